@@ -2,18 +2,33 @@
 
 #include "InputStream.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
+#include <memory>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Simple stream that reads from a file
+// Simple stream that reads from a file.
+// Reads are done in large blocks into an internal buffer, so that reading many small values does not need a file read for each value.
 //------------------------------------------------------------------------------------------------------------------------------------------
 class FileInputStream final : public InputStream {
 public:
-    inline FileInputStream(const char* const filePath) THROWS
+    // The default size of the internal read buffer
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    inline FileInputStream(const char* const filePath, const size_t bufferSize = DEFAULT_BUFFER_SIZE) THROWS
         : mpFile(std::fopen(filePath, "rb"))
+        , mpBuffer()
+        , mBufferSize(std::max<size_t>(bufferSize, 1))
+        , mBufferPos(0)
+        , mBufferEnd(0)
     {
         if (!mpFile)
             throw StreamException();
+
+        // Buffering is done by this class, so disable buffering in the C library to avoid copying twice
+        std::setvbuf(mpFile, nullptr, _IONBF, 0);
+        mpBuffer.reset(new std::byte[mBufferSize]);
     }
 
     virtual ~FileInputStream() noexcept override {
@@ -24,15 +39,28 @@ public:
     }
 
     virtual void readBytes(void* const pDstBytes, const size_t numBytes) THROWS override {
-        if (numBytes > 0) {
-            if (std::fread(pDstBytes, numBytes, 1, mpFile) != 1)
-                throw StreamException();
+        // Fast path: the data is all in the buffer
+        if (numBytes <= mBufferEnd - mBufferPos) {
+            if (numBytes > 0) {
+                std::memcpy(pDstBytes, mpBuffer.get() + mBufferPos, numBytes);
+                mBufferPos += numBytes;
+            }
+        } else {
+            readBytesSlow((std::byte*) pDstBytes, numBytes);
         }
     }
 
     virtual void skipBytes(const size_t numBytes) THROWS override {
-        if (numBytes > 0) {
-            if (std::fseek(mpFile, (long) numBytes, SEEK_CUR) != 0)
+        // Skip within the buffer if possible, otherwise discard the buffer and seek past the remaining bytes
+        const size_t numBufferedBytes = mBufferEnd - mBufferPos;
+
+        if (numBytes <= numBufferedBytes) {
+            mBufferPos += numBytes;
+        } else {
+            mBufferPos = 0;
+            mBufferEnd = 0;
+
+            if (std::fseek(mpFile, (long)(numBytes - numBufferedBytes), SEEK_CUR) != 0)
                 throw StreamException();
         }
     }
@@ -43,13 +71,15 @@ public:
         if (offset < 0)
             throw StreamException();
 
-        return (size_t) offset;
+        return (size_t) offset - (mBufferEnd - mBufferPos);
     }
 
     virtual bool isAtEnd() noexcept override {
-        const int charValue = std::getc(mpFile);
-        std::ungetc(charValue, mpFile);
-        return (charValue == EOF);
+        if (mBufferPos < mBufferEnd)
+            return false;
+
+        fillBuffer();
+        return (mBufferPos >= mBufferEnd);
     }
 
 private:
@@ -58,5 +88,40 @@ private:
     inline FileInputStream& operator = (const FileInputStream& other) = delete;
     inline FileInputStream& operator = (FileInputStream&& other) = delete;
 
-    FILE* mpFile;
+    // Refill the internal buffer with as many bytes as can be read (the buffer must be empty)
+    void fillBuffer() noexcept {
+        mBufferPos = 0;
+        mBufferEnd = std::fread(mpBuffer.get(), 1, mBufferSize, mpFile);
+    }
+
+    // Read the given number of bytes when not all of them are in the buffer
+    void readBytesSlow(std::byte* pDstBytes, size_t numBytes) THROWS {
+        // Consume whatever is left in the buffer first
+        const size_t numBufferedBytes = mBufferEnd - mBufferPos;
+        std::memcpy(pDstBytes, mpBuffer.get() + mBufferPos, numBufferedBytes);
+        pDstBytes += numBufferedBytes;
+        numBytes -= numBufferedBytes;
+        mBufferPos = 0;
+        mBufferEnd = 0;
+
+        // Large reads go straight to the destination, otherwise refill the buffer and read from that
+        if (numBytes >= mBufferSize) {
+            if (std::fread(pDstBytes, numBytes, 1, mpFile) != 1)
+                throw StreamException();
+        } else {
+            fillBuffer();
+
+            if (numBytes > mBufferEnd)
+                throw StreamException();
+
+            std::memcpy(pDstBytes, mpBuffer.get(), numBytes);
+            mBufferPos = numBytes;
+        }
+    }
+
+    FILE*                           mpFile;
+    std::unique_ptr<std::byte[]>    mpBuffer;       // Buffer holding data read from the file but not yet consumed
+    size_t                          mBufferSize;    // Size of the buffer
+    size_t                          mBufferPos;     // Where the next unconsumed byte is in the buffer
+    size_t                          mBufferEnd;     // The end of the data read into the buffer
 };
@@ -2,44 +2,87 @@
 
 #include "OutputStream.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <cstring>
+#include <memory>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Represents a generic output stream
+// Stream that writes to a file.
+// Writes are gathered in an internal buffer and written to the file in large blocks, when the buffer is full or when flushed.
 //------------------------------------------------------------------------------------------------------------------------------------------
 class FileOutputStream final : public OutputStream {
 public:
-    inline FileOutputStream(const char* const filePath, const bool bAppend) THROWS
+    // The default size of the internal write buffer
+    static constexpr size_t DEFAULT_BUFFER_SIZE = 64 * 1024;
+
+    inline FileOutputStream(const char* const filePath, const bool bAppend, const size_t bufferSize = DEFAULT_BUFFER_SIZE) THROWS
         : mpFile(std::fopen(filePath, (bAppend) ?  "wab" : "wb"))
+        , mpBuffer()
+        , mBufferSize(std::max<size_t>(bufferSize, 1))
+        , mBufferUsed(0)
     {
         if (!mpFile)
             throw StreamException();
+
+        // Buffering is done by this class, so disable buffering in the C library to avoid copying twice
+        std::setvbuf(mpFile, nullptr, _IONBF, 0);
+        mpBuffer.reset(new std::byte[mBufferSize]);
     }
 
     inline FileOutputStream(FileOutputStream&& other) noexcept
         : mpFile(other.mpFile)
+        , mpBuffer(std::move(other.mpBuffer))
+        , mBufferSize(other.mBufferSize)
+        , mBufferUsed(other.mBufferUsed)
     {
         other.mpFile = nullptr;
+        other.mBufferUsed = 0;
     }
 
     virtual ~FileOutputStream() noexcept override {
         if (mpFile) {
+            // Write out anything still buffered: no way to report errors here, call 'flush' before destruction to check for those
+            if (mBufferUsed > 0) {
+                std::fwrite(mpBuffer.get(), mBufferUsed, 1, mpFile);
+            }
+
             std::fclose(mpFile);
             mpFile = nullptr;
         }
     }
 
     virtual void writeBytes(const void* const pSrcBytes, const size_t numBytes) THROWS override {
-        if (numBytes > 0) {
-            if (std::fwrite(pSrcBytes, numBytes, 1, mpFile) != 1)
-                throw StreamException();
+        // Fast path: the data fits in the buffer
+        if (numBytes <= mBufferSize - mBufferUsed) {
+            if (numBytes > 0) {
+                std::memcpy(mpBuffer.get() + mBufferUsed, pSrcBytes, numBytes);
+                mBufferUsed += numBytes;
+            }
+        } else {
+            // Make room in the buffer, then either buffer the data or write it directly if it is a large write
+            writeBuffer();
+
+            if (numBytes >= mBufferSize) {
+                if (std::fwrite(pSrcBytes, numBytes, 1, mpFile) != 1)
+                    throw StreamException();
+            } else {
+                std::memcpy(mpBuffer.get(), pSrcBytes, numBytes);
+                mBufferUsed = numBytes;
+            }
         }
     }
 
     virtual void fillBytes(const size_t numBytes, const std::byte byteValue) THROWS override {
-        for (size_t i = 0; i < numBytes; ++i) {
-            if (std::fwrite(&byteValue, 1, 1, mpFile) != 1)
-                throw StreamException();
+        for (size_t numBytesLeft = numBytes; numBytesLeft > 0;) {
+            if (mBufferUsed >= mBufferSize) {
+                writeBuffer();
+            }
+
+            const size_t numBytesToFill = std::min(numBytesLeft, mBufferSize - mBufferUsed);
+            std::memset(mpBuffer.get() + mBufferUsed, (int) byteValue, numBytesToFill);
+            mBufferUsed += numBytesToFill;
+            numBytesLeft -= numBytesToFill;
         }
     }
 
@@ -49,10 +92,12 @@ public:
         if (offset < 0)
             throw StreamException();
 
-        return (size_t) offset;
+        return (size_t) offset + mBufferUsed;
     }
 
     virtual void flush() THROWS override {
+        writeBuffer();
+
         if (std::fflush(mpFile) != 0)
             throw StreamException();
     }
@@ -62,5 +107,19 @@ private:
     inline FileOutputStream& operator = (const FileOutputStream& other) = delete;
     inline FileOutputStream& operator = (FileOutputStream&& other) = delete;
 
-    FILE* mpFile;
+    // Write all buffered data to the file and empty the buffer
+    void writeBuffer() THROWS {
+        if (mBufferUsed > 0) {
+            const size_t numBytesToWrite = mBufferUsed;
+            mBufferUsed = 0;
+
+            if (std::fwrite(mpBuffer.get(), numBytesToWrite, 1, mpFile) != 1)
+                throw StreamException();
+        }
+    }
+
+    FILE*                           mpFile;
+    std::unique_ptr<std::byte[]>    mpBuffer;       // Buffer holding data not yet written to the file
+    size_t                          mBufferSize;    // Size of the buffer
+    size_t                          mBufferUsed;    // How many bytes of the buffer are used
 };
@@ -153,6 +153,54 @@ int64_t getFileSize(const char* filePath) noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Renames the given source file to the destination path, replacing the destination file if it already exists.
+// On POSIX systems this is done atomically, so other readers see either the old or new destination file but never a partial one.
+// Returns 'false' on failure.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool replaceFile(const char* srcFilePath, const char* dstFilePath) noexcept {
+    ASSERT(srcFilePath);
+    ASSERT(dstFilePath);
+
+    try {
+        // MacOS: working around missing support for <filesystem> in everything except the latest bleeding edge OS and Xcode.
+        // Use standard Unix file functions instead for now, but some day this can be removed.
+        #ifdef __APPLE__
+            return (std::rename(srcFilePath, dstFilePath) == 0);
+        #else
+            std::filesystem::rename(srcFilePath, dstFilePath);
+            return true;
+        #endif
+    } catch (...) {
+        return false;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the last modification time of the given file and return '-1' if there is an error.
+// The units and epoch of the time are platform specific, so it should only be used for comparing against other values from this function.
+//------------------------------------------------------------------------------------------------------------------------------------------
+int64_t getFileModTime(const char* filePath) noexcept {
+    ASSERT(filePath);
+
+    try {
+        // MacOS: working around missing support for <filesystem> in everything except the latest bleeding edge OS and Xcode.
+        // Use standard Unix file functions instead for now, but some day this can be removed.
+        #ifdef __APPLE__
+            struct stat fileInfo;
+
+            if (stat(filePath, &fileInfo) < 0)
+                return -1;
+
+            return (int64_t) fileInfo.st_mtime;
+        #else
+            return (int64_t) std::filesystem::last_write_time(filePath).time_since_epoch().count();
+        #endif
+    } catch (...) {
+        return -1;
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Given a file or folder path, return the parent folder path or an empty string if there is no parent.
 // Accepts POSIX or Windows style separators (forward or backward slash) in the path only.
@@ -33,6 +33,8 @@ bool writeDataToFile(
 
 bool fileExists(const char* filePath) noexcept;
 int64_t getFileSize(const char* filePath) noexcept;
+int64_t getFileModTime(const char* filePath) noexcept;
+bool replaceFile(const char* srcFilePath, const char* dstFilePath) noexcept;
 void getParentPath(const char* path, std::string& parentPath) noexcept;
 
 END_NAMESPACE(FileUtils)
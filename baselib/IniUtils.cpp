@@ -28,8 +28,8 @@ BEGIN_NAMESPACE(IniUtils)
 struct ParserState {
     const char*         pCurChar;
     const char*         pEndChar;
-    IniEntry            curEntry;
-    IniEntryHandler     entryHandler;
+    IniEntry                curEntry;
+    const IniEntryHandler*  pEntryHandler;
 };
 
 static inline bool isSpace(const char c) noexcept {
@@ -225,20 +225,20 @@ static void parseKeyValuePair(ParserState& state) noexcept {
     trimUnescapeAndAssignStr(pValueStartChar, pValueEndChar, state.curEntry.value.strValue);
 
     // Send the value to the entry handler
-    state.entryHandler(state.curEntry);
+    (*state.pEntryHandler)(state.curEntry);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Parse an INI from a string in memory.
 // Does its best to try and recover from errors on each line.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void parseIniFromString(const char* const pStr, const size_t len, const IniEntryHandler entryHandler) noexcept {
+void parseIniFromString(const char* const pStr, const size_t len, const IniEntryHandler& entryHandler) noexcept {
     ASSERT(entryHandler);
 
     ParserState state;
     state.pCurChar = pStr;
     state.pEndChar = pStr + len;
-    state.entryHandler = entryHandler;
+    state.pEntryHandler = &entryHandler;
 
     state.curEntry.section.reserve(64);
     state.curEntry.key.reserve(64);
@@ -118,6 +118,6 @@ struct IniEntry {
 // Note: I would make this function prototype 'noexcept' but std::function<> doesn't handle that so well currently...
 typedef std::function<void (const IniEntry& entry)> IniEntryHandler;
 
-void parseIniFromString(const char* const pStr, const size_t len, const IniEntryHandler entryHandler) noexcept;
+void parseIniFromString(const char* const pStr, const size_t len, const IniEntryHandler& entryHandler) noexcept;
 
 END_NAMESPACE(IniUtils)
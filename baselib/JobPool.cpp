@@ -0,0 +1,189 @@
+#include "JobPool.h"
+
+#include "Asserts.h"
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the number of worker threads to use for a pool by default.
+// Uses one less worker thread than the number of CPU cores, since the thread running jobs also helps out with them.
+// If 'maxThreads' is greater than zero then the total number of threads (including the calling thread) is capped further to this amount.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t JobPool::getDefaultNumWorkers(const int32_t maxThreads, const uint32_t maxWorkers) noexcept {
+    const uint32_t numCpuThreads = (maxThreads > 0) ?
+        std::min(std::thread::hardware_concurrency(), (uint32_t) maxThreads) :
+        std::thread::hardware_concurrency();
+
+    return (numCpuThreads > 1) ? std::min(numCpuThreads - 1, maxWorkers) : 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates the pool with no worker threads
+//------------------------------------------------------------------------------------------------------------------------------------------
+JobPool::JobPool() noexcept
+    : mWorkers()
+    , mbBatchRunning(false)
+    , mMutex()
+    , mJobsStartedCV()
+    , mJobsFinishedCV()
+    , mBatchId(0)
+    , mNumBusyWorkers(0)
+    , mbQuitWorkers(false)
+    , mJobFunc(nullptr)
+    , mpJobCtx(nullptr)
+    , mNumJobs(0)
+    , mNextJobIdx(0)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stops the worker threads, if running
+//------------------------------------------------------------------------------------------------------------------------------------------
+JobPool::~JobPool() noexcept {
+    shutdown();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Starts up the specified number of worker threads, stopping any existing ones first
+//------------------------------------------------------------------------------------------------------------------------------------------
+void JobPool::init(const uint32_t numWorkers) noexcept {
+    shutdown();
+
+    mbQuitWorkers = false;
+    mWorkers.reserve(numWorkers);
+
+    for (uint32_t i = 0; i < numWorkers; ++i) {
+        mWorkers.emplace_back(&JobPool::workerMain, this);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stops all of the worker threads, if any are running
+//------------------------------------------------------------------------------------------------------------------------------------------
+void JobPool::shutdown() noexcept {
+    if (mWorkers.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mbQuitWorkers = true;
+    }
+
+    mJobsStartedCV.notify_all();
+
+    for (std::thread& thread : mWorkers) {
+        thread.join();
+    }
+
+    mWorkers.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Executes the specified number of jobs using the job function, spreading them across the worker threads and the calling thread.
+// Waits for all of the jobs to complete before returning. If there are no worker threads, or if the pool is already busy with another
+// batch of jobs, then the jobs are just run in order on the calling thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void JobPool::run(const JobFunc jobFunc, void* const pCtx, const uint32_t numJobs) noexcept {
+    ASSERT(jobFunc);
+
+    const auto runJobsOnThisThread = [&]() noexcept {
+        for (uint32_t jobIdx = 0; jobIdx < numJobs; ++jobIdx) {
+            jobFunc(pCtx, jobIdx);
+        }
+    };
+
+    // If there is only 1 job or no workers then just run the jobs on this thread
+    if ((numJobs <= 1) || mWorkers.empty()) {
+        runJobsOnThisThread();
+        return;
+    }
+
+    // Same if another batch of jobs is in progress
+    bool bExpectedBatchRunning = false;
+
+    if (!mbBatchRunning.compare_exchange_strong(bExpectedBatchRunning, true, std::memory_order_acquire)) {
+        runJobsOnThisThread();
+        return;
+    }
+
+    // Kick off the jobs for the workers and help out with them on this thread
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJobFunc = jobFunc;
+        mpJobCtx = pCtx;
+        mNumJobs = numJobs;
+        mNextJobIdx.store(0, std::memory_order_relaxed);
+        mNumBusyWorkers = (uint32_t) mWorkers.size();
+        mBatchId++;
+    }
+
+    mJobsStartedCV.notify_all();
+    doJobs();
+
+    // Wait for all workers to finish
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mJobsFinishedCV.wait(lock, [this]() noexcept {
+            return (mNumBusyWorkers == 0);
+        });
+
+        mJobFunc = nullptr;
+        mpJobCtx = nullptr;
+        mNumJobs = 0;
+    }
+
+    mbBatchRunning.store(false, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Keep grabbing jobs in the current batch and executing them until there are none left
+//------------------------------------------------------------------------------------------------------------------------------------------
+void JobPool::doJobs() noexcept {
+    const JobFunc jobFunc = mJobFunc;
+    void* const pCtx = mpJobCtx;
+    const uint32_t numJobs = mNumJobs;
+
+    while (true) {
+        const uint32_t jobIdx = mNextJobIdx.fetch_add(1, std::memory_order_relaxed);
+
+        if (jobIdx >= numJobs)
+            break;
+
+        jobFunc(pCtx, jobIdx);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Main loop for a job worker thread
+//------------------------------------------------------------------------------------------------------------------------------------------
+void JobPool::workerMain() noexcept {
+    uint32_t lastBatchId = 0;
+
+    while (true) {
+        // Wait for a new batch of jobs or to be told to exit
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mJobsStartedCV.wait(lock, [&]() noexcept {
+                return (mbQuitWorkers || (mBatchId != lastBatchId));
+            });
+
+            if (mbQuitWorkers)
+                return;
+
+            lastBatchId = mBatchId;
+        }
+
+        // Do the jobs and signal when the last worker is done
+        doJobs();
+
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            ASSERT(mNumBusyWorkers > 0);
+            mNumBusyWorkers--;
+
+            if (mNumBusyWorkers == 0) {
+                mJobsFinishedCV.notify_one();
+            }
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A small pool of worker threads used to spread batches of independent jobs across multiple cores.
+// The thread calling 'run' also helps out with the jobs and waits for the whole batch to finish.
+//
+// Only one batch runs on the pool at a time. If 'run' is called while another batch is in progress (from another thread, or from within
+// a job) then the jobs are simply executed on the calling thread instead of waiting, so that callers can never deadlock on the pool.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class JobPool {
+public:
+    // A function which executes the job with the given index, using the context pointer passed to 'run'.
+    // Jobs which are run together may be executed in any order and on any thread.
+    typedef void (*JobFunc)(void* const pCtx, const uint32_t jobIdx) noexcept;
+
+    static uint32_t getDefaultNumWorkers(const int32_t maxThreads, const uint32_t maxWorkers) noexcept;
+
+    JobPool() noexcept;
+    ~JobPool() noexcept;
+
+    void init(const uint32_t numWorkers) noexcept;
+    void shutdown() noexcept;
+    inline uint32_t getNumWorkers() const noexcept { return (uint32_t) mWorkers.size(); }
+    void run(const JobFunc jobFunc, void* const pCtx, const uint32_t numJobs) noexcept;
+
+private:
+    JobPool(const JobPool& other) = delete;
+    JobPool(JobPool&& other) = delete;
+    JobPool& operator = (const JobPool& other) = delete;
+    JobPool& operator = (JobPool&& other) = delete;
+
+    void doJobs() noexcept;
+    void workerMain() noexcept;
+
+    // The worker threads and their synchronization state
+    std::vector<std::thread>    mWorkers;
+    std::atomic<bool>           mbBatchRunning;     // Set while a batch of jobs is running: only one batch can run at a time
+    std::mutex                  mMutex;
+    std::condition_variable     mJobsStartedCV;     // Signalled when a new batch of jobs starts or when the workers should exit
+    std::condition_variable     mJobsFinishedCV;    // Signalled when the last busy worker has finished with the current batch
+    uint32_t                    mBatchId;           // Incremented for each new batch of jobs
+    uint32_t                    mNumBusyWorkers;    // How many workers have still to finish the current batch
+    bool                        mbQuitWorkers;      // Set when the workers should exit
+
+    // The current batch of jobs being executed
+    JobFunc                     mJobFunc;
+    void*                       mpJobCtx;
+    uint32_t                    mNumJobs;
+    std::atomic<uint32_t>       mNextJobIdx;
+};
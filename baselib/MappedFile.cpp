@@ -0,0 +1,130 @@
+#include "MappedFile.h"
+
+#if _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates the object with no file mapped
+//------------------------------------------------------------------------------------------------------------------------------------------
+MappedFile::MappedFile() noexcept
+    : mpData(nullptr)
+    , mSize(0)
+    , mpOsHandle(nullptr)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Move the mapping from one object to another
+//------------------------------------------------------------------------------------------------------------------------------------------
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : mpData(other.mpData)
+    , mSize(other.mSize)
+    , mpOsHandle(other.mpOsHandle)
+{
+    other.mpData = nullptr;
+    other.mSize = 0;
+    other.mpOsHandle = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Unmaps the file, if mapped
+//------------------------------------------------------------------------------------------------------------------------------------------
+MappedFile::~MappedFile() noexcept {
+    close();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to map the entire contents of the specified file into memory for reading and returns 'true' if successful.
+// If a file is already mapped then it is unmapped first.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool MappedFile::open(const char* const filePath) noexcept {
+    close();
+
+    if (!filePath)
+        return false;
+
+    #if _WIN32
+        // Open the file, get it's size and create a read only mapping of the whole file.
+        // Note: the file handle can be closed once the mapping object is created since the mapping keeps the file open.
+        const HANDLE hFile = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+        if (hFile == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize = {};
+        const bool bGotSize = GetFileSizeEx(hFile, &fileSize);
+
+        if ((!bGotSize) || (fileSize.QuadPart <= 0)) {
+            CloseHandle(hFile);
+            return false;
+        }
+
+        const HANDLE hMapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(hFile);
+
+        if (!hMapping)
+            return false;
+
+        const void* const pView = MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+
+        if (!pView) {
+            CloseHandle(hMapping);
+            return false;
+        }
+
+        mpData = (const std::byte*) pView;
+        mSize = (uint64_t) fileSize.QuadPart;
+        mpOsHandle = hMapping;
+    #else
+        // Open the file, get it's size and create a read only mapping of the whole file.
+        // Note: the file descriptor can be closed once the mapping is made since the mapping keeps the file open.
+        const int fd = ::open(filePath, O_RDONLY);
+
+        if (fd < 0)
+            return false;
+
+        struct stat fileStat = {};
+
+        if ((fstat(fd, &fileStat) != 0) || (fileStat.st_size <= 0)) {
+            ::close(fd);
+            return false;
+        }
+
+        void* const pView = mmap(nullptr, (size_t) fileStat.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+
+        if (pView == MAP_FAILED)
+            return false;
+
+        mpData = (const std::byte*) pView;
+        mSize = (uint64_t) fileStat.st_size;
+    #endif
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Unmaps the currently mapped file, if any
+//------------------------------------------------------------------------------------------------------------------------------------------
+void MappedFile::close() noexcept {
+    if (mpData) {
+        #if _WIN32
+            UnmapViewOfFile(mpData);
+            CloseHandle((HANDLE) mpOsHandle);
+        #else
+            munmap((void*) mpData, (size_t) mSize);
+        #endif
+    }
+
+    mpData = nullptr;
+    mSize = 0;
+    mpOsHandle = nullptr;
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A read-only memory mapping of a file on disk.
+// Allows the contents of a file to be accessed directly without any read/seek system calls or copies into intermediate buffers.
+// Mapping may not be possible in all cases (e.g empty files, or if the OS refuses) so users should be prepared to fall back to regular IO.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class MappedFile {
+public:
+    MappedFile() noexcept;
+    MappedFile(MappedFile&& other) noexcept;
+    ~MappedFile() noexcept;
+
+    bool open(const char* const filePath) noexcept;
+    void close() noexcept;
+
+    inline bool isOpen() const noexcept { return (mpData != nullptr); }
+    inline const std::byte* getData() const noexcept { return mpData; }
+    inline uint64_t getSize() const noexcept { return mSize; }
+
+private:
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator = (const MappedFile& other) = delete;
+    MappedFile& operator = (MappedFile&& other) = delete;
+
+    const std::byte*    mpData;         // The mapped file contents or null if no file is mapped
+    uint64_t            mSize;          // Size of the mapped file in bytes
+    void*               mpOsHandle;     // Windows only: handle to the file mapping object
+};
@@ -0,0 +1,122 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A minimal microbenchmark harness.
+//
+// Each benchmark kernel runs its workload a given number of times. The harness firstly calibrates how many iterations are required for a
+// single timed run to take a reasonable amount of time, then times several runs of that size and reports the median time per iteration.
+// Using the median rather than the mean helps filter out noise from other processes, page faults and so on.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+BEGIN_NAMESPACE(Bench)
+
+typedef std::chrono::steady_clock Clock;
+
+// How long a single timed run of a benchmark should take at minimum and how many timed runs to do
+static constexpr std::chrono::milliseconds MIN_RUN_TIME = std::chrono::milliseconds(25);
+static constexpr uint32_t NUM_TIMED_RUNS = 7;
+
+// A registered benchmark
+struct Benchmark {
+    const char*     name;
+    BenchFunc       func;
+};
+
+volatile uint32_t gSink;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the list of registered benchmarks
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::vector<Benchmark>& getBenchmarks() noexcept {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Time how long it takes for the benchmark to do the specified number of iterations
+//------------------------------------------------------------------------------------------------------------------------------------------
+static Clock::duration timeRun(const Benchmark& benchmark, const uint64_t numIters) noexcept {
+    const Clock::time_point startTime = Clock::now();
+    benchmark.func(numIters);
+    return Clock::now() - startTime;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Runs the given benchmark and returns the median time taken per iteration in nanoseconds.
+// Also outputs the number of iterations done per timed run.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static double runBenchmark(const Benchmark& benchmark, uint64_t& numItersOut) noexcept {
+    // Calibrate: keep increasing the number of iterations until a run takes long enough to time accurately.
+    // The first run also serves as a warmup for caches etc.
+    uint64_t numIters = 1;
+
+    while (true) {
+        const Clock::duration runTime = timeRun(benchmark, numIters);
+
+        if (runTime >= MIN_RUN_TIME)
+            break;
+
+        // Estimate how many iterations are needed to reach the minimum run time, without growing too quickly in case the estimate is off
+        const double runTimeNs = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(runTime).count();
+        const double targetNs = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(MIN_RUN_TIME).count();
+        const double scale = (runTimeNs > 0.0) ? std::min(targetNs * 1.2 / runTimeNs, 10.0) : 10.0;
+        numIters = std::max<uint64_t>((uint64_t)((double) numIters * scale), numIters + 1);
+    }
+
+    // Do the timed runs and take the median
+    double nsPerIter[NUM_TIMED_RUNS];
+
+    for (double& runNsPerIter : nsPerIter) {
+        const Clock::duration runTime = timeRun(benchmark, numIters);
+        runNsPerIter = (double) std::chrono::duration_cast<std::chrono::nanoseconds>(runTime).count() / (double) numIters;
+    }
+
+    std::sort(nsPerIter, nsPerIter + NUM_TIMED_RUNS);
+    numItersOut = numIters;
+    return nsPerIter[NUM_TIMED_RUNS / 2];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Register a benchmark with the given name
+//------------------------------------------------------------------------------------------------------------------------------------------
+void add(const char* const name, const BenchFunc func) noexcept {
+    getBenchmarks().push_back(Benchmark{ name, func });
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Print the names of all registered benchmarks
+//------------------------------------------------------------------------------------------------------------------------------------------
+void list() noexcept {
+    for (const Benchmark& benchmark : getBenchmarks()) {
+        std::printf("%s\n", benchmark.name);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Run all benchmarks whose name contains the given filter string (or all benchmarks if no filter is given) and print the results.
+// Returns the number of benchmarks that were run.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t run(const char* const nameFilter) noexcept {
+    std::printf("%-56s %14s %14s\n", "Benchmark", "ns/iter", "iters/run");
+    uint32_t numRun = 0;
+
+    for (const Benchmark& benchmark : getBenchmarks()) {
+        if (nameFilter && (!std::strstr(benchmark.name, nameFilter)))
+            continue;
+
+        uint64_t numIters = 0;
+        const double nsPerIter = runBenchmark(benchmark, numIters);
+        std::printf("%-56s %14.2f %14llu\n", benchmark.name, nsPerIter, (unsigned long long) numIters);
+        std::fflush(stdout);
+        numRun++;
+    }
+
+    return numRun;
+}
+
+END_NAMESPACE(Bench)
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstdint>
+
+BEGIN_NAMESPACE(Bench)
+
+// Signature for a benchmark kernel: the kernel must run its workload the requested number of times
+typedef void (*BenchFunc)(const uint64_t numIters) noexcept;
+
+void add(const char* const name, const BenchFunc func) noexcept;
+void list() noexcept;
+uint32_t run(const char* const nameFilter) noexcept;
+
+// A sink for computed results, so that the compiler cannot discard the work done by a kernel
+extern volatile uint32_t gSink;
+
+inline void consume(const uint32_t value) noexcept {
+    gSink = gSink + value;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A small deterministic random number generator (xorshift32) used to generate benchmark inputs.
+// Deterministic so that runs of the benchmarks are comparable between builds.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct Random {
+    uint32_t state;
+
+    inline Random(const uint32_t seed = 0x9E3779B9u) noexcept : state(seed) {}
+
+    inline uint32_t next() noexcept {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        return state;
+    }
+
+    // Returns a number in the range 'min' to 'max' (inclusive)
+    inline int32_t range(const int32_t min, const int32_t max) noexcept {
+        return min + (int32_t)(next() % (uint32_t)(max - min + 1));
+    }
+};
+
+END_NAMESPACE(Bench)
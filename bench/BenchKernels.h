@@ -0,0 +1,14 @@
+#pragma once
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Functions which register each group of benchmark kernels with the harness
+//------------------------------------------------------------------------------------------------------------------------------------------
+void registerGpuBenchmarks() noexcept;
+void registerSpuBenchmarks() noexcept;
+void registerWadBenchmarks() noexcept;
+void registerMovieBenchmarks() noexcept;
+void registerMathBenchmarks() noexcept;
+
+#if PSYDOOM_VULKAN_RENDERER
+    void registerOcclusionBenchmarks() noexcept;
+#endif
@@ -0,0 +1,97 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Benchmarks for the software GPU: draws each primitive type in each of the supported draw modes.
+// The primitive sizes are roughly what is typically seen in-game at the original 256x240 resolution.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include "BenchKernels.h"
+
+#include "Gpu.h"
+
+using namespace Gpu;
+
+static Core gCore;
+static bool gbCoreInitialized;
+
+// Where the texture page and CLUT used for textured drawing live in VRAM
+static constexpr uint16_t TEX_PAGE_X = 512;
+static constexpr uint16_t TEX_PAGE_Y = 0;
+static constexpr uint16_t CLUT_X = 0;
+static constexpr uint16_t CLUT_Y = 480;
+
+// The primitives drawn
+static constexpr Color24F COLOR = Color24F(128, 96, 64);
+
+static constexpr DrawRect RECT = { 96, 88, 64, 64, 0, 0, COLOR };
+static constexpr DrawLine LINE = { 0, 0, 255, 200, COLOR };
+static constexpr DrawTriangle TRIANGLE = { 20, 20, 0, 0, 200, 40, 127, 0, 100, 200, 64, 127, COLOR };
+static constexpr DrawTriangleGouraud TRIANGLE_GOURAUD = {
+    20, 20, 0, 0, 200, 40, 127, 0, 100, 200, 64, 127, Color24F(128, 128, 128), Color24F(64, 64, 64), Color24F(32, 96, 128)
+};
+static constexpr DrawFloorRow FLOOR_ROW = { 120, 0, 0, 0, 255, 63, 127, COLOR };
+static constexpr DrawWallCol WALL_COL = { 100, 10, 20, 0, 200, 127, COLOR };
+static constexpr DrawWallColGouraud WALL_COL_GOURAUD = { 100, 10, 20, 0, 200, 127, Color24F(128, 128, 128), Color24F(32, 32, 32) };
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initializes the GPU core used for benchmarking if not already done.
+// Fills VRAM with random data and sets up an 8 bpp texture page and CLUT, similar to what is used for Doom's walls and floors.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void initCoreIfRequired() noexcept {
+    if (gbCoreInitialized)
+        return;
+
+    initCore(gCore, PS1_VRAM_W, PS1_VRAM_H);
+    Bench::Random random;
+
+    for (uint32_t i = 0; i < (uint32_t) PS1_VRAM_W * PS1_VRAM_H; ++i) {
+        gCore.pRam[i] = (uint16_t)(random.next() | 0x1);    // Non-zero texels so that masking does not discard them
+    }
+
+    gCore.texPageX = TEX_PAGE_X;
+    gCore.texPageY = TEX_PAGE_Y;
+    gCore.texPageXMask = 0x7F;
+    gCore.texPageYMask = 0xFF;
+    gCore.texWinXMask = 0xFF;
+    gCore.texWinYMask = 0x7F;
+    gCore.texFmt = TexFmt::Bpp8;
+    gCore.clutX = CLUT_X;
+    gCore.clutY = CLUT_Y;
+    gCore.blendMode = BlendMode::Alpha50;
+    gbCoreInitialized = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Benchmark kernel: draws the given primitive with the given draw mode
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <DrawMode Mode, const auto& Prim>
+static void benchDraw(const uint64_t numIters) noexcept {
+    initCoreIfRequired();
+
+    for (uint64_t i = 0; i < numIters; ++i) {
+        draw<Mode>(gCore, Prim);
+    }
+
+    Bench::consume(gCore.pRam[(size_t) 120 * gCore.ramPixelW + 128]);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Registers the benchmarks
+//------------------------------------------------------------------------------------------------------------------------------------------
+#define ADD_DRAW_BENCH(NAME, PRIM, MODE)\
+    Bench::add("Gpu::draw/" NAME "/" #MODE, benchDraw<DrawMode::MODE, PRIM>)
+
+#define ADD_DRAW_BENCH_ALL_MODES(NAME, PRIM)\
+    ADD_DRAW_BENCH(NAME, PRIM, Colored);\
+    ADD_DRAW_BENCH(NAME, PRIM, ColoredBlended);\
+    ADD_DRAW_BENCH(NAME, PRIM, Textured);\
+    ADD_DRAW_BENCH(NAME, PRIM, TexturedBlended)
+
+void registerGpuBenchmarks() noexcept {
+    ADD_DRAW_BENCH_ALL_MODES("Rect 64x64", RECT);
+    ADD_DRAW_BENCH("Line 255x200", LINE, Colored);              // Note: lines only support the colored modes
+    ADD_DRAW_BENCH("Line 255x200", LINE, ColoredBlended);
+    ADD_DRAW_BENCH_ALL_MODES("Triangle", TRIANGLE);
+    ADD_DRAW_BENCH_ALL_MODES("TriangleGouraud", TRIANGLE_GOURAUD);
+    ADD_DRAW_BENCH_ALL_MODES("FloorRow 256", FLOOR_ROW);
+    ADD_DRAW_BENCH_ALL_MODES("WallCol 180", WALL_COL);
+    ADD_DRAW_BENCH_ALL_MODES("WallColGouraud 180", WALL_COL_GOURAUD);
+}
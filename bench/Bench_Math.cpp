@@ -0,0 +1,70 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Benchmarks for fixed point math.
+// Each iteration processes a batch of random operands so that loop overhead and branch prediction effects are representative.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include "BenchKernels.h"
+
+#include "Doom/Base/m_fixed.h"
+
+// How many pairs of operands are processed per iteration
+static constexpr uint32_t NUM_OPERANDS = 1024;
+
+static fixed_t  gOperandsA[NUM_OPERANDS];
+static fixed_t  gOperandsB[NUM_OPERANDS];
+static bool     gbOperandsGenerated;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Generates the random operands if not already done.
+// The values are in the range of typical map coordinates and distances: +/- 4096.0 for 'a' and +/- 64.0 (but never zero) for 'b'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void generateOperandsIfRequired() noexcept {
+    if (gbOperandsGenerated)
+        return;
+
+    Bench::Random random;
+
+    for (uint32_t i = 0; i < NUM_OPERANDS; ++i) {
+        gOperandsA[i] = random.range(-4096 * FRACUNIT, 4096 * FRACUNIT);
+        gOperandsB[i] = random.range(FRACUNIT / 16, 64 * FRACUNIT) * ((random.next() & 1) ? +1 : -1);
+    }
+
+    gbOperandsGenerated = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Benchmark kernels: fixed point multiply and divide
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void benchFixedMul(const uint64_t numIters) noexcept {
+    generateOperandsIfRequired();
+    fixed_t sum = 0;
+
+    for (uint64_t i = 0; i < numIters; ++i) {
+        for (uint32_t j = 0; j < NUM_OPERANDS; ++j) {
+            sum += FixedMul(gOperandsA[j], gOperandsB[j]);
+        }
+    }
+
+    Bench::consume((uint32_t) sum);
+}
+
+static void benchFixedDiv(const uint64_t numIters) noexcept {
+    generateOperandsIfRequired();
+    fixed_t sum = 0;
+
+    for (uint64_t i = 0; i < numIters; ++i) {
+        for (uint32_t j = 0; j < NUM_OPERANDS; ++j) {
+            sum += FixedDiv(gOperandsA[j], gOperandsB[j]);
+        }
+    }
+
+    Bench::consume((uint32_t) sum);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Registers the benchmarks
+//------------------------------------------------------------------------------------------------------------------------------------------
+void registerMathBenchmarks() noexcept {
+    Bench::add("FixedMul/1024 ops", benchFixedMul);
+    Bench::add("FixedDiv/1024 ops", benchFixedDiv);
+}
@@ -0,0 +1,118 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Benchmarks for movie (MDEC) macroblock decoding.
+// A synthetic bitstream for a macroblock is generated with a typical number of non-zero AC coefficients in each of its 6 blocks.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include "BenchKernels.h"
+
+#include "Asserts.h"
+#include "Endian.h"
+#include "PsyDoom/Movie/MacroBlockDecoder.h"
+#include "PsyDoom/Movie/MBlockBitStream.h"
+
+#include <vector>
+
+using namespace movie;
+
+// How many AC coefficients are encoded in each block and the quantization scale used for decoding
+static constexpr uint32_t NUM_AC_COEFFS_PER_BLOCK = 12;
+static constexpr int16_t QUANTIZATION_SCALE = 4;
+
+static std::vector<uint16_t>   gMacroBlockWords;
+static MacroBlockDecoder::Coeffs gMacroBlockCoeffs;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: writes bits most significant first to a stream of 16-bit little endian words
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct BitWriter {
+    std::vector<uint16_t>&  words;
+    uint32_t                bitBuffer;
+    uint32_t                numBufferedBits;
+
+    BitWriter(std::vector<uint16_t>& words) noexcept : words(words), bitBuffer(0), numBufferedBits(0) {}
+
+    void write(const uint32_t bits, const uint32_t numBits) noexcept {
+        for (int32_t bitIdx = (int32_t) numBits - 1; bitIdx >= 0; --bitIdx) {
+            bitBuffer = (bitBuffer << 1) | ((bits >> bitIdx) & 1);
+            numBufferedBits++;
+
+            if (numBufferedBits == 16) {
+                words.push_back(Endian::hostToLittle((uint16_t) bitBuffer));
+                bitBuffer = 0;
+                numBufferedBits = 0;
+            }
+        }
+    }
+
+    void flush() noexcept {
+        if (numBufferedBits > 0) {
+            write(0, 16 - numBufferedBits);
+        }
+    }
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Generates the macroblock bitstream and the coefficients read from it, if not already done.
+// Each block is a random 10-bit DC coefficient followed by AC coefficients of +/- 1 ('11s' codes) and the end of block code ('10').
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void generateMacroBlockIfRequired() noexcept {
+    if (!gMacroBlockWords.empty())
+        return;
+
+    Bench::Random random;
+    BitWriter writer(gMacroBlockWords);
+
+    for (uint32_t blockIdx = 0; blockIdx < 6; ++blockIdx) {
+        writer.write(random.next() & 0x3FF, 10);
+
+        for (uint32_t coeffIdx = 0; coeffIdx < NUM_AC_COEFFS_PER_BLOCK; ++coeffIdx) {
+            writer.write(0b110 | (random.next() & 1), 3);
+        }
+
+        writer.write(0b10, 2);
+    }
+
+    writer.flush();
+
+    MBlockBitStream bitStream;
+    bitStream.open(gMacroBlockWords.data(), (uint32_t) gMacroBlockWords.size());
+    [[maybe_unused]] const bool bReadOk = MacroBlockDecoder::readCoeffs(bitStream, gMacroBlockCoeffs);
+    ASSERT(bReadOk);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Benchmark kernels: read and decode a macroblock from a bitstream, or just decode the already read coefficients
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void benchDecode(const uint64_t numIters) noexcept {
+    generateMacroBlockIfRequired();
+    uint32_t pixels[MacroBlockDecoder::PIXELS_H][MacroBlockDecoder::PIXELS_W];
+    MBlockBitStream bitStream;
+
+    for (uint64_t i = 0; i < numIters; ++i) {
+        bitStream.open(gMacroBlockWords.data(), (uint32_t) gMacroBlockWords.size());
+        MacroBlockDecoder::decode(bitStream, QUANTIZATION_SCALE, pixels);
+    }
+
+    Bench::consume(pixels[7][7]);
+}
+
+static void benchDecodeCoeffs(const uint64_t numIters) noexcept {
+    generateMacroBlockIfRequired();
+    uint32_t pixels[MacroBlockDecoder::PIXELS_H][MacroBlockDecoder::PIXELS_W];
+
+    for (uint64_t i = 0; i < numIters; ++i) {
+        // Note: decoding transforms the coefficients in-place, hence a fresh copy is needed each time
+        MacroBlockDecoder::Coeffs coeffs = gMacroBlockCoeffs;
+        MacroBlockDecoder::decodeCoeffs(coeffs, QUANTIZATION_SCALE, pixels);
+    }
+
+    Bench::consume(pixels[7][7]);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Registers the benchmarks
+//------------------------------------------------------------------------------------------------------------------------------------------
+void registerMovieBenchmarks() noexcept {
+    Bench::add("MacroBlockDecoder::decode", benchDecode);
+    Bench::add("MacroBlockDecoder::decodeCoeffs", benchDecodeCoeffs);
+}
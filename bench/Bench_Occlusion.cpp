@@ -0,0 +1,91 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Benchmarks for the Vulkan renderer's horizontal occlusion checks, which are done for every seg and subsector during BSP traversal.
+// Each iteration simulates a frame: the occlusion state is cleared and then a batch of random seg ranges are tested and occluded.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#if PSYDOOM_VULKAN_RENDERER
+
+#include "Bench.h"
+#include "BenchKernels.h"
+
+#include "Doom/RendererVk/rv_main.h"
+#include "Doom/RendererVk/rv_occlusion.h"
+
+// The occlusion module reads the view projection matrix to figure out the direction of the NDC y axis.
+// This is normally defined by the Vulkan renderer's main module but the benchmarks provide their own, since they don't include that module.
+Matrix4f gViewProjMatrix;
+
+// How many seg ranges are processed per frame
+static constexpr uint32_t NUM_RANGES = 512;
+
+static float    gRangesMin[NUM_RANGES];
+static float    gRangesMax[NUM_RANGES];
+static bool     gbRangesGenerated;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Generates the random seg ranges if not already done.
+// Most segs are narrow on screen; a few are wide, and some are partially or fully offscreen.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void generateRangesIfRequired() noexcept {
+    if (gbRangesGenerated)
+        return;
+
+    Bench::Random random;
+
+    for (uint32_t i = 0; i < NUM_RANGES; ++i) {
+        const float xMin = (float) random.range(-1100, 1000) / 1000.0f;
+        const float width = ((random.next() % 8) == 0) ? (float) random.range(100, 800) / 1000.0f : (float) random.range(2, 60) / 1000.0f;
+        gRangesMin[i] = xMin;
+        gRangesMax[i] = xMin + width;
+    }
+
+    gbRangesGenerated = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Benchmark kernels: occluding ranges only, and testing the visibility of ranges before occluding them (as BSP traversal does)
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void benchOccludeRange(const uint64_t numIters) noexcept {
+    generateRangesIfRequired();
+
+    for (uint64_t i = 0; i < numIters; ++i) {
+        RV_ClearOcclussion(false);
+
+        for (uint32_t j = 0; j < NUM_RANGES; ++j) {
+            RV_OccludeRange(gRangesMin[j], gRangesMax[j]);
+        }
+    }
+
+    Bench::consume(RV_IsRangeVisible(-1.0f, +1.0f));
+}
+
+static void benchIsRangeVisibleAndOcclude(const uint64_t numIters) noexcept {
+    generateRangesIfRequired();
+    uint32_t numVisible = 0;
+
+    for (uint64_t i = 0; i < numIters; ++i) {
+        RV_ClearOcclussion(false);
+
+        for (uint32_t j = 0; j < NUM_RANGES; ++j) {
+            if (RV_IsRangeVisible(gRangesMin[j], gRangesMax[j])) {
+                numVisible++;
+
+                // Only some segs are solid walls which occlude
+                if ((j & 3) == 0) {
+                    RV_OccludeRange(gRangesMin[j], gRangesMax[j]);
+                }
+            }
+        }
+    }
+
+    Bench::consume(numVisible);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Registers the benchmarks
+//------------------------------------------------------------------------------------------------------------------------------------------
+void registerOcclusionBenchmarks() noexcept {
+    Bench::add("RV_OccludeRange/512 ranges", benchOccludeRange);
+    Bench::add("RV_IsRangeVisible+RV_OccludeRange/512 ranges", benchIsRangeVisibleAndOcclude);
+}
+
+#endif  // #if PSYDOOM_VULKAN_RENDERER
@@ -0,0 +1,137 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Benchmarks for the SPU: mixes audio with varying numbers of voices playing a looped sound.
+// The SPU is setup the same way the game sets it up (voice count, ADPCM cache) so the numbers are representative.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include "BenchKernels.h"
+
+#include "Spu.h"
+
+using namespace Spu;
+
+static Core gCore;
+static bool gbCoreInitialized;
+
+// SPU setup and the looped sound played by all voices
+static constexpr uint32_t SPU_RAM_SIZE = 512 * 1024;
+static constexpr uint32_t SPU_VOICE_COUNT = 64;
+static constexpr uint32_t SPU_ADPCM_CACHE_SIZE = 8192;
+static constexpr uint32_t SOUND_ADDR8 = 0x200;              // Start address of the sound (in 8 byte units)
+static constexpr uint32_t SOUND_NUM_ADPCM_BLOCKS = 256;     // Length of the sound: 256 blocks is ~0.1 seconds at 44.1 KHz
+
+// How many samples are generated per iteration of the block benchmarks: 512 is roughly the size of an audio callback buffer
+static constexpr uint32_t BLOCK_NUM_SAMPLES = 512;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initializes the SPU core used for benchmarking if not already done.
+// Writes a looped sound made up of random ADPCM data into SPU RAM.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void initCoreIfRequired() noexcept {
+    if (gbCoreInitialized)
+        return;
+
+    initCore(gCore, SPU_RAM_SIZE, SPU_VOICE_COUNT);
+    setAdpcmCacheSize(gCore, SPU_ADPCM_CACHE_SIZE);
+
+    Bench::Random random;
+    std::byte* const pSound = gCore.pRam + (size_t) SOUND_ADDR8 * 8;
+
+    for (uint32_t blockIdx = 0; blockIdx < SOUND_NUM_ADPCM_BLOCKS; ++blockIdx) {
+        std::byte* const pBlock = pSound + (size_t) blockIdx * ADPCM_BLOCK_SIZE;
+
+        const uint8_t shift = (uint8_t)(4 + random.next() % 8);
+        const uint8_t filter = (uint8_t)(random.next() % 5);
+        uint8_t flags = 0;
+
+        if (blockIdx == 0) {
+            flags |= ADPCM_FLAG_LOOP_START;
+        }
+
+        if (blockIdx + 1 == SOUND_NUM_ADPCM_BLOCKS) {
+            flags |= ADPCM_FLAG_LOOP_END | ADPCM_FLAG_REPEAT;
+        }
+
+        pBlock[0] = (std::byte)((filter << 4) | shift);
+        pBlock[1] = (std::byte) flags;
+
+        for (int32_t i = 2; i < ADPCM_BLOCK_SIZE; ++i) {
+            pBlock[i] = (std::byte) random.next();
+        }
+    }
+
+    gCore.masterVol = { 0x3FFF, 0x3FFF };
+    gCore.bUnmute = true;
+    gbCoreInitialized = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Keys on the specified number of voices (and turns off the rest) to play the benchmark sound at various pitches.
+// If requested reverb is also enabled for the voices.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void setupVoices(const uint32_t numVoicesOn, const bool bReverb) noexcept {
+    initCoreIfRequired();
+
+    for (uint32_t voiceIdx = 0; voiceIdx < gCore.numVoices; ++voiceIdx) {
+        Voice& voice = gCore.pVoices[voiceIdx];
+
+        if (voiceIdx < numVoicesOn) {
+            voice.adpcmStartAddr8 = SOUND_ADDR8;
+            voice.sampleRate = (uint16_t)(0x800 + voiceIdx * 0x40);     // Vary the pitch so that the voices are not in lockstep
+            voice.volume = { 0x1FFF, 0x1FFF };
+            voice.env = {};
+            voice.env.sustainLevel = 15;
+            voice.env.sustainShift = 31;
+            voice.bDisabled = false;
+            voice.bDoReverb = bReverb;
+            keyOn(gCore, voiceIdx);
+        } else {
+            voice.envPhase = EnvPhase::Off;
+        }
+    }
+
+    gCore.reverbVol = (bReverb) ? Volume{ 0x1FFF, 0x1FFF } : Volume{};
+    gCore.bReverbWriteEnable = bReverb;
+    gCore.reverbBaseAddr8 = (SPU_RAM_SIZE - 64 * 1024) / 8;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Benchmark kernels: generate audio samples one at a time or in blocks with the specified number of voices playing
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <uint32_t NumVoices>
+static void benchStepCore(const uint64_t numIters) noexcept {
+    setupVoices(NumVoices, false);
+    float sum = 0.0f;
+
+    for (uint64_t i = 0; i < numIters; ++i) {
+        const StereoSample sample = stepCore(gCore);
+        sum += (float) sample.left + (float) sample.right;
+    }
+
+    Bench::consume((uint32_t)(int32_t) sum);
+}
+
+template <uint32_t NumVoices, bool bReverb>
+static void benchStepCoreBlock(const uint64_t numIters) noexcept {
+    setupVoices(NumVoices, bReverb);
+    StereoSample samples[BLOCK_NUM_SAMPLES];
+
+    for (uint64_t i = 0; i < numIters; ++i) {
+        stepCoreBlock(gCore, samples, BLOCK_NUM_SAMPLES);
+    }
+
+    Bench::consume((uint32_t)(int32_t)((float) samples[0].left + (float) samples[BLOCK_NUM_SAMPLES - 1].right));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Registers the benchmarks
+//------------------------------------------------------------------------------------------------------------------------------------------
+void registerSpuBenchmarks() noexcept {
+    Bench::add("Spu::stepCore/0 voices", benchStepCore<0>);
+    Bench::add("Spu::stepCore/8 voices", benchStepCore<8>);
+    Bench::add("Spu::stepCore/24 voices", benchStepCore<24>);
+    Bench::add("Spu::stepCoreBlock/512 samples/0 voices", benchStepCoreBlock<0, false>);
+    Bench::add("Spu::stepCoreBlock/512 samples/8 voices", benchStepCoreBlock<8, false>);
+    Bench::add("Spu::stepCoreBlock/512 samples/24 voices", benchStepCoreBlock<24, false>);
+    Bench::add("Spu::stepCoreBlock/512 samples/64 voices", benchStepCoreBlock<64, false>);
+    Bench::add("Spu::stepCoreBlock/512 samples/24 voices + reverb", benchStepCoreBlock<24, true>);
+}
@@ -0,0 +1,102 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Benchmarks for WAD lump decompression.
+// A synthetic compressed lump is generated with a mix of literal bytes and back references, similar in ratio to compressed map lumps.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include "BenchKernels.h"
+
+#include "PsyDoom/WadUtils.h"
+
+#include <algorithm>
+#include <vector>
+
+// Roughly how big the decompressed lump is
+static constexpr uint32_t TARGET_DECOMPRESSED_SIZE = 64 * 1024;
+
+static std::vector<uint8_t>    gCompressedLump;
+static std::vector<uint8_t>    gDecompressedLump;
+static int32_t                 gDecompressedSize;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Generates the compressed lump to benchmark with, if not already done.
+// Rather than compressing data, the compressed stream is generated directly by picking random literals and back references.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void generateLumpIfRequired() noexcept {
+    if (!gCompressedLump.empty())
+        return;
+
+    Bench::Random random;
+    uint32_t decompressedSize = 0;
+
+    while (true) {
+        // Each id byte is followed by 8 items: a bit of '1' in the id byte means a back reference, '0' means a literal byte
+        const size_t idByteIdx = gCompressedLump.size();
+        gCompressedLump.push_back(0);
+
+        for (uint32_t itemIdx = 0; itemIdx < 8; ++itemIdx) {
+            // Is it time to end the stream? If so add the end marker, which is a back reference with a length of '1'.
+            if (decompressedSize >= TARGET_DECOMPRESSED_SIZE) {
+                gCompressedLump[idByteIdx] |= (uint8_t)(1u << itemIdx);
+                gCompressedLump.push_back(0);
+                gCompressedLump.push_back(0);
+                gDecompressedSize = (int32_t) decompressedSize;
+                gDecompressedLump.resize(decompressedSize + 64);
+                return;
+            }
+
+            // Use a back reference around half of the time, once there is enough data to reference
+            if ((decompressedSize >= 16) && (random.next() & 1)) {
+                const uint32_t maxOffset = std::min<uint32_t>(decompressedSize, 4096);
+                const uint32_t offset = 1 + random.next() % maxOffset;
+                const uint32_t length = 2 + random.next() % 15;
+                const uint32_t offsetBits = offset - 1;
+                const uint32_t lengthBits = length - 1;
+
+                gCompressedLump[idByteIdx] |= (uint8_t)(1u << itemIdx);
+                gCompressedLump.push_back((uint8_t)(offsetBits >> 4));
+                gCompressedLump.push_back((uint8_t)(((offsetBits & 0xF) << 4) | lengthBits));
+                decompressedSize += length;
+            } else {
+                gCompressedLump.push_back((uint8_t) random.next());
+                decompressedSize++;
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Benchmark kernels: decompress the lump with and without bounds checking
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void benchDecompressLump(const uint64_t numIters) noexcept {
+    generateLumpIfRequired();
+
+    for (uint64_t i = 0; i < numIters; ++i) {
+        WadUtils::decompressLump(gCompressedLump.data(), gDecompressedLump.data());
+    }
+
+    Bench::consume(gDecompressedLump[(size_t) gDecompressedSize - 1]);
+}
+
+static void benchDecompressLumpSafe(const uint64_t numIters) noexcept {
+    generateLumpIfRequired();
+    uint32_t numSucceeded = 0;
+
+    for (uint64_t i = 0; i < numIters; ++i) {
+        numSucceeded += WadUtils::decompressLumpSafe(
+            gCompressedLump.data(),
+            (int32_t) gCompressedLump.size(),
+            gDecompressedLump.data(),
+            (int32_t) gDecompressedLump.size()
+        );
+    }
+
+    Bench::consume(numSucceeded);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Registers the benchmarks
+//------------------------------------------------------------------------------------------------------------------------------------------
+void registerWadBenchmarks() noexcept {
+    Bench::add("WadUtils::decompressLump/64 KiB", benchDecompressLump);
+    Bench::add("WadUtils::decompressLumpSafe/64 KiB", benchDecompressLumpSafe);
+}
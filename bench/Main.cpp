@@ -0,0 +1,41 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoomBench:
+//      Microbenchmarks for engine hot paths (software GPU, SPU mixing, lump decompression, movie decoding, math and occlusion).
+//      Usage: PsyDoomBench [-list] [NAME_FILTER]
+//      Only benchmarks whose name contains 'NAME_FILTER' are run, if it is given.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Bench.h"
+#include "BenchKernels.h"
+
+#include <cstdio>
+#include <cstring>
+
+int main(const int argc, const char* const* const argv) noexcept {
+    registerGpuBenchmarks();
+    registerSpuBenchmarks();
+    registerWadBenchmarks();
+    registerMovieBenchmarks();
+    registerMathBenchmarks();
+
+    #if PSYDOOM_VULKAN_RENDERER
+        registerOcclusionBenchmarks();
+    #endif
+
+    const char* nameFilter = nullptr;
+
+    for (int argIdx = 1; argIdx < argc; ++argIdx) {
+        if (std::strcmp(argv[argIdx], "-list") == 0) {
+            Bench::list();
+            return 0;
+        }
+
+        nameFilter = argv[argIdx];
+    }
+
+    if (Bench::run(nameFilter) == 0) {
+        std::printf("No benchmarks match the filter '%s'!\n", nameFilter);
+        return 1;
+    }
+
+    return 0;
+}
@@ -43,6 +43,10 @@ inline void I_AddPrim(const FLOORROW_FT& row) noexcept {
     LIBGPU_CmdDispatch::submit(row);
 }
 
+inline void I_AddPrims(const FLOORROW_FT* const pRows, const uint32_t numRows) noexcept {
+    LIBGPU_CmdDispatch::submit(pRows, numRows);
+}
+
 inline void I_AddPrim(const WALLCOL_GT& col) noexcept {
     LIBGPU_CmdDispatch::submit(col);
 }
@@ -12,8 +12,10 @@
 #include "FatalErrors.h"
 #include "i_drawcmds.h"
 #include "i_texcache.h"
+#include "m_random.h"
 #include "PsyDoom/Controls.h"
 #include "PsyDoom/DemoPlayer.h"
+#include "PsyDoom/FrameStats.h"
 #include "PsyDoom/Game.h"
 #include "PsyDoom/Input.h"
 #include "PsyDoom/MapHash.h"
@@ -22,6 +24,7 @@
 #include "PsyDoom/ProgArgs.h"
 #include "PsyDoom/PsxPadButtons.h"
 #include "PsyDoom/PsxVm.h"
+#include "PsyDoom/TimeDemo.h"
 #include "PsyDoom/Utils.h"
 #include "PsyDoom/Video.h"
 #include "PsyDoom/Vulkan/VDrawing.h"
@@ -41,6 +44,8 @@
 // Used for measuring the total vblanks elapsed since app start
 #if PSYDOOM_MODS
     static std::chrono::steady_clock::time_point gAppStartTime;
+
+    static std::chrono::steady_clock::time_point I_GetTotalVBlanksTimepoint(const int32_t totalVBlanks) noexcept;
 #endif
 
 // Video vblank timers: track the total amount, last total and current elapsed amount
@@ -123,7 +128,7 @@ texture_t gTex_CONNECT;
 
     // The current network protocol version.
     // Should be incremented whenever the data format being transmitted changes, or when updates might cause differences in game behavior.
-    static constexpr int32_t NET_PROTOCOL_VERSION = 32;
+    static constexpr int32_t NET_PROTOCOL_VERSION = 33;
 
     // Previous game error checking value when we last sent to the other player.
     // Have to store this because we always send 1 packet ahead for the next frame.
@@ -607,6 +612,12 @@ void I_IncDrawnFrameCount() noexcept {
 // Also does framerate limiting to 30 Hz and updates the elapsed vblank count, which feeds the game's timing system.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void I_DrawPresent() noexcept {
+    // PsyDoom: time presentation if running a timedemo benchmark and for the frame time stats
+    #if PSYDOOM_MODS
+        TimeDemo::SectionTimer sectionTimer(TimeDemo::Section::DrawPresent);
+        FrameStats::SplitTimer splitTimer(FrameStats::Split::Present);
+    #endif
+
     // Finish up all in-flight drawing commands
     LIBGPU_DrawSync(0);
 
@@ -631,6 +642,18 @@ void I_DrawPresent() noexcept {
         const int32_t demoTickVBlanks = VBLANKS_PER_TIC;
     #endif
 
+    // PsyDoom: if running a timedemo benchmark then don't wait for any vblanks, just advance time by one demo tick.
+    // This is the same as what happens in headless mode, but with rendering still being done.
+    // Headless mode with rendering (but no display) also never waits, since no frames are being shown.
+    #if PSYDOOM_MODS
+        if (TimeDemo::gbIsTiming || ProgArgs::gbHeadlessMode) {
+            gTotalVBlanks = gLastTotalVBlanks + demoTickVBlanks;
+            gLastTotalVBlanks = gTotalVBlanks;
+            gElapsedVBlanks = demoTickVBlanks;
+            return;
+        }
+    #endif
+
     // Continously poll and wait until the required number of vblanks have elapsed before continuing
     while (true) {
         // PsyDoom: use 'I_GetTotalVBlanks' because it can adjust time in networked games
@@ -671,10 +694,10 @@ void I_DrawPresent() noexcept {
         if (gElapsedVBlanks >= 2)
             break;
 
-        // PsyDoom: do platform updates (sound, window etc.) and yield some cpu since we are waiting for a bit
+        // PsyDoom: do platform updates (sound, window etc.) and sleep until the next vblank since we are waiting for a bit
         #if PSYDOOM_MODS
             Utils::doPlatformUpdates();
-            Utils::threadYield();
+            Utils::sleepUntil(I_GetTotalVBlanksTimepoint(curVBlanks + 1));
         #endif
     }
 
@@ -683,10 +706,10 @@ void I_DrawPresent() noexcept {
     // Probably done so the simulation remains consistent!
     if (Game::gSettings.bUseDemoTimings) {
         while (gElapsedVBlanks < (uint32_t) demoTickVBlanks) {
-            // PsyDoom: do platform updates (sound, window etc.) and yield some cpu since we are waiting for a bit
+            // PsyDoom: do platform updates (sound, window etc.) and sleep until the next vblank since we are waiting for a bit
             #if PSYDOOM_MODS
                 Utils::doPlatformUpdates();
-                Utils::threadYield();
+                Utils::sleepUntil(I_GetTotalVBlanksTimepoint(gTotalVBlanks + 1));
             #endif
 
             // PsyDoom: use 'I_GetTotalVBlanks' because it can adjust time in networked games
@@ -867,13 +890,23 @@ bool I_NetUpdate() noexcept {
 
     if (bInGame) {
         for (int32_t i = 0; i < MAXPLAYERS; ++i) {
-            mobj_t& mobj = *gPlayers[i].mo;
+            const player_t& player = gPlayers[i];
+            mobj_t& mobj = *player.mo;
             errorCheck ^= mobj.x;
             errorCheck ^= mobj.y;
             errorCheck ^= mobj.z;
             errorCheck ^= mobj.angle;
             errorCheck ^= (uint32_t) MapHash::gWord1;   // Check both players are playing the same map
+
+            // PsyDoom: also fold in health and armor, shifted so they don't cancel against each other or the position bits.
+            // These diverge as soon as damage or pickups differ between the peers, even when positions still happen to match.
+            errorCheck ^= ((uint32_t) mobj.health << 8) ^ ((uint32_t) player.armorpoints << 20);
         }
+
+        // PsyDoom: fold in the gameplay random number index also.
+        // Almost any simulation divergence (monster AI, damage rolls, specials) consumes a different amount of random numbers,
+        // so this catches desyncs long before they become visible in player positions.
+        errorCheck ^= gPRndIndex << 24;
     }
 
     // If it's the very first network update for this session send a dummy packet with no inputs to the other player.
@@ -1080,4 +1113,13 @@ time_point_t I_GetVBlankTimepoint(const int32_t vblankIdx) noexcept {
         return gAppStartTime + std::chrono::nanoseconds((int64_t)((double) vblankIdx * nanosPerVblank));
     }
 }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: gets the absolute time at which 'I_GetTotalVBlanks' will return the specified vblank count.
+// Unlike 'I_GetVBlankTimepoint' this takes into account the current time adjustment in networked games.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static time_point_t I_GetTotalVBlanksTimepoint(const int32_t totalVBlanks) noexcept {
+    const duration_t netTimeAdjust = std::chrono::milliseconds((gNetGame != gt_single) ? gNetTimeAdjustMs : 0);
+    return I_GetVBlankTimepoint(totalVBlanks) - netTimeAdjust;
+}
 #endif  // #if PSYDOOM_MODS
@@ -55,6 +55,8 @@
 #include "i_drawcmds.h"
 #include "i_main.h"
 #include "PsyDoom/Config/Config.h"
+#include "PsyDoom/DecodedTexPool.h"
+#include "PsyDoom/Profiler.h"
 #include "PsyDoom/PsxVm.h"
 #include "PsyDoom/TexturePatcher.h"
 #include "PsyDoom/Video.h"
@@ -68,6 +70,7 @@
 #include <algorithm>
 #include <cmath>
 #include <cstdio>
+#include <cstring>
 #include <vector>
 
 #if PSYDOOM_MODS
@@ -82,6 +85,22 @@ struct tcachepage_t {
     uint16_t    vramX;
     uint16_t    vramY;
     texture_t*  cells[TCACHE_CELLS_Y][TCACHE_CELLS_X];
+
+    // Limit removing: a summary of texture sizes (in cells) which are known to not fit anywhere on this page.
+    // For each texture height, this is the minimum texture width found to not fit with that height or less.
+    // The summary is only valid for the frame number and free space generation ('gTCacheFreeSpaceGen') it was recorded with.
+    // This allows pages which are full for the current frame to be skipped over quickly when searching for room.
+    #if PSYDOOM_LIMIT_REMOVING
+        uint32_t    noFitFrameNum;
+        uint32_t    noFitFreeSpaceGen;
+        uint8_t     noFitMinW16[TCACHE_CELLS_Y + 1];
+    #endif
+
+    // Limit removing: the last frame number that a texture on this page was used in.
+    // Used by the least recently used eviction policy to decide which pages to try and place textures on first.
+    #if PSYDOOM_LIMIT_REMOVING
+        uint32_t    lastUseFrameNum;
+    #endif
 };
 
 // All of the texture pages available to use
@@ -111,10 +130,80 @@ static uint32_t gTCacheFillCellY;
     static bool gbAllowLoosePacking = false;
 #endif
 
+// Limit removing: incremented whenever textures which could not be evicted (locked or used in the current frame) are removed or unlocked.
+// When this happens space might be freed up in the cache which invalidates the knowledge of which textures do not fit on which pages.
+#if PSYDOOM_LIMIT_REMOVING
+    static uint32_t gTCacheFreeSpaceGen;
+#endif
+
+// Limit removing: scratch list of texture page indexes sorted in least recently used order
+#if PSYDOOM_LIMIT_REMOVING
+    static std::vector<uint32_t> gTCachePageLruOrder;
+#endif
+
 // Current row height (in cells) when using the 'loose' texture packing mode.
 // If loose packing is used, when we reach the end of the current texture cache row we skip past this height and don't try to fill in any gaps.
 static uint32_t gTCacheLoosePackRowH;
 
+// Texture cache activity totals, and the number of candidate fill locations checked so far by the current 'I_CacheTex' call
+texcachestats_t gTexCacheStats;
+static uint32_t gTCacheSearchLen;
+
+static void TC_RemoveTexCacheEntry(texture_t& tex) noexcept;
+
+#if PSYDOOM_LIMIT_REMOVING
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Limit removing: get the texture cache page that the given cached texture resides on.
+// Assumes the texture has valid cache entries.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static tcachepage_t& TC_GetTexCachePage(const texture_t& tex) noexcept {
+    ASSERT(tex.ppTexCacheEntries);
+    const uintptr_t pageOffset = (uintptr_t) tex.ppTexCacheEntries - (uintptr_t) gTCachePages.data();
+    const size_t pageIdx = pageOffset / sizeof(tcachepage_t);
+    ASSERT(pageIdx < gTCachePages.size());
+    return gTCachePages[pageIdx];
+}
+#endif
+
+#if PSYDOOM_LIMIT_REMOVING
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Clears the summary of which texture sizes are known to not fit on the given page if it is out of date
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void TC_UpdatePageNoFitSummary(tcachepage_t& texPage) noexcept {
+    if ((texPage.noFitFrameNum != gNumFramesDrawn) || (texPage.noFitFreeSpaceGen != gTCacheFreeSpaceGen)) {
+        texPage.noFitFrameNum = gNumFramesDrawn;
+        texPage.noFitFreeSpaceGen = gTCacheFreeSpaceGen;
+        std::memset(texPage.noFitMinW16, UINT8_MAX, sizeof(texPage.noFitMinW16));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the given texture is known to not fit anywhere on the given page for the current frame.
+// This is the case if a texture which is no larger in either dimension was previously found to not fit.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool TC_IsKnownNoFitOnPage(tcachepage_t& texPage, const texture_t& tex) noexcept {
+    TC_UpdatePageNoFitSummary(texPage);
+    return (tex.width16 >= texPage.noFitMinW16[tex.height16]);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records that the given texture does not fit anywhere on the given page for the current frame.
+// Should only be called after an exhaustive search of the page: i.e a tight packing search starting from the beginning of the page.
+//
+// Note: this works because space on the page can only be freed up during the frame by removing or unlocking textures which cannot be
+// evicted, and doing that increments 'gTCacheFreeSpaceGen'. All other textures encountered during the search are evicted if they block
+// the texture from being placed, so the only things which prevent the texture from fitting are textures which cannot be evicted.
+// If the texture cannot fit then any texture at least as wide and high also cannot fit.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void TC_RecordNoFitOnPage(tcachepage_t& texPage, const texture_t& tex) noexcept {
+    TC_UpdatePageNoFitSummary(texPage);
+
+    for (uint32_t h16 = tex.height16; h16 <= TCACHE_CELLS_Y; ++h16) {
+        texPage.noFitMinW16[h16] = (uint8_t) std::min<uint32_t>(texPage.noFitMinW16[h16], tex.width16);
+    }
+}
+#endif  // #if PSYDOOM_LIMIT_REMOVING
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Checks to see if the texture can be placed on the given page at the current fill location.
 // Returns 'false' if this action is not possible due to other textures that are currently occupying the cells.
@@ -131,6 +220,7 @@ static bool TC_PrepFillLocationCells(tcachepage_t& texPage, const texture_t& tex
 
     ASSERT(xEnd <= TCACHE_CELLS_X);
     ASSERT(yEnd <= TCACHE_CELLS_Y);
+    gTCacheSearchLen++;
 
     // Check all of the cells to see if there is anything blocking placing this texture here
     for (uint16_t y = yBeg; y < yEnd; ++y) {
@@ -152,7 +242,12 @@ static bool TC_PrepFillLocationCells(tcachepage_t& texPage, const texture_t& tex
             const bool bCantEvictTex = ((pOccupyTex->uploadFrameNum == gNumFramesDrawn) || bIsOccupyTexLocked);
             
             if (bCantEvictTex) {
-                gTCacheFillCellX += pOccupyTex->width16;
+                // PsyDoom: skip to the right edge of the texture rather than by the texture width from the current fill location.
+                // Skipping by the texture width can jump past valid fill locations if the texture begins to the left of the fill location.
+                // Note: the texture must overlap the current fill location, so this always moves forward by at least 1 cell.
+                const uint32_t occupyBegCellX = pOccupyTex->texPageCoordX / TCACHE_CELL_SIZE;
+                ASSERT(occupyBegCellX + pOccupyTex->width16 > gTCacheFillCellX);
+                gTCacheFillCellX = occupyBegCellX + pOccupyTex->width16;
 
                 // Adjust the current loose packing row height to account for the texture we encountered.
                 // If we are using loose packing we want to skip past the rows that this texture lies on.
@@ -166,7 +261,8 @@ static bool TC_PrepFillLocationCells(tcachepage_t& texPage, const texture_t& tex
             }
 
             // The cell is not empty but we can evict the texture, do that now:
-            I_RemoveTexCacheEntry(*pOccupyTex);
+            TC_RemoveTexCacheEntry(*pOccupyTex);
+            gTexCacheStats.numEvictions++;
         }
     }
 
@@ -213,6 +309,79 @@ static bool TC_MoveToPageFillLocation(const texture_t& tex, const bool bLoosePac
     return false;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to move to a valid fill location for the specified texture in the current texture page, if the page is not locked.
+// Returns 'false' on failure to find a valid fill location.
+// May evict stale textures (not for the current frame) along the way.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool TC_TryMoveToPageFillLocation(const texture_t& tex, const bool bLoosePack) noexcept {
+    // In non limit removing builds the entire page can be locked too (classic VRAM management technique)
+    #if !PSYDOOM_LIMIT_REMOVING
+        if (gTCachePages[gTCacheFillPage].bIsLocked)
+            return false;
+    #endif
+
+    // Limit removing: skip the search if the texture is already known to not fit on the page, and remember if the search finds
+    // that the texture doesn't fit. This only applies to tight packing since loose packing does not consider all fill locations.
+    #if PSYDOOM_LIMIT_REMOVING
+        tcachepage_t& texPage = gTCachePages[gTCacheFillPage];
+        const bool bIsExhaustiveSearch = ((!bLoosePack) && (gTCacheFillCellX == 0) && (gTCacheFillCellY == 0));
+
+        if ((!bLoosePack) && TC_IsKnownNoFitOnPage(texPage, tex))
+            return false;
+    #endif
+
+    if (TC_MoveToPageFillLocation(tex, bLoosePack))
+        return true;
+
+    #if PSYDOOM_LIMIT_REMOVING
+        if (bIsExhaustiveSearch) {
+            TC_RecordNoFitOnPage(texPage, tex);
+        }
+    #endif
+
+    return false;
+}
+
+#if PSYDOOM_LIMIT_REMOVING
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Limit removing: tries to find a fill location for the specified texture, trying texture pages in least recently used order.
+// Pages which have not been used for the longest time are tried first, so the textures evicted to make room are likely to be stale ones.
+// The current fill location is not tried first, since it is expected that this has already been done.
+// Returns 'false' on failure to find a valid fill location.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool TC_MoveToLruFillLocation(const texture_t& tex) noexcept {
+    // Sort the pages in least recently used order.
+    // If pages were last used in the same frame then prefer the page which comes soonest after the current page (wrapping around).
+    const uint32_t numTCachePages = (uint32_t) gTCachePages.size();
+    const uint32_t startPageIdx = gTCacheFillPage + 1;
+
+    gTCachePageLruOrder.resize(numTCachePages);
+
+    for (uint32_t i = 0; i < numTCachePages; ++i) {
+        gTCachePageLruOrder[i] = (startPageIdx + i) % numTCachePages;
+    }
+
+    std::stable_sort(
+        gTCachePageLruOrder.begin(),
+        gTCachePageLruOrder.end(),
+        [](const uint32_t pageIdx1, const uint32_t pageIdx2) noexcept {
+            return (gTCachePages[pageIdx1].lastUseFrameNum < gTCachePages[pageIdx2].lastUseFrameNum);
+        }
+    );
+
+    // Try each page in order using tight packing
+    for (const uint32_t pageIdx : gTCachePageLruOrder) {
+        I_SetTexCacheFillPage(pageIdx);
+
+        if (TC_TryMoveToPageFillLocation(tex, false))
+            return true;
+    }
+
+    return false;
+}
+#endif  // #if PSYDOOM_LIMIT_REMOVING
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Moves to a fill location in the texture cache where the specified texture can be placed.
 // Returns 'false' on failure to find such a location and issues a warning.
@@ -235,19 +404,23 @@ static bool TC_MoveToFillLocation(const texture_t& tex) noexcept {
         constexpr bool bUseLoosePacking = true;     // Always active in non limit removing builds
     #endif
 
-    for (uint32_t numAttempts = numTCachePages + 1; numAttempts != 0; --numAttempts) {
-        // In non limit removing builds the entire page can be locked too (classic VRAM management technique)
-        #if PSYDOOM_LIMIT_REMOVING
-            constexpr bool bPageLocked = false;
-        #else
-            const bool bPageLocked = gTCachePages[gTCacheFillPage].bIsLocked;
-        #endif
+    // Limit removing: if the least recently used eviction policy is enabled then try the current fill location first, followed by all
+    // pages in least recently used order. Otherwise move through the pages in order, wrapping around at the end.
+    #if PSYDOOM_LIMIT_REMOVING
+        const bool bUseLruEviction = Config::gbTexCacheLruEviction;
 
-        // Try move to a valid fill location in the current page (if not locked), otherwise try the next one
-        if (!bPageLocked) {
-            if (TC_MoveToPageFillLocation(tex, bUseLoosePacking))
+        if (bUseLruEviction) {
+            if (TC_TryMoveToPageFillLocation(tex, bUseLoosePacking) || TC_MoveToLruFillLocation(tex))
                 return true;
         }
+    #else
+        constexpr bool bUseLruEviction = false;
+    #endif
+
+    for (uint32_t numAttempts = (bUseLruEviction) ? 0 : numTCachePages + 1; numAttempts != 0; --numAttempts) {
+        // Try move to a valid fill location in the current page, otherwise try the next one
+        if (TC_TryMoveToPageFillLocation(tex, bUseLoosePacking))
+            return true;
 
         // Limit removing: use tight packing for subsequent texture pages
         #if PSYDOOM_LIMIT_REMOVING
@@ -262,6 +435,7 @@ static bool TC_MoveToFillLocation(const texture_t& tex) noexcept {
     // The original game crashed with a hard error, this way at least allows the player to continue and recover.
     gStatusBar.message = "W: Texture Cache Overflow!";
     gStatusBar.messageTicsLeft = 60;
+    gTexCacheStats.numOverflows++;
     return false;
 }
 
@@ -334,9 +508,18 @@ static void TC_FillCacheCells(tcachepage_t& texPage, texture_t& tex) noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Caches and decompresses the data for the specified texture and returns the pointer to the texture bytes and its size
+// Caches and decompresses the data for the specified texture and returns the pointer to the texture bytes and its size.
+// Also outputs whether the data is held in the decoded texture pool, in which case texture patches have already been applied.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static texdata_t TC_CacheTexData(const texture_t& tex) {
+static texdata_t TC_CacheTexData(const texture_t& tex, bool& bIsPooledTexDataOut) {
+    // If the texture is in the decoded texture pool then use that data, and there is no need to load or decompress the lump
+    if (std::byte* const pPooledTexBytes = (std::byte*) DecodedTexPool::findLumpData(tex.lumpNum)) {
+        bIsPooledTexDataOut = true;
+        return { pPooledTexBytes, (uint32_t) W_LumpLength(tex.lumpNum) };
+    }
+
+    bIsPooledTexDataOut = false;
+
     // Make sure the texture's lump is loaded and get the bytes
     const WadLump& texLump = W_CacheLumpNum(tex.lumpNum, PU_CACHE, false);
     std::byte* pTexBytes = (std::byte*) texLump.pCachedData;
@@ -346,9 +529,14 @@ static texdata_t TC_CacheTexData(const texture_t& tex) {
     const bool bIsTexCompressed = (!texLump.bIsUncompressed);
 
     if (bIsTexCompressed) {
-        // Compressed texture, must decompress to the temporary buffer first
+        // Compressed texture, must decompress to the decoded texture pool (if possible) or the temporary buffer first
         const uint32_t texSize = getDecodedSize(pTexBytes);
 
+        if (std::byte* const pPooledTexBytes = (std::byte*) DecodedTexPool::addLumpData(tex.lumpNum, pTexBytes, texSize)) {
+            bIsPooledTexDataOut = true;
+            return { pPooledTexBytes, texSize };
+        }
+
         #if PSYDOOM_LIMIT_REMOVING
             gTmpBuffer.ensureSize(texSize);
             decode(pTexBytes, gTmpBuffer.bytes());
@@ -402,6 +590,7 @@ static void TC_UploadTexToVram(texture_t& tex, const texdata_t& texData, const t
             );
 
             LIBGPU_LoadImage8(dstVramRect, texData.pBytes + sizeof(texlump_header_t));
+            gTexCacheStats.numBytesUploaded += (uint64_t)((tex.width + 1u) & ~1u) * tex.height;    // Padded to an even width
         #else
             SRECT dstVramRect;
             LIBGPU_setRECT(
@@ -413,7 +602,10 @@ static void TC_UploadTexToVram(texture_t& tex, const texdata_t& texData, const t
             );
 
             LIBGPU_LoadImage(dstVramRect, (uint16_t*)(texData.pBytes + sizeof(texlump_header_t)));
+            gTexCacheStats.numBytesUploaded += (uint64_t) dstVramRect.w * dstVramRect.h * sizeof(uint16_t);
         #endif
+
+        gTexCacheStats.numUploads++;
     }
     else {
         // Not enough data in the lump to load the texture, issue a warning.
@@ -467,6 +659,11 @@ void I_InitTexCache() noexcept {
             tcachepage_t& texPage = gTCachePages.emplace_back();
             texPage.vramX = vramX;
             texPage.vramY = vramY;
+
+            #if PSYDOOM_LIMIT_REMOVING
+                texPage.noFitFrameNum = TEX_INVALID_UPLOAD_FRAME_NUM;
+                texPage.lastUseFrameNum = 0;
+            #endif
         }
     }
 
@@ -499,6 +696,31 @@ uint32_t I_GetNumTexCachePages() noexcept {
     return (uint32_t) gTCachePages.size();
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Return how many texture cache pages have at least one texture in them.
+// Limit removing: the area of VRAM reserved for the PSX framebuffer and CLUTs does not count as a texture.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t I_GetNumTexCachePagesInUse() noexcept {
+    uint32_t numPagesInUse = 0;
+
+    for (const tcachepage_t& texPage : gTCachePages) {
+        const texture_t* const* const pCellsBeg = &texPage.cells[0][0];
+        const texture_t* const* const pCellsEnd = pCellsBeg + NUM_TCACHE_PAGE_CELLS;
+
+        const bool bPageInUse = std::any_of(pCellsBeg, pCellsEnd, [](const texture_t* const pTex) noexcept {
+            #if PSYDOOM_LIMIT_REMOVING
+                return (pTex && (pTex != &gReservedVramDummyTex));
+            #else
+                return (pTex != nullptr);
+            #endif
+        });
+
+        numPagesInUse += (bPageInUse) ? 1 : 0;
+    }
+
+    return numPagesInUse;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Get the current page being filled in the texture cache
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -539,6 +761,11 @@ void I_TexCacheUseLoosePacking(const bool bUseLoosePacking) noexcept {
 // If the textures are locked then they cannot be evicted from the cache.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void I_LockAllWallAndFloorTextures(const bool bLock) noexcept {
+    // Unlocking textures may free up space in the cache
+    if (!bLock) {
+        ++gTCacheFreeSpaceGen;
+    }
+
     texture_t* const pWallTextures = gpTextures;
     const int32_t numWallTextures = gNumTexLumps;
 
@@ -581,6 +808,18 @@ void I_UnlockAllTexCachePages() noexcept {
 // Note this should only be called if the texture is actually in the cache!
 //------------------------------------------------------------------------------------------------------------------------------------------
 void I_RemoveTexCacheEntry(texture_t& tex) noexcept {
+    // Limit removing: the texture might be one that could not be evicted, so this may free up space in the cache
+    #if PSYDOOM_LIMIT_REMOVING
+        ++gTCacheFreeSpaceGen;
+    #endif
+
+    TC_RemoveTexCacheEntry(tex);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Internal version of 'I_RemoveTexCacheEntry', used for evicting textures which are not locked and not used in the current frame
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void TC_RemoveTexCacheEntry(texture_t& tex) noexcept {
     // Sanity checks: make sure the texture has a valid texture cache entry and size
     ASSERT(tex.ppTexCacheEntries);
     ASSERT((tex.width16 > 0) && (tex.width16 <= TCACHE_CELLS_X));
@@ -611,26 +850,53 @@ void I_RemoveTexCacheEntry(texture_t& tex) noexcept {
 // If there's no more room for textures in VRAM for this frame then the game will die with an error.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void I_CacheTex(texture_t& tex) noexcept {
+    #if PSYDOOM_MODS
+        // PsyDoom: record this function in the profiler (compiles to nothing unless the profiler is enabled)
+        PROFILE_ZONE("I_CacheTex");
+    #endif
+
     // Update which frame the texture was added to the cache in, for tracking texture cache overflows
     tex.uploadFrameNum = gNumFramesDrawn;
 
-    // If the texture is already in the cache then there is nothing else to do
-    if (tex.bIsCached)
+    // If the texture is already in the cache then there is nothing else to do.
+    // Limit removing: also update when the texture page it's on was last used, for the least recently used eviction policy.
+    if (tex.bIsCached) {
+        #if PSYDOOM_LIMIT_REMOVING
+            if (tex.ppTexCacheEntries) {
+                TC_GetTexCachePage(tex).lastUseFrameNum = gNumFramesDrawn;
+            }
+        #endif
+
         return;
+    }
 
     // Load the texture data and update the dimensions of the texture from the data header
-    const texdata_t texData = TC_CacheTexData(tex);
+    bool bIsPooledTexData;
+    const texdata_t texData = TC_CacheTexData(tex, bIsPooledTexData);
     R_UpdateTexMetricsFromData(tex, texData.pBytes, (int32_t) texData.size);
 
-    // PsyDoom: patch this texture with bug fixes, if applicable
+    // PsyDoom: patch this texture with bug fixes, if applicable.
+    // Data from the decoded texture pool is patched when it is decompressed into the pool, so it does not need to be checked here.
     #if PSYDOOM_MODS
-        TexturePatcher::applyTexturePatches(tex, texData);
+        if (!bIsPooledTexData) {
+            TexturePatcher::applyTexturePatches(tex, texData);
+        }
     #endif
 
     // Move to a valid fill location for the texture and abort if failed.
     // This will also evict textures from previous frames along the way.
-    if (!TC_MoveToFillLocation(tex))
-        return;
+    // PsyDoom: also track the worst case number of fill locations checked while doing this.
+    #if PSYDOOM_MODS
+        gTCacheSearchLen = 0;
+        const bool bFoundFillLocation = TC_MoveToFillLocation(tex);
+        gTexCacheStats.maxSearchLen = std::max(gTexCacheStats.maxSearchLen, gTCacheSearchLen);
+
+        if (!bFoundFillLocation)
+            return;
+    #else
+        if (!TC_MoveToFillLocation(tex))
+            return;
+    #endif
 
     // Found a place to upload the texture!
     // Mark the texture as cached and fill the cells that this texture will occupy with references to the texture.
@@ -638,6 +904,10 @@ void I_CacheTex(texture_t& tex) noexcept {
     tcachepage_t& texPage = gTCachePages[gTCacheFillPage];
     TC_FillCacheCells(texPage, tex);
 
+    #if PSYDOOM_LIMIT_REMOVING
+        texPage.lastUseFrameNum = gNumFramesDrawn;
+    #endif
+
     // Upload the texture to vram and advance the fill position in the texture cache
     TC_UploadTexToVram(tex, texData, texPage);
     gTCacheFillCellX += tex.width16;
@@ -29,8 +29,22 @@ static constexpr uint32_t NUM_TCACHE_PAGE_CELLS = TCACHE_CELLS_X * TCACHE_CELLS_
         size_t      size;
     };
 
+    // Running totals for texture cache activity and texture uploads to VRAM, used for performance counters and benchmark reports.
+    // The search length is the number of candidate fill locations checked by a single 'I_CacheTex' call before finding room (or giving up).
+    struct texcachestats_t {
+        uint64_t    numUploads;             // Number of textures uploaded to VRAM, including animated textures updated by the Vulkan renderer
+        uint64_t    numBytesUploaded;       // Total bytes of texture data uploaded to VRAM
+        uint64_t    numEvictions;           // Number of textures evicted from the cache to make room for others
+        uint64_t    numOverflows;           // Number of times the cache could not find room for a texture
+        uint64_t    numDecodedPoolHits;     // Number of uploads which used already decompressed lump data from the decoded texture pool
+        uint32_t    maxSearchLen;           // Worst case search length for finding room in the cache, since the current level started
+    };
+
+    extern texcachestats_t gTexCacheStats;
+
     void I_InitTexCache() noexcept;
     uint32_t I_GetNumTexCachePages() noexcept;
+    uint32_t I_GetNumTexCachePagesInUse() noexcept;
     uint32_t I_GetCurTexCacheFillPage() noexcept;
     void I_SetTexCacheFillPage(const uint32_t pageIdx) noexcept;
     void I_PurgeTexCachePage(const uint32_t pageIdx) noexcept;
@@ -2,5 +2,81 @@
 
 #include "Doom/doomdef.h"
 
-fixed_t FixedMul(const fixed_t a, const fixed_t b) noexcept;
-fixed_t FixedDiv(const fixed_t a, const fixed_t b) noexcept;
+// PsyDoom: these are now inline and 'constexpr' so that calls in hot paths (or in constant expressions) do not need real function calls.
+// The results are bit-identical to the original implementations, including overflow behavior, since demo sync depends on them.
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Multiply two numbers in 16.16 fixed point format
+//------------------------------------------------------------------------------------------------------------------------------------------
+inline constexpr fixed_t FixedMul(const fixed_t a, const fixed_t b) noexcept {
+    // Note: the real version of this relied on combining the seperate 32-bit 'hi' and 'lo' portions of the MIPS 'mulu' instruction result.
+    // This version shortcuts that a bit and just uses 64-bit types provided by modern C++ rather than going through emulator instructions
+    // to get a split hi/lo result. It's the exact same thing basically but this should hopefully be a little faster...
+    const bool bNegativeResult = ((a ^ b) < 0);
+    const uint64_t a_u64 = (a < 0) ? -a : a;
+    const uint64_t b_u64 = (b < 0) ? -b : b;
+
+    const uint64_t result_u64 = (a_u64 * b_u64) >> FRACBITS;
+    const fixed_t result_abs = (fixed_t) result_u64;
+
+    return (bNegativeResult) ? -result_abs : result_abs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Divide 'a' by 'b'. Both numbers are in 16.16 fixed point format.
+//------------------------------------------------------------------------------------------------------------------------------------------
+inline constexpr fixed_t FixedDiv(const fixed_t a, const fixed_t b) noexcept {
+    // First step: make the problem an unsigned one
+    const bool bNegativeResult = ((a ^ b) < 0);
+    uint32_t dividend = (a < 0) ? -a : a;
+    uint32_t divisor = (b < 0) ? -b : b;
+
+    // PsyDoom: if the operands are small enough then the bit by bit division below (including its signed comparisons) works out to be an
+    // exact truncated division, so just do a 64-bit divide instead. The dividend must be under 2^29 and the divisor non zero and under 2^30,
+    // so the shifted divisor and dividend never reach 2^31. The quotient must also fit in 31 bits, which means no result bits are lost.
+    #if PSYDOOM_MODS
+        if ((dividend < 0x20000000u) && (divisor - 1u < 0x3FFFFFFFu)) {
+            const uint64_t quotient = ((uint64_t) dividend << FRACBITS) / divisor;
+
+            if (quotient < 0x80000000u) {
+                const fixed_t result = (fixed_t) quotient;
+                return (bNegativeResult) ? -result : result;
+            }
+        }
+    #endif
+
+    // Start off asuming the max result is '1.0'.
+    // Shift up the max result by 1 bit until we make the divisor bigger than the dividend.
+    // This gives the maximum possible estimated result:
+    uint32_t resultBit = FRACUNIT;
+
+    while (divisor < dividend) {
+        divisor <<= 1;
+        resultBit <<= 1;
+    }
+
+    // Start doing the division, one bit at a time
+    fixed_t result = 0;
+
+    do {
+        // See if the dividend will fit into the divisor at this bit.
+        // If so then include this result bit.
+        //
+        // Note: the original code did this comparison as a SIGNED comparison so I'm doing
+        // the same thing here for compatibility. It shouldn't matter in most cases but might
+        // be important to get the same result in cases of overflow...
+        //
+        if ((int32_t) dividend >= (int32_t) divisor) {
+            dividend -= divisor;
+            result |= resultBit;
+        }
+
+        // Move along to the next bit.
+        // Stop iteration once theres nothing left to divide or when we have processed all bits.
+        dividend <<= 1;
+        resultBit >>= 1;
+    } while ((resultBit != 0) && (dividend != 0));
+
+    // Last step, correct the sign of the result
+    return (bNegativeResult) ? -result : result;
+}
@@ -10,6 +10,7 @@
 #include "i_main.h"
 #include "m_fixed.h"
 #include "PsyDoom/Config/Config.h"
+#include "PsyDoom/DemoPlayer.h"
 #include "PsyDoom/DiscInfo.h"
 #include "PsyDoom/Game.h"
 #include "PsyDoom/IsoFileSys.h"
@@ -73,6 +74,7 @@ uint32_t gCDTrackNum[NUM_CD_MUSIC_TRACKS] = {
         uint8_t     volume;     // Volume level (0-127)
         uint8_t     pan;        // Pan amount (WESS_PAN_CENTER is the center)
         uint8_t     reverb;     // How much reverb to apply (0-127)
+        uint16_t    numPlays;   // How many times this exact sound (same origin and sound id) was requested to play this tick
     };
 
     // A list of sounds queued to be played on the next call to 'S_UpdateSounds'
@@ -125,6 +127,19 @@ static SampleBlock gMapSndBlock;
 // Is the DOOMSFX.LCD file loaded? (main sound effect samples)
 static bool gbDidLoadDoomSfxLcd;
 
+#if PSYDOOM_LIMIT_REMOVING
+    // PsyDoom limit removing: map sound effect and music instrument samples which are kept resident in SPU RAM across map transitions.
+    // Most maps reuse the same monster sounds and music instruments, so with the greatly expanded SPU RAM instead of unloading these samples
+    // on every map change they are kept around and only samples which are missing get uploaded. Samples are allocated linearly, starting
+    // at 'gSound_MapLcdSpuStartAddr', and the entire set of resident samples is flushed whenever SPU RAM starts getting low.
+    static std::vector<uint16_t>    gResidentMapSamples;
+    static uint32_t                 gResidentMapSamplesSpuEndAddr = SPU_RAM_APP_BASE;
+
+    // How much free SPU RAM must be available after the resident map samples in order to load the samples for a new map without a flush.
+    // This is the size of the original PlayStation's SPU RAM, which should be enough to hold all the music and sounds for any one map.
+    static constexpr uint32_t MIN_FREE_SPU_RAM_FOR_MAP_SAMPLES = 512 * 1024;
+#endif
+
 // Used to save the state of voices when pausing
 static SavedVoiceList gPausedMusVoiceState;
 
@@ -292,6 +307,44 @@ void S_UnloadSampleBlock(SampleBlock& sampleBlock) noexcept {
     }
 }
 
+#if PSYDOOM_LIMIT_REMOVING
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom limit removing: unloads all map samples which are kept resident in SPU RAM across map transitions
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void S_FlushResidentMapSamples() noexcept {
+    for (const uint16_t patchSampleIdx : gResidentMapSamples) {
+        wess_dig_set_sample_position(patchSampleIdx, 0);
+    }
+
+    gResidentMapSamples.clear();
+    gResidentMapSamplesSpuEndAddr = gSound_MapLcdSpuStartAddr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom limit removing: returns the SPU RAM address to load new map samples to, after any samples kept resident from previous maps.
+// If there is not enough SPU RAM left after the resident samples then they are all flushed first, so the new map loads from scratch.
+// Note: this must be called after reverb is setup for the map, since the reverb work area reduces the amount of SPU RAM available.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint32_t S_GetMapSamplesLoadAddr() noexcept {
+    if (gResidentMapSamplesSpuEndAddr + MIN_FREE_SPU_RAM_FOR_MAP_SAMPLES > gPsxSpu_sram_end) {
+        S_FlushResidentMapSamples();
+    }
+
+    return gResidentMapSamplesSpuEndAddr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom limit removing: makes all samples in the map sample block resident, so they don't get unloaded on the next map transition.
+// The map sample block is cleared afterwards since the resident samples list now tracks these samples.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void S_MakeMapSamplesResident(const uint32_t spuEndAddr) noexcept {
+    ASSERT(gMapSndBlock.num_samples <= SAMPLE_BLOCK_SIZE);
+    gResidentMapSamples.insert(gResidentMapSamples.end(), gMapSndBlock.patch_sample_idx, gMapSndBlock.patch_sample_idx + gMapSndBlock.num_samples);
+    gResidentMapSamplesSpuEndAddr = std::max(gResidentMapSamplesSpuEndAddr, spuEndAddr);
+    gMapSndBlock.num_samples = 0;
+}
+#endif  // #if PSYDOOM_LIMIT_REMOVING
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Loads all sound and music for the given map number (Note: '0' if menu, '60' if finale).
 // PsyDoom: this function has been rewritten. For the original version see the 'Old' folder.
@@ -339,11 +392,25 @@ void S_LoadMapSoundAndMusic(const int32_t mapNum) noexcept {
         S_UnloadSampleBlock(gDoomSndBlock);
         gbDidLoadDoomSfxLcd = false;
         gSound_MapLcdSpuStartAddr = SPU_RAM_APP_BASE;
+
+        // PsyDoom limit removing: resident map samples must also go since the finale samples are loaded where this LCD was
+        #if PSYDOOM_LIMIT_REMOVING
+            S_FlushResidentMapSamples();
+        #endif
     } else {
         // In all other cases ensure it is loaded
         if (!gbDidLoadDoomSfxLcd) {
+            // PsyDoom limit removing: need to flush resident map samples (from the finale) since this LCD will be loaded over them
+            #if PSYDOOM_LIMIT_REMOVING
+                S_FlushResidentMapSamples();
+            #endif
+
             gSound_MapLcdSpuStartAddr = SPU_RAM_APP_BASE + wess_dig_lcd_load(CdFile::DOOMSFX_LCD, SPU_RAM_APP_BASE, &gDoomSndBlock, false);
             gbDidLoadDoomSfxLcd = true;
+
+            #if PSYDOOM_LIMIT_REMOVING
+                gResidentMapSamplesSpuEndAddr = gSound_MapLcdSpuStartAddr;
+            #endif
         }
     }
 
@@ -366,6 +433,10 @@ void S_LoadMapSoundAndMusic(const int32_t mapNum) noexcept {
     if (gCurMusicSeqIdx == 0) {
         // No music sequences for this map - turn off reverb
         psxspu_init_reverb(SPU_REV_MODE_OFF, 0, 0, 0, 0);
+
+        #if PSYDOOM_LIMIT_REMOVING
+            destSpuAddr = S_GetMapSamplesLoadAddr();
+        #endif
     } else {
         // Normal case: most likely playing a map music sequence (unless CD music is requested) and initializing reverb.
         // Note: incorporating a change Final Doom made for all versions here, mute all audio first to prevent artifacts when initializing reverb:
@@ -373,6 +444,10 @@ void S_LoadMapSoundAndMusic(const int32_t mapNum) noexcept {
         psxspu_set_master_vol(0);
         psxspu_init_reverb(mapReverbMode, mapReverbDepthL, mapReverbDepthR, mapReverbDelay, mapReverbFeedback);
 
+        #if PSYDOOM_LIMIT_REMOVING
+            destSpuAddr = S_GetMapSamplesLoadAddr();
+        #endif
+
         if (!bPlayCdMusic) {
             wess_seq_load(gCurMusicSeqIdx, gpSound_MusicSeqData);
             const CdFileId lcdFileId = S_GetMusicLcdFileId(mapMusicTrack);
@@ -423,9 +498,14 @@ void S_LoadMapSoundAndMusic(const int32_t mapNum) noexcept {
         }
 
         if (mapSoundLcdFileId != CdFileId{}) {
-            wess_dig_lcd_load(mapSoundLcdFileId, destSpuAddr, &gMapSndBlock, false);
+            destSpuAddr += wess_dig_lcd_load(mapSoundLcdFileId, destSpuAddr, &gMapSndBlock, false);
         }
     }
+
+    // PsyDoom limit removing: keep all the samples just loaded in SPU RAM across map transitions
+    #if PSYDOOM_LIMIT_REMOVING
+        S_MakeMapSamplesResident(destSpuAddr);
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -488,8 +568,8 @@ static void I_StartSound(const queued_sound_t& sound) noexcept {
 // Queuing allows us to de-duplicate the same sound playing on the same frame multiple times.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void I_QueueSound(mobj_t* const pOrigin, const sfxenum_t soundId) noexcept {
-    // Ignore this command in headless mode
-    if (ProgArgs::gbHeadlessMode)
+    // Ignore this command in headless mode, or if fast forwarding a demo
+    if (ProgArgs::gbHeadlessMode || DemoPlayer::isFastForwarding())
         return;
 
     // Ignore the request if the sound sequence number is invalid
@@ -503,6 +583,17 @@ static void I_QueueSound(mobj_t* const pOrigin, const sfxenum_t soundId) noexcep
     if (!bValidSound)
         return;
 
+    // If this exact sound (same origin and sound id) was already queued then just count the extra request instead of redoing all the
+    // attenuation math below and queuing a duplicate. The result is the same since duplicates are merged when playing anyway.
+    for (auto iter = gQueuedSounds.rbegin(); iter != gQueuedSounds.rend(); ++iter) {
+        queued_sound_t& queuedSound = *iter;
+
+        if ((queuedSound.pOrigin == pOrigin) && (queuedSound.soundId == soundId)) {
+            queuedSound.numPlays = (uint16_t) std::min<uint32_t>(queuedSound.numPlays + 1u, UINT16_MAX);
+            return;
+        }
+    }
+
     // Grab the listener (player) and default the pan/volume for now
     mobj_t* pListener = gPlayers[gCurPlayerIndex].mo;
     int32_t vol = WESS_MAX_MASTER_VOL;
@@ -568,6 +659,7 @@ static void I_QueueSound(mobj_t* const pOrigin, const sfxenum_t soundId) noexcep
     sound.volume = (uint8_t) std::min<int32_t>(vol, WESS_MAX_MASTER_VOL);
     sound.pan = (uint8_t) std::clamp<int32_t>(pan, WESS_PAN_LEFT, WESS_PAN_RIGHT);
     sound.reverb = (uint8_t) std::clamp<int32_t>(reverb, 0, WESS_MAX_REVERB_DEPTH);
+    sound.numPlays = 1;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -594,9 +686,9 @@ static queued_sound_iter I_PlayQueuedSound(queued_sound_iter curIter) noexcept {
         return curIter;
 
     // Initially just playing the first sound pointed to.
-    // Note that reverb and pan levels are weighted based on sound volume.
+    // Note that reverb and pan levels are weighted based on sound volume, and repeated requests for the same sound count multiple times.
     const sfxenum_t soundId = curIter->soundId;
-    double vol = curIter->volume;
+    double vol = (double) curIter->volume * curIter->numPlays;
     double avgPan = curIter->pan * vol;
     double avgReverb = curIter->reverb * vol;
 
@@ -621,7 +713,7 @@ static queued_sound_iter I_PlayQueuedSound(queued_sound_iter curIter) noexcept {
             break;
 
         // Accumulate this sound so it will be merged and weight pan/reverb by volume level
-        const double curSoundVol = curIter->volume;
+        const double curSoundVol = (double) curIter->volume * curIter->numPlays;
         vol += curSoundVol;
         avgPan += curIter->pan * curSoundVol;
         avgReverb += curIter->reverb * curSoundVol;
@@ -790,6 +882,11 @@ void PsxSoundInit(const int32_t sfxVol, const int32_t musVol, void* const pTmpWm
     gSound_MapLcdSpuStartAddr = SPU_RAM_APP_BASE + wess_dig_lcd_load(CdFile::DOOMSFX_LCD, SPU_RAM_APP_BASE, &gDoomSndBlock, false);
     gbDidLoadDoomSfxLcd = true;
 
+    #if PSYDOOM_LIMIT_REMOVING
+        gResidentMapSamples.clear();
+        gResidentMapSamplesSpuEndAddr = gSound_MapLcdSpuStartAddr;
+    #endif
+
     // PsyDoom: reserve memory in the queued sounds list
     #if PSYDOOM_MODS
         gQueuedSounds.reserve(128);
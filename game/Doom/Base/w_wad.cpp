@@ -8,10 +8,17 @@
 
 #include "Doom/cdmaptbl.h"
 #include "i_main.h"
+#include "PsyDoom/DecodedTexPool.h"
+#include "PsyDoom/DevTexAutoReloader.h"
 #include "PsyDoom/Game.h"
+#include "PsyDoom/MapHash.h"
 #include "PsyDoom/ModMgr.h"
 #include "PsyDoom/WadList.h"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 // A flag set to true once data for the current map has been loaded.
 // Has very little purpose anymore in PsyDoom; was originally used to ensure the game was not loading resources on-the-fly off the CD-ROM.
 // In PsyDoom however on-the-fly resource loading is allowed, so this flag's purpose is diminished.
@@ -25,6 +32,16 @@ static WadList gMainWadList;
 // This is only used to load level data, and nothing else.
 static WadFile gMapWad;
 
+// Lumps from the currently open map WAD which have been read and decompressed ahead of time using 'W_PrefetchMapLumps'.
+// Reads of these lumps are served from this copy of the data.
+struct PrefetchedMapLump {
+    int32_t                 lumpIdx;
+    int32_t                 size;       // Decompressed size of the lump
+    std::vector<std::byte>  data;
+};
+
+static std::vector<PrefetchedMapLump> gPrefetchedMapLumps;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes the WAD file management system.
 // Opens up the main WAD files and verifies they are valid.
@@ -46,12 +63,15 @@ void W_Init() noexcept {
     }
 
     gMainWadList.finalize();
+    DevTexAutoReloader::init();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Shuts down the WAD file management system and cleans up resources used
 //------------------------------------------------------------------------------------------------------------------------------------------
 void W_Shutdown() noexcept {
+    DevTexAutoReloader::shutdown();
+    DecodedTexPool::clear();
     gMapWad.close();
     gMainWadList.clear();
     gbIsLevelDataCached = false;
@@ -64,6 +84,13 @@ void W_Shutdown() noexcept {
 int32_t W_NumLumps() noexcept {
     return gMainWadList.getNumLumps();
 }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the list of main WADs: used by developer tools which need to access individual WAD files
+//------------------------------------------------------------------------------------------------------------------------------------------
+WadList& W_GetMainWadList() noexcept {
+    return gMainWadList;
+}
 #endif
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -136,6 +163,14 @@ const WadLump& W_CacheLumpNum(const int32_t lumpIdx, const int16_t allocTag, con
     return gMainWadList.cacheLump(lumpIdx, allocTag, bDecompress);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Cache/load a batch of main WAD lumps (specified by lump index) in one go.
+// Has the same effect as calling 'W_CacheLumpNum' on each lump, but decompression is spread across the game's job worker threads.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void W_CacheLumpNums(const int32_t* const pLumpIdxs, const int32_t numLumps, const int16_t allocTag, const bool bDecompress) noexcept {
+    gMainWadList.cacheLumps(pLumpIdxs, numLumps, allocTag, bDecompress);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Helper that caches a specified main WAD lump (specified by name)
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -155,6 +190,7 @@ void W_OpenMapWad(const CdFileId fileId) noexcept {
 // Closes the currently open map WAD, if any
 //------------------------------------------------------------------------------------------------------------------------------------------
 void W_CloseMapWad() noexcept {
+    W_ClearPrefetchedMapLumps();
     gMapWad.close();
 }
 
@@ -201,9 +237,72 @@ int32_t W_RawMapLumpLength(const int32_t lumpIdx) noexcept {
 // The buffer must be big enough to accomodate the data. Optionally, decompression can be disabled.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void W_ReadMapLump(const int32_t lumpIdx, void* const pDest, const bool bDecompress) noexcept {
+    // If the lump has been prefetched in decompressed form then just copy it
+    if (bDecompress) {
+        for (const PrefetchedMapLump& lump : gPrefetchedMapLumps) {
+            if (lump.lumpIdx == lumpIdx) {
+                std::memcpy(pDest, lump.data.data(), (size_t) lump.size);
+                return;
+            }
+        }
+    }
+
     gMapWad.readLump(lumpIdx, pDest, bDecompress);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Read and decompress the requested lump index from the currently open map WAD into the given buffer, and add it to the hash for the map.
+// If the lump has been prefetched then the copy and hashing are done in one pass over the data.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void W_ReadMapLumpAndHash(const int32_t lumpIdx, void* const pDest) noexcept {
+    for (const PrefetchedMapLump& lump : gPrefetchedMapLumps) {
+        if (lump.lumpIdx == lumpIdx) {
+            MapHash::copyAndAddData(pDest, lump.data.data(), lump.size);
+            return;
+        }
+    }
+
+    gMapWad.readLump(lumpIdx, pDest, true);
+    MapHash::addData(pDest, W_MapLumpLength(lumpIdx));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads and decompresses the specified lumps from the currently open map WAD ahead of time, so that later reads are just a copy.
+// Decompression is spread across the game's job worker threads. Invalid lump indexes (e.g for missing lumps) are ignored.
+// Any previously prefetched lumps are discarded.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void W_PrefetchMapLumps(const int32_t* const pLumpIdxs, const int32_t numLumps) noexcept {
+    W_ClearPrefetchedMapLumps();
+
+    std::vector<int32_t> lumpIdxs;
+    std::vector<void*> lumpDests;
+    gPrefetchedMapLumps.reserve((size_t) numLumps);
+
+    for (int32_t i = 0; i < numLumps; ++i) {
+        const int32_t lumpIdx = pLumpIdxs[i];
+
+        if (!gMapWad.isValidLumpIdx(lumpIdx))
+            continue;
+
+        PrefetchedMapLump& lump = gPrefetchedMapLumps.emplace_back();
+        lump.lumpIdx = lumpIdx;
+        lump.size = gMapWad.getLump(lumpIdx).uncompressedSize;
+        lump.data.resize((size_t) std::max(lump.size, gMapWad.getRawSize(lumpIdx)));   // N.B: uncompressed lumps are read using their raw size
+        lumpIdxs.push_back(lumpIdx);
+        lumpDests.push_back(lump.data.data());
+    }
+
+    gMapWad.readLumps(lumpIdxs.data(), lumpDests.data(), (int32_t) lumpIdxs.size(), true);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Discards all map lumps which have been prefetched and frees the memory used to hold them
+//------------------------------------------------------------------------------------------------------------------------------------------
+void W_ClearPrefetchedMapLumps() noexcept {
+    gPrefetchedMapLumps.clear();
+    gPrefetchedMapLumps.shrink_to_fit();
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // These functions have been relocated to the new WAD handling code.
 // Keeping these calls here however so previous code using them can still work without changes.
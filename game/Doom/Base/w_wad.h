@@ -17,6 +17,7 @@
 #endif
 
 class WadFile;
+class WadList;
 
 extern bool gbIsLevelDataCached;
 
@@ -25,6 +26,7 @@ void W_Shutdown() noexcept;
 
 #if PSYDOOM_MODS
     int32_t W_NumLumps() noexcept;
+    WadList& W_GetMainWadList() noexcept;
 #endif
 
 const WadLump& W_GetLump(const int32_t lumpIdx) noexcept;
@@ -35,6 +37,7 @@ int32_t W_LumpLength(const int32_t lumpIdx) noexcept;
 int32_t W_RawLumpLength(const int32_t lumpIdx) noexcept;
 void W_ReadLump(const int32_t lumpIdx, void* const pDest, const bool bDecompress) noexcept;
 const WadLump& W_CacheLumpNum(const int32_t lumpIdx, const int16_t allocTag, const bool bDecompress) noexcept;
+void W_CacheLumpNums(const int32_t* const pLumpIdxs, const int32_t numLumps, const int16_t allocTag, const bool bDecompress) noexcept;
 const WadLump& W_CacheLumpName(const WadLumpName lumpName, const int16_t allocTag, const bool bDecompress) noexcept;
 void W_OpenMapWad(const CdFileId fileId) noexcept;
 void W_CloseMapWad() noexcept;
@@ -43,6 +46,9 @@ int32_t W_MapGetNumForName(const WadLumpName lumpName) noexcept;
 int32_t W_MapLumpLength(const int32_t lumpIdx) noexcept;
 int32_t W_RawMapLumpLength(const int32_t lumpIdx) noexcept;
 void W_ReadMapLump(const int32_t lumpIdx, void* const pDest, const bool bDecompress) noexcept;
+void W_ReadMapLumpAndHash(const int32_t lumpIdx, void* const pDest) noexcept;
+void W_PrefetchMapLumps(const int32_t* const pLumpIdxs, const int32_t numLumps) noexcept;
+void W_ClearPrefetchedMapLumps() noexcept;
 void decode(const void* pSrc, void* pDst) noexcept;
 uint32_t getDecodedSize(const void* const pSrc) noexcept;
 
@@ -4,9 +4,15 @@
 #include "EngineLimits.h"
 #include "i_main.h"
 #include "PsyDoom/Config/Config.h"
+#include "PsyDoom/LevelObjPool.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdio>
 #include <cstring>
 #include <memory>
+#include <new>
+#include <vector>
 
 // The minimum size that a memory block must be
 static constexpr int32_t MINFRAGMENT = 64;
@@ -20,6 +26,24 @@ static std::unique_ptr<std::byte[]> gZoneHeap;
 // The main (and only) memory zone used by PSX DOOM
 memzone_t* gpMainMemZone;
 
+#if PSYDOOM_LIMIT_REMOVING
+    // PsyDoom limit removing: an extra region of memory added to the main zone when it runs out of space.
+    // Each region starts with a memory block and it's blocks are linked onto the end of the zone's block list.
+    struct zoneregion_t {
+        std::unique_ptr<std::byte[]>    pMem;
+        memblock_t*                     pFirstBlock;
+        int32_t                         size;
+    };
+
+    // Unused padding placed before and after the blocks in each extra region.
+    // This guarantees that blocks in different regions never touch, so that they are never merged together.
+    static constexpr int32_t Z_REGION_PAD_SIZE = alignof(std::max_align_t);
+
+    static std::vector<zoneregion_t> gZoneExtraRegions;     // Extra regions in the order they appear in the block list
+    static int32_t gZoneExtraRegionsSize;                   // Total size of all extra regions
+    static int32_t gZonePeakTotalSize;                      // High water mark for the size of all blocks in the main zone, including extra regions
+#endif
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes the zone memory management system. DOOM doesn't use any PsyQ SDK allocation functions AT ALL (either directly or indirectly)
 // so it just gobbles up the entire of the available heap space on the system for it's own purposes.
@@ -36,8 +60,409 @@ void Z_Init() noexcept {
 
     gZoneHeap.reset(new std::byte[heapSize]);                   // Allocate the native heap for the application
     gpMainMemZone = Z_InitZone(gZoneHeap.get(), heapSize);      // Setup and save the main memory zone (the only zone)
+
+    #if PSYDOOM_LIMIT_REMOVING
+        gZoneExtraRegions.clear();
+        gZoneExtraRegionsSize = 0;
+        gZonePeakTotalSize = heapSize - (int32_t) MEMZONE_HEADER_SIZE;
+    #endif
+}
+
+#if PSYDOOM_LIMIT_REMOVING
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom limit removing: a faster memory allocator is used when the heap is large.
+//
+// Free blocks are kept in size class free lists (one list per power of two) so that allocation doesn't need to search the entire heap,
+// and used blocks are kept in lists for each tag so that 'Z_FreeTags' only visits the blocks it needs to free. Freed blocks are merged
+// with adjacent free blocks immediately, so there are never two free blocks next to each other. Purgable blocks are only thrown out
+// when there is no free block large enough to satisfy an allocation.
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+// Index of the tag list for blocks with zero or multiple tag bits set
+static constexpr int32_t TAG_LIST_MISC = Z_NUM_TAG_LISTS - 1;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the index of the highest set bit in the given value, or '0' if the value is zero
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t Z_HighestBitIdx(const uint32_t value) noexcept {
+    int32_t bitIdx = 0;
+
+    for (uint32_t bits = value >> 1; bits != 0; bits >>= 1) {
+        ++bitIdx;
+    }
+
+    return bitIdx;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns which tag list a used block with the given tag belongs in
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t Z_GetTagListIdx(const int16_t tag) noexcept {
+    const uint32_t tagBits = (uint16_t) tag;
+    const bool bIsSingleBit = ((tagBits != 0) && ((tagBits & (tagBits - 1)) == 0));
+    return (bIsSingleBit) ? Z_HighestBitIdx(tagBits) : TAG_LIST_MISC;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Add or remove a block from a list of blocks (free list or tag list)
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void Z_ListInsert(memblock_t*& pListHead, memblock_t& block) noexcept {
+    block.listPrev = nullptr;
+    block.listNext = pListHead;
+
+    if (pListHead) {
+        pListHead->listPrev = &block;
+    }
+
+    pListHead = &block;
+}
+
+static void Z_ListRemove(memblock_t*& pListHead, memblock_t& block) noexcept {
+    if (block.listPrev) {
+        block.listPrev->listNext = block.listNext;
+    } else {
+        pListHead = block.listNext;
+    }
+
+    if (block.listNext) {
+        block.listNext->listPrev = block.listPrev;
+    }
+
+    block.listPrev = nullptr;
+    block.listNext = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Add or remove a free block from the free list for it's size class.
+// Note: the size of the block must not change while it is in a free list.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void Z_AddToFreeList(memzone_t& zone, memblock_t& block) noexcept {
+    const int32_t listIdx = Z_HighestBitIdx((uint32_t) block.size);
+    Z_ListInsert(zone.freeLists[listIdx], block);
+    zone.freeListsMask |= (uint32_t) 1 << listIdx;
+}
+
+static void Z_RemoveFromFreeList(memzone_t& zone, memblock_t& block) noexcept {
+    const int32_t listIdx = Z_HighestBitIdx((uint32_t) block.size);
+    Z_ListRemove(zone.freeLists[listIdx], block);
+
+    if (!zone.freeLists[listIdx]) {
+        zone.freeListsMask &= ~((uint32_t) 1 << listIdx);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the given block ends exactly where the second block begins.
+// Blocks which are neighbours in the block list might not touch if they are in different regions of the zone.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool Z_BlocksTouch(const memblock_t& block, const memblock_t& nextBlock) noexcept {
+    return ((const std::byte*) &block + block.size == (const std::byte*) &nextBlock);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Turns the given block (which must not be in any list) into a free block, merging it with any adjacent free blocks.
+// Returns the resulting free block, which might start before the given block.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static memblock_t& Z_MakeFreeBlock(memzone_t& zone, memblock_t& block) noexcept {
+    memblock_t* pBlock = &block;
+    pBlock->user = nullptr;
+    pBlock->tag = 0;
+    pBlock->id = 0;
+
+    // Merge with the following block if free
+    memblock_t* const pNext = pBlock->next;
+
+    if (pNext && (!pNext->user) && Z_BlocksTouch(*pBlock, *pNext)) {
+        Z_RemoveFromFreeList(zone, *pNext);
+        pBlock->size += pNext->size;
+        pBlock->next = pNext->next;
+
+        if (pNext->next) {
+            pNext->next->prev = pBlock;
+        }
+
+        if (zone.rover == pNext) {
+            zone.rover = pBlock;
+        }
+    }
+
+    // Merge with the preceding block if free
+    memblock_t* const pPrev = pBlock->prev;
+
+    if (pPrev && (!pPrev->user) && Z_BlocksTouch(*pPrev, *pBlock)) {
+        Z_RemoveFromFreeList(zone, *pPrev);
+        pPrev->size += pBlock->size;
+        pPrev->next = pBlock->next;
+
+        if (pBlock->next) {
+            pBlock->next->prev = pPrev;
+        }
+
+        if (zone.rover == pBlock) {
+            zone.rover = pPrev;
+        }
+
+        pBlock = pPrev;
+    }
+
+    Z_AddToFreeList(zone, *pBlock);
+    return *pBlock;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Finds a free block of at least the given size using the size class free lists, or returns 'nullptr' if there is none.
+// If 'bHighestAddress' is set then the fitting free block with the highest address is returned, otherwise the first one found.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static memblock_t* Z_FindFreeBlock(memzone_t& zone, const int32_t allocSize, const bool bHighestAddress) noexcept {
+    memblock_t* pBestBlock = nullptr;
+
+    for (int32_t listIdx = Z_HighestBitIdx((uint32_t) allocSize); listIdx < Z_NUM_FREE_LISTS; ++listIdx) {
+        if ((zone.freeListsMask & ((uint32_t) 1 << listIdx)) == 0)
+            continue;
+
+        for (memblock_t* pBlock = zone.freeLists[listIdx]; pBlock; pBlock = pBlock->listNext) {
+            if (pBlock->size < allocSize)
+                continue;
+
+            if (!bHighestAddress)
+                return pBlock;
+
+            if ((!pBestBlock) || (pBlock > pBestBlock)) {
+                pBestBlock = pBlock;
+            }
+        }
+    }
+
+    return pBestBlock;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Throws out purgable blocks until there is a free block of at least the given size, or returns 'nullptr' if that is not possible.
+// Like the original allocator, purging starts from the rover and works forward through the heap.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static memblock_t* Z_PurgeForFreeBlock(memzone_t& zone, const int32_t allocSize) noexcept {
+    memblock_t* const startBlocks[2] = { zone.rover, &zone.blocklist };
+
+    for (memblock_t* const pStartBlock : startBlocks) {
+        for (memblock_t* pBlock = pStartBlock; pBlock;) {
+            if (pBlock->user && (pBlock->tag >= PU_PURGELEVEL)) {
+                memblock_t* const pPrev = pBlock->prev;
+                Z_Free2(zone, &pBlock[1]);
+
+                // The freed block might have been merged with the previous block
+                pBlock = (pPrev && (!pPrev->user)) ? pPrev : pBlock;
+            }
+
+            if ((!pBlock->user) && (pBlock->size >= allocSize))
+                return pBlock;
+
+            pBlock = pBlock->next;
+        }
+    }
+
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocates using the given free block, splitting off any unused space into a new free block.
+// The allocation is placed at either the start or the end of the free block.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static memblock_t& Z_AllocFromFreeBlock(
+    memzone_t& zone,
+    memblock_t& freeBlock,
+    const int32_t allocSize,
+    const int16_t tag,
+    void** const ppUser,
+    const bool bAllocAtEnd
+) noexcept {
+    Z_RemoveFromFreeList(zone, freeBlock);
+
+    // If there are enough free bytes left over then split them off into a new free block
+    const int32_t numUnusedBytes = freeBlock.size - allocSize;
+    memblock_t* pBase = &freeBlock;
+
+    if (numUnusedBytes > MINFRAGMENT) {
+        memblock_t* pUnused;
+
+        if (bAllocAtEnd) {
+            pUnused = &freeBlock;
+            pBase = (memblock_t*)((std::byte*) &freeBlock + numUnusedBytes);
+        } else {
+            pUnused = (memblock_t*)((std::byte*) &freeBlock + allocSize);
+        }
+
+        memblock_t& first = (bAllocAtEnd) ? *pUnused : *pBase;
+        memblock_t& second = (bAllocAtEnd) ? *pBase : *pUnused;
+        second.prev = &first;
+        second.next = first.next;
+
+        if (first.next) {
+            first.next->prev = &second;
+        }
+
+        first.next = &second;
+        pBase->size = allocSize;
+        pUnused->size = numUnusedBytes;
+        pUnused->user = nullptr;
+        pUnused->tag = 0;
+        pUnused->id = 0;
+        Z_AddToFreeList(zone, *pUnused);
+    }
+
+    // Setup the links on the memory block back to the pointer referencing it.
+    // Also populate the pointer referencing it (if given):
+    if (ppUser) {
+        pBase->user = ppUser;
+        *ppUser = &pBase[1];
+    } else {
+        if (tag >= PU_PURGELEVEL) {
+            I_Error("Z_Malloc: an owner is required for purgable blocks");
+        }
+
+        // Non purgable blocks without any owner are assigned a pointer value of '1'
+        pBase->user = (void**) 1;
+    }
+
+    pBase->tag = tag;
+    pBase->id = ZONEID;
+    Z_ListInsert(zone.tagLists[Z_GetTagListIdx(tag)], *pBase);
+    return *pBase;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Expands the main memory zone with an extra region big enough for an allocation of the given size.
+// Returns the free block spanning the new region, or 'nullptr' if the zone can't be expanded.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static memblock_t* Z_GrowZone(memzone_t& zone, const int32_t allocSize) noexcept {
+    // Only the main zone can be expanded, and the total size of the zone must still fit in 32-bits
+    if (&zone != gpMainMemZone)
+        return nullptr;
+
+    const int64_t regionSize = std::max<int64_t>(Z_HEAP_GROW_SIZE, allocSize);
+
+    if (zone.size + (int64_t) gZoneExtraRegionsSize + regionSize > INT32_MAX)
+        return nullptr;
+
+    std::unique_ptr<std::byte[]> pMem(new (std::nothrow) std::byte[regionSize + Z_REGION_PAD_SIZE * 2]);
+
+    if (!pMem)
+        return nullptr;
+
+    // The whole region starts out as one free block, linked onto the end of the block list
+    memblock_t* pTail = (gZoneExtraRegions.empty()) ? &zone.blocklist : gZoneExtraRegions.back().pFirstBlock;
+
+    while (pTail->next) {
+        pTail = pTail->next;
+    }
+
+    memblock_t& block = *(memblock_t*)(pMem.get() + Z_REGION_PAD_SIZE);
+    block = {};
+    block.size = (int32_t) regionSize;
+    block.lockframe = -1;
+    block.prev = pTail;
+    pTail->next = &block;
+    Z_AddToFreeList(zone, block);
+
+    // Save the region and report the expansion, so the user knows to raise the heap size if it keeps happening
+    gZoneExtraRegions.push_back({ std::move(pMem), &block, (int32_t) regionSize });
+    gZoneExtraRegionsSize += (int32_t) regionSize;
+    const int32_t totalSize = zone.size - (int32_t) MEMZONE_HEADER_SIZE + gZoneExtraRegionsSize;
+    gZonePeakTotalSize = std::max(gZonePeakTotalSize, totalSize);
+
+    std::printf(
+        "PsyDoom: main memory heap ran out of space and was expanded to %d KiB (peak %d KiB).\n"
+        "Consider raising 'MainMemoryHeapSize' in 'game_cfg.ini' if this happens often.\n",
+        totalSize / 1024,
+        gZonePeakTotalSize / 1024
+    );
+
+    return &block;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gives back any extra regions of the main memory zone which are now completely free
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void Z_ReleaseEmptyRegions(memzone_t& zone) noexcept {
+    for (auto regionIter = gZoneExtraRegions.begin(); regionIter != gZoneExtraRegions.end();) {
+        memblock_t& block = *regionIter->pFirstBlock;
+
+        if (block.user || (block.size != regionIter->size)) {
+            ++regionIter;
+            continue;
+        }
+
+        // The region is a single free block: unlink it and free the memory
+        Z_RemoveFromFreeList(zone, block);
+        block.prev->next = block.next;
+
+        if (block.next) {
+            block.next->prev = block.prev;
+        }
+
+        if (zone.rover == &block) {
+            zone.rover = &zone.blocklist;
+        }
+
+        gZoneExtraRegionsSize -= regionIter->size;
+        regionIter = gZoneExtraRegions.erase(regionIter);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Versions of 'Z_Malloc' and 'Z_EndMalloc' which use the size class free lists
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void* Z_MallocFromFreeList(memzone_t& zone, const int32_t allocSize, const int16_t tag, void** const ppUser, const bool bAllocAtEnd) noexcept {
+    memblock_t* pFreeBlock = Z_FindFreeBlock(zone, allocSize, bAllocAtEnd);
+
+    if (!pFreeBlock) {
+        pFreeBlock = Z_PurgeForFreeBlock(zone, allocSize);
+
+        if (!pFreeBlock) {
+            pFreeBlock = Z_GrowZone(zone, allocSize);
+        }
+
+        if (!pFreeBlock) {
+            Z_DumpHeap();
+            I_Error("Z_Malloc: failed allocation on %i", allocSize);
+        }
+    }
+
+    memblock_t& block = Z_AllocFromFreeBlock(zone, *pFreeBlock, allocSize, tag, ppUser, bAllocAtEnd);
+
+    if (bAllocAtEnd) {
+        zone.rover = &zone.blocklist;
+    } else {
+        zone.rover = (block.next) ? block.next : &zone.blocklist;
+    }
+
+    return &block + 1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Version of 'Z_FreeTags' which only visits blocks that have the given tags
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void Z_FreeTagsFromTagLists(memzone_t& zone, const int16_t tagBits) noexcept {
+    for (int32_t listIdx = 0; listIdx < Z_NUM_TAG_LISTS; ++listIdx) {
+        const bool bIsMiscList = (listIdx == TAG_LIST_MISC);
+
+        if ((!bIsMiscList) && ((tagBits & (1 << listIdx)) == 0))
+            continue;
+
+        for (memblock_t* pBlock = zone.tagLists[listIdx]; pBlock;) {
+            memblock_t* const pNextBlock = pBlock->listNext;
+
+            if (pBlock->tag & tagBits) {
+                Z_Free2(zone, &pBlock[1]);
+            }
+
+            pBlock = pNextBlock;
+        }
+    }
+
+    zone.rover = &zone.blocklist;
+}
+#endif  // #if PSYDOOM_LIMIT_REMOVING
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Sets up the given block of memory as a memory zone
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -59,6 +484,22 @@ memzone_t* Z_InitZone(void* const pBase, const int32_t size) noexcept {
 
     pZone->blocklist.next = nullptr;
     pZone->blocklist.prev = nullptr;
+
+    // PsyDoom limit removing: initialize the free and tag lists; the entire zone starts out as one free block
+    #if PSYDOOM_LIMIT_REMOVING
+        std::memset(pZone->freeLists, 0, sizeof(pZone->freeLists));
+        std::memset(pZone->tagLists, 0, sizeof(pZone->tagLists));
+        pZone->freeListsMask = 0;
+        pZone->blocklist.listNext = nullptr;
+        pZone->blocklist.listPrev = nullptr;
+        Z_AddToFreeList(*pZone, pZone->blocklist);
+    #endif
+
+    #if PSYDOOM_MODS
+        pZone->numMallocs = 0;
+        pZone->numBytesMalloced = 0;
+    #endif
+
     return pZone;
 }
 
@@ -75,6 +516,17 @@ void* Z_Malloc(memzone_t& zone, const int32_t size, const int16_t tag, void** co
         const int32_t allocSize = (size + sizeof(memblock_t) + 3) & 0xFFFFFFFC;
     #endif
 
+    // PsyDoom: keep track of how much is being allocated
+    #if PSYDOOM_MODS
+        zone.numMallocs++;
+        zone.numBytesMalloced += (uint32_t) allocSize;
+    #endif
+
+    // PsyDoom limit removing: use the size class free lists to find a block quickly instead of searching from the rover
+    #if PSYDOOM_LIMIT_REMOVING
+        return Z_MallocFromFreeList(zone, allocSize, tag, ppUser, false);
+    #endif
+
     // Scan through the block list looking for the first free block of sufficient size.
     // Also throw out any purgable blocks along the way.
     memblock_t* pBase = zone.rover;
@@ -184,6 +636,17 @@ void* Z_EndMalloc(memzone_t& zone, const int32_t size, const int16_t tag, void**
         const int32_t allocSize = (size + sizeof(memblock_t) + 3) & 0xFFFFFFFC;
     #endif
 
+    // PsyDoom: keep track of how much is being allocated
+    #if PSYDOOM_MODS
+        zone.numMallocs++;
+        zone.numBytesMalloced += (uint32_t) allocSize;
+    #endif
+
+    // PsyDoom limit removing: use the size class free lists to find the highest free block quickly
+    #if PSYDOOM_LIMIT_REMOVING
+        return Z_MallocFromFreeList(zone, allocSize, tag, ppUser, true);
+    #endif
+
     // Start at the very last block in the list, since we want to alloc at the end of the heap
     memblock_t* pBase = &zone.blocklist;
 
@@ -300,15 +763,38 @@ void Z_Free2([[maybe_unused]] memzone_t& zone, void* const ptr) noexcept {
         *block.user = nullptr;
     }
 
-    block.user = nullptr;
-    block.tag = 0;
-    block.id = 0;
+    // PsyDoom limit removing: move the block from it's tag list into a free list, merging it with adjacent free blocks
+    #if PSYDOOM_LIMIT_REMOVING
+        Z_ListRemove(zone.tagLists[Z_GetTagListIdx(block.tag)], block);
+        Z_MakeFreeBlock(zone, block);
+    #else
+        block.user = nullptr;
+        block.tag = 0;
+        block.id = 0;
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Free memory blocks that have one or more of the given tag bits
 //------------------------------------------------------------------------------------------------------------------------------------------
 void Z_FreeTags(memzone_t& zone, const int16_t tagBits) noexcept {
+    // PsyDoom limit removing: only visit blocks with the given tags, using the tag lists.
+    // Also any object pools using the freed tags have now lost all of their memory.
+    // When level data is freed, give back any extra regions that the main zone was expanded with and no longer needs.
+    #if PSYDOOM_LIMIT_REMOVING
+        Z_FreeTagsFromTagLists(zone, tagBits);
+
+        if (&zone == gpMainMemZone) {
+            LevelObjPool::onZoneTagsFreed(tagBits);
+
+            if (tagBits & PU_LEVEL) {
+                Z_ReleaseEmptyRegions(zone);
+            }
+        }
+
+        return;
+    #endif
+
     // Free each block if it is in use and matches one of the given tags
     for (memblock_t* pBlock = &zone.blocklist; pBlock; pBlock = pBlock->next) {
         if (pBlock->user) {
@@ -357,17 +843,58 @@ void Z_FreeTags(memzone_t& zone, const int16_t tagBits) noexcept {
 // If any sanity checks fail, then a fatal error is emitted.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void Z_CheckHeap(const memzone_t& zone) noexcept {
+    // PsyDoom limit removing: the blocks for any extra regions of the main zone follow the blocks for the zone itself.
+    // Check each region in turn, treating the end of each one like the end of the block list.
+    #if PSYDOOM_LIMIT_REMOVING
+        const bool bCheckExtraRegions = (&zone == gpMainMemZone);
+        size_t nextRegionIdx = 0;
+        const std::byte* pRegionStartByte = (const std::byte*) &zone;
+        int32_t regionSize = zone.size;
+    #endif
+
     // Sanity check all blocks in the heap
     for (const memblock_t* pBlock = &zone.blocklist; pBlock; pBlock = pBlock->next) {
+        #if PSYDOOM_LIMIT_REMOVING
+            const bool bLastBlockInRegion = ((const std::byte*) pBlock + pBlock->size == pRegionStartByte + regionSize);
+
+            if (bCheckExtraRegions && bLastBlockInRegion && pBlock->next) {
+                // The next block should be the start of the next extra region
+                if ((nextRegionIdx >= gZoneExtraRegions.size()) || (pBlock->next != gZoneExtraRegions[nextRegionIdx].pFirstBlock)) {
+                    I_Error("Z_CheckHeap: region end is not followed by the next region\n");
+                }
+
+                pRegionStartByte = (const std::byte*) gZoneExtraRegions[nextRegionIdx].pFirstBlock;
+                regionSize = gZoneExtraRegions[nextRegionIdx].size;
+                ++nextRegionIdx;
+
+                if (pBlock->next->prev != pBlock) {
+                    I_Error("Z_CheckHeap: next block doesn't have proper back link\n");
+                }
+
+                continue;
+            }
+        #endif
+
         // If we have reached the end of the block list, make sure we haven't 'lost' any heap memory.
         // Computed size for all the blocks should match the zone size:
         if (!pBlock->next) {
-            const std::byte* const pZoneStartByte = (const std::byte*) &zone;
+            #if PSYDOOM_LIMIT_REMOVING
+                const std::byte* const pZoneStartByte = pRegionStartByte;
+                const int32_t expectedZoneSize = regionSize;
+
+                if (bCheckExtraRegions && (nextRegionIdx != gZoneExtraRegions.size())) {
+                    I_Error("Z_CheckHeap: lost a zone region\n");
+                }
+            #else
+                const std::byte* const pZoneStartByte = (const std::byte*) &zone;
+                const int32_t expectedZoneSize = zone.size;
+            #endif
+
             const std::byte* const pBlockStartByte = (const std::byte*) pBlock;
             const std::byte* const pBlockEndByte = pBlockStartByte + pBlock->size;
             const int32_t actualZoneSize = (int32_t)(pBlockEndByte - pZoneStartByte);
 
-            if (actualZoneSize != zone.size) {
+            if (actualZoneSize != expectedZoneSize) {
                 I_Error("Z_CheckHeap: zone size changed\n");
             }
 
@@ -407,6 +934,12 @@ void Z_ChangeTag(void* const ptr, const int16_t tagBits) noexcept {
         }
     }
 
+    // PsyDoom limit removing: move the block to the tag list for it's new tag
+    #if PSYDOOM_LIMIT_REMOVING
+        Z_ListRemove(gpMainMemZone->tagLists[Z_GetTagListIdx(block.tag)], block);
+        Z_ListInsert(gpMainMemZone->tagLists[Z_GetTagListIdx((int16_t) tagBits)], block);
+    #endif
+
     block.tag = (int16_t) tagBits;
 }
 
@@ -423,7 +956,26 @@ void Z_SetUser(void* const ptr, void** const ppUser) noexcept {
         I_Error("Z_SetUser: pointer has incorrect ZONEID");
     }
 
-    block.user = ppUser;
+    // PsyDoom limit removing: a 'null' user marks a block as free, so blocks without an owner must use the special value '1' instead
+    #if PSYDOOM_LIMIT_REMOVING
+        block.user = (ppUser) ? ppUser : (void**) 1;
+    #else
+        block.user = ppUser;
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: get the tags for an already allocated memory block
+//------------------------------------------------------------------------------------------------------------------------------------------
+int16_t Z_GetTag(const void* const ptr) noexcept {
+    const memblock_t& block = ((const memblock_t*) ptr)[-1];
+
+    // Sanity check the zoneid for the block
+    if (block.id != ZONEID) {
+        I_Error("Z_GetTag: pointer has incorrect ZONEID");
+    }
+
+    return block.tag;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -434,6 +986,44 @@ void* Z_ZeroedMalloc(memzone_t& zone, const int32_t size, const int16_t tag, voi
     std::memset(pMemory, 0, size);
     return pMemory;
 }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: gathers statistics on how memory in the given zone is being used: bytes used by each tag, free space and fragmentation
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Z_GetStats(const memzone_t& zone, zonestats_t& stats) noexcept {
+    stats = {};
+
+    for (const memblock_t* pBlock = &zone.blocklist; pBlock; pBlock = pBlock->next) {
+        const int32_t blockSize = pBlock->size;
+        stats.totalBytes += blockSize;
+
+        if (!pBlock->user) {
+            stats.freeBytes += blockSize;
+            stats.largestFreeBlock = std::max(stats.largestFreeBlock, blockSize);
+            stats.numFreeBlocks++;
+            continue;
+        }
+
+        stats.usedBytes += blockSize;
+        stats.numUsedBlocks++;
+
+        switch (pBlock->tag) {
+            case PU_STATIC:     stats.staticBytes += blockSize;     break;
+            case PU_LEVEL:      stats.levelBytes += blockSize;      break;
+            case PU_LEVSPEC:    stats.levSpecBytes += blockSize;    break;
+            case PU_ANIMATION:  stats.animationBytes += blockSize;  break;
+            case PU_CACHE:      stats.cacheBytes += blockSize;      break;
+            default:            stats.otherTagBytes += blockSize;   break;
+        }
+    }
+
+    // PsyDoom limit removing: the main zone can be expanded and shrunk, so also say how big it has been at it's largest
+    #if PSYDOOM_LIMIT_REMOVING
+        stats.peakTotalBytes = (&zone == gpMainMemZone) ? std::max(stats.totalBytes, gZonePeakTotalSize) : stats.totalBytes;
+    #else
+        stats.peakTotalBytes = stats.totalBytes;
+    #endif
+}
 #endif  // #if PSYDOOM_MODS
 
 //------------------------------------------------------------------------------------------------------------------------------------------
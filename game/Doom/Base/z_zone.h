@@ -18,6 +18,13 @@ static constexpr int16_t PU_CACHE       = 0x20;     // Used to temporarily cache
 // All blocks must have this id
 static constexpr int16_t ZONEID = 0x1D4A;
 
+// PsyDoom limit removing: the number of size class free lists and the number of tag lists used to find blocks quickly.
+// There is one tag list for each possible tag bit, plus one extra list for blocks with zero or multiple tag bits set.
+#if PSYDOOM_LIMIT_REMOVING
+    static constexpr int32_t Z_NUM_FREE_LISTS = 32;
+    static constexpr int32_t Z_NUM_TAG_LISTS = 17;
+#endif
+
 // Holds details on a block of memory
 struct memblock_t {
     int32_t         size;           // Including the header and possibly tiny fragments
@@ -27,15 +34,54 @@ struct memblock_t {
     int32_t         lockframe;      // Don't purge on this frame
     memblock_t*     next;
     memblock_t*     prev;
+
+    // PsyDoom limit removing: links for the size class free list that the block is in (if free) or the tag list (if in use)
+    #if PSYDOOM_LIMIT_REMOVING
+        memblock_t*     listNext;
+        memblock_t*     listPrev;
+    #endif
 };
 
 // Info for a memory allocation zone
 struct memzone_t {
     int32_t         size;           // Total bytes malloced, including header
     memblock_t*     rover;
+
+    // PsyDoom limit removing: size class free lists (by power of two block size) and lists of used blocks for each tag
+    #if PSYDOOM_LIMIT_REMOVING
+        memblock_t*     freeLists[Z_NUM_FREE_LISTS];
+        memblock_t*     tagLists[Z_NUM_TAG_LISTS];
+        uint32_t        freeListsMask;              // Which free lists have blocks in them
+    #endif
+
+    // PsyDoom: running totals of allocations made in the zone, for working out allocation rates
+    #if PSYDOOM_MODS
+        uint64_t        numMallocs;                 // Number of allocations made since the zone was created
+        uint64_t        numBytesMalloced;           // Total bytes allocated since the zone was created, including block headers
+    #endif
+
     memblock_t      blocklist;      // Start / end cap for linked list
 };
 
+#if PSYDOOM_MODS
+    // PsyDoom: a summary of how memory in a zone is being used; the byte counts include block headers
+    struct zonestats_t {
+        int32_t     totalBytes;             // Size of all blocks in the zone
+        int32_t     peakTotalBytes;         // Largest that 'totalBytes' has been: the zone may grow when it runs out of space (limit removing)
+        int32_t     usedBytes;              // Size of all blocks in use
+        int32_t     freeBytes;              // Size of all free blocks
+        int32_t     largestFreeBlock;       // Size of the largest free block: the largest allocation possible without purging
+        int32_t     numUsedBlocks;          // Number of blocks in use
+        int32_t     numFreeBlocks;          // Number of free blocks: the more there are for the amount free, the more fragmented the zone
+        int32_t     staticBytes;            // Bytes used by 'PU_STATIC' blocks
+        int32_t     levelBytes;             // Bytes used by 'PU_LEVEL' blocks
+        int32_t     levSpecBytes;           // Bytes used by 'PU_LEVSPEC' blocks
+        int32_t     animationBytes;         // Bytes used by 'PU_ANIMATION' blocks
+        int32_t     cacheBytes;             // Bytes used by 'PU_CACHE' blocks
+        int32_t     otherTagBytes;          // Bytes used by blocks with any other tag or combination of tags
+    };
+#endif
+
 extern memzone_t* gpMainMemZone;
 
 void Z_Init() noexcept;
@@ -49,7 +95,9 @@ void Z_ChangeTag(void* const ptr, const int16_t tagBits) noexcept;
 
 #if PSYDOOM_MODS
     void Z_SetUser(void* const ptr, void** const ppUser) noexcept;
+    int16_t Z_GetTag(const void* const ptr) noexcept;
     void* Z_ZeroedMalloc(memzone_t& zone, const int32_t size, const int16_t tag, void** const ppUser) noexcept;
+    void Z_GetStats(const memzone_t& zone, zonestats_t& stats) noexcept;
 #endif
 
 int32_t Z_FreeMemory(memzone_t& zone) noexcept;
@@ -99,7 +99,15 @@ static constexpr int16_t MTF_BLEND_MODE_BIT2    = 0x80;     // PSX DOOM: 1 of 2
 
 // If this flag is set for a BSP node child in a wad then it means the child is a subsector.
 // This flag should be removed when retrieving the actual subsector number.
-static constexpr uint32_t NF_SUBSECTOR = 0x8000;
+//
+// PsyDoom: in limit removing builds the runtime flag moves to the top bit of a 32-bit child index, so that maps with more than 32,767
+// nodes or subsectors can be supported. 'NF_SUBSECTOR_16' is the flag as it is stored in the original 16-bit WAD format nodes lump.
+#if PSYDOOM_LIMIT_REMOVING
+    static constexpr uint32_t NF_SUBSECTOR = 0x80000000;
+    static constexpr uint32_t NF_SUBSECTOR_16 = 0x8000;
+#else
+    static constexpr uint32_t NF_SUBSECTOR = 0x8000;
+#endif
 
 // Header for a block of memory in a memory blocks file.
 // The data for the block immediately follows this header in the blocks file.
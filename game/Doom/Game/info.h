@@ -1377,17 +1377,32 @@ struct statefn_t {
 static constexpr uint32_t FF_FULLBRIGHT = 0x8000;       // If set the sprite is always displayed fullbright, in spite of lighting conditions.
 static constexpr uint32_t FF_FRAMEMASK  = 0x7FFF;       // Mask to retrieve the actual frame number itself.
 
-// Defines a finite state machine state that a map object or player sprite (weapon) can be in
+// Defines a finite state machine state that a map object or player sprite (weapon) can be in.
+// PsyDoom: the unused 'misc' fields are now 16-bit and states are aligned to 32 bytes, so that each state occupies a single 32 byte slot which
+// never straddles a cache line. States are read constantly by 'P_SetMobjState' etc. and this makes the state table more cache friendly.
+#if PSYDOOM_MODS
+struct alignas(32) state_t {
+#else
 struct state_t {
+#endif
     spritenum_t     sprite;         // Sprite number to use for the state
     int32_t         frame;          // What frame of the state to display
     int32_t         tics;           // Number of tics to remain in this state, or -1 if infinite
     statefn_t       action;         // Action function to call upon entering the state, may have 1 or 2 parameters depending on context (map object vs player sprite).
     statenum_t      nextstate;      // State number to goto after this state
+#if PSYDOOM_MODS
+    int16_t         misc1;          // State specific info 1: appears unused in this version of the game
+    int16_t         misc2;          // State specific info 2: appears unused in this version of the game
+#else
     int32_t         misc1;          // State specific info 1: appears unused in this version of the game
     int32_t         misc2;          // State specific info 2: appears unused in this version of the game
+#endif
 };
 
+#if PSYDOOM_MODS
+    static_assert(sizeof(state_t) == 32);
+#endif
+
 // Defines properties and behavior for a map object type
 struct mobjinfo_t {
     int32_t         doomednum;
@@ -11,6 +11,7 @@
 #include "Doom/Renderer/r_main.h"
 #include "doomdata.h"
 #include "info.h"
+#include "p_collide.h"
 #include "p_enemy.h"
 #include "p_local.h"
 #include "p_maputl.h"
@@ -18,6 +19,7 @@
 #include "p_setup.h"
 #include "p_tick.h"
 #include "PsyDoom/Config/Config.h"
+#include "PsyDoom/ScriptingEngine.h"
 
 #include <algorithm>
 
@@ -108,6 +110,13 @@ static void P_XYMovement(mobj_t& mobj) noexcept {
                 if (bHitSky) {
                     // Hit the sky: just remove quietly
                     mobj.latecall = &P_RemoveMobj;
+
+                    // PsyDoom: scripts running before the late call also remove this thing, as they always have
+                    #if PSYDOOM_MODS
+                        if (ScriptingEngine::isActive()) {
+                            ScriptingEngine::queueMobjRemoval(mobj);
+                        }
+                    #endif
                 } else {
                     // Usual case: exploding on hitting a wall or thing
                     mobj.latecall = &L_MissileHit;
@@ -294,6 +303,13 @@ void P_MobjThinker(mobj_t& mobj) noexcept {
             } else {
                 // No next state: schedule a removal for this map object
                 mobj.latecall = &P_RemoveMobj;
+
+                // PsyDoom: scripts running before the late call also remove this thing, as they always have
+                #if PSYDOOM_MODS
+                    if (ScriptingEngine::isActive()) {
+                        ScriptingEngine::queueMobjRemoval(mobj);
+                    }
+                #endif
             }
         }
     }
@@ -386,6 +402,13 @@ static void PB_UnsetThingPosition(mobj_t& thing) noexcept {
 
     // Remove the thing from the blockmap, if it is added to the blockmap
     if ((gTestFlags & MF_NOBLOCKMAP) == 0) {
+        // PsyDoom: remember if the blockmap cell had things in it, for updating blockmap chunk usage
+        #if PSYDOOM_MODS
+            const int32_t cellX = d_rshift<MAPBLOCKSHIFT>(thing.x - gBlockmapOriginX);
+            const int32_t cellY = d_rshift<MAPBLOCKSHIFT>(thing.y - gBlockmapOriginY);
+            const bool bCellWasUsed = P_IsBlockmapCellUsed(cellX, cellY);
+        #endif
+
         if (thing.bnext) {
             thing.bnext->bprev = thing.bprev;
         }
@@ -411,6 +434,10 @@ static void PB_UnsetThingPosition(mobj_t& thing) noexcept {
                 gppBlockLinks[blocky * gBlockmapWidth + blockx] = thing.bnext;
             #endif
         }
+
+        #if PSYDOOM_MODS
+            P_UpdateBlockmapChunkUsage(cellX, cellY, bCellWasUsed);
+        #endif
     }
 }
 
@@ -452,6 +479,11 @@ static void PB_SetThingPosition(mobj_t& mobj) noexcept {
             }
 
             blockmapList = &mobj;
+
+            // PsyDoom: the blockmap cell now has things in it, if it didn't before
+            #if PSYDOOM_MODS
+                P_UpdateBlockmapChunkUsage(bmapX, bmapY, (pPrevListHead != nullptr));
+            #endif
         } else {
             // Thing is outside the blockmap
             mobj.bprev = nullptr;
@@ -537,54 +569,6 @@ static bool PB_CheckPosition() noexcept {
     return true;
 }
 
-//------------------------------------------------------------------------------------------------------------------------------------------
-// Test if 'gTestBBox' intersects the given line: returns 'true' if there is an intersection
-//------------------------------------------------------------------------------------------------------------------------------------------
-static bool PB_BoxCrossLine(line_t& line) noexcept {
-    // Check if the test bounding box is outside the bounding box of the line: if it is then early out
-    const bool bTestBBOutsideLineBB = (
-        (gTestBBox[BOXTOP] <= line.bbox[BOXBOTTOM]) ||
-        (gTestBBox[BOXBOTTOM] >= line.bbox[BOXTOP]) ||
-        (gTestBBox[BOXLEFT] >= line.bbox[BOXRIGHT]) ||
-        (gTestBBox[BOXRIGHT] <= line.bbox[BOXLEFT])
-    );
-
-    if (bTestBBOutsideLineBB)
-        return false;
-
-    // Choose what line diagonal in the test box to test for crossing the line.
-    // This code is trying to get a box diagonal that is as perpendicular to the line as possible.
-    // Some lines for instance might run at 45 degrees and be parallel to the opposite box diagonal...
-    fixed_t x1;
-    fixed_t x2;
-
-    if (line.slopetype == ST_POSITIVE) {
-        x1 = gTestBBox[BOXLEFT];
-        x2 = gTestBBox[BOXRIGHT];
-    } else {
-        x1 = gTestBBox[BOXRIGHT];
-        x2 = gTestBBox[BOXLEFT];
-    }
-
-    // Use the cross product trick found in many functions such as 'R_PointOnSide' to determine what side of the line
-    // both points of the test bounding box diagonal lie on.
-    const fixed_t lx = line.vertex1->x;
-    const fixed_t ly = line.vertex1->y;
-    const int32_t ldx = d_fixed_to_int(line.dx);
-    const int32_t ldy = d_fixed_to_int(line.dy);
-
-    const int32_t dx1 = d_fixed_to_int(x1 - lx);
-    const int32_t dy1 = d_fixed_to_int(gTestBBox[BOXTOP] - ly);
-    const int32_t dx2 = d_fixed_to_int(x2 - lx);
-    const int32_t dy2 = d_fixed_to_int(gTestBBox[BOXBOTTOM] - ly);
-
-    const uint32_t side1 = (ldy * dx1 < dy1 * ldx);
-    const uint32_t side2 = (ldy * dx2 < dy2 * ldx);
-
-    // If the bounding box diagonal line points are on opposite sides of the line, then the box crosses the line
-    return (side1 != side2);
-}
-
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Assuming a collider intersects the given line, tells if the given line will potentially block - ignoring height differences.
 // Returns 'false' if the line is considered blocking ignoring height differences.
@@ -721,27 +705,7 @@ static bool PB_CheckThing(mobj_t& mobj) noexcept {
 // Returns 'false' if there is a definite collision, 'true' otherwise.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static bool PB_BlockLinesIterator(const int32_t x, const int32_t y) noexcept {
-    // Get the line list for this blockmap cell
-    const int16_t* pLineNum = (int16_t*)(gpBlockmapLump + gpBlockmap[y * gBlockmapWidth + x]);
-
-    // Visit all lines in the cell, checking for intersection and potential collision.
-    // Stop when there is a definite collision.
-    line_t* const pLines = gpLines;
-
-    for (; *pLineNum != -1; ++pLineNum) {
-        line_t& line = pLines[*pLineNum];
-
-        // Only check the line if not already checked this test
-        if (line.validcount != gValidCount) {
-            line.validcount = gValidCount;
-
-            // If it's collided with and definitely blocking then stop
-            if (PB_BoxCrossLine(line) && (!PB_CheckLine(line)))
-                return false;
-        }
-    }
-
-    return true;
+    return P_BoxBlockLinesIterator(x, y, gTestBBox, PB_CheckLine);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -749,14 +713,5 @@ static bool PB_BlockLinesIterator(const int32_t x, const int32_t y) noexcept {
 // Stops when a collision is detected and returns 'false', otherwise returns 'true' for no collision.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static bool PB_BlockThingsIterator(const int32_t x, const int32_t y) noexcept {
-    mobj_t* pmobj = gppBlockLinks[x + y * gBlockmapWidth];
-
-    while (pmobj) {
-        if (!PB_CheckThing(*pmobj))
-            return false;
-
-        pmobj = pmobj->bnext;
-    }
-
-    return true;
+    return P_BoxBlockThingsIterator(x, y, PB_CheckThing);
 }
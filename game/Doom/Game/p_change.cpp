@@ -14,6 +14,7 @@
 #include "p_maputl.h"
 #include "p_mobj.h"
 #include "p_move.h"
+#include "p_sight.h"
 #include "PsyDoom/Config/Config.h"
 #include "PsyDoom/Game.h"
 
@@ -170,6 +171,11 @@ bool PIT_ChangeSector(mobj_t& mobj) noexcept {
 // Returns 'true' if one or more things in the sector did not fit into it's height range.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool P_ChangeSector(sector_t& sector, const bool bCrunch) noexcept {
+    // PsyDoom: the sector height has changed so invalidate all cached sight check results
+    #if PSYDOOM_MODS
+        gSectorGeometryEpoch++;
+    #endif
+
     // Force all players to do a noise alert again next time they fire.
     // Because of the height change with this sector, new gaps might have opened...
     for (int32_t i = MAXPLAYERS - 1; i >= 0; --i) {
@@ -189,6 +195,15 @@ bool P_ChangeSector(sector_t& sector, const bool bCrunch) noexcept {
 
     for (int32_t x = bmapLx; x <= bmapRx; ++x) {
         for (int32_t y = bmapBy; y <= bmapTy; ++y) {
+            // PsyDoom: skip to the end of the current blockmap chunk if there are no things in it.
+            // This visits exactly the same things in the same order as before, just faster.
+            #if PSYDOOM_MODS
+                if (P_IsBlockmapChunkEmpty(x, y)) {
+                    y |= (1 << BLOCKMAP_CHUNK_SHIFT) - 1;
+                    continue;
+                }
+            #endif
+
             P_BlockThingsIterator(x, y, PIT_ChangeSector);
         }
     }
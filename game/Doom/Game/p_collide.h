@@ -0,0 +1,132 @@
+#pragma once
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Collision testing core shared by the movement code for players and missiles ('p_move') and for other map objects ('p_base').
+// Both modules test a bounding box against the lines and things in blockmap cells in the same way, but decide what actually blocks
+// differently. The common parts live here as inline templates, and each module passes in its own line and thing checks. Each caller
+// therefore keeps its exact semantics while sharing one implementation of the inner loops.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Doom/Renderer/r_local.h"
+#include "Doom/Renderer/r_main.h"
+#include "p_setup.h"
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Test if the given bounding box intersects the given line: returns 'true' if there is an intersection
+//------------------------------------------------------------------------------------------------------------------------------------------
+inline bool P_BoxCrossLine(const fixed_t (&bbox)[4], const line_t& line) noexcept {
+    // Check if the test bounding box is outside the bounding box of the line: if it is then early out
+    const bool bTestBBOutsideLineBB = (
+        (bbox[BOXTOP] <= line.bbox[BOXBOTTOM]) ||
+        (bbox[BOXBOTTOM] >= line.bbox[BOXTOP]) ||
+        (bbox[BOXLEFT] >= line.bbox[BOXRIGHT]) ||
+        (bbox[BOXRIGHT] <= line.bbox[BOXLEFT])
+    );
+
+    if (bTestBBOutsideLineBB)
+        return false;
+
+    // Choose what line diagonal in the test box to test for crossing the line.
+    // This code is trying to get a box diagonal that is as perpendicular to the line as possible.
+    // Some lines for instance might run at 45 degrees and be parallel to the opposite box diagonal...
+    fixed_t x1;
+    fixed_t x2;
+
+    if (line.slopetype == ST_POSITIVE) {
+        x1 = bbox[BOXLEFT];
+        x2 = bbox[BOXRIGHT];
+    } else {
+        x1 = bbox[BOXRIGHT];
+        x2 = bbox[BOXLEFT];
+    }
+
+    // Use the cross product trick found in many functions such as 'R_PointOnSide' to determine what side of the line
+    // both points of the test bounding box diagonal lie on.
+    const fixed_t lx = line.vertex1->x;
+    const fixed_t ly = line.vertex1->y;
+    const int32_t ldx = d_fixed_to_int(line.dx);
+    const int32_t ldy = d_fixed_to_int(line.dy);
+
+    const int32_t dx1 = d_fixed_to_int(x1 - lx);
+    const int32_t dy1 = d_fixed_to_int(bbox[BOXTOP] - ly);
+    const int32_t dx2 = d_fixed_to_int(x2 - lx);
+    const int32_t dy2 = d_fixed_to_int(bbox[BOXBOTTOM] - ly);
+
+    const uint32_t side1 = (ldy * dx1 < dy1 * ldx);
+    const uint32_t side2 = (ldy * dx2 < dy2 * ldx);
+
+    // If the bounding box diagonal line points are on opposite sides of the line, then the box crosses the line
+    return (side1 != side2);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Check for potential collisions between the given bounding box and all lines in the given blockmap cell.
+// Each line which is not already checked in this test ('validcount') and which the box crosses is passed to 'checkLine', which returns
+// 'false' if the line definitely blocks. Returns 'false' if there is a definite collision, 'true' otherwise.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class CheckLineT>
+inline bool P_BoxBlockLinesIterator(const int32_t x, const int32_t y, const fixed_t (&bbox)[4], const CheckLineT& checkLine) noexcept {
+    // Get the line list for this blockmap cell.
+    // PsyDoom: use the compact blockmap instead, which has 32-bit offsets and line numbers.
+    #if PSYDOOM_MODS
+        const int32_t* pLineNum = gpBlockmapLineNums + gpBlockmapCellLists[y * gBlockmapWidth + x];
+    #else
+        const int16_t* pLineNum = (int16_t*)(gpBlockmapLump + gpBlockmap[y * gBlockmapWidth + x]);
+    #endif
+
+    // Visit all lines in the cell, checking for intersection and potential collision.
+    // Stop when there is a definite collision.
+    line_t* const pLines = gpLines;
+
+    #if PSYDOOM_MODS
+        const fixed_t boxTop = bbox[BOXTOP];
+        const fixed_t boxBottom = bbox[BOXBOTTOM];
+        const fixed_t boxLeft = bbox[BOXLEFT];
+        const fixed_t boxRight = bbox[BOXRIGHT];
+    #endif
+
+    for (; *pLineNum != -1; ++pLineNum) {
+        // PsyDoom: quickly reject lines whose bounding box is not touched using the copy of line bounding boxes in the compact blockmap.
+        // This is the same test that 'P_BoxCrossLine' starts with, and skipping the 'validcount' update here doesn't change anything,
+        // since the line will always be rejected again by this same test for the rest of this collision check.
+        // Note: the tests are combined with bitwise rather than logical 'or' so they compile to branchless code.
+        #if PSYDOOM_MODS
+            const int32_t entryIdx = (int32_t)(pLineNum - gpBlockmapLineNums);
+            const bool bTestBBOutsideLineBB = (
+                (boxTop <= gpBlockmapLineBoxBottom[entryIdx]) |
+                (boxBottom >= gpBlockmapLineBoxTop[entryIdx]) |
+                (boxLeft >= gpBlockmapLineBoxRight[entryIdx]) |
+                (boxRight <= gpBlockmapLineBoxLeft[entryIdx])
+            );
+
+            if (bTestBBOutsideLineBB)
+                continue;
+        #endif
+
+        line_t& line = pLines[*pLineNum];
+
+        // Only check the line if not already checked this test
+        if (line.validcount != gValidCount) {
+            line.validcount = gValidCount;
+
+            // If it's collided with and definitely blocking then stop
+            if (P_BoxCrossLine(bbox, line) && (!checkLine(line)))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Check for collisions against all things in the given blockmap cell, passing each thing to 'checkThing'.
+// Stops when a collision is detected ('checkThing' returns 'false') and returns 'false', otherwise returns 'true' for no collision.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class CheckThingT>
+inline bool P_BoxBlockThingsIterator(const int32_t x, const int32_t y, const CheckThingT& checkThing) noexcept {
+    for (mobj_t* pmobj = gppBlockLinks[x + y * gBlockmapWidth]; pmobj; pmobj = pmobj->bnext) {
+        if (!checkThing(*pmobj))
+            return false;
+    }
+
+    return true;
+}
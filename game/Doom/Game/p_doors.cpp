@@ -285,7 +285,11 @@ bool EV_DoDoor(line_t& line, const vldoor_e doorType) noexcept {
 
         // Create the door thinker and populate its state/settings
         bActivatedADoor = true;
-        vldoor_t& door = *(vldoor_t*) Z_Malloc(*gpMainMemZone, sizeof(vldoor_t), PU_LEVSPEC, nullptr);
+        #if PSYDOOM_MODS
+            vldoor_t& door = *(vldoor_t*) P_AllocThinker(sizeof(vldoor_t));
+        #else
+            vldoor_t& door = *(vldoor_t*) Z_Malloc(*gpMainMemZone, sizeof(vldoor_t), PU_LEVSPEC, nullptr);
+        #endif
 
         #if PSYDOOM_MODS
             door = {};      // PsyDoom: zero-init this struct for good measure
@@ -427,7 +431,11 @@ void EV_VerticalDoor(line_t& line, mobj_t& user) noexcept {
     }
 
     // Need to create a new door thinker to run the door logic: create and set as the sector special
-    vldoor_t& newDoor = *(vldoor_t*) Z_Malloc(*gpMainMemZone, sizeof(vldoor_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        vldoor_t& newDoor = *(vldoor_t*) P_AllocThinker(sizeof(vldoor_t));
+    #else
+        vldoor_t& newDoor = *(vldoor_t*) Z_Malloc(*gpMainMemZone, sizeof(vldoor_t), PU_LEVSPEC, nullptr);
+    #endif
 
     #if PSYDOOM_MODS
         newDoor = {};   // PsyDoom: zero-init this struct for good measure
@@ -488,7 +496,11 @@ void P_SpawnDoorCloseIn30(sector_t& sector) noexcept {
     #endif
 
     // Spawn the door thinker and link it to the sector
-    vldoor_t& door = *(vldoor_t*) Z_Malloc(*gpMainMemZone, sizeof(vldoor_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        vldoor_t& door = *(vldoor_t*) P_AllocThinker(sizeof(vldoor_t));
+    #else
+        vldoor_t& door = *(vldoor_t*) Z_Malloc(*gpMainMemZone, sizeof(vldoor_t), PU_LEVSPEC, nullptr);
+    #endif
     P_AddThinker(door.thinker);
     sector.specialdata = &door;
     sector.special = 0;
@@ -513,7 +525,11 @@ void P_SpawnDoorRaiseIn5Mins(sector_t& sector, [[maybe_unused]] const int32_t se
     #endif
 
     // Spawn the door thinker and link it to the sector
-    vldoor_t& door = *(vldoor_t*) Z_Malloc(*gpMainMemZone, sizeof(vldoor_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        vldoor_t& door = *(vldoor_t*) P_AllocThinker(sizeof(vldoor_t));
+    #else
+        vldoor_t& door = *(vldoor_t*) Z_Malloc(*gpMainMemZone, sizeof(vldoor_t), PU_LEVSPEC, nullptr);
+    #endif
     P_AddThinker(door.thinker);
     sector.specialdata = &door;
     sector.special = 0;
@@ -617,7 +633,11 @@ bool EV_DoCustomDoor(sector_t& sector, const CustomDoorDef& def) noexcept {
         return false;
 
     // Alloc the door, zero-init and set it up as a thinker for the sector
-    vlcustomdoor_t& door = *(vlcustomdoor_t*) Z_Malloc(*gpMainMemZone, sizeof(vlcustomdoor_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        vlcustomdoor_t& door = *(vlcustomdoor_t*) P_AllocThinker(sizeof(vlcustomdoor_t));
+    #else
+        vlcustomdoor_t& door = *(vlcustomdoor_t*) Z_Malloc(*gpMainMemZone, sizeof(vlcustomdoor_t), PU_LEVSPEC, nullptr);
+    #endif
     door = {};
     P_AddThinker(door.thinker);
     door.thinker.function = (think_t) &T_CustomDoor;
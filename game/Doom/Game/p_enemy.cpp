@@ -92,14 +92,12 @@ constexpr static dirtype_t gDiagonalDirs[4] = {
 static void P_GatherBrainTargets() noexcept {
     gNumBrainTargets = 0;
 
-    for (mobj_t* pMobj = gMobjHead.next; pMobj != &gMobjHead; pMobj = pMobj->next) {
+    for (mobj_t* pMobj = P_GetFirstMobjOfType(MT_BOSSTARGET); pMobj; pMobj = pMobj->tnext) {
         if (gNumBrainTargets >= MAX_BRAIN_TARGETS)
             break;
 
-        if (pMobj->type == MT_BOSSTARGET) {
-            gpBrainTargets[gNumBrainTargets] = pMobj;
-            gNumBrainTargets++;
-        }
+        gpBrainTargets[gNumBrainTargets] = pMobj;
+        gNumBrainTargets++;
     }
 }
 
@@ -1159,16 +1157,22 @@ static void A_PainShootSkull(mobj_t& actor, const angle_t angle) noexcept {
     const int32_t skullLimit = Game::gSettings.lostSoulSpawnLimit;
 
     if (skullLimit > 0) {
-        int32_t numSkulls = 0;
+        // PsyDoom: the number of skulls is now tracked by the per-type lists of things, no need to count them
+        #if PSYDOOM_MODS
+            if (P_GetNumMobjsOfType(MT_SKULL) > skullLimit)
+                return;
+        #else
+            int32_t numSkulls = 0;
 
-        for (mobj_t* pmobj = gMobjHead.next; pmobj != &gMobjHead; pmobj = pmobj->next) {
-            if (pmobj->type == MT_SKULL) {
-                numSkulls++;
+            for (mobj_t* pmobj = gMobjHead.next; pmobj != &gMobjHead; pmobj = pmobj->next) {
+                if (pmobj->type == MT_SKULL) {
+                    numSkulls++;
 
-                if (numSkulls > skullLimit)
-                    return;
+                    if (numSkulls > skullLimit)
+                        return;
+                }
             }
-        }
+        #endif
     }
 
     // Figure out where to spawn the skull
@@ -1358,11 +1362,19 @@ void A_BossDeath(mobj_t& actor) noexcept {
     }
 
     // If all map objects of the given actor type are dead then we can trigger the special for the boss death.
-    // Otherwise if we find one that is alive, then we can't:
-    for (mobj_t* pmobj = gMobjHead.next; pmobj != &gMobjHead; pmobj = pmobj->next) {
-        if ((pmobj != &actor) && (pmobj->type == actorType) && (pmobj->health > 0))
-            return;
-    }
+    // Otherwise if we find one that is alive, then we can't.
+    // PsyDoom: only visit things of the actor's type, using the per-type lists of things.
+    #if PSYDOOM_MODS
+        for (mobj_t* pmobj = P_GetFirstMobjOfType(actorType); pmobj; pmobj = pmobj->tnext) {
+            if ((pmobj != &actor) && (pmobj->health > 0))
+                return;
+        }
+    #else
+        for (mobj_t* pmobj = gMobjHead.next; pmobj != &gMobjHead; pmobj = pmobj->next) {
+            if ((pmobj != &actor) && (pmobj->type == actorType) && (pmobj->health > 0))
+                return;
+        }
+    #endif
 
     // If we've gotten to here then we've killed all of this boss type and should trigger the appropriate special.
     // Use a dummy line structure (only want the 'tag' field really) to trigger some specials.
@@ -5,6 +5,9 @@
 #include "Doom/Base/w_wad.h"
 #include "Doom/Renderer/r_data.h"
 #include "doomdata.h"
+#include "PsyQ/LIBGPU.h"
+
+#include <algorithm>
 
 // This wraps x coordinates to 64 px bounds
 static const uint8_t FIRESKY_X_WRAP_MASK = FIRESKY_W - 1;
@@ -12,6 +15,16 @@ static const uint8_t FIRESKY_X_WRAP_MASK = FIRESKY_W - 1;
 // This RNG seed is used exclusively for the fire sky
 static uint32_t gFireSkyRndIndex;
 
+// PsyDoom: tracks which rows of the fire sky need to be uploaded to VRAM.
+// If a texture is given here then it was last uploaded by 'P_UploadSkyTex' and its copy in VRAM only differs in the rows from the given
+// row onwards to the bottom of the texture. If no texture is given (or it's not the sky being uploaded) then the whole texture is uploaded.
+// Only textures which are updated as fire skies are tracked, so that other skies are always uploaded in full.
+#if PSYDOOM_MODS
+    static const texture_t*     gpFireSkyTex;                   // The texture last updated as a fire sky
+    static const texture_t*     gpFireSkyPartialUploadTex;
+    static int32_t              gFireSkyUploadRowBeg;
+#endif
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Does one update round/iteration of the famous PlayStation Doom 'fire sky' effect.
 // After the effect is done, the fire sky texture is also invalidated, so that it is uploaded to VRAM next time it is drawn.
@@ -34,6 +47,20 @@ void P_UpdateFireSky(texture_t& skyTex) noexcept {
 
     uint8_t* const pRow0 = pLumpData + sizeof(texlump_header_t);
 
+    // PsyDoom: track the topmost row changed by this update, so only the rows which changed need to be uploaded.
+    // The bottom row is always treated as changed since the title screen modifies it outside of here, to control the fire intensity.
+    #if PSYDOOM_MODS
+        int32_t minChangedRow = FIRESKY_H - 1;
+    #endif
+
+    // PsyDoom: keep the RNG index in a local while updating.
+    // Otherwise since the texture pixels are bytes (which may alias anything) the global must be reloaded and saved for every pixel.
+    #if PSYDOOM_MODS
+        uint32_t rndIndex = gFireSkyRndIndex;
+    #else
+        uint32_t& rndIndex = gFireSkyRndIndex;
+    #endif
+
     // Fire propagates up, so we always sample from a row below the destination
     uint8_t* pSrcRow = pRow0 + FIRESKY_W;
 
@@ -48,16 +75,32 @@ void P_UpdateFireSky(texture_t& skyTex) noexcept {
             const uint8_t srcTemp = pSrcRow[x];
 
             if (srcTemp == 0) {
+                // PsyDoom: track the topmost row modified
+                #if PSYDOOM_MODS
+                    if ((y - 1 < minChangedRow) && (pDstRow[x] != 0)) {
+                        minChangedRow = y - 1;
+                    }
+                #endif
+
                 pDstRow[x] = 0;
             } else {
                 // Source pixel is not zero temp: propagate its 'heat' to the row above.
                 // Vary destination x and heat decay randomly:
-                const uint8_t dstXRand = gRndTable[gFireSkyRndIndex++ & 0xFF] & 3;
-                const uint8_t tempRand = gRndTable[gFireSkyRndIndex++ & 0xFF] & 1;
+                const uint8_t dstXRand = gRndTable[rndIndex++ & 0xFF] & 3;
+                const uint8_t tempRand = gRndTable[rndIndex++ & 0xFF] & 1;
 
                 // Update the chosen pixel in the row above and do heat decay randomly
                 const uint8_t dstX = (x + 1 - dstXRand) & FIRESKY_X_WRAP_MASK;
-                pDstRow[dstX] = srcTemp - tempRand;
+                const uint8_t dstTemp = srcTemp - tempRand;
+
+                // PsyDoom: track the topmost row modified
+                #if PSYDOOM_MODS
+                    if ((y - 1 < minChangedRow) && (pDstRow[dstX] != dstTemp)) {
+                        minChangedRow = y - 1;
+                    }
+                #endif
+
+                pDstRow[dstX] = dstTemp;
             }
 
             pSrcRow += FIRESKY_W;
@@ -67,7 +110,49 @@ void P_UpdateFireSky(texture_t& skyTex) noexcept {
         pSrcRow -= (FIRESKY_W * (FIRESKY_H - 1));
     }
 
+    // PsyDoom: save the RNG index and include any rows changed in this update in the rows to be uploaded
+    #if PSYDOOM_MODS
+        gFireSkyRndIndex = rndIndex;
+        gpFireSkyTex = &skyTex;
+
+        if (gpFireSkyPartialUploadTex == &skyTex) {
+            gFireSkyUploadRowBeg = std::min(gFireSkyUploadRowBeg, minChangedRow);
+        }
+    #endif
+
     // Mark the sky texture as 'not uploaded' to VRAM even though it may be there.
     // This invalidation causes it to be re-upoaded the next time it is drawn, so the updates done here will be visible.
     skyTex.uploadFrameNum = TEX_INVALID_UPLOAD_FRAME_NUM;
 }
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: forget which rows of the fire sky have changed and require the next upload of the sky texture to be a full upload.
+// This should be called whenever the fire sky is setup, since VRAM might have been overwritten since the last upload.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_ResetFireSkyUploadRows() noexcept {
+    gpFireSkyTex = nullptr;
+    gpFireSkyPartialUploadTex = nullptr;
+    gFireSkyUploadRowBeg = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: uploads the given sky texture's pixels to the specified area of VRAM.
+// For the fire sky only the rows which changed since the last upload are uploaded, if that is known; other skies are uploaded in full.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_UploadSkyTex(const texture_t& skyTex, const SRECT& vramRect, const uint16_t* const pTexData) noexcept {
+    // Upload the rows that changed, if any
+    const int32_t rowBeg = (&skyTex == gpFireSkyPartialUploadTex) ? std::min<int32_t>(gFireSkyUploadRowBeg, vramRect.h) : 0;
+
+    if (rowBeg < vramRect.h) {
+        SRECT uploadRect = vramRect;
+        uploadRect.y += (int16_t) rowBeg;
+        uploadRect.h -= (int16_t) rowBeg;
+        LIBGPU_LoadImage(uploadRect, pTexData + rowBeg * vramRect.w);
+    }
+
+    // The texture in VRAM is now up to date: track changes from here on if it's the fire sky
+    gpFireSkyPartialUploadTex = (&skyTex == gpFireSkyTex) ? &skyTex : nullptr;
+    gFireSkyUploadRowBeg = vramRect.h;
+}
+#endif  // #if PSYDOOM_MODS
@@ -2,6 +2,7 @@
 
 #include <cstdint>
 
+struct SRECT;
 struct texture_t;
 
 // Size of the firesky texture
@@ -9,3 +10,8 @@ static constexpr int32_t FIRESKY_W = 64;
 static constexpr int32_t FIRESKY_H = 128;
 
 void P_UpdateFireSky(texture_t& skyTex) noexcept;
+
+#if PSYDOOM_MODS
+    void P_ResetFireSkyUploadRows() noexcept;
+    void P_UploadSkyTex(const texture_t& skyTex, const SRECT& vramRect, const uint16_t* const pTexData) noexcept;
+#endif
@@ -10,6 +10,7 @@
 #include "g_game.h"
 #include "p_change.h"
 #include "p_setup.h"
+#include "p_sight.h"
 #include "p_spec.h"
 #include "p_tick.h"
 #include "PsyDoom/Config/Config.h"
@@ -49,8 +50,11 @@ result_e T_MovePlane(
     const int32_t floorOrCeiling,       // 0 = floor, 1 = ceiling
     const int32_t direction             // -1 = down, 1 = up
 ) noexcept {
+    // PsyDoom: sector heights are (potentially) about to change, so any cached sight check results must be invalidated.
     // PsyDoom: if the 'turbo' cheat is enabled allow planes to move 2x as fast
     #if PSYDOOM_MODS
+        gSectorGeometryEpoch++;
+
         if (Game::gSettings.bTurboMode) {
             speed *= 2;
         }
@@ -310,7 +314,11 @@ bool EV_DoFloor(line_t& line, const floor_e floorType) noexcept {
 
         // Found a sector which will be affected by this floor special: create a thinker and link to the sector
         bActivatedAMover = true;
-        floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+        #if PSYDOOM_MODS
+            floormove_t& floor = *(floormove_t*) P_AllocThinker(sizeof(floormove_t));
+        #else
+            floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+        #endif
 
         #if PSYDOOM_MODS
             floor = {};   // PsyDoom: zero-init all fields, including ones unused by this function
@@ -494,7 +502,11 @@ bool EV_BuildStairs(line_t& line, const stair_e stairType) noexcept {
 
         // Found a stairs sector which will be affected by this floor special: create a thinker for the first step and link to the sector
         bActivatedAMover = true;
-        floormove_t& firstFloor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+        #if PSYDOOM_MODS
+            floormove_t& firstFloor = *(floormove_t*) P_AllocThinker(sizeof(floormove_t));
+        #else
+            floormove_t& firstFloor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+        #endif
 
         #if PSYDOOM_MODS
             firstFloor = {};   // PsyDoom: zero-init all fields, including ones unused by this function
@@ -561,7 +573,11 @@ bool EV_BuildStairs(line_t& line, const stair_e stairType) noexcept {
                     continue;
 
                 // Create a thinker for this step's floor mover, link to the sector and populate it's settings
-                floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #if PSYDOOM_MODS
+                    floormove_t& floor = *(floormove_t*) P_AllocThinker(sizeof(floormove_t));
+                #else
+                    floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #endif
 
                 #if PSYDOOM_MODS
                     floor = {};   // PsyDoom: zero-init all fields, including ones unused by this function
@@ -604,7 +620,11 @@ bool EV_DoCustomFloor(sector_t& sector, const CustomFloorDef& floorDef) noexcept
         return false;
 
     // Allocate the floor mover, zero initialize and set as the sector thinker
-    floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        floormove_t& floor = *(floormove_t*) P_AllocThinker(sizeof(floormove_t));
+    #else
+        floormove_t& floor = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+    #endif
     floor = {};
     sector.specialdata = &floor;
 
@@ -222,9 +222,8 @@ static void P_ReadDecorateLump(const char* const lumpName) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_InitMobjInfo() noexcept {
     // Add base states to the states vector
-    gStateVec.clear();
     gStateVec.reserve(2048);
-    gStateVec.insert(gStateVec.begin(), gBaseStates, gBaseStates + BASE_NUM_STATES);
+    gStateVec.assign(gBaseStates, gBaseStates + BASE_NUM_STATES);
 
     // Add base map objects to the vector
     gMobjInfoVec.clear();
@@ -36,7 +36,11 @@ void T_FireFlicker(fireflicker_t& flicker) noexcept {
 void P_SpawnFireFlicker(sector_t& sector) noexcept {
     // Clear the current sector special (no hurt for example) and spawn the thinker
     sector.special = 0;
-    fireflicker_t& flicker = *(fireflicker_t*) Z_Malloc(*gpMainMemZone, sizeof(fireflicker_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        fireflicker_t& flicker = *(fireflicker_t*) P_AllocThinker(sizeof(fireflicker_t));
+    #else
+        fireflicker_t& flicker = *(fireflicker_t*) Z_Malloc(*gpMainMemZone, sizeof(fireflicker_t), PU_LEVSPEC, nullptr);
+    #endif
     P_AddThinker(flicker.thinker);
 
     // Setup flicker settings
@@ -73,7 +77,11 @@ void T_LightFlash(lightflash_t& lightFlash) noexcept {
 void P_SpawnLightFlash(sector_t& sector) noexcept {
     // Clear the current sector special (no hurt for example) and spawn the thinker
     sector.special = 0;
-    lightflash_t& lightFlash = *(lightflash_t*) Z_Malloc(*gpMainMemZone, sizeof(lightflash_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        lightflash_t& lightFlash = *(lightflash_t*) P_AllocThinker(sizeof(lightflash_t));
+    #else
+        lightflash_t& lightFlash = *(lightflash_t*) Z_Malloc(*gpMainMemZone, sizeof(lightflash_t), PU_LEVSPEC, nullptr);
+    #endif
     P_AddThinker(lightFlash.thinker);
 
     // Setup flash settings
@@ -111,7 +119,11 @@ void T_StrobeFlash(strobe_t& strobe) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_SpawnStrobeFlash(sector_t& sector, const int32_t darkTime, const bool bInSync) noexcept {
     // Create the strobe thinker and populate it's settings
-    strobe_t& strobe = *(strobe_t*) Z_Malloc(*gpMainMemZone, sizeof(strobe_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        strobe_t& strobe = *(strobe_t*) P_AllocThinker(sizeof(strobe_t));
+    #else
+        strobe_t& strobe = *(strobe_t*) Z_Malloc(*gpMainMemZone, sizeof(strobe_t), PU_LEVSPEC, nullptr);
+    #endif
     P_AddThinker(strobe.thinker);
 
     strobe.thinker.function = (think_t) &T_StrobeFlash;
@@ -142,7 +154,11 @@ void P_SpawnStrobeFlash(sector_t& sector, const int32_t darkTime, const bool bIn
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_SpawnRapidStrobeFlash(sector_t& sector) noexcept {
     // Create the strobe thinker and populate it's settings
-    strobe_t& strobe = *(strobe_t*) Z_Malloc(*gpMainMemZone, sizeof(strobe_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        strobe_t& strobe = *(strobe_t*) P_AllocThinker(sizeof(strobe_t));
+    #else
+        strobe_t& strobe = *(strobe_t*) Z_Malloc(*gpMainMemZone, sizeof(strobe_t), PU_LEVSPEC, nullptr);
+    #endif
     P_AddThinker(strobe.thinker);
 
     strobe.thinker.function = (think_t) &T_StrobeFlash;
@@ -183,11 +199,17 @@ void EV_TurnTagLightsOff(line_t& line) noexcept {
     // Turn 'off' the light for all sectors with a matching tag
     sector_t* const pSectors = gpSectors;
 
-    for (int32_t sectorIdx = 0; sectorIdx < gNumSectors; ++sectorIdx) {
-        sector_t& sector = pSectors[sectorIdx];
+    // PsyDoom: only visit the sectors with a matching tag, using the index of sectors by tag
+    #if PSYDOOM_MODS
+        for (int32_t sectorIdx = P_FindSectorFromLineTag(line, -1); sectorIdx >= 0; sectorIdx = P_FindSectorFromLineTag(line, sectorIdx)) {
+            sector_t& sector = pSectors[sectorIdx];
+    #else
+        for (int32_t sectorIdx = 0; sectorIdx < gNumSectors; ++sectorIdx) {
+            sector_t& sector = pSectors[sectorIdx];
 
-        if (sector.tag != line.tag)
-            continue;
+            if (sector.tag != line.tag)
+                continue;
+    #endif
 
         // Tag matches: find the lowest light level of surrounding sectors and use that as the new light level
         int16_t minLightLevel = sector.lightlevel;
@@ -213,11 +235,17 @@ void EV_LightTurnOn(line_t& line, const int32_t onLightLevel) noexcept {
     // Turn 'on' the light for all sectors with a matching tag
     sector_t* const pSectors = gpSectors;
 
-    for (int32_t sectorIdx = 0; sectorIdx < gNumSectors; ++sectorIdx) {
-        sector_t& sector = pSectors[sectorIdx];
+    // PsyDoom: only visit the sectors with a matching tag, using the index of sectors by tag
+    #if PSYDOOM_MODS
+        for (int32_t sectorIdx = P_FindSectorFromLineTag(line, -1); sectorIdx >= 0; sectorIdx = P_FindSectorFromLineTag(line, sectorIdx)) {
+            sector_t& sector = pSectors[sectorIdx];
+    #else
+        for (int32_t sectorIdx = 0; sectorIdx < gNumSectors; ++sectorIdx) {
+            sector_t& sector = pSectors[sectorIdx];
 
-        if (sector.tag != line.tag)
-            continue;
+            if (sector.tag != line.tag)
+                continue;
+    #endif
 
         // Tag matches: use the given light level as the 'on' light level, or if '0' is specified for that
         // use the highest light level found in surrounding sectors.
@@ -270,7 +298,11 @@ void T_Glow(glow_t& glow) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_SpawnGlowingLight(sector_t& sector, const glowtype_e glowType) noexcept {
     // Create the glow thinker
-    glow_t& glow = *(glow_t*) Z_Malloc(*gpMainMemZone, sizeof(glow_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        glow_t& glow = *(glow_t*) P_AllocThinker(sizeof(glow_t));
+    #else
+        glow_t& glow = *(glow_t*) Z_Malloc(*gpMainMemZone, sizeof(glow_t), PU_LEVSPEC, nullptr);
+    #endif
     P_AddThinker(glow.thinker);
 
     // Configure the glow settings depending on the type
@@ -326,6 +326,15 @@ void P_RadiusAttack(mobj_t& bombSpot, mobj_t* const pSource, const int32_t damag
 
     for (int32_t y = bmapBy; y <= bmapTy; ++y) {
         for (int32_t x = bmapLx; x <= bmapRx; ++x) {
+            // PsyDoom: skip to the end of the current blockmap chunk if there are no things in it.
+            // This visits exactly the same things in the same order as before, just faster.
+            #if PSYDOOM_MODS
+                if (P_IsBlockmapChunkEmpty(x, y)) {
+                    x |= (1 << BLOCKMAP_CHUNK_SHIFT) - 1;
+                    continue;
+                }
+            #endif
+
             P_BlockThingsIterator(x, y, PIT_RadiusAttack);
         }
     }
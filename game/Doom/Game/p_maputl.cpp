@@ -150,6 +150,13 @@ void P_UnsetThingPosition(mobj_t& thing) noexcept {
     // Does this thing get added to the blockmap?
     // If so remove it from the blockmap.
     if ((thing.flags & MF_NOBLOCKMAP) == 0) {
+        // PsyDoom: remember if the blockmap cell had things in it, for updating blockmap chunk usage
+        #if PSYDOOM_MODS
+            const int32_t cellX = d_rshift<MAPBLOCKSHIFT>(thing.x - gBlockmapOriginX);
+            const int32_t cellY = d_rshift<MAPBLOCKSHIFT>(thing.y - gBlockmapOriginY);
+            const bool bCellWasUsed = P_IsBlockmapCellUsed(cellX, cellY);
+        #endif
+
         if (thing.bnext) {
             thing.bnext->bprev = thing.bprev;
         }
@@ -175,6 +182,10 @@ void P_UnsetThingPosition(mobj_t& thing) noexcept {
                 gppBlockLinks[blocky * gBlockmapWidth + blockx] = thing.bnext;
             #endif
         }
+
+        #if PSYDOOM_MODS
+            P_UpdateBlockmapChunkUsage(cellX, cellY, bCellWasUsed);
+        #endif
     }
 }
 
@@ -216,6 +227,11 @@ void P_SetThingPosition(mobj_t& mobj) noexcept {
             }
 
             blockList = &mobj;
+
+            // PsyDoom: the blockmap cell now has things in it, if it didn't before
+            #if PSYDOOM_MODS
+                P_UpdateBlockmapChunkUsage(blockX, blockY, (mobj.bnext != nullptr));
+            #endif
         } else {
             mobj.bprev = nullptr;
             mobj.bnext = nullptr;
@@ -235,10 +251,15 @@ bool P_BlockLinesIterator(const int32_t x, const int32_t y, bool (*pFunc)(line_t
 
     // Get the line list offset for this blockmap cell in the blockmap lump.
     // Note that the offset to the line list is in terms of 16-bit words, not bytes.
-    const uint16_t lineListOffset = gpBlockmap[x + y * gBlockmapWidth];
+    // PsyDoom: use the compact blockmap instead, which has 32-bit offsets and line numbers.
+    #if PSYDOOM_MODS
+        const int32_t* pLineIdx = gpBlockmapLineNums + gpBlockmapCellLists[x + y * gBlockmapWidth];
+    #else
+        const uint16_t lineListOffset = gpBlockmap[x + y * gBlockmapWidth];
+        const int16_t* pLineIdx = (int16_t*)(gpBlockmapLump + lineListOffset);
+    #endif
 
     // Visit all the lines in the block unless the callee asks to quit
-    const int16_t* pLineIdx = (int16_t*)(gpBlockmapLump + lineListOffset);
     line_t* const pLines = gpLines;
 
     while (*pLineIdx != -1) {
@@ -281,3 +302,44 @@ bool P_BlockThingsIterator(const int32_t x, const int32_t y, bool (*pFunc)(mobj_
 
     return true;
 }
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: tells if the specified blockmap cell has any things in it.
+// Cells outside of the blockmap are treated as unused.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool P_IsBlockmapCellUsed(const int32_t x, const int32_t y) noexcept {
+    if ((x < 0) || (y < 0) || (x >= gBlockmapWidth) || (y >= gBlockmapHeight))
+        return false;
+
+    return (gppBlockLinks[x + y * gBlockmapWidth] != nullptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: must be called after the list of things for a blockmap cell is modified.
+// Updates the count of used cells for the chunk containing the cell, given whether the cell was used before the modification.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_UpdateBlockmapChunkUsage(const int32_t x, const int32_t y, const bool bCellWasUsed) noexcept {
+    if ((x < 0) || (y < 0) || (x >= gBlockmapWidth) || (y >= gBlockmapHeight))
+        return;
+
+    const bool bCellIsUsed = (gppBlockLinks[x + y * gBlockmapWidth] != nullptr);
+
+    if (bCellIsUsed != bCellWasUsed) {
+        uint8_t& numUsedCells = gpBlockmapChunkNumUsedCells[(x >> BLOCKMAP_CHUNK_SHIFT) + (y >> BLOCKMAP_CHUNK_SHIFT) * gBlockmapChunksWidth];
+        ASSERT(bCellIsUsed || (numUsedCells > 0));
+        numUsedCells = (bCellIsUsed) ? numUsedCells + 1 : numUsedCells - 1;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: tells if the blockmap chunk containing the specified blockmap cell has no things in it.
+// Chunks outside of the blockmap are treated as empty. This can be used to quickly skip over big empty areas when searching for things.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool P_IsBlockmapChunkEmpty(const int32_t x, const int32_t y) noexcept {
+    if ((x < 0) || (y < 0) || (x >= gBlockmapWidth) || (y >= gBlockmapHeight))
+        return true;
+
+    return (gpBlockmapChunkNumUsedCells[(x >> BLOCKMAP_CHUNK_SHIFT) + (y >> BLOCKMAP_CHUNK_SHIFT) * gBlockmapChunksWidth] == 0);
+}
+#endif  // #if PSYDOOM_MODS
@@ -11,6 +11,11 @@ extern fixed_t gOpenTop;
 extern fixed_t gOpenRange;
 extern fixed_t gLowFloor;
 
+#if PSYDOOM_MODS
+    // PsyDoom: the blockmap is split up into square chunks of this many cells (as a power of two) to track where things are
+    static constexpr int32_t BLOCKMAP_CHUNK_SHIFT = 3;
+#endif
+
 fixed_t P_AproxDistance(const fixed_t dx, const fixed_t dy) noexcept;
 int32_t P_PointOnLineSide(const fixed_t x, const fixed_t y, const line_t& line) noexcept;
 int32_t P_PointOnDivlineSide(const fixed_t x, const fixed_t y, const divline_t& divline) noexcept;
@@ -20,3 +25,9 @@ void P_UnsetThingPosition(mobj_t& thing) noexcept;
 void P_SetThingPosition(mobj_t& thing) noexcept;
 bool P_BlockLinesIterator(const int32_t x, const int32_t y, bool (*pFunc)(line_t&)) noexcept;
 bool P_BlockThingsIterator(const int32_t x, const int32_t y, bool (*pFunc)(mobj_t&)) noexcept;
+
+#if PSYDOOM_MODS
+    bool P_IsBlockmapCellUsed(const int32_t x, const int32_t y) noexcept;
+    void P_UpdateBlockmapChunkUsage(const int32_t x, const int32_t y, const bool bCellWasUsed) noexcept;
+    bool P_IsBlockmapChunkEmpty(const int32_t x, const int32_t y) noexcept;
+#endif
@@ -1,5 +1,6 @@
 #include "p_mobj.h"
 
+#include "Asserts.h"
 #include "Doom/Base/i_main.h"
 #include "Doom/Base/i_misc.h"
 #include "Doom/Base/m_random.h"
@@ -24,15 +25,44 @@
 #include "p_setup.h"
 #include "p_tick.h"
 #include "PsyDoom/Game.h"
+#include "PsyDoom/LevelObjPool.h"
+#include "PsyDoom/ScriptingEngine.h"
 
 #include <algorithm>
 #include <cstdio>
+#include <vector>
 
 int32_t         gItemRespawnQueueHead;              // Head of the circular queue
 int32_t         gItemRespawnQueueTail;              // Tail of the circular queue
 int32_t         gItemRespawnTime[ITEMQUESIZE];      // When each item in the respawn queue began the wait to respawn
 mapthing_t      gItemRespawnQueue[ITEMQUESIZE];     // Details for the things to be respawned
 
+#if PSYDOOM_MODS
+    uint32_t    gNextMobjListOrder;                 // PsyDoom: the 'listOrder' to give the next thing added to the global list of things
+
+    // PsyDoom: a list of all the things of a particular type, linked through the 'tprev' and 'tnext' fields of each thing.
+    // These let code which is only interested in one type of thing (boss deaths, Icon Of Sin targets etc.) skip visiting all other things.
+    struct MobjTypeList {
+        mobj_t*     pHead;      // First thing in the list
+        mobj_t*     pTail;      // Last thing in the list
+        int32_t     count;      // How many things are in the list
+    };
+
+    static std::vector<MobjTypeList> gMobjTypeLists;    // PsyDoom: lists of things for each map object type, indexed by type
+
+    static void P_UnlinkMobjFromTypeList(mobj_t& mobj) noexcept;
+
+    // PsyDoom: the map object type for each non-negative DoomEd number up to the largest one in use, or 'gNumMobjInfo' if there is none.
+    // Used to find the type of each map thing spawned without searching through all of the map object types.
+    static std::vector<int32_t> gMobjTypeForDoomEdNum;
+#endif
+
+// PsyDoom limit removing: map objects are allocated from a dedicated pool of contiguous memory chunks rather than being scattered
+// throughout the zone heap. This makes spawning and removing cheaper and keeps things which are iterated over every frame close together.
+#if PSYDOOM_LIMIT_REMOVING
+    static LevelObjPool gMobjPool(sizeof(mobj_t), 256, PU_LEVEL);
+#endif
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Removes the given map object from the game
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -58,19 +88,33 @@ void P_RemoveMobj(mobj_t& mobj) noexcept {
         gItemRespawnQueueHead++;
     }
 
+    // PsyDoom: if a script asked for this thing to be removed later then it can no longer be removed that way.
+    // This can happen if the thing gets removed by other means while the script is still executing.
+    #if PSYDOOM_MODS
+        if (mobj.scriptRemovalIdx != 0) {
+            ScriptingEngine::cancelMobjRemoval(mobj);
+        }
+    #endif
+
     // Remove the thing from sector thing lists and the blockmap
     P_UnsetThingPosition(mobj);
 
-    // Remove from the global linked list of things and deallocate
+    // Remove from the global linked list of things and deallocate.
+    // PsyDoom: also remove from the list of things of the same type.
     mobj.next->prev = mobj.prev;
     mobj.prev->next = mobj.next;
 
     #if PSYDOOM_MODS
+        P_UnlinkMobjFromTypeList(mobj);
         P_WeakReferencedDestroyed(mobj);    // PsyDoom: weak references to this object are now nulled
         mobj.~mobj_t();                     // PsyDoom: destroy C++ weak pointers
     #endif
 
-    Z_Free2(*gpMainMemZone, &mobj);
+    #if PSYDOOM_LIMIT_REMOVING
+        LevelObjPool::free(&mobj);
+    #else
+        Z_Free2(*gpMainMemZone, &mobj);
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -201,16 +245,120 @@ void P_ExplodeMissile(mobj_t& mobj) noexcept {
     }
 }
 
+#if PSYDOOM_MODS
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Spawn a thing with the specified type at the given location in space
+// PsyDoom addition: allocates a zero initialized map object and calls C++ constructors for it's weak pointers.
+// The map object must be freed via 'P_RemoveMobj' or by freeing all 'PU_LEVEL' zone memory.
 //------------------------------------------------------------------------------------------------------------------------------------------
-mobj_t* P_SpawnMobj(const fixed_t x, const fixed_t y, const fixed_t z, const mobjtype_t type) noexcept {
-    // Alloc and zero initialize the map object
-    mobj_t& mobj = *(mobj_t*) Z_Malloc(*gpMainMemZone, sizeof(mobj_t), PU_LEVEL, nullptr);
+mobj_t& P_AllocMobj() noexcept {
+    // PsyDoom limit removing: allocate from the map object pool instead of directly from the zone heap
+    #if PSYDOOM_LIMIT_REMOVING
+        mobj_t& mobj = *(mobj_t*) gMobjPool.alloc();
+    #else
+        mobj_t& mobj = *(mobj_t*) Z_Malloc(*gpMainMemZone, sizeof(mobj_t), PU_LEVEL, nullptr);
+    #endif
+
     D_memset(&mobj, std::byte(0), sizeof(mobj_t));
+    new (&mobj) mobj_t();
+    return mobj;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: adds the given map object to the end of the list of things with the same type.
+// Things must be added in the same order that they are added to the global list of things, so that both lists have the same ordering.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_LinkMobjToTypeList(mobj_t& mobj) noexcept {
+    ASSERT(mobj.type >= 0);
+    const size_t typeIdx = (size_t) mobj.type;
+
+    if (typeIdx >= gMobjTypeLists.size()) {
+        gMobjTypeLists.resize(std::max<size_t>(typeIdx + 1, gNumMobjInfo));
+    }
+
+    MobjTypeList& list = gMobjTypeLists[typeIdx];
+    mobj.tprev = list.pTail;
+    mobj.tnext = nullptr;
+
+    if (list.pTail) {
+        list.pTail->tnext = &mobj;
+    } else {
+        list.pHead = &mobj;
+    }
+
+    list.pTail = &mobj;
+    list.count++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: removes the given map object from the list of things with the same type
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_UnlinkMobjFromTypeList(mobj_t& mobj) noexcept {
+    const size_t typeIdx = (size_t) mobj.type;
+
+    if (typeIdx >= gMobjTypeLists.size())
+        return;
+
+    MobjTypeList& list = gMobjTypeLists[typeIdx];
+
+    // Ignore the request if the thing is not in the list (can happen if it was never fully spawned)
+    if ((!mobj.tprev) && (list.pHead != &mobj))
+        return;
+
+    if (mobj.tprev) {
+        mobj.tprev->tnext = mobj.tnext;
+    } else {
+        list.pHead = mobj.tnext;
+    }
+
+    if (mobj.tnext) {
+        mobj.tnext->tprev = mobj.tprev;
+    } else {
+        list.pTail = mobj.tprev;
+    }
+
+    mobj.tprev = nullptr;
+    mobj.tnext = nullptr;
+    list.count--;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: empties the lists of things for each type, should be done whenever the global list of things is reset
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_ClearMobjTypeLists() noexcept {
+    for (MobjTypeList& list : gMobjTypeLists) {
+        list = {};
+    }
+}
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: returns the first of the things with the given type (in global list order), or 'nullptr' if there are none.
+// The rest of the things with the type can be visited by following the 'tnext' field.
+//------------------------------------------------------------------------------------------------------------------------------------------
+mobj_t* P_GetFirstMobjOfType(const mobjtype_t type) noexcept {
+    const size_t typeIdx = (size_t) type;
+    return (typeIdx < gMobjTypeLists.size()) ? gMobjTypeLists[typeIdx].pHead : nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: returns how many things with the given type there are, alive or dead
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t P_GetNumMobjsOfType(const mobjtype_t type) noexcept {
+    const size_t typeIdx = (size_t) type;
+    return (typeIdx < gMobjTypeLists.size()) ? gMobjTypeLists[typeIdx].count : 0;
+}
+#endif  // #if PSYDOOM_MODS
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Spawn a thing with the specified type at the given location in space
+//------------------------------------------------------------------------------------------------------------------------------------------
+mobj_t* P_SpawnMobj(const fixed_t x, const fixed_t y, const fixed_t z, const mobjtype_t type) noexcept {
+    // Alloc and zero initialize the map object.
+    // PsyDoom: this is now done by a helper function, which also calls C++ constructors for weak pointers.
     #if PSYDOOM_MODS
-        new (&mobj) mobj_t();   // PsyDoom: call C++ constructors for weak pointers
+        mobj_t& mobj = P_AllocMobj();
+    #else
+        mobj_t& mobj = *(mobj_t*) Z_Malloc(*gpMainMemZone, sizeof(mobj_t), PU_LEVEL, nullptr);
+        D_memset(&mobj, std::byte(0), sizeof(mobj_t));
     #endif
 
     // Fill in basic fields
@@ -255,6 +403,11 @@ mobj_t* P_SpawnMobj(const fixed_t x, const fixed_t y, const fixed_t z, const mob
     mobj.prev = gMobjHead.prev;
     gMobjHead.prev = &mobj;
 
+    #if PSYDOOM_MODS
+        mobj.listOrder = gNextMobjListOrder++;      // PsyDoom: record where the thing is in the list, relative to other things
+        P_LinkMobjToTypeList(mobj);                 // PsyDoom: add to the list of things with the same type
+    #endif
+
     // PsyDoom: reset all interpolations for the thing
     #if PSYDOOM_MODS
         R_SnapMobjInterpolation(mobj);
@@ -345,6 +498,35 @@ void P_SpawnPlayer(const mapthing_t& mapThing) noexcept {
     }
 }
 
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: builds the lookup of map object type by DoomEd number used by 'P_SpawnMapThing'.
+// Where several map object types share a DoomEd number the first one is used, the same as a search through the list of types would do.
+// Should be called before the things for a map are spawned.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_InitDoomEdNumLookup() noexcept {
+    // Map things use 16-bit DoomEd numbers, so there is no need for the lookup to cover anything larger
+    int32_t maxDoomEdNum = -1;
+
+    for (int32_t typeIdx = 0; typeIdx < gNumMobjInfo; ++typeIdx) {
+        maxDoomEdNum = std::max(maxDoomEdNum, gMobjInfo[typeIdx].doomednum);
+    }
+
+    maxDoomEdNum = std::min<int32_t>(maxDoomEdNum, INT16_MAX);
+
+    gMobjTypeForDoomEdNum.clear();
+    gMobjTypeForDoomEdNum.resize(maxDoomEdNum + 1, gNumMobjInfo);
+
+    for (int32_t typeIdx = gNumMobjInfo - 1; typeIdx >= 0; --typeIdx) {
+        const int32_t doomEdNum = gMobjInfo[typeIdx].doomednum;
+
+        if ((doomEdNum >= 0) && (doomEdNum <= maxDoomEdNum)) {
+            gMobjTypeForDoomEdNum[doomEdNum] = typeIdx;
+        }
+    }
+}
+#endif
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Spawns a thing using the information in the given 'mapthing_t' struct
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -423,10 +605,20 @@ void P_SpawnMapThing(const mapthing_t& mapthing) noexcept {
 
     mobjtype_t thingType = (mobjtype_t) numMobjTypes;
 
-    for (int32_t thingTypeIdx = 0; thingTypeIdx < numMobjTypes; ++thingTypeIdx) {
-        if (gMobjInfo[thingTypeIdx].doomednum == mapthing.type) {
-            thingType = (mobjtype_t) thingTypeIdx;
-            break;
+    // PsyDoom: use the lookup by DoomEd number where possible, falling back to a search for DoomEd numbers outside of it
+    #if PSYDOOM_MODS
+        const bool bUseDoomEdNumLookup = ((mapthing.type >= 0) && (mapthing.type < (int32_t) gMobjTypeForDoomEdNum.size()));
+
+        if (bUseDoomEdNumLookup) {
+            thingType = (mobjtype_t) gMobjTypeForDoomEdNum[mapthing.type];
+        } else
+    #endif
+    {
+        for (int32_t thingTypeIdx = 0; thingTypeIdx < numMobjTypes; ++thingTypeIdx) {
+            if (gMobjInfo[thingTypeIdx].doomednum == mapthing.type) {
+                thingType = (mobjtype_t) thingTypeIdx;
+                break;
+            }
         }
     }
 
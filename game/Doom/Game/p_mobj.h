@@ -14,6 +14,17 @@ extern int32_t      gItemRespawnQueueTail;
 extern int32_t      gItemRespawnTime[ITEMQUESIZE];
 extern mapthing_t   gItemRespawnQueue[ITEMQUESIZE];
 
+#if PSYDOOM_MODS
+    extern uint32_t gNextMobjListOrder;
+
+    mobj_t& P_AllocMobj() noexcept;
+    void P_LinkMobjToTypeList(mobj_t& mobj) noexcept;
+    void P_ClearMobjTypeLists() noexcept;
+    mobj_t* P_GetFirstMobjOfType(const mobjtype_t type) noexcept;
+    int32_t P_GetNumMobjsOfType(const mobjtype_t type) noexcept;
+    void P_InitDoomEdNumLookup() noexcept;
+#endif
+
 void P_RemoveMobj(mobj_t& mobj) noexcept;
 void P_RespawnSpecials() noexcept;
 bool P_SetMobjState(mobj_t& mobj, const statenum_t stateNum) noexcept;
@@ -5,6 +5,7 @@
 #include "Doom/Renderer/r_main.h"
 #include "doomdata.h"
 #include "info.h"
+#include "p_collide.h"
 #include "p_inter.h"
 #include "p_local.h"
 #include "p_map.h"
@@ -201,6 +202,13 @@ static void PM_UnsetThingPosition(mobj_t& thing) noexcept {
     // Does this thing get added to the blockmap?
     // If so remove it from the blockmap.
     if ((thing.flags & MF_NOBLOCKMAP) == 0) {
+        // PsyDoom: remember if the blockmap cell had things in it, for updating blockmap chunk usage
+        #if PSYDOOM_MODS
+            const int32_t cellX = d_rshift<MAPBLOCKSHIFT>(thing.x - gBlockmapOriginX);
+            const int32_t cellY = d_rshift<MAPBLOCKSHIFT>(thing.y - gBlockmapOriginY);
+            const bool bCellWasUsed = P_IsBlockmapCellUsed(cellX, cellY);
+        #endif
+
         if (thing.bnext) {
             thing.bnext->bprev = thing.bprev;
         }
@@ -226,6 +234,10 @@ static void PM_UnsetThingPosition(mobj_t& thing) noexcept {
                 gppBlockLinks[blocky * gBlockmapWidth + blockx] = thing.bnext;
             #endif
         }
+
+        #if PSYDOOM_MODS
+            P_UpdateBlockmapChunkUsage(cellX, cellY, bCellWasUsed);
+        #endif
     }
 }
 
@@ -267,6 +279,11 @@ static void PM_SetThingPosition(mobj_t& mobj) noexcept {
             }
 
             blockList = &mobj;
+
+            // PsyDoom: the blockmap cell now has things in it, if it didn't before
+            #if PSYDOOM_MODS
+                P_UpdateBlockmapChunkUsage(blockX, blockY, (mobj.bnext != nullptr));
+            #endif
         } else {
             mobj.bprev = nullptr;
             mobj.bnext = nullptr;
@@ -380,54 +397,6 @@ static void PM_CheckPosition() noexcept {
     gbTryMove2 = true;
 }
 
-//------------------------------------------------------------------------------------------------------------------------------------------
-// Test if 'gTestTmBBox' intersects the given line: returns 'true' if there is an intersection
-//------------------------------------------------------------------------------------------------------------------------------------------
-static bool PM_BoxCrossLine(line_t& line) noexcept {
-    // Check if the test bounding box is outside the bounding box of the line: if it is then early out
-    const bool bTestBBOutsideLineBB = (
-        (gTestTmBBox[BOXTOP] <= line.bbox[BOXBOTTOM]) ||
-        (gTestTmBBox[BOXBOTTOM] >= line.bbox[BOXTOP]) ||
-        (gTestTmBBox[BOXLEFT] >= line.bbox[BOXRIGHT]) ||
-        (gTestTmBBox[BOXRIGHT] <= line.bbox[BOXLEFT])
-    );
-
-    if (bTestBBOutsideLineBB)
-        return false;
-
-    // Choose what line diagonal in the test box to test for crossing the line.
-    // This code is trying to get a box diagonal that is as perpendicular to the line as possible.
-    // Some lines for instance might run at 45 degrees and be parallel to the opposite box diagonal...
-    fixed_t x1;
-    fixed_t x2;
-
-    if (line.slopetype == ST_POSITIVE) {
-        x1 = gTestTmBBox[BOXLEFT];
-        x2 = gTestTmBBox[BOXRIGHT];
-    } else {
-        x1 = gTestTmBBox[BOXRIGHT];
-        x2 = gTestTmBBox[BOXLEFT];
-    }
-
-    // Use the cross product trick found in many functions such as 'R_PointOnSide' to determine what side of the line
-    // both points of the test bounding box diagonal lie on.
-    const fixed_t lx = line.vertex1->x;
-    const fixed_t ly = line.vertex1->y;
-    const int32_t ldx = d_fixed_to_int(line.dx);
-    const int32_t ldy = d_fixed_to_int(line.dy);
-
-    const int32_t dx1 = d_fixed_to_int(x1 - lx);
-    const int32_t dy1 = d_fixed_to_int(gTestTmBBox[BOXTOP] - ly);
-    const int32_t dx2 = d_fixed_to_int(x2 - lx);
-    const int32_t dy2 = d_fixed_to_int(gTestTmBBox[BOXBOTTOM] - ly);
-
-    const uint32_t side1 = (ldy * dx1 < dy1 * ldx);
-    const uint32_t side2 = (ldy * dx2 < dy2 * ldx);
-
-    // If the bounding box diagonal line points are on opposite sides of the line, then the box crosses the line
-    return (side1 != side2);
-}
-
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Assuming a collider intersects the given line, tells if the given line will potentially block - ignoring height differences.
 // Returns 'false' if the line is considered blocking ignoring height differences.
@@ -603,27 +572,7 @@ static bool PIT_CheckThing(mobj_t& mobj) noexcept {
 // Returns 'false' if there is a definite collision, 'true' otherwise.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static bool PM_BlockLinesIterator(const int32_t x, const int32_t y) noexcept {
-    // Get the line list for this blockmap cell
-    const int16_t* pLineNum = (int16_t*)(gpBlockmapLump + gpBlockmap[y * gBlockmapWidth + x]);
-
-    // Visit all lines in the cell, checking for intersection and potential collision.
-    // Stop when there is a definite collision.
-    line_t* const pLines = gpLines;
-
-    for (; *pLineNum != -1; ++pLineNum) {
-        line_t& line = pLines[*pLineNum];
-
-        // Only check the line if not already checked this test
-        if (line.validcount != gValidCount) {
-            line.validcount = gValidCount;
-
-            // If it's collided with and definitely blocking then stop
-            if (PM_BoxCrossLine(line) && (!PIT_CheckLine(line)))
-                return false;
-        }
-    }
-
-    return true;
+    return P_BoxBlockLinesIterator(x, y, gTestTmBBox, PIT_CheckLine);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -631,10 +580,5 @@ static bool PM_BlockLinesIterator(const int32_t x, const int32_t y) noexcept {
 // In some cases the thing collided with is saved in 'gpMoveThing' for futher interactions like pickups and damaging.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static bool PM_BlockThingsIterator(const int32_t x, const int32_t y) noexcept {
-    for (mobj_t* pmobj = gppBlockLinks[x + y * gBlockmapWidth]; pmobj; pmobj = pmobj->bnext) {
-        if (!PIT_CheckThing(*pmobj))
-            return false;
-    }
-
-    return true;
+    return P_BoxBlockThingsIterator(x, y, PIT_CheckThing);
 }
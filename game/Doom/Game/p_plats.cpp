@@ -252,7 +252,11 @@ bool EV_DoPlat(line_t& line, const plattype_e platType, const int32_t moveAmount
 
         // Create the platform thinker, link to it's sector and populate its state/settings
         bActivatedPlats = true;
-        plat_t& plat = *(plat_t*) Z_Malloc(*gpMainMemZone, sizeof(plat_t), PU_LEVSPEC, nullptr);
+        #if PSYDOOM_MODS
+            plat_t& plat = *(plat_t*) P_AllocThinker(sizeof(plat_t));
+        #else
+            plat_t& plat = *(plat_t*) Z_Malloc(*gpMainMemZone, sizeof(plat_t), PU_LEVSPEC, nullptr);
+        #endif
 
         #if PSYDOOM_MODS
             plat = {};  // PsyDoom: zero-init all fields, including ones unused by this function
@@ -336,7 +340,11 @@ bool EV_DoCustomPlat(sector_t& sector, const CustomPlatDef platDef) noexcept {
         return false;
 
     // Alloc the platform, zero-init and set it up as a thinker for the sector
-    plat_t& plat = *(plat_t*) Z_Malloc(*gpMainMemZone, sizeof(plat_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        plat_t& plat = *(plat_t*) P_AllocThinker(sizeof(plat_t));
+    #else
+        plat_t& plat = *(plat_t*) Z_Malloc(*gpMainMemZone, sizeof(plat_t), PU_LEVSPEC, nullptr);
+    #endif
     plat = {};
     P_AddThinker(plat.thinker);
     sector.specialdata = &plat;
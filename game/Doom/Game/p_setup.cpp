@@ -25,6 +25,7 @@
 #include "p_local.h"
 #include "p_maputl.h"
 #include "p_mobj.h"
+#include "p_sight.h"
 #include "p_spec.h"
 #include "p_switch.h"
 #include "p_tick.h"
@@ -38,9 +39,14 @@
 #include "PsyDoom/MapPatcher/MapPatcher.h"
 #include "PsyDoom/MobjSpritePrecacher.h"
 #include "PsyDoom/ModMgr.h"
+#include "PsyDoom/Profiler.h"
+#include "PsyDoom/ScriptBindings.h"
 #include "PsyDoom/ScriptingEngine.h"
+#include "PsyDoom/SightPvs.h"
+#include "PsyDoom/Utils.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <cstring>
 #include <vector>
@@ -102,6 +108,44 @@ mapthing_t*     gpDeathmatchP;                                  // Points past t
     char gLevelStartupWarning[64];
 #endif
 
+#if PSYDOOM_MODS
+    // PsyDoom: a tightly packed copy of the BSP tree nodes, used for faster BSP tree traversal
+    packednode_t*   gpPackedBspNodes;
+
+    // PsyDoom: how many blockmap cells have things in them, for each square chunk of blockmap cells.
+    // This allows big empty areas of the blockmap to be skipped when searching for things.
+    uint8_t*        gpBlockmapChunkNumUsedCells;
+    int32_t         gBlockmapChunksWidth;
+    int32_t         gBlockmapChunksHeight;
+
+    // PsyDoom: a compact version of the blockmap which is built after loading the map, using 32-bit offsets and line numbers.
+    // For each blockmap cell there is an index to the start of it's line list, and each line list is terminated by '-1'.
+    // The bounding box of each line is also stored alongside each line list entry (as separate arrays) for fast collision rejection.
+    int32_t*        gpBlockmapCellLists;
+    int32_t*        gpBlockmapLineNums;
+    fixed_t*        gpBlockmapLineBoxTop;
+    fixed_t*        gpBlockmapLineBoxBottom;
+    fixed_t*        gpBlockmapLineBoxLeft;
+    fixed_t*        gpBlockmapLineBoxRight;
+
+    static int32_t  gBlockmapLumpNumWords;      // Size of the blockmap lump in 16-bit words
+
+    // PsyDoom: a copy of the compact blockmap line lists which only contains lines with specials, in the same order as the full lists.
+    // Used to find crossed special lines without visiting all the other lines. Rebuilt on demand if line specials have been changed.
+    int32_t*        gpBlockmapSpecialCellLists;
+    int32_t*        gpBlockmapSpecialLineNums;
+    static bool     gbSpecialLineBlockmapDirty;
+
+    // PsyDoom: for each blockmap cell, the deepest BSP tree node (or subsector, if 'NF_SUBSECTOR' is set) which contains the whole cell.
+    // Used to skip most of the BSP tree walk when finding the subsector which a point is in. Null if not built for the current map.
+    int32_t*        gpBlockmapCellBspNodes;
+
+    // PsyDoom: the indexes of all sectors sorted by tag and then by index, so sectors with a given tag can be found without searching all of them.
+    // Rebuilt on demand if sector tags have been changed since it was last built.
+    static int32_t* gpSectorIdxsByTag;
+    static bool     gbSectorTagIndexDirty;
+#endif
+
 // PsyDoom: sets of texture and flat texture indexes to indicate what walls and flats are to be loaded & cached during level setup.
 // The new flexible texture mangement code first flags all the resources needed using these sets before actually sorting and loading the resources.
 #if PSYDOOM_LIMIT_REMOVING
@@ -151,6 +195,24 @@ static bool isSkyFlatPic(const int32_t picNum) noexcept {
     return false;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: reads and decompresses all of the lumps needed to load the map ahead of time, in one batch.
+// This allows decompression to be spread across the job worker threads; the map lump loaders then just copy the prefetched data.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_PrefetchMapLumps() noexcept {
+    constexpr const char* MAP_LUMP_NAMES[] = {
+        "THINGS", "LINEDEFS", "SIDEDEFS", "VERTEXES", "SEGS", "SSECTORS", "NODES", "SECTORS", "REJECT", "BLOCKMAP", "LEAFS", "ZNODES", "SCRIPTS"
+    };
+
+    int32_t lumpNums[C_ARRAY_SIZE(MAP_LUMP_NAMES)];
+
+    for (uint32_t i = 0; i < C_ARRAY_SIZE(MAP_LUMP_NAMES); ++i) {
+        lumpNums[i] = W_MapCheckNumForName(MAP_LUMP_NAMES[i]);     // N.B: missing lumps (-1) are ignored by the prefetch
+    }
+
+    W_PrefetchMapLumps(lumpNums, (int32_t) C_ARRAY_SIZE(lumpNums));
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // PsyDoom: activates all boss related specials in the map
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -223,11 +285,11 @@ static void P_LoadVertexes(const int32_t lumpNum) noexcept {
     gpVertexes = (vertex_t*) Z_Malloc(*gpMainMemZone, gNumVertexes * sizeof(vertex_t), PU_LEVEL, nullptr);
 
     // Read the WAD vertexes into the temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
-
-    // PsyDoom: add to the hash for the map
+    // PsyDoom: read the lump and add it to the hash for the map in one pass
     #if PSYDOOM_MODS
-        MapHash::addData(pTmpBufferBytes, lumpSize);
+        W_ReadMapLumpAndHash(lumpNum, pTmpBufferBytes);
+    #else
+        W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
     #endif
 
     // Convert the vertexes to the renderer runtime format
@@ -268,11 +330,11 @@ static void P_LoadSegs(const int32_t lumpNum) noexcept {
     D_memset(gpSegs, std::byte(0), gNumSegs * sizeof(seg_t));
 
     // Read the map lump containing the segs into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
-
-    // PsyDoom: add to the hash for the map
+    // PsyDoom: read the lump and add it to the hash for the map in one pass
     #if PSYDOOM_MODS
-        MapHash::addData(pTmpBufferBytes, lumpSize);
+        W_ReadMapLumpAndHash(lumpNum, pTmpBufferBytes);
+    #else
+        W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
     #endif
 
     // Process the WAD segs and convert them into runtime segs
@@ -340,11 +402,11 @@ static void P_LoadSubSectors(const int32_t lumpNum) noexcept {
     D_memset(gpSubsectors, std::byte(0), gNumSubsectors * sizeof(subsector_t));
 
     // Read the map lump containing the subsectors into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
-
-    // PsyDoom: add to the hash for the map
+    // PsyDoom: read the lump and add it to the hash for the map in one pass
     #if PSYDOOM_MODS
-        MapHash::addData(pTmpBufferBytes, lumpSize);
+        W_ReadMapLumpAndHash(lumpNum, pTmpBufferBytes);
+    #else
+        W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
     #endif
 
     // Process the WAD subsectors and convert them into runtime subsectors
@@ -352,8 +414,14 @@ static void P_LoadSubSectors(const int32_t lumpNum) noexcept {
     subsector_t* pDstSubsec = gpSubsectors;
 
     for (int32_t subsectorIdx = 0; subsectorIdx < gNumSubsectors; ++subsectorIdx) {
-        pDstSubsec->numsegs = Endian::littleToHost(pSrcSubsec->numsegs);
-        pDstSubsec->firstseg = Endian::littleToHost(pSrcSubsec->firstseg);
+        // PsyDoom: treat the seg indexes as unsigned in limit removing builds to allow up to 65,535 segs in the original map format
+        #if PSYDOOM_LIMIT_REMOVING
+            pDstSubsec->numsegs = (uint16_t) Endian::littleToHost(pSrcSubsec->numsegs);
+            pDstSubsec->firstseg = (uint16_t) Endian::littleToHost(pSrcSubsec->firstseg);
+        #else
+            pDstSubsec->numsegs = Endian::littleToHost(pSrcSubsec->numsegs);
+            pDstSubsec->firstseg = Endian::littleToHost(pSrcSubsec->firstseg);
+        #endif
         pDstSubsec->numLeafEdges = 0;
         pDstSubsec->firstLeafEdge = 0;
 
@@ -403,11 +471,11 @@ static void P_LoadSectors(const int32_t lumpNum) noexcept {
     D_memset(gpSectors, std::byte(0), gNumSectors * sizeof(sector_t));
 
     // Read the map lump containing the sectors into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
-
-    // PsyDoom: add to the hash for the map
+    // PsyDoom: read the lump and add it to the hash for the map in one pass
     #if PSYDOOM_MODS
-        MapHash::addData(pTmpBufferBytes, lumpSize);
+        W_ReadMapLumpAndHash(lumpNum, pTmpBufferBytes);
+    #else
+        W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
     #endif
 
     // Process the WAD sectors and convert them into runtime sectors
@@ -606,12 +674,17 @@ static void P_LoadNodes(const int32_t lumpNum) noexcept {
     gNumBspNodes = lumpSize / sizeof(mapnode_t);
     gpBspNodes = (node_t*) Z_Malloc(*gpMainMemZone, gNumBspNodes * sizeof(node_t), PU_LEVEL, nullptr);
 
-    // Read the map lump containing the nodes into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
+    // PsyDoom: alloc ram for the packed copy of the nodes also
+    #if PSYDOOM_MODS
+        gpPackedBspNodes = (packednode_t*) Z_Malloc(*gpMainMemZone, std::max(gNumBspNodes, 1) * (int32_t) sizeof(packednode_t), PU_LEVEL, nullptr);
+    #endif
 
-    // PsyDoom: add to the hash for the map
+    // Read the map lump containing the nodes into a temp buffer from the map WAD
+    // PsyDoom: read the lump and add it to the hash for the map in one pass
     #if PSYDOOM_MODS
-        MapHash::addData(pTmpBufferBytes, lumpSize);
+        W_ReadMapLumpAndHash(lumpNum, pTmpBufferBytes);
+    #else
+        W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
     #endif
 
     // Process the WAD nodes and convert them into runtime nodes.
@@ -626,7 +699,13 @@ static void P_LoadNodes(const int32_t lumpNum) noexcept {
         pDstNode->line.dy = d_int_to_fixed(Endian::littleToHost(pSrcNode->dy));
 
         for (int32_t childIdx = 0; childIdx < 2; ++childIdx) {
-            pDstNode->children[childIdx] = Endian::littleToHost(pSrcNode->children[childIdx]);
+            // PsyDoom: in limit removing builds the subsector flag is moved to the top bit of the 32-bit runtime child index
+            #if PSYDOOM_LIMIT_REMOVING
+                const uint32_t child = Endian::littleToHost(pSrcNode->children[childIdx]);
+                pDstNode->children[childIdx] = (child & NF_SUBSECTOR_16) ? (int32_t)((child & (~NF_SUBSECTOR_16)) | NF_SUBSECTOR) : (int32_t) child;
+            #else
+                pDstNode->children[childIdx] = Endian::littleToHost(pSrcNode->children[childIdx]);
+            #endif
 
             for (int32_t coordIdx = 0; coordIdx < 4; ++coordIdx) {
                 const fixed_t coord = d_int_to_fixed(Endian::littleToHost(pSrcNode->bbox[childIdx][coordIdx]));
@@ -634,6 +713,17 @@ static void P_LoadNodes(const int32_t lumpNum) noexcept {
             }
         }
 
+        // PsyDoom: populate the packed copy of the node too
+        #if PSYDOOM_MODS
+            packednode_t& packedNode = gpPackedBspNodes[nodeIdx];
+            packedNode.x = Endian::littleToHost(pSrcNode->x);
+            packedNode.y = Endian::littleToHost(pSrcNode->y);
+            packedNode.dx = Endian::littleToHost(pSrcNode->dx);
+            packedNode.dy = Endian::littleToHost(pSrcNode->dy);
+            packedNode.children[0] = pDstNode->children[0];
+            packedNode.children[1] = pDstNode->children[1];
+        #endif
+
         ++pSrcNode;
         ++pDstNode;
     }
@@ -660,13 +750,16 @@ static void P_LoadThings(const int32_t lumpNum) noexcept {
 
     // Determine how many things there are to spawn and read the lump from the WAD
     const int32_t numThings = lumpSize / sizeof(mapthing_t);
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
 
-    // PsyDoom: add to the hash for the map and reset the list containing all player starts (including duplicates)
+    // PsyDoom: read the lump and add it to the hash for the map in one pass, and reset the list containing all player starts (including duplicates).
+    // Also build the lookup of thing types by DoomEd number, used to spawn each thing.
     #if PSYDOOM_MODS
-        MapHash::addData(pTmpBufferBytes, lumpSize);
+        W_ReadMapLumpAndHash(lumpNum, pTmpBufferBytes);
         gAllPlayerStarts.clear();
         gAllPlayerStarts.reserve(12);
+        P_InitDoomEdNumLookup();
+    #else
+        W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
     #endif
 
     // Spawn the map things
@@ -717,11 +810,11 @@ static void P_LoadLineDefs(const int32_t lumpNum) noexcept {
     D_memset(gpLines, std::byte(0), gNumLines * sizeof(line_t));
 
     // Read the map lump containing the sidedefs into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
-
-    // PsyDoom: add to the hash for the map
+    // PsyDoom: read the lump and add it to the hash for the map in one pass
     #if PSYDOOM_MODS
-        MapHash::addData(pTmpBufferBytes, lumpSize);
+        W_ReadMapLumpAndHash(lumpNum, pTmpBufferBytes);
+    #else
+        W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
     #endif
 
     // Process the WAD linedefs and convert them into runtime linedefs
@@ -828,11 +921,11 @@ static void P_LoadSideDefs(const int32_t lumpNum) noexcept {
     D_memset(gpSides, std::byte(0), gNumSides * sizeof(side_t));
 
     // Read the map lump containing the sidedefs into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
-
-    // PsyDoom: add to the hash for the map
+    // PsyDoom: read the lump and add it to the hash for the map in one pass
     #if PSYDOOM_MODS
-        MapHash::addData(pTmpBufferBytes, lumpSize);
+        W_ReadMapLumpAndHash(lumpNum, pTmpBufferBytes);
+    #else
+        W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
     #endif
 
     // Process the WAD sidedefs and convert them into runtime sidedefs
@@ -914,11 +1007,13 @@ static void P_LoadBlockMap(const int32_t lumpNum) noexcept {
     // Read the blockmap lump into RAM
     const int32_t lumpSize = W_MapLumpLength(lumpNum);
     gpBlockmapLump = (uint16_t*) Z_Malloc(*gpMainMemZone, lumpSize, PU_LEVEL, nullptr);
-    W_ReadMapLump(lumpNum, gpBlockmapLump, true);
 
-    // PsyDoom: add to the hash for the map
+    // PsyDoom: read the lump and add it to the hash for the map in one pass, and remember the lump size for building the compact blockmap
     #if PSYDOOM_MODS
-        MapHash::addData(gpBlockmapLump, lumpSize);
+        W_ReadMapLumpAndHash(lumpNum, gpBlockmapLump);
+        gBlockmapLumpNumWords = lumpSize / (int32_t) sizeof(uint16_t);
+    #else
+        W_ReadMapLump(lumpNum, gpBlockmapLump, true);
     #endif
 
     // The first 8 bytes of the blockmap are it's header
@@ -964,19 +1059,270 @@ static void P_LoadBlockMap(const int32_t lumpNum) noexcept {
     const int32_t blockLinksSize = blockmapHeader.width * blockmapHeader.height * (int32_t) sizeof(gppBlockLinks[0]);
     gppBlockLinks = (mobj_t**) Z_Malloc(*gpMainMemZone, blockLinksSize, PU_LEVEL, nullptr);
     D_memset(gppBlockLinks, std::byte(0), blockLinksSize);
+
+    // PsyDoom: alloc and zero initialize the count of cells with things in them, for each chunk of blockmap cells
+    #if PSYDOOM_MODS
+        constexpr int32_t CHUNK_SIZE = 1 << BLOCKMAP_CHUNK_SHIFT;
+        gBlockmapChunksWidth = std::max((gBlockmapWidth + CHUNK_SIZE - 1) >> BLOCKMAP_CHUNK_SHIFT, 1);
+        gBlockmapChunksHeight = std::max((gBlockmapHeight + CHUNK_SIZE - 1) >> BLOCKMAP_CHUNK_SHIFT, 1);
+
+        const int32_t chunkCountsSize = gBlockmapChunksWidth * gBlockmapChunksHeight * (int32_t) sizeof(gpBlockmapChunkNumUsedCells[0]);
+        gpBlockmapChunkNumUsedCells = (uint8_t*) Z_Malloc(*gpMainMemZone, chunkCountsSize, PU_LEVEL, nullptr);
+        D_memset(gpBlockmapChunkNumUsedCells, std::byte(0), chunkCountsSize);
+    #endif
 }
 
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: helper for 'P_BuildBlockmapCellBspNodes'.
+// Determines which side of the given BSP node's partition line 'R_PointOnSide' would put ALL points in the given box on.
+// Returns '-1' if points in the box could be put on different sides of the line.
+//
+// This works because 'R_PointOnSide' is a half-plane test on the integer (floored) coordinates of the point relative to the line, and both
+// half-planes are convex: if all 4 corners of the box are on the same side then so is everything in between. Boxes where the integer
+// products in 'R_PointOnSide' could overflow (making the test non-linear) are always treated as straddling the line, to be safe.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t P_GetBoxNodeSide(const node_t& node, const fixed_t boxLx, const fixed_t boxTy, const fixed_t boxRx, const fixed_t boxBy) noexcept {
+    const auto getPointSide = [&](const fixed_t x, const fixed_t y) noexcept -> int32_t {
+        // Special case for vertical and horizontal lines: same logic as 'R_PointOnSide'
+        if (node.line.dx == 0) {
+            if (x <= node.line.x) {
+                return (node.line.dy > 0);
+            } else {
+                return (node.line.dy < 0);
+            }
+        }
+
+        if (node.line.dy == 0) {
+            if (y <= node.line.y) {
+                return (node.line.dx < 0);
+            } else {
+                return (node.line.dx > 0);
+            }
+        }
+
+        // Integer cross product test: bail if anything might overflow
+        const int64_t dx = (int64_t) x - node.line.x;
+        const int64_t dy = (int64_t) y - node.line.y;
+
+        if ((dx < INT32_MIN) || (dx > INT32_MAX) || (dy < INT32_MIN) || (dy > INT32_MAX))
+            return -1;
+
+        const int64_t lprod = (int64_t) d_fixed_to_int((fixed_t) dx) * d_fixed_to_int(node.line.dy);
+        const int64_t rprod = (int64_t) d_fixed_to_int((fixed_t) dy) * d_fixed_to_int(node.line.dx);
+
+        if ((lprod < INT32_MIN) || (lprod > INT32_MAX) || (rprod < INT32_MIN) || (rprod > INT32_MAX))
+            return -1;
+
+        return (rprod >= lprod);
+    };
+
+    const int32_t side = getPointSide(boxLx, boxTy);
+    const bool bAllOnSameSide = (
+        (side >= 0) &&
+        (getPointSide(boxRx, boxTy) == side) &&
+        (getPointSide(boxLx, boxBy) == side) &&
+        (getPointSide(boxRx, boxBy) == side)
+    );
+
+    return (bAllOnSameSide) ? side : -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: builds the list of the deepest BSP tree nodes containing each blockmap cell, once the blockmap and nodes are loaded.
+// For most cells this will be a single subsector, or a node which is only a few levels away from one.
+// 'R_PointInSubsector' can then begin it's BSP tree walk from this node, and arrive at exactly the same result as a walk from the root.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_BuildBlockmapCellBspNodes() noexcept {
+    gpBlockmapCellBspNodes = nullptr;
+
+    if ((gNumBspNodes <= 0) || (gBlockmapWidth <= 0) || (gBlockmapHeight <= 0))
+        return;
+
+    const int32_t numCells = gBlockmapWidth * gBlockmapHeight;
+    gpBlockmapCellBspNodes = (int32_t*) Z_Malloc(*gpMainMemZone, numCells * (int32_t) sizeof(int32_t), PU_LEVEL, nullptr);
+
+    for (int32_t cellY = 0; cellY < gBlockmapHeight; ++cellY) {
+        for (int32_t cellX = 0; cellX < gBlockmapWidth; ++cellX) {
+            // Get the bounds of the cell (inclusive) in 16.16 format, clamped to the range of coordinates that points can have
+            constexpr int64_t CELL_SIZE = MAPBLOCKSIZE;
+            const int64_t boxLx = (int64_t) gBlockmapOriginX + cellX * CELL_SIZE;
+            const int64_t boxBy = (int64_t) gBlockmapOriginY + cellY * CELL_SIZE;
+            const int64_t boxRx = boxLx + CELL_SIZE - 1;
+            const int64_t boxTy = boxBy + CELL_SIZE - 1;
+
+            const auto clampCoord = [](const int64_t coord) noexcept {
+                return (fixed_t) std::clamp<int64_t>(coord, INT32_MIN, INT32_MAX);
+            };
+
+            // Descend the BSP tree while the whole cell is on one side of each partition line
+            int32_t nodeNum = gNumBspNodes - 1;
+
+            while ((nodeNum & NF_SUBSECTOR) == 0) {
+                const node_t& node = gpBspNodes[nodeNum];
+                const int32_t side = P_GetBoxNodeSide(node, clampCoord(boxLx), clampCoord(boxTy), clampCoord(boxRx), clampCoord(boxBy));
+
+                if (side < 0)
+                    break;
+
+                nodeNum = node.children[side];
+            }
+
+            gpBlockmapCellBspNodes[cellY * gBlockmapWidth + cellX] = nodeNum;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: builds the compact blockmap from the blockmap lump, once lines have been loaded.
+//
+// The blockmap lump uses 16-bit offsets to the line list for each cell, which limits how big it can be. For blockmap lumps that exceed
+// this limit the offsets are assumed to have wrapped around and are 'unwrapped', by assuming that the line lists are stored in the same
+// order as the cells. Offsets which are out of bounds and line numbers which are invalid are ignored.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_BuildCompactBlockmap() noexcept {
+    const int32_t numCells = gBlockmapWidth * gBlockmapHeight;
+    const int32_t lumpNumWords = gBlockmapLumpNumWords;
+    const int32_t cellOffsetsBeg = (int32_t)(gpBlockmap - gpBlockmapLump);
+    const bool bUnwrapOffsets = (lumpNumWords > UINT16_MAX + 1);
+
+    // Figure out where each cell's line list starts in the blockmap lump (in words)
+    std::vector<int32_t> lumpCellOffsets((size_t) std::max(numCells, 0));
+    int32_t offsetBase = 0;
+    int32_t prevOffset = 0;
+
+    for (int32_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+        if (cellOffsetsBeg + cellIdx >= lumpNumWords) {
+            lumpCellOffsets[cellIdx] = -1;
+            continue;
+        }
+
+        int32_t offset = offsetBase + gpBlockmap[cellIdx];
+
+        if (bUnwrapOffsets && (offset + INT16_MAX < prevOffset)) {
+            offsetBase += UINT16_MAX + 1;
+            offset += UINT16_MAX + 1;
+        }
+
+        prevOffset = offset;
+        lumpCellOffsets[cellIdx] = (offset < lumpNumWords) ? offset : -1;
+    }
+
+    // Count how many entries are needed for all of the line lists
+    int32_t numEntries = 0;
+
+    for (int32_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+        for (int32_t wordIdx = lumpCellOffsets[cellIdx]; (wordIdx >= 0) && (wordIdx < lumpNumWords); ++wordIdx) {
+            const uint16_t lineNum = gpBlockmapLump[wordIdx];
+
+            if (lineNum == UINT16_MAX)
+                break;
+
+            if (lineNum < gNumLines) {
+                ++numEntries;
+            }
+        }
+
+        ++numEntries;   // List terminator
+    }
+
+    // Alloc the compact blockmap
+    gpBlockmapCellLists = (int32_t*) Z_Malloc(*gpMainMemZone, std::max(numCells, 1) * (int32_t) sizeof(int32_t), PU_LEVEL, nullptr);
+    gpBlockmapLineNums = (int32_t*) Z_Malloc(*gpMainMemZone, numEntries * (int32_t) sizeof(int32_t), PU_LEVEL, nullptr);
+    gpBlockmapLineBoxTop = (fixed_t*) Z_Malloc(*gpMainMemZone, numEntries * (int32_t) sizeof(fixed_t), PU_LEVEL, nullptr);
+    gpBlockmapLineBoxBottom = (fixed_t*) Z_Malloc(*gpMainMemZone, numEntries * (int32_t) sizeof(fixed_t), PU_LEVEL, nullptr);
+    gpBlockmapLineBoxLeft = (fixed_t*) Z_Malloc(*gpMainMemZone, numEntries * (int32_t) sizeof(fixed_t), PU_LEVEL, nullptr);
+    gpBlockmapLineBoxRight = (fixed_t*) Z_Malloc(*gpMainMemZone, numEntries * (int32_t) sizeof(fixed_t), PU_LEVEL, nullptr);
+
+    // Fill in the line lists for each cell, preserving the original order of lines in each list
+    int32_t entryIdx = 0;
+
+    for (int32_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+        gpBlockmapCellLists[cellIdx] = entryIdx;
+
+        for (int32_t wordIdx = lumpCellOffsets[cellIdx]; (wordIdx >= 0) && (wordIdx < lumpNumWords); ++wordIdx) {
+            const uint16_t lineNum = gpBlockmapLump[wordIdx];
+
+            if (lineNum == UINT16_MAX)
+                break;
+
+            if (lineNum < gNumLines) {
+                const line_t& line = gpLines[lineNum];
+                gpBlockmapLineNums[entryIdx] = lineNum;
+                gpBlockmapLineBoxTop[entryIdx] = line.bbox[BOXTOP];
+                gpBlockmapLineBoxBottom[entryIdx] = line.bbox[BOXBOTTOM];
+                gpBlockmapLineBoxLeft[entryIdx] = line.bbox[BOXLEFT];
+                gpBlockmapLineBoxRight[entryIdx] = line.bbox[BOXRIGHT];
+                ++entryIdx;
+            }
+        }
+
+        gpBlockmapLineNums[entryIdx] = -1;
+        gpBlockmapLineBoxTop[entryIdx] = 0;
+        gpBlockmapLineBoxBottom[entryIdx] = 0;
+        gpBlockmapLineBoxLeft[entryIdx] = 0;
+        gpBlockmapLineBoxRight[entryIdx] = 0;
+        ++entryIdx;
+    }
+
+    // Alloc the blockmap of special lines: the line lists can never need more entries than the full blockmap has.
+    // It is built the first time it is used.
+    gpBlockmapSpecialCellLists = (int32_t*) Z_Malloc(*gpMainMemZone, std::max(numCells, 1) * (int32_t) sizeof(int32_t), PU_LEVEL, nullptr);
+    gpBlockmapSpecialLineNums = (int32_t*) Z_Malloc(*gpMainMemZone, numEntries * (int32_t) sizeof(int32_t), PU_LEVEL, nullptr);
+    gbSpecialLineBlockmapDirty = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: flags that the blockmap of special lines needs to be rebuilt.
+// Must be called whenever a line is given a special after the level has been loaded.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_InvalidateSpecialLineBlockmap() noexcept {
+    gbSpecialLineBlockmapDirty = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: rebuilds the blockmap of special lines from the compact blockmap, if it needs to be rebuilt.
+// Lines whose special has since been cleared are left in the lists, so users must still check that each line has a special.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_UpdateSpecialLineBlockmap() noexcept {
+    if (!gbSpecialLineBlockmapDirty)
+        return;
+
+    ASSERT(gpBlockmapSpecialCellLists && gpBlockmapSpecialLineNums);
+    const int32_t numCells = gBlockmapWidth * gBlockmapHeight;
+    const line_t* const pLines = gpLines;
+    int32_t entryIdx = 0;
+
+    for (int32_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+        gpBlockmapSpecialCellLists[cellIdx] = entryIdx;
+
+        for (const int32_t* pLineNum = gpBlockmapLineNums + gpBlockmapCellLists[cellIdx]; *pLineNum != -1; ++pLineNum) {
+            if (pLines[*pLineNum].special != 0) {
+                gpBlockmapSpecialLineNums[entryIdx] = *pLineNum;
+                ++entryIdx;
+            }
+        }
+
+        gpBlockmapSpecialLineNums[entryIdx] = -1;
+        ++entryIdx;
+    }
+
+    gbSpecialLineBlockmapDirty = false;
+}
+#endif  // #if PSYDOOM_MODS
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Load the reject map from the specified map lump number
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void P_LoadRejectMap(const int32_t lumpNum) noexcept {
     const int32_t lumpSize = W_MapLumpLength(lumpNum);
     gpRejectMatrix = (uint8_t*) Z_Malloc(*gpMainMemZone, lumpSize, PU_LEVEL, nullptr);
-    W_ReadMapLump(lumpNum, gpRejectMatrix, true);
 
-    // PsyDoom: add to the hash for the map
+    // PsyDoom: read the lump and add it to the hash for the map in one pass
     #if PSYDOOM_MODS
-        MapHash::addData(gpRejectMatrix, lumpSize);
+        W_ReadMapLumpAndHash(lumpNum, gpRejectMatrix);
+    #else
+        W_ReadMapLump(lumpNum, gpRejectMatrix, true);
     #endif
 }
 
@@ -1000,15 +1346,16 @@ static void P_LoadLeafs(const int32_t lumpNum) noexcept {
     #endif
 
     // Read the map lump containing the leaf edges into a temp buffer from the map WAD
-    W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
-    const std::byte* const pLumpBeg = pTmpBufferBytes;
-    const std::byte* const pLumpEnd = pTmpBufferBytes + lumpSize;
-
-    // PsyDoom: add to the hash for the map
+    // PsyDoom: read the lump and add it to the hash for the map in one pass
     #if PSYDOOM_MODS
-        MapHash::addData(pTmpBufferBytes, lumpSize);
+        W_ReadMapLumpAndHash(lumpNum, pTmpBufferBytes);
+    #else
+        W_ReadMapLump(lumpNum, pTmpBufferBytes, true);
     #endif
 
+    const std::byte* const pLumpBeg = pTmpBufferBytes;
+    const std::byte* const pLumpEnd = pTmpBufferBytes + lumpSize;
+
     // Determine the number of leafs in the lump.
     // The number of leafs MUST equal the number of subsectors, and they must be in the same order as their subsectors.
     int32_t numLeafs = 0;
@@ -1048,7 +1395,7 @@ static void P_LoadLeafs(const int32_t lumpNum) noexcept {
 
         // Save leaf info on the subsector
         pSubsec->numLeafEdges = leaf.numedges;
-        pSubsec->firstLeafEdge = (int16_t) gTotalNumLeafEdges;
+        pSubsec->firstLeafEdge = (decltype(pSubsec->firstLeafEdge)) gTotalNumLeafEdges;     // PsyDoom: don't truncate to 16-bits in limit removing builds
 
         // Process the edges in the leaf
         for (int32_t edgeIdx = 0; edgeIdx < pSubsec->numLeafEdges; ++edgeIdx) {
@@ -1086,6 +1433,380 @@ static void P_LoadLeafs(const int32_t lumpNum) noexcept {
     }
 }
 
+#if PSYDOOM_LIMIT_REMOVING
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom limit removing: support for ZDoom style extended GL nodes (uncompressed 'XGLN', 'XGL2' and 'XGL3' formats).
+// These formats use 32-bit indexes throughout and allow for maps far beyond the limits of the original 16-bit map lumps.
+// The GL segs in these formats each describe one edge of a closed convex subsector polygon, which means they double up as the PSX
+// 'LEAFS' lump as well as the regular 'SEGS' lump (after discarding the 'minisegs' which have no associated linedef).
+//------------------------------------------------------------------------------------------------------------------------------------------
+enum class ExtNodesFormat : uint8_t {
+    XGLN,   // 16-bit linedef numbers and 16-bit node partition lines
+    XGL2,   // 32-bit linedef numbers and 16-bit node partition lines
+    XGL3    // 32-bit linedef numbers and 16.16 fixed point node partition lines
+};
+
+// The contents of the extended nodes lump for the map currently being loaded and it's format.
+// Also where the subsectors start in the lump, after the vertices.
+// The lump buffer is cleared once the level is loaded but kept around to avoid reallocations.
+static std::vector<std::byte>   gExtNodesLump;
+static ExtNodesFormat           gExtNodesFormat;
+static uint32_t                 gExtNodesSubsecOffset;
+
+// The number of original vertices as specified by the extended nodes lump and the index where the extra GL vertices start in 'gpVertexes'
+static uint32_t gExtNodesNumOrgVerts;
+static uint32_t gExtNodesFirstNewVert;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: reads little endian values from the extended nodes lump, with bounds checks
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct ExtNodesReader {
+    uint32_t offset;
+
+    void ensureBytesLeft(const uint64_t numBytes) const noexcept {
+        if (offset + numBytes > gExtNodesLump.size()) {
+            I_Error("P_LoadExtendedNodes: unexpected end of lump!");
+        }
+    }
+
+    template <class T>
+    T read() noexcept {
+        ensureBytesLeft(sizeof(T));
+        T value;
+        std::memcpy(&value, gExtNodesLump.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return Endian::littleToHost(value);
+    }
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: tries to read and identify extended nodes from the specified lump.
+// Returns 'true' if the lump contains extended nodes which can be loaded, in which case the lump is saved for loading.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool P_TryReadExtendedNodesLump(const int32_t lumpNum) noexcept {
+    if (lumpNum < 0)
+        return false;
+
+    const int32_t lumpSize = W_MapLumpLength(lumpNum);
+
+    if (lumpSize < 4)
+        return false;
+
+    gExtNodesLump.resize((size_t) lumpSize);
+    W_ReadMapLump(lumpNum, gExtNodesLump.data(), true);
+
+    // Identify the format
+    char magic[4];
+    std::memcpy(magic, gExtNodesLump.data(), 4);
+
+    const auto isMagic = [&](const char* const otherMagic) noexcept {
+        return (std::memcmp(magic, otherMagic, 4) == 0);
+    };
+
+    if (isMagic("XGLN")) {
+        gExtNodesFormat = ExtNodesFormat::XGLN;
+    } else if (isMagic("XGL2")) {
+        gExtNodesFormat = ExtNodesFormat::XGL2;
+    } else if (isMagic("XGL3")) {
+        gExtNodesFormat = ExtNodesFormat::XGL3;
+    } else if (isMagic("ZGLN") || isMagic("ZGL2") || isMagic("ZGL3") || isMagic("ZNOD")) {
+        I_Error("P_LoadExtendedNodes: compressed nodes are not supported!\nRebuild the nodes uncompressed.");
+    } else if (isMagic("XNOD")) {
+        I_Error("P_LoadExtendedNodes: non-GL extended nodes are not supported!\nRebuild the map with extended GL nodes.");
+    } else {
+        gExtNodesLump.clear();
+        return false;
+    }
+
+    gExtNodesSubsecOffset = 4;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Checks to see if the map being loaded has extended GL nodes and reads them for loading if so.
+// The nodes may be in a 'ZNODES' lump, or stored in place of the 'SSECTORS' or 'NODES' lump.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool P_ReadExtendedNodesLump() noexcept {
+    return (
+        P_TryReadExtendedNodesLump(W_MapCheckNumForName("ZNODES")) ||
+        P_TryReadExtendedNodesLump(W_MapCheckNumForName("SSECTORS")) ||
+        P_TryReadExtendedNodesLump(W_MapCheckNumForName("NODES"))
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Loads the extra GL vertices in the extended nodes lump, appending them to the map's vertices.
+// Must be called after the regular vertices are loaded and before anything else references the vertex array.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_LoadExtendedNodesVertexes() noexcept {
+    ExtNodesReader reader = { gExtNodesSubsecOffset };
+    gExtNodesNumOrgVerts = reader.read<uint32_t>();
+    const uint32_t numNewVerts = reader.read<uint32_t>();
+
+    if (gExtNodesNumOrgVerts > (uint32_t) gNumVertexes) {
+        I_Error("P_LoadExtendedNodes: nodes use more vertices than the map has!");
+    }
+
+    reader.ensureBytesLeft(numNewVerts * uint64_t(8));
+
+    // Make a new vertex array with room for the extra vertices and copy the original vertices in
+    const int32_t numTotalVerts = gNumVertexes + (int32_t) numNewVerts;
+    vertex_t* const pNewVertexes = (vertex_t*) Z_Malloc(*gpMainMemZone, numTotalVerts * (int32_t) sizeof(vertex_t), PU_LEVEL, nullptr);
+    std::memcpy(pNewVertexes, gpVertexes, gNumVertexes * sizeof(vertex_t));
+    Z_Free2(*gpMainMemZone, gpVertexes);
+
+    gExtNodesFirstNewVert = (uint32_t) gNumVertexes;
+    gpVertexes = pNewVertexes;
+    gNumVertexes = numTotalVerts;
+
+    // Read the extra vertices, which are in 16.16 fixed point format
+    for (uint32_t i = 0; i < numNewVerts; ++i) {
+        vertex_t& vertex = gpVertexes[gExtNodesFirstNewVert + i];
+        vertex = {};
+        vertex.x = reader.read<fixed_t>();
+        vertex.y = reader.read<fixed_t>();
+        vertex.frameUpdated = 0;
+    }
+
+    gExtNodesSubsecOffset = reader.offset;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: converts a vertex index in the extended nodes lump to a runtime vertex
+//------------------------------------------------------------------------------------------------------------------------------------------
+static vertex_t& P_GetExtendedNodesVertex(const uint32_t vertexNum) noexcept {
+    const uint64_t vertexIdx = (vertexNum < gExtNodesNumOrgVerts) ? vertexNum : (uint64_t) vertexNum - gExtNodesNumOrgVerts + gExtNodesFirstNewVert;
+
+    if (vertexIdx >= (uint64_t) gNumVertexes) {
+        I_Error("P_LoadExtendedNodes: vertex out of range!");
+    }
+
+    return gpVertexes[vertexIdx];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Loads subsectors, segs, leafs and nodes from the extended nodes lump.
+// Replaces loading of the 'SSECTORS', 'NODES', 'SEGS' and 'LEAFS' lumps.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_LoadExtendedNodes() noexcept {
+    // Add the lump to the hash for the map
+    MapHash::addData(gExtNodesLump.data(), (int32_t) gExtNodesLump.size());
+
+    // Read the subsectors: the GL seg count for each subsector is the number of leaf edges it has
+    ExtNodesReader reader = { gExtNodesSubsecOffset };
+    const uint32_t numSubsecs = reader.read<uint32_t>();
+    reader.ensureBytesLeft(numSubsecs * uint64_t(4));
+
+    gNumSubsectors = (int32_t) numSubsecs;
+    gpSubsectors = (subsector_t*) Z_Malloc(*gpMainMemZone, gNumSubsectors * (int32_t) sizeof(subsector_t), PU_LEVEL, nullptr);
+    D_memset(gpSubsectors, std::byte(0), gNumSubsectors * sizeof(subsector_t));
+
+    uint64_t totalGlSegs = 0;
+
+    for (int32_t subsecIdx = 0; subsecIdx < gNumSubsectors; ++subsecIdx) {
+        subsector_t& subsec = gpSubsectors[subsecIdx];
+        subsec.numLeafEdges = (int32_t) reader.read<uint32_t>();
+        subsec.firstLeafEdge = (int32_t) totalGlSegs;
+        subsec.vkDrawSubsecIdx = -1;
+        totalGlSegs += (uint32_t) subsec.numLeafEdges;
+    }
+
+    // Read the GL segs and verify they match up with the subsectors
+    struct GlSeg {
+        vertex_t*   pVertex;
+        int32_t     lineNum;    // -1 if a 'miniseg' which has no associated linedef
+        uint8_t     side;
+    };
+
+    const uint32_t numGlSegs = reader.read<uint32_t>();
+
+    if (numGlSegs != totalGlSegs) {
+        I_Error("P_LoadExtendedNodes: seg/subsector inconsistancy!");
+    }
+
+    const uint32_t glSegSize = (gExtNodesFormat == ExtNodesFormat::XGLN) ? 11 : 13;
+    reader.ensureBytesLeft(numGlSegs * uint64_t(glSegSize));
+
+    std::vector<GlSeg> glSegs;
+    glSegs.resize(numGlSegs);
+    int32_t numRealSegs = 0;
+
+    for (GlSeg& glSeg : glSegs) {
+        glSeg.pVertex = &P_GetExtendedNodesVertex(reader.read<uint32_t>());
+        reader.read<uint32_t>();    // Partner seg: not used
+
+        uint32_t lineNum;
+
+        if (gExtNodesFormat == ExtNodesFormat::XGLN) {
+            lineNum = reader.read<uint16_t>();
+            lineNum = (lineNum == 0xFFFFu) ? UINT32_MAX : lineNum;
+        } else {
+            lineNum = reader.read<uint32_t>();
+        }
+
+        glSeg.side = reader.read<uint8_t>();
+
+        if (lineNum != UINT32_MAX) {
+            if ((lineNum >= (uint32_t) gNumLines) || (glSeg.side > 1)) {
+                I_Error("P_LoadExtendedNodes: bad seg linedef or side!");
+            }
+
+            glSeg.lineNum = (int32_t) lineNum;
+            ++numRealSegs;
+        } else {
+            glSeg.lineNum = -1;
+        }
+    }
+
+    // Build the runtime segs and leaf edges for each subsector.
+    // The end point for each GL seg is the start point of the next seg in the subsector's polygon.
+    gNumSegs = numRealSegs;
+    gpSegs = (seg_t*) Z_Malloc(*gpMainMemZone, std::max(gNumSegs, 1) * (int32_t) sizeof(seg_t), PU_LEVEL, nullptr);
+    D_memset(gpSegs, std::byte(0), gNumSegs * sizeof(seg_t));
+
+    gTotalNumLeafEdges = (int32_t) numGlSegs;
+    gpLeafEdges = (leafedge_t*) Z_Malloc(*gpMainMemZone, std::max(gTotalNumLeafEdges, 1) * (int32_t) sizeof(leafedge_t), PU_LEVEL, nullptr);
+
+    seg_t* pDstSeg = gpSegs;
+
+    for (int32_t subsecIdx = 0; subsecIdx < gNumSubsectors; ++subsecIdx) {
+        subsector_t& subsec = gpSubsectors[subsecIdx];
+        subsec.firstseg = (int32_t)(pDstSeg - gpSegs);
+
+        for (int32_t edgeIdx = 0; edgeIdx < subsec.numLeafEdges; ++edgeIdx) {
+            const GlSeg& glSeg = glSegs[subsec.firstLeafEdge + edgeIdx];
+            const GlSeg& nextGlSeg = glSegs[subsec.firstLeafEdge + (edgeIdx + 1) % subsec.numLeafEdges];
+
+            leafedge_t& leafEdge = gpLeafEdges[subsec.firstLeafEdge + edgeIdx];
+            leafEdge.vertex = glSeg.pVertex;
+
+            // Minisegs only produce a leaf edge
+            if (glSeg.lineNum < 0) {
+                leafEdge.seg = nullptr;
+                continue;
+            }
+
+            leafEdge.seg = pDstSeg;
+
+            // Store basic seg properties: note that the angle and offset are computed with the same precision as the original map format
+            line_t& linedef = gpLines[glSeg.lineNum];
+            pDstSeg->vertex1 = glSeg.pVertex;
+            pDstSeg->vertex2 = nextGlSeg.pVertex;
+            pDstSeg->angle = R_PointToAngle2(pDstSeg->vertex1->x, pDstSeg->vertex1->y, pDstSeg->vertex2->x, pDstSeg->vertex2->y) & 0xFFFF0000;
+
+            const vertex_t& lineStartVert = (glSeg.side == 0) ? *linedef.vertex1 : *linedef.vertex2;
+            const double offsetDx = (double) pDstSeg->vertex1->x - (double) lineStartVert.x;
+            const double offsetDy = (double) pDstSeg->vertex1->y - (double) lineStartVert.y;
+            pDstSeg->offset = d_int_to_fixed((int32_t)(std::sqrt(offsetDx * offsetDx + offsetDy * offsetDy) / FRACUNIT));
+
+            // Figure out seg line and side
+            pDstSeg->linedef = &linedef;
+            const int32_t sideNum = linedef.sidenum[glSeg.side];
+
+            if (sideNum < 0) {
+                I_Error("P_LoadExtendedNodes: seg references a missing sidedef!");
+            }
+
+            side_t& side = gpSides[sideNum];
+            pDstSeg->sidedef = &side;
+
+            // Set front and backsector reference
+            pDstSeg->frontsector = side.sector;
+
+            if (linedef.flags & ML_TWOSIDED) {
+                const int32_t backSideNum = linedef.sidenum[glSeg.side ^ 1];
+                side_t& backSide = gpSides[backSideNum];
+                pDstSeg->backsector = backSide.sector;
+            } else {
+                pDstSeg->backsector = nullptr;
+            }
+
+            // Take this opportunity to compute line fineangle if the seg is pointing in the same direction
+            if (linedef.vertex1 == pDstSeg->vertex1) {
+                linedef.fineangle = pDstSeg->angle >> ANGLETOFINESHIFT;
+            }
+
+            ++pDstSeg;
+        }
+
+        // Every subsector needs at least one real seg so it's sector can be determined
+        subsec.numsegs = (int32_t)(pDstSeg - gpSegs) - subsec.firstseg;
+
+        if (subsec.numsegs <= 0) {
+            I_Error("P_LoadExtendedNodes: subsector %d has no segs!", subsecIdx);
+        }
+    }
+
+    // Read the nodes
+    const uint32_t numNodes = reader.read<uint32_t>();
+    const uint32_t nodeSize = (gExtNodesFormat == ExtNodesFormat::XGL3) ? 40 : 32;
+    reader.ensureBytesLeft(numNodes * uint64_t(nodeSize));
+
+    gNumBspNodes = (int32_t) numNodes;
+    gpBspNodes = (node_t*) Z_Malloc(*gpMainMemZone, std::max(gNumBspNodes, 1) * (int32_t) sizeof(node_t), PU_LEVEL, nullptr);
+    gpPackedBspNodes = (packednode_t*) Z_Malloc(*gpMainMemZone, std::max(gNumBspNodes, 1) * (int32_t) sizeof(packednode_t), PU_LEVEL, nullptr);
+
+    for (int32_t nodeIdx = 0; nodeIdx < gNumBspNodes; ++nodeIdx) {
+        node_t& node = gpBspNodes[nodeIdx];
+        packednode_t& packedNode = gpPackedBspNodes[nodeIdx];
+
+        if (gExtNodesFormat == ExtNodesFormat::XGL3) {
+            node.line.x = reader.read<fixed_t>();
+            node.line.y = reader.read<fixed_t>();
+            node.line.dx = reader.read<fixed_t>();
+            node.line.dy = reader.read<fixed_t>();
+
+            // The packed nodes (and the original map format) only support whole number partition lines
+            if ((node.line.x | node.line.y | node.line.dx | node.line.dy) & (FRACUNIT - 1)) {
+                I_Error("P_LoadExtendedNodes: fractional node partition lines are not supported!\nRebuild the nodes in 'XGLN' or 'XGL2' format.");
+            }
+
+            // They also only support 16-bit partition line coordinates and deltas
+            const auto isInt16Range = [](const fixed_t coord) noexcept {
+                const int32_t intCoord = d_fixed_to_int(coord);
+                return ((intCoord >= INT16_MIN) && (intCoord <= INT16_MAX));
+            };
+
+            if ((!isInt16Range(node.line.x)) || (!isInt16Range(node.line.y)) || (!isInt16Range(node.line.dx)) || (!isInt16Range(node.line.dy))) {
+                I_Error("P_LoadExtendedNodes: node partition line out of range!");
+            }
+        } else {
+            node.line.x = d_int_to_fixed(reader.read<int16_t>());
+            node.line.y = d_int_to_fixed(reader.read<int16_t>());
+            node.line.dx = d_int_to_fixed(reader.read<int16_t>());
+            node.line.dy = d_int_to_fixed(reader.read<int16_t>());
+        }
+
+        for (int32_t childIdx = 0; childIdx < 2; ++childIdx) {
+            for (int32_t coordIdx = 0; coordIdx < 4; ++coordIdx) {
+                node.bbox[childIdx][coordIdx] = d_int_to_fixed(reader.read<int16_t>());
+            }
+        }
+
+        for (int32_t childIdx = 0; childIdx < 2; ++childIdx) {
+            const uint32_t child = reader.read<uint32_t>();
+            const uint32_t childNum = child & (~NF_SUBSECTOR);
+
+            if ((child & NF_SUBSECTOR) ? (childNum >= numSubsecs) : (childNum >= numNodes)) {
+                I_Error("P_LoadExtendedNodes: node child out of range!");
+            }
+
+            node.children[childIdx] = (int32_t) child;
+        }
+
+        packedNode.x = (int16_t) d_fixed_to_int(node.line.x);
+        packedNode.y = (int16_t) d_fixed_to_int(node.line.y);
+        packedNode.dx = (int16_t) d_fixed_to_int(node.line.dx);
+        packedNode.dy = (int16_t) d_fixed_to_int(node.line.dy);
+        packedNode.children[0] = node.children[0];
+        packedNode.children[1] = node.children[1];
+    }
+
+    // Done with the lump
+    gExtNodesLump.clear();
+}
+#endif  // #if PSYDOOM_LIMIT_REMOVING
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Builds the line lists for each sector, bounding boxes as well as sound origin points
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -1220,6 +1941,60 @@ static void P_GroupLines() noexcept {
     }
 }
 
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: allocates the index of sectors by tag, once sectors have been loaded.
+// The index is built the first time it is used.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void P_AllocSectorTagIndex() noexcept {
+    gpSectorIdxsByTag = (int32_t*) Z_Malloc(*gpMainMemZone, std::max(gNumSectors, 1) * (int32_t) sizeof(int32_t), PU_LEVEL, nullptr);
+    gbSectorTagIndexDirty = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: flags that the index of sectors by tag needs to be rebuilt.
+// Must be called whenever the tag of a sector is changed after the level has been loaded.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_InvalidateSectorTagIndex() noexcept {
+    gbSectorTagIndexDirty = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: gets the range of sector indexes with the given tag, in ascending order.
+// Rebuilds the index of sectors by tag first if needed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_GetSectorsWithTag(const int32_t tag, const int32_t*& pBeg, const int32_t*& pEnd) noexcept {
+    ASSERT(gpSectorIdxsByTag);
+    const sector_t* const pSectors = gpSectors;
+    const int32_t numSectors = gNumSectors;
+
+    if (gbSectorTagIndexDirty) {
+        for (int32_t i = 0; i < numSectors; ++i) {
+            gpSectorIdxsByTag[i] = i;
+        }
+
+        std::sort(gpSectorIdxsByTag, gpSectorIdxsByTag + numSectors, [=](const int32_t i1, const int32_t i2) noexcept {
+            const int32_t tag1 = pSectors[i1].tag;
+            const int32_t tag2 = pSectors[i2].tag;
+            return (tag1 != tag2) ? (tag1 < tag2) : (i1 < i2);
+        });
+
+        gbSectorTagIndexDirty = false;
+    }
+
+    const int32_t* const pIdxsBeg = gpSectorIdxsByTag;
+    const int32_t* const pIdxsEnd = gpSectorIdxsByTag + numSectors;
+
+    pBeg = std::lower_bound(pIdxsBeg, pIdxsEnd, tag, [=](const int32_t sectorIdx, const int32_t value) noexcept {
+        return (pSectors[sectorIdx].tag < value);
+    });
+
+    pEnd = std::upper_bound(pBeg, pIdxsEnd, tag, [=](const int32_t value, const int32_t sectorIdx) noexcept {
+        return (value < pSectors[sectorIdx].tag);
+    });
+}
+#endif  // #if PSYDOOM_MODS
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Loads wall, floor and switch textures into VRAM.
 // For animated textures the first frame will be put into VRAM and the rest of the animation cached in main RAM.
@@ -1336,6 +2111,11 @@ static void P_Init() noexcept {
             gPaletteClutId_CurMapSky = gPaletteClutIds[skyPaletteIdx];
             gUpdateFireSkyFunc = P_UpdateFireSky;
 
+            // PsyDoom: VRAM might have been overwritten since the fire sky was last uploaded, do a full upload next time
+            #if PSYDOOM_MODS
+                P_ResetFireSkyUploadRows();
+            #endif
+
             // PsyDoom: updates to work with the new WAD management code - ensure texture metrics are up-to-date!
             #if PSYDOOM_MODS
             {
@@ -1571,6 +2351,11 @@ static void P_Init() noexcept {
 // Note: while most of the loading and setup is done here for the level, sound and music are handled eleswhere.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) noexcept {
+    #if PSYDOOM_MODS
+        // PsyDoom: record this function in the profiler (compiles to nothing unless the profiler is enabled)
+        PROFILE_ZONE("P_SetupLevel");
+    #endif
+
     // Cleanup of memory and resetting the RNG before we start
     Z_FreeTags(*gpMainMemZone, PU_CACHE | PU_LEVSPEC| PU_LEVEL);
 
@@ -1596,6 +2381,11 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
     Z_CheckHeap(*gpMainMemZone);
     M_ClearRandom();
 
+    // PsyDoom: texture cache search length statistics are tracked per level
+    #if PSYDOOM_MODS
+        gTexCacheStats.maxSearchLen = 0;
+    #endif
+
     // PsyDoom: initialize the map object weak referencing system and mark the level as not complete
     #if PSYDOOM_MODS
         P_InitWeakRefs();
@@ -1629,6 +2419,10 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
     gMobjHead.next = &gMobjHead;
     gMobjHead.prev = &gMobjHead;
 
+    #if PSYDOOM_MODS
+        P_ClearMobjTypeLists();     // PsyDoom: the per-type lists of things must be reset along with the global list
+    #endif
+
     // Setup the item respawn queue and dead player removal queue index
     gItemRespawnQueueHead = 0;
     gItemRespawnQueueTail = 0;
@@ -1702,15 +2496,41 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
     // PsyDoom: clear the map hash before starting to load level lumps that will add to the hash.
     #if PSYDOOM_MODS
         MapHash::clear();
+
+        // PsyDoom: read and decompress all the map lumps up front (using the job worker threads) so the loaders below just copy them
+        P_PrefetchMapLumps();
+        Utils::doPlatformUpdates();     // PsyDoom: keep handling window events etc. during each stage of a potentially long level load
+
+        // PsyDoom limit removing: check if the map has extended GL nodes first, which replace the subsectors, nodes, segs and leafs
+        #if PSYDOOM_LIMIT_REMOVING
+            const bool bHasExtNodes = P_ReadExtendedNodesLump();
+        #endif
+
         P_LoadBlockMap(W_MapGetNumForName("BLOCKMAP"));
         P_LoadVertexes(W_MapGetNumForName("VERTEXES"));
+
+        #if PSYDOOM_LIMIT_REMOVING
+            if (bHasExtNodes) {
+                P_LoadExtendedNodesVertexes();
+            }
+        #endif
+
         P_LoadSectors(W_MapGetNumForName("SECTORS"));
         P_LoadSideDefs(W_MapGetNumForName("SIDEDEFS"));
         P_LoadLineDefs(W_MapGetNumForName("LINEDEFS"));
-        P_LoadSubSectors(W_MapGetNumForName("SSECTORS"));
-        P_LoadNodes(W_MapGetNumForName("NODES"));
-        P_LoadSegs(W_MapGetNumForName("SEGS"));
-        P_LoadLeafs(W_MapGetNumForName("LEAFS"));
+
+        #if PSYDOOM_LIMIT_REMOVING
+            if (bHasExtNodes) {
+                P_LoadExtendedNodes();
+            } else
+        #endif
+        {
+            P_LoadSubSectors(W_MapGetNumForName("SSECTORS"));
+            P_LoadNodes(W_MapGetNumForName("NODES"));
+            P_LoadSegs(W_MapGetNumForName("SEGS"));
+            P_LoadLeafs(W_MapGetNumForName("LEAFS"));
+        }
+
         P_LoadRejectMap(W_MapGetNumForName("REJECT"));
     #else
         P_LoadBlockMap(mapStartLump + ML_BLOCKMAP);
@@ -1725,9 +2545,24 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
         P_LoadRejectMap(mapStartLump + ML_REJECT);
     #endif
 
+    // PsyDoom: build the list of BSP nodes containing each blockmap cell, which speeds up point in subsector queries
+    #if PSYDOOM_MODS
+        P_BuildBlockmapCellBspNodes();
+    #endif
+
     // Build sector line lists etc.
     P_GroupLines();
 
+    #if PSYDOOM_MODS
+        Utils::doPlatformUpdates();
+    #endif
+
+    // PsyDoom: build the compact blockmap now that lines are loaded, and setup the index of sectors by tag
+    #if PSYDOOM_MODS
+        P_BuildCompactBlockmap();
+        P_AllocSectorTagIndex();
+    #endif
+
     // Load and spawn map things; also initialize the next deathmatch start
     gpDeathmatchP = &gDeathmatchStarts[0];
 
@@ -1737,6 +2572,9 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
         ScriptingEngine::init();                        // PsyDoom: initialize the scripting engine if the map has Lua scripted actions
         MapHash::finalize();                            // PsyDoom: compute the final map hash
         MapPatcher::applyPatches();                     // PsyDoom: apply any patches to original map data that are relevant at this point, once all things have been loaded
+        P_InvalidateSectorTagIndex();                   // PsyDoom: map patches may have changed sector tags
+        P_InvalidateSpecialLineBlockmap();              // PsyDoom: map patches may also have changed line specials
+        ScriptBindings::invalidateLineTagIndex();       // PsyDoom: likewise for the script API's index of lines by tag
 
         // PsyDoom: forcing open boss triggered doors etc. if appropriate:
         const bool bIsDeathmatch = (gNetGame == gt_deathmatch);
@@ -1758,7 +2596,16 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
     P_SpawnSpecials();
 
     #if PSYDOOM_MODS
+        Utils::doPlatformUpdates();
+    #endif
+
+    // PsyDoom: the map geometry is entirely new, so invalidate all cached sight check results from before.
+    // Also load or build the precomputed sight PVS for the map, now that all map data is loaded and patched.
+    #if PSYDOOM_MODS
+        gSectorGeometryEpoch++;
+        SightPvs::init();
         W_CloseMapWad();
+        Utils::doPlatformUpdates();
     #else
         Z_Free2(*gpMainMemZone, pMapWadFileData);
     #endif
@@ -1785,6 +2632,7 @@ void P_SetupLevel(const int32_t mapNum, [[maybe_unused]] const skill_t skill) no
 
     // PsyDoom: precache all sprites needed for the level
     #if PSYDOOM_MODS
+        Utils::doPlatformUpdates();
         MobjSpritePrecacher::doPrecaching();
     #endif
 
@@ -1959,6 +2807,15 @@ static void P_LoadMapTextures() noexcept {
     gLoadTextureList.clear();
     gLoadTextureList.reserve((size_t)(gCacheFlatTextureSet.size() + gCacheTextureSet.size()));
 
+    // Cache all of the texture lumps in one batch first, so that decompression can be spread across the job worker threads
+    {
+        std::vector<int32_t> texLumpNums;
+        texLumpNums.reserve(gLoadTextureList.capacity());
+        gCacheTextureSet.forEachIndex([&](const uint64_t idx) noexcept { texLumpNums.push_back(gpTextures[idx].lumpNum); });
+        gCacheFlatTextureSet.forEachIndex([&](const uint64_t idx) noexcept { texLumpNums.push_back(gpFlatTextures[idx].lumpNum); });
+        W_CacheLumpNums(texLumpNums.data(), (int32_t) texLumpNums.size(), PU_CACHE, true);
+    }
+
     gCacheTextureSet.forEachIndex(
         [](const uint64_t idx) noexcept {
             texture_t& tex = gpTextures[idx];
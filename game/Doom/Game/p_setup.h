@@ -8,6 +8,7 @@ struct leafedge_t;
 struct line_t;
 struct mapthing_t;
 struct node_t;
+struct packednode_t;
 struct seg_t;
 struct side_t;
 struct texture_t;
@@ -46,6 +47,20 @@ extern mapthing_t*      gpDeathmatchP;
 
 #if PSYDOOM_MODS
     extern char gLevelStartupWarning[64];
+
+    extern packednode_t*    gpPackedBspNodes;
+    extern uint8_t*         gpBlockmapChunkNumUsedCells;
+    extern int32_t          gBlockmapChunksWidth;
+    extern int32_t          gBlockmapChunksHeight;
+    extern int32_t*         gpBlockmapCellLists;
+    extern int32_t*         gpBlockmapLineNums;
+    extern fixed_t*         gpBlockmapLineBoxTop;
+    extern fixed_t*         gpBlockmapLineBoxBottom;
+    extern fixed_t*         gpBlockmapLineBoxLeft;
+    extern fixed_t*         gpBlockmapLineBoxRight;
+    extern int32_t*         gpBlockmapSpecialCellLists;
+    extern int32_t*         gpBlockmapSpecialLineNums;
+    extern int32_t*         gpBlockmapCellBspNodes;
 #endif
 
 #if PSYDOOM_LIMIT_REMOVING
@@ -59,4 +74,8 @@ void P_SetupLevel(const int32_t mapNum, const skill_t skill) noexcept;
 
 #if PSYDOOM_MODS
     void P_AddPlayerStart(const mapthing_t& mapThing) noexcept;
+    void P_InvalidateSectorTagIndex() noexcept;
+    void P_GetSectorsWithTag(const int32_t tag, const int32_t*& pBeg, const int32_t*& pEnd) noexcept;
+    void P_InvalidateSpecialLineBlockmap() noexcept;
+    void P_UpdateSpecialLineBlockmap() noexcept;
 #endif
@@ -439,10 +439,79 @@ int32_t PA_DivlineSide(const fixed_t x, const fixed_t y, const divline_t& line)
     return sideNum;
 }
 
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: same as 'PA_DivlineSide' but for the partition line of a packed BSP node.
+// Gives exactly the same result as 'PA_DivlineSide' does for the partition line of the equivalent unpacked node.
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t PA_PackedNodeSide(const fixed_t x, const fixed_t y, const packednode_t& node) noexcept {
+    const int32_t dx1 = d_fixed_to_int(x - d_int_to_fixed(node.x));
+    const int32_t dy1 = d_fixed_to_int(y - d_int_to_fixed(node.y));
+    const int32_t dx2 = node.dx;
+    const int32_t dy2 = node.dy;
+    const int32_t sideNum = (dx1 * dy2 <= dy1 * dx2);
+    return sideNum;
+}
+#endif
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Recursive sight checking: tells if the 'gShootDiv' line is blocked by the BSP tree halfspace represented by the given node.
 // Returns 'true' if the shooting sight line is unobstructed.
+//
+// PsyDoom: this is now done iteratively using an explicit stack and the packed BSP nodes. Subsectors are visited in exactly the same
+// order as the original recursive version. If the BSP tree is too deep for the stack then the function calls itself to handle subtrees.
 //------------------------------------------------------------------------------------------------------------------------------------------
+#if PSYDOOM_MODS
+bool PA_CrossBSPNode(const int32_t rootNodeNum) noexcept {
+    // Half-spaces still to be checked after the current one: these are the far sides of BSP splits which the shoot line crosses
+    int32_t nodeStack[BSP_TRAVERSE_STACK_SIZE];
+    int32_t stackSize = 0;
+    int32_t nodeNum = rootNodeNum;
+
+    while (true) {
+        // Is this bsp node actually a subsector? (leaf node) If so then do sight checks against that:
+        if (nodeNum & NF_SUBSECTOR) {
+            const int32_t subsecNum = nodeNum & (~NF_SUBSECTOR);
+
+            if (subsecNum < gNumSubsectors) {
+                if (!PA_CrossSubsector(gpSubsectors[subsecNum]))
+                    return false;
+            } else {
+                I_Error("PA_CrossSubsector: ss %i with numss = %i", subsecNum, gNumSubsectors);     // Bad subsector number!
+                return false;
+            }
+
+            // Done if there are no more half-spaces to check, otherwise move onto the next one
+            if (stackSize <= 0)
+                return true;
+
+            nodeNum = nodeStack[--stackSize];
+            continue;
+        }
+
+        // See what side of the bsp split the start and end points for sight checking are on.
+        // If the end point is on the other side then the opposite half-space must be checked after the closest one.
+        const packednode_t& bspNode = gpPackedBspNodes[nodeNum];
+        const int32_t sideNum = PA_PackedNodeSide(gShootDiv.x, gShootDiv.y, bspNode);
+
+        if (sideNum != PA_PackedNodeSide(gShootX2, gShootY2, bspNode)) {
+            // If the stack is full then handle this part of the tree with another call, and then move onto the next half-space
+            if (stackSize >= BSP_TRAVERSE_STACK_SIZE) {
+                if (!PA_CrossBSPNode(nodeNum))
+                    return false;
+
+                nodeNum = nodeStack[--stackSize];
+                continue;
+            }
+
+            nodeStack[stackSize++] = bspNode.children[sideNum ^ 1];
+        }
+
+        // Check the closest half-space next
+        nodeNum = bspNode.children[sideNum];
+    }
+}
+#else
 bool PA_CrossBSPNode(const int32_t nodeNum) noexcept {
     // Is this bsp node actually a subsector? (leaf node) If so then do sight checks against that:
     if (nodeNum & NF_SUBSECTOR) {
@@ -472,3 +541,4 @@ bool PA_CrossBSPNode(const int32_t nodeNum) noexcept {
     // Failing that recurse into the opposite side of the BSP split and raycast against that, returning the result
     return PA_CrossBSPNode(bspNode.children[sideNum ^ 1]);
 }
+#endif
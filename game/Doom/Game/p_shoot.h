@@ -4,6 +4,7 @@
 
 struct divline_t;
 struct line_t;
+struct packednode_t;
 
 extern mobj_t*      gpShootMobj;
 extern line_t*      gpShootLine;
@@ -18,3 +19,10 @@ bool PA_ShootLine(line_t& line, fixed_t hitFrac) noexcept;
 bool PA_ShootThing(mobj_t& thing, const fixed_t hitFrac) noexcept;
 bool PA_CrossBSPNode(const int32_t nodeNum) noexcept;
 int32_t PA_DivlineSide(const fixed_t x, const fixed_t y, const divline_t& line) noexcept;
+
+#if PSYDOOM_MODS
+    // PsyDoom: how many nodes deep the explicit stacks used for iterative BSP tree traversal can go
+    static constexpr int32_t BSP_TRAVERSE_STACK_SIZE = 64;
+
+    int32_t PA_PackedNodeSide(const fixed_t x, const fixed_t y, const packednode_t& node) noexcept;
+#endif
@@ -10,25 +10,201 @@
 #include "p_setup.h"
 #include "p_shoot.h"
 #include "p_tick.h"
+#include "PsyDoom/Config/Config.h"
 #include "PsyDoom/Game.h"
+#include "PsyDoom/GameJobs.h"
+#include "PsyDoom/SightPvs.h"
 
 #include <algorithm>
+#include <vector>
+
+// PsyDoom: the sight checking state is per thread, so that sight checks can be done on multiple threads at once
+#if PSYDOOM_MODS
+    #define SIGHT_STATE_STORAGE static thread_local
+#else
+    #define SIGHT_STATE_STORAGE static
+#endif
+
+SIGHT_STATE_STORAGE fixed_t     gSightZStart;       // Z position of thing looking
+SIGHT_STATE_STORAGE fixed_t     gTopSlope;          // Maximum/top unblocked viewing slope (clipped against upper walls)
+SIGHT_STATE_STORAGE fixed_t     gBottomSlope;       // Minimum/bottom unblocked viewing slope (clipped against lower walls)
+SIGHT_STATE_STORAGE divline_t   gSTrace;            // The start point and vector for sight checking
+SIGHT_STATE_STORAGE fixed_t     gT2x;               // End point for sight checking: x
+SIGHT_STATE_STORAGE fixed_t     gT2y;               // End point for sight checking: y
+SIGHT_STATE_STORAGE int32_t     gT1xs;              // Sight line start, whole coords: x
+SIGHT_STATE_STORAGE int32_t     gT1ys;              // Sight line start, whole coords: y
+SIGHT_STATE_STORAGE int32_t     gT2xs;              // Sight line end, whole coords: x
+SIGHT_STATE_STORAGE int32_t     gT2ys;              // Sight line end, whole coords: y
+
+#if PSYDOOM_MODS
+    // PsyDoom: set while the current thread is doing a sight check as part of a parallel batch of sight checks.
+    // In this mode no shared state is modified: the sight cache is not used and line 'validcount' marks are neither read nor written.
+    // This does not change the result of a sight check because checking the same line more than once always has the same outcome,
+    // as the vertical sight range can only be narrowed to the same slopes again.
+    static thread_local bool gbSightCheckInParallel;
+
+    // PsyDoom: the minimum number of sight checks in a tic for them to be spread across threads, and how many checks each job does
+    static constexpr uint32_t MIN_PARALLEL_SIGHT_CHECKS = 32;
+    static constexpr uint32_t SIGHT_CHECKS_PER_JOB = 8;
+
+    // PsyDoom: the map objects whose target's visibility is being checked in parallel, and the results for each
+    static std::vector<mobj_t*>     gParallelSightMobjs;
+    static std::vector<uint8_t>     gbParallelSightResults;
+#endif
+
+#if PSYDOOM_MODS
+    // PsyDoom: incremented whenever any sector floor or ceiling height changes, or when a new level/save is loaded.
+    // Sight check results cached under an older epoch are considered stale and are never returned.
+    uint32_t gSectorGeometryEpoch = 1;
+
+    // PsyDoom: a cached sight check result.
+    // The key is every input that the BSP traversal depends on (besides sector heights, which are covered by the epoch).
+    // Exact coordinates and slopes are used so that a cache hit always returns the same answer a full traversal would, keeping demos in sync.
+    struct SightCacheEntry {
+        uint32_t    epoch;          // Sector geometry epoch the result was computed under: '0' if the entry is unused
+        fixed_t     x1;             // Sight line start (masked): x
+        fixed_t     y1;             // Sight line start (masked): y
+        fixed_t     x2;             // Sight line end (masked): x
+        fixed_t     y2;             // Sight line end (masked): y
+        fixed_t     sightZStart;    // Eye height of the thing looking
+        fixed_t     topSlope;       // Initial top slope for the vertical sight range
+        fixed_t     bottomSlope;    // Initial bottom slope for the vertical sight range
+        bool        bCanSee;        // The result of the sight check
+    };
+
+    // Direct mapped cache of sight check results: must be a power of two in size
+    static constexpr uint32_t   SIGHT_CACHE_SIZE = 4096;
+    static SightCacheEntry      gSightCache[SIGHT_CACHE_SIZE];
+
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Computes which cache slot a sight check between the two given subsectors, with the specified inputs, maps to
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    static uint32_t P_SightCacheSlot(
+        const int32_t subsecNum1,
+        const int32_t subsecNum2,
+        const fixed_t x1,
+        const fixed_t y1,
+        const fixed_t x2,
+        const fixed_t y2,
+        const fixed_t sightZStart
+    ) noexcept {
+        uint32_t hash = (uint32_t) subsecNum1 * 0x9E3779B1u;
+        hash ^= (uint32_t) subsecNum2 * 0x85EBCA77u;
+        hash ^= ((uint32_t) x1 >> 17) * 0xC2B2AE3Du;
+        hash ^= ((uint32_t) y1 >> 17) * 0x27D4EB2Fu;
+        hash ^= ((uint32_t) x2 >> 17) * 0x165667B1u;
+        hash ^= ((uint32_t) y2 >> 17) * 0xD3A2646Cu;
+        hash ^= ((uint32_t) sightZStart >> 16);
+        hash ^= hash >> 15;
+        hash *= 0x2C1B3C6Du;
+        hash ^= hash >> 12;
+        return hash & (SIGHT_CACHE_SIZE - 1);
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Tells if sight checks for map objects can be spread across multiple threads in the current game
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    static bool P_CanDoParallelSightChecks() noexcept {
+        return (
+            Config::gbUseParallelSightChecks &&
+            (!gbDemoPlayback) &&
+            (!gbDemoRecording) &&
+            (gNetGame == gt_single) &&
+            (GameJobs::getNumWorkers() > 0)
+        );
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Tells if the given map object is one which 'P_CheckSights' does target visibility checks for
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    static bool P_MobjDoesSightChecks(const mobj_t& mobj) noexcept {
+        const bool bHasSeeState = (mobj.info->seestate != S_NULL);
+        const bool bIsNotPlayer = (mobj.type != MT_PLAYER);
+        return ((mobj.flags & MF_COUNTKILL) || (bHasSeeState && bIsNotPlayer));
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Job function which does one batch of the sight checks prepared by 'P_CheckSightsInParallel'
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    static void P_DoParallelSightChecksJob([[maybe_unused]] void* const pCtx, const uint32_t jobIdx) noexcept {
+        const uint32_t numChecks = (uint32_t) gParallelSightMobjs.size();
+        const uint32_t checksBeg = jobIdx * SIGHT_CHECKS_PER_JOB;
+        const uint32_t checksEnd = std::min(checksBeg + SIGHT_CHECKS_PER_JOB, numChecks);
+
+        gbSightCheckInParallel = true;
+
+        for (uint32_t checkIdx = checksBeg; checkIdx < checksEnd; ++checkIdx) {
+            mobj_t& mobj = *gParallelSightMobjs[checkIdx];
+            gbParallelSightResults[checkIdx] = P_CheckSight(mobj, *mobj.target);
+        }
+
+        gbSightCheckInParallel = false;
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Does the same work as 'P_CheckSights' but spreads the sight checks across multiple threads.
+    // The sight checks are all done first (which doesn't modify any game state), then the results are applied in map object list order.
+    // Returns 'false' if there were not enough sight checks to be worth doing them in parallel, in which case nothing is done.
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    static bool P_CheckSightsInParallel() noexcept {
+        // Gather up all of the map objects which need a sight check against their target.
+        // Use the exact same conditions as 'P_CheckSights' for this.
+        gParallelSightMobjs.clear();
+
+        for (mobj_t* pmobj = gMobjHead.next; pmobj != &gMobjHead; pmobj = pmobj->next) {
+            const bool bCheckSight = P_MobjDoesSightChecks(*pmobj);
+
+            if (bCheckSight && (pmobj->tics == 1) && pmobj->target) {
+                gParallelSightMobjs.push_back(pmobj);
+            }
+        }
 
-static fixed_t      gSightZStart;       // Z position of thing looking
-static fixed_t      gTopSlope;          // Maximum/top unblocked viewing slope (clipped against upper walls)
-static fixed_t      gBottomSlope;       // Minimum/bottom unblocked viewing slope (clipped against lower walls)
-static divline_t    gSTrace;            // The start point and vector for sight checking
-static fixed_t      gT2x;               // End point for sight checking: x
-static fixed_t      gT2y;               // End point for sight checking: y
-static int32_t      gT1xs;              // Sight line start, whole coords: x
-static int32_t      gT1ys;              // Sight line start, whole coords: y
-static int32_t      gT2xs;              // Sight line end, whole coords: x
-static int32_t      gT2ys;              // Sight line end, whole coords: y
+        const uint32_t numChecks = (uint32_t) gParallelSightMobjs.size();
+
+        if (numChecks < MIN_PARALLEL_SIGHT_CHECKS)
+            return false;
+
+        // Do all the sight checks
+        gbParallelSightResults.resize(numChecks);
+        GameJobs::run(P_DoParallelSightChecksJob, nullptr, (numChecks + SIGHT_CHECKS_PER_JOB - 1) / SIGHT_CHECKS_PER_JOB);
+
+        // Apply the results in map object list order.
+        // Map objects due a sight check which have no target simply lose the visibility flag, same as 'P_CheckSights' does.
+        uint32_t checkIdx = 0;
+
+        for (mobj_t* pmobj = gMobjHead.next; pmobj != &gMobjHead; pmobj = pmobj->next) {
+            if ((checkIdx < numChecks) && (pmobj == gParallelSightMobjs[checkIdx])) {
+                if (gbParallelSightResults[checkIdx]) {
+                    pmobj->flags |= MF_SEETARGET;
+                } else {
+                    pmobj->flags &= (~MF_SEETARGET);
+                }
+
+                ++checkIdx;
+                continue;
+            }
+
+            const bool bCheckSight = P_MobjDoesSightChecks(*pmobj);
+
+            if (bCheckSight && (pmobj->tics == 1)) {
+                pmobj->flags &= (~MF_SEETARGET);
+            }
+        }
+
+        return true;
+    }
+#endif
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Updates target visibility checking for all map objects that are due an update
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_CheckSights() noexcept {
+    // PsyDoom: spread the sight checks across multiple threads if enabled and there are enough of them
+    #if PSYDOOM_MODS
+        if (P_CanDoParallelSightChecks() && P_CheckSightsInParallel())
+            return;
+    #endif
+
     for (mobj_t* pmobj = gMobjHead.next; pmobj != &gMobjHead; pmobj = pmobj->next) {
         // Must be killable (enemy) to do sight checking.
         //
@@ -114,12 +290,59 @@ bool P_CheckSight(mobj_t& mobj1, mobj_t& mobj2) noexcept {
     gTopSlope = mobj2.z + mobj2.height - sightZStart;
     gBottomSlope = mobj2.z - sightZStart;
 
+    // PsyDoom: early out if the precomputed sight PVS says that no line between these two points can ever be unobstructed
+    #if PSYDOOM_MODS
+        if (SightPvs::isSightBlocked(*mobj1.subsector, gSTrace.x, gSTrace.y, *mobj2.subsector, gT2x, gT2y))
+            return false;
+    #endif
+
+    // PsyDoom: see if the result of this exact sight check is already known and still valid for the current sector heights.
+    // Note that skipping the 'validcount' increment on a cache hit is safe since that is only ever compared for equality.
+    // PsyDoom: if this sight check is part of a parallel batch then don't touch the cache or the 'validcount' marks at all, since they are shared.
+    #if PSYDOOM_MODS
+        if (gbSightCheckInParallel)
+            return PS_CrossBSPNode(gNumBspNodes - 1);
+
+        const int32_t subsecNum1 = (int32_t)(mobj1.subsector - gpSubsectors);
+        const int32_t subsecNum2 = (int32_t)(mobj2.subsector - gpSubsectors);
+        SightCacheEntry& cacheEntry = gSightCache[P_SightCacheSlot(subsecNum1, subsecNum2, gSTrace.x, gSTrace.y, gT2x, gT2y, sightZStart)];
+
+        const bool bCacheHit = (
+            (cacheEntry.epoch == gSectorGeometryEpoch) &&
+            (cacheEntry.x1 == gSTrace.x) &&
+            (cacheEntry.y1 == gSTrace.y) &&
+            (cacheEntry.x2 == gT2x) &&
+            (cacheEntry.y2 == gT2y) &&
+            (cacheEntry.sightZStart == sightZStart) &&
+            (cacheEntry.topSlope == gTopSlope) &&
+            (cacheEntry.bottomSlope == gBottomSlope)
+        );
+
+        if (bCacheHit)
+            return cacheEntry.bCanSee;
+
+        cacheEntry.epoch = gSectorGeometryEpoch;
+        cacheEntry.x1 = gSTrace.x;
+        cacheEntry.y1 = gSTrace.y;
+        cacheEntry.x2 = gT2x;
+        cacheEntry.y2 = gT2y;
+        cacheEntry.sightZStart = sightZStart;
+        cacheEntry.topSlope = gTopSlope;
+        cacheEntry.bottomSlope = gBottomSlope;
+    #endif
+
     // Doing a new raycast so update the visitation mark which tells us if stuff has already been processed
     gValidCount++;
 
     // Do a raycast against the BSP tree and return if sight is unobstructed.
     // Also narrows the vertical sight range with each lower and upper wall encountered.
-    return PS_CrossBSPNode(gNumBspNodes - 1);
+    #if PSYDOOM_MODS
+        const bool bCanSee = PS_CrossBSPNode(gNumBspNodes - 1);
+        cacheEntry.bCanSee = bCanSee;
+        return bCanSee;
+    #else
+        return PS_CrossBSPNode(gNumBspNodes - 1);
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -182,12 +405,21 @@ static bool PS_CrossSubsector(subsector_t& subsec) noexcept {
         line_t& line = *seg.linedef;
 
         // Skip past this seg's line if we've already done it this sight check.
-        // Multiple segs might reference the same line, so this saves redundant work:
-        if (line.validcount == gValidCount)
-            continue;
+        // Multiple segs might reference the same line, so this saves redundant work.
+        // PsyDoom: don't do this for sight checks which are done in parallel, as the 'validcount' marks are shared between threads.
+        #if PSYDOOM_MODS
+            const bool bUseValidCount = (!gbSightCheckInParallel);
+        #else
+            constexpr bool bUseValidCount = true;
+        #endif
+
+        if (bUseValidCount) {
+            if (line.validcount == gValidCount)
+                continue;
 
-        // Don't check the line again until the next sight check
-        line.validcount = gValidCount;
+            // Don't check the line again until the next sight check
+            line.validcount = gValidCount;
+        }
 
         // If the sight line does not intersect along the actual line points then ignore.
         // Not sure where the magics here came from, probably through hacking/experimentation?
@@ -272,7 +504,61 @@ static bool PS_CrossSubsector(subsector_t& subsec) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Recursive sight checking: tells if the 'gSTrace' line is blocked by the BSP tree halfspace represented by the given node.
 // Returns 'true' if the sight line is unobstructed.
+//
+// PsyDoom: this is now done iteratively using an explicit stack and the packed BSP nodes. Subsectors are visited in exactly the same
+// order as the original recursive version. If the BSP tree is too deep for the stack then the function calls itself to handle subtrees.
 //------------------------------------------------------------------------------------------------------------------------------------------
+#if PSYDOOM_MODS
+bool PS_CrossBSPNode(const int32_t rootNodeNum) noexcept {
+    // Half-spaces still to be checked after the current one: these are the far sides of BSP splits which the sight line crosses
+    int32_t nodeStack[BSP_TRAVERSE_STACK_SIZE];
+    int32_t stackSize = 0;
+    int32_t nodeNum = rootNodeNum;
+
+    while (true) {
+        // Is this bsp node actually a subsector? (leaf node) If so then do sight checks against that:
+        if (nodeNum & NF_SUBSECTOR) {
+            const int32_t subsecNum = nodeNum & (~NF_SUBSECTOR);
+
+            if (subsecNum < gNumSubsectors) {
+                if (!PS_CrossSubsector(gpSubsectors[subsecNum]))
+                    return false;
+            } else {
+                I_Error("PS_CrossSubsector: ss %i with numss = %i", subsecNum, gNumSubsectors);     // Bad subsector number!
+                return false;
+            }
+
+            // Done if there are no more half-spaces to check, otherwise move onto the next one
+            if (stackSize <= 0)
+                return true;
+
+            nodeNum = nodeStack[--stackSize];
+            continue;
+        }
+
+        // See what side of the bsp split the start and end points for sight checking are on.
+        // If the end point is on the other side then the opposite half-space must be checked after the closest one.
+        const packednode_t& bspNode = gpPackedBspNodes[nodeNum];
+        const int32_t sideNum = PA_PackedNodeSide(gSTrace.x, gSTrace.y, bspNode);
+
+        if (sideNum != PA_PackedNodeSide(gT2x, gT2y, bspNode)) {
+            // If the stack is full then handle this part of the tree with another call, and then move onto the next half-space
+            if (stackSize >= BSP_TRAVERSE_STACK_SIZE) {
+                if (!PS_CrossBSPNode(nodeNum))
+                    return false;
+
+                nodeNum = nodeStack[--stackSize];
+                continue;
+            }
+
+            nodeStack[stackSize++] = bspNode.children[sideNum ^ 1];
+        }
+
+        // Check the closest half-space next
+        nodeNum = bspNode.children[sideNum];
+    }
+}
+#else
 bool PS_CrossBSPNode(const int32_t nodeNum) noexcept {
     // Is this bsp node actually a subsector? (leaf node) If so then do sight checks against that:
     if (nodeNum & NF_SUBSECTOR) {
@@ -302,3 +588,4 @@ bool PS_CrossBSPNode(const int32_t nodeNum) noexcept {
     // Failing that recurse into the opposite side of the BSP split and raycast against that, returning the result
     return PS_CrossBSPNode(bspNode.children[sideNum ^ 1]);
 }
+#endif
@@ -188,8 +188,13 @@ static fixed_t P_CompletableFrac(const fixed_t dx, const fixed_t dy) noexcept {
     // Collide the movement line against all lines found in these cells.
     for (int32_t bmapX = bmapLx; bmapX <= bmapRx; ++bmapX) {
         for (int32_t bmapY = bmapBy; bmapY <= bmapTy; ++bmapY) {
-            // Get where the line numbers list for this blockmap cell starts in the blockmap
-            int16_t* pLineNum = (int16_t*) gpBlockmapLump + gpBlockmap[bmapX + bmapY * gBlockmapWidth];
+            // Get where the line numbers list for this blockmap cell starts in the blockmap.
+            // PsyDoom: use the compact blockmap instead, which has 32-bit offsets and line numbers.
+            #if PSYDOOM_MODS
+                const int32_t* pLineNum = gpBlockmapLineNums + gpBlockmapCellLists[bmapX + bmapY * gBlockmapWidth];
+            #else
+                int16_t* pLineNum = (int16_t*) gpBlockmapLump + gpBlockmap[bmapX + bmapY * gBlockmapWidth];
+            #endif
 
             // Collide against all of the lines in this cell
             for (; *pLineNum != -1; ++pLineNum) {
@@ -480,12 +485,24 @@ static void SL_CheckSpecialLines(const fixed_t moveX1, const fixed_t moveY1, con
 
     gValidCount++;
 
+    // PsyDoom: make sure the blockmap of special lines is up to date before using it
+    #if PSYDOOM_MODS
+        P_UpdateSpecialLineBlockmap();
+    #endif
+
     // Check for crossing lines in this blockmap area
     for (int32_t bmapX = bmapLx; bmapX <= bmapRx; ++bmapX) {
         for (int32_t bmapY = bmapBy; bmapY <= bmapTy; ++bmapY) {
-            const int32_t firstLineOffset = gpBlockmap[bmapX + bmapY * gBlockmapWidth];
-
-            for (int16_t* pLineNum = (int16_t*) &gpBlockmapLump[firstLineOffset]; *pLineNum != -1; ++pLineNum) {
+            // PsyDoom: use the blockmap of special lines instead, which has 32-bit offsets and line numbers and only lines with specials.
+            // Lines without specials were always skipped before being marked as checked, so this visits the same lines in the same order.
+            #if PSYDOOM_MODS
+                const int32_t* const pFirstLineNum = gpBlockmapSpecialLineNums + gpBlockmapSpecialCellLists[bmapX + bmapY * gBlockmapWidth];
+            #else
+                const int32_t firstLineOffset = gpBlockmap[bmapX + bmapY * gBlockmapWidth];
+                int16_t* const pFirstLineNum = (int16_t*) &gpBlockmapLump[firstLineOffset];
+            #endif
+
+            for (auto* pLineNum = pFirstLineNum; *pLineNum != -1; ++pLineNum) {
                 // Ignore the line if it has no special or if we already checked
                 line_t& line = gpLines[*pLineNum];
 
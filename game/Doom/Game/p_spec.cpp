@@ -31,6 +31,7 @@
 #include "PsyDoom/ParserTokenizer.h"
 #include "PsyDoom/ScriptingEngine.h"
 
+#include <algorithm>
 #include <cstdlib>
 #include <memory>
 #include <string>
@@ -535,18 +536,29 @@ fixed_t P_FindHighestCeilingSurrounding(sector_t& sector) noexcept {
 // Returns the index of the next matching sector found, or '-1' if there was no next matching sector.
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t P_FindSectorFromLineTag(line_t& line, const int32_t searchStart) noexcept {
-    const int32_t lineTag = line.tag;
-    sector_t* const pSectors = gpSectors;
-    const int32_t numSectors = gNumSectors;
+    // PsyDoom: use the index of sectors by tag to find the next sector instead of searching through all of them.
+    // Sectors are still found in the same order as before.
+    #if PSYDOOM_MODS
+        const int32_t* pBeg = nullptr;
+        const int32_t* pEnd = nullptr;
+        P_GetSectorsWithTag(line.tag, pBeg, pEnd);
+
+        const int32_t* const pNext = std::upper_bound(pBeg, pEnd, searchStart);
+        return (pNext != pEnd) ? *pNext : -1;
+    #else
+        const int32_t lineTag = line.tag;
+        sector_t* const pSectors = gpSectors;
+        const int32_t numSectors = gNumSectors;
 
-    for (int32_t sectorIdx = searchStart + 1; sectorIdx < numSectors; ++sectorIdx) {
-        sector_t& sector = pSectors[sectorIdx];
+        for (int32_t sectorIdx = searchStart + 1; sectorIdx < numSectors; ++sectorIdx) {
+            sector_t& sector = pSectors[sectorIdx];
 
-        if (sector.tag == lineTag)
-            return sectorIdx;
-    }
+            if (sector.tag == lineTag)
+                return sectorIdx;
+        }
 
-    return -1;
+        return -1;
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -1471,7 +1483,11 @@ bool EV_DoDonut(line_t& line) noexcept {
             // This raises the floor to the height of the back sector we just found and changes the texture to that.
             // This is normally used to raise slime and change the slime texture.
             {
-                floormove_t& floorMove = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #if PSYDOOM_MODS
+                    floormove_t& floorMove = *(floormove_t*) P_AllocThinker(sizeof(floormove_t));
+                #else
+                    floormove_t& floorMove = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #endif
 
                 #if PSYDOOM_MODS
                     floorMove = {};     // PsyDoom: zero-init all fields to be safe
@@ -1494,7 +1510,11 @@ bool EV_DoDonut(line_t& line) noexcept {
             // Create the mover for the inner part or the 'hole' of the donut.
             // This sector just lowers down to the height of the back sector we just found.
             {
-                floormove_t& floorMove = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #if PSYDOOM_MODS
+                    floormove_t& floorMove = *(floormove_t*) P_AllocThinker(sizeof(floormove_t));
+                #else
+                    floormove_t& floorMove = *(floormove_t*) Z_Malloc(*gpMainMemZone, sizeof(floormove_t), PU_LEVSPEC, nullptr);
+                #endif
 
                 #if PSYDOOM_MODS
                     floorMove = {};     // PsyDoom: zero-init all fields to be safe
@@ -1524,7 +1544,11 @@ bool EV_DoDonut(line_t& line) noexcept {
 // Schedule an action to be invoked after the specified number of tics
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void P_ScheduleDelayedAction(const int32_t delayTics, const delayed_actionfn_t actionFunc) noexcept {
-    delayaction_t& delayed = *(delayaction_t*) Z_Malloc(*gpMainMemZone, sizeof(delayaction_t), PU_LEVSPEC, nullptr);
+    #if PSYDOOM_MODS
+        delayaction_t& delayed = *(delayaction_t*) P_AllocThinker(sizeof(delayaction_t));
+    #else
+        delayaction_t& delayed = *(delayaction_t*) Z_Malloc(*gpMainMemZone, sizeof(delayaction_t), PU_LEVSPEC, nullptr);
+    #endif
     P_AddThinker(delayed.thinker);
 
     delayed.thinker.function = (think_t) &T_DelayedAction;
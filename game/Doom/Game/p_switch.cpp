@@ -23,6 +23,8 @@
 #include "PsyDoom/ParserTokenizer.h"
 #include "PsyDoom/ScriptingEngine.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 
 // Definitions for all of the switch textures built into the game
@@ -108,6 +110,12 @@ static constexpr int32_t BUTTONTIME = 1 * TICRATE;
     static int32_t gSwitchList[BASE_NUM_SWITCHES * 2];
 #endif
 
+// PsyDoom: for each wall texture, the first index in 'gSwitchList' which uses the texture or '-1' if the texture is not a switch texture.
+// This allows the switch for a wall texture to be found without searching the entire switch list.
+#if PSYDOOM_MODS
+    static std::vector<int32_t> gSwitchListIdxForTex;
+#endif
+
 #if PSYDOOM_MODS
 //------------------------------------------------------------------------------------------------------------------------------------------
 // PsyDoom addition: try to read a list of switch definitions from the named text lump.
@@ -247,7 +255,32 @@ void P_InitSwitchList() noexcept {
         pSwitchLump[1] = tex2Lump;
         pSwitchLump += 2;
     }
+
+    // PsyDoom: build the lookup of switch list index by texture, preferring the lowest index for each texture (same as a linear search)
+    #if PSYDOOM_MODS
+        gSwitchListIdxForTex.clear();
+        gSwitchListIdxForTex.resize(std::max(gNumTexLumps, 0), -1);
+
+        for (int32_t switchListIdx = (int32_t) gSwitchList.size() - 1; switchListIdx >= 0; --switchListIdx) {
+            const int32_t texNum = gSwitchList[switchListIdx];
+
+            if ((texNum >= 0) && (texNum < gNumTexLumps)) {
+                gSwitchListIdxForTex[texNum] = switchListIdx;
+            }
+        }
+    #endif
+}
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: returns the first index in the switch list which uses the specified wall texture, or 'INT32_MAX' if there is none
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t P_GetSwitchListIdxForTex(const int32_t texNum) noexcept {
+    const bool bValidTexNum = ((texNum >= 0) && (texNum < (int32_t) gSwitchListIdxForTex.size()));
+    const int32_t switchListIdx = (bValidTexNum) ? gSwitchListIdxForTex[texNum] : -1;
+    return (switchListIdx >= 0) ? switchListIdx : INT32_MAX;
 }
+#endif
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Save the state of a switch (current texture) for later restoration after a specified delay.
@@ -305,29 +338,40 @@ void P_ChangeSwitchTexture(line_t& line, const bool bUseAgain) noexcept {
     // If the switch is usable again, switch it back after a while.
     side_t& side = gpSides[line.sidenum[0]];
 
+    // Note: for all these cases the button should have a 'NULL' sound origin set because it's struct has been zero intialized.
+    // Therefore the initial switch sound will not play positionally, and will always be at full volume.
+    // I wonder is this odd for deathmatch though? 3DO DOOM appears to use the sector that the switch is in for the sound origin...
+    //
+    // PsyDoom: changing this behavior to play sounds at the center position of the switch.
+    // Should mean the volume will be lower for listeners further away.
+    // This also covers us for limit removing builds since 'gButtonList[0]' might not exist in the std::vector (we compact it constantly).
+    // The sound origin only depends on the line, so it is now computed once rather than for every switch list entry checked.
     #if PSYDOOM_MODS
-        const int32_t numSwitchStates = (int32_t) gSwitchList.size();   // PsyDoom: the switch state list is now dynamically sized
+        degenmobj_t soundOrigin = {};
+        soundOrigin.x = (line.vertex1->x + line.vertex2->x) / 2;    // Note: don't care about 'z' since it doesn't matter for sound
+        soundOrigin.y = (line.vertex1->y + line.vertex2->y) / 2;
+        soundOrigin.subsector = R_PointInSubsector(soundOrigin.x, soundOrigin.y);
+    #endif
+
+    // PsyDoom: find the switch list entry via the lookup by texture rather than searching the whole list.
+    // Only the first match in the list for the top, middle or bottom texture matters (same order as the original search), so only visit that.
+    #if PSYDOOM_MODS
+        const int32_t firstSwitchListIdx = std::min({
+            P_GetSwitchListIdxForTex(side.toptexture),
+            P_GetSwitchListIdxForTex(side.midtexture),
+            P_GetSwitchListIdxForTex(side.bottomtexture)
+        });
+
+        const int32_t switchListBegIdx = (firstSwitchListIdx != INT32_MAX) ? firstSwitchListIdx : 0;
+        const int32_t numSwitchStates = (firstSwitchListIdx != INT32_MAX) ? firstSwitchListIdx + 1 : 0;
     #else
+        const int32_t switchListBegIdx = 0;
         const int32_t numSwitchStates = NUM_SWITCHES * 2;
     #endif
 
-    for (int32_t switchListIdx = 0; switchListIdx < numSwitchStates; ++switchListIdx) {
+    for (int32_t switchListIdx = switchListBegIdx; switchListIdx < numSwitchStates; ++switchListIdx) {
         const int32_t switchTex = gSwitchList[switchListIdx];
 
-        // Note: for all these cases the button should have a 'NULL' sound origin set because it's struct has been zero intialized.
-        // Therefore the initial switch sound will not play positionally, and will always be at full volume.
-        // I wonder is this odd for deathmatch though? 3DO DOOM appears to use the sector that the switch is in for the sound origin...
-        //
-        // PsyDoom: changing this behavior to play sounds at the center position of the switch.
-        // Should mean the volume will be lower for listeners further away.
-        // This also covers us for limit removing builds since 'gButtonList[0]' might not exist in the std::vector (we compact it constantly).
-        #if PSYDOOM_MODS
-            degenmobj_t soundOrigin = {};
-            soundOrigin.x = (line.vertex1->x + line.vertex2->x) / 2;    // Note: don't care about 'z' since it doesn't matter for sound
-            soundOrigin.y = (line.vertex1->y + line.vertex2->y) / 2;
-            soundOrigin.subsector = R_PointInSubsector(soundOrigin.x, soundOrigin.y);
-        #endif
-
         if (switchTex == side.toptexture) {
             #if PSYDOOM_MODS
                 S_StartSound((mobj_t*) &soundOrigin, soundId);
@@ -14,6 +14,7 @@
 #include "p_mobj.h"
 #include "p_move.h"
 #include "p_setup.h"
+#include "p_spec.h"
 #include "p_tick.h"
 
 #include <cstdlib>
@@ -69,19 +70,30 @@ bool EV_Teleport(line_t& line, mobj_t& mobj) noexcept {
     // Search for a teleport destination marker in a sector with a tag matching the given line
     sector_t* const pSectors = gpSectors;
 
-    for (int32_t sectorIdx = 0; sectorIdx < gNumSectors; ++sectorIdx) {
-        // Ignore this sector if it doesn't have the right tag
-        sector_t& sector = pSectors[sectorIdx];
-
-        if (sector.tag != line.tag)
-            continue;
+    // PsyDoom: only visit the sectors with a matching tag, using the index of sectors by tag
+    #if PSYDOOM_MODS
+        for (int32_t sectorIdx = P_FindSectorFromLineTag(line, -1); sectorIdx >= 0; sectorIdx = P_FindSectorFromLineTag(line, sectorIdx)) {
+    #else
+        for (int32_t sectorIdx = 0; sectorIdx < gNumSectors; ++sectorIdx) {
+            // Ignore this sector if it doesn't have the right tag
+            sector_t& sector = pSectors[sectorIdx];
 
-        // Try to find a teleport destination that is in the target sector
-        for (mobj_t* pDstMarker = gMobjHead.next; pDstMarker != &gMobjHead; pDstMarker = pDstMarker->next) {
-            // Ignore if the marker is not a teleport marker or not in this sector
-            if (pDstMarker->type != MT_TELEPORTMAN)
+            if (sector.tag != line.tag)
                 continue;
+    #endif
+
+        // Try to find a teleport destination that is in the target sector.
+        // PsyDoom: only visit teleport markers, using the per-type lists of things.
+        #if PSYDOOM_MODS
+            for (mobj_t* pDstMarker = P_GetFirstMobjOfType(MT_TELEPORTMAN); pDstMarker; pDstMarker = pDstMarker->tnext) {
+        #else
+            for (mobj_t* pDstMarker = gMobjHead.next; pDstMarker != &gMobjHead; pDstMarker = pDstMarker->next) {
+                // Ignore if the marker is not a teleport marker
+                if (pDstMarker->type != MT_TELEPORTMAN)
+                    continue;
+        #endif
 
+            // Ignore if the marker is not in this sector
             const int32_t destSectorIdx = (int32_t)(pDstMarker->subsector->sector - pSectors);
 
             if (destSectorIdx != sectorIdx)
@@ -31,14 +31,18 @@
 #include "PsyDoom/DemoPlayer.h"
 #include "PsyDoom/DemoResult.h"
 #include "PsyDoom/DevMapAutoReloader.h"
+#include "PsyDoom/DevTexAutoReloader.h"
 #include "PsyDoom/Game.h"
 #include "PsyDoom/Input.h"
+#include "PsyDoom/LevelObjPool.h"
 #include "PsyDoom/MapInfo/MapInfo.h"
 #include "PsyDoom/PlayerPrefs.h"
 #include "PsyDoom/ProgArgs.h"
+#include "PsyDoom/Profiler.h"
 #include "PsyDoom/PsxPadButtons.h"
 #include "PsyDoom/SaveAndLoad.h"
 #include "PsyDoom/ScriptingEngine.h"
+#include "PsyDoom/TimeDemo.h"
 #include "PsyDoom/Video.h"
 #include "PsyQ/LIBGPU.h"
 #include "Wess/psxcd.h"
@@ -47,6 +51,7 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 
 // The number of buttons in a cheat sequence and a list of all the cheat sequences and their indices
 static constexpr int32_t CHEAT_SEQ_LEN = 8;
@@ -112,6 +117,62 @@ int32_t     gTicConOnPause;                         // What 1 vblank tick we pau
 static uint16_t     gCheatSequenceBtns[CHEAT_SEQ_LEN];      // Cheat sequence buttons inputted by the player
 static int32_t      gNumActiveThinkers;                     // Stat tracking count, no use other than that
 
+// PsyDoom limit removing: thinkers are allocated from pools of fixed size objects rather than directly from the zone heap.
+// Each pool holds thinkers up to a certain size, and the thinker structs are allocated from the smallest pool they fit in.
+#if PSYDOOM_LIMIT_REMOVING
+    static LevelObjPool gThinkerPools[] = {
+        { 32,  128, PU_LEVSPEC },
+        { 64,  128, PU_LEVSPEC },
+        { 96,  128, PU_LEVSPEC },
+        { 128, 128, PU_LEVSPEC },
+        { 192, 64,  PU_LEVSPEC },
+        { 256, 64,  PU_LEVSPEC },
+        { 512, 32,  PU_LEVSPEC },
+    };
+
+    static constexpr int32_t THINKER_POOL_OBJ_SIZES[] = { 32, 64, 96, 128, 192, 256, 512 };
+    static_assert(C_ARRAY_SIZE(THINKER_POOL_OBJ_SIZES) == C_ARRAY_SIZE(gThinkerPools));
+#endif
+
+#if PSYDOOM_MODS
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: allocates and zero initializes memory for a thinker of the given size.
+// The thinker must be freed via 'P_FreeThinker' or by freeing all 'PU_LEVSPEC' zone memory.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void* P_AllocThinker(const int32_t size) noexcept {
+    #if PSYDOOM_LIMIT_REMOVING
+        void* pThinker = nullptr;
+
+        for (int32_t poolIdx = 0; poolIdx < (int32_t) C_ARRAY_SIZE(gThinkerPools); ++poolIdx) {
+            if (size <= THINKER_POOL_OBJ_SIZES[poolIdx]) {
+                pThinker = gThinkerPools[poolIdx].alloc();
+                break;
+            }
+        }
+
+        if (!pThinker) {
+            I_Error("P_AllocThinker: thinker size %d is too big!", size);
+        }
+    #else
+        void* const pThinker = Z_Malloc(*gpMainMemZone, size, PU_LEVSPEC, nullptr);
+    #endif
+
+    std::memset(pThinker, 0, (size_t) size);
+    return pThinker;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: frees memory for a thinker that was allocated by 'P_AllocThinker'
+//------------------------------------------------------------------------------------------------------------------------------------------
+void P_FreeThinker(thinker_t& thinker) noexcept {
+    #if PSYDOOM_LIMIT_REMOVING
+        LevelObjPool::free(&thinker);
+    #else
+        Z_Free2(*gpMainMemZone, &thinker);
+    #endif
+}
+#endif  // #if PSYDOOM_MODS
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Add a thinker to the linked list of thinkers
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -141,7 +202,12 @@ void P_RunThinkers() noexcept {
             // Time to remove this thinker, it's function has been zapped
             pThinker->next->prev = pThinker->prev;
             pThinker->prev->next = pThinker->next;
-            Z_Free2(*gpMainMemZone, pThinker);
+
+            #if PSYDOOM_MODS
+                P_FreeThinker(*pThinker);
+            #else
+                Z_Free2(*gpMainMemZone, pThinker);
+            #endif
         } else {
             // Run the thinker if it has a think function and increment the active count stat
             if (pThinker->function) {
@@ -659,6 +725,11 @@ void P_CheckCheats() noexcept {
 // High level tick/update logic for main gameplay
 //------------------------------------------------------------------------------------------------------------------------------------------
 gameaction_t P_Ticker() noexcept {
+    #if PSYDOOM_MODS
+        // PsyDoom: record this function in the profiler (compiles to nothing unless the profiler is enabled)
+        PROFILE_ZONE("P_Ticker");
+    #endif
+
     gGameAction = ga_nothing;
 
     #if PSYDOOM_MODS
@@ -681,6 +752,9 @@ gameaction_t P_Ticker() noexcept {
             R_InterpBeginWorldFrame();
         }
 
+        // PsyDoom: show the result of any save that was being written in the background, if it has finished
+        UpdatePendingSave();
+
         // PsyDoom: fix certain sequencer music tracks in 'Final Doom' not looping correctly: if the sequencer track has ended then restart it.
         // Only do this check when the game is not paused however, since that stops the music.
         if (!gbGamePaused) {
@@ -726,17 +800,31 @@ gameaction_t P_Ticker() noexcept {
             }
         #endif
 
-        P_RunThinkers();
-        P_CheckSights();
+        #if PSYDOOM_MODS
+            // PsyDoom: time these subsystems if running a timedemo benchmark
+            {
+                TimeDemo::SectionTimer sectionTimer(TimeDemo::Section::RunThinkers);
+                P_RunThinkers();
+            }
+            {
+                TimeDemo::SectionTimer sectionTimer(TimeDemo::Section::CheckSights);
+                P_CheckSights();
+            }
+        #else
+            P_RunThinkers();
+            P_CheckSights();
+        #endif
+
         P_RunMobjBase();
         P_RunMobjLate();
         P_UpdateSpecials();
         P_RespawnSpecials();
         ST_Ticker();
 
-        // PsyDoom: allow the developer map auto-reloader to do it's thing and trigger a map reload if required
+        // PsyDoom: allow the developer map and texture auto-reloaders to do their thing and trigger reloads if required
         #if PSYDOOM_MODS
             DevMapAutoReloader::update();
+            DevTexAutoReloader::update();
         #endif
     }
 
@@ -758,6 +846,13 @@ gameaction_t P_Ticker() noexcept {
         P_PlayerThink(player);
     }
 
+    // PsyDoom: finish timing map scripts for this tick, now that everything which might trigger them has run
+    #if PSYDOOM_MODS
+        if (gGameTic > gPrevGameTic) {
+            ScriptingEngine::endTick();
+        }
+    #endif
+
     // PsyDoom: do quick save and load if requested in singleplayer (even if paused).
     // Only do them on 15 Hz (full game tick) boundaries however. Also this functionality is not available in the demo version.
     #if PSYDOOM_MODS
@@ -793,10 +888,16 @@ gameaction_t P_Ticker() noexcept {
 // Does all drawing for main gameplay
 //------------------------------------------------------------------------------------------------------------------------------------------
 void P_Drawer() noexcept {
-    // PsyDoom: no drawing in headless mode, but do advance the elapsed time.
+    #if PSYDOOM_MODS
+        // PsyDoom: record this function in the profiler (compiles to nothing unless the profiler is enabled)
+        PROFILE_ZONE("P_Drawer");
+    #endif
+
+    // PsyDoom: no drawing in headless mode (unless rendering without display was requested), but do advance the elapsed time.
     // Keep the framerate at the appropriate amount (for PAL or NTSC mode) for consistent demo playback.
+    // The same is done while fast forwarding a demo to a seek target, so that it gets there as quickly as possible.
     #if PSYDOOM_MODS
-        if (ProgArgs::gbHeadlessMode) {
+        if ((ProgArgs::gbHeadlessMode && (!ProgArgs::gbHeadlessRender)) || DemoPlayer::isFastForwarding()) {
             const int32_t demoTickVBlanks = (Game::gSettings.bUsePalTimings) ? 3 : VBLANKS_PER_TIC;
 
             gTotalVBlanks += demoTickVBlanks;
@@ -819,6 +920,11 @@ void P_Drawer() noexcept {
     if (bShowAutomap) {
         AM_Drawer();
     } else {
+        // PsyDoom: time the 3d view rendering if running a timedemo benchmark
+        #if PSYDOOM_MODS
+            TimeDemo::SectionTimer sectionTimer(TimeDemo::Section::RenderPlayerView);
+        #endif
+
         #if PSYDOOM_VULKAN_RENDERER
             // PsyDoom: use the new Vulkan renderer if enabled and bypass the classic one
             if (Video::isUsingVulkanRenderPath()) {
@@ -911,6 +1017,11 @@ void P_Start() noexcept {
             gbAutoSaveOnLevelStart = false;
             SaveGameForSlot(SaveFileSlot::AUTOSAVE, SaveGameContext::Autosave);
         }
+
+        // PsyDoom: start timing the demo if running a timedemo benchmark
+        if (gbDemoPlayback && ProgArgs::gTimeDemoResultFilePath[0]) {
+            TimeDemo::begin();
+        }
     #endif
 }
 
@@ -926,8 +1037,13 @@ void P_Stop([[maybe_unused]] const gameaction_t exitAction) noexcept {
     // Finish up any GPU related work
     LIBGPU_DrawSync(0);
 
-    // PsyDoom: save/check demo result if requested
+    // PsyDoom: save timedemo benchmark results and save/check demo result if requested
     #if PSYDOOM_MODS
+        if (TimeDemo::gbIsTiming) {
+            TimeDemo::end();
+            TimeDemo::saveToJsonFile(ProgArgs::gTimeDemoResultFilePath);
+        }
+
         if (gbDemoPlayback || gbDemoRecording) {
             if (ProgArgs::gSaveDemoResultFilePath[0]) {
                 DemoResult::saveToJsonFile(ProgArgs::gSaveDemoResultFilePath);
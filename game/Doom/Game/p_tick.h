@@ -68,6 +68,11 @@ extern int32_t      gTicConOnPause;
     extern uint32_t     gOldTicButtons[MAXPLAYERS];
 #endif
 
+#if PSYDOOM_MODS
+    void* P_AllocThinker(const int32_t size) noexcept;
+    void P_FreeThinker(thinker_t& thinker) noexcept;
+#endif
+
 void P_AddThinker(thinker_t& thinker) noexcept;
 void P_RemoveThinker(thinker_t& thinker) noexcept;
 void P_RunThinkers() noexcept;
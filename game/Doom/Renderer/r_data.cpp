@@ -151,9 +151,10 @@ static void forEachLumpList(
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Initialize the global wall textures list and load texture size metadata.
+// Initialize the global wall textures list.
 // Also initialize the texture translation table for animated wall textures.
 // PsyDoom: this function has been re-written, see the 'Old' code folder for the original version.
+// Texture size metadata is no longer loaded here, it is read from each texture's lump header when the texture is first loaded instead.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void R_InitTextures() noexcept {
     // Count the number of textures overall in the game.
@@ -255,8 +256,9 @@ static void R_InitFlats() noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Initialize the global sprite textures list and load sprite size and offset metadata.
+// Initialize the global sprite textures list.
 // PsyDoom: this function has been re-written, see the 'Old' code folder for the original version.
+// Sprite size and offset metadata is no longer loaded here, it is read from each sprite's lump header when the sprite is first loaded instead.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void R_InitSprites() noexcept {
     // Count the number of sprite lumps overall in the game.
@@ -13,8 +13,20 @@
 #include "r_sky.h"
 #include "r_things.h"
 
+#include <cstring>
 #include <vector>
 
+// PsyDoom: use SIMD instructions (SSE2 or NEON) to check what side of the view frustrum planes leaf points are on, if supported by the target
+#if PSYDOOM_MODS
+    #if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #define R_LEAF_SIMD_SSE2 1
+        #include <emmintrin.h>
+    #elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+        #define R_LEAF_SIMD_NEON 1
+        #include <arm_neon.h>
+    #endif
+#endif
+
 // The maximum number of new vertices that can be added to leafs by clipping operations.
 // If we happen to emit more than this then engine will fail with an error.
 // PsyDoom: this static limit no longer applies in the limit removing engine.
@@ -457,6 +469,76 @@ void R_FrontZClip(const leaf_t& inLeaf, leaf_t& outLeaf) noexcept {
     #endif
 }
 
+#if R_LEAF_SIMD_SSE2 || R_LEAF_SIMD_NEON
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: a SIMD version of the point classification done by 'R_CheckLeafSide', which works on 4 points at a time.
+// The view x and y values for each group of 4 points are gathered into a small structure of arrays first so they can be loaded as vectors.
+// Saves whether each point is on the outside of the plane (as '0' or '1') to the given list and returns the number of points on the outside.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <bool RightViewPlane>
+static int32_t R_ClassifyLeafPointsSimd(const leafedge_t* const pLeafEdges, const int32_t numLeafEdges, uint8_t* const pbPointsOnOutside) noexcept {
+    int32_t numOutside = 0;
+    int32_t edgeIdx = 0;
+
+    for (; edgeIdx + 4 <= numLeafEdges; edgeIdx += 4) {
+        alignas(16) int32_t viewxs[4];
+        alignas(16) int32_t viewys[4];
+
+        for (int32_t i = 0; i < 4; ++i) {
+            const vertex_t& vert = *pLeafEdges[edgeIdx + i].vertex;
+            viewxs[i] = vert.viewx;
+            viewys[i] = vert.viewy;
+        }
+
+        // Left plane: a point is on the outside if '-viewx > viewy', for the right plane if 'viewx > viewy'.
+        // Note: negation here wraps on overflow, the same as the scalar code in practice.
+        uint32_t outsideBytes;
+
+        #if R_LEAF_SIMD_SSE2
+            __m128i viewx = _mm_load_si128((const __m128i*) viewxs);
+            const __m128i viewy = _mm_load_si128((const __m128i*) viewys);
+
+            if constexpr (!RightViewPlane) {
+                viewx = _mm_sub_epi32(_mm_setzero_si128(), viewx);
+            }
+
+            const __m128i outsideMask = _mm_cmpgt_epi32(viewx, viewy);
+            const __m128i outsideMask16 = _mm_packs_epi32(outsideMask, outsideMask);
+            const __m128i outsideMask8 = _mm_packs_epi16(outsideMask16, outsideMask16);
+            outsideBytes = (uint32_t) _mm_cvtsi128_si32(_mm_and_si128(outsideMask8, _mm_set1_epi8(1)));
+        #else
+            int32x4_t viewx = vld1q_s32(viewxs);
+            const int32x4_t viewy = vld1q_s32(viewys);
+
+            if constexpr (!RightViewPlane) {
+                viewx = vnegq_s32(viewx);
+            }
+
+            const uint32x4_t outsideMask = vcgtq_s32(viewx, viewy);
+            const uint16x4_t outsideMask16 = vmovn_u32(outsideMask);
+            const uint8x8_t outsideMask8 = vand_u8(vmovn_u16(vcombine_u16(outsideMask16, outsideMask16)), vdup_n_u8(1));
+            outsideBytes = vget_lane_u32(vreinterpret_u32_u8(outsideMask8), 0);
+        #endif
+
+        std::memcpy(pbPointsOnOutside + edgeIdx, &outsideBytes, sizeof(outsideBytes));
+
+        // Each byte is '0' or '1', so summing the bytes gives the number of points on the outside
+        numOutside += (int32_t)((outsideBytes * 0x01010101u) >> 24);
+    }
+
+    // Do any remaining points one at a time
+    for (; edgeIdx < numLeafEdges; ++edgeIdx) {
+        const vertex_t& vert = *pLeafEdges[edgeIdx].vertex;
+        const int32_t viewx = (RightViewPlane) ? vert.viewx : -vert.viewx;
+        const bool bOutside = (viewx > vert.viewy);
+        pbPointsOnOutside[edgeIdx] = (uint8_t) bOutside;
+        numOutside += bOutside;
+    }
+
+    return numOutside;
+}
+#endif  // #if R_LEAF_SIMD_SSE2 || R_LEAF_SIMD_NEON
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Check to see what side of left or right view frustrum plane all points in the leaf are on.
 // Also stores what side each point is on at the start of scratchpad memory as a bool32_t.
@@ -502,6 +584,25 @@ int32_t R_CheckLeafSide(const bool bRightViewPlane, const leaf_t& leaf) noexcept
     // For each point on the inside, increment - otherwise decrement.
     int32_t insideOutsideCount = 0;
 
+    // PsyDoom: classify the points using SIMD if possible.
+    // Debug builds also classify the points with the original code and check that the results match.
+    #if R_LEAF_SIMD_SSE2 || R_LEAF_SIMD_NEON
+        uint8_t* const pbSimdPointsOnOutside = (uint8_t*) pbPointsOnOutside;
+        const int32_t numOutside = (bRightViewPlane) ?
+            R_ClassifyLeafPointsSimd<true>(pLeafEdge, numLeafEdges, pbSimdPointsOnOutside) :
+            R_ClassifyLeafPointsSimd<false>(pLeafEdge, numLeafEdges, pbSimdPointsOnOutside);
+
+        insideOutsideCount = numLeafEdges - numOutside * 2;
+        pbPointOnOutside += numLeafEdges;
+
+        #if ASSERTS_ENABLED
+            for (int32_t edgeIdx = 0; edgeIdx < numLeafEdges; ++edgeIdx) {
+                const vertex_t& vert = *pLeafEdge[edgeIdx].vertex;
+                const bool bOutside = (bRightViewPlane) ? (vert.viewx > vert.viewy) : (-vert.viewx > vert.viewy);
+                ASSERT(pbSimdPointsOnOutside[edgeIdx] == (uint8_t) bOutside);
+            }
+        #endif
+    #else
     // See which plane we are checking against, left or right view frustrum plane
     if (!bRightViewPlane) {
         for (int32_t edgeIdx = 0; edgeIdx < numLeafEdges; ++edgeIdx, ++pLeafEdge, ++pbPointOnOutside) {
@@ -528,6 +629,7 @@ int32_t R_CheckLeafSide(const bool bRightViewPlane, const leaf_t& leaf) noexcept
             }
         }
     }
+    #endif  // #if R_LEAF_SIMD_SSE2 || R_LEAF_SIMD_NEON
 
     // Terminate the list of whether each leaf point is on the front side of the plane or not by duplicating
     // the first entry in the list at the end. This allows the renderer to wraparound automatically to the
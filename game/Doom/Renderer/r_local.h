@@ -124,10 +124,18 @@ struct line_t {
 // Describes a convex region within a sector
 struct subsector_t {
     sector_t*   sector;             // Parent sector for the subsector
+// PsyDoom: these indexes are 32-bit in limit removing builds, so that maps with more than 32,767 segs or leaf edges can be supported
+#if PSYDOOM_LIMIT_REMOVING
+    int32_t     numsegs;            // How many line segments in this subsector
+    int32_t     firstseg;           // Index of the first line segment for the subsector, in the global list of line segments
+    int32_t     numLeafEdges;       // How many leaf edges there are for the subsector
+    int32_t     firstLeafEdge;      // Index of the first leaf edge for the subsector, in the global list of leaf edges
+#else
     int16_t     numsegs;            // How many line segments in this subsector
     int16_t     firstseg;           // Index of the first line segment for the subsector, in the global list of line segments
     int16_t     numLeafEdges;       // How many leaf edges there are for the subsector
     int16_t     firstLeafEdge;      // Index of the first leaf edge for the subsector, in the global list of leaf edges
+#endif
 #if PSYDOOM_MODS
     int32_t     vkDrawSubsecIdx;    // PsyDoom: repurpose unused fields to hold the draw subsector index for the new Vulkan renderer. Will be '-1' if not drawn.
     bool        bVkCanBatchFlats;   // PsyDoom: a flag set to 'true' if the subsector's flats can be batched/merged with other flats by the Vulkan renderer.
@@ -152,6 +160,21 @@ struct node_t {
     int32_t     children[2];    // When 'NF_SUBSECTOR' is set then it means it's a subsector number
 };
 
+#if PSYDOOM_MODS
+    // PsyDoom: a tightly packed version of a BSP tree node, containing just what is needed to traverse the tree.
+    // Used for faster BSP tree walking, since 4 of these nodes fit into a single cache line.
+    // The partition line is in integer coordinates, which is how it is defined in the map data.
+    struct packednode_t {
+        int16_t     x;              // The partition line: 1st point in integer coords (x & y)
+        int16_t     y;
+        int16_t     dx;             // The partition line: vector from the 1st point to the end point in integer coords (x & y)
+        int16_t     dy;
+        int32_t     children[2];    // When 'NF_SUBSECTOR' is set then it means it's a subsector number
+    };
+
+    static_assert(sizeof(packednode_t) == 16);
+#endif
+
 // Seg flags
 static constexpr uint16_t SGF_VISIBLE_COLS = 0x1;       // The seg has at least 1 visible (non fully occluded column)
 
@@ -6,12 +6,15 @@
 #include "Doom/d_main.h"
 #include "Doom/Game/doomdata.h"
 #include "Doom/Game/g_game.h"
+#include "Doom/Game/p_local.h"
 #include "Doom/Game/p_setup.h"
 #include "Doom/Game/p_spec.h"
 #include "Doom/Game/p_user.h"
+#include "Gpu.h"
 #include "PsyDoom/Config/Config.h"
 #include "PsyDoom/Game.h"
 #include "PsyDoom/PlayerPrefs.h"
+#include "PsyDoom/PsxVm.h"
 #include "PsyQ/LIBGPU.h"
 #include "PsyQ/LIBGTE.h"
 #include "r_bsp.h"
@@ -258,6 +261,12 @@ void R_RenderPlayerView() noexcept {
         I_DrawPresent();
     #endif
 
+    // PsyDoom: record the draw commands for the 3d view and rasterize them all at the end using multiple threads (if available).
+    // Note that any texture uploads during rendering will automatically cause the draw commands recorded so far to be rasterized first.
+    #if PSYDOOM_MODS
+        Gpu::beginDeferredDraw(PsxVm::gGpu);
+    #endif
+
     if (gbIsSkyVisible) {
         R_DrawSky();
     }
@@ -349,6 +358,11 @@ void R_RenderPlayerView() noexcept {
         LIBGPU_SetTexWindow(texWinPrim, texWinRect);
         I_AddPrim(texWinPrim);
     }
+
+    // PsyDoom: rasterize all of the draw commands recorded for the 3d view
+    #if PSYDOOM_MODS
+        Gpu::endDeferredDraw(PsxVm::gGpu);
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -459,6 +473,19 @@ subsector_t* R_PointInSubsector(const fixed_t x, const fixed_t y) noexcept {
     // Once we reach a subsector stop and return it.
     int32_t nodeNum = gNumBspNodes - 1;
 
+    // PsyDoom: if the point is within the blockmap then start from the deepest node known to contain the point's blockmap cell instead.
+    // This gives the same result as walking from the root, but usually skips most or all of the tree.
+    #if PSYDOOM_MODS
+        if (gpBlockmapCellBspNodes) {
+            const uint32_t cellX = (uint32_t)(((int64_t) x - gBlockmapOriginX) >> MAPBLOCKSHIFT);
+            const uint32_t cellY = (uint32_t)(((int64_t) y - gBlockmapOriginY) >> MAPBLOCKSHIFT);
+
+            if ((cellX < (uint32_t) gBlockmapWidth) && (cellY < (uint32_t) gBlockmapHeight)) {
+                nodeNum = gpBlockmapCellBspNodes[cellY * (uint32_t) gBlockmapWidth + cellX];
+            }
+        }
+    #endif
+
     while ((nodeNum & NF_SUBSECTOR) == 0) {
         node_t& node = gpBspNodes[nodeNum];
         const int32_t side = R_PointOnSide(x, y, node);
@@ -6,6 +6,7 @@
 #include "Doom/Base/w_wad.h"
 #include "Doom/Game/doomdata.h"
 #include "PsyDoom/Config/Config.h"
+#include "PsyDoom/DecodedTexPool.h"
 #include "PsyQ/LIBGPU.h"
 #include "r_data.h"
 #include "r_local.h"
@@ -70,7 +71,14 @@ void R_DrawSubsectorFlat(leaf_t& leaf, const bool bIsCeiling) noexcept {
             #else
                 pLumpData = (const std::byte*) gpLumpCache[tex.lumpNum];
             #endif
-        } else {
+        }
+        // PsyDoom: try to use the decoded texture pool first, so that re-uploads of the flat can skip decompression
+        #if PSYDOOM_MODS
+            else if (const std::byte* const pPooledLumpData = DecodedTexPool::getLumpData(tex.lumpNum, flatLump)) {
+                pLumpData = pPooledLumpData;
+            }
+        #endif
+        else {
             #if PSYDOOM_MODS
                 const void* pCompressedLumpData = flatLump.pCachedData;
             #else
@@ -375,6 +383,24 @@ static void R_DrawFlatSpans(leaf_t& leaf, const int32_t planeViewZ, const textur
     drawPrim.clut = g3dViewPaletteClutId;
     drawPrim.tpage = tex.texPageId;
 
+    // PsyDoom: flat rows are submitted to the GPU in batches rather than individually, to reduce the overhead per row.
+    // All of the rows share the same texture, CLUT and draw mode.
+    #if PSYDOOM_MODS
+        constexpr uint32_t MAX_BATCHED_ROWS = 64;
+        FLOORROW_FT batchedRows[MAX_BATCHED_ROWS];
+        uint32_t numBatchedRows = 0;
+
+        const auto addFlatRow = [&](const FLOORROW_FT& row) noexcept {
+            batchedRows[numBatchedRows] = row;
+            ++numBatchedRows;
+
+            if (numBatchedRows >= MAX_BATCHED_ROWS) {
+                I_AddPrims(batchedRows, numBatchedRows);
+                numBatchedRows = 0;
+            }
+        };
+    #endif
+
     // Draw all of the horizontal spans in the flat
     const span_t* pSpan = &gFlatSpans[planeBegY];
 
@@ -576,6 +602,7 @@ static void R_DrawFlatSpans(leaf_t& leaf, const int32_t planeViewZ, const textur
                 drawPrim.v0 = (LibGpuUV) spanVL;
                 drawPrim.u1 = (LibGpuUV) spanUR;
                 drawPrim.v1 = (LibGpuUV) spanVR;
+                addFlatRow(drawPrim);
             #else
                 LIBGPU_setXY3(drawPrim,
                     (int16_t) spanL, (int16_t) spanY,
@@ -588,9 +615,9 @@ static void R_DrawFlatSpans(leaf_t& leaf, const int32_t planeViewZ, const textur
                     (uint8_t) spanUR, (uint8_t) spanVR,
                     (uint8_t) spanUR, (uint8_t) spanVR
                 );
-            #endif
 
-            I_AddPrim(drawPrim);
+                I_AddPrim(drawPrim);
+            #endif
         } else {
             // Harder case: we must split up the flat span and issue multiple primitives.
             // Note also, the piece count is minus 1 so increment here now to get the true amount:
@@ -670,6 +697,7 @@ static void R_DrawFlatSpans(leaf_t& leaf, const int32_t planeViewZ, const textur
                     drawPrim.v0 = (LibGpuUV) spanVL;
                     drawPrim.u1 = (LibGpuUV) spanUR;
                     drawPrim.v1 = (LibGpuUV) spanVR;
+                    addFlatRow(drawPrim);
                 #else
                     LIBGPU_setXY3(drawPrim,
                         (int16_t) spanL, (int16_t) spanY,
@@ -682,9 +710,9 @@ static void R_DrawFlatSpans(leaf_t& leaf, const int32_t planeViewZ, const textur
                         (uint8_t) spanUR, (uint8_t) spanVR,
                         (uint8_t) spanUR, (uint8_t) spanVR
                     );
-                #endif
 
-                I_AddPrim(drawPrim);
+                    I_AddPrim(drawPrim);
+                #endif
 
                 // Move coords onto the next span.
                 // Note that the previous wrapping operation (if any) is also undone here.
@@ -695,8 +723,9 @@ static void R_DrawFlatSpans(leaf_t& leaf, const int32_t planeViewZ, const textur
         }
     }
 
-    // PsyDoom: need to cleanup this list before exiting
+    // PsyDoom: submit any remaining batched flat rows and cleanup this list before exiting
     #if PSYDOOM_MODS
+        I_AddPrims(batchedRows, numBatchedRows);
         gLeafScreenVerts.clear();
     #endif
 }
@@ -6,6 +6,7 @@
 #include "Doom/Base/w_wad.h"
 #include "Doom/Game/doomdata.h"
 #include "PsyDoom/Config/Config.h"
+#include "PsyDoom/DecodedTexPool.h"
 #include "PsyQ/LIBGPU.h"
 #include "r_data.h"
 #include "r_local.h"
@@ -34,9 +35,12 @@ static void R_UploadWallTexToVram(texture_t& tex) noexcept {
 
     const std::byte* pTexData;
 
+    // PsyDoom limit removing: try to use the decoded texture pool first, so that re-uploads of the texture can skip decompression
     #if PSYDOOM_LIMIT_REMOVING
         if (texLump.bIsUncompressed) {
             pTexData = (const std::byte*) pLumpData;
+        } else if (const std::byte* const pPooledTexData = DecodedTexPool::getLumpData(tex.lumpNum, texLump)) {
+            pTexData = pPooledTexData;
         } else {
             gTmpBuffer.ensureSize(texLump.uncompressedSize);
             decode(pLumpData, gTmpBuffer.bytes());
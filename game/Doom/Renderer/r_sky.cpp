@@ -5,6 +5,7 @@
 #include "Doom/Base/i_main.h"
 #include "Doom/Base/w_wad.h"
 #include "Doom/Game/doomdata.h"
+#include "Doom/Game/p_firesky.h"
 #include "PsyQ/LIBGPU.h"
 #include "r_data.h"
 #include "r_local.h"
@@ -179,7 +180,13 @@ void R_DrawSky() noexcept {
         const uint16_t* const pTexData = (const std::uint16_t*)(pLumpData + sizeof(texlump_header_t));
         SRECT vramRect = getTextureVramRect(skyTex);
 
-        LIBGPU_LoadImage(vramRect, pTexData);
+        // PsyDoom: only upload the rows of the fire sky which changed, if possible
+        #if PSYDOOM_MODS
+            P_UploadSkyTex(skyTex, vramRect, pTexData);
+        #else
+            LIBGPU_LoadImage(vramRect, pTexData);
+        #endif
+
         skyTex.uploadFrameNum = gNumFramesDrawn;
     }
 
@@ -13,6 +13,8 @@
 #include "r_local.h"
 #include "r_main.h"
 
+#include <algorithm>
+
 // Describes a sprite that is to be drawn
 struct vissprite_t {
     int32_t         viewx;      // Viewspace x position
@@ -23,6 +25,7 @@ struct vissprite_t {
 
 // This is the maximum number of vissprites that can be drawn per subsector - any more than this will simply be ignored.
 // Should be enough for even the most extreme situations; if we go much higher then sprite sorting times would become super slow!
+// PsyDoom limit removing: sprites are now sorted in O(n log n) time rather than by linear insertion, so the higher limit is not a problem.
 #if PSYDOOM_LIMIT_REMOVING
     static constexpr int32_t MAXVISSPRITES = 8192;
 #else
@@ -34,6 +37,11 @@ struct vissprite_t {
 static vissprite_t  gVisSprites[MAXVISSPRITES];
 static vissprite_t  gVisSpriteHead;
 
+// PsyDoom limit removing: pointers to the draw sprites for the current subsector, used to sort them before building the draw list
+#if PSYDOOM_LIMIT_REMOVING
+    static vissprite_t* gpSortedVisSprites[MAXVISSPRITES];
+#endif
+
 #if PSYDOOM_LIMIT_REMOVING
 //------------------------------------------------------------------------------------------------------------------------------------------
 // PsyDoom addition: sets up the final XY and UV coordinates for a sprite quad, after clipping against the screen edges.
@@ -178,26 +186,33 @@ void R_DrawSubsectorSprites(subsector_t& subsec) noexcept {
             pVisSprite->scale = (HALF_SCREEN_W * FRACUNIT) / viewpos.vz;
             pVisSprite->thing = pThing;
 
-            // Find the vissprite in the linked list to insert the new sprite AFTER.
-            // This will be first sprite for which the next sprite is bigger than the new sprite we are inserting.
-            // This method basically sorts the sprites from back to front, with sprites at the back being first in the draw list:
-            vissprite_t* pInsertPt = &gVisSpriteHead;
+            // PsyDoom limit removing: just collect the sprite for now, all sprites are sorted into the draw list at the end
+            #if PSYDOOM_LIMIT_REMOVING
+                gpSortedVisSprites[numDrawSprites] = pVisSprite;
+            #else
+                // Find the vissprite in the linked list to insert the new sprite AFTER.
+                // This will be first sprite for which the next sprite is bigger than the new sprite we are inserting.
+                // This method basically sorts the sprites from back to front, with sprites at the back being first in the draw list:
+                vissprite_t* pInsertPt = &gVisSpriteHead;
 
-            {
-                vissprite_t* pNextSpr = pInsertPt->next;
+                {
+                    vissprite_t* pNextSpr = pInsertPt->next;
 
-                while (pNextSpr != &gVisSpriteHead) {
-                    if (pNextSpr->scale >= pVisSprite->scale)
-                        break;
+                    while (pNextSpr != &gVisSpriteHead) {
+                        if (pNextSpr->scale >= pVisSprite->scale)
+                            break;
 
-                    pInsertPt = pNextSpr;
-                    pNextSpr = pNextSpr->next;
+                        pInsertPt = pNextSpr;
+                        pNextSpr = pNextSpr->next;
+                    }
                 }
-            }
 
-            // Add the sprite into the linked list at the insertion point and move onto the next sprite slot
-            pVisSprite->next = pInsertPt->next;
-            pInsertPt->next = pVisSprite;
+                // Add the sprite into the linked list at the insertion point
+                pVisSprite->next = pInsertPt->next;
+                pInsertPt->next = pVisSprite;
+            #endif
+
+            // Move onto the next sprite slot
             ++numDrawSprites;
             ++pVisSprite;
 
@@ -211,6 +226,29 @@ void R_DrawSubsectorSprites(subsector_t& subsec) noexcept {
     if (numDrawSprites == 0)
         return;
 
+    // PsyDoom limit removing: sort the sprites back to front and build the draw list from that.
+    // This gives the same order as the original insertion sort: ascending scale, with later added sprites first where the scale is equal.
+    #if PSYDOOM_LIMIT_REMOVING
+        std::sort(
+            gpSortedVisSprites,
+            gpSortedVisSprites + numDrawSprites,
+            [](const vissprite_t* const pSpr1, const vissprite_t* const pSpr2) noexcept {
+                return (pSpr1->scale != pSpr2->scale) ? (pSpr1->scale < pSpr2->scale) : (pSpr1 > pSpr2);
+            }
+        );
+
+        {
+            vissprite_t* pPrevSpr = &gVisSpriteHead;
+
+            for (int32_t i = 0; i < numDrawSprites; ++i) {
+                pPrevSpr->next = gpSortedVisSprites[i];
+                pPrevSpr = gpSortedVisSprites[i];
+            }
+
+            pPrevSpr->next = &gVisSpriteHead;
+        }
+    #endif
+
     // Clear the texture window to disable wrapping
     {
         SRECT texWinRect;
@@ -24,6 +24,7 @@
 #include "PsyDoom/Vulkan/VTypes.h"
 #include "rv_utils.h"
 
+#include <algorithm>
 #include <cmath>
 
 // The position and rotation to use for the player this frame on the automap, and the free camera position and camera zoom
@@ -124,12 +125,23 @@ static void RV_DrawMapLines() noexcept {
     const player_t& curPlayer = gPlayers[gCurPlayerIndex];
     const bool bBrightLines = Config::gbVulkanBrightenAutomap;
 
-    const int32_t numLines = gNumLines;
+    // Only consider lines in grid cells overlapping the automap view.
+    // The view extends horizontally into the widescreen area if widescreen is enabled, and a small margin is added for safety.
+    const bool bFollowMode = (curPlayer.automapflags & AF_FOLLOW);
+    const fixed_t viewX = (bFollowMode) ? gRvMap_AutomapX : gRvMap_PlayerX;
+    const fixed_t viewY = (bFollowMode) ? gRvMap_AutomapY : gRvMap_PlayerY;
+    const float xPadding = (Config::gbVulkanWidescreenEnabled) ? (VRenderer::gPsxCoordsFbX / VRenderer::gPsxCoordsFbW) * (float) SCREEN_W : 0.0f;
+    const float amScale = std::max(RV_FixedToFloat(gRvMap_AutomapScale) / (float) SCREEN_W, 1.0f / 1024.0f);
+    const int64_t viewHalfW = (int64_t)(((float) HALF_SCREEN_W + xPadding + 2.0f) / amScale * (float) FRACUNIT);
+    const int64_t viewHalfH = (int64_t)(((float) SCREEN_H / 2.0f + 2.0f) / amScale * (float) FRACUNIT);
+
+    int32_t numLines;
+    const int32_t* const pLineIndexes = AM_GetLinesInView(viewX, viewY, viewHalfW, viewHalfH, numLines);
     const line_t* const pLines = gpLines;
 
-    for (int32_t lineIdx = 0; lineIdx < numLines; ++lineIdx) {
+    for (int32_t i = 0; i < numLines; ++i) {
         // See whether we should draw the automap line or not
-        const line_t& line = pLines[lineIdx];
+        const line_t& line = pLines[pLineIndexes[i]];
 
         const bool bHiddenLine = (line.flags & ML_DONTDRAW);
         const bool bLineSeen = ((line.flags & ML_MAPPED) && (!bHiddenLine));
@@ -11,6 +11,7 @@
 #include "Doom/Game/p_setup.h"
 #include "Doom/Renderer/r_local.h"
 #include "Doom/Renderer/r_main.h"
+#include "PsyDoom/Profiler.h"
 #include "rv_data.h"
 #include "rv_main.h"
 #include "rv_occlusion.h"
@@ -19,6 +20,56 @@
 // This is the list of subsectors to be drawn by the Vulkan renderer, in front to back order
 std::vector<subsector_t*> gRvDrawSubsecs;
 
+// The minimum and maximum world heights of everything contained in each BSP node, for the current frame.
+// Only computed when the coarse occlusion buffer is in use, to allow node bounding boxes to be tested against it in 3D.
+static std::vector<float> gRvNodeMinH;
+static std::vector<float> gRvNodeMaxH;
+
+// How much bounding boxes for BSP nodes are artificially expanded by (horiztonally and vertically) for visibility testing purposes.
+// See 'RV_NodeBBVisible' for more details.
+static constexpr float BSP_NODE_BOX_FUDGE = 128.0f;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the minimum and maximum height of everything contained in the specified BSP node or subsector, for coarse occlusion testing.
+// For nodes this relies on the height bounds having been computed for this frame.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_GetBspNodeHeightBounds(const int32_t nodeIdx, float& minH, float& maxH) noexcept {
+    if (nodeIdx & NF_SUBSECTOR) {
+        // Note: the '-1' check here is the same strange check from the PC engine, see 'RV_VisitBspNode'
+        const int32_t subsecIdx = (nodeIdx == -1) ? 0 : (nodeIdx & (~NF_SUBSECTOR));
+        sector_t& sector = *gpSubsectors[subsecIdx].sector;
+
+        // Invisible platforms are drawn at the height of the lowest surrounding floor, so just be conservative with those
+        const bool bIsInvisiblePlatform = (sector.flags & SF_GHOSTPLAT);
+        minH = (bIsInvisiblePlatform) ? -32768.0f : RV_FixedToFloat(sector.floorheight.renderValue());
+        maxH = RV_FixedToFloat(sector.ceilingheight.renderValue());
+    } else {
+        ASSERT((size_t) nodeIdx < gRvNodeMinH.size());
+        minH = gRvNodeMinH[nodeIdx];
+        maxH = gRvNodeMaxH[nodeIdx];
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Computes the minimum and maximum height of everything contained in the specified BSP node (and all nodes below it) for this frame
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_UpdateBspNodeHeightBounds(const int32_t nodeIdx) noexcept {
+    if (nodeIdx & NF_SUBSECTOR)
+        return;
+
+    const node_t& node = gpBspNodes[nodeIdx];
+    RV_UpdateBspNodeHeightBounds(node.children[0]);
+    RV_UpdateBspNodeHeightBounds(node.children[1]);
+
+    float minH1, maxH1;
+    float minH2, maxH2;
+    RV_GetBspNodeHeightBounds(node.children[0], minH1, maxH1);
+    RV_GetBspNodeHeightBounds(node.children[1], minH2, maxH2);
+
+    gRvNodeMinH[nodeIdx] = std::min(minH1, minH2);
+    gRvNodeMaxH[nodeIdx] = std::max(maxH1, maxH2);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Tells if the given line segment is occluding for the purposes of visibility testing.
 // Occluding segs should mark out areas of the screen that they cover, so that nothing behind draws.
@@ -64,15 +115,100 @@ static bool RV_IsOccludingSeg(const rvseg_t& seg, const sector_t& frontSector) n
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Check if the bounding box for the specified node is visible
+// Adds the fully opaque geometry for the given subsector to the coarse occlusion buffer.
+// This includes upper and lower walls which are not sky walls, as well as floors and ceilings which are not sky.
+// Fully solid segs are not added since they already occlude entire screen columns via the regular 1D occlusion ranges.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_AddSubsecToOccBuffer(const subsector_t& subsec) noexcept {
+    // Add upper and lower walls for all visible two sided segs
+    const sector_t& frontSector = *subsec.sector;
+    const rvseg_t* const pSegs = gpRvSegs.get() + subsec.firstseg;
+    const uint32_t numSegs = subsec.numsegs;
+    const float fty = RV_FixedToFloat(frontSector.ceilingDrawH);
+    const float fby = RV_FixedToFloat(frontSector.floorDrawH);
+
+    for (uint32_t segIdx = 0; segIdx < numSegs; ++segIdx) {
+        const rvseg_t& seg = pSegs[segIdx];
+
+        if ((seg.flags & SGF_BACKFACING) || ((seg.flags & SGF_VISIBLE_COLS) == 0) || (!seg.backsector))
+            continue;
+
+        if (seg.linedef->flags & ML_VOID)
+            continue;
+
+        const sector_t& backSector = *seg.backsector;
+        const side_t& side = *seg.sidedef;
+        const float bty = RV_FixedToFloat(backSector.ceilingDrawH);
+        const float bby = RV_FixedToFloat(backSector.floorDrawH);
+
+        const bool bHasUpperWall = ((bty < fty) && (side.toptexture >= 0) && (backSector.ceilingpic != -1));
+        const bool bHasLowerWall = ((bby > fby) && (side.bottomtexture >= 0) && (backSector.floorpic != -1));
+
+        if (bHasUpperWall) {
+            const float wallPoints[4][3] = {
+                { seg.v1x, bty, seg.v1y },
+                { seg.v1x, fty, seg.v1y },
+                { seg.v2x, fty, seg.v2y },
+                { seg.v2x, bty, seg.v2y },
+            };
+
+            RV_OccludeConvexPoly(wallPoints, 4);
+        }
+
+        if (bHasLowerWall) {
+            const float wallPoints[4][3] = {
+                { seg.v1x, fby, seg.v1y },
+                { seg.v1x, bby, seg.v1y },
+                { seg.v2x, bby, seg.v2y },
+                { seg.v2x, fby, seg.v2y },
+            };
+
+            RV_OccludeConvexPoly(wallPoints, 4);
+        }
+    }
+
+    // Add the floor and ceiling if they are drawn and not sky
+    constexpr int32_t MAX_PLANE_POINTS = 32;
+    const int32_t numLeafEdges = subsec.numLeafEdges;
+
+    if ((numLeafEdges < 3) || (numLeafEdges > MAX_PLANE_POINTS))
+        return;
+
+    const rvleafedge_t* const pLeafEdges = gpRvLeafEdges.get() + subsec.firstLeafEdge;
+    const bool bDrawFloor = ((gViewZf > fby) && (frontSector.floorpic >= 0));
+    const bool bDrawCeiling = ((gViewZf < fty) && (frontSector.ceilingpic >= 0));
+    float planePoints[MAX_PLANE_POINTS][3];
+
+    const auto addPlane = [&](const float planeH) noexcept {
+        for (int32_t i = 0; i < numLeafEdges; ++i) {
+            planePoints[i][0] = pLeafEdges[i].v1x;
+            planePoints[i][1] = planeH;
+            planePoints[i][2] = pLeafEdges[i].v1y;
+        }
+
+        RV_OccludeConvexPoly(planePoints, numLeafEdges);
+    };
+
+    if (bDrawFloor) {
+        addPlane(fby);
+    }
+
+    if (bDrawCeiling) {
+        addPlane(fty);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Check if the bounding box for the specified node is visible.
+// The index of the node (or subsector) which the bounding box is for must also be specified.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static bool RV_NodeBBVisible(const fixed_t boxCoords[4]) noexcept {
+static bool RV_NodeBBVisible(const fixed_t boxCoords[4], const int32_t boxNodeIdx) noexcept {
     // Get the bounds of the box in normalized device coords to see what area of the screen it occupies.
     //
     // Also artifically expand the bounds by a certain amount to account for cases where sprites inside an occluded BSP node extend into
     // BSP nodes that ARE visible. This fudge helps prevent annoying pop-in of sprites and improves visual consistency. This does of course
     // cost some performance, but it's worth it to help prevent pop in!
-    const float BOX_FUDGE = 128.0f;
+    const float BOX_FUDGE = BSP_NODE_BOX_FUDGE;
 
     const float nodeTy = RV_FixedToFloat(boxCoords[BOXTOP]) + BOX_FUDGE;
     const float nodeBy = RV_FixedToFloat(boxCoords[BOXBOTTOM]) - BOX_FUDGE;
@@ -103,7 +239,21 @@ static bool RV_NodeBBVisible(const fixed_t boxCoords[4]) noexcept {
     addNodeLineToBounds(nodeLx, nodeBy, nodeLx, nodeTy);
 
     // Regard the node as visible if any of that area is unobscured
-    return RV_IsRangeVisible(nodeMinX, nodeMaxX);
+    if (!RV_IsRangeVisible(nodeMinX, nodeMaxX))
+        return false;
+
+    // If the coarse occlusion buffer is in use then also test the box against that, in 3D.
+    // Expand the box vertically by the same amount as horizontally, to try and avoid pop-in for sprites which extend outside of the node.
+    if (RV_IsOccBufferEnabled()) {
+        float nodeMinH, nodeMaxH;
+        RV_GetBspNodeHeightBounds(boxNodeIdx, nodeMinH, nodeMaxH);
+
+        const float boxMin[3] = { nodeLx, nodeMinH - BOX_FUDGE, nodeBy };
+        const float boxMax[3] = { nodeRx, nodeMaxH + BOX_FUDGE, nodeTy };
+        return RV_IsBoxVisibleInOccBuffer(boxMin, boxMax);
+    }
+
+    return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -214,6 +364,11 @@ static void RV_VisitSubsec(const int32_t subsecIdx) noexcept {
         }
     }
 
+    // Add the opaque parts of the subsector to the coarse occlusion buffer, if it's being used
+    if (RV_IsOccBufferEnabled()) {
+        RV_AddSubsecToOccBuffer(subsec);
+    }
+
     // Add the subsector to the draw list and set it's draw index.
     // If the sector has a sky ceiling or floor (new engine feature) then also mark the sky as visible.
     subsec.vkDrawSubsecIdx = (int32_t) gRvDrawSubsecs.size();
@@ -229,49 +384,74 @@ static void RV_VisitSubsec(const int32_t subsecIdx) noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Does recursive traversal of the BSP tree to prepare a list of subsectors to draw, starting at the given node
+// Does traversal of the BSP tree to prepare a list of subsectors to draw, starting at the given node.
+//
+// The traversal is done iteratively using an explicit stack and the packed BSP nodes, visiting nodes closest to the viewpoint first.
+// The bounding boxes of the far children of nodes are only tested for visibility once the closer children have been visited, since
+// the closer children might occlude them. If the BSP tree is too deep for the stack then the function calls itself to handle subtrees.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void RV_VisitBspNode(const int32_t nodeIdx) noexcept {
-    // Is this node number a subsector?
-    // If so then process it for potential later rendering:
-    if (nodeIdx & NF_SUBSECTOR) {
-        // Note: this strange check is in the PC engine too...
-        // Under what circumstances can the node number be '-1'?
-        if (nodeIdx == -1) {
-            RV_VisitSubsec(0);
-        } else {
-            RV_VisitSubsec(nodeIdx & (~NF_SUBSECTOR));
-        }
-    } else {
-        // This is not a subsector, continue traversing the BSP tree.
-        // Only stop when a particular node is determined to be not visible.
-        node_t& node = gpBspNodes[nodeIdx];
-
-        // Compute which side of the line the point is on using the cross product.
-        // This is pretty much the same code found in 'R_PointOnSide':
-        const float dx = gViewXf - RV_FixedToFloat(node.line.x);
-        const float dy = gViewYf - RV_FixedToFloat(node.line.y);
-        const float lprod = RV_FixedToFloat(node.line.dx) * dy;
-        const float rprod = RV_FixedToFloat(node.line.dy) * dx;
-
-        // Depending on which side of the halfspace we are on, reverse the traversal order:
-        if (lprod < rprod) {
-            if (RV_NodeBBVisible(node.bbox[0])) {
-                RV_VisitBspNode(node.children[0]);
-            }
+static void RV_VisitBspNode(const int32_t rootNodeIdx) noexcept {
+    // A child of a BSP node which is still to be visited, if it's bounding box is found to be visible
+    struct PendingChild {
+        int32_t     parentIdx;
+        int32_t     childSide;
+    };
 
-            if (RV_NodeBBVisible(node.bbox[1])) {
-                RV_VisitBspNode(node.children[1]);
+    constexpr int32_t STACK_SIZE = 64;
+    PendingChild pendingChildren[STACK_SIZE];
+    int32_t numPendingChildren = 0;
+    int32_t nodeIdx = rootNodeIdx;
+
+    while (true) {
+        if (nodeIdx & NF_SUBSECTOR) {
+            // This node number is a subsector, process it for potential later rendering.
+            // Note: this strange '-1' check is in the PC engine too... Under what circumstances can the node number be '-1'?
+            if (nodeIdx == -1) {
+                RV_VisitSubsec(0);
+            } else {
+                RV_VisitSubsec(nodeIdx & (~NF_SUBSECTOR));
             }
+        } else if (numPendingChildren >= STACK_SIZE) {
+            // Out of stack space: handle this part of the tree with another call
+            RV_VisitBspNode(nodeIdx);
         } else {
-            if (RV_NodeBBVisible(node.bbox[1])) {
-                RV_VisitBspNode(node.children[1]);
+            // This is not a subsector, continue traversing the BSP tree.
+            // Compute which side of the line the point is on using the cross product.
+            // This is pretty much the same code found in 'R_PointOnSide':
+            const packednode_t& node = gpPackedBspNodes[nodeIdx];
+            const float dx = gViewXf - (float) node.x;
+            const float dy = gViewYf - (float) node.y;
+            const float lprod = (float) node.dx * dy;
+            const float rprod = (float) node.dy * dx;
+
+            // Depending on which side of the halfspace we are on, reverse the traversal order.
+            // Visit the closest child next if it is visible and the other child later on.
+            const int32_t nearSide = (lprod < rprod) ? 0 : 1;
+            pendingChildren[numPendingChildren] = { nodeIdx, nearSide ^ 1 };
+            numPendingChildren++;
+
+            if (RV_NodeBBVisible(gpBspNodes[nodeIdx].bbox[nearSide], node.children[nearSide])) {
+                nodeIdx = node.children[nearSide];
+                continue;
             }
+        }
+
+        // Move onto the next child still to be visited which is visible, or stop if there are none left
+        bool bFoundNextNode = false;
 
-            if (RV_NodeBBVisible(node.bbox[0])) {
-                RV_VisitBspNode(node.children[0]);
+        while ((!bFoundNextNode) && (numPendingChildren > 0)) {
+            numPendingChildren--;
+            const PendingChild child = pendingChildren[numPendingChildren];
+            const int32_t childNodeIdx = gpPackedBspNodes[child.parentIdx].children[child.childSide];
+
+            if (RV_NodeBBVisible(gpBspNodes[child.parentIdx].bbox[child.childSide], childNodeIdx)) {
+                nodeIdx = childNodeIdx;
+                bFoundNextNode = true;
             }
         }
+
+        if (!bFoundNextNode)
+            return;
     }
 }
 
@@ -279,6 +459,8 @@ static void RV_VisitBspNode(const int32_t nodeIdx) noexcept {
 // Start traversing the BSP tree from the root using the current viewpoint and find what subsectors are to be drawn
 //------------------------------------------------------------------------------------------------------------------------------------------
 void RV_BuildDrawSubsecList() noexcept {
+    PROFILE_ZONE("RV_BuildDrawSubsecList");
+
     // Prepare the draw subsectors list and prealloc enough memory
     gRvDrawSubsecs.clear();
     gRvDrawSubsecs.reserve(gNumSubsectors);
@@ -286,8 +468,16 @@ void RV_BuildDrawSubsecList() noexcept {
     // Initially assume the sky is not visible
     gbIsSkyVisible = false;
 
-    // Traverse the BSP tree, starting at the root
+    // If the coarse occlusion buffer is being used then compute the height bounds of all BSP nodes for this frame, for testing against it
     const int32_t bspRootNodeIdx = gNumBspNodes - 1;
+
+    if (RV_IsOccBufferEnabled()) {
+        gRvNodeMinH.resize((size_t) gNumBspNodes);
+        gRvNodeMaxH.resize((size_t) gNumBspNodes);
+        RV_UpdateBspNodeHeightBounds(bspRootNodeIdx);
+    }
+
+    // Traverse the BSP tree, starting at the root
     RV_VisitBspNode(bspRootNodeIdx);
 }
 
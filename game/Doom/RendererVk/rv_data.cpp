@@ -13,6 +13,7 @@
 #include "Doom/Game/p_setup.h"
 #include "Doom/Renderer/r_local.h"
 #include "PsyDoom/Video.h"
+#include "rv_flats.h"
 #include "rv_utils.h"
 
 #include <cmath>
@@ -91,6 +92,7 @@ void RV_InitLevelData() noexcept {
     // Initialize basic data structures
     RV_InitSegs();
     RV_InitLeafEdges();
+    RV_InitFlatVertCache();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -101,6 +103,7 @@ void RV_FreeLevelData() noexcept {
     if (Video::gBackendType != Video::BackendType::Vulkan)
         return;
 
+    RV_FreeFlatVertCache();
     gpRvLeafEdges.reset();
     gpRvSegs.reset();
 }
@@ -18,10 +18,53 @@
 #include "rv_utils.h"
 
 #include <cmath>
+#include <memory>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// The parameters that the cached vertices for a subsector floor or ceiling were built with.
+// If any of these change then the cached vertices must be rebuilt.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct FlatVertCacheKey {
+    float           planeH;
+    float           uOffset, vOffset;
+    uint16_t        texWinX, texWinY;
+    uint16_t        texWinW, texWinH;
+    uint16_t        clutX, clutY;
+    uint8_t         colR, colG, colB;
+    VLightDimMode   lightDimMode;
+    bool            bIsValid;           // Set to 'false' if there are no cached vertices
+
+    inline bool operator == (const FlatVertCacheKey& other) const noexcept {
+        return (
+            (planeH == other.planeH) &&
+            (uOffset == other.uOffset) &&
+            (vOffset == other.vOffset) &&
+            (texWinX == other.texWinX) &&
+            (texWinY == other.texWinY) &&
+            (texWinW == other.texWinW) &&
+            (texWinH == other.texWinH) &&
+            (clutX == other.clutX) &&
+            (clutY == other.clutY) &&
+            (colR == other.colR) &&
+            (colG == other.colG) &&
+            (colB == other.colB) &&
+            (lightDimMode == other.lightDimMode) &&
+            (bIsValid == other.bIsValid)
+        );
+    }
+};
 
 static int32_t gNextFloorDrawSubsecIdx;     // Index of the next draw subsector to have its floor drawn
 static int32_t gNextCeilDrawSubsecIdx;      // Index of the next draw subsector to have its ceiling drawn
 
+// Cached triangles for the floor and ceiling of every subsector in the level, built the last time each was drawn.
+// Each subsector has 3 vertices for each of it's leaf edges, starting at 3x the index of it's first leaf edge.
+// Sector heights, textures and lighting rarely change, so most of the time the triangles can just be copied instead of rebuilt.
+static std::unique_ptr<FlatVertCacheKey[]>  gpFloorVertCacheKeys;
+static std::unique_ptr<FlatVertCacheKey[]>  gpCeilVertCacheKeys;
+static std::unique_ptr<VVertex_Draw[]>      gpFloorVertCache;
+static std::unique_ptr<VVertex_Draw[]>      gpCeilVertCache;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Figures out a 2D point (on the XZ plane) to act as the center of a triangle fan type arrangement for the subsector.
 // The subsector is convex so we should be able to do a triangle fan from this point to every other subector edge, in order to fill it.
@@ -63,15 +106,6 @@ static void RV_DrawPlane(
     uint16_t texWinW, texWinH;
     RV_GetTexWinXyWh(tex, texWinX, texWinY, texWinW, texWinH);
 
-    // Get the xz point to use as the center of a triangle fan for the subsector
-    const rvleafedge_t* const pLeafEdges = gpRvLeafEdges.get() + subsec.firstLeafEdge;
-    const uint16_t numLeafEdges = subsec.numLeafEdges;
-    ASSERT(numLeafEdges >= 3);
-
-    float triFanCenterX;
-    float triFanCenterZ;
-    RV_CalcSubsecTriFanCenter(pLeafEdges, triFanCenterX, triFanCenterZ);
-
     // Get the texture offset for the sector and wrap the offset to be within the texture's bounds (for precision purposes).
     // Note: this code assumes the floor texture dimensions are a power of two, which should always be the case for all textures.
     float uOffset, vOffset;
@@ -92,43 +126,94 @@ static void RV_DrawPlane(
     // Ensure we have the correct draw pipeline set
     VDrawing::setDrawPipeline(gOpaqueGeomPipeline);
 
-    // Do all the triangles for the plane.
-    // Note that all draw calls assume that the correct pipeline has already been set beforehand.
-    for (uint16_t edgeIdx = 0; edgeIdx < numLeafEdges; ++edgeIdx) {
-        // Get the edge coords
-        const rvleafedge_t& e1 = pLeafEdges[edgeIdx];
-        const rvleafedge_t& e2 = pLeafEdges[(edgeIdx + 1) % numLeafEdges];
-        const float x1 = e1.v1x;
-        const float z1 = e1.v1y;
-        const float x2 = e2.v1x;
-        const float z2 = e2.v1y;
-
-        // Draw the triangle: note that UV coords are just the vertex coords (scaled in the case of U) - no offsetting to worry about here.
+    // Figure out the parameters the plane's triangles are built with, and which cached triangles the plane has
+    FlatVertCacheKey cacheKey;
+    cacheKey.planeH = planeH;
+    cacheKey.uOffset = uOffset;
+    cacheKey.vOffset = vOffset;
+    cacheKey.texWinX = texWinX;
+    cacheKey.texWinY = texWinY;
+    cacheKey.texWinW = texWinW;
+    cacheKey.texWinH = texWinH;
+    cacheKey.clutX = gClutX;
+    cacheKey.clutY = gClutY;
+    cacheKey.colR = colR;
+    cacheKey.colG = colG;
+    cacheKey.colB = colB;
+    cacheKey.lightDimMode = lightDimMode;
+    cacheKey.bIsValid = true;
+
+    const rvleafedge_t* const pLeafEdges = gpRvLeafEdges.get() + subsec.firstLeafEdge;
+    const uint16_t numLeafEdges = subsec.numLeafEdges;
+    ASSERT(numLeafEdges >= 3);
+
+    const int32_t subsecIdx = (int32_t)(&subsec - gpSubsectors);
+    ASSERT((subsecIdx >= 0) && (subsecIdx < gNumSubsectors));
+
+    FlatVertCacheKey& curCacheKey = (IsFloor) ? gpFloorVertCacheKeys[subsecIdx] : gpCeilVertCacheKeys[subsecIdx];
+    VVertex_Draw* const pCachedVerts = ((IsFloor) ? gpFloorVertCache.get() : gpCeilVertCache.get()) + (size_t) subsec.firstLeafEdge * 3;
+    const uint32_t numVerts = (uint32_t) numLeafEdges * 3;
+
+    // Rebuild all the triangles for the plane if something has changed since they were last built
+    if (!(curCacheKey == cacheKey)) {
+        // Fill in the parameters which are common to all vertices first
+        for (uint32_t vertIdx = 0; vertIdx < numVerts; ++vertIdx) {
+            VVertex_Draw& vert = pCachedVerts[vertIdx];
+            vert.y = planeH;
+            vert.r = colR;
+            vert.g = colG;
+            vert.b = colB;
+            vert.lightDimMode = lightDimMode;
+            vert.texWinX = texWinX;
+            vert.texWinY = texWinY;
+            vert.texWinW = texWinW;
+            vert.texWinH = texWinH;
+            vert.clutX = gClutX;
+            vert.clutY = gClutY;
+            vert.stmulR = 128;
+            vert.stmulG = 128;
+            vert.stmulB = 128;
+            vert.stmulA = 128;
+        }
+
+        // Get the xz point to use as the center of a triangle fan for the subsector
+        float triFanCenterX;
+        float triFanCenterZ;
+        RV_CalcSubsecTriFanCenter(pLeafEdges, triFanCenterX, triFanCenterZ);
+
+        // Fill in the xz positions and UV coords for each triangle.
+        // Note that UV coords are just the vertex coords (scaled in the case of U) - no offsetting to worry about here.
         // For ceilings as well reverse the winding order so backface culling works OK.
-        if constexpr (IsFloor) {
-            VDrawing::addWorldTriangle(
-                x1, planeH, z1, x1 + uOffset, z1 + vOffset,
-                x2, planeH, z2, x2 + uOffset, z2 + vOffset,
-                triFanCenterX, planeH, triFanCenterZ, triFanCenterX + uOffset, triFanCenterZ + vOffset,
-                colR, colG, colB,
-                gClutX, gClutY,
-                texWinX, texWinY, texWinW, texWinH,
-                lightDimMode,
-                128, 128, 128, 128
-            );
-        } else {
-            VDrawing::addWorldTriangle(
-                x1, planeH, z1, x1 + uOffset, z1 + vOffset,
-                triFanCenterX, planeH, triFanCenterZ, triFanCenterX + uOffset, triFanCenterZ + vOffset,
-                x2, planeH, z2, x2 + uOffset, z2 + vOffset,
-                colR, colG, colB,
-                gClutX, gClutY,
-                texWinX, texWinY, texWinW, texWinH,
-                lightDimMode,
-                128, 128, 128, 128
-            );
+        const auto setVertPos = [=](VVertex_Draw& vert, const float x, const float z) noexcept {
+            vert.x = x;
+            vert.z = z;
+            vert.u = x + uOffset;
+            vert.v = z + vOffset;
+        };
+
+        for (uint16_t edgeIdx = 0; edgeIdx < numLeafEdges; ++edgeIdx) {
+            // Get the edge coords
+            const rvleafedge_t& e1 = pLeafEdges[edgeIdx];
+            const rvleafedge_t& e2 = pLeafEdges[(edgeIdx + 1) % numLeafEdges];
+            VVertex_Draw* const pTriVerts = pCachedVerts + (size_t) edgeIdx * 3;
+
+            if constexpr (IsFloor) {
+                setVertPos(pTriVerts[0], e1.v1x, e1.v1y);
+                setVertPos(pTriVerts[1], e2.v1x, e2.v1y);
+                setVertPos(pTriVerts[2], triFanCenterX, triFanCenterZ);
+            } else {
+                setVertPos(pTriVerts[0], e1.v1x, e1.v1y);
+                setVertPos(pTriVerts[1], triFanCenterX, triFanCenterZ);
+                setVertPos(pTriVerts[2], e2.v1x, e2.v1y);
+            }
         }
+
+        curCacheKey = cacheKey;
     }
+
+    // Draw all the triangles for the plane.
+    // Note that all draw calls assume that the correct pipeline has already been set beforehand.
+    VDrawing::addWorldVerts(pCachedVerts, numVerts);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -168,6 +253,30 @@ static void RV_DrawFlat(const subsector_t& subsec, const bool bDrawFloor, const
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocates the cached floor and ceiling triangles for all subsectors on level startup.
+// The triangles are built on demand when the subsectors are first drawn.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void RV_InitFlatVertCache() noexcept {
+    const int32_t numSubsecs = gNumSubsectors;
+    const size_t numVerts = (size_t) gTotalNumLeafEdges * 3;
+
+    gpFloorVertCacheKeys.reset(new FlatVertCacheKey[numSubsecs]());
+    gpCeilVertCacheKeys.reset(new FlatVertCacheKey[numSubsecs]());
+    gpFloorVertCache.reset(new VVertex_Draw[numVerts]);
+    gpCeilVertCache.reset(new VVertex_Draw[numVerts]);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees the cached floor and ceiling triangles for all subsectors on level shutdown
+//------------------------------------------------------------------------------------------------------------------------------------------
+void RV_FreeFlatVertCache() noexcept {
+    gpCeilVertCache.reset();
+    gpFloorVertCache.reset();
+    gpCeilVertCacheKeys.reset();
+    gpFloorVertCacheKeys.reset();
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Must be called before drawing subsectors and their flats.
 // Initializes which subsector floor and ceiling is to be drawn next.
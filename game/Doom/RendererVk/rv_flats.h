@@ -6,6 +6,8 @@ struct subsector_t;
 
 #include <cstdint>
 
+void RV_InitFlatVertCache() noexcept;
+void RV_FreeFlatVertCache() noexcept;
 void RV_InitNextDrawFlats() noexcept;
 void RV_DrawSubsecFloors(const int32_t fromDrawSubsecIdx) noexcept;
 void RV_DrawSubsecCeilings(const int32_t fromDrawSubsecIdx) noexcept;
@@ -172,10 +172,11 @@ void RV_RenderPlayerView() noexcept {
     // Increment the marker used to determine when to update the 'draw height' for each sector
     gValidCount++;
 
-    // Determine various draw settings and clear x-axis occlusion info to start with.
+    // Determine various draw settings and clear occlusion info to start with.
+    // Don't use the coarse occlusion buffer if the x-ray cheat is active, since walls and flats are not opaque in that case.
     // Then traverse the BSP tree to determine what needs to be drawn and in what order
     RV_DetermineDrawParams();
-    RV_ClearOcclussion();
+    RV_ClearOcclussion(Config::gbVulkanCoarseOcclusion && ((gpViewPlayer->cheats & CF_XRAYVISION) == 0));
     RV_BuildDrawSubsecList();
 
     // Build the list of sprite fragments to be drawn for each subsector
@@ -7,99 +7,160 @@
 //  (1) All coordinates passed in are in terms of normalized device coordinates and range from -1 to +1.
 //  (2) Areas outside -1 to +1 (offscreen) are always considered occluded.
 //  (3) Zero sized ranges are always considered NOT visible.
-//  (4) Occlusion ranges are merged when they touch or overlap to keep the list of ranges as small as possible.
-//      If there are two neighboring ranges in the list then there is guaranteed to be a gap between them.
+//  (4) Horizontal occlusion is tracked using a bitset of evenly spaced sample columns across the screen, similar to how pixel centers
+//      are sampled during rasterization. A range covers a sample column if the column's center falls within the range, so ranges which
+//      touch exactly (segs sharing an endpoint) leave no gaps between them. The resolution is finer than typical output resolutions.
+//  (5) Optionally a coarse 2D occlusion buffer can also be used, which tracks occlusion vertically as well as horizontally.
+//      The screen is divided up into a small number of columns, each of which has a vertical 'open' window which is not yet occluded.
+//      Convex polygons for opaque geometry (walls, floors and ceilings) shrink the window if they touch the occluded area at the top or
+//      bottom of the column - this keeps the occluded area for each column contiguous and the test conservative.
+//      Geometry must be added front to back, the same order as for the 1D occlusion ranges.
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "rv_occlusion.h"
 
 #if PSYDOOM_VULKAN_RENDERER
 
 #include "Asserts.h"
+#include "rv_main.h"
 
 #include <algorithm>
-#include <vector>
+#include <cmath>
+#include <cstring>
 
-// Occlusion range: represents a range of the screen that is occluded/blocked by walls
-struct OccRange {
-    float xMin;
-    float xMax;
+// How many sample columns horizontal occlusion is tracked at, and the width of each in normalized device coords
+static constexpr int32_t    OCC_SAMPLE_COLS = 4096;
+static constexpr int32_t    OCC_SAMPLE_WORDS = OCC_SAMPLE_COLS / 64;
+static constexpr float      OCC_SAMPLE_COL_W = 2.0f / (float) OCC_SAMPLE_COLS;
+
+static_assert(OCC_SAMPLE_COLS % 64 == 0);
+
+// Which of the sample columns across the screen are currently occluded: 1 bit per column, with a bit set if the column is occluded
+static uint64_t gRvOccSampleBits[OCC_SAMPLE_WORDS];
+
+// Coarse occlusion buffer column: represents the vertical range of a column of the screen which is not yet occluded.
+// Y values are in normalized device coords, but oriented so that increasing 'y' values are always higher up on the screen.
+// If the bottom of the open range is not below the top of the range then the column is fully occluded.
+struct OccColumn {
+    float openBy;
+    float openTy;
 };
 
-// Convenience typedef
-typedef std::vector<OccRange>::iterator OccRangeIter;
+// How many columns the coarse occlusion buffer has and the width of each one in normalized device coords
+static constexpr int32_t    OCC_BUFFER_W = 128;
+static constexpr float      OCC_COLUMN_W = 2.0f / (float) OCC_BUFFER_W;
+
+// The maximum number of polygon points after clipping that can be added to the coarse occlusion buffer.
+// Anything with more points than this is simply ignored for the purposes of occlusion.
+static constexpr int32_t OCC_MAX_POLY_POINTS = 64;
 
-// These are all of the ranges of the screen that are currently occluded.
-// The list is kept in sorted order and there is no overlapping or touching ranges (those are merged).
-std::vector<OccRange> gRvOccRanges;
+// Whether the coarse occlusion buffer is in use for this frame and the columns of the buffer
+static bool         gbRvOccBufferEnabled;
+static OccColumn    gRvOccColumns[OCC_BUFFER_W];
+
+// Multiplier to use on normalized device 'y' coordinates so that increasing 'y' values are higher up on the screen
+static float gRvOccNdcYUpMul;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Return an iterator to the occlusion range that the given x value falls within.
-// If the x value does not fall within a range, returns the next range after it.
-// Can be used to determine where insert a new range, or where to start checking for occlusion.
+// Transforms an xyz world position to clip space, saving the 'x', 'y' and 'w' components and whether the point is behind the front plane
 //------------------------------------------------------------------------------------------------------------------------------------------
-static OccRangeIter RV_GetOccRangeIter(const float x) noexcept {
-    // Try and find the range where max value is >= the given x value.
-    // This is all that is needed to satisfy the behavior documented above.
-    const auto begIter = gRvOccRanges.begin();
-    const auto endIter = gRvOccRanges.end();
+static bool RV_OccTransformPoint(const float worldPos[3], float clipXYW[3]) noexcept {
+    const float worldPos4d[4] = { worldPos[0], worldPos[1], worldPos[2], 1.0f };
+    float clipPos[4];
+    gViewProjMatrix.transform4d(worldPos4d, clipPos);
 
-    return std::lower_bound(
-        begIter,
-        endIter,
-        x,
-        [](const OccRange& range, const float x) noexcept {
-            return (range.xMax < x);
-        }
-    );
+    clipXYW[0] = clipPos[0];
+    clipXYW[1] = clipPos[1] * gRvOccNdcYUpMul;
+    clipXYW[2] = clipPos[3];
+    return (clipPos[2] < -clipPos[3]);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Grow the occlusion range pointed to by the given iterator by the specified amount.
-// Will merge ranges if required.
+// Get the vertical range of the given convex polygon (points in normalized device coords) at the specified 'x' value.
+// Returns 'false' if the polygon does not cross the x value.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void RV_GrowOccRangeTo(OccRangeIter rangeIter, const float newXMax) noexcept {
-    // Continue growing and merging the range with other ranges until we are done
-    while (true) {
-        // If the range is already big enough then we are done
-        OccRange& range = *rangeIter;
+static bool RV_GetOccPolyYRangeAtX(
+    const float (* const pPoints)[2],
+    const int32_t numPoints,
+    const float x,
+    float& yMin,
+    float& yMax
+) noexcept {
+    yMin = +INFINITY;
+    yMax = -INFINITY;
 
-        if (newXMax <= range.xMax)
-            break;
+    for (int32_t i = 0; i < numPoints; ++i) {
+        const float* const p1 = pPoints[i];
+        const float* const p2 = pPoints[(i + 1) % numPoints];
+        const float edgeLx = std::min(p1[0], p2[0]);
+        const float edgeRx = std::max(p1[0], p2[0]);
 
-        // If there is no next range then we can simply expand the current range to whatever size we want
-        const OccRangeIter nextRangeIter = rangeIter + 1;
+        if ((x < edgeLx) || (x > edgeRx))
+            continue;
 
-        if (nextRangeIter == gRvOccRanges.end()) {
-            range.xMax = newXMax;
-            break;
+        if (edgeLx == edgeRx) {
+            yMin = std::min(yMin, std::min(p1[1], p2[1]));
+            yMax = std::max(yMax, std::max(p1[1], p2[1]));
+        } else {
+            const float t = (x - p1[0]) / (p2[0] - p1[0]);
+            const float y = p1[1] + (p2[1] - p1[1]) * t;
+            yMin = std::min(yMin, y);
+            yMax = std::max(yMax, y);
         }
+    }
 
-        // Otherwise see if the expanded range would overlap the next range
-        OccRange& nextRange = *nextRangeIter;
-
-        if (newXMax < nextRange.xMin) {
-            // No overlap with the next range: grow the remaining distance
-            range.xMax = newXMax;
-            break;
-        }
+    return (yMin <= yMax);
+}
 
-        // Merge this range into the next range since it falls within it or touches it
-        ASSERT(range.xMin < nextRange.xMin);
-        ASSERT(range.xMax < nextRange.xMax);
-        nextRange.xMin = range.xMin;
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Marks all columns of the coarse occlusion buffer which are fully inside the given range of x values as occluded
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_OccludeBufferColumns(const float xMin, const float xMax) noexcept {
+    const int32_t begCol = std::max((int32_t) std::ceil((xMin + 1.0f) / OCC_COLUMN_W), 0);
+    const int32_t endCol = std::min((int32_t) std::floor((xMax + 1.0f) / OCC_COLUMN_W), OCC_BUFFER_W);
 
-        // Remove the old range we no longer want and continue the merging process
-        rangeIter = gRvOccRanges.erase(rangeIter);
+    for (int32_t colIdx = begCol; colIdx < endCol; ++colIdx) {
+        gRvOccColumns[colIdx].openBy = +1.0f;
+        gRvOccColumns[colIdx].openTy = -1.0f;
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the range of sample columns (inclusive) whose centers fall within the given range of x values.
+// Returns 'false' if no sample column centers are within the range.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool RV_GetOccSampleColRange(const float xMin, const float xMax, int32_t& begCol, int32_t& endCol) noexcept {
+    begCol = std::max((int32_t) std::ceil((xMin + 1.0f) / OCC_SAMPLE_COL_W - 0.5f), 0);
+    endCol = std::min((int32_t) std::floor((xMax + 1.0f) / OCC_SAMPLE_COL_W - 0.5f), OCC_SAMPLE_COLS - 1);
+    return (begCol <= endCol);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the mask of bits in a sample column word for the given range of bit indexes (inclusive)
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t RV_GetOccSampleWordMask(const int32_t begBit, const int32_t endBit) noexcept {
+    ASSERT((begBit >= 0) && (begBit <= endBit) && (endBit < 64));
+    const uint64_t begMask = ~uint64_t(0) << begBit;
+    const uint64_t endMask = ~uint64_t(0) >> (63 - endBit);
+    return (begMask & endMask);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Un-marks all areas of the screen as occluded.
-// Intended to be called at the start of a frame.
+// Intended to be called at the start of a frame, after the view projection matrix has been determined.
+// Also specifies whether the coarse occlusion buffer is to be used for this frame.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void RV_ClearOcclussion() noexcept {
-    gRvOccRanges.clear();
-    gRvOccRanges.reserve(128);  // This should be more than enough for even the most complex scenes
+void RV_ClearOcclussion(const bool bUseOccBuffer) noexcept {
+    std::memset(gRvOccSampleBits, 0, sizeof(gRvOccSampleBits));
+
+    gbRvOccBufferEnabled = bUseOccBuffer;
+    gRvOccNdcYUpMul = (gViewProjMatrix.e[1][1] >= 0.0f) ? +1.0f : -1.0f;
+
+    if (bUseOccBuffer) {
+        for (OccColumn& column : gRvOccColumns) {
+            column.openBy = -1.0f;
+            column.openTy = +1.0f;
+        }
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -114,27 +175,30 @@ void RV_OccludeRange(float xMin, float xMax) noexcept {
     if (xMin >= xMax)
         return;
 
-    // Try to find where to insert
-    OccRangeIter insertIter = RV_GetOccRangeIter(xMin);
+    // Fully occlude the affected columns in the coarse occlusion buffer too, if it's in use
+    if (gbRvOccBufferEnabled) {
+        RV_OccludeBufferColumns(xMin, xMax);
+    }
+
+    // Set the bits for all of the sample columns covered
+    int32_t begCol, endCol;
 
-    // Easy case: inserting at the end of the range list
-    if (insertIter == gRvOccRanges.end()) {
-        gRvOccRanges.push_back({ xMin, xMax });
+    if (!RV_GetOccSampleColRange(xMin, xMax, begCol, endCol))
         return;
-    }
 
-    // Harder case: range may overlap an existing range, may need to merge ranges.
-    // First see if this new range would overlap the one we found:
-    OccRange& insertRange = *insertIter;
+    const int32_t begWord = begCol / 64;
+    const int32_t endWord = endCol / 64;
 
-    if (xMax >= insertRange.xMin) {
-        // Merge this range into the insert range since it falls within it or touches it
-        insertRange.xMin = std::min(xMin, insertRange.xMin);
-        const float newMax = std::max(xMax, insertRange.xMax);
-        RV_GrowOccRangeTo(insertIter, newMax);
+    if (begWord == endWord) {
+        gRvOccSampleBits[begWord] |= RV_GetOccSampleWordMask(begCol % 64, endCol % 64);
     } else {
-        // No overlap with an existing range, just make a new one
-        gRvOccRanges.insert(insertIter, { xMin, xMax});
+        gRvOccSampleBits[begWord] |= RV_GetOccSampleWordMask(begCol % 64, 63);
+
+        for (int32_t wordIdx = begWord + 1; wordIdx < endWord; ++wordIdx) {
+            gRvOccSampleBits[wordIdx] = ~uint64_t(0);
+        }
+
+        gRvOccSampleBits[endWord] |= RV_GetOccSampleWordMask(0, endCol % 64);
     }
 }
 
@@ -151,18 +215,209 @@ bool RV_IsRangeVisible(float xMin, float xMax) noexcept {
     if (xMin >= xMax)
         return false;
 
-    // Get the range that the x values overlap
-    const OccRangeIter overlapRangeIter = RV_GetOccRangeIter(xMin);
+    // The range is visible if any of the sample columns it covers are not occluded
+    int32_t begCol, endCol;
+
+    if (!RV_GetOccSampleColRange(xMin, xMax, begCol, endCol))
+        return false;
 
-    // If nothing is overlapped then the range is visible
-    if (overlapRangeIter == gRvOccRanges.end())
+    const int32_t begWord = begCol / 64;
+    const int32_t endWord = endCol / 64;
+
+    if (begWord == endWord) {
+        const uint64_t mask = RV_GetOccSampleWordMask(begCol % 64, endCol % 64);
+        return ((gRvOccSampleBits[begWord] & mask) != mask);
+    }
+
+    const uint64_t begMask = RV_GetOccSampleWordMask(begCol % 64, 63);
+    const uint64_t endMask = RV_GetOccSampleWordMask(0, endCol % 64);
+
+    if ((gRvOccSampleBits[begWord] & begMask) != begMask)
         return true;
 
-    // If the range is fully contained within the search range, then it is not visible.
-    // Otherwise it is visible, since part of the range either falls before or after the found range.
-    // There is always some gap between ranges in the list so these parts will therefore be visible.
-    const OccRange& overlapRange = *overlapRangeIter;
-    return ((xMin < overlapRange.xMin) || (xMax > overlapRange.xMax));
+    for (int32_t wordIdx = begWord + 1; wordIdx < endWord; ++wordIdx) {
+        if (gRvOccSampleBits[wordIdx] != ~uint64_t(0))
+            return true;
+    }
+
+    return ((gRvOccSampleBits[endWord] & endMask) != endMask);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the coarse occlusion buffer is being used for this frame
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool RV_IsOccBufferEnabled() noexcept {
+    return gbRvOccBufferEnabled;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds the given convex polygon of fully opaque geometry to the coarse occlusion buffer (if it's in use).
+// The points are given as xyz world positions (Vulkan coordinate system) and the polygon is clipped against the front view plane.
+// Only the columns which are fully covered horizontally by the polygon are affected.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void RV_OccludeConvexPoly(const float (* const pPoints)[3], const int32_t numPoints) noexcept {
+    ASSERT(pPoints || (numPoints == 0));
+
+    if ((!gbRvOccBufferEnabled) || (numPoints < 3) || (numPoints > OCC_MAX_POLY_POINTS - 1))
+        return;
+
+    // Transform all of the points to clip space and clip the polygon against the front plane if required.
+    // Use the same clipping method as 'RV_GetLineNdcBounds' - setting 'w' for points on the front plane to ensure 'z' is '-1' in NDC.
+    float clipPoints[OCC_MAX_POLY_POINTS][3];
+    bool bBehindFrontPlane[OCC_MAX_POLY_POINTS];
+    float clipDepths[OCC_MAX_POLY_POINTS];
+    bool bAnyBehindFrontPlane = false;
+    bool bAllBehindFrontPlane = true;
+
+    for (int32_t i = 0; i < numPoints; ++i) {
+        const float worldPos4d[4] = { pPoints[i][0], pPoints[i][1], pPoints[i][2], 1.0f };
+        float clipPos[4];
+        gViewProjMatrix.transform4d(worldPos4d, clipPos);
+
+        clipPoints[i][0] = clipPos[0];
+        clipPoints[i][1] = clipPos[1] * gRvOccNdcYUpMul;
+        clipPoints[i][2] = clipPos[3];
+        clipDepths[i] = clipPos[2] + clipPos[3];
+        bBehindFrontPlane[i] = (clipDepths[i] < 0.0f);
+        bAnyBehindFrontPlane |= bBehindFrontPlane[i];
+        bAllBehindFrontPlane &= bBehindFrontPlane[i];
+    }
+
+    if (bAllBehindFrontPlane)
+        return;
+
+    float ndcPoints[OCC_MAX_POLY_POINTS][2];
+    int32_t numNdcPoints = 0;
+
+    const auto addNdcPoint = [&](const float clipX, const float clipY, const float clipW) noexcept {
+        ASSERT(numNdcPoints < OCC_MAX_POLY_POINTS);
+        ndcPoints[numNdcPoints][0] = clipX / clipW;
+        ndcPoints[numNdcPoints][1] = clipY / clipW;
+        numNdcPoints++;
+    };
+
+    for (int32_t i = 0; i < numPoints; ++i) {
+        const int32_t j = (i + 1) % numPoints;
+
+        if (!bBehindFrontPlane[i]) {
+            addNdcPoint(clipPoints[i][0], clipPoints[i][1], clipPoints[i][2]);
+        }
+
+        // Add the intersection point with the front plane if the edge crosses it
+        if (bAnyBehindFrontPlane && (bBehindFrontPlane[i] != bBehindFrontPlane[j])) {
+            const float d1 = std::abs(clipDepths[i]);
+            const float d2 = std::abs(clipDepths[j]);
+            const float t = d1 / (d1 + d2);
+            const float newX = clipPoints[i][0] * (1.0f - t) + clipPoints[j][0] * t;
+            const float newY = clipPoints[i][1] * (1.0f - t) + clipPoints[j][1] * t;
+            const float newW = clipPoints[i][2] * (1.0f - t) + clipPoints[j][2] * t;
+
+            if (newW <= 0.0f)
+                return;
+
+            addNdcPoint(newX, newY, newW);
+        }
+    }
+
+    // Get the horizontal range of the polygon and which column boundaries are inside of it
+    float polyLx = +INFINITY;
+    float polyRx = -INFINITY;
+
+    for (int32_t i = 0; i < numNdcPoints; ++i) {
+        polyLx = std::min(polyLx, ndcPoints[i][0]);
+        polyRx = std::max(polyRx, ndcPoints[i][0]);
+    }
+
+    const int32_t begBoundary = std::max((int32_t) std::ceil((std::max(polyLx, -1.0f) + 1.0f) / OCC_COLUMN_W), 0);
+    const int32_t endBoundary = std::min((int32_t) std::floor((std::min(polyRx, +1.0f) + 1.0f) / OCC_COLUMN_W), OCC_BUFFER_W);
+
+    if (begBoundary >= endBoundary)
+        return;
+
+    // Run through all of the columns fully covered by the polygon horizontally.
+    // Because the polygon is convex, the vertical range which the polygon covers for the entire column can be determined from the
+    // vertical ranges at the left and right boundaries of the column.
+    float prevYMin = {};
+    float prevYMax = {};
+
+    if (!RV_GetOccPolyYRangeAtX(ndcPoints, numNdcPoints, (float) begBoundary * OCC_COLUMN_W - 1.0f, prevYMin, prevYMax))
+        return;
+
+    for (int32_t colIdx = begBoundary; colIdx < endBoundary; ++colIdx) {
+        float nextYMin;
+        float nextYMax;
+
+        if (!RV_GetOccPolyYRangeAtX(ndcPoints, numNdcPoints, (float)(colIdx + 1) * OCC_COLUMN_W - 1.0f, nextYMin, nextYMax))
+            return;
+
+        const float coverBy = std::max(prevYMin, nextYMin);
+        const float coverTy = std::min(prevYMax, nextYMax);
+        prevYMin = nextYMin;
+        prevYMax = nextYMax;
+
+        // Grow the occluded areas at the top and bottom of the column if the covered range touches them
+        if (coverBy > coverTy)
+            continue;
+
+        OccColumn& column = gRvOccColumns[colIdx];
+
+        if ((coverTy >= column.openTy) && (coverBy < column.openTy)) {
+            column.openTy = coverBy;
+        }
+
+        if ((coverBy <= column.openBy) && (coverTy > column.openBy)) {
+            column.openBy = coverTy;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Checks if any part of the given axis aligned 3D box (xyz world coords, Vulkan coordinate system) is visible according to the coarse
+// occlusion buffer. Always returns 'true' if the buffer is not in use or if part of the box is behind the front view plane.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool RV_IsBoxVisibleInOccBuffer(const float boxMin[3], const float boxMax[3]) noexcept {
+    if (!gbRvOccBufferEnabled)
+        return true;
+
+    // Get the screen area covered by all of the box corners
+    float boxLx = +INFINITY;
+    float boxRx = -INFINITY;
+    float boxBy = +INFINITY;
+    float boxTy = -INFINITY;
+
+    for (uint32_t cornerIdx = 0; cornerIdx < 8; ++cornerIdx) {
+        const float cornerPos[3] = {
+            (cornerIdx & 1) ? boxMax[0] : boxMin[0],
+            (cornerIdx & 2) ? boxMax[1] : boxMin[1],
+            (cornerIdx & 4) ? boxMax[2] : boxMin[2]
+        };
+
+        float clipXYW[3];
+
+        if (RV_OccTransformPoint(cornerPos, clipXYW))
+            return true;
+
+        const float ndcX = clipXYW[0] / clipXYW[2];
+        const float ndcY = clipXYW[1] / clipXYW[2];
+        boxLx = std::min(boxLx, ndcX);
+        boxRx = std::max(boxRx, ndcX);
+        boxBy = std::min(boxBy, ndcY);
+        boxTy = std::max(boxTy, ndcY);
+    }
+
+    // Check if any of the columns that the box touches are open in the vertical range covered by the box
+    const int32_t begCol = std::max((int32_t) std::floor((boxLx + 1.0f) / OCC_COLUMN_W), 0);
+    const int32_t endCol = std::min((int32_t) std::floor((boxRx + 1.0f) / OCC_COLUMN_W) + 1, OCC_BUFFER_W);
+
+    for (int32_t colIdx = begCol; colIdx < endCol; ++colIdx) {
+        const OccColumn& column = gRvOccColumns[colIdx];
+        const bool bColumnOpen = (column.openBy < column.openTy);
+
+        if (bColumnOpen && (boxTy > column.openBy) && (boxBy < column.openTy))
+            return true;
+    }
+
+    return false;
 }
 
 #endif  // #if PSYDOOM_VULKAN_RENDERER
@@ -2,8 +2,13 @@
 
 #if PSYDOOM_VULKAN_RENDERER
 
-void RV_ClearOcclussion() noexcept;
+#include <cstdint>
+
+void RV_ClearOcclussion(const bool bUseOccBuffer) noexcept;
 void RV_OccludeRange(float xMin, float xMax) noexcept;
 bool RV_IsRangeVisible(float xMin, float xMax) noexcept;
+bool RV_IsOccBufferEnabled() noexcept;
+void RV_OccludeConvexPoly(const float (* const pPoints)[3], const int32_t numPoints) noexcept;
+bool RV_IsBoxVisibleInOccBuffer(const float boxMin[3], const float boxMax[3]) noexcept;
 
 #endif  // #if PSYDOOM_VULKAN_RENDERER
@@ -9,6 +9,7 @@
 #include "Doom/Base/i_main.h"
 #include "Doom/Base/w_wad.h"
 #include "Doom/Game/doomdata.h"
+#include "Doom/Game/p_firesky.h"
 #include "Doom/Renderer/r_data.h"
 #include "Doom/Renderer/r_sky.h"
 #include "Gpu.h"
@@ -71,7 +72,8 @@ void RV_CacheSkyTex() noexcept {
     if (skyTex.uploadFrameNum != TEX_INVALID_UPLOAD_FRAME_NUM)
         return;
 
-    // Need to upload the texture to VRAM, do that now and also ensure texture metrics are up-to-date
+    // Need to upload the texture to VRAM, do that now and also ensure texture metrics are up-to-date.
+    // For the fire sky only the rows which changed since the last upload are uploaded, if possible.
     const WadLump& skyTexLump = W_GetLump(skyTex.lumpNum);
     const std::byte* const pLumpData = (const std::byte*) skyTexLump.pCachedData;
     const uint16_t* const pTexData = (const std::uint16_t*)(pLumpData + sizeof(texlump_header_t));
@@ -79,7 +81,7 @@ void RV_CacheSkyTex() noexcept {
     R_UpdateTexMetricsFromData(skyTex, pLumpData, skyTexLump.uncompressedSize);
 
     SRECT vramRect = getTextureVramRect(skyTex);
-    LIBGPU_LoadImage(vramRect, pTexData);
+    P_UploadSkyTex(skyTex, vramRect, pTexData);
     skyTex.uploadFrameNum = gNumFramesDrawn;
 }
 
@@ -14,6 +14,7 @@
 #include "Doom/Renderer/r_data.h"
 #include "Doom/Renderer/r_local.h"
 #include "Doom/Renderer/r_main.h"
+#include "PsyDoom/GameJobs.h"
 #include "PsyDoom/Vulkan/VDrawing.h"
 #include "PsyDoom/Vulkan/VTypes.h"
 #include "rv_bsp.h"
@@ -58,6 +59,26 @@ struct SplitTestLine {
     float yb, yt;
 };
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A full (unsplit) sprite fragment for a thing, along with the thing's position.
+// These are created on the main thread (since textures must be cached) and then split up on BSP boundaries by sprite fragment jobs.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct ThingSpriteFrag {
+    SpriteFrag  frag;
+    float       thingPos[3];    // XYZ position of the thing (Vulkan coords), used to resolve cases where we can't split
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A sprite fragment output by a sprite fragment job, along with the draw subsector it's to be drawn in
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct SubsecSpriteFrag {
+    int32_t     drawSubsecIdx;
+    SpriteFrag  frag;
+};
+
+// How many things each sprite fragment job splits into sprite fragments
+static constexpr uint32_t SPRITE_FRAG_JOB_SIZE = 16;
+
 // All of the sprite fragments to be drawn in this frame
 static std::vector<SpriteFrag> gRvSpriteFrags;
 
@@ -68,8 +89,12 @@ static std::vector<int32_t> gRvDrawSubsecSprFrags;
 // This temporary list is re-used for each subsector to avoid allocations.
 static std::vector<const SpriteFrag*> gRvSortedFrags;
 
-// XYZ position for the current thing which is having sprite fragments generated
-static float gSpriteFragThingPos[3];
+// The full sprite fragments for all visible things in this frame, awaiting splitting up on BSP boundaries
+static std::vector<ThingSpriteFrag> gRvThingSprFrags;
+
+// The output sprite fragments for each sprite fragment job.
+// These are added to the draw lists in job order after all the jobs are done, so the results are the same as splitting on one thread.
+static std::vector<std::vector<SubsecSpriteFrag>> gRvSprFragJobOutputs;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Get and cache the texture to use for the given thing and sprite frame, and get whether it is flipped.
@@ -270,28 +295,29 @@ static void RV_InitSpriteFrag(
 static void RV_DrawSpriteFrag(const SpriteFrag& sprFrag) noexcept {
     VDrawing::setDrawPipeline(sprFrag.drawPipeline);
 
-    const uint8_t colR = sprFrag.colR;
-    const uint8_t colG = sprFrag.colG;
-    const uint8_t colB = sprFrag.colB;
-
-    VDrawing::addWorldQuad(
-        { sprFrag.x1, sprFrag.yb, sprFrag.z1, sprFrag.ul, sprFrag.vb, colR, colG, colB },
-        { sprFrag.x1, sprFrag.yt, sprFrag.z1, sprFrag.ul, sprFrag.vt, colR, colG, colB },
-        { sprFrag.x2, sprFrag.yt, sprFrag.z2, sprFrag.ur, sprFrag.vt, colR, colG, colB },
-        { sprFrag.x2, sprFrag.yb, sprFrag.z2, sprFrag.ur, sprFrag.vb, colR, colG, colB },
+    VDrawing::addWorldSprite(
+        sprFrag.x1, sprFrag.z1,
+        sprFrag.x2, sprFrag.z2,
+        sprFrag.yt, sprFrag.yb,
+        sprFrag.ul, sprFrag.ur,
+        sprFrag.vt, sprFrag.vb,
+        sprFrag.colR, sprFrag.colG, sprFrag.colB,
         gClutX, gClutY,
         sprFrag.texWinX, sprFrag.texWinY,
         sprFrag.texWinW, sprFrag.texWinH,
-        VLightDimMode::None,
         sprFrag.stMulR, sprFrag.stMulG, sprFrag.stMulB, sprFrag.stMulA
     );
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Makes the sprite fragment visit the specified subsector.
-// Adds it to the draw list of sprite fragments for that subsector.
+// Outputs the fragment so that it can be added to the draw list of sprite fragments for that subsector later.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void RV_SpriteFrag_VisitSubsector(const subsector_t& subsec, const SpriteFrag& frag) noexcept {
+static void RV_SpriteFrag_VisitSubsector(
+    const subsector_t& subsec,
+    const SpriteFrag& frag,
+    std::vector<SubsecSpriteFrag>& outFrags
+) noexcept {
     // If the subsector is not drawn then ignore and don't assign the sprite to a draw list
     const int32_t drawSubsecIdx = subsec.vkDrawSubsecIdx;
 
@@ -299,12 +325,7 @@ static void RV_SpriteFrag_VisitSubsector(const subsector_t& subsec, const Sprite
         return;
 
     ASSERT((size_t) drawSubsecIdx < gRvDrawSubsecSprFrags.size());
-
-    // Add this sprite fragment to the draw list for the subsector
-    const int32_t sprFragIdx = (int32_t) gRvSpriteFrags.size();
-    SpriteFrag& drawFrag = gRvSpriteFrags.emplace_back(frag);
-    drawFrag.nextSubsecFragIdx = gRvDrawSubsecSprFrags[drawSubsecIdx];
-    gRvDrawSubsecSprFrags[drawSubsecIdx] = sprFragIdx;
+    outFrags.push_back({ drawSubsecIdx, frag });
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -437,15 +458,20 @@ static bool RV_SpriteSplitTest_VisitBspNode(const int32_t nodeIdx, const SplitTe
 // Does recursive traversal of the BSP tree against the specified sprite fragment.
 // Splits up the fragment along BSP split boundaries as needed and assigns the fragments to appropriate destination subsectors.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void RV_SpriteFrag_VisitBspNode(const int32_t nodeIdx, SpriteFrag& frag) noexcept {
+static void RV_SpriteFrag_VisitBspNode(
+    const int32_t nodeIdx,
+    SpriteFrag& frag,
+    const float thingPos[3],
+    std::vector<SubsecSpriteFrag>& outFrags
+) noexcept {
     // Is this node number a subsector? If so then add the sprite fragment to it's draw lists
     if (nodeIdx & NF_SUBSECTOR) {
         // Note: this strange check is in the PC engine too...
         // Under what circumstances can the node number be '-1'?
         if (nodeIdx == -1) {
-            RV_SpriteFrag_VisitSubsector(gpSubsectors[0], frag);
+            RV_SpriteFrag_VisitSubsector(gpSubsectors[0], frag, outFrags);
         } else {
-            RV_SpriteFrag_VisitSubsector(gpSubsectors[nodeIdx & (~NF_SUBSECTOR)], frag);
+            RV_SpriteFrag_VisitSubsector(gpSubsectors[nodeIdx & (~NF_SUBSECTOR)], frag, outFrags);
         }
     } else {
         // This is not a subsector, continue traversing the BSP tree and splitting the sprite fragment
@@ -475,9 +501,9 @@ static void RV_SpriteFrag_VisitBspNode(const int32_t nodeIdx, SpriteFrag& frag)
         if (bSide1 == bSide2) {
             // No split needed, just recurse into the appropriate side
             if (bSide1) {
-                RV_SpriteFrag_VisitBspNode(node.children[0], frag);
+                RV_SpriteFrag_VisitBspNode(node.children[0], frag, thingPos, outFrags);
             } else {
-                RV_SpriteFrag_VisitBspNode(node.children[1], frag);
+                RV_SpriteFrag_VisitBspNode(node.children[1], frag, thingPos, outFrags);
             }
         } else {
             // Need to split (less common case): need to compute where the split would happen.
@@ -517,14 +543,14 @@ static void RV_SpriteFrag_VisitBspNode(const int32_t nodeIdx, SpriteFrag& frag)
             if (!RV_SpriteSplitTest_VisitBspNode(nodeIdx, splitLine)) {
                 // Can't split, decide which part of the tree to place the sprite fragment in based on the sprite's center point.
                 // If splits are not possible then ultimately we will tend to put the thing's sprite parts closest to it's home subsector for rendering.
-                const float lprod_center = nodeDx * (gSpriteFragThingPos[2] - nodePy);
-                const float rprod_center = nodeDy * (gSpriteFragThingPos[0] - nodePx);
+                const float lprod_center = nodeDx * (thingPos[2] - nodePy);
+                const float rprod_center = nodeDy * (thingPos[0] - nodePx);
                 const bool bCenterSide = (lprod_center < rprod_center);
 
                 if (bCenterSide) {
-                    RV_SpriteFrag_VisitBspNode(node.children[0], frag);
+                    RV_SpriteFrag_VisitBspNode(node.children[0], frag, thingPos, outFrags);
                 } else {
-                    RV_SpriteFrag_VisitBspNode(node.children[1], frag);
+                    RV_SpriteFrag_VisitBspNode(node.children[1], frag, thingPos, outFrags);
                 }
             }
             else {
@@ -544,11 +570,11 @@ static void RV_SpriteFrag_VisitBspNode(const int32_t nodeIdx, SpriteFrag& frag)
                 // Recurse using the split fragments.
                 // Splits shouldn't happen TOO often so hopefully stack space should not be an issue.
                 if (bSide1) {
-                    RV_SpriteFrag_VisitBspNode(node.children[0], frag1);
-                    RV_SpriteFrag_VisitBspNode(node.children[1], frag2);
+                    RV_SpriteFrag_VisitBspNode(node.children[0], frag1, thingPos, outFrags);
+                    RV_SpriteFrag_VisitBspNode(node.children[1], frag2, thingPos, outFrags);
                 } else {
-                    RV_SpriteFrag_VisitBspNode(node.children[1], frag1);
-                    RV_SpriteFrag_VisitBspNode(node.children[0], frag2);
+                    RV_SpriteFrag_VisitBspNode(node.children[1], frag1, thingPos, outFrags);
+                    RV_SpriteFrag_VisitBspNode(node.children[0], frag2, thingPos, outFrags);
                 }
             }
         }
@@ -556,7 +582,8 @@ static void RV_SpriteFrag_VisitBspNode(const int32_t nodeIdx, SpriteFrag& frag)
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Creates all of the sprite fragments for sprites contained in the specfied subsector
+// Creates the full (unsplit) sprite fragments for sprites contained in the specfied subsector.
+// These are split up along BSP boundaries later by sprite fragment jobs.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void RV_BuildSubsectorSpriteFrags(const subsector_t& subsec, [[maybe_unused]] const int32_t drawSubsecIdx) noexcept {
     // Sanity check!
@@ -593,18 +620,34 @@ static void RV_BuildSubsectorSpriteFrags(const subsector_t& subsec, [[maybe_unus
         uint8_t secB;
         R_GetSectorDrawColor(*subsec.sector, thingZ, secR, secG, secB);
 
-        // Allocate and initialize a full sprite fragment for the thing
-        SpriteFrag sprFrag;
-        RV_InitSpriteFrag(*pThing, sprFrag, thingX, thingY, thingZ, secR, secG, secB);
-
-        // Split up the sprite fragment into further small pieces (on subsector boundaries) if neccessary and remember the position of the thing being split.
+        // Allocate and initialize a full sprite fragment for the thing and remember the position of the thing.
         // The thing position is used to resolve cases that we can't split and where we need to decide on a sprite subsector.
-        gSpriteFragThingPos[0] = RV_FixedToFloat(thingX);
-        gSpriteFragThingPos[1] = RV_FixedToFloat(thingZ);   // N.B: converting to Vulkan coords (where 'y' is up and 'z' is foward)
-        gSpriteFragThingPos[2] = RV_FixedToFloat(thingY);
+        ThingSpriteFrag& thingFrag = gRvThingSprFrags.emplace_back();
+        RV_InitSpriteFrag(*pThing, thingFrag.frag, thingX, thingY, thingZ, secR, secG, secB);
 
-        const int32_t bspRootNodeIdx = gNumBspNodes - 1;
-        RV_SpriteFrag_VisitBspNode(bspRootNodeIdx, sprFrag);
+        thingFrag.thingPos[0] = RV_FixedToFloat(thingX);
+        thingFrag.thingPos[1] = RV_FixedToFloat(thingZ);    // N.B: converting to Vulkan coords (where 'y' is up and 'z' is foward)
+        thingFrag.thingPos[2] = RV_FixedToFloat(thingY);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Job which splits up a range of thing sprite fragments into further small pieces (on subsector boundaries) where neccessary.
+// Only reads level and visibility data, and writes to it's own output list - so it can be executed on any thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void RV_SplitSpriteFragsJob([[maybe_unused]] void* const pCtx, const uint32_t jobIdx) noexcept {
+    ASSERT(jobIdx < gRvSprFragJobOutputs.size());
+    std::vector<SubsecSpriteFrag>& outFrags = gRvSprFragJobOutputs[jobIdx];
+    outFrags.clear();
+
+    const uint32_t numThingFrags = (uint32_t) gRvThingSprFrags.size();
+    const uint32_t begIdx = jobIdx * SPRITE_FRAG_JOB_SIZE;
+    const uint32_t endIdx = std::min(begIdx + SPRITE_FRAG_JOB_SIZE, numThingFrags);
+    const int32_t bspRootNodeIdx = gNumBspNodes - 1;
+
+    for (uint32_t i = begIdx; i < endIdx; ++i) {
+        ThingSpriteFrag& thingFrag = gRvThingSprFrags[i];
+        RV_SpriteFrag_VisitBspNode(bspRootNodeIdx, thingFrag.frag, thingFrag.thingPos, outFrags);
     }
 }
 
@@ -622,11 +665,34 @@ void RV_BuildSpriteFragLists() noexcept {
     gRvDrawSubsecSprFrags.reserve(4196);
     gRvDrawSubsecSprFrags.resize((size_t) numDrawSubsecs, -1);
     gRvSortedFrags.reserve(256);
+    gRvThingSprFrags.clear();
 
-    // Run through all of the draw subsectors and build a list of sprite fragments for each
+    // Run through all of the draw subsectors and create the full sprite fragments for all things in each.
+    // Note that this must be done on this thread because sprite textures are uploaded to VRAM along the way.
     for (int32_t drawSubsecIdx = 0; drawSubsecIdx < numDrawSubsecs; ++drawSubsecIdx) {
         RV_BuildSubsectorSpriteFrags(*gRvDrawSubsecs[drawSubsecIdx], drawSubsecIdx);
     }
+
+    // Split up all of the sprite fragments along BSP boundaries: this is the expensive part and can be done on multiple threads
+    const uint32_t numThingFrags = (uint32_t) gRvThingSprFrags.size();
+    const uint32_t numJobs = (numThingFrags + SPRITE_FRAG_JOB_SIZE - 1) / SPRITE_FRAG_JOB_SIZE;
+
+    if (gRvSprFragJobOutputs.size() < numJobs) {
+        gRvSprFragJobOutputs.resize(numJobs);
+    }
+
+    GameJobs::run(RV_SplitSpriteFragsJob, nullptr, numJobs);
+
+    // Add the split sprite fragments to the draw list for each draw subsector, in job order
+    for (uint32_t jobIdx = 0; jobIdx < numJobs; ++jobIdx) {
+        for (const SubsecSpriteFrag& subsecFrag : gRvSprFragJobOutputs[jobIdx]) {
+            const int32_t drawSubsecIdx = subsecFrag.drawSubsecIdx;
+            const int32_t sprFragIdx = (int32_t) gRvSpriteFrags.size();
+            SpriteFrag& drawFrag = gRvSpriteFrags.emplace_back(subsecFrag.frag);
+            drawFrag.nextSubsecFragIdx = gRvDrawSubsecSprFrags[drawSubsecIdx];
+            gRvDrawSubsecSprFrags[drawSubsecIdx] = sprFragIdx;
+        }
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
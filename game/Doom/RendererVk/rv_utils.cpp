@@ -6,6 +6,7 @@
 #include "rv_utils.h"
 
 #include "Doom/Base/i_main.h"
+#include "Doom/Base/i_texcache.h"
 #include "Doom/Base/w_wad.h"
 #include "Doom/Game/doomdata.h"
 #include "Doom/Game/g_game.h"
@@ -13,6 +14,7 @@
 #include "Doom/Renderer/r_local.h"
 #include "Doom/Renderer/r_main.h"
 #include "Gpu.h"
+#include "PsyDoom/DecodedTexPool.h"
 #include "PsyDoom/Vulkan/VDrawing.h"
 #include "PsyDoom/Vulkan/VTypes.h"
 #include "PsyQ/LIBGPU.h"
@@ -128,7 +130,8 @@ void RV_UploadDirtyTex(texture_t& tex) noexcept {
     if (tex.uploadFrameNum != TEX_INVALID_UPLOAD_FRAME_NUM)
         return;
 
-    // Decompress the lump data to the temporary buffer if required
+    // Decompress the lump data to the temporary buffer if required.
+    // Try to use the decoded texture pool first, so that re-uploads of the texture can skip decompression.
     const std::byte* pLumpData;
 
     const WadLump& texLump = W_GetLump(tex.lumpNum);
@@ -136,6 +139,8 @@ void RV_UploadDirtyTex(texture_t& tex) noexcept {
 
     if (bIsUncompressedLump) {
         pLumpData = (const std::byte*) texLump.pCachedData;
+    } else if (const std::byte* const pPooledLumpData = DecodedTexPool::getLumpData(tex.lumpNum, texLump)) {
+        pLumpData = pPooledLumpData;
     } else {
         const void* pCompressedLumpData = texLump.pCachedData;
 
@@ -160,6 +165,9 @@ void RV_UploadDirtyTex(texture_t& tex) noexcept {
     const SRECT vramRect = getTextureVramRect(tex);
     LIBGPU_LoadImage(vramRect, (uint16_t*)(pLumpData + sizeof(texlump_header_t)));
     tex.uploadFrameNum = gNumFramesDrawn;
+
+    gTexCacheStats.numUploads++;
+    gTexCacheStats.numBytesUploaded += (uint64_t) vramRect.w * vramRect.h * sizeof(uint16_t);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -20,6 +20,9 @@
 #include "PsyQ/LIBETC.h"
 #include "PsyQ/LIBGPU.h"
 
+#include <algorithm>
+#include <vector>
+
 static constexpr fixed_t MOVESTEP   = FRACUNIT * 128;   // Controls how fast manual automap movement happens
 static constexpr fixed_t SCALESTEP  = 2;                // How fast to scale in/out
 static constexpr int32_t MAXSCALE   = 64;               // Maximum map zoom
@@ -43,6 +46,151 @@ static fixed_t gAM_AutomapX;
 static fixed_t gAM_AutomapY;
 static fixed_t gAM_AutomapScale;
 
+// PsyDoom: map lines are bucketed into a coarse grid of cells when the level starts, so that only the lines in or near the automap view
+// need to be considered for drawing each frame. A line is added to every cell that its bounding box overlaps.
+static constexpr int32_t AM_CELL_SHIFT = FRACBITS + 10;     // Cells are 1024x1024 map units
+
+static fixed_t                  gAM_CellsOriginX;           // Where the grid of cells starts
+static fixed_t                  gAM_CellsOriginY;
+static int32_t                  gAM_NumCellsX;              // Size of the grid of cells
+static int32_t                  gAM_NumCellsY;
+static std::vector<int32_t>     gAM_CellLinesBeg;           // Where the lines for each cell start in 'gAM_CellLines' (with 1 extra entry for the end)
+static std::vector<int32_t>     gAM_CellLines;              // The indexes of the lines in all cells
+static std::vector<uint32_t>    gAM_LineGatherStamps;       // The last gather that each line was added in, to avoid adding lines twice
+static uint32_t                 gAM_CurGatherStamp;         // The number of the current (or last) gather
+static std::vector<int32_t>     gAM_GatheredLines;          // The indexes of the lines returned by the last gather
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: buckets the lines in the level into a coarse grid of cells, for culling automap lines against the automap view
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void AM_InitLineCells() noexcept {
+    const int32_t numLines = gNumLines;
+    const line_t* const pLines = gpLines;
+
+    // Figure out the bounds of all lines and size the grid of cells accordingly
+    fixed_t minX = INT32_MAX;
+    fixed_t minY = INT32_MAX;
+    fixed_t maxX = INT32_MIN;
+    fixed_t maxY = INT32_MIN;
+
+    for (int32_t lineIdx = 0; lineIdx < numLines; ++lineIdx) {
+        const line_t& line = pLines[lineIdx];
+        minX = std::min(minX, line.bbox[BOXLEFT]);
+        minY = std::min(minY, line.bbox[BOXBOTTOM]);
+        maxX = std::max(maxX, line.bbox[BOXRIGHT]);
+        maxY = std::max(maxY, line.bbox[BOXTOP]);
+    }
+
+    if (numLines <= 0) {
+        minX = minY = maxX = maxY = 0;
+    }
+
+    gAM_CellsOriginX = minX;
+    gAM_CellsOriginY = minY;
+    gAM_NumCellsX = (int32_t)(((int64_t) maxX - minX) >> AM_CELL_SHIFT) + 1;
+    gAM_NumCellsY = (int32_t)(((int64_t) maxY - minY) >> AM_CELL_SHIFT) + 1;
+
+    // Gets the range of cells overlapped by a line
+    const auto getLineCellRange = [](const line_t& line, int32_t& cellLx, int32_t& cellRx, int32_t& cellBy, int32_t& cellTy) noexcept {
+        cellLx = (int32_t)(((int64_t) line.bbox[BOXLEFT] - gAM_CellsOriginX) >> AM_CELL_SHIFT);
+        cellRx = (int32_t)(((int64_t) line.bbox[BOXRIGHT] - gAM_CellsOriginX) >> AM_CELL_SHIFT);
+        cellBy = (int32_t)(((int64_t) line.bbox[BOXBOTTOM] - gAM_CellsOriginY) >> AM_CELL_SHIFT);
+        cellTy = (int32_t)(((int64_t) line.bbox[BOXTOP] - gAM_CellsOriginY) >> AM_CELL_SHIFT);
+    };
+
+    // Count the number of lines in each cell and figure out where the lines for each cell begin
+    const int32_t numCells = gAM_NumCellsX * gAM_NumCellsY;
+    gAM_CellLinesBeg.clear();
+    gAM_CellLinesBeg.resize((size_t) numCells + 1, 0);
+
+    for (int32_t lineIdx = 0; lineIdx < numLines; ++lineIdx) {
+        int32_t cellLx, cellRx, cellBy, cellTy;
+        getLineCellRange(pLines[lineIdx], cellLx, cellRx, cellBy, cellTy);
+
+        for (int32_t cellY = cellBy; cellY <= cellTy; ++cellY) {
+            for (int32_t cellX = cellLx; cellX <= cellRx; ++cellX) {
+                gAM_CellLinesBeg[(size_t) cellY * gAM_NumCellsX + cellX + 1]++;
+            }
+        }
+    }
+
+    for (int32_t cellIdx = 0; cellIdx < numCells; ++cellIdx) {
+        gAM_CellLinesBeg[(size_t) cellIdx + 1] += gAM_CellLinesBeg[cellIdx];
+    }
+
+    // Add all the lines to the cells; lines are added in order so each cell's lines are sorted by line index
+    std::vector<int32_t> cellLinesEnd(gAM_CellLinesBeg.begin(), gAM_CellLinesBeg.end() - 1);
+    gAM_CellLines.clear();
+    gAM_CellLines.resize(gAM_CellLinesBeg.back());
+
+    for (int32_t lineIdx = 0; lineIdx < numLines; ++lineIdx) {
+        int32_t cellLx, cellRx, cellBy, cellTy;
+        getLineCellRange(pLines[lineIdx], cellLx, cellRx, cellBy, cellTy);
+
+        for (int32_t cellY = cellBy; cellY <= cellTy; ++cellY) {
+            for (int32_t cellX = cellLx; cellX <= cellRx; ++cellX) {
+                gAM_CellLines[cellLinesEnd[(size_t) cellY * gAM_NumCellsX + cellX]++] = lineIdx;
+            }
+        }
+    }
+
+    // Reset line gathering
+    gAM_LineGatherStamps.clear();
+    gAM_LineGatherStamps.resize(numLines, 0);
+    gAM_CurGatherStamp = 0;
+    gAM_GatheredLines.clear();
+    gAM_GatheredLines.reserve(numLines);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: get the indexes of all lines which might be visible in an automap view with the given center and half extents (in fixed point).
+// All lines in grid cells overlapping the view are returned, in ascending order of line index so lines draw in their original order.
+// The returned list is only valid until the next call.
+//------------------------------------------------------------------------------------------------------------------------------------------
+const int32_t* AM_GetLinesInView(const int32_t viewX, const int32_t viewY, const int64_t halfW, const int64_t halfH, int32_t& numLinesOut) noexcept {
+    // Get the range of cells overlapped by the view
+    const int64_t maxCellX = gAM_NumCellsX - 1;
+    const int64_t maxCellY = gAM_NumCellsY - 1;
+    const int32_t cellLx = (int32_t) std::clamp<int64_t>(((int64_t) viewX - halfW - gAM_CellsOriginX) >> AM_CELL_SHIFT, 0, maxCellX);
+    const int32_t cellRx = (int32_t) std::clamp<int64_t>(((int64_t) viewX + halfW - gAM_CellsOriginX) >> AM_CELL_SHIFT, 0, maxCellX);
+    const int32_t cellBy = (int32_t) std::clamp<int64_t>(((int64_t) viewY - halfH - gAM_CellsOriginY) >> AM_CELL_SHIFT, 0, maxCellY);
+    const int32_t cellTy = (int32_t) std::clamp<int64_t>(((int64_t) viewY + halfH - gAM_CellsOriginY) >> AM_CELL_SHIFT, 0, maxCellY);
+
+    // Start a new gather, clearing the line stamps if the gather number wraps around
+    gAM_GatheredLines.clear();
+    gAM_CurGatherStamp++;
+
+    if (gAM_CurGatherStamp == 0) {
+        std::fill(gAM_LineGatherStamps.begin(), gAM_LineGatherStamps.end(), 0);
+        gAM_CurGatherStamp = 1;
+    }
+
+    // Gather all the lines in the cells, skipping lines already added.
+    // If the lines all come from 1 cell then they are already in order, otherwise they must be sorted.
+    for (int32_t cellY = cellBy; cellY <= cellTy; ++cellY) {
+        for (int32_t cellX = cellLx; cellX <= cellRx; ++cellX) {
+            const size_t cellIdx = (size_t) cellY * gAM_NumCellsX + cellX;
+            const int32_t cellLinesEnd = gAM_CellLinesBeg[cellIdx + 1];
+
+            for (int32_t i = gAM_CellLinesBeg[cellIdx]; i < cellLinesEnd; ++i) {
+                const int32_t lineIdx = gAM_CellLines[i];
+
+                if (gAM_LineGatherStamps[lineIdx] != gAM_CurGatherStamp) {
+                    gAM_LineGatherStamps[lineIdx] = gAM_CurGatherStamp;
+                    gAM_GatheredLines.push_back(lineIdx);
+                }
+            }
+        }
+    }
+
+    if ((cellLx != cellRx) || (cellBy != cellTy)) {
+        std::sort(gAM_GatheredLines.begin(), gAM_GatheredLines.end());
+    }
+
+    numLinesOut = (int32_t) gAM_GatheredLines.size();
+    return gAM_GatheredLines.data();
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Compute the position and rotation to use for the automap for the player, taking into account framerate independent movement.
 // Also does the same for the 'free camera' automap position that is used when the player is manually panning over the map.
@@ -81,6 +229,11 @@ void AM_Start() noexcept {
     gAutomapYMin = gBlockmapOriginY;
     gAutomapXMax = d_lshift<MAPBLOCKSHIFT>(gBlockmapWidth) + gBlockmapOriginX;
     gAutomapYMax = d_lshift<MAPBLOCKSHIFT>(gBlockmapHeight) + gBlockmapOriginY;
+
+    // PsyDoom: bucket lines into grid cells for culling
+    #if PSYDOOM_MODS
+        AM_InitLineCells();
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -293,11 +446,26 @@ void AM_Drawer() noexcept {
         }
     #endif
 
-    // Draw all the map lines
+    // Draw all the map lines.
+    // PsyDoom: only consider lines in grid cells overlapping the automap view, plus a small margin for rounding.
     {
-        const line_t* pLine = gpLines;
+        #if PSYDOOM_MODS
+            const int64_t viewHalfW = ((int64_t)(HALF_SCREEN_W + 2) * SCREEN_W * FRACUNIT * FRACUNIT) / std::max(scale, 1);
+            const int64_t viewHalfH = ((int64_t)(SCREEN_H / 2 + 2) * SCREEN_W * FRACUNIT * FRACUNIT) / std::max(scale, 1);
+
+            int32_t numLinesToDraw;
+            const int32_t* const pLinesToDraw = AM_GetLinesInView(ox, oy, viewHalfW, viewHalfH, numLinesToDraw);
+        #else
+            const int32_t numLinesToDraw = gNumLines;
+        #endif
+
+        for (int32_t i = 0; i < numLinesToDraw; ++i) {
+            #if PSYDOOM_MODS
+                const line_t* const pLine = &gpLines[pLinesToDraw[i]];
+            #else
+                const line_t* const pLine = &gpLines[i];
+            #endif
 
-        for (int32_t lineIdx = 0; lineIdx < gNumLines; ++lineIdx, ++pLine) {
             // See whether we should draw the automap line or not
             const bool bHiddenLine = (pLine->flags & ML_DONTDRAW);
             const bool bLineSeen = ((pLine->flags & ML_MAPPED) && (!bHiddenLine));
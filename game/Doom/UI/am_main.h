@@ -37,4 +37,5 @@ void AM_Drawer() noexcept;
 #if PSYDOOM_MODS
     uint32_t AM_GetPlayerColor(const int32_t playerIdx, const bool bBrighten) noexcept;
     uint32_t AM_GetMobjColor(const mobj_t& mobj, const bool bBrighten) noexcept;
+    const int32_t* AM_GetLinesInView(const int32_t viewX, const int32_t viewY, const int64_t halfW, const int64_t halfH, int32_t& numLinesOut) noexcept;
 #endif
@@ -19,7 +19,6 @@
 #include "Doom/Renderer/r_data.h"
 #include "errormenu_main.h"
 #include "FileInputStream.h"
-#include "FileOutputStream.h"
 #include "FileUtils.h"
 #include "m_main.h"
 #include "o_main.h"
@@ -64,30 +63,73 @@ struct SaveSlotMapName {
     char chars[MAX_DISPLAY_CHARS + 1];
 };
 
+// Cached slot info for a save file, so the slots don't need to be re-read each time the menu opens if the file is unchanged
+struct SaveFileInfoCache {
+    int64_t         fileModTime;    // Modification time of the save file when it was last read, or '-1' if not cached
+    int64_t         fileSize;       // Size of the save file when it was last read
+    SaveFileInfo    info;           // The cached slot info
+};
+
 static LoadSaveMenuMode     gMenuMode;                  // What mode the menu is operating in
 static uint8_t              gSlotHighlightPhase;        // Current phase for the slot highlight effect
 static SaveFileInfo         gSaveFiles[5];              // The 5 save file slots
 static int32_t              gFocusedSaveSlot;           // Which save slot is currently focused (-1 if none)
 static bool                 gbLoadSaveOnLevelStart;     // If true then load the currently buffered save on loading the next map
+static bool                 gbSaveWritePending;         // If true then a save is being written in the background and its result has not been shown yet
+static SaveGameContext      gPendingSaveContext;        // What triggered the save that is being written in the background
+static SaveFileInfoCache    gSaveFileCache[5] = { {-1}, {-1}, {-1}, {-1}, {-1} };   // Cached slot info for the 5 save files, by file modification time
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Waits for any save being written in the background to finish and displays the result of it to the HUD.
+// Skip the HUD message however if the unusual situation arises where we are auto-saving on level start and there is already
+// a message being displayed. The message already being displayed is likely a warning of some sort, so it should get priority.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void FinishPendingSave() noexcept {
+    if (!gbSaveWritePending)
+        return;
+
+    gbSaveWritePending = false;
+    const bool bSuccess = SaveAndLoad::endSaveToFile();
+
+    const bool bHudAlreadyHasMessage = ((gStatusBar.message != nullptr) && (gStatusBar.messageTicsLeft > 0));
+    const bool bIsAutoSaving = (gPendingSaveContext == SaveGameContext::Autosave);
+    const bool bSkipHudMessage = (bHudAlreadyHasMessage && bIsAutoSaving);
+
+    if (!bSkipHudMessage) {
+        DisplaySavedHudMessage(gPendingSaveContext, bSuccess);
+    }
+}
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Tries to read the header for the specified save file and populates the slot info from it.
-// Does nothing if the save does not exist.
+// Only the fixed size header is read, never the bulk of the save data. If the save file has not changed since it was last read then the
+// cached slot info is used instead and the file is not opened at all. Does nothing if the save does not exist.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void ReadSaveHeader(SaveFileInfo& save) noexcept {
+static void ReadSaveHeader(SaveFileInfo& save, SaveFileInfoCache& cache) noexcept {
     std::string saveFilePath = SaveAndLoad::getSaveFilePath(save.slot);
 
-    if (!FileUtils::fileExists(saveFilePath.c_str()))
+    if (!FileUtils::fileExists(saveFilePath.c_str())) {
+        cache.fileModTime = -1;
+        return;
+    }
+
+    // Use the cached info if the file is unchanged.
+    // Check the size also in case the modification time has a coarse resolution on this platform.
+    const int64_t fileModTime = FileUtils::getFileModTime(saveFilePath.c_str());
+    const int64_t fileSize = FileUtils::getFileSize(saveFilePath.c_str());
+
+    if ((fileModTime >= 0) && (fileModTime == cache.fileModTime) && (fileSize == cache.fileSize) && (cache.info.slot == save.slot)) {
+        save = cache.info;
         return;
+    }
 
     try {
         // Read the file header
         FileInputStream file = FileInputStream(saveFilePath.c_str());
         SaveFileHdr saveHdr;
-        file.read(saveHdr);
 
         // Make sure it is valid for this version of the game
-        if (saveHdr.validateFileId() && saveHdr.validateVersion()) {
+        if (saveHdr.readFrom(file) == ReadSaveResult::OK) {
             // Save the map information
             save.mapNum = (uint8_t) saveHdr.mapNum;
             save.mapName = saveHdr.mapName;
@@ -104,6 +146,11 @@ static void ReadSaveHeader(SaveFileInfo& save) noexcept {
             secondsLeft %= SECS_PER_MIN;
             save.secs = (uint8_t)(secondsLeft);
         }
+
+        // Cache the slot info for next time
+        cache.fileModTime = fileModTime;
+        cache.fileSize = fileSize;
+        cache.info = save;
     }
     catch (...) {
         // Ignore...
@@ -287,9 +334,11 @@ void LoadSave_Init() noexcept {
     gSaveFiles[3].label = 'q';  gSaveFiles[3].slot = SaveFileSlot::QUICKSAVE;
     gSaveFiles[4].label = 'a';  gSaveFiles[4].slot = SaveFileSlot::AUTOSAVE;
 
-    // Read the headers for each save
-    for (SaveFileInfo& save : gSaveFiles) {
-        ReadSaveHeader(save);
+    // Read the headers for each save, after making sure any save being written in the background is done
+    FinishPendingSave();
+
+    for (uint32_t i = 0; i < C_ARRAY_SIZE(gSaveFiles); ++i) {
+        ReadSaveHeader(gSaveFiles[i], gSaveFileCache[i]);
     }
 }
 
@@ -525,32 +574,18 @@ void LoadSave_Draw() noexcept {
 gameaction_t SaveGameForSlot(const SaveFileSlot slot, const SaveGameContext saveContext) noexcept {
     ASSERT_LOG(gNetGame == gt_single, "Should only be called in single player games!");
 
-    // Do the save and remember temporarily the slot being used
-    SaveAndLoad::gCurSaveSlot = slot;
-    bool bSuccess = false;
-
-    try {
-        const std::string savePath = SaveAndLoad::getSaveFilePath(slot);
-        FileOutputStream file(savePath.c_str(), false);
-        bSuccess = SaveAndLoad::save(file);
-    }
-    catch (...) {
-        // Ignore...
-    }
-
-    // Display the result to the HUD and clear the current slot being loaded.
-    // Skip the HUD message however if the unusual situation arises where we are auto-saving on level start and there is already
-    // a message being displayed. The message already being displayed is likely a warning of some sort, so it should get priority.
-    const bool bHudAlreadyHasMessage = ((gStatusBar.message != nullptr) && (gStatusBar.messageTicsLeft > 0));
-    const bool bIsAutoSaving = (saveContext == SaveGameContext::Autosave);
-    const bool bSkipHudMessage = (bHudAlreadyHasMessage && bIsAutoSaving);
-
-    if (!bSkipHudMessage) {
-        DisplaySavedHudMessage(saveContext, bSuccess);
-    }
+    // Finish up any previous save still being written before starting this one
+    FinishPendingSave();
 
+    // Capture the game state and begin writing it to the save file in the background, remembering temporarily the slot being used.
+    // The result is displayed to the HUD once the write has finished, see 'UpdatePendingSave'.
+    SaveAndLoad::gCurSaveSlot = slot;
+    SaveAndLoad::beginSaveToFile(SaveAndLoad::getSaveFilePath(slot));
     SaveAndLoad::gCurSaveSlot = SaveFileSlot::NONE;
 
+    gbSaveWritePending = true;
+    gPendingSaveContext = saveContext;
+
     // Exit all menus and unpause the game
     gbUnpauseAfterOptionsMenu = true;
     return ga_exitmenus;
@@ -565,7 +600,8 @@ gameaction_t LoadGameForSlot(const SaveFileSlot slot, const LoadGameContext load
     gbLoadSaveOnLevelStart = false;
     SaveAndLoad::gCurSaveSlot = slot;
 
-    // Read the save first of all
+    // Read the save first of all, after making sure it's not still being written
+    FinishPendingSave();
     ReadSaveResult readSaveResult = ReadSaveResult::IO_ERROR;
 
     try {
@@ -688,6 +724,15 @@ void DisplayLoadedHudMessage(const LoadGameContext loadContext, const bool bSucc
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Called every game tic: displays the result of any save being written in the background once it has finished
+//------------------------------------------------------------------------------------------------------------------------------------------
+void UpdatePendingSave() noexcept {
+    if (gbSaveWritePending && (!SaveAndLoad::isSaveToFileInProgress())) {
+        FinishPendingSave();
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Helper: attempts to quicksave the game
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -699,7 +744,8 @@ void DoQuicksave() noexcept {
 // Helper: attempts to quickload the current quicksave
 //------------------------------------------------------------------------------------------------------------------------------------------
 gameaction_t DoQuickload() noexcept {
-    // Only do quickload if the file actually exists
+    // Only do quickload if the file actually exists (once any quicksave being written has finished)
+    FinishPendingSave();
     const std::string saveFilePath = SaveAndLoad::getSaveFilePath(SaveFileSlot::QUICKSAVE);
 
     if (FileUtils::fileExists(saveFilePath.c_str())) {
@@ -36,6 +36,7 @@ bool ShouldLoadSaveOnLevelStart() noexcept;
 void ClearLoadSaveOnLevelStartFlag() noexcept;
 void DisplaySavedHudMessage(const SaveGameContext saveContext, const bool bSuccess) noexcept;
 void DisplayLoadedHudMessage(const LoadGameContext loadContext, const bool bSuccess) noexcept;
+void UpdatePendingSave() noexcept;
 void DoQuicksave() noexcept;
 [[nodiscard]] gameaction_t DoQuickload() noexcept;
 
@@ -95,12 +95,14 @@ static void TI_DrawFire(const bool bUseFinalDoomFirePos, const bool bAdditiveBle
             const WadLump& fireSkyLump = W_GetLump(skyTex.lumpNum);
             const std::byte* const pSkyTexData = (const std::byte*) fireSkyLump.pCachedData;
             R_UpdateTexMetricsFromData(skyTex, pSkyTexData, fireSkyLump.uncompressedSize);
+
+            // PsyDoom: only upload the rows of the fire which changed, if possible
+            P_UploadSkyTex(skyTex, vramRect, (const uint16_t*)(pSkyTexData + sizeof(texlump_header_t)));
         #else
             const std::byte* const pSkyTexData = (const std::byte*) gpLumpCache[skytex.lumpNum];
+            LIBGPU_LoadImage(vramRect, (const uint16_t*)(pSkyTexData + sizeof(texlump_header_t)));
         #endif
 
-        LIBGPU_LoadImage(vramRect, (const uint16_t*)(pSkyTexData + sizeof(texlump_header_t)));
-
         // Mark this as uploaded now
         skyTex.uploadFrameNum = gNumFramesDrawn;
     }
@@ -467,6 +469,11 @@ void START_Title() noexcept {
 
         W_CacheLumpNum(skyTex.lumpNum, PU_CACHE, true);
         I_CacheTex(skyTex);
+
+        // PsyDoom: VRAM might have been overwritten since the fire was last uploaded, do a full upload next time
+        #if PSYDOOM_MODS
+            P_ResetFireSkyUploadRows();
+        #endif
     }
 
     // Doom: initially the DOOM logo is offscreen.
@@ -5,6 +5,7 @@
 #include "Base/i_file.h"
 #include "Base/i_main.h"
 #include "Base/i_misc.h"
+#include "Base/i_texcache.h"
 #include "Base/s_sound.h"
 #include "Base/w_wad.h"
 #include "Base/z_zone.h"
@@ -18,9 +19,12 @@
 #include "Game/p_switch.h"
 #include "Game/p_tick.h"
 #include "Game/sprinfo.h"
+#include "psx_main.h"
 #include "PsyDoom/Config/Config.h"
+#include "PsyDoom/DemoBatchRunner.h"
 #include "PsyDoom/DemoPlayer.h"
 #include "PsyDoom/DemoRecorder.h"
+#include "PsyDoom/FrameStats.h"
 #include "PsyDoom/Game.h"
 #include "PsyDoom/GameConstants.h"
 #include "PsyDoom/Input.h"
@@ -28,8 +32,13 @@
 #include "PsyDoom/MapInfo/MapInfo.h"
 #include "PsyDoom/Movie/MoviePlayer.h"
 #include "PsyDoom/PlayerPrefs.h"
+#include "PsyDoom/Profiler.h"
 #include "PsyDoom/ProgArgs.h"
 #include "PsyDoom/PsxPadButtons.h"
+#include "PsyDoom/ScriptingEngine.h"
+#include "PsyDoom/SimBench.h"
+#include "PsyDoom/TexturePatcher.h"
+#include "PsyDoom/TimeDemo.h"
 #include "PsyDoom/Utils.h"
 #include "PsyDoom/Video.h"
 #include "PsyQ/LIBGPU.h"
@@ -50,6 +59,7 @@
 #include <chrono>
 #include <cstdio>
 #include <memory>
+#include <thread>
 
 #if PSYDOOM_MODS
     // PsyDoom: how frequently (in seconds) to update the performance counters that track the average frame time
@@ -89,6 +99,15 @@ bool gbDidAbortGame = false;
     double      gPrevFrameDuration;             // How long the previous frame took: used to try and provide more accurate interpolation
     float       gPerfAvgFps;                    // Performance counter: averaged FPS for the last few frames
     float       gPerfAvgUsec;                   // Performance counter: averaged microseconds duration for the last few frames
+
+    static zonestats_t  gPerfZoneStats;                 // Performance counter: main memory zone usage, updated every few frames
+    static float        gPerfZoneMallocsPerTick;        // Performance counter: average main memory zone allocations per game tick for the last few frames
+    static float        gPerfZoneBytesPerTick;          // Performance counter: average main memory zone bytes allocated per game tick for the last few frames
+    static float        gPerfTexUploadsPerFrame;        // Performance counter: average textures uploaded to VRAM per frame for the last few frames
+    static float        gPerfTexBytesPerFrame;          // Performance counter: average bytes of texture data uploaded to VRAM per frame for the last few frames
+    static float        gPerfTexEvictionsPerFrame;      // Performance counter: average texture cache evictions per frame for the last few frames
+    static uint32_t     gPerfTexPagesInUse;             // Performance counter: number of texture cache pages with textures in them, updated every few frames
+
     bool        gbIsFirstTick;                  // Set to 'true' for the very first tick only, 'false' thereafter
     bool        gbKeepInputEvents;              // Ticker request: if true then don't consume input events after invoking the current ticker in 'MiniLoop'
     std::byte*  gpDemoBufferEnd;                // PsyDoom: save the end pointer for the buffer, so we know when to end the demo; do this instead of hardcoding the end
@@ -166,6 +185,16 @@ static void D_PlayIntros() noexcept {
         MiniLoop(START_Legals, STOP_Legals, TIC_Legals, DRAW_Legals);
     }
 }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: runs the given startup step and returns how long it took in milliseconds
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class StepFn>
+static double D_TimeStartupStep(const StepFn& stepFn) noexcept {
+    const auto startTime = std::chrono::steady_clock::now();
+    stepFn();
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+}
 #endif  // #if PSYDOOM_MODS
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -173,43 +202,99 @@ static void D_PlayIntros() noexcept {
 // Bootstraps the engine and platform specific code and runs the game loops.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void D_DoomMain() noexcept {
+    // PsyDoom: time how long each of the startup steps takes, for the startup timing report
+    #if PSYDOOM_MODS
+        const auto startupBegTime = std::chrono::steady_clock::now();
+    #endif
+
     // PlayStation specific setup
     I_PSXInit();
 
     // Sound init:
     #if PSYDOOM_MODS
-    {
         // PsyDoom: apply the sound and music volumes from the saved preferences file now, before we init sound
         PlayerPrefs::pushSoundAndMusicPrefs();
 
-        // PsyDoom: allocate a buffer big enough to hold the WMD file (as it is on disk) temporarily.
-        // The original PSX Doom used the 64 KiB static 'temp' buffer for this purpose; Final Doom did a temp 'Z_EndMalloc' of 122,880 bytes
-        // because it's WMD file was much bigger. This method is more flexible and will allow for practically any sized WMD.
-        const int32_t wmdFileSize = psxcd_get_file_size(CdFile::DOOMSND_WMD);
-        std::unique_ptr<std::byte[]> wmdFileBuffer(new std::byte[wmdFileSize]);
-        PsxSoundInit(doomToWessVol(gOptionsSndVol), doomToWessVol(gOptionsMusVol), wmdFileBuffer.get());
-    }
+        // PsyDoom: none of the other startup steps below depend on the sound system or use it, and sound init does not use zone memory or
+        // the WADs either. Initialize sound (loading the WMD and the main sound effects LCD) on a separate thread while the rest of startup
+        // is done, since it spends most of its time reading from the disc. Note that opening and closing CD files and querying their sizes is
+        // thread safe.
+        double soundInitMs = 0.0;
+
+        std::thread soundInitThread([&]() noexcept {
+            PROFILE_ZONE("PsxSoundInit");
+
+            soundInitMs = D_TimeStartupStep([]() noexcept {
+                // PsyDoom: allocate a buffer big enough to hold the WMD file (as it is on disk) temporarily.
+                // The original PSX Doom used the 64 KiB static 'temp' buffer for this purpose; Final Doom did a temp 'Z_EndMalloc' of 122,880 bytes
+                // because it's WMD file was much bigger. This method is more flexible and will allow for practically any sized WMD.
+                const int32_t wmdFileSize = psxcd_get_file_size(CdFile::DOOMSND_WMD);
+                std::unique_ptr<std::byte[]> wmdFileBuffer(new std::byte[wmdFileSize]);
+                PsxSoundInit(doomToWessVol(gOptionsSndVol), doomToWessVol(gOptionsMusVol), wmdFileBuffer.get());
+            });
+        });
     #else
         PsxSoundInit(doomToWessVol(gOptionsSndVol), doomToWessVol(gOptionsMusVol), gTmpBuffer);
     #endif
 
     // Initializing standard DOOM subsystems, zone memory management, WAD, platform stuff, renderer etc.
-    Z_Init();
-    I_Init();
-    W_Init();
-    R_Init();
+    #if PSYDOOM_MODS
+        const double memAndTexCacheInitMs = D_TimeStartupStep([]() noexcept {
+            Z_Init();
+            I_Init();
+        });
+
+        const double wadInitMs = D_TimeStartupStep([]() noexcept {
+            PROFILE_ZONE("W_Init");
+            W_Init();
+            TexturePatcher::init();
+        });
+
+        const double rendererInitMs = D_TimeStartupStep([]() noexcept {
+            PROFILE_ZONE("R_Init");
+            R_Init();
+        });
+    #else
+        Z_Init();
+        I_Init();
+        W_Init();
+        R_Init();
+    #endif
 
     // PsyDoom: build the (now) dynamically generated lists of sprites, map objects, animated textures and switches for the game.
     // User mods can add new entries to any of these lists. Also initialize MAPINFO.
     #if PSYDOOM_MODS
-        MapInfo::init();        // Do this first since GEC MAPINFO can affect the base lists of animations and switches
-        P_InitSprites();
-        P_InitMobjInfo();
-        P_InitAnimDefs();
-        P_InitSwitchDefs();
-    #endif
+        const double gameDefsInitMs = D_TimeStartupStep([]() noexcept {
+            PROFILE_ZONE("MapInfo & defs init");
+            MapInfo::init();        // Do this first since GEC MAPINFO can affect the base lists of animations and switches
+            P_InitSprites();
+            P_InitMobjInfo();
+            P_InitAnimDefs();
+            P_InitSwitchDefs();
+        });
 
-    ST_Init();
+        const double statusBarInitMs = D_TimeStartupStep([]() noexcept {
+            ST_Init();
+        });
+
+        // PsyDoom: wait for sound to finish initializing before going any further and print the startup timing report
+        soundInitThread.join();
+        const double startupMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startupBegTime).count();
+
+        std::printf(
+            "Startup took %.1f ms: sound %.1f ms (in parallel), memory & texture cache %.1f ms, WADs %.1f ms, renderer %.1f ms, "
+            "MAPINFO & game definitions %.1f ms, status bar %.1f ms\n",
+            startupMs,
+            soundInitMs,
+            memAndTexCacheInitMs,
+            wadInitMs,
+            rendererInitMs,
+            gameDefsInitMs,
+            statusBarInitMs
+        );
+    #else
+        ST_Init();
+    #endif
 
     #if PSYDOOM_MODS
         // PsyDoom: new cleanup logic before we exit
@@ -228,7 +313,13 @@ void D_DoomMain() noexcept {
 
         // PsyDoom: play intro movies and logos unless disabled.
         // Note: also skip them if we are playing a demo file or warping directly to a map.
-        const bool bSkipIntros = (Config::gbSkipIntros || ProgArgs::gPlayDemoFilePath[0] || gbStartupWarpToMap);
+        const bool bSkipIntros = (
+            Config::gbSkipIntros ||
+            ProgArgs::gPlayDemoFilePath[0] ||
+            ProgArgs::gBatchDemoManifestFilePath[0] ||
+            ProgArgs::gSimBenchResultFilePath[0] ||
+            gbStartupWarpToMap
+        );
 
         if (!bSkipIntros) {
             D_PlayIntros();
@@ -264,6 +355,18 @@ void D_DoomMain() noexcept {
         // This way it will be waiting for the player upon opening that menu:
         PlayerPrefs::pushLastPassword();
 
+        // PsyDoom: run and check the results of a batch of demos and exit if commanded
+        if (ProgArgs::gBatchDemoManifestFilePath[0]) {
+            gbCheckDemoResultFailed = (!DemoBatchRunner::run(ProgArgs::gBatchDemoManifestFilePath, ProgArgs::gBatchDemoReportFilePath));
+            return;
+        }
+
+        // PsyDoom: run the simulation-only benchmark and exit if commanded
+        if (ProgArgs::gSimBenchResultFilePath[0]) {
+            gbCheckDemoResultFailed = (!SimBench::run());
+            return;
+        }
+
         // PsyDoom: play a single demo file and exit if commanded.
         // Also, if in headless mode then don't run the main game - only single demo playback is allowed.
         if (ProgArgs::gPlayDemoFilePath[0]) {
@@ -572,7 +675,8 @@ void I_DebugDrawString(const char* const fmtMsg, ...) noexcept {
 
 #if PSYDOOM_MODS
 //------------------------------------------------------------------------------------------------------------------------------------------
-// PsyDoom: draws frame performance counters (average frame duration and FPS) at the top left of the screen if they are enabled
+// PsyDoom: draws frame performance counters (average frame duration and FPS) at the top left of the screen if they are enabled.
+// Also shows a breakdown of recent frame times into simulation, CPU render, GPU and present time, along with a frame time graph.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void I_DrawEnabledPerfCounters() noexcept {
     // Are we showing performance counters?
@@ -607,6 +711,96 @@ void I_DrawEnabledPerfCounters() noexcept {
     // Show average FPS counter
     std::snprintf(msgBuffer, sizeof(msgBuffer), "FPS:  %.1f", gPerfAvgFps);
     I_DrawStringSmall(2 + widescreenAdjust, 10, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+
+    // Show the average split of recent frame times in milliseconds, the slowest recent frame and a graph of recent frame times
+    FrameStats::FrameTimes avgTimes;
+    FrameStats::FrameTimes maxTimes;
+    FrameStats::getAverageFrameTimes(avgTimes, maxTimes);
+
+    std::snprintf(msgBuffer, sizeof(msgBuffer), "SIM:  %.2f  REN: %.2f", avgTimes.simUsec / 1000.0f, avgTimes.renderUsec / 1000.0f);
+    I_DrawStringSmall(2 + widescreenAdjust, 18, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+
+    if (avgTimes.gpuUsec >= 0.0f) {
+        std::snprintf(msgBuffer, sizeof(msgBuffer), "GPU:  %.2f  PRS: %.2f", avgTimes.gpuUsec / 1000.0f, avgTimes.presentUsec / 1000.0f);
+    } else {
+        std::snprintf(msgBuffer, sizeof(msgBuffer), "GPU:  N/A  PRS: %.2f", avgTimes.presentUsec / 1000.0f);
+    }
+
+    I_DrawStringSmall(2 + widescreenAdjust, 26, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+
+    std::snprintf(msgBuffer, sizeof(msgBuffer), "MAX:  %.2f", maxTimes.totalUsec / 1000.0f);
+    I_DrawStringSmall(2 + widescreenAdjust, 34, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+
+    FrameStats::drawGraph(2 + widescreenAdjust, 44);
+
+    // Show main memory zone usage and fragmentation (largest free block and free block count) along with the allocation rate
+    const int32_t graphBottomY = 44 + FrameStats::GRAPH_H + 2;
+
+    std::snprintf(
+        msgBuffer,
+        sizeof(msgBuffer),
+        "ZONE: %dK/%dK  FREE: %dK",
+        gPerfZoneStats.usedBytes / 1024,
+        gPerfZoneStats.totalBytes / 1024,
+        gPerfZoneStats.freeBytes / 1024
+    );
+
+    I_DrawStringSmall(2 + widescreenAdjust, graphBottomY, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+
+    std::snprintf(
+        msgBuffer,
+        sizeof(msgBuffer),
+        "LFB:  %dK  NFB: %d",
+        gPerfZoneStats.largestFreeBlock / 1024,
+        gPerfZoneStats.numFreeBlocks
+    );
+
+    I_DrawStringSmall(2 + widescreenAdjust, graphBottomY + 8, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+
+    std::snprintf(msgBuffer, sizeof(msgBuffer), "ALC:  %.1f/T  %.1fK/T", gPerfZoneMallocsPerTick, gPerfZoneBytesPerTick / 1024.0f);
+    I_DrawStringSmall(2 + widescreenAdjust, graphBottomY + 16, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+
+    // Show texture cache and VRAM upload activity: uploads, evictions, pages used, worst search length for the level and overflows
+    std::snprintf(
+        msgBuffer,
+        sizeof(msgBuffer),
+        "TEX:  %.1f/F  %.1fK/F  EVC: %.1f/F",
+        gPerfTexUploadsPerFrame,
+        gPerfTexBytesPerFrame / 1024.0f,
+        gPerfTexEvictionsPerFrame
+    );
+
+    I_DrawStringSmall(2 + widescreenAdjust, graphBottomY + 24, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+
+    std::snprintf(
+        msgBuffer,
+        sizeof(msgBuffer),
+        "TPG:  %u/%u  SRCH: %u  OVF: %u",
+        gPerfTexPagesInUse,
+        I_GetNumTexCachePages(),
+        gTexCacheStats.maxSearchLen,
+        (uint32_t) gTexCacheStats.numOverflows
+    );
+
+    I_DrawStringSmall(2 + widescreenAdjust, graphBottomY + 32, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+
+    // If the map has scripts then show the average and worst case time spent in them per tick for the level, plus the Lua heap size
+    if (ScriptingEngine::isActive()) {
+        const ScriptingEngine::ScriptTimeStats& tickStats = ScriptingEngine::gTickTimeStats;
+        const double avgTickUsec = (tickStats.numSamples > 0) ? tickStats.totalUsec / (double) tickStats.numSamples : 0.0;
+
+        std::snprintf(
+            msgBuffer,
+            sizeof(msgBuffer),
+            "LUA:  %.2f/%.2f  GC: %.2f  %dK",
+            avgTickUsec / 1000.0,
+            tickStats.maxUsec / 1000.0,
+            ScriptingEngine::gGcTimeStats.maxUsec / 1000.0,
+            (int32_t)(ScriptingEngine::getLuaMemoryUsed() / 1024)
+        );
+
+        I_DrawStringSmall(2 + widescreenAdjust, graphBottomY + 40, msgBuffer, Game::getTexClut_STATUS(), 128, 255, 255, false, false);
+    }
 }
 #endif  // #if PSYDOOM_MODS
 
@@ -787,6 +981,10 @@ gameaction_t MiniLoop(
 
         frametimer_t::time_point profilerStartTime = frameStartTime;        // When we started profiling the current few frames
         uint32_t profilerNumFramesElapsed = 0;                              // How many frames have elapsed for the frame profiler
+        uint32_t profilerNumTicksElapsed = 0;                               // How many game ticks have elapsed for the frame profiler
+        uint64_t profilerStartNumMallocs = gpMainMemZone->numMallocs;       // Main memory zone allocation totals when we started profiling
+        uint64_t profilerStartNumBytesMalloced = gpMainMemZone->numBytesMalloced;
+        texcachestats_t profilerStartTexCacheStats = gTexCacheStats;        // Texture cache activity totals when we started profiling
         gPerfAvgFps = 0;                                                    // Don't know this yet, frame profiler will tell us later!
         gPerfAvgUsec = 0;                                                   // Don't know this yet, frame profiler will tell us later!
     #endif
@@ -993,7 +1191,15 @@ gameaction_t MiniLoop(
         // Call the ticker function to do updates for the frame.
         // Note that I am calling this in all situations, even if the framerate is capped and if we haven't passed enough time for a game tick.
         // That allows for possible update logic which runs > 30 Hz in future, like framerate uncapped turning movement.
-        exitAction = pTicker();
+        // PsyDoom: time the ticker for the frame time stats
+        #if PSYDOOM_MODS
+            {
+                FrameStats::SplitTimer splitTimer(FrameStats::Split::Sim);
+                exitAction = pTicker();
+            }
+        #else
+            exitAction = pTicker();
+        #endif
 
         if (exitAction != ga_nothing)
             break;
@@ -1016,8 +1222,16 @@ gameaction_t MiniLoop(
             }
         #endif
 
-        // Call the drawer function to do drawing for the frame
-        pDrawer();
+        // Call the drawer function to do drawing for the frame.
+        // PsyDoom: time the drawer for the frame time stats.
+        #if PSYDOOM_MODS
+            {
+                FrameStats::SplitTimer splitTimer(FrameStats::Split::Drawer);
+                pDrawer();
+            }
+        #else
+            pDrawer();
+        #endif
 
         // Do we need to update sound? (sound updates at 15 Hz)
         // PsyDoom: allow updates at any rate so sounds start as soon as possible.
@@ -1029,6 +1243,12 @@ gameaction_t MiniLoop(
             }
         #endif
 
+        // PsyDoom: record the frame if running a timedemo benchmark, and count ticks for the frame profiler
+        #if PSYDOOM_MODS
+            TimeDemo::endFrame(gGameTic - gPrevGameTic);
+            profilerNumTicksElapsed += (gGameTic > gPrevGameTic) ? (uint32_t)(gGameTic - gPrevGameTic) : 0;
+        #endif
+
         gPrevGameTic = gGameTic;
         gbIsFirstTick = false;
 
@@ -1036,6 +1256,7 @@ gameaction_t MiniLoop(
             // PsyDoom: wrap up timing this frame's duration
             const frametimer_t::time_point now = frametimer_t::now();
             gPrevFrameDuration = std::chrono::duration<double>(now - frameStartTime).count();
+            FrameStats::endFrame(std::chrono::duration<float, std::micro>(now - frameStartTime).count());
             frameStartTime = now;
 
             // PsyDoom: update frame time profiling if enough time has passed
@@ -1054,8 +1275,26 @@ gameaction_t MiniLoop(
                 gPerfAvgUsec = (float) avgUsec;
                 gPerfAvgFps = (float) avgFps;
 
+                // Compute the memory zone and texture cache metrics if they are being shown: walking the heap and cache is not free
+                if (Config::gbShowPerfCounters) {
+                    Z_GetStats(*gpMainMemZone, gPerfZoneStats);
+                    const float numTicks = (float) std::max(profilerNumTicksElapsed, 1u);
+                    gPerfZoneMallocsPerTick = (float)(gpMainMemZone->numMallocs - profilerStartNumMallocs) / numTicks;
+                    gPerfZoneBytesPerTick = (float)(gpMainMemZone->numBytesMalloced - profilerStartNumBytesMalloced) / numTicks;
+
+                    const float numFrames = (float) profilerNumFramesElapsed;
+                    gPerfTexUploadsPerFrame = (float)(gTexCacheStats.numUploads - profilerStartTexCacheStats.numUploads) / numFrames;
+                    gPerfTexBytesPerFrame = (float)(gTexCacheStats.numBytesUploaded - profilerStartTexCacheStats.numBytesUploaded) / numFrames;
+                    gPerfTexEvictionsPerFrame = (float)(gTexCacheStats.numEvictions - profilerStartTexCacheStats.numEvictions) / numFrames;
+                    gPerfTexPagesInUse = I_GetNumTexCachePagesInUse();
+                }
+
                 // Begin a new profiling iteration
                 profilerNumFramesElapsed = 0;
+                profilerNumTicksElapsed = 0;
+                profilerStartNumMallocs = gpMainMemZone->numMallocs;
+                profilerStartNumBytesMalloced = gpMainMemZone->numBytesMalloced;
+                profilerStartTexCacheStats = gTexCacheStats;
                 profilerStartTime = now;
             }
         #endif
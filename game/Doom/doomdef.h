@@ -5,6 +5,8 @@
 #include "PsyDoom/BitShift.h"
 #include "PsyDoom/InterpFixedT.h"
 
+#include <cstddef>
+
 struct mobj_t;
 struct mobjinfo_t;
 struct player_t;
@@ -214,6 +216,9 @@ static constexpr uint32_t MF_ALL_BLEND_FLAGS = (
 typedef void (*latecall_t)(mobj_t& mobj) noexcept;
 
 // Holds state for an object/thing in the game world
+// Note: the fields of this struct are ordered so that the ones touched every tick by movement, collision and thinking code are grouped
+// together at the start (within the first 128 bytes on 64-bit targets), while fields which are used only occasionally are at the end.
+// The first few fields must also match the layout of 'degenmobj_t', since that is type punned as 'mobj_t' for sound origins.
 struct mobj_t {
 #if PSYDOOM_MODS
     InterpFixedT    x;                  // Global position in the world, in 16.16 format (supporting interpolation)
@@ -230,27 +235,28 @@ struct mobj_t {
     subsector_t*    subsector;          // What subsector the map object is currently in (and by extension, what sector)
     mobj_t*         prev;               // Intrusive fields for the global linked list of things
     mobj_t*         next;
-    latecall_t      latecall;
-    mobj_t*         snext;              // Intrusive fields for the linked list of things in the current sector
-    mobj_t*         sprev;
-    angle_t         angle;              // Direction the thing is facing in
-    uint32_t        sprite;             // Current sprite displayed
-    uint32_t        frame;              // Current sprite frame displayed. Must use 'FF_FRAMEMASK' to get the actual frame number.
-    mobj_t*         bnext;              // Linked list of things in this blockmap block
-    mobj_t*         bprev;
-    fixed_t         floorz;             // Highest floor in contact with map object
-    fixed_t         ceilingz;           // Lowest ceiling in contact with map object
-    fixed_t         radius;             // For collision detection
-    fixed_t         height;             // For collision detection
     fixed_t         momx;               // Current velocity/speed: x, y & z
     fixed_t         momy;
     fixed_t         momz;
-    mobjtype_t      type;               // Type enum
-    mobjinfo_t*     info;               // Type data
-    int32_t         tics;               // Tick counter for the current state
-    state_t*        state;              // State data
     uint32_t        flags;              // See the MF_XXX series of flags for possible bits.
+    int32_t         tics;               // Tick counter for the current state
     int32_t         health;             // When this reaches '0' the object is dead
+    state_t*        state;              // State data
+    mobjinfo_t*     info;               // Type data
+    fixed_t         floorz;             // Highest floor in contact with map object
+    fixed_t         ceilingz;           // Lowest ceiling in contact with map object
+    fixed_t         radius;             // For collision detection
+    fixed_t         height;             // For collision detection
+    mobjtype_t      type;               // Type enum
+    angle_t         angle;              // Direction the thing is facing in
+    latecall_t      latecall;
+    player_t*       player;             // Associated player, if any
+    mobj_t*         snext;              // Intrusive fields for the linked list of things in the current sector
+    mobj_t*         sprev;
+    mobj_t*         bnext;              // Linked list of things in this blockmap block
+    mobj_t*         bprev;
+    uint32_t        sprite;             // Current sprite displayed
+    uint32_t        frame;              // Current sprite frame displayed. Must use 'FF_FRAMEMASK' to get the actual frame number.
     dirtype_t       movedir;            // For enemy AI, what direction the enemy is moving in
     int32_t         movecount;          // When this reaches 0 a new dir is selected
 // PsyDoom: need to use weak refs!
@@ -262,12 +268,7 @@ struct mobj_t {
 #endif
     int32_t         reactiontime;       // Time left until an attack is allowed
     int32_t         threshold;          // Time left chasing the current target
-    player_t*       player;             // Associated player, if any
     uintptr_t       extradata;          // Used for latecall functions
-    int16_t         spawnx;             // Used for respawns: original spawn position (integer) x
-    int16_t         spawny;             // Used for respawns: original spawn position (integer) y
-    uint16_t        spawntype;          // Used for respawns: item 'DoomEd' type/number
-    int16_t         spawnangle;         // Used for respawns: item angle
 // PsyDoom: need to use weak refs!
 // These objects can sometimes get destroyed without references to them being cleared.
 #if PSYDOOM_MODS
@@ -275,6 +276,16 @@ struct mobj_t {
     uint32_t        weakCountIdx;       // PsyDoom: index of the weak reference counter allocated for this map object ('0' if there are no weak references to it)
 #else
     mobj_t*         tracer;             // Used by homing missiles
+#endif
+    int16_t         spawnx;             // Used for respawns: original spawn position (integer) x
+    int16_t         spawny;             // Used for respawns: original spawn position (integer) y
+    uint16_t        spawntype;          // Used for respawns: item 'DoomEd' type/number
+    int16_t         spawnangle;         // Used for respawns: item angle
+#if PSYDOOM_MODS
+    uint32_t        listOrder;          // PsyDoom: increases for each map object added to the global list of things, so the relative order of things in the list can be compared
+    uint32_t        scriptRemovalIdx;   // PsyDoom: '1 + index' in the scripting engine's list of things pending removal, or '0' if not in the list
+    mobj_t*         tprev;              // PsyDoom: intrusive fields for the linked list of things with the same type (in the same order as the global list)
+    mobj_t*         tnext;
 #endif
 };
 
@@ -296,6 +307,22 @@ struct degenmobj_t {
     subsector_t*    subsector;
 };
 
+// PsyDoom: sanity check the layout of map objects.
+// Sound origins are type punned as 'mobj_t', so the fields shared with 'degenmobj_t' must be at the same place in both structs.
+// On 64-bit targets also make sure the fields accessed every tick stay within the first two cache lines and the struct stays at 4 lines.
+#if PSYDOOM_MODS
+    static_assert(offsetof(mobj_t, x) == offsetof(degenmobj_t, x));
+    static_assert(offsetof(mobj_t, y) == offsetof(degenmobj_t, y));
+    static_assert(offsetof(mobj_t, z) == offsetof(degenmobj_t, z));
+    static_assert(offsetof(mobj_t, tag) == offsetof(degenmobj_t, tag));
+    static_assert(offsetof(mobj_t, subsector) == offsetof(degenmobj_t, subsector));
+
+    #if UINTPTR_MAX == UINT64_MAX
+        static_assert(offsetof(mobj_t, angle) + sizeof(angle_t) <= 128);
+        static_assert(sizeof(mobj_t) == 256);
+    #endif
+#endif
+
 // Basic player status
 enum playerstate_t : int32_t {
     PST_LIVE,       // Player is playing the game
@@ -12,9 +12,12 @@
 #include "PsyDoom/ModMgr.h"
 #include "PsyDoom/PlayerPrefs.h"
 #include "PsyDoom/ProgArgs.h"
+#include "PsyDoom/SaveAndLoad.h"
+#include "PsyDoom/Profiler.h"
 #include "PsyDoom/PsxVm.h"
 #include "PsyDoom/Utils.h"
 #include "PsyDoom/Video.h"
+#include "Wess/psxcd.h"
 
 #if PSYDOOM_MODS
     // PsyDoom: a flag set to 'true' if the result of demo playback is unexpected/wrong (when checking demo results).
@@ -96,7 +99,19 @@ int psx_main(const int argc, const char* const* const argv) noexcept {
 
     // PsyDoom: cleanup logic after Doom itself is done and save player prefs (unless headless mode)
     #if PSYDOOM_MODS
-        const bool bIsCheckingADemoResult = (ProgArgs::gCheckDemoResultFilePath[0] != 0);
+        #if PSYDOOM_PROFILER
+            if (ProgArgs::gProfileTraceFilePath[0]) {
+                if (!Profiler::saveChromeTrace(ProgArgs::gProfileTraceFilePath)) {
+                    std::printf("Failed to save the profiler trace to '%s'!\n", ProgArgs::gProfileTraceFilePath);
+                }
+            }
+        #endif
+
+        const bool bIsCheckingADemoResult = (
+            (ProgArgs::gCheckDemoResultFilePath[0] != 0) ||
+            (ProgArgs::gBatchDemoManifestFilePath[0] != 0) ||
+            (ProgArgs::gSimBenchResultFilePath[0] != 0)
+        );
 
         if (!ProgArgs::gbHeadlessMode) {
             PlayerPrefs::save();
@@ -104,8 +119,10 @@ int psx_main(const int argc, const char* const* const argv) noexcept {
 
         IntroLogos::shutdown();
         Video::shutdownVideo();
+        psxcd_exit();
         PsxVm::shutdown();
         Cheats::shutdown();
+        SaveAndLoad::endSaveToFile();
         ModMgr::shutdown();
         Input::shutdown();
         Config::shutdown();
@@ -32,6 +32,10 @@ static constexpr bool IS_64_BIT_BUILD = (sizeof(void*) > 4);
 //------------------------------------------------------------------------------------------------------------------------------------------
 #if PSYDOOM_LIMIT_REMOVING
     static constexpr uint32_t Z_HEAP_DEFAULT_SIZE = 64 * 1024 * 1024;
+
+    // Limit removing: if the heap runs out of space then it is expanded with extra regions of (at least) this size.
+    // Extra regions are given back once they become empty, after level data is freed.
+    static constexpr uint32_t Z_HEAP_GROW_SIZE = 16 * 1024 * 1024;
 #else
     static constexpr uint32_t Z_HEAP_SIZE = 1800 * 1024 * (IS_64_BIT_BUILD ? 2 : 1);
 #endif
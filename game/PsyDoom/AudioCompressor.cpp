@@ -5,8 +5,20 @@
 #include <algorithm>
 #include <cmath>
 
+// Use SIMD instructions (SSE2 or NEON) for the decibel conversions done when compressing blocks of samples, if supported by the target
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define AUDIO_COMP_SIMD_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define AUDIO_COMP_SIMD_NEON 1
+    #include <arm_neon.h>
+#endif
+
 BEGIN_NAMESPACE(AudioCompressor)
 
+// How many samples are processed at a time by 'compressBlock': determines the size of the scratch buffers on the stack
+static constexpr uint32_t MAX_BLOCK_SIZE = 256;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes the audio compressor state with the specified settings.
 //
@@ -53,14 +65,10 @@ void init(
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Perform dynamic range compression on a single audio sample.
-// 
-// References for this implementation:
-//      https://openaudio.blogspot.com/2017/01/basic-dynamic-range-compressor.html
-//      https://github.com/chipaudette/OpenAudio_ArduinoLibrary/blob/master/AudioEffectCompressor_F32.h
-//      https://github.com/chipaudette/OpenAudio_ArduinoLibrary/blob/81492cc5aca290d95cd6b681729302148cb7e109/AudioEffectCompressor_F32.h
+// Compression step: scrub the given sample of NaN values and update the low pass filtered signal power with it.
+// Returns the new smoothed signal power.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void compress(State& state, float& sampleL, float& sampleR) noexcept {
+static float updateSignalPower(State& state, float& sampleL, float& sampleR) noexcept {
     // Safety check: recover from input NaN values
     sampleL = (!std::isnan(sampleL)) ? sampleL : 0.0f;
     sampleR = (!std::isnan(sampleR)) ? sampleR : 0.0f;
@@ -76,14 +84,14 @@ void compress(State& state, float& sampleL, float& sampleR) noexcept {
     ASSERT((!std::isnan(smoothedSignalPower)) && (!std::isinf(smoothedSignalPower)));
 
     state.lpfPrevSignalPower = smoothedSignalPower;
+    return smoothedSignalPower;
+}
 
-    // Compute the signal power in decibels.
-    // Note: normally the formula to convert is 'dB = 20 * log10(amplitude)' but we've already squared the signal so instead the multiply is by '10' instead.
-    const float signalPowerDB = std::clamp(10.0f * std::log10(smoothedSignalPower), -100.0f, +100.0f);
-    ASSERT((!std::isnan(signalPowerDB)) && (!std::isinf(signalPowerDB)));
-
-    // Compute the instantaneous/non-smoothed gain in decibels.
-    // Don't allow a positive gain, only negative!
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Compression step: compute the instantaneous/non-smoothed gain in decibels for a signal with the given power in decibels.
+// Doesn't allow a positive gain, only negative!
+//------------------------------------------------------------------------------------------------------------------------------------------
+static float getInstantGainDB(const State& state, const float signalPowerDB) noexcept {
     const float aboveThresholdDB = signalPowerDB - state.thresholdDB;
     const float goalAboveThresholdDB = aboveThresholdDB * state.compressionRatio;
     const float kneeWidthDB = state.kneeWidthDB;
@@ -91,20 +99,243 @@ void compress(State& state, float& sampleL, float& sampleR) noexcept {
     ASSERT((!std::isnan(compressionStrength)) && (!std::isinf(compressionStrength)));
 
     const float smoothedGoalAboveThresholdDB = goalAboveThresholdDB * compressionStrength + (1.0f - compressionStrength) * aboveThresholdDB;
-    const float instantGainDB = std::clamp(smoothedGoalAboveThresholdDB - aboveThresholdDB, -100.0f, 0.0f);
+    return std::clamp(smoothedGoalAboveThresholdDB - aboveThresholdDB, -100.0f, 0.0f);
+}
 
-    // Compute the smoothed gain in decibels and save as the new smoothed sample
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Compression step: smooth the given instantaneous gain using the attack and release envelopes and return the final gain in decibels.
+// The final gain includes the post gain.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static float updateGain(State& state, const float instantGainDB) noexcept {
     const float prevGainDB = state.prevSampleGainDB;
     const float gainLerp = (instantGainDB < prevGainDB) ? state.attackLerpFactor : state.releaseLerpFactor;
     const float smoothedGainDB = instantGainDB * gainLerp + prevGainDB * (1.0f - gainLerp);
     state.prevSampleGainDB = smoothedGainDB;
+    return smoothedGainDB + state.postGainDB;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Perform dynamic range compression on a single audio sample.
+// 
+// References for this implementation:
+//      https://openaudio.blogspot.com/2017/01/basic-dynamic-range-compressor.html
+//      https://github.com/chipaudette/OpenAudio_ArduinoLibrary/blob/master/AudioEffectCompressor_F32.h
+//      https://github.com/chipaudette/OpenAudio_ArduinoLibrary/blob/81492cc5aca290d95cd6b681729302148cb7e109/AudioEffectCompressor_F32.h
+//------------------------------------------------------------------------------------------------------------------------------------------
+void compress(State& state, float& sampleL, float& sampleR) noexcept {
+    // Update the smoothed signal power and compute the signal power in decibels.
+    // Note: normally the formula to convert is 'dB = 20 * log10(amplitude)' but we've already squared the signal so instead the multiply is by '10' instead.
+    const float smoothedSignalPower = updateSignalPower(state, sampleL, sampleR);
+    const float signalPowerDB = std::clamp(10.0f * std::log10(smoothedSignalPower), -100.0f, +100.0f);
+    ASSERT((!std::isnan(signalPowerDB)) && (!std::isinf(signalPowerDB)));
 
-    // Convert the gain to linear gain and apply it to the sample.
-    // Also apply the post gain at this point...
-    const float finalGainDB = smoothedGainDB + state.postGainDB;
+    // Compute the instantaneous gain and then the smoothed gain in decibels
+    const float finalGainDB = updateGain(state, getInstantGainDB(state, signalPowerDB));
+
+    // Convert the gain to linear gain and apply it to the sample
     const float linearGain = std::pow(10.0f, finalGainDB * (1.0f / 20.0f));
     sampleL *= linearGain;
     sampleR *= linearGain;
 }
 
+#if AUDIO_COMP_SIMD_SSE2 || AUDIO_COMP_SIMD_NEON
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD helpers: a small set of 4 float vector operations which are implemented for either SSE2 or NEON.
+// The 'log2' and 'exp2' approximations are accurate to within a tiny fraction of a decibel when used for decibel conversions.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#if AUDIO_COMP_SIMD_SSE2
+    typedef __m128 Float4;
+
+    static inline Float4 f4Load(const float* const p) noexcept { return _mm_loadu_ps(p); }
+    static inline void f4Store(float* const p, const Float4 v) noexcept { _mm_storeu_ps(p, v); }
+    static inline Float4 f4Set1(const float f) noexcept { return _mm_set1_ps(f); }
+    static inline Float4 f4Add(const Float4 a, const Float4 b) noexcept { return _mm_add_ps(a, b); }
+    static inline Float4 f4Sub(const Float4 a, const Float4 b) noexcept { return _mm_sub_ps(a, b); }
+    static inline Float4 f4Mul(const Float4 a, const Float4 b) noexcept { return _mm_mul_ps(a, b); }
+    static inline Float4 f4Div(const Float4 a, const Float4 b) noexcept { return _mm_div_ps(a, b); }
+    static inline Float4 f4Min(const Float4 a, const Float4 b) noexcept { return _mm_min_ps(a, b); }
+    static inline Float4 f4Max(const Float4 a, const Float4 b) noexcept { return _mm_max_ps(a, b); }
+
+    // Computes 'log2(x)' for positive and normal (non denormal) 'x'
+    static inline Float4 f4Log2(const Float4 x) noexcept {
+        // Split into the exponent and mantissa, with the mantissa in the range [sqrt(0.5), sqrt(2)) so the series below converges quickly
+        const __m128i bits = _mm_castps_si128(x);
+        const __m128i exponent = _mm_sub_epi32(_mm_srli_epi32(bits, 23), _mm_set1_epi32(127));
+        const Float4 mantissa = _mm_castsi128_ps(_mm_or_si128(_mm_and_si128(bits, _mm_set1_epi32(0x007FFFFF)), _mm_set1_epi32(0x3F800000)));
+        const Float4 bigMantissaMask = _mm_cmpgt_ps(mantissa, _mm_set1_ps(1.41421356f));
+        const Float4 m = _mm_or_ps(_mm_and_ps(bigMantissaMask, _mm_mul_ps(mantissa, _mm_set1_ps(0.5f))), _mm_andnot_ps(bigMantissaMask, mantissa));
+        const Float4 e = _mm_add_ps(_mm_cvtepi32_ps(exponent), _mm_and_ps(bigMantissaMask, _mm_set1_ps(1.0f)));
+
+        // log2(m) = 2/ln(2) * atanh(t) where 't = (m - 1) / (m + 1)'
+        const Float4 t = _mm_div_ps(_mm_sub_ps(m, _mm_set1_ps(1.0f)), _mm_add_ps(m, _mm_set1_ps(1.0f)));
+        const Float4 t2 = _mm_mul_ps(t, t);
+        Float4 series = _mm_set1_ps(2.8853900818f / 7.0f);
+        series = _mm_add_ps(_mm_mul_ps(series, t2), _mm_set1_ps(2.8853900818f / 5.0f));
+        series = _mm_add_ps(_mm_mul_ps(series, t2), _mm_set1_ps(2.8853900818f / 3.0f));
+        series = _mm_add_ps(_mm_mul_ps(series, t2), _mm_set1_ps(2.8853900818f));
+        return _mm_add_ps(e, _mm_mul_ps(series, t));
+    }
+
+    // Computes '2^x' for 'x' in the range [-120, 120]
+    static inline Float4 f4Exp2(const Float4 x) noexcept {
+        // Split into an integer part (rounded to nearest) and a fractional part in the range [-0.5, 0.5]
+        const __m128i n = _mm_sub_epi32(_mm_cvttps_epi32(_mm_add_ps(x, _mm_set1_ps(128.5f))), _mm_set1_epi32(128));
+        const Float4 y = _mm_mul_ps(_mm_sub_ps(x, _mm_cvtepi32_ps(n)), _mm_set1_ps(0.69314718056f));
+
+        // 2^f = e^(f * ln(2)): use the Taylor series for 'e^y', then scale by '2^n' by adding 'n' to the exponent
+        Float4 series = _mm_set1_ps(1.0f / 720.0f);
+        series = _mm_add_ps(_mm_mul_ps(series, y), _mm_set1_ps(1.0f / 120.0f));
+        series = _mm_add_ps(_mm_mul_ps(series, y), _mm_set1_ps(1.0f / 24.0f));
+        series = _mm_add_ps(_mm_mul_ps(series, y), _mm_set1_ps(1.0f / 6.0f));
+        series = _mm_add_ps(_mm_mul_ps(series, y), _mm_set1_ps(1.0f / 2.0f));
+        series = _mm_add_ps(_mm_mul_ps(series, y), _mm_set1_ps(1.0f));
+        series = _mm_add_ps(_mm_mul_ps(series, y), _mm_set1_ps(1.0f));
+        return _mm_castsi128_ps(_mm_add_epi32(_mm_castps_si128(series), _mm_slli_epi32(n, 23)));
+    }
+#elif AUDIO_COMP_SIMD_NEON
+    typedef float32x4_t Float4;
+
+    static inline Float4 f4Load(const float* const p) noexcept { return vld1q_f32(p); }
+    static inline void f4Store(float* const p, const Float4 v) noexcept { vst1q_f32(p, v); }
+    static inline Float4 f4Set1(const float f) noexcept { return vdupq_n_f32(f); }
+    static inline Float4 f4Add(const Float4 a, const Float4 b) noexcept { return vaddq_f32(a, b); }
+    static inline Float4 f4Sub(const Float4 a, const Float4 b) noexcept { return vsubq_f32(a, b); }
+    static inline Float4 f4Mul(const Float4 a, const Float4 b) noexcept { return vmulq_f32(a, b); }
+    static inline Float4 f4Min(const Float4 a, const Float4 b) noexcept { return vminq_f32(a, b); }
+    static inline Float4 f4Max(const Float4 a, const Float4 b) noexcept { return vmaxq_f32(a, b); }
+
+    static inline Float4 f4Div(const Float4 a, const Float4 b) noexcept {
+        // Note: ARMv7 NEON has no divide instruction, so refine the reciprocal estimate twice with Newton-Raphson iterations
+        Float4 recip = vrecpeq_f32(b);
+        recip = vmulq_f32(vrecpsq_f32(b, recip), recip);
+        recip = vmulq_f32(vrecpsq_f32(b, recip), recip);
+        return vmulq_f32(a, recip);
+    }
+
+    // Computes 'log2(x)' for positive and normal (non denormal) 'x'
+    static inline Float4 f4Log2(const Float4 x) noexcept {
+        // Split into the exponent and mantissa, with the mantissa in the range [sqrt(0.5), sqrt(2)) so the series below converges quickly
+        const uint32x4_t bits = vreinterpretq_u32_f32(x);
+        const int32x4_t exponent = vsubq_s32(vreinterpretq_s32_u32(vshrq_n_u32(bits, 23)), vdupq_n_s32(127));
+        const Float4 mantissa = vreinterpretq_f32_u32(vorrq_u32(vandq_u32(bits, vdupq_n_u32(0x007FFFFF)), vdupq_n_u32(0x3F800000)));
+        const uint32x4_t bigMantissaMask = vcgtq_f32(mantissa, vdupq_n_f32(1.41421356f));
+        const Float4 m = vbslq_f32(bigMantissaMask, vmulq_f32(mantissa, vdupq_n_f32(0.5f)), mantissa);
+        const Float4 e = vaddq_f32(vcvtq_f32_s32(exponent), vbslq_f32(bigMantissaMask, vdupq_n_f32(1.0f), vdupq_n_f32(0.0f)));
+
+        // log2(m) = 2/ln(2) * atanh(t) where 't = (m - 1) / (m + 1)'
+        const Float4 t = f4Div(vsubq_f32(m, vdupq_n_f32(1.0f)), vaddq_f32(m, vdupq_n_f32(1.0f)));
+        const Float4 t2 = vmulq_f32(t, t);
+        Float4 series = vdupq_n_f32(2.8853900818f / 7.0f);
+        series = vaddq_f32(vmulq_f32(series, t2), vdupq_n_f32(2.8853900818f / 5.0f));
+        series = vaddq_f32(vmulq_f32(series, t2), vdupq_n_f32(2.8853900818f / 3.0f));
+        series = vaddq_f32(vmulq_f32(series, t2), vdupq_n_f32(2.8853900818f));
+        return vaddq_f32(e, vmulq_f32(series, t));
+    }
+
+    // Computes '2^x' for 'x' in the range [-120, 120]
+    static inline Float4 f4Exp2(const Float4 x) noexcept {
+        // Split into an integer part (rounded to nearest) and a fractional part in the range [-0.5, 0.5]
+        const int32x4_t n = vsubq_s32(vcvtq_s32_f32(vaddq_f32(x, vdupq_n_f32(128.5f))), vdupq_n_s32(128));
+        const Float4 y = vmulq_f32(vsubq_f32(x, vcvtq_f32_s32(n)), vdupq_n_f32(0.69314718056f));
+
+        // 2^f = e^(f * ln(2)): use the Taylor series for 'e^y', then scale by '2^n' by adding 'n' to the exponent
+        Float4 series = vdupq_n_f32(1.0f / 720.0f);
+        series = vaddq_f32(vmulq_f32(series, y), vdupq_n_f32(1.0f / 120.0f));
+        series = vaddq_f32(vmulq_f32(series, y), vdupq_n_f32(1.0f / 24.0f));
+        series = vaddq_f32(vmulq_f32(series, y), vdupq_n_f32(1.0f / 6.0f));
+        series = vaddq_f32(vmulq_f32(series, y), vdupq_n_f32(1.0f / 2.0f));
+        series = vaddq_f32(vmulq_f32(series, y), vdupq_n_f32(1.0f));
+        series = vaddq_f32(vmulq_f32(series, y), vdupq_n_f32(1.0f));
+        return vreinterpretq_f32_s32(vaddq_s32(vreinterpretq_s32_f32(series), vshlq_n_s32(n, 23)));
+    }
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD version of converting smoothed signal powers to instantaneous gains in decibels, 4 samples at a time.
+// The number of values must be a multiple of 4. Follows 'getInstantGainDB' exactly, other than the approximated 'log10'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void getInstantGainsDBSimd(const State& state, const float* const pSignalPowers, float* const pGainsDB, const uint32_t numValues) noexcept {
+    ASSERT(numValues % 4 == 0);
+
+    const Float4 threshold = f4Set1(state.thresholdDB);
+    const Float4 compressionRatio = f4Set1(state.compressionRatio);
+    const Float4 kneeWidth = f4Set1(state.kneeWidthDB);
+    const bool bHaveKnee = (state.kneeWidthDB > 0);
+
+    for (uint32_t i = 0; i < numValues; i += 4) {
+        // Note: 10 * log10(x) = (10 * log10(2)) * log2(x)
+        const Float4 signalPowerDB = f4Min(f4Max(f4Mul(f4Log2(f4Load(pSignalPowers + i)), f4Set1(3.0102999566f)), f4Set1(-100.0f)), f4Set1(+100.0f));
+        const Float4 aboveThresholdDB = f4Sub(signalPowerDB, threshold);
+        const Float4 goalAboveThresholdDB = f4Mul(aboveThresholdDB, compressionRatio);
+        const Float4 compressionStrength = (bHaveKnee) ?
+            f4Min(f4Max(f4Div(aboveThresholdDB, kneeWidth), f4Set1(0.0f)), f4Set1(1.0f)) :
+            f4Set1(1.0f);
+
+        const Float4 smoothedGoalAboveThresholdDB = f4Add(
+            f4Mul(goalAboveThresholdDB, compressionStrength),
+            f4Mul(f4Sub(f4Set1(1.0f), compressionStrength), aboveThresholdDB)
+        );
+
+        const Float4 instantGainDB = f4Min(f4Max(f4Sub(smoothedGoalAboveThresholdDB, aboveThresholdDB), f4Set1(-100.0f)), f4Set1(0.0f));
+        f4Store(pGainsDB + i, instantGainDB);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD version of converting gains in decibels to linear gains in-place, 4 at a time. The number of values must be a multiple of 4.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void dbToLinearGainsSimd(float* const pGains, const uint32_t numValues) noexcept {
+    ASSERT(numValues % 4 == 0);
+
+    for (uint32_t i = 0; i < numValues; i += 4) {
+        // Note: 10^(x / 20) = 2^(x * log2(10) / 20)
+        const Float4 exponent = f4Min(f4Max(f4Mul(f4Load(pGains + i), f4Set1(3.3219280949f / 20.0f)), f4Set1(-120.0f)), f4Set1(+120.0f));
+        f4Store(pGains + i, f4Exp2(exponent));
+    }
+}
+#endif  // #if AUDIO_COMP_SIMD_SSE2 || AUDIO_COMP_SIMD_NEON
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Perform dynamic range compression on a block of interleaved stereo samples (left then right) in-place.
+// Same as calling 'compress' for each sample, except that the decibel conversions are vectorized where SIMD is supported.
+// The envelope following (signal power smoothing and attack/release of the gain) is inherently serial and is still done per sample.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void compressBlock(State& state, float* const pSamples, const uint32_t numSamples) noexcept {
+    ASSERT(pSamples || (numSamples == 0));
+
+    #if AUDIO_COMP_SIMD_SSE2 || AUDIO_COMP_SIMD_NEON
+        // Scratch buffers for each step: padded with a valid (non zero) extra signal power for the SIMD steps, if the block size is not a multiple of 4
+        alignas(16) float signalPowers[MAX_BLOCK_SIZE];
+        alignas(16) float gains[MAX_BLOCK_SIZE];
+
+        for (uint32_t blockStartIdx = 0; blockStartIdx < numSamples; blockStartIdx += MAX_BLOCK_SIZE) {
+            const uint32_t blockSize = std::min(numSamples - blockStartIdx, MAX_BLOCK_SIZE);
+            const uint32_t paddedBlockSize = (blockSize + 3) & ~3u;
+            float* const pBlockSamples = pSamples + (size_t) blockStartIdx * 2;
+
+            for (uint32_t i = 0; i < blockSize; ++i) {
+                signalPowers[i] = updateSignalPower(state, pBlockSamples[i * 2], pBlockSamples[i * 2 + 1]);
+            }
+
+            std::fill(signalPowers + blockSize, signalPowers + paddedBlockSize, 1.0f);
+            getInstantGainsDBSimd(state, signalPowers, gains, paddedBlockSize);
+
+            for (uint32_t i = 0; i < blockSize; ++i) {
+                gains[i] = updateGain(state, gains[i]);
+            }
+
+            dbToLinearGainsSimd(gains, paddedBlockSize);
+
+            for (uint32_t i = 0; i < blockSize; ++i) {
+                pBlockSamples[i * 2] *= gains[i];
+                pBlockSamples[i * 2 + 1] *= gains[i];
+            }
+        }
+    #else
+        for (uint32_t i = 0; i < numSamples; ++i) {
+            compress(state, pSamples[i * 2], pSamples[i * 2 + 1]);
+        }
+    #endif
+}
+
 END_NAMESPACE(AudioCompressor)
@@ -2,6 +2,8 @@
 
 #include "Macros.h"
 
+#include <cstdint>
+
 BEGIN_NAMESPACE(AudioCompressor)
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -31,5 +33,6 @@ void init(
 ) noexcept;
 
 void compress(State& state, float& sampleL, float& sampleR) noexcept;
+void compressBlock(State& state, float* const pSamples, const uint32_t numSamples) noexcept;
 
 END_NAMESPACE(AudioCompressor)
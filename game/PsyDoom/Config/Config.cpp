@@ -52,6 +52,10 @@ bool            gbFixGravityStrength;
 int32_t         gLostSoulSpawnLimit;
 bool            gbUseLostSoulSpawnFix;
 bool            gbUseLineOfSightOverflowFix;
+bool            gbUseSightPvs;
+bool            gbUseParallelSightChecks;
+int32_t         gMaxJobThreads;
+bool            gbUseLumpCache;
 bool            gbFixOutdoorBulletPuffs;
 bool            gbFixBlockingGibsBug;
 bool            gbFixSoundPropagation;
@@ -76,19 +80,26 @@ float           gLogicalDisplayW;
 bool            gbDisableVulkanRenderer;
 int32_t         gVulkanRenderHeight;
 bool            gbVulkanPixelStretch;
+int32_t         gVulkanDynamicResolutionFps;
 bool            gbVulkanTripleBuffer;
+bool            gbVulkanLowLatencyMode;
 bool            gbVulkanDrawExtendedStatusBar;
 bool            gbVulkanWidescreenEnabled;
 int32_t         gAAMultisamples;
+float           gAASampleShading;
 int32_t         gTopOverscanPixels;
 int32_t         gBottomOverscanPixels;
 bool            gbEnhanceWallDrawPrecision;
 bool            gbFloorRenderGapFix;
 bool            gbSkyLeakFix;
+int32_t         gClassicUpscaleFactor;
 bool            gbVulkanBrightenAutomap;
+bool            gbVulkanCoarseOcclusion;
 bool            gbUseVulkan32BitShading;
 bool            gbUseExtendedAutomapColors;
 int32_t         gVramSizeInMegabytes;
+bool            gbTexCacheLruEviction;
+int32_t         gDecodedTexPoolSizeInMegabytes;
 std::string     gVulkanPreferredDevicesRegex;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -96,6 +107,8 @@ std::string     gVulkanPreferredDevicesRegex;
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t     gAudioBufferSize;
 int32_t     gSpuRamSize;
+int32_t     gMaxCachedCdTrackSize;
+bool        gbSampleAccurateMusicTiming;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Input config settings
@@ -114,6 +127,7 @@ float       gAnalogToDigitalThreshold;
 bool gbEnableDevCheatShortcuts;
 bool gbEnableDevInPlaceReloadFunctionKey;
 bool gbEnableDevMapAutoReload;
+bool gbEnableDevTexAutoReload;
 
 CheatKeySequence gCheatKeys_GodMode;
 CheatKeySequence gCheatKeys_NoClip;
@@ -259,6 +273,12 @@ void init() noexcept {
     // Also, if any files need saving after default initializing new fields then do that now.
     ConfigSerialization::readAllConfigFiles();
     ConfigSerialization::writeAllConfigFiles(false);
+
+    // Timedemo benchmarks should not be limited by the display refresh rate: force vsync off for them.
+    // Note: this is done after writing config so that the change is not saved.
+    if (ProgArgs::gTimeDemoResultFilePath[0]) {
+        gbEnableVSync = false;
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
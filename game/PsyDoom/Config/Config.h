@@ -39,6 +39,10 @@ extern bool             gbFixGravityStrength;
 extern int32_t          gLostSoulSpawnLimit;
 extern bool             gbUseLostSoulSpawnFix;
 extern bool             gbUseLineOfSightOverflowFix;
+extern bool             gbUseSightPvs;
+extern bool             gbUseParallelSightChecks;
+extern int32_t          gMaxJobThreads;
+extern bool             gbUseLumpCache;
 extern bool             gbFixOutdoorBulletPuffs;
 extern bool             gbFixBlockingGibsBug;
 extern bool             gbFixSoundPropagation;
@@ -63,19 +67,26 @@ extern float            gLogicalDisplayW;
 extern bool             gbDisableVulkanRenderer;
 extern int32_t          gVulkanRenderHeight;
 extern bool             gbVulkanPixelStretch;
+extern int32_t          gVulkanDynamicResolutionFps;
 extern bool             gbVulkanTripleBuffer;
+extern bool             gbVulkanLowLatencyMode;
 extern bool             gbVulkanDrawExtendedStatusBar;
 extern bool             gbVulkanWidescreenEnabled;
 extern int32_t          gAAMultisamples;
+extern float            gAASampleShading;
 extern int32_t          gTopOverscanPixels;
 extern int32_t          gBottomOverscanPixels;
 extern bool             gbEnhanceWallDrawPrecision;
 extern bool             gbFloorRenderGapFix;
 extern bool             gbSkyLeakFix;
+extern int32_t          gClassicUpscaleFactor;
 extern bool             gbVulkanBrightenAutomap;
+extern bool             gbVulkanCoarseOcclusion;
 extern bool             gbUseVulkan32BitShading;
 extern bool             gbUseExtendedAutomapColors;
 extern int32_t          gVramSizeInMegabytes;
+extern bool             gbTexCacheLruEviction;
+extern int32_t          gDecodedTexPoolSizeInMegabytes;
 extern std::string      gVulkanPreferredDevicesRegex;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -83,6 +94,8 @@ extern std::string      gVulkanPreferredDevicesRegex;
 //------------------------------------------------------------------------------------------------------------------------------------------
 extern int32_t      gAudioBufferSize;
 extern int32_t      gSpuRamSize;
+extern int32_t      gMaxCachedCdTrackSize;
+extern bool         gbSampleAccurateMusicTiming;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Input settings
@@ -120,6 +133,7 @@ struct CheatKeySequence {
 extern bool                 gbEnableDevCheatShortcuts;              // If 'true' then enable the convenience developer single cheat keys on the pause menu (keys F1-F8)
 extern bool                 gbEnableDevInPlaceReloadFunctionKey;    // If 'true' then enable the development 'in-place map reload' function. This is activated with key F11.
 extern bool                 gbEnableDevMapAutoReload;               // If 'true' then allow the game to automatically reload a map if it has changed on-disk
+extern bool                 gbEnableDevTexAutoReload;               // If 'true' then allow the game to automatically reload textures and sprites in user WADs if they have changed on-disk
 extern CheatKeySequence     gCheatKeys_GodMode;
 extern CheatKeySequence     gCheatKeys_NoClip;
 extern CheatKeySequence     gCheatKeys_LevelWarp;
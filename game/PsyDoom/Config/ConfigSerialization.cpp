@@ -13,6 +13,7 @@
 #include "IniUtils.h"
 #include "PsyDoom/Utils.h"
 
+#include <algorithm>
 #include <cstring>
 #include <vector>
 
@@ -310,6 +311,19 @@ bool readConfigFile(
     std::vector<bool> readConfigField;
     readConfigField.resize(cfgFields.numFields);
 
+    // Make a list of the config field indexes sorted by name, so the field for each ini entry can be found with a binary search.
+    // A stable sort is used so that the first of any fields with the same name is always the one found.
+    std::vector<size_t> fieldIdxsByName;
+    fieldIdxsByName.resize(cfgFields.numFields);
+
+    for (size_t i = 0; i < cfgFields.numFields; ++i) {
+        fieldIdxsByName[i] = i;
+    }
+
+    std::stable_sort(fieldIdxsByName.begin(), fieldIdxsByName.end(), [&](const size_t i1, const size_t i2) noexcept {
+        return (std::strcmp(cfgFields.pFieldList[i1].name, cfgFields.pFieldList[i2].name) < 0);
+    });
+
     // Read and parse the ini file (if it exists)
     const CfgFileInfo cfgFileInfo = getCfgFileInfo(configFolder, fileName);
     const FileData cfgFileData = (cfgFileInfo.bFileExists) ? FileUtils::getContentsOfFile(cfgFileInfo.path.c_str(), 8, std::byte(0)) : FileData();
@@ -319,23 +333,28 @@ bool readConfigFile(
             (const char*) cfgFileData.bytes.get(),
             cfgFileData.size,
             [&](const IniUtils::IniEntry& iniEntry) noexcept {
-                // Try to find a matching config field.
-                // This is not an especially smart or fast way of doing it, but performance isn't an issue here:
-                for (size_t i = 0; i < cfgFields.numFields; ++i) {
-                    const ConfigField& field = cfgFields.pFieldList[i];
-                    ASSERT(field.setFunc);
-
-                    if (iniEntry.key != field.name)
-                        continue;
-
-                    try {
-                        field.setFunc(iniEntry.value);
-                        readConfigField[i] = true;
-                    } catch (...) {
-                        // Ignore, will default the field later...
+                // Try to find a matching config field
+                const auto fieldIdxIter = std::lower_bound(
+                    fieldIdxsByName.begin(),
+                    fieldIdxsByName.end(),
+                    iniEntry.key,
+                    [&](const size_t fieldIdx, const std::string& key) noexcept {
+                        return (key.compare(cfgFields.pFieldList[fieldIdx].name) > 0);
                     }
-                    
-                    break;
+                );
+
+                if ((fieldIdxIter == fieldIdxsByName.end()) || (iniEntry.key != cfgFields.pFieldList[*fieldIdxIter].name))
+                    return;
+
+                const size_t i = *fieldIdxIter;
+                const ConfigField& field = cfgFields.pFieldList[i];
+                ASSERT(field.setFunc);
+
+                try {
+                    field.setFunc(iniEntry.value);
+                    readConfigField[i] = true;
+                } catch (...) {
+                    // Ignore, will default the field later...
                 }
             }
         );
@@ -27,6 +27,8 @@ void initCfgSerialization_Audio() noexcept {
         "\n"
         "Setting the buffer size too low however may cause audio instability or stutter on some systems.\n"
         "If set to '0' (auto) then PsyDoom will use a default value, which is '256' samples currently.\n"
+        "If set to '-1' (adaptive) then PsyDoom will start with a very small buffer of '64' samples and double\n"
+        "the buffer size (up to '2048' samples) whenever sound output is detected to be falling behind.\n"
         "Mostly this setting can be left alone but if you are experiencing sound issues, try adjusting.\n"
         "\n"
         "Some example values and their corresponding added sound latency (MS):\n"
@@ -51,6 +53,32 @@ void initCfgSerialization_Audio() noexcept {
         gSpuRamSize,
         -1
     );
+
+    cfg.maxCachedCdTrackSize = makeConfigField(
+        "MaxCachedCdTrackSize",
+        "The maximum size of a looping CD audio music track that will be held in memory, in bytes.\n"
+        "While a looping track plays, PsyDoom reads the whole track into memory in the background. Each\n"
+        "time it loops, it is then played from memory instead of being read from the disc again.\n"
+        "This avoids disc seeks every time the music loops, which can help on slow drives.\n"
+        "\n"
+        "If < 0 then PsyDoom will auto-configure the limit to 64 MiB, which is enough for most tracks.\n"
+        "If set to '0' then CD audio tracks are never held in memory.",
+        gMaxCachedCdTrackSize,
+        -1
+    );
+
+    cfg.sampleAccurateMusicTiming = makeConfigField(
+        "SampleAccurateMusicTiming",
+        "If enabled then the music and sound sequencer is timed by the number of audio samples that have\n"
+        "been output, and each sequencer event is applied at the exact audio sample it was due at. This\n"
+        "gives the tightest possible music timing regardless of the game's framerate.\n"
+        "\n"
+        "To do this, sequencer events are delayed by a fixed amount (the audio buffer size plus 1/30th of\n"
+        "a second) so they can be scheduled ahead of the audio being generated. This adds approximately\n"
+        "40 MS of latency to music and sound effects, so this setting is disabled by default.",
+        gbSampleAccurateMusicTiming,
+        false
+    );
 }
 
 END_NAMESPACE(ConfigSerialization)
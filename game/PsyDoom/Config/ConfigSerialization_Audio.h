@@ -12,6 +12,8 @@ BEGIN_NAMESPACE(ConfigSerialization)
 struct Config_Audio {
     ConfigField     audioBufferSize;
     ConfigField     spuRamSize;
+    ConfigField     maxCachedCdTrackSize;
+    ConfigField     sampleAccurateMusicTiming;
 
     inline ConfigFieldList getFieldList() noexcept {
         static_assert(sizeof(*this) % sizeof(ConfigField) == 0);
@@ -94,12 +94,25 @@ void initCfgSerialization_Cheats() noexcept {
         "Enable to activate a developer feature where the game will automatically do an 'in-place' reload\n"
         "of the current map if it has changed on-disk. Useful for instantly viewing map edits in-engine.\n"
         "\n"
-        "This feature only works for files overridden via the file overrides mechanism, only in single\n"
-        "player mode and only on Windows.",
+        "This feature only works for files overridden via the file overrides mechanism and only in single\n"
+        "player mode.",
         gbEnableDevMapAutoReload,
         false
     );
 
+    cfg.enableDevTexAutoReload = makeConfigField(
+        "EnableDevTexAutoReload",
+        "Enable to activate a developer feature where the game will automatically reload wall textures,\n"
+        "flats and sprites if they have changed on-disk, without restarting the level. Useful for instantly\n"
+        "viewing texture and sprite edits in-engine.\n"
+        "\n"
+        "This feature only works for user WAD files on disk (not files in the game disc) and only if the\n"
+        "names and order of all lumps in the WAD stay the same. Textures whose dimensions change are not\n"
+        "reloaded and require a level restart.",
+        gbEnableDevTexAutoReload,
+        false
+    );
+
     // Cheat key sequences
     cfg.cheatKeys_godMode = makeCheatKeySequenceConfigField(
         "CheatKeySequence_GodMode",
@@ -13,6 +13,7 @@ struct Config_Cheats {
     ConfigField     enableDevCheatShortcuts;
     ConfigField     enableDevInPlaceReloadFunctionKey;
     ConfigField     enableDevMapAutoReload;
+    ConfigField     enableDevTexAutoReload;
     ConfigField     cheatKeys_godMode;
     ConfigField     cheatKeys_noClip;
     ConfigField     cheatKeys_levelWarp;
@@ -40,7 +40,8 @@ void initCfgSerialization_Game() noexcept {
 
     cfg.showPerfCounters = makeConfigField(
         "ShowPerfCounters",
-        "If enabled then show performance counters (FPS & frame duration) during gameplay and menus.",
+        "If enabled then show performance counters (FPS & frame duration) during gameplay and menus.\n"
+        "A breakdown of recent frame times (simulation, CPU render, GPU and present) and a frame time graph are also shown.\n",
         gbShowPerfCounters,
         false
     );
@@ -85,6 +86,8 @@ void initCfgSerialization_Game() noexcept {
         "\n"
         "If the value of this setting is <= 0 then PsyDoom will reserve a default amount of memory which is\n"
         "presently 64 MiB. This should be enough for even the most demanding user maps.\n"
+        "If the heap runs out of space then it will be expanded in steps of 16 MiB or more, and the extra\n"
+        "memory is given back once it is no longer used after a level ends.\n"
         "\n"
         "For reference, the original PSX Doom had about 1.3 MiB of heap space\n"
         "available, though it also used less RAM in general being a 32-bit program instead of 64-bit.\n"
@@ -394,6 +397,56 @@ void initCfgSerialization_Game() noexcept {
         true
     );
 
+    cfg.useSightPvs = makeConfigField(
+        "UseSightPvs",
+        "If enabled then precompute which areas of each map can possibly see each other when the map is\n"
+        "loaded, and use this to skip expensive enemy 'line of sight' checks that can never succeed.\n"
+        "This helps performance in large maps which lack a proper 'REJECT' lump. The results are cached\n"
+        "on disk so they only need to be computed the first time a map is played.\n"
+        "\n"
+        "Note: this setting does not change game behavior and is safe to use with demos.",
+        gbUseSightPvs,
+        true
+    );
+
+    cfg.useParallelSightChecks = makeConfigField(
+        "UseParallelSightChecks",
+        "EXPERIMENTAL: if enabled then the 'line of sight' checks that enemies do each game tic are spread\n"
+        "across multiple CPU cores. The results are applied to enemies in the same order as normal once all\n"
+        "checks have finished, so game behavior is unchanged. This may help performance in maps with huge\n"
+        "numbers of enemies ('slaughter maps').\n"
+        "\n"
+        "Note: this setting is ignored during demos and networked games.",
+        gbUseParallelSightChecks,
+        false
+    );
+
+    cfg.maxJobThreads = makeConfigField(
+        "MaxJobThreads",
+        "The maximum number of CPU threads to use for work that is spread across multiple cores, such as\n"
+        "level loading, movie decoding, parallel 'line of sight' checks and rendering (both the Vulkan and\n"
+        "classic renderers). This count includes the main game thread. Lowering this may help if PsyDoom is\n"
+        "sharing the machine with other demanding programs. Changes take effect when PsyDoom is restarted.\n"
+        "\n"
+        "Allowed values:\n"
+        "   0 = Auto decide based on the number of CPU cores\n"
+        "   1 = Don't use any extra threads, do all of this work on the main thread\n"
+        " >1 = Use at most this many threads",
+        gMaxJobThreads,
+        0
+    );
+
+    cfg.useLumpCache = makeConfigField(
+        "UseLumpCache",
+        "If enabled then keep a cache on disk of the decompressed data for lumps in the WAD files on the game disc.\n"
+        "This lets the game skip decompressing lumps when they are loaded again on future launches, which can\n"
+        "help level loading times on slower machines. The cache files are stored in the user data folder.\n"
+        "\n"
+        "Note: this setting does not change game behavior and is safe to use with demos.",
+        gbUseLumpCache,
+        false
+    );
+
     cfg.fixOutdoorBulletPuffs = makeConfigField(
         "FixOutdoorBulletPuffs",
         "If enabled then fix a Doom engine bug where bullet puffs don't appear sometimes when shooting\n"
@@ -39,6 +39,10 @@ struct Config_Game {
     ConfigField     lostSoulSpawnLimit;
     ConfigField     useLostSoulSpawnFix;
     ConfigField     useLineOfSightOverflowFix;
+    ConfigField     useSightPvs;
+    ConfigField     useParallelSightChecks;
+    ConfigField     maxJobThreads;
+    ConfigField     useLumpCache;
     ConfigField     fixOutdoorBulletPuffs;
     ConfigField     fixBlockingGibsBug;
     ConfigField     fixSoundPropagation;
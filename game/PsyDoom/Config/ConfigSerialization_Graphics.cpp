@@ -92,6 +92,19 @@ void initCfgSerialization_Graphics() noexcept {
         gDefaultAntiAliasingMultisamples
     );
 
+    cfg.antiAliasingSampleShading = makeConfigField(
+        "AntiAliasingSampleShading",
+        "Vulkan renderer only: when anti-aliasing is enabled, the minimum fraction (0.0 to 1.0) of the\n"
+        "multisamples for each pixel that 3D world shading is done for. At '1.0' every single sample is\n"
+        "shaded, which best eliminates texture shimmer but is costly at high sample counts or resolutions\n"
+        "since PlayStation VRAM and palette lookups are emulated for every sample. Lower values trade some\n"
+        "texture shimmer for speed. If '0' then only polygon edges are anti-aliased.\n"
+        "\n"
+        "Note: this setting has no effect if the GPU does not support sample rate shading.",
+        gAASampleShading,
+        1.0f
+    );
+
     cfg.vulkanRenderHeight = makeConfigField(
         "VulkanRenderHeight",
         "Vulkan renderer: determines the vertical resolution (in pixels) of the render/draw framebuffer.\n"
@@ -127,6 +140,22 @@ void initCfgSerialization_Graphics() noexcept {
         false
     );
 
+    cfg.vulkanDynamicResolutionFps = makeConfigField(
+        "VulkanDynamicResolutionFps",
+        "Vulkan renderer: if greater than '0' then enables dynamic resolution, with this being the target\n"
+        "frame rate. The render resolution is lowered (down to half of the resolution determined by\n"
+        "'VulkanRenderHeight') when the GPU takes too long to draw a frame for the target frame rate, and\n"
+        "raised again when the GPU has time to spare. The view is upscaled to the display on output.\n"
+        "\n"
+        "This can help slower GPUs hold the target frame rate on heavy maps or at high resolutions.\n"
+        "Note that the whole frame (including the UI) is drawn at the reduced resolution, and that there\n"
+        "may be a brief hitch whenever the resolution changes since framebuffers must be recreated.\n"
+        "Changes are limited to at most once every second or so to avoid this happening often.\n"
+        "Set to '0' to disable and always render at the full resolution.",
+        gVulkanDynamicResolutionFps,
+        0
+    );
+
     cfg.vulkanTripleBuffer = makeConfigField(
         "VulkanTripleBuffer",
         "If the Vulkan video backend is active and the Vulkan API is in use, whether to use triple\n"
@@ -143,6 +172,21 @@ void initCfgSerialization_Graphics() noexcept {
         false
     );
 
+    cfg.vulkanLowLatencyMode = makeConfigField(
+        "VulkanLowLatencyMode",
+        "If the Vulkan video backend is active and the Vulkan API is in use, whether to reduce input\n"
+        "latency by only allowing 1 frame to be in flight on the GPU at a time. This setting affects both\n"
+        "the classic renderer when it is output via Vulkan and the new Vulkan renderer itself.\n"
+        "\n"
+        "If enabled then after presenting a frame the game waits for the GPU to finish it before starting\n"
+        "on the next frame, so that player inputs are read as close as possible to when they are drawn.\n"
+        "This is most useful with vsync enabled, where frames would otherwise queue up ahead of the\n"
+        "display. It may reduce the frame rate slightly on slower systems, since the CPU and GPU can no\n"
+        "longer work on different frames at the same time.",
+        gbVulkanLowLatencyMode,
+        false
+    );
+
     cfg.vulkanDrawExtendedStatusBar = makeConfigField(
         "VulkanDrawExtendedStatusBar",
         "Vulkan renderer only: draw extensions to the in-game status bar for widescreen mode?\n"
@@ -270,6 +314,21 @@ void initCfgSerialization_Graphics() noexcept {
         true
     );
 
+    cfg.classicUpscaleFactor = makeConfigField(
+        "ClassicUpscaleFactor",
+        "Classic renderer with the SDL video backend only: integer factor to upscale the PSX framebuffer by\n"
+        "on the CPU before it is sent to the GPU for display. When upscaled, the remaining (non integer)\n"
+        "scaling to the window size is done with bilinear filtering; this gives a 'sharp bilinear' look\n"
+        "which avoids uneven pixel sizes without blurring the image too much.\n"
+        "\n"
+        "Example values:\n"
+        "  1 = Don't upscale: scale the original framebuffer straight to the window with no filtering.\n"
+        "  2 = Upscale to 2x the original resolution (512x480) before doing filtered scaling.\n"
+        " -1 = Auto: use the largest integer factor that fits within the window (up to 8x).",
+        gClassicUpscaleFactor,
+        1
+    );
+
     cfg.vulkanBrightenAutomap = makeConfigField(
         "VulkanBrightenAutomap",
         "Vulkan renderer only: if enabled then automap lines will be brightened to compensate for them\n"
@@ -281,6 +340,16 @@ void initCfgSerialization_Graphics() noexcept {
         true
     );
 
+    cfg.vulkanCoarseOcclusion = makeConfigField(
+        "VulkanCoarseOcclusion",
+        "Vulkan renderer only: if enabled then use a coarse, low resolution occlusion buffer to help cull\n"
+        "areas of the map which are hidden behind upper and lower walls, floors and ceilings.\n"
+        "This can reduce the amount of geometry drawn on large open maps with many sector height changes.\n"
+        "Disable if you notice parts of the level wrongly disappearing.",
+        gbVulkanCoarseOcclusion,
+        true
+    );
+
     cfg.useExtendedAutomapColors = makeConfigField(
         "UseExtendedAutomapColors",
         "If enabled then live enemies and special bonus items (that count towards the player's item total)\n"
@@ -303,6 +372,27 @@ void initCfgSerialization_Graphics() noexcept {
         gDefaultVramSizeInMegabytes
     );
 
+    cfg.texCacheLruEviction = makeConfigField(
+        "TexCacheLruEviction",
+        "If enabled (1) then when the texture cache needs to make room for a new sprite or texture, it will\n"
+        "prefer to evict textures from the VRAM pages which have gone unused for the longest time. This\n"
+        "helps reduce texture re-uploads and 'Texture Cache Overflow' warnings on sprite heavy maps.\n"
+        "If disabled (0) then the cache simply moves to the next VRAM page in order, like the original game.\n",
+        gbTexCacheLruEviction,
+        true
+    );
+
+    cfg.decodedTexPoolSizeInMegabytes = makeConfigField(
+        "DecodedTexturePoolSizeInMegabytes",
+        "How many megabytes of system RAM to use for keeping decompressed copies of recently used sprites\n"
+        "and textures. When a sprite or texture is evicted from VRAM and needed again later, or when an\n"
+        "animated texture changes, it can then be uploaded without decompressing its WAD lump again.\n"
+        "Least recently used sprites and textures are discarded first when this limit is reached.\n"
+        "If <= 0 is specified then decompressed sprites and textures will not be kept.\n",
+        gDecodedTexPoolSizeInMegabytes,
+        32
+    );
+
     cfg.vulkanPreferredDevicesRegex = makeConfigField(
         "VulkanPreferredDevicesRegex",
         "Vulkan renderer: a case insensitive regex that can specify which GPUs are preferable to use.\n"
@@ -17,9 +17,12 @@ struct Config_Graphics {
     ConfigField     outputDisplayIndex;
     ConfigField     exclusiveFullscreenMode;
     ConfigField     antiAliasingMultisamples;
+    ConfigField     antiAliasingSampleShading;
     ConfigField     vulkanRenderHeight;
     ConfigField     vulkanPixelStretch;
+    ConfigField     vulkanDynamicResolutionFps;
     ConfigField     vulkanTripleBuffer;
+    ConfigField     vulkanLowLatencyMode;
     ConfigField     vulkanDrawExtendedStatusBar;
     ConfigField     vulkanWidescreenEnabled;
     ConfigField     useVulkan32BitShading;
@@ -30,9 +33,13 @@ struct Config_Graphics {
     ConfigField     enhanceWallDrawPrecision;
     ConfigField     floorRenderGapFix;
     ConfigField     skyLeakFix;
+    ConfigField     classicUpscaleFactor;
     ConfigField     vulkanBrightenAutomap;
+    ConfigField     vulkanCoarseOcclusion;
     ConfigField     useExtendedAutomapColors;
     ConfigField     vramSizeInMegabytes;
+    ConfigField     texCacheLruEviction;
+    ConfigField     decodedTexPoolSizeInMegabytes;
     ConfigField     vulkanPreferredDevicesRegex;
 
     inline ConfigFieldList getFieldList() noexcept {
@@ -7,7 +7,7 @@
 
 #include <algorithm>
 #include <cmath>
-#include <regex>
+#include <cstring>
 #include <SDL.h>
 #include <string>
 #include <vector>
@@ -20,21 +20,24 @@ static bool gbDidInit = false;
 // The list of inputs that each control binding uses
 static BindingData gBindings[(uint16_t) Binding::NUM_BINDINGS];
 
+// Precomputed masks of the keyboard, mouse and gamepad inputs used by a control binding.
+// These allow the state of all those inputs to be checked at once, rather than checking each input source individually.
+// Input sources which can't be represented by the masks are listed by index, so they can still be checked one at a time.
+struct BindingMasks {
+    Input::KeyboardKeyBits      keyboardKeys;                       // Keys that contribute to the binding value and pressed/released events
+    Input::MouseButtonBits      mouseButtons;                       // Mouse buttons that contribute to the binding value and pressed/released events
+    Input::GamepadInputBits     gamepadInputs;                      // Gamepad inputs that contribute to pressed/released events (only!)
+    uint8_t                     numValueSrcs;                       // How many input sources must be checked individually to get the binding value
+    uint8_t                     numEventSrcs;                       // How many input sources must be checked individually for pressed/released events
+    uint8_t                     valueSrcs[MAX_BINDING_INPUTS];      // Indexes of input sources that must be checked individually to get the binding value
+    uint8_t                     eventSrcs[MAX_BINDING_INPUTS];      // Indexes of input sources that must be checked individually for pressed/released events
+};
+
+static BindingMasks gBindingMasks[(uint16_t) Binding::NUM_BINDINGS];
+
 // Temporary string used to hold the current input name
 static std::string gCurInputName;
 
-// Use case insensitive matching for all regexes and use ECMAScript
-static constexpr auto REGEX_OPTIONS = std::regex_constants::ECMAScript | std::regex_constants::icase;
-
-// Regexes for parsing generic joystick control bindings
-static const std::regex gRegex_JoystickAxis_Pos     = std::regex(R"(^JOYSTICK\s+AXIS(\d+)\+$)", REGEX_OPTIONS);
-static const std::regex gRegex_JoystickAxis_Neg     = std::regex(R"(^JOYSTICK\s+AXIS(\d+)-$)", REGEX_OPTIONS);
-static const std::regex gRegex_JoystickButton       = std::regex(R"(^JOYSTICK\s+BUTTON(\d+)$)", REGEX_OPTIONS);
-static const std::regex gRegex_JoystickHat_Up       = std::regex(R"(^JOYSTICK\s+HAT(\d+)\s+UP$)", REGEX_OPTIONS);
-static const std::regex gRegex_JoystickHat_Down     = std::regex(R"(^JOYSTICK\s+HAT(\d+)\s+DOWN$)", REGEX_OPTIONS);
-static const std::regex gRegex_JoystickHat_Left     = std::regex(R"(^JOYSTICK\s+HAT(\d+)\s+LEFT$)", REGEX_OPTIONS);
-static const std::regex gRegex_JoystickHat_Right    = std::regex(R"(^JOYSTICK\s+HAT(\d+)\s+RIGHT$)", REGEX_OPTIONS);
-
 // A struct returned when data for an invalid binding is requested
 static const BindingData INVALID_BINDING_DATA = {};
 
@@ -83,6 +86,47 @@ static const char* getNextInputNameUpper(const char* const str, std::string& nam
     return pCurChar;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helpers for parsing generic joystick input names, like 'JOYSTICK AXIS1+' or 'JOYSTICK HAT1 UP'.
+// Each helper tries to consume the specified text at the current string position and advances past it if successful.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool consumeText(const char*& pStr, const char* const text) noexcept {
+    const size_t textLen = std::strlen(text);
+
+    if (std::strncmp(pStr, text, textLen) != 0)
+        return false;
+
+    pStr += textLen;
+    return true;
+}
+
+// Consumes one or more whitespace characters
+static bool consumeWhitespace(const char*& pStr) noexcept {
+    if (!isAsciiWhitespace(*pStr))
+        return false;
+
+    while (isAsciiWhitespace(*pStr)) {
+        ++pStr;
+    }
+
+    return true;
+}
+
+// Consumes one or more decimal digits and outputs the number they represent: very large numbers are clamped
+static bool consumeNumber(const char*& pStr, int32_t& numberOut) noexcept {
+    if ((*pStr < '0') || (*pStr > '9'))
+        return false;
+
+    int32_t number = 0;
+
+    for (; (*pStr >= '0') && (*pStr <= '9'); ++pStr) {
+        number = std::min(number * 10 + (*pStr - '0'), 0xFFFFFF);
+    }
+
+    numberOut = number;
+    return true;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Get a raw (unmodified) input as a floating point value.
 // Digital inputs such as keyboard keys are returned as either 0 or 1.
@@ -207,18 +251,75 @@ static float getInputForBinding(const Binding binding) noexcept {
     if (bindingIdx >= (uint16_t) Binding::NUM_BINDINGS)
         return 0.0f;
 
-    // Sum up the contribution from all the different input sources
+    // Sum up the contribution from all the different input sources.
+    // Keys and mouse buttons in the binding masks contribute '1.0' each when pressed, the rest must be checked individually.
     const BindingData& bindingData = gBindings[bindingIdx];
-    const uint32_t numInputSources = bindingData.numInputSources;
-    float inputValue = 0.0f;
+    const BindingMasks& bindingMasks = gBindingMasks[bindingIdx];
+
+    const size_t numDigitalInputsPressed = (
+        (bindingMasks.keyboardKeys & Input::getKeyboardKeyBitsPressed()).count() +
+        (bindingMasks.mouseButtons & Input::getMouseButtonBitsPressed()).count()
+    );
+
+    float inputValue = (float) numDigitalInputsPressed;
 
-    for (uint16_t i = 0; i < numInputSources; ++i) {
-        inputValue += getSubAxisInput(bindingData.inputSources[i]);
+    for (uint32_t i = 0; i < bindingMasks.numValueSrcs; ++i) {
+        inputValue += getSubAxisInput(bindingData.inputSources[bindingMasks.valueSrcs[i]]);
     }
 
     return inputValue;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Recomputes the masks of keyboard, mouse and gamepad inputs used by the specified binding.
+// Must be called whenever the input sources for the binding change.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void updateBindingMasks(const uint16_t bindingIdx) noexcept {
+    ASSERT(bindingIdx < (uint16_t) Binding::NUM_BINDINGS);
+
+    const BindingData& bindingData = gBindings[bindingIdx];
+    BindingMasks& bindingMasks = gBindingMasks[bindingIdx];
+    bindingMasks = {};
+
+    for (uint32_t i = 0; i < bindingData.numInputSources; ++i) {
+        const InputSrc inputSrc = bindingData.inputSources[i];
+        const uint16_t input = inputSrc.input;
+
+        // Note: a key or mouse button bound more than once (or with an unusual negative sub-axis) can't be represented by the masks.
+        // Since each binding of the input contributes to the binding value, the extra bindings are checked individually.
+        bool bValueInMask = false;
+
+        if ((inputSrc.device == InputSrc::KEYBOARD_KEY) && (input < Input::NUM_KEYBOARD_KEYS)) {
+            bValueInMask = ((inputSrc.subaxis == InputSrc::SUBAXIS_POS) && (!bindingMasks.keyboardKeys.test(input)));
+
+            if (bValueInMask) {
+                bindingMasks.keyboardKeys.set(input);
+            } else {
+                bindingMasks.eventSrcs[bindingMasks.numEventSrcs++] = (uint8_t) i;
+            }
+        }
+        else if ((inputSrc.device == InputSrc::MOUSE_BUTTON) && (input < NUM_MOUSE_BUTTONS)) {
+            bValueInMask = ((inputSrc.subaxis == InputSrc::SUBAXIS_POS) && (!bindingMasks.mouseButtons.test(input)));
+
+            if (bValueInMask) {
+                bindingMasks.mouseButtons.set(input);
+            } else {
+                bindingMasks.eventSrcs[bindingMasks.numEventSrcs++] = (uint8_t) i;
+            }
+        }
+        else if (((inputSrc.device == InputSrc::GAMEPAD_AXIS) || (inputSrc.device == InputSrc::GAMEPAD_BUTTON)) && (input < NUM_GAMEPAD_INPUTS)) {
+            bindingMasks.gamepadInputs.set(input);
+        }
+        else {
+            bindingMasks.eventSrcs[bindingMasks.numEventSrcs++] = (uint8_t) i;
+        }
+
+        if (!bValueInMask) {
+            bindingMasks.valueSrcs[bindingMasks.numValueSrcs++] = (uint8_t) i;
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Determine an input source from the given uppercase string containing it's name: returns 'false' if no source could be determined
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -319,39 +420,50 @@ static bool getInputSrcFromNameUpper(const std::string& nameUpper, InputSrc& inp
         }
     }
     else if (nameUpper.find("JOYSTICK ") == 0) {
-        // Probably a generic joystick input (not inverted) - try one of the regexes for generic joystick inputs.
+        // Probably a generic joystick input (not inverted) - try to parse one of the generic joystick input name formats:
+        //  JOYSTICK AXIS<NUM>+
+        //  JOYSTICK AXIS<NUM>-
+        //  JOYSTICK BUTTON<NUM>
+        //  JOYSTICK HAT<NUM> <UP|DOWN|LEFT|RIGHT>
+        //
         // Note: for axis, button etc. numbers they are '1' based to the user but '0' based in code - hence we subtract '1' everywhere here...
-        std::smatch regexMatches;
+        const char* pStr = nameUpper.c_str() + (sizeof("JOYSTICK") - 1);
+        int32_t number = 0;
+
+        if (consumeWhitespace(pStr)) {
+            if (consumeText(pStr, "AXIS")) {
+                if (consumeNumber(pStr, number) && ((pStr[0] == '+') || (pStr[0] == '-')) && (pStr[1] == 0)) {
+                    inputSrc.device = InputSrc::JOYSTICK_AXIS;
+                    inputSrc.input = (uint16_t)(number - 1);
+                    inputSrc.subaxis = (pStr[0] == '+') ? InputSrc::SUBAXIS_POS : InputSrc::SUBAXIS_NEG;
+                }
+            }
+            else if (consumeText(pStr, "BUTTON")) {
+                if (consumeNumber(pStr, number) && (pStr[0] == 0)) {
+                    inputSrc.device = InputSrc::JOYSTICK_BUTTON;
+                    inputSrc.input = (uint16_t)(number - 1);
+                }
+            }
+            else if (consumeText(pStr, "HAT") && consumeNumber(pStr, number) && consumeWhitespace(pStr)) {
+                const uint8_t hatNum = (uint8_t)(number - 1);
 
-        if (std::regex_search(nameUpper, regexMatches, gRegex_JoystickAxis_Pos)) {
-            inputSrc.device = InputSrc::JOYSTICK_AXIS;
-            inputSrc.input = (uint16_t)(std::stoi(regexMatches[1]) - 1);
-            inputSrc.subaxis = InputSrc::SUBAXIS_POS;
-        }
-        else if (std::regex_search(nameUpper, regexMatches, gRegex_JoystickAxis_Neg)) {
-            inputSrc.device = InputSrc::JOYSTICK_AXIS;
-            inputSrc.input = (uint16_t)(std::stoi(regexMatches[1]) - 1);
-            inputSrc.subaxis = InputSrc::SUBAXIS_NEG;
-        }
-        else if (std::regex_search(nameUpper, regexMatches, gRegex_JoystickButton)) {
-            inputSrc.device = InputSrc::JOYSTICK_BUTTON;
-            inputSrc.input = (uint16_t)(std::stoi(regexMatches[1]) - 1);
-        }
-        else if (std::regex_search(nameUpper, regexMatches, gRegex_JoystickHat_Up)) {
-            inputSrc.device = InputSrc::JOYSTICK_HAT;
-            inputSrc.input = Input::JoyHat(Input::JoyHatDir::Up, (uint8_t)(std::stoi(regexMatches[1]) - 1));
-        }
-        else if (std::regex_search(nameUpper, regexMatches, gRegex_JoystickHat_Down)) {
-            inputSrc.device = InputSrc::JOYSTICK_HAT;
-            inputSrc.input = Input::JoyHat(Input::JoyHatDir::Down, (uint8_t)(std::stoi(regexMatches[1]) - 1));
-        }
-        else if (std::regex_search(nameUpper, regexMatches, gRegex_JoystickHat_Left)) {
-            inputSrc.device = InputSrc::JOYSTICK_HAT;
-            inputSrc.input = Input::JoyHat(Input::JoyHatDir::Left, (uint8_t)(std::stoi(regexMatches[1]) - 1));
-        }
-        else if (std::regex_search(nameUpper, regexMatches, gRegex_JoystickHat_Right)) {
-            inputSrc.device = InputSrc::JOYSTICK_HAT;
-            inputSrc.input = Input::JoyHat(Input::JoyHatDir::Right, (uint8_t)(std::stoi(regexMatches[1]) - 1));
+                if (std::strcmp(pStr, "UP") == 0) {
+                    inputSrc.device = InputSrc::JOYSTICK_HAT;
+                    inputSrc.input = Input::JoyHat(Input::JoyHatDir::Up, hatNum);
+                }
+                else if (std::strcmp(pStr, "DOWN") == 0) {
+                    inputSrc.device = InputSrc::JOYSTICK_HAT;
+                    inputSrc.input = Input::JoyHat(Input::JoyHatDir::Down, hatNum);
+                }
+                else if (std::strcmp(pStr, "LEFT") == 0) {
+                    inputSrc.device = InputSrc::JOYSTICK_HAT;
+                    inputSrc.input = Input::JoyHat(Input::JoyHatDir::Left, hatNum);
+                }
+                else if (std::strcmp(pStr, "RIGHT") == 0) {
+                    inputSrc.device = InputSrc::JOYSTICK_HAT;
+                    inputSrc.input = Input::JoyHat(Input::JoyHatDir::Right, hatNum);
+                }
+            }
         }
     }
     else {
@@ -411,6 +523,10 @@ void clearAllBindings() noexcept {
     for (BindingData& bindingData : gBindings) {
         bindingData = {};
     }
+
+    for (BindingMasks& bindingMasks : gBindingMasks) {
+        bindingMasks = {};
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -444,6 +560,8 @@ void parseBinding(const Binding binding, const char* const str) noexcept {
         // Otherwise add the input source to the binding
         addInputSourceToBinding(inputSrc, bindingData);
     }
+
+    updateBindingMasks(bindingIdx);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -478,12 +596,23 @@ bool isJustPressed(const Binding binding) noexcept {
     if (bindingIdx >= (uint16_t) Binding::NUM_BINDINGS)
         return false;
 
-    // Check to see if any of the input sources are just pressed
+    // Check to see if any of the keyboard, mouse or gamepad inputs in the binding masks are just pressed
+    const BindingMasks& bindingMasks = gBindingMasks[bindingIdx];
+
+    if ((bindingMasks.keyboardKeys & Input::getKeyboardKeyBitsJustPressed()).any())
+        return true;
+
+    if ((bindingMasks.mouseButtons & Input::getMouseButtonBitsJustPressed()).any())
+        return true;
+
+    if ((bindingMasks.gamepadInputs & Input::getGamepadInputBitsJustPressed()).any())
+        return true;
+
+    // Check to see if any of the other input sources are just pressed
     const BindingData& bindingData = gBindings[bindingIdx];
-    const uint32_t numInputSources = bindingData.numInputSources;
 
-    for (uint32_t i = 0; i < numInputSources; ++i) {
-        const InputSrc inputSrc = bindingData.inputSources[i];
+    for (uint32_t i = 0; i < bindingMasks.numEventSrcs; ++i) {
+        const InputSrc inputSrc = bindingData.inputSources[bindingMasks.eventSrcs[i]];
 
         if (isInputJustPressed(inputSrc))
             return true;
@@ -502,12 +631,23 @@ bool isJustReleased(const Binding binding) noexcept {
     if (bindingIdx >= (uint16_t) Binding::NUM_BINDINGS)
         return false;
 
-    // Check to see if any of the input sources are just released
+    // Check to see if any of the keyboard, mouse or gamepad inputs in the binding masks are just released
+    const BindingMasks& bindingMasks = gBindingMasks[bindingIdx];
+
+    if ((bindingMasks.keyboardKeys & Input::getKeyboardKeyBitsJustReleased()).any())
+        return true;
+
+    if ((bindingMasks.mouseButtons & Input::getMouseButtonBitsJustReleased()).any())
+        return true;
+
+    if ((bindingMasks.gamepadInputs & Input::getGamepadInputBitsJustReleased()).any())
+        return true;
+
+    // Check to see if any of the other input sources are just released
     const BindingData& bindingData = gBindings[bindingIdx];
-    const uint32_t numInputSources = bindingData.numInputSources;
 
-    for (uint32_t i = 0; i < numInputSources; ++i) {
-        const InputSrc inputSrc = bindingData.inputSources[i];
+    for (uint32_t i = 0; i < bindingMasks.numEventSrcs; ++i) {
+        const InputSrc inputSrc = bindingData.inputSources[bindingMasks.eventSrcs[i]];
 
         if (isInputJustReleased(inputSrc))
             return true;
@@ -0,0 +1,211 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A module which keeps the decompressed data for recently used texture and sprite lumps around, up to a configurable budget.
+// When the texture cache evicts a sprite or texture and it is needed again soon after, or when an animated texture is re-uploaded,
+// the decompressed lump data can be taken from here rather than decoding the compressed lump again.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "DecodedTexPool.h"
+
+#include "Asserts.h"
+#include "Config/Config.h"
+#include "Doom/Base/i_texcache.h"
+#include "Doom/Base/w_wad.h"
+#include "GameJobs.h"
+#include "TexturePatcher.h"
+#include "WadFile.h"
+
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+BEGIN_NAMESPACE(DecodedTexPool)
+
+// Decompressed data for one lump in the pool
+struct PoolEntry {
+    int32_t                         lumpIdx;
+    uint32_t                        size;
+    std::unique_ptr<std::byte[]>    pData;
+};
+
+// All of the lumps in the pool, from most recently used to least recently used: plus a lookup of pool entries by lump index
+static std::list<PoolEntry>                                         gPoolEntries;
+static std::unordered_map<int32_t, std::list<PoolEntry>::iterator>  gPoolEntryLookup;
+
+// Total size of all the lump data in the pool
+static size_t gPoolSize;
+
+// A lump to be decompressed into the pool by a job, when adding a batch of lumps to the pool
+struct BatchLumpDecode {
+    int32_t         lumpIdx;
+    uint32_t        size;
+    const void*     pCompressedData;
+    std::byte*      pData;
+};
+
+static std::vector<BatchLumpDecode> gBatchLumpDecodes;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the maximum allowed size of the pool in bytes, as specified by the user config
+//------------------------------------------------------------------------------------------------------------------------------------------
+static size_t getMaxPoolSize() noexcept {
+    const int32_t maxPoolSizeMB = Config::gDecodedTexPoolSizeInMegabytes;
+    return (maxPoolSizeMB > 0) ? (size_t) maxPoolSizeMB * 1024 * 1024 : 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Removes the least recently used lump from the pool
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void evictLeastRecentlyUsed() noexcept {
+    ASSERT(!gPoolEntries.empty());
+    PoolEntry& entry = gPoolEntries.back();
+    gPoolSize -= entry.size;
+    gPoolEntryLookup.erase(entry.lumpIdx);
+    gPoolEntries.pop_back();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes room in the pool for a lump of the given size (which must fit in the pool) and adds an entry for it as the most recently used lump.
+// Returns the memory to decompress the lump data to.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::byte* allocPoolEntry(const int32_t lumpIdx, const uint32_t decodedSize, const size_t maxPoolSize) noexcept {
+    ASSERT(decodedSize <= maxPoolSize);
+
+    while (gPoolSize + decodedSize > maxPoolSize) {
+        evictLeastRecentlyUsed();
+    }
+
+    gPoolEntries.push_front(PoolEntry{ lumpIdx, decodedSize, std::make_unique<std::byte[]>(decodedSize) });
+    gPoolEntryLookup[lumpIdx] = gPoolEntries.begin();
+    gPoolSize += decodedSize;
+    return gPoolEntries.front().pData.get();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Job function: decompresses one lump in the batch of lumps being added to the pool and applies any texture patches to it.
+// The context is the array of lump decodes for the batch.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void decodeBatchLump(void* const pCtx, const uint32_t jobIdx) noexcept {
+    const BatchLumpDecode& lumpDecode = ((const BatchLumpDecode*) pCtx)[jobIdx];
+    decode(lumpDecode.pCompressedData, lumpDecode.pData);
+    TexturePatcher::applyLumpPatches(lumpDecode.lumpIdx, { lumpDecode.pData, lumpDecode.size });
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the pool is enabled by the user config
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isEnabled() noexcept {
+    return (getMaxPoolSize() > 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the decompressed data for the specified lump if it is in the pool, or otherwise 'nullptr'.
+// If found then the lump also becomes the most recently used lump in the pool.
+//------------------------------------------------------------------------------------------------------------------------------------------
+const std::byte* findLumpData(const int32_t lumpIdx) noexcept {
+    const auto lookupIter = gPoolEntryLookup.find(lumpIdx);
+
+    if (lookupIter == gPoolEntryLookup.end())
+        return nullptr;
+
+    const auto entryIter = lookupIter->second;
+    gPoolEntries.splice(gPoolEntries.begin(), gPoolEntries, entryIter);
+    gTexCacheStats.numDecodedPoolHits++;
+    return entryIter->pData.get();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decompresses the given compressed data for the specified lump into the pool and returns the decompressed data.
+// Any texture patches which apply to the lump are also applied to the decompressed data.
+// Lumps which have gone unused for the longest time are evicted to make room as required.
+// If the pool is disabled or the lump is too big for the pool then 'nullptr' is returned, and nothing is decompressed.
+// Note: the lump must not already be in the pool!
+//------------------------------------------------------------------------------------------------------------------------------------------
+const std::byte* addLumpData(const int32_t lumpIdx, const void* const pCompressedData, const uint32_t decodedSize) noexcept {
+    ASSERT(pCompressedData);
+    ASSERT(gPoolEntryLookup.count(lumpIdx) == 0);
+
+    // Is there any hope of this lump fitting?
+    const size_t maxPoolSize = getMaxPoolSize();
+
+    if ((maxPoolSize <= 0) || (decodedSize > maxPoolSize))
+        return nullptr;
+
+    // Make room for the lump, then decompress it into the pool as the most recently used lump.
+    // Texture patches are applied to the data once here, so that it does not need to be checked for patching again while pooled.
+    std::byte* const pData = allocPoolEntry(lumpIdx, decodedSize, maxPoolSize);
+    decode(pCompressedData, pData);
+    TexturePatcher::applyLumpPatches(lumpIdx, { pData, decodedSize });
+    return pData;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the decompressed data for the specified compressed (and cached) lump, decompressing it into the pool if required.
+// Returns 'nullptr' if the pool is disabled or the lump is too big for the pool, in which case the caller must decompress the lump.
+//------------------------------------------------------------------------------------------------------------------------------------------
+const std::byte* getLumpData(const int32_t lumpIdx, const WadLump& lump) noexcept {
+    ASSERT(lump.pCachedData && (!lump.bIsUncompressed));
+
+    if (const std::byte* const pData = findLumpData(lumpIdx))
+        return pData;
+
+    return addLumpData(lumpIdx, lump.pCachedData, (uint32_t) lump.uncompressedSize);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decompresses a batch of main WAD lumps into the pool ahead of when they are needed, spreading the work across the job worker threads.
+// Lumps which are not cached, are uncompressed or are already in the pool are skipped. Lumps are only added while the total size of the
+// batch fits within the pool, so that lumps added by the batch do not evict each other.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void addLumps(const int32_t* const pLumpIdxs, const int32_t numLumps) noexcept {
+    const size_t maxPoolSize = getMaxPoolSize();
+    size_t batchSize = 0;
+    gBatchLumpDecodes.clear();
+
+    for (int32_t i = 0; i < numLumps; ++i) {
+        const int32_t lumpIdx = pLumpIdxs[i];
+        const WadLump& lump = W_GetLump(lumpIdx);
+
+        if ((!lump.pCachedData) || lump.bIsUncompressed || (gPoolEntryLookup.count(lumpIdx) > 0))
+            continue;
+
+        const uint32_t decodedSize = (uint32_t) lump.uncompressedSize;
+
+        if (batchSize + decodedSize > maxPoolSize)
+            break;
+
+        batchSize += decodedSize;
+        std::byte* const pData = allocPoolEntry(lumpIdx, decodedSize, maxPoolSize);
+        gBatchLumpDecodes.push_back({ lumpIdx, decodedSize, lump.pCachedData, pData });
+    }
+
+    GameJobs::run(decodeBatchLump, gBatchLumpDecodes.data(), (uint32_t) gBatchLumpDecodes.size());
+    gBatchLumpDecodes.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Removes the specified lump from the pool (if it is in the pool) and frees up the memory used.
+// This must be done whenever the data for a lump changes, so that the old decompressed data is not used.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void removeLumpData(const int32_t lumpIdx) noexcept {
+    const auto lookupIter = gPoolEntryLookup.find(lumpIdx);
+
+    if (lookupIter == gPoolEntryLookup.end())
+        return;
+
+    const auto entryIter = lookupIter->second;
+    gPoolSize -= entryIter->size;
+    gPoolEntryLookup.erase(lookupIter);
+    gPoolEntries.erase(entryIter);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Removes all lumps from the pool and frees up the memory used.
+// This must be done whenever the main WADs are closed, since lump indexes may then refer to different lumps.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void clear() noexcept {
+    gPoolEntryLookup.clear();
+    gPoolEntries.clear();
+    gPoolSize = 0;
+}
+
+END_NAMESPACE(DecodedTexPool)
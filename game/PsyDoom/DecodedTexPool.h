@@ -0,0 +1,25 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstddef>
+#include <cstdint>
+
+struct WadLump;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A pool of decompressed texture and sprite lump data, kept in least recently used order and limited to a configurable size.
+// Allows textures which are evicted from VRAM and later re-uploaded to skip decompressing their lump again each time.
+// Note: pointers to data in the pool are only valid until the next lump is added to the pool or the pool is cleared.
+//------------------------------------------------------------------------------------------------------------------------------------------
+BEGIN_NAMESPACE(DecodedTexPool)
+
+bool isEnabled() noexcept;
+const std::byte* findLumpData(const int32_t lumpIdx) noexcept;
+const std::byte* addLumpData(const int32_t lumpIdx, const void* const pCompressedData, const uint32_t decodedSize) noexcept;
+const std::byte* getLumpData(const int32_t lumpIdx, const WadLump& lump) noexcept;
+void addLumps(const int32_t* const pLumpIdxs, const int32_t numLumps) noexcept;
+void removeLumpData(const int32_t lumpIdx) noexcept;
+void clear() noexcept;
+
+END_NAMESPACE(DecodedTexPool)
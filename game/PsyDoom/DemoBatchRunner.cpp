@@ -0,0 +1,458 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Runs and verifies the results of a whole batch of demos in one launch of the game, writing a single pass/fail report for all of them.
+// Used for regression testing of the game logic against a large corpus of demos, where startup time would otherwise dominate.
+//
+// The list of demos is read from a json manifest file of the following form, where relative paths are relative to the manifest file:
+//
+//  {
+//      "demos": [
+//          { "demo": "DEMO1.LMP", "result": "DEMO1.json" },
+//          { "demo": "DEMO2.LMP", "result": "DEMO2.json" }
+//      ]
+//  }
+//
+// All demos are run in headless mode. The game disc, WADs and other startup data is only loaded once, before any demos are run.
+// On platforms which support 'fork()' a number of worker processes are then forked off from the fully initialized game, with each worker
+// playing back an interleaved share of the demos and reporting the results back to the parent process via a pipe. If a worker crashes
+// (e.g due to a fatal error in a demo) then the demo being played is marked as having crashed and a new worker picks up where it left off.
+// On other platforms the demos are simply played back one after the other in the current process.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "DemoBatchRunner.h"
+
+#include "Doom/d_main.h"
+#include "Doom/psx_main.h"
+#include "FileUtils.h"
+#include "Finally.h"
+#include "ProgArgs.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <rapidjson/document.h>
+#include <rapidjson/filewritestream.h>
+#include <rapidjson/prettywriter.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if !_WIN32
+    #include <cerrno>
+    #include <csignal>
+    #include <poll.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+BEGIN_NAMESPACE(DemoBatchRunner)
+
+// The result for a single demo in the batch
+enum class DemoStatus : uint8_t {
+    NOT_RUN,        // The demo was not run (yet)
+    PASSED,         // The demo result matched the expected result
+    FAILED,         // The demo result did not match the expected result, or the demo could not be played
+    CRASHED         // The game crashed or terminated while playing the demo
+};
+
+// A demo to be run and its expected result
+struct DemoEntry {
+    std::string     demoFilePath;       // Path to the demo file to play
+    std::string     resultFilePath;     // Path to the json file containing the expected demo result
+    DemoStatus      status;             // The outcome of running the demo
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns a string describing the specified demo status
+//------------------------------------------------------------------------------------------------------------------------------------------
+static const char* getStatusString(const DemoStatus status) noexcept {
+    switch (status) {
+        case DemoStatus::NOT_RUN:   return "not_run";
+        case DemoStatus::PASSED:    return "passed";
+        case DemoStatus::FAILED:    return "failed";
+        case DemoStatus::CRASHED:   return "crashed";
+    }
+
+    return "unknown";
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes the specified path relative to the given folder (which has a trailing path separator) if it is not an absolute path
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::string resolvePath(const std::string& folderPath, const char* const path) noexcept {
+    const bool bIsAbsolutePath = ((path[0] == '/') || (path[0] == '\\') || ((path[0] != 0) && (path[1] == ':')));
+    return (bIsAbsolutePath) ? std::string(path) : folderPath + path;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the list of demos to run from the specified manifest file.
+// Returns 'false' on failure, printing the reason why.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool readManifest(const char* const manifestFilePath, std::vector<DemoEntry>& demos) noexcept {
+    // Read and parse the manifest json
+    const FileData fileData = FileUtils::getContentsOfFile(manifestFilePath, 8, std::byte(0));
+
+    if (!fileData.bytes) {
+        std::printf("Demo batch: unable to read the manifest file '%s'!\n", manifestFilePath);
+        return false;
+    }
+
+    rapidjson::Document document;
+
+    if (document.ParseInsitu((char*) fileData.bytes.get()).HasParseError() || (!document.IsObject())) {
+        std::printf("Demo batch: the manifest file '%s' is not valid json!\n", manifestFilePath);
+        return false;
+    }
+
+    const auto demosIter = document.FindMember("demos");
+
+    if ((demosIter == document.MemberEnd()) || (!demosIter->value.IsArray())) {
+        std::printf("Demo batch: the manifest file '%s' does not contain a 'demos' array!\n", manifestFilePath);
+        return false;
+    }
+
+    // Read all of the demo and result file pairs
+    std::string manifestFolderPath;
+    FileUtils::getParentPath(manifestFilePath, manifestFolderPath);
+
+    for (const rapidjson::Value& demoJson : demosIter->value.GetArray()) {
+        const auto demoIter = (demoJson.IsObject()) ? demoJson.FindMember("demo") : demoJson.MemberEnd();
+        const auto resultIter = (demoJson.IsObject()) ? demoJson.FindMember("result") : demoJson.MemberEnd();
+        const bool bValidEntry = (
+            (demoJson.IsObject()) &&
+            (demoIter != demoJson.MemberEnd()) && demoIter->value.IsString() &&
+            (resultIter != demoJson.MemberEnd()) && resultIter->value.IsString()
+        );
+
+        if (!bValidEntry) {
+            std::printf("Demo batch: manifest entry %u must have 'demo' and 'result' string fields!\n", (unsigned) demos.size());
+            return false;
+        }
+
+        DemoEntry& demo = demos.emplace_back();
+        demo.demoFilePath = resolvePath(manifestFolderPath, demoIter->value.GetString());
+        demo.resultFilePath = resolvePath(manifestFolderPath, resultIter->value.GetString());
+        demo.status = DemoStatus::NOT_RUN;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Plays back the specified demo in the current process and checks its result
+//------------------------------------------------------------------------------------------------------------------------------------------
+static DemoStatus runDemo(const DemoEntry& demo) noexcept {
+    // A missing demo file would be a fatal error, so check for that first
+    if (!FileUtils::fileExists(demo.demoFilePath.c_str()))
+        return DemoStatus::FAILED;
+
+    // Play the demo with the expected result set to be checked once it's done
+    ProgArgs::gPlayDemoFilePath = demo.demoFilePath.c_str();
+    ProgArgs::gCheckDemoResultFilePath = demo.resultFilePath.c_str();
+    gbCheckDemoResultFailed = false;
+
+    RunDemoAtPath(demo.demoFilePath.c_str());
+
+    const DemoStatus status = (gbCheckDemoResultFailed) ? DemoStatus::FAILED : DemoStatus::PASSED;
+    ProgArgs::gPlayDemoFilePath = "";
+    ProgArgs::gCheckDemoResultFilePath = "";
+    gbCheckDemoResultFailed = false;
+    return status;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Runs all of the demos one after the other in the current process
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void runDemosInProcess(std::vector<DemoEntry>& demos) noexcept {
+    for (DemoEntry& demo : demos) {
+        demo.status = runDemo(demo);
+    }
+}
+
+#if !_WIN32
+
+// A message sent from a worker process to the parent process when a demo has finished
+struct WorkerMsg {
+    uint32_t    demoIdx;        // Which demo finished
+    DemoStatus  status;         // The outcome of running the demo
+};
+
+// Tracks a worker process: each worker plays every 'Nth' demo, where 'N' is the number of workers
+struct Worker {
+    pid_t       pid;            // Process id of the worker, or '-1' if the worker is not running
+    int         readFd;         // The parent's end of the pipe which the worker sends results on
+    uint32_t    nextDemoIdx;    // The next demo the worker is expected to report the result for
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Entry point for a worker process: runs every 'Nth' demo starting at the given demo and reports each result via the given pipe.
+// Never returns, the worker process exits once done.
+//------------------------------------------------------------------------------------------------------------------------------------------
+[[noreturn]] static void runWorkerProcess(
+    const std::vector<DemoEntry>& demos,
+    const uint32_t firstDemoIdx,
+    const uint32_t demoIdxStride,
+    const int writeFd
+) noexcept {
+    for (uint32_t demoIdx = firstDemoIdx; demoIdx < demos.size(); demoIdx += demoIdxStride) {
+        const WorkerMsg msg = { demoIdx, runDemo(demos[demoIdx]) };
+
+        while (write(writeFd, &msg, sizeof(msg)) < 0) {
+            if (errno != EINTR)
+                _exit(1);
+        }
+    }
+
+    // Note: skip the usual game cleanup, the parent process handles all that
+    close(writeFd);
+    std::fflush(nullptr);
+    _exit(0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Forks a worker process to run every 'Nth' demo starting at the given demo.
+// Returns 'false' on failure, in which case the worker is not started.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool startWorker(
+    Worker& worker,
+    const std::vector<DemoEntry>& demos,
+    const uint32_t firstDemoIdx,
+    const uint32_t demoIdxStride
+) noexcept {
+    int pipeFds[2] = {};
+
+    if (pipe(pipeFds) != 0)
+        return false;
+
+    // Flush all output before forking, so the child doesn't output it again
+    std::fflush(nullptr);
+    const pid_t pid = fork();
+
+    if (pid == 0) {
+        close(pipeFds[0]);
+        runWorkerProcess(demos, firstDemoIdx, demoIdxStride, pipeFds[1]);
+    }
+
+    close(pipeFds[1]);
+
+    if (pid < 0) {
+        close(pipeFds[0]);
+        return false;
+    }
+
+    worker.pid = pid;
+    worker.readFd = pipeFds[0];
+    worker.nextDemoIdx = firstDemoIdx;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Handles a worker process finishing: if the worker didn't run all of its demos then the demo it was running is marked as crashed.
+// In that case a new worker is started to run the remaining demos for the worker.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void onWorkerFinished(Worker& worker, std::vector<DemoEntry>& demos, const uint32_t demoIdxStride) noexcept {
+    close(worker.readFd);
+
+    int waitStatus = 0;
+    while ((waitpid(worker.pid, &waitStatus, 0) < 0) && (errno == EINTR)) {}
+
+    worker.pid = -1;
+    worker.readFd = -1;
+
+    if (worker.nextDemoIdx >= demos.size())
+        return;
+
+    DemoEntry& crashedDemo = demos[worker.nextDemoIdx];
+    crashedDemo.status = DemoStatus::CRASHED;
+    std::printf("Demo batch: the game terminated while playing demo '%s'!\n", crashedDemo.demoFilePath.c_str());
+
+    const uint32_t nextDemoIdx = worker.nextDemoIdx + demoIdxStride;
+
+    if (nextDemoIdx < demos.size()) {
+        startWorker(worker, demos, nextDemoIdx, demoIdxStride);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Runs all of the demos using the specified number of worker processes, which are forked from the current process.
+// Returns 'false' if no worker processes could be started.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool runDemosInWorkers(std::vector<DemoEntry>& demos, const uint32_t numWorkers) noexcept {
+    // Start all the workers: give up on this method of running demos if none can be started
+    std::vector<Worker> workers(numWorkers, Worker{ -1, -1, 0 });
+    uint32_t numWorkersStarted = 0;
+
+    for (uint32_t i = 0; i < numWorkers; ++i) {
+        numWorkersStarted += (startWorker(workers[i], demos, i, numWorkers)) ? 1 : 0;
+    }
+
+    if (numWorkersStarted == 0)
+        return false;
+
+    // Collect results from the workers until they are all done
+    std::vector<pollfd> pollFds;
+    std::vector<uint32_t> pollWorkerIndexes;
+
+    while (true) {
+        pollFds.clear();
+        pollWorkerIndexes.clear();
+
+        for (uint32_t i = 0; i < numWorkers; ++i) {
+            if (workers[i].pid >= 0) {
+                pollFds.push_back(pollfd{ workers[i].readFd, POLLIN, 0 });
+                pollWorkerIndexes.push_back(i);
+            }
+        }
+
+        if (pollFds.empty())
+            break;
+
+        if (poll(pollFds.data(), (nfds_t) pollFds.size(), -1) < 0) {
+            if (errno == EINTR)
+                continue;
+
+            break;
+        }
+
+        for (size_t i = 0; i < pollFds.size(); ++i) {
+            if (pollFds[i].revents == 0)
+                continue;
+
+            // Note: result messages are smaller than 'PIPE_BUF' so they are always written and read in their entirety
+            Worker& worker = workers[pollWorkerIndexes[i]];
+            WorkerMsg msg = {};
+            const ssize_t numBytesRead = read(worker.readFd, &msg, sizeof(msg));
+
+            if ((numBytesRead < 0) && (errno == EINTR))
+                continue;
+
+            if ((numBytesRead == (ssize_t) sizeof(msg)) && (msg.demoIdx < demos.size())) {
+                demos[msg.demoIdx].status = msg.status;
+                worker.nextDemoIdx = msg.demoIdx + numWorkers;
+            } else {
+                onWorkerFinished(worker, demos, numWorkers);
+            }
+        }
+    }
+
+    // If anything went wrong with polling then make sure all workers are stopped
+    for (Worker& worker : workers) {
+        if (worker.pid >= 0) {
+            kill(worker.pid, SIGKILL);
+            worker.nextDemoIdx = (uint32_t) demos.size();
+            onWorkerFinished(worker, demos, numWorkers);
+        }
+    }
+
+    return true;
+}
+
+#endif  // #if !_WIN32
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes the results for all demos to the specified json report file.
+// Returns 'false' on failure.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool writeReport(const char* const reportFilePath, const std::vector<DemoEntry>& demos) noexcept {
+    // Count the results of each type
+    uint32_t numPassed = 0;
+    uint32_t numFailed = 0;
+    uint32_t numCrashed = 0;
+
+    for (const DemoEntry& demo : demos) {
+        numPassed += (demo.status == DemoStatus::PASSED) ? 1 : 0;
+        numFailed += (demo.status == DemoStatus::FAILED) ? 1 : 0;
+        numCrashed += (demo.status == DemoStatus::CRASHED) ? 1 : 0;
+    }
+
+    // Build the json document
+    rapidjson::Document document;
+    rapidjson::Document::AllocatorType& allocator = document.GetAllocator();
+    document.SetObject();
+    document.AddMember("numDemos", (uint32_t) demos.size(), allocator);
+    document.AddMember("numPassed", numPassed, allocator);
+    document.AddMember("numFailed", numFailed, allocator);
+    document.AddMember("numCrashed", numCrashed, allocator);
+    document.AddMember("allPassed", (numPassed == demos.size()), allocator);
+
+    rapidjson::Value resultsJson(rapidjson::kArrayType);
+
+    for (const DemoEntry& demo : demos) {
+        rapidjson::Value demoJson(rapidjson::kObjectType);
+        demoJson.AddMember("demo", rapidjson::Value(demo.demoFilePath.c_str(), allocator), allocator);
+        demoJson.AddMember("result", rapidjson::Value(demo.resultFilePath.c_str(), allocator), allocator);
+        demoJson.AddMember("status", rapidjson::StringRef(getStatusString(demo.status)), allocator);
+        resultsJson.PushBack(demoJson, allocator);
+    }
+
+    document.AddMember("results", resultsJson, allocator);
+
+    // Write the report to the given file
+    std::FILE* const pFile = std::fopen(reportFilePath, "w");
+
+    if (!pFile)
+        return false;
+
+    auto closeFile = finally([&]() noexcept {
+        std::fflush(pFile);
+        std::fclose(pFile);
+    });
+
+    try {
+        char writeBuffer[4096];
+        rapidjson::FileWriteStream writeStream(pFile, writeBuffer, C_ARRAY_SIZE(writeBuffer));
+        rapidjson::PrettyWriter<rapidjson::FileWriteStream> fileWriter(writeStream);
+        document.Accept(fileWriter);
+    } catch (...) {
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Runs all of the demos in the specified manifest file, checks their results and saves a report of the results to the given file.
+// Returns 'true' if all the demos in the batch passed and the report was written successfully.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool run(const char* const manifestFilePath, const char* const reportFilePath) noexcept {
+    // Read the list of demos to run
+    std::vector<DemoEntry> demos;
+
+    if (!readManifest(manifestFilePath, demos))
+        return false;
+
+    // Decide how many worker processes to use: by default use one per CPU thread
+    const uint32_t numCpuThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    const uint32_t numWorkersWanted = (ProgArgs::gNumBatchDemoWorkers > 0) ? (uint32_t) ProgArgs::gNumBatchDemoWorkers : numCpuThreads;
+    const uint32_t numWorkers = std::min(numWorkersWanted, (uint32_t) demos.size());
+
+    // Run all the demos, falling back to running them in this process if worker processes are not supported or can't be started
+    std::printf("Demo batch: running %u demo(s) using %u worker(s)...\n", (unsigned) demos.size(), (unsigned) std::max(numWorkers, 1u));
+
+    #if _WIN32
+        runDemosInProcess(demos);
+    #else
+        if ((numWorkers <= 1) || (!runDemosInWorkers(demos, numWorkers))) {
+            runDemosInProcess(demos);
+        }
+    #endif
+
+    // Print a summary, save the report and return whether all demos passed
+    uint32_t numPassed = 0;
+
+    for (const DemoEntry& demo : demos) {
+        if (demo.status == DemoStatus::PASSED) {
+            numPassed++;
+        } else {
+            std::printf("Demo batch: %s: %s\n", getStatusString(demo.status), demo.demoFilePath.c_str());
+        }
+    }
+
+    std::printf("Demo batch: %u of %u demo(s) passed.\n", (unsigned) numPassed, (unsigned) demos.size());
+
+    if (!writeReport(reportFilePath, demos)) {
+        std::printf("Demo batch: unable to write the report file '%s'!\n", reportFilePath);
+        return false;
+    }
+
+    return (numPassed == demos.size());
+}
+
+END_NAMESPACE(DemoBatchRunner)
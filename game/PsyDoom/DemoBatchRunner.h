@@ -0,0 +1,9 @@
+#pragma once
+
+#include "Macros.h"
+
+BEGIN_NAMESPACE(DemoBatchRunner)
+
+bool run(const char* const manifestFilePath, const char* const reportFilePath) noexcept;
+
+END_NAMESPACE(DemoBatchRunner)
@@ -1,6 +1,10 @@
 //------------------------------------------------------------------------------------------------------------------------------------------
 // A module responsible for much of the logic relating to demo playback.
 // This includes emulation of the original game's demo playback (classic demos) and also PsyDoom's new extended demo format.
+//
+// Demos being watched can also be seeked through with the left and right arrow keys. As a demo plays, a keyframe snapshot of the game
+// state is taken every few seconds. Seeking restores the nearest keyframe before the target time and then fast forwards from there,
+// with no drawing or audio, until the target time is reached. Keyframes are captured on the way, so a later seek is quick.
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "DemoPlayer.h"
 
@@ -15,10 +19,16 @@
 #include "Doom/Renderer/r_main.h"
 #include "Doom/UI/errormenu_main.h"
 #include "Game.h"
+#include "Input.h"
 #include "MapHash.h"
+#include "ProgArgs.h"
+#include "SaveAndLoad.h"
 #include "SaveDataTypes.h"
+#include "TimeDemo.h"
 
 #include <cstring>
+#include <SDL.h>
+#include <vector>
 
 using namespace DemoCommon;
 
@@ -30,6 +40,27 @@ static int32_t          gPrevPsxMouseSensitivity;                   // The previ
 static DemoFormat       gPlayingDemoFormat;                         // Which format of demo is currently being played
 static DemoTickInputs   gPrevTickInputs[MAXPLAYERS];                // The previous inputs of each player: used to avoid encoding repeats
 
+// How often a keyframe snapshot is taken for seeking and how far each seek moves, in seconds
+static constexpr int32_t KEYFRAME_INTERVAL_SECS = 10;
+static constexpr int32_t SEEK_STEP_SECS = 10;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A snapshot of demo playback, taken just before reading the inputs for a tick, so that playback can resume from that point later.
+// Holds the game state along with the demo reading position and the inputs state that is not part of the game state.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct SeekKeyframe {
+    int32_t                 ticCon;                             // Value of 'gTicCon' when the keyframe was taken (time in vblanks)
+    size_t                  demoOffset;                         // Offset of the next tick's inputs in the demo buffer
+    DemoTickInputs          prevTickInputs[MAXPLAYERS];         // Saved 'gPrevTickInputs'
+    TickInputs              oldTickInputs[MAXPLAYERS];          // Saved 'gOldTickInputs'
+    uint32_t                oldTicButtons;                      // Saved 'gOldTicButtons'
+    std::vector<std::byte>  snapshot;                           // Game state saved with 'SaveAndLoad::saveSnapshot'
+};
+
+static bool                         gbCanSeek;                  // True if seeking is allowed for the demo being played
+static std::vector<SeekKeyframe>    gSeekKeyframes;             // Keyframes captured for the demo being played, in time order
+static int32_t                      gSeekTgtTicCon = -1;        // If fast forwarding, the time ('gTicCon') to fast forward to, otherwise '-1'
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Tick inputs for the 'GEC Master Edition' demo format
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -589,6 +620,127 @@ static bool readTickInputs_gecDemoFormat() noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Seeking helper: get the number of vblanks in the given number of seconds
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t secsToVBlanks(const int32_t secs) noexcept {
+    return secs * ((Game::gSettings.bUsePalTimings) ? 50 : VBLANKS_PER_SEC);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Seeking helper: discard all keyframes and stop fast forwarding
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void clearSeekState() noexcept {
+    gSeekKeyframes.clear();
+    gSeekKeyframes.shrink_to_fit();
+    gSeekTgtTicCon = -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Seeking helper: captures a keyframe for the current point in demo playback.
+// If the game state cannot be saved then seeking is disabled for the rest of the demo.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void captureSeekKeyframe() noexcept {
+    SeekKeyframe& keyframe = gSeekKeyframes.emplace_back();
+    keyframe.ticCon = gTicCon;
+    keyframe.demoOffset = (size_t)(gpDemo_p - gpDemoBuffer);
+    std::memcpy(keyframe.prevTickInputs, gPrevTickInputs, sizeof(gPrevTickInputs));
+    std::memcpy(keyframe.oldTickInputs, gOldTickInputs, sizeof(gOldTickInputs));
+    keyframe.oldTicButtons = gOldTicButtons;
+
+    // Save the game state, once to find out how big the snapshot is and again to save it if the first attempt did not fit
+    size_t snapshotSize = 0;
+    bool bSavedOk = SaveAndLoad::saveSnapshot(nullptr, 0, snapshotSize);
+
+    if ((!bSavedOk) && (snapshotSize > 0)) {
+        keyframe.snapshot.resize(snapshotSize);
+        bSavedOk = SaveAndLoad::saveSnapshot(keyframe.snapshot.data(), keyframe.snapshot.size(), snapshotSize);
+    }
+
+    if (!bSavedOk) {
+        gSeekKeyframes.pop_back();
+        gbCanSeek = false;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Seeking helper: resumes demo playback from the given keyframe.
+// Timing for the current frame is kept as-is, since it relates to real time and not to the point in the demo.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool restoreSeekKeyframe(const SeekKeyframe& keyframe) noexcept {
+    const uint32_t totalVBlanks = gTotalVBlanks;
+    const uint32_t lastTotalVBlanks = gLastTotalVBlanks;
+    const uint32_t elapsedVBlanks = gElapsedVBlanks;
+    int32_t playersElapsedVBlanks[MAXPLAYERS];
+    std::memcpy(playersElapsedVBlanks, gPlayersElapsedVBlanks, sizeof(gPlayersElapsedVBlanks));
+
+    if (SaveAndLoad::loadSnapshot(keyframe.snapshot.data(), keyframe.snapshot.size()) != LoadSaveResult::OK)
+        return false;
+
+    gTotalVBlanks = totalVBlanks;
+    gLastTotalVBlanks = lastTotalVBlanks;
+    gElapsedVBlanks = elapsedVBlanks;
+    std::memcpy(gPlayersElapsedVBlanks, playersElapsedVBlanks, sizeof(gPlayersElapsedVBlanks));
+
+    gTicCon = keyframe.ticCon;
+    gpDemo_p = gpDemoBuffer + keyframe.demoOffset;
+    std::memcpy(gPrevTickInputs, keyframe.prevTickInputs, sizeof(gPrevTickInputs));
+    std::memcpy(gOldTickInputs, keyframe.oldTickInputs, sizeof(gOldTickInputs));
+    gOldTicButtons = keyframe.oldTicButtons;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Seeking helper: seeks the given number of vblanks forwards or backwards from the current point in the demo.
+// Jumps to the last keyframe at or before the target time (if that moves playback) and then fast forwards to the target.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void seekBy(const int32_t numVBlanks) noexcept {
+    const int32_t curTicCon = gTicCon;
+    const int32_t tgtTicCon = std::max(curTicCon + numVBlanks, 0);
+    const SeekKeyframe* pKeyframe = nullptr;
+
+    for (const SeekKeyframe& keyframe : gSeekKeyframes) {
+        if (keyframe.ticCon > tgtTicCon)
+            break;
+
+        pKeyframe = &keyframe;
+    }
+
+    const bool bJumpToKeyframe = (pKeyframe && ((tgtTicCon < curTicCon) || (pKeyframe->ticCon > curTicCon)));
+
+    if (bJumpToKeyframe && (!restoreSeekKeyframe(*pKeyframe))) {
+        gbCanSeek = false;
+        gSeekTgtTicCon = -1;
+        return;
+    }
+
+    gSeekTgtTicCon = (gTicCon < tgtTicCon) ? tgtTicCon : -1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Does seeking related updates before reading the inputs for a tick.
+// Ends fast forwarding once the target time is reached, captures keyframes when due and handles seek requests from the user.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void updateSeeking() noexcept {
+    if (!gbCanSeek)
+        return;
+
+    if ((gSeekTgtTicCon >= 0) && (gTicCon >= gSeekTgtTicCon)) {
+        gSeekTgtTicCon = -1;
+    }
+
+    if (gSeekKeyframes.empty() || (gTicCon >= gSeekKeyframes.back().ticCon + secsToVBlanks(KEYFRAME_INTERVAL_SECS))) {
+        captureSeekKeyframe();
+    }
+
+    if (Input::isKeyboardKeyJustPressed(SDL_SCANCODE_LEFT)) {
+        seekBy(-secsToVBlanks(SEEK_STEP_SECS));
+    }
+    else if (Input::isKeyboardKeyJustPressed(SDL_SCANCODE_RIGHT)) {
+        seekBy(secsToVBlanks(SEEK_STEP_SECS));
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // This should be called prior to loading the map.
 // Reads some demo header info and checks that its contents are valid.
@@ -633,6 +785,10 @@ bool onBeforeMapLoad() noexcept {
 // Returns 'false' if the demo should not be played due to some kind of error.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool onAfterMapLoad() noexcept {
+    // Seeking is only for demos being watched, not for demos being checked or benchmarked
+    clearSeekState();
+    gbCanSeek = ((!ProgArgs::gbHeadlessMode) && (!TimeDemo::gbIsTiming));
+
     // This only does stuff for PsyDoom's new demo format!
     if (gPlayingDemoFormat != DemoFormat::PsyDoom)
         return true;
@@ -743,11 +899,20 @@ bool isPlayerTurning30HzCapped() noexcept {
     );
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the demo is being fast forwarded to a seek target, in which case gameplay should not be drawn or heard
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isFastForwarding() noexcept {
+    return (gSeekTgtTicCon >= 0);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Reads the tick inputs for this tick.
 // Returns 'false' if the demo should not be played due to some kind of error.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool readTickInputs() noexcept {
+    updateSeeking();
+
     switch (gPlayingDemoFormat) {
         case DemoFormat::None:      return false;
         case DemoFormat::Classic:   return readTickInputs_classicDemoFormat();
@@ -772,6 +937,8 @@ void onPlaybackDone() noexcept {
     gPrevPsxMouseSensitivity = {};
     std::memset(gPrevPsxCtrlBindings, 0, sizeof(gPrevPsxCtrlBindings));
     gPrevGameSettings = {};
+    gbCanSeek = false;
+    clearSeekState();
 }
 
 END_NAMESPACE(DemoPlayer)
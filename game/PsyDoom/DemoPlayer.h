@@ -21,6 +21,7 @@ bool wasLevelCompleted() noexcept;
 DemoFormat getPlayingDemoFormat() noexcept;
 bool shouldOverrideMapMusicForDemo() noexcept;
 bool isPlayerTurning30HzCapped() noexcept;
+bool isFastForwarding() noexcept;
 bool readTickInputs() noexcept;
 void onPlaybackDone() noexcept;
 
@@ -2,9 +2,12 @@
 // A module responsible for most of the logic relating to demo recording.
 // The demos are recorded in a new format specific to PsyDoom that has greater capabilities than the original format.
 // Improvements include greater timing resolution (30Hz vs 15Hz ticks), analog movement and multiplayer support.
+// Demo data is recorded to memory and handed periodically to a background thread which writes it to the demo file, so that the game
+// tick never has to wait on file I/O.
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "DemoRecorder.h"
 
+#include "ByteVecOutputStream.h"
 #include "DemoCommon.h"
 #include "Doom/Base/i_main.h"
 #include "Doom/d_main.h"
@@ -18,6 +21,11 @@
 #include "Utils.h"
 
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 
 using namespace DemoCommon;
 
@@ -25,9 +33,23 @@ BEGIN_NAMESPACE(DemoRecorder)
 
 typedef std::unique_ptr<FileOutputStream> DemoFilePtr;
 
-static std::string      gDemoFilePath;                  // Path of the demo file being recorded to
-static DemoFilePtr      gpDemoFile;                     // The demo file currently being recorded to
-static DemoTickInputs   gPrevTickInputs[MAXPLAYERS];    // The previous inputs of each player: used to avoid encoding repeats
+// How often recorded demo data is handed to the writer thread to be written to the demo file
+static constexpr std::chrono::seconds WRITE_INTERVAL = std::chrono::seconds(2);
+
+static std::string          gDemoFilePath;                  // Path of the demo file being recorded to
+static DemoFilePtr          gpDemoFile;                     // The demo file currently being recorded to: only used by the writer thread while it runs
+static DemoTickInputs       gPrevTickInputs[MAXPLAYERS];    // The previous inputs of each player: used to avoid encoding repeats
+static ByteVecOutputStream  gRecordedData;                  // Demo data recorded by the game thread that has not yet been handed to the writer thread
+
+static std::chrono::steady_clock::time_point gLastWriteTime;   // When recorded demo data was last handed to the writer thread
+
+// The background thread which writes demo data to the demo file and the state it shares with the game thread
+static std::thread              gWriterThread;
+static std::mutex               gWriterMutex;
+static std::condition_variable  gWriterWakeCV;
+static std::vector<std::byte>   gWriterPendingData;         // Data waiting to be written to the demo file (guarded by 'gWriterMutex')
+static bool                     gbWriterStop;               // Set when the writer thread should write what data is pending and then exit (guarded by 'gWriterMutex')
+static std::atomic<bool>        gbWriterFailed;             // Set by the writer thread if writing to the demo file fails
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Returns the path of the demo file that will be recorded for the current map
@@ -47,46 +69,133 @@ static void openDemoFile() THROWS {
     gpDemoFile = std::make_unique<FileOutputStream>(gDemoFilePath.c_str(), false);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writer thread: writes demo data to the demo file as it is handed over by the game thread, until told to stop
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void writerThreadMain() noexcept {
+    std::vector<std::byte> dataToWrite;
+
+    while (true) {
+        // Wait for some data to write or to be told to stop, then take whatever data is pending
+        bool bStop;
+
+        {
+            std::unique_lock<std::mutex> lock(gWriterMutex);
+            gWriterWakeCV.wait(lock, []() noexcept { return (gbWriterStop || (!gWriterPendingData.empty())); });
+            dataToWrite.swap(gWriterPendingData);
+            bStop = gbWriterStop;
+        }
+
+        // Write the data, unless a previous write failed
+        if ((!dataToWrite.empty()) && (!gbWriterFailed)) {
+            try {
+                gpDemoFile->writeBytes(dataToWrite.data(), dataToWrite.size());
+            } catch (...) {
+                gbWriterFailed = true;
+            }
+        }
+
+        dataToWrite.clear();
+
+        if (bStop)
+            break;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Starts up the background thread that writes demo data to the demo file
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void startWriterThread() noexcept {
+    ASSERT(!gWriterThread.joinable());
+    gWriterPendingData.clear();
+    gbWriterStop = false;
+    gbWriterFailed = false;
+    gWriterThread = std::thread(writerThreadMain);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells the writer thread to write all pending data and waits for it to exit.
+// Once this returns, the game thread is free to use the demo file again.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void stopWriterThread() noexcept {
+    if (!gWriterThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(gWriterMutex);
+        gbWriterStop = true;
+    }
+
+    gWriterWakeCV.notify_one();
+    gWriterThread.join();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Hands all demo data recorded so far to the writer thread, to be written to the demo file
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void handRecordedDataToWriter() noexcept {
+    std::vector<std::byte>& recordedData = gRecordedData.getBytes();
+    gLastWriteTime = std::chrono::steady_clock::now();
+
+    if (recordedData.empty())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(gWriterMutex);
+
+        // Note: swapping the vectors when possible so their memory is reused for the next round of recording
+        if (gWriterPendingData.empty()) {
+            gWriterPendingData.swap(recordedData);
+        } else {
+            gWriterPendingData.insert(gWriterPendingData.end(), recordedData.begin(), recordedData.end());
+        }
+    }
+
+    gRecordedData.reset();
+    gWriterWakeCV.notify_one();
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Closes up the current demo file and therefore ends recording
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void closeDemoFile() noexcept {
+    stopWriterThread();
+    gRecordedData.reset();
     gDemoFilePath.clear();
     gpDemoFile.reset();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Writes the demo file header.
+// Writes the demo file header to the recorded demo data.
 // This includes all the information about the game and the starting state for all players.
-// Note: expects the demo file to be open for writing!
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void writeDemoHeader() THROWS {
-    ASSERT(gpDemoFile);
+    OutputStream& out = gRecordedData;
 
     // Begin the demo with a 32-bit integer set to '-1'.
     // This is a signature to distinguish the new demo lump format from the old one.
     // In the old demo format this integer was the 'skill' field.
-    gpDemoFile->write<int32_t>(Endian::hostToLittle(-1));
+    out.write<int32_t>(Endian::hostToLittle(-1));
 
     // Record the current demo file version
-    gpDemoFile->write<uint32_t>(Endian::hostToLittle(DEMO_FILE_VERSION));
+    out.write<uint32_t>(Endian::hostToLittle(DEMO_FILE_VERSION));
 
     // Record the skill, map number, whether this is multiplayer and which player the demo is being played for
-    gpDemoFile->write<int32_t>(Endian::hostToLittle(gGameSkill));
-    gpDemoFile->write<int32_t>(Endian::hostToLittle(gGameMap));
-    gpDemoFile->write<int32_t>(Endian::hostToLittle(gNetGame));
-    gpDemoFile->write<int32_t>(Endian::hostToLittle(gCurPlayerIndex));
+    out.write<int32_t>(Endian::hostToLittle(gGameSkill));
+    out.write<int32_t>(Endian::hostToLittle(gGameMap));
+    out.write<int32_t>(Endian::hostToLittle(gNetGame));
+    out.write<int32_t>(Endian::hostToLittle(gCurPlayerIndex));
 
     // Record the game settings
     {
         GameSettings settings = Game::gSettings;
         settings.endianCorrect();
-        gpDemoFile->write(settings);
+        out.write(settings);
     }
 
     // Record the hash of the map being played so we can verify the same map is being played for the demo
-    gpDemoFile->write<uint64_t>(Endian::hostToLittle(MapHash::gWord1));
-    gpDemoFile->write<uint64_t>(Endian::hostToLittle(MapHash::gWord2));
+    out.write<uint64_t>(Endian::hostToLittle(MapHash::gWord1));
+    out.write<uint64_t>(Endian::hostToLittle(MapHash::gWord2));
 
     // Record details for all the players starting the game, including health and ammo etc.
     const int32_t numPlayers = (gNetGame != gt_single) ? 2 : 1;
@@ -96,25 +205,25 @@ static void writeDemoHeader() THROWS {
         SavedPlayerT player = {};
         player.serializeFrom(gPlayers[playerIdx]);
         DemoCommon::endianCorrect(player);
-        gpDemoFile->write(player);
+        out.write(player);
     }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Writes the specified 'DemoTickInputs' structure to the demo file
+// Writes the specified 'DemoTickInputs' structure to the recorded demo data
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void writeTickInputs(const DemoTickInputs& tickInputs) noexcept {
+static void writeTickInputs(const DemoTickInputs& tickInputs) THROWS {
     ASSERT(isRecording());
 
     if constexpr (Endian::isLittle()) {
         // Little endian CPU: just write the inputs as-is
-        gpDemoFile->write(tickInputs);
+        gRecordedData.write(tickInputs);
     }
     else {
         // Big endian CPU: have to convert the tick inputs to little endian before writing
         DemoTickInputs tickInputsLE = tickInputs;
         tickInputsLE.byteSwap();
-        gpDemoFile->write(tickInputsLE);
+        gRecordedData.write(tickInputsLE);
     }
 }
 
@@ -138,7 +247,7 @@ static void handleDemoWriteError() noexcept {
     closeDemoFile();
 
     // Issue a fatal error to let the user know about the problem
-    I_Error("Error writing to demo file '%s'!", gDemoFilePath.c_str());
+    I_Error("Error writing to demo file '%s'!", demoPath.c_str());
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -150,6 +259,8 @@ void begin() noexcept {
         openDemoFile();
         writeDemoHeader();
         initPrevTickInputs();
+        startWriterThread();
+        handRecordedDataToWriter();
     } catch (...) {
         handleDemoWriteError();
     }
@@ -162,7 +273,14 @@ void begin() noexcept {
 void end() noexcept {
     ASSERT(isRecording());
 
+    // Write out all remaining data and wait for the writer thread to finish, then the demo file can be flushed here
+    handRecordedDataToWriter();
+    stopWriterThread();
+
     try {
+        if (gbWriterFailed)
+            throw OutputStream::StreamException();
+
         gpDemoFile->flush();
         closeDemoFile();
     } catch (...) {
@@ -213,7 +331,7 @@ void recordTick() noexcept {
 
     // Write the status byte followed by the inputs if they have changed
     try {
-        gpDemoFile->write(statusByte);
+        gRecordedData.write(statusByte);
 
         if (statusByte & 0x80) {
             writeTickInputs(p1Inputs);
@@ -230,6 +348,15 @@ void recordTick() noexcept {
     // Remember the current inputs as the previous ones
     gPrevTickInputs[0] = p1Inputs;
     gPrevTickInputs[1] = p2Inputs;
+
+    // Periodically hand what was recorded to the writer thread, and stop recording if it failed to write earlier data
+    if (gbWriterFailed) {
+        handleDemoWriteError();
+    }
+
+    if (std::chrono::steady_clock::now() - gLastWriteTime >= WRITE_INTERVAL) {
+        handRecordedDataToWriter();
+    }
 }
 
 END_NAMESPACE(DemoRecorder)
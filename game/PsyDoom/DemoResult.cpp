@@ -207,6 +207,57 @@ static bool verifyPlayerMatchesJson(player_t& player, const rapidjson::Value& pl
     );
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Mixes the attributes of the specified player which are saved in the demo result into the given FNV-1a hash
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void addPlayerToHash(uint64_t& hash, const player_t& player) noexcept {
+    const auto addToHash = [&](const int32_t value) noexcept {
+        for (uint32_t byteIdx = 0; byteIdx < 4; ++byteIdx) {
+            hash ^= (uint8_t)((uint32_t) value >> (byteIdx * 8));
+            hash *= 0x100000001B3ull;
+        }
+    };
+
+    const mobj_t& mobj = *player.mo;
+    addToHash(mobj.x.value);
+    addToHash(mobj.y.value);
+    addToHash(mobj.z.value);
+    addToHash((int32_t) mobj.angle);
+    addToHash(mobj.momx);
+    addToHash(mobj.momy);
+    addToHash(mobj.momz);
+    addToHash(player.health);
+    addToHash(player.armorpoints);
+    addToHash(player.armortype);
+
+    for (int32_t i = 0; i < NUMPOWERS; ++i) {
+        addToHash(player.powers[i]);
+    }
+
+    for (int32_t i = 0; i < NUMCARDS; ++i) {
+        addToHash((int32_t) player.cards[i]);
+    }
+
+    addToHash((int32_t) player.backpack);
+    addToHash((int32_t) player.readyweapon);
+
+    for (int32_t i = 0; i < NUMWEAPONS; ++i) {
+        addToHash((int32_t) player.weaponowned[i]);
+    }
+
+    for (int32_t i = 0; i < NUMAMMO; ++i) {
+        addToHash(player.ammo[i]);
+    }
+
+    addToHash(player.killcount);
+    addToHash(player.itemcount);
+    addToHash(player.secretcount);
+
+    if (gNetGame == gt_deathmatch) {
+        addToHash(player.frags);
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Save the demo result consisting of the the player's main attributes to the given json file.
 // Returns 'false' on failure to save.
@@ -277,4 +328,19 @@ bool verifyMatchesJsonFileResult(const char* const jsonFilePath) noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Computes a hash of the current demo result, consisting of the same player attributes that are saved to json files.
+// Useful for quickly checking whether two runs of the game logic ended up in the same state.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint64_t computeStateHash() noexcept {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    addPlayerToHash(hash, gPlayers[0]);
+
+    if (gNetGame != gt_single) {
+        addPlayerToHash(hash, gPlayers[1]);
+    }
+
+    return hash;
+}
+
 END_NAMESPACE(EndResult)
@@ -2,9 +2,12 @@
 
 #include "Macros.h"
 
+#include <cstdint>
+
 BEGIN_NAMESPACE(DemoResult)
 
 bool saveToJsonFile(const char* const jsonFilePath) noexcept;
 bool verifyMatchesJsonFileResult(const char* const jsonFilePath) noexcept;
+uint64_t computeStateHash() noexcept;
 
 END_NAMESPACE(DemoResult)
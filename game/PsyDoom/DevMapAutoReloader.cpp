@@ -1,13 +1,15 @@
 //------------------------------------------------------------------------------------------------------------------------------------------
 // A developer feature that automatically does an 'in-place' reload of the current map if all of the following criteria are true:
-// 
+//
 //  (1) The game mode is single player.
 //  (2) The current map being played is sourced from a real file on disc, via the file overrides mechanism.
 //      Changes to files within a CD image are NOT monitored.
 //  (3) The auto-reload feature is enabled.
-//  (4) The file has been modified since we last checked.
-//  (5) The platform is Windows. This feature is currently not supported on MacOS due to the '<filesystem>'
-//      API not being available until later OS versions.
+//  (4) The file has been modified since we last checked and its contents have actually changed.
+//
+// Where possible the folder containing the map file is watched using the OS file change notification APIs (inotify on Linux,
+// directory change notifications on Windows) so that the file only needs to be checked when something has actually been written.
+// On other platforms, or if setting up the watch fails, the file's timestamp is polled instead at a fixed interval.
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "DevMapAutoReloader.h"
 
@@ -15,66 +17,203 @@
 #include "Config/Config.h"
 #include "Doom/cdmaptbl.h"
 #include "Doom/Game/g_game.h"
+#include "FileUtils.h"
 #include "ModMgr.h"
 #include "ProgArgs.h"
 
+#include <chrono>
+#include <cstring>
+#include <md5.h>
 #include <string>
 
-// Is the auto reloader available on this platform?
-#if __APPLE__
-    #define ENABLE_MAP_AUTO_RELOADER 0
-#else
-    #define ENABLE_MAP_AUTO_RELOADER 1
-    #include <filesystem>
+#if __linux__
+    #include <cerrno>
+    #include <strings.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#elif _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
 #endif
 
 BEGIN_NAMESPACE(DevMapAutoReloader)
 
-#if ENABLE_MAP_AUTO_RELOADER
-    static std::filesystem::path            gMapFilePath;
-    static std::filesystem::file_time_type  gLastMapFileModifiedTime;
+// How often to poll the map file for changes when OS file change notifications are not available
+static constexpr auto POLL_INTERVAL = std::chrono::milliseconds(500);
+
+static std::string                                  gMapFilePath;           // Path to the map file being watched
+static std::string                                  gMapFileName;           // Name of the map file being watched, without the folder
+static int64_t                                      gLastMapFileModTime;    // Modified timestamp of the map file when it was last checked
+static uint8_t                                      gMapFileMd5[16];        // MD5 of the map file contents when it was last loaded
+static std::chrono::steady_clock::time_point        gLastPollTime;          // When the map file was last polled for changes (if polling)
+
+#if __linux__
+    static int gInotifyFd = -1;     // Inotify instance watching the folder containing the map file, or '-1' if none
+#elif _WIN32
+    static HANDLE gDirChangeHandle = INVALID_HANDLE_VALUE;  // Change notification handle for the folder containing the map file
 #endif
 
-#if ENABLE_MAP_AUTO_RELOADER
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Get the 'modified' timestamp for the current map file.
-// Returns the default timestamp on an error.
+// Computes the MD5 hash of the current contents of the map file and saves it to the given output.
+// Returns 'false' if the file could not be read.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool computeMapFileMd5(uint8_t md5Out[16]) noexcept {
+    const FileData fileData = FileUtils::getContentsOfFile(gMapFilePath.c_str());
+
+    if (!fileData.bytes)
+        return false;
+
+    MD5 md5Hasher;
+    md5Hasher.add(fileData.bytes.get(), fileData.size);
+    md5Hasher.getHash(md5Out);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to start watching the folder containing the map file for changes using the OS file change notification APIs.
+// If this fails (or is not supported on this platform) then the map file will be polled for changes instead.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static std::filesystem::file_time_type queryMapFileModifiedTime() noexcept {
-    try {
-        return std::filesystem::last_write_time(gMapFilePath);
-    } catch (...) {
-        return {};
+static void startWatchingMapFolder() noexcept {
+    std::string folderPath;
+    FileUtils::getParentPath(gMapFilePath.c_str(), folderPath);
+
+    if (folderPath.empty()) {
+        folderPath = "./";
     }
+
+    #if __linux__
+        gInotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+
+        if (gInotifyFd < 0)
+            return;
+
+        // Note: the folder is watched rather than the file itself since many editors save by writing a new file and renaming it
+        if (inotify_add_watch(gInotifyFd, folderPath.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE) < 0) {
+            close(gInotifyFd);
+            gInotifyFd = -1;
+        }
+    #elif _WIN32
+        gDirChangeHandle = FindFirstChangeNotificationA(
+            folderPath.c_str(),
+            FALSE,
+            FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_SIZE
+        );
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stops watching the folder containing the map file, if it is being watched
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void stopWatchingMapFolder() noexcept {
+    #if __linux__
+        if (gInotifyFd >= 0) {
+            close(gInotifyFd);
+            gInotifyFd = -1;
+        }
+    #elif _WIN32
+        if (gDirChangeHandle != INVALID_HANDLE_VALUE) {
+            FindCloseChangeNotification(gDirChangeHandle);
+            gDirChangeHandle = INVALID_HANDLE_VALUE;
+        }
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the map file might have been changed since the last call.
+// When the map folder is being watched this only checks for pending change notifications, otherwise it polls at a fixed interval.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool checkForPossibleMapFileChange() noexcept {
+    #if __linux__
+        if (gInotifyFd >= 0) {
+            // Drain all pending events and see if any of them relate to the map file
+            bool bMapFileChanged = false;
+            alignas(inotify_event) char eventBuffer[4096];
+
+            while (true) {
+                const ssize_t numBytesRead = read(gInotifyFd, eventBuffer, sizeof(eventBuffer));
+
+                if (numBytesRead <= 0)
+                    break;
+
+                for (ssize_t offset = 0; offset < numBytesRead;) {
+                    const inotify_event& event = *(const inotify_event*)(eventBuffer + offset);
+
+                    if ((event.len > 0) && (strcasecmp(event.name, gMapFileName.c_str()) == 0)) {
+                        bMapFileChanged = true;
+                    }
+
+                    offset += (ssize_t) sizeof(inotify_event) + event.len;
+                }
+            }
+
+            return bMapFileChanged;
+        }
+    #elif _WIN32
+        if (gDirChangeHandle != INVALID_HANDLE_VALUE) {
+            // Note: this notification is for any file in the folder, so the map file timestamp needs to be checked after
+            if (WaitForSingleObject(gDirChangeHandle, 0) != WAIT_OBJECT_0)
+                return false;
+
+            if (!FindNextChangeNotification(gDirChangeHandle)) {
+                stopWatchingMapFolder();
+            }
+
+            return true;
+        }
+    #endif
+
+    // No OS file change notifications available: poll the file at a fixed interval instead
+    const auto now = std::chrono::steady_clock::now();
+
+    if (now - gLastPollTime < POLL_INTERVAL)
+        return false;
+
+    gLastPollTime = now;
+    return true;
 }
-#endif
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes the map auto-reloader.
 // This should be called when the map is initially loaded.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void init([[maybe_unused]] const CdFileId mapWadFile) noexcept {
-    #if ENABLE_MAP_AUTO_RELOADER
-        // Ignore if this feature is disabled
-        if (!Config::gbEnableDevMapAutoReload)
-            return;
+void init(const CdFileId mapWadFile) noexcept {
+    // Ignore if this feature is disabled
+    if (!Config::gbEnableDevMapAutoReload)
+        return;
 
-        // Ignore the call if the current game mode is multiplayer
-        if (gNetGame != gt_single)
-            return;
+    // Ignore the call if the current game mode is multiplayer
+    if (gNetGame != gt_single)
+        return;
 
-        // No overrides for this wad file? The file watched must be a real file on disk.
-        if (!ModMgr::areOverridesAvailableForFile(mapWadFile))
-            return;
+    // No overrides for this wad file? The file watched must be a real file on disk.
+    if (!ModMgr::areOverridesAvailableForFile(mapWadFile))
+        return;
 
-        // Make up the path to the overriden file
-        const auto mapWadFileName = mapWadFile.c_str();
-        gMapFilePath = ProgArgs::gDataDirPath;
-        gMapFilePath.append(mapWadFileName.data());
+    // If we are already watching this file (in-place reload) then just update the contents hash, otherwise start watching it
+    const auto mapWadFileName = mapWadFile.c_str();
+    std::string mapFilePath = ProgArgs::gDataDirPath;
 
-        // Get the current modified timestamp
-        gLastMapFileModifiedTime = queryMapFileModifiedTime();
-    #endif
+    if ((!mapFilePath.empty()) && (mapFilePath.back() != '\\') && (mapFilePath.back() != '/')) {
+        mapFilePath += '/';
+    }
+
+    mapFilePath += mapWadFileName.data();
+
+    if (mapFilePath != gMapFilePath) {
+        shutdown();
+        gMapFilePath = std::move(mapFilePath);
+        gMapFileName = mapWadFileName.data();
+        startWatchingMapFolder();
+    }
+
+    // Get the current modified timestamp and contents hash
+    gLastMapFileModTime = FileUtils::getFileModTime(gMapFilePath.c_str());
+    gLastPollTime = std::chrono::steady_clock::now();
+
+    if (!computeMapFileMd5(gMapFileMd5)) {
+        std::memset(gMapFileMd5, 0, sizeof(gMapFileMd5));
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -82,10 +221,11 @@ void init([[maybe_unused]] const CdFileId mapWadFile) noexcept {
 // This should be called when the map is finished.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void shutdown() noexcept {
-    #if ENABLE_MAP_AUTO_RELOADER
-        gMapFilePath.clear();
-        gLastMapFileModifiedTime = {};
-    #endif
+    stopWatchingMapFolder();
+    gMapFilePath.clear();
+    gMapFileName.clear();
+    gLastMapFileModTime = {};
+    std::memset(gMapFileMd5, 0, sizeof(gMapFileMd5));
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -93,19 +233,33 @@ void shutdown() noexcept {
 // It will trigger a reload of the current map if appropriate.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void update() noexcept {
-    #if ENABLE_MAP_AUTO_RELOADER
-        // If we are not watching anything then bail out now
-        if (gMapFilePath.empty())
-            return;
+    // If we are not watching anything then bail out now
+    if (gMapFilePath.empty())
+        return;
 
-        // Check for the map file being modified and start an in-place reload of the map if it's changed
-        const std::filesystem::file_time_type modifiedTime = queryMapFileModifiedTime();
+    // Only bother checking the file itself if it might have changed
+    if (!checkForPossibleMapFileChange())
+        return;
 
-        if (modifiedTime > gLastMapFileModifiedTime) {
-            gLastMapFileModifiedTime = modifiedTime;
-            Cheats::doInPlaceReloadCheat();
-        }
-    #endif
+    // Check for the map file being modified
+    const int64_t modTime = FileUtils::getFileModTime(gMapFilePath.c_str());
+
+    if ((modTime < 0) || (modTime == gLastMapFileModTime))
+        return;
+
+    gLastMapFileModTime = modTime;
+
+    // Only reload if the contents of the file have actually changed: saving an unmodified map should not trigger a reload
+    uint8_t newMd5[16];
+
+    if (!computeMapFileMd5(newMd5))
+        return;
+
+    if (std::memcmp(newMd5, gMapFileMd5, sizeof(newMd5)) == 0)
+        return;
+
+    std::memcpy(gMapFileMd5, newMd5, sizeof(newMd5));
+    Cheats::doInPlaceReloadCheat();
 }
 
 END_NAMESPACE(DevMapAutoReloader)
@@ -0,0 +1,299 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A developer feature that automatically reloads wall textures, flats and sprites from user WAD files when those files change on-disk.
+// Unlike 'DevMapAutoReloader' this does not restart the level, only the lumps which actually changed are reloaded and re-uploaded:
+//
+//  (1) Only WADs which are real files on disk are watched: WADs within the game disc never change.
+//  (2) The modified WAD must have the same lumps (by name and order) as before, so that existing lump numbers remain valid.
+//  (3) Lumps are compared against a hash of their previous contents to find which ones changed.
+//  (4) Changed sprites are evicted from the texture cache, and get cached again with the new data when next drawn.
+//  (5) Changed walls and flats stay where they are in VRAM for the level, so they are only re-uploaded if their size is unchanged.
+//      This is done the same way as for animated textures, by marking them as needing an upload.
+//
+// The WAD files are polled for changes at a fixed interval, and a change is only acted on once the file's timestamp has been stable for
+// one poll interval. This avoids reading a WAD file while it is still being written.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "DevTexAutoReloader.h"
+
+#include "Config/Config.h"
+#include "DecodedTexPool.h"
+#include "Doom/Base/i_texcache.h"
+#include "Doom/Base/w_wad.h"
+#include "Doom/Base/z_zone.h"
+#include "Doom/Game/doomdata.h"
+#include "Doom/Renderer/r_data.h"
+#include "Doom/UI/st_main.h"
+#include "FileUtils.h"
+#include "WadList.h"
+
+#include <chrono>
+#include <cstring>
+#include <vector>
+
+BEGIN_NAMESPACE(DevTexAutoReloader)
+
+// How often to poll the watched WAD files for changes
+static constexpr auto POLL_INTERVAL = std::chrono::milliseconds(500);
+
+// A user WAD file being watched for changes
+struct WatchedWad {
+    int32_t                 wadFileIdx;         // Index of the WAD in the list of main WADs
+    int64_t                 lastModTime;        // Modified timestamp of the WAD file when it was last reloaded (or first watched)
+    int64_t                 pendingModTime;     // Modified timestamp of the WAD file on the last poll: a change is acted on once this is stable
+    std::vector<uint64_t>   lumpHashes;         // Hash of the raw data for each lump in the WAD, as of the last reload
+};
+
+// What happened when trying to reload a lump that has changed
+enum class LumpReloadResult : int32_t {
+    NOT_TEXTURE,        // The lump is not used by any wall, flat or sprite texture so nothing was done
+    RELOADED,           // All textures using the lump were reloaded
+    NEEDS_RESTART       // Some textures using the lump could not be reloaded because their size changed
+};
+
+static std::vector<WatchedWad>                  gWatchedWads;       // The user WAD files being watched
+static std::chrono::steady_clock::time_point    gLastPollTime;      // When the WAD files were last polled for changes
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Computes a 64-bit FNV-1a hash of the raw (possibly compressed) data for each lump in the given WAD file
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void computeLumpHashes(WadFile& wadFile, std::vector<uint64_t>& hashesOut) noexcept {
+    const int32_t numLumps = wadFile.getNumLumps();
+    hashesOut.resize((size_t) numLumps);
+    std::vector<std::byte> lumpData;
+
+    for (int32_t lumpIdx = 0; lumpIdx < numLumps; ++lumpIdx) {
+        const int32_t rawSize = wadFile.getRawSize(lumpIdx);
+        uint64_t hash = 0xCBF29CE484222325;
+
+        if (rawSize > 0) {
+            lumpData.resize((size_t) rawSize);
+            wadFile.readLump(lumpIdx, lumpData.data(), false);
+
+            for (const std::byte b : lumpData) {
+                hash ^= (uint64_t) b;
+                hash *= 0x100000001B3;
+            }
+        }
+
+        hashesOut[lumpIdx] = hash;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds all textures in the given list which use the specified lump to the output list
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void gatherTexturesUsingLump(
+    texture_t* const pTextures,
+    const int32_t numTextures,
+    const int32_t lumpIdx,
+    std::vector<texture_t*>& texturesOut
+) noexcept {
+    if (!pTextures)
+        return;
+
+    for (int32_t i = 0; i < numTextures; ++i) {
+        if (pTextures[i].lumpNum == lumpIdx) {
+            texturesOut.push_back(&pTextures[i]);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reloads the specified main WAD lump, whose data has changed, and updates any wall, flat or sprite textures which use it.
+// Lumps which are not used by textures are left alone, since other data (palettes etc.) is held onto in various other ways.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static LumpReloadResult reloadChangedLump(const int32_t lumpIdx) noexcept {
+    // Find all the textures which use this lump, if any
+    std::vector<texture_t*> wallsAndFlats;
+    std::vector<texture_t*> sprites;
+    gatherTexturesUsingLump(gpTextures, gNumTexLumps, lumpIdx, wallsAndFlats);
+    gatherTexturesUsingLump(gpFlatTextures, gNumFlatLumps, lumpIdx, wallsAndFlats);
+    gatherTexturesUsingLump(gpSpriteTextures, gNumSpriteLumps, lumpIdx, sprites);
+
+    if (wallsAndFlats.empty() && sprites.empty())
+        return LumpReloadResult::NOT_TEXTURE;
+
+    // Remember how the lump was cached and then purge the old data for it, including any decompressed data in the decoded texture pool.
+    // When the lump is next cached it will be read from the modified WAD file.
+    const WadLump& lump = W_GetLump(lumpIdx);
+    const bool bWasCached = (lump.pCachedData != nullptr);
+    const int16_t cacheTag = (bWasCached) ? Z_GetTag(lump.pCachedData) : PU_CACHE;
+    const bool bWasDecompressed = (bWasCached && lump.bIsUncompressed);
+
+    W_GetMainWadList().purgeCachedLump(lumpIdx);
+    DecodedTexPool::removeLumpData(lumpIdx);
+
+    // Sprites: evict them from the texture cache, they will be cached again with the new data (and dimensions) when next drawn
+    for (texture_t* const pTex : sprites) {
+        if (pTex->isCached() && pTex->ppTexCacheEntries) {
+            I_RemoveTexCacheEntry(*pTex);
+        }
+
+        pTex->uploadFrameNum = TEX_INVALID_UPLOAD_FRAME_NUM;
+    }
+
+    // If there are no walls or flats using the lump then just restore the lump to the cache if it was cached before
+    if (wallsAndFlats.empty()) {
+        if (bWasCached) {
+            W_CacheLumpNum(lumpIdx, cacheTag, bWasDecompressed);
+        }
+
+        return LumpReloadResult::RELOADED;
+    }
+
+    // Walls and flats keep their place in VRAM for the whole level, so they can only be updated in-place if their size is unchanged.
+    // Mark those which are in VRAM as needing an upload, in the same way that animated textures are updated.
+    // Note: cache the lump with the same tag as animated textures so the data can't be purged before it is uploaded.
+    const WadLump& newLump = W_CacheLumpNum(lumpIdx, PU_ANIMATION, true);
+
+    if (newLump.uncompressedSize <= (int32_t) sizeof(texlump_header_t))
+        return LumpReloadResult::NEEDS_RESTART;
+
+    texlump_header_t texHdr;
+    std::memcpy(&texHdr, newLump.pCachedData, sizeof(texHdr));
+    const int16_t newWidth = Endian::littleToHost(texHdr.width);
+    const int16_t newHeight = Endian::littleToHost(texHdr.height);
+    bool bNeedsRestart = false;
+
+    for (texture_t* const pTex : wallsAndFlats) {
+        if (!pTex->isCached())
+            continue;
+
+        if ((pTex->width != newWidth) || (pTex->height != newHeight)) {
+            bNeedsRestart = true;
+            continue;
+        }
+
+        pTex->uploadFrameNum = TEX_INVALID_UPLOAD_FRAME_NUM;
+    }
+
+    return (bNeedsRestart) ? LumpReloadResult::NEEDS_RESTART : LumpReloadResult::RELOADED;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Shows a message on the status bar about the result of a reload
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void showReloadMessage(const char* const message) noexcept {
+    gStatusBar.message = message;
+    gStatusBar.messageTicsLeft = 30;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reloads the specified WAD file after it has changed on-disk, and reloads any textures using lumps which have changed
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void reloadWad(WatchedWad& wad) noexcept {
+    // Re-open the WAD first: this only works if the lumps in the WAD are the same as before
+    WadList& wadList = W_GetMainWadList();
+    WadFile& wadFile = wadList.getWadFile(wad.wadFileIdx);
+
+    if (!wadFile.reopen()) {
+        showReloadMessage("WAD lumps changed! Restart to reload.");
+        return;
+    }
+
+    // See which lumps have changed and reload those
+    std::vector<uint64_t> newLumpHashes;
+    computeLumpHashes(wadFile, newLumpHashes);
+
+    const int32_t firstLumpIdx = wadList.getWadFirstLumpIdx(wad.wadFileIdx);
+    const int32_t numLumps = (int32_t) newLumpHashes.size();
+    bool bReloadedAny = false;
+    bool bNeedsRestart = false;
+
+    for (int32_t i = 0; i < numLumps; ++i) {
+        if (newLumpHashes[i] == wad.lumpHashes[i])
+            continue;
+
+        const LumpReloadResult result = reloadChangedLump(firstLumpIdx + i);
+        bReloadedAny |= (result == LumpReloadResult::RELOADED);
+        bNeedsRestart |= (result == LumpReloadResult::NEEDS_RESTART);
+    }
+
+    wad.lumpHashes = std::move(newLumpHashes);
+
+    if (bNeedsRestart) {
+        showReloadMessage("Texture size changed! Restart level.");
+    } else if (bReloadedAny) {
+        showReloadMessage("Textures reloaded.");
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initializes the texture auto-reloader and starts watching all user WAD files on disk, if the feature is enabled.
+// This should be called after the main WADs are opened.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void init() noexcept {
+    shutdown();
+
+    if (!Config::gbEnableDevTexAutoReload)
+        return;
+
+    WadList& wadList = W_GetMainWadList();
+    const int32_t numWadFiles = wadList.getNumWadFiles();
+
+    for (int32_t wadFileIdx = 0; wadFileIdx < numWadFiles; ++wadFileIdx) {
+        WadFile& wadFile = wadList.getWadFile(wadFileIdx);
+        const std::string& filePath = wadFile.getFilePath();
+
+        if (filePath.empty())
+            continue;
+
+        WatchedWad& wad = gWatchedWads.emplace_back();
+        wad.wadFileIdx = wadFileIdx;
+        wad.lastModTime = FileUtils::getFileModTime(filePath.c_str());
+        wad.pendingModTime = wad.lastModTime;
+        computeLumpHashes(wadFile, wad.lumpHashes);
+    }
+
+    gLastPollTime = std::chrono::steady_clock::now();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Shuts down the texture auto-reloader.
+// This should be called before the main WADs are closed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void shutdown() noexcept {
+    gWatchedWads.clear();
+    gWatchedWads.shrink_to_fit();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// This should be called periodically by the game loop while in a level.
+// It will reload any textures that have changed on-disk, if appropriate.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void update() noexcept {
+    // If we are not watching anything then bail out now
+    if (gWatchedWads.empty())
+        return;
+
+    // Only poll the files at a fixed interval
+    const auto now = std::chrono::steady_clock::now();
+
+    if (now - gLastPollTime < POLL_INTERVAL)
+        return;
+
+    gLastPollTime = now;
+
+    // Check each file for changes.
+    // Wait until the modified timestamp is the same for two polls in a row before reading, in case the file is still being written.
+    WadList& wadList = W_GetMainWadList();
+
+    for (WatchedWad& wad : gWatchedWads) {
+        const std::string& filePath = wadList.getWadFile(wad.wadFileIdx).getFilePath();
+        const int64_t modTime = FileUtils::getFileModTime(filePath.c_str());
+
+        if ((modTime < 0) || (modTime == wad.lastModTime)) {
+            wad.pendingModTime = wad.lastModTime;
+            continue;
+        }
+
+        if (modTime != wad.pendingModTime) {
+            wad.pendingModTime = modTime;
+            continue;
+        }
+
+        wad.lastModTime = modTime;
+        reloadWad(wad);
+    }
+}
+
+END_NAMESPACE(DevTexAutoReloader)
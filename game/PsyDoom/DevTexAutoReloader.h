@@ -0,0 +1,11 @@
+#pragma once
+
+#include "Macros.h"
+
+BEGIN_NAMESPACE(DevTexAutoReloader)
+
+void init() noexcept;
+void shutdown() noexcept;
+void update() noexcept;
+
+END_NAMESPACE(DevTexAutoReloader)
@@ -15,6 +15,7 @@ DiscReader::DiscReader(const DiscInfo& discInfo) noexcept
     , mCurTrackIdx(-1)
     , mCurOffset(0)
     , mpOpenFile(nullptr)
+    , mMappedFile()
 {
 }
 
@@ -49,11 +50,15 @@ bool DiscReader::setTrackNum(int32_t trackNum) noexcept {
     // Open the file for the new track if it's different to the current file
     if ((!mpCurTrack) || (mpCurTrack->sourceFilePath != pTrack->sourceFilePath)) {
         // Need to switch files: close the old track and open the new one
+        // Try to memory map the file first to avoid system calls for seeking and reading, falling back to regular file IO if not possible.
         closeTrack();
-        mpOpenFile = std::fopen(pTrack->sourceFilePath.c_str(), "rb");
 
-        if (!mpOpenFile)
-            return false;
+        if (!mMappedFile.open(pTrack->sourceFilePath.c_str())) {
+            mpOpenFile = std::fopen(pTrack->sourceFilePath.c_str(), "rb");
+
+            if (!mpOpenFile)
+                return false;
+        }
     }
 
     // Success - save the current track number and track!
@@ -76,7 +81,7 @@ bool DiscReader::setTrackNum(int32_t trackNum) noexcept {
 // Is a track currently open for reading?
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool DiscReader::isTrackOpen() noexcept {
-    return (mpOpenFile != nullptr);
+    return ((mpOpenFile != nullptr) || mMappedFile.isOpen());
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -90,6 +95,7 @@ void DiscReader::closeTrack() noexcept {
         mpOpenFile = nullptr;
     }
 
+    mMappedFile.close();
     mCurOffset = 0;
     mCurTrackIdx = -1;
     mpCurTrack = nullptr;
@@ -103,7 +109,7 @@ bool DiscReader::trackSeekAbs(const int32_t offsetAbs) noexcept {
     if (!mpCurTrack)
         return false;
 
-    ASSERT(mpOpenFile);
+    ASSERT(mpOpenFile || mMappedFile.isOpen());
 
     if ((offsetAbs < 0) || (offsetAbs > mpCurTrack->trackPayloadSize))
         return false;
@@ -112,11 +118,14 @@ bool DiscReader::trackSeekAbs(const int32_t offsetAbs) noexcept {
     if (mCurOffset == offsetAbs)
         return true;
 
-    // Do the seek and save the result if successful
-    const int32_t physicalOffset = dataOffsetToPhysical(offsetAbs);
+    // Do the seek and save the result if successful.
+    // If the file is memory mapped then there is no actual seek to do; reads will just use the new offset.
+    if (mpOpenFile) {
+        const int32_t physicalOffset = dataOffsetToPhysical(offsetAbs);
 
-    if (std::fseek((FILE*) mpOpenFile, physicalOffset, SEEK_SET) != 0)
-        return false;
+        if (std::fseek((FILE*) mpOpenFile, physicalOffset, SEEK_SET) != 0)
+            return false;
+    }
 
     mCurOffset = offsetAbs;
     return true;
@@ -130,7 +139,7 @@ bool DiscReader::trackSeekRel(const int32_t offsetRel) noexcept {
     if (!mpCurTrack)
         return false;
 
-    ASSERT(mpOpenFile);
+    ASSERT(mpOpenFile || mMappedFile.isOpen());
     const int32_t newOffset = mCurOffset + offsetRel;
 
     if ((newOffset < 0) || (newOffset > mpCurTrack->trackPayloadSize))
@@ -140,11 +149,14 @@ bool DiscReader::trackSeekRel(const int32_t offsetRel) noexcept {
     if (mCurOffset == newOffset)
         return true;
 
-    // Do the seek and save the result if successful
-    const int32_t physicalOffset = dataOffsetToPhysical(newOffset);
+    // Do the seek and save the result if successful.
+    // If the file is memory mapped then there is no actual seek to do; reads will just use the new offset.
+    if (mpOpenFile) {
+        const int32_t physicalOffset = dataOffsetToPhysical(newOffset);
 
-    if (std::fseek((FILE*) mpOpenFile, physicalOffset, SEEK_SET) != 0)
-        return false;
+        if (std::fseek((FILE*) mpOpenFile, physicalOffset, SEEK_SET) != 0)
+            return false;
+    }
 
     mCurOffset = newOffset;
     return true;
@@ -176,9 +188,21 @@ bool DiscReader::read(void* const pBuffer, const int32_t numBytes) noexcept {
         const int32_t sectorBytesLeft = blockPayloadSize - (mCurOffset % blockPayloadSize);
         const int32_t thisReadSize = std::min(bytesLeft, sectorBytesLeft);
 
-        if (std::fread(pDstBytes, thisReadSize, 1, (FILE*) mpOpenFile) != 1) {
-            std::memset(pBuffer, 0, (size_t) numBytes);
-            return false;
+        if (mpOpenFile) {
+            if (std::fread(pDstBytes, thisReadSize, 1, (FILE*) mpOpenFile) != 1) {
+                std::memset(pBuffer, 0, (size_t) numBytes);
+                return false;
+            }
+        } else {
+            // Memory mapped file: copy straight from the mapping, after making sure the data is in range
+            const uint64_t physicalOffset = (uint64_t) dataOffsetToPhysical(mCurOffset);
+
+            if (physicalOffset + (uint64_t) thisReadSize > mMappedFile.getSize()) {
+                std::memset(pBuffer, 0, (size_t) numBytes);
+                return false;
+            }
+
+            std::memcpy(pDstBytes, mMappedFile.getData() + physicalOffset, (size_t) thisReadSize);
         }
 
         // Read succeeded: seek to the next sector if we have consumed all of this sector's bytes
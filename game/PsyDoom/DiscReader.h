@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Macros.h"
+#include "MappedFile.h"
 
 #include <cstdint>
 
@@ -34,5 +35,6 @@ private:
     const DiscTrack*    mpCurTrack;     // Pointer to the current track open for the disc reader
     int32_t             mCurTrackIdx;   // Current track index in the disc that is open for reading or '-1' if none
     int32_t             mCurOffset;     // Current byte offset in the actual track data we are at (NOT physical offset in the file)
-    void*               mpOpenFile;     // Handle to the open file for the current track
+    void*               mpOpenFile;     // Handle to the open file for the current track, if not memory mapped
+    MappedFile          mMappedFile;    // Memory mapping of the file for the current track: used instead of regular file IO if available
 };
@@ -0,0 +1,237 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frame time statistics: keeps a rolling history of how long recent frames took, split by simulation, CPU rendering, presentation and
+// GPU time. Used to draw a frame time graph along with the performance counters, so that stutters and hitches can be seen and measured.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "FrameStats.h"
+
+#include "Doom/Base/i_drawcmds.h"
+#include "PsyQ/LIBGPU.h"
+#include "Video.h"
+
+#if PSYDOOM_VULKAN_RENDERER
+    #include "Vulkan/VDrawing.h"
+    #include "Vulkan/VRenderer.h"
+    #include "Vulkan/VTypes.h"
+#endif
+
+#include <algorithm>
+
+BEGIN_NAMESPACE(FrameStats)
+
+// How many frames of history are kept and graphed: the graph is 1 pixel wide per frame
+static constexpr uint32_t NUM_HISTORY_FRAMES = 128;
+
+// How many pixels tall each millisecond of frame time is on the graph
+static constexpr float GRAPH_PX_PER_USEC = 1.0f / 1000.0f;
+
+// Frame times marked by reference lines on the graph: 60 Hz and 30 Hz frame times
+static constexpr float GRAPH_REF_LINE_USEC[] = { 1000000.0f / 60.0f, 1000000.0f / 30.0f };
+
+static Clock::duration      gSplitTimes[(size_t) Split::NUM_SPLITS];    // Time spent so far in each split for the current frame
+static FrameTimes           gHistory[NUM_HISTORY_FRAMES];               // Ring buffer of the times for recent frames
+static uint32_t             gHistoryHeadIdx;                            // Where the next frame will be written to in the history
+static uint32_t             gHistorySize;                               // How many valid frames there are in the history
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts a duration to microseconds
+//------------------------------------------------------------------------------------------------------------------------------------------
+static float toMicroseconds(const Clock::duration duration) noexcept {
+    return std::chrono::duration<float, std::micro>(duration).count();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helpers: draw a flat colored rectangle or a line in screen coordinates, using either the Vulkan or classic renderer
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void drawRect(const int32_t x, const int32_t y, const int32_t w, const int32_t h, const uint8_t r, const uint8_t g, const uint8_t b) noexcept {
+    if ((w <= 0) || (h <= 0))
+        return;
+
+    #if PSYDOOM_VULKAN_RENDERER
+        if (Video::isUsingVulkanRenderPath()) {
+            // Only issue draw commands if rendering is allowed!
+            if (VRenderer::isRendering()) {
+                const float lx = (float) x;
+                const float rx = (float)(x + w);
+                const float ty = (float) y;
+                const float by = (float)(y + h);
+
+                VDrawing::setDrawPipeline(VPipelineType::Colored);
+                VDrawing::addFlatColoredQuad(
+                    lx, ty, 0.0f,
+                    rx, ty, 0.0f,
+                    rx, by, 0.0f,
+                    lx, by, 0.0f,
+                    r, g, b
+                );
+            }
+
+            return;
+        }
+    #endif
+
+    POLY_F4 quad = {};
+    LIBGPU_SetPolyF4(quad);
+    LIBGPU_setRGB0(quad, r, g, b);
+    LIBGPU_setXY4(quad,
+        (int16_t) x,        (int16_t) y,
+        (int16_t)(x + w),   (int16_t) y,
+        (int16_t) x,        (int16_t)(y + h),
+        (int16_t)(x + w),   (int16_t)(y + h)
+    );
+
+    I_AddPrim(quad);
+}
+
+static void drawLine(const int32_t x1, const int32_t y1, const int32_t x2, const int32_t y2, const uint8_t r, const uint8_t g, const uint8_t b) noexcept {
+    #if PSYDOOM_VULKAN_RENDERER
+        if (Video::isUsingVulkanRenderPath()) {
+            if (VRenderer::isRendering()) {
+                VDrawing::setDrawPipeline(VPipelineType::Lines);
+                VDrawing::addUILine((float) x1, (float) y1, (float) x2, (float) y2, r, g, b);
+            }
+
+            return;
+        }
+    #endif
+
+    LINE_F2 line = {};
+    LIBGPU_SetLineF2(line);
+    LIBGPU_setRGB0(line, r, g, b);
+    LIBGPU_setXY2(line, (int16_t) x1, (int16_t) y1, (int16_t) x2, (int16_t) y2);
+    I_AddPrim(line);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts a frame time to a bar height on the graph, clamped to the graph height
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t getGraphBarHeight(const float usec) noexcept {
+    return std::clamp((int32_t)(usec * GRAPH_PX_PER_USEC + 0.5f), 0, GRAPH_H);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds time spent in the given split to the current frame
+//------------------------------------------------------------------------------------------------------------------------------------------
+void addSplitTime(const Split split, const Clock::duration duration) noexcept {
+    gSplitTimes[(size_t) split] += duration;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records the end of a frame which took the given number of microseconds overall and begins timing a new one
+//------------------------------------------------------------------------------------------------------------------------------------------
+void endFrame(const float frameUsec) noexcept {
+    // Note: presentation happens inside of the drawer function, so exclude it from the CPU render time
+    const float drawerUsec = toMicroseconds(gSplitTimes[(size_t) Split::Drawer]);
+
+    FrameTimes& frame = gHistory[gHistoryHeadIdx];
+    frame.totalUsec = frameUsec;
+    frame.simUsec = toMicroseconds(gSplitTimes[(size_t) Split::Sim]);
+    frame.presentUsec = toMicroseconds(gSplitTimes[(size_t) Split::Present]);
+    frame.renderUsec = std::max(drawerUsec - frame.presentUsec, 0.0f);
+
+    #if PSYDOOM_VULKAN_RENDERER
+        frame.gpuUsec = (Video::isUsingVulkanRenderPath()) ? VRenderer::getGpuFrameTimeUsec() : -1.0f;
+    #else
+        frame.gpuUsec = -1.0f;
+    #endif
+
+    gHistoryHeadIdx = (gHistoryHeadIdx + 1) % NUM_HISTORY_FRAMES;
+    gHistorySize = std::min(gHistorySize + 1, NUM_HISTORY_FRAMES);
+
+    for (Clock::duration& splitTime : gSplitTimes) {
+        splitTime = {};
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the average and maximum times for each part of the frame over the recorded history.
+// GPU times are '-1' if unavailable for any of the frames.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void getAverageFrameTimes(FrameTimes& avgTimes, FrameTimes& maxTimes) noexcept {
+    avgTimes = {};
+    maxTimes = {};
+
+    if (gHistorySize == 0) {
+        avgTimes.gpuUsec = -1.0f;
+        maxTimes.gpuUsec = -1.0f;
+        return;
+    }
+
+    bool bHaveGpuTimes = true;
+
+    for (uint32_t i = 0; i < gHistorySize; ++i) {
+        const FrameTimes& frame = gHistory[i];
+        avgTimes.totalUsec += frame.totalUsec;
+        avgTimes.simUsec += frame.simUsec;
+        avgTimes.renderUsec += frame.renderUsec;
+        avgTimes.presentUsec += frame.presentUsec;
+        avgTimes.gpuUsec += frame.gpuUsec;
+        maxTimes.totalUsec = std::max(maxTimes.totalUsec, frame.totalUsec);
+        maxTimes.simUsec = std::max(maxTimes.simUsec, frame.simUsec);
+        maxTimes.renderUsec = std::max(maxTimes.renderUsec, frame.renderUsec);
+        maxTimes.presentUsec = std::max(maxTimes.presentUsec, frame.presentUsec);
+        maxTimes.gpuUsec = std::max(maxTimes.gpuUsec, frame.gpuUsec);
+        bHaveGpuTimes &= (frame.gpuUsec >= 0.0f);
+    }
+
+    const float invNumFrames = 1.0f / (float) gHistorySize;
+    avgTimes.totalUsec *= invNumFrames;
+    avgTimes.simUsec *= invNumFrames;
+    avgTimes.renderUsec *= invNumFrames;
+    avgTimes.presentUsec *= invNumFrames;
+    avgTimes.gpuUsec = (bHaveGpuTimes) ? avgTimes.gpuUsec * invNumFrames : -1.0f;
+    maxTimes.gpuUsec = (bHaveGpuTimes) ? maxTimes.gpuUsec : -1.0f;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws a graph of the recent frame times with its top left corner at the given screen position, oldest frames first.
+// Each frame is drawn as a stacked bar of simulation (green), CPU render (yellow) and present (blue) time.
+// The overall frame time is drawn as a white line (red when slower than 30 Hz) and GPU time as a magenta line, where available.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void drawGraph(const int32_t x, const int32_t y) noexcept {
+    const int32_t graphBy = y + GRAPH_H;
+
+    // Draw the background and the reference lines
+    drawRect(x, y, (int32_t) NUM_HISTORY_FRAMES, GRAPH_H, 0, 0, 0);
+
+    for (const float refUsec : GRAPH_REF_LINE_USEC) {
+        const int32_t lineY = graphBy - getGraphBarHeight(refUsec);
+        drawLine(x, lineY, x + (int32_t) NUM_HISTORY_FRAMES - 1, lineY, 64, 64, 64);
+    }
+
+    // Draw the stacked bars for each frame
+    const uint32_t firstFrameIdx = (gHistoryHeadIdx + NUM_HISTORY_FRAMES - gHistorySize) % NUM_HISTORY_FRAMES;
+    const int32_t firstFrameX = x + (int32_t)(NUM_HISTORY_FRAMES - gHistorySize);
+
+    for (uint32_t i = 0; i < gHistorySize; ++i) {
+        const FrameTimes& frame = gHistory[(firstFrameIdx + i) % NUM_HISTORY_FRAMES];
+        const int32_t barX = firstFrameX + (int32_t) i;
+
+        const int32_t simH = getGraphBarHeight(frame.simUsec);
+        const int32_t renderH = getGraphBarHeight(frame.simUsec + frame.renderUsec) - simH;
+        const int32_t presentH = getGraphBarHeight(frame.simUsec + frame.renderUsec + frame.presentUsec) - simH - renderH;
+
+        drawRect(barX, graphBy - simH, 1, simH, 0, 192, 0);
+        drawRect(barX, graphBy - simH - renderH, 1, renderH, 224, 192, 0);
+        drawRect(barX, graphBy - simH - renderH - presentH, 1, presentH, 0, 96, 255);
+    }
+
+    // Draw the lines for overall frame time and GPU time
+    for (uint32_t i = 1; i < gHistorySize; ++i) {
+        const FrameTimes& prevFrame = gHistory[(firstFrameIdx + i - 1) % NUM_HISTORY_FRAMES];
+        const FrameTimes& frame = gHistory[(firstFrameIdx + i) % NUM_HISTORY_FRAMES];
+        const int32_t lineX = firstFrameX + (int32_t) i;
+
+        const bool bIsSlowFrame = (frame.totalUsec > GRAPH_REF_LINE_USEC[1] + 1000.0f);
+        const int32_t prevTotalY = graphBy - getGraphBarHeight(prevFrame.totalUsec);
+        const int32_t totalY = graphBy - getGraphBarHeight(frame.totalUsec);
+        drawLine(lineX - 1, prevTotalY, lineX, totalY, 255, (bIsSlowFrame) ? 0 : 255, (bIsSlowFrame) ? 0 : 255);
+
+        if ((prevFrame.gpuUsec >= 0.0f) && (frame.gpuUsec >= 0.0f)) {
+            const int32_t prevGpuY = graphBy - getGraphBarHeight(prevFrame.gpuUsec);
+            const int32_t gpuY = graphBy - getGraphBarHeight(frame.gpuUsec);
+            drawLine(lineX - 1, prevGpuY, lineX, gpuY, 255, 0, 255);
+        }
+    }
+}
+
+END_NAMESPACE(FrameStats)
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <chrono>
+#include <cstdint>
+
+BEGIN_NAMESPACE(FrameStats)
+
+// The parts of the game loop which have their time tracked each frame
+enum class Split : uint8_t {
+    Sim,        // The ticker function for the current game loop: game simulation
+    Drawer,     // The drawer function for the current game loop: includes presentation time
+    Present,    // 'I_DrawPresent': presenting the frame and waiting for vblanks
+    NUM_SPLITS
+};
+
+// Time taken by each part of a single frame, in microseconds
+struct FrameTimes {
+    float   totalUsec;      // Overall time for the frame
+    float   simUsec;        // Simulation (ticker) time
+    float   renderUsec;     // CPU rendering time: the drawer function, minus presentation time
+    float   presentUsec;    // Presentation time, including waiting for vblanks
+    float   gpuUsec;        // GPU time to execute the frame's commands (lags a few frames behind) or '-1' if unavailable
+};
+
+// Height of the frame time graph in pixels
+static constexpr int32_t GRAPH_H = 40;
+
+typedef std::chrono::steady_clock Clock;
+
+void addSplitTime(const Split split, const Clock::duration duration) noexcept;
+void endFrame(const float frameUsec) noexcept;
+void getAverageFrameTimes(FrameTimes& avgTimes, FrameTimes& maxTimes) noexcept;
+void drawGraph(const int32_t x, const int32_t y) noexcept;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Times the scope it is declared in and adds the time to the given split for the current frame
+//------------------------------------------------------------------------------------------------------------------------------------------
+class SplitTimer {
+public:
+    inline SplitTimer(const Split split) noexcept
+        : mSplit(split)
+        , mStartTime(Clock::now())
+    {
+    }
+
+    inline ~SplitTimer() noexcept {
+        addSplitTime(mSplit, Clock::now() - mStartTime);
+    }
+
+private:
+    const Split                 mSplit;
+    const Clock::time_point     mStartTime;
+};
+
+END_NAMESPACE(FrameStats)
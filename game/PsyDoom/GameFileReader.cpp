@@ -5,12 +5,16 @@
 #include "SmallString.h"
 #include "Wess/psxcd.h"
 
+#include <cstring>
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes the file reader with no file open
 //------------------------------------------------------------------------------------------------------------------------------------------
 GameFileReader::GameFileReader() noexcept
     : mCdFile()
     , mpFile(nullptr)
+    , mMappedFile()
+    , mMappedOffset(0)
 {
 }
 
@@ -27,16 +31,19 @@ GameFileReader::~GameFileReader() noexcept {
 GameFileReader::GameFileReader(GameFileReader&& other) noexcept
     : mCdFile(other.mCdFile)
     , mpFile(other.mpFile)
+    , mMappedFile(std::move(other.mMappedFile))
+    , mMappedOffset(other.mMappedOffset)
 {
     other.mCdFile = {};
     other.mpFile = nullptr;
+    other.mMappedOffset = 0;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Tells if a file is currently open for reading
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool GameFileReader::isOpen() noexcept {
-    return ((mCdFile.fileHandle > 0) || (mCdFile.overrideFileHandle > 0) || mpFile);
+    return ((mCdFile.fileHandle > 0) || (mCdFile.overrideFileHandle > 0) || mpFile || mMappedFile.isOpen());
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -46,6 +53,9 @@ void GameFileReader::close() noexcept {
     if (mpFile) {
         std::fclose(mpFile);
         mpFile = nullptr;
+    } else if (mMappedFile.isOpen()) {
+        mMappedFile.close();
+        mMappedOffset = 0;
     } else {
         psxcd_close(mCdFile);
         mCdFile = {};
@@ -56,15 +66,25 @@ void GameFileReader::close() noexcept {
 // Tries to open the specified file for reading.
 // Note: it is illegal/undefined behavior to try to open another file while one is already open.
 //------------------------------------------------------------------------------------------------------------------------------------------
-FILE* GameFileReader::open(const char* const filePath) noexcept {
+void GameFileReader::open(const char* const filePath) noexcept {
     ASSERT(!isOpen());
+
+    // Try to memory map the file first and fallback to regular file IO if that is not possible.
+    // Only files which can be addressed with 32-bit offsets are mapped, since that is all this reader deals with.
+    if (mMappedFile.open(filePath)) {
+        if (mMappedFile.getSize() <= (uint64_t) INT32_MAX) {
+            mMappedOffset = 0;
+            return;
+        }
+
+        mMappedFile.close();
+    }
+
     mpFile = std::fopen(filePath, "rb");
 
     if (!mpFile) {
         FatalErrors::raiseF("GameFileReader::open: error opening file '%s'!", filePath);
     }
-
-    return mpFile;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -88,6 +108,14 @@ void GameFileReader::seekRelative(const int32_t offset) noexcept {
         if (std::fseek(mpFile, offset, SEEK_CUR) != 0) {
             FatalErrors::raiseF("GameFileReader::seek: operation failed - IO error!");
         }
+    } else if (mMappedFile.isOpen()) {
+        const int64_t newOffset = (int64_t) mMappedOffset + offset;
+
+        if ((newOffset < 0) || (newOffset > (int64_t) mMappedFile.getSize())) {
+            FatalErrors::raiseF("GameFileReader::seek: operation failed - IO error!");
+        }
+
+        mMappedOffset = (int32_t) newOffset;
     } else {
         if (psxcd_seek(mCdFile, offset, PsxCd_SeekMode::CUR) != 0) {
             FatalErrors::raiseF("GameFileReader::seek: operation failed - IO error!");
@@ -106,6 +134,12 @@ void GameFileReader::seekAbsolute(const int32_t offset) noexcept {
         if (std::fseek(mpFile, offset, SEEK_SET) != 0) {
             FatalErrors::raiseF("GameFileReader::seek: operation failed - IO error!");
         }
+    } else if (mMappedFile.isOpen()) {
+        if ((offset < 0) || ((uint64_t) offset > mMappedFile.getSize())) {
+            FatalErrors::raiseF("GameFileReader::seek: operation failed - IO error!");
+        }
+
+        mMappedOffset = offset;
     } else {
         if (psxcd_seek(mCdFile, offset, PsxCd_SeekMode::SET) != 0) {
             FatalErrors::raiseF("GameFileReader::seek: operation failed - IO error!");
@@ -129,9 +163,33 @@ void GameFileReader::read(void* const pBuffer, const int32_t numBytes) noexcept
         if (std::fread(pBuffer, (uint32_t) numBytes, 1, mpFile) != 1) {
             FatalErrors::raiseF("GameFileReader::read: operation failed - IO error!");
         }
+    } else if (mMappedFile.isOpen()) {
+        const std::byte* const pSrcBytes = getMappedBytes(mMappedOffset, numBytes);
+
+        if (!pSrcBytes) {
+            FatalErrors::raiseF("GameFileReader::read: operation failed - IO error!");
+        }
+
+        std::memcpy(pBuffer, pSrcBytes, (size_t) numBytes);
+        mMappedOffset += numBytes;
     } else {
         if (psxcd_read(pBuffer, numBytes, mCdFile) != numBytes) {
             FatalErrors::raiseF("GameFileReader::read: operation failed - IO error!");
         }
     }
 }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// If the file is memory mapped, returns a pointer to the specified range of bytes in the file.
+// Returns null if the file is not memory mapped or if the range is out of bounds, in which case 'read()' should be used instead.
+// Note: the current read offset is unaffected by this call.
+//------------------------------------------------------------------------------------------------------------------------------------------
+const std::byte* GameFileReader::getMappedBytes(const int32_t offset, const int32_t numBytes) const noexcept {
+    if ((!mMappedFile.isOpen()) || (offset < 0) || (numBytes < 0))
+        return nullptr;
+
+    if ((uint64_t) offset + (uint64_t) numBytes > mMappedFile.getSize())
+        return nullptr;
+
+    return mMappedFile.getData() + offset;
+}
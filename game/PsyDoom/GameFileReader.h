@@ -1,5 +1,6 @@
 #pragma once
 
+#include "MappedFile.h"
 #include "Wess/psxcd.h"
 
 #include <cstdio>
@@ -8,7 +9,7 @@
 // Provides a consistent interface to read from a game file from several possible sources:
 //  (1) A file within the game's CD image.
 //  (2) A file within the game's CD image that has been overriden on disk.
-//  (3) A real file on disk.
+//  (3) A real file on disk: this will be memory mapped if possible, to avoid system calls and copies when reading.
 //
 // Note: if any IO errors occur then the problem will be treated as fatal and the game will be terminated.
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -20,11 +21,12 @@ public:
     
     bool isOpen() noexcept;
     void close() noexcept;
-    FILE* open(const char* const filePath) noexcept;
+    void open(const char* const filePath) noexcept;
     const PsxCd_File& open(const CdFileId fileId) noexcept;
     void seekRelative(const int32_t offset) noexcept;
     void seekAbsolute(const int32_t offset) noexcept;
     void read(void* const pBuffer, const int32_t numBytes) noexcept;
+    const std::byte* getMappedBytes(const int32_t offset, const int32_t numBytes) const noexcept;
 
     // Convenience overload
     template <class T>
@@ -36,5 +38,7 @@ private:
     GameFileReader& operator = (GameFileReader&& other) = delete;
 
     PsxCd_File      mCdFile;    // If reading from a file on-disk, this is the index of the file slot open in the 'psxcd' library
-    FILE*           mpFile;     // If reading from a real file, this is the file being read
+    FILE*           mpFile;             // If reading from a real file (and not memory mapped), this is the file being read
+    MappedFile      mMappedFile;        // If reading from a real file that could be memory mapped, this is the mapping
+    int32_t         mMappedOffset;      // Current offset when reading from the memory mapped file
 };
@@ -0,0 +1,46 @@
+#include "GameJobs.h"
+
+BEGIN_NAMESPACE(GameJobs)
+
+static JobPool gJobPool;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Starts up the job worker threads.
+// Uses one less worker thread than the number of CPU cores, since the thread running jobs also helps out with them.
+// If 'maxThreads' is greater than zero then the total number of threads (including the calling thread) is capped further to this amount.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void init(const int32_t maxThreads) noexcept {
+    constexpr uint32_t MAX_WORKERS = 15;
+    gJobPool.init(JobPool::getDefaultNumWorkers(maxThreads, MAX_WORKERS));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stops all of the job worker threads, if any are running
+//------------------------------------------------------------------------------------------------------------------------------------------
+void shutdown() noexcept {
+    gJobPool.shutdown();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the number of worker threads available to help with jobs (not including the thread which runs the jobs)
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t getNumWorkers() noexcept {
+    return gJobPool.getNumWorkers();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the underlying job pool, for systems outside of the game which take a pool to run their work on
+//------------------------------------------------------------------------------------------------------------------------------------------
+JobPool& getPool() noexcept {
+    return gJobPool;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Executes the specified number of jobs using the job function, spreading them across the worker threads and the calling thread.
+// Waits for all of the jobs to complete before returning. If there are no worker threads then the jobs are just run in order.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void run(const JobFunc jobFunc, void* const pCtx, const uint32_t numJobs) noexcept {
+    gJobPool.run(jobFunc, pCtx, numJobs);
+}
+
+END_NAMESPACE(GameJobs)
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "JobPool.h"
+#include "Macros.h"
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// The pool of worker threads shared by everything in PsyDoom that spreads independent work across multiple cores: level loading,
+// game logic which makes no changes to the game state, movie decoding, the Vulkan renderer and the software GPU's deferred drawing.
+// The thread calling 'run' also helps out with the work and waits for it to finish.
+//
+// The pool is started when the PlayStation VM is initialized and runs until it is shut down. Its total thread count (including the
+// thread calling 'run') is capped by the 'MaxJobThreads' config setting.
+//------------------------------------------------------------------------------------------------------------------------------------------
+BEGIN_NAMESPACE(GameJobs)
+
+// A function which executes a job with the given index, using the context pointer passed to 'run'.
+// Jobs which are run together may be executed in any order and on any thread.
+typedef JobPool::JobFunc JobFunc;
+
+void init(const int32_t maxThreads) noexcept;
+void shutdown() noexcept;
+uint32_t getNumWorkers() noexcept;
+JobPool& getPool() noexcept;
+void run(const JobFunc jobFunc, void* const pCtx, const uint32_t numJobs) noexcept;
+
+END_NAMESPACE(GameJobs)
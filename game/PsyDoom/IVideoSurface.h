@@ -20,6 +20,12 @@ public:
     // Populates the video surface with the given XBGR8888 32-bit pixels.
     // The pixel array is expected to have the same dimensions as the surface.
     virtual void setPixels(const uint32_t* const pSrcPixels) noexcept = 0;
+
+    // Locks the surface so that its XBGR8888 32-bit pixels can be written directly, without an intermediate buffer and copy.
+    // Returns the pixels to write to and the distance in pixels between rows, or null on failure.
+    // The entire surface must be written before unlocking it, since the previous contents of the surface are undefined after locking.
+    virtual uint32_t* lockPixels(uint32_t& rowPitchOut) noexcept = 0;
+    virtual void unlockPixels() noexcept = 0;
 };
 
 END_NAMESPACE(Video)
@@ -40,6 +40,18 @@ static std::vector<JoyHat>              gJoystickHatsPressed;
 static std::vector<JoyHat>              gJoystickHatsJustPressed;
 static std::vector<JoyHat>              gJoystickHatsJustReleased;
 
+// The same states as above in bitset form, for fast queries.
+// These must always be kept in sync with the lists of inputs!
+static KeyboardKeyBits      gKeyboardKeyBitsPressed;
+static KeyboardKeyBits      gKeyboardKeyBitsJustPressed;
+static KeyboardKeyBits      gKeyboardKeyBitsJustReleased;
+static MouseButtonBits      gMouseButtonBitsPressed;
+static MouseButtonBits      gMouseButtonBitsJustPressed;
+static MouseButtonBits      gMouseButtonBitsJustReleased;
+static GamepadInputBits     gGamepadInputBitsPressed;
+static GamepadInputBits     gGamepadInputBitsJustPressed;
+static GamepadInputBits     gGamepadInputBitsJustReleased;
+
 static SDL_GameController*  gpGameController;
 static SDL_Joystick*        gpJoystick;         // Note: if there is a game controller then this joystick will be managed by that and not closed manually by this module!
 static SDL_JoystickID       gJoystickId;
@@ -121,6 +133,9 @@ static void closeCurrentGameController() noexcept {
     gGamepadInputsPressed.clear();
     gGamepadInputsJustPressed.clear();
     gGamepadInputsJustReleased.clear();
+    gGamepadInputBitsPressed.reset();
+    gGamepadInputBitsJustPressed.reset();
+    gGamepadInputBitsJustReleased.reset();
 
     gJoystickAxes.clear();
     gJoystickAxesPressed.clear();
@@ -270,6 +285,9 @@ static void handleSdlEvents() noexcept {
                     removeValueFromVector(scancode, gKeyboardKeysJustReleased);
                     gKeyboardKeysPressed.push_back(scancode);
                     gKeyboardKeysJustPressed.push_back(scancode);
+                    gKeyboardKeyBitsJustReleased.reset(scancode);
+                    gKeyboardKeyBitsPressed.set(scancode);
+                    gKeyboardKeyBitsJustPressed.set(scancode);
                 }
             }   break;
 
@@ -281,6 +299,9 @@ static void handleSdlEvents() noexcept {
                     removeValueFromVector(scancode, gKeyboardKeysPressed);
                     removeValueFromVector(scancode, gKeyboardKeysJustPressed);
                     gKeyboardKeysJustReleased.push_back(scancode);
+                    gKeyboardKeyBitsPressed.reset(scancode);
+                    gKeyboardKeyBitsJustPressed.reset(scancode);
+                    gKeyboardKeyBitsJustReleased.set(scancode);
                 }
             }   break;
 
@@ -304,6 +325,9 @@ static void handleSdlEvents() noexcept {
                     removeValueFromVector(button, gMouseButtonsJustReleased);
                     gMouseButtonsPressed.push_back(button);
                     gMouseButtonsJustPressed.push_back(button);
+                    gMouseButtonBitsJustReleased.reset((uint8_t) button);
+                    gMouseButtonBitsPressed.set((uint8_t) button);
+                    gMouseButtonBitsJustPressed.set((uint8_t) button);
                 }
             } break;
 
@@ -314,6 +338,9 @@ static void handleSdlEvents() noexcept {
                     removeValueFromVector(button, gMouseButtonsPressed);
                     removeValueFromVector(button, gMouseButtonsJustPressed);
                     gMouseButtonsJustReleased.push_back(button);
+                    gMouseButtonBitsPressed.reset((uint8_t) button);
+                    gMouseButtonBitsJustPressed.reset((uint8_t) button);
+                    gMouseButtonBitsJustReleased.set((uint8_t) button);
                 }
             } break;
 
@@ -362,10 +389,16 @@ static void handleSdlEvents() noexcept {
                                 removeValueFromVector(input, gGamepadInputsJustReleased);
                                 gGamepadInputsPressed.push_back(input);
                                 gGamepadInputsJustPressed.push_back(input);
+                                gGamepadInputBitsJustReleased.reset(inputIdx);
+                                gGamepadInputBitsPressed.set(inputIdx);
+                                gGamepadInputBitsJustPressed.set(inputIdx);
                             } else {
                                 removeValueFromVector(input, gGamepadInputsPressed);
                                 removeValueFromVector(input, gGamepadInputsJustPressed);
                                 gGamepadInputsJustReleased.push_back(input);
+                                gGamepadInputBitsPressed.reset(inputIdx);
+                                gGamepadInputBitsJustPressed.reset(inputIdx);
+                                gGamepadInputBitsJustReleased.set(inputIdx);
                             }
                         }
                     }
@@ -409,6 +442,9 @@ static void handleSdlEvents() noexcept {
                         removeValueFromVector(input, gGamepadInputsJustReleased);
                         gGamepadInputsPressed.push_back(input);
                         gGamepadInputsJustPressed.push_back(input);
+                        gGamepadInputBitsJustReleased.reset((uint8_t) input);
+                        gGamepadInputBitsPressed.set((uint8_t) input);
+                        gGamepadInputBitsJustPressed.set((uint8_t) input);
                         gGamepadInputs[(uint8_t) input] = 1.0f;
                     }
                 }
@@ -431,6 +467,9 @@ static void handleSdlEvents() noexcept {
                         gGamepadInputsJustReleased.push_back(input);
                         removeValueFromVector(input, gGamepadInputsPressed);
                         removeValueFromVector(input, gGamepadInputsJustPressed);
+                        gGamepadInputBitsJustReleased.set((uint8_t) input);
+                        gGamepadInputBitsPressed.reset((uint8_t) input);
+                        gGamepadInputBitsJustPressed.reset((uint8_t) input);
                         gGamepadInputs[(uint8_t) input] = 0.0f;
                     }
                 }
@@ -554,6 +593,9 @@ void shutdown() noexcept {
     emptyAndShrinkVector(gKeyboardKeysJustPressed);
     emptyAndShrinkVector(gKeyboardKeysPressed);
 
+    gMouseButtonBitsPressed.reset();
+    gKeyboardKeyBitsPressed.reset();
+
     gpKeyboardState = nullptr;
     gbIsQuitRequested = false;
 
@@ -577,13 +619,19 @@ void consumeEvents() noexcept {
     // Clear all events
     gKeyboardKeysJustPressed.clear();
     gKeyboardKeysJustReleased.clear();
+    gKeyboardKeyBitsJustPressed.reset();
+    gKeyboardKeyBitsJustReleased.reset();
     consumeTypedChars();
 
     gMouseButtonsJustPressed.clear();
     gMouseButtonsJustReleased.clear();
+    gMouseButtonBitsJustPressed.reset();
+    gMouseButtonBitsJustReleased.reset();
 
     gGamepadInputsJustPressed.clear();
     gGamepadInputsJustReleased.clear();
+    gGamepadInputBitsJustPressed.reset();
+    gGamepadInputBitsJustReleased.reset();
     
     gJoystickAxesJustPressed.clear();
     gJoystickAxesJustReleased.clear();
@@ -762,12 +810,48 @@ const std::vector<JoystickAxis>& getActiveJoystickAxes() noexcept {
     return gJoystickAxes;
 }
 
+const KeyboardKeyBits& getKeyboardKeyBitsPressed() noexcept {
+    return gKeyboardKeyBitsPressed;
+}
+
+const KeyboardKeyBits& getKeyboardKeyBitsJustPressed() noexcept {
+    return gKeyboardKeyBitsJustPressed;
+}
+
+const KeyboardKeyBits& getKeyboardKeyBitsJustReleased() noexcept {
+    return gKeyboardKeyBitsJustReleased;
+}
+
+const MouseButtonBits& getMouseButtonBitsPressed() noexcept {
+    return gMouseButtonBitsPressed;
+}
+
+const MouseButtonBits& getMouseButtonBitsJustPressed() noexcept {
+    return gMouseButtonBitsJustPressed;
+}
+
+const MouseButtonBits& getMouseButtonBitsJustReleased() noexcept {
+    return gMouseButtonBitsJustReleased;
+}
+
+const GamepadInputBits& getGamepadInputBitsPressed() noexcept {
+    return gGamepadInputBitsPressed;
+}
+
+const GamepadInputBits& getGamepadInputBitsJustPressed() noexcept {
+    return gGamepadInputBitsJustPressed;
+}
+
+const GamepadInputBits& getGamepadInputBitsJustReleased() noexcept {
+    return gGamepadInputBitsJustReleased;
+}
+
 bool isKeyboardKeyPressed(const uint16_t key) noexcept {
-    return vectorContainsValue(gKeyboardKeysPressed, key);
+    return (key < NUM_KEYBOARD_KEYS) && gKeyboardKeyBitsPressed.test(key);
 }
 
 bool isKeyboardKeyJustPressed(const uint16_t key) noexcept {
-    return vectorContainsValue(gKeyboardKeysJustPressed, key);
+    return (key < NUM_KEYBOARD_KEYS) && gKeyboardKeyBitsJustPressed.test(key);
 }
 
 bool isKeyboardKeyReleased(const uint16_t key) noexcept {
@@ -775,35 +859,35 @@ bool isKeyboardKeyReleased(const uint16_t key) noexcept {
 }
 
 bool isKeyboardKeyJustReleased(const uint16_t key) noexcept {
-    return vectorContainsValue(gKeyboardKeysJustReleased, key);
+    return (key < NUM_KEYBOARD_KEYS) && gKeyboardKeyBitsJustReleased.test(key);
 }
 
 bool isMouseButtonPressed(const MouseButton button) noexcept {
-    return vectorContainsValue(gMouseButtonsPressed, button);
+    return ((uint8_t) button < NUM_MOUSE_BUTTONS) && gMouseButtonBitsPressed.test((uint8_t) button);
 }
 
 bool isMouseButtonJustPressed(const MouseButton button) noexcept {
-    return vectorContainsValue(gMouseButtonsJustPressed, button);
+    return ((uint8_t) button < NUM_MOUSE_BUTTONS) && gMouseButtonBitsJustPressed.test((uint8_t) button);
 }
 
 bool isMouseButtonReleased(const MouseButton button) noexcept {
-    return (!vectorContainsValue(gMouseButtonsPressed, button));
+    return (!isMouseButtonPressed(button));
 }
 
 bool isMouseButtonJustReleased(const MouseButton button) noexcept {
-    return vectorContainsValue(gMouseButtonsJustReleased, button);
+    return ((uint8_t) button < NUM_MOUSE_BUTTONS) && gMouseButtonBitsJustReleased.test((uint8_t) button);
 }
 
 bool isGamepadInputPressed(const GamepadInput input) noexcept {
-    return vectorContainsValue(gGamepadInputsPressed, input);
+    return ((uint8_t) input < NUM_GAMEPAD_INPUTS) && gGamepadInputBitsPressed.test((uint8_t) input);
 }
 
 bool isGamepadInputJustPressed(const GamepadInput input) noexcept {
-    return vectorContainsValue(gGamepadInputsJustPressed, input);
+    return ((uint8_t) input < NUM_GAMEPAD_INPUTS) && gGamepadInputBitsJustPressed.test((uint8_t) input);
 }
 
 bool isGamepadInputJustReleased(const GamepadInput input) noexcept {
-    return vectorContainsValue(gGamepadInputsJustReleased, input);
+    return ((uint8_t) input < NUM_GAMEPAD_INPUTS) && gGamepadInputBitsJustReleased.test((uint8_t) input);
 }
 
 bool isJoystickAxisPressed(const uint32_t axis) noexcept {
@@ -3,6 +3,8 @@
 #include "GamepadInput.h"
 #include "Macros.h"
 #include "MouseButton.h"
+
+#include <bitset>
 #include <vector>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -61,6 +63,12 @@ struct JoystickAxis {
     float       value;
 };
 
+// Bitsets holding one bit for each keyboard key, mouse button or gamepad input.
+// These allow fast queries of input state, or checking a whole group of inputs at once.
+typedef std::bitset<NUM_KEYBOARD_KEYS>      KeyboardKeyBits;
+typedef std::bitset<NUM_MOUSE_BUTTONS>      MouseButtonBits;
+typedef std::bitset<NUM_GAMEPAD_INPUTS>     GamepadInputBits;
+
 void init() noexcept;
 void shutdown() noexcept;
 void update() noexcept;
@@ -102,6 +110,19 @@ const std::vector<JoyHat>& getJoystickHatsJustReleased() noexcept;
 // Get joystick axes that currently have a non-zero value
 const std::vector<JoystickAxis>& getActiveJoystickAxes() noexcept;
 
+// Get bitsets of what keys, mouse buttons or gamepad inputs are pressed, just pressed or just released
+const KeyboardKeyBits& getKeyboardKeyBitsPressed() noexcept;
+const KeyboardKeyBits& getKeyboardKeyBitsJustPressed() noexcept;
+const KeyboardKeyBits& getKeyboardKeyBitsJustReleased() noexcept;
+
+const MouseButtonBits& getMouseButtonBitsPressed() noexcept;
+const MouseButtonBits& getMouseButtonBitsJustPressed() noexcept;
+const MouseButtonBits& getMouseButtonBitsJustReleased() noexcept;
+
+const GamepadInputBits& getGamepadInputBitsPressed() noexcept;
+const GamepadInputBits& getGamepadInputBitsJustPressed() noexcept;
+const GamepadInputBits& getGamepadInputBitsJustReleased() noexcept;
+
 // Query input state and whether something is just pressed or released
 bool isKeyboardKeyPressed(const uint16_t key) noexcept;
 bool isKeyboardKeyJustPressed(const uint16_t key) noexcept;
@@ -4,6 +4,9 @@
 
 typedef int32_t fixed_t;
 
+// The current game tick: declared here so that field assignment can be inline
+extern int32_t gGameTic;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // A 'fixed_t' value that supports being interpolated (according to the world/mobj tic rate) for uncapped framerates
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -12,8 +15,19 @@ struct InterpFixedT {
     fixed_t     oldValue;       // The previous value of this field, prior to the current value being set
     int32_t     oldGameTic;     // The game tick in which the old value was last assigned, this is the tick that should be interpolated
 
-    // Assign a new value to the interpolated field and remember the replaced value if from a previous frame
-    fixed_t operator = (const fixed_t& newValue) noexcept;
+    // Assign a new value to the interpolated field and remember the replaced value if from a previous frame.
+    // Note: this is inline since it is done all the time in game logic hot paths (movement etc.) for mobj positions and sector heights.
+    inline fixed_t operator = (const fixed_t& newValue) noexcept {
+        const int32_t curTic = gGameTic;
+
+        if (curTic != oldGameTic) {
+            oldValue = value;
+            oldGameTic = curTic;
+        }
+
+        value = newValue;
+        return newValue;
+    }
 
     inline fixed_t operator += (const fixed_t& amt) noexcept { return operator = (value + amt); }
     inline fixed_t operator -= (const fixed_t& amt) noexcept { return operator = (value - amt); }
@@ -43,6 +57,15 @@ struct InterpFixedT {
     // An optional overload allows the interpolation to be predicated on a condition.
     // May modify the old value to speed up future render value queries.
     // The interpolation is done using the world/mobj frame rate of 15 Hz for NTSC.
-    fixed_t renderValue() noexcept;
-    fixed_t renderValue(const bool bInterpolate) noexcept;
+    inline fixed_t renderValue() noexcept {
+        // If the value is the same don't bother interpolating (common case)
+        return (value == oldValue) ? value : lerpRenderValue();
+    }
+
+    inline fixed_t renderValue(const bool bInterpolate) noexcept {
+        return (bInterpolate) ? renderValue() : value;
+    }
+
+private:
+    fixed_t lerpRenderValue() noexcept;
 };
@@ -5,9 +5,12 @@
 #include "DiscInfo.h"
 #include "DiscReader.h"
 #include "Endian.h"
+#include "FileUtils.h"
 
+#include <cctype>
 #include <cstring>
 #include <queue>
+#include <string>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Represents most of an ISO 9660 directory record.
@@ -142,6 +145,25 @@ struct DirReaderContext {
 //------------------------------------------------------------------------------------------------------------------------------------------
 static constexpr int32_t VOL_DESC_SECTOR = 16;
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Info for the file system cache file, and the header for the file (which is followed by all of the file system entries)
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr uint32_t CACHE_FILE_MAGIC = 0x53464F49;    // 'IOFS'
+static constexpr uint32_t CACHE_FILE_VERSION = 1;
+
+struct CacheFileHeader {
+    uint32_t    magic;
+    uint32_t    version;
+    uint64_t    discSourceHash;         // Hash of the disc image files the file system was read from: if they change the cache is invalid
+    uint32_t    logicalBlockSize;
+    uint32_t    numEntries;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// The longest (normalized) path that can be looked up via the path index: longer paths are looked up by walking the directory tree
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr uint32_t MAX_INDEXED_PATH_LEN = 255;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Helper: tells if the specified character is a path separator
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -149,6 +171,143 @@ static bool isPathSeparator(const char c) noexcept {
     return ((c == '\\') || (c == '/'));
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: hashes the specified bytes using the 64-bit FNV-1a hash, continuing on from the given hash
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t hashBytes(const void* const pData, const size_t size, uint64_t hash = 0xCBF29CE484222325) noexcept {
+    const uint8_t* const pBytes = (const uint8_t*) pData;
+
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= pBytes[i];
+        hash *= 0x100000001B3;
+    }
+
+    return hash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: hashes the size and modification time of the specified file, continuing on from the given hash
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t hashFileSizeAndModTime(const char* const filePath, const uint64_t hash) noexcept {
+    const int64_t fileInfo[2] = { FileUtils::getFileSize(filePath), FileUtils::getFileModTime(filePath) };
+    return hashBytes(fileInfo, sizeof(fileInfo), hashBytes(filePath, std::strlen(filePath), hash));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Normalizes a path (relative to the filesystem root) for lookup in the path index.
+// The path is uppercased and all '.' and separator prefixes on path components are removed, in the same way as when walking the tree.
+// Returns the length of the normalized path or '-1' if the path can't be looked up via the index, and must be resolved by walking the tree.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t normalizePathForIndex(const char* path, char normPath[MAX_INDEXED_PATH_LEN + 1]) noexcept {
+    uint32_t normPathLen = 0;
+
+    while (true) {
+        // Skip separators and './' before the next path component
+        while (true) {
+            if ((path[0] == '.') && isPathSeparator(path[1])) {
+                path += 2;
+            } else if (isPathSeparator(path[0])) {
+                path += 1;
+            } else {
+                break;
+            }
+        }
+
+        // Empty path components (such as trailing separators) are unusual cases that are left to walking the tree
+        if (path[0] == 0)
+            return -1;
+
+        // Add the path component
+        if (normPathLen > 0) {
+            if (normPathLen >= MAX_INDEXED_PATH_LEN)
+                return -1;
+
+            normPath[normPathLen++] = '/';
+        }
+
+        for (; (path[0] != 0) && (!isPathSeparator(path[0])); ++path) {
+            if (normPathLen >= MAX_INDEXED_PATH_LEN)
+                return -1;
+
+            normPath[normPathLen++] = (char) std::toupper(path[0]);
+        }
+
+        if (path[0] == 0)
+            break;
+
+        ++path;     // Skip the separator
+    }
+
+    normPath[normPathLen] = 0;
+    return (int32_t) normPathLen;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: tells if the full path of the specified entry matches the given normalized path
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool entryPathMatches(const IsoFileSys& fs, int32_t entryIdx, const char* const normPath, const int32_t normPathLen) noexcept {
+    int32_t pathEnd = normPathLen;
+
+    while (entryIdx != 0) {
+        const IsoFileSysEntry& entry = fs.entries[entryIdx];
+        const int32_t nameStart = pathEnd - entry.nameLen;
+
+        if (nameStart < 0)
+            return false;
+
+        for (int32_t i = 0; i < entry.nameLen; ++i) {
+            if ((char) std::toupper(entry.name[i]) != normPath[nameStart + i])
+                return false;
+        }
+
+        // The name must be preceded by a separator, unless the parent is the root
+        entryIdx = entry.parentIdx;
+
+        if (entryIdx == 0)
+            return (nameStart == 0);
+
+        if ((nameStart == 0) || (normPath[nameStart - 1] != '/'))
+            return false;
+
+        pathEnd = nameStart - 1;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the index of full entry paths to entry indexes for the filesystem
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void buildPathIndex(IsoFileSys& fs) noexcept {
+    fs.pathIndex.clear();
+    fs.pathIndex.reserve(fs.entries.size());
+
+    // Note: parent entries always come before their children, so the full paths of parents are always known before children
+    std::vector<std::string> entryPaths(fs.entries.size());
+
+    for (size_t entryIdx = 1; entryIdx < fs.entries.size(); ++entryIdx) {
+        const IsoFileSysEntry& entry = fs.entries[entryIdx];
+        std::string& entryPath = entryPaths[entryIdx];
+
+        if (entry.parentIdx != 0) {
+            entryPath = entryPaths[entry.parentIdx];
+            entryPath.push_back('/');
+        }
+
+        for (uint32_t i = 0; i < entry.nameLen; ++i) {
+            entryPath.push_back((char) std::toupper(entry.name[i]));
+        }
+
+        // If multiple entries have the same path hash then those paths must be resolved by walking the tree
+        const uint64_t pathHash = hashBytes(entryPath.data(), entryPath.size());
+        const auto [iter, bInserted] = fs.pathIndex.try_emplace(pathHash, (int32_t) entryIdx);
+
+        if (!bInserted) {
+            iter->second = -1;
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Sets up the file system and disc reader for the process of reading files and directories.
 // Reads the volume descriptor for the filesystem and creates the root filesystem entry.
@@ -362,15 +521,132 @@ bool IsoFileSys::build(DiscReader& discReader) noexcept {
             return false;
     }
 
+    buildPathIndex(*this);
     return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Computes a hash which identifies the disc image files for the given disc: the .cue file and all track source files.
+// The hash is based on file paths, sizes and modification times - if any of these change then the hash changes.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint64_t IsoFileSys::computeDiscSourceHash(const DiscInfo& discInfo, const char* const cueFilePath) noexcept {
+    uint64_t hash = hashFileSizeAndModTime(cueFilePath, hashBytes(nullptr, 0));
+
+    for (const DiscTrack& track : discInfo.tracks) {
+        hash = hashFileSizeAndModTime(track.sourceFilePath.c_str(), hash);
+        hash = hashBytes(&track.fileOffset, sizeof(track.fileOffset), hash);
+    }
+
+    return hash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to read the filesystem from the specified cache file, returning 'true' if successful.
+// The cache file must have been written for disc image files with the specified hash, otherwise reading fails.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool IsoFileSys::readFromCacheFile(const char* const filePath, const uint64_t discSourceHash) noexcept {
+    logicalBlockSize = 0;
+    entries.clear();
+    pathIndex.clear();
+
+    if (!FileUtils::fileExists(filePath))
+        return false;
+
+    // Read the file and verify the header
+    const FileData fileData = FileUtils::getContentsOfFile(filePath);
+
+    if ((!fileData.bytes) || (fileData.size < sizeof(CacheFileHeader)))
+        return false;
+
+    CacheFileHeader header;
+    std::memcpy(&header, fileData.bytes.get(), sizeof(CacheFileHeader));
+
+    const bool bHeaderOk = (
+        (header.magic == CACHE_FILE_MAGIC) &&
+        (header.version == CACHE_FILE_VERSION) &&
+        (header.discSourceHash == discSourceHash) &&
+        (header.logicalBlockSize >= MIN_LOGICAL_BLOCK_SIZE) &&
+        (header.logicalBlockSize <= MAX_LOGICAL_BLOCK_SIZE) &&
+        (header.numEntries > 0) &&
+        (header.numEntries < IsoFileSysEntry::ROOT_PARENT_IDX) &&
+        (fileData.size == sizeof(CacheFileHeader) + (size_t) header.numEntries * sizeof(IsoFileSysEntry))
+    );
+
+    if (!bHeaderOk)
+        return false;
+
+    // Read all the entries and sanity check the links between them, in case the file is corrupt
+    entries.resize(header.numEntries);
+    std::memcpy(entries.data(), fileData.bytes.get() + sizeof(CacheFileHeader), (size_t) header.numEntries * sizeof(IsoFileSysEntry));
+
+    for (uint32_t entryIdx = 0; entryIdx < header.numEntries; ++entryIdx) {
+        IsoFileSysEntry& entry = entries[entryIdx];
+
+        const bool bBadParent = (entryIdx == 0) ?
+            (entry.parentIdx != IsoFileSysEntry::ROOT_PARENT_IDX) :
+            (entry.parentIdx >= entryIdx);
+
+        const bool bBadChildren = (entry.bIsDirectory && (entry.numChildren > 0) && (
+            (entry.firstChildIdx <= entryIdx) || ((uint32_t) entry.firstChildIdx + entry.numChildren > header.numEntries)
+        ));
+
+        if (bBadParent || bBadChildren || (entry.nameLen >= C_ARRAY_SIZE(entry.name))) {
+            entries.clear();
+            return false;
+        }
+
+        entry.name[C_ARRAY_SIZE(entry.name) - 1] = 0;
+    }
+
+    logicalBlockSize = header.logicalBlockSize;
+    buildPathIndex(*this);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes the filesystem to the specified cache file, recording the given hash of the disc image files it was read from
+//------------------------------------------------------------------------------------------------------------------------------------------
+void IsoFileSys::writeToCacheFile(const char* const filePath, const uint64_t discSourceHash) const noexcept {
+    CacheFileHeader header = {};
+    header.magic = CACHE_FILE_MAGIC;
+    header.version = CACHE_FILE_VERSION;
+    header.discSourceHash = discSourceHash;
+    header.logicalBlockSize = logicalBlockSize;
+    header.numEntries = (uint32_t) entries.size();
+
+    const size_t entriesSize = entries.size() * sizeof(IsoFileSysEntry);
+    std::vector<std::byte> fileData(sizeof(CacheFileHeader) + entriesSize);
+    std::memcpy(fileData.data(), &header, sizeof(CacheFileHeader));
+    std::memcpy(fileData.data() + sizeof(CacheFileHeader), entries.data(), entriesSize);
+    FileUtils::writeDataToFile(filePath, fileData.data(), fileData.size());
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Lookup the index of the file system entry for the given path (case insensitive), relative to the root of the filesystem.
 // Returns '-1' if the file system entry is not found.
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t IsoFileSys::getEntryIndex(const char* const path) const noexcept {
-    return (!entries.empty()) ? getEntryIndex(entries[0], path) : -1;
+    if (entries.empty())
+        return -1;
+
+    // Try to find the entry using the path index first.
+    // Fallback to walking the directory tree for unusual paths, or if multiple entries happen to have the same path hash.
+    char normPath[MAX_INDEXED_PATH_LEN + 1];
+    const int32_t normPathLen = normalizePathForIndex(path, normPath);
+
+    if (normPathLen >= 0) {
+        const auto iter = pathIndex.find(hashBytes(normPath, (size_t) normPathLen));
+
+        if (iter == pathIndex.end())
+            return -1;
+
+        const int32_t entryIdx = iter->second;
+
+        if (entryIdx >= 0)
+            return entryPathMatches(*this, entryIdx, normPath, normPathLen) ? entryIdx : -1;
+    }
+
+    return getEntryIndex(entries[0], path);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
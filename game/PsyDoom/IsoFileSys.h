@@ -3,9 +3,11 @@
 #include "Macros.h"
 
 #include <cstdint>
+#include <unordered_map>
 #include <vector>
 
 class DiscReader;
+struct DiscInfo;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Represents a single entry in the filesystem
@@ -27,15 +29,21 @@ struct IsoFileSysEntry {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Contains the ISO 9660 filesystem for a game disc and allows lookup of files.
 // Note that the filesystem entries are cut down to just the attributes we are interested in.
+// The filesystem can also be saved to and loaded from a cache file, to avoid reading all of the directory records on the disc.
 //------------------------------------------------------------------------------------------------------------------------------------------
 struct IsoFileSys {
     static constexpr uint32_t MIN_LOGICAL_BLOCK_SIZE = 2048;    // Minimum allowed logical sector size
     static constexpr uint32_t MAX_LOGICAL_BLOCK_SIZE = 2352;    // Maximum allowed logical sector size
 
-    uint32_t                        logicalBlockSize;   // Size of a logical sector for the CD-ROM's data track: normally 2,048 bytes
-    std::vector<IsoFileSysEntry>    entries;            // All the entries in the file system: the root entry is the first
+    uint32_t                                logicalBlockSize;   // Size of a logical sector for the CD-ROM's data track: normally 2,048 bytes
+    std::vector<IsoFileSysEntry>            entries;            // All the entries in the file system: the root entry is the first
+    std::unordered_map<uint64_t, int32_t>   pathIndex;          // Hash of each entry's full path (uppercase) to entry index, or '-1' if multiple entries have the same hash
+
+    static uint64_t computeDiscSourceHash(const DiscInfo& discInfo, const char* const cueFilePath) noexcept;
 
     bool build(DiscReader& discReader) noexcept;
+    bool readFromCacheFile(const char* const filePath, const uint64_t discSourceHash) noexcept;
+    void writeToCacheFile(const char* const filePath, const uint64_t discSourceHash) const noexcept;
     int32_t getEntryIndex(const char* const path) const noexcept;
     int32_t getEntryIndex(const IsoFileSysEntry& root, const char* const path) const noexcept;
     const IsoFileSysEntry* getEntry(const char* const path) const noexcept;
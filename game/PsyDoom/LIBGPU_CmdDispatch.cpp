@@ -8,6 +8,8 @@
 #include "Vulkan/VRenderer.h"
 #include "Vulkan/VTypes.h"
 
+#include <algorithm>
+
 BEGIN_NAMESPACE(LIBGPU_CmdDispatch)
 
 #if PSYDOOM_VULKAN_RENDERER
@@ -586,6 +588,59 @@ void submit(const FLOORROW_FT& row) noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Handle a command to draw a batch of textured rows of Doom floor pixels.
+// All of the rows must use the same texture page, CLUT and draw code; only the position, uvs and color of each row can differ.
+// This saves setting up the GPU state and dispatching each row individually.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void submit(const FLOORROW_FT* const pRows, const uint32_t numRows) noexcept {
+    if (numRows == 0)
+        return;
+
+    Gpu::Core& gpu = PsxVm::gGpu;
+    const FLOORROW_FT& firstRow = pRows[0];
+
+    // Set texture page and format, the CLUT to use and masking mode
+    setGpuTexPageId(firstRow.tpage);
+    setGpuClutId(firstRow.clut);
+    setGpuMaskingMode(firstRow);
+
+    // Convert the rows to GPU rows and submit them in small batches
+    const bool bColorRows = ((firstRow.code & 0x1) == 0);
+    const bool bBlendRows = (firstRow.code & 0x2);
+
+    constexpr uint32_t MAX_BATCH_ROWS = 64;
+    Gpu::DrawFloorRow drawRows[MAX_BATCH_ROWS];
+
+    for (uint32_t batchBeg = 0; batchBeg < numRows; batchBeg += MAX_BATCH_ROWS) {
+        const uint32_t batchSize = std::min(numRows - batchBeg, MAX_BATCH_ROWS);
+
+        for (uint32_t i = 0; i < batchSize; ++i) {
+            const FLOORROW_FT& row = pRows[batchBeg + i];
+            ASSERT((row.tpage == firstRow.tpage) && (row.clut == firstRow.clut) && (row.code == firstRow.code));
+
+            Gpu::DrawFloorRow& drawRow = drawRows[i];
+            drawRow = {};
+            drawRow.x1 = row.x0;
+            drawRow.x2 = row.x1;
+            drawRow.y = row.y0;
+            drawRow.u1 = row.u0;
+            drawRow.v1 = row.v0;
+            drawRow.u2 = row.u1;
+            drawRow.v2 = row.v1;
+            drawRow.color.comp.r = (bColorRows) ? row.r0 : 128;   // Note: '128' is '1.0' or full strength color if we don't want to modulate
+            drawRow.color.comp.g = (bColorRows) ? row.g0 : 128;
+            drawRow.color.comp.b = (bColorRows) ? row.b0 : 128;
+        }
+
+        if (bBlendRows) {
+            Gpu::draw<Gpu::DrawMode::TexturedBlended>(gpu, drawRows, batchSize);
+        } else {
+            Gpu::draw<Gpu::DrawMode::Textured>(gpu, drawRows, batchSize);
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Handle a command to draw a textured column of Doom wall pixels.
 // Note: this function does not support pass-through to the Vulkan renderer; it's not needed since it's just ussed by the Classic renderer.
@@ -25,6 +25,7 @@ void submit(const POLY_FT3& poly) noexcept;
 void submit(const POLY_F4& poly) noexcept;
 void submit(const POLY_FT4& poly) noexcept;
 void submit(const FLOORROW_FT& row) noexcept;
+void submit(const FLOORROW_FT* const pRows, const uint32_t numRows) noexcept;
 void submit(const WALLCOL_GT& col) noexcept;
 
 END_NAMESPACE(LIBGPU_CmdDispatch)
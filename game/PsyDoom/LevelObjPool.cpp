@@ -0,0 +1,81 @@
+#include "LevelObjPool.h"
+
+#include "Asserts.h"
+#include "Doom/Base/z_zone.h"
+
+LevelObjPool* LevelObjPool::gpPools;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates a pool for objects of the given size.
+// Pools are expected to be global objects which last the lifetime of the program.
+//------------------------------------------------------------------------------------------------------------------------------------------
+LevelObjPool::LevelObjPool(const int32_t objSize, const int32_t objsPerChunk, const int16_t zoneTag) noexcept
+    : mSlotSize((int32_t)((sizeof(SlotHeader) + objSize + alignof(SlotHeader) - 1) & ~(alignof(SlotHeader) - 1)))
+    , mObjsPerChunk(objsPerChunk)
+    , mZoneTag(zoneTag)
+    , mpFreeSlots(nullptr)
+    , mpChunkCur(nullptr)
+    , mpChunkEnd(nullptr)
+    , mpNextPool(gpPools)
+{
+    ASSERT(objSize >= (int32_t) sizeof(FreeSlot));
+    ASSERT(objsPerChunk > 0);
+    gpPools = this;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocates an uninitialized object from the pool, re-using previously freed objects first
+//------------------------------------------------------------------------------------------------------------------------------------------
+void* LevelObjPool::alloc() noexcept {
+    std::byte* pSlot;
+
+    if (mpFreeSlots) {
+        pSlot = (std::byte*) mpFreeSlots - sizeof(SlotHeader);
+        mpFreeSlots = mpFreeSlots->pNext;
+    } else {
+        // Need a new chunk? Note that running out of zone memory here is a fatal error, same as any other zone allocation.
+        if (mpChunkCur == mpChunkEnd) {
+            const int32_t chunkSize = mSlotSize * mObjsPerChunk;
+            mpChunkCur = (std::byte*) Z_Malloc(*gpMainMemZone, chunkSize, mZoneTag, nullptr);
+            mpChunkEnd = mpChunkCur + chunkSize;
+        }
+
+        pSlot = mpChunkCur;
+        mpChunkCur += mSlotSize;
+    }
+
+    ((SlotHeader*) pSlot)->pPool = this;
+    return pSlot + sizeof(SlotHeader);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns an object to the pool that it was allocated from
+//------------------------------------------------------------------------------------------------------------------------------------------
+void LevelObjPool::free(void* const pObj) noexcept {
+    ASSERT(pObj);
+    LevelObjPool& pool = *((SlotHeader*)((std::byte*) pObj - sizeof(SlotHeader)))->pPool;
+    FreeSlot* const pFreeSlot = (FreeSlot*) pObj;
+    pFreeSlot->pNext = pool.mpFreeSlots;
+    pool.mpFreeSlots = pFreeSlot;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Must be called whenever zone memory blocks with any of the given tags are freed in bulk.
+// Pools using those tags have lost all of their chunks, so they start over from scratch.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void LevelObjPool::onZoneTagsFreed(const int16_t tagBits) noexcept {
+    for (LevelObjPool* pPool = gpPools; pPool; pPool = pPool->mpNextPool) {
+        if (pPool->mZoneTag & tagBits) {
+            pPool->reset();
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Forgets about all chunks and objects in the pool
+//------------------------------------------------------------------------------------------------------------------------------------------
+void LevelObjPool::reset() noexcept {
+    mpFreeSlots = nullptr;
+    mpChunkCur = nullptr;
+    mpChunkEnd = nullptr;
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A pool of fixed size objects which are allocated in large contiguous chunks from the main zone memory heap.
+// Used for objects which are frequently created and destroyed during gameplay (map objects etc.) to avoid constantly searching the zone
+// heap for free blocks, and to keep the objects close together in memory for better cache performance.
+//
+// The chunks are allocated with the zone tag given to the pool and get freed along with everything else using that tag.
+// When that happens the pool automatically forgets about all of it's chunks and objects, so there is no explicit bulk free.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class LevelObjPool {
+public:
+    LevelObjPool(const int32_t objSize, const int32_t objsPerChunk, const int16_t zoneTag) noexcept;
+    LevelObjPool(const LevelObjPool& other) = delete;
+    LevelObjPool& operator = (const LevelObjPool& other) = delete;
+
+    void* alloc() noexcept;
+    static void free(void* const pObj) noexcept;
+    static void onZoneTagsFreed(const int16_t tagBits) noexcept;
+
+private:
+    // A header preceding each object which records the pool that owns it
+    struct alignas(16) SlotHeader {
+        LevelObjPool* pPool;
+    };
+
+    // A free slot in the pool: these form a linked list of slots to be re-used
+    struct FreeSlot {
+        FreeSlot* pNext;
+    };
+
+    void reset() noexcept;
+
+    const int32_t   mSlotSize;          // Size of each object including the header; rounded up to preserve alignment
+    const int32_t   mObjsPerChunk;      // How many objects to allocate in each chunk
+    const int16_t   mZoneTag;           // Zone memory tag that chunks are allocated with
+    FreeSlot*       mpFreeSlots;        // List of slots which have been freed and can be re-used
+    std::byte*      mpChunkCur;         // Next never-used slot in the current chunk
+    std::byte*      mpChunkEnd;         // End of the current chunk
+    LevelObjPool*   mpNextPool;         // Next pool in the list of all pools
+
+    static LevelObjPool* gpPools;       // List of all pools
+};
@@ -92,17 +92,21 @@ static void updateLogoSurface(const Logo& logo, const float brightness) noexcept
     // Don't update again unless we need to
     gCurLogoBrightness = intBrightness;
 
-    // Alloc a temporary array for the logo pixels.
-    // Not super efficient to be doing constantly but this code is only for logo display, so not a performance concern:
-    const uint32_t numPixels = logo.width * logo.height;
-    std::unique_ptr<uint32_t[]> pixels = std::make_unique<uint32_t[]>(numPixels);
+    // Lock the surface and write the logo pixels directly to it, rather than going through a temporary array and copy.
+    // If locking fails then just leave the surface as it is.
+    uint32_t dstRowPitch = 0;
+    uint32_t* const pDstPixels = gpLogoSurface->lockPixels(dstRowPitch);
 
-    {
-        // Populate the pixel data, taking into account the logo's brightness:
-        const uint32_t* pSrcPixel = logo.pPixels.get();
-        uint32_t* pDstPixel = pixels.get();
+    if (!pDstPixels)
+        return;
+
+    // Populate the pixel data, taking into account the logo's brightness:
+    const uint32_t* pSrcPixel = logo.pPixels.get();
+
+    for (uint32_t y = 0; y < logo.height; ++y) {
+        uint32_t* pDstPixel = pDstPixels + (size_t) y * dstRowPitch;
 
-        for (uint32_t i = 0; i < numPixels; ++i, ++pSrcPixel, ++pDstPixel) {
+        for (uint32_t x = 0; x < logo.width; ++x, ++pSrcPixel, ++pDstPixel) {
             const uint32_t srcPixel = *pSrcPixel;
             const float srcRf = (uint8_t)(srcPixel);
             const float srcGf = (uint8_t)(srcPixel >> 8);
@@ -114,8 +118,8 @@ static void updateLogoSurface(const Logo& logo, const float brightness) noexcept
         }
     }
 
-    // Update the surface data
-    gpLogoSurface->setPixels(pixels.get());
+    // Done updating the surface data
+    gpLogoSurface->unlockPixels();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -6,6 +6,8 @@
 
 #include "Asserts.h"
 
+#include <algorithm>
+#include <cstring>
 #include <md5.h>
 
 BEGIN_NAMESPACE(MapHash)
@@ -39,6 +41,26 @@ void addData(const void* const pData, const int32_t dataSize) noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Copies the given data to the destination and adds it to the hash for the map in the same pass.
+// The data is copied and hashed in small chunks, so that each chunk is hashed while it is still in the CPU cache.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void copyAndAddData(void* const pDst, const void* const pSrc, const int32_t dataSize) noexcept {
+    ASSERT(dataSize >= 0);
+    constexpr int32_t CHUNK_SIZE = 16 * 1024;
+
+    std::byte* const pDstBytes = (std::byte*) pDst;
+    const std::byte* const pSrcBytes = (const std::byte*) pSrc;
+
+    for (int32_t offset = 0; offset < dataSize; offset += CHUNK_SIZE) {
+        const int32_t chunkSize = std::min(dataSize - offset, CHUNK_SIZE);
+        std::memcpy(pDstBytes + offset, pSrcBytes + offset, (size_t) chunkSize);
+        gMD5Hasher.add(pDstBytes + offset, (size_t) chunkSize);
+    }
+
+    gDataSize += dataSize;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Sets the 2 64-bit words of the hash.
 // This should be done after all of the map data has been added to the hash.
@@ -13,6 +13,7 @@ extern uint64_t     gWord2;
 
 void clear() noexcept;
 void addData(const void* const pData, const int32_t dataSize) noexcept;
+void copyAndAddData(void* const pDst, const void* const pSrc, const int32_t dataSize) noexcept;
 void finalize() noexcept;
 
 END_NAMESPACE(MapHash)
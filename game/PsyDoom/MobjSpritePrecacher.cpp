@@ -5,6 +5,7 @@
 // caches of all the textures and sprites needed for a map, arranged in nice flat files for fast CD-ROM access.
 // 
 // Instead for PsyDoom, we load all resources from the main IWAD and do it once during map load so there are no hitches during gameplay.
+// The sprite lumps are loaded in one batch and also decompressed ahead of time into the decoded texture pool, if it is enabled.
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "MobjSpritePrecacher.h"
 
@@ -15,7 +16,9 @@
 #include "Doom/Game/p_tick.h"
 #include "Doom/Game/sprinfo.h"
 #include "Doom/Renderer/r_data.h"
+#include "DecodedTexPool.h"
 
+#include <algorithm>
 #include <cstring>
 #include <vector>
 
@@ -23,6 +26,7 @@ BEGIN_NAMESPACE(MobjSpritePrecacher)
 
 static std::vector<bool>    gbCacheSprite;          // Whether to precache each sprite in the game
 static std::vector<bool>    gbCachedMobjType;       // Whether sprites were precached for each 'mobjtype_t'
+static std::vector<int32_t> gSpriteLumpsToCache;    // The lumps for all of the sprites to be precached: sorted, with no duplicates
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Clears the set of sprites to be precached and the set of map objects marked as precached
@@ -193,8 +197,11 @@ static void flagSpritesToPrecache() noexcept {
 // Precaches all sprites that are flagged for precaching
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void precacheSprites() noexcept {
-    // How many sprite lumps are there?
+    // Gather up the lumps for all the sprite frames to be precached.
+    // Many frames share the same lump for each rotation (or with other frames), so remove duplicates and sort in lump order.
+    // Sorting means the lumps are read in the order they are stored in the WAD.
     const int32_t numSprites = gNumSprites;
+    gSpriteLumpsToCache.clear();
 
     for (int32_t sprIdx = 0; sprIdx < numSprites; ++sprIdx) {
         // Ignore if this sprite was not flagged to be precached
@@ -213,10 +220,18 @@ static void precacheSprites() noexcept {
                     I_Error("SprCache: bad lump num %d!", sprLumpIdx);
                 }
 
-                W_CacheLumpNum(sprLumpIdx, PU_CACHE, false);
+                gSpriteLumpsToCache.push_back(sprLumpIdx);
             }
         }
     }
+
+    std::sort(gSpriteLumpsToCache.begin(), gSpriteLumpsToCache.end());
+    gSpriteLumpsToCache.erase(std::unique(gSpriteLumpsToCache.begin(), gSpriteLumpsToCache.end()), gSpriteLumpsToCache.end());
+
+    // Load all the sprite lumps in one batch and then decompress as many as will fit into the decoded texture pool, using the job threads
+    const int32_t numLumpsToCache = (int32_t) gSpriteLumpsToCache.size();
+    W_CacheLumpNums(gSpriteLumpsToCache.data(), numLumpsToCache, PU_CACHE, false);
+    DecodedTexPool::addLumps(gSpriteLumpsToCache.data(), numLumpsToCache);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -13,7 +13,8 @@
 #include <algorithm>
 #include <functional>
 #include <map>
-#include <unordered_set>
+#include <string>
+#include <unordered_map>
 #include <vector>
 
 // MacOS: some POSIX stuff needed due to <filesystem> workaround
@@ -25,7 +26,7 @@
 #endif
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Provides a hash for a CD file ID, required so we can put it in a set
+// Provides a hash for a CD file ID, required so we can use it as a key in a hash map
 //------------------------------------------------------------------------------------------------------------------------------------------
 template<> struct std::hash<CdFileId> {
     inline uint64_t operator()(const CdFileId& fileId) const noexcept {
@@ -38,9 +39,15 @@ BEGIN_NAMESPACE(ModMgr)
 // Maximum number of files that can be open at once by the mod manager
 static constexpr uint8_t MAX_OPEN_FILES = 16;
 
-// A set of filenames in the game that are overriden by a file in the user specified 'datadir'.
-// The names in this set are uppercased for case insensitive comparison.
-static std::unordered_set<CdFileId> gOverridenFileNames;
+// Details for a file in the user specified 'datadir' which overrides a game file
+struct OverridenFile {
+    std::string     path;       // Full path to the file, using the actual case of the filename on disk
+    int32_t         size;       // Size of the file in bytes, or '-1' if not yet known: determined on first use to avoid querying every file upfront
+};
+
+// Filenames in the game that are overriden by a file in the user specified 'datadir', and the details of each override.
+// The names in this map are uppercased for case insensitive comparison.
+static std::unordered_map<CdFileId, OverridenFile> gOverridenFiles;
 
 // A list of currently open files.
 // Only a certain amount are allowed at a time:
@@ -75,14 +82,14 @@ static void makeUppercase(char* const pStr, const size_t len) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void determineFileOverridesInUserDataDir() noexcept {
     // If there is no data dir then there are no overrides
-    gOverridenFileNames.clear();
+    gOverridenFiles.clear();
 
     if (!ProgArgs::gDataDirPath[0])
         return;
 
-    // Prealloc memory for the overriden filenames set
+    // Prealloc memory for the overriden files map
     const IsoFileSys& fileSys = PsxVm::gIsoFileSys;
-    gOverridenFileNames.reserve(fileSys.entries.size() * 8);
+    gOverridenFiles.reserve(fileSys.entries.size() * 8);
 
     // MacOS: the C++ 17 '<filesystem>' header requires MacOS Catalina as a minimum target.
     // That's a bit too much for now, so use standard POSIX stuff instead as a workaround.
@@ -105,7 +112,7 @@ static void determineFileOverridesInUserDataDir() noexcept {
                 // This functionality is desirable since the Doom format is more modding friendly and doesn't contain baked-in texture numbers.
                 CdFileId fileId = pDirEnt->d_name;
                 makeUppercase(fileId.chars, CdFileId::MAX_LEN);
-                gOverridenFileNames.insert(fileId);
+                gOverridenFiles[fileId] = OverridenFile{ getDataDirFilePath(pDirEnt->d_name), -1 };
             }
 
             closedir(pDir);
@@ -128,9 +135,10 @@ static void determineFileOverridesInUserDataDir() noexcept {
                 // allows us to add new files to variants of the game that might not have originally had them. An example of this would be
                 // allowing 'MAP01.WAD' (Doom format map) to override 'MAP01.ROM' (Final Doom format map) when the Final Doom game is loaded.
                 // This functionality is desirable since the Doom format is more modding friendly and doesn't contain baked-in texture numbers.
-                CdFileId fileId = dirIter->path().filename().u8string().c_str();
+                const auto fileName = dirIter->path().filename().u8string();
+                CdFileId fileId = fileName.c_str();
                 makeUppercase(fileId.chars, CdFileId::MAX_LEN);
-                gOverridenFileNames.insert(fileId);
+                gOverridenFiles[fileId] = OverridenFile{ getDataDirFilePath((const char*) fileName.c_str()), -1 };
 
                 ++dirIter;
             }
@@ -168,16 +176,13 @@ static bool isValidOverridenFile(const PsxCd_File& file) noexcept {
 #endif  // #if ASSERTS_ENABLED
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Get the path to an overriden file
+// Get the details for an overriden file, or 'nullptr' if the file is not overriden
 //------------------------------------------------------------------------------------------------------------------------------------------
-static std::string getOverridenFilePath(const CdFileId discFile) noexcept {
-    std::string filePath;
-    filePath.reserve(255);
-    filePath = ProgArgs::gDataDirPath;
-    filePath.push_back('/');
-    filePath += discFile.c_str().data();
-
-    return filePath;
+static OverridenFile* getOverridenFile(const CdFileId discFile) noexcept {
+    CdFileId ucaseDiscFile = discFile;
+    makeUppercase(ucaseDiscFile.chars, CdFileId::MAX_LEN);
+    const auto iter = gOverridenFiles.find(ucaseDiscFile);
+    return (iter != gOverridenFiles.end()) ? &iter->second : nullptr;
 }
 
 void init() noexcept {
@@ -194,7 +199,7 @@ void shutdown() noexcept {
     }
 
     // Clear all overrides
-    gOverridenFileNames.clear();
+    gOverridenFiles.clear();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -227,9 +232,7 @@ void addUserWads(WadList& wadList) noexcept {
 }
 
 bool areOverridesAvailableForFile(const CdFileId discFile) noexcept {
-    CdFileId ucaseDiscFile = discFile;
-    makeUppercase(ucaseDiscFile.chars, CdFileId::MAX_LEN);
-    return (gOverridenFileNames.count(ucaseDiscFile) > 0);
+    return (getOverridenFile(discFile) != nullptr);
 }
 
 bool isFileOverriden(const PsxCd_File& file) noexcept {
@@ -245,10 +248,13 @@ bool openOverridenFile(const CdFileId discFile, PsxCd_File& fileOut) noexcept {
         FatalErrors::raise("ModMgr::openOverridenFile: invalid file specified!");
     }
 
-    std::string filePath = getOverridenFilePath(discFile);
+    OverridenFile* const pOverridenFile = getOverridenFile(discFile);
+
+    if (!pOverridenFile)
+        return false;
 
     // Open the file and save it in the file slot index
-    std::FILE* const pFile = std::fopen(filePath.c_str(), "rb");
+    std::FILE* const pFile = std::fopen(pOverridenFile->path.c_str(), "rb");
 
     if (!pFile) {
         return false;
@@ -273,8 +279,9 @@ bool openOverridenFile(const CdFileId discFile, PsxCd_File& fileOut) noexcept {
         return false;
     }
 
-    // Save this in the open file slot
+    // Save this in the open file slot and remember the size of the file, since it might have changed since it was last used
     gOpenFileSlots[fileSlotIdx] = pFile;
+    pOverridenFile->size = fileSize;
 
     // Save file details and return 'true' for success
     fileOut = {};
@@ -331,8 +338,18 @@ int32_t getOverridenFileSize(const CdFileId discFile) noexcept {
         FatalErrors::raise("ModMgr::getOverridenFileSize: invalid file specified!");
     }
 
-    std::string filePath = getOverridenFilePath(discFile);
-    return (int32_t) FileUtils::getFileSize(filePath.c_str());
+    // Only query the file size if it isn't already known from a previous call or from opening the file.
+    // Note: 'psxcd' calls this with it's open files lock held, since opening the file also updates the cached size.
+    OverridenFile* const pOverridenFile = getOverridenFile(discFile);
+
+    if (!pOverridenFile)
+        return -1;
+
+    if (pOverridenFile->size < 0) {
+        pOverridenFile->size = (int32_t) FileUtils::getFileSize(pOverridenFile->path.c_str());
+    }
+
+    return pOverridenFile->size;
 }
 
 END_NAMESPACE(ModMgr)
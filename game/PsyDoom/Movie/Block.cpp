@@ -1,9 +1,16 @@
 #include "Block.h"
 
+#include "Asserts.h"
 #include "MBlockBitStream.h"
 
 #include <cstring>
 
+#if MOVIE_SIMD_SSE2
+    #include <emmintrin.h>
+#elif MOVIE_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
 BEGIN_NAMESPACE(movie)
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -66,9 +73,11 @@ static constexpr int16_t IDCT_MT[Block::PIXELS_H][Block::PIXELS_W] = {
     { IDCT_M[0][7], IDCT_M[1][7], IDCT_M[2][7], IDCT_M[3][7], IDCT_M[4][7], IDCT_M[5][7], IDCT_M[6][7], IDCT_M[7][7], },
 };
 
+#if (!(MOVIE_SIMD_SSE2 || MOVIE_SIMD_NEON)) || ASSERTS_ENABLED
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Does one matrix multiply for the inverse discrete cosine transform.
 // Assumes one of the matrixes is in 0.16 fixed point format.
+// This is the reference implementation which the SIMD version must match exactly.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void doIdctMatrixMultiply(
     const int16_t matrix1[Block::PIXELS_H][Block::PIXELS_W],
@@ -96,6 +105,69 @@ static void doIdctMatrixMultiply(
         }
     }
 }
+#endif  // #if (!(MOVIE_SIMD_SSE2 || MOVIE_SIMD_NEON)) || ASSERTS_ENABLED
+
+#if MOVIE_SIMD_SSE2 || MOVIE_SIMD_NEON
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD version of 'doIdctMatrixMultiply': computes a full row of the output matrix at a time.
+// Each row is the sum of the rows in 'matrix2' scaled by the elements in the same row of 'matrix1', with the same fixed point rounding
+// as the reference version. Results are truncated to 16-bits (not saturated) also, to match the reference version exactly.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void doIdctMatrixMultiplySimd(
+    const int16_t matrix1[Block::PIXELS_H][Block::PIXELS_W],
+    const int16_t matrix2[Block::PIXELS_H][Block::PIXELS_W],
+    int16_t outMatrix[Block::PIXELS_H][Block::PIXELS_W]
+) noexcept {
+    static_assert(Block::PIXELS_W == 8);    // Assuming a row fits in one 128-bit vector
+
+    #if MOVIE_SIMD_SSE2
+        __m128i m2Rows[Block::PIXELS_H];
+
+        for (uint32_t i = 0; i < Block::PIXELS_H; ++i) {
+            m2Rows[i] = _mm_loadu_si128((const __m128i*) matrix2[i]);
+        }
+
+        for (uint32_t row = 0; row < Block::PIXELS_H; ++row) {
+            __m128i sumLo = _mm_setzero_si128();
+            __m128i sumHi = _mm_setzero_si128();
+
+            for (uint32_t i = 0; i < Block::PIXELS_W; ++i) {
+                // Get the full 32-bit products by combining the low and high 16-bits of the multiply
+                const __m128i scale = _mm_set1_epi16(matrix1[row][i]);
+                const __m128i prodLo16 = _mm_mullo_epi16(m2Rows[i], scale);
+                const __m128i prodHi16 = _mm_mulhi_epi16(m2Rows[i], scale);
+                sumLo = _mm_add_epi32(sumLo, _mm_srai_epi32(_mm_unpacklo_epi16(prodLo16, prodHi16), 4));
+                sumHi = _mm_add_epi32(sumHi, _mm_srai_epi32(_mm_unpackhi_epi16(prodLo16, prodHi16), 4));
+            }
+
+            // Remove the rest of the fractional bits, then sign extend the low 16-bits so the pack does not saturate
+            sumLo = _mm_srai_epi32(_mm_slli_epi32(_mm_srai_epi32(sumLo, 12), 16), 16);
+            sumHi = _mm_srai_epi32(_mm_slli_epi32(_mm_srai_epi32(sumHi, 12), 16), 16);
+            _mm_storeu_si128((__m128i*) outMatrix[row], _mm_packs_epi32(sumLo, sumHi));
+        }
+    #elif MOVIE_SIMD_NEON
+        int16x8_t m2Rows[Block::PIXELS_H];
+
+        for (uint32_t i = 0; i < Block::PIXELS_H; ++i) {
+            m2Rows[i] = vld1q_s16(matrix2[i]);
+        }
+
+        for (uint32_t row = 0; row < Block::PIXELS_H; ++row) {
+            int32x4_t sumLo = vdupq_n_s32(0);
+            int32x4_t sumHi = vdupq_n_s32(0);
+
+            for (uint32_t i = 0; i < Block::PIXELS_W; ++i) {
+                const int16x4_t scale = vdup_n_s16(matrix1[row][i]);
+                sumLo = vaddq_s32(sumLo, vshrq_n_s32(vmull_s16(vget_low_s16(m2Rows[i]), scale), 4));
+                sumHi = vaddq_s32(sumHi, vshrq_n_s32(vmull_s16(vget_high_s16(m2Rows[i]), scale), 4));
+            }
+
+            // Remove the rest of the fractional bits and truncate to 16-bits
+            vst1q_s16(outMatrix[row], vcombine_s16(vmovn_s32(vshrq_n_s32(sumLo, 12)), vmovn_s32(vshrq_n_s32(sumHi, 12))));
+        }
+    #endif
+}
+#endif  // #if MOVIE_SIMD_SSE2 || MOVIE_SIMD_NEON
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Reorders the matrix values in the block so that they are no longer in MPEG1/JPEG 'zig-zag' order
@@ -144,8 +216,23 @@ static void dequantizeBlock(Block& block, const int16_t quantizationScale) noexc
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void applyInverseDiscreteCosineTransformToBlock(Block& block) noexcept {
     int16_t tmpMatrix[Block::PIXELS_H][Block::PIXELS_W];
-    doIdctMatrixMultiply(IDCT_MT, block.mValues, tmpMatrix);
-    doIdctMatrixMultiply(tmpMatrix, IDCT_M, block.mValues);
+
+    #if MOVIE_SIMD_SSE2 || MOVIE_SIMD_NEON
+        // Debug builds: compute the result using the reference version also so it can be checked against
+        #if ASSERTS_ENABLED
+            int16_t refTmpMatrix[Block::PIXELS_H][Block::PIXELS_W];
+            int16_t refMatrix[Block::PIXELS_H][Block::PIXELS_W];
+            doIdctMatrixMultiply(IDCT_MT, block.mValues, refTmpMatrix);
+            doIdctMatrixMultiply(refTmpMatrix, IDCT_M, refMatrix);
+        #endif
+
+        doIdctMatrixMultiplySimd(IDCT_MT, block.mValues, tmpMatrix);
+        doIdctMatrixMultiplySimd(tmpMatrix, IDCT_M, block.mValues);
+        ASSERT(std::memcmp(block.mValues, refMatrix, sizeof(refMatrix)) == 0);
+    #else
+        doIdctMatrixMultiply(IDCT_MT, block.mValues, tmpMatrix);
+        doIdctMatrixMultiply(tmpMatrix, IDCT_M, block.mValues);
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -201,15 +288,15 @@ void Block::clear() noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Tries to read and decode the block of values.
-// Takes the quantization scale for the frame as input.
+// Tries to read the matrix of DC and AC coefficients for the block, without decoding them into final values.
+// This step must be done in order for all blocks in a frame, since the blocks are all stored in the same bitstream.
 //------------------------------------------------------------------------------------------------------------------------------------------
-bool Block::readAndDecode(MBlockBitStream& inputStream, const int16_t quantizationScale) noexcept {
+bool Block::read(MBlockBitStream& inputStream) noexcept {
     // The set of AC coefficients (63 total) doesn't have to be complete within the stream.
     // The unspecified ones must be zero-initialized if not provided:
     clear();
 
-    // Firstly read/decode the DC coefficients and all the AC coefficients.
+    // Read the DC coefficients and all the AC coefficients.
     // If that fails clear the block and abort with failure:
     try {
         readDcAndAcCoeffForBlock(*this, inputStream);
@@ -218,13 +305,31 @@ bool Block::readAndDecode(MBlockBitStream& inputStream, const int16_t quantizati
         return false;
     }
 
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes the coefficients previously read for the block into the final block values.
+// Takes the quantization scale for the frame as input.
+// Unlike reading, this step has no dependencies on other blocks and so can be done for blocks in any order and on any thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Block::decode(const int16_t quantizationScale) noexcept {
     // Reverse the zig-zag matrix order, dequantize and apply the inverse discrete cosine transform.
     // This yields the final block values.
     unZigZagBlock(*this);
     dequantizeBlock(*this, quantizationScale);
     applyInverseDiscreteCosineTransformToBlock(*this);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to read and decode the block of values.
+// Takes the quantization scale for the frame as input.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool Block::readAndDecode(MBlockBitStream& inputStream, const int16_t quantizationScale) noexcept {
+    if (!read(inputStream))
+        return false;
 
-    // All good if we've made it to here!
+    decode(quantizationScale);
     return true;
 }
 
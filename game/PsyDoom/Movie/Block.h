@@ -4,6 +4,13 @@
 
 #include <cstdint>
 
+// Use SIMD instructions (SSE2 or NEON) for the inverse discrete cosine transform and color conversion, if supported by the target
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define MOVIE_SIMD_SSE2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define MOVIE_SIMD_NEON 1
+#endif
+
 BEGIN_NAMESPACE(movie)
 
 class MBlockBitStream;
@@ -18,6 +25,8 @@ struct Block {
     static constexpr uint32_t PIXELS_H = 8;     // Height of the block in pixels
 
     void clear() noexcept;
+    bool read(MBlockBitStream& inputStream) noexcept;
+    void decode(const int16_t quantizationScale) noexcept;
     bool readAndDecode(MBlockBitStream& inputStream, const int16_t quantizationScale) noexcept;
 
     int16_t mValues[PIXELS_H][PIXELS_W];
@@ -1,10 +1,12 @@
 #include "Frame.h"
 
+#include "Asserts.h"
 #include "CDXAFileStreamer.h"
 #include "Endian.h"
 #include "FatalErrors.h"
 #include "MacroBlockDecoder.h"
 #include "MBlockBitStream.h"
+#include "PsyDoom/GameJobs.h"
 
 #include <cstdlib>
 #include <cstring>
@@ -14,6 +16,13 @@ BEGIN_NAMESPACE(movie)
 // In an MDEC video sector there's just 2048 bytes of data, and 32 of that is taken up by the header
 constexpr uint32_t VIDEO_DATA_BYTES_PER_SECTOR = 2048 - sizeof(FrameSectorHeader);
 
+// Context for the jobs decoding a frame's macro blocks: the frame being decoded and where the pixels are being output to
+struct DecodePixelsJobCtx {
+    Frame*      pFrame;
+    uint32_t*   pPixelsOut;
+    uint32_t    rowPitch;
+};
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Endian correction: swaps the bytes in the frame header
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -43,6 +52,7 @@ Frame::Frame() noexcept
     , mDemuxedDataCapacity(0)
     , mpPixelBuffer(nullptr)
     , mPixelBufferCapacity(0)
+    , mMacroBlockCoeffs()
 {
     ensureDemuxedDataBufferCapacity(sizeof(VIDEO_DATA_BYTES_PER_SECTOR) * 8);       // Should be enough for all frames...
 }
@@ -71,12 +81,13 @@ void Frame::clear() noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Attempts to read and decode a frame of video.
+// Attempts to read a frame of video and the coefficients for all of its macro blocks.
+// The frame must then be decoded to pixels with 'decodePixels'.
 // Returns false if that is not possible due to the end of the file being encountered, or some sort of error.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool Frame::read(CDXAFileStreamer& cdStreamer, const uint8_t channelNum) noexcept {
     clear();
-    const bool bSuccess = (demuxFrame(cdStreamer, channelNum) && decodeMacroBlocks());
+    const bool bSuccess = (demuxFrame(cdStreamer, channelNum) && readMacroBlockCoeffs());
 
     if (!bSuccess) {
         clear();
@@ -110,7 +121,7 @@ void Frame::ensurePixelBufferCapacity(const uint32_t capacity) noexcept {
     mPixelBufferCapacity = capacity;
     mpPixelBuffer = (uint32_t*) std::realloc(mpPixelBuffer, capacity * sizeof(uint32_t));
 
-    if (!mpDemuxedData) {
+    if (!mpPixelBuffer) {
         FatalErrors::outOfMemory();
     }
 }
@@ -219,12 +230,35 @@ bool Frame::demuxFrame(CDXAFileStreamer& cdStreamer, const uint8_t channelNum) n
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Decodes the 16x16 pixel blocks that make up the the movie frame and saves them to the pixel buffer
+// Decodes the frame that was read into the frame's own pixel buffer, which can then be retrieved with 'getPixels'.
+// Note: this can only be done once for each frame read, since decoding modifies the macro block coefficients.
 //------------------------------------------------------------------------------------------------------------------------------------------
-bool Frame::decodeMacroBlocks() noexcept {
-    // Ensure we have enough room in the buffer for the decoded frame
+void Frame::decodePixels() noexcept {
     ensurePixelBufferCapacity((uint32_t) mFirstSecHdr.frameW * mFirstSecHdr.frameH);
+    decodePixels(mpPixelBuffer, mFirstSecHdr.frameW);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes the frame that was read to the given pixel buffer, which must fit the dimensions of the frame.
+// The row pitch is the distance between rows in the pixel buffer, in pixels.
+// This allows the frame to be decoded straight into memory owned by the video backend.
+// Note: this can only be done once for each frame read, since decoding modifies the macro block coefficients.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Frame::decodePixels(uint32_t* const pPixelsOut, const uint32_t rowPitch) noexcept {
+    ASSERT(pPixelsOut);
+    ASSERT(rowPitch >= mFirstSecHdr.frameW);
 
+    // Decoding the coefficients to pixels doesn't depend on other macro blocks: decode each column of blocks in parallel
+    const uint32_t blocksW = (mFirstSecHdr.frameW + 15u) / 16u;
+
+    DecodePixelsJobCtx jobCtx = { this, pPixelsOut, rowPitch };
+    GameJobs::run(decodeMacroBlockColumnJob, &jobCtx, blocksW);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the coefficients for all of the 16x16 pixel macro blocks that make up the the movie frame, so they can be decoded later
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool Frame::readMacroBlockCoeffs() noexcept {
     // There must be more than 8-bytes in the stream (see below)
     if (mDemuxedDataSize <= 8)
         return false;
@@ -242,38 +276,59 @@ bool Frame::decodeMacroBlocks() noexcept {
     MBlockBitStream frameDataStream;
     frameDataStream.open((const uint16_t*)(mpDemuxedData + 8), (mDemuxedDataSize - 8) / sizeof(uint16_t));
 
-    // The macro blocks are arranged in a column major order, decode in that fashion.
+    // The macro blocks are arranged in a column major order.
     // If the frame size is not an even multiple of 16 then the extra pixels are simply padding that are ignored.
     const uint32_t blocksW = (mFirstSecHdr.frameW + 15u) / 16u;
     const uint32_t blocksH = (mFirstSecHdr.frameH + 15u) / 16u;
+    const uint32_t numMacroBlocks = blocksW * blocksH;
 
-    for (uint32_t bx = 0; bx < blocksW; ++bx) {
-        for (uint32_t by = 0; by < blocksH; ++by) {
-            // Decode this block of pixels and abort if failed
-            uint32_t blockPixels[16][16];
-
-            if (!MacroBlockDecoder::decode(frameDataStream, mFirstSecHdr.quantizationScale, blockPixels))
-                return false;
-
-            // Copy the pixels to the pixel buffer, the ones that are in range at least
-            const uint32_t dstStartX = bx * 16u;
-            const uint32_t dstStartY = by * 16u;
-            const uint32_t dstEndX = std::min(dstStartX + 16u, (uint32_t) mFirstSecHdr.frameW);
-            const uint32_t dstEndY = std::min(dstStartY + 16u, (uint32_t) mFirstSecHdr.frameH);
-            const uint32_t copyRectW = dstEndX - dstStartX;
-            const uint32_t copyRectH = dstEndY - dstStartY;
-
-            for (uint32_t y = 0; y < copyRectH; ++y) {
-                for (uint32_t x = 0; x < copyRectW; ++x) {
-                    const uint32_t dstX = dstStartX + x;
-                    const uint32_t dstY = dstStartY + y;
-                    mpPixelBuffer[mFirstSecHdr.frameW * dstY + dstX] = blockPixels[y][x];
-                }
-            }
-        }
+    if (mMacroBlockCoeffs.size() < numMacroBlocks) {
+        mMacroBlockCoeffs.resize(numMacroBlocks);
+    }
+
+    // Firstly read the coefficients for all of the macro blocks and abort if that fails.
+    // This has to be done in order since all of the blocks are stored in the same bitstream.
+    for (uint32_t blockIdx = 0; blockIdx < numMacroBlocks; ++blockIdx) {
+        if (!MacroBlockDecoder::readCoeffs(frameDataStream, mMacroBlockCoeffs[blockIdx]))
+            return false;
     }
 
     return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Job which decodes the column of macro blocks with the given index for the frame being decoded and saves them to the output pixels
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Frame::decodeMacroBlockColumnJob(void* const pCtx, const uint32_t jobIdx) noexcept {
+    const DecodePixelsJobCtx& jobCtx = *(const DecodePixelsJobCtx*) pCtx;
+    Frame& frame = *jobCtx.pFrame;
+    uint32_t* const pPixelsOut = jobCtx.pPixelsOut;
+    const uint32_t rowPitch = jobCtx.rowPitch;
+    const FrameSectorHeader& hdr = frame.mFirstSecHdr;
+    const uint32_t blocksH = (hdr.frameH + 15u) / 16u;
+    const uint32_t bx = jobIdx;
+
+    for (uint32_t by = 0; by < blocksH; ++by) {
+        // Decode this block of pixels
+        uint32_t blockPixels[16][16];
+        MacroBlockDecoder::decodeCoeffs(frame.mMacroBlockCoeffs[bx * blocksH + by], hdr.quantizationScale, blockPixels);
+
+        // Copy the pixels to the pixel buffer, the ones that are in range at least
+        const uint32_t dstStartX = bx * 16u;
+        const uint32_t dstStartY = by * 16u;
+        const uint32_t dstEndX = std::min(dstStartX + 16u, (uint32_t) hdr.frameW);
+        const uint32_t dstEndY = std::min(dstStartY + 16u, (uint32_t) hdr.frameH);
+        const uint32_t copyRectW = dstEndX - dstStartX;
+        const uint32_t copyRectH = dstEndY - dstStartY;
+
+        for (uint32_t y = 0; y < copyRectH; ++y) {
+            for (uint32_t x = 0; x < copyRectW; ++x) {
+                const uint32_t dstX = dstStartX + x;
+                const uint32_t dstY = dstStartY + y;
+                pPixelsOut[rowPitch * dstY + dstX] = blockPixels[y][x];
+            }
+        }
+    }
+}
+
 END_NAMESPACE(movie)
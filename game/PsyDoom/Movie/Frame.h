@@ -1,5 +1,6 @@
 #pragma once
 
+#include "MacroBlockDecoder.h"
 #include "Macros.h"
 
 #include <cstdint>
@@ -48,6 +49,8 @@ public:
     ~Frame() noexcept;
     void clear() noexcept;
     bool read(CDXAFileStreamer& cdStreamer, const uint8_t channelNum) noexcept;
+    void decodePixels() noexcept;
+    void decodePixels(uint32_t* const pPixelsOut, const uint32_t rowPitch) noexcept;
 
 private:
     Frame(const Frame& other) = delete;
@@ -58,7 +61,8 @@ private:
     void getFrameSectorHeader(const CDXASector& sector, FrameSectorHeader& hdrOut) noexcept;
     void bufferFrameData(const CDXASector& sector) noexcept;
     bool demuxFrame(CDXAFileStreamer& cdStreamer, const uint8_t channelNum) noexcept;
-    bool decodeMacroBlocks() noexcept;
+    bool readMacroBlockCoeffs() noexcept;
+    static void decodeMacroBlockColumnJob(void* const pCtx, const uint32_t jobIdx) noexcept;
 
     FrameSectorHeader   mFirstSecHdr;           // Holds the header for the first sector in the frame, subsequent sectors largely duplicate this info
     std::byte*          mpDemuxedData;          // Buffer holding the de-multiplexed compressed data for the frame
@@ -66,6 +70,9 @@ private:
     uint32_t            mDemuxedDataCapacity;   // Size of the demuxed frame data buffer
     uint32_t*           mpPixelBuffer;          // Pixel buffer for holding decoded frame data (32-bit ABGR8888)
     uint32_t            mPixelBufferCapacity;   // The number of pixels that the pixel buffer can hold
+
+    // Coefficients for all macro blocks in the frame, read from the bitstream in column major order and then decoded in parallel
+    std::vector<MacroBlockDecoder::Coeffs>  mMacroBlockCoeffs;
 };
 
 END_NAMESPACE(movie)
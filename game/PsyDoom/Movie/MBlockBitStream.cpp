@@ -5,6 +5,98 @@
 
 BEGIN_NAMESPACE(movie)
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Lookup tables for decoding AC coefficient variable length codes (including the sign bit).
+//
+// All codes which do not begin with 8 zero bits are at most 13 bits long, and are decoded by indexing the 'short' table with the next 13
+// bits of the stream. The remaining codes are at most 17 bits long and are decoded by indexing the 'long' table with the 9 bits which
+// follow the initial 8 zero bits. Both tables are generated once at startup from the tree based decoder, which is the reference.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr uint32_t VLC_SHORT_TABLE_BITS = 13;
+static constexpr uint32_t VLC_LONG_TABLE_BITS = 9;
+static constexpr uint32_t VLC_LONG_PREFIX_BITS = 8;
+
+// What type of code an entry in the lookup tables is for
+enum class VlcType : uint8_t {
+    Invalid,    // Not a valid code
+    Coeff,      // A regular code for an AC coefficient
+    Eof,        // End of the block's coefficients
+    Escape,     // Escape code: a 6-bit zero count and a 10-bit coefficient follow
+    Long        // A code which begins with 8 zero bits: look up the 'long' table to decode it
+};
+
+// An entry in the lookup tables
+struct VlcEntry {
+    VlcType     type;
+    uint8_t     numBits;    // Length of the code (including sign bit) if it's an AC coefficient or EOF code
+    uint16_t    numZeros;   // AC coefficient: number of zero value coefficients that precede the non-zero one
+    int16_t     coeff;      // AC coefficient: the non-zero coefficient value (signed)
+};
+
+struct VlcTables {
+    VlcEntry shortTable[1u << VLC_SHORT_TABLE_BITS];
+    VlcEntry longTable[1u << VLC_LONG_TABLE_BITS];
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: decodes a single AC coefficient using the tree based (reference) decoder from the given bits (up to 32) at the start of a stream.
+// The rest of the stream is zero padded. Returns a table entry describing the decoded code.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static VlcEntry decodeVlcEntryUsingTree(const uint32_t codeBits, const uint32_t numCodeBits) noexcept {
+    const uint32_t alignedBits = codeBits << (32u - numCodeBits);
+    const uint16_t words[4] = {
+        Endian::hostToLittle((uint16_t)(alignedBits >> 16)),
+        Endian::hostToLittle((uint16_t)(alignedBits)),
+        0,
+        0
+    };
+
+    MBlockBitStream bitStream;
+    bitStream.open(words, C_ARRAY_SIZE(words));
+
+    try {
+        const ACCoeff coeff = bitStream.readACCoeffUsingTree();
+        const uint32_t numBitsRead = bitStream.getNumBitsRead();
+        ASSERT(numBitsRead <= numCodeBits);
+
+        if (coeff.isEof())
+            return VlcEntry{ VlcType::Eof, (uint8_t) numBitsRead, 0, 0 };
+
+        return VlcEntry{ VlcType::Coeff, (uint8_t) numBitsRead, coeff.numZeroValueCoeff, coeff.nonZeroCoeff };
+    } catch (...) {
+        return VlcEntry{ VlcType::Invalid, 0, 0, 0 };
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Generates the lookup tables for decoding AC coefficients
+//------------------------------------------------------------------------------------------------------------------------------------------
+static VlcTables buildVlcTables() noexcept {
+    VlcTables tables = {};
+
+    for (uint32_t bits = 0; bits < C_ARRAY_SIZE(tables.shortTable); ++bits) {
+        VlcEntry& entry = tables.shortTable[bits];
+        const uint32_t prefix8 = bits >> (VLC_SHORT_TABLE_BITS - VLC_LONG_PREFIX_BITS);
+        const uint32_t prefix6 = bits >> (VLC_SHORT_TABLE_BITS - 6);
+
+        if (prefix8 == 0) {
+            entry = VlcEntry{ VlcType::Long, 0, 0, 0 };
+        } else if (prefix6 == 0b000001) {
+            entry = VlcEntry{ VlcType::Escape, 6, 0, 0 };
+        } else {
+            entry = decodeVlcEntryUsingTree(bits, VLC_SHORT_TABLE_BITS);
+        }
+    }
+
+    for (uint32_t bits = 0; bits < C_ARRAY_SIZE(tables.longTable); ++bits) {
+        tables.longTable[bits] = decodeVlcEntryUsingTree(bits, VLC_LONG_PREFIX_BITS + VLC_LONG_TABLE_BITS);
+    }
+
+    return tables;
+}
+
+static const VlcTables gVlcTables = buildVlcTables();
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Creates an unopened bit stream
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -12,8 +104,8 @@ MBlockBitStream::MBlockBitStream() noexcept
     : mpWords(nullptr)
     , mSize(0)
     , mCurOffset(0)
-    , mCurWord(0)
-    , mCurWordBitsLeft(0)
+    , mBitBuffer(0)
+    , mNumBufferedBits(0)
 {
 }
 
@@ -26,8 +118,8 @@ void MBlockBitStream::open(const uint16_t* pWords, const uint32_t numWords) noex
     mpWords = pWords;
     mSize = numWords;
     mCurOffset = 0;
-    mCurWord = 0;
-    mCurWordBitsLeft = 0;
+    mBitBuffer = 0;
+    mNumBufferedBits = 0;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -37,30 +129,55 @@ void MBlockBitStream::close() noexcept {
     mpWords = nullptr;
     mSize = 0;
     mCurOffset = 0;
-    mCurWord = 0;
-    mCurWordBitsLeft = 0;
+    mBitBuffer = 0;
+    mNumBufferedBits = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns how many bits have been read from the stream so far
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t MBlockBitStream::getNumBitsRead() const noexcept {
+    return mCurOffset * 16u - mNumBufferedBits;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Reads a single bit; throws an exception if that is not possible
+// Attempts to read a series of AC coefficients from the bit stream using the lookup tables
 //------------------------------------------------------------------------------------------------------------------------------------------
-uint16_t MBlockBitStream::readBit() THROWS {
-    // Get the next 16-bit word of data if all bits are consumed
-    if (mCurWordBitsLeft <= 0) {
-        nextWord();
+ACCoeff MBlockBitStream::readACCoeff() THROWS {
+    // Lookup the code in the table for short codes first, and then the table for long codes if required
+    const VlcEntry* pEntry = &gVlcTables.shortTable[peekBits(VLC_SHORT_TABLE_BITS)];
+
+    if (pEntry->type == VlcType::Long) {
+        const uint32_t longBits = peekBits(VLC_LONG_PREFIX_BITS + VLC_LONG_TABLE_BITS) & ((1u << VLC_LONG_TABLE_BITS) - 1u);
+        pEntry = &gVlcTables.longTable[longBits];
     }
 
-    // Return the next bit in the currently loaded word.
-    // Note that the highest bits are read first.
-    --mCurWordBitsLeft;
-    const uint16_t bit = (mCurWord >> mCurWordBitsLeft) & 0x1u;
-    return bit;
+    switch (pEntry->type) {
+        case VlcType::Coeff:
+            consumeBits(pEntry->numBits);
+            return ACCoeff{ pEntry->numZeros, pEntry->coeff };
+
+        case VlcType::Eof:
+            consumeBits(pEntry->numBits);
+            return ACCoeff::eof();
+
+        case VlcType::Escape:
+            consumeBits(pEntry->numBits);
+            return readACCoeff_0000_01();
+
+        case VlcType::Long:
+        case VlcType::Invalid:
+            break;
+    }
+
+    throw ErrorType::INVALID_ENCODING;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Attempts to read a series of AC coefficients from the bit stream
+// Attempts to read a series of AC coefficients from the bit stream by walking the tree of possible codes, one bit at a time.
+// This is much slower than 'readACCoeff', but it serves as the reference implementation and is used to build the lookup tables.
 //------------------------------------------------------------------------------------------------------------------------------------------
-ACCoeff MBlockBitStream::readACCoeff() THROWS {
+ACCoeff MBlockBitStream::readACCoeffUsingTree() THROWS {
     // Read the first two bits of the variable length code.
     // There will always be at least two bits in one of these:
     const uint16_t topBits = readBits<2>();
@@ -76,21 +193,16 @@ ACCoeff MBlockBitStream::readACCoeff() THROWS {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Loads the next 16-bit word into the bit stream.
-// Throws an exception if there is no more data available.
+// Buffers more bits from the array of words, if there are any left.
+// Buffers as many whole 16-bit words as will fit in the bit buffer.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void MBlockBitStream::nextWord() THROWS {
-    if (mCurOffset >= mSize)
-        throw ErrorType::UNEXPECTED_EOF;
-
-    if constexpr (Endian::isLittle()) {
-        mCurWord = mpWords[mCurOffset];
-    } else {
-        mCurWord = Endian::byteSwap(mpWords[mCurOffset]);
+void MBlockBitStream::bufferMoreBits() noexcept {
+    while ((mNumBufferedBits <= 48) && (mCurOffset < mSize)) {
+        const uint16_t word = Endian::littleToHost(mpWords[mCurOffset]);
+        mBitBuffer |= (uint64_t) word << (48u - mNumBufferedBits);
+        mNumBufferedBits += 16;
+        mCurOffset++;
     }
-
-    mCurWordBitsLeft = 16;
-    mCurOffset++;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
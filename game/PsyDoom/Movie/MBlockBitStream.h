@@ -28,6 +28,7 @@ struct ACCoeff {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Movie block bitstream: provides the means for individual blocks in an MDEC movie frame to be read.
 // Wraps an array of 16-bit words and provides a bit oriented input stream from that array.
+// Bits are buffered from the array up to 64 bits at a time, and AC coefficients are decoded using lookup tables.
 // 
 // For more info on MDEC movie decoding see: https://github.com/m35/jpsxdec/blob/readme/jpsxdec/PlayStation1_STR_format.txt
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -45,8 +46,16 @@ public:
     void open(const uint16_t* pWords, const uint32_t numWords) noexcept;
     void close() noexcept;
     inline bool isOpen() const noexcept { return (mpWords != nullptr); }
+    uint32_t getNumBitsRead() const noexcept;
 
-    uint16_t readBit() THROWS;
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Reads a single bit; throws an exception if that is not possible
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    inline uint16_t readBit() THROWS {
+        const uint16_t bit = (uint16_t) peekBits(1);
+        consumeBits(1);
+        return bit;
+    }
 
     //--------------------------------------------------------------------------------------------------------------------------------------
     // Reads the specified number of bits (up to 16) as an unsigned integer.
@@ -57,40 +66,44 @@ public:
         // Sanity check the number of bits is ok
         static_assert((NumReadBits >= 1) && (NumReadBits <= 16));
 
-        if constexpr (NumReadBits == 1) {
-            // Special case: reading a single bit
-            return readBit();
-        } else {
-            // Regular case: reading 2 or more bits, may have to extract bits from 2 different words.
-            // First check for the easy case where all bits are available in the currently loaded word:
-            const uint16_t numBitsFree = mCurWordBitsLeft;
-            const uint16_t numBitsConsumed = 16 - numBitsFree;
-            constexpr uint16_t READ_BITS_MASK = 0xFFFFu >> (16u - NumReadBits);
-
-            if (numBitsFree >= NumReadBits) {
-                mCurWordBitsLeft = numBitsFree - NumReadBits;
-                const uint16_t bits = (mCurWord >> mCurWordBitsLeft) & READ_BITS_MASK;
-                return bits;
-            }
-
-            // Harder case: must split up the read across two 16-bit words; read the first chunk of bits:
-            const uint16_t highBits = mCurWord & (0xFFFFu >> numBitsConsumed);
-            const uint16_t numHighBits = numBitsFree;
-            const uint16_t numLowBits = NumReadBits - numHighBits;
-            const uint16_t lowBitsMask = READ_BITS_MASK >> numHighBits;
-
-            // Get a fresh word and read the rest of the bits
-            nextWord();
-            mCurWordBitsLeft -= numLowBits;
-            const uint16_t lowBits = (mCurWord >> mCurWordBitsLeft) & lowBitsMask;
-            return (highBits << numLowBits) | lowBits;
-        }
+        const uint16_t bits = (uint16_t) peekBits(NumReadBits);
+        consumeBits(NumReadBits);
+        return bits;
     }
 
     ACCoeff readACCoeff() THROWS;
+    ACCoeff readACCoeffUsingTree() THROWS;
 
 private:
-    void nextWord() THROWS;
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Returns the next specified number of bits (up to 32) in the stream without consuming them.
+    // If there are not enough bits left in the stream then the missing bits are returned as zeros.
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    inline uint32_t peekBits(const uint32_t numBits) noexcept {
+        if (mNumBufferedBits < numBits) {
+            bufferMoreBits();
+        }
+
+        return (uint32_t)(mBitBuffer >> (64u - numBits));
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Consumes the specified number of bits (up to 32) in the stream.
+    // Throws an exception if there are not that many bits left in the stream.
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    inline void consumeBits(const uint32_t numBits) THROWS {
+        if (mNumBufferedBits < numBits) {
+            bufferMoreBits();
+
+            if (mNumBufferedBits < numBits)
+                throw ErrorType::UNEXPECTED_EOF;
+        }
+
+        mBitBuffer <<= numBits;
+        mNumBufferedBits -= numBits;
+    }
+
+    void bufferMoreBits() noexcept;
 
     ACCoeff readACCoeffSign(const uint16_t numZeroValueCoeff, const int16_t nonZeroCoeff) THROWS;
     ACCoeff readACCoeff_00() THROWS;
@@ -108,9 +121,9 @@ private:
 
     const uint16_t* mpWords;            // The array of 16-bit (little endian) words to be read
     uint32_t        mSize;              // How many 16-bit words there are in 'mpWords'
-    uint32_t        mCurOffset;         // Which word we are currently on in 'mpWords'
-    uint16_t        mCurWord;           // The current word we are reading bits from
-    uint16_t        mCurWordBitsLeft;   // How many bits are remaining to read from the current word
+    uint32_t        mCurOffset;         // Which word is to be buffered next in 'mpWords'
+    uint64_t        mBitBuffer;         // Bits buffered from 'mpWords' that have yet to be read, starting at the highest bit (unused bits are '0')
+    uint32_t        mNumBufferedBits;   // How many bits in the bit buffer are valid
 };
 
 END_NAMESPACE(movie)
@@ -8,70 +8,257 @@
 
 #include <algorithm>
 
+#if MOVIE_SIMD_SSE2
+    #include <emmintrin.h>
+#elif MOVIE_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
 BEGIN_NAMESPACE(movie)
 BEGIN_NAMESPACE(MacroBlockDecoder)
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Attempts to decode a 16x16 block of pixels in the movie.
+// Converts a pixel from YCbCr to ABGR8888 format.
+// This is the reference implementation which the SIMD version must match.
+//------------------------------------------------------------------------------------------------------------------------------------------
+[[maybe_unused]] static uint32_t convertPixelToAbgr(const int16_t luma, const int16_t chromaR, const int16_t chromaB) noexcept {
+    // Firstly get the chroma red and blue values as well as the luma value
+    const float chromaRf = (float) chromaR;
+    const float chromaBf = (float) chromaB;
+    const float lumaF = (float)(luma + 128);    // Note: +128 for JPEG 'level shift' (see jpsxdec docs for more on this)
+
+    // Convert YCbCr to RGB and clamp between 0 and 255
+    const float colorRf = std::clamp(lumaF + 1.4020f * chromaRf + 0.5f, 0.0f, 255.0f);
+    const float colorGf = std::clamp(lumaF - 0.3437f * chromaBf - 0.7143f * chromaRf + 0.5f, 0.0f, 255.0f);
+    const float colorBf = std::clamp(lumaF + 1.7720f * chromaBf + 0.5f, 0.0f, 255.0f);
+
+    // Convert to 8-bit RGB and return the pixel in ABGR8888 format
+    const uint32_t colorR = (uint32_t) colorRf;
+    const uint32_t colorG = (uint32_t) colorGf;
+    const uint32_t colorB = (uint32_t) colorBf;
+
+    return 0xFF000000 | (colorB << 16) | (colorG << 8) | colorR;
+}
+
+#if MOVIE_SIMD_SSE2
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SSE2 helpers for color conversion: converts the low and high 4 of 8 signed 16-bit integers to floats
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline __m128 int16LoToFloat(const __m128i vals) noexcept {
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(vals, vals), 16));
+}
+
+static inline __m128 int16HiToFloat(const __m128i vals) noexcept {
+    return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(vals, vals), 16));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SSE2 version of 'convertPixelToAbgr' for 4 pixels at a time.
+// Does the same floating point operations in the same order as the reference version, so the results match.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline void convert4PixelsToAbgr(const __m128 lumaF, const __m128 chromaRf, const __m128 chromaBf, uint32_t* const pPixelsOut) noexcept {
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 max = _mm_set1_ps(255.0f);
+    const __m128 half = _mm_set1_ps(0.5f);
+
+    const __m128 colorRf = _mm_add_ps(_mm_add_ps(lumaF, _mm_mul_ps(_mm_set1_ps(1.4020f), chromaRf)), half);
+    const __m128 colorGf = _mm_add_ps(_mm_sub_ps(_mm_sub_ps(lumaF, _mm_mul_ps(_mm_set1_ps(0.3437f), chromaBf)), _mm_mul_ps(_mm_set1_ps(0.7143f), chromaRf)), half);
+    const __m128 colorBf = _mm_add_ps(_mm_add_ps(lumaF, _mm_mul_ps(_mm_set1_ps(1.7720f), chromaBf)), half);
+
+    const __m128i colorR = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(colorRf, max), zero));
+    const __m128i colorG = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(colorGf, max), zero));
+    const __m128i colorB = _mm_cvttps_epi32(_mm_max_ps(_mm_min_ps(colorBf, max), zero));
+
+    const __m128i abgr = _mm_or_si128(
+        _mm_or_si128(_mm_set1_epi32((int32_t) 0xFF000000), _mm_slli_epi32(colorB, 16)),
+        _mm_or_si128(_mm_slli_epi32(colorG, 8), colorR)
+    );
+
+    _mm_storeu_si128((__m128i*) pPixelsOut, abgr);
+}
+#elif MOVIE_SIMD_NEON
+//------------------------------------------------------------------------------------------------------------------------------------------
+// NEON helpers for color conversion: converts the low and high 4 of 8 signed 16-bit integers to floats
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline float32x4_t int16LoToFloat(const int16x8_t vals) noexcept {
+    return vcvtq_f32_s32(vmovl_s16(vget_low_s16(vals)));
+}
+
+static inline float32x4_t int16HiToFloat(const int16x8_t vals) noexcept {
+    return vcvtq_f32_s32(vmovl_s16(vget_high_s16(vals)));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// NEON version of 'convertPixelToAbgr' for 4 pixels at a time.
+// Does the same floating point operations in the same order as the reference version (no fused multiply adds).
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline void convert4PixelsToAbgr(
+    const float32x4_t lumaF,
+    const float32x4_t chromaRf,
+    const float32x4_t chromaBf,
+    uint32_t* const pPixelsOut
+) noexcept {
+    const float32x4_t zero = vdupq_n_f32(0.0f);
+    const float32x4_t max = vdupq_n_f32(255.0f);
+    const float32x4_t half = vdupq_n_f32(0.5f);
+
+    const float32x4_t colorRf = vaddq_f32(vaddq_f32(lumaF, vmulq_n_f32(chromaRf, 1.4020f)), half);
+    const float32x4_t colorGf = vaddq_f32(vsubq_f32(vsubq_f32(lumaF, vmulq_n_f32(chromaBf, 0.3437f)), vmulq_n_f32(chromaRf, 0.7143f)), half);
+    const float32x4_t colorBf = vaddq_f32(vaddq_f32(lumaF, vmulq_n_f32(chromaBf, 1.7720f)), half);
+
+    const uint32x4_t colorR = vcvtq_u32_f32(vmaxq_f32(vminq_f32(colorRf, max), zero));
+    const uint32x4_t colorG = vcvtq_u32_f32(vmaxq_f32(vminq_f32(colorGf, max), zero));
+    const uint32x4_t colorB = vcvtq_u32_f32(vmaxq_f32(vminq_f32(colorBf, max), zero));
+
+    const uint32x4_t abgr = vorrq_u32(
+        vorrq_u32(vdupq_n_u32(0xFF000000), vshlq_n_u32(colorB, 16)),
+        vorrq_u32(vshlq_n_u32(colorG, 8), colorR)
+    );
+
+    vst1q_u32(pPixelsOut, abgr);
+}
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Attempts to read the coefficients for the 6 blocks within a macro block:
+//
+//  cr = Chroma Red
+//  cb = Chroma Blue
+//  y[0] = Luma (top left)
+//  y[1] = Luma (top right)
+//  y[2] = Luma (bottom left)
+//  y[3] = Luma (bottom right)
+//
+// This step must be done serially for all macro blocks in a frame, since they are all read from the same bitstream.
+// Returns 'false' on failure to read the blocks.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool readCoeffs(MBlockBitStream& inputStream, Coeffs& coeffs) noexcept {
+    return (
+        coeffs.cr.read(inputStream) &&
+        coeffs.cb.read(inputStream) &&
+        coeffs.y[0].read(inputStream) &&
+        coeffs.y[1].read(inputStream) &&
+        coeffs.y[2].read(inputStream) &&
+        coeffs.y[3].read(inputStream)
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes the previously read coefficients for a macro block into a 16x16 block of pixels in the movie.
 // Takes the quantization scale for the frame as input and outputs the pixels to the specified array.
-// Returns 'false' on failure to read or decode the block.
+// The coefficient blocks are modified during decoding. Macro blocks can be decoded in any order and on any thread.
 // For more on this, see: https://github.com/m35/jpsxdec/blob/readme/jpsxdec/PlayStation1_STR_format.txt
 //------------------------------------------------------------------------------------------------------------------------------------------
-bool decode(
-    MBlockBitStream& inputStream,
+void decodeCoeffs(
+    Coeffs& coeffs,
     const int16_t quantizationScale,
     uint32_t pPixelsOut[PIXELS_H][PIXELS_W]
 ) noexcept {
     ASSERT(pPixelsOut);
 
-    // Firstly decode the 6 blocks within this macro block:
-    // 
-    //  cr = Chroma Red
-    //  cb = Chroma Blue
-    //  y[0] = Luma (top left)
-    //  y[1] = Luma (top right)
-    //  y[2] = Luma (bottom left)
-    //  y[3] = Luma (bottom right)
-    //
+    // Firstly decode the 6 blocks within this macro block.
     // Note that the chroma blocks cover a 16x16 pixel area but each luma block covers a 8x8 pixel area.
     // Thus luma resolution is twice that of color.
-    Block blockCr, blockCb, blockY[4];
-
-    const bool bDecodedAllBlocksOk = (
-        blockCr.readAndDecode(inputStream, quantizationScale) &&
-        blockCb.readAndDecode(inputStream, quantizationScale) &&
-        blockY[0].readAndDecode(inputStream, quantizationScale) &&
-        blockY[1].readAndDecode(inputStream, quantizationScale) &&
-        blockY[2].readAndDecode(inputStream, quantizationScale) &&
-        blockY[3].readAndDecode(inputStream, quantizationScale)
-    );
+    const Block& blockCr = coeffs.cr;
+    const Block& blockCb = coeffs.cb;
+    const Block* const blockY = coeffs.y;
 
-    if (!bDecodedAllBlocksOk)
-        return false;
+    coeffs.cr.decode(quantizationScale);
+    coeffs.cb.decode(quantizationScale);
+    coeffs.y[0].decode(quantizationScale);
+    coeffs.y[1].decode(quantizationScale);
+    coeffs.y[2].decode(quantizationScale);
+    coeffs.y[3].decode(quantizationScale);
 
     // Process each pixel and convert to ABGR8888 format
-    for (uint32_t y = 0; y < PIXELS_H; ++y) {
-        for (uint32_t x = 0; x < PIXELS_W; ++x) {
-            // Firstly get the chroma red and blue values as well as the luma value
-            const float chromaRf = (float) blockCr.mValues[y / 2][x / 2];
-            const float chromaBf = (float) blockCb.mValues[y / 2][x / 2];
-            const Block& lumaBlock = blockY[(y / 8) * 2 + (x / 8)];
-            const float lumaF = (float)(lumaBlock.mValues[y % 8][x % 8] + 128);     // Note: +128 for JPEG 'level shift' (see jpsxdec docs for more on this)
-
-            // Convert YCbCr to RGB and clamp between 0 and 255
-            const float colorRf = std::clamp(lumaF + 1.4020f * chromaRf + 0.5f, 0.0f, 255.0f);
-            const float colorGf = std::clamp(lumaF - 0.3437f * chromaBf - 0.7143f * chromaRf + 0.5f, 0.0f, 255.0f);
-            const float colorBf = std::clamp(lumaF + 1.7720f * chromaBf + 0.5f, 0.0f, 255.0f);
-
-            // Convert to 8-bit RGB and save the output pixel in ABGR8888 format
-            const uint32_t colorR = (uint32_t) colorRf;
-            const uint32_t colorG = (uint32_t) colorGf;
-            const uint32_t colorB = (uint32_t) colorBf;
-
-            pPixelsOut[y][x] = 0xFF000000 | (colorB << 16) | (colorG << 8) | colorR;
+    #if MOVIE_SIMD_SSE2 || MOVIE_SIMD_NEON
+        // SIMD version: do an entire row of 16 pixels at a time.
+        // Each row uses 8 chroma values (each one covers 2 pixels) and a row from 2 luma blocks.
+        static_assert(PIXELS_W == 16);
+
+        for (uint32_t y = 0; y < PIXELS_H; ++y) {
+            const Block& lumaBlockL = blockY[(y / 8) * 2 + 0];
+            const Block& lumaBlockR = blockY[(y / 8) * 2 + 1];
+            uint32_t* const pRowOut = pPixelsOut[y];
+
+            #if MOVIE_SIMD_SSE2
+                const __m128i chromaR = _mm_loadu_si128((const __m128i*) blockCr.mValues[y / 2]);
+                const __m128i chromaB = _mm_loadu_si128((const __m128i*) blockCb.mValues[y / 2]);
+                const __m128i lumaL = _mm_loadu_si128((const __m128i*) lumaBlockL.mValues[y % 8]);
+                const __m128i lumaR = _mm_loadu_si128((const __m128i*) lumaBlockR.mValues[y % 8]);
+                const __m128 levelShift = _mm_set1_ps(128.0f);     // Note: +128 for JPEG 'level shift', done in float to avoid 16-bit overflow
+
+                // Duplicate each chroma value across the 2 pixels it covers
+                const __m128 chromaRLo = int16LoToFloat(chromaR);
+                const __m128 chromaRHi = int16HiToFloat(chromaR);
+                const __m128 chromaBLo = int16LoToFloat(chromaB);
+                const __m128 chromaBHi = int16HiToFloat(chromaB);
+
+                const __m128 lumaF[4] = {
+                    _mm_add_ps(int16LoToFloat(lumaL), levelShift),
+                    _mm_add_ps(int16HiToFloat(lumaL), levelShift),
+                    _mm_add_ps(int16LoToFloat(lumaR), levelShift),
+                    _mm_add_ps(int16HiToFloat(lumaR), levelShift),
+                };
+
+                convert4PixelsToAbgr(lumaF[0], _mm_unpacklo_ps(chromaRLo, chromaRLo), _mm_unpacklo_ps(chromaBLo, chromaBLo), pRowOut + 0);
+                convert4PixelsToAbgr(lumaF[1], _mm_unpackhi_ps(chromaRLo, chromaRLo), _mm_unpackhi_ps(chromaBLo, chromaBLo), pRowOut + 4);
+                convert4PixelsToAbgr(lumaF[2], _mm_unpacklo_ps(chromaRHi, chromaRHi), _mm_unpacklo_ps(chromaBHi, chromaBHi), pRowOut + 8);
+                convert4PixelsToAbgr(lumaF[3], _mm_unpackhi_ps(chromaRHi, chromaRHi), _mm_unpackhi_ps(chromaBHi, chromaBHi), pRowOut + 12);
+            #else
+                const int16x8_t chromaR = vld1q_s16(blockCr.mValues[y / 2]);
+                const int16x8_t chromaB = vld1q_s16(blockCb.mValues[y / 2]);
+                const int16x8_t lumaL = vld1q_s16(lumaBlockL.mValues[y % 8]);
+                const int16x8_t lumaR = vld1q_s16(lumaBlockR.mValues[y % 8]);
+                const float32x4_t levelShift = vdupq_n_f32(128.0f);     // Note: +128 for JPEG 'level shift', done in float to avoid 16-bit overflow
+
+                // Duplicate each chroma value across the 2 pixels it covers
+                const float32x4x2_t chromaRLo = vzipq_f32(int16LoToFloat(chromaR), int16LoToFloat(chromaR));
+                const float32x4x2_t chromaRHi = vzipq_f32(int16HiToFloat(chromaR), int16HiToFloat(chromaR));
+                const float32x4x2_t chromaBLo = vzipq_f32(int16LoToFloat(chromaB), int16LoToFloat(chromaB));
+                const float32x4x2_t chromaBHi = vzipq_f32(int16HiToFloat(chromaB), int16HiToFloat(chromaB));
+
+                convert4PixelsToAbgr(vaddq_f32(int16LoToFloat(lumaL), levelShift), chromaRLo.val[0], chromaBLo.val[0], pRowOut + 0);
+                convert4PixelsToAbgr(vaddq_f32(int16HiToFloat(lumaL), levelShift), chromaRLo.val[1], chromaBLo.val[1], pRowOut + 4);
+                convert4PixelsToAbgr(vaddq_f32(int16LoToFloat(lumaR), levelShift), chromaRHi.val[0], chromaBHi.val[0], pRowOut + 8);
+                convert4PixelsToAbgr(vaddq_f32(int16HiToFloat(lumaR), levelShift), chromaRHi.val[1], chromaBHi.val[1], pRowOut + 12);
+            #endif
+
+            // Debug builds: check the output against the reference version.
+            // Note: not done for NEON since the compiler may fuse the multiply and adds in the reference version, causing tiny differences.
+            #if ASSERTS_ENABLED && MOVIE_SIMD_SSE2
+                for (uint32_t x = 0; x < PIXELS_W; ++x) {
+                    const Block& lumaBlock = blockY[(y / 8) * 2 + (x / 8)];
+                    ASSERT(pRowOut[x] == convertPixelToAbgr(lumaBlock.mValues[y % 8][x % 8], blockCr.mValues[y / 2][x / 2], blockCb.mValues[y / 2][x / 2]));
+                }
+            #endif
         }
-    }
+    #else
+        for (uint32_t y = 0; y < PIXELS_H; ++y) {
+            for (uint32_t x = 0; x < PIXELS_W; ++x) {
+                const Block& lumaBlock = blockY[(y / 8) * 2 + (x / 8)];
+                pPixelsOut[y][x] = convertPixelToAbgr(lumaBlock.mValues[y % 8][x % 8], blockCr.mValues[y / 2][x / 2], blockCb.mValues[y / 2][x / 2]);
+            }
+        }
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Attempts to read and decode a 16x16 block of pixels in the movie.
+// Takes the quantization scale for the frame as input and outputs the pixels to the specified array.
+// Returns 'false' on failure to read or decode the block.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool decode(
+    MBlockBitStream& inputStream,
+    const int16_t quantizationScale,
+    uint32_t pPixelsOut[PIXELS_H][PIXELS_W]
+) noexcept {
+    Coeffs coeffs;
+
+    if (!readCoeffs(inputStream, coeffs))
+        return false;
 
+    decodeCoeffs(coeffs, quantizationScale, pPixelsOut);
     return true;
 }
 
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "Block.h"
 #include "Macros.h"
 
 #include <cstdint>
@@ -13,6 +14,22 @@ BEGIN_NAMESPACE(MacroBlockDecoder)
 static constexpr uint32_t PIXELS_W = 16;    // Width of the decoded block in pixels
 static constexpr uint32_t PIXELS_H = 16;    // Height of the decoded block in pixels
 
+// Holds the 6 blocks of coefficients for a macro block, as read from the bitstream.
+// Luma blocks are ordered: top left, top right, bottom left, bottom right.
+struct Coeffs {
+    Block   cr;     // Chroma red
+    Block   cb;     // Chroma blue
+    Block   y[4];   // Luma
+};
+
+bool readCoeffs(MBlockBitStream& inputStream, Coeffs& coeffs) noexcept;
+
+void decodeCoeffs(
+    Coeffs& coeffs,
+    const int16_t quantizationScale,
+    uint32_t pPixelsOut[PIXELS_H][PIXELS_W]     // 32-bit ABGR8888 format
+) noexcept;
+
 bool decode(
     MBlockBitStream& inputStream,
     const int16_t quantizationScale,
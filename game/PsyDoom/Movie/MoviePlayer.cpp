@@ -17,6 +17,7 @@
 
 #include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <mutex>
 #include <thread>
 
@@ -24,7 +25,13 @@ BEGIN_NAMESPACE(movie)
 BEGIN_NAMESPACE(MoviePlayer)
 
 // How many audio sectors to read ahead for
-static constexpr uint32_t AUDIO_BUFFER_SECTORS = 16;
+static constexpr uint32_t AUDIO_BUFFER_SECTORS = 32;
+
+// How many resampled 44,100 Hz audio samples can be buffered for the audio thread (~0.19 seconds): must be a power of two
+static constexpr uint32_t RESAMPLED_AUDIO_BUFFER_SIZE = 8192;
+
+// How many video frames the decoder thread can decode ahead of the frame being displayed
+static constexpr uint32_t NUM_DECODE_AHEAD_FRAMES = 4;
 
 // Convenience typedefs
 typedef XAAdpcmDecoder::SectorAudio             AudioSector;
@@ -32,12 +39,21 @@ typedef std::unique_ptr<Video::IVideoSurface>   IVideoSurfacePtr;
 
 static bool                         gbIsPlaying;                            // True if the movie is playing currently
 static CDXAFileStreamer             gVideoFileStream;                       // File stream for the movie's video
-static Frame                        gFrame;                                 // This container is used to decode a movie frame
+static Frame                        gFrames[NUM_DECODE_AHEAD_FRAMES];       // Ring of frames read ahead by the decoder thread, waiting to be displayed
+static std::thread                  gDecodeThread;                          // Thread which reads and decodes video frames (and audio sectors) ahead of time
+static std::mutex                   gDecodeMutex;                           // Guards the decoded frame ring state below
+static std::condition_variable      gDecodeCondVar;                         // Signalled when a frame in the ring is consumed or when the decoder thread should stop
+static uint32_t                     gNumDecodedFrames;                      // How many frames in the ring are decoded and waiting to be displayed
+static uint32_t                     gNextDecodeFrameIdx;                    // Index of the next frame in the ring for the decoder thread to decode into
+static uint32_t                     gNextDisplayFrameIdx;                   // Index of the next frame in the ring to display
+static bool                         gbVideoStreamEnded;                     // Set by the decoder thread when no more frames can be read
+static bool                         gbStopDecodeThread;                     // Set to request that the decoder thread exits
 static IVideoSurfacePtr             gpFrameSurface;                         // Holds a decoded video frame ready to display to the screen
 static std::mutex                   gAudioDecodeMutex;                      // Mutex guarding the audio file and decode context
 static CDXAFileStreamer             gAudioFileStream;                       // File stream for the movie's audio
 static XAAdpcmDecoder::Context      gAudioDecodeCtx;                        // Audio decoding context
 static std::atomic<bool>            gbCanReadAudioSectors;                  // Set to 'true' while audio sectors for the movie can be read
+static std::atomic<bool>            gbCanResampleAudio;                     // Set to 'true' while audio samples for the movie can be resampled
 static std::atomic<bool>            gbCanPlayAudioSamples;                  // Set to 'true' while audio samples for the movie can be played
 static Spu::StereoSample            gAudioSamples[4];                       // Audio samples for cubic resampling: previous, current, next, post next
 static AudioSector                  gAudioSectors[AUDIO_BUFFER_SECTORS];    // Audio sectors that have been buffered
@@ -49,6 +65,9 @@ static std::mutex                   gAudioSectorsMutex;                     // S
 static std::vector<AudioSector*>    gEmptyAudioSectors;                     // Which audio sectors are consumed and free to populate
 static std::vector<AudioSector*>    gDecodingAudioSectors;                  // Which audio sectors are currently being decoded
 static std::vector<AudioSector*>    gReadyAudioSectors;                     // Which audio sectors are populated with data and ready to use
+static Spu::StereoSample            gResampledAudio[RESAMPLED_AUDIO_BUFFER_SIZE];   // Ring buffer of resampled audio, produced by the decoder thread and consumed by the audio thread
+static std::atomic<uint32_t>        gResampledAudioWriteIdx;                // Index of the next resampled sample to be written: only changed by the decoder thread
+static std::atomic<uint32_t>        gResampledAudioReadIdx;                 // Index of the next resampled sample to be read: only changed by the audio thread
 static Spu::ExtInputCallback        gPrevAudioExtInput;                     // Previous audio external input callback: restored after playback finishes
 static void*                        gPrevAudioExtInputUserdata;             // User data for the previous audio external input callback
 
@@ -144,7 +163,7 @@ static bool tryDecodeMovieAudioSector() noexcept {
         gDecodingAudioSectors.erase(iter);
         
         // The audio sector is now free again since decoding failed
-        gEmptyAudioSectors.push_back(gpCurAudioSector);
+        gEmptyAudioSectors.push_back(pAudioSector);
 
         // We are done!
         return false;
@@ -179,7 +198,7 @@ static void tryLoadNextAudioSample() noexcept {
     // See if we need to grab a new audio sector
     const bool bNeedNewAudioSector = ((!gpCurAudioSector) || (gCurAudioSampleIdx >= gpCurAudioSector->numSamples));
 
-    if (bNeedNewAudioSector && gbCanPlayAudioSamples) {
+    if (bNeedNewAudioSector && gbCanResampleAudio) {
         // Free the current audio sector (if we have one) and determine whether any audio sectors are ready
         bool bIsAudioReady = {};
 
@@ -214,8 +233,8 @@ static void tryLoadNextAudioSample() noexcept {
                 gAudioSampleTimeStep = (float) gpCurAudioSector->sampleRate / 44100.0f;
             } else {
                 // We failed to get another audio sector when one was needed.
-                // This means playback is now done:
-                gbCanPlayAudioSamples = false;
+                // This means resampling is now done:
+                gbCanResampleAudio = false;
             }
         }
     }
@@ -235,10 +254,9 @@ static void tryLoadNextAudioSample() noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Audio callback for the movie player.
-// Called on the audio thread to retrieve the next sample of audio from the movie.
+// Resamples the movie's audio to get the next 44,100 Hz audio sample
 //------------------------------------------------------------------------------------------------------------------------------------------
-static Spu::StereoSample movieGetAudioSampleCallback([[maybe_unused]] void* const pUserData) noexcept {
+static Spu::StereoSample getNextResampledAudioSample() noexcept {
     // Move along time and grab new samples if required
     gCurAudioSampleTime += gAudioSampleTimeStep;
 
@@ -263,6 +281,121 @@ static Spu::StereoSample movieGetAudioSampleCallback([[maybe_unused]] void* cons
     return interpolated;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Fills up the buffer of resampled audio for the audio thread, until it is full or there is no more audio to resample.
+// Should only be called by the decoder thread while it is running, since that is the only producer of resampled audio.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void resampleMovieAudio() noexcept {
+    uint32_t writeIdx = gResampledAudioWriteIdx.load(std::memory_order_relaxed);
+    const uint32_t readIdx = gResampledAudioReadIdx.load(std::memory_order_acquire);
+
+    for (uint32_t numFree = RESAMPLED_AUDIO_BUFFER_SIZE - (writeIdx - readIdx); (numFree > 0) && gbCanResampleAudio; --numFree, ++writeIdx) {
+        gResampledAudio[writeIdx & (RESAMPLED_AUDIO_BUFFER_SIZE - 1)] = getNextResampledAudioSample();
+    }
+
+    // Note: this must be published before the audio thread can see that resampling has ended, so no samples are missed at the end
+    gResampledAudioWriteIdx.store(writeIdx, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Audio callback for the movie player.
+// Called on the audio thread to retrieve the next sample of audio from the movie, which has already been resampled by the decoder thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static Spu::StereoSample movieGetAudioSampleCallback([[maybe_unused]] void* const pUserData) noexcept {
+    // Check whether resampling has ended before checking if the buffer is empty, so the last samples written are definitely visible
+    const bool bCanResampleAudio = gbCanResampleAudio;
+    const uint32_t readIdx = gResampledAudioReadIdx.load(std::memory_order_relaxed);
+    const uint32_t writeIdx = gResampledAudioWriteIdx.load(std::memory_order_acquire);
+
+    if (readIdx != writeIdx) {
+        const Spu::StereoSample sample = gResampledAudio[readIdx & (RESAMPLED_AUDIO_BUFFER_SIZE - 1)];
+        gResampledAudioReadIdx.store(readIdx + 1, std::memory_order_release);
+        return sample;
+    }
+
+    // If the buffer is empty and no more audio will be resampled then playback is now done.
+    // Otherwise the decoder thread has fallen behind, output silence until it catches up.
+    if (!bCanResampleAudio) {
+        gbCanPlayAudioSamples = false;
+    }
+
+    return {};
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Entry point for the decoder thread.
+// Reads video frames (up to the point of the macro block coefficients) into the ring of frames until it is full, and keeps the audio
+// buffers topped up while doing so.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void decodeThreadMain() noexcept {
+    while (true) {
+        // Decode and resample audio first since the audio thread can't tolerate running out of samples as well as video can tolerate a late frame
+        while (tryDecodeMovieAudioSector()) {}
+        resampleMovieAudio();
+
+        // Wait for a free frame in the ring, or for a stop request.
+        // Note: wake up periodically even if no frames are free so audio sectors consumed by the audio thread get refilled.
+        uint32_t decodeFrameIdx = {};
+
+        {
+            std::unique_lock<std::mutex> decodeLock(gDecodeMutex);
+
+            if (gbStopDecodeThread)
+                break;
+
+            if (gbVideoStreamEnded || (gNumDecodedFrames >= NUM_DECODE_AHEAD_FRAMES)) {
+                gDecodeCondVar.wait_for(decodeLock, std::chrono::milliseconds(5));
+                continue;
+            }
+
+            decodeFrameIdx = gNextDecodeFrameIdx;
+        }
+
+        // Decode the frame: this slot in the ring is not touched by the main thread until it is published below
+        const bool bReadFrame = gFrames[decodeFrameIdx].read(gVideoFileStream, 1);
+
+        {
+            std::lock_guard<std::mutex> decodeLock(gDecodeMutex);
+
+            if (bReadFrame) {
+                gNextDecodeFrameIdx = (gNextDecodeFrameIdx + 1) % NUM_DECODE_AHEAD_FRAMES;
+                gNumDecodedFrames++;
+            } else {
+                gbVideoStreamEnded = true;
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Starts the decoder thread for the movie
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void startDecodeThread() noexcept {
+    gNumDecodedFrames = 0;
+    gNextDecodeFrameIdx = 0;
+    gNextDisplayFrameIdx = 0;
+    gbVideoStreamEnded = false;
+    gbStopDecodeThread = false;
+    gDecodeThread = std::thread(decodeThreadMain);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stops the decoder thread for the movie (if running) and waits for it to exit
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void stopDecodeThread() noexcept {
+    if (!gDecodeThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> decodeLock(gDecodeMutex);
+        gbStopDecodeThread = true;
+    }
+
+    gDecodeCondVar.notify_all();
+    gDecodeThread.join();
+    gDecodeThread = {};
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Starts playback of the specified movie: returns 'false' on failure
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -283,7 +416,10 @@ static bool initMoviePlayback(const char* const cdFilePath) noexcept {
     // Note that we don't need synchronization here yet because audio playback hasn't started.
     gAudioDecodeCtx.init();
     gbCanReadAudioSectors = true;
+    gbCanResampleAudio = true;
     gbCanPlayAudioSamples = true;
+    gResampledAudioWriteIdx = 0;
+    gResampledAudioReadIdx = 0;
     
     for (Spu::StereoSample& sample : gAudioSamples) {
         sample = {};
@@ -305,12 +441,14 @@ static bool initMoviePlayback(const char* const cdFilePath) noexcept {
         gEmptyAudioSectors.push_back(&sector);
     }
 
-    // Pre-fill the audio buffer a little so we don't lag behind when the audio device wants it
+    // Pre-fill the audio buffers so we don't lag behind when the audio device wants it
     for (uint32_t i = 0; i < AUDIO_BUFFER_SECTORS; ++i) {
         if (!tryDecodeMovieAudioSector())
             break;
     }
 
+    resampleMovieAudio();
+
     // Install the external audio input callback.
     // This will cause the movie's audio to be fed to the SPU:
     {
@@ -325,6 +463,9 @@ static bool initMoviePlayback(const char* const cdFilePath) noexcept {
 
     // Begin external surface display: will be submitting frames manually from here on in
     Video::getCurrentBackend().beginExternalSurfaceDisplay();
+
+    // Start decoding frames ahead of time
+    startDecodeThread();
     return true;
 }
 
@@ -332,6 +473,13 @@ static bool initMoviePlayback(const char* const cdFilePath) noexcept {
 // Shuts down playback of the movie and cleans up resources
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void shutdownMoviePlayback() noexcept {
+    // Stop decoding frames and audio sectors before cleaning up the streams and buffers
+    stopDecodeThread();
+
+    for (Frame& frame : gFrames) {
+        frame.clear();
+    }
+
     // Uninstall the audio callback and restore the previous one
     {
         PsxVm::LockSpu lockSpu;
@@ -357,7 +505,10 @@ static void shutdownMoviePlayback() noexcept {
     }
     
     gbCanPlayAudioSamples = false;
+    gbCanResampleAudio = false;
     gbCanReadAudioSectors = false;
+    gResampledAudioWriteIdx = 0;
+    gResampledAudioReadIdx = 0;
     gAudioDecodeCtx.init();
 
     gpFrameSurface.reset();
@@ -386,33 +537,71 @@ static bool shouldContinueMoviePlayback() noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Attempts to read the next frame of video.
-// Returns 'false' if that is not possible due to the end of the video being reached or if an error occurs.
+// Result of trying to get the next frame of video from the decoder thread
 //------------------------------------------------------------------------------------------------------------------------------------------
-static bool readNextVideoFrame() noexcept {
-    // Read the frame firstly
-    if (!gFrame.read(gVideoFileStream, 1))
-        return false;
+enum class NextFrameResult {
+    Ready,          // The next frame was uploaded to the frame surface
+    NotReady,       // The next frame has not been decoded yet
+    Finished        // The end of the video has been reached or an error occurred
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Attempts to get the next frame of video read by the decoder thread, then decode it to pixels and upload it to the frame surface.
+// Only the serial part of decoding (reading the macro block coefficients) is done ahead of time on the decoder thread. Converting the
+// coefficients to pixels is done here (in parallel) so that the pixels can be written straight to the surface, avoiding another copy.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static NextFrameResult readNextVideoFrame() noexcept {
+    // Is there a decoded frame available?
+    uint32_t frameIdx = {};
+
+    {
+        std::lock_guard<std::mutex> decodeLock(gDecodeMutex);
+
+        if (gNumDecodedFrames <= 0)
+            return (gbVideoStreamEnded) ? NextFrameResult::Finished : NextFrameResult::NotReady;
+
+        frameIdx = gNextDisplayFrameIdx;
+    }
+
+    Frame& frame = gFrames[frameIdx];
 
     // See if we need to make a new surface to hold this frame and create it if so
     const bool bNeedNewSurface = (
         (!gpFrameSurface) ||
-        (gpFrameSurface->getWidth() != gFrame.getWidth()) ||
-        (gpFrameSurface->getHeight() != gFrame.getHeight())
+        (gpFrameSurface->getWidth() != frame.getWidth()) ||
+        (gpFrameSurface->getHeight() != frame.getHeight())
     );
 
     if (bNeedNewSurface) {
         Video::IVideoBackend& vidBackend = Video::getCurrentBackend();
-        gpFrameSurface = vidBackend.createSurface(gFrame.getWidth(), gFrame.getHeight());
+        gpFrameSurface = vidBackend.createSurface(frame.getWidth(), frame.getHeight());
     }
 
     // Abort if we don't have a valid surface
     if (!gpFrameSurface)
-        return false;
+        return NextFrameResult::Finished;
 
-    // Populate the surface with the frame's pixels
-    gpFrameSurface->setPixels(gFrame.getPixels());
-    return true;
+    // Decode the frame's pixels straight into the surface if the surface allows that, otherwise decode and then copy.
+    // Once done hand the frame back to the decoder thread.
+    uint32_t surfaceRowPitch = 0;
+    uint32_t* const pSurfacePixels = gpFrameSurface->lockPixels(surfaceRowPitch);
+
+    if (pSurfacePixels) {
+        frame.decodePixels(pSurfacePixels, surfaceRowPitch);
+        gpFrameSurface->unlockPixels();
+    } else {
+        frame.decodePixels();
+        gpFrameSurface->setPixels(frame.getPixels());
+    }
+
+    {
+        std::lock_guard<std::mutex> decodeLock(gDecodeMutex);
+        gNextDisplayFrameIdx = (gNextDisplayFrameIdx + 1) % NUM_DECODE_AHEAD_FRAMES;
+        gNumDecodedFrames--;
+    }
+
+    gDecodeCondVar.notify_one();
+    return NextFrameResult::Ready;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -476,25 +665,35 @@ static void moviePlaybackLoop(const float secondsPerFrame) noexcept {
         const int32_t tgtFrameIndex = (int32_t)(elapsedTimeSecs / secondsPerFrame);
 
         if (curFrameIndex < tgtFrameIndex) {
-            // Time to read another frame!
-            // Read the frame or end the loop if we can't:
-            if (!readNextVideoFrame())
+            // Time to show another frame!
+            // Grab the frame from the decoder thread or end the loop if there are no more.
+            // If the decoder thread is running behind then just keep showing the current frame until it catches up.
+            const NextFrameResult result = readNextVideoFrame();
+
+            if (result == NextFrameResult::Finished)
                 break;
 
-            ++curFrameIndex;
+            if (result == NextFrameResult::Ready) {
+                ++curFrameIndex;
+            }
         }
 
         // Show the currently loaded frame and update the window afterwards.
-        // Also buffer audio on the main thread, so it's ready for the audio thread when needed.
+        // Audio is buffered by the decoder thread, so ready for the audio thread when needed.
         displayCurrentVideoFrame();
-        tryDecodeMovieAudioSector();
         Input::update();
+
+        // Don't spin the CPU while waiting for the next frame to be due: sleep a little, but not so long that input becomes unresponsive
+        if (curFrameIndex >= tgtFrameIndex) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
     }
 
     // Wait for audio playback to finish if behind
     while (gbCanPlayAudioSamples && shouldContinueMoviePlayback()) {
         displayCurrentVideoFrame();
         Input::update();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
 }
 
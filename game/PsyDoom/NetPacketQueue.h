@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A fixed size lock-free queue of network packets (or other items) for passing data between exactly two threads.
+// One thread (the producer) may push items and one other thread (the consumer) may pop them; no other usage patterns are supported.
+// Used to pass tick packets between the game thread and the network thread without either having to lock or wait on the other.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class T, uint32_t Capacity>
+class NetPacketQueue {
+public:
+    static_assert((Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two!");
+
+    NetPacketQueue() noexcept
+        : mReadIdx(0)
+        , mWriteIdx(0)
+        , mItems{}
+    {
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Tells if there are no items in the queue.
+    // Note: if called by the producer the queue may become empty at any time, if called by the consumer it may become non-empty.
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    inline bool isEmpty() const noexcept {
+        return (mReadIdx.load(std::memory_order_acquire) == mWriteIdx.load(std::memory_order_acquire));
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Producer only: adds an item to the back of the queue.
+    // Returns 'false' if the queue is full, in which case the item is not added.
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    bool tryPush(const T& item) noexcept {
+        const uint32_t writeIdx = mWriteIdx.load(std::memory_order_relaxed);
+
+        if (writeIdx - mReadIdx.load(std::memory_order_acquire) >= Capacity)
+            return false;
+
+        mItems[writeIdx & (Capacity - 1)] = item;
+        mWriteIdx.store(writeIdx + 1, std::memory_order_release);
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Consumer only: removes the item at the front of the queue and saves it to the given output.
+    // Returns 'false' if the queue is empty.
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    bool tryPop(T& itemOut) noexcept {
+        const uint32_t readIdx = mReadIdx.load(std::memory_order_relaxed);
+
+        if (readIdx == mWriteIdx.load(std::memory_order_acquire))
+            return false;
+
+        itemOut = mItems[readIdx & (Capacity - 1)];
+        mReadIdx.store(readIdx + 1, std::memory_order_release);
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Empties the queue: must only be called when neither the producer or consumer is using the queue
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    void clear() noexcept {
+        mReadIdx.store(0, std::memory_order_relaxed);
+        mWriteIdx.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    // Note: the read and write indexes are free running and wrap naturally, only their lower bits are used to index the items
+    alignas(64) std::atomic<uint32_t>   mReadIdx;           // Index of the next item to be popped (only modified by the consumer)
+    alignas(64) std::atomic<uint32_t>   mWriteIdx;          // Index of the next item to be pushed (only modified by the producer)
+    T                                   mItems[Capacity];   // Storage for the queue items
+};
@@ -3,15 +3,21 @@
 #include "Doom/Base/i_main.h"
 #include "Doom/Game/p_tick.h"
 #include "Doom/UI/m_main.h"
+#include "Endian.h"
 #include "Input.h"
-#include "NetPacketReader.h"
-#include "NetPacketWriter.h"
+#include "NetPacketQueue.h"
 #include "ProgArgs.h"
 #include "PsxPadButtons.h"
 #include "PsyQ/LIBETC.h"
 #include "Utils.h"
 #include "Video.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <thread>
+
 // This prevents warnings in ASIO about the Windows SDK target version not being specified
 #if _WIN32
     #include <sdkddkver.h>
@@ -27,13 +33,72 @@ BEGIN_NAMESPACE(Network)
 bool gbWasInitAborted = false;
 
 // Maximum number of input/output tick packets that can be buffered
-static constexpr int32_t MAX_TICK_PKTS = 2;
+static constexpr uint32_t MAX_TICK_PKTS = 8;
+
+// A tick packet received from the other peer and the time it was received
+struct RecvTickPacket {
+    NetPacket_Tick                          packet;
+    std::chrono::system_clock::time_point   receiveTime;
+};
 
-static std::unique_ptr<asio::io_context>                                    gpIoContext;
-static std::unique_ptr<asio::ip::tcp::socket>                               gpSocket;
-static std::unique_ptr<NetPacketReader<NetPacket_Tick, MAX_TICK_PKTS>>      gTickPacketReader;
-static std::unique_ptr<NetPacketWriter<NetPacket_Tick, MAX_TICK_PKTS>>      gTickPacketWriter;
-static bool                                                                 gbWasWaitForAsyncNetOpAborted;
+typedef asio::executor_work_guard<asio::io_context::executor_type> IoWorkGuard;
+
+static std::unique_ptr<asio::io_context>                gpIoContext;
+static std::unique_ptr<asio::ip::tcp::socket>           gpSocket;
+static bool                                             gbWasWaitForAsyncNetOpAborted;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Once the game begins the io context is run on a dedicated network thread, which sends and receives tick packets in the background.
+// The game thread only pushes tick packets to the outgoing queue and pops them from the incoming queue, so it never has to wait on any
+// network I/O itself - just for the other peer's packet to arrive. Before the game begins (while connecting and doing the handshake) the
+// io context is instead polled by the game thread as it waits for each operation to complete.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::thread                                      gNetThread;             // Runs the io context once the game begins
+static std::unique_ptr<IoWorkGuard>                     gpNetThreadWorkGuard;   // Stops the network thread exiting when there is no work
+static std::atomic<bool>                                gbNetThreadError;       // Set by the network thread if the connection is lost
+static NetPacketQueue<NetPacket_Tick, MAX_TICK_PKTS>    gOutTickPackets;        // Tick packets to be sent by the network thread
+static NetPacketQueue<RecvTickPacket, MAX_TICK_PKTS>    gInTickPackets;         // Tick packets received by the network thread
+static NetPacket_Tick                                   gNetThreadReadPkt;      // Network thread only: the tick packet currently being read
+static NetPacket_Tick                                   gNetThreadWritePkt;     // Network thread only: the tick packet currently being written
+static bool                                             gbNetThreadWriting;     // Network thread only: true if a tick packet write is in progress
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Optional UDP transport for tick packets, enabled via the '-udp' command line argument (both peers must use it).
+//
+// The TCP connection is still used to connect, for the initial handshake and to detect the other peer disconnecting; only tick packets
+// are sent over UDP. Every tick packet is given a sequence number and each datagram sent contains all tick packets not yet acknowledged
+// by the other peer (oldest first), along with an acknowledgement of the tick packets received so far. This means a lost datagram does
+// not stall the game: the next datagram sent carries the same tick packets again. While waiting on the other peer the last datagram is
+// also periodically resent, in case it was the one that was lost.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr uint32_t   UDP_DGRAM_MAGIC         = 0x50445550;   // 'PUDP'
+static constexpr uint32_t   UDP_MAX_DGRAM_TICKS     = 16;           // Maximum number of tick packets sent in the one datagram
+static constexpr uint32_t   UDP_MAX_UNACKED_TICKS   = 256;          // If more than this many tick packets are unacknowledged then the connection is killed
+static constexpr auto       UDP_RESEND_INTERVAL     = std::chrono::milliseconds(20);
+static constexpr auto       UDP_TIMEOUT             = std::chrono::seconds(10);
+
+// Header for a datagram containing tick packets; all fields are little endian.
+// It is followed by 'numTicks' tick packets, which have sequence numbers 'firstSeq' onwards.
+struct UdpDgramHeader {
+    uint32_t    magic;          // Identifies the datagram as being from PsyDoom
+    uint32_t    firstSeq;       // Sequence number of the first tick packet in the datagram
+    uint32_t    ackSeq;         // Sequence number of the next tick packet expected from the receiver: all tick packets before it have been received
+    uint32_t    numTicks;       // Number of tick packets following the header
+};
+
+static_assert(sizeof(UdpDgramHeader) == 16);
+
+static std::unique_ptr<asio::ip::udp::socket>   gpUdpSocket;            // Socket used to send and receive tick packets, if using UDP
+static asio::ip::address                        gUdpPeerAddress;        // Address of the other peer: only datagrams from this address are accepted
+static asio::ip::udp::endpoint                  gUdpPeerEndpoint;       // Where to send datagrams to: not known by the server until the client sends its first datagram
+static bool                                     gbHaveUdpPeerEndpoint;  // True if the endpoint of the other peer is known
+static std::deque<NetPacket_Tick>               gUdpUnackedTicks;       // Tick packets sent that the other peer has not yet acknowledged, oldest first
+static uint32_t                                 gUdpFirstUnackedSeq;    // Sequence number of the first tick packet in 'gUdpUnackedTicks'
+static uint32_t                                 gUdpNextRecvSeq;        // Sequence number of the next tick packet expected from the other peer
+static std::deque<RecvTickPacket>               gUdpRecvTicks;             // Tick packets received from the other peer that have not yet been consumed
+static std::chrono::steady_clock::time_point    gUdpLastSendTime;       // When a datagram was last sent
+static std::chrono::steady_clock::time_point    gUdpLastRecvTime;       // When a valid datagram was last received
+static uint8_t                                  gUdpTcpWatchByte;       // Destination for the disconnect detecting TCP read
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Checks for user input to cancel an abortable network operation like establishing a connection
@@ -89,6 +154,285 @@ static bool waitForAsyncNetworkOp(bool& bFinishedFlag, const bool bIsAbortable)
     return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts IPv4 addresses mapped to IPv6 to plain IPv4 addresses, so that addresses can be compared regardless of the socket type
+//------------------------------------------------------------------------------------------------------------------------------------------
+static asio::ip::address getUnmappedAddress(const asio::ip::address& address) noexcept {
+    if (address.is_v6() && address.to_v6().is_v4_mapped())
+        return asio::ip::make_address_v4(asio::ip::v4_mapped, address.to_v6());
+
+    return address;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates the UDP socket for sending and receiving tick packets, once the TCP connection has been established.
+// The server listens on the same port number as for TCP, the client sends to that port on the server from any port.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void udpSetup(asio::ip::tcp::socket& tcpSocket) {
+    const asio::ip::address peerAddress = tcpSocket.remote_endpoint().address();
+    gpUdpSocket.reset(new asio::ip::udp::socket(*gpIoContext));
+
+    if (ProgArgs::gbIsNetServer) {
+        gpUdpSocket->open(asio::ip::udp::v6());
+
+        try {
+            gpUdpSocket->set_option(asio::ip::v6_only(false));      // Accept IPv4 clients also
+        }
+        catch (...) {
+            // Ignore if not supported on this platform...
+        }
+
+        gpUdpSocket->bind(asio::ip::udp::endpoint(asio::ip::udp::v6(), ProgArgs::gServerPort));
+        gbHaveUdpPeerEndpoint = false;
+    } else {
+        gpUdpSocket->open(peerAddress.is_v4() ? asio::ip::udp::v4() : asio::ip::udp::v6());
+        gUdpPeerEndpoint = asio::ip::udp::endpoint(peerAddress, ProgArgs::gServerPort);
+        gbHaveUdpPeerEndpoint = true;
+    }
+
+    gpUdpSocket->non_blocking(true);
+    gUdpPeerAddress = getUnmappedAddress(peerAddress);
+    gUdpUnackedTicks.clear();
+    gUdpFirstUnackedSeq = 0;
+    gUdpNextRecvSeq = 0;
+    gUdpRecvTicks.clear();
+    gUdpLastSendTime = {};
+    gUdpLastRecvTime = std::chrono::steady_clock::now();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sends a datagram to the other peer containing the oldest unacknowledged tick packets and an acknowledgement of the ones received.
+// Send failures are ignored since datagrams can be lost anyway; the same tick packets will be sent again in the next datagram.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void udpSendDatagram() noexcept {
+    gUdpLastSendTime = std::chrono::steady_clock::now();
+
+    if (!gbHaveUdpPeerEndpoint)
+        return;
+
+    const uint32_t numTicks = std::min((uint32_t) gUdpUnackedTicks.size(), UDP_MAX_DGRAM_TICKS);
+    std::byte dgram[sizeof(UdpDgramHeader) + UDP_MAX_DGRAM_TICKS * sizeof(NetPacket_Tick)];
+
+    UdpDgramHeader header = {};
+    header.magic = Endian::hostToLittle(UDP_DGRAM_MAGIC);
+    header.firstSeq = Endian::hostToLittle(gUdpFirstUnackedSeq);
+    header.ackSeq = Endian::hostToLittle(gUdpNextRecvSeq);
+    header.numTicks = Endian::hostToLittle(numTicks);
+    std::memcpy(dgram, &header, sizeof(header));
+
+    // Note: tick packets are already endian corrected by the caller
+    for (uint32_t i = 0; i < numTicks; ++i) {
+        std::memcpy(dgram + sizeof(header) + i * sizeof(NetPacket_Tick), &gUdpUnackedTicks[i], sizeof(NetPacket_Tick));
+    }
+
+    asio::error_code error;
+    gpUdpSocket->send_to(asio::buffer(dgram, sizeof(header) + numTicks * sizeof(NetPacket_Tick)), gUdpPeerEndpoint, 0, error);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Handles one datagram received from the other peer: processes the acknowledgement and saves any new tick packets in sequence order
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void udpHandleDatagram(const std::byte* const pDgram, const size_t dgramSize) noexcept {
+    // Ignore the datagram if it's not valid
+    if (dgramSize < sizeof(UdpDgramHeader))
+        return;
+
+    UdpDgramHeader header;
+    std::memcpy(&header, pDgram, sizeof(header));
+    header.magic = Endian::littleToHost(header.magic);
+    header.firstSeq = Endian::littleToHost(header.firstSeq);
+    header.ackSeq = Endian::littleToHost(header.ackSeq);
+    header.numTicks = Endian::littleToHost(header.numTicks);
+
+    if ((header.magic != UDP_DGRAM_MAGIC) || (header.numTicks > UDP_MAX_DGRAM_TICKS))
+        return;
+
+    if (dgramSize != sizeof(UdpDgramHeader) + header.numTicks * sizeof(NetPacket_Tick))
+        return;
+
+    gUdpLastRecvTime = std::chrono::steady_clock::now();
+
+    // Drop all the tick packets acknowledged by the other peer.
+    // Note: sequence numbers are compared using wrapping arithmetic and old (out of order) acknowledgements are ignored.
+    const int32_t numAcked = (int32_t)(header.ackSeq - gUdpFirstUnackedSeq);
+
+    if ((numAcked > 0) && ((size_t) numAcked <= gUdpUnackedTicks.size())) {
+        gUdpUnackedTicks.erase(gUdpUnackedTicks.begin(), gUdpUnackedTicks.begin() + numAcked);
+        gUdpFirstUnackedSeq = header.ackSeq;
+    }
+
+    // Save any tick packets we haven't seen yet, which must follow on from the last one received.
+    // Since the other peer always sends starting from its oldest unacknowledged tick packet, there should never be gaps.
+    const auto receiveTime = std::chrono::system_clock::now();
+
+    for (uint32_t i = 0; i < header.numTicks; ++i) {
+        if (header.firstSeq + i != gUdpNextRecvSeq)
+            continue;
+
+        RecvTickPacket& recvPacket = gUdpRecvTicks.emplace_back();
+        std::memcpy(&recvPacket.packet, pDgram + sizeof(UdpDgramHeader) + i * sizeof(NetPacket_Tick), sizeof(NetPacket_Tick));
+        recvPacket.receiveTime = receiveTime;
+        gUdpNextRecvSeq++;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Receives and handles all datagrams waiting on the UDP socket, without blocking
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void udpReceiveDatagrams() noexcept {
+    std::byte dgram[sizeof(UdpDgramHeader) + UDP_MAX_DGRAM_TICKS * sizeof(NetPacket_Tick)];
+
+    while (true) {
+        asio::ip::udp::endpoint senderEndpoint;
+        asio::error_code error;
+        const size_t dgramSize = gpUdpSocket->receive_from(asio::buffer(dgram, sizeof(dgram)), senderEndpoint, 0, error);
+
+        // Note: errors like 'connection refused' (from a previous send) are ignored, we just stop when there is nothing more to read
+        if (error) {
+            if ((error == asio::error::would_block) || (error == asio::error::try_again))
+                break;
+
+            continue;
+        }
+
+        // Ignore datagrams from anyone other than the other peer.
+        // The server also learns which port the client is sending from with the first valid datagram.
+        if (getUnmappedAddress(senderEndpoint.address()) != gUdpPeerAddress)
+            continue;
+
+        if (!gbHaveUdpPeerEndpoint) {
+            gUdpPeerEndpoint = senderEndpoint;
+            gbHaveUdpPeerEndpoint = true;
+        }
+
+        if (senderEndpoint != gUdpPeerEndpoint)
+            continue;
+
+        udpHandleDatagram(dgram, dgramSize);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Network thread only: starts a read on the TCP connection while using UDP for tick packets, so we find out if the other peer disconnects.
+// Nothing else is sent over TCP once the game begins, so the read completing for any reason means the connection is gone.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void netThreadBeginWatchingTcp() noexcept {
+    try {
+        gpSocket->async_read_some(
+            asio::buffer(&gUdpTcpWatchByte, 1),
+            [](const asio::error_code&, const std::size_t) noexcept {
+                gbNetThreadError = true;
+            }
+        );
+    }
+    catch (...) {
+        gbNetThreadError = true;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Network thread only: kicks off the read of the next tick packet from the other peer.
+// When the read completes the packet is timestamped and queued for the game thread, and the next read is started.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void netThreadBeginTickPacketRead() noexcept {
+    try {
+        asio::async_read(
+            *gpSocket,
+            asio::buffer(&gNetThreadReadPkt, sizeof(NetPacket_Tick)),
+            [](const asio::error_code error, const std::size_t bytesRead) noexcept {
+                if (error || (bytesRead != sizeof(NetPacket_Tick))) {
+                    gbNetThreadError = true;
+                    return;
+                }
+
+                // Note: the game thread never lets more than a couple of tick packets build up, so the queue being full is an error
+                if (!gInTickPackets.tryPush(RecvTickPacket{ gNetThreadReadPkt, std::chrono::system_clock::now() })) {
+                    gbNetThreadError = true;
+                    return;
+                }
+
+                netThreadBeginTickPacketRead();
+            }
+        );
+    }
+    catch (...) {
+        gbNetThreadError = true;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Network thread only: kicks off the write of the next queued outgoing tick packet, if there is one and no write is in progress
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void netThreadTryBeginTickPacketWrite() noexcept {
+    if (gbNetThreadWriting || (!gOutTickPackets.tryPop(gNetThreadWritePkt)))
+        return;
+
+    try {
+        gbNetThreadWriting = true;
+
+        asio::async_write(
+            *gpSocket,
+            asio::buffer(&gNetThreadWritePkt, sizeof(NetPacket_Tick)),
+            [](const asio::error_code error, const std::size_t bytesWritten) noexcept {
+                gbNetThreadWriting = false;
+
+                if (error || (bytesWritten != sizeof(NetPacket_Tick))) {
+                    gbNetThreadError = true;
+                    return;
+                }
+
+                netThreadTryBeginTickPacketWrite();
+            }
+        );
+    }
+    catch (...) {
+        gbNetThreadError = true;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Starts the network thread running the io context (if not already started), once the handshake is done and the game is beginning.
+// When using UDP the thread just watches the TCP connection for disconnects, otherwise it starts receiving tick packets.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool ensureNetThreadStarted() noexcept {
+    if (gNetThread.joinable())
+        return true;
+
+    try {
+        gpIoContext->restart();
+        gpNetThreadWorkGuard.reset(new IoWorkGuard(gpIoContext->get_executor()));
+        gbNetThreadWriting = false;
+        asio::post(*gpIoContext, (gpUdpSocket) ? netThreadBeginWatchingTcp : netThreadBeginTickPacketRead);
+
+        gNetThread = std::thread([]() noexcept {
+            try {
+                gpIoContext->run();
+            }
+            catch (...) {
+                gbNetThreadError = true;
+            }
+        });
+    }
+    catch (...) {
+        gpNetThreadWorkGuard.reset();
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stops the network thread (if running) and waits for it to exit
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void stopNetThread() noexcept {
+    if (gNetThread.joinable()) {
+        gpIoContext->stop();
+        gNetThread.join();
+    }
+
+    gpNetThreadWorkGuard.reset();
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Setup options and preferences for the given socket among other stuff
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -110,9 +454,18 @@ static void postConnectSetup(asio::ip::tcp::socket& socket) noexcept {
     trySetOption(asio::socket_base::send_low_watermark(0));             // Don't wait to batch up sends/receives (Doom only sends a small amount of data)
     trySetOption(asio::socket_base::receive_low_watermark(0));          // Don't wait to batch up sends/receives (Doom only sends a small amount of data)
 
-    // Setup the tick packet reader/writers
-    gTickPacketReader.reset(new NetPacketReader<NetPacket_Tick, MAX_TICK_PKTS>(*gpSocket));
-    gTickPacketWriter.reset(new NetPacketWriter<NetPacket_Tick, MAX_TICK_PKTS>(*gpSocket));
+    // Create the UDP socket also if tick packets are being sent that way.
+    // If that fails then close the TCP connection too, so the handshake fails.
+    if (ProgArgs::gbUseUdpTransport) {
+        try {
+            udpSetup(socket);
+        }
+        catch (...) {
+            gpUdpSocket.reset();
+            asio::error_code error;
+            socket.close(error);
+        }
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -234,15 +587,23 @@ bool initForClient() noexcept {
 // Closes up the current network connection (if any)
 //------------------------------------------------------------------------------------------------------------------------------------------
 void shutdown() noexcept {
+    // Note: the network thread must be stopped first, since it might be using the sockets
+    stopNetThread();
+    gpUdpSocket.reset();
+    gUdpUnackedTicks.clear();
+    gUdpRecvTicks.clear();
     gpSocket.reset();
     gpIoContext.reset();
+    gOutTickPackets.clear();
+    gInTickPackets.clear();
+    gbNetThreadError = false;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Tells if there is a network connection established
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool isConnected() noexcept {
-    return (gpSocket && gpSocket->is_open());
+    return (gpSocket && gpSocket->is_open() && (!gbNetThreadError));
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -256,10 +617,15 @@ asio::ip::tcp::socket* getSocket() noexcept {
 // Process any network related events that need to be handled
 //------------------------------------------------------------------------------------------------------------------------------------------
 void doUpdates() noexcept {
-    if (gpIoContext) {
+    // Note: once the network thread is running it handles all io context events instead
+    if (gpIoContext && (!gNetThread.joinable())) {
         gpIoContext->restart();
         gpIoContext->poll();
     }
+
+    if (gpUdpSocket) {
+        udpReceiveDatagrams();
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -356,14 +722,93 @@ bool recvBytes(void* pBuffer, const int32_t numBytes) noexcept {
     return bWasSuccessful;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// UDP version of 'recvTickPacket': blocks until the next tick packet from the other peer is available.
+// While waiting the last datagram is periodically resent, in case it was lost. If nothing is heard from the other peer for too long,
+// or the TCP connection is lost, then the connection is killed and 'false' is returned.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool udpRecvTickPacket(NetPacket_Tick& packet, std::chrono::system_clock::time_point& receiveTime) noexcept {
+    while (true) {
+        doUpdates();
+        Utils::doPlatformUpdates();
+
+        if ((!gpUdpSocket) || gbNetThreadError || Input::isQuitRequested())
+            break;
+
+        if (!gUdpRecvTicks.empty()) {
+            packet = gUdpRecvTicks.front().packet;
+            receiveTime = gUdpRecvTicks.front().receiveTime;
+            gUdpRecvTicks.pop_front();
+            return true;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+
+        if (now - gUdpLastRecvTime >= UDP_TIMEOUT)
+            break;
+
+        if (now - gUdpLastSendTime >= UDP_RESEND_INTERVAL) {
+            udpSendDatagram();
+        }
+
+        Utils::threadYield();
+    }
+
+    packet = {};
+    receiveTime = {};
+    shutdown();
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Waits on the game thread until the given condition becomes true, doing platform updates in the meantime to keep the app responsive.
+// Returns 'false' if the network thread encounters an error or app quit is requested while waiting.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class ConditionT>
+static bool waitForNetThread(const ConditionT& condition) noexcept {
+    while (true) {
+        if (condition())
+            return true;
+
+        if (gbNetThreadError || Input::isQuitRequested())
+            return false;
+
+        Utils::doPlatformUpdates();
+        Utils::threadYield();
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Send a tick update packet: this call may or may not block, depending on whether the outgoing packet queue is full or not.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool sendTickPacket(const NetPacket_Tick& packet) noexcept {
-    if (!isConnected())
+    if ((!isConnected()) || (!ensureNetThreadStarted())) {
+        shutdown();
+        return false;
+    }
+
+    // Using UDP? Queue the packet until it is acknowledged and send it along with any others not yet acknowledged.
+    if (gpUdpSocket) {
+        if (gUdpUnackedTicks.size() >= UDP_MAX_UNACKED_TICKS) {
+            shutdown();
+            return false;
+        }
+
+        gUdpUnackedTicks.push_back(packet);
+        udpSendDatagram();
+        return true;
+    }
+
+    // Otherwise queue the packet for the network thread to send, waiting for a free slot if required
+    if (!waitForNetThread([&]() noexcept { return gOutTickPackets.tryPush(packet); })) {
+        shutdown();
         return false;
+    }
 
-    if (!gTickPacketWriter->writePacket(packet, nullptr)) {
+    try {
+        asio::post(*gpIoContext, netThreadTryBeginTickPacketWrite);
+    }
+    catch (...) {
         shutdown();
         return false;
     }
@@ -372,17 +817,16 @@ bool sendTickPacket(const NetPacket_Tick& packet) noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Request that the tick packet buffer be filled as much as possible and kick off as many packet reads as we can.
+// Begin receiving tick packets from the other peer in the background, if not already doing so.
+// This should be called once the handshake is done, since after that the TCP connection is managed by the network thread.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool requestTickPackets() noexcept {
-    if (!isConnected())
-        return false;
-
-    if (!gTickPacketReader->asyncFillPacketBuffer()) {
+    if ((!isConnected()) || (!ensureNetThreadStarted())) {
         shutdown();
         return false;
     }
 
+    doUpdates();
     return true;
 }
 
@@ -391,14 +835,26 @@ bool requestTickPackets() noexcept {
 // Returns the time that the packet was received at also.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool recvTickPacket(NetPacket_Tick& packet, std::chrono::system_clock::time_point& receiveTime) noexcept {
-    if (!isConnected())
+    if ((!isConnected()) || (!ensureNetThreadStarted())) {
+        shutdown();
         return false;
+    }
+
+    if (gpUdpSocket)
+        return udpRecvTickPacket(packet, receiveTime);
+
+    // The network thread receives packets in the background, so this is just a matter of waiting until one has been queued
+    RecvTickPacket recvPacket = {};
 
-    if (!gTickPacketReader->popRequestedPacket(packet, receiveTime, nullptr)) {
+    if (!waitForNetThread([&]() noexcept { return gInTickPackets.tryPop(recvPacket); })) {
+        packet = {};
+        receiveTime = {};
         shutdown();
         return false;
     }
 
+    packet = recvPacket.packet;
+    receiveTime = recvPacket.receiveTime;
     return true;
 }
 
@@ -4,8 +4,6 @@
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "ParserTokenizer.h"
 
-#include "Asserts.h"
-
 BEGIN_NAMESPACE(ParserTokenizer)
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -96,47 +94,4 @@ bool getNextToken(const char* const pStr, const char* const pStrEnd, const char*
     return (pBeg < pEnd);
 }
 
-//------------------------------------------------------------------------------------------------------------------------------------------
-// Helper that visits all lines in a text block and all tokens on a line, using the newline and space delimiters defined by this module.
-// This does a lot of the heavy lifting towards parsing a block of text into game specific data.
-//------------------------------------------------------------------------------------------------------------------------------------------
-void visitAllLineTokens(
-    const char* const pStrBeg,
-    const char* const pStrEnd,
-    const VisitLineFunc& onNewLine,
-    const VisitTokenFunc& onToken
-) noexcept {
-    // Preconditions
-    ASSERT(onNewLine);
-    ASSERT(onToken);
-
-    // Parse each line of the string
-    int32_t lineIdx = 0;
-    const char* pLineBeg = {};
-    const char* pLineEnd = pStrBeg;
-
-    while (true) {
-        // Move onto the line after the end of the previous one
-        if (!ParserTokenizer::getNextLine(pLineEnd, pStrEnd, pLineBeg, pLineEnd))
-            break;
-
-        onNewLine(lineIdx);
-
-        // Process all tokens in this line
-        int32_t tokenIdx = 0;
-        const char* pTokenBeg = {};
-        const char* pTokenEnd = pLineBeg;
-
-        while (true) {
-            if (!ParserTokenizer::getNextToken(pTokenEnd, pLineEnd, pTokenBeg, pTokenEnd))
-                break;
-
-            onToken(tokenIdx, pTokenBeg, (size_t)(pTokenEnd - pTokenBeg));
-            ++tokenIdx;
-        }
-
-        ++lineIdx;
-    }
-}
-
 END_NAMESPACE(ParserTokenizer)
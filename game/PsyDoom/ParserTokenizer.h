@@ -2,28 +2,59 @@
 
 #include "Macros.h"
 
-#include <functional>
+#include <cstddef>
+#include <cstdint>
 
 BEGIN_NAMESPACE(ParserTokenizer)
 
-// Visitor function for a new line in a block of text: receives the index of the line visited
-typedef std::function<void (const int32_t lineIdx)> VisitLineFunc;
-
-// Visitor function for a token in a line: receives the index of the token in the line and the string for the token itself
-typedef std::function<void (
-    const int32_t tokenIdx,
-    const char* const token,
-    const size_t tokenLen
-)> VisitTokenFunc;
-
 bool getNextLine(const char* const pStr, const char* const pStrEnd, const char*& pBeg, const char*& pEnd) noexcept;
 bool getNextToken(const char* const pStr, const char* const pStrEnd, const char*& pBeg, const char*& pEnd) noexcept;
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper that visits all lines in a text block and all tokens on a line, using the newline and space delimiters defined by this module.
+// This does a lot of the heavy lifting towards parsing a block of text into game specific data.
+//
+// The line visitor receives the index of the line visited:
+//      void (const int32_t lineIdx)
+// The token visitor receives the index of the token in the line and the string for the token itself:
+//      void (const int32_t tokenIdx, const char* const token, const size_t tokenLen)
+//
+// Note: the visitors are template parameters so that they can be inlined, rather than being called through 'std::function' for every token.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class VisitLineFunc, class VisitTokenFunc>
 void visitAllLineTokens(
     const char* const pStrBeg,
     const char* const pStrEnd,
     const VisitLineFunc& onNewLine,
     const VisitTokenFunc& onToken
-) noexcept;
+) noexcept {
+    // Parse each line of the string
+    int32_t lineIdx = 0;
+    const char* pLineBeg = {};
+    const char* pLineEnd = pStrBeg;
+
+    while (true) {
+        // Move onto the line after the end of the previous one
+        if (!getNextLine(pLineEnd, pStrEnd, pLineBeg, pLineEnd))
+            break;
+
+        onNewLine(lineIdx);
+
+        // Process all tokens in this line
+        int32_t tokenIdx = 0;
+        const char* pTokenBeg = {};
+        const char* pTokenEnd = pLineBeg;
+
+        while (true) {
+            if (!getNextToken(pTokenEnd, pLineEnd, pTokenBeg, pTokenEnd))
+                break;
+
+            onToken(tokenIdx, pTokenBeg, (size_t)(pTokenEnd - pTokenBeg));
+            ++tokenIdx;
+        }
+
+        ++lineIdx;
+    }
+}
 
 END_NAMESPACE(ParserTokenizer)
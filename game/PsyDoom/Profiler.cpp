@@ -0,0 +1,212 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Scoped zone profiler: records the start and end times of named zones of code so they can be viewed on a timeline.
+//
+// Each thread records zones into its own fixed size ring buffer, so there is no locking or allocation on the fast path. Once a ring buffer
+// is full the oldest zones are overwritten, so only the most recent activity for each thread is kept. The recorded zones can be saved as
+// a Chrome trace event json file, which can be viewed with 'chrome://tracing' or the Perfetto UI (https://ui.perfetto.dev).
+// Zones for work done on the GPU are kept in their own ring buffer, which is shown as a separate 'GPU' thread in the trace.
+// This module is only compiled in if 'PSYDOOM_PROFILER' is enabled.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "Profiler.h"
+
+#if PSYDOOM_PROFILER
+
+#include "Finally.h"
+
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <rapidjson/filewritestream.h>
+#include <rapidjson/writer.h>
+#include <vector>
+
+BEGIN_NAMESPACE(Profiler)
+
+// How many zones each thread's ring buffer holds (must be a power of two)
+static constexpr uint32_t RING_SIZE = 1024 * 64;
+static_assert((RING_SIZE & (RING_SIZE - 1)) == 0);
+
+// A single recorded zone
+struct Zone {
+    const char*     name;
+    int64_t         startNs;        // Start time relative to when the profiler started
+    int64_t         durationNs;     // How long the zone lasted for
+};
+
+// Holds all the zones recorded for a single thread
+struct ThreadRing {
+    uint32_t                threadIdx;      // Sequential index of the thread assigned on first use, used as the thread id in the trace ('0' for the GPU)
+    std::atomic<uint64_t>   numZones;       // Total number of zones ever recorded by this thread: the ring only holds the last 'RING_SIZE'
+    Zone                    zones[RING_SIZE];
+};
+
+// The time that profiling started at, which all zone times are relative to
+static const Clock::time_point gStartTime = Clock::now();
+
+// The ring buffer for the current thread, created on first use.
+// Ownership is held by the global list of rings so that zones recorded by threads which have since exited can still be saved.
+static thread_local ThreadRing* gpThreadRing;
+
+// The ring buffer for GPU zones, created on first use
+static ThreadRing* gpGpuRing;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the list of all thread ring buffers and the mutex guarding it.
+// These are function local statics to avoid problems with static initialization order.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::vector<std::unique_ptr<ThreadRing>>& getThreadRings() noexcept {
+    static std::vector<std::unique_ptr<ThreadRing>> threadRings;
+    return threadRings;
+}
+
+static std::mutex& getThreadRingsMutex() noexcept {
+    static std::mutex threadRingsMutex;
+    return threadRingsMutex;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates the ring buffer for the current thread and registers it in the global list
+//------------------------------------------------------------------------------------------------------------------------------------------
+static ThreadRing& createThreadRing() noexcept {
+    std::unique_ptr<ThreadRing> pRing = std::make_unique<ThreadRing>();
+    gpThreadRing = pRing.get();
+
+    std::lock_guard<std::mutex> lock(getThreadRingsMutex());
+    std::vector<std::unique_ptr<ThreadRing>>& threadRings = getThreadRings();
+    pRing->threadIdx = (uint32_t) threadRings.size() + 1;
+    pRing->numZones = 0;
+    threadRings.push_back(std::move(pRing));
+    return *gpThreadRing;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates the ring buffer for GPU zones and registers it in the global list
+//------------------------------------------------------------------------------------------------------------------------------------------
+static ThreadRing& createGpuRing() noexcept {
+    std::unique_ptr<ThreadRing> pRing = std::make_unique<ThreadRing>();
+    gpGpuRing = pRing.get();
+
+    std::lock_guard<std::mutex> lock(getThreadRingsMutex());
+    pRing->threadIdx = 0;
+    pRing->numZones = 0;
+    getThreadRings().push_back(std::move(pRing));
+    return *gpGpuRing;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records a completed zone to the given ring buffer
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void addZoneToRing(ThreadRing& ring, const char* const name, const Clock::time_point startTime, const Clock::time_point endTime) noexcept {
+    const uint64_t zoneNum = ring.numZones.load(std::memory_order_relaxed);
+
+    Zone& zone = ring.zones[zoneNum & (RING_SIZE - 1)];
+    zone.name = name;
+    zone.startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(startTime - gStartTime).count();
+    zone.durationNs = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime).count();
+
+    ring.numZones.store(zoneNum + 1, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records a completed zone for the current thread
+//------------------------------------------------------------------------------------------------------------------------------------------
+void addZone(const char* const name, const Clock::time_point startTime, const Clock::time_point endTime) noexcept {
+    ThreadRing& ring = (gpThreadRing) ? *gpThreadRing : createThreadRing();
+    addZoneToRing(ring, name, startTime, endTime);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records a completed zone of work on the GPU, with the GPU times converted to the same clock as CPU zones.
+// This must only ever be called from the main thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void addGpuZone(const char* const name, const Clock::time_point startTime, const Clock::time_point endTime) noexcept {
+    ThreadRing& ring = (gpGpuRing) ? *gpGpuRing : createGpuRing();
+    addZoneToRing(ring, name, startTime, endTime);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Save all the recorded zones for all threads to the given file in the Chrome trace event json format.
+// Zones from other threads which are still running may still be recorded while saving; there is a small chance that the oldest zones for
+// a thread which is very busy might be overwritten while saving, but that is acceptable for what is purely a debugging tool.
+// Returns 'false' on failure to save.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool saveChromeTrace(const char* const jsonFilePath) noexcept {
+    std::FILE* const pFile = std::fopen(jsonFilePath, "w");
+
+    if (!pFile)
+        return false;
+
+    auto closeFile = finally([&]() noexcept {
+        std::fflush(pFile);
+        std::fclose(pFile);
+    });
+
+    // Events are streamed straight to the file rather than building a document first, since there may be a lot of them
+    try {
+        char writeBuffer[4096];
+        rapidjson::FileWriteStream writeStream(pFile, writeBuffer, C_ARRAY_SIZE(writeBuffer));
+        rapidjson::Writer<rapidjson::FileWriteStream> writer(writeStream);
+
+        writer.StartObject();
+        writer.Key("displayTimeUnit");
+        writer.String("ms");
+        writer.Key("traceEvents");
+        writer.StartArray();
+
+        std::lock_guard<std::mutex> lock(getThreadRingsMutex());
+
+        for (const std::unique_ptr<ThreadRing>& pRing : getThreadRings()) {
+            const ThreadRing& ring = *pRing;
+
+            // Name the thread in the trace: the first thread to record a zone is always the main thread
+            char threadName[32];
+
+            if (ring.threadIdx == 0) {
+                std::snprintf(threadName, C_ARRAY_SIZE(threadName), "GPU");
+            } else {
+                std::snprintf(threadName, C_ARRAY_SIZE(threadName), (ring.threadIdx == 1) ? "Main thread" : "Thread %u", ring.threadIdx);
+            }
+
+            writer.StartObject();
+            writer.Key("ph");       writer.String("M");
+            writer.Key("name");     writer.String("thread_name");
+            writer.Key("pid");      writer.Uint(1);
+            writer.Key("tid");      writer.Uint(ring.threadIdx);
+            writer.Key("args");
+            writer.StartObject();
+            writer.Key("name");     writer.String(threadName);
+            writer.EndObject();
+            writer.EndObject();
+
+            // Output all the zones still in the ring, oldest first.
+            // Note: trace event times are in microseconds.
+            const uint64_t numZones = ring.numZones.load(std::memory_order_acquire);
+            const uint64_t firstZoneNum = (numZones > RING_SIZE) ? numZones - RING_SIZE : 0;
+
+            for (uint64_t zoneNum = firstZoneNum; zoneNum < numZones; ++zoneNum) {
+                const Zone& zone = ring.zones[zoneNum & (RING_SIZE - 1)];
+
+                writer.StartObject();
+                writer.Key("ph");       writer.String("X");
+                writer.Key("name");     writer.String(zone.name);
+                writer.Key("pid");      writer.Uint(1);
+                writer.Key("tid");      writer.Uint(ring.threadIdx);
+                writer.Key("ts");       writer.Double((double) zone.startNs / 1000.0);
+                writer.Key("dur");      writer.Double((double) zone.durationNs / 1000.0);
+                writer.EndObject();
+            }
+        }
+
+        writer.EndArray();
+        writer.EndObject();
+    } catch (...) {
+        return false;
+    }
+
+    return true;
+}
+
+END_NAMESPACE(Profiler)
+
+#endif  // #if PSYDOOM_PROFILER
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Macros.h"
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A lightweight scoped zone profiler which can be compiled into the game for performance analysis.
+// Use 'PROFILE_ZONE("Name")' to time the remainder of the current scope; the name must be a string literal or otherwise have static lifetime.
+// When 'PSYDOOM_PROFILER' is not enabled the macro expands to nothing and has zero cost.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#if PSYDOOM_PROFILER
+
+#include <chrono>
+#include <cstdint>
+
+BEGIN_NAMESPACE(Profiler)
+
+typedef std::chrono::steady_clock Clock;
+
+void addZone(const char* const name, const Clock::time_point startTime, const Clock::time_point endTime) noexcept;
+void addGpuZone(const char* const name, const Clock::time_point startTime, const Clock::time_point endTime) noexcept;
+bool saveChromeTrace(const char* const jsonFilePath) noexcept;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records the time spent in the scope it is declared in as a profiler zone
+//------------------------------------------------------------------------------------------------------------------------------------------
+class ScopedZone {
+public:
+    inline ScopedZone(const char* const name) noexcept
+        : mName(name)
+        , mStartTime(Clock::now())
+    {
+    }
+
+    inline ~ScopedZone() noexcept {
+        addZone(mName, mStartTime, Clock::now());
+    }
+
+private:
+    const char* const           mName;
+    const Clock::time_point     mStartTime;
+};
+
+END_NAMESPACE(Profiler)
+
+#define PROFILE_ZONE_CONCAT_IMPL(A, B) A##B
+#define PROFILE_ZONE_CONCAT(A, B) PROFILE_ZONE_CONCAT_IMPL(A, B)
+#define PROFILE_ZONE(NAME) const Profiler::ScopedZone PROFILE_ZONE_CONCAT(profileZone_, __LINE__)(NAME)
+
+#else
+
+#define PROFILE_ZONE(NAME)
+
+#endif  // #if PSYDOOM_PROFILER
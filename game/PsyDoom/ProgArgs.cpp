@@ -28,6 +28,10 @@ const char* gCueFileOverride;
 // Can only be used for single demo playback, the main game won't run in this mode;
 bool gbHeadlessMode = false;
 
+// If true then headless mode still renders every frame with the classic renderer (into PSX VRAM), but never displays it.
+// Used to benchmark and regression test rendering for single demo playback on machines with no display.
+bool gbHeadlessRender = false;
+
 // The data directory to pull file overrides for the file modding mechanism, empty string when there is none.
 // Any files placed in this directory matching original game file names will override the original game files.
 const char* gDataDirPath = "";
@@ -35,11 +39,24 @@ const char* gDataDirPath = "";
 const char* gPlayDemoFilePath = "";             // The demo file to play and exit
 const char* gSaveDemoResultFilePath = "";       // Path to a json file to save the demo result to
 const char* gCheckDemoResultFilePath = "";      // Path to a json file to read the demo result from and verify a match with
+const char* gTimeDemoResultFilePath = "";       // If set then run the demo as a timedemo benchmark and save the timing results to this json file
+const char* gBatchDemoManifestFilePath = "";    // If set then run and check the results of all demos in this json manifest file, then exit
+const char* gBatchDemoReportFilePath = "";      // Path to a json file to save the results of running a batch of demos to
+int32_t     gNumBatchDemoWorkers = 0;           // How many worker processes to use when running a batch of demos: '0' means one per CPU thread
+const char* gProfileTraceFilePath = "";         // If set then save the zones recorded by the profiler to this Chrome trace json file on exit
+const char* gSimBenchResultFilePath = "";       // If set then run the simulation benchmark and save the timing results to this json file, then exit
+int32_t     gSimBenchMap = 0;                   // Which map to run the simulation benchmark on
+int32_t     gSimBenchNumTicks = 0;              // How many game ticks to run the simulation benchmark for
+int32_t     gSimBenchHordeSize = 0;             // How many extra monsters to spawn around the player for the simulation benchmark
+int32_t     gSimBenchHordeType = 0;             // The map object type ('mobjtype_t') of the extra monsters spawned for the simulation benchmark
+float       gScriptTickBudgetMs = 0.0f;         // If greater than '0' then warn when map scripts take longer than this many milliseconds in a game tick
+int32_t     gFrameHashInterval = 0;             // If greater than '0' then a timedemo saves a hash of the displayed frame every time this many ticks pass
 bool        gbRecordDemos;                      // True if the game should record demos for every map played
 
 bool        gbIsNetServer   = false;                // True if this peer is a server in a networked game (player 1, waits for client connection)
 bool        gbIsNetClient   = false;                // True if this peer is a client in a networked game (player 2, connects to waiting server)
 uint16_t    gServerPort     = DEFAULT_NET_PORT;     // Port that the server listens on or that the client connects to
+bool        gbUseUdpTransport = false;              // True if tick packets in a networked game are sent via UDP instead of TCP (both peers must agree)
 
 bool gbNoMonsters           = false;    // Cheat: if true then do not spawn any monsters
 bool gbNoMonstersBossFixup  = false;    // Cheat: if 'no monsters' is active then try to fix broken boss specials by triggering them at the start of the map
@@ -87,6 +104,16 @@ static int parseArg_headless([[maybe_unused]] const int argc, const char* const*
     return 0;
 }
 
+static int parseArg_headlessrender([[maybe_unused]] const int argc, const char* const* const argv) {
+    if (std::strcmp(argv[0], "-headlessrender") == 0) {
+        gbHeadlessMode = true;
+        gbHeadlessRender = true;
+        return 1;
+    }
+
+    return 0;
+}
+
 static int parseArg_datadir(const int argc, const char* const* const argv) {
     if ((argc >= 2) && (std::strcmp(argv[0], "-datadir") == 0)) {
         gDataDirPath = argv[1];
@@ -123,6 +150,82 @@ static int parseArg_checkresult(const int argc, const char* const* const argv) {
     return 0;
 }
 
+static int parseArg_timedemo(const int argc, const char* const* const argv) {
+    if ((argc >= 2) && (std::strcmp(argv[0], "-timedemo") == 0)) {
+        gTimeDemoResultFilePath = argv[1];
+        return 2;
+    }
+
+    return 0;
+}
+
+static int parseArg_batchdemos(const int argc, const char* const* const argv) {
+    if ((argc >= 3) && (std::strcmp(argv[0], "-batchdemos") == 0)) {
+        gBatchDemoManifestFilePath = argv[1];
+        gBatchDemoReportFilePath = argv[2];
+        return 3;
+    }
+
+    return 0;
+}
+
+static int parseArg_batchworkers(const int argc, const char* const* const argv) {
+    if ((argc >= 2) && (std::strcmp(argv[0], "-batchworkers") == 0)) {
+        gNumBatchDemoWorkers = std::max(std::atoi(argv[1]), 0);
+        return 2;
+    }
+
+    return 0;
+}
+
+static int parseArg_profiletrace(const int argc, const char* const* const argv) {
+    if ((argc >= 2) && (std::strcmp(argv[0], "-profiletrace") == 0)) {
+        gProfileTraceFilePath = argv[1];
+        return 2;
+    }
+
+    return 0;
+}
+
+static int parseArg_simbench(const int argc, const char* const* const argv) {
+    if ((argc >= 4) && (std::strcmp(argv[0], "-simbench") == 0)) {
+        gSimBenchMap = std::atoi(argv[1]);
+        gSimBenchNumTicks = std::max(std::atoi(argv[2]), 0);
+        gSimBenchResultFilePath = argv[3];
+        return 4;
+    }
+
+    return 0;
+}
+
+static int parseArg_simhorde(const int argc, const char* const* const argv) {
+    if ((argc >= 3) && (std::strcmp(argv[0], "-simhorde") == 0)) {
+        gSimBenchHordeSize = std::max(std::atoi(argv[1]), 0);
+        gSimBenchHordeType = std::atoi(argv[2]);
+        return 3;
+    }
+
+    return 0;
+}
+
+static int parseArg_scriptbudget(const int argc, const char* const* const argv) {
+    if ((argc >= 2) && (std::strcmp(argv[0], "-scriptbudget") == 0)) {
+        gScriptTickBudgetMs = std::max((float) std::atof(argv[1]), 0.0f);
+        return 2;
+    }
+
+    return 0;
+}
+
+static int parseArg_framehashes(const int argc, const char* const* const argv) {
+    if ((argc >= 2) && (std::strcmp(argv[0], "-framehashes") == 0)) {
+        gFrameHashInterval = std::max(std::atoi(argv[1]), 0);
+        return 2;
+    }
+
+    return 0;
+}
+
 static int parseArg_record([[maybe_unused]] const int argc, const char* const* const argv) {
     if (std::strcmp(argv[0], "-record") == 0) {
         gbRecordDemos = true;
@@ -200,6 +303,15 @@ static int parseArg_server([[maybe_unused]] const int argc, const char* const* c
     return 0;
 }
 
+static int parseArg_udp(const int argc, const char* const* const argv) {
+    if ((argc >= 1) && (std::strcmp(argv[0], "-udp") == 0)) {
+        gbUseUdpTransport = true;
+        return 1;
+    }
+
+    return 0;
+}
+
 static int parseArg_client([[maybe_unused]] const int argc, const char* const* const argv) {
     if ((argc >= 2) && (std::strcmp(argv[0], "-client") == 0)) {
         gbIsNetClient = true;
@@ -277,10 +389,19 @@ static int parseArg_skill(const int argc, const char* const* const argv) {
 static constexpr ArgParser ARG_PARSERS[] = {
     parseArg_cue,
     parseArg_headless,
+    parseArg_headlessrender,
     parseArg_datadir,
     parseArg_playdemo,
     parseArg_saveresult,
     parseArg_checkresult,
+    parseArg_timedemo,
+    parseArg_batchdemos,
+    parseArg_batchworkers,
+    parseArg_profiletrace,
+    parseArg_simbench,
+    parseArg_simhorde,
+    parseArg_scriptbudget,
+    parseArg_framehashes,
     parseArg_record,
     parseArg_nomonsters,
     parseArg_nmbossfixup,
@@ -288,6 +409,7 @@ static constexpr ArgParser ARG_PARSERS[] = {
     parseArg_turbo,
     parseArg_server,
     parseArg_client,
+    parseArg_udp,
     parseArg_file,
     parseArg_nolauncher,
     parseArg_warp,
@@ -298,9 +420,68 @@ static constexpr ArgParser ARG_PARSERS[] = {
 // Performs additional validation and sanity checks for program arguments to fix some unsupported/invalid combos
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void validateAndSanitizeArgs() noexcept {
-    if (gbHeadlessMode && (!gPlayDemoFilePath[0])) {
-        std::printf("The '-headless' switch can only be used in conjunction with '-playdemo'! Arg will be ignored...\n");
+    // Batch demo runs are always headless and replace the single demo related arguments
+    if (gBatchDemoManifestFilePath[0]) {
+        if (gPlayDemoFilePath[0] || gSaveDemoResultFilePath[0] || gCheckDemoResultFilePath[0] || gTimeDemoResultFilePath[0]) {
+            std::printf("Can't use '-playdemo', '-saveresult', '-checkresult' or '-timedemo' with '-batchdemos'! Args will be ignored...\n");
+            gPlayDemoFilePath = "";
+            gSaveDemoResultFilePath = "";
+            gCheckDemoResultFilePath = "";
+            gTimeDemoResultFilePath = "";
+        }
+
+        if (gbRecordDemos) {
+            std::printf("Can't use '-record' in conjunction with '-batchdemos'! Arg will be ignored...\n");
+            gbRecordDemos = false;
+        }
+
+        if (gbHeadlessRender) {
+            std::printf("Can't use '-headlessrender' in conjunction with '-batchdemos'! Demos will be run without rendering...\n");
+            gbHeadlessRender = false;
+        }
+
+        gbHeadlessMode = true;
+    }
+
+    // The simulation benchmark is always headless and conflicts with anything else that takes over the game loop
+    if (gSimBenchResultFilePath[0]) {
+        if (gPlayDemoFilePath[0] || gBatchDemoManifestFilePath[0]) {
+            std::printf("Can't use '-simbench' in conjunction with '-playdemo' or '-batchdemos'! Arg will be ignored...\n");
+            gSimBenchResultFilePath = "";
+        } else {
+            if (gbRecordDemos) {
+                std::printf("Can't use '-record' in conjunction with '-simbench'! Arg will be ignored...\n");
+                gbRecordDemos = false;
+            }
+
+            if (gbHeadlessRender) {
+                std::printf("Can't use '-headlessrender' in conjunction with '-simbench'! The map will be run without rendering...\n");
+                gbHeadlessRender = false;
+            }
+
+            gbHeadlessMode = true;
+        }
+    }
+
+    if ((gSimBenchHordeSize > 0) && (!gSimBenchResultFilePath[0])) {
+        std::printf("The '-simhorde' argument can only be used in conjunction with '-simbench'! Arg will be ignored...\n");
+        gSimBenchHordeSize = 0;
+    }
+
+    if (gbHeadlessMode && (!gPlayDemoFilePath[0]) && (!gBatchDemoManifestFilePath[0]) && (!gSimBenchResultFilePath[0])) {
+        std::printf("The '-headless' switch can only be used in conjunction with '-playdemo', '-batchdemos' or '-simbench'! Arg will be ignored...\n");
         gbHeadlessMode = false;
+        gbHeadlessRender = false;
+    }
+
+    if (gTimeDemoResultFilePath[0] && (!gPlayDemoFilePath[0])) {
+        std::printf("The '-timedemo' argument can only be used in conjunction with '-playdemo'! Arg will be ignored...\n");
+        gTimeDemoResultFilePath = "";
+    }
+
+    if ((gFrameHashInterval > 0) && (!gTimeDemoResultFilePath[0])) {
+        std::printf("The '-framehashes' argument can only be used in conjunction with '-timedemo'! Arg will be ignored...\n");
+        gFrameHashInterval = 0;
     }
 
     if (gbRecordDemos && gPlayDemoFilePath[0]) {
@@ -323,6 +504,13 @@ static void validateAndSanitizeArgs() noexcept {
         gCheckDemoResultFilePath = "";
     }
 
+    #if !PSYDOOM_PROFILER
+        if (gProfileTraceFilePath[0]) {
+            std::printf("The '-profiletrace' argument requires a build with 'PSYDOOM_PROFILER' enabled! Arg will be ignored...\n");
+            gProfileTraceFilePath = "";
+        }
+    #endif
+
     if ((gWarpMap > 0) && gPlayDemoFilePath[0]) {
         std::printf("The '-warp' argument conflicts with '-playdemo'! Arg will be ignored...\n");
         gWarpMap = 0;
@@ -372,13 +560,27 @@ void shutdown() noexcept {
     // Reset everything back to its initial state and free any memory allocated (to help leak detection)
     gCueFileOverride = nullptr;
     gbHeadlessMode = false;
+    gbHeadlessRender = false;
     gDataDirPath = "";
     gPlayDemoFilePath = "";
     gSaveDemoResultFilePath = "";
     gCheckDemoResultFilePath = "";
+    gTimeDemoResultFilePath = "";
+    gBatchDemoManifestFilePath = "";
+    gBatchDemoReportFilePath = "";
+    gNumBatchDemoWorkers = 0;
+    gProfileTraceFilePath = "";
+    gSimBenchResultFilePath = "";
+    gSimBenchMap = 0;
+    gSimBenchNumTicks = 0;
+    gSimBenchHordeSize = 0;
+    gSimBenchHordeType = 0;
+    gScriptTickBudgetMs = 0.0f;
+    gFrameHashInterval = 0;
     gbIsNetServer = false;
     gbIsNetClient = false;
     gServerPort = DEFAULT_NET_PORT;
+    gbUseUdpTransport = false;
     gbNoMonsters = false;
     gbNoMonstersBossFixup = false;
     gbPistolStart = false;
@@ -10,14 +10,28 @@ BEGIN_NAMESPACE(ProgArgs)
 
 extern const char*  gCueFileOverride;
 extern bool         gbHeadlessMode;
+extern bool         gbHeadlessRender;
 extern const char*  gDataDirPath;
 extern const char*  gPlayDemoFilePath;
 extern const char*  gSaveDemoResultFilePath;
 extern const char*  gCheckDemoResultFilePath;
+extern const char*  gTimeDemoResultFilePath;
+extern const char*  gBatchDemoManifestFilePath;
+extern const char*  gBatchDemoReportFilePath;
+extern int32_t      gNumBatchDemoWorkers;
+extern const char*  gProfileTraceFilePath;
+extern const char*  gSimBenchResultFilePath;
+extern int32_t      gSimBenchMap;
+extern int32_t      gSimBenchNumTicks;
+extern int32_t      gSimBenchHordeSize;
+extern int32_t      gSimBenchHordeType;
+extern float        gScriptTickBudgetMs;
+extern int32_t      gFrameHashInterval;
 extern bool         gbRecordDemos;
 extern bool         gbIsNetServer;
 extern bool         gbIsNetClient;
 extern uint16_t     gServerPort;
+extern bool         gbUseUdpTransport;
 extern bool         gbNoMonsters;
 extern bool         gbNoMonstersBossFixup;
 extern bool         gbPistolStart;
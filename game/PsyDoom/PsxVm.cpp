@@ -8,13 +8,19 @@
 #include "Config/Config.h"
 #include "DiscInfo.h"
 #include "DiscReader.h"
+#include "GameJobs.h"
 #include "Gpu.h"
 #include "Input.h"
 #include "IsoFileSys.h"
 #include "ProgArgs.h"
+#include "Profiler.h"
 #include "Spu.h"
+#include "Utils.h"
 
 #include <SDL.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
 #include <mutex>
 
 BEGIN_NAMESPACE(PsxVm)
@@ -26,6 +32,27 @@ Spu::Core   gSpu;
 
 static SDL_AudioDeviceID        gSdlAudioDeviceId;
 static std::recursive_mutex     gSpuMutex;
+static Spu::CmdQueue            gSpuCmdQueue;       // Commands submitted by the game thread to be executed by whatever thread locks the SPU next
+
+// Sample clock for scheduling SPU commands at exact sample numbers
+static std::atomic<uint32_t>    gSpuSampleClock;            // How many samples the audio thread has generated so far (wraps around)
+static uint32_t                 gSpuCmdLeadSamples;         // How far ahead of the sample clock commands should be scheduled so they are not late
+static uint32_t                 gLastSpuCmdWaitSampleNum;   // Sample number of the last wait submitted by the game thread
+static bool                     gbSubmittingTimedSpuCmds;   // If set then SPU commands being submitted are sample timed (held by waits)
+
+// Adaptive audio buffer size: the buffer starts small and grows whenever the audio thread detects that the output has underrun too often.
+// An underrun is assumed whenever there is a gap between audio callbacks that is much longer than the time it takes to play the buffer.
+static constexpr uint16_t       ADAPTIVE_AUDIO_BUFFER_MIN_SIZE = 64;
+static constexpr uint16_t       ADAPTIVE_AUDIO_BUFFER_MAX_SIZE = 2048;
+static constexpr uint32_t       ADAPTIVE_AUDIO_MAX_UNDERRUNS = 3;           // Grow the buffer if this many underruns happen within the window below
+static constexpr uint32_t       ADAPTIVE_AUDIO_UNDERRUN_WINDOW_MS = 5000;
+
+static bool                     gbAdaptiveAudioBufferSize;      // Is the adaptive audio buffer size enabled?
+static uint16_t                 gAudioBufferSize;               // Size of the current audio buffer, in samples
+static uint64_t                 gLastAudioCallbackTime;         // Audio thread: when the last audio callback happened (performance counter ticks)
+static uint64_t                 gAudioUnderrunWindowStartTime;  // Audio thread: when the first underrun in the current window happened
+static uint32_t                 gNumAudioUnderruns;             // Audio thread: how many underruns happened in the current window
+static std::atomic<bool>        gbAudioBufferGrowRequested;     // Set by the audio thread when the buffer should be made bigger
 
 // The audio compressor is only needed if we have a floating point SPU
 #if SIMPLE_SPU_FLOAT_SPU
@@ -43,35 +70,113 @@ static void SdlAudioCallback([[maybe_unused]] void* userData, Uint8* pOutput, in
     // How many samples are to be output?
     const uint32_t numSamples = (uint32_t) outputSize / (sizeof(float) * 2);
 
-    // Lock the SPU and generate the requested number of samples
+    // If the audio buffer size is adaptive then check for underruns and request a bigger buffer if they are happening too often
+    if (gbAdaptiveAudioBufferSize) {
+        const uint64_t now = SDL_GetPerformanceCounter();
+        const uint64_t ticksPerSec = SDL_GetPerformanceFrequency();
+
+        if (gLastAudioCallbackTime != 0) {
+            const uint64_t bufferDurationTicks = (ticksPerSec * numSamples) / 44100;
+
+            if (now - gLastAudioCallbackTime > bufferDurationTicks * 2) {
+                if ((gNumAudioUnderruns == 0) || (now - gAudioUnderrunWindowStartTime > (ticksPerSec * ADAPTIVE_AUDIO_UNDERRUN_WINDOW_MS) / 1000)) {
+                    gAudioUnderrunWindowStartTime = now;
+                    gNumAudioUnderruns = 0;
+                }
+
+                gNumAudioUnderruns++;
+
+                if (gNumAudioUnderruns >= ADAPTIVE_AUDIO_MAX_UNDERRUNS) {
+                    gbAudioBufferGrowRequested.store(true, std::memory_order_relaxed);
+                }
+            }
+        }
+
+        gLastAudioCallbackTime = now;
+    }
+
+    // Generate the requested number of samples in blocks.
+    // Only hold the SPU lock while generating each block, and not while doing the conversion and compression of the output.
     float* pOutputF = reinterpret_cast<float*>(pOutput);
-    PsxVm::LockSpu spuLock;
+    Spu::StereoSample samples[Spu::MAX_STEP_BLOCK_SIZE];
 
-    for (uint32_t sampleIdx = 0; sampleIdx < numSamples; ++sampleIdx) {
-        // Get this sample in floating point format
-        const Spu::StereoSample sample = Spu::stepCore(gSpu);
+    for (uint32_t blockStartIdx = 0; blockStartIdx < numSamples; blockStartIdx += Spu::MAX_STEP_BLOCK_SIZE) {
+        const uint32_t blockSize = std::min<uint32_t>(numSamples - blockStartIdx, Spu::MAX_STEP_BLOCK_SIZE);
 
-        #if SIMPLE_SPU_FLOAT_SPU
-            float sampleL = sample.left;
-            float sampleR = sample.right;
-        #else
-            float sampleL = Spu::toFloatSample(sample.left);
-            float sampleR = Spu::toFloatSample(sample.right);
-        #endif
+        {
+            PROFILE_ZONE("Spu::stepCoreBlock");
+            std::lock_guard<std::recursive_mutex> spuLock(gSpuMutex);
+
+            // Execute commands as they become due and generate the samples in between.
+            // This allows commands which are scheduled for an exact sample number to take effect on that exact sample.
+            uint32_t sampleClock = gSpuSampleClock.load(std::memory_order_relaxed);
+
+            for (uint32_t numSamplesGenerated = 0; numSamplesGenerated < blockSize;) {
+                const uint32_t samplesTillNextCmd = Spu::executeCmds(gSpu, gSpuCmdQueue, sampleClock);
+                const uint32_t numSamplesToGenerate = std::min(blockSize - numSamplesGenerated, samplesTillNextCmd);
+                Spu::stepCoreBlock(gSpu, samples + numSamplesGenerated, numSamplesToGenerate);
+                numSamplesGenerated += numSamplesToGenerate;
+                sampleClock += numSamplesToGenerate;
+            }
+
+            gSpuSampleClock.store(sampleClock, std::memory_order_release);
+        }
+
+        // Output each sample in floating point format
+        for (uint32_t sampleIdx = 0; sampleIdx < blockSize; ++sampleIdx) {
+            const Spu::StereoSample sample = samples[sampleIdx];
+
+            #if SIMPLE_SPU_FLOAT_SPU
+                pOutputF[sampleIdx * 2 + 0] = sample.left;
+                pOutputF[sampleIdx * 2 + 1] = sample.right;
+            #else
+                pOutputF[sampleIdx * 2 + 0] = Spu::toFloatSample(sample.left);
+                pOutputF[sampleIdx * 2 + 1] = Spu::toFloatSample(sample.right);
+            #endif
+        }
 
         // If using the floating point SPU apply audio compression.
         // When using floating point sound the audio can get EXTREMELY loud (and painful to listen to) if not capped.
         // When using the original 16-bit SPU the sound will also clip/distort if too loud, so no point in using compression in that case.
         #if SIMPLE_SPU_FLOAT_SPU
-            AudioCompressor::compress(gAudioCompState, sampleL, sampleR);
+            AudioCompressor::compressBlock(gAudioCompState, pOutputF, blockSize);
         #endif
 
-        pOutputF[0] = sampleL;
-        pOutputF[1] = sampleR;
-        pOutputF += 2;
+        pOutputF += blockSize * 2;
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Try to open an audio device sampling at 44,100 Hz stereo in floating point mode, with the given buffer size in samples.
+// Note that if opening succeeds then we've got our requested format, since we ask SDL not to allow any deviation.
+// The device is also unpaused if opened successfully.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool openAudioDevice(const uint16_t bufferSize) noexcept {
+    SDL_AudioSpec wantFmt = {};
+    wantFmt.freq = 44100;
+    wantFmt.format = AUDIO_F32;
+    wantFmt.channels = 2;
+    wantFmt.samples = bufferSize;
+    wantFmt.callback = SdlAudioCallback;
+
+    // Reset underrun detection for the new device, the audio thread is not running at this point
+    gLastAudioCallbackTime = 0;
+    gNumAudioUnderruns = 0;
+    gbAudioBufferGrowRequested = false;
+
+    SDL_AudioSpec gotFmt = {};
+    gSdlAudioDeviceId = SDL_OpenAudioDevice(nullptr, false, &wantFmt, &gotFmt, false);
+
+    if (gSdlAudioDeviceId == 0)
+        return false;
+
+    // Schedule sample accurate commands far enough ahead to cover the audio buffer size plus a 30 Hz game frame
+    gAudioBufferSize = gotFmt.samples;
+    gSpuCmdLeadSamples = (uint32_t) gotFmt.samples + 44100 / 30;
+    SDL_PauseAudioDevice(gSdlAudioDeviceId, false);
+    return true;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Determine the VRAM size to use from user config
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -107,12 +212,16 @@ static void getVramSize(uint16_t& vramW, uint16_t& vramH) noexcept {
 // Initialize emulated PlayStation system components and use the given .cue file for the game disc
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool init(const char* const doomCdCuePath) noexcept {
+    // Start up the job worker threads shared by the game, the renderers and the GPU, capping the number of threads used if configured
+    GameJobs::init(Config::gMaxJobThreads);
+
     // Init the GPU core
     {
         uint16_t vramW = {};
         uint16_t vramH = {};
         getVramSize(vramW, vramH);
         Gpu::initCore(gGpu, vramW, vramH);
+        initGpuDeferredDraw();
     }
 
     // Init the SPU core and use extended hardware voice counts (64 max) and an expanded RAM size (defaulted to 16 MiB) if the build is limit removing.
@@ -130,6 +239,16 @@ bool init(const char* const doomCdCuePath) noexcept {
 
     Spu::initCore(gSpu, spuRamSize, SPU_VOICE_COUNT);
 
+    // Cache decoded ADPCM blocks for the SPU: sounds are uploaded once and then usually played many times.
+    // Note: the number of entries must be a power of two. This number of entries requires around 1 MiB of RAM for the float SPU.
+    constexpr uint32_t SPU_ADPCM_CACHE_SIZE = 8192;
+    Spu::setAdpcmCacheSize(gSpu, SPU_ADPCM_CACHE_SIZE);
+
+    // Setup the queue for submitting SPU commands without locking.
+    // This should be more than big enough to hold all the commands issued during an audio buffer's worth of time.
+    constexpr uint32_t SPU_CMD_QUEUE_SIZE = 4096;
+    Spu::initCmdQueue(gSpuCmdQueue, SPU_CMD_QUEUE_SIZE);
+
     // Init the audio compressor if using the float SPU (don't need it for the 16-bit SPU)
     #if SIMPLE_SPU_FLOAT_SPU
         AudioCompressor::init(
@@ -157,41 +276,44 @@ bool init(const char* const doomCdCuePath) noexcept {
         }
     }
 
-    // Build up the ISO file system from the game disc
+    // Build up the ISO file system from the game disc, or load it from a cache file if it was built previously for the same disc image files.
+    // The cache file is named after the hash of the disc image files so that switching between different discs doesn't invalidate it.
     {
-        DiscReader discReader(gDiscInfo);
+        const uint64_t discSourceHash = IsoFileSys::computeDiscSourceHash(gDiscInfo, doomCdCuePath);
 
-        if (!gIsoFileSys.build(discReader)) {
-            FatalErrors::raise(
-                "Failed to extract the ISO 9960 filesystem records from the game's disc! "
-                "Is the disc in a strange format, or is the image corrupt?"
-            );
+        char cacheFileName[64];
+        std::snprintf(cacheFileName, sizeof(cacheFileName), "iso_fs_%016llx.bin", (unsigned long long) discSourceHash);
+        const std::string cacheFilePath = Utils::getOrCreateUserDataFolder() + cacheFileName;
+
+        if (!gIsoFileSys.readFromCacheFile(cacheFilePath.c_str(), discSourceHash)) {
+            DiscReader discReader(gDiscInfo);
+
+            if (!gIsoFileSys.build(discReader)) {
+                FatalErrors::raise(
+                    "Failed to extract the ISO 9960 filesystem records from the game's disc! "
+                    "Is the disc in a strange format, or is the image corrupt?"
+                );
+            }
+
+            gIsoFileSys.writeToCacheFile(cacheFilePath.c_str(), discSourceHash);
         }
     }
 
     // Setup sound
     if (SDL_InitSubSystem(SDL_INIT_AUDIO) >= 0) {
-        // Firstly try to open an audio device sampling at 44,100 Hz stereo in floating point mode.
-        // Note that if initialization succeeds then we've got our requested format, since we ask SDL not to allow any deviation.
-        SDL_AudioSpec wantFmt = {};
-        wantFmt.freq = 44100;
-        wantFmt.format = AUDIO_F32;
-        wantFmt.channels = 2;
+        // Decide on the audio buffer size to use and open the audio device
+        uint16_t bufferSize = {};
+        gbAdaptiveAudioBufferSize = (Config::gAudioBufferSize < 0);
 
         if (Config::gAudioBufferSize > 0) {
-            wantFmt.samples = (uint16_t) std::min<int32_t>(Config::gAudioBufferSize, UINT16_MAX);
+            bufferSize = (uint16_t) std::min<int32_t>(Config::gAudioBufferSize, UINT16_MAX);
+        } else if (gbAdaptiveAudioBufferSize) {
+            bufferSize = ADAPTIVE_AUDIO_BUFFER_MIN_SIZE;    // Adaptive mode: start with the minimum buffer size and grow if there are underruns
         } else {
-            wantFmt.samples = 256;  // Use a default of '256' samples (~5.8 MS latency) when using 'auto' configure mode
+            bufferSize = 256;   // Use a default of '256' samples (~5.8 MS latency) when using 'auto' configure mode
         }
 
-        wantFmt.callback = SdlAudioCallback;
-
-        SDL_AudioSpec gotFmt = {};
-        gSdlAudioDeviceId = SDL_OpenAudioDevice(nullptr, false, &wantFmt, &gotFmt, false);
-
-        if (gSdlAudioDeviceId != 0) {
-            SDL_PauseAudioDevice(gSdlAudioDeviceId, false);
-        } else {
+        if (!openAudioDevice(bufferSize)) {
             SDL_QuitSubSystem(SDL_INIT_AUDIO);
         }
     }
@@ -212,20 +334,112 @@ void shutdown() noexcept {
         gSdlAudioDeviceId = 0;
     }
 
+    Spu::destroyCmdQueue(gSpuCmdQueue);
     Spu::destroyCore(gSpu);     // Note: no locking of the SPU here because all threads should be done with it at this point
     Gpu::destroyCore(gGpu);
+    GameJobs::shutdown();       // Note: must be done after the GPU is destroyed, since deferred drawing uses the job workers
+}
+
+void initGpuDeferredDraw() noexcept {
+    // Rasterize deferred draws using the shared job worker threads, which the thread flushing deferred draws also helps out with
+    Gpu::initDeferredDraw(gGpu, GameJobs::getPool());
 }
 
 bool haveAudioOutputDevice() noexcept {
     return (gSdlAudioDeviceId != 0);
 }
 
+void updateAudioBufferSize() noexcept {
+    // Only need to do something if the audio thread has asked for a bigger buffer
+    if ((gSdlAudioDeviceId == 0) || (!gbAudioBufferGrowRequested.load(std::memory_order_relaxed)))
+        return;
+
+    // Don't grow beyond the maximum size
+    const uint16_t oldBufferSize = gAudioBufferSize;
+    const uint16_t newBufferSize = (uint16_t) std::min<uint32_t>((uint32_t) oldBufferSize * 2, ADAPTIVE_AUDIO_BUFFER_MAX_SIZE);
+
+    if (newBufferSize <= oldBufferSize) {
+        gbAudioBufferGrowRequested = false;
+        return;
+    }
+
+    // Re-open the audio device with the bigger buffer size, or with the old one if that fails.
+    // Note that closing the device waits for the audio callback to finish, and the SPU state and sample clock carry over to the new device.
+    SDL_CloseAudioDevice(gSdlAudioDeviceId);
+    gSdlAudioDeviceId = 0;
+
+    if (openAudioDevice(newBufferSize)) {
+        std::printf("Audio output underruns detected, audio buffer size increased to %u samples.\n", (unsigned) gAudioBufferSize);
+    } else if (!openAudioDevice(oldBufferSize)) {
+        std::printf("Failed to re-open the audio device after changing the audio buffer size! Audio will be disabled.\n");
+        SDL_QuitSubSystem(SDL_INIT_AUDIO);
+    }
+}
+
 void lockSpu() noexcept {
+    // Execute all pending commands once locked, including any scheduled for a sample number which has not been reached yet.
+    // Whatever thread holds the lock becomes the consumer of the command queue.
+    // Note: the audio thread does not use this function since it executes commands at the sample numbers they are scheduled for.
     gSpuMutex.lock();
+    Spu::executeCmds(gSpu, gSpuCmdQueue, gSpuSampleClock.load(std::memory_order_acquire), true);
 }
 
 void unlockSpu() noexcept {
     gSpuMutex.unlock();
 }
 
+uint32_t submitSpuCmd(const Spu::Cmd& cmd) noexcept {
+    uint32_t cmdSeqNum = {};
+
+    // Only commands submitted between 'beginTimedSpuCmds' and 'endTimedSpuCmds' are held by sample waits
+    Spu::Cmd cmdToSubmit = cmd;
+    cmdToSubmit.bTimed = gbSubmittingTimedSpuCmds;
+
+    // If the queue is full then lock the SPU to flush it, which makes space for the command.
+    // This should hopefully rarely ever happen...
+    if (!Spu::tryEnqueueCmd(gSpuCmdQueue, cmdToSubmit, cmdSeqNum)) {
+        LockSpu spuLock;    // N.B: this executes all commands, including those waiting on a sample number
+        [[maybe_unused]] const bool bEnqueued = Spu::tryEnqueueCmd(gSpuCmdQueue, cmdToSubmit, cmdSeqNum);
+        ASSERT(bEnqueued);
+    }
+
+    return cmdSeqNum;
+}
+
+bool isSpuCmdPending(const uint32_t cmdSeqNum) noexcept {
+    return Spu::isCmdPending(gSpuCmdQueue, cmdSeqNum);
+}
+
+bool isSpuSampleClockEnabled() noexcept {
+    return (Config::gbSampleAccurateMusicTiming && haveAudioOutputDevice());
+}
+
+uint32_t getSpuSampleClock() noexcept {
+    return gSpuSampleClock.load(std::memory_order_acquire);
+}
+
+uint32_t getSpuCmdLeadSamples() noexcept {
+    return gSpuCmdLeadSamples;
+}
+
+void beginTimedSpuCmds(const uint32_t sampleNum) noexcept {
+    ASSERT(!gbSubmittingTimedSpuCmds);
+    gbSubmittingTimedSpuCmds = true;
+
+    // Waits must be submitted in order since the audio thread stops at each one.
+    // Only submit if this wait is later than the previous one, and if it is not already due (no point otherwise).
+    const bool bLaterThanLastWait = ((int32_t)(sampleNum - gLastSpuCmdWaitSampleNum) > 0);
+    const bool bNotYetDue = ((int32_t)(sampleNum - getSpuSampleClock()) > 0);
+
+    if (bLaterThanLastWait && bNotYetDue) {
+        submitSpuCmd(Spu::Cmd{ Spu::CmdType::WaitUntilSample, true, 0, sampleNum });
+        gLastSpuCmdWaitSampleNum = sampleNum;
+    }
+}
+
+void endTimedSpuCmds() noexcept {
+    ASSERT(gbSubmittingTimedSpuCmds);
+    gbSubmittingTimedSpuCmds = false;
+}
+
 END_NAMESPACE(PsxVm)
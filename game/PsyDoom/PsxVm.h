@@ -12,6 +12,7 @@ namespace Gpu {
 }
 
 namespace Spu {
+    struct Cmd;
     struct Core;
 }
 
@@ -28,9 +29,17 @@ extern Spu::Core    gSpu;
 bool init(const char* const doomCdCuePath) noexcept;
 void shutdown() noexcept;
 
+// Setup deferred (multithreaded) drawing for the GPU, using the CPU cores available.
+// Note: this is done on init, but must be done again if the GPU core is re-created.
+void initGpuDeferredDraw() noexcept;
+
 // Returns 'true' if there is valid audio output device
 bool haveAudioOutputDevice() noexcept;
 
+// If using an adaptive audio buffer size, grow the buffer if the audio thread has detected too many output underruns.
+// Should be called periodically by the main/game thread.
+void updateAudioBufferSize() noexcept;
+
 // Fire timer (root counter) related events if appropriate.
 // Note: this is implemented in LIBAPI, where timers are handled.
 void generateTimerEvents() noexcept;
@@ -45,4 +54,30 @@ struct LockSpu {
     ~LockSpu() noexcept { unlockSpu(); }
 };
 
+// Submit a command to the SPU without locking it; the command is executed the next time the SPU is locked by any thread.
+// The audio thread locks the SPU before generating each block of audio, so commands will be executed before that block is generated.
+// Returns the sequence number for the command, which can be used to query if it is still pending.
+//
+// Notes:
+//  (1) Only the main/game thread is allowed to submit SPU commands.
+//  (2) Locking the SPU always executes all pending commands first, so any direct SPU modifications done after locking are correctly
+//      ordered with respect to commands submitted prior.
+uint32_t submitSpuCmd(const Spu::Cmd& cmd) noexcept;
+bool isSpuCmdPending(const uint32_t cmdSeqNum) noexcept;
+
+// Support for scheduling SPU commands at an exact sample number, used for sample accurate music sequencer timing.
+// The audio thread keeps a clock of how many samples it has generated. Commands submitted between 'beginTimedSpuCmds' and 'endTimedSpuCmds'
+// are timed: they are held until the sample clock reaches the given sample number, so that they take effect on exactly that sample.
+// Other commands (e.g sound effects) are not held by the wait, unless they must stay ordered after a held command for the same voice.
+//
+// Notes:
+//  (1) The sample clock is only enabled if there is an audio device and the user has enabled this feature.
+//  (2) Commands should be scheduled at least 'getSpuCmdLeadSamples' ahead of the sample clock, otherwise they might be late.
+//  (3) Waits are ignored when the SPU is locked by the game thread; all pending commands are executed in that case.
+bool isSpuSampleClockEnabled() noexcept;
+uint32_t getSpuSampleClock() noexcept;
+uint32_t getSpuCmdLeadSamples() noexcept;
+void beginTimedSpuCmds(const uint32_t sampleNum) noexcept;
+void endTimedSpuCmds() noexcept;
+
 END_NAMESPACE(PsxVm)
@@ -19,18 +19,29 @@
 #include "Doom/Game/p_tick.h"
 #include "Doom/Renderer/r_local.h"
 #include "Doom/Renderer/r_main.h"
+#include "FileOutputStream.h"
+#include "FileUtils.h"
 #include "Game.h"
 #include "InputStream.h"
 #include "MapHash.h"
 #include "OutputStream.h"
 #include "SaveDataTypes.h"
+#include "ScriptBindings.h"
 #include "ScriptingEngine.h"
 #include "Utils.h"
 
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
 BEGIN_NAMESPACE(SaveAndLoad)
 
 // Save/load accelerator LUT: maps from a map object to it's index in the global linked list of map objects
-std::unordered_map<mobj_t*, int32_t> gMobjToIdx;
+MobjIndexLut gMobjToIdx;
 
 // Save/load accelerator LUT: maps from a map object index to it's pointer
 std::vector<mobj_t*> gMobjList;
@@ -38,6 +49,13 @@ std::vector<mobj_t*> gMobjList;
 // Used during loading and saving: keeps track globally which slot is being used
 SaveFileSlot gCurSaveSlot = SaveFileSlot::NONE;
 
+// Saving to a file: the game state is captured on the game thread and then written to the file by this background thread.
+// The last two fields are only written by the writer thread, and only read by the game thread once the writer is done.
+static std::thread                  gSaveWriterThread;
+static std::unique_ptr<SaveData>    gpSaveDataToWrite;
+static std::atomic<bool>            gbSaveWriteDone;
+static bool                         gbSaveWriteSucceeded = true;
+
 // LUTS for thinkers of various types: used during saving and loading
 static std::vector<vldoor_t*>           gVlDoors;
 static std::vector<vlcustomdoor_t*>     gVlCustomDoors;
@@ -56,6 +74,104 @@ static std::vector<button_t*> gActiveButtons;
 // Used during loading, the input save data loaded into memory
 static SaveData gSaveDataIn;
 
+// Where each part of the save data is located in memory.
+// Allows the same code to save to and load from either a 'SaveData' object (for save files) or an in-memory snapshot.
+template <bool IsConst>
+struct SaveDataPtrs {
+    template <class T>
+    using PtrT = std::conditional_t<IsConst, const T*, T*>;
+
+    PtrT<SaveFileHdr>               pHdr;
+    PtrT<SavedGlobals>              pGlobals;
+    PtrT<SavedSnapshotGlobals>      pSnapshotGlobals;       // Only for snapshots, null for save files
+    PtrT<SavedSectorT>              pSectors;
+    PtrT<SavedLineT>                pLines;
+    PtrT<SavedSideT>                pSides;
+    PtrT<SavedMobjT>                pMobjs;
+    PtrT<SavedVLDoorT>              pVlDoors;
+    PtrT<SavedVLCustomdoorT>        pVlCustomDoors;
+    PtrT<SavedFloorMoveT>           pFloorMovers;
+    PtrT<SavedCeilingT>             pCeilings;
+    PtrT<SavedPlatT>                pPlats;
+    PtrT<SavedFireFlickerT>         pFireFlickers;
+    PtrT<SavedLightFlashT>          pLightFlashes;
+    PtrT<SavedStrobeT>              pStrobes;
+    PtrT<SavedGlowT>                pGlows;
+    PtrT<SavedDelayedExitT>         pDelayedExits;
+    PtrT<SavedButtonT>              pButtons;
+    PtrT<SavedScheduledAction>      pScheduledActions;
+};
+
+// Alignment for each part of an in-memory snapshot
+static constexpr size_t SNAPSHOT_PART_ALIGN = alignof(std::max_align_t);
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates an empty map object LUT
+//------------------------------------------------------------------------------------------------------------------------------------------
+MobjIndexLut::MobjIndexLut() noexcept : mEntries() {}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Hashes a map object pointer for the map object LUT
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline uint32_t getMobjPtrHash(const mobj_t* const pMobj) noexcept {
+    // Fibonacci hashing: the low bits of the pointer are discarded since map objects are always well aligned
+    const uint64_t ptrBits = (uint64_t)(uintptr_t) pMobj;
+    return (uint32_t)(((ptrBits >> 4) * 0x9E3779B97F4A7C15ull) >> 32);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Rebuilds the LUT so that it maps from each of the given map objects to its index in the list
+//------------------------------------------------------------------------------------------------------------------------------------------
+void MobjIndexLut::build(const std::vector<mobj_t*>& mobjs) noexcept {
+    // Keep the table at most half full so that probe sequences stay short
+    size_t tableSize = 16;
+
+    while (tableSize < mobjs.size() * 2) {
+        tableSize *= 2;
+    }
+
+    mEntries.clear();
+    mEntries.resize(tableSize, Entry{ nullptr, -1 });
+    const uint32_t tableMask = (uint32_t) tableSize - 1;
+
+    for (size_t i = 0; i < mobjs.size(); ++i) {
+        uint32_t slotIdx = getMobjPtrHash(mobjs[i]) & tableMask;
+
+        while (mEntries[slotIdx].pMobj) {
+            slotIdx = (slotIdx + 1) & tableMask;
+        }
+
+        mEntries[slotIdx] = Entry{ mobjs[i], (int32_t) i };
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Empties the LUT, but keeps the memory allocated for it so it can be reused
+//------------------------------------------------------------------------------------------------------------------------------------------
+void MobjIndexLut::clear() noexcept {
+    mEntries.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the index of the specified map object, or '-1' if the map object is not in the LUT
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t MobjIndexLut::find(const mobj_t* const pMobj) const noexcept {
+    if ((!pMobj) || mEntries.empty())
+        return -1;
+
+    const uint32_t tableMask = (uint32_t) mEntries.size() - 1;
+    uint32_t slotIdx = getMobjPtrHash(pMobj) & tableMask;
+
+    while (mEntries[slotIdx].pMobj) {
+        if (mEntries[slotIdx].pMobj == pMobj)
+            return mEntries[slotIdx].idx;
+
+        slotIdx = (slotIdx + 1) & tableMask;
+    }
+
+    return -1;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Removes all map objects from the game
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -83,7 +199,7 @@ static void removeAllThinkers() noexcept {
 
     while (pThinker != &gThinkerCap) {
         thinker_t* const pNextThinker = pThinker->next;
-        Z_Free2(*gpMainMemZone, pThinker);
+        P_FreeThinker(*pThinker);
         pThinker = pNextThinker;
     }
 
@@ -120,28 +236,21 @@ static void removeActiveButtons() noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Allocates all of the map objects to be loaded; assumes there no map objects currently existing in the game
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void allocMobjsToLoad() noexcept {
+static void allocMobjsToLoad(const SaveDataPtrs<true>& saveData) noexcept {
     // Sanity check, there should be no map objects in the game at this point
     ASSERT(gMobjHead.next == &gMobjHead);
 
-    const uint32_t numMobjs = gSaveDataIn.hdr.numMobjs;
-    gMobjToIdx.clear();
+    const uint32_t numMobjs = saveData.pHdr->numMobjs;
     gMobjList.clear();
-    gMobjToIdx.reserve(numMobjs);
     gMobjList.reserve(numMobjs);
 
     mobj_t* pMobjTail = &gMobjHead;
 
     for (uint32_t i = 0; i < numMobjs; ++i) {
-        // Alloc the map object and zero init
-        mobj_t& mobj = *(mobj_t*) Z_ZeroedMalloc(*gpMainMemZone, sizeof(mobj_t), PU_LEVEL, nullptr);
-
-        #if PSYDOOM_MODS
-            new (&mobj) mobj_t();   // PsyDoom: construct C++ weak pointers
-        #endif
+        // Alloc the map object, zero init and construct C++ weak pointers
+        mobj_t& mobj = P_AllocMobj();
 
         // Keep track of it for later loading logic
-        gMobjToIdx[&mobj] = i;
         gMobjList.push_back(&mobj);
 
         // Link the new object into the map objects list at the end
@@ -150,7 +259,10 @@ static void allocMobjsToLoad() noexcept {
         pMobjTail->next = &mobj;
         gMobjHead.prev = &mobj;
         pMobjTail = &mobj;
+        mobj.listOrder = gNextMobjListOrder++;
     }
+
+    gMobjToIdx.build(gMobjList);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -162,7 +274,7 @@ static void allocThinkersToLoad(std::vector<ThinkerT*>& outputList, const uint32
     outputList.reserve(amt);
 
     for (uint32_t i = 0; i < amt; ++i) {
-        ThinkerT& thinker = *(ThinkerT*) Z_ZeroedMalloc(*gpMainMemZone, sizeof(ThinkerT), PU_LEVSPEC, nullptr);
+        ThinkerT& thinker = *(ThinkerT*) P_AllocThinker(sizeof(ThinkerT));
         P_AddThinker(thinker.thinker);
         outputList.push_back(&thinker);
     }
@@ -171,9 +283,9 @@ static void allocThinkersToLoad(std::vector<ThinkerT*>& outputList, const uint32
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Allocates room for all of the buttons to be loaded
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void allocButtonsToLoad() noexcept {
+static void allocButtonsToLoad(const SaveDataPtrs<true>& saveData) noexcept {
     // This can only be done in limit removing builds
-    const uint32_t numBtns = gSaveDataIn.hdr.numButtons;
+    const uint32_t numBtns = saveData.pHdr->numButtons;
 
     #if PSYDOOM_LIMIT_REMOVING
         gButtonList.clear();
@@ -185,7 +297,7 @@ static void allocButtonsToLoad() noexcept {
 
         if (numBtns > MAXBUTTONS) {
             for (uint32_t i = MAXBUTTONS; i < numBtns; ++i) {
-                const SavedButtonT& savedBtn = gSaveDataIn.buttons[i];
+                const SavedButtonT& savedBtn = saveData.pButtons[i];
 
                 if (savedBtn.lineIdx < (uint32_t) gNumLines) {
                     line_t& line = gpLines[savedBtn.lineIdx];
@@ -311,17 +423,14 @@ static void gatherActiveButtons(std::vector<button_t*>& outputList, const uint32
 // Builds the LUTs for accelerating map object lookups; this is a prerequisite step for saving and loading.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void buildMobjLuts(const uint32_t reserveAmt) noexcept {
-    gMobjToIdx.clear();
     gMobjList.clear();
-    gMobjToIdx.reserve(reserveAmt);
     gMobjList.reserve(reserveAmt);
 
-    int32_t mobjIdx = 0;
-
-    for (mobj_t* pMobj = gMobjHead.next; pMobj != &gMobjHead; pMobj = pMobj->next, ++mobjIdx) {
-        gMobjToIdx[pMobj] = mobjIdx;
+    for (mobj_t* pMobj = gMobjHead.next; pMobj != &gMobjHead; pMobj = pMobj->next) {
         gMobjList.push_back(pMobj);
     }
+
+    gMobjToIdx.build(gMobjList);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -360,7 +469,7 @@ static void populateSaveHeader(SaveFileHdr& hdr) noexcept {
 // Validates a list of save file objects
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <class ObjT>
-static bool validateObjects(const std::unique_ptr<ObjT[]>& pObjs, const uint32_t numObjs) noexcept {
+static bool validateObjects(const ObjT* const pObjs, const uint32_t numObjs) noexcept {
     for (uint32_t i = 0; i < numObjs; ++i) {
         if (!pObjs[i].validate())
             return false;
@@ -370,41 +479,39 @@ static bool validateObjects(const std::unique_ptr<ObjT[]>& pObjs, const uint32_t
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Serializes an array of objects
+// Serializes an array of objects to the given output array
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <class SrcT, class DstT>
-static void serializeObjects(const SrcT* const pSrcObjs, std::unique_ptr<DstT[]>& dstObjs, const uint32_t numObjs) noexcept {
-    // Alloc the output array and ensure even padding bytes are zero initialized
-    dstObjs = std::make_unique<DstT[]>(numObjs);
-    std::memset(dstObjs.get(), 0, sizeof(DstT) * numObjs);
+static void serializeObjects(const SrcT* const pSrcObjs, DstT* const pDstObjs, const uint32_t numObjs) noexcept {
+    // Ensure even padding bytes are zero initialized
+    std::memset(pDstObjs, 0, sizeof(DstT) * numObjs);
 
     // Serialize everything
     for (uint32_t i = 0; i < numObjs; ++i) {
-        dstObjs[i].serializeFrom(pSrcObjs[i]);
+        pDstObjs[i].serializeFrom(pSrcObjs[i]);
     }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Serializes a list of pointers to objects
+// Serializes a list of pointers to objects to the given output array
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <class SrcT, class DstT>
-static void serializeObjects(const std::vector<SrcT*>& srcObjs, std::unique_ptr<DstT[]>& dstObjs) noexcept {
-    // Alloc the output array and ensure all objects are initialized
+static void serializeObjects(const std::vector<SrcT*>& srcObjs, DstT* const pDstObjs) noexcept {
+    // Ensure all objects are initialized
     const size_t numObjs = srcObjs.size();
-    dstObjs = std::make_unique<DstT[]>(numObjs);
 
     if constexpr (std::is_trivial_v<DstT>) {
-        std::memset(dstObjs.get(), 0, sizeof(DstT) * numObjs);
+        std::memset(pDstObjs, 0, sizeof(DstT) * numObjs);
     } else {
         // For non trivially constructed/copied objects use this method instead of a simple 'memset()'
         for (size_t i = 0; i < numObjs; ++i) {
-            dstObjs[i] = {};
+            pDstObjs[i] = {};
         }
     }
 
     // Serialize everything
     for (size_t i = 0; i < numObjs; ++i) {
-        dstObjs[i].serializeFrom(*srcObjs[i]);
+        pDstObjs[i].serializeFrom(*srcObjs[i]);
     }
 }
 
@@ -413,7 +520,7 @@ static void serializeObjects(const std::vector<SrcT*>& srcObjs, std::unique_ptr<
 // Note: does not zero-init, assumes destination objects have already had this done upon allocation.
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <class SrcT, class DstT>
-static void deserializeObjects(const std::unique_ptr<SrcT>& pSrcObjs, DstT* const pDstObjs, const uint32_t numObjs) noexcept {
+static void deserializeObjects(const SrcT* const pSrcObjs, DstT* const pDstObjs, const uint32_t numObjs) noexcept {
     for (uint32_t i = 0; i < numObjs; ++i) {
         pSrcObjs[i].deserializeTo(pDstObjs[i]);
     }
@@ -424,7 +531,7 @@ static void deserializeObjects(const std::unique_ptr<SrcT>& pSrcObjs, DstT* cons
 // Note: does not zero-init, assumes destination objects have already had this done upon allocation.
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <class SrcT, class DstT>
-static void deserializeObjects(const std::unique_ptr<SrcT>& pSrcObjs, const std::vector<DstT*>& dstObjs) noexcept {
+static void deserializeObjects(const SrcT* const pSrcObjs, const std::vector<DstT*>& dstObjs) noexcept {
     const uint32_t numObjs = (uint32_t) dstObjs.size();
 
     for (uint32_t i = 0; i < numObjs; ++i) {
@@ -432,6 +539,99 @@ static void deserializeObjects(const std::unique_ptr<SrcT>& pSrcObjs, const std:
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns pointers to all the parts of the given save data
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class SaveDataT>
+static SaveDataPtrs<std::is_const_v<SaveDataT>> getSaveDataPtrs(SaveDataT& saveData) noexcept {
+    SaveDataPtrs<std::is_const_v<SaveDataT>> ptrs = {};
+    ptrs.pHdr = &saveData.hdr;
+    ptrs.pGlobals = &saveData.globals;
+    ptrs.pSnapshotGlobals = nullptr;
+    ptrs.pSectors = saveData.sectors.get();
+    ptrs.pLines = saveData.lines.get();
+    ptrs.pSides = saveData.sides.get();
+    ptrs.pMobjs = saveData.mobjs.get();
+    ptrs.pVlDoors = saveData.vlDoors.get();
+    ptrs.pVlCustomDoors = saveData.vlCustomDoors.get();
+    ptrs.pFloorMovers = saveData.floorMovers.get();
+    ptrs.pCeilings = saveData.ceilings.get();
+    ptrs.pPlats = saveData.plats.get();
+    ptrs.pFireFlickers = saveData.fireFlickers.get();
+    ptrs.pLightFlashes = saveData.lightFlashes.get();
+    ptrs.pStrobes = saveData.strobes.get();
+    ptrs.pGlows = saveData.glows.get();
+    ptrs.pDelayedExits = saveData.delayedExits.get();
+    ptrs.pButtons = saveData.buttons.get();
+    ptrs.pScheduledActions = saveData.scheduledActions.get();
+    return ptrs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Figures out the layout of an in-memory snapshot with the object counts given by the specified header and returns its total size.
+// Each part of the snapshot is stored one after the other in the same order as 'SaveDataPtrs', with each part suitably aligned.
+// If a pointer to the snapshot memory is given then the pointers to each part of the snapshot are also set, otherwise they are nulled.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class ByteT, bool IsConst>
+static size_t getSnapshotLayout(ByteT* const pSnapshot, const SaveFileHdr& hdr, SaveDataPtrs<IsConst>& ptrs) noexcept {
+    size_t offset = 0;
+
+    const auto addPart = [&](auto& pPart, const uint32_t numObjs) noexcept {
+        typedef std::remove_reference_t<decltype(pPart)> PartPtrT;
+        typedef std::remove_cv_t<std::remove_pointer_t<PartPtrT>> PartT;
+        static_assert(std::is_trivially_copyable_v<PartT>, "Snapshot parts must be trivially copyable!");
+
+        offset = (offset + SNAPSHOT_PART_ALIGN - 1) & ~(SNAPSHOT_PART_ALIGN - 1);
+        pPart = (pSnapshot) ? reinterpret_cast<PartPtrT>(pSnapshot + offset) : nullptr;
+        offset += sizeof(PartT) * numObjs;
+    };
+
+    addPart(ptrs.pHdr, 1);
+    addPart(ptrs.pGlobals, 1);
+    addPart(ptrs.pSnapshotGlobals, 1);
+    addPart(ptrs.pSectors, hdr.numSectors);
+    addPart(ptrs.pLines, hdr.numLines);
+    addPart(ptrs.pSides, hdr.numSides);
+    addPart(ptrs.pMobjs, hdr.numMobjs);
+    addPart(ptrs.pVlDoors, hdr.numVlDoors);
+    addPart(ptrs.pVlCustomDoors, hdr.numVlCustomDoors);
+    addPart(ptrs.pFloorMovers, hdr.numFloorMovers);
+    addPart(ptrs.pCeilings, hdr.numCeilings);
+    addPart(ptrs.pPlats, hdr.numPlats);
+    addPart(ptrs.pFireFlickers, hdr.numFireFlickers);
+    addPart(ptrs.pLightFlashes, hdr.numLightFlashes);
+    addPart(ptrs.pStrobes, hdr.numStrobes);
+    addPart(ptrs.pGlows, hdr.numGlows);
+    addPart(ptrs.pDelayedExits, hdr.numDelayedExits);
+    addPart(ptrs.pButtons, hdr.numButtons);
+    addPart(ptrs.pScheduledActions, hdr.numScheduledActions);
+    return offset;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocates all of the object arrays in the given save data (with counts as given by its header) and returns pointers to all its parts
+//------------------------------------------------------------------------------------------------------------------------------------------
+static SaveDataPtrs<false> allocSaveData(SaveData& saveData) noexcept {
+    const SaveFileHdr& hdr = saveData.hdr;
+    saveData.sectors = std::make_unique<SavedSectorT[]>(hdr.numSectors);
+    saveData.lines = std::make_unique<SavedLineT[]>(hdr.numLines);
+    saveData.sides = std::make_unique<SavedSideT[]>(hdr.numSides);
+    saveData.mobjs = std::make_unique<SavedMobjT[]>(hdr.numMobjs);
+    saveData.vlDoors = std::make_unique<SavedVLDoorT[]>(hdr.numVlDoors);
+    saveData.vlCustomDoors = std::make_unique<SavedVLCustomdoorT[]>(hdr.numVlCustomDoors);
+    saveData.floorMovers = std::make_unique<SavedFloorMoveT[]>(hdr.numFloorMovers);
+    saveData.ceilings = std::make_unique<SavedCeilingT[]>(hdr.numCeilings);
+    saveData.plats = std::make_unique<SavedPlatT[]>(hdr.numPlats);
+    saveData.fireFlickers = std::make_unique<SavedFireFlickerT[]>(hdr.numFireFlickers);
+    saveData.lightFlashes = std::make_unique<SavedLightFlashT[]>(hdr.numLightFlashes);
+    saveData.strobes = std::make_unique<SavedStrobeT[]>(hdr.numStrobes);
+    saveData.glows = std::make_unique<SavedGlowT[]>(hdr.numGlows);
+    saveData.delayedExits = std::make_unique<SavedDelayedExitT[]>(hdr.numDelayedExits);
+    saveData.buttons = std::make_unique<SavedButtonT[]>(hdr.numButtons);
+    saveData.scheduledActions = std::make_unique<SavedScheduledAction[]>(hdr.numScheduledActions);
+    return getSaveDataPtrs(saveData);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Load helper: if the specified CD track is valid, plays it if not already playing.
 // If the CD track given is NOT valid then this function will instead stop any currently playing CD track.
@@ -458,9 +658,9 @@ static void playOrStopCdTrackIfNeeded(const int32_t cdTrackNum) noexcept {
 // Load helper: add loaded active ceilings and plats to the active lists.
 // Note: expects the lists of output ceilings and plats to be allocated.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void addActiveCeilingsAndPlats() noexcept {
-    const uint32_t numCeils = gSaveDataIn.hdr.numCeilings;
-    const uint32_t numPlats = gSaveDataIn.hdr.numPlats;
+static void addActiveCeilingsAndPlats(const SaveDataPtrs<true>& saveData) noexcept {
+    const uint32_t numCeils = saveData.pHdr->numCeilings;
+    const uint32_t numPlats = saveData.pHdr->numPlats;
     ASSERT(numCeils == gCeilings.size());
     ASSERT(numPlats == gPlats.size());
 
@@ -474,11 +674,13 @@ static void addActiveCeilingsAndPlats() noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Load helper: add all map objects into the world (registers with sectors and the blockmap)
+// Load helper: add all map objects into the world (registers with sectors and the blockmap).
+// Also adds them to the lists of things for each type, now that their types are known.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void addMobjsToSectors() noexcept {
     for (mobj_t* const pMobj : gMobjList) {
         P_SetThingPosition(*pMobj);
+        P_LinkMobjToTypeList(*pMobj);
     }
 }
 
@@ -512,10 +714,10 @@ static void associateThinkersWithSectors(const std::vector<ThinkerT*>& thinkers)
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Attempts to save the game to the specified output file
+// Gathers lists of all the map objects, thinkers and buttons to be saved; this is a prerequisite step for saving.
+// Note: the lists keep their memory between saves, so this does not need to allocate once the lists have grown large enough.
 //------------------------------------------------------------------------------------------------------------------------------------------
-bool save(OutputStream& out) noexcept {
-    // Build required LUTs
+static void gatherObjectsToSave() noexcept {
     buildMobjLuts(8192);
     gatherThinkersOfType(T_VerticalDoor, gVlDoors, 128);
     gatherThinkersOfType(T_CustomDoor, gVlCustomDoors, 128);
@@ -528,51 +730,49 @@ bool save(OutputStream& out) noexcept {
     gatherThinkersOfType(T_Glow, gGlows, 512);
     gatherDelayedActionsOfType(G_CompleteLevel, gDelayedExits, 0);      // Don't expect to ever save this in practice...
     gatherActiveButtons(gActiveButtons, 32);
-
-    // Populate the save header, globals and all the lists of objects
-    SaveData saveData = {};
-    SaveFileHdr& hdr = saveData.hdr;
-
-    populateSaveHeader(hdr);
-    saveData.globals.serializeFromGlobals();
-    serializeObjects(gpSectors, saveData.sectors, hdr.numSectors);
-    serializeObjects(gpLines, saveData.lines, hdr.numLines);
-    serializeObjects(gpSides, saveData.sides, hdr.numSides);
-    serializeObjects(gMobjList, saveData.mobjs);
-    serializeObjects(gVlDoors, saveData.vlDoors);
-    serializeObjects(gVlCustomDoors, saveData.vlCustomDoors);
-    serializeObjects(gFloorMovers, saveData.floorMovers);
-    serializeObjects(gCeilings, saveData.ceilings);
-    serializeObjects(gPlats, saveData.plats);
-    serializeObjects(gFireFlickers, saveData.fireFlickers);
-    serializeObjects(gLightFlashes, saveData.lightFlashes);
-    serializeObjects(gStrobes, saveData.strobes);
-    serializeObjects(gGlows, saveData.glows);
-    serializeObjects(gDelayedExits, saveData.delayedExits);
-    serializeObjects(gActiveButtons, saveData.buttons);
-    serializeObjects(ScriptingEngine::gScheduledActions.data(), saveData.scheduledActions, hdr.numScheduledActions);
-
-    // Cleanup and finish up by writing it all out to a file
-    clearTempLuts();
-    return saveData.writeTo(out);
+    ScriptingEngine::syncScheduledActionDelays();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Reads a save file from the specified input stream and performs basic validation.
-// This step doesn't actually begin the process of loading the level, just buffers all the data.
+// Serializes the globals and all the lists of objects gathered for saving to the given save data; the header must be populated already.
+// If the save data has snapshot globals then those are serialized too.
 //------------------------------------------------------------------------------------------------------------------------------------------
-ReadSaveResult read(InputStream& in) noexcept {
-    gSaveDataIn = {};
-    return gSaveDataIn.readFrom(in);
+static void serializeSaveData(const SaveDataPtrs<false>& saveData) noexcept {
+    const SaveFileHdr& hdr = *saveData.pHdr;
+
+    *saveData.pGlobals = {};
+    saveData.pGlobals->serializeFromGlobals();
+
+    if (saveData.pSnapshotGlobals) {
+        *saveData.pSnapshotGlobals = {};
+        saveData.pSnapshotGlobals->serializeFromGlobals();
+    }
+
+    serializeObjects(gpSectors, saveData.pSectors, hdr.numSectors);
+    serializeObjects(gpLines, saveData.pLines, hdr.numLines);
+    serializeObjects(gpSides, saveData.pSides, hdr.numSides);
+    serializeObjects(gMobjList, saveData.pMobjs);
+    serializeObjects(gVlDoors, saveData.pVlDoors);
+    serializeObjects(gVlCustomDoors, saveData.pVlCustomDoors);
+    serializeObjects(gFloorMovers, saveData.pFloorMovers);
+    serializeObjects(gCeilings, saveData.pCeilings);
+    serializeObjects(gPlats, saveData.pPlats);
+    serializeObjects(gFireFlickers, saveData.pFireFlickers);
+    serializeObjects(gLightFlashes, saveData.pLightFlashes);
+    serializeObjects(gStrobes, saveData.pStrobes);
+    serializeObjects(gGlows, saveData.pGlows);
+    serializeObjects(gDelayedExits, saveData.pDelayedExits);
+    serializeObjects(gActiveButtons, saveData.pButtons);
+    serializeObjects(ScriptingEngine::gScheduledActions.data(), saveData.pScheduledActions, hdr.numScheduledActions);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Loads the current save file that has been read into memory, after the map file used by the save has been loaded
+// Loads the given save data which is in memory, including the extra globals for a snapshot if the save data is for a snapshot
 //------------------------------------------------------------------------------------------------------------------------------------------
-LoadSaveResult load() noexcept {
+static LoadSaveResult loadSaveData(const SaveDataPtrs<true>& saveData) noexcept {
     // Do some very basic validations first
-    const SaveData& saveData = gSaveDataIn;
-    const SaveFileHdr& hdr = saveData.hdr;
+    const SaveFileHdr& hdr = *saveData.pHdr;
+    const SavedSnapshotGlobals* const pSnapshotGlobals = saveData.pSnapshotGlobals;
 
     if (!hdr.validateMapHash())
         return LoadSaveResult::BAD_MAP_HASH;
@@ -587,7 +787,7 @@ LoadSaveResult load() noexcept {
     ScriptingEngine::gScheduledActions.clear();
 
     // Allocate objects that the save file calls for
-    allocMobjsToLoad();
+    allocMobjsToLoad(saveData);
     allocThinkersToLoad(gVlDoors, hdr.numVlDoors);
     allocThinkersToLoad(gVlCustomDoors, hdr.numVlCustomDoors);
     allocThinkersToLoad(gFloorMovers, hdr.numFloorMovers);
@@ -598,25 +798,25 @@ LoadSaveResult load() noexcept {
     allocThinkersToLoad(gStrobes, hdr.numStrobes);
     allocThinkersToLoad(gGlows, hdr.numGlows);
     allocThinkersToLoad(gDelayedExits, hdr.numDelayedExits);
-    allocButtonsToLoad();
+    allocButtonsToLoad(saveData);
     ScriptingEngine::gScheduledActions.resize(hdr.numScheduledActions);
 
     // Validate everything that needs to be validated
     const bool bAllValid = (
-        saveData.globals.validate() &&
-        validateObjects(saveData.sectors, hdr.numSectors) &&
-        validateObjects(saveData.sides, hdr.numSides) &&
-        validateObjects(saveData.mobjs, hdr.numMobjs) &&
-        validateObjects(saveData.vlDoors, hdr.numVlDoors) &&
-        validateObjects(saveData.vlCustomDoors, hdr.numVlCustomDoors) &&
-        validateObjects(saveData.floorMovers, hdr.numFloorMovers) &&
-        validateObjects(saveData.ceilings, hdr.numCeilings) &&
-        validateObjects(saveData.plats, hdr.numPlats) &&
-        validateObjects(saveData.fireFlickers, hdr.numFireFlickers) &&
-        validateObjects(saveData.lightFlashes, hdr.numLightFlashes) &&
-        validateObjects(saveData.strobes, hdr.numStrobes) &&
-        validateObjects(saveData.glows, hdr.numGlows) &&
-        validateObjects(saveData.buttons, hdr.numButtons)
+        saveData.pGlobals->validate() &&
+        validateObjects(saveData.pSectors, hdr.numSectors) &&
+        validateObjects(saveData.pSides, hdr.numSides) &&
+        validateObjects(saveData.pMobjs, hdr.numMobjs) &&
+        validateObjects(saveData.pVlDoors, hdr.numVlDoors) &&
+        validateObjects(saveData.pVlCustomDoors, hdr.numVlCustomDoors) &&
+        validateObjects(saveData.pFloorMovers, hdr.numFloorMovers) &&
+        validateObjects(saveData.pCeilings, hdr.numCeilings) &&
+        validateObjects(saveData.pPlats, hdr.numPlats) &&
+        validateObjects(saveData.pFireFlickers, hdr.numFireFlickers) &&
+        validateObjects(saveData.pLightFlashes, hdr.numLightFlashes) &&
+        validateObjects(saveData.pStrobes, hdr.numStrobes) &&
+        validateObjects(saveData.pGlows, hdr.numGlows) &&
+        validateObjects(saveData.pButtons, hdr.numButtons)
     );
 
     if (!bAllValid)
@@ -629,23 +829,32 @@ LoadSaveResult load() noexcept {
         button_t* const pButtons = gButtonList;
     #endif
 
-    saveData.globals.deserializeToGlobals();
-    deserializeObjects(saveData.sectors, gpSectors, hdr.numSectors);
-    deserializeObjects(saveData.lines, gpLines, hdr.numLines);
-    deserializeObjects(saveData.sides, gpSides, hdr.numSides);
-    deserializeObjects(saveData.mobjs, gMobjList);
-    deserializeObjects(saveData.vlDoors, gVlDoors);
-    deserializeObjects(saveData.vlCustomDoors, gVlCustomDoors);
-    deserializeObjects(saveData.floorMovers, gFloorMovers);
-    deserializeObjects(saveData.ceilings, gCeilings);
-    deserializeObjects(saveData.plats, gPlats);
-    deserializeObjects(saveData.fireFlickers, gFireFlickers);
-    deserializeObjects(saveData.lightFlashes, gLightFlashes);
-    deserializeObjects(saveData.strobes, gStrobes);
-    deserializeObjects(saveData.glows, gGlows);
-    deserializeObjects(saveData.delayedExits, gDelayedExits);
-    deserializeObjects(saveData.buttons, pButtons, hdr.numButtons);
-    deserializeObjects(saveData.scheduledActions, ScriptingEngine::gScheduledActions.data(), hdr.numScheduledActions);
+    saveData.pGlobals->deserializeToGlobals();
+    deserializeObjects(saveData.pSectors, gpSectors, hdr.numSectors);
+    deserializeObjects(saveData.pLines, gpLines, hdr.numLines);
+    deserializeObjects(saveData.pSides, gpSides, hdr.numSides);
+    deserializeObjects(saveData.pMobjs, gMobjList);
+    deserializeObjects(saveData.pVlDoors, gVlDoors);
+    deserializeObjects(saveData.pVlCustomDoors, gVlCustomDoors);
+    deserializeObjects(saveData.pFloorMovers, gFloorMovers);
+    deserializeObjects(saveData.pCeilings, gCeilings);
+    deserializeObjects(saveData.pPlats, gPlats);
+    deserializeObjects(saveData.pFireFlickers, gFireFlickers);
+    deserializeObjects(saveData.pLightFlashes, gLightFlashes);
+    deserializeObjects(saveData.pStrobes, gStrobes);
+    deserializeObjects(saveData.pGlows, gGlows);
+    deserializeObjects(saveData.pDelayedExits, gDelayedExits);
+    deserializeObjects(saveData.pButtons, pButtons, hdr.numButtons);
+    deserializeObjects(saveData.pScheduledActions, ScriptingEngine::gScheduledActions.data(), hdr.numScheduledActions);
+    ScriptingEngine::rebuildScheduledActionIndexes();
+    P_InvalidateSectorTagIndex();
+    P_InvalidateSpecialLineBlockmap();
+    ScriptBindings::invalidateLineTagIndex();
+
+    // Snapshots also restore the state for all players and for multiplayer, which regular saves just default
+    if (pSnapshotGlobals) {
+        pSnapshotGlobals->deserializeToGlobals();
+    }
 
     // Post load actions: update skill based game settings, adding map objects into the blockmap and sector lists, and associating thinkers with their sectors
     G_UpdateMobjInfoForSkill(gGameSkill);
@@ -655,10 +864,14 @@ LoadSaveResult load() noexcept {
     associateThinkersWithSectors(gFloorMovers);
     associateThinkersWithSectors(gCeilings);
     associateThinkersWithSectors(gPlats);
-    addActiveCeilingsAndPlats();
+    addActiveCeilingsAndPlats(saveData);
+
+    // Post load actions: play or stop CD music if required, kill interpolations and update sector draw params.
+    // Snapshots are restored within the same play session so the music is left alone for those.
+    if (!pSnapshotGlobals) {
+        playOrStopCdTrackIfNeeded(saveData.pGlobals->curCDTrack);
+    }
 
-    // Post load actions: play or stop CD music if required, kill interpolations and update sector draw params
-    playOrStopCdTrackIfNeeded(saveData.globals.curCDTrack);
     R_SnapPlayerInterpolation();
     updateSectorDrawParams();
 
@@ -667,6 +880,170 @@ LoadSaveResult load() noexcept {
     return LoadSaveResult::OK;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Attempts to save the game to the specified output file
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool save(OutputStream& out) noexcept {
+    // Gather everything to be saved, then populate the save header, globals and all the lists of objects
+    gatherObjectsToSave();
+
+    SaveData saveData = {};
+    populateSaveHeader(saveData.hdr);
+    serializeSaveData(allocSaveData(saveData));
+
+    // Cleanup and finish up by writing it all out to a file
+    clearTempLuts();
+    return saveData.writeTo(out);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writer thread for 'beginSaveToFile': writes the captured save data to a temporary file and then replaces the save file with that.
+// This means that a failed or interrupted write never leaves behind a partial save file.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void saveWriterThreadMain(const std::string filePath) noexcept {
+    const std::string tmpFilePath = filePath + ".tmp";
+    bool bSuccess = false;
+
+    try {
+        FileOutputStream file(tmpFilePath.c_str(), false);
+        bSuccess = gpSaveDataToWrite->writeTo(file);
+
+        if (bSuccess) {
+            file.flush();
+        }
+    }
+    catch (...) {
+        bSuccess = false;
+    }
+
+    if (bSuccess) {
+        bSuccess = FileUtils::replaceFile(tmpFilePath.c_str(), filePath.c_str());
+    }
+
+    if (!bSuccess) {
+        std::remove(tmpFilePath.c_str());
+    }
+
+    gbSaveWriteSucceeded = bSuccess;
+    gbSaveWriteDone.store(true, std::memory_order_release);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Begins saving the game to the specified file.
+// The game state is captured immediately, but compressing it and writing the file is done in the background so the game doesn't hitch.
+// Call 'endSaveToFile' to wait for the save to finish and find out whether it succeeded. Only one save to a file can be in progress, so
+// any previous save is finished up first.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool beginSaveToFile(const std::string& filePath) noexcept {
+    endSaveToFile();
+
+    // Gather everything to be saved, then populate the save header, globals and all the lists of objects
+    gatherObjectsToSave();
+
+    gpSaveDataToWrite = std::make_unique<SaveData>();
+    populateSaveHeader(gpSaveDataToWrite->hdr);
+    serializeSaveData(allocSaveData(*gpSaveDataToWrite));
+    clearTempLuts();
+
+    // Write it all out to the file in the background, or on this thread if a thread can't be started for some reason
+    gbSaveWriteDone = false;
+
+    try {
+        gSaveWriterThread = std::thread(saveWriterThreadMain, filePath);
+    }
+    catch (...) {
+        saveWriterThreadMain(filePath);
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if a save started with 'beginSaveToFile' is still being written
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isSaveToFileInProgress() noexcept {
+    return (gSaveWriterThread.joinable() && (!gbSaveWriteDone.load(std::memory_order_acquire)));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Waits for any save started with 'beginSaveToFile' to finish and returns whether it succeeded.
+// If no save was started since the last call then 'true' is returned.
+// This must be called before reading a save file which might be being written, and before the program exits.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool endSaveToFile() noexcept {
+    if (gSaveWriterThread.joinable()) {
+        gSaveWriterThread.join();
+    }
+
+    gpSaveDataToWrite.reset();
+    const bool bSuccess = gbSaveWriteSucceeded;
+    gbSaveWriteSucceeded = true;
+    return bSuccess;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads a save file from the specified input stream and performs basic validation.
+// This step doesn't actually begin the process of loading the level, just buffers all the data.
+//------------------------------------------------------------------------------------------------------------------------------------------
+ReadSaveResult read(InputStream& in) noexcept {
+    gSaveDataIn = {};
+    return gSaveDataIn.readFrom(in);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Loads the current save file that has been read into memory, after the map file used by the save has been loaded
+//------------------------------------------------------------------------------------------------------------------------------------------
+LoadSaveResult load() noexcept {
+    return loadSaveData(getSaveDataPtrs(std::as_const(gSaveDataIn)));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Saves an in-memory snapshot of the current game state directly to the given memory region, which must be 'max_align_t' aligned.
+// Unlike regular saves this includes the state for all players and multiplayer, so snapshots can be taken during networked games.
+// Snapshots are only meant to be restored during the same play session and level, they should not be written to disk.
+//
+// The size of the snapshot is always output, even if the memory region is too small for it and 'false' is returned for failure.
+// This allows the caller to grow the memory region and try again. Since the object lists used for saving and the memory region are
+// both reused between calls, once these have grown large enough then taking a snapshot does not need any heap allocations.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool saveSnapshot(std::byte* const pDst, const size_t dstCapacity, size_t& snapshotSizeOut) noexcept {
+    gatherObjectsToSave();
+
+    SaveFileHdr hdr = {};
+    populateSaveHeader(hdr);
+
+    SaveDataPtrs<false> snapshot = {};
+    const bool bIsAligned = ((uintptr_t) pDst % SNAPSHOT_PART_ALIGN == 0);
+    snapshotSizeOut = getSnapshotLayout(pDst, hdr, snapshot);
+    const bool bCanSave = (pDst && bIsAligned && (snapshotSizeOut <= dstCapacity));
+
+    if (bCanSave) {
+        *snapshot.pHdr = hdr;
+        serializeSaveData(snapshot);
+    }
+
+    clearTempLuts();
+    return bCanSave;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Restores the game state from a snapshot previously saved with 'saveSnapshot' during the current level.
+// The snapshot is loaded in place from the given memory, which must be 'max_align_t' aligned.
+// If the snapshot data is not valid then 'BAD_MAP_DATA' is returned.
+//------------------------------------------------------------------------------------------------------------------------------------------
+LoadSaveResult loadSnapshot(const std::byte* const pSrc, const size_t srcSize) noexcept {
+    if ((!pSrc) || ((uintptr_t) pSrc % SNAPSHOT_PART_ALIGN != 0) || (srcSize < sizeof(SaveFileHdr)))
+        return LoadSaveResult::BAD_MAP_DATA;
+
+    SaveDataPtrs<true> snapshot = {};
+    const SaveFileHdr& hdr = *reinterpret_cast<const SaveFileHdr*>(pSrc);
+
+    if (getSnapshotLayout(pSrc, hdr, snapshot) > srcSize)
+        return LoadSaveResult::BAD_MAP_DATA;
+
+    return loadSaveData(snapshot);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Returns the base name of the save file used for the specified save slot.
 // The returned name does not have any game specific save file prefixes added.
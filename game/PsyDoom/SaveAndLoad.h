@@ -2,8 +2,8 @@
 
 #include "Macros.h"
 
+#include <cstddef>
 #include <string>
-#include <unordered_map>
 #include <vector>
 
 class InputStream;
@@ -38,13 +38,40 @@ enum class SaveFileSlot : uint8_t {
 
 BEGIN_NAMESPACE(SaveAndLoad)
 
-extern std::unordered_map<mobj_t*, int32_t>     gMobjToIdx;
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A lookup table from map object pointers to their index in the list of map objects being saved or loaded.
+// Implemented as an open addressing hash table stored in a single array, which is reused after being cleared. This means that once the
+// table has grown large enough, rebuilding it for each save or snapshot does not need to allocate any memory.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class MobjIndexLut {
+public:
+    MobjIndexLut() noexcept;
+
+    void build(const std::vector<mobj_t*>& mobjs) noexcept;
+    void clear() noexcept;
+    int32_t find(const mobj_t* const pMobj) const noexcept;
+
+private:
+    struct Entry {
+        const mobj_t*   pMobj;      // The map object for this entry, or null if the entry is empty
+        int32_t         idx;        // Index of the map object
+    };
+
+    std::vector<Entry>  mEntries;   // The hash table: the size is always zero or a power of two
+};
+
+extern MobjIndexLut                             gMobjToIdx;
 extern std::vector<mobj_t*>                     gMobjList;
 extern SaveFileSlot                             gCurSaveSlot;
 
 bool save(OutputStream& out) noexcept;
+bool beginSaveToFile(const std::string& filePath) noexcept;
+bool isSaveToFileInProgress() noexcept;
+bool endSaveToFile() noexcept;
 ReadSaveResult read(InputStream& in) noexcept;
 LoadSaveResult load() noexcept;
+bool saveSnapshot(std::byte* const pDst, const size_t dstCapacity, size_t& snapshotSizeOut) noexcept;
+LoadSaveResult loadSnapshot(const std::byte* const pSrc, const size_t srcSize) noexcept;
 const char* getSaveFileBaseName(const SaveFileSlot slot) noexcept;
 std::string getSaveFilePath(const SaveFileSlot slot) noexcept;
 void clearBufferedSave() noexcept;
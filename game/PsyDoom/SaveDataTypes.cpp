@@ -28,6 +28,7 @@
 #include "Doom/Game/p_plats.h"
 #include "Doom/Game/p_pspr.h"
 #include "Doom/Game/p_setup.h"
+#include "Doom/Game/p_sight.h"
 #include "Doom/Game/p_spec.h"
 #include "Doom/Game/p_switch.h"
 #include "Doom/Game/p_tick.h"
@@ -37,17 +38,23 @@
 #include "Doom/Renderer/r_main.h"
 #include "Doom/UI/pw_main.h"
 #include "Doom/UI/st_main.h"
+#include "ByteInputStream.h"
+#include "ByteVecOutputStream.h"
 #include "Endian.h"
 #include "Game.h"
 #include "InputStream.h"
 #include "MapHash.h"
 #include "OutputStream.h"
 #include "SaveAndLoad.h"
+#include "SaveDelta.h"
 #include "ScriptingEngine.h"
 #include "Wess/psxcd.h"
 
 #include <algorithm>
 
+// Sanity limit on the size of a compressed save file body once it is decompressed, so that corrupt files don't cause huge allocations
+static constexpr uint32_t MAX_SAVE_BODY_SIZE = 256 * 1024 * 1024;
+
 // Make sure the global password character buffer is the expected size
 static_assert(PW_SEQ_LEN == C_ARRAY_SIZE(SavedGlobals::passwordCharBuffer), "Password char buffer has unexpected size!");
 
@@ -229,18 +236,10 @@ static bool validateObjects(const T (&pObjs)[ArraySize]) noexcept {
 // Returns '-1' if the map object is not in the global map objects list, or is null.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static int32_t getMobjIndex(mobj_t* const pMobj) noexcept {
-    if (pMobj) {
-        const auto iter = SaveAndLoad::gMobjToIdx.find(pMobj);
-
-        // Make sure the map object pointer is valid. There are bugs in the DOOM code where sometimes the 'target' and 'tracer'
-        // fields end up pointing to deleted objects. I've fixed this issue but keep the sanity checks here just in case.
-        // If the pointer is to an invalid object then just pretend it was a null pointer for the purposes of serialization...
-        if (iter != SaveAndLoad::gMobjToIdx.end()) {
-            return iter->second;
-        }
-    }
-
-    return -1;
+    // Make sure the map object pointer is valid. There are bugs in the DOOM code where sometimes the 'target' and 'tracer'
+    // fields end up pointing to deleted objects. I've fixed this issue but keep the sanity checks here just in case.
+    // If the pointer is to an invalid object then just pretend it was a null pointer for the purposes of serialization ('-1' is returned).
+    return SaveAndLoad::gMobjToIdx.find(pMobj);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -306,7 +305,9 @@ void SavedSectorT::deserializeTo(sector_t& sector) const noexcept {
     // All things should be removed from the map at this point!
     ASSERT(sector.thinglist == nullptr);
 
-    // Note: we don't init the thing list deliberately here - that's done elsewhere
+    // Note: we don't init the thing list deliberately here - that's done elsewhere.
+    // Sector heights are also changing, so invalidate all cached sight check results.
+    gSectorGeometryEpoch++;
     sector.floorheight = floorheight;
     sector.ceilingheight = ceilingheight;
     sector.floorpic = floorpic;
@@ -1448,12 +1449,32 @@ void SaveFileHdr::byteSwap() noexcept {
     byteSwapValue(numScheduledActions);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads just the header of a save file from the specified stream and validates the file id and version.
+// Leaves the stream positioned at the start of the save body; used for cheaply inspecting saves without reading the bulk of the data.
+//------------------------------------------------------------------------------------------------------------------------------------------
+ReadSaveResult SaveFileHdr::readFrom(InputStream& in) noexcept {
+    try {
+        readObjectLE(in, *this);
+    } catch (...) {
+        return ReadSaveResult::IO_ERROR;
+    }
+
+    if (!validateFileId())
+        return ReadSaveResult::BAD_FILE_ID;
+
+    if (!validateVersion())
+        return ReadSaveResult::BAD_VERSION;
+
+    return ReadSaveResult::OK;
+}
+
 bool SaveFileHdr::validateFileId() const noexcept {
     return ((fileId1 == SAVE_FILE_ID1) && (fileId2 == SAVE_FILE_ID2));
 }
 
 bool SaveFileHdr::validateVersion() const noexcept {
-    return (version == SAVE_FILE_VERSION);
+    return ((version >= SAVE_FILE_MIN_VERSION) && (version <= SAVE_FILE_VERSION));
 }
 
 bool SaveFileHdr::validateMapNum() const noexcept {
@@ -1484,26 +1505,117 @@ bool SaveFileHdr::validate() const noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // SaveData
 //------------------------------------------------------------------------------------------------------------------------------------------
+void SavedSnapshotGlobals::serializeFromGlobals() noexcept {
+    netGame = gNetGame;
+    arrayAssign(bPlayerInGame, gbPlayerInGame);
+
+    for (int32_t i = 0; i < MAXPLAYERS; ++i) {
+        players[i].serializeFrom(gPlayers[i]);
+    }
+
+    arrayAssign(ticRemainder, gTicRemainder);
+    itemRespawnQueueHead = gItemRespawnQueueHead;
+    itemRespawnQueueTail = gItemRespawnQueueTail;
+    arrayAssign(itemRespawnTime, gItemRespawnTime);
+    arrayAssign(itemRespawnQueue, gItemRespawnQueue);
+    deadPlayerRemovalQueueIdx = gDeadPlayerRemovalQueueIdx;
+
+    for (uint32_t i = 0; i < MAX_DEAD_PLAYERS; ++i) {
+        deadPlayerMobjRemovalQueue[i] = getMobjIndex(gDeadPlayerMobjRemovalQueue[i]);
+    }
+
+    arrayAssign(flashCards, gFlashCards);
+}
+
+void SavedSnapshotGlobals::deserializeToGlobals() const noexcept {
+    // Note: this is expected to be done after 'SavedGlobals::deserializeToGlobals', overriding its defaults for the single player case
+    gNetGame = netGame;
+    arrayAssign(gbPlayerInGame, bPlayerInGame);
+
+    for (int32_t i = 0; i < MAXPLAYERS; ++i) {
+        players[i].deserializeTo(gPlayers[i], (!bPlayerInGame[i]));
+    }
+
+    arrayAssign(gTicRemainder, ticRemainder);
+    gItemRespawnQueueHead = itemRespawnQueueHead;
+    gItemRespawnQueueTail = itemRespawnQueueTail;
+    arrayAssign(gItemRespawnTime, itemRespawnTime);
+    arrayAssign(gItemRespawnQueue, itemRespawnQueue);
+    gDeadPlayerRemovalQueueIdx = deadPlayerRemovalQueueIdx;
+
+    for (uint32_t i = 0; i < MAX_DEAD_PLAYERS; ++i) {
+        gDeadPlayerMobjRemovalQueue[i] = getMobjAtIdx(deadPlayerMobjRemovalQueue[i]);
+    }
+
+    arrayAssign(gFlashCards, flashCards);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: writes everything in the save data following the header (the body) to the specified stream in little endian format
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void writeSaveBodyLE(OutputStream& out, const SaveData& saveData) THROWS {
+    const SaveFileHdr& hdr = saveData.hdr;
+    writeObjectLE(out, saveData.globals);
+    writeArrayLE(out, saveData.sectors.get(), hdr.numSectors);
+    writeArrayLE(out, saveData.lines.get(), hdr.numLines);
+    writeArrayLE(out, saveData.sides.get(), hdr.numSides);
+    writeArrayLE(out, saveData.mobjs.get(), hdr.numMobjs);
+    writeArrayLE(out, saveData.vlDoors.get(), hdr.numVlDoors);
+    writeArrayLE(out, saveData.vlCustomDoors.get(), hdr.numVlCustomDoors);
+    writeArrayLE(out, saveData.floorMovers.get(), hdr.numFloorMovers);
+    writeArrayLE(out, saveData.ceilings.get(), hdr.numCeilings);
+    writeArrayLE(out, saveData.plats.get(), hdr.numPlats);
+    writeArrayLE(out, saveData.fireFlickers.get(), hdr.numFireFlickers);
+    writeArrayLE(out, saveData.lightFlashes.get(), hdr.numLightFlashes);
+    writeArrayLE(out, saveData.strobes.get(), hdr.numStrobes);
+    writeArrayLE(out, saveData.glows.get(), hdr.numGlows);
+    writeArrayLE(out, saveData.delayedExits.get(), hdr.numDelayedExits);
+    writeArrayLE(out, saveData.buttons.get(), hdr.numButtons);
+    writeArrayLE(out, saveData.scheduledActions.get(), hdr.numScheduledActions);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: reads everything in the save data following the header (the body) from the specified stream.
+// The data in the stream is assumed to be little endian.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void readSaveBodyLE(InputStream& in, SaveData& saveData) THROWS {
+    const SaveFileHdr& hdr = saveData.hdr;
+    readObjectLE(in, saveData.globals);
+    readArrayLE(in, saveData.sectors, hdr.numSectors);
+    readArrayLE(in, saveData.lines, hdr.numLines);
+    readArrayLE(in, saveData.sides, hdr.numSides);
+    readArrayLE(in, saveData.mobjs, hdr.numMobjs);
+    readArrayLE(in, saveData.vlDoors, hdr.numVlDoors);
+    readArrayLE(in, saveData.vlCustomDoors, hdr.numVlCustomDoors);
+    readArrayLE(in, saveData.floorMovers, hdr.numFloorMovers);
+    readArrayLE(in, saveData.ceilings, hdr.numCeilings);
+    readArrayLE(in, saveData.plats, hdr.numPlats);
+    readArrayLE(in, saveData.fireFlickers, hdr.numFireFlickers);
+    readArrayLE(in, saveData.lightFlashes, hdr.numLightFlashes);
+    readArrayLE(in, saveData.strobes, hdr.numStrobes);
+    readArrayLE(in, saveData.glows, hdr.numGlows);
+    readArrayLE(in, saveData.delayedExits, hdr.numDelayedExits);
+    readArrayLE(in, saveData.buttons, hdr.numButtons);
+    readArrayLE(in, saveData.scheduledActions, hdr.numScheduledActions);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes the save data to the specified stream.
+// The header is written uncompressed so it can be quickly read for the save menus, but the body following it is compressed.
+// The compressed body is preceded by its decompressed size and compressed size (both 32-bit little endian values).
+//------------------------------------------------------------------------------------------------------------------------------------------
 bool SaveData::writeTo(OutputStream& out) const noexcept {
     try {
+        ByteVecOutputStream body;
+        writeSaveBodyLE(body, *this);
+
+        std::vector<std::byte> compressedBody;
+        SaveDelta::encode(nullptr, 0, body.getBytes().data(), body.getBytes().size(), compressedBody);
+
         writeObjectLE(out, hdr);
-        writeObjectLE(out, globals);
-        writeArrayLE(out, sectors.get(), hdr.numSectors);
-        writeArrayLE(out, lines.get(), hdr.numLines);
-        writeArrayLE(out, sides.get(), hdr.numSides);
-        writeArrayLE(out, mobjs.get(), hdr.numMobjs);
-        writeArrayLE(out, vlDoors.get(), hdr.numVlDoors);
-        writeArrayLE(out, vlCustomDoors.get(), hdr.numVlCustomDoors);
-        writeArrayLE(out, floorMovers.get(), hdr.numFloorMovers);
-        writeArrayLE(out, ceilings.get(), hdr.numCeilings);
-        writeArrayLE(out, plats.get(), hdr.numPlats);
-        writeArrayLE(out, fireFlickers.get(), hdr.numFireFlickers);
-        writeArrayLE(out, lightFlashes.get(), hdr.numLightFlashes);
-        writeArrayLE(out, strobes.get(), hdr.numStrobes);
-        writeArrayLE(out, glows.get(), hdr.numGlows);
-        writeArrayLE(out, delayedExits.get(), hdr.numDelayedExits);
-        writeArrayLE(out, buttons.get(), hdr.numButtons);
-        writeArrayLE(out, scheduledActions.get(), hdr.numScheduledActions);
+        out.write(Endian::hostToLittle((uint32_t) body.getBytes().size()));
+        out.write(Endian::hostToLittle((uint32_t) compressedBody.size()));
+        out.writeArray(compressedBody.data(), compressedBody.size());
         return true;
     }
     catch (...) {
@@ -1511,38 +1623,43 @@ bool SaveData::writeTo(OutputStream& out) const noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the save data from the specified stream, decompressing it if required (for version 4 onwards)
+//------------------------------------------------------------------------------------------------------------------------------------------
 ReadSaveResult SaveData::readFrom(InputStream& in) noexcept {
     try {
         // Read the header first and do basic validity checks
-        readObjectLE(in, hdr);
-
-        if (!hdr.validateFileId())
-            return ReadSaveResult::BAD_FILE_ID;
+        const ReadSaveResult hdrResult = hdr.readFrom(in);
 
-        if (!hdr.validateVersion())
-            return ReadSaveResult::BAD_VERSION;
+        if (hdrResult != ReadSaveResult::OK)
+            return hdrResult;
 
         if (!hdr.validateMapNum())
             return ReadSaveResult::BAD_MAP_NUM;
 
-        // Read the globals and everything else
-        readObjectLE(in, globals);
-        readArrayLE(in, sectors, hdr.numSectors);
-        readArrayLE(in, lines, hdr.numLines);
-        readArrayLE(in, sides, hdr.numSides);
-        readArrayLE(in, mobjs, hdr.numMobjs);
-        readArrayLE(in, vlDoors, hdr.numVlDoors);
-        readArrayLE(in, vlCustomDoors, hdr.numVlCustomDoors);
-        readArrayLE(in, floorMovers, hdr.numFloorMovers);
-        readArrayLE(in, ceilings, hdr.numCeilings);
-        readArrayLE(in, plats, hdr.numPlats);
-        readArrayLE(in, fireFlickers, hdr.numFireFlickers);
-        readArrayLE(in, lightFlashes, hdr.numLightFlashes);
-        readArrayLE(in, strobes, hdr.numStrobes);
-        readArrayLE(in, glows, hdr.numGlows);
-        readArrayLE(in, delayedExits, hdr.numDelayedExits);
-        readArrayLE(in, buttons, hdr.numButtons);
-        readArrayLE(in, scheduledActions, hdr.numScheduledActions);
+        // Version 3 saves are not compressed: read the globals and everything else directly
+        if (hdr.version < 4) {
+            readSaveBodyLE(in, *this);
+            return ReadSaveResult::OK;
+        }
+
+        // Otherwise read and decompress the body first
+        const uint32_t bodySize = Endian::littleToHost(in.read<uint32_t>());
+        const uint32_t compressedBodySize = Endian::littleToHost(in.read<uint32_t>());
+
+        if ((bodySize > MAX_SAVE_BODY_SIZE) || (compressedBodySize > MAX_SAVE_BODY_SIZE))
+            return ReadSaveResult::IO_ERROR;
+
+        std::vector<std::byte> compressedBody(compressedBodySize);
+        in.readArray(compressedBody.data(), compressedBodySize);
+
+        std::vector<std::byte> body(bodySize);
+
+        if (!SaveDelta::decode(nullptr, 0, compressedBody.data(), compressedBodySize, body.data(), bodySize))
+            return ReadSaveResult::IO_ERROR;
+
+        ByteInputStream bodyIn(body.data(), body.size());
+        readSaveBodyLE(bodyIn, *this);
         return ReadSaveResult::OK;
     }
     catch (...) {
@@ -1,7 +1,11 @@
 #pragma once
 
 #include "Doom/doomdef.h"
+#include "Doom/Game/doomdata.h"
 #include "Doom/Game/p_doors.h"
+#include "Doom/Game/p_inter.h"
+#include "Doom/Game/p_mobj.h"
+#include "Doom/UI/st_main.h"
 #include "SmallString.h"
 
 #include <memory>
@@ -35,8 +39,12 @@ namespace ScriptingEngine {
     struct ScheduledAction;
 }
 
-// The current save file format version
-static constexpr uint32_t SAVE_FILE_VERSION = 3;
+// The current save file format version.
+// Version 4 compresses everything after the save file header using 'SaveDelta', otherwise it is identical to version 3.
+static constexpr uint32_t SAVE_FILE_VERSION = 4;
+
+// The oldest save file format version which can still be read
+static constexpr uint32_t SAVE_FILE_MIN_VERSION = 3;
 
 // The expected file ids in little endian format (says 'PSYDSAVF' at the top of the file)
 static constexpr uint32_t SAVE_FILE_ID1 = 0x44595350;
@@ -408,7 +416,7 @@ struct SavedButtonT {
 static_assert(sizeof(SavedButtonT) == 16);
 
 // Saved state for a scheduled script action.
-// This is presently identical to the runtime struct but we keep the types separate in case they need to differ.
+// This is the same as the runtime struct minus the scheduler bookkeeping, which is rebuilt after loading.
 struct SavedScheduledAction {
     int32_t     actionNum;              // Which action function to execute with
     int32_t     delayTics;              // Game tics left until the action executes
@@ -484,11 +492,31 @@ struct SavedGlobals {
 
 static_assert(sizeof(SavedGlobals) == 384);
 
+// Extra globals saved for in-memory snapshots of the game, on top of 'SavedGlobals'.
+// Unlike save files, snapshots support multiplayer so this holds the state for all players and other multiplayer only state.
+// Snapshots are never written to disk so this is always in host endian format and no byte swapping is required.
+struct SavedSnapshotGlobals {
+    gametype_t          netGame;                                        // The type of game being played
+    bool                bPlayerInGame[MAXPLAYERS];                      // Which players are in the game
+    SavedPlayerT        players[MAXPLAYERS];                            // State for all players
+    int32_t             ticRemainder[MAXPLAYERS];                       // How many unsimulated player sprite vblanks there are for each player
+    int32_t             itemRespawnQueueHead;                           // Deathmatch item respawn queue: head index
+    int32_t             itemRespawnQueueTail;                           // Deathmatch item respawn queue: tail index
+    int32_t             itemRespawnTime[ITEMQUESIZE];                   // Deathmatch item respawn queue: when each item was picked up
+    mapthing_t          itemRespawnQueue[ITEMQUESIZE];                  // Deathmatch item respawn queue: the things to respawn
+    uint32_t            deadPlayerRemovalQueueIdx;                      // Next slot to use in the dead player body removal queue
+    int32_t             deadPlayerMobjRemovalQueue[MAX_DEAD_PLAYERS];   // Dead player bodies to remove (map object indexes)
+    sbflash_t           flashCards[NUMCARDS];                           // Status bar keycard flashes
+
+    void serializeFromGlobals() noexcept;
+    void deserializeToGlobals() const noexcept;
+};
+
 // Header for a save file, comes first in the file
 struct SaveFileHdr {
     uint32_t    fileId1;                // Should match 'SAVE_FILE_ID1'
     uint32_t    fileId2;                // Should match 'SAVE_FILE_ID2'
-    uint32_t    version;                // Should match 'SAVE_FILE_VERSION'
+    uint32_t    version;                // Should be between 'SAVE_FILE_MIN_VERSION' and 'SAVE_FILE_VERSION'
     int32_t     mapNum;                 // Map number
     int64_t     secondsPlayed;          // Number of seconds the player has been playing the map
     String32    mapName;                // Name of the map
@@ -512,6 +540,7 @@ struct SaveFileHdr {
     uint32_t    numScheduledActions;    // Number of 'SavedScheduledAction' in the save file
 
     void byteSwap() noexcept;
+    [[nodiscard]] ReadSaveResult readFrom(InputStream& in) noexcept;
     bool validateFileId() const noexcept;
     bool validateVersion() const noexcept;
     bool validateMapNum() const noexcept;
@@ -0,0 +1,223 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A simple and fast delta codec for save data and in-memory snapshots of the game.
+//
+// The data being encoded is XORed against a reference (such as an earlier snapshot), so bytes which have not changed become zero.
+// The reference may be smaller than the data being encoded, in which case the data past the end of the reference is XORed against zero.
+// Encoding with no reference at all therefore simply compresses the data, which works well for save data since it contains lots of zeros.
+//
+// The XORed data is then stored as a series of tokens, each one consisting of:
+//
+//  (1) The number of zero bytes in the XORed data, stored as a variable length integer (7 bits per byte, LSB first).
+//  (2) The number of literal (non zero run) bytes which follow, stored as a variable length integer.
+//  (3) The literal bytes themselves, still XORed against the reference.
+//
+// Small runs of zeros inside the literal bytes are left as is, since splitting the literal bytes there would not save any space.
+// Snapshots taken close together are almost identical, so the XORed data mostly consists of long zero runs which this handles well.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "SaveDelta.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+BEGIN_NAMESPACE(SaveDelta)
+
+// The minimum number of zero bytes needed to end a run of literal bytes and start a new token.
+// Shorter runs of zeros are stored as literals since the token overhead would make it not worthwhile to split the literal bytes there.
+static constexpr size_t MIN_ZERO_RUN_LEN = 8;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the delta (XORed) byte at the specified index in the data being encoded
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline std::byte getDeltaByte(
+    const std::byte* const pRef,
+    const size_t refSize,
+    const std::byte* const pSrc,
+    const size_t byteIdx
+) noexcept {
+    return (byteIdx < refSize) ? pSrc[byteIdx] ^ pRef[byteIdx] : pSrc[byteIdx];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Counts the number of consecutive zero bytes in the delta (XORed) data, starting at the specified index.
+// Checks 8 bytes at a time where possible, since most of the data for a delta is expected to be zero.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static size_t countZeroDeltaBytes(
+    const std::byte* const pRef,
+    const size_t refSize,
+    const std::byte* const pSrc,
+    const size_t srcSize,
+    const size_t startIdx
+) noexcept {
+    size_t byteIdx = startIdx;
+
+    while (byteIdx + sizeof(uint64_t) <= srcSize) {
+        uint64_t srcWord = {};
+        std::memcpy(&srcWord, pSrc + byteIdx, sizeof(uint64_t));
+
+        if (byteIdx + sizeof(uint64_t) <= refSize) {
+            uint64_t refWord = {};
+            std::memcpy(&refWord, pRef + byteIdx, sizeof(uint64_t));
+            srcWord ^= refWord;
+        } else if (byteIdx < refSize) {
+            break;      // Straddling the end of the reference: finish up byte by byte
+        }
+
+        if (srcWord != 0)
+            break;
+
+        byteIdx += sizeof(uint64_t);
+    }
+
+    while ((byteIdx < srcSize) && (getDeltaByte(pRef, refSize, pSrc, byteIdx) == std::byte(0))) {
+        ++byteIdx;
+    }
+
+    return byteIdx - startIdx;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Appends a variable length integer to the given output
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void writeVarInt(std::vector<std::byte>& out, size_t value) noexcept {
+    while (value >= 0x80) {
+        out.push_back(std::byte((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+
+    out.push_back(std::byte(value));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads a variable length integer from the encoded data and advances the read index.
+// Returns 'false' if the encoded data ends before the integer does or if the integer is too big.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool readVarInt(const std::byte* const pEnc, const size_t encSize, size_t& encIdx, size_t& valueOut) noexcept {
+    size_t value = 0;
+
+    for (uint32_t shift = 0; shift < sizeof(size_t) * 8; shift += 7) {
+        if (encIdx >= encSize)
+            return false;
+
+        const uint8_t encByte = (uint8_t) pEnc[encIdx++];
+        value |= (size_t)(encByte & 0x7F) << shift;
+
+        if ((encByte & 0x80) == 0) {
+            valueOut = value;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Encodes the specified data as a delta against the given reference data and saves the result to the given output vector.
+// The reference data may be null or smaller than the data being encoded: in that case the extra data is effectively just compressed.
+// The output vector is cleared first but its memory is reused, so repeated encodes into the same vector need not allocate.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void encode(
+    const std::byte* const pRef,
+    const size_t refSize,
+    const std::byte* const pSrc,
+    const size_t srcSize,
+    std::vector<std::byte>& out
+) noexcept {
+    const size_t usedRefSize = (pRef) ? refSize : 0;
+    out.clear();
+
+    for (size_t byteIdx = 0; byteIdx < srcSize;) {
+        // How many unchanged bytes are there?
+        const size_t zeroRunLen = countZeroDeltaBytes(pRef, usedRefSize, pSrc, srcSize, byteIdx);
+        byteIdx += zeroRunLen;
+
+        // Figure out where the literal bytes end: at the next long enough run of zeros or the end of the data
+        size_t literalEndIdx = byteIdx;
+
+        while (literalEndIdx < srcSize) {
+            if (getDeltaByte(pRef, usedRefSize, pSrc, literalEndIdx) != std::byte(0)) {
+                ++literalEndIdx;
+                continue;
+            }
+
+            const size_t numZeros = countZeroDeltaBytes(pRef, usedRefSize, pSrc, srcSize, literalEndIdx);
+
+            if ((numZeros >= MIN_ZERO_RUN_LEN) || (literalEndIdx + numZeros >= srcSize))
+                break;
+
+            literalEndIdx += numZeros;
+        }
+
+        // Write the token and the literal bytes
+        const size_t literalLen = literalEndIdx - byteIdx;
+        writeVarInt(out, zeroRunLen);
+        writeVarInt(out, literalLen);
+
+        const size_t literalsOffset = out.size();
+        out.resize(literalsOffset + literalLen);
+        std::byte* const pLiterals = out.data() + literalsOffset;
+
+        for (size_t i = 0; i < literalLen; ++i) {
+            pLiterals[i] = getDeltaByte(pRef, usedRefSize, pSrc, byteIdx + i);
+        }
+
+        byteIdx = literalEndIdx;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes data previously encoded with 'encode' against the same reference data, saving the result to the given output.
+// The size of the output must be exactly the size of the data that was originally encoded and it must not overlap the reference.
+// Returns 'false' if the encoded data is not valid.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool decode(
+    const std::byte* const pRef,
+    const size_t refSize,
+    const std::byte* const pEnc,
+    const size_t encSize,
+    std::byte* const pDst,
+    const size_t dstSize
+) noexcept {
+    const size_t usedRefSize = (pRef) ? refSize : 0;
+    size_t encIdx = 0;
+    size_t dstIdx = 0;
+
+    while (dstIdx < dstSize) {
+        // Read the next token and validate it
+        size_t zeroRunLen = 0;
+        size_t literalLen = 0;
+
+        if ((!readVarInt(pEnc, encSize, encIdx, zeroRunLen)) || (!readVarInt(pEnc, encSize, encIdx, literalLen)))
+            return false;
+
+        if ((zeroRunLen == 0) && (literalLen == 0))
+            return false;
+
+        if ((zeroRunLen > dstSize - dstIdx) || (literalLen > dstSize - dstIdx - zeroRunLen) || (literalLen > encSize - encIdx))
+            return false;
+
+        // Unchanged bytes: copy from the reference, or zero fill past the end of it
+        const size_t numRefBytes = (dstIdx < usedRefSize) ? std::min(zeroRunLen, usedRefSize - dstIdx) : 0;
+
+        if (numRefBytes > 0) {
+            std::memcpy(pDst + dstIdx, pRef + dstIdx, numRefBytes);
+        }
+
+        std::memset(pDst + dstIdx + numRefBytes, 0, zeroRunLen - numRefBytes);
+        dstIdx += zeroRunLen;
+
+        // Literal bytes: undo the XOR against the reference
+        for (size_t i = 0; i < literalLen; ++i) {
+            const size_t byteIdx = dstIdx + i;
+            const std::byte refByte = (byteIdx < usedRefSize) ? pRef[byteIdx] : std::byte(0);
+            pDst[byteIdx] = pEnc[encIdx + i] ^ refByte;
+        }
+
+        dstIdx += literalLen;
+        encIdx += literalLen;
+    }
+
+    return (encIdx == encSize);
+}
+
+END_NAMESPACE(SaveDelta)
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstddef>
+#include <vector>
+
+BEGIN_NAMESPACE(SaveDelta)
+
+void encode(
+    const std::byte* const pRef,
+    const size_t refSize,
+    const std::byte* const pSrc,
+    const size_t srcSize,
+    std::vector<std::byte>& out
+) noexcept;
+
+bool decode(
+    const std::byte* const pRef,
+    const size_t refSize,
+    const std::byte* const pEnc,
+    const size_t encSize,
+    std::byte* const pDst,
+    const size_t dstSize
+) noexcept;
+
+END_NAMESPACE(SaveDelta)
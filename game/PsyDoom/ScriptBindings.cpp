@@ -34,10 +34,18 @@
 #include <algorithm>
 #include <cstdio>
 #include <optional>
+#include <utility>
+#include <vector>
 #include <sol/sol.hpp>
 
 BEGIN_NAMESPACE(ScriptBindings)
 
+// Indexes of all lines in the level, sorted by tag and then by index.
+// This is used to find lines with a given tag without searching through all of them, and is rebuilt when line tags have changed.
+// Note: the engine itself keeps a similar index for sectors.
+static std::vector<int32_t>     gLinesByTag;
+static bool                     gbLineTagIndexDirty = true;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Helper: makes a lua type's table readonly as much as possible
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -48,6 +56,61 @@ static void makeTypeReadOnly(sol::usertype<T>& typeTable) noexcept {
     };
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: finds the range of line indexes with the given tag, rebuilding the index of lines by tag first if required.
+// The indexes in the range are in ascending order.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::pair<const int32_t*, const int32_t*> findLinesWithTag(const int32_t tag) noexcept {
+    const line_t* const pLines = gpLines;
+    const int32_t numLines = gNumLines;
+
+    if (gbLineTagIndexDirty) {
+        gLinesByTag.resize((size_t) numLines);
+
+        for (int32_t i = 0; i < numLines; ++i) {
+            gLinesByTag[i] = i;
+        }
+
+        std::sort(gLinesByTag.begin(), gLinesByTag.end(), [=](const int32_t i1, const int32_t i2) noexcept {
+            const int32_t tag1 = pLines[i1].tag;
+            const int32_t tag2 = pLines[i2].tag;
+            return (tag1 != tag2) ? (tag1 < tag2) : (i1 < i2);
+        });
+
+        gbLineTagIndexDirty = false;
+    }
+
+    const int32_t* const pBeg = gLinesByTag.data();
+    const int32_t* const pEnd = pBeg + gLinesByTag.size();
+
+    const int32_t* const pRangeBeg = std::lower_bound(pBeg, pEnd, tag, [=](const int32_t lineIdx, const int32_t value) noexcept {
+        return (pLines[lineIdx].tag < value);
+    });
+
+    const int32_t* const pRangeEnd = std::upper_bound(pRangeBeg, pEnd, tag, [=](const int32_t value, const int32_t lineIdx) noexcept {
+        return (value < pLines[lineIdx].tag);
+    });
+
+    return { pRangeBeg, pRangeEnd };
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: gets a table to return the results of a bulk query in.
+// Reuses the table given by the script if there is one, clearing out any existing elements in it. Otherwise a new table is created.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static sol::table getQueryResultTable(const sol::this_state L, const sol::object& tableObj) noexcept {
+    if (tableObj.get_type() != sol::type::table)
+        return sol::table(L, sol::create);
+
+    sol::table table = tableObj.as<sol::table>();
+
+    for (size_t i = table.size(); i >= 1; --i) {
+        table.raw_set(i, sol::lua_nil);
+    }
+
+    return table;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Helper: visits sectors surrounding a specified sector, invoking the specified lambda on each one
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -303,17 +366,24 @@ static sector_t* GetSector(const int32_t index) noexcept {
 }
 
 static sector_t* FindSectorWithTag(const int32_t tag) noexcept {
-    const int32_t numSectors = gNumSectors;
-    sector_t* const pSectors = gpSectors;
+    const int32_t* pBeg = nullptr;
+    const int32_t* pEnd = nullptr;
+    P_GetSectorsWithTag(tag, pBeg, pEnd);
+    return (pBeg != pEnd) ? gpSectors + *pBeg : nullptr;
+}
 
-    for (int32_t i = 0; i < numSectors; ++i) {
-        sector_t& sector = pSectors[i];
+static sol::table FindSectorsWithTag(const int32_t tag, const sol::object tableObj, const sol::this_state L) noexcept {
+    sol::table result = getQueryResultTable(L, tableObj);
+    const int32_t* pBeg = nullptr;
+    const int32_t* pEnd = nullptr;
+    P_GetSectorsWithTag(tag, pBeg, pEnd);
+    int32_t numResults = 0;
 
-        if (sector.tag == tag)
-            return &sector;
+    for (const int32_t* pIdx = pBeg; pIdx < pEnd; ++pIdx) {
+        result.raw_set(++numResults, gpSectors + *pIdx);
     }
 
-    return nullptr;
+    return result;
 }
 
 static void ForEachSector(const std::function<void (sector_t& sector)>& callback) noexcept {
@@ -450,17 +520,20 @@ static line_t* GetLine(const int32_t index) noexcept {
 }
 
 static line_t* FindLineWithTag(const int32_t tag) noexcept {
-    const int32_t numLines = gNumLines;
-    line_t* const pLines = gpLines;
+    const auto [pBeg, pEnd] = findLinesWithTag(tag);
+    return (pBeg != pEnd) ? gpLines + *pBeg : nullptr;
+}
 
-    for (int32_t i = 0; i < numLines; ++i) {
-        line_t& line = pLines[i];
+static sol::table FindLinesWithTag(const int32_t tag, const sol::object tableObj, const sol::this_state L) noexcept {
+    sol::table result = getQueryResultTable(L, tableObj);
+    const auto [pBeg, pEnd] = findLinesWithTag(tag);
+    int32_t numResults = 0;
 
-        if (line.tag == tag)
-            return &line;
+    for (const int32_t* pIdx = pBeg; pIdx < pEnd; ++pIdx) {
+        result.raw_set(++numResults, gpLines + *pIdx);
     }
 
-    return nullptr;
+    return result;
 }
 
 static void ForEachLine(const std::function<void (line_t& line)>& callback) noexcept {
@@ -544,6 +617,21 @@ static void ForEachMobj(const std::function<void (mobj_t& mo)>& callback) noexce
     }
 }
 
+static void ForEachMobjOfType(const int32_t mobjType, const std::function<void (mobj_t& mo)>& callback) noexcept {
+    if ((!callback) || (mobjType < 0) || (mobjType >= gNumMobjInfo))
+        return;
+
+    for (mobj_t* pMobj = P_GetFirstMobjOfType((mobjtype_t) mobjType); pMobj;) {
+        mobj_t* const pNextMobj = pMobj->tnext;     // Just to be a bit safer...
+        callback(*pMobj);
+        pMobj = pNextMobj;
+    }
+}
+
+static int32_t GetNumMobjsOfType(const int32_t mobjType) noexcept {
+    return ((mobjType >= 0) && (mobjType < gNumMobjInfo)) ? P_GetNumMobjsOfType((mobjtype_t) mobjType) : 0;
+}
+
 static void ForEachMobjInArea(
     const float x1,
     const float y1,
@@ -582,6 +670,53 @@ static void ForEachMobjInArea(
     }
 }
 
+static sol::table FindMobjsInRadius(
+    const float x,
+    const float y,
+    const float radius,
+    const int32_t type,
+    const sol::object tableObj,
+    const sol::this_state L
+) noexcept {
+    sol::table result = getQueryResultTable(L, tableObj);
+
+    // Figure out what cells in the blockmap we will cover
+    const fixed_t xmin = FloatToFixed(x - radius);
+    const fixed_t xmax = FloatToFixed(x + radius);
+    const fixed_t ymin = FloatToFixed(y - radius);
+    const fixed_t ymax = FloatToFixed(y + radius);
+
+    const int32_t bmapW = gBlockmapWidth;
+    const int32_t bmapH = gBlockmapHeight;
+
+    const int32_t bmapTy = std::min(d_rshift<MAPBLOCKSHIFT>(ymax - gBlockmapOriginY), bmapH - 1);
+    const int32_t bmapBy = std::max(d_rshift<MAPBLOCKSHIFT>(ymin - gBlockmapOriginY), 0);
+    const int32_t bmapLx = std::max(d_rshift<MAPBLOCKSHIFT>(xmin - gBlockmapOriginX), 0);
+    const int32_t bmapRx = std::min(d_rshift<MAPBLOCKSHIFT>(xmax - gBlockmapOriginX), bmapW - 1);
+
+    // Go through all of the blockmap cells of interest, adding each thing of the wanted type (if any) whose center is within the radius
+    const float radiusSq = radius * radius;
+    int32_t numResults = 0;
+
+    for (int32_t bmapY = bmapBy; bmapY <= bmapTy; ++bmapY) {
+        for (int32_t bmapX = bmapLx; bmapX <= bmapRx; ++bmapX) {
+            for (mobj_t* pMobj = gppBlockLinks[bmapX + bmapY * bmapW]; pMobj; pMobj = pMobj->bnext) {
+                if ((type >= 0) && (pMobj->type != type))
+                    continue;
+
+                const float dx = FixedToFloat(pMobj->x) - x;
+                const float dy = FixedToFloat(pMobj->y) - y;
+
+                if (dx * dx + dy * dy <= radiusSq) {
+                    result.raw_set(++numResults, pMobj);
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
 static int32_t FindMobjTypeForDoomEdNum(const int32_t doomEdNum) noexcept {
     const int32_t numMobjTypes = gNumMobjInfo;
     const mobjinfo_t* const pMobjInfo = gMobjInfo;
@@ -636,8 +771,8 @@ void Script_P_RemoveMobj(mobj_t& mobj) noexcept {
     mobj.frame = nullState.frame;
     mobj.latecall = P_RemoveMobj;
 
-    // Tell the scripting engine that it needs to clean up some things
-    ScriptingEngine::gbNeedMobjGC = true;
+    // Tell the scripting engine that it needs to clean up this thing
+    ScriptingEngine::queueMobjRemoval(mobj);
 }
 
 bool Script_EV_TeleportTo(
@@ -776,6 +911,7 @@ void S_PlaySoundAtPosition(const float x, const float y, const uint32_t soundId)
         [](const TypeName& obj) noexcept { return obj.FieldName; },\
         [](TypeName& obj, const fixed_t value) noexcept {\
             obj.FieldName = value;\
+            gSectorGeometryEpoch++;\
             \
             if (!Config::gbInterpolateSectors) {\
                 obj.FieldName.snap();\
@@ -789,6 +925,7 @@ void S_PlaySoundAtPosition(const float x, const float y, const uint32_t soundId)
         [](const TypeName& obj) noexcept { return FixedToFloat(obj.FieldName); },\
         [](TypeName& obj, const float value) noexcept {\
             obj.FieldName = FloatToFixed(value);\
+            gSectorGeometryEpoch++;\
             \
             if (!Config::gbInterpolateSectors) {\
                 obj.FieldName.snap();\
@@ -812,7 +949,10 @@ static void registerType_sector_t(sol::state& lua) noexcept {
     type["colorid"] = SOL_BYTE_PROPERTY(sector_t, colorid);
     type["lightlevel"] = SOL_BYTE_PROPERTY(sector_t, lightlevel);
     type["special"] = &sector_t::special;
-    type["tag"] = &sector_t::tag;
+    type["tag"] = sol::property(
+        [](const sector_t& sector) noexcept { return sector.tag; },
+        [](sector_t& sector, const int32_t tag) noexcept { sector.tag = tag; P_InvalidateSectorTagIndex(); }
+    );
     type["flags"] = &sector_t::flags;
     type["ceil_colorid"] = SOL_BYTE_PROPERTY(sector_t, ceilColorid);
     type["floor_tex_offset_x"] = SOL_LERPED_SECTOR_FIXED_PROPERTY_AS_FLOAT(sector_t, floorTexOffsetX);
@@ -853,8 +993,14 @@ static void registerType_line_t(sol::state& lua) noexcept {
     type["v2y"] = sol::readonly_property([](const line_t& line) noexcept { return FixedToFloat(line.vertex2->y); });
     type["angle"] = sol::readonly_property([](const line_t& line) noexcept { return AngleToDegrees((angle_t) line.fineangle << ANGLETOFINESHIFT); });
     type["flags"] = &line_t::flags;
-    type["special"] = &line_t::special;
-    type["tag"] = &line_t::tag;
+    type["special"] = sol::property(
+        [](const line_t& line) noexcept { return line.special; },
+        [](line_t& line, const int32_t special) noexcept { line.special = special; P_InvalidateSpecialLineBlockmap(); }
+    );
+    type["tag"] = sol::property(
+        [](const line_t& line) noexcept { return line.tag; },
+        [](line_t& line, const int32_t tag) noexcept { line.tag = tag; gbLineTagIndexDirty = true; }
+    );
     type["frontside"] = sol::readonly_property([](const line_t& line) noexcept { return GetSide(line.sidenum[0]); });
     type["backside"] = sol::readonly_property([](const line_t& line) noexcept { return GetSide(line.sidenum[1]); });
     type["frontsector"] = sol::readonly(&line_t::frontsector);
@@ -1064,6 +1210,7 @@ static void registerLuaFunctions(sol::state& lua) noexcept {
     lua["GetNumSectors"] = GetNumSectors;
     lua["GetSector"] = GetSector;
     lua["FindSectorWithTag"] = FindSectorWithTag;
+    lua["FindSectorsWithTag"] = FindSectorsWithTag;
     lua["ForEachSector"] = ForEachSector;
     lua["ForEachSectorWithTag"] = ForEachSectorWithTag;
     lua["SectorAtPosition"] = SectorAtPosition;
@@ -1071,6 +1218,7 @@ static void registerLuaFunctions(sol::state& lua) noexcept {
     lua["GetNumLines"] = GetNumLines;
     lua["GetLine"] = GetLine;
     lua["FindLineWithTag"] = FindLineWithTag;
+    lua["FindLinesWithTag"] = FindLinesWithTag;
     lua["ForEachLine"] = ForEachLine;
     lua["ForEachLineWithTag"] = ForEachLineWithTag;
     lua["P_PointOnLineSide"] = Script_P_PointOnLineSide;
@@ -1088,7 +1236,10 @@ static void registerLuaFunctions(sol::state& lua) noexcept {
     lua["ForEachSide"] = ForEachSide;
 
     lua["ForEachMobj"] = ForEachMobj;
+    lua["ForEachMobjOfType"] = ForEachMobjOfType;
+    lua["GetNumMobjsOfType"] = GetNumMobjsOfType;
     lua["ForEachMobjInArea"] = ForEachMobjInArea;
+    lua["FindMobjsInRadius"] = FindMobjsInRadius;
     lua["FindMobjTypeForDoomEdNum"] = FindMobjTypeForDoomEdNum;
     lua["P_SpawnMobj"] = Script_P_SpawnMobj;
     lua["P_SpawnMissile"] = Script_P_SpawnMissile;
@@ -1454,9 +1605,18 @@ static void registerLuaConstants(sol::state& lua) noexcept {
 // Registers all Lua scripting bindings: types, functions and constants
 //------------------------------------------------------------------------------------------------------------------------------------------
 void registerAll(sol::state& lua) noexcept {
+    gbLineTagIndexDirty = true;
     registerLuaTypes(lua);
     registerLuaFunctions(lua);
     registerLuaConstants(lua);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Marks the index of lines by tag as needing to be rebuilt.
+// Must be called if line tags are changed outside of scripts, such as when loading a save.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void invalidateLineTagIndex() noexcept {
+    gbLineTagIndexDirty = true;
+}
+
 END_NAMESPACE(ScriptBindings)
@@ -9,5 +9,6 @@ namespace sol {
 BEGIN_NAMESPACE(ScriptBindings)
 
 void registerAll(sol::state& lua) noexcept;
+void invalidateLineTagIndex() noexcept;
 
 END_NAMESPACE(ScriptBindings)
@@ -1,6 +1,10 @@
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Manages the Lua scripting engine that new PsyDoom levels can use to execute more advanced line actions with.
 // The scripting capabilities are limited, and just extend to offering a little more control like 'Macros' in the original Doom 64 engine.
+//
+// Time spent executing each action number is recorded, as is time spent on garbage collection and the total time spent in scripts per tick.
+// An optional per-tick time budget (see the '-scriptbudget' argument) can also be set, which warns when scripts take too long in a tick.
+// Note: Lua's own incremental garbage collection runs during script execution and is counted as part of the time for the action.
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "ScriptingEngine.h"
 
@@ -10,17 +14,34 @@
 #include "Doom/Game/p_tick.h"
 #include "Doom/UI/st_main.h"
 #include "MapHash.h"
+#include "Profiler.h"
+#include "ProgArgs.h"
 #include "ScriptBindings.h"
 
+#include <algorithm>
+#include <chrono>
 #include <cstdio>
+#include <functional>
+#include <map>
 #include <memory>
+#include <queue>
 #include <sol/sol.hpp>
+#include <string>
+#include <string_view>
 
 BEGIN_NAMESPACE(ScriptingEngine)
 
+typedef std::chrono::steady_clock Clock;
+
 // The main Lua VM, managed and wrapped by the 'Sol2' library
 static std::unique_ptr<sol::state> gpLuaState;
 
+// The compiled bytecode for the most recently loaded map script, along with the source it was compiled from and a hash of that source.
+// Restarting the same level (after dying for example) reuses the bytecode instead of compiling the script again.
+static std::string      gCachedScriptSource;
+static size_t           gCachedScriptHash;
+static sol::bytecode    gCachedScriptBytecode;
+
 // A table of actions registered with the scripting engine.
 // Each action has an integer identifier associated with it that is referenced by line tags.
 static std::unordered_map<int32_t, sol::protected_function> gScriptActions;
@@ -33,6 +54,38 @@ static int32_t gNumExecutingScripts = 0;
 // This is so we preserve the relative order of actions scheduled to occur on the same tic - they should happen in the same order they were scheduled in.
 std::vector<ScheduledAction> gScheduledActions;
 
+// The scheduled actions list is indexed by a hierarchical timer wheel so that only actions which are due have to be visited each tick.
+// Each level of the wheel has 64 slots and each slot on a level spans 64x as many ticks as a slot on the level below it.
+// Actions due on the current tick are always found in slot 'tick % 64' of level 0; buckets on higher levels are cascaded down into the
+// lower levels as the time for them comes around. Actions due too far in the future for the wheel to represent go in an overflow list.
+//
+// Wheel entries are not removed when an action is stopped, paused or rescheduled. Instead the action's 'armId' is changed, which makes
+// any existing entries for it stale; these are simply discarded when they are encountered.
+static constexpr uint32_t TIMER_WHEEL_SLOT_BITS = 6;
+static constexpr uint32_t TIMER_WHEEL_NUM_SLOTS = 1u << TIMER_WHEEL_SLOT_BITS;
+static constexpr uint32_t TIMER_WHEEL_NUM_LEVELS = 4;
+
+struct TimerWheelEntry {
+    int32_t     actionIdx;      // Index of the action in the scheduled actions list
+    uint32_t    armId;          // Which scheduling of the action this entry is for: if it doesn't match the action's 'armId' then the entry is stale
+};
+
+typedef std::vector<TimerWheelEntry> TimerWheelBucket;
+
+static TimerWheelBucket     gTimerWheel[TIMER_WHEEL_NUM_LEVELS][TIMER_WHEEL_NUM_SLOTS];
+static TimerWheelBucket     gTimerWheelOverflow;
+static TimerWheelBucket     gDueActions;            // Scratch list: the actions due for the current tick, in scheduled actions list order
+static uint64_t             gSchedulerTick;         // How many times 'runScheduledActions' has been called for the level
+static uint32_t             gNextArmId;             // Used to generate a new 'armId' for an action
+
+// Free slots in the scheduled actions list, lowest index first.
+// The lowest free slot is always used for new actions, which keeps the order that actions due on the same tick execute in exactly the same as
+// it has always been. Entries for slots that have since been used or trimmed off the end of the list are discarded when they are encountered.
+static std::priority_queue<int32_t, std::vector<int32_t>, std::greater<int32_t>> gFreeActionIdxs;
+
+// The indexes of all actions which are not stopped/finished, by tag
+static std::unordered_map<int32_t, std::vector<int32_t>> gActionIdxsByTag;
+
 // Context for the current script action being executed.
 // Which linedef, sector and thing triggered the action, all of which are optional.
 // All, some or none of these might be specified depending on the context in which the script action is executed.
@@ -49,9 +102,40 @@ int32_t     gCurActionUserdata;
 // It affects the behavior of switches and whether they can change texture and make a noise or not.
 bool gbCurActionAllowed;
 
-// A flag set to true if we need to delete things after the current script has finished executing.
-// This will be triggered if scripts do a call to 'P_RemoveMobj()'.
-bool gbNeedMobjGC;
+// Things to delete after the current script has finished executing, added to when scripts do a call to 'P_RemoveMobj()'.
+// Things which the engine has scheduled a 'P_RemoveMobj' late call for are also added, since scripts have always removed those early too.
+// Entries are null if the thing was removed by other means in the meantime. Each thing records its index in this list (see 'queueMobjRemoval').
+static std::vector<mobj_t*> gPendingRemovalMobjs;
+
+// Timing statistics for the current level: total time spent in scripts per tick, and time spent on garbage collection.
+// Garbage collection here includes deleting things removed by scripts as well as explicit full collections of the Lua heap.
+ScriptTimeStats gTickTimeStats;
+ScriptTimeStats gGcTimeStats;
+
+// Timing statistics for each script action number for the current level.
+// An ordered map is used so that the report at the end of the level is sorted by action number.
+static std::map<int32_t, ScriptTimeStats> gActionTimeStats;
+
+// Time spent in scripts so far for the current tick, and the action number which took the longest to execute during the tick
+static double   gCurTickUsec;
+static double   gCurTickSlowestActionUsec;
+static int32_t  gCurTickSlowestActionNum;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds a single sample to the given timing statistics
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void addTimeSample(ScriptTimeStats& stats, const double usec) noexcept {
+    stats.numSamples++;
+    stats.totalUsec += usec;
+    stats.maxUsec = std::max(stats.maxUsec, usec);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns how many microseconds have elapsed since the given time point
+//------------------------------------------------------------------------------------------------------------------------------------------
+static double getUsecSince(const Clock::time_point startTime) noexcept {
+    return std::chrono::duration<double, std::micro>(Clock::now() - startTime).count();
+}
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Issues a user facing error message relating to scripting, which is shown on the in-game status bar.
@@ -79,14 +163,41 @@ static std::unique_ptr<char[]> readCurrentMapScript() noexcept {
     // Read the map's script into a null terminated string
     const int32_t scriptsLumpLen = W_MapLumpLength(scriptsLumpIdx);
     std::unique_ptr<char[]> mapScript(new char[scriptsLumpLen + 1]);
-    W_ReadMapLump(scriptsLumpIdx, mapScript.get(), true);
+    // Note: the script counts towards the map hash, so hash it while reading
+    W_ReadMapLumpAndHash(scriptsLumpIdx, mapScript.get());
     mapScript[scriptsLumpLen] = 0;
-
-    // The script counts towards the map hash: count it before returning
-    MapHash::addData(mapScript.get(), scriptsLumpLen);
     return mapScript;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the compiled bytecode for the given map script, compiling it if it's not the same script as the one last compiled.
+// Throws an exception if the script fails to compile.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static const sol::bytecode& getMapScriptBytecode(const char* const mapScript) noexcept(false) {
+    const std::string_view source = mapScript;
+    const size_t sourceHash = std::hash<std::string_view>()(source);
+
+    if ((!gCachedScriptBytecode.empty()) && (sourceHash == gCachedScriptHash) && (source == gCachedScriptSource))
+        return gCachedScriptBytecode;
+
+    // Compile the script: note that the chunk name is derived from the source, the same as when running the source directly
+    gCachedScriptBytecode.clear();
+    gCachedScriptSource.clear();
+
+    sol::load_result loadResult = gpLuaState->load(source);
+
+    if (!loadResult.valid()) {
+        sol::error err = loadResult;
+        throw err;
+    }
+
+    sol::protected_function scriptFunc = loadResult;
+    gCachedScriptBytecode = scriptFunc.dump();
+    gCachedScriptSource = source;
+    gCachedScriptHash = sourceHash;
+    return gCachedScriptBytecode;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Helper: makes a lua table readonly as much as possible
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -184,7 +295,9 @@ static void setupActionExecuteLuaEnv() noexcept {
     lua["SetAction"] = nullptr;
 
     // Do garbage collection at this point to clean up, scripts should only be using locals variables after this
+    const Clock::time_point gcStartTime = Clock::now();
     lua.collect_gc();
+    addTimeSample(gGcTimeStats, getUsecSince(gcStartTime));
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -192,38 +305,241 @@ static void setupActionExecuteLuaEnv() noexcept {
 // This action will be triggered by scripts calling 'P_RemoveMobj'.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void doMobjGC() noexcept {
-    if (!gbNeedMobjGC) 
+    if (gPendingRemovalMobjs.empty()) 
         return;
 
-    gbNeedMobjGC = false;
+    PROFILE_ZONE("ScriptingEngine::doMobjGC");
+    const Clock::time_point gcStartTime = Clock::now();
 
-    for (mobj_t* pMobj = gMobjHead.next; pMobj != &gMobjHead;) {
-        mobj_t* const pNextMobj = pMobj->next;
-        const latecall_t lateCall = pMobj->latecall;
+    // Delete the things in the same order as they are in the global list of things, which is the order the deletion was always done in.
+    // Note: the list order comparison allows for 'listOrder' wrapping around.
+    std::vector<mobj_t*> mobjs;
+    mobjs.swap(gPendingRemovalMobjs);
+    mobjs.erase(std::remove(mobjs.begin(), mobjs.end(), nullptr), mobjs.end());
+
+    std::sort(mobjs.begin(), mobjs.end(), [](const mobj_t* const pMobj1, const mobj_t* const pMobj2) noexcept {
+        return ((int32_t)(pMobj1->listOrder - pMobj2->listOrder) < 0);
+    });
 
+    for (mobj_t* const pMobj : mobjs) {
+        pMobj->scriptRemovalIdx = 0;
+    }
+
+    for (mobj_t* const pMobj : mobjs) {
         // N.B: only run the 'P_RemoveMobj' late call - leave other late calls alone
+        const latecall_t lateCall = pMobj->latecall;
+
         if (lateCall && (lateCall == P_RemoveMobj)) {
             lateCall(*pMobj);
         }
+    }
+
+    // Give the memory back to the pending list, to avoid reallocating it later
+    mobjs.clear();
+    gPendingRemovalMobjs.swap(mobjs);
+
+    // This counts towards the time spent in scripts for the current tick
+    const double gcUsec = getUsecSince(gcStartTime);
+    addTimeSample(gGcTimeStats, gcUsec);
+    gCurTickUsec += gcUsec;
+}
 
-        pMobj = pNextMobj;
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds an entry for the specified action to the timer wheel, at the level and slot appropriate for how far in the future it is due
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void addTimerWheelEntry(const TimerWheelEntry entry, const uint64_t dueTick) noexcept {
+    ASSERT(dueTick >= gSchedulerTick);      // Note: can be due on the current tick if cascading from a higher level
+    const uint64_t ticksUntilDue = dueTick - gSchedulerTick;
+
+    for (uint32_t level = 0; level < TIMER_WHEEL_NUM_LEVELS; ++level) {
+        const uint32_t levelShift = level * TIMER_WHEEL_SLOT_BITS;
+
+        if (ticksUntilDue < (uint64_t(1) << (levelShift + TIMER_WHEEL_SLOT_BITS))) {
+            const uint64_t slotIdx = (dueTick >> levelShift) & (TIMER_WHEEL_NUM_SLOTS - 1);
+            gTimerWheel[level][slotIdx].push_back(entry);
+            return;
+        }
     }
+
+    gTimerWheelOverflow.push_back(entry);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Allocates and zero initializes a 'ScheduledAction' structure.
-// Tries to find a free one in the list first, otherwise adds a new one to the end of the list.
+// Tells if the given timer wheel entry is for an action which is still waiting to execute at the time the entry was made for
 //------------------------------------------------------------------------------------------------------------------------------------------
-static ScheduledAction& allocScheduledAction() noexcept {
-    for (ScheduledAction& action : gScheduledActions) {
-        // If there are no more executions left then it is free
-        if (action.executionsLeft == 0) {
-            action = {};
-            return action;
+static bool isTimerWheelEntryValid(const TimerWheelEntry entry) noexcept {
+    return (
+        (entry.actionIdx < (int32_t) gScheduledActions.size()) &&
+        (gScheduledActions[entry.actionIdx].armId == entry.armId)
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Moves all entries in the given timer wheel bucket to wherever they should be placed now, discarding any stale entries
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void cascadeTimerWheelBucket(TimerWheelBucket& bucket) noexcept {
+    // N.B: swap the bucket out first since entries might be re-added to the same bucket
+    TimerWheelBucket entries;
+    entries.swap(bucket);
+
+    for (const TimerWheelEntry entry : entries) {
+        if (isTimerWheelEntryValid(entry)) {
+            addTimerWheelEntry(entry, gScheduledActions[entry.actionIdx].dueTick);
+        }
+    }
+
+    // Give the memory back to the bucket if nothing new was added to it, to avoid reallocating it later
+    if (bucket.empty()) {
+        entries.clear();
+        bucket.swap(entries);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Advances the scheduler to the next tick and moves any timer wheel buckets that are now coming due down into the lower levels of the wheel
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void advanceSchedulerTick() noexcept {
+    const uint64_t tick = ++gSchedulerTick;
+
+    // Note: the overflow list and higher levels must be cascaded first, since their entries may end up in the lower level buckets cascaded next
+    constexpr uint64_t OVERFLOW_PERIOD = uint64_t(1) << (TIMER_WHEEL_NUM_LEVELS * TIMER_WHEEL_SLOT_BITS);
+
+    if ((tick & (OVERFLOW_PERIOD - 1)) == 0) {
+        cascadeTimerWheelBucket(gTimerWheelOverflow);
+    }
+
+    for (uint32_t level = TIMER_WHEEL_NUM_LEVELS - 1; level >= 1; --level) {
+        const uint32_t levelShift = level * TIMER_WHEEL_SLOT_BITS;
+
+        if ((tick & ((uint64_t(1) << levelShift) - 1)) == 0) {
+            const uint64_t slotIdx = (tick >> levelShift) & (TIMER_WHEEL_NUM_SLOTS - 1);
+            cascadeTimerWheelBucket(gTimerWheel[level][slotIdx]);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Schedules the given action to execute after the specified number of scheduler ticks have passed (following the current one).
+// Any previous scheduling of the action is cancelled.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void armScheduledAction(const int32_t actionIdx, const int32_t delayTics) noexcept {
+    ScheduledAction& action = gScheduledActions[actionIdx];
+    action.dueTick = gSchedulerTick + (uint64_t) std::max(delayTics, 0) + 1;
+    action.armId = ++gNextArmId;
+    addTimerWheelEntry(TimerWheelEntry{ actionIdx, action.armId }, action.dueTick);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stops the given action from waiting to execute and saves how many ticks it had left to wait, so it can be resumed later
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void disarmScheduledAction(ScheduledAction& action) noexcept {
+    action.delayTics = (int32_t) std::max<int64_t>((int64_t)(action.dueTick - gSchedulerTick) - 1, 0);
+    action.armId = ++gNextArmId;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds the given action to the list of actions with the same tag
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void addToTagList(const int32_t actionIdx) noexcept {
+    ScheduledAction& action = gScheduledActions[actionIdx];
+    std::vector<int32_t>& tagList = gActionIdxsByTag[action.tag];
+    action.tagListIdx = (int32_t) tagList.size();
+    tagList.push_back(actionIdx);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stops the action at the given index (if it isn't already stopped) and makes its slot in the scheduled actions list available for reuse
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void freeScheduledAction(const int32_t actionIdx) noexcept {
+    ScheduledAction& action = gScheduledActions[actionIdx];
+    action.bPendingExecute = false;
+
+    if (action.executionsLeft == 0)
+        return;
+
+    action.executionsLeft = 0;
+    action.armId = ++gNextArmId;
+
+    // Remove from the list of actions with this tag: move the last action in the list into this action's place
+    std::vector<int32_t>& tagList = gActionIdxsByTag[action.tag];
+    ASSERT((action.tagListIdx >= 0) && (action.tagListIdx < (int32_t) tagList.size()));
+    ASSERT(tagList[action.tagListIdx] == actionIdx);
+
+    const int32_t lastActionIdx = tagList.back();
+    tagList[action.tagListIdx] = lastActionIdx;
+    gScheduledActions[lastActionIdx].tagListIdx = action.tagListIdx;
+    tagList.pop_back();
+
+    gFreeActionIdxs.push(actionIdx);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds a new action to the scheduled actions list and schedules it to execute after its delay.
+// The lowest free slot in the list is used, otherwise the action is added to the end of the list.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void addScheduledAction(const ScheduledAction& newAction) noexcept {
+    ASSERT(newAction.executionsLeft != 0);
+    int32_t actionIdx = -1;
+
+    while (!gFreeActionIdxs.empty()) {
+        const int32_t freeIdx = gFreeActionIdxs.top();
+        gFreeActionIdxs.pop();
+
+        if ((freeIdx < (int32_t) gScheduledActions.size()) && (gScheduledActions[freeIdx].executionsLeft == 0)) {
+            actionIdx = freeIdx;
+            break;
+        }
+    }
+
+    if (actionIdx < 0) {
+        actionIdx = (int32_t) gScheduledActions.size();
+        gScheduledActions.emplace_back();
+    }
+
+    gScheduledActions[actionIdx] = newAction;
+    addToTagList(actionIdx);
+    armScheduledAction(actionIdx, newAction.delayTics);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Pauses or unpauses the action at the given index.
+// Note: an action which is pending execution on the current tick must also wait another tick, even if it was not paused to begin with.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void setScheduledActionPaused(const int32_t actionIdx, const bool bPause) noexcept {
+    ScheduledAction& action = gScheduledActions[actionIdx];
+
+    if (action.executionsLeft != 0) {
+        if (bPause) {
+            if (!action.bPaused) {
+                disarmScheduledAction(action);
+            }
+        } else {
+            if (action.bPaused) {
+                armScheduledAction(actionIdx, action.delayTics);
+            } else if (action.bPendingExecute) {
+                armScheduledAction(actionIdx, 0);
+            }
+        }
+    }
+
+    action.bPaused = bPause;
+    action.bPendingExecute = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Clears the timer wheel and all other indexes of the scheduled actions list
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void clearScheduledActionIndexes() noexcept {
+    for (TimerWheelBucket (&level)[TIMER_WHEEL_NUM_SLOTS] : gTimerWheel) {
+        for (TimerWheelBucket& bucket : level) {
+            bucket.clear();
         }
     }
 
-    return gScheduledActions.emplace_back();
+    gTimerWheelOverflow.clear();
+    gDueActions.clear();
+    gFreeActionIdxs = {};
+    gActionIdxsByTag.clear();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -242,6 +558,32 @@ static void compactScheduledActionList() noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Prints a report to standard out on time spent in scripts for the current level: per tick, per action number and for garbage collection
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void printScriptTimeReport() noexcept {
+    const auto printStats = [](const char* const name, const ScriptTimeStats& stats) noexcept {
+        std::printf(
+            "  %-16s count: %8llu  total: %10.3f ms  avg: %8.1f us  max: %8.1f us\n",
+            name,
+            (unsigned long long) stats.numSamples,
+            stats.totalUsec / 1000.0,
+            (stats.numSamples > 0) ? stats.totalUsec / (double) stats.numSamples : 0.0,
+            stats.maxUsec
+        );
+    };
+
+    std::printf("PsyDoom: script timings for the level:\n");
+    printStats("Per tick", gTickTimeStats);
+    printStats("Garbage collect", gGcTimeStats);
+
+    for (const auto& [actionNum, stats] : gActionTimeStats) {
+        char name[32];
+        std::snprintf(name, C_ARRAY_SIZE(name), "Action #%d", actionNum);
+        printStats(name, stats);
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes the scripting engine for the current level.
 // Loads and compiles the script lump for the level, if any is present.
@@ -249,20 +591,31 @@ static void compactScheduledActionList() noexcept {
 void init() noexcept {
     ASSERT(gNumExecutingScripts == 0);
 
+    // Clear the timing statistics for the level
+    gTickTimeStats = {};
+    gGcTimeStats = {};
+    gActionTimeStats.clear();
+    gCurTickUsec = 0.0;
+    gCurTickSlowestActionUsec = 0.0;
+    gCurTickSlowestActionNum = 0;
+
     // Read the current map script (if any)
     std::unique_ptr<char[]> mapScript = readCurrentMapScript();
 
     if (!mapScript)
         return;
 
-    // Prealloc some memory
+    // Prealloc some memory and reset the scheduler
     gScheduledActions.reserve(64);
+    clearScheduledActionIndexes();
+    gSchedulerTick = 0;
 
     // If a script exists then setup a Lua environment for registering script actions and then execute the map script to register them
     setupActionRegisterLuaEnv();
 
     try {
-        gpLuaState->script(mapScript.get());
+        const sol::bytecode& bytecode = getMapScriptBytecode(mapScript.get());
+        gpLuaState->script(bytecode.as_string_view(), "SCRIPTS", sol::load_mode::binary);
     }
     catch (const std::exception& e) {
         std::printf("PsyDoom: error executing the map script! Details follow:\n%s\n", e.what());
@@ -279,58 +632,120 @@ void init() noexcept {
 void shutdown() noexcept {
     ASSERT_LOG(gNumExecutingScripts == 0, "Shutdown should only be done when no scripts are executing!");
 
+    // If a script time budget is being used then report on how long each action took to execute during the level
+    if (gpLuaState && (ProgArgs::gScriptTickBudgetMs > 0.0f)) {
+        printScriptTimeReport();
+    }
+
     gScheduledActions.clear();
+    clearScheduledActionIndexes();
+    gPendingRemovalMobjs.clear();
     gScriptActions.clear();
     gpLuaState.reset();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Runs all actions that are scheduled for execution
+// Runs all actions that are scheduled for execution.
+// Actions which are due on the same tick execute in the order they appear in the scheduled actions list.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void runScheduledActions() noexcept {
-    // Flag which actions are pending execution for this frame.
-    // If any actions schedule any other actions then they will be delayed by 1 frame at least.
-    const int32_t numActions = (int32_t) gScheduledActions.size();
+    // Move onto the next tick and gather up the actions which are due on it, discarding stale entries in the wheel.
+    // Flag these actions as pending execution: if any actions schedule any other actions then they will be delayed by 1 frame at least.
+    advanceSchedulerTick();
+
+    TimerWheelBucket& dueBucket = gTimerWheel[0][gSchedulerTick & (TIMER_WHEEL_NUM_SLOTS - 1)];
+    gDueActions.clear();
+
+    for (const TimerWheelEntry entry : dueBucket) {
+        if (isTimerWheelEntryValid(entry)) {
+            ASSERT(gScheduledActions[entry.actionIdx].dueTick == gSchedulerTick);
+            gScheduledActions[entry.actionIdx].bPendingExecute = true;
+            gDueActions.push_back(entry);
+        }
+    }
+
+    dueBucket.clear();
 
-    for (int32_t i = 0; i < numActions; ++i) {
-        // Skip the action if paused or if there are no more executions left (stopped)
-        ScheduledAction& action = gScheduledActions[i];
+    std::sort(gDueActions.begin(), gDueActions.end(), [](const TimerWheelEntry& e1, const TimerWheelEntry& e2) noexcept {
+        return (e1.actionIdx < e2.actionIdx);
+    });
 
-        if (action.bPaused || (action.executionsLeft == 0))
+    // Execute all pending actions.
+    // Note that executing actions might stop, pause or reschedule other actions due on this tick, which makes them no longer pending.
+    for (size_t i = 0; i < gDueActions.size(); ++i) {
+        const TimerWheelEntry entry = gDueActions[i];
+
+        if ((!isTimerWheelEntryValid(entry)) || (!gScheduledActions[entry.actionIdx].bPendingExecute))
             continue;
 
-        // Reduce the time until the action executes or schedule it to execute if executing now
-        const int32_t delayTics = action.delayTics;
+        // Setup the next repeat (if any) or free up the action if there are no more executions left, then execute it.
+        // N.B: copy the action details before this since executing the action might cause the list to be reallocated.
+        ScheduledAction& action = gScheduledActions[entry.actionIdx];
+        const int32_t actionNum = action.actionNum;
+        const int32_t actionTag = action.tag;
+        const int32_t actionUserdata = action.userdata;
+        const int32_t executionsLeft = action.executionsLeft;
+
+        action.bPendingExecute = false;
 
-        if (delayTics > 0) {
-            action.delayTics = delayTics - 1;
+        if (executionsLeft == 1) {
+            freeScheduledAction(entry.actionIdx);
         } else {
-            action.bPendingExecute = true;
+            if (executionsLeft > 0) {
+                action.executionsLeft = executionsLeft - 1;     // Finite number of repeats
+            }
+
+            armScheduledAction(entry.actionIdx, action.repeatDelay);
         }
+
+        doAction(actionNum, nullptr, nullptr, nullptr, actionTag, actionUserdata);
     }
 
-    // Execute all pending actions and ignore any new ones that have been added
-    for (int32_t i = 0; i < numActions; ++i) {
-        // Only execute the action if it's pending execution
-        ScheduledAction& action = gScheduledActions[i];
+    gDueActions.clear();
 
-        if (!action.bPendingExecute)
-            continue;
+    // Compact the actions list as much as possible if there's stuff on the end that can be removed
+    compactScheduledActionList();
+}
 
-        // Otherwise setup the next repeat (if any) and execute the action
-        const int32_t executionsLeft = action.executionsLeft;
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Finishes timing scripts for the current game tick and issues a warning if they went over the time budget for a tick (if there is one)
+//------------------------------------------------------------------------------------------------------------------------------------------
+void endTick() noexcept {
+    if (!gpLuaState)
+        return;
 
-        if (executionsLeft > 0) {
-            action.executionsLeft = executionsLeft - 1;     // Finite number of repeats
-        }
+    addTimeSample(gTickTimeStats, gCurTickUsec);
 
-        action.delayTics = action.repeatDelay;
-        action.bPendingExecute = false;
-        doAction(action.actionNum, nullptr, nullptr, nullptr, action.tag, action.userdata);
+    const double budgetUsec = (double) ProgArgs::gScriptTickBudgetMs * 1000.0;
+
+    if ((budgetUsec > 0.0) && (gCurTickUsec > budgetUsec)) {
+        showStatusBarError("Scripts over budget: %.1fms!", gCurTickUsec / 1000.0);
+        std::printf(
+            "PsyDoom: scripts took %.3f ms this tick, over the budget of %.3f ms! Slowest action was #%d at %.3f ms.\n",
+            gCurTickUsec / 1000.0,
+            budgetUsec / 1000.0,
+            gCurTickSlowestActionNum,
+            gCurTickSlowestActionUsec / 1000.0
+        );
     }
 
-    // Compact the actions list as much as possible if there's stuff on the end that can be removed
-    compactScheduledActionList();
+    gCurTickUsec = 0.0;
+    gCurTickSlowestActionUsec = 0.0;
+    gCurTickSlowestActionNum = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the scripting engine is active, i.e. if the current map has a script
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isActive() noexcept {
+    return (gpLuaState != nullptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns how many bytes are currently used by the Lua heap, or '0' if the scripting engine is not active
+//------------------------------------------------------------------------------------------------------------------------------------------
+size_t getLuaMemoryUsed() noexcept {
+    return (gpLuaState) ? gpLuaState->memory_used() : 0;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -345,6 +760,10 @@ bool doAction(
     const int32_t actionTag,
     const int32_t actionUserdata
 ) noexcept {
+    // Time how long the action takes to execute
+    PROFILE_ZONE("ScriptingEngine::doAction");
+    const Clock::time_point actionStartTime = Clock::now();
+
     // Set context for scripts
     gNumExecutingScripts++;
 
@@ -391,6 +810,20 @@ bool doAction(
 
     gNumExecutingScripts--;
 
+    // Record how long the action took to execute.
+    // Only the outermost action in the stack counts towards the time for the current tick, since nested actions are included in its time.
+    const double actionUsec = getUsecSince(actionStartTime);
+    addTimeSample(gActionTimeStats[actionNum], actionUsec);
+
+    if (gNumExecutingScripts == 0) {
+        gCurTickUsec += actionUsec;
+
+        if (actionUsec > gCurTickSlowestActionUsec) {
+            gCurTickSlowestActionUsec = actionUsec;
+            gCurTickSlowestActionNum = actionNum;
+        }
+    }
+
     // Delete any things that are pending for delete if this is the last script in the stack
     if (gNumExecutingScripts == 0) {
         doMobjGC();
@@ -409,12 +842,13 @@ void scheduleAction(
     const int32_t tag,
     const int32_t userdata
 ) noexcept {
-    ScheduledAction& action = allocScheduledAction();
+    ScheduledAction action = {};
     action.actionNum = actionNum;
     action.delayTics = std::max(delayTics, 0);
     action.executionsLeft = 1;
     action.tag = tag;
     action.userdata = userdata;
+    addScheduledAction(action);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -429,24 +863,87 @@ void scheduleRepeatingAction(
     const int32_t tag,
     const int32_t userdata
 ) noexcept {
-    ScheduledAction& action = allocScheduledAction();
+    ScheduledAction action = {};
     action.actionNum = actionNum;
     action.delayTics = std::max(initialDelayTics, 0);
     action.executionsLeft = (numRepeats < 0) ? -1 : numRepeats + 1;    // Note: use '-1' always for infinite
     action.repeatDelay = std::max(repeatDelay, 0);
     action.tag = tag;
     action.userdata = userdata;
+    addScheduledAction(action);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Cancels/stops all scheduled actions
+// Adds the given thing to the list of things to delete after the current script has finished executing, if it's not already in the list.
+// Only the things which scripts ask to delete are visited when cleaning up, rather than every thing in the level.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void stopAllScheduledActions() noexcept {
-    // Note: this can be called while executing and iterating through the scheduled action list.
-    // Therefore just flag the action as stopped rather than trying to cleanup or compact the list.
+void queueMobjRemoval(mobj_t& mobj) noexcept {
+    if (mobj.scriptRemovalIdx != 0)
+        return;
+
+    gPendingRemovalMobjs.push_back(&mobj);
+    mobj.scriptRemovalIdx = (uint32_t) gPendingRemovalMobjs.size();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Takes the given thing off the list of things to delete after the current script has finished executing.
+// Must be called if the thing is deleted by other means before then.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void cancelMobjRemoval(mobj_t& mobj) noexcept {
+    const uint32_t listIdx = mobj.scriptRemovalIdx - 1;
+    ASSERT(listIdx < gPendingRemovalMobjs.size());
+    ASSERT(gPendingRemovalMobjs[listIdx] == &mobj);
+
+    gPendingRemovalMobjs[listIdx] = nullptr;
+    mobj.scriptRemovalIdx = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Brings the delay counts for all scheduled actions up to date, so that they can be saved.
+// Actions which are waiting to execute only track the tick they are due on while the game is running.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void syncScheduledActionDelays() noexcept {
     for (ScheduledAction& action : gScheduledActions) {
-        action.executionsLeft = 0;
+        if ((action.executionsLeft != 0) && (!action.bPaused)) {
+            action.delayTics = (int32_t) std::max<int64_t>((int64_t)(action.dueTick - gSchedulerTick) - 1, 0);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Rebuilds the timer wheel and other indexes for the scheduled actions list, after the list has been loaded from a save
+//------------------------------------------------------------------------------------------------------------------------------------------
+void rebuildScheduledActionIndexes() noexcept {
+    clearScheduledActionIndexes();
+    const int32_t numActions = (int32_t) gScheduledActions.size();
+
+    for (int32_t actionIdx = 0; actionIdx < numActions; ++actionIdx) {
+        ScheduledAction& action = gScheduledActions[actionIdx];
         action.bPendingExecute = false;
+        action.armId = ++gNextArmId;
+
+        if (action.executionsLeft == 0) {
+            gFreeActionIdxs.push(actionIdx);
+            continue;
+        }
+
+        addToTagList(actionIdx);
+
+        if (!action.bPaused) {
+            armScheduledAction(actionIdx, action.delayTics);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Cancels/stops all scheduled actions
+//------------------------------------------------------------------------------------------------------------------------------------------
+void stopAllScheduledActions() noexcept {
+    // Note: this can be called while executing scheduled actions, so just flag the actions as stopped rather than trying to compact the list.
+    const int32_t numActions = (int32_t) gScheduledActions.size();
+
+    for (int32_t actionIdx = 0; actionIdx < numActions; ++actionIdx) {
+        freeScheduledAction(actionIdx);
     }
 }
 
@@ -454,13 +951,17 @@ void stopAllScheduledActions() noexcept {
 // Cancels/stops all scheduled actions with the specified tag
 //------------------------------------------------------------------------------------------------------------------------------------------
 void stopScheduledActionsWithTag(const int32_t tag) noexcept {
-    // Note: this can be called while executing and iterating through the scheduled action list.
-    // Therefore just flag the action as stopped rather than trying to cleanup or compact the list.
-    for (ScheduledAction& action : gScheduledActions) {
-        if (action.tag == tag) {
-            action.executionsLeft = 0;
-            action.bPendingExecute = false;
-        }
+    // Note: this can be called while executing scheduled actions, so just flag the actions as stopped rather than trying to compact the list.
+    // Freeing an action removes it from the tag list, so keep stopping the last action in the list until there are none left.
+    const auto tagIter = gActionIdxsByTag.find(tag);
+
+    if (tagIter == gActionIdxsByTag.end())
+        return;
+
+    std::vector<int32_t>& tagList = tagIter->second;
+
+    while (!tagList.empty()) {
+        freeScheduledAction(tagList.back());
     }
 }
 
@@ -468,9 +969,10 @@ void stopScheduledActionsWithTag(const int32_t tag) noexcept {
 // Pauses or unpaused all scheduled actions
 //------------------------------------------------------------------------------------------------------------------------------------------
 void pauseAllScheduledActions(const bool bPause) noexcept {
-    for (ScheduledAction& action : gScheduledActions) {
-        action.bPaused = bPause;
-        action.bPendingExecute = false;     // Action must wait another frame if it is unpaused
+    const int32_t numActions = (int32_t) gScheduledActions.size();
+
+    for (int32_t actionIdx = 0; actionIdx < numActions; ++actionIdx) {
+        setScheduledActionPaused(actionIdx, bPause);
     }
 }
 
@@ -478,11 +980,13 @@ void pauseAllScheduledActions(const bool bPause) noexcept {
 // Pauses or unpaused all scheduled actions with the specified tag
 //------------------------------------------------------------------------------------------------------------------------------------------
 void pauseScheduledActionsWithTag(const int32_t tag, const bool bPause) noexcept {
-    for (ScheduledAction& action : gScheduledActions) {
-        if (action.tag == tag) {
-            action.bPaused = bPause;
-            action.bPendingExecute = false;     // Action must wait another frame if it is unpaused
-        }
+    const auto tagIter = gActionIdxsByTag.find(tag);
+
+    if (tagIter == gActionIdxsByTag.end())
+        return;
+
+    for (const int32_t actionIdx : tagIter->second) {
+        setScheduledActionPaused(actionIdx, bPause);
     }
 }
 
@@ -491,15 +995,8 @@ void pauseScheduledActionsWithTag(const int32_t tag, const bool bPause) noexcept
 // This count includes any actions that have been paused, but not actions that are stopped/finished.
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t getNumScheduledActionsWithTag(const int32_t tag) noexcept {
-    int32_t actionCount = 0;
-
-    for (ScheduledAction& action : gScheduledActions) {
-        if ((action.tag == tag) && (action.executionsLeft != 0)) {
-            actionCount++;
-        }
-    }
-
-    return actionCount;
+    const auto tagIter = gActionIdxsByTag.find(tag);
+    return (tagIter != gActionIdxsByTag.end()) ? (int32_t) tagIter->second.size() : 0;
 }
 
 END_NAMESPACE(ScriptingEngine)
@@ -2,6 +2,7 @@
 
 #include "Macros.h"
 
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -22,6 +23,19 @@ struct ScheduledAction {
     int32_t     userdata;           // User defined data associated with the action
     bool        bPaused;            // If 'true' then the action is paused, otherwise it's unpaused
     bool        bPendingExecute;    // If 'true' then the action is pending execution this frame
+
+    // Scheduler bookkeeping which is not saved; rebuilt from the fields above after loading.
+    // Note: while an action is waiting to execute 'delayTics' is only brought up to date when the action is paused or the game is saved.
+    uint64_t    dueTick;            // Scheduler tick that the action next executes on, if it is waiting to execute (not paused or stopped)
+    uint32_t    armId;              // Changes whenever the action is (re)scheduled or stops waiting, to invalidate old timer wheel entries for it
+    int32_t     tagListIdx;         // Where the action is in the list of actions with the same tag
+};
+
+// Timing statistics for script actions and other scripting engine activity over the course of the current level
+struct ScriptTimeStats {
+    uint64_t    numSamples;     // How many times the activity was timed (executions of an action, ticks etc.)
+    double      totalUsec;      // Total time spent on the activity
+    double      maxUsec;        // Worst case time for a single sample of the activity
 };
 
 extern std::vector<ScheduledAction>     gScheduledActions;
@@ -31,11 +45,15 @@ extern mobj_t*                          gpCurTriggeringMobj;
 extern int32_t                          gCurActionTag;
 extern int32_t                          gCurActionUserdata;
 extern bool                             gbCurActionAllowed;
-extern bool                             gbNeedMobjGC;
+extern ScriptTimeStats                  gTickTimeStats;
+extern ScriptTimeStats                  gGcTimeStats;
 
 void init() noexcept;
 void shutdown() noexcept;
 void runScheduledActions() noexcept;
+void endTick() noexcept;
+bool isActive() noexcept;
+size_t getLuaMemoryUsed() noexcept;
 
 bool doAction(
     const int32_t actionNum,
@@ -62,6 +80,10 @@ void scheduleRepeatingAction(
     const int32_t userdata
 ) noexcept;
 
+void queueMobjRemoval(mobj_t& mobj) noexcept;
+void cancelMobjRemoval(mobj_t& mobj) noexcept;
+void syncScheduledActionDelays() noexcept;
+void rebuildScheduledActionIndexes() noexcept;
 void stopAllScheduledActions() noexcept;
 void stopScheduledActionsWithTag(const int32_t tag) noexcept;
 void pauseAllScheduledActions(const bool bPause) noexcept;
@@ -0,0 +1,1208 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A module which computes a conservative 'potentially visible set' (PVS) for enemy line of sight checks at level load time.
+// For each pair of subsectors it records whether any unobstructed sight line could possibly exist between them, ignoring sector heights.
+// 'P_CheckSight' uses this as an early out before doing a full raycast against the BSP tree, which helps a lot for community maps that
+// ship with an empty or weak 'REJECT' lump.
+//
+// The PVS must never say that sight is blocked when the original sight checking code would say otherwise, because that would cause
+// demo desyncs. To make sure of this the following is done:
+//
+//  (1) Visibility is computed by flooding through the portals between leafs (subsector polygons), finding chains of portals which can
+//      all be stabbed by a single line. All tests are done with closed ranges and a small amount of slack, so that lines grazing
+//      portal endpoints or passing through cracks between leafs are always considered visible.
+//  (2) The original code ignores walls crossed very close to the start of the sight line. To account for this the start of the line
+//      is allowed anywhere within a few units of the source subsector.
+//  (3) Lines running exactly along one sided walls are not blocked by those walls and can pass through 'void' areas outside of the map.
+//      These are handled separately by a 1D visibility pass along each distinct wall line.
+//  (4) The PVS is only used for maps where the original integer math in the sight code cannot overflow, where all line and partition
+//      coordinates are whole numbers, and where the BSP tree is consistent (so that every crossed wall is guaranteed to be tested).
+//      The PVS is also only consulted when both sight points are actually inside the polygons of their subsectors at runtime.
+//
+// The result is cached on disk (keyed by the map hash) so that it only needs to be computed the first time a map is played.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "SightPvs.h"
+
+#include "Config/Config.h"
+#include "Doom/Game/doomdata.h"
+#include "Doom/Game/p_setup.h"
+#include "Doom/Renderer/r_local.h"
+#include "FileUtils.h"
+#include "GameJobs.h"
+#include "MapHash.h"
+#include "Utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+BEGIN_NAMESPACE(SightPvs)
+
+// Sanity limits and tolerances for building the PVS
+static constexpr int32_t    MAX_SUBSECTORS          = 8192;         // Don't build the PVS for maps bigger than this (memory & build time limits)
+static constexpr int32_t    MAX_MAP_EXTENT          = 23000;        // Max map width/height where the original sight code's integer math can't overflow
+static constexpr int32_t    MAX_VOID_PORTALS        = 256;          // Give up on the PVS if leafs have more than this many edges which open into the void
+static constexpr uint32_t   MAX_FLOOD_STEPS         = 1u << 17;     // Max portal steps for flooding out from a single subsector, before giving up
+static constexpr double     NEAR_START_DIST         = 6.0;          // Walls closer than this to the sight line start might be ignored by the original code
+static constexpr double     EDGE_MATCH_TOLERANCE    = 0.05;         // How much leaf edges can deviate and still be considered as touching
+static constexpr double     STAB_SLACK              = 0.01;         // How much a line can miss a portal by and still be considered as passing through it
+static constexpr double     GRID_CELL_SIZE          = 128.0;        // Size of the cells used in the spatial hash for matching up leaf edges
+
+// Info for the PVS cache file
+static constexpr uint32_t   CACHE_FILE_MAGIC        = 0x53565053;   // 'SPVS'
+static constexpr uint32_t   CACHE_FILE_VERSION      = 1;
+
+struct CacheFileHeader {
+    uint32_t    magic;
+    uint32_t    version;
+    uint64_t    mapHashWord1;
+    uint64_t    mapHashWord2;
+    uint64_t    geometryHash;       // Hash of the geometry the PVS was built from: guards against map patches and such changing things
+    uint32_t    numSubsectors;
+    uint32_t    rowNumWords;
+};
+
+// A 2D point or vector
+struct Vec2d {
+    double x;
+    double y;
+};
+
+// The edge of a convex leaf polygon, as a line equation: points are inside the leaf when 'nx * x + ny * y + c >= 0'
+struct EdgePlane {
+    double nx;
+    double ny;
+    double c;
+};
+
+// An axis aligned bounding box
+struct Box2d {
+    double lx;
+    double ly;
+    double hx;
+    double hy;
+};
+
+// A portal leading out of a cell (leaf) into another cell.
+// A line passing through the portal from the current cell must have the 'left' point on its left and the 'right' point on its right.
+struct Portal {
+    Vec2d       lpt;
+    Vec2d       rpt;
+    int32_t     toCell;
+};
+
+// An edge of a leaf, used for matching up edges between leafs to find portals
+struct LeafEdge {
+    Vec2d       a;
+    Vec2d       b;
+    int32_t     leafIdx;
+};
+
+// A distinct line that one sided walls lie on, plus the positions along it where other walls cross it
+struct WallLine {
+    Vec2d                   origin;
+    Vec2d                   dir;            // Normalized
+    std::vector<double>     blockers;       // Sorted positions along the line of walls which cross it
+    std::vector<int32_t>    leafIdxs;       // Leafs whose bounding box touches the line
+    std::vector<Vec2d>      leafRanges;     // Min/max position along the line for each leaf touching the line
+};
+
+// The PVS itself and the leaf polygon data needed at runtime to decide whether it can be used
+static bool                     gbPvsValid;
+static int32_t                  gNumLeafs;
+static uint32_t                 gRowNumWords;
+static std::vector<uint64_t>    gPvsBits;
+static std::vector<uint32_t>    gLeafPlanesBeg;
+static std::vector<EdgePlane>   gLeafPlanes;
+static std::vector<Box2d>       gLeafBoxes;
+static std::vector<uint8_t>     gbLeafUsable;
+
+// Data used only while building the PVS
+static int32_t                  gVoidCell;
+static std::vector<uint32_t>    gCellPortalsBeg;
+static std::vector<Portal>      gPortals;
+static std::vector<WallLine>    gWallLines;
+static std::atomic<int32_t>     gNextBuildLeafIdx;      // Next leaf to build a PVS row for (shared by all build jobs)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Small geometry helpers
+//------------------------------------------------------------------------------------------------------------------------------------------
+static Vec2d toVec2d(const vertex_t& vertex) noexcept {
+    return Vec2d{ (double) vertex.x / (double) FRACUNIT, (double) vertex.y / (double) FRACUNIT };
+}
+
+static double dot(const Vec2d& a, const Vec2d& b) noexcept {
+    return a.x * b.x + a.y * b.y;
+}
+
+static Vec2d sub(const Vec2d& a, const Vec2d& b) noexcept {
+    return Vec2d{ a.x - b.x, a.y - b.y };
+}
+
+static Vec2d madd(const Vec2d& a, const Vec2d& dir, const double t) noexcept {
+    return Vec2d{ a.x + dir.x * t, a.y + dir.y * t };
+}
+
+static bool boxesIntersect(const Box2d& a, const Box2d& b) noexcept {
+    return ((a.lx <= b.hx) && (a.hx >= b.lx) && (a.ly <= b.hy) && (a.hy >= b.ly));
+}
+
+static Box2d expandBox(const Box2d& box, const double amount) noexcept {
+    return Box2d{ box.lx - amount, box.ly - amount, box.hx + amount, box.hy + amount };
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Clips the infinite line with the given origin and normalized direction against a box.
+// Returns 'false' if there is no intersection, otherwise returns the range of positions along the line inside the box.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool clipLineToBox(const Vec2d& origin, const Vec2d& dir, const Box2d& box, double& tMin, double& tMax) noexcept {
+    tMin = -INFINITY;
+    tMax = +INFINITY;
+
+    const double o[2] = { origin.x, origin.y };
+    const double d[2] = { dir.x, dir.y };
+    const double lo[2] = { box.lx, box.ly };
+    const double hi[2] = { box.hx, box.hy };
+
+    for (int32_t axis = 0; axis < 2; ++axis) {
+        if (std::abs(d[axis]) < 1e-12) {
+            if ((o[axis] < lo[axis]) || (o[axis] > hi[axis]))
+                return false;
+        } else {
+            double t1 = (lo[axis] - o[axis]) / d[axis];
+            double t2 = (hi[axis] - o[axis]) / d[axis];
+
+            if (t1 > t2) {
+                std::swap(t1, t2);
+            }
+
+            tMin = std::max(tMin, t1);
+            tMax = std::min(tMax, t2);
+        }
+    }
+
+    return (tMin <= tMax);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees all PVS data and the data used to build it
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void clearAll() noexcept {
+    gbPvsValid = false;
+    gNumLeafs = 0;
+    gRowNumWords = 0;
+    gPvsBits = {};
+    gLeafPlanesBeg = {};
+    gLeafPlanes = {};
+    gLeafBoxes = {};
+    gbLeafUsable = {};
+    gVoidCell = 0;
+    gCellPortalsBeg = {};
+    gPortals = {};
+    gWallLines = {};
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if a fixed point number is a whole number
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool isWholeNumber(const fixed_t value) noexcept {
+    return ((value & (FRACUNIT - 1)) == 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns which side of a BSP partition a point is on, using the same logic as 'PA_DivlineSide' but without truncating the point.
+// Returns '> 0' for side '0' and '<= 0' for side '1'. Assumes the partition coordinates are whole numbers.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int64_t getPartitionSideValue(const divline_t& line, const fixed_t x, const fixed_t y) noexcept {
+    const int64_t dx1 = (int64_t) x - line.x;
+    const int64_t dy1 = (int64_t) y - line.y;
+    return dx1 * d_fixed_to_int(line.dy) - dy1 * d_fixed_to_int(line.dx);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Verifies that the segs for every subsector are on the expected side of all the BSP partitions leading to that subsector.
+// This guarantees that the sight raycast always visits every subsector containing a wall that is crossed by the sight line.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool isBspConsistent(const int32_t nodeNum, std::vector<std::pair<const divline_t*, int32_t>>& partitions) noexcept {
+    if (nodeNum & NF_SUBSECTOR) {
+        const int32_t subsecNum = nodeNum & (~NF_SUBSECTOR);
+
+        if ((subsecNum < 0) || (subsecNum >= gNumSubsectors))
+            return false;
+
+        const subsector_t& subsec = gpSubsectors[subsecNum];
+
+        for (int32_t segIdx = 0; segIdx < subsec.numsegs; ++segIdx) {
+            const seg_t& seg = gpSegs[subsec.firstseg + segIdx];
+            const vertex_t* const segVerts[2] = { seg.vertex1, seg.vertex2 };
+
+            for (const vertex_t* const pVertex : segVerts) {
+                for (const auto& [pPartition, side] : partitions) {
+                    const int64_t sideValue = getPartitionSideValue(*pPartition, pVertex->x, pVertex->y);
+                    const bool bOnExpectedSide = (side == 0) ? (sideValue >= 0) : (sideValue <= 0);
+
+                    if (!bOnExpectedSide)
+                        return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    if ((nodeNum < 0) || (nodeNum >= gNumBspNodes))
+        return false;
+
+    const node_t& node = gpBspNodes[nodeNum];
+
+    for (int32_t side = 0; side < 2; ++side) {
+        partitions.emplace_back(&node.line, side);
+        const bool bConsistent = isBspConsistent(node.children[side], partitions);
+        partitions.pop_back();
+
+        if (!bConsistent)
+            return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Checks whether the PVS can be safely used for the current map, given the quirks of the original sight checking code
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool canUsePvsForMap() noexcept {
+    if ((gNumSubsectors <= 0) || (gNumSubsectors > MAX_SUBSECTORS) || (gNumBspNodes <= 0))
+        return false;
+
+    // All line vertices must be whole numbers (the sight code truncates them) and the map must be small enough to avoid overflows
+    int32_t minX = INT32_MAX, minY = INT32_MAX;
+    int32_t maxX = INT32_MIN, maxY = INT32_MIN;
+
+    for (int32_t vertexIdx = 0; vertexIdx < gNumVertexes; ++vertexIdx) {
+        const vertex_t& vertex = gpVertexes[vertexIdx];
+        minX = std::min(minX, d_fixed_to_int(vertex.x));
+        minY = std::min(minY, d_fixed_to_int(vertex.y));
+        maxX = std::max(maxX, d_fixed_to_int(vertex.x) + 1);
+        maxY = std::max(maxY, d_fixed_to_int(vertex.y) + 1);
+    }
+
+    if ((maxX - minX >= MAX_MAP_EXTENT) || (maxY - minY >= MAX_MAP_EXTENT))
+        return false;
+
+    for (int32_t lineIdx = 0; lineIdx < gNumLines; ++lineIdx) {
+        const line_t& line = gpLines[lineIdx];
+        const bool bWholeCoords = (
+            isWholeNumber(line.vertex1->x) && isWholeNumber(line.vertex1->y) &&
+            isWholeNumber(line.vertex2->x) && isWholeNumber(line.vertex2->y)
+        );
+
+        if (!bWholeCoords)
+            return false;
+    }
+
+    // Partitions must also be whole numbers (the sight code truncates them) and the BSP tree must be consistent
+    for (int32_t nodeIdx = 0; nodeIdx < gNumBspNodes; ++nodeIdx) {
+        const divline_t& line = gpBspNodes[nodeIdx].line;
+        const bool bWholeCoords = (isWholeNumber(line.x) && isWholeNumber(line.y) && isWholeNumber(line.dx) && isWholeNumber(line.dy));
+
+        if (!bWholeCoords)
+            return false;
+    }
+
+    std::vector<std::pair<const divline_t*, int32_t>> partitions;
+    return isBspConsistent(gNumBspNodes - 1, partitions);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the convex polygon (as a set of edge planes) and bounding box for each leaf.
+// Also verifies that the leaf edges for one sided walls actually lie along those walls, returning 'false' if that is not the case.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool buildLeafPolygons() noexcept {
+    gNumLeafs = gNumSubsectors;
+    gLeafPlanesBeg.resize((size_t) gNumLeafs + 1);
+    gLeafBoxes.resize((size_t) gNumLeafs);
+    gbLeafUsable.resize((size_t) gNumLeafs);
+    gLeafPlanes.clear();
+
+    for (int32_t leafIdx = 0; leafIdx < gNumLeafs; ++leafIdx) {
+        const subsector_t& subsec = gpSubsectors[leafIdx];
+        const leafedge_t* const pEdges = &gpLeafEdges[subsec.firstLeafEdge];
+        const int32_t numEdges = subsec.numLeafEdges;
+        gLeafPlanesBeg[leafIdx] = (uint32_t) gLeafPlanes.size();
+
+        // Get the bounds and signed area of the leaf
+        Box2d box = { +INFINITY, +INFINITY, -INFINITY, -INFINITY };
+        double area2 = 0.0;
+
+        for (int32_t edgeIdx = 0; edgeIdx < numEdges; ++edgeIdx) {
+            const Vec2d p1 = toVec2d(*pEdges[edgeIdx].vertex);
+            const Vec2d p2 = toVec2d(*pEdges[(edgeIdx + 1) % numEdges].vertex);
+            box.lx = std::min(box.lx, p1.x);
+            box.ly = std::min(box.ly, p1.y);
+            box.hx = std::max(box.hx, p1.x);
+            box.hy = std::max(box.hy, p1.y);
+            area2 += p1.x * p2.y - p2.x * p1.y;
+        }
+
+        gLeafBoxes[leafIdx] = box;
+
+        // Degenerate leafs can't contain anything, so are never used for culling
+        if ((numEdges < 3) || (std::abs(area2) < 1e-3)) {
+            gbLeafUsable[leafIdx] = false;
+            gLeafBoxes[leafIdx] = (numEdges > 0) ? box : Box2d{};
+            continue;
+        }
+
+        gbLeafUsable[leafIdx] = true;
+        const double orientation = (area2 > 0.0) ? 1.0 : -1.0;
+
+        for (int32_t edgeIdx = 0; edgeIdx < numEdges; ++edgeIdx) {
+            const leafedge_t& edge = pEdges[edgeIdx];
+            const Vec2d p1 = toVec2d(*edge.vertex);
+            const Vec2d p2 = toVec2d(*pEdges[(edgeIdx + 1) % numEdges].vertex);
+            const Vec2d edgeVec = sub(p2, p1);
+            const double edgeLen = std::sqrt(dot(edgeVec, edgeVec));
+
+            if (edgeLen < 1e-9)
+                continue;
+
+            // Plane for the edge: the inside of the leaf is on the left of the edge for counter clockwise leafs
+            EdgePlane plane;
+            plane.nx = -edgeVec.y / edgeLen * orientation;
+            plane.ny = +edgeVec.x / edgeLen * orientation;
+            plane.c = -(plane.nx * p1.x + plane.ny * p1.y);
+            gLeafPlanes.push_back(plane);
+
+            // If the edge is for a one sided wall then make sure it's actually along that wall
+            if (edge.seg && (!edge.seg->linedef->backsector)) {
+                const line_t& line = *edge.seg->linedef;
+                const Vec2d lineP1 = toVec2d(*line.vertex1);
+                const Vec2d lineVec = sub(toVec2d(*line.vertex2), lineP1);
+                const double lineLen = std::sqrt(dot(lineVec, lineVec));
+
+                if (lineLen < 1e-9)
+                    return false;
+
+                const Vec2d lineDir = { lineVec.x / lineLen, lineVec.y / lineLen };
+                const Vec2d edgePts[2] = { p1, p2 };
+
+                for (const Vec2d& pt : edgePts) {
+                    const Vec2d offset = sub(pt, lineP1);
+                    const double along = dot(offset, lineDir);
+                    const double across = offset.x * lineDir.y - offset.y * lineDir.x;
+
+                    if ((std::abs(across) > EDGE_MATCH_TOLERANCE) || (along < -EDGE_MATCH_TOLERANCE) || (along > lineLen + EDGE_MATCH_TOLERANCE))
+                        return false;
+                }
+            }
+        }
+    }
+
+    gLeafPlanesBeg[gNumLeafs] = (uint32_t) gLeafPlanes.size();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the key for a cell in the spatial hash used for matching up leaf edges
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t getGridCellKey(const int32_t cellX, const int32_t cellY) noexcept {
+    return ((uint64_t)(uint32_t) cellX << 32) | (uint64_t)(uint32_t) cellY;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Finds the portals between leafs by matching up the non wall edges of leafs which lie along each other.
+// Parts of leaf edges which don't touch any other leaf become portals into the 'void' cell.
+// Returns 'false' if there are too many edges opening into the void for the PVS to be useful.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool buildPortals() noexcept {
+    // Gather all the non wall edges for usable leafs
+    std::vector<LeafEdge> edges;
+
+    for (int32_t leafIdx = 0; leafIdx < gNumLeafs; ++leafIdx) {
+        if (!gbLeafUsable[leafIdx])
+            continue;
+
+        const subsector_t& subsec = gpSubsectors[leafIdx];
+        const leafedge_t* const pEdges = &gpLeafEdges[subsec.firstLeafEdge];
+        const int32_t numEdges = subsec.numLeafEdges;
+
+        // Note: re-orient edges so that they always go counter clockwise (leaf is on the left)
+        const uint32_t planesBeg = gLeafPlanesBeg[leafIdx];
+        const EdgePlane& firstPlane = gLeafPlanes[planesBeg];
+        bool bReverse = false;
+
+        for (int32_t edgeIdx = 0; edgeIdx < numEdges; ++edgeIdx) {
+            const Vec2d p1 = toVec2d(*pEdges[edgeIdx].vertex);
+            const Vec2d p2 = toVec2d(*pEdges[(edgeIdx + 1) % numEdges].vertex);
+            const Vec2d edgeVec = sub(p2, p1);
+            const double edgeLen = std::sqrt(dot(edgeVec, edgeVec));
+
+            if (edgeLen >= 1e-9) {
+                bReverse = (firstPlane.nx * edgeVec.y - firstPlane.ny * edgeVec.x > 0.0);
+                break;
+            }
+        }
+
+        for (int32_t edgeIdx = 0; edgeIdx < numEdges; ++edgeIdx) {
+            const leafedge_t& edge = pEdges[edgeIdx];
+            const bool bIsWall = (edge.seg && (!edge.seg->linedef->backsector));
+
+            if (bIsWall)
+                continue;
+
+            Vec2d p1 = toVec2d(*edge.vertex);
+            Vec2d p2 = toVec2d(*pEdges[(edgeIdx + 1) % numEdges].vertex);
+            const Vec2d edgeVec = sub(p2, p1);
+
+            if (dot(edgeVec, edgeVec) < 1e-18)
+                continue;
+
+            if (bReverse) {
+                std::swap(p1, p2);
+            }
+
+            edges.push_back(LeafEdge{ p1, p2, leafIdx });
+        }
+    }
+
+    // Put the edges into a spatial hash
+    std::unordered_map<uint64_t, std::vector<uint32_t>> grid;
+
+    for (uint32_t edgeIdx = 0; edgeIdx < (uint32_t) edges.size(); ++edgeIdx) {
+        const LeafEdge& edge = edges[edgeIdx];
+        const int32_t cellLx = (int32_t) std::floor((std::min(edge.a.x, edge.b.x) - EDGE_MATCH_TOLERANCE) / GRID_CELL_SIZE);
+        const int32_t cellLy = (int32_t) std::floor((std::min(edge.a.y, edge.b.y) - EDGE_MATCH_TOLERANCE) / GRID_CELL_SIZE);
+        const int32_t cellHx = (int32_t) std::floor((std::max(edge.a.x, edge.b.x) + EDGE_MATCH_TOLERANCE) / GRID_CELL_SIZE);
+        const int32_t cellHy = (int32_t) std::floor((std::max(edge.a.y, edge.b.y) + EDGE_MATCH_TOLERANCE) / GRID_CELL_SIZE);
+
+        for (int32_t cellY = cellLy; cellY <= cellHy; ++cellY) {
+            for (int32_t cellX = cellLx; cellX <= cellHx; ++cellX) {
+                grid[getGridCellKey(cellX, cellY)].push_back(edgeIdx);
+            }
+        }
+    }
+
+    // Match up each edge against all other edges that lie along it.
+    // Portals are made slightly bigger than the overlap between the edges, to be conservative.
+    std::vector<std::pair<int32_t, Portal>> portals;
+    std::vector<uint32_t> lastEdgeChecked(edges.size(), UINT32_MAX);
+    std::vector<Vec2d> overlaps;
+    int32_t numVoidPortals = 0;
+    gVoidCell = gNumLeafs;
+
+    for (uint32_t edgeIdx = 0; edgeIdx < (uint32_t) edges.size(); ++edgeIdx) {
+        const LeafEdge& edge = edges[edgeIdx];
+        const Vec2d edgeVec = sub(edge.b, edge.a);
+        const double edgeLen = std::sqrt(dot(edgeVec, edgeVec));
+        const Vec2d edgeDir = { edgeVec.x / edgeLen, edgeVec.y / edgeLen };
+        overlaps.clear();
+
+        const int32_t cellLx = (int32_t) std::floor((std::min(edge.a.x, edge.b.x) - EDGE_MATCH_TOLERANCE) / GRID_CELL_SIZE);
+        const int32_t cellLy = (int32_t) std::floor((std::min(edge.a.y, edge.b.y) - EDGE_MATCH_TOLERANCE) / GRID_CELL_SIZE);
+        const int32_t cellHx = (int32_t) std::floor((std::max(edge.a.x, edge.b.x) + EDGE_MATCH_TOLERANCE) / GRID_CELL_SIZE);
+        const int32_t cellHy = (int32_t) std::floor((std::max(edge.a.y, edge.b.y) + EDGE_MATCH_TOLERANCE) / GRID_CELL_SIZE);
+
+        for (int32_t cellY = cellLy; cellY <= cellHy; ++cellY) {
+            for (int32_t cellX = cellLx; cellX <= cellHx; ++cellX) {
+                const auto cellIter = grid.find(getGridCellKey(cellX, cellY));
+
+                if (cellIter == grid.end())
+                    continue;
+
+                for (const uint32_t otherIdx : cellIter->second) {
+                    if (lastEdgeChecked[otherIdx] == edgeIdx)
+                        continue;
+
+                    lastEdgeChecked[otherIdx] = edgeIdx;
+                    const LeafEdge& other = edges[otherIdx];
+
+                    if (other.leafIdx == edge.leafIdx)
+                        continue;
+
+                    // Must be along the same line
+                    const Vec2d offsetA = sub(other.a, edge.a);
+                    const Vec2d offsetB = sub(other.b, edge.a);
+                    const double acrossA = offsetA.x * edgeDir.y - offsetA.y * edgeDir.x;
+                    const double acrossB = offsetB.x * edgeDir.y - offsetB.y * edgeDir.x;
+
+                    if ((std::abs(acrossA) > EDGE_MATCH_TOLERANCE) || (std::abs(acrossB) > EDGE_MATCH_TOLERANCE))
+                        continue;
+
+                    // Must overlap or at least touch
+                    const double alongA = dot(offsetA, edgeDir);
+                    const double alongB = dot(offsetB, edgeDir);
+                    const double overlapBeg = std::max(0.0, std::min(alongA, alongB));
+                    const double overlapEnd = std::min(edgeLen, std::max(alongA, alongB));
+
+                    if (overlapEnd - overlapBeg < -EDGE_MATCH_TOLERANCE)
+                        continue;
+
+                    // Leaving this leaf the sight line crosses from the left of the edge to the right, so the point furthest along the
+                    // edge is on the left of the sight line.
+                    Portal portal;
+                    portal.lpt = madd(edge.a, edgeDir, overlapEnd + EDGE_MATCH_TOLERANCE);
+                    portal.rpt = madd(edge.a, edgeDir, overlapBeg - EDGE_MATCH_TOLERANCE);
+                    portal.toCell = other.leafIdx;
+                    portals.emplace_back(edge.leafIdx, portal);
+                    overlaps.push_back(Vec2d{ overlapBeg, overlapEnd });
+                }
+            }
+        }
+
+        // Find any parts of the edge not touching other leafs: these open out into the void
+        std::sort(overlaps.begin(), overlaps.end(), [](const Vec2d& o1, const Vec2d& o2) noexcept { return (o1.x < o2.x); });
+        double coveredEnd = 0.0;
+        overlaps.push_back(Vec2d{ edgeLen, edgeLen });
+
+        for (const Vec2d& overlap : overlaps) {
+            if (overlap.x - coveredEnd > EDGE_MATCH_TOLERANCE) {
+                const Vec2d gapBeg = madd(edge.a, edgeDir, coveredEnd - EDGE_MATCH_TOLERANCE);
+                const Vec2d gapEnd = madd(edge.a, edgeDir, overlap.x + EDGE_MATCH_TOLERANCE);
+                portals.emplace_back(edge.leafIdx, Portal{ gapEnd, gapBeg, gVoidCell });
+                portals.emplace_back(gVoidCell, Portal{ gapBeg, gapEnd, edge.leafIdx });
+                numVoidPortals++;
+            }
+
+            coveredEnd = std::max(coveredEnd, overlap.y);
+        }
+    }
+
+    if (numVoidPortals > MAX_VOID_PORTALS)
+        return false;
+
+    // Group the portals by the cell they are leaving
+    std::stable_sort(portals.begin(), portals.end(), [](const auto& p1, const auto& p2) noexcept { return (p1.first < p2.first); });
+
+    const int32_t numCells = gNumLeafs + 1;
+    gCellPortalsBeg.assign((size_t) numCells + 1, 0);
+    gPortals.clear();
+    gPortals.reserve(portals.size());
+
+    for (int32_t cellIdx = 0, portalIdx = 0; cellIdx < numCells; ++cellIdx) {
+        gCellPortalsBeg[cellIdx] = (uint32_t) gPortals.size();
+
+        while ((portalIdx < (int32_t) portals.size()) && (portals[portalIdx].first == cellIdx)) {
+            gPortals.push_back(portals[portalIdx].second);
+            ++portalIdx;
+        }
+    }
+
+    gCellPortalsBeg[numCells] = (uint32_t) gPortals.size();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Finds all the distinct lines that one sided walls lie on, and where other walls cross those lines.
+// Also records which leafs touch each line, and where.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void buildWallLines() noexcept {
+    struct Wall {
+        int64_t x1, y1, x2, y2;
+    };
+
+    struct LineKey {
+        int64_t dx, dy, c;
+
+        bool operator < (const LineKey& other) const noexcept {
+            if (dx != other.dx) return (dx < other.dx);
+            if (dy != other.dy) return (dy < other.dy);
+            return (c < other.c);
+        }
+
+        bool operator == (const LineKey& other) const noexcept {
+            return ((dx == other.dx) && (dy == other.dy) && (c == other.c));
+        }
+    };
+
+    // Gather all one sided walls with their (whole number) coordinates
+    std::vector<Wall> walls;
+
+    for (int32_t lineIdx = 0; lineIdx < gNumLines; ++lineIdx) {
+        const line_t& line = gpLines[lineIdx];
+
+        if (line.backsector)
+            continue;
+
+        const Wall wall = {
+            d_fixed_to_int(line.vertex1->x), d_fixed_to_int(line.vertex1->y),
+            d_fixed_to_int(line.vertex2->x), d_fixed_to_int(line.vertex2->y)
+        };
+
+        if ((wall.x1 != wall.x2) || (wall.y1 != wall.y2)) {
+            walls.push_back(wall);
+        }
+    }
+
+    // Figure out the distinct lines the walls lie on, in a normalized form
+    std::vector<std::pair<LineKey, uint32_t>> lineKeys;
+
+    for (uint32_t wallIdx = 0; wallIdx < (uint32_t) walls.size(); ++wallIdx) {
+        const Wall& wall = walls[wallIdx];
+        int64_t dx = wall.x2 - wall.x1;
+        int64_t dy = wall.y2 - wall.y1;
+
+        int64_t divisor = std::abs(dx);
+
+        for (int64_t b = std::abs(dy); b != 0;) {
+            const int64_t r = divisor % b;
+            divisor = b;
+            b = r;
+        }
+
+        dx /= divisor;
+        dy /= divisor;
+
+        if ((dx < 0) || ((dx == 0) && (dy < 0))) {
+            dx = -dx;
+            dy = -dy;
+        }
+
+        lineKeys.emplace_back(LineKey{ dx, dy, dx * wall.y1 - dy * wall.x1 }, wallIdx);
+    }
+
+    std::sort(lineKeys.begin(), lineKeys.end());
+    lineKeys.erase(
+        std::unique(lineKeys.begin(), lineKeys.end(), [](const auto& k1, const auto& k2) noexcept { return (k1.first == k2.first); }),
+        lineKeys.end()
+    );
+
+    // Build each line and find the walls which cross it, and the leafs which touch it
+    gWallLines.clear();
+    gWallLines.resize(lineKeys.size());
+
+    for (size_t lineIdx = 0; lineIdx < lineKeys.size(); ++lineIdx) {
+        const Wall& baseWall = walls[lineKeys[lineIdx].second];
+        const int64_t dx = baseWall.x2 - baseWall.x1;
+        const int64_t dy = baseWall.y2 - baseWall.y1;
+        const double len = std::sqrt((double)(dx * dx + dy * dy));
+
+        WallLine& wallLine = gWallLines[lineIdx];
+        wallLine.origin = Vec2d{ (double) baseWall.x1, (double) baseWall.y1 };
+        wallLine.dir = Vec2d{ (double) dx / len, (double) dy / len };
+
+        // Walls crossing the line: both endpoints must be strictly on opposite sides
+        for (const Wall& wall : walls) {
+            const int64_t side1 = dx * (wall.y1 - baseWall.y1) - dy * (wall.x1 - baseWall.x1);
+            const int64_t side2 = dx * (wall.y2 - baseWall.y1) - dy * (wall.x2 - baseWall.x1);
+
+            if (((side1 < 0) && (side2 > 0)) || ((side1 > 0) && (side2 < 0))) {
+                const double frac = (double) side1 / ((double) side1 - (double) side2);
+                const Vec2d crossPt = {
+                    (double) wall.x1 + (double)(wall.x2 - wall.x1) * frac,
+                    (double) wall.y1 + (double)(wall.y2 - wall.y1) * frac
+                };
+
+                wallLine.blockers.push_back(dot(sub(crossPt, wallLine.origin), wallLine.dir));
+            }
+        }
+
+        std::sort(wallLine.blockers.begin(), wallLine.blockers.end());
+
+        // Leafs touching the line
+        for (int32_t leafIdx = 0; leafIdx < gNumLeafs; ++leafIdx) {
+            if (!gbLeafUsable[leafIdx])
+                continue;
+
+            double tMin, tMax;
+
+            if (clipLineToBox(wallLine.origin, wallLine.dir, expandBox(gLeafBoxes[leafIdx], EDGE_MATCH_TOLERANCE), tMin, tMax)) {
+                wallLine.leafIdxs.push_back(leafIdx);
+                wallLine.leafRanges.push_back(Vec2d{ tMin, tMax });
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sets the PVS bit for the given source and destination leaf
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void setPvsBit(uint64_t* const pRow, const int32_t leafIdx) noexcept {
+    pRow[(uint32_t) leafIdx / 64] |= (uint64_t) 1 << ((uint32_t) leafIdx % 64);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Floods out from a source leaf through chains of portals that can be stabbed by a single line.
+//
+// Lines are parameterized in 4 'charts' covering all possible directions. In each chart the plane is rotated so that the line
+// direction is '(1, m)' with 'm' in the range -1 to 1, and the line passes through '(0, b)'. A point being on the left of the line then
+// gives an upper bound on 'b' and being on the right gives a lower bound, both linear in 'm'. A line exists if some 'm' keeps all the
+// upper bounds above all the lower bounds, which can be checked pairwise and narrowed down incrementally as portals are added.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class PortalFlooder {
+public:
+    PortalFlooder() noexcept
+        : mpRow(nullptr)
+        , mNumSteps(0)
+        , mbOutOfSteps(false)
+    {
+        mbCellOnStack.resize((size_t) gNumLeafs + 1);
+        mbPortalUsed.resize(gPortals.size());
+    }
+
+    // Floods out from the given start cell; the line must also pass through the given initial pair of left/right points
+    void flood(uint64_t* const pRow, const int32_t startCell, const Vec2d& initialLpt, const Vec2d& initialRpt) noexcept {
+        mpRow = pRow;
+
+        for (int32_t chart = 0; chart < 4; ++chart) {
+            mUppers[chart].clear();
+            mLowers[chart].clear();
+        }
+
+        ChartRanges ranges;
+
+        for (int32_t chart = 0; chart < 4; ++chart) {
+            ranges.lo[chart] = -1.0;
+            ranges.hi[chart] = +1.0;
+        }
+
+        if (!addConstraint(ranges, initialLpt, initialRpt))
+            return;
+
+        pushConstraint(initialLpt, initialRpt);
+        mbCellOnStack[startCell] = (startCell != gVoidCell);
+        floodFrom(startCell, ranges);
+        mbCellOnStack[startCell] = false;
+        popConstraint();
+    }
+
+    void resetSteps() noexcept {
+        mNumSteps = 0;
+        mbOutOfSteps = false;
+    }
+
+    bool isOutOfSteps() const noexcept { return mbOutOfSteps; }
+
+private:
+    struct ChartRanges {
+        double lo[4];
+        double hi[4];
+    };
+
+    static Vec2d rotateToChart(const int32_t chart, const Vec2d& pt) noexcept {
+        switch (chart) {
+            case 0:     return Vec2d{ +pt.x, +pt.y };   // Directions (+1, m)
+            case 1:     return Vec2d{ -pt.x, -pt.y };   // Directions (-1, m)
+            case 2:     return Vec2d{ +pt.y, -pt.x };   // Directions (m, +1)
+            default:    return Vec2d{ -pt.y, +pt.x };   // Directions (m, -1)
+        }
+    }
+
+    // Narrows the range of 'm' so that the given upper bound point stays above the given lower bound point
+    static void constrainPair(const Vec2d& upperPt, const Vec2d& lowerPt, double& lo, double& hi) noexcept {
+        const double a = lowerPt.x - upperPt.x;
+        const double b = lowerPt.y - upperPt.y - STAB_SLACK;
+
+        if (a > 1e-9) {
+            lo = std::max(lo, b / a);
+        } else if (a < -1e-9) {
+            hi = std::min(hi, b / a);
+        } else if (b > 0.0) {
+            lo = +INFINITY;
+        }
+    }
+
+    // Narrows the chart ranges with the given left/right point constraint; returns 'false' if no line can satisfy all constraints
+    bool addConstraint(ChartRanges& ranges, const Vec2d& lpt, const Vec2d& rpt) noexcept {
+        bool bFeasible = false;
+
+        for (int32_t chart = 0; chart < 4; ++chart) {
+            double lo = ranges.lo[chart];
+            double hi = ranges.hi[chart];
+
+            if (lo > hi)
+                continue;
+
+            const Vec2d upper = rotateToChart(chart, lpt);
+            const Vec2d lower = rotateToChart(chart, rpt);
+            constrainPair(upper, lower, lo, hi);
+
+            for (const Vec2d& otherLower : mLowers[chart]) {
+                if (lo > hi) break;
+                constrainPair(upper, otherLower, lo, hi);
+            }
+
+            for (const Vec2d& otherUpper : mUppers[chart]) {
+                if (lo > hi) break;
+                constrainPair(otherUpper, lower, lo, hi);
+            }
+
+            ranges.lo[chart] = lo;
+            ranges.hi[chart] = hi;
+            bFeasible |= (lo <= hi);
+        }
+
+        return bFeasible;
+    }
+
+    void pushConstraint(const Vec2d& lpt, const Vec2d& rpt) noexcept {
+        for (int32_t chart = 0; chart < 4; ++chart) {
+            mUppers[chart].push_back(rotateToChart(chart, lpt));
+            mLowers[chart].push_back(rotateToChart(chart, rpt));
+        }
+    }
+
+    void popConstraint() noexcept {
+        for (int32_t chart = 0; chart < 4; ++chart) {
+            mUppers[chart].pop_back();
+            mLowers[chart].pop_back();
+        }
+    }
+
+    void floodFrom(const int32_t cellIdx, const ChartRanges& ranges) noexcept {
+        const uint32_t portalsBeg = gCellPortalsBeg[cellIdx];
+        const uint32_t portalsEnd = gCellPortalsBeg[cellIdx + 1];
+
+        for (uint32_t portalIdx = portalsBeg; portalIdx < portalsEnd; ++portalIdx) {
+            // Stop if we've been going for too long
+            if (mNumSteps >= MAX_FLOOD_STEPS) {
+                mbOutOfSteps = true;
+                return;
+            }
+
+            mNumSteps++;
+
+            // A line can only pass through each convex leaf once; the void is not convex however so only limit portal reuse there
+            const Portal& portal = gPortals[portalIdx];
+
+            if (mbCellOnStack[portal.toCell] || mbPortalUsed[portalIdx])
+                continue;
+
+            ChartRanges newRanges = ranges;
+
+            if (!addConstraint(newRanges, portal.lpt, portal.rpt))
+                continue;
+
+            const bool bIsVoid = (portal.toCell == gVoidCell);
+
+            if (!bIsVoid) {
+                setPvsBit(mpRow, portal.toCell);
+            }
+
+            mbCellOnStack[portal.toCell] = (!bIsVoid);
+            mbPortalUsed[portalIdx] = true;
+            pushConstraint(portal.lpt, portal.rpt);
+            floodFrom(portal.toCell, newRanges);
+            popConstraint();
+            mbPortalUsed[portalIdx] = false;
+            mbCellOnStack[portal.toCell] = false;
+
+            if (mbOutOfSteps)
+                return;
+        }
+    }
+
+    uint64_t*               mpRow;
+    uint32_t                mNumSteps;
+    bool                    mbOutOfSteps;
+    std::vector<uint8_t>    mbCellOnStack;
+    std::vector<uint8_t>    mbPortalUsed;
+    std::vector<Vec2d>      mUppers[4];
+    std::vector<Vec2d>      mLowers[4];
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Marks leafs which can see the given source leaf via lines running exactly along one sided walls.
+// Such lines are not blocked by the walls they run along and can pass through the void outside of the map.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void markWallLineVisibility(uint64_t* const pRow, const Box2d& srcBox) noexcept {
+    for (const WallLine& wallLine : gWallLines) {
+        double srcMin, srcMax;
+
+        if (!clipLineToBox(wallLine.origin, wallLine.dir, srcBox, srcMin, srcMax))
+            continue;
+
+        const std::vector<double>& blockers = wallLine.blockers;
+
+        for (size_t i = 0; i < wallLine.leafIdxs.size(); ++i) {
+            const Vec2d dstRange = wallLine.leafRanges[i];
+
+            // Get the gap between the source and destination ranges, if any.
+            // Visible if no wall crosses the line strictly inside of that gap.
+            const double gapBeg = std::min(srcMax, dstRange.y) + STAB_SLACK;
+            const double gapEnd = std::max(srcMin, dstRange.x) - STAB_SLACK;
+            const auto blockerIter = std::upper_bound(blockers.begin(), blockers.end(), gapBeg);
+            const bool bBlocked = ((blockerIter != blockers.end()) && (*blockerIter < gapEnd));
+
+            if (!bBlocked) {
+                setPvsBit(pRow, wallLine.leafIdxs[i]);
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Computes the PVS row for one source leaf
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void buildPvsRow(PortalFlooder& flooder, const int32_t srcLeafIdx) noexcept {
+    uint64_t* const pRow = &gPvsBits[(size_t) srcLeafIdx * gRowNumWords];
+
+    // Leafs which can't be used for culling are treated as seeing everything
+    if (!gbLeafUsable[srcLeafIdx]) {
+        std::fill(pRow, pRow + gRowNumWords, ~(uint64_t) 0);
+        return;
+    }
+
+    // The start of the sight line might be anywhere near the source leaf, since crossed walls close to the start can be ignored.
+    // All leafs touching that area are trivially visible and are also where the flood starts from.
+    const Box2d srcBox = expandBox(gLeafBoxes[srcLeafIdx], NEAR_START_DIST);
+    std::vector<int32_t> startCells;
+
+    for (int32_t leafIdx = 0; leafIdx < gNumLeafs; ++leafIdx) {
+        if (gbLeafUsable[leafIdx] && boxesIntersect(srcBox, gLeafBoxes[leafIdx])) {
+            startCells.push_back(leafIdx);
+            setPvsBit(pRow, leafIdx);
+        }
+    }
+
+    if (gCellPortalsBeg[gVoidCell + 1] > gCellPortalsBeg[gVoidCell]) {
+        startCells.push_back(gVoidCell);
+    }
+
+    // The line must pass through the source area, which means crossing one of its diagonals (in either direction)
+    const Vec2d corners[4] = {
+        { srcBox.lx, srcBox.ly },
+        { srcBox.hx, srcBox.ly },
+        { srcBox.hx, srcBox.hy },
+        { srcBox.lx, srcBox.hy },
+    };
+
+    const Vec2d diagonals[4][2] = {
+        { corners[0], corners[2] },
+        { corners[2], corners[0] },
+        { corners[1], corners[3] },
+        { corners[3], corners[1] },
+    };
+
+    flooder.resetSteps();
+
+    for (const int32_t startCell : startCells) {
+        for (const auto& diagonal : diagonals) {
+            flooder.flood(pRow, startCell, diagonal[0], diagonal[1]);
+
+            if (flooder.isOutOfSteps()) {
+                std::fill(pRow, pRow + gRowNumWords, ~(uint64_t) 0);
+                return;
+            }
+        }
+    }
+
+    markWallLineVisibility(pRow, srcBox);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Job function for building the PVS: keeps building rows until there are no more leafs left to do.
+// There is one of these jobs per available job thread, so that each thread only needs to allocate one portal flooder.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void buildPvsJob([[maybe_unused]] void* const pCtx, [[maybe_unused]] const uint32_t jobIdx) noexcept {
+    PortalFlooder flooder;
+
+    while (true) {
+        const int32_t leafIdx = gNextBuildLeafIdx.fetch_add(1, std::memory_order_relaxed);
+
+        if (leafIdx >= gNumLeafs)
+            break;
+
+        buildPvsRow(flooder, leafIdx);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Computes the PVS for all leafs, spreading the work across the game's job worker threads (if running)
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void buildPvs() noexcept {
+    gPvsBits.assign((size_t) gNumLeafs * gRowNumWords, 0);
+    gNextBuildLeafIdx.store(0, std::memory_order_relaxed);
+    GameJobs::run(buildPvsJob, nullptr, GameJobs::getNumWorkers() + 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Computes a hash of all of the map geometry that the PVS depends on
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t computeGeometryHash() noexcept {
+    uint64_t hash = 0xCBF29CE484222325;
+
+    const auto addToHash = [&](const int64_t value) noexcept {
+        for (int32_t byteIdx = 0; byteIdx < 8; ++byteIdx) {
+            hash ^= (uint64_t)(value >> (byteIdx * 8)) & 0xFF;
+            hash *= 0x100000001B3;
+        }
+    };
+
+    addToHash(gNumSubsectors);
+    addToHash(gNumLines);
+    addToHash(gNumBspNodes);
+
+    for (int32_t leafIdx = 0; leafIdx < gNumSubsectors; ++leafIdx) {
+        const subsector_t& subsec = gpSubsectors[leafIdx];
+        addToHash(subsec.numLeafEdges);
+
+        for (int32_t edgeIdx = 0; edgeIdx < subsec.numLeafEdges; ++edgeIdx) {
+            const leafedge_t& edge = gpLeafEdges[subsec.firstLeafEdge + edgeIdx];
+            addToHash(edge.vertex->x);
+            addToHash(edge.vertex->y);
+            addToHash((edge.seg) ? (edge.seg->linedef - gpLines) : -1);
+        }
+    }
+
+    for (int32_t lineIdx = 0; lineIdx < gNumLines; ++lineIdx) {
+        const line_t& line = gpLines[lineIdx];
+        addToHash(line.vertex1->x);
+        addToHash(line.vertex1->y);
+        addToHash(line.vertex2->x);
+        addToHash(line.vertex2->y);
+        addToHash((line.backsector) ? 1 : 0);
+    }
+
+    return hash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the path to the PVS cache file for the current map
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::string getCacheFilePath() noexcept {
+    char fileName[64];
+    std::snprintf(fileName, sizeof(fileName), "sight_pvs_%016llx%016llx.bin", (unsigned long long) MapHash::gWord1, (unsigned long long) MapHash::gWord2);
+    return Utils::getOrCreateUserDataFolder() + fileName;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to load the PVS for the current map from the cache file, returning 'true' if successful
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool loadCachedPvs(const std::string& filePath, const uint64_t geometryHash) noexcept {
+    if (!FileUtils::fileExists(filePath.c_str()))
+        return false;
+
+    const FileData fileData = FileUtils::getContentsOfFile(filePath.c_str());
+    const size_t rowsSize = (size_t) gNumLeafs * gRowNumWords * sizeof(uint64_t);
+
+    if ((!fileData.bytes) || (fileData.size != sizeof(CacheFileHeader) + rowsSize))
+        return false;
+
+    CacheFileHeader header;
+    std::memcpy(&header, fileData.bytes.get(), sizeof(CacheFileHeader));
+
+    const bool bHeaderOk = (
+        (header.magic == CACHE_FILE_MAGIC) &&
+        (header.version == CACHE_FILE_VERSION) &&
+        (header.mapHashWord1 == MapHash::gWord1) &&
+        (header.mapHashWord2 == MapHash::gWord2) &&
+        (header.geometryHash == geometryHash) &&
+        (header.numSubsectors == (uint32_t) gNumLeafs) &&
+        (header.rowNumWords == gRowNumWords)
+    );
+
+    if (!bHeaderOk)
+        return false;
+
+    gPvsBits.resize((size_t) gNumLeafs * gRowNumWords);
+    std::memcpy(gPvsBits.data(), fileData.bytes.get() + sizeof(CacheFileHeader), rowsSize);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Saves the PVS for the current map to the cache file
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void saveCachedPvs(const std::string& filePath, const uint64_t geometryHash) noexcept {
+    CacheFileHeader header = {};
+    header.magic = CACHE_FILE_MAGIC;
+    header.version = CACHE_FILE_VERSION;
+    header.mapHashWord1 = MapHash::gWord1;
+    header.mapHashWord2 = MapHash::gWord2;
+    header.geometryHash = geometryHash;
+    header.numSubsectors = (uint32_t) gNumLeafs;
+    header.rowNumWords = gRowNumWords;
+
+    const size_t rowsSize = gPvsBits.size() * sizeof(uint64_t);
+    std::vector<std::byte> fileData(sizeof(CacheFileHeader) + rowsSize);
+    std::memcpy(fileData.data(), &header, sizeof(CacheFileHeader));
+    std::memcpy(fileData.data() + sizeof(CacheFileHeader), gPvsBits.data(), rowsSize);
+    FileUtils::writeDataToFile(filePath.c_str(), fileData.data(), fileData.size());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Sets up the sight PVS for the current map, loading it from the cache or building it if required.
+// Should be called once all map data has been loaded and patched.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void init() noexcept {
+    clearAll();
+
+    if ((!Config::gbUseSightPvs) || (!canUsePvsForMap()) || (!buildLeafPolygons())) {
+        clearAll();
+        return;
+    }
+
+    gRowNumWords = ((uint32_t) gNumLeafs + 63) / 64;
+    const uint64_t geometryHash = computeGeometryHash();
+    const std::string cacheFilePath = getCacheFilePath();
+
+    if (!loadCachedPvs(cacheFilePath, geometryHash)) {
+        if (!buildPortals()) {
+            clearAll();
+            return;
+        }
+
+        buildWallLines();
+        buildPvs();
+        saveCachedPvs(cacheFilePath, geometryHash);
+    }
+
+    // Don't need the data used for building anymore
+    gCellPortalsBeg = {};
+    gPortals = {};
+    gWallLines = {};
+    gbPvsValid = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees up the sight PVS
+//------------------------------------------------------------------------------------------------------------------------------------------
+void shutdown() noexcept {
+    clearAll();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if a (fixed point) point is inside the polygon of the given leaf
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool isPointInLeaf(const int32_t leafIdx, const fixed_t x, const fixed_t y) noexcept {
+    const double px = (double) x / (double) FRACUNIT;
+    const double py = (double) y / (double) FRACUNIT;
+    const uint32_t planesBeg = gLeafPlanesBeg[leafIdx];
+    const uint32_t planesEnd = gLeafPlanesBeg[leafIdx + 1];
+
+    for (uint32_t planeIdx = planesBeg; planeIdx < planesEnd; ++planeIdx) {
+        const EdgePlane& plane = gLeafPlanes[planeIdx];
+
+        if (plane.nx * px + plane.ny * py + plane.c < -1e-7)
+            return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if sight between the two given (masked) sight line points in the given subsectors is definitely blocked, according to the PVS.
+// If 'false' is returned then a full sight check still needs to be done.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isSightBlocked(const subsector_t& subsec1, const fixed_t x1, const fixed_t y1, const subsector_t& subsec2, const fixed_t x2, const fixed_t y2) noexcept {
+    if (!gbPvsValid)
+        return false;
+
+    const int32_t leafIdx1 = (int32_t)(&subsec1 - gpSubsectors);
+    const int32_t leafIdx2 = (int32_t)(&subsec2 - gpSubsectors);
+
+    if ((!gbLeafUsable[leafIdx1]) || (!gbLeafUsable[leafIdx2]))
+        return false;
+
+    const uint64_t rowWord = gPvsBits[(size_t) leafIdx1 * gRowNumWords + (uint32_t) leafIdx2 / 64];
+
+    if (rowWord & ((uint64_t) 1 << ((uint32_t) leafIdx2 % 64)))
+        return false;
+
+    // The PVS only holds for points that are actually inside the leaf polygons
+    return (isPointInLeaf(leafIdx1, x1, y1) && isPointInLeaf(leafIdx2, x2, y2));
+}
+
+END_NAMESPACE(SightPvs)
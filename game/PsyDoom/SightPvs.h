@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Doom/doomdef.h"
+#include "Macros.h"
+
+struct subsector_t;
+
+BEGIN_NAMESPACE(SightPvs)
+
+void init() noexcept;
+void shutdown() noexcept;
+bool isSightBlocked(const subsector_t& subsec1, const fixed_t x1, const fixed_t y1, const subsector_t& subsec2, const fixed_t x2, const fixed_t y2) noexcept;
+
+END_NAMESPACE(SightPvs)
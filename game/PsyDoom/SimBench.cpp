@@ -0,0 +1,341 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Simulation-only benchmark: measures the throughput of the game logic ('P_Ticker') with no rendering, audio or vblank pacing at all.
+//
+// The given map is loaded and optionally a synthetic 'horde' of monsters is spawned around the player, all of which are woken up and
+// targeting the player. The game then runs for a fixed number of ticks, with fixed (empty) inputs, as fast as possible and the time taken
+// for each tick is recorded. Since the inputs and starting state are always the same the simulation is deterministic, so the final state
+// hash (computed from the same player state used for demo results) can be used to verify that optimizations did not change behavior.
+// The results are written to a json file once the benchmark finishes, along with a report on memory zone usage during the run.
+// Texture cache activity is also reported, though since nothing is rendered this only covers the textures cached by loading the level.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "SimBench.h"
+
+#include "DemoResult.h"
+#include "Doom/d_main.h"
+#include "Doom/Base/i_main.h"
+#include "Doom/Base/i_texcache.h"
+#include "Doom/Base/z_zone.h"
+#include "Doom/Game/g_game.h"
+#include "Doom/Game/info.h"
+#include "Doom/Game/p_local.h"
+#include "Doom/Game/p_map.h"
+#include "Doom/Game/p_mobj.h"
+#include "Doom/Game/p_sight.h"
+#include "Doom/Game/p_tick.h"
+#include "Finally.h"
+#include "Game.h"
+#include "ProgArgs.h"
+#include "TexCacheStats.h"
+#include "ZoneStats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <rapidjson/document.h>
+#include <rapidjson/filewritestream.h>
+#include <rapidjson/prettywriter.h>
+#include <vector>
+
+BEGIN_NAMESPACE(SimBench)
+
+typedef std::chrono::steady_clock Clock;
+
+// The maximum number of rings of spawn positions to try around the player when spawning the horde
+static constexpr int32_t MAX_HORDE_SPAWN_RINGS = 64;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts a duration to microseconds
+//------------------------------------------------------------------------------------------------------------------------------------------
+static double toMicroseconds(const Clock::duration duration) noexcept {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tries to spawn a horde monster at the given position.
+// The spot must have room for the monster and be within sight of the player, so that the monster is in the same area as the player.
+// Returns 'true' if the monster was spawned.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool trySpawnHordeMonster(mobj_t& playerMobj, const fixed_t x, const fixed_t y, const mobjtype_t type) noexcept {
+    mobj_t* const pMobj = P_SpawnMobj(x, y, ONFLOORZ, type);
+
+    if ((!P_CheckPosition(*pMobj, x, y)) || (!P_CheckSight(*pMobj, playerMobj))) {
+        P_RemoveMobj(*pMobj);
+        return false;
+    }
+
+    // Wake up the monster and have it chase the player immediately
+    const mobjinfo_t& info = gMobjInfo[type];
+    pMobj->target = &playerMobj;
+
+    if (info.seestate != S_NULL) {
+        P_SetMobjState(*pMobj, info.seestate);
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Spawns up to the given number of monsters around the player in a grid, expanding outwards in rings until all are spawned.
+// Returns the number of monsters that were actually spawned.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t spawnHorde(const int32_t numMonsters, const mobjtype_t type) noexcept {
+    mobj_t& playerMobj = *gPlayers[0].mo;
+    const fixed_t spacing = gMobjInfo[type].radius * 2 + 8 * FRACUNIT;
+    int32_t numSpawned = 0;
+
+    for (int32_t ring = 1; (ring <= MAX_HORDE_SPAWN_RINGS) && (numSpawned < numMonsters); ++ring) {
+        for (int32_t gridY = -ring; (gridY <= ring) && (numSpawned < numMonsters); ++gridY) {
+            for (int32_t gridX = -ring; (gridX <= ring) && (numSpawned < numMonsters); ++gridX) {
+                // Only consider cells on the edge of this ring, the inner cells were done by previous rings
+                if ((std::abs(gridX) != ring) && (std::abs(gridY) != ring))
+                    continue;
+
+                const fixed_t x = playerMobj.x + gridX * spacing;
+                const fixed_t y = playerMobj.y + gridY * spacing;
+
+                if (trySpawnHordeMonster(playerMobj, x, y, type)) {
+                    numSpawned++;
+                }
+            }
+        }
+    }
+
+    return numSpawned;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Hashes the position, health and state of all map objects in the level.
+// This complements the demo result hash, which only covers the player: monster behavior matters a lot for the simulation benchmark.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t computeMobjsHash(int32_t& numMobjsOut) noexcept {
+    uint64_t hash = 0xCBF29CE484222325ull;
+    int32_t numMobjs = 0;
+
+    const auto addToHash = [&](const int32_t value) noexcept {
+        for (uint32_t byteIdx = 0; byteIdx < 4; ++byteIdx) {
+            hash ^= (uint8_t)((uint32_t) value >> (byteIdx * 8));
+            hash *= 0x100000001B3ull;
+        }
+    };
+
+    for (const mobj_t* pMobj = gMobjHead.next; pMobj != &gMobjHead; pMobj = pMobj->next) {
+        addToHash(pMobj->x.value);
+        addToHash(pMobj->y.value);
+        addToHash(pMobj->z.value);
+        addToHash(pMobj->type);
+        addToHash(pMobj->health);
+        addToHash((int32_t)(pMobj->state - gStates));
+        addToHash(pMobj->tics);
+        numMobjs++;
+    }
+
+    numMobjsOut = numMobjs;
+    return hash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Saves the benchmark results to the given json file and also prints a short summary of them.
+// Returns 'false' on failure to save.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool saveResults(
+    const char* const jsonFilePath,
+    const int32_t numHordeMonsters,
+    const zonestats_t& zoneStartStats,
+    const ZoneStats::Snapshot& zoneStartSnapshot,
+    const texcachestats_t& texCacheStartStats,
+    std::vector<Clock::duration>& tickTimes,
+    const uint64_t stateHash,
+    const uint64_t mobjsHash,
+    const int32_t numMobjs
+) noexcept {
+    // Compute the tick time stats
+    Clock::duration totalTime = {};
+
+    for (const Clock::duration tickTime : tickTimes) {
+        totalTime += tickTime;
+    }
+
+    const size_t numTicks = tickTimes.size();
+    const double totalSeconds = std::chrono::duration<double>(totalTime).count();
+    const double ticksPerSecond = (totalSeconds > 0.0) ? (double) numTicks / totalSeconds : 0.0;
+    std::sort(tickTimes.begin(), tickTimes.end());
+
+    const auto getPercentileUsec = [&](const double percentile) noexcept {
+        if (numTicks <= 0)
+            return 0.0;
+
+        const size_t idx = std::min((size_t)(percentile * (double)(numTicks - 1) + 0.5), numTicks - 1);
+        return toMicroseconds(tickTimes[idx]);
+    };
+
+    std::printf(
+        "Simulation benchmark: %llu ticks in %.3f seconds (%.1f ticks/sec), %d horde monsters, state hash %016llX, mobjs hash %016llX\n",
+        (unsigned long long) numTicks,
+        totalSeconds,
+        ticksPerSecond,
+        numHordeMonsters,
+        (unsigned long long) stateHash,
+        (unsigned long long) mobjsHash
+    );
+
+    // Create the json document
+    rapidjson::Document document;
+    rapidjson::Document::AllocatorType& allocator = document.GetAllocator();
+    document.SetObject();
+
+    document.AddMember("map", ProgArgs::gSimBenchMap, allocator);
+    document.AddMember("skill", (int32_t) ProgArgs::gWarpSkill, allocator);
+    document.AddMember("hordeType", ProgArgs::gSimBenchHordeType, allocator);
+    document.AddMember("hordeSizeRequested", ProgArgs::gSimBenchHordeSize, allocator);
+    document.AddMember("hordeSizeSpawned", numHordeMonsters, allocator);
+    document.AddMember("numTicks", (uint64_t) numTicks, allocator);
+    document.AddMember("totalSec", totalSeconds, allocator);
+    document.AddMember("ticksPerSec", ticksPerSecond, allocator);
+
+    {
+        rapidjson::Value tickTimesJson(rapidjson::kObjectType);
+        tickTimesJson.AddMember("minUsec", getPercentileUsec(0.0), allocator);
+        tickTimesJson.AddMember("medianUsec", getPercentileUsec(0.5), allocator);
+        tickTimesJson.AddMember("p99Usec", getPercentileUsec(0.99), allocator);
+        tickTimesJson.AddMember("maxUsec", getPercentileUsec(1.0), allocator);
+        tickTimesJson.AddMember("avgUsec", (numTicks > 0) ? toMicroseconds(totalTime) / (double) numTicks : 0.0, allocator);
+        document.AddMember("tickTimes", tickTimesJson, allocator);
+    }
+
+    document.AddMember("stateHash", stateHash, allocator);
+    document.AddMember("mobjsHash", mobjsHash, allocator);
+    document.AddMember("numMobjs", numMobjs, allocator);
+    document.AddMember("zone", ZoneStats::mainZoneToJson(zoneStartStats, zoneStartSnapshot, numTicks, allocator), allocator);
+    document.AddMember("texCache", TexCacheStats::toJson(texCacheStartStats, numTicks, allocator), allocator);
+
+    // Write the result to the given file
+    std::FILE* const pFile = std::fopen(jsonFilePath, "w");
+
+    if (!pFile)
+        return false;
+
+    auto closeFile = finally([&]() noexcept {
+        std::fflush(pFile);
+        std::fclose(pFile);
+    });
+
+    try {
+        char writeBuffer[4096];
+        rapidjson::FileWriteStream writeStream(pFile, writeBuffer, C_ARRAY_SIZE(writeBuffer));
+        rapidjson::PrettyWriter<rapidjson::FileWriteStream> fileWriter(writeStream);
+        document.Accept(fileWriter);
+    } catch (...) {
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Runs the simulation benchmark as specified by the program arguments and saves the results.
+// Returns 'false' if the benchmark could not be run or the results could not be saved.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool run() noexcept {
+    // Validate the benchmark settings
+    const int32_t mapNum = ProgArgs::gSimBenchMap;
+    const int32_t numTicks = ProgArgs::gSimBenchNumTicks;
+
+    if ((mapNum < 1) || (mapNum > Game::getNumMaps())) {
+        std::printf("Simulation benchmark: invalid map number %d!\n", mapNum);
+        return false;
+    }
+
+    const bool bSpawnHorde = (ProgArgs::gSimBenchHordeSize > 0);
+
+    if (bSpawnHorde && ((ProgArgs::gSimBenchHordeType < 0) || (ProgArgs::gSimBenchHordeType >= gNumMobjInfo))) {
+        std::printf("Simulation benchmark: invalid horde map object type %d!\n", ProgArgs::gSimBenchHordeType);
+        return false;
+    }
+
+    // Load the level, using the same flow as regular gameplay.
+    // Note the texture cache activity totals beforehand, so that the textures cached by loading the level are included in the report.
+    const texcachestats_t texCacheStartStats = gTexCacheStats;
+    G_InitNew(ProgArgs::gWarpSkill, mapNum, gt_single);
+    G_DoLoadLevel();
+
+    // Do the same setup as the main game loop and level start
+    gGameAction = ga_nothing;
+    gPrevGameTic = 0;
+    gGameTic = 0;
+    gTicCon = 0;
+    gLastTgtGameTicCount = 0;
+    gbIsFirstTick = true;
+    gbAutoSaveOnLevelStart = false;
+    D_UpdateIsLongGameTick();
+    P_Start();
+
+    // Spawn the horde if requested.
+    // Make the player invulnerable in this case, so that the horde keeps attacking for the entire benchmark.
+    int32_t numHordeMonsters = 0;
+
+    if (bSpawnHorde) {
+        numHordeMonsters = spawnHorde(ProgArgs::gSimBenchHordeSize, (mobjtype_t) ProgArgs::gSimBenchHordeType);
+        gPlayers[0].cheats |= CF_GODMODE;
+    }
+
+    // Note the state of the memory zone before the run starts
+    zonestats_t zoneStartStats = {};
+    Z_GetStats(*gpMainMemZone, zoneStartStats);
+    const ZoneStats::Snapshot zoneStartSnapshot = ZoneStats::takeSnapshot();
+
+    // Run the requested number of ticks with no inputs, as fast as possible
+    const int32_t vblanksPerTick = (Game::gSettings.bUsePalTimings) ? 3 : VBLANKS_PER_TIC;
+
+    std::vector<Clock::duration> tickTimes;
+    tickTimes.reserve((size_t) std::max(numTicks, 0));
+    gameaction_t exitAction = ga_nothing;
+
+    for (int32_t tickIdx = 0; tickIdx < numTicks; ++tickIdx) {
+        gOldTickInputs[0] = gTickInputs[0];
+        gTickInputs[0].reset();
+        gElapsedVBlanks = vblanksPerTick;
+        gPlayersElapsedVBlanks[0] = vblanksPerTick;
+        gTicCon += vblanksPerTick;
+        gLastTgtGameTicCount++;
+        gGameTic++;
+        D_UpdateIsLongGameTick();
+
+        const Clock::time_point tickStartTime = Clock::now();
+        exitAction = P_Ticker();
+        tickTimes.push_back(Clock::now() - tickStartTime);
+
+        gPrevGameTic = gGameTic;
+        gbIsFirstTick = false;
+
+        // Stop early if the level was exited for some reason
+        if (exitAction != ga_nothing)
+            break;
+    }
+
+    // Compute the final state hashes and save the results before cleaning up the level
+    const uint64_t stateHash = DemoResult::computeStateHash();
+    int32_t numMobjs = 0;
+    const uint64_t mobjsHash = computeMobjsHash(numMobjs);
+
+    const bool bSavedResults = saveResults(
+        ProgArgs::gSimBenchResultFilePath,
+        numHordeMonsters,
+        zoneStartStats,
+        zoneStartSnapshot,
+        texCacheStartStats,
+        tickTimes,
+        stateHash,
+        mobjsHash,
+        numMobjs
+    );
+
+    P_Stop(exitAction);
+
+    if (!bSavedResults) {
+        std::printf("Simulation benchmark: failed to save the results to '%s'!\n", ProgArgs::gSimBenchResultFilePath);
+    }
+
+    return bSavedResults;
+}
+
+END_NAMESPACE(SimBench)
@@ -0,0 +1,9 @@
+#pragma once
+
+#include "Macros.h"
+
+BEGIN_NAMESPACE(SimBench)
+
+bool run() noexcept;
+
+END_NAMESPACE(SimBench)
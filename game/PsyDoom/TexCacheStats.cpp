@@ -0,0 +1,34 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helpers for reporting on texture cache activity: converts texture cache statistics to json for the timedemo and simulation benchmark
+// results. These reports help to spot levels that thrash the cache or overflow it, and show how much texture data is sent to VRAM.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "TexCacheStats.h"
+
+#include "Doom/Base/i_texcache.h"
+
+BEGIN_NAMESPACE(TexCacheStats)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes a json report on texture cache activity over a run of the given number of ticks.
+// The statistics at the start of the run are given, and the current statistics are used as the statistics at the end of the run.
+//------------------------------------------------------------------------------------------------------------------------------------------
+rapidjson::Value toJson(const texcachestats_t& startStats, const uint64_t numTicks, rapidjson::Document::AllocatorType& allocator) noexcept {
+    const texcachestats_t& endStats = gTexCacheStats;
+    const uint64_t numUploads = endStats.numUploads - startStats.numUploads;
+    const uint64_t numBytesUploaded = endStats.numBytesUploaded - startStats.numBytesUploaded;
+
+    rapidjson::Value jsonObj(rapidjson::kObjectType);
+    jsonObj.AddMember("numUploads", numUploads, allocator);
+    jsonObj.AddMember("numBytesUploaded", numBytesUploaded, allocator);
+    jsonObj.AddMember("numEvictions", endStats.numEvictions - startStats.numEvictions, allocator);
+    jsonObj.AddMember("numOverflows", endStats.numOverflows - startStats.numOverflows, allocator);
+    jsonObj.AddMember("numDecodedPoolHits", endStats.numDecodedPoolHits - startStats.numDecodedPoolHits, allocator);
+    jsonObj.AddMember("maxSearchLength", endStats.maxSearchLen, allocator);
+    jsonObj.AddMember("numPagesInUse", I_GetNumTexCachePagesInUse(), allocator);
+    jsonObj.AddMember("numPages", I_GetNumTexCachePages(), allocator);
+    jsonObj.AddMember("uploadsPerTick", (numTicks > 0) ? (double) numUploads / (double) numTicks : 0.0, allocator);
+    jsonObj.AddMember("bytesUploadedPerTick", (numTicks > 0) ? (double) numBytesUploaded / (double) numTicks : 0.0, allocator);
+    return jsonObj;
+}
+
+END_NAMESPACE(TexCacheStats)
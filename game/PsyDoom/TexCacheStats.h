@@ -0,0 +1,14 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstdint>
+#include <rapidjson/document.h>
+
+struct texcachestats_t;
+
+BEGIN_NAMESPACE(TexCacheStats)
+
+rapidjson::Value toJson(const texcachestats_t& startStats, const uint64_t numTicks, rapidjson::Document::AllocatorType& allocator) noexcept;
+
+END_NAMESPACE(TexCacheStats)
@@ -10,9 +10,28 @@
 #include "Doom/Renderer/r_data.h"
 
 #include <md5.h>
+#include <vector>
 
 BEGIN_NAMESPACE(TexturePatcher)
 
+// Describes a patch for a texture: which lump it applies to, the expected hash of the unpatched data and the function which patches it
+struct TexPatch {
+    const char* lumpName;
+    uint64_t    md5Word1;
+    uint64_t    md5Word2;
+    void        (*patchFunc)(const texdata_t texData) noexcept;
+};
+
+// A lump in the main WADs which may need patching, and the patch to apply to it
+struct PatchableLump {
+    int32_t             lumpIdx;
+    const TexPatch*     pPatch;
+};
+
+// All lumps in the main WADs which may need patching.
+// These are found once on startup so that patch lookups when textures are loaded don't need to check lump names.
+static std::vector<PatchableLump> gPatchableLumps;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Verifies that the data for the given texture has the expected MD5 hash
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -42,9 +61,10 @@ static bool md5HashMatches(const texdata_t texData, const uint64_t expectedMd5Wo
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Doom: patches the 'GRATE' floor/ceiling texture to fix unintended holes in it
 //------------------------------------------------------------------------------------------------------------------------------------------
-void patchTex_GRATE(const texture_t& tex, const texdata_t texData) noexcept {
+void patchTex_GRATE(const texdata_t texData) noexcept {
+    const texlump_header_t& texHeader = *(const texlump_header_t*) texData.pBytes;
     uint8_t* const pTexPixels = (uint8_t*)(texData.pBytes + sizeof(texlump_header_t));
-    const int32_t numTexPixels = tex.width * tex.height;
+    const int32_t numTexPixels = Endian::littleToHost(texHeader.width) * Endian::littleToHost(texHeader.height);
 
     for (int32_t i = 0; i < numTexPixels; ++i) {
         // Replace transparent pixels with black pixels
@@ -57,35 +77,68 @@ void patchTex_GRATE(const texture_t& tex, const texdata_t texData) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Final Doom: patches the 'STATUS' texture to fix unintended pixels on the keycards
 //------------------------------------------------------------------------------------------------------------------------------------------
-void patchTex_FinalDoom_STATUS([[maybe_unused]] const texture_t& tex, const texdata_t texData) noexcept {
+void patchTex_FinalDoom_STATUS(const texdata_t texData) noexcept {
     uint8_t* const pTexPixels = (uint8_t*)(texData.pBytes + sizeof(texlump_header_t));
     pTexPixels[49031] = 0;
     pTexPixels[49032] = 0;
 }
 
+// All of the texture patches available
+static constexpr TexPatch TEX_PATCHES[] = {
+    { "GRATE",  0x57EC4B1EF4567271, 0xA097852AE0E5C725, patchTex_GRATE },
+    { "STATUS", 0xD35CCD07913A9366, 0xC1B0D65C90757FAA, patchTex_FinalDoom_STATUS },
+};
+
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Applies patches to the specified texture, if appropriate
+// Finds all the lumps in the main WADs which may need patching.
+// Must be called after the WAD system has been initialized and before any textures are loaded or decompressed.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void applyTexturePatches(const texture_t& tex, const texdata_t texData) noexcept {
+void init() noexcept {
+    gPatchableLumps.clear();
+    const int32_t numLumps = W_NumLumps();
+
+    for (int32_t lumpIdx = 0; lumpIdx < numLumps; ++lumpIdx) {
+        // Get the lump name and remove the compressed flag from the first character
+        WadLumpName lumpName = W_GetLumpName(lumpIdx);
+        lumpName.chars[0] &= 0x7F;
+
+        for (const TexPatch& patch : TEX_PATCHES) {
+            if (lumpName == patch.lumpName) {
+                gPatchableLumps.push_back({ lumpIdx, &patch });
+                break;
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Applies patches to the given decompressed data for the specified texture lump, if appropriate
+//------------------------------------------------------------------------------------------------------------------------------------------
+void applyLumpPatches(const int32_t lumpIdx, const texdata_t texData) noexcept {
     // Only apply texture patches if visual map patches are enabled
     if (!Config::gbEnableMapPatches_Visual)
         return;
 
-    // Get the lump name and remove the compressed flag from the first character
-    WadLumpName lumpName = W_GetLumpName(tex.lumpNum);
-    lumpName.chars[0] &= 0x7F;
+    // Patch this lump? Only patch if the data is the original unpatched data that the patch expects.
+    for (const PatchableLump& patchableLump : gPatchableLumps) {
+        if (patchableLump.lumpIdx != lumpIdx)
+            continue;
 
-    // Patch this texture?
-    if (lumpName == "GRATE") {
-        if (md5HashMatches(texData, 0x57EC4B1EF4567271, 0xA097852AE0E5C725)) {
-            patchTex_GRATE(tex, texData);
-        }
-    } 
-    else if (lumpName == "STATUS") {
-        if (md5HashMatches(texData, 0xD35CCD07913A9366, 0xC1B0D65C90757FAA)) {
-            patchTex_FinalDoom_STATUS(tex, texData);
+        const TexPatch& patch = *patchableLump.pPatch;
+
+        if (md5HashMatches(texData, patch.md5Word1, patch.md5Word2)) {
+            patch.patchFunc(texData);
         }
+
+        break;
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Applies patches to the specified texture, if appropriate
+//------------------------------------------------------------------------------------------------------------------------------------------
+void applyTexturePatches(const texture_t& tex, const texdata_t texData) noexcept {
+    applyLumpPatches(tex.lumpNum, texData);
+}
+
 END_NAMESPACE(TexturePatcher)
@@ -2,11 +2,15 @@
 
 #include "Macros.h"
 
+#include <cstdint>
+
 struct texture_t;
 struct texdata_t;
 
 BEGIN_NAMESPACE(TexturePatcher)
 
+void init() noexcept;
+void applyLumpPatches(const int32_t lumpIdx, const texdata_t texData) noexcept;
 void applyTexturePatches(const texture_t& tex, const texdata_t texData) noexcept;
 
 END_NAMESPACE(TexturePatcher)
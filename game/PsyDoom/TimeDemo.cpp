@@ -0,0 +1,346 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Timedemo benchmark mode: plays back a demo as fast as possible (without waiting for vblanks) and measures how long it takes.
+//
+// The overall wall time, the number of game ticks and frames, a histogram of frame times and the time spent in certain key game
+// subsystems are all recorded. The results are written to a json file once the demo finishes, so they can be compared between builds.
+// Rendering is optional: when used together with '-headless' only the game simulation is measured.
+// With '-headlessrender' frames are still rendered with the classic renderer but never displayed, so rendering can be measured without a display.
+// Hashes of the displayed frame can also be saved at regular tick intervals, when the classic renderer is in use, to check for rendering changes.
+// Memory zone usage at the start and end of the demo, and the allocation rate during it, are also reported along with texture cache activity.
+// With the Vulkan renderer, peak usage of the vertex buffers used for drawing is reported too.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "TimeDemo.h"
+
+#include "Doom/Base/i_texcache.h"
+#include "Doom/Base/z_zone.h"
+#include "Finally.h"
+#include "Gpu.h"
+#include "ProgArgs.h"
+#include "PsxVm.h"
+#include "TexCacheStats.h"
+#include "Video.h"
+#include "ZoneStats.h"
+
+#if PSYDOOM_VULKAN_RENDERER
+    #include "Vulkan/VDrawing.h"
+    #include "Vulkan/VVertexBufferSet.h"
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+#include <rapidjson/document.h>
+#include <rapidjson/filewritestream.h>
+#include <rapidjson/prettywriter.h>
+
+BEGIN_NAMESPACE(TimeDemo)
+
+// Number of buckets in the frame time histogram.
+// Bucket 'N' holds frames taking '2^N' to '2^(N+1)' microseconds, with the first and last buckets also holding faster and slower frames.
+static constexpr uint32_t NUM_HISTOGRAM_BUCKETS = 24;
+
+// Names for each section in the json output
+static constexpr const char* SECTION_NAMES[] = {
+    "P_RunThinkers",
+    "P_CheckSights",
+    "RenderPlayerView",
+    "I_DrawPresent"
+};
+
+static_assert(C_ARRAY_SIZE(SECTION_NAMES) == (size_t) Section::NUM_SECTIONS);
+
+// Timing stats for a single game subsystem
+struct SectionStats {
+    Clock::duration     totalTime;      // Total time spent in the section
+    uint64_t            numCalls;       // Number of times the section was entered
+};
+
+// A hash of the frame being displayed at a particular tick of the timedemo
+struct FrameHash {
+    uint64_t    tick;
+    uint64_t    hash;
+};
+
+bool gbIsTiming;    // True if a timedemo is currently being timed
+
+static Clock::time_point    gStartTime;                                     // When timing started
+static Clock::time_point    gFrameStartTime;                                // When timing of the current frame started
+static Clock::duration      gTotalTime;                                     // Total time elapsed for the timedemo, once finished
+static Clock::duration      gMinFrameTime;                                  // Shortest frame time
+static Clock::duration      gMaxFrameTime;                                  // Longest frame time
+static uint64_t             gNumFrames;                                     // Number of frames run
+static uint64_t             gNumTicks;                                      // Number of game ticks run
+static uint64_t             gFrameTimeHistogram[NUM_HISTOGRAM_BUCKETS];     // Number of frames falling into each frame time bucket
+static SectionStats         gSectionStats[(size_t) Section::NUM_SECTIONS];  // Time spent in each of the game subsystems being timed
+static zonestats_t          gZoneStartStats;                                // Memory zone usage when timing started
+static ZoneStats::Snapshot  gZoneStartSnapshot;                             // Memory zone allocation totals when timing started
+static texcachestats_t      gTexCacheStartStats;                            // Texture cache activity totals when timing started
+static uint64_t             gNextFrameHashTick;                             // The tick at which to save the next frame hash, if saving them
+
+// Hashes of the frames displayed at regular tick intervals, if saving them
+static std::vector<FrameHash> gFrameHashes;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts a duration to seconds or microseconds
+//------------------------------------------------------------------------------------------------------------------------------------------
+static double toSeconds(const Clock::duration duration) noexcept {
+    return std::chrono::duration<double>(duration).count();
+}
+
+static double toMicroseconds(const Clock::duration duration) noexcept {
+    return std::chrono::duration<double, std::micro>(duration).count();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Figures out which histogram bucket a frame with the given duration goes into
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint32_t getHistogramBucket(const Clock::duration frameTime) noexcept {
+    uint64_t frameUsec = (uint64_t) std::chrono::duration_cast<std::chrono::microseconds>(frameTime).count();
+    uint32_t bucketIdx = 0;
+
+    while ((frameUsec > 1) && (bucketIdx + 1 < NUM_HISTOGRAM_BUCKETS)) {
+        frameUsec >>= 1;
+        bucketIdx++;
+    }
+
+    return bucketIdx;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes a 64-bit FNV-1a hash of the area of PSX VRAM currently being displayed
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t hashDisplayedFrame() noexcept {
+    const Gpu::Core& gpu = PsxVm::gGpu;
+    uint64_t hash = 0xCBF29CE484222325ull;
+
+    for (uint32_t y = 0; y < gpu.displayAreaH; ++y) {
+        const uint16_t* const pRow = gpu.pRam + (size_t)(gpu.displayAreaY + y) * gpu.ramPixelW + gpu.displayAreaX;
+
+        for (uint32_t x = 0; x < gpu.displayAreaW; ++x) {
+            hash ^= pRow[x];
+            hash *= 0x100000001B3ull;
+        }
+    }
+
+    return hash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Starts timing a timedemo, clearing any previous results.
+// Should be called once the demo has finished loading and is about to start running.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void begin() noexcept {
+    Z_GetStats(*gpMainMemZone, gZoneStartStats);
+    gZoneStartSnapshot = ZoneStats::takeSnapshot();
+    gTexCacheStartStats = gTexCacheStats;
+
+    #if PSYDOOM_VULKAN_RENDERER
+        VDrawing::resetVertexBufferStats();
+    #endif
+
+    gStartTime = Clock::now();
+    gFrameStartTime = gStartTime;
+    gTotalTime = {};
+    gMinFrameTime = Clock::duration::max();
+    gMaxFrameTime = {};
+    gNumFrames = 0;
+    gNumTicks = 0;
+
+    for (uint64_t& bucket : gFrameTimeHistogram) {
+        bucket = 0;
+    }
+
+    for (SectionStats& stats : gSectionStats) {
+        stats = {};
+    }
+
+    gNextFrameHashTick = (uint64_t) ProgArgs::gFrameHashInterval;
+    gFrameHashes.clear();
+    gbIsTiming = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records the end of a frame of the game loop, which ran the specified number of game ticks
+//------------------------------------------------------------------------------------------------------------------------------------------
+void endFrame(const int32_t numTicks) noexcept {
+    if (!gbIsTiming)
+        return;
+
+    const Clock::time_point now = Clock::now();
+    const Clock::duration frameTime = now - gFrameStartTime;
+    gFrameStartTime = now;
+
+    gMinFrameTime = std::min(gMinFrameTime, frameTime);
+    gMaxFrameTime = std::max(gMaxFrameTime, frameTime);
+    gFrameTimeHistogram[getHistogramBucket(frameTime)]++;
+    gNumFrames++;
+    gNumTicks += (numTicks > 0) ? (uint64_t) numTicks : 0;
+
+    // Save a hash of the frame just displayed if another frame hash interval has passed.
+    // Only the classic renderer outputs frames to PSX VRAM, so nothing can be hashed with the Vulkan renderer.
+    if ((ProgArgs::gFrameHashInterval > 0) && (gNumTicks >= gNextFrameHashTick)) {
+        if (!Video::isUsingVulkanRenderPath()) {
+            gFrameHashes.push_back({ gNumTicks, hashDisplayedFrame() });
+        }
+
+        gNextFrameHashTick = gNumTicks + (uint64_t) ProgArgs::gFrameHashInterval;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stops timing the timedemo, if it is being timed
+//------------------------------------------------------------------------------------------------------------------------------------------
+void end() noexcept {
+    if (!gbIsTiming)
+        return;
+
+    gTotalTime = Clock::now() - gStartTime;
+    gbIsTiming = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds time spent in the specified game subsystem to the timedemo results
+//------------------------------------------------------------------------------------------------------------------------------------------
+void addSectionTime(const Section section, const Clock::duration duration) noexcept {
+    SectionStats& stats = gSectionStats[(size_t) section];
+    stats.totalTime += duration;
+    stats.numCalls++;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Save the results of the last timedemo to the given json file and also print a short summary of them.
+// Returns 'false' on failure to save.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool saveToJsonFile(const char* const jsonFilePath) noexcept {
+    // Print a summary of the results first
+    const double totalSeconds = toSeconds(gTotalTime);
+    const double ticksPerSecond = (totalSeconds > 0.0) ? (double) gNumTicks / totalSeconds : 0.0;
+    const double framesPerSecond = (totalSeconds > 0.0) ? (double) gNumFrames / totalSeconds : 0.0;
+
+    std::printf(
+        "Timedemo: %llu ticks and %llu frames in %.3f seconds (%.1f ticks/sec, %.1f frames/sec)\n",
+        (unsigned long long) gNumTicks,
+        (unsigned long long) gNumFrames,
+        totalSeconds,
+        ticksPerSecond,
+        framesPerSecond
+    );
+
+    // Create the json document and add the overall results
+    rapidjson::Document document;
+    rapidjson::Document::AllocatorType& allocator = document.GetAllocator();
+    document.SetObject();
+
+    document.AddMember("demoFile", rapidjson::Value(ProgArgs::gPlayDemoFilePath, allocator), allocator);
+    document.AddMember("headless", ProgArgs::gbHeadlessMode, allocator);
+    document.AddMember("headlessRender", ProgArgs::gbHeadlessRender, allocator);
+    document.AddMember("totalWallTimeSec", totalSeconds, allocator);
+    document.AddMember("numTicks", gNumTicks, allocator);
+    document.AddMember("numFrames", gNumFrames, allocator);
+    document.AddMember("ticksPerSec", ticksPerSecond, allocator);
+    document.AddMember("framesPerSec", framesPerSecond, allocator);
+
+    // Add frame time stats and the histogram: only non-empty histogram buckets are output
+    {
+        rapidjson::Value frameTimesJson(rapidjson::kObjectType);
+        const bool bHaveFrames = (gNumFrames > 0);
+        frameTimesJson.AddMember("minUsec", (bHaveFrames) ? toMicroseconds(gMinFrameTime) : 0.0, allocator);
+        frameTimesJson.AddMember("maxUsec", (bHaveFrames) ? toMicroseconds(gMaxFrameTime) : 0.0, allocator);
+        frameTimesJson.AddMember("avgUsec", (bHaveFrames) ? (totalSeconds * 1000000.0) / (double) gNumFrames : 0.0, allocator);
+        document.AddMember("frameTimes", frameTimesJson, allocator);
+    }
+
+    {
+        rapidjson::Value histogramJson(rapidjson::kArrayType);
+
+        for (uint32_t i = 0; i < NUM_HISTOGRAM_BUCKETS; ++i) {
+            if (gFrameTimeHistogram[i] == 0)
+                continue;
+
+            const uint64_t minUsec = (i > 0) ? (uint64_t) 1 << i : 0;
+            const uint64_t maxUsec = (i + 1 < NUM_HISTOGRAM_BUCKETS) ? (uint64_t) 1 << (i + 1) : UINT64_MAX;
+
+            rapidjson::Value bucketJson(rapidjson::kObjectType);
+            bucketJson.AddMember("minUsec", minUsec, allocator);
+            bucketJson.AddMember("maxUsec", maxUsec, allocator);
+            bucketJson.AddMember("numFrames", gFrameTimeHistogram[i], allocator);
+            histogramJson.PushBack(bucketJson, allocator);
+        }
+
+        document.AddMember("frameTimeHistogram", histogramJson, allocator);
+    }
+
+    // Add the time spent in each game subsystem
+    {
+        rapidjson::Value sectionsJson(rapidjson::kObjectType);
+
+        for (size_t i = 0; i < (size_t) Section::NUM_SECTIONS; ++i) {
+            const SectionStats& stats = gSectionStats[i];
+            const double sectionSeconds = toSeconds(stats.totalTime);
+
+            rapidjson::Value sectionJson(rapidjson::kObjectType);
+            sectionJson.AddMember("totalSec", sectionSeconds, allocator);
+            sectionJson.AddMember("numCalls", stats.numCalls, allocator);
+            sectionJson.AddMember("avgUsec", (stats.numCalls > 0) ? toMicroseconds(stats.totalTime) / (double) stats.numCalls : 0.0, allocator);
+            sectionJson.AddMember("percentOfTotal", (totalSeconds > 0.0) ? (sectionSeconds * 100.0) / totalSeconds : 0.0, allocator);
+            sectionsJson.AddMember(rapidjson::StringRef(SECTION_NAMES[i]), sectionJson, allocator);
+        }
+
+        document.AddMember("sections", sectionsJson, allocator);
+    }
+
+    // Add the hashes of frames displayed at regular tick intervals, if saving them
+    if (ProgArgs::gFrameHashInterval > 0) {
+        rapidjson::Value frameHashesJson(rapidjson::kArrayType);
+
+        for (const FrameHash& frameHash : gFrameHashes) {
+            rapidjson::Value frameHashJson(rapidjson::kObjectType);
+            frameHashJson.AddMember("tick", frameHash.tick, allocator);
+            frameHashJson.AddMember("hash", frameHash.hash, allocator);
+            frameHashesJson.PushBack(frameHashJson, allocator);
+        }
+
+        document.AddMember("frameHashes", frameHashesJson, allocator);
+    }
+
+    document.AddMember("zone", ZoneStats::mainZoneToJson(gZoneStartStats, gZoneStartSnapshot, gNumTicks, allocator), allocator);
+    document.AddMember("texCache", TexCacheStats::toJson(gTexCacheStartStats, gNumTicks, allocator), allocator);
+
+    // Add peak usage of the vertex buffers used for drawing (Vulkan renderer only)
+    #if PSYDOOM_VULKAN_RENDERER
+    {
+        const VVertexBufferStats& vbStats = VDrawing::getVertexBufferStats();
+
+        rapidjson::Value vbJson(rapidjson::kObjectType);
+        vbJson.AddMember("peakFrameVerts", vbStats.peakFrameVerts, allocator);
+        vbJson.AddMember("peakFrameBlocks", vbStats.peakFrameBlocks, allocator);
+        vbJson.AddMember("numBlocksCreated", vbStats.numBlocksCreated, allocator);
+        vbJson.AddMember("numBlocksReleased", vbStats.numBlocksReleased, allocator);
+        document.AddMember("drawVertexBuffers", vbJson, allocator);
+    }
+    #endif
+
+    // Write the result to the given file
+    std::FILE* const pFile = std::fopen(jsonFilePath, "w");
+
+    if (!pFile)
+        return false;
+
+    auto closeFile = finally([&]() noexcept {
+        std::fflush(pFile);
+        std::fclose(pFile);
+    });
+
+    try {
+        char writeBuffer[4096];
+        rapidjson::FileWriteStream writeStream(pFile, writeBuffer, C_ARRAY_SIZE(writeBuffer));
+        rapidjson::PrettyWriter<rapidjson::FileWriteStream> fileWriter(writeStream);
+        document.Accept(fileWriter);
+    } catch (...) {
+        return false;
+    }
+
+    return true;
+}
+
+END_NAMESPACE(TimeDemo)
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <chrono>
+#include <cstdint>
+
+BEGIN_NAMESPACE(TimeDemo)
+
+// Game subsystems which have their time tracked during a timedemo
+enum class Section : uint8_t {
+    RunThinkers,            // 'P_RunThinkers'
+    CheckSights,            // 'P_CheckSights'
+    RenderPlayerView,       // 'RV_RenderPlayerView' or 'R_RenderPlayerView', depending on the renderer in use
+    DrawPresent,            // 'I_DrawPresent'
+    NUM_SECTIONS
+};
+
+typedef std::chrono::steady_clock Clock;
+
+extern bool gbIsTiming;
+
+void begin() noexcept;
+void endFrame(const int32_t numTicks) noexcept;
+void end() noexcept;
+bool saveToJsonFile(const char* const jsonFilePath) noexcept;
+void addSectionTime(const Section section, const Clock::duration duration) noexcept;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Times the scope it is declared in and adds the time to the given section, if a timedemo is currently running
+//------------------------------------------------------------------------------------------------------------------------------------------
+class SectionTimer {
+public:
+    inline SectionTimer(const Section section) noexcept
+        : mSection(section)
+        , mbTiming(gbIsTiming)
+        , mStartTime((gbIsTiming) ? Clock::now() : Clock::time_point())
+    {
+    }
+
+    inline ~SectionTimer() noexcept {
+        if (mbTiming) {
+            addSectionTime(mSection, Clock::now() - mStartTime);
+        }
+    }
+
+private:
+    const Section               mSection;
+    const bool                  mbTiming;
+    const Clock::time_point     mStartTime;
+};
+
+END_NAMESPACE(TimeDemo)
@@ -26,6 +26,16 @@
 #include <md5.h>
 #include <SDL.h>
 #include <thread>
+#include <vector>
+
+#if __linux__
+    #include <cerrno>
+    #include <time.h>
+#elif _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <Windows.h>
+#endif
 
 BEGIN_NAMESPACE(Utils)
 
@@ -35,8 +45,35 @@ static constexpr const char* const SAVE_FILE_PRODUCT    = "PsyDoom";
 // Because typing this is a pain...
 typedef std::chrono::high_resolution_clock::time_point timepoint_t;
 
-// When we last did platform updates
+// When we last did platform updates and when we last generated timer events and updated the music sequencer
 static timepoint_t gLastPlatformUpdateTime = {};
+static timepoint_t gLastSequencerUpdateTime = {};
+
+// A previously computed MD5 hash for a disc file, identified by the disc image file and where the file is located within it
+struct DiscFileHash {
+    std::string     discFilePath;
+    uint32_t        startLba;
+    uint32_t        size;
+    uint64_t        hashWord1;
+    uint64_t        hashWord2;
+};
+
+// MD5 hashes for disc files computed so far, so the same file doesn't need to be read and hashed more than once
+static std::vector<DiscFileHash> gDiscFileHashes;
+
+// How often to generate timer events and update the music sequencer (1 KHz), independent of how often platform updates are requested
+static constexpr auto SEQUENCER_UPDATE_INTERVAL = std::chrono::milliseconds(1);
+
+// How long before a wait deadline to stop sleeping and begin spinning instead, to absorb OS timer/scheduler wakeup latency.
+// Also the longest amount of time that 'sleepUntil' will wait for before returning, so that platform updates can happen regularly.
+static constexpr auto SLEEP_SPIN_MARGIN = std::chrono::microseconds(1500);
+static constexpr auto SLEEP_MAX_WAIT    = std::chrono::milliseconds(4);
+
+#if _WIN32
+    // Windows: a high resolution waitable timer for this thread, or 'nullptr' if not supported (pre Windows 10 1803)
+    static thread_local HANDLE gSleepTimer = nullptr;
+    static thread_local bool gbTriedCreateSleepTimer = false;
+#endif
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Gets the game version string.
@@ -102,18 +139,22 @@ void doPlatformUpdates() noexcept {
     if (ProgArgs::gbHeadlessMode)
         return;
 
-    // Always generate timer events and update the music sequencer.
-    // Note that for PsyDoom the sequencer is now manually updated here and it now uses a delta time rather than a fixed increment
-    PsxVm::generateTimerEvents();
+    // Generate timer events and update the music sequencer on a fixed clock, rather than every time a busy loop happens to call this.
+    // Note that for PsyDoom the sequencer is now manually updated here and it now uses a delta time rather than a fixed increment.
+    // These updates must stay on the main thread since the sequencer is not thread safe, and only the main thread may submit SPU commands.
+    const timepoint_t now = std::chrono::high_resolution_clock::now();
 
-    if (gbWess_SeqOn) {
-        SeqEngine();
+    if (now - gLastSequencerUpdateTime >= SEQUENCER_UPDATE_INTERVAL) {
+        gLastSequencerUpdateTime = now;
+        PsxVm::generateTimerEvents();
+
+        if (gbWess_SeqOn) {
+            SeqEngine();
+        }
     }
 
     // Only do these updates if enough time has elapsed.
     // Do this to prevent excessive CPU usage in loops that are periodically trying to update sound etc. while waiting for some event.
-    const timepoint_t now = std::chrono::high_resolution_clock::now();
-
     if (now - gLastPlatformUpdateTime < std::chrono::milliseconds(4))
         return;
 
@@ -121,6 +162,7 @@ void doPlatformUpdates() noexcept {
     gLastPlatformUpdateTime = now;
     Network::doUpdates();
     Input::update();
+    PsxVm::updateAudioBufferSize();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -153,7 +195,8 @@ static bool waitForCond(const T& condLamba) noexcept {
             Video::displayFramebuffer();
         }
 
-        Utils::threadYield();
+        // Sleep for a short while rather than a spinning thread yield, since there is no exact deadline to hit here
+        sleepUntil(std::chrono::steady_clock::now() + std::chrono::milliseconds(1));
         doPlatformUpdates();
     }
 
@@ -231,6 +274,85 @@ void threadYield() noexcept {
     std::this_thread::yield();
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Does a high resolution sleep of the current thread until the specified time.
+// Returns 'false' if the platform does not support high resolution sleeps, in which case no sleep is done.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool preciseSleepUntil(const std::chrono::steady_clock::time_point wakeTime) noexcept {
+    #if __linux__
+        // Linux: 'steady_clock' is 'CLOCK_MONOTONIC', so we can sleep until an absolute time on that clock
+        const auto wakeNanos = std::chrono::duration_cast<std::chrono::nanoseconds>(wakeTime.time_since_epoch()).count();
+        timespec wakeTimespec = {};
+        wakeTimespec.tv_sec = (time_t)(wakeNanos / 1000000000);
+        wakeTimespec.tv_nsec = (long)(wakeNanos % 1000000000);
+
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &wakeTimespec, nullptr) == EINTR) {}
+        return true;
+    #elif _WIN32
+        // Windows: use a high resolution waitable timer, if available.
+        // Regular sleeps are limited to the system timer resolution (often 15.6ms) which is far too coarse for frame pacing.
+        #ifndef CREATE_WAITABLE_TIMER_HIGH_RESOLUTION
+            #define CREATE_WAITABLE_TIMER_HIGH_RESOLUTION 0x00000002
+        #endif
+
+        if (!gbTriedCreateSleepTimer) {
+            gbTriedCreateSleepTimer = true;
+            gSleepTimer = CreateWaitableTimerExW(nullptr, nullptr, CREATE_WAITABLE_TIMER_HIGH_RESOLUTION, TIMER_ALL_ACCESS);
+        }
+
+        if (!gSleepTimer)
+            return false;
+
+        // Note: a negative due time is relative and in 100 nanosecond units
+        const auto sleepDuration = wakeTime - std::chrono::steady_clock::now();
+        const int64_t sleepTicks = std::chrono::duration_cast<std::chrono::nanoseconds>(sleepDuration).count() / 100;
+
+        if (sleepTicks > 0) {
+            LARGE_INTEGER dueTime = {};
+            dueTime.QuadPart = -sleepTicks;
+
+            if (SetWaitableTimerEx(gSleepTimer, &dueTime, 0, nullptr, nullptr, nullptr, 0)) {
+                WaitForSingleObject(gSleepTimer, INFINITE);
+            }
+        }
+
+        return true;
+    #else
+        std::this_thread::sleep_until(wakeTime);
+        return true;
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Waits until the specified time without burning CPU, or for at most a few milliseconds if the time is further away than that.
+// The wait is capped so that callers can continue to do platform updates regularly while waiting in a loop for some deadline.
+// Most of the wait is done using a high resolution timed sleep, with only the last short while before the deadline spent spinning.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void sleepUntil(const std::chrono::steady_clock::time_point wakeTime) noexcept {
+    typedef std::chrono::steady_clock clock_t;
+
+    const clock_t::time_point waitStartTime = clock_t::now();
+    const clock_t::time_point waitEndTime = std::min(wakeTime, waitStartTime + SLEEP_MAX_WAIT);
+
+    // Sleep for most of the wait, if there is enough time to and if the platform supports precise sleeps
+    bool bCanSleep = true;
+
+    if (waitEndTime - waitStartTime > SLEEP_SPIN_MARGIN) {
+        bCanSleep = preciseSleepUntil(waitEndTime - SLEEP_SPIN_MARGIN);
+    }
+
+    // Spin for the remainder of the wait.
+    // If we can't do precise sleeps then just yield once and return, so that the caller's wait loop behaves as it always did.
+    if (!bCanSleep) {
+        threadYield();
+        return;
+    }
+
+    while (clock_t::now() < waitEndTime) {
+        threadYield();
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Does some setup for UI drawing if using the new Vulkan based renderer
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -363,6 +485,26 @@ bool getDiscFileMD5Hash(
     uint64_t& hashWord1,
     uint64_t& hashWord2
 ) noexcept {
+    // If this file has already been hashed then just return the previous result
+    const IsoFileSysEntry* const pFsEntry = (filePath) ? isoFileSys.getEntry(filePath) : nullptr;
+    const DiscTrack* const pTrack = discInfo.getTrack(1);
+
+    if (pFsEntry && pTrack) {
+        for (const DiscFileHash& fileHash : gDiscFileHashes) {
+            const bool bIsSameFile = (
+                (fileHash.startLba == pFsEntry->startLba) &&
+                (fileHash.size == pFsEntry->size) &&
+                (fileHash.discFilePath == pTrack->sourceFilePath)
+            );
+
+            if (bIsSameFile) {
+                hashWord1 = fileHash.hashWord1;
+                hashWord2 = fileHash.hashWord2;
+                return true;
+            }
+        }
+    }
+
     // Get the data and abort if that fails
     DiscFileData data = getDiscFileData(discInfo, isoFileSys, filePath);
 
@@ -390,6 +532,11 @@ bool getDiscFileMD5Hash(
         ((uint64_t) md5[12] << 24) | ((uint64_t) md5[13] << 16) | ((uint64_t) md5[14] <<  8) | ((uint64_t) md5[15] <<  0)
     );
 
+    // Remember the hash in case it is asked for again
+    if (pFsEntry && pTrack) {
+        gDiscFileHashes.push_back({ pTrack->sourceFilePath, pFsEntry->startLba, pFsEntry->size, hashWord1, hashWord2 });
+    }
+
     return true;
 }
 
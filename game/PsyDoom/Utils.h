@@ -2,6 +2,7 @@
 
 #include "Macros.h"
 
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <string>
@@ -32,6 +33,7 @@ bool waitUntilSeqEnteredStatus(const int32_t sequenceIdx, const SequenceStatus s
 bool waitUntilSeqExitedStatus(const int32_t sequenceIdx, const SequenceStatus status) noexcept;
 bool waitForCdAudioFadeOut() noexcept;
 void threadYield() noexcept;
+void sleepUntil(const std::chrono::steady_clock::time_point wakeTime) noexcept;
 void onBeginUIDrawing() noexcept;
 void checkForRendererToggleInput() noexcept;
 void checkForUncappedFramerateToggleInput() noexcept;
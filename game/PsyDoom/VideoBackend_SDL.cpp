@@ -9,10 +9,141 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <SDL.h>
 
+// Use SIMD instructions (SSE2 or NEON) for converting and upscaling the PSX framebuffer, if supported by the target
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define VIDEO_SDL_SIMD_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define VIDEO_SDL_SIMD_NEON 1
+    #include <arm_neon.h>
+#endif
+
 BEGIN_NAMESPACE(Video)
 
+// The maximum integer factor that the PSX framebuffer can be upscaled by on the CPU
+static constexpr uint32_t MAX_UPSCALE_FACTOR = 8;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts a single PSX 16-bit framebuffer color to the 32-bit 'ABGR8888' format used for the SDL framebuffer texture
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline uint32_t convertColor16ToAbgr8888(const Gpu::Color16 srcPixel) noexcept {
+    const uint32_t r = (uint32_t) srcPixel.getR() << 3;
+    const uint32_t g = (uint32_t) srcPixel.getG() << 3;
+    const uint32_t b = (uint32_t) srcPixel.getB() << 3;
+    return (0xFF000000 | (b << 16) | (g << 8 ) | (r << 0));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts a row of PSX 16-bit framebuffer pixels to the 32-bit 'ABGR8888' format and horizontally upscales it by the given integer
+// factor, all in the same pass. The number of source pixels must be a multiple of 8.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void convertAndUpscaleRow(
+    const Gpu::Color16* const pSrcPixels,
+    const uint32_t numSrcPixels,
+    uint32_t* const pDstPixels,
+    const uint32_t upscaleFactor
+) noexcept {
+    ASSERT(numSrcPixels % 8 == 0);
+    ASSERT((upscaleFactor >= 1) && (upscaleFactor <= MAX_UPSCALE_FACTOR));
+
+    uint32_t* pDstPixel = pDstPixels;
+
+    for (uint32_t srcX = 0; srcX < numSrcPixels; srcX += 8) {
+        // Convert 8 pixels at a time: move each RGB555 component into it's own byte, shifted up to 8-bits
+        #if VIDEO_SDL_SIMD_SSE2
+            const __m128i srcColors = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcPixels + srcX));
+
+            const auto convert = [](const __m128i colors) noexcept {
+                const __m128i r = _mm_slli_epi32(_mm_and_si128(colors, _mm_set1_epi32(0x001F)), 3);
+                const __m128i g = _mm_slli_epi32(_mm_and_si128(colors, _mm_set1_epi32(0x03E0)), 6);
+                const __m128i b = _mm_slli_epi32(_mm_and_si128(colors, _mm_set1_epi32(0x7C00)), 9);
+                return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, _mm_set1_epi32((int32_t) 0xFF000000)));
+            };
+
+            const __m128i pixelsLo = convert(_mm_unpacklo_epi16(srcColors, _mm_setzero_si128()));
+            const __m128i pixelsHi = convert(_mm_unpackhi_epi16(srcColors, _mm_setzero_si128()));
+        #elif VIDEO_SDL_SIMD_NEON
+            const uint16x8_t srcColors = vld1q_u16(reinterpret_cast<const uint16_t*>(pSrcPixels + srcX));
+
+            const auto convert = [](const uint32x4_t colors) noexcept {
+                const uint32x4_t r = vshlq_n_u32(vandq_u32(colors, vdupq_n_u32(0x001F)), 3);
+                const uint32x4_t g = vshlq_n_u32(vandq_u32(colors, vdupq_n_u32(0x03E0)), 6);
+                const uint32x4_t b = vshlq_n_u32(vandq_u32(colors, vdupq_n_u32(0x7C00)), 9);
+                return vorrq_u32(vorrq_u32(r, g), vorrq_u32(b, vdupq_n_u32(0xFF000000)));
+            };
+
+            const uint32x4_t pixelsLo = convert(vmovl_u16(vget_low_u16(srcColors)));
+            const uint32x4_t pixelsHi = convert(vmovl_u16(vget_high_u16(srcColors)));
+        #else
+            uint32_t pixels[8];
+
+            for (uint32_t i = 0; i < 8; ++i) {
+                pixels[i] = convertColor16ToAbgr8888(pSrcPixels[srcX + i]);
+            }
+        #endif
+
+        // Output the converted pixels, repeating each one horizontally by the upscale factor.
+        // The common 1x and 2x cases are done entirely in registers.
+        #if VIDEO_SDL_SIMD_SSE2 || VIDEO_SDL_SIMD_NEON
+            if (upscaleFactor == 1) {
+                #if VIDEO_SDL_SIMD_SSE2
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(pDstPixel + 0), pixelsLo);
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(pDstPixel + 4), pixelsHi);
+                #else
+                    vst1q_u32(pDstPixel + 0, pixelsLo);
+                    vst1q_u32(pDstPixel + 4, pixelsHi);
+                #endif
+
+                pDstPixel += 8;
+                continue;
+            }
+
+            if (upscaleFactor == 2) {
+                #if VIDEO_SDL_SIMD_SSE2
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(pDstPixel + 0),  _mm_unpacklo_epi32(pixelsLo, pixelsLo));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(pDstPixel + 4),  _mm_unpackhi_epi32(pixelsLo, pixelsLo));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(pDstPixel + 8),  _mm_unpacklo_epi32(pixelsHi, pixelsHi));
+                    _mm_storeu_si128(reinterpret_cast<__m128i*>(pDstPixel + 12), _mm_unpackhi_epi32(pixelsHi, pixelsHi));
+                #else
+                    const uint32x4x2_t pixelsLo2x = vzipq_u32(pixelsLo, pixelsLo);
+                    const uint32x4x2_t pixelsHi2x = vzipq_u32(pixelsHi, pixelsHi);
+                    vst1q_u32(pDstPixel + 0,  pixelsLo2x.val[0]);
+                    vst1q_u32(pDstPixel + 4,  pixelsLo2x.val[1]);
+                    vst1q_u32(pDstPixel + 8,  pixelsHi2x.val[0]);
+                    vst1q_u32(pDstPixel + 12, pixelsHi2x.val[1]);
+                #endif
+
+                pDstPixel += 16;
+                continue;
+            }
+
+            uint32_t pixels[8];
+
+            #if VIDEO_SDL_SIMD_SSE2
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + 0), pixelsLo);
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pixels + 4), pixelsHi);
+            #else
+                vst1q_u32(pixels + 0, pixelsLo);
+                vst1q_u32(pixels + 4, pixelsHi);
+            #endif
+        #endif
+
+        for (uint32_t i = 0; i < 8; ++i) {
+            pDstPixel = std::fill_n(pDstPixel, upscaleFactor, pixels[i]);
+        }
+    }
+
+    // Debug: verify the output against a simple unoptimized version of the conversion
+    #if ASSERTS_ENABLED
+        for (uint32_t dstX = 0; dstX < numSrcPixels * upscaleFactor; ++dstX) {
+            ASSERT(pDstPixels[dstX] == convertColor16ToAbgr8888(pSrcPixels[dstX / upscaleFactor]));
+        }
+    #endif
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Creates the backend with the SDL renderer uninitialized
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -21,6 +152,8 @@ VideoBackend_SDL::VideoBackend_SDL() noexcept
     , mpRenderer(nullptr)
     , mpFramebufferTexture(nullptr)
     , mpFramebufferPixels(nullptr)
+    , mFramebufferPitch(0)
+    , mUpscaleFactor(0)
 {
 }
 
@@ -55,7 +188,7 @@ void VideoBackend_SDL::initRenderers(SDL_Window* const pSdlWindow) noexcept {
     ASSERT(!mpFramebufferTexture);
     ASSERT(!mpFramebufferPixels);
 
-    // Create the renderer and framebuffer texture
+    // Create the renderer
     mpSdlWindow = pSdlWindow;
     const Uint32 vsyncFlag = (Config::gbEnableVSync) ? SDL_RENDERER_PRESENTVSYNC : 0;
     mpRenderer = SDL_CreateRenderer(pSdlWindow, -1, SDL_RENDERER_ACCELERATED | vsyncFlag);
@@ -64,38 +197,19 @@ void VideoBackend_SDL::initRenderers(SDL_Window* const pSdlWindow) noexcept {
         FatalErrors::raise("Failed to create renderer!");
     }
 
-    mpFramebufferTexture = SDL_CreateTexture(
-        mpRenderer,
-        SDL_PIXELFORMAT_ABGR8888,
-        SDL_TEXTUREACCESS_STREAMING,
-        ORIG_DRAW_RES_X,
-        ORIG_DRAW_RES_Y
-    );
-
-    if (!mpFramebufferTexture) {
-        FatalErrors::raise("Failed to create a framebuffer texture!");
-    }
-
     // Clear the renderer to black
     SDL_SetRenderDrawColor(mpRenderer, 0, 0, 0, 0);
     SDL_RenderClear(mpRenderer);
 
-    // Immediately lock the framebuffer texture in preparation for the next update
-    lockFramebufferTexture();
+    // Create the framebuffer texture and immediately lock it in preparation for the next update
+    createFramebufferTexture(getFramebufferUpscaleFactor());
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Cleans up and destroys the SDL renderer used by this video backend
 //------------------------------------------------------------------------------------------------------------------------------------------
 void VideoBackend_SDL::destroyRenderers() noexcept {
-    if (mpFramebufferPixels) {
-        unlockFramebufferTexture();
-    }
-
-    if (mpFramebufferTexture) {
-        SDL_DestroyTexture(mpFramebufferTexture);
-        mpFramebufferTexture = nullptr;
-    }
+    destroyFramebufferTexture();
 
     if (mpRenderer) {
         SDL_DestroyRenderer(mpRenderer);
@@ -109,6 +223,14 @@ void VideoBackend_SDL::destroyRenderers() noexcept {
 // Copies the output from the classic renderer (PSX framebuffer) to an SDL texture and then blits that to the screen.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void VideoBackend_SDL::displayFramebuffer() noexcept {
+    // If the window size or settings changed such that the PSX framebuffer needs a different amount of upscaling, recreate the texture
+    const uint32_t upscaleFactor = getFramebufferUpscaleFactor();
+
+    if (upscaleFactor != mUpscaleFactor) {
+        destroyFramebufferTexture();
+        createFramebufferTexture(upscaleFactor);
+    }
+
     copyPsxToSdlFramebufferTexture();
     presentSdlFramebufferTexture();
 }
@@ -187,6 +309,90 @@ std::unique_ptr<IVideoSurface> VideoBackend_SDL::createSurface(const uint32_t wi
     return (mpRenderer) ? std::make_unique<VideoSurface_SDL>(*mpRenderer, width, height) : std::unique_ptr<IVideoSurface>();
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates the SDL texture that the PSX framebuffer is uploaded to, sized for the given upscale factor, and locks it for writing.
+// If a texture of that size cannot be created then falls back to no upscaling.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void VideoBackend_SDL::createFramebufferTexture(const uint32_t upscaleFactor) noexcept {
+    ASSERT(mpRenderer);
+    ASSERT(!mpFramebufferTexture);
+    ASSERT((upscaleFactor >= 1) && (upscaleFactor <= MAX_UPSCALE_FACTOR));
+
+    mUpscaleFactor = upscaleFactor;
+    mpFramebufferTexture = SDL_CreateTexture(
+        mpRenderer,
+        SDL_PIXELFORMAT_ABGR8888,
+        SDL_TEXTUREACCESS_STREAMING,
+        ORIG_DRAW_RES_X * (int32_t) upscaleFactor,
+        ORIG_DRAW_RES_Y * (int32_t) upscaleFactor
+    );
+
+    if ((!mpFramebufferTexture) && (upscaleFactor > 1)) {
+        mUpscaleFactor = 1;
+        mpFramebufferTexture = SDL_CreateTexture(
+            mpRenderer,
+            SDL_PIXELFORMAT_ABGR8888,
+            SDL_TEXTUREACCESS_STREAMING,
+            ORIG_DRAW_RES_X,
+            ORIG_DRAW_RES_Y
+        );
+    }
+
+    if (!mpFramebufferTexture) {
+        FatalErrors::raise("Failed to create a framebuffer texture!");
+    }
+
+    // When upscaled on the CPU, the remaining (non integer) scaling to the window is filtered to get a 'sharp bilinear' look.
+    // Without upscaling, scale the framebuffer straight to the window with no filtering.
+    SDL_SetTextureScaleMode(mpFramebufferTexture, (mUpscaleFactor > 1) ? SDL_ScaleModeLinear : SDL_ScaleModeNearest);
+    lockFramebufferTexture();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Unlocks and destroys the SDL texture that the PSX framebuffer is uploaded to, if it exists
+//------------------------------------------------------------------------------------------------------------------------------------------
+void VideoBackend_SDL::destroyFramebufferTexture() noexcept {
+    if (mpFramebufferPixels) {
+        unlockFramebufferTexture();
+    }
+
+    if (mpFramebufferTexture) {
+        SDL_DestroyTexture(mpFramebufferTexture);
+        mpFramebufferTexture = nullptr;
+    }
+
+    mUpscaleFactor = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decides what integer factor to upscale the PSX framebuffer by on the CPU, based on user settings and the current window size.
+// In 'auto' mode the largest factor that fits within the area the framebuffer is displayed to is used.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t VideoBackend_SDL::getFramebufferUpscaleFactor() noexcept {
+    ASSERT(mpRenderer);
+
+    if (Config::gClassicUpscaleFactor > 0)
+        return std::min((uint32_t) Config::gClassicUpscaleFactor, MAX_UPSCALE_FACTOR);
+
+    int32_t windowW = {};
+    int32_t windowH = {};
+    SDL_GetRendererOutputSize(mpRenderer, &windowW, &windowH);
+
+    if ((windowW <= 0) || (windowH <= 0))
+        return 1;
+
+    float outputRectX = {};
+    float outputRectY = {};
+    float outputRectW = {};
+    float outputRectH = {};
+    Video::getClassicFramebufferWindowRect((float) windowW, (float) windowH, outputRectX, outputRectY, outputRectW, outputRectH);
+
+    const int32_t srcH = Video::ORIG_DRAW_RES_Y - Video::gTopOverscan - Video::gBotOverscan;
+    const int32_t factorX = (int32_t)(outputRectW / (float) Video::ORIG_DRAW_RES_X);
+    const int32_t factorY = (int32_t)(outputRectH / (float) std::max(srcH, 1));
+    return (uint32_t) std::clamp<int32_t>(std::min(factorX, factorY), 1, (int32_t) MAX_UPSCALE_FACTOR);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Lock the SDL texture we upload the PSX framebuffer to for writing
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -199,6 +405,8 @@ void VideoBackend_SDL::lockFramebufferTexture() noexcept {
     if (SDL_LockTexture(mpFramebufferTexture, nullptr, reinterpret_cast<void**>(&mpFramebufferPixels), &pitch) != 0) {
         FatalErrors::raise("Failed to lock the framebuffer texture for writing!");
     }
+
+    mFramebufferPitch = (uint32_t) pitch / sizeof(uint32_t);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -219,25 +427,25 @@ void VideoBackend_SDL::copyPsxToSdlFramebufferTexture() noexcept {
     // Sanity checks
     ASSERT(mpFramebufferPixels);
 
-    // Copy the framebuffer
+    ASSERT((mUpscaleFactor >= 1) && (mUpscaleFactor <= MAX_UPSCALE_FACTOR));
+    ASSERT(mFramebufferPitch >= ORIG_DRAW_RES_X * mUpscaleFactor);
+
+    // Copy the framebuffer, converting and upscaling each row in one pass and then duplicating it vertically for the upscale factor.
+    // Rows hidden by overscan are never displayed, so don't bother converting them.
     Gpu::Core& gpu = PsxVm::gGpu;
     const Gpu::Color16* const vramPixels = reinterpret_cast<const Gpu::Color16*>(gpu.pRam);
-    uint32_t* pDstPixel = mpFramebufferPixels;
-
-    for (uint32_t y = 0; y < ORIG_DRAW_RES_Y; ++y) {
-        const Gpu::Color16* const rowPixels = vramPixels + ((intptr_t) y + gpu.displayAreaY) * gpu.ramPixelW;
-        const uint32_t xStart = (uint32_t) gpu.displayAreaX;
-        const uint32_t xEnd = xStart + ORIG_DRAW_RES_X;
-        ASSERT(xEnd <= gpu.ramPixelW);
-
-        // Note: don't bother doing multiple pixels at a time - compiler is smart and already optimizes this to use SIMD
-        for (uint32_t x = xStart; x < xEnd; ++x, ++pDstPixel) {
-            const Gpu::Color16 srcPixel = rowPixels[x];
-            const uint32_t r = (uint32_t) srcPixel.getR() << 3;
-            const uint32_t g = (uint32_t) srcPixel.getG() << 3;
-            const uint32_t b = (uint32_t) srcPixel.getB() << 3;
-
-            *pDstPixel = (0xFF000000 | (b << 16) | (g << 8 ) | (r << 0));
+    const uint32_t dstRowSize = ORIG_DRAW_RES_X * mUpscaleFactor * sizeof(uint32_t);
+    const uint32_t yStart = (uint32_t) Video::gTopOverscan;
+    const uint32_t yEnd = ORIG_DRAW_RES_Y - (uint32_t) Video::gBotOverscan;
+    ASSERT((uint32_t) gpu.displayAreaX + ORIG_DRAW_RES_X <= gpu.ramPixelW);
+
+    for (uint32_t y = yStart; y < yEnd; ++y) {
+        const Gpu::Color16* const rowPixels = vramPixels + ((intptr_t) y + gpu.displayAreaY) * gpu.ramPixelW + gpu.displayAreaX;
+        uint32_t* const pDstRow = mpFramebufferPixels + (intptr_t) y * mUpscaleFactor * mFramebufferPitch;
+        convertAndUpscaleRow(rowPixels, ORIG_DRAW_RES_X, pDstRow, mUpscaleFactor);
+
+        for (uint32_t i = 1; i < mUpscaleFactor; ++i) {
+            std::memcpy(pDstRow + (intptr_t) i * mFramebufferPitch, pDstRow, dstRowSize);
         }
     }
 }
@@ -282,9 +490,9 @@ void VideoBackend_SDL::presentSdlFramebufferTexture() noexcept {
     ASSERT((Video::gBotOverscan >= 0) && (Video::gBotOverscan < Video::ORIG_DRAW_RES_Y / 2));
 
     SDL_Rect srcRect = {};
-    srcRect.y = Video::gTopOverscan;
-    srcRect.w = Video::ORIG_DRAW_RES_X;
-    srcRect.h = Video::ORIG_DRAW_RES_Y - Video::gTopOverscan - Video::gBotOverscan;
+    srcRect.y = Video::gTopOverscan * (int32_t) mUpscaleFactor;
+    srcRect.w = Video::ORIG_DRAW_RES_X * (int32_t) mUpscaleFactor;
+    srcRect.h = (Video::ORIG_DRAW_RES_Y - Video::gTopOverscan - Video::gBotOverscan) * (int32_t) mUpscaleFactor;
 
     SDL_Rect dstRect = {};
     dstRect.x = (int) outputRectX;
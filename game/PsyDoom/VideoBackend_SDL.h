@@ -38,6 +38,9 @@ public:
     [[nodiscard]] virtual std::unique_ptr<IVideoSurface> createSurface(const uint32_t width, const uint32_t height) noexcept override;
 
 private:
+    void createFramebufferTexture(const uint32_t upscaleFactor) noexcept;
+    void destroyFramebufferTexture() noexcept;
+    uint32_t getFramebufferUpscaleFactor() noexcept;
     void lockFramebufferTexture() noexcept;
     void unlockFramebufferTexture() noexcept;
     void copyPsxToSdlFramebufferTexture() noexcept;
@@ -47,6 +50,8 @@ private:
     SDL_Renderer*   mpRenderer;             // The SDL renderer used for blitting to the display
     SDL_Texture*    mpFramebufferTexture;   // A texture we populate for blitting to the display
     uint32_t*       mpFramebufferPixels;    // The pixels for framebuffer texture when locked for writing
+    uint32_t        mFramebufferPitch;      // The number of pixels per row in the framebuffer texture when locked for writing
+    uint32_t        mUpscaleFactor;         // Integer factor that the PSX framebuffer is upscaled by on the CPU when copied to the framebuffer texture
 };
 
 END_NAMESPACE(Video)
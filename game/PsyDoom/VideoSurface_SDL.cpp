@@ -70,4 +70,39 @@ void VideoSurface_SDL::setPixels(const uint32_t* const pSrcPixels) noexcept {
     SDL_UnlockTexture(mpTexture);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Locks the pixels of the surface for writing directly.
+// Returns null if the surface was not successfully initialized or if locking fails.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t* VideoSurface_SDL::lockPixels(uint32_t& rowPitchOut) noexcept {
+    rowPitchOut = 0;
+
+    if (!mpTexture)
+        return nullptr;
+
+    void* pPixels = nullptr;
+    int pitch = 0;
+
+    if (SDL_LockTexture(mpTexture, nullptr, &pPixels, &pitch) != 0)
+        return nullptr;
+
+    // The row pitch should always be a whole number of pixels for this format, but sanity check
+    if ((pitch <= 0) || (pitch % sizeof(uint32_t) != 0)) {
+        SDL_UnlockTexture(mpTexture);
+        return nullptr;
+    }
+
+    rowPitchOut = (uint32_t) pitch / sizeof(uint32_t);
+    return (uint32_t*) pPixels;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Unlocks the pixels of the surface after writing them directly
+//------------------------------------------------------------------------------------------------------------------------------------------
+void VideoSurface_SDL::unlockPixels() noexcept {
+    if (mpTexture) {
+        SDL_UnlockTexture(mpTexture);
+    }
+}
+
 END_NAMESPACE(Video)
@@ -3,6 +3,7 @@
 #if PSYDOOM_VULKAN_RENDERER
 
 #include "Asserts.h"
+#include "LogicalDevice.h"
 
 #include <cstring>
 
@@ -45,8 +46,36 @@ void VideoSurface_Vulkan::setPixels(const uint32_t* const pSrcPixels) noexcept {
 
     // Only if the texture was initialized validly
     if (mTexture.isValid()) {
+        // Movie frames are big whole texture uploads, so do them asynchronously on the dedicated transfer queue (if available)
+        vgl::TransferMgr& transferMgr = mTexture.getDevice()->getTransferMgr();
         std::memcpy(mTexture.lock(), pSrcPixels, mWidth * mHeight * sizeof(uint32_t));
-        mTexture.unlock();
+        mTexture.unlock(&transferMgr.getAsyncUploadTask());
+        mbIsReadyForBlit = false;   // Texture will be shader read only optimal after the transfer!
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Locks the pixels of the surface for writing directly.
+// The memory returned is host visible staging memory from the transfer manager, which is then uploaded when unlocked.
+// Returns null if the surface was not successfully initialized or if locking fails.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t* VideoSurface_Vulkan::lockPixels(uint32_t& rowPitchOut) noexcept {
+    rowPitchOut = mWidth;
+
+    if (!mTexture.isValid())
+        return nullptr;
+
+    return (uint32_t*) mTexture.lock();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Unlocks the pixels of the surface after writing them directly and kicks off the upload to the GPU
+//------------------------------------------------------------------------------------------------------------------------------------------
+void VideoSurface_Vulkan::unlockPixels() noexcept {
+    if (mTexture.isLocked()) {
+        // Movie frames are big whole texture uploads, so do them asynchronously on the dedicated transfer queue (if available)
+        vgl::TransferMgr& transferMgr = mTexture.getDevice()->getTransferMgr();
+        mTexture.unlock(&transferMgr.getAsyncUploadTask());
         mbIsReadyForBlit = false;   // Texture will be shader read only optimal after the transfer!
     }
 }
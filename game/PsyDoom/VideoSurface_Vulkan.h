@@ -16,6 +16,8 @@ public:
     virtual uint32_t getWidth() const noexcept override;
     virtual uint32_t getHeight() const noexcept override;
     virtual void setPixels(const uint32_t* const pSrcPixels) noexcept override;
+    virtual uint32_t* lockPixels(uint32_t& rowPitchOut) noexcept override;
+    virtual void unlockPixels() noexcept override;
 
     inline const vgl::Texture& getTexture() const noexcept { return mTexture; }
 
@@ -9,7 +9,9 @@
 
 #include "Asserts.h"
 #include "Buffer.h"
+#include "CmdBuffer.h"
 #include "CmdBufferRecorder.h"
+#include "CmdPool.h"
 #include "Defines.h"
 #include "DescriptorPool.h"
 #include "DescriptorSet.h"
@@ -20,12 +22,18 @@
 #include "LogicalDevice.h"
 #include "Pipeline.h"
 #include "PsyDoom/Config/Config.h"
+#include "PsyDoom/GameJobs.h"
 #include "PsyDoom/Video.h"
+#include "RenderPass.h"
+#include "VGpuTimers.h"
 #include "VPipelines.h"
 #include "VRenderer.h"
 #include "VTypes.h"
 #include "VVertexBufferSet.h"
 
+#include <algorithm>
+#include <cstring>
+
 BEGIN_NAMESPACE(VDrawing)
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -35,7 +43,10 @@ BEGIN_NAMESPACE(VDrawing)
 enum class DrawCmdType : uint32_t {
     SetPipeline,        // Set the graphics pipeline to use: 1st arg is pipeline type, 2nd arg unused
     SetUniforms,        // Set the uniforms to use: 1st arg is index in the uniforms list
-    Draw                // A command to draw primitives: 1st arg is vertex count, 2nd arg is vertex offset
+    Draw,               // A command to draw primitives: 1st arg is vertex count, 2nd arg is vertex offset
+    DrawQuads,          // PsyDoom: draw quads (4 verts each) using the quad index buffer: 1st arg is quad count, 2nd arg is vertex offset
+    WriteTimestamp,     // PsyDoom: write a GPU timestamp for profiling: 1st arg is the timestamp mark reserved via VGpuTimers
+    SetVertexBuffer     // PsyDoom: switch to another block of the draw vertex buffer set: 1st arg is the block index
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -61,16 +72,186 @@ static VVertexBufferSet gVertexBuffers_Draw;
 // The current pipeline being used by the 'draw' subpass; used to help avoid unneccessary pipeline switches
 static VPipelineType gCurDrawPipelineType;
 
+// PsyDoom: an index buffer shared by all quads drawn, which turns each group of 4 vertices into the triangles (0, 1, 2) and (2, 3, 0).
+// This saves having to write 6 vertices per quad. Since 16-bit indices are used, the buffer only covers a limited number of quads;
+// draws with more quads than this are split up when recording.
+static constexpr uint32_t MAX_QUADS_PER_INDEXED_DRAW = 16384;
+static vgl::Buffer gQuadIndexBuffer;
+
+// PsyDoom: whether the current draw batch consists of indexed quads rather than regular (non-indexed) primitives
+static bool gbCurDrawBatchIsQuads;
+
+// PsyDoom: names for each pipeline type, used to label the GPU time spent on each batch of draws using a pipeline
+static constexpr const char* PIPELINE_TYPE_NAMES[] = {
+    "Lines",
+    "Colored",
+    "UI_4bpp",
+    "UI_8bpp",
+    "UI_8bpp_Add",
+    "UI_16bpp",
+    "World_GeomMasked",
+    "World_GeomAlpha",
+    "World_SpriteMasked",
+    "World_SpriteAlpha",
+    "World_SpriteAdditive",
+    "World_SpriteSubtractive",
+    "World_Sky",
+    "Msaa_Resolve",
+    "Crossfade",
+    "LoadingPlaque"
+};
+
+static_assert(C_ARRAY_SIZE(PIPELINE_TYPE_NAMES) == (size_t) VPipelineType::NUM_TYPES);
+
 // Sets of uniforms for the current frame
 static std::vector<VShaderUniforms_Draw> gFrameUniforms;
 
 // Drawing commands for the current frame
 static std::vector<DrawCmd> gFrameDrawCmds;
 
+// PsyDoom: the maximum number of secondary command buffers that the frame's drawing commands can be split across.
+// Also the minimum number of drawing commands for each secondary command buffer, so there is enough work to make the split worthwhile.
+static constexpr uint32_t MAX_SECONDARY_CMD_BUFFERS = 8;
+static constexpr uint32_t MIN_DRAW_CMDS_PER_SECONDARY_CMD_BUFFER = 256;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Records all drawing commands for the current frame to a Vulkan command buffer
+// PsyDoom: a contiguous range of the frame's drawing commands that is recorded to a single secondary command buffer.
+// Also holds the pipeline and uniforms which are active at the start of the range, since secondary command buffers inherit no state.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void recordCmdBuffer(vgl::CmdBufferRecorder& cmdRec) noexcept {
+struct DrawCmdRange {
+    uint32_t    beginCmdIdx;
+    uint32_t    endCmdIdx;
+    int32_t     pipelineType;       // Pipeline active at the start of the range or '-1' if none
+    int32_t     uniformsIdx;        // Uniforms active at the start of the range or '-1' if none
+    uint32_t    vertexBlockIdx;     // Which block of the draw vertex buffer set is bound at the start of the range
+};
+
+// PsyDoom: command pools and secondary command buffers used to record the frame's drawing commands across multiple threads.
+// There is one command pool per range of drawing commands, so that each pool is only ever used by one thread at a time.
+// There is one set of command buffers per ringbuffer slot, since the buffers for previous frames may still be in use by the GPU.
+static vgl::CmdPool     gSecondaryCmdPools[MAX_SECONDARY_CMD_BUFFERS];
+static vgl::CmdBuffer   gSecondaryCmdBuffers[vgl::Defines::RINGBUFFER_SIZE][MAX_SECONDARY_CMD_BUFFERS];
+
+// PsyDoom: the ranges of drawing commands being recorded to secondary command buffers
+static DrawCmdRange     gSecondaryDrawCmdRanges[MAX_SECONDARY_CMD_BUFFERS];
+
+// PsyDoom: context for the jobs recording secondary command buffers: the render pass and framebuffer the commands are for
+struct SecondaryCmdsJobCtx {
+    const vgl::RenderPass*      pRenderPass;
+    const vgl::Framebuffer*     pFramebuffer;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: adds a drawing command to write a GPU timestamp mark beginning an interval with the given label (or ending the previous one).
+// Does nothing if detailed GPU timing is unavailable.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void addTimestampMarkCmd(const char* const label) noexcept {
+    const uint32_t mark = VGpuTimers::reserveMark(label);
+
+    if (mark != VGpuTimers::INVALID_MARK) {
+        DrawCmd& drawCmd = gFrameDrawCmds.emplace_back();
+        drawCmd.type = DrawCmdType::WriteTimestamp;
+        drawCmd.arg1 = mark;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: tells how many vertices a draw command consumes, for the purposes of merging draws
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint32_t getDrawCmdNumVerts(const DrawCmd& drawCmd) noexcept {
+    ASSERT((drawCmd.type == DrawCmdType::Draw) || (drawCmd.type == DrawCmdType::DrawQuads));
+    return (drawCmd.type == DrawCmdType::DrawQuads) ? drawCmd.arg1 * 4 : drawCmd.arg1;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: removes redundant state changes from the frame's drawing commands and merges draws which can be combined.
+// Run once all of the frame's drawing commands have been submitted, before the commands are recorded to a Vulkan command buffer.
+//
+// Pipeline and uniform changes are deferred until there is something to draw, so that pipelines which are switched to but never drawn
+// with are skipped, as are uniforms which are overwritten or identical to the ones already set. If skipping a pipeline switch means that
+// the same pipeline is being rebound, then the rebind is skipped too and the draws before and after it are merged where possible.
+// The order of all draws is preserved since there is no depth buffer; this only ever eliminates commands, it never reorders them.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void optimizeDrawCmds() noexcept {
+    const uint32_t numDrawCmds = (uint32_t) gFrameDrawCmds.size();
+    DrawCmd* const pDrawCmds = gFrameDrawCmds.data();
+
+    int32_t boundPipelineType = -1;         // Pipeline set by the output commands, or '-1' if none yet
+    int32_t boundUniformsIdx = -1;          // Uniforms set by the output commands, or '-1' if none yet
+    int32_t pendingPipelineType = -1;       // Pipeline requested but not yet output because nothing has been drawn with it, or '-1' if none
+    int32_t pendingUniformsIdx = -1;        // Uniforms requested but not yet output because nothing has been drawn with them, or '-1' if none
+    uint32_t numOutCmds = 0;
+    bool bCanMergeWithPrevCmd = false;      // True if the last output command is a draw which the next draw can potentially be merged with
+
+    for (uint32_t cmdIdx = 0; cmdIdx < numDrawCmds; ++cmdIdx) {
+        const DrawCmd drawCmd = pDrawCmds[cmdIdx];
+
+        switch (drawCmd.type) {
+            case DrawCmdType::SetPipeline: {
+                pendingPipelineType = (int32_t) drawCmd.arg1;
+            }   break;
+
+            case DrawCmdType::SetUniforms: {
+                pendingUniformsIdx = (int32_t) drawCmd.arg1;
+            }   break;
+
+            case DrawCmdType::Draw:
+            case DrawCmdType::DrawQuads: {
+                // Output any state changes which actually make a difference to this draw
+                if ((pendingPipelineType >= 0) && (pendingPipelineType != boundPipelineType)) {
+                    pDrawCmds[numOutCmds++] = DrawCmd{ DrawCmdType::SetPipeline, (uint32_t) pendingPipelineType, 0 };
+                    boundPipelineType = pendingPipelineType;
+                    bCanMergeWithPrevCmd = false;
+                }
+
+                if (pendingUniformsIdx >= 0) {
+                    const bool bSameUniforms = (
+                        (boundUniformsIdx >= 0) &&
+                        (std::memcmp(&gFrameUniforms[pendingUniformsIdx], &gFrameUniforms[boundUniformsIdx], sizeof(VShaderUniforms_Draw)) == 0)
+                    );
+
+                    if (!bSameUniforms) {
+                        pDrawCmds[numOutCmds++] = DrawCmd{ DrawCmdType::SetUniforms, (uint32_t) pendingUniformsIdx, 0 };
+                        boundUniformsIdx = pendingUniformsIdx;
+                        bCanMergeWithPrevCmd = false;
+                    }
+                }
+
+                pendingPipelineType = -1;
+                pendingUniformsIdx = -1;
+
+                // Merge with the previous draw if it is of the same type and this draw's vertices directly follow it's vertices
+                if (bCanMergeWithPrevCmd) {
+                    DrawCmd& prevCmd = pDrawCmds[numOutCmds - 1];
+
+                    if ((prevCmd.type == drawCmd.type) && (prevCmd.arg2 + getDrawCmdNumVerts(prevCmd) == drawCmd.arg2)) {
+                        prevCmd.arg1 += drawCmd.arg1;
+                        break;
+                    }
+                }
+
+                pDrawCmds[numOutCmds++] = drawCmd;
+                bCanMergeWithPrevCmd = true;
+            }   break;
+
+            case DrawCmdType::WriteTimestamp:
+            case DrawCmdType::SetVertexBuffer: {
+                pDrawCmds[numOutCmds++] = drawCmd;
+                bCanMergeWithPrevCmd = false;
+            }   break;
+        }
+    }
+
+    // Any state changes left pending at this point have nothing drawn with them and can be discarded
+    ASSERT(numOutCmds <= numDrawCmds);
+    gFrameDrawCmds.resize(numOutCmds);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records commands to setup the viewport, scissors and vertex buffer used for drawing.
+// PsyDoom: the block of the draw vertex buffer set to bind initially must also be specified.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void recordDrawSetupCmds(vgl::CmdBufferRecorder& cmdRec, const uint32_t vertexBlockIdx) noexcept {
     // First command in the drawing pass is to setup the viewport. Note that while the view is allowed to extend horizontally if widescreen
     // is enabled, no extension is allowed vertically; instead, letterboxing will happen. I considered allowing a vertically long display
     // but it won't work with the UI assets & design that Doom uses. I'm also not sure why someone want to play that way anyway...
@@ -88,14 +269,85 @@ static void recordCmdBuffer(vgl::CmdBufferRecorder& cmdRec) noexcept {
     cmdRec.setViewport((float) viewportXInt, (float) viewportYInt, (float) viewportWInt, (float) viewportHInt, 0.0f, 1.0f);
     cmdRec.setScissors(viewportXInt, viewportYInt, viewportWInt, viewportHInt);
 
-    // Bind the correct vertex buffer for drawing
-    cmdRec.bindVertexBuffer(*gVertexBuffers_Draw.pCurBuffer, 0, 0);
+    // Bind the correct vertex buffer for drawing.
+    // PsyDoom: also bind the index buffer used for drawing quads.
+    cmdRec.bindVertexBuffer(gVertexBuffers_Draw.getBlockBuffer(vertexBlockIdx), 0, 0);
+    cmdRec.bindIndexBufferUint16(gQuadIndexBuffer, 0);
+}
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: records a command to push the specified set of the frame's uniforms as push constants.
+// If uniforms were already pushed then only the range of 32-bit words which differ from those uniforms is pushed, to cut down on the amount
+// of data in the command buffer. Usually only the transform matrix differs between uniform sets.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void recordPushDrawUniforms(vgl::CmdBufferRecorder& cmdRec, const uint32_t uniformsIdx, const int32_t prevUniformsIdx) noexcept {
+    static_assert(sizeof(VShaderUniforms_Draw) % sizeof(uint32_t) == 0);
+    constexpr uint32_t NUM_WORDS = sizeof(VShaderUniforms_Draw) / sizeof(uint32_t);
+
+    const VShaderUniforms_Draw& uniforms = gFrameUniforms[uniformsIdx];
+    uint32_t beginWord = 0;
+    uint32_t endWord = NUM_WORDS;
+
+    if (prevUniformsIdx >= 0) {
+        uint32_t words[NUM_WORDS];
+        uint32_t prevWords[NUM_WORDS];
+        std::memcpy(words, &uniforms, sizeof(words));
+        std::memcpy(prevWords, &gFrameUniforms[prevUniformsIdx], sizeof(prevWords));
+
+        while ((beginWord < endWord) && (words[beginWord] == prevWords[beginWord])) {
+            ++beginWord;
+        }
+
+        while ((endWord > beginWord) && (words[endWord - 1] == prevWords[endWord - 1])) {
+            --endWord;
+        }
+
+        // If nothing has changed then there is nothing to push
+        if (beginWord == endWord)
+            return;
+    }
+
+    cmdRec.pushConstants(
+        VPipelines::gPipelineLayout_draw,
+        VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
+        beginWord * sizeof(uint32_t),
+        (endWord - beginWord) * sizeof(uint32_t),
+        reinterpret_cast<const std::byte*>(&uniforms) + beginWord * sizeof(uint32_t)
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records the specified range of drawing commands for the current frame to a Vulkan command buffer.
+// The pipeline and uniforms which are active at the start of the range are also re-established, if there are any.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void recordDrawCmds(vgl::CmdBufferRecorder& cmdRec, const DrawCmdRange& cmdRange) noexcept {
     // Clear this flag once we bind the drawing descriptor set - it only needs to be done once since all draw pipeline layouts are compatible
     bool bNeedToBindDescriptorSet = true;
 
+    // Re-establish any pipeline and uniforms which were set before the start of this range
+    if (cmdRange.pipelineType >= 0) {
+        ASSERT(cmdRange.pipelineType < (int32_t) VPipelineType::NUM_TYPES);
+        vgl::Pipeline& pipeline = VPipelines::gPipelines[cmdRange.pipelineType];
+        cmdRec.bindPipeline(pipeline);
+        cmdRec.bindDescriptorSet(*gpDescriptorSet, pipeline, 0, 0, nullptr);
+        bNeedToBindDescriptorSet = false;
+    }
+
+    // PsyDoom: remember which uniforms were last pushed so that only the differences need to be pushed for subsequent uniform changes
+    int32_t pushedUniformsIdx = -1;
+
+    if (cmdRange.uniformsIdx >= 0) {
+        recordPushDrawUniforms(cmdRec, (uint32_t) cmdRange.uniformsIdx, -1);
+        pushedUniformsIdx = cmdRange.uniformsIdx;
+    }
+
     // Handle each draw command
-    for (const DrawCmd& drawCmd : gFrameDrawCmds) {
+    ASSERT(cmdRange.beginCmdIdx <= cmdRange.endCmdIdx);
+    ASSERT(cmdRange.endCmdIdx <= gFrameDrawCmds.size());
+
+    for (uint32_t cmdIdx = cmdRange.beginCmdIdx; cmdIdx < cmdRange.endCmdIdx; ++cmdIdx) {
+        const DrawCmd& drawCmd = gFrameDrawCmds[cmdIdx];
+
         switch (drawCmd.type) {
             case DrawCmdType::SetPipeline: {
                 // Bind the pipeline
@@ -111,22 +363,207 @@ static void recordCmdBuffer(vgl::CmdBufferRecorder& cmdRec) noexcept {
             }   break;
 
             case DrawCmdType::SetUniforms: {
-                cmdRec.pushConstants(
-                    VPipelines::gPipelineLayout_draw,
-                    VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT,
-                    0,
-                    sizeof(VShaderUniforms_Draw),
-                    &gFrameUniforms[drawCmd.arg1]
-                );
+                recordPushDrawUniforms(cmdRec, drawCmd.arg1, pushedUniformsIdx);
+                pushedUniformsIdx = (int32_t) drawCmd.arg1;
             }   break;
 
             case DrawCmdType::Draw: {
                 cmdRec.draw(drawCmd.arg1, drawCmd.arg2);
             }   break;
+
+            case DrawCmdType::DrawQuads: {
+                // Split into multiple draws if there are more quads than the index buffer covers, advancing the base vertex for each
+                for (uint32_t quadIdx = 0; quadIdx < drawCmd.arg1; quadIdx += MAX_QUADS_PER_INDEXED_DRAW) {
+                    const uint32_t numQuads = std::min(drawCmd.arg1 - quadIdx, MAX_QUADS_PER_INDEXED_DRAW);
+                    cmdRec.drawIndexed(numQuads * 6, 0, drawCmd.arg2 + quadIdx * 4);
+                }
+            }   break;
+
+            case DrawCmdType::WriteTimestamp: {
+                VGpuTimers::writeMark(cmdRec, drawCmd.arg1);
+            }   break;
+
+            case DrawCmdType::SetVertexBuffer: {
+                cmdRec.bindVertexBuffer(gVertexBuffers_Draw.getBlockBuffer(drawCmd.arg1), 0, 0);
+            }   break;
         }
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records all drawing commands for the current frame to a Vulkan command buffer
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void recordCmdBuffer(vgl::CmdBufferRecorder& cmdRec) noexcept {
+    recordDrawSetupCmds(cmdRec, 0);
+    recordDrawCmds(cmdRec, DrawCmdRange{ 0, (uint32_t) gFrameDrawCmds.size(), -1, -1, 0 });
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: job which records one range of the frame's drawing commands to it's secondary command buffer
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void recordSecondaryCmdBufferJob(void* const pCtx, const uint32_t jobIdx) noexcept {
+    ASSERT(jobIdx < MAX_SECONDARY_CMD_BUFFERS);
+    const SecondaryCmdsJobCtx& jobCtx = *(const SecondaryCmdsJobCtx*) pCtx;
+    ASSERT(jobCtx.pRenderPass && jobCtx.pFramebuffer);
+
+    vgl::CmdBufferRecorder cmdRec(VRenderer::gVkFuncs);
+    cmdRec.beginSecondaryCmdBuffer(
+        gSecondaryCmdBuffers[gCurRingbufferIdx][jobIdx],
+        VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT,
+        jobCtx.pRenderPass->getVkRenderPass(),
+        0,
+        jobCtx.pFramebuffer->getVkFramebuffer()
+    );
+
+    const DrawCmdRange& cmdRange = gSecondaryDrawCmdRanges[jobIdx];
+    recordDrawSetupCmds(cmdRec, cmdRange.vertexBlockIdx);
+    recordDrawCmds(cmdRec, cmdRange);
+    cmdRec.endCmdBuffer();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: splits the frame's drawing commands into ranges that are recorded to secondary command buffers on the renderer's worker threads.
+// The secondary command buffers are then executed in order by the given primary command buffer.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void recordSecondaryCmdBuffers(
+    vgl::CmdBufferRecorder& cmdRec,
+    const vgl::RenderPass& renderPass,
+    const vgl::Framebuffer& framebuffer
+) noexcept {
+    // Decide how many ranges to split the drawing commands into: it should be at least 1 even if there are no commands
+    const uint32_t numDrawCmds = (uint32_t) gFrameDrawCmds.size();
+    const uint32_t numThreads = GameJobs::getNumWorkers() + 1;
+    const uint32_t numRanges = std::clamp(std::min(numDrawCmds / MIN_DRAW_CMDS_PER_SECONDARY_CMD_BUFFER, numThreads), 1u, MAX_SECONDARY_CMD_BUFFERS);
+
+    // Figure out the range of commands for each secondary command buffer and the pipeline, uniforms and vertex buffer active at the start of each range
+    int32_t curPipelineType = -1;
+    int32_t curUniformsIdx = -1;
+    uint32_t curVertexBlockIdx = 0;
+    uint32_t nextCmdIdx = 0;
+
+    for (uint32_t rangeIdx = 0; rangeIdx < numRanges; ++rangeIdx) {
+        DrawCmdRange& cmdRange = gSecondaryDrawCmdRanges[rangeIdx];
+        cmdRange.beginCmdIdx = nextCmdIdx;
+        cmdRange.endCmdIdx = (uint32_t)(((uint64_t) numDrawCmds * (rangeIdx + 1)) / numRanges);
+        cmdRange.pipelineType = curPipelineType;
+        cmdRange.uniformsIdx = curUniformsIdx;
+        cmdRange.vertexBlockIdx = curVertexBlockIdx;
+
+        for (; nextCmdIdx < cmdRange.endCmdIdx; ++nextCmdIdx) {
+            const DrawCmd& drawCmd = gFrameDrawCmds[nextCmdIdx];
+
+            if (drawCmd.type == DrawCmdType::SetPipeline) {
+                curPipelineType = (int32_t) drawCmd.arg1;
+            } else if (drawCmd.type == DrawCmdType::SetUniforms) {
+                curUniformsIdx = (int32_t) drawCmd.arg1;
+            } else if (drawCmd.type == DrawCmdType::SetVertexBuffer) {
+                curVertexBlockIdx = drawCmd.arg1;
+            }
+        }
+    }
+
+    // Record all of the secondary command buffers (in parallel, if possible) and execute them in order
+    SecondaryCmdsJobCtx jobCtx = { &renderPass, &framebuffer };
+    GameJobs::run(recordSecondaryCmdBufferJob, &jobCtx, numRanges);
+
+    for (uint32_t rangeIdx = 0; rangeIdx < numRanges; ++rangeIdx) {
+        cmdRec.exec(gSecondaryCmdBuffers[gCurRingbufferIdx][rangeIdx].getVkCommandBuffer());
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Uploads the vertices generated during drawing and does post frame cleanup, after the frame's drawing commands have been recorded
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void finishFrame() noexcept {
+    // Upload vertices generated during drawing, so the draw commands can use them
+    gVertexBuffers_Draw.endFrame();
+
+    // Post frame cleanup: clear buffers, the current draw pipeline and ringbuffer index
+    gFrameDrawCmds.clear();
+    gFrameUniforms.clear();
+    gCurDrawPipelineType = (VPipelineType) -1;
+    gbCurDrawBatchIsQuads = false;
+    gCurRingbufferIdx = {};
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: creates and populates the static index buffer shared by all quads drawn
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void initQuadIndexBuffer(vgl::LogicalDevice& device) noexcept {
+    constexpr uint32_t NUM_INDICES = MAX_QUADS_PER_INDEXED_DRAW * 6;
+
+    const bool bCreatedBufferOk = gQuadIndexBuffer.initWithElementCount<uint16_t>(
+        device,
+        VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        vgl::BufferUsageMode::STATIC,
+        NUM_INDICES
+    );
+
+    if (!bCreatedBufferOk)
+        FatalErrors::raise("VDrawing: Failed to create a Vulkan index buffer!");
+
+    uint16_t* const pIndices = gQuadIndexBuffer.lockElements<uint16_t>(0, NUM_INDICES);
+
+    if (!pIndices)
+        FatalErrors::raise("VDrawing: Failed to lock a required Vulkan index buffer!");
+
+    for (uint32_t quadIdx = 0; quadIdx < MAX_QUADS_PER_INDEXED_DRAW; ++quadIdx) {
+        uint16_t* const pQuadIndices = pIndices + quadIdx * 6;
+        const uint16_t firstVertIdx = (uint16_t)(quadIdx * 4);
+        pQuadIndices[0] = firstVertIdx + 0;
+        pQuadIndices[1] = firstVertIdx + 1;
+        pQuadIndices[2] = firstVertIdx + 2;
+        pQuadIndices[3] = firstVertIdx + 2;
+        pQuadIndices[4] = firstVertIdx + 3;
+        pQuadIndices[5] = firstVertIdx + 0;
+    }
+
+    gQuadIndexBuffer.unlockElements<uint16_t>(NUM_INDICES);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: allocates the specified number of vertices for the current draw batch.
+// If the current vertex buffer block is full then the batch is ended and drawing moves onto the next block in the chain.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static VVertex_Draw* allocBatchVerts(const uint32_t numVerts) noexcept {
+    if (!gVertexBuffers_Draw.hasRoomForVerts(numVerts)) {
+        endCurrentDrawBatch();
+        gVertexBuffers_Draw.beginNextBlock(numVerts);
+
+        DrawCmd& drawCmd = gFrameDrawCmds.emplace_back();
+        drawCmd.type = DrawCmdType::SetVertexBuffer;
+        drawCmd.arg1 = gVertexBuffers_Draw.curBlockIdx;
+    }
+
+    return gVertexBuffers_Draw.allocVerts<VVertex_Draw>(numVerts);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: allocates vertices for regular (non-indexed) primitives in the current draw batch.
+// If the current batch is for quads then it is ended first, since the 2 types of batch are drawn differently.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static VVertex_Draw* allocDrawVerts(const uint32_t numVerts) noexcept {
+    if (gbCurDrawBatchIsQuads) {
+        endCurrentDrawBatch();
+        gbCurDrawBatchIsQuads = false;
+    }
+
+    return allocBatchVerts(numVerts);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: allocates the 4 vertices for a quad in the current draw batch, which is drawn as the triangles (0, 1, 2) and (2, 3, 0).
+// If the current batch is for regular primitives then it is ended first, since the 2 types of batch are drawn differently.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static VVertex_Draw* allocQuadVerts() noexcept {
+    if (!gbCurDrawBatchIsQuads) {
+        endCurrentDrawBatch();
+        gbCurDrawBatchIsQuads = true;
+    }
+
+    return allocBatchVerts(4);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes the drawing module and allocates draw vertex buffers etc.
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -152,12 +589,26 @@ void init(vgl::LogicalDevice& device, vgl::BaseTexture& vramTex) noexcept {
         gpDescriptorSet->bindTextureAndSampler(0, vramTex, VPipelines::gSampler_draw);
     }
 
-    // Create the vertex buffers
+    // Create the vertex buffers.
+    // PsyDoom: this is now the size of each block in the chain of vertex buffers used for each ringbuffer slot.
     constexpr uint32_t DRAW_VB_SIZE = 4 * 1024 * 1024;
     gVertexBuffers_Draw.init<VVertex_Draw>(device, DRAW_VB_SIZE / sizeof(VVertex_Draw));
+    initQuadIndexBuffer(device);
+
+    // Create the command pools and secondary command buffers used to record drawing commands across multiple threads
+    for (uint32_t poolIdx = 0; poolIdx < MAX_SECONDARY_CMD_BUFFERS; ++poolIdx) {
+        if (!gSecondaryCmdPools[poolIdx].init(device, device.getWorkQueueFamilyIdx(), true))
+            FatalErrors::raise("VDrawing: Failed to create a Vulkan command pool!");
+
+        for (vgl::CmdBuffer (&cmdBuffers)[MAX_SECONDARY_CMD_BUFFERS] : gSecondaryCmdBuffers) {
+            if (!cmdBuffers[poolIdx].init(gSecondaryCmdPools[poolIdx], VK_COMMAND_BUFFER_LEVEL_SECONDARY))
+                FatalErrors::raise("VDrawing: Failed to create a Vulkan secondary command buffer!");
+        }
+    }
 
     // Current draw pipeline in use is undefined initially
     gCurDrawPipelineType = (VPipelineType) -1;
+    gbCurDrawBatchIsQuads = false;
 
     // Prealloc draw buffer memory
     gFrameUniforms.reserve(16);
@@ -171,8 +622,20 @@ void shutdown() noexcept {
     gFrameDrawCmds.clear();
     gFrameUniforms.clear();
     gCurDrawPipelineType = {};
+    gbCurDrawBatchIsQuads = false;
+    gQuadIndexBuffer.destroy(true);
     gVertexBuffers_Draw.destroy();
 
+    for (vgl::CmdBuffer (&cmdBuffers)[MAX_SECONDARY_CMD_BUFFERS] : gSecondaryCmdBuffers) {
+        for (vgl::CmdBuffer& cmdBuffer : cmdBuffers) {
+            cmdBuffer.destroy(true);
+        }
+    }
+
+    for (vgl::CmdPool& cmdPool : gSecondaryCmdPools) {
+        cmdPool.destroy();
+    }
+
     if (gpDescriptorSet) {
         gpDescriptorSet->free(true);
         gpDescriptorSet = nullptr;
@@ -194,21 +657,49 @@ void beginFrame(const uint32_t ringbufferIdx) noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Performs end of frame logic for the drawing module
+// Performs end of frame logic for the drawing module, for when drawing commands are recorded inline to the given primary command buffer
 //------------------------------------------------------------------------------------------------------------------------------------------
 void endFrame(vgl::CmdBufferRecorder& cmdRec) noexcept {
-    // Finish the current draw batch then record all drawing commands in the Vulkan command buffer
+    // Finish the current draw batch then record all drawing commands in the Vulkan command buffer.
+    // PsyDoom: also end the GPU timing interval for the last pipeline used.
     endCurrentDrawBatch();
+    addTimestampMarkCmd(nullptr);
+    optimizeDrawCmds();
     recordCmdBuffer(cmdRec);
+    finishFrame();
+}
 
-    // Upload vertices generated during drawing, so the draw commands can use them
-    gVertexBuffers_Draw.endFrame();
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: performs end of frame logic for the drawing module, for when drawing commands are recorded to secondary command buffers.
+// The drawing commands are recorded across multiple threads where possible, and the given primary command buffer then executes them.
+// The subpass being drawn to must be the first in the given render pass and it must have been started with secondary command buffer contents.
+// Note that this can only be done ONCE per ringbuffer slot per frame, since the secondary command buffers used are per ringbuffer slot.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void endFrame(vgl::CmdBufferRecorder& cmdRec, const vgl::RenderPass& renderPass, const vgl::Framebuffer& framebuffer) noexcept {
+    endCurrentDrawBatch();
+    addTimestampMarkCmd(nullptr);
+    optimizeDrawCmds();
+    recordSecondaryCmdBuffers(cmdRec, renderPass, framebuffer);
+    finishFrame();
+}
 
-    // Post frame cleanup: clear buffers, the current draw pipeline and ringbuffer index
-    gFrameDrawCmds.clear();
-    gFrameUniforms.clear();
-    gCurDrawPipelineType = (VPipelineType) -1;
-    gCurRingbufferIdx = {};
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: tells if it is worthwhile recording drawing commands to secondary command buffers, so that they can be recorded in parallel.
+// This is only the case when there are worker threads available to help with the recording.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool shouldUseSecondaryCmdBuffers() noexcept {
+    return (GameJobs::getNumWorkers() > 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: get or reset the peak usage statistics for the vertex buffers used for drawing
+//------------------------------------------------------------------------------------------------------------------------------------------
+const VVertexBufferStats& getVertexBufferStats() noexcept {
+    return gVertexBuffers_Draw.stats;
+}
+
+void resetVertexBufferStats() noexcept {
+    gVertexBuffers_Draw.stats = {};
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -227,6 +718,9 @@ void setDrawPipeline(const VPipelineType type) noexcept {
     endCurrentDrawBatch();
     gCurDrawPipelineType = type;
 
+    // PsyDoom: time the batch of draws using this pipeline on the GPU
+    addTimestampMarkCmd(PIPELINE_TYPE_NAMES[(size_t) type]);
+
     DrawCmd& drawCmd = gFrameDrawCmds.emplace_back();
     drawCmd.type = DrawCmdType::SetPipeline;
     drawCmd.arg1 = (uint32_t) type;
@@ -303,10 +797,19 @@ void endCurrentDrawBatch() noexcept {
     if (gVertexBuffers_Draw.curBatchSize <= 0)
         return;
 
-    // Record the draw command
+    // Record the draw command.
+    // PsyDoom: quad batches are drawn indexed, with 4 vertices per quad.
     DrawCmd& drawCmd = gFrameDrawCmds.emplace_back();
-    drawCmd.type = DrawCmdType::Draw;
-    drawCmd.arg1 = gVertexBuffers_Draw.curBatchSize;
+
+    if (gbCurDrawBatchIsQuads) {
+        ASSERT(gVertexBuffers_Draw.curBatchSize % 4 == 0);
+        drawCmd.type = DrawCmdType::DrawQuads;
+        drawCmd.arg1 = gVertexBuffers_Draw.curBatchSize / 4;
+    } else {
+        drawCmd.type = DrawCmdType::Draw;
+        drawCmd.arg1 = gVertexBuffers_Draw.curBatchSize;
+    }
+
     drawCmd.arg2 = gVertexBuffers_Draw.curBatchStart;
     gVertexBuffers_Draw.endCurrentDrawBatch();
 }
@@ -324,7 +827,7 @@ void addUILine(
     const uint8_t b
 ) noexcept {
     // Fill in the vertices, starting first with common parameters
-    VVertex_Draw* const pVerts = gVertexBuffers_Draw.allocVerts<VVertex_Draw>(2);
+    VVertex_Draw* const pVerts = allocDrawVerts(2);
 
     for (uint32_t i = 0; i < 2; ++i) {
         VVertex_Draw& vert = pVerts[i];
@@ -360,7 +863,7 @@ void addFlatColoredTriangle(
     const uint8_t g,
     const uint8_t b
 ) noexcept {
-    VVertex_Draw* const pVerts = gVertexBuffers_Draw.allocVerts<VVertex_Draw>(3);
+    VVertex_Draw* const pVerts = allocDrawVerts(3);
 
     for (uint32_t i = 0; i < 3; ++i) {
         VVertex_Draw& vert = pVerts[i];
@@ -399,9 +902,9 @@ void addFlatColoredQuad(
     const uint8_t g,
     const uint8_t b
 ) noexcept {
-    VVertex_Draw* const pVerts = gVertexBuffers_Draw.allocVerts<VVertex_Draw>(6);
+    VVertex_Draw* const pVerts = allocQuadVerts();
 
-    for (uint32_t i = 0; i < 6; ++i) {
+    for (uint32_t i = 0; i < 4; ++i) {
         VVertex_Draw& vert = pVerts[i];
         vert = {};
         vert.r = r;
@@ -416,9 +919,7 @@ void addFlatColoredQuad(
     pVerts[0].x = x1;   pVerts[0].y = y1;   pVerts[0].z = z1;
     pVerts[1].x = x2;   pVerts[1].y = y2;   pVerts[1].z = z2;
     pVerts[2].x = x3;   pVerts[2].y = y3;   pVerts[2].z = z3;
-    pVerts[3].x = x3;   pVerts[3].y = y3;   pVerts[3].z = z3;
-    pVerts[4].x = x4;   pVerts[4].y = y4;   pVerts[4].z = z4;
-    pVerts[5].x = x1;   pVerts[5].y = y1;   pVerts[5].z = z1;
+    pVerts[3].x = x4;   pVerts[3].y = y4;   pVerts[3].z = z4;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -443,9 +944,9 @@ void addUISprite(
     const uint16_t texWinH
 ) noexcept {
     // Fill in the vertices, starting first with common parameters
-    VVertex_Draw* const pVerts = gVertexBuffers_Draw.allocVerts<VVertex_Draw>(6);
+    VVertex_Draw* const pVerts = allocQuadVerts();
 
-    for (uint32_t i = 0; i < 6; ++i) {
+    for (uint32_t i = 0; i < 4; ++i) {
         VVertex_Draw& vert = pVerts[i];
         vert.z = {};                // Unused for UI shaders
         vert.r = r;
@@ -478,16 +979,12 @@ void addUISprite(
     pVerts[0].x = xl;   pVerts[0].y = yt;
     pVerts[1].x = xr;   pVerts[1].y = yt;
     pVerts[2].x = xr;   pVerts[2].y = yb;
-    pVerts[3].x = xr;   pVerts[3].y = yb;
-    pVerts[4].x = xl;   pVerts[4].y = yb;
-    pVerts[5].x = xl;   pVerts[5].y = yt;
+    pVerts[3].x = xl;   pVerts[3].y = yb;
 
     pVerts[0].u = ul;   pVerts[0].v = vt;
     pVerts[1].u = ur;   pVerts[1].v = vt;
     pVerts[2].u = ur;   pVerts[2].v = vb;
-    pVerts[3].u = ur;   pVerts[3].v = vb;
-    pVerts[4].u = ul;   pVerts[4].v = vb;
-    pVerts[5].u = ul;   pVerts[5].v = vt;
+    pVerts[3].u = ul;   pVerts[3].v = vb;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -530,7 +1027,7 @@ void addWorldTriangle(
     const uint8_t stMulA
 ) noexcept {
     // Fill in the vertices, starting first with common parameters
-    VVertex_Draw* const pVerts = gVertexBuffers_Draw.allocVerts<VVertex_Draw>(3);
+    VVertex_Draw* const pVerts = allocDrawVerts(3);
 
     for (uint32_t i = 0; i < 3; ++i) {
         VVertex_Draw& vert = pVerts[i];
@@ -586,9 +1083,9 @@ void addWorldQuad(
     const uint8_t stMulA
 ) noexcept {
     // Fill in the vertices, starting first with the parameters that are the same for all vertices
-    VVertex_Draw* const pVerts = gVertexBuffers_Draw.allocVerts<VVertex_Draw>(6);
+    VVertex_Draw* const pVerts = allocQuadVerts();
 
-    for (uint32_t i = 0; i < 6; ++i) {
+    for (uint32_t i = 0; i < 4; ++i) {
         VVertex_Draw& vert = pVerts[i];
         vert.texWinX = texWinX;
         vert.texWinY = texWinY;
@@ -618,9 +1115,93 @@ void addWorldQuad(
     assignVertexUniqueAttribs(pVerts[0], v1);
     assignVertexUniqueAttribs(pVerts[1], v2);
     assignVertexUniqueAttribs(pVerts[2], v3);
-    assignVertexUniqueAttribs(pVerts[3], v3);
-    assignVertexUniqueAttribs(pVerts[4], v4);
-    assignVertexUniqueAttribs(pVerts[5], v1);
+    assignVertexUniqueAttribs(pVerts[3], v4);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: add a vertical quad for a sprite in the game's 3D view/world to the 'draw' subpass.
+// This is a faster alternative to 'addWorldQuad' for sprites, which only need their 2 xz endpoints, top and bottom 'y' and UV extents.
+// All attributes which are shared among the vertices are filled in once and copied; the same notes as 'addWorldQuad' also apply here.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void addWorldSprite(
+    const float x1,
+    const float z1,
+    const float x2,
+    const float z2,
+    const float yt,
+    const float yb,
+    const float ul,
+    const float ur,
+    const float vt,
+    const float vb,
+    const uint8_t r,
+    const uint8_t g,
+    const uint8_t b,
+    const uint16_t clutX,
+    const uint16_t clutY,
+    const uint16_t texWinX,
+    const uint16_t texWinY,
+    const uint16_t texWinW,
+    const uint16_t texWinH,
+    const uint8_t stMulR,
+    const uint8_t stMulG,
+    const uint8_t stMulB,
+    const uint8_t stMulA
+) noexcept {
+    // Build the bottom left vertex first, including all of the shared attributes
+    VVertex_Draw vertBL;
+    vertBL.x = x1;
+    vertBL.y = yb;
+    vertBL.z = z1;
+    vertBL.r = r;
+    vertBL.g = g;
+    vertBL.b = b;
+    vertBL.lightDimMode = VLightDimMode::None;
+    vertBL.u = ul;
+    vertBL.v = vb;
+    vertBL.texWinX = texWinX;
+    vertBL.texWinY = texWinY;
+    vertBL.texWinW = texWinW;
+    vertBL.texWinH = texWinH;
+    vertBL.clutX = clutX;
+    vertBL.clutY = clutY;
+    vertBL.stmulR = stMulR;
+    vertBL.stmulG = stMulG;
+    vertBL.stmulB = stMulB;
+    vertBL.stmulA = stMulA;
+
+    // Derive the other corners from it, only changing the attributes which differ
+    VVertex_Draw vertTL = vertBL;
+    vertTL.y = yt;
+    vertTL.v = vt;
+
+    VVertex_Draw vertTR = vertTL;
+    vertTR.x = x2;
+    vertTR.z = z2;
+    vertTR.u = ur;
+
+    VVertex_Draw vertBR = vertTR;
+    vertBR.y = yb;
+    vertBR.v = vb;
+
+    // Output the quad, in the same order as 'addWorldQuad' would
+    VVertex_Draw* const pVerts = allocQuadVerts();
+    pVerts[0] = vertBL;
+    pVerts[1] = vertTL;
+    pVerts[2] = vertTR;
+    pVerts[3] = vertBR;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Add pre-built triangles for the game's 3D view/world to the 'draw' subpass, by copying the given vertices.
+// Useful for geometry which is cached and re-used over multiple frames; the same notes as 'addWorldTriangle' apply to the vertices.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void addWorldVerts(const VVertex_Draw* const pVerts, const uint32_t numVerts) noexcept {
+    ASSERT(pVerts || (numVerts == 0));
+    ASSERT(numVerts % 3 == 0);
+
+    VVertex_Draw* const pDstVerts = allocDrawVerts(numVerts);
+    std::memcpy(pDstVerts, pVerts, sizeof(VVertex_Draw) * numVerts);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -645,9 +1226,9 @@ void addWorldInfiniteSkyWall(
 ) noexcept {
     // Fill in the vertices, starting first with common parameters.
     // Note: we store the sky U offset based on player rotation in the U coordinate.
-    VVertex_Draw* const pVerts = gVertexBuffers_Draw.allocVerts<VVertex_Draw>(6);
+    VVertex_Draw* const pVerts = allocQuadVerts();
 
-    for (uint32_t i = 0; i < 6; ++i) {
+    for (uint32_t i = 0; i < 4; ++i) {
         VVertex_Draw& vert = pVerts[i];
         vert.y = y;
         vert.r = 128;
@@ -669,31 +1250,26 @@ void addWorldInfiniteSkyWall(
 
     // Note: the 'v' coordinate is used to determine whether the vertex is for the bottom or the top of the sky wall.
     // If the 'v' coord is '-1' or '+1' then it means the vertex should be stretched past the top (+1) or bottom (-1) of the screen.
-    pVerts[0].x = x1;   pVerts[0].z = z1;
+    // PsyDoom: the quad starts at the 2nd endpoint so that the triangle winding matches what it was before quads were indexed.
+    pVerts[0].x = x2;   pVerts[0].z = z2;
     pVerts[1].x = x2;   pVerts[1].z = z2;
-    pVerts[2].x = x2;   pVerts[2].z = z2;
-    pVerts[3].x = x2;   pVerts[3].z = z2;
-    pVerts[4].x = x1;   pVerts[4].z = z1;
-    pVerts[5].x = x1;   pVerts[5].z = z1;
+    pVerts[2].x = x1;   pVerts[2].z = z1;
+    pVerts[3].x = x1;   pVerts[3].z = z1;
 
     // Make the skywall be a certain fixed height to begin with.
     // This should be enough for most situations but the vertex shader will also stretch the wall past the ends of the screen too.
     constexpr float EXTRUDE_AMT = 1024.0f;
 
     if (bIsUpperSkyWall) {
-        pVerts[0].y = y;                pVerts[0].v = 0.0f;
-        pVerts[1].y = y + EXTRUDE_AMT;  pVerts[1].v = 1.0f;
+        pVerts[0].y = y + EXTRUDE_AMT;  pVerts[0].v = 1.0f;
+        pVerts[1].y = y;                pVerts[1].v = 0.0f;
         pVerts[2].y = y;                pVerts[2].v = 0.0f;
         pVerts[3].y = y + EXTRUDE_AMT;  pVerts[3].v = 1.0f;
-        pVerts[4].y = y;                pVerts[4].v = 0.0f;
-        pVerts[5].y = y + EXTRUDE_AMT;  pVerts[5].v = 1.0f;
     } else {
-        pVerts[0].y = y - EXTRUDE_AMT;  pVerts[0].v = -1.0f;
-        pVerts[1].y = y;                pVerts[1].v =  0.0f;
+        pVerts[0].y = y;                pVerts[0].v =  0.0f;
+        pVerts[1].y = y - EXTRUDE_AMT;  pVerts[1].v = -1.0f;
         pVerts[2].y = y - EXTRUDE_AMT;  pVerts[2].v = -1.0f;
         pVerts[3].y = y;                pVerts[3].v =  0.0f;
-        pVerts[4].y = y - EXTRUDE_AMT;  pVerts[4].v = -1.0f;
-        pVerts[5].y = y;                pVerts[5].v =  0.0f;
     }
 }
 
@@ -723,9 +1299,9 @@ void addWorldSkyQuad(
 ) noexcept {
     // Fill in the vertices, starting first with common parameters.
     // Note: we store the sky U offset based on player rotation in the U coordinate.
-    VVertex_Draw* const pVerts = gVertexBuffers_Draw.allocVerts<VVertex_Draw>(6);
+    VVertex_Draw* const pVerts = allocQuadVerts();
 
-    for (uint32_t i = 0; i < 6; ++i) {
+    for (uint32_t i = 0; i < 4; ++i) {
         VVertex_Draw& vert = pVerts[i];
         vert.r = 128;
         vert.g = 128;
@@ -749,9 +1325,7 @@ void addWorldSkyQuad(
     pVerts[0].x = x1;   pVerts[0].y = y1;   pVerts[0].z = z1;
     pVerts[1].x = x2;   pVerts[1].y = y2;   pVerts[1].z = z2;
     pVerts[2].x = x3;   pVerts[2].y = y3;   pVerts[2].z = z3;
-    pVerts[3].x = x3;   pVerts[3].y = y3;   pVerts[3].z = z3;
-    pVerts[4].x = x4;   pVerts[4].y = y4;   pVerts[4].z = z4;
-    pVerts[5].x = x1;   pVerts[5].y = y1;   pVerts[5].z = z1;
+    pVerts[3].x = x4;   pVerts[3].y = y4;   pVerts[3].z = z4;
 }
 
 END_NAMESPACE(VDrawing)
@@ -13,6 +13,7 @@ namespace vgl {
     class CmdBufferRecorder;
     class Framebuffer;
     class LogicalDevice;
+    class RenderPass;
 }
 
 namespace Gpu {
@@ -24,6 +25,8 @@ enum class VLightDimMode : uint8_t;
 enum class VPipelineType : uint8_t;
 enum class VPipelineType : uint8_t;
 struct VShaderUniforms_Draw;
+struct VVertex_Draw;
+struct VVertexBufferStats;
 
 BEGIN_NAMESPACE(VDrawing)
 
@@ -38,6 +41,10 @@ void init(vgl::LogicalDevice& device, vgl::BaseTexture& vramTex) noexcept;
 void shutdown() noexcept;
 void beginFrame(const uint32_t ringbufferIdx) noexcept;
 void endFrame(vgl::CmdBufferRecorder& cmdRec) noexcept;
+void endFrame(vgl::CmdBufferRecorder& cmdRec, const vgl::RenderPass& renderPass, const vgl::Framebuffer& framebuffer) noexcept;
+bool shouldUseSecondaryCmdBuffers() noexcept;
+const VVertexBufferStats& getVertexBufferStats() noexcept;
+void resetVertexBufferStats() noexcept;
 void setDrawPipeline(const VPipelineType type) noexcept;
 void setDrawUniforms(const VShaderUniforms_Draw& uniforms) noexcept;
 Matrix4f computeTransformMatrixForUI(const bool bAllowWidescreen) noexcept;
@@ -156,6 +163,34 @@ void addWorldQuad(
     const uint8_t stMulA
 ) noexcept;
 
+void addWorldSprite(
+    const float x1,
+    const float z1,
+    const float x2,
+    const float z2,
+    const float yt,
+    const float yb,
+    const float ul,
+    const float ur,
+    const float vt,
+    const float vb,
+    const uint8_t r,
+    const uint8_t g,
+    const uint8_t b,
+    const uint16_t clutX,
+    const uint16_t clutY,
+    const uint16_t texWinX,
+    const uint16_t texWinY,
+    const uint16_t texWinW,
+    const uint16_t texWinH,
+    const uint8_t stMulR,
+    const uint8_t stMulG,
+    const uint8_t stMulB,
+    const uint8_t stMulA
+) noexcept;
+
+void addWorldVerts(const VVertex_Draw* const pVerts, const uint32_t numVerts) noexcept;
+
 void addWorldInfiniteSkyWall(
     const float x1,
     const float z1,
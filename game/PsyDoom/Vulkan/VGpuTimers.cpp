@@ -0,0 +1,235 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A module that measures how long the GPU takes to execute each frame's commands using timestamp queries.
+//
+// There is a range of timestamp queries for each ringbuffer slot. The results for a slot are read back when the slot is next used, at
+// which point the ringbuffer slot fence guarantees the commands have finished executing, so reading never needs to wait. This means
+// results are always collected a few frames late. The overall GPU time for each frame is always measured, for the perf counters.
+//
+// When the profiler is enabled, the frame can also be divided up into labelled intervals by writing 'marks' (timestamps) to the command
+// buffer: each interval runs from one mark to the next and is named by the label of the mark which starts it. The render path for the
+// frame and any labelled intervals are added to the profiler trace as GPU zones. GPU timestamps are in a different clock domain to CPU
+// times, so the CPU time at which each frame was submitted is used as the start time of the frame's GPU work. This places GPU zones
+// somewhat earlier on the timeline than when the work actually ran, but the durations and relative timings of the zones are accurate.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "VGpuTimers.h"
+
+#if PSYDOOM_VULKAN_RENDERER
+
+#include "Asserts.h"
+#include "CmdBufferRecorder.h"
+#include "Defines.h"
+#include "LogicalDevice.h"
+#include "PhysicalDevice.h"
+#include "PsyDoom/Profiler.h"
+#include "QueryPool.h"
+
+#include <chrono>
+
+BEGIN_NAMESPACE(VGpuTimers)
+
+// How many timestamp marks can be written per frame, including the marks for the start and end of the frame.
+// Only the start and end of the frame are measured if the profiler is not enabled, since there is nowhere to put more detailed timings.
+#if PSYDOOM_PROFILER
+    static constexpr uint32_t MAX_MARKS_PER_FRAME = 256;
+#else
+    static constexpr uint32_t MAX_MARKS_PER_FRAME = 2;
+#endif
+
+typedef std::chrono::steady_clock Clock;
+
+// Marks reserved for a frame using a particular ringbuffer slot
+struct FrameMarks {
+    uint32_t            numMarks;                           // How many marks were reserved for the frame, including the frame start & end
+    bool                bPending;                           // True if the frame was submitted and the results have not been read yet
+    const char*         frameName;                          // Name for the frame's zone in the profiler: the render path used
+    const char*         labels[MAX_MARKS_PER_FRAME];        // Label for the interval starting at each mark, or 'nullptr' if unlabelled
+    Clock::time_point   submitTime;                         // CPU time at which the frame's commands were submitted
+};
+
+static vgl::QueryPool   gTimestampQueries;                                  // Timestamp queries: not created if the device does not support timestamps
+static FrameMarks       gFrameMarks[vgl::Defines::RINGBUFFER_SIZE];         // Marks for each ringbuffer slot
+static uint64_t         gTimestampMask;                                     // Mask for the valid bits in a timestamp
+static double           gTimestampPeriodNs;                                 // How many nanoseconds each timestamp tick is
+static uint32_t         gCurRingbufferIdx;                                  // Ringbuffer slot for the current frame
+static bool             gbInFrame;                                          // True if a frame is currently being recorded and timed
+static float            gFrameTimeUsec = -1.0f;                             // The most recently measured GPU frame time, or '-1' if unknown
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts a difference in GPU timestamps to nanoseconds
+//------------------------------------------------------------------------------------------------------------------------------------------
+static double timestampDiffToNs(const uint64_t startTimestamp, const uint64_t endTimestamp) noexcept {
+    const uint64_t elapsedTicks = (endTimestamp - startTimestamp) & gTimestampMask;
+    return (double) elapsedTicks * gTimestampPeriodNs;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds the results for a frame to the profiler, if it is enabled
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void addFrameToProfiler([[maybe_unused]] const FrameMarks& frameMarks, [[maybe_unused]] const uint64_t* const pTimestamps) noexcept {
+    #if PSYDOOM_PROFILER
+        const uint32_t numMarks = frameMarks.numMarks;
+
+        const auto getMarkCpuTime = [&](const uint32_t markIdx) noexcept {
+            const double offsetNs = timestampDiffToNs(pTimestamps[0], pTimestamps[markIdx]);
+            return frameMarks.submitTime + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::nano>(offsetNs));
+        };
+
+        Profiler::addGpuZone(frameMarks.frameName, frameMarks.submitTime, getMarkCpuTime(numMarks - 1));
+
+        for (uint32_t markIdx = 0; markIdx + 1 < numMarks; ++markIdx) {
+            if (frameMarks.labels[markIdx]) {
+                Profiler::addGpuZone(frameMarks.labels[markIdx], getMarkCpuTime(markIdx), getMarkCpuTime(markIdx + 1));
+            }
+        }
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads back the results for the last frame which used the given ringbuffer slot, if the results are available
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void readFrameResults(const uint32_t ringbufferIdx) noexcept {
+    FrameMarks& frameMarks = gFrameMarks[ringbufferIdx];
+
+    if (!frameMarks.bPending)
+        return;
+
+    frameMarks.bPending = false;
+    uint64_t timestamps[MAX_MARKS_PER_FRAME];
+    ASSERT((frameMarks.numMarks >= 2) && (frameMarks.numMarks <= MAX_MARKS_PER_FRAME));
+
+    if (!gTimestampQueries.getResults(ringbufferIdx * MAX_MARKS_PER_FRAME, frameMarks.numMarks, timestamps))
+        return;
+
+    gFrameTimeUsec = (float)(timestampDiffToNs(timestamps[0], timestamps[frameMarks.numMarks - 1]) / 1000.0);
+    addFrameToProfiler(frameMarks, timestamps);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates the timestamp queries if the device's work queue supports timestamps.
+// Failure is not fatal, GPU frame times will just be unavailable.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void init(vgl::LogicalDevice& device, const vgl::PhysicalDevice& physicalDevice) noexcept {
+    const uint32_t queueFamilyIdx = device.getWorkQueueFamilyIdx();
+    const uint32_t timestampValidBits = physicalDevice.getQueueFamilyProps()[queueFamilyIdx].timestampValidBits;
+
+    if (timestampValidBits == 0)
+        return;
+
+    if (!gTimestampQueries.init(device, VK_QUERY_TYPE_TIMESTAMP, vgl::Defines::RINGBUFFER_SIZE * MAX_MARKS_PER_FRAME))
+        return;
+
+    gTimestampMask = (timestampValidBits >= 64) ? UINT64_MAX : ((uint64_t) 1 << timestampValidBits) - 1;
+    gTimestampPeriodNs = physicalDevice.getProps().limits.timestampPeriod;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Destroys the timestamp queries and clears all timing results
+//------------------------------------------------------------------------------------------------------------------------------------------
+void destroy() noexcept {
+    gFrameTimeUsec = -1.0f;
+    gbInFrame = false;
+    gCurRingbufferIdx = 0;
+    gTimestampPeriodNs = 0.0;
+    gTimestampMask = 0;
+
+    for (FrameMarks& frameMarks : gFrameMarks) {
+        frameMarks = {};
+    }
+
+    gTimestampQueries.destroy(true);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads back the results for the last time this ringbuffer slot was used and starts timing the frame on the GPU.
+// The queries must be reset outside of a render pass, so this must be called before the render path begins the frame.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void beginFrame(vgl::CmdBufferRecorder& cmdRec, const uint32_t ringbufferIdx, const char* const frameName) noexcept {
+    ASSERT(!gbInFrame);
+    ASSERT(ringbufferIdx < vgl::Defines::RINGBUFFER_SIZE);
+
+    if (!gTimestampQueries.isValid())
+        return;
+
+    readFrameResults(ringbufferIdx);
+
+    FrameMarks& frameMarks = gFrameMarks[ringbufferIdx];
+    frameMarks.numMarks = 1;
+    frameMarks.frameName = frameName;
+    frameMarks.labels[0] = nullptr;
+
+    cmdRec.resetQueries(gTimestampQueries, ringbufferIdx * MAX_MARKS_PER_FRAME, MAX_MARKS_PER_FRAME);
+    cmdRec.writeTimestamp(VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, gTimestampQueries, ringbufferIdx * MAX_MARKS_PER_FRAME);
+
+    gCurRingbufferIdx = ringbufferIdx;
+    gbInFrame = true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Marks the end of the frame's GPU work: should be called just before the frame's commands are submitted
+//------------------------------------------------------------------------------------------------------------------------------------------
+void endFrame(vgl::CmdBufferRecorder& cmdRec) noexcept {
+    if (!gbInFrame)
+        return;
+
+    FrameMarks& frameMarks = gFrameMarks[gCurRingbufferIdx];
+    ASSERT(frameMarks.numMarks < MAX_MARKS_PER_FRAME);
+
+    const uint32_t endMarkIdx = frameMarks.numMarks++;
+    frameMarks.labels[endMarkIdx] = nullptr;
+    cmdRec.writeTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, gTimestampQueries, gCurRingbufferIdx * MAX_MARKS_PER_FRAME + endMarkIdx);
+
+    frameMarks.submitTime = Clock::now();
+    frameMarks.bPending = true;
+    gbInFrame = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reserves a timestamp mark for the current frame which begins an interval with the given label, or ends the previous interval if there
+// is no label. Marks must be reserved in the same order as the GPU executes them, and every reserved mark MUST be written by 'writeMark'.
+// This allows marks to be reserved up front and then written to secondary command buffers recorded later on other threads.
+// Returns 'INVALID_MARK' if the mark could not be reserved because detailed timing is unavailable or the frame has run out of marks.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t reserveMark(const char* const label) noexcept {
+    if (!gbInFrame)
+        return INVALID_MARK;
+
+    // Note: always leave room for the end of frame mark
+    FrameMarks& frameMarks = gFrameMarks[gCurRingbufferIdx];
+
+    if (frameMarks.numMarks + 1 >= MAX_MARKS_PER_FRAME)
+        return INVALID_MARK;
+
+    const uint32_t markIdx = frameMarks.numMarks++;
+    frameMarks.labels[markIdx] = label;
+    return gCurRingbufferIdx * MAX_MARKS_PER_FRAME + markIdx;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes a previously reserved timestamp mark to the given command buffer; does nothing if the mark is invalid.
+// The timestamp is written once all previous commands have finished executing, so that it marks the end of the previous interval.
+// This is safe to call from any thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void writeMark(vgl::CmdBufferRecorder& cmdRec, const uint32_t mark) noexcept {
+    if (mark != INVALID_MARK) {
+        cmdRec.writeTimestamp(VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, gTimestampQueries, mark);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reserves and immediately writes a timestamp mark to the given command buffer, which begins an interval with the given label
+//------------------------------------------------------------------------------------------------------------------------------------------
+void mark(vgl::CmdBufferRecorder& cmdRec, const char* const label) noexcept {
+    writeMark(cmdRec, reserveMark(label));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns how long the GPU took to execute the commands for the most recently measured frame, in microseconds.
+// Due to frames being in flight this lags a few frames behind the current frame. Returns a negative value if GPU time is unavailable.
+//------------------------------------------------------------------------------------------------------------------------------------------
+float getFrameTimeUsec() noexcept {
+    return gFrameTimeUsec;
+}
+
+END_NAMESPACE(VGpuTimers)
+
+#endif  // #if PSYDOOM_VULKAN_RENDERER
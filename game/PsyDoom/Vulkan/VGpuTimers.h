@@ -0,0 +1,31 @@
+#pragma once
+
+#if PSYDOOM_VULKAN_RENDERER
+
+#include "Macros.h"
+
+#include <cstdint>
+
+namespace vgl {
+    class CmdBufferRecorder;
+    class LogicalDevice;
+    class PhysicalDevice;
+}
+
+BEGIN_NAMESPACE(VGpuTimers)
+
+// Returned when a timestamp mark could not be reserved
+static constexpr uint32_t INVALID_MARK = UINT32_MAX;
+
+void init(vgl::LogicalDevice& device, const vgl::PhysicalDevice& physicalDevice) noexcept;
+void destroy() noexcept;
+void beginFrame(vgl::CmdBufferRecorder& cmdRec, const uint32_t ringbufferIdx, const char* const frameName) noexcept;
+void endFrame(vgl::CmdBufferRecorder& cmdRec) noexcept;
+uint32_t reserveMark(const char* const label) noexcept;
+void writeMark(vgl::CmdBufferRecorder& cmdRec, const uint32_t mark) noexcept;
+void mark(vgl::CmdBufferRecorder& cmdRec, const char* const label) noexcept;
+float getFrameTimeUsec() noexcept;
+
+END_NAMESPACE(VGpuTimers)
+
+#endif  // #if PSYDOOM_VULKAN_RENDERER
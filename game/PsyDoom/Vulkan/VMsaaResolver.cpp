@@ -13,6 +13,8 @@
 //------------------------------------------------------------------------------------------------------------------------------------------
 VMsaaResolver::VMsaaResolver() noexcept
     : mbIsValid(false)
+    , mbResolveWithShader(false)
+    , mpDevice(nullptr)
     , mVertexBuffer()
     , mResolveAttachments{}
     , mDescriptorPool()
@@ -30,12 +32,18 @@ VMsaaResolver::~VMsaaResolver() noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes the MSAA resolver and sets up its main resources.
 // Note that this init does NOT create the resolve color attachments, that must be done in a separate call.
+// If not resolving with a shader then the render pass must do the resolve via subpass resolve attachments.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void VMsaaResolver::init(vgl::LogicalDevice& device) noexcept {
+void VMsaaResolver::init(vgl::LogicalDevice& device, const bool bResolveWithShader) noexcept {
     ASSERT_LOG((!mbIsValid), "VMsaaResolver is already initialized!");
 
-    initVertexBuffer(device);
-    initDescriptorPoolAndSets(device);
+    if (bResolveWithShader) {
+        initVertexBuffer(device);
+        initDescriptorPoolAndSets(device);
+    }
+
+    mbResolveWithShader = bResolveWithShader;
+    mpDevice = &device;
     mbIsValid = true;
 }
 
@@ -55,6 +63,8 @@ void VMsaaResolver::destroy() noexcept {
     mDescriptorPool.destroy(true);
     destroyResolveAttachments();
     mVertexBuffer.destroy(true);
+    mpDevice = nullptr;
+    mbResolveWithShader = false;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -63,7 +73,7 @@ void VMsaaResolver::destroy() noexcept {
 bool VMsaaResolver::createResolveAttachments(const VkFormat format, const uint32_t fbWidth, const uint32_t fbHeight) noexcept {
     // Get the render device used
     ASSERT(mbIsValid);
-    vgl::LogicalDevice& device = *mVertexBuffer.getDevice();
+    vgl::LogicalDevice& device = *mpDevice;
 
     // Create or re-create the attachements
     for (vgl::RenderTexture& attachment : mResolveAttachments) {
@@ -92,6 +102,7 @@ void VMsaaResolver::destroyResolveAttachments() noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 void VMsaaResolver::setInputAttachments(const vgl::BaseTexture inputAttachments[vgl::Defines::RINGBUFFER_SIZE]) noexcept {
     ASSERT(mbIsValid);
+    ASSERT(mbResolveWithShader);
 
     for (uint32_t i = 0; i < vgl::Defines::RINGBUFFER_SIZE; ++i) {
         ASSERT(mpDescriptorSets[i]);
@@ -101,12 +112,13 @@ void VMsaaResolver::setInputAttachments(const vgl::BaseTexture inputAttachments[
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Schedules an MSAA resolve to happen.
-// Assumes we have already transitioned to the subpass for MSAA resolve.
+// Assumes we have already transitioned to the subpass for MSAA resolve, and that we are resolving with a shader.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void VMsaaResolver::resolve(vgl::CmdBufferRecorder& cmdRec) noexcept {
     // Get the render device
     ASSERT(mbIsValid);
-    vgl::LogicalDevice& device = *mVertexBuffer.getDevice();
+    ASSERT(mbResolveWithShader);
+    vgl::LogicalDevice& device = *mpDevice;
 
     // Set the viewport and scissors rect dimensions
     const uint32_t fbWidth = mResolveAttachments[0].getWidth();
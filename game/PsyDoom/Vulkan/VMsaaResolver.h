@@ -13,14 +13,17 @@ namespace vgl {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Handles the resolving of MSAA and the resources required for that is MSAA is enabled for the game
+// Handles the resolving of MSAA and the resources required for that is MSAA is enabled for the game.
+//
+// PsyDoom: the resolve can either be done by the fixed function hardware (via subpass resolve attachments) or with a custom shader in a
+// separate subpass. When the hardware does the resolve this class just owns the resolve attachments, and the shader resources are not made.
 //------------------------------------------------------------------------------------------------------------------------------------------
 class VMsaaResolver {
 public:
     VMsaaResolver() noexcept;
     ~VMsaaResolver() noexcept;
 
-    void init(vgl::LogicalDevice& device) noexcept;
+    void init(vgl::LogicalDevice& device, const bool bResolveWithShader) noexcept;
     void destroy() noexcept;
 
     bool createResolveAttachments(const VkFormat format, const uint32_t fbWidth, const uint32_t fbHeight) noexcept;
@@ -34,6 +37,7 @@ public:
     }
 
     bool areAllResolveAttachmentsValid(const uint32_t fbWidth, const uint32_t fbHeight) noexcept;
+    inline bool isResolvingWithShader() const noexcept { return mbResolveWithShader; }
 
 private:
     void initVertexBuffer(vgl::LogicalDevice& device) noexcept;
@@ -42,8 +46,14 @@ private:
     // Set to true once the resolver is validly initialized
     bool mbIsValid;
 
+    // PsyDoom: if true then the resolve is done using a custom shader in a separate subpass, otherwise it is done by subpass resolve attachments
+    bool mbResolveWithShader;
+
+    // The device used by the resolver
+    vgl::LogicalDevice* mpDevice;
+
     // A vertex buffer containing a single quad (two triangles) of vertex type 'VVertex_MsaaResolve' covering the entire screen.
-    // This is used to draw a screen quad during MSAA resolve.
+    // This is used to draw a screen quad during MSAA resolve, when resolving with a shader.
     vgl::Buffer mVertexBuffer;
 
     // Destination color attachments for resolving MSAA samples to 1 sample
@@ -7,16 +7,23 @@
 
 #include "DescriptorSetLayout.h"
 #include "FatalErrors.h"
+#include "FileUtils.h"
 #include "LogicalDevice.h"
 #include "PhysicalDevice.h"
 #include "Pipeline.h"
+#include "PipelineCache.h"
 #include "PipelineLayout.h"
 #include "PsyDoom/Config/Config.h"
+#include "PsyDoom/Utils.h"
 #include "Sampler.h"
 #include "ShaderModule.h"
 #include "VRenderPath_Crossfade.h"
 #include "VRenderPath_Main.h"
 
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 BEGIN_NAMESPACE(VPipelines)
 
 // The raw SPIRV binary code for the shaders
@@ -136,6 +143,52 @@ vgl::PipelineDepthStencilState gDepthState_disabled;        // No depth/stencil
 // The pipelines themselves
 vgl::Pipeline gPipelines[(size_t) VPipelineType::NUM_TYPES];
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: header for the pipeline cache file saved in the user data folder.
+// Identifies the device and driver that the cache data was generated by, so that cache data for a different device or driver is ignored.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct PipelineCacheFileHeader {
+    uint32_t    fileId;                                 // Should be 'PIPELINE_CACHE_FILE_ID'
+    uint32_t    fileVersion;                            // Should be 'PIPELINE_CACHE_FILE_VERSION'
+    uint32_t    vendorId;                               // Which GPU vendor the cache data is for
+    uint32_t    deviceId;                               // Which GPU device the cache data is for
+    uint32_t    driverVersion;                          // Which driver version the cache data is for
+    uint8_t     pipelineCacheUuid[VK_UUID_SIZE];        // The driver's pipeline cache UUID when the cache data was generated
+    uint32_t    dataSize;                               // Size of the cache data following this header
+};
+
+static constexpr const char* PIPELINE_CACHE_FILE_NAME = "vulkan_pipeline_cache.bin";
+static constexpr uint32_t PIPELINE_CACHE_FILE_ID = 0x43504450;      // 'PDPC' in little endian
+static constexpr uint32_t PIPELINE_CACHE_FILE_VERSION = 1;
+
+// PsyDoom: the pipeline cache used to speed up pipeline creation, the device it is for and the cache data it was initialized with
+static vgl::PipelineCache       gPipelineCache;
+static vgl::LogicalDevice*      gpPipelineCacheDevice;
+static std::vector<std::byte>   gInitialPipelineCacheData;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: makes a pipeline cache file header for the given device, minus the size of the cache data
+//------------------------------------------------------------------------------------------------------------------------------------------
+static PipelineCacheFileHeader makePipelineCacheFileHeader(vgl::LogicalDevice& device) noexcept {
+    const VkPhysicalDeviceProperties& deviceProps = device.getPhysicalDevice()->getProps();
+
+    PipelineCacheFileHeader header = {};
+    header.fileId = PIPELINE_CACHE_FILE_ID;
+    header.fileVersion = PIPELINE_CACHE_FILE_VERSION;
+    header.vendorId = deviceProps.vendorID;
+    header.deviceId = deviceProps.deviceID;
+    header.driverVersion = deviceProps.driverVersion;
+    std::memcpy(header.pipelineCacheUuid, deviceProps.pipelineCacheUUID, VK_UUID_SIZE);
+    return header;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: get the path to the pipeline cache file in the user data folder
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::string getPipelineCacheFilePath() noexcept {
+    return Utils::getOrCreateUserDataFolder() + PIPELINE_CACHE_FILE_NAME;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initialize a single shader and raise a fatal error if it fails
 //-----------------------------------------------------------------------------------------------------------------------------------------
@@ -355,11 +408,14 @@ static void initPipelineMultisampleStates(vgl::LogicalDevice& device, const uint
     gMultisampleState_perSettings = vgl::PipelineMultisampleState().setToDefault();
     gMultisampleState_perSettings.rasterizationSamples = (VkSampleCountFlagBits) numSamples;
 
-    if (device.getPhysicalDevice()->getFeatures().sampleRateShading) {
+    // PsyDoom: the fraction of samples to shade is now configurable, since full rate shading of every sample is expensive at high sample counts
+    const float minSampleShading = std::min(Config::gAASampleShading, 1.0f);
+
+    if (device.getPhysicalDevice()->getFeatures().sampleRateShading && (minSampleShading > 0.0f)) {
         // Enable sample rate shading if we can get it for nicer MSAA.
-        // Force it to do MSAA for every single fragment to help eliminate texture shimmer and shader aliasing.
+        // By default force it to do MSAA for every single fragment to help eliminate texture shimmer and shader aliasing.
         gMultisampleState_perSettings.sampleShadingEnable = true;
-        gMultisampleState_perSettings.minSampleShading = 1.0f;
+        gMultisampleState_perSettings.minSampleShading = minSampleShading;
     }
 
     // This is a variant of the 'per settings' state but without sample rate shading (edge only MSAA).
@@ -476,7 +532,8 @@ static void initPipeline(
         rasterizerState,
         multisampleState,
         colorBlendState,
-        depthStencilState
+        depthStencilState,
+        (gPipelineCache.isValid()) ? &gPipelineCache : nullptr
     );
 
     if (!bSuccess)
@@ -536,6 +593,75 @@ static void initDrawPipeline(
     );
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: creates the pipeline cache used to speed up pipeline creation and loads any previously saved cache data for it.
+// Cache data is only used if it was generated by the same device and driver; if there is no usable data then the cache starts empty.
+// Failure to create the cache is not fatal, pipelines will just be created without one.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void initPipelineCache(vgl::LogicalDevice& device) noexcept {
+    ASSERT(!gPipelineCache.isValid());
+    gpPipelineCacheDevice = &device;
+    gInitialPipelineCacheData.clear();
+
+    // Try to read the cache data from the last run, if it's there and for this device and driver
+    const std::string cacheFilePath = getPipelineCacheFilePath();
+
+    if (FileUtils::fileExists(cacheFilePath.c_str())) {
+        const FileData fileData = FileUtils::getContentsOfFile(cacheFilePath.c_str());
+        const PipelineCacheFileHeader expectedHeader = makePipelineCacheFileHeader(device);
+        PipelineCacheFileHeader header = {};
+
+        if (fileData.bytes && (fileData.size >= sizeof(header))) {
+            std::memcpy(&header, fileData.bytes.get(), sizeof(header));
+            const uint32_t dataSize = header.dataSize;
+            header.dataSize = 0;
+
+            const bool bIsUsableData = (
+                (std::memcmp(&header, &expectedHeader, sizeof(header)) == 0) &&
+                (dataSize == fileData.size - sizeof(header))
+            );
+
+            if (bIsUsableData) {
+                const std::byte* const pData = fileData.bytes.get() + sizeof(header);
+                gInitialPipelineCacheData.assign(pData, pData + dataSize);
+            }
+        }
+    }
+
+    // Create the cache with whatever data we got
+    if (!gPipelineCache.init(device, gInitialPipelineCacheData.data(), gInitialPipelineCacheData.size())) {
+        gInitialPipelineCacheData.clear();
+        gPipelineCache.init(device, nullptr, 0);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: saves the pipeline cache data to the user data folder, so pipelines can be created faster on the next run.
+// The file is only written if the cache data has changed since it was loaded at startup.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void savePipelineCache() noexcept {
+    // Get the current cache data and don't bother saving if there is nothing new
+    if ((!gPipelineCache.isValid()) || (!gpPipelineCacheDevice))
+        return;
+
+    std::vector<std::byte> cacheData;
+
+    if ((!gPipelineCache.getData(cacheData)) || cacheData.empty() || (cacheData == gInitialPipelineCacheData))
+        return;
+
+    // Save the data along with a header identifying the device and driver it's for
+    PipelineCacheFileHeader header = makePipelineCacheFileHeader(*gpPipelineCacheDevice);
+    header.dataSize = (uint32_t) cacheData.size();
+
+    std::vector<std::byte> fileData(sizeof(header) + cacheData.size());
+    std::memcpy(fileData.data(), &header, sizeof(header));
+    std::memcpy(fileData.data() + sizeof(header), cacheData.data(), cacheData.size());
+
+    if (FileUtils::writeDataToFile(getPipelineCacheFilePath().c_str(), fileData.data(), fileData.size())) {
+        gInitialPipelineCacheData = std::move(cacheData);
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes all of the building blocks that make up pipelines, but not the pipelines themselves.
 // These elements have very few dependencies and can be initialized early in order to solve bootstrap dependency issues.
@@ -578,9 +704,9 @@ void initPipelines(
     initDrawPipeline(VPipelineType::World_SpriteSubtractive, mainRPath, gShaders_world, gInputAS_triList, gRasterState_noCull, gBlendState_subtractive, gDepthState_disabled, false, false);
     initDrawPipeline(VPipelineType::World_Sky, mainRPath, gShaders_sky, gInputAS_triList, gRasterState_backFaceCull, gBlendState_noBlend, gDepthState_disabled, true, true);
 
-    // The pipeline to resolve MSAA: only bother creating this if we are doing MSAA.
+    // The pipeline to resolve MSAA: only bother creating this if we are doing MSAA with a shader rather than with subpass resolve attachments.
     // Specialize the shader to the number of samples also, so that loops can be unrolled.
-    if (numSamples > 1) {
+    if ((numSamples > 1) && mainRPath.isUsingShaderMsaaResolve()) {
         const VkSpecializationMapEntry specializationMapEntries[] = {
             { 0, 0, sizeof(uint32_t) }
         };
@@ -641,6 +767,11 @@ void shutdown() noexcept {
         pipeline.destroy(true);
     }
 
+    gPipelineCache.destroy();
+    gpPipelineCacheDevice = nullptr;
+    gInitialPipelineCacheData.clear();
+    gInitialPipelineCacheData.shrink_to_fit();
+
     gPipelineLayout_loadingPlaque.destroy(true);
     gPipelineLayout_crossfade.destroy(true);
     gPipelineLayout_msaaResolve.destroy(true);
@@ -31,6 +31,8 @@ extern vgl::PipelineLayout          gPipelineLayout_crossfade;
 extern vgl::PipelineLayout          gPipelineLayout_loadingPlaque;
 extern vgl::Pipeline                gPipelines[(size_t) VPipelineType::NUM_TYPES];
 
+void initPipelineCache(vgl::LogicalDevice& device) noexcept;
+void savePipelineCache() noexcept;
 void initPipelineComponents(vgl::LogicalDevice& device, const uint32_t numSamples) noexcept;
 
 void initPipelines(
@@ -316,9 +316,10 @@ void drawPlaque(texture_t& plaqueTex, const int16_t plaqueX, const int16_t plaqu
         VRenderer::getActiveRenderPath().endFrame(VRenderer::gSwapchain, VRenderer::gCmdBufferRec);
         transitionBackgroundTexImageLayout();
 
-        // Ensure we are still set to be on the main render path and begin the next frame
+        // Ensure we are still set to be on the main render path and begin the next frame.
+        // PsyDoom: the plaque is drawn with commands recorded directly into the render pass, so secondary command buffers can't be used.
         VRenderer::setNextRenderPath(mainRenderPath);
-        mainRenderPath.beginFrame(VRenderer::gSwapchain, VRenderer::gCmdBufferRec);
+        mainRenderPath.beginFrameWithInlineCmds(VRenderer::gSwapchain, VRenderer::gCmdBufferRec);
 
         // What size is the view being rendered to?
         const uint32_t viewportW = VRenderer::gFramebufferW;
@@ -7,6 +7,7 @@
 #include "RenderPassDef.h"
 #include "Swapchain.h"
 #include "VDrawing.h"
+#include "VGpuTimers.h"
 #include "VRenderer.h"
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -23,6 +24,7 @@ VRenderPath_Main::VRenderPath_Main() noexcept
     , mColorAttachments{}
     , mFramebuffers{}
     , mbRenderedToFramebuffer{}
+    , mbUsingSecondaryCmdBuffers(false)
 {
 }
 
@@ -57,7 +59,7 @@ void VRenderPath_Main::init(
         FatalErrors::raise("Failed to create the main Vulkan renderpass!");
 
     if (mNumDrawSamples > 1) {
-        mMsaaResolver.init(device);
+        mMsaaResolver.init(device, isUsingShaderMsaaResolve());
     }
 
     // Now initialized
@@ -98,6 +100,7 @@ bool VRenderPath_Main::ensureValidFramebuffers(const uint32_t fbWidth, const uin
 
     // Recreate MSAA resolve attachments if needed
     const bool bDoingMsaa = (mNumDrawSamples > 1);
+    const bool bShaderMsaaResolve = isUsingShaderMsaaResolve();
 
     if (bDoingMsaa && (!mMsaaResolver.areAllResolveAttachmentsValid(fbWidth, fbHeight))) {
         if (!mMsaaResolver.createResolveAttachments(mResolveFormat, fbWidth, fbHeight))
@@ -124,10 +127,13 @@ bool VRenderPath_Main::ensureValidFramebuffers(const uint32_t fbWidth, const uin
         mColorAttachments[i].destroy(true);
         mbRenderedToFramebuffer[i] = false;
 
-        // Color attachment can either be used as a transfer & sampling source (for blits and crossfades, with no MSAA) or an input attachment for MSAA resolve
-        const VkImageUsageFlags colorAttachUsage = (mNumDrawSamples > 1) ?
-            VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT :
-            VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+        // Color attachment can either be used as a transfer & sampling source (for blits and crossfades, with no MSAA) or an input attachment for MSAA resolve.
+        // PsyDoom: if the render pass resolves MSAA itself then the multi-sampled attachment never leaves the render pass and can be transient.
+        VkImageUsageFlags colorAttachUsage = VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+
+        if (bDoingMsaa) {
+            colorAttachUsage = (bShaderMsaaResolve) ? VK_IMAGE_USAGE_INPUT_ATTACHMENT_BIT : VK_IMAGE_USAGE_TRANSIENT_ATTACHMENT_BIT;
+        }
 
         if (!mColorAttachments[i].initAsRenderTexture(device, true, mColorFormat, colorAttachUsage, fbWidth, fbHeight, mNumDrawSamples))
             return false;
@@ -147,7 +153,7 @@ bool VRenderPath_Main::ensureValidFramebuffers(const uint32_t fbWidth, const uin
     }
 
     // Need to set the input attachments for the MSAA resolver after creating framebuffer color attachments
-    if (bDoingMsaa && bCreatedColorAttachments) {
+    if (bShaderMsaaResolve && bCreatedColorAttachments) {
         mMsaaResolver.setInputAttachments(mColorAttachments);
     }
 
@@ -155,9 +161,25 @@ bool VRenderPath_Main::ensureValidFramebuffers(const uint32_t fbWidth, const uin
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Begins the frame for the render path
+// Begins the frame for the render path.
+// PsyDoom: the drawing commands for the frame will be recorded to secondary command buffers across multiple threads, if worthwhile.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void VRenderPath_Main::beginFrame(vgl::Swapchain& swapchain, vgl::CmdBufferRecorder& cmdRec) noexcept {
+    beginFrame(swapchain, cmdRec, VDrawing::shouldUseSecondaryCmdBuffers());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: begins the frame for the render path and ensures that commands can be recorded directly to the primary command buffer.
+// This is for code which wants to record it's own commands within the render pass, rather than going through the 'VDrawing' module.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void VRenderPath_Main::beginFrameWithInlineCmds(vgl::Swapchain& swapchain, vgl::CmdBufferRecorder& cmdRec) noexcept {
+    beginFrame(swapchain, cmdRec, false);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Begins the frame for the render path, optionally recording the drawing commands for the frame to secondary command buffers
+//------------------------------------------------------------------------------------------------------------------------------------------
+void VRenderPath_Main::beginFrame(vgl::Swapchain& swapchain, vgl::CmdBufferRecorder& cmdRec, const bool bUseSecondaryCmdBuffers) noexcept {
     // Sanity checks and getting the device
     ASSERT(mbIsValid);
     ASSERT(mpDevice);
@@ -196,10 +218,12 @@ void VRenderPath_Main::beginFrame(vgl::Swapchain& swapchain, vgl::CmdBufferRecor
     vgl::Framebuffer& framebuffer = mFramebuffers[ringbufferIdx];
     VkClearValue framebufferClearValues[1] = {};
 
+    mbUsingSecondaryCmdBuffers = bUseSecondaryCmdBuffers;
+
     cmdRec.beginRenderPass(
         mRenderPass,
         framebuffer,
-        VK_SUBPASS_CONTENTS_INLINE,
+        (bUseSecondaryCmdBuffers) ? VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS : VK_SUBPASS_CONTENTS_INLINE,
         0,
         0,
         framebuffer.getWidth(),
@@ -227,12 +251,20 @@ void VRenderPath_Main::endFrame(vgl::Swapchain& swapchain, vgl::CmdBufferRecorde
     vgl::LogicalDevice& device = *mpDevice;
 
     // Finish up drawing for the main rendering subpass
-    VDrawing::endFrame(cmdRec);
+    if (mbUsingSecondaryCmdBuffers) {
+        const uint32_t ringbufferIdx = device.getRingbufferMgr().getBufferIndex();
+        VDrawing::endFrame(cmdRec, mRenderPass, mFramebuffers[ringbufferIdx]);
+        mbUsingSecondaryCmdBuffers = false;
+    } else {
+        VDrawing::endFrame(cmdRec);
+    }
 
-    // Do an MSAA resolve subpass if MSAA is enabled
-    if (mNumDrawSamples > 1) {
+    // Do an MSAA resolve subpass if MSAA is enabled and the resolve is not done by the draw subpass itself
+    if (isUsingShaderMsaaResolve()) {
         cmdRec.nextSubpass(VK_SUBPASS_CONTENTS_INLINE);
+        VGpuTimers::mark(cmdRec, "Msaa_Resolve");
         mMsaaResolver.resolve(cmdRec);
+        VGpuTimers::mark(cmdRec, nullptr);
     }
 
     // Done with the render pass now
@@ -347,6 +379,7 @@ bool VRenderPath_Main::initRenderPass() noexcept {
 
     vgl::LogicalDevice& device = *mpDevice;
     const bool bMsaaEnabled = (mNumDrawSamples > 1);
+    const bool bShaderMsaaResolve = isUsingShaderMsaaResolve();
 
     // Define the color attachment
     vgl::RenderPassDef renderPassDef;
@@ -387,10 +420,19 @@ bool VRenderPath_Main::initRenderPass() noexcept {
         VkAttachmentReference& colorAttachRef = subpassDef.colorAttachments.emplace_back();
         colorAttachRef.attachment = 0;
         colorAttachRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+
+        // PsyDoom: if the draw and resolve formats match then let the hardware resolve MSAA at the end of this subpass.
+        // This saves a full screen pass and on tile based GPUs the resolve can happen on-chip.
+        if (bMsaaEnabled && (!bShaderMsaaResolve)) {
+            VkAttachmentReference& resolveAttachRef = subpassDef.colorResolveAttachments.emplace_back();
+            resolveAttachRef.attachment = 1;
+            resolveAttachRef.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+        }
     }
 
-    // If doing MSAA, define the MSAA color resolve subpass and the attachment resolved to as well as the input MSAA color attachment
-    if (bMsaaEnabled) {
+    // If doing MSAA with a shader (needed to convert from 16-bit color), define the MSAA color resolve subpass and the attachment resolved to
+    // as well as the input MSAA color attachment.
+    if (bShaderMsaaResolve) {
         vgl::SubpassDef& subpassDef = renderPassDef.subpasses.emplace_back();
 
         VkAttachmentReference& resolveAttachRef = subpassDef.colorAttachments.emplace_back();
@@ -412,12 +454,18 @@ bool VRenderPath_Main::initRenderPass() noexcept {
         dep.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
         dep.srcAccessMask = (bMsaaEnabled) ? VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT : VK_ACCESS_TRANSFER_READ_BIT;
         dep.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+
+        // PsyDoom: if the draw subpass also writes the MSAA resolve target then it must wait for the previous blit from that target to end
+        if (bMsaaEnabled && (!bShaderMsaaResolve)) {
+            dep.srcStageMask |= VK_PIPELINE_STAGE_TRANSFER_BIT;
+            dep.srcAccessMask |= VK_ACCESS_TRANSFER_READ_BIT;
+        }
     }
 
     {
         // Blit must wait on drawing or msaa resolve to finish (depending on whether msaa is enabled)
         VkSubpassDependency& dep = renderPassDef.extraSubpassDeps.emplace_back();
-        dep.srcSubpass = (bMsaaEnabled) ? 1 : 0;
+        dep.srcSubpass = (bShaderMsaaResolve) ? 1 : 0;
         dep.dstSubpass = VK_SUBPASS_EXTERNAL;
         dep.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
         dep.dstStageMask = VK_PIPELINE_STAGE_TRANSFER_BIT;
@@ -28,11 +28,13 @@ public:
     virtual bool ensureValidFramebuffers(const uint32_t fbWidth, const uint32_t fbHeight) noexcept override;
     virtual void beginFrame(vgl::Swapchain& swapchain, vgl::CmdBufferRecorder& cmdRec) noexcept override;
     virtual void endFrame(vgl::Swapchain& swapchain, vgl::CmdBufferRecorder& cmdRec) noexcept override;
+    void beginFrameWithInlineCmds(vgl::Swapchain& swapchain, vgl::CmdBufferRecorder& cmdRec) noexcept;
 
     inline bool isValid() const noexcept { return mbIsValid; }
     inline uint32_t getNumDrawSamples() const noexcept { return mNumDrawSamples; }
     inline const vgl::RenderPass& getRenderPass() const noexcept { return mRenderPass; }
     inline VMsaaResolver& getMsaaResolver() noexcept { return mMsaaResolver; }
+    inline bool isUsingShaderMsaaResolve() const noexcept { return ((mNumDrawSamples > 1) && (mColorFormat != mResolveFormat)); }
 
     inline vgl::RenderTexture& getFramebufferAttachment(const uint32_t idx) noexcept {
         ASSERT(idx < vgl::Defines::RINGBUFFER_SIZE);
@@ -43,6 +45,7 @@ public:
 
 private:
     bool initRenderPass() noexcept;
+    void beginFrame(vgl::Swapchain& swapchain, vgl::CmdBufferRecorder& cmdRec, const bool bUseSecondaryCmdBuffers) noexcept;
 
     bool                    mbIsValid;          // True if the render path has been initialized
     vgl::LogicalDevice*     mpDevice;           // The vulkan device used
@@ -59,6 +62,9 @@ private:
 
     // Whether each of the framebuffers have been involved in a frame yet
     bool mbRenderedToFramebuffer[vgl::Defines::RINGBUFFER_SIZE];
+
+    // PsyDoom: whether the drawing subpass for the current frame executes secondary command buffers rather than having inline commands
+    bool mbUsingSecondaryCmdBuffers;
 };
 
 #endif  // #if PSYDOOM_VULKAN_RENDERER
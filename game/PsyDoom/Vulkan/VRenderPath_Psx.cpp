@@ -13,6 +13,124 @@
 
 #include <algorithm>
 
+// Use SIMD instructions (SSE2 or NEON) for converting the PSX framebuffer, if supported by the target
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define VRENDER_PSX_SIMD_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #define VRENDER_PSX_SIMD_NEON 1
+    #include <arm_neon.h>
+#endif
+
+// The number of pixels in each row of the PSX framebuffer must be a multiple of 8 for the SIMD conversion
+static_assert(Video::ORIG_DRAW_RES_X % 8 == 0);
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts a single PSX 16-bit framebuffer color to the 'A1R5G5B5' format
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline uint16_t convertColor16ToA1R5G5B5(const uint16_t srcPixel) noexcept {
+    const uint16_t srcR = (srcPixel >>  0) & 0x1F;
+    const uint16_t srcG = (srcPixel >>  5) & 0x1F;
+    const uint16_t srcB = (srcPixel >> 10) & 0x1F;
+    return (uint16_t)((srcR << 10) | (srcG << 5) | (srcB << 0) | 0x8000);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts a single PSX 16-bit framebuffer color to the 'B8G8R8A8' format
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline uint32_t convertColor16ToB8G8R8A8(const uint16_t srcPixel) noexcept {
+    const uint32_t srcR = (((uint32_t) srcPixel >>  0) & 0x1F) << 3;
+    const uint32_t srcG = (((uint32_t) srcPixel >>  5) & 0x1F) << 3;
+    const uint32_t srcB = (((uint32_t) srcPixel >> 10) & 0x1F) << 3;
+    return (srcB << 0) | (srcG << 8) | (srcR << 16) | 0xFF000000u;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts a row of PSX 16-bit framebuffer pixels to the 'A1R5G5B5' format, 8 pixels at a time.
+// The number of pixels must be a multiple of 8.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void convertRowToA1R5G5B5(const uint16_t* const pSrcPixels, uint16_t* const pDstPixels, const uint32_t numPixels) noexcept {
+    ASSERT(numPixels % 8 == 0);
+
+    for (uint32_t x = 0; x < numPixels; x += 8) {
+        // Swap the red and blue components around and set the alpha bit
+        #if VRENDER_PSX_SIMD_SSE2
+            const __m128i srcColors = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcPixels + x));
+            const __m128i r = _mm_slli_epi16(_mm_and_si128(srcColors, _mm_set1_epi16(0x001F)), 10);
+            const __m128i g = _mm_and_si128(srcColors, _mm_set1_epi16(0x03E0));
+            const __m128i b = _mm_and_si128(_mm_srli_epi16(srcColors, 10), _mm_set1_epi16(0x001F));
+            const __m128i dstColors = _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, _mm_set1_epi16((int16_t) 0x8000)));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDstPixels + x), dstColors);
+        #elif VRENDER_PSX_SIMD_NEON
+            const uint16x8_t srcColors = vld1q_u16(pSrcPixels + x);
+            const uint16x8_t r = vshlq_n_u16(vandq_u16(srcColors, vdupq_n_u16(0x001F)), 10);
+            const uint16x8_t g = vandq_u16(srcColors, vdupq_n_u16(0x03E0));
+            const uint16x8_t b = vandq_u16(vshrq_n_u16(srcColors, 10), vdupq_n_u16(0x001F));
+            const uint16x8_t dstColors = vorrq_u16(vorrq_u16(r, g), vorrq_u16(b, vdupq_n_u16(0x8000)));
+            vst1q_u16(pDstPixels + x, dstColors);
+        #else
+            for (uint32_t i = 0; i < 8; ++i) {
+                pDstPixels[x + i] = convertColor16ToA1R5G5B5(pSrcPixels[x + i]);
+            }
+        #endif
+    }
+
+    // Debug: verify the output against the simple unoptimized version of the conversion
+    #if ASSERTS_ENABLED
+        for (uint32_t x = 0; x < numPixels; ++x) {
+            ASSERT(pDstPixels[x] == convertColor16ToA1R5G5B5(pSrcPixels[x]));
+        }
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts a row of PSX 16-bit framebuffer pixels to the 'B8G8R8A8' format, 8 pixels at a time.
+// The number of pixels must be a multiple of 8.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void convertRowToB8G8R8A8(const uint16_t* const pSrcPixels, uint32_t* const pDstPixels, const uint32_t numPixels) noexcept {
+    ASSERT(numPixels % 8 == 0);
+
+    for (uint32_t x = 0; x < numPixels; x += 8) {
+        // Move each RGB555 component into it's own byte, shifted up to 8-bits, and set the alpha to fully opaque
+        #if VRENDER_PSX_SIMD_SSE2
+            const __m128i srcColors = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcPixels + x));
+
+            const auto convert = [](const __m128i colors) noexcept {
+                const __m128i r = _mm_slli_epi32(_mm_and_si128(colors, _mm_set1_epi32(0x001F)), 19);
+                const __m128i g = _mm_slli_epi32(_mm_and_si128(colors, _mm_set1_epi32(0x03E0)), 6);
+                const __m128i b = _mm_srli_epi32(_mm_and_si128(colors, _mm_set1_epi32(0x7C00)), 7);
+                return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, _mm_set1_epi32((int32_t) 0xFF000000)));
+            };
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDstPixels + x + 0), convert(_mm_unpacklo_epi16(srcColors, _mm_setzero_si128())));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDstPixels + x + 4), convert(_mm_unpackhi_epi16(srcColors, _mm_setzero_si128())));
+        #elif VRENDER_PSX_SIMD_NEON
+            const uint16x8_t srcColors = vld1q_u16(pSrcPixels + x);
+
+            const auto convert = [](const uint32x4_t colors) noexcept {
+                const uint32x4_t r = vshlq_n_u32(vandq_u32(colors, vdupq_n_u32(0x001F)), 19);
+                const uint32x4_t g = vshlq_n_u32(vandq_u32(colors, vdupq_n_u32(0x03E0)), 6);
+                const uint32x4_t b = vshrq_n_u32(vandq_u32(colors, vdupq_n_u32(0x7C00)), 7);
+                return vorrq_u32(vorrq_u32(r, g), vorrq_u32(b, vdupq_n_u32(0xFF000000)));
+            };
+
+            vst1q_u32(pDstPixels + x + 0, convert(vmovl_u16(vget_low_u16(srcColors))));
+            vst1q_u32(pDstPixels + x + 4, convert(vmovl_u16(vget_high_u16(srcColors))));
+        #else
+            for (uint32_t i = 0; i < 8; ++i) {
+                pDstPixels[x + i] = convertColor16ToB8G8R8A8(pSrcPixels[x + i]);
+            }
+        #endif
+    }
+
+    // Debug: verify the output against the simple unoptimized version of the conversion
+    #if ASSERTS_ENABLED
+        for (uint32_t x = 0; x < numPixels; ++x) {
+            ASSERT(pDstPixels[x] == convertColor16ToB8G8R8A8(pSrcPixels[x]));
+        }
+    #endif
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Sets the render path to a default uninitialized state
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -270,17 +388,7 @@ void VRenderPath_Psx::copyPsxFramebufferToFbTexture_A1R5G5B5(const uint16_t* con
     uint16_t* pDstRowPixels = pDstPixels;
 
     for (uint32_t y = 0; y < Video::ORIG_DRAW_RES_Y; ++y) {
-        // Note: don't bother doing multiple pixels at a time - compiler is smart and already optimizes this to use SIMD
-        for (uint32_t x = 0; x < Video::ORIG_DRAW_RES_X; ++x) {
-            const uint16_t srcPixel = pSrcRowPixels[x];
-            const uint16_t srcR = (srcPixel >>  0) & 0x1F;
-            const uint16_t srcG = (srcPixel >>  5) & 0x1F;
-            const uint16_t srcB = (srcPixel >> 10) & 0x1F;
-
-            const uint16_t dstPixel = (srcR << 10) | (srcG << 5) | (srcB << 0) | 0x8000;
-            pDstRowPixels[x] = dstPixel;
-        }
-
+        convertRowToA1R5G5B5(pSrcRowPixels, pDstRowPixels, Video::ORIG_DRAW_RES_X);
         pSrcRowPixels += ramPixelW;
         pDstRowPixels += Video::ORIG_DRAW_RES_X;
     }
@@ -298,17 +406,7 @@ void VRenderPath_Psx::copyPsxFramebufferToFbTexture_B8G8R8A8(const uint16_t* con
     uint32_t* pDstRowPixels = pDstPixels;
 
     for (uint32_t y = 0; y < Video::ORIG_DRAW_RES_Y; ++y) {
-        // Note: don't bother doing multiple pixels at a time - compiler is smart and already optimizes this to use SIMD
-        for (uint32_t x = 0; x < Video::ORIG_DRAW_RES_X; ++x) {
-            const uint32_t srcPixel = pSrcRowPixels[x];
-            const uint32_t srcR = ((srcPixel >>  0) & 0x1F) << 3;
-            const uint32_t srcG = ((srcPixel >>  5) & 0x1F) << 3;
-            const uint32_t srcB = ((srcPixel >> 10) & 0x1F) << 3;
-
-            const uint32_t dstPixel = (srcB << 0) | (srcG << 8) | (srcR << 16) | 0xFF000000u;
-            pDstRowPixels[x] = dstPixel;
-        }
-
+        convertRowToB8G8R8A8(pSrcRowPixels, pDstRowPixels, Video::ORIG_DRAW_RES_X);
         pSrcRowPixels += ramPixelW;
         pDstRowPixels += Video::ORIG_DRAW_RES_X;
     }
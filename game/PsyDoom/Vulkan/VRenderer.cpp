@@ -15,13 +15,17 @@
 #include "PhysicalDeviceSelection.h"
 #include "PsyDoom/Config/Config.h"
 #include "PsyDoom/PlayerPrefs.h"
+#include "PsyDoom/Profiler.h"
 #include "PsyDoom/PsxVm.h"
 #include "PsyDoom/Video.h"
 #include "Semaphore.h"
 #include "Swapchain.h"
 #include "Texture.h"
+#include "TransferMgr.h"
+#include "Utils.h"
 #include "VCrossfader.h"
 #include "VDrawing.h"
+#include "VGpuTimers.h"
 #include "VkFuncs.h"
 #include "VPipelines.h"
 #include "VPlaqueDrawer.h"
@@ -34,6 +38,7 @@
 
 #include <regex>
 #include <SDL_vulkan.h>
+#include <vector>
 
 BEGIN_NAMESPACE(VRenderer)
 
@@ -105,6 +110,22 @@ static VkFormat                     gPresentSurfaceFormat;          // What colo
 static VkColorSpaceKHR              gPresentSurfaceColorspace;      // What colorspace the surface we are presenting to should use
 static uint32_t                     gDrawSampleCount;               // The number of samples to use when drawing (if > 1 then MSAA is active)
 
+// PsyDoom: dynamic resolution settings.
+// The render scale is lowered in large steps when over the GPU frame time budget and raised in small steps when well under it.
+// Measurements are averaged over a number of frames before deciding, and a few frames after each change are ignored because GPU
+// timings are read back late and would still be for frames drawn at the previous scale.
+static constexpr float      MIN_DYNAMIC_RENDER_SCALE            = 0.5f;
+static constexpr float      DYNAMIC_RENDER_SCALE_STEP_DOWN      = 0.1f;
+static constexpr float      DYNAMIC_RENDER_SCALE_STEP_UP        = 0.05f;
+static constexpr float      DYNAMIC_RES_LOWER_BUDGET_FRAC       = 0.95f;    // Lower the scale if the average GPU frame time is above this fraction of the budget
+static constexpr float      DYNAMIC_RES_RAISE_BUDGET_FRAC       = 0.70f;    // Raise the scale if the average GPU frame time is below this fraction of the budget
+static constexpr uint32_t   DYNAMIC_RES_NUM_SAMPLED_FRAMES      = 60;
+static constexpr uint32_t   DYNAMIC_RES_NUM_IGNORED_FRAMES      = vgl::Defines::RINGBUFFER_SIZE + 1;
+
+static float        gRenderScale = 1.0f;            // Dynamic resolution: scale applied to the framebuffer size, '1.0' if dynamic resolution is off
+static float        gDynResGpuUsecSum;              // Dynamic resolution: sum of the GPU frame times sampled so far
+static uint32_t     gDynResNumSampledFrames;        // Dynamic resolution: how many frames have been sampled so far (including ignored ones)
+
 vgl::LogicalDevice  gDevice(gVkFuncs);      // The logical device used for Vulkan
 vgl::Swapchain      gSwapchain;             // The swapchain we present to
 
@@ -134,6 +155,24 @@ static vgl::CmdBuffer gCmdBuffers[vgl::Defines::RINGBUFFER_SIZE];
 // Any texture uploads to PSX VRAM will get passed along from LIBGPU and eventually find their way in here.
 static vgl::Texture gPsxVramTexture;
 
+// Size of each tile (in pixels, along both dimensions) used for tracking which parts of PSX VRAM need to be uploaded to the mirrored texture
+static constexpr uint32_t PSX_VRAM_DIRTY_TILE_SIZE = 32;
+
+// Tracks which tiles of PSX VRAM have been modified and need to be uploaded to the texture mirroring it: one flag per tile, row by row.
+// Also tracks the range of tile rows containing modified tiles, so that only those rows need to be searched when uploading.
+static std::vector<uint8_t>     gPsxVramDirtyTiles;
+static uint32_t                 gPsxVramDirtyTilesW;
+static uint32_t                 gPsxVramDirtyTilesH;
+static uint32_t                 gPsxVramDirtyTileTy;
+static uint32_t                 gPsxVramDirtyTileBy;
+
+// The list of regions to upload to the texture mirroring PSX VRAM: cached here to avoid re-allocating memory each time
+static std::vector<VkBufferImageCopy> gPsxVramUploadRegions;
+
+// PSX VRAM uploads of at least this many bytes are done asynchronously on the dedicated transfer queue, if the device has one.
+// This is mostly intended for the bulk VRAM population done when loading a level; small per-frame updates stay on the work queue.
+static constexpr uint64_t PSX_VRAM_ASYNC_UPLOAD_MIN_SIZE = 256 * 1024;
+
 // The current and next frame render paths to use: these should always be valid
 static IVRendererPath* gpCurRenderPath;
 static IVRendererPath* gpNextRenderPath;
@@ -244,6 +283,12 @@ static void updateCoordSysInfo() noexcept {
             gFramebufferW = gPresentSurfaceW;
             gFramebufferH = gPresentSurfaceH;
         }
+
+        // PsyDoom: apply the scaling for dynamic resolution, if any
+        if (gRenderScale < 1.0f) {
+            gFramebufferW = (uint32_t) std::max(std::round((float) gFramebufferW * gRenderScale), 1.0f);
+            gFramebufferH = (uint32_t) std::max(std::round((float) gFramebufferH * gRenderScale), 1.0f);
+        }
     } else {
         gFramebufferW = 0;
         gFramebufferH = 0;
@@ -335,6 +380,58 @@ static void updateCoordSysInfo() noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom: adjusts the render scale for dynamic resolution (if enabled) based on recently measured GPU frame times.
+// If the scale changes then the coordinate system info is updated, which will cause the framebuffers to be recreated.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void updateDynamicRenderScale() noexcept {
+    // If dynamic resolution is disabled then make sure we are rendering at the full size
+    const int32_t targetFps = Config::gVulkanDynamicResolutionFps;
+    float newRenderScale = gRenderScale;
+
+    if (targetFps <= 0) {
+        newRenderScale = 1.0f;
+    }
+
+    // Only adjust based on frames drawn by the main render path, since the other paths don't draw the world.
+    // Also give up if GPU timings are not available.
+    const float gpuFrameUsec = VGpuTimers::getFrameTimeUsec();
+
+    if ((targetFps > 0) && (gpCurRenderPath == &gRenderPath_Main) && (gpuFrameUsec >= 0.0f)) {
+        // Sample this frame's GPU time, unless the timing might be for a frame drawn at a previous scale
+        if (gDynResNumSampledFrames >= DYNAMIC_RES_NUM_IGNORED_FRAMES) {
+            gDynResGpuUsecSum += gpuFrameUsec;
+        }
+
+        gDynResNumSampledFrames++;
+
+        // Decide whether to change the scale once enough frames are sampled
+        if (gDynResNumSampledFrames >= DYNAMIC_RES_NUM_IGNORED_FRAMES + DYNAMIC_RES_NUM_SAMPLED_FRAMES) {
+            const float avgGpuFrameUsec = gDynResGpuUsecSum / (float) DYNAMIC_RES_NUM_SAMPLED_FRAMES;
+            const float frameBudgetUsec = 1000000.0f / (float) targetFps;
+
+            if (avgGpuFrameUsec > frameBudgetUsec * DYNAMIC_RES_LOWER_BUDGET_FRAC) {
+                newRenderScale = std::max(gRenderScale - DYNAMIC_RENDER_SCALE_STEP_DOWN, MIN_DYNAMIC_RENDER_SCALE);
+            } else if (avgGpuFrameUsec < frameBudgetUsec * DYNAMIC_RES_RAISE_BUDGET_FRAC) {
+                newRenderScale = std::min(gRenderScale + DYNAMIC_RENDER_SCALE_STEP_UP, 1.0f);
+            }
+
+            gDynResGpuUsecSum = 0.0f;
+            gDynResNumSampledFrames = 0;
+        }
+    }
+
+    // If the scale changed then update the framebuffer size and restart sampling.
+    // The framebuffers for all ringbuffer slots are recreated immediately, so wait for any frames in flight to finish first.
+    if (newRenderScale != gRenderScale) {
+        gDevice.waitUntilDeviceIdle();
+        gRenderScale = newRenderScale;
+        gDynResGpuUsecSum = 0.0f;
+        gDynResNumSampledFrames = 0;
+        updateCoordSysInfo();
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Create or recreate the 'swap image ready' semaphores
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -349,6 +446,25 @@ static void recreateSwapImageReadySemaphores() noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the name of the given render path, for labelling GPU timings
+//------------------------------------------------------------------------------------------------------------------------------------------
+static const char* getRenderPathName(const IVRendererPath& renderPath) noexcept {
+    if (&renderPath == &gRenderPath_Main)
+        return "VRenderPath_Main";
+
+    if (&renderPath == &gRenderPath_Psx)
+        return "VRenderPath_Psx";
+
+    if (&renderPath == &gRenderPath_Crossfade)
+        return "VRenderPath_Crossfade";
+
+    if (&renderPath == &gRenderPath_Blit)
+        return "VRenderPath_Blit";
+
+    return "VRenderPath_Unknown";
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Recreates the swapchain and new Vulkan renderer framebuffers if required and returns 'false' if that is not possible to do currently.
 // Recreation might fail validly if the window is currently zero sized for example.
@@ -558,7 +674,9 @@ void init() noexcept {
     if (!gDevice.init(*gpPhysicalDevice, &gWindowSurface))
         FatalErrors::raise("Failed to initialize a Vulkan logical device!");
 
-    // Initialize all pipeline components: must be done BEFORE creating render paths, as they rely on some components
+    // Initialize all pipeline components: must be done BEFORE creating render paths, as they rely on some components.
+    // PsyDoom: also load the pipeline cache saved from previous runs, to speed up pipeline creation.
+    VPipelines::initPipelineCache(gDevice);
     VPipelines::initPipelineComponents(gDevice, gDrawSampleCount);
 
     // Initialize all render paths
@@ -571,6 +689,7 @@ void init() noexcept {
 
     // Create all of the pipelines needed, these use the previously created pipeline components
     VPipelines::initPipelines(gRenderPath_Main, gRenderPath_Crossfade, gDrawSampleCount);
+    VPipelines::savePipelineCache();
 
     // Create the 'render done' semaphores
     for (vgl::Semaphore& semaphore : gRenderDoneSemaphores) {
@@ -584,6 +703,9 @@ void init() noexcept {
             FatalErrors::raise("Failed to create a Vulkan command buffer required for rendering!");
     }
 
+    // Create the queries used to measure GPU frame time
+    VGpuTimers::init(gDevice, *gpPhysicalDevice);
+
     // Workaround for lower-end devices like the Raspberry Pi 4 which only support texture sizes of 4096x4096 at the time of writing.
     // Determine the maximum texture size supported by the Vulkan device and if it's smaller than the already chosen PSX VRAM size
     // then re-initialize the PSX GPU with the smaller of the two memory sizes:
@@ -609,6 +731,7 @@ void init() noexcept {
 
         Gpu::destroyCore(PsxVm::gGpu);
         Gpu::initCore(PsxVm::gGpu, 4096, 4096);
+        PsxVm::initGpuDeferredDraw();
     }
 
     // Initialize the texture representing PSX VRAM and clear it all to black.
@@ -626,6 +749,14 @@ void init() noexcept {
         gPsxVramTexture.unlock();
     }
 
+    // Nothing in PSX VRAM needs to be uploaded to the texture initially
+    gPsxVramDirtyTilesW = (psxGpu.ramPixelW + PSX_VRAM_DIRTY_TILE_SIZE - 1) / PSX_VRAM_DIRTY_TILE_SIZE;
+    gPsxVramDirtyTilesH = (psxGpu.ramPixelH + PSX_VRAM_DIRTY_TILE_SIZE - 1) / PSX_VRAM_DIRTY_TILE_SIZE;
+    gPsxVramDirtyTiles.clear();
+    gPsxVramDirtyTiles.resize((size_t) gPsxVramDirtyTilesW * gPsxVramDirtyTilesH);
+    gPsxVramDirtyTileTy = UINT32_MAX;
+    gPsxVramDirtyTileBy = 0;
+
     // Initialize the draw command submission module, crossfader and loading plaque drawer
     VDrawing::init(gDevice, gPsxVramTexture);
     VCrossfader::init(gDevice);
@@ -667,8 +798,18 @@ void destroy() noexcept {
     gbSkipNextFramePresent = false;
     gpNextRenderPath = nullptr;
     gpCurRenderPath = nullptr;
+    gPsxVramUploadRegions.clear();
+    gPsxVramUploadRegions.shrink_to_fit();
+    gPsxVramDirtyTileBy = 0;
+    gPsxVramDirtyTileTy = UINT32_MAX;
+    gPsxVramDirtyTilesH = 0;
+    gPsxVramDirtyTilesW = 0;
+    gPsxVramDirtyTiles.clear();
+    gPsxVramDirtyTiles.shrink_to_fit();
     gPsxVramTexture.destroy(true);
 
+    VGpuTimers::destroy();
+
     for (vgl::CmdBuffer& cmdBuffer : gCmdBuffers) {
         cmdBuffer.destroy(true);
     }
@@ -716,6 +857,9 @@ bool beginFrame() noexcept {
     // Do a render path switch if requested
     gpCurRenderPath = gpNextRenderPath;
 
+    // Adjust the render resolution if dynamic resolution is enabled
+    updateDynamicRenderScale();
+
     // Recreate the swapchain and framebuffers if required and bail if that operation failed
     if (!ensureValidSwapchainAndFramebuffers())
         return false;
@@ -756,6 +900,10 @@ bool beginFrame() noexcept {
         );
     }
 
+    // Read back GPU timings for the last time this ringbuffer slot was used and start timing this frame on the GPU.
+    // Note: this must be done before the render path begins the frame, since the timer queries must be reset outside of a render pass.
+    VGpuTimers::beginFrame(gCmdBufferRec, ringbufferIdx, getRenderPathName(*gpCurRenderPath));
+
     // Render path specific frame start
     gpCurRenderPath->beginFrame(gSwapchain, gCmdBufferRec);
     return true;
@@ -775,6 +923,8 @@ bool isRendering() noexcept {
 // End the current frame and present to the screen
 //------------------------------------------------------------------------------------------------------------------------------------------
 void endFrame() noexcept {
+    PROFILE_ZONE("VRenderer::endFrame");
+
     // Must have begun the frame
     ASSERT(gbDidBeginFrame);
     gbDidBeginFrame = false;
@@ -793,7 +943,9 @@ void endFrame() noexcept {
         gpCurRenderPath->endFrame(gSwapchain, gCmdBufferRec);
     }
 
-    // Begin executing any pending transfers
+    // Schedule uploads for any PSX VRAM modified since the last frame and begin executing any pending transfers
+    flushPsxVramUpdates();
+
     vgl::TransferMgr& transferMgr = gDevice.getTransferMgr();
     transferMgr.executePreFrameTransferTask();
 
@@ -803,6 +955,9 @@ void endFrame() noexcept {
         return;
     }
 
+    // Mark the end of the frame's GPU work if measuring GPU frame time
+    VGpuTimers::endFrame(gCmdBufferRec);
+
     // End command recording and submit the command buffer to the device.
     // Wait for the current swapchain image to be acquired before executing this command buffer.
     // Signal the current ringbuffer slot fence when drawing is done.
@@ -848,14 +1003,31 @@ void endFrame() noexcept {
         gbSkipNextFramePresent = false;
     }
 
+    // PsyDoom: in low latency mode only allow 1 frame in flight by waiting for the GPU to finish this frame before starting the next one.
+    // That way the game does not run ahead of the GPU and display, and the next frame's inputs are read as late as possible.
+    if (Config::gbVulkanLowLatencyMode) {
+        ringbufferMgr.getCurrentBufferFence().waitUntilSignalled();
+    }
+
     // Move onto the next ringbuffer index and clear the command buffer used: will get it again once we begin a frame.
     gbDidAcquireSwapImageThisFrame = false;
     ringbufferMgr.acquireNextBuffer();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Copies a rectangular area of pixels (of at least 1x1 pixels) from the PSX GPU's VRAM to the Vulkan texture that mirrors it.
-// This makes updates to PSX VRAM visible to the new native Vulkan renderer.
+// Returns how long the GPU took to execute the commands for the most recently measured frame, in microseconds.
+// Due to frames being in flight this lags a few frames behind the current frame. Returns a negative value if GPU time is unavailable.
+//------------------------------------------------------------------------------------------------------------------------------------------
+float getGpuFrameTimeUsec() noexcept {
+    return VGpuTimers::getFrameTimeUsec();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Marks a rectangular area of pixels (of at least 1x1 pixels) in the PSX GPU's VRAM as needing to be copied to the Vulkan texture that
+// mirrors it. This makes updates to PSX VRAM visible to the new native Vulkan renderer.
+//
+// Note: the copy does not happen immediately. Instead all modified areas are uploaded together at the end of the frame, before any of the
+// frame's drawing is done on the GPU. This allows many small and scattered updates to be uploaded efficiently in one transfer.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void pushPsxVramUpdates(const uint16_t rectLx, const uint16_t rectRx, const uint16_t rectTy, const uint16_t rectBy) noexcept {
     // Sanity check the rectangle bounds.
@@ -886,23 +1058,112 @@ void pushPsxVramUpdates(const uint16_t rectLx, const uint16_t rectRx, const uint
         return;
     }
 
-    // This is the size of the area to be updated and the number of bytes in each row
-    const uint32_t copyRectW = (uint32_t) rectRx + 1 - rectLx;
-    const uint32_t copyRectH = (uint32_t) rectBy + 1 - rectTy;
-    const uint32_t copyRowSize = copyRectW * sizeof(uint16_t);
+    // Mark all the tiles touched by the rectangle as modified and expand the range of modified tile rows
+    const uint32_t tileLx = rectLx / PSX_VRAM_DIRTY_TILE_SIZE;
+    const uint32_t tileRx = rectRx / PSX_VRAM_DIRTY_TILE_SIZE;
+    const uint32_t tileTy = rectTy / PSX_VRAM_DIRTY_TILE_SIZE;
+    const uint32_t tileBy = rectBy / PSX_VRAM_DIRTY_TILE_SIZE;
+    ASSERT((tileRx < gPsxVramDirtyTilesW) && (tileBy < gPsxVramDirtyTilesH));
+
+    for (uint32_t tileY = tileTy; tileY <= tileBy; ++tileY) {
+        uint8_t* const pTileRow = gPsxVramDirtyTiles.data() + (size_t) tileY * gPsxVramDirtyTilesW;
+        std::memset(pTileRow + tileLx, 1, tileRx + 1 - tileLx);
+    }
+
+    gPsxVramDirtyTileTy = std::min(gPsxVramDirtyTileTy, tileTy);
+    gPsxVramDirtyTileBy = std::max(gPsxVramDirtyTileBy, tileBy);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Copies all areas of PSX VRAM marked as modified by 'pushPsxVramUpdates' to the Vulkan texture that mirrors PSX VRAM.
+// Each horizontal run of modified tiles becomes one region to upload and all of the regions are uploaded in a single transfer.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void flushPsxVramUpdates() noexcept {
+    // Is there anything to upload?
+    if (gPsxVramDirtyTileTy > gPsxVramDirtyTileBy)
+        return;
+
+    // Make up the list of regions to upload and figure out where each region's data is stored in the staging buffer
+    Gpu::Core& psxGpu = PsxVm::gGpu;
+    const uint32_t vramW = psxGpu.ramPixelW;
+    const uint32_t vramH = psxGpu.ramPixelH;
 
-    // Lock the required region of the texture and copy in the updates, row by row
-    uint16_t* pDstBytes = (uint16_t*) gPsxVramTexture.lock(rectLx, rectTy, 0, 0, copyRectW, copyRectH, 1, 1);
-    const uint16_t* pSrcBytes = psxGpu.pRam + rectLx + ((uintptr_t) rectTy * vramW);
+    gPsxVramUploadRegions.clear();
+    uint64_t stagingBufferSize = 0;
 
-    for (uint32_t row = 0; row < copyRectH; ++row) {
-        std::memcpy(pDstBytes, pSrcBytes, copyRowSize);
-        pDstBytes += copyRectW;
-        pSrcBytes += vramW;
+    for (uint32_t tileY = gPsxVramDirtyTileTy; tileY <= gPsxVramDirtyTileBy; ++tileY) {
+        uint8_t* const pTileRow = gPsxVramDirtyTiles.data() + (size_t) tileY * gPsxVramDirtyTilesW;
+
+        for (uint32_t tileX = 0; tileX < gPsxVramDirtyTilesW;) {
+            // Skip past tiles which are not modified
+            if (!pTileRow[tileX]) {
+                ++tileX;
+                continue;
+            }
+
+            // Find the end of this run of modified tiles and clear the tiles while we are at it
+            const uint32_t runTileLx = tileX;
+
+            while ((tileX < gPsxVramDirtyTilesW) && pTileRow[tileX]) {
+                pTileRow[tileX] = 0;
+                ++tileX;
+            }
+
+            // Add the region for the run of tiles
+            const uint32_t regionX = runTileLx * PSX_VRAM_DIRTY_TILE_SIZE;
+            const uint32_t regionY = tileY * PSX_VRAM_DIRTY_TILE_SIZE;
+            const uint32_t regionW = std::min(tileX * PSX_VRAM_DIRTY_TILE_SIZE, vramW) - regionX;
+            const uint32_t regionH = std::min(regionY + PSX_VRAM_DIRTY_TILE_SIZE, vramH) - regionY;
+
+            VkBufferImageCopy& region = gPsxVramUploadRegions.emplace_back();
+            region = {};
+            region.bufferOffset = stagingBufferSize;
+            region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+            region.imageSubresource.layerCount = 1;
+            region.imageOffset = { (int32_t) regionX, (int32_t) regionY, 0 };
+            region.imageExtent = { regionW, regionH, 1 };
+
+            stagingBufferSize += (uint64_t) regionW * regionH * sizeof(uint16_t);
+            stagingBufferSize = vgl::Utils::ualignUp(stagingBufferSize, (uint64_t) vgl::Defines::MIN_IMAGE_ALIGNMENT);
+        }
+    }
+
+    gPsxVramDirtyTileTy = UINT32_MAX;
+    gPsxVramDirtyTileBy = 0;
+
+    // Allocate a staging buffer for the transfer and copy in the pixels for each region, row by row
+    const vgl::TransferMgr::StagingBuffer stagingBuffer = gDevice.getTransferMgr().allocTempStagingBuffer(stagingBufferSize);
+
+    if (!stagingBuffer.pBytes) {
+        ASSERT_FAIL("Failed to allocate a temporary staging buffer for PSX VRAM updates!");
+        return;
+    }
+
+    for (VkBufferImageCopy& region : gPsxVramUploadRegions) {
+        const uint32_t regionW = region.imageExtent.width;
+        const uint32_t regionH = region.imageExtent.height;
+        const uint32_t rowSize = regionW * sizeof(uint16_t);
+
+        uint16_t* pDstPixels = (uint16_t*)(stagingBuffer.pBytes + region.bufferOffset);
+        const uint16_t* pSrcPixels = psxGpu.pRam + region.imageOffset.x + ((uintptr_t) region.imageOffset.y * vramW);
+
+        for (uint32_t row = 0; row < regionH; ++row) {
+            std::memcpy(pDstPixels, pSrcPixels, rowSize);
+            pDstPixels += regionW;
+            pSrcPixels += vramW;
+        }
+
+        // The staging allocation might not start at the beginning of its buffer: make the region offset relative to the buffer
+        region.bufferOffset += stagingBuffer.offset;
     }
 
-    // Unlock the texture to begin uploading the updates
-    gPsxVramTexture.unlock();
+    // Schedule the upload of all the regions; use the async upload task if it's a big upload
+    vgl::TransferMgr& transferMgr = gDevice.getTransferMgr();
+    vgl::TransferTask& transferTask = (stagingBufferSize >= PSX_VRAM_ASYNC_UPLOAD_MIN_SIZE) ?
+        transferMgr.getAsyncUploadTask() :
+        transferMgr.getPreFrameTransferTask();
+
+    gPsxVramTexture.uploadRegions(stagingBuffer.vkBuffer, gPsxVramUploadRegions.data(), (uint32_t) gPsxVramUploadRegions.size(), &transferTask);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -58,6 +58,7 @@ bool beginFrame() noexcept;
 bool isRendering() noexcept;
 void endFrame() noexcept;
 void pushPsxVramUpdates(const uint16_t rectLx, const uint16_t rectRx, const uint16_t rectTy, const uint16_t rectBy) noexcept;
+void flushPsxVramUpdates() noexcept;
 void initRendererUniformFields(VShaderUniforms_Draw& uniforms) noexcept;
 IVRendererPath& getActiveRenderPath() noexcept;
 IVRendererPath& getNextRenderPath() noexcept;
@@ -68,6 +69,7 @@ void switchToMainVulkanRenderPath() noexcept;
 void skipNextFramePresent() noexcept;
 bool willSkipNextFramePresent() noexcept;
 bool isSwapchainOutOfDate() noexcept;
+float getGpuFrameTimeUsec() noexcept;
 
 END_NAMESPACE(VRenderer)
 
@@ -6,46 +6,87 @@
 #include "Buffer.h"
 #include "Defines.h"
 
+#include <algorithm>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Statistics for a vertex buffer set: peak usage and how often extra vertex buffer blocks were created and released
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct VVertexBufferStats {
+    uint32_t    peakFrameVerts;         // The most vertices used in a single frame
+    uint32_t    peakFrameBlocks;        // The most vertex buffer blocks used in a single frame
+    uint32_t    numBlocksCreated;       // How many extra blocks were created after init, due to frames needing more than 1 block
+    uint32_t    numBlocksReleased;      // How many extra blocks were released after going unused for a while
+};
+
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Holds a collection of vertex buffers (one per ringbuffer slot) for a specified vertex type.
+// Holds a collection of vertex buffers for a specified vertex type.
 // Keeps track of where we are in the vertex buffer, the current draw batch location and size and so on.
+//
+// Each ringbuffer slot has a chain of fixed size vertex buffer 'blocks'. A frame starts writing to the first block in the chain and
+// moves onto the next block (creating it if required) when the current block is full. This avoids having to reallocate and copy all
+// of the vertices written so far when a frame needs more vertices than usual. The owner of the set must end the current draw batch
+// and bind the new block's vertex buffer when switching blocks, since draw batches may not span blocks. Blocks other than the first
+// are released (via the retirement manager) once they have gone unused for a while, so memory usage returns to normal after a burst.
 //------------------------------------------------------------------------------------------------------------------------------------------
 struct VVertexBufferSet {
-    vgl::Buffer     buffers[vgl::Defines::RINGBUFFER_SIZE];     // The vertex buffers for each ringbuffer slot
-    uint32_t        vertexSize;                                 // The size of each vertex
-    vgl::Buffer*    pCurBuffer;                                 // The the vertex buffer to use from the current ringbuffer slot
-    uint32_t        curOffset;                                  // How many vertices have been placed in the vertex buffer
-    uint32_t        curSize;                                    // Size of the vertex buffer in vertexes
-    std::byte*      pCurVerts;                                  // Pointer to the vertex data which can be written to
-    uint32_t        curBatchStart;                              // Where the current draw batch in the vertex buffer starts (which vertex number)
-    uint32_t        curBatchSize;                               // Size of the current draw batch in the vertedx buffer (in vertices)
+    // The maximum number of blocks in the chain for each ringbuffer slot
+    static constexpr uint32_t MAX_BLOCKS = 32;
+
+    // How many frames a ringbuffer slot must go without using one of it's extra blocks before that block is released
+    static constexpr uint32_t NUM_UNUSED_FRAMES_BEFORE_BLOCK_RELEASE = 120;
+
+    // A single vertex buffer block and how many frames (of it's ringbuffer slot) it has gone unused for
+    struct Block {
+        vgl::Buffer     buffer;
+        uint32_t        numUnusedFrames;
+    };
+
+    // The chain of vertex buffer blocks for a ringbuffer slot
+    struct BlockChain {
+        Block       blocks[MAX_BLOCKS];
+        uint32_t    numBlocks;
+    };
+
+    BlockChain          blockChains[vgl::Defines::RINGBUFFER_SIZE];     // The chain of vertex buffer blocks for each ringbuffer slot
+    vgl::LogicalDevice* pDevice;                                        // The device used to create vertex buffer blocks
+    uint32_t            vertexSize;                                     // The size of each vertex
+    uint32_t            blockSize;                                      // The standard size of each vertex buffer block (in vertices)
+    BlockChain*         pCurBlockChain;                                 // The chain of vertex buffer blocks for the current ringbuffer slot
+    uint32_t            curBlockIdx;                                    // Which block in the chain is currently being written to
+    vgl::Buffer*        pCurBuffer;                                     // The vertex buffer for the current block being written to
+    uint32_t            curOffset;                                      // How many vertices have been placed in the current vertex buffer
+    uint32_t            curSize;                                        // Size of the current vertex buffer in vertexes
+    std::byte*          pCurVerts;                                      // Pointer to the vertex data which can be written to
+    uint32_t            curBatchStart;                                  // Where the current draw batch in the vertex buffer starts (which vertex number)
+    uint32_t            curBatchSize;                                   // Size of the current draw batch in the vertedx buffer (in vertices)
+    uint32_t            curFrameVertsInPrevBlocks;                      // How many vertices were used by previous blocks in the current frame
+    VVertexBufferStats  stats;                                          // Peak usage and block management statistics
 
     //--------------------------------------------------------------------------------------------------------------------------------------
-    // Initializes the vertex buffer set for the given vertex type and capacity
+    // Initializes the vertex buffer set for the given vertex type and block capacity
     //--------------------------------------------------------------------------------------------------------------------------------------
     template <class VertT>
     void init(vgl::LogicalDevice& device, const uint32_t numVerts) noexcept {
         // Init basic fields
+        ASSERT(numVerts > 0);
+        pDevice = &device;
         vertexSize = sizeof(VertT);
+        blockSize = numVerts;
+        pCurBlockChain = nullptr;
+        curBlockIdx = 0;
         pCurBuffer = nullptr;
         curOffset = 0;
-        curSize = numVerts;
+        curSize = 0;
         pCurVerts = nullptr;
         curBatchStart = 0;
         curBatchSize = 0;
+        curFrameVertsInPrevBlocks = 0;
+        stats = {};
 
-        // Create the vertex buffers for each ringbuffer slot
-        for (vgl::Buffer& buffer : buffers) {
-            const bool bWasSuccessful = buffer.initWithElementCount<VertT>(
-                device,
-                VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
-                vgl::BufferUsageMode::DYNAMIC,
-                numVerts,
-                true
-            );
-
-            if (!bWasSuccessful)
-                FatalErrors::raise("Failed to create a required Vulkan vertex buffer! May be out of memory!");
+        // Create the first vertex buffer block for each ringbuffer slot
+        for (BlockChain& blockChain : blockChains) {
+            initBlock(blockChain.blocks[0], numVerts);
+            blockChain.numBlocks = 1;
         }
     }
 
@@ -53,30 +94,38 @@ struct VVertexBufferSet {
     // Tears down the vertex buffer set
     //--------------------------------------------------------------------------------------------------------------------------------------
     void destroy() noexcept {
+        pDevice = nullptr;
         vertexSize = 0;
+        blockSize = 0;
+        pCurBlockChain = nullptr;
+        curBlockIdx = 0;
         pCurBuffer = nullptr;
         curOffset = 0;
         curSize = 0;
         pCurVerts = nullptr;
         curBatchStart = 0;
         curBatchSize = 0;
+        curFrameVertsInPrevBlocks = 0;
+
+        for (BlockChain& blockChain : blockChains) {
+            for (Block& block : blockChain.blocks) {
+                block.buffer.destroy(true);
+                block.numUnusedFrames = 0;
+            }
 
-        for (vgl::Buffer& buffer : buffers) {
-            buffer.destroy(true);
+            blockChain.numBlocks = 0;
         }
     }
 
     //--------------------------------------------------------------------------------------------------------------------------------------
     // Should be called at the beginning of a frame.
-    // Decides which vertex buffer to use based on the ringbuffer index, and locks it for writing.
+    // Decides which chain of vertex buffers to use based on the ringbuffer index, and locks the first one for writing.
     //--------------------------------------------------------------------------------------------------------------------------------------
     void beginFrame(const uint32_t ringbufferIdx) noexcept {
-        // Get what vertex buffer to use and lock its entire range for writing
-        pCurBuffer = &buffers[ringbufferIdx];
-        curOffset = 0;
-        curSize = (uint32_t)(pCurBuffer->getSizeInBytes() / vertexSize);
-        pCurVerts = pCurBuffer->lockBytes(0, pCurBuffer->getSizeInBytes());
-        ASSERT(pCurVerts);
+        pCurBlockChain = &blockChains[ringbufferIdx];
+        ASSERT(pCurBlockChain->numBlocks > 0);
+        lockBlock(0);
+        curFrameVertsInPrevBlocks = 0;
 
         // These should already be zeroed
         ASSERT(curBatchStart == 0);
@@ -85,73 +134,119 @@ struct VVertexBufferSet {
 
     //--------------------------------------------------------------------------------------------------------------------------------------
     // Should be called at the end of a frame.
-    // Schedules uploads for any vertices that need to be uploaded to the GPU.
+    // Schedules uploads for any vertices that need to be uploaded to the GPU, updates statistics and releases long unused blocks.
     //--------------------------------------------------------------------------------------------------------------------------------------
     void endFrame() noexcept {
         // Unlock the vertex buffer used to schedule the transfer of vertex data to the GPU
         ASSERT(pCurBuffer);
-        pCurBuffer->unlockBytes(curOffset * vertexSize);
-        pCurVerts = nullptr;
+        const uint32_t numFrameVerts = curFrameVertsInPrevBlocks + curOffset;
+        const uint32_t numFrameBlocks = curBlockIdx + 1;
+        unlockCurBlock();
+
+        // Update peak usage statistics
+        stats.peakFrameVerts = std::max(stats.peakFrameVerts, numFrameVerts);
+        stats.peakFrameBlocks = std::max(stats.peakFrameBlocks, numFrameBlocks);
+
+        // Update how long each block in the chain has gone unused, then release extra blocks at the end of the chain which have been unused
+        // for long enough. Note that the destroyed buffers are handed over to the retirement manager, since they may still be in use by the GPU.
+        BlockChain& blockChain = *pCurBlockChain;
+
+        for (uint32_t blockIdx = 0; blockIdx < blockChain.numBlocks; ++blockIdx) {
+            Block& block = blockChain.blocks[blockIdx];
+            block.numUnusedFrames = (blockIdx < numFrameBlocks) ? 0 : block.numUnusedFrames + 1;
+        }
+
+        while (blockChain.numBlocks > 1) {
+            Block& block = blockChain.blocks[blockChain.numBlocks - 1];
+
+            if (block.numUnusedFrames < NUM_UNUSED_FRAMES_BEFORE_BLOCK_RELEASE)
+                break;
+
+            block.buffer.destroy();
+            block.numUnusedFrames = 0;
+            blockChain.numBlocks--;
+            stats.numBlocksReleased++;
+        }
 
         // Clear everything else
-        pCurBuffer = nullptr;
-        curOffset = 0;
-        curSize = 0;
+        pCurBlockChain = nullptr;
+        curBlockIdx = 0;
+        curFrameVertsInPrevBlocks = 0;
         curBatchStart = 0;
         curBatchSize = 0;
     }
 
     //--------------------------------------------------------------------------------------------------------------------------------------
-    // Ensures the specified number of vertices are free for use, and if they are not resizes the current vertex buffer in use.
+    // Tells if the specified number of vertices can be allocated from the current vertex buffer block.
     // Note: must only be called after 'beginFrame', i.e a ringbuffer slot MUST be decided.
     //--------------------------------------------------------------------------------------------------------------------------------------
-    void ensureNumVerts(const uint32_t numVerts) noexcept {
-        // The vertex buffer must be locked by 'beginFrame' and we must have a valid vertex size set
-        ASSERT(vertexSize > 0);
-        ASSERT((curSize > 0) || (!pCurBuffer));
-        
-        if (!pCurBuffer)
-            FatalErrors::raise("VVertexBufferSet::ensureNumVerts: attempting to draw without a valid framebuffer!");
+    bool hasRoomForVerts(const uint32_t numVerts) const noexcept {
+        ASSERT(pCurBuffer);
+        return (numVerts <= curSize - curOffset);
+    }
 
-        // What size would be good to hold this amount of vertices?
-        uint32_t newSize = curSize;
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Moves onto the next vertex buffer block in the chain for the current frame, creating it if required.
+    // The block is guaranteed to have room for at least the specified number of vertices.
+    //
+    // Notes:
+    //  (1) The current draw batch MUST be ended before calling this, since draw batches cannot span blocks.
+    //  (2) The vertex buffer for the new block must be bound before drawing any vertices allocated from it.
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    void beginNextBlock(const uint32_t numVerts) noexcept {
+        ASSERT(pCurBlockChain && pCurBuffer);
+        ASSERT_LOG(curBatchSize == 0, "Must end the current draw batch before switching vertex buffer blocks!");
 
-        while (curOffset + numVerts > newSize) {
-            newSize *= 2;
-        }
+        // Finish up with the current block
+        curFrameVertsInPrevBlocks += curOffset;
+        unlockCurBlock();
 
-        // Do we need to do a resize?
-        if (newSize != curSize) {
-            const bool bResizeOk = pCurBuffer->resizeToByteCount(
-                (uint64_t) newSize * vertexSize,
-                vgl::Buffer::ResizeFlagBits::KEEP_LOCKED_DATA,
-                0,
-                UINT64_MAX      // Re-lock the entire buffer
-            );
-
-            if (!bResizeOk)
-                FatalErrors::raise("Failed to resize a Vulkan vertex buffer used for rendering! May be out of memory!");
-
-            // Need to update the locked pointer after resizing and the new vertex buffer size
-            curSize = (uint32_t)(pCurBuffer->getSizeInBytes() / vertexSize);
-            pCurVerts = pCurBuffer->getLockedBytes();
-            ASSERT(pCurVerts);
+        // Create or replace the next block if needed: it may not exist yet or may not be big enough
+        BlockChain& blockChain = *pCurBlockChain;
+        const uint32_t nextBlockIdx = curBlockIdx + 1;
+
+        if (nextBlockIdx >= MAX_BLOCKS)
+            FatalErrors::raise("VVertexBufferSet::beginNextBlock: too many vertices submitted for drawing in a single frame!");
+
+        Block& nextBlock = blockChain.blocks[nextBlockIdx];
+
+        if (nextBlockIdx < blockChain.numBlocks) {
+            if (nextBlock.buffer.getSizeInBytes() / vertexSize < numVerts) {
+                nextBlock.buffer.destroy();
+                initBlock(nextBlock, numVerts);
+                stats.numBlocksCreated++;
+            }
+        } else {
+            initBlock(nextBlock, std::max(numVerts, blockSize));
+            blockChain.numBlocks = nextBlockIdx + 1;
+            stats.numBlocksCreated++;
         }
+
+        // Start writing to the new block
+        lockBlock(nextBlockIdx);
+        ASSERT(hasRoomForVerts(numVerts));
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Get the vertex buffer for the specified block in the chain for the current frame
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    vgl::Buffer& getBlockBuffer(const uint32_t blockIdx) const noexcept {
+        ASSERT(pCurBlockChain);
+        ASSERT(blockIdx < pCurBlockChain->numBlocks);
+        return pCurBlockChain->blocks[blockIdx].buffer;
     }
 
     //--------------------------------------------------------------------------------------------------------------------------------------
-    // Allocate the specified number of vertices from the buffer for use and move on.
-    // 
+    // Allocate the specified number of vertices from the current vertex buffer block for use and move on.
+    //
     // Notes:
-    //  (1) If the buffer is not big enough then it is resized.
+    //  (1) There MUST be room in the current block for the vertices - see 'hasRoomForVerts' and 'beginNextBlock'.
     //  (2) Must only be called after 'beginFrame', i.e a ringbuffer slot MUST be decided.
-    //  (3) May invalidate previously allocated vertex pointers, be careful!
     //--------------------------------------------------------------------------------------------------------------------------------------
     template <class VertT>
     VertT* allocVerts(const uint32_t numVerts) noexcept {
-        // Make sure the vertex is big enough, then get the vertex pointer
         ASSERT_LOG(sizeof(VertT) == vertexSize, "Vertex size inconsistency!");
-        ensureNumVerts(numVerts);
+        ASSERT(hasRoomForVerts(numVerts));
         VertT* const pVerts = (VertT*) pCurVerts + curOffset;
 
         // Mark these vertices as consumed
@@ -169,6 +264,50 @@ struct VVertexBufferSet {
             curBatchSize = 0;
         }
     }
+
+private:
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Creates the vertex buffer for a block with the specified capacity
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    void initBlock(Block& block, const uint32_t numVerts) noexcept {
+        ASSERT(pDevice);
+        const bool bWasSuccessful = block.buffer.initWithByteCount(
+            *pDevice,
+            VK_BUFFER_USAGE_VERTEX_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+            vgl::BufferUsageMode::DYNAMIC,
+            (uint64_t) numVerts * vertexSize
+        );
+
+        if (!bWasSuccessful)
+            FatalErrors::raise("Failed to create a required Vulkan vertex buffer! May be out of memory!");
+
+        block.numUnusedFrames = 0;
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Makes the specified block in the chain for the current frame the one being written to, and locks it's entire range for writing
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    void lockBlock(const uint32_t blockIdx) noexcept {
+        curBlockIdx = blockIdx;
+        pCurBuffer = &getBlockBuffer(blockIdx);
+        curOffset = 0;
+        curSize = (uint32_t)(pCurBuffer->getSizeInBytes() / vertexSize);
+        pCurVerts = pCurBuffer->lockBytes(0, pCurBuffer->getSizeInBytes());
+        curBatchStart = 0;
+        ASSERT(pCurVerts);
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Unlocks the block currently being written to, which schedules the transfer of the vertices written to it to the GPU
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    void unlockCurBlock() noexcept {
+        ASSERT(pCurBuffer);
+        pCurBuffer->unlockBytes((uint64_t) curOffset * vertexSize);
+        pCurBuffer = nullptr;
+        pCurVerts = nullptr;
+        curOffset = 0;
+        curSize = 0;
+    }
 };
 
 #endif  // #if PSYDOOM_MODS
@@ -4,9 +4,15 @@
 #include "Doom/Base/z_zone.h"
 #include "Doom/d_main.h"
 #include "FileUtils.h"
+#include "PsyDoom/Config/Config.h"
 #include "WadUtils.h"
 
+#include <algorithm>
 #include <cctype>
+#include <cstring>
+#include <md5.h>
+#include <memory>
+#include <vector>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Header for a WAD file: constains high level information about the contents of the WAD
@@ -30,6 +36,60 @@ struct WadLumpHdr {
 
 static_assert(sizeof(WadLumpHdr) == 16);
 
+// The size of the chunks that compressed lump data is read in when decompressing a lump that is not memory mapped
+static constexpr int32_t LUMP_DECOMPRESS_CHUNK_SIZE = 16 * 1024;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: decompresses lump data with bounds checking, failing with a fatal error if the data is corrupt
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void decompressLumpOrFail(const void* const pSrc, const int32_t srcSize, void* const pDst, const int32_t dstSize) noexcept {
+    if (!WadUtils::decompressLumpSafe(pSrc, srcSize, pDst, dstSize)) {
+        I_Error("WadFile: lump data is corrupt!");
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: remaps the given lump name if a name remapper is supplied, otherwise returns it as-is.
+// When remapping however don't supply the 'compressed' flag encoded in the lump name.
+// Also re-add it after remapping, don't allow the remapping code to have any say over whether something is compressed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static WadLumpName getRemappedLumpName(const WadLumpName lumpName, const RemapWadLumpNameFn lumpNameRemapFn) noexcept {
+    // This is the normal case for the 'Doom' and 'Final Doom' games - no lump remapper used:
+    if (!lumpNameRemapFn)
+        return lumpName;
+
+    // Games like 'GEC Master Edition (Beta 3)' need some lump remapping to work!
+    const uint64_t compressedLumpBit = lumpName.word() & (~WAD_LUMPNAME_MASK);
+    return lumpNameRemapFn(lumpName.word() ^ compressedLumpBit).word() ^ compressedLumpBit;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: computes the hash words which identify a WAD from its header, lump directory and size
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void computeWadHash(
+    const WadHdr& wadHdr,
+    const WadLumpHdr* const pLumpHdrs,
+    const int32_t wadSize,
+    uint64_t& hashWord1Out,
+    uint64_t& hashWord2Out
+) noexcept {
+    uint8_t md5[16] = {};
+
+    MD5 md5Hasher;
+    md5Hasher.add(&wadHdr, sizeof(wadHdr));
+    md5Hasher.add(pLumpHdrs, wadHdr.numLumps * sizeof(WadLumpHdr));
+    md5Hasher.add(&wadSize, sizeof(wadSize));
+    md5Hasher.getHash(md5);
+
+    hashWord1Out = 0;
+    hashWord2Out = 0;
+
+    for (int32_t i = 0; i < 8; ++i) {
+        hashWord1Out = (hashWord1Out << 8) | md5[i];
+        hashWord2Out = (hashWord2Out << 8) | md5[i + 8];
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Creates a WAD file that has not yet been opened
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -39,6 +99,11 @@ WadFile::WadFile() noexcept
     , mLumpNames{}
     , mLumps{}
     , mFileReader()
+    , mHashWord1(0)
+    , mHashWord2(0)
+    , mLumpCache()
+    , mFilePath()
+    , mLumpNameRemapFn(nullptr)
 {
 }
 
@@ -51,9 +116,18 @@ WadFile::WadFile(WadFile&& other) noexcept
     , mLumpNames(std::move(other.mLumpNames))
     , mLumps(std::move(other.mLumps))
     , mFileReader(std::move(other.mFileReader))
+    , mHashWord1(other.mHashWord1)
+    , mHashWord2(other.mHashWord2)
+    , mLumpCache(std::move(other.mLumpCache))
+    , mFilePath(std::move(other.mFilePath))
+    , mLumpNameRemapFn(other.mLumpNameRemapFn)
 {
     other.mNumLumps = 0;
     other.mSizeInBytes = 0;
+    other.mHashWord1 = 0;
+    other.mHashWord2 = 0;
+    other.mFilePath.clear();
+    other.mLumpNameRemapFn = nullptr;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -69,11 +143,16 @@ WadFile::~WadFile() noexcept {
 void WadFile::close() noexcept {
     purgeAllLumps();
 
+    mLumpCache.close();
     mFileReader.close();
     mLumps.reset();
     mLumpNames.reset();
     mSizeInBytes = 0;
     mNumLumps = 0;
+    mHashWord1 = 0;
+    mHashWord2 = 0;
+    mFilePath.clear();
+    mLumpNameRemapFn = nullptr;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -95,6 +174,7 @@ void WadFile::open(const char* const filePath, const RemapWadLumpNameFn lumpName
     // Open the WAD file and perform all other initialization
     mSizeInBytes = (int32_t) fileSize;
     mFileReader.open(filePath);
+    mFilePath = filePath;
     initAfterOpen(lumpNameRemapFn);
 }
 
@@ -115,6 +195,79 @@ void WadFile::open(const CdFileId fileId, const RemapWadLumpNameFn lumpNameRemap
 
     // Perform all other initialization
     initAfterOpen(lumpNameRemapFn);
+
+    // The contents of the game disc never change, so it is worth keeping an on-disk cache of decompressed lumps for WADs on it (if enabled)
+    if (Config::gbUseLumpCache) {
+        mLumpCache.open(mHashWord1, mHashWord2, mNumLumps);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Re-opens a WAD file on disk after it has been modified, picking up the new locations and sizes of all lumps.
+// This is only possible if the WAD was opened from a real file on disk and if the modified WAD has the same lumps (by name and order)
+// as before, so that existing lump indexes remain valid. If that is not the case then 'false' is returned and the WAD is left as-is.
+// 
+// Note: lumps which are currently cached are NOT purged, the caller must purge any lumps whose data has changed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool WadFile::reopen() noexcept {
+    // Can only do this for real files on disk
+    if (mFilePath.empty())
+        return false;
+
+    // Sanity check the size of the modified WAD file and read its header.
+    // Don't treat any problems here as fatal, since the file might still be in the middle of being written.
+    const int64_t fileSize = FileUtils::getFileSize(mFilePath.c_str());
+
+    if ((fileSize < (int64_t) sizeof(WadHdr)) || (fileSize > INT32_MAX))
+        return false;
+
+    const FileData fileData = FileUtils::getContentsOfFile(mFilePath.c_str());
+
+    if ((!fileData.bytes) || (fileData.size != (size_t) fileSize))
+        return false;
+
+    WadHdr wadHdr = {};
+    std::memcpy(&wadHdr, fileData.bytes.get(), sizeof(WadHdr));
+
+    const bool bIsIWAD = (D_strncasecmp(wadHdr.fileid, "IWAD", sizeof(wadHdr.fileid)) == 0);
+    const bool bIsPWAD = (D_strncasecmp(wadHdr.fileid, "PWAD", sizeof(wadHdr.fileid)) == 0);
+    const int64_t lumpHdrsEnd = (int64_t) wadHdr.lumpHdrsOffset + (int64_t) wadHdr.numLumps * (int64_t) sizeof(WadLumpHdr);
+
+    if (((!bIsIWAD) && (!bIsPWAD)) || (wadHdr.numLumps != mNumLumps) || (wadHdr.lumpHdrsOffset < 0) || (lumpHdrsEnd > fileSize))
+        return false;
+
+    // Check the lump directory: the lumps must have the same names as before and be within the bounds of the file
+    std::unique_ptr<WadLumpHdr[]> lumpHdrs(new WadLumpHdr[mNumLumps]);
+    std::memcpy(lumpHdrs.get(), fileData.bytes.get() + wadHdr.lumpHdrsOffset, mNumLumps * sizeof(WadLumpHdr));
+
+    for (int32_t i = 0; i < mNumLumps; ++i) {
+        const WadLumpHdr& lumpHdr = lumpHdrs[i];
+        const WadLumpName lumpName = getRemappedLumpName(lumpHdr.name, mLumpNameRemapFn);
+
+        if ((lumpName.word() & WAD_LUMPNAME_MASK) != (mLumpNames[i].word() & WAD_LUMPNAME_MASK))
+            return false;
+
+        if ((int64_t) lumpHdr.wadFileOffset > fileSize)
+            return false;
+    }
+
+    // The modified WAD is compatible: re-open the file and update the lump directory.
+    // Note that the 'compressed' flag for a lump may have changed, so update the lump names also.
+    mFileReader.close();
+    mFileReader.open(mFilePath.c_str());
+    mSizeInBytes = (int32_t) fileSize;
+    computeWadHash(wadHdr, lumpHdrs.get(), mSizeInBytes, mHashWord1, mHashWord2);
+
+    for (int32_t i = 0; i < mNumLumps; ++i) {
+        const WadLumpHdr& lumpHdr = lumpHdrs[i];
+        WadLump& lump = mLumps[i];
+
+        mLumpNames[i] = getRemappedLumpName(lumpHdr.name, mLumpNameRemapFn);
+        lump.wadFileOffset = lumpHdr.wadFileOffset;
+        lump.uncompressedSize = lumpHdr.uncompressedSize;
+    }
+
+    return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -210,7 +363,7 @@ const WadLump& WadFile::cacheLump(const int32_t lumpIdx, const int16_t allocTag,
             
             Z_SetUser(pCompressedLump, nullptr); // N.B: Doing this to avoid wiping the cache entry on 'Z_Free'
             Z_Malloc(*gpMainMemZone, lump.uncompressedSize, allocTag, &lump.pCachedData);
-            WadUtils::decompressLump(pCompressedLump, lump.pCachedData);
+            decompressLumpData(lumpIdx, pCompressedLump, getRawSize(lumpIdx), lump.pCachedData);
             Z_Free2(*gpMainMemZone, pCompressedLump);
 
             lump.bIsUncompressed = true;
@@ -222,17 +375,25 @@ const WadLump& WadFile::cacheLump(const int32_t lumpIdx, const int16_t allocTag,
     // If we get to here then the lump is not cached and will have to be loaded.
     // Note that originally the PSX engine disallowed loading lumps during gameplay due to slow CD-ROM I/O, but PsyDoom waives this restriction.
     // This change means that levels no longer need to ship with 'MAPSPR--.IMG' and 'MAPTEX--.IMG' files and can load resources on the fly.
-    int32_t sizeToRead;
+    // Alloc RAM for the lump and read it.
+    void* const pLumpData = allocLumpCacheData(lumpIdx, allocTag, bDecompress);
+    readLump(lumpIdx, pLumpData, bDecompress);
+    return lump;
+}
 
-    if (bDecompress) {
-        sizeToRead = lump.uncompressedSize;
-    } else {
-        sizeToRead = getRawSize(lumpIdx);
-    }
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocates the cached data for the specified lump (which must not already be cached) but does not read it.
+// The data for the lump must be read with 'readLump' or 'readLumps' (using the same decompression setting) before it is used.
+// Returns the memory allocated for the lump.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void* WadFile::allocLumpCacheData(const int32_t lumpIdx, const int16_t allocTag, const bool bDecompress) noexcept {
+    ASSERT(isValidLumpIdx(lumpIdx));
+
+    WadLump& lump = mLumps[lumpIdx];
+    ASSERT(!lump.pCachedData);
 
-    // Alloc RAM for the lump and read it
+    const int32_t sizeToRead = (bDecompress) ? lump.uncompressedSize : getRawSize(lumpIdx);
     Z_Malloc(*gpMainMemZone, sizeToRead, allocTag, &lump.pCachedData);
-    readLump(lumpIdx, lump.pCachedData, bDecompress);
 
     // Save whether the lump is compressed or not.
     // If the lump is compressed then the highest bit of the first character in the name will be set:
@@ -242,7 +403,7 @@ const WadLump& WadFile::cacheLump(const int32_t lumpIdx, const int16_t allocTag,
         lump.bIsUncompressed = true;
     }
 
-    return lump;
+    return lump.pCachedData;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -262,15 +423,49 @@ void WadFile::readLump(const int32_t lumpIdx, void* const pDest, const bool bDec
     const bool bIsLumpCompressed = ((uint8_t) lumpName.chars[0] & 0x80u);
 
     if (bDecompress && bIsLumpCompressed) {
-        // Decompression needed, must alloc a temp buffer for the compressed data before reading and decompressing!
-        void* const pTmpBuffer = Z_EndMalloc(*gpMainMemZone, sizeToRead, PU_STATIC, nullptr);
+        // If the decompressed lump is in the on-disk lump cache then there is no read or decompression required
+        if (const std::byte* const pCachedBytes = mLumpCache.getLumpData(lumpIdx, lump.uncompressedSize)) {
+            std::memcpy(pDest, pCachedBytes, (size_t) lump.uncompressedSize);
+            return;
+        }
 
+        // If the WAD is memory mapped then decompress straight from the mapping, no temp buffer or read required
+        if (const std::byte* const pMappedBytes = mFileReader.getMappedBytes(lump.wadFileOffset, sizeToRead)) {
+            decompressLumpData(lumpIdx, pMappedBytes, sizeToRead, pDest);
+            return;
+        }
+
+        // Decompression needed: read the compressed data in small chunks and decompress each one as it arrives.
+        // This avoids allocating a temp buffer in the zone for all of the compressed data, which could force cached data to be purged.
+        std::byte chunk[LUMP_DECOMPRESS_CHUNK_SIZE];
+        int32_t chunkSize = 0;
+        int32_t bytesLeftToRead = (int32_t) sizeToRead;
+
+        WadUtils::LumpDecompressStream stream;
+        WadUtils::beginLumpDecompressStream(stream, pDest, lump.uncompressedSize);
         mFileReader.seekAbsolute(lump.wadFileOffset);
-        mFileReader.read(pTmpBuffer, sizeToRead);
-        ASSERT(WadUtils::getDecompressedLumpSize(pTmpBuffer) == lump.uncompressedSize);   // Sanity check the WAD data in debug mode
-        WadUtils::decompressLump(pTmpBuffer, pDest);
 
-        Z_Free2(*gpMainMemZone, pTmpBuffer);
+        while (!stream.bFinished) {
+            // Top up the chunk: any data not consumed by the decompressor last time is already at the start of it
+            const int32_t readSize = std::min(bytesLeftToRead, LUMP_DECOMPRESS_CHUNK_SIZE - chunkSize);
+            mFileReader.read(chunk + chunkSize, readSize);
+            chunkSize += readSize;
+            bytesLeftToRead -= readSize;
+
+            // Decompress what we can and move any leftover data to the start of the chunk.
+            // Note: if all the data has been read and the end of the compressed stream was not found then the lump is corrupt.
+            const bool bIsLastChunk = (bytesLeftToRead <= 0);
+            const int32_t bytesConsumed = WadUtils::decompressLumpChunk(stream, chunk, chunkSize, bIsLastChunk);
+
+            if ((bytesConsumed < 0) || (bIsLastChunk && (!stream.bFinished))) {
+                I_Error("WadFile: lump data is corrupt!");
+            }
+
+            chunkSize -= bytesConsumed;
+            std::memmove(chunk, chunk + bytesConsumed, (size_t) chunkSize);
+        }
+
+        mLumpCache.addLump(lumpIdx, pDest, lump.uncompressedSize);
     } else {
         // No decompression needed, can just read straight into the output buffer
         mFileReader.seekAbsolute(lump.wadFileOffset);
@@ -278,10 +473,79 @@ void WadFile::readLump(const int32_t lumpIdx, void* const pDest, const bool bDec
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads a batch of lumps into the given buffers, which must be big enough to accomodate the data.
+// Lumps are read from the file one after the other on this thread, but decompression (where needed) is spread across the game's job
+// worker threads. If the WAD is memory mapped then lumps are decompressed straight from the mapping, otherwise the compressed data is
+// read into temporary buffers first. Lumps in the on-disk lump cache are copied from there and not decompressed at all.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void WadFile::readLumps(const int32_t* const pLumpIdxs, void* const* const pDests, const int32_t numLumps, const bool bDecompress) noexcept {
+    std::vector<WadUtils::LumpDecompressTask> decompressTasks;
+    std::vector<int32_t> decompressTaskLumpIdxs;
+    std::vector<std::unique_ptr<std::byte[]>> tmpBuffers;
+
+    for (int32_t i = 0; i < numLumps; ++i) {
+        const int32_t lumpIdx = pLumpIdxs[i];
+        ASSERT(isValidLumpIdx(lumpIdx));
+
+        // If no decompression is needed then just read the lump now
+        const bool bIsLumpCompressed = ((uint8_t) mLumpNames[lumpIdx].chars[0] & 0x80u);
+
+        if ((!bDecompress) || (!bIsLumpCompressed)) {
+            readLump(lumpIdx, pDests[i], false);
+            continue;
+        }
+
+        // Use the on-disk lump cache if possible, otherwise get the compressed data for the lump and queue it up for decompression
+        const WadLump& lump = mLumps[lumpIdx];
+
+        if (const std::byte* const pCachedBytes = mLumpCache.getLumpData(lumpIdx, lump.uncompressedSize)) {
+            std::memcpy(pDests[i], pCachedBytes, (size_t) lump.uncompressedSize);
+            continue;
+        }
+
+        const int32_t rawSize = getRawSize(lumpIdx);
+        const std::byte* pSrc = mFileReader.getMappedBytes(lump.wadFileOffset, rawSize);
+
+        if (!pSrc) {
+            std::byte* const pTmpBuffer = tmpBuffers.emplace_back(new std::byte[rawSize]).get();
+            mFileReader.seekAbsolute(lump.wadFileOffset);
+            mFileReader.read(pTmpBuffer, rawSize);
+            pSrc = pTmpBuffer;
+        }
+
+        decompressTasks.push_back({ pSrc, rawSize, pDests[i], lump.uncompressedSize, false });
+        decompressTaskLumpIdxs.push_back(lumpIdx);
+    }
+
+    WadUtils::decompressLumps(decompressTasks.data(), (int32_t) decompressTasks.size());
+
+    for (size_t i = 0; i < decompressTasks.size(); ++i) {
+        const WadUtils::LumpDecompressTask& task = decompressTasks[i];
+
+        if (!task.bSucceeded) {
+            I_Error("WadFile::readLumps: lump data is corrupt!");
+        }
+
+        mLumpCache.addLump(decompressTaskLumpIdxs[i], task.pDst, task.dstSize);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decompresses the data for the specified lump into the given buffer, which must be big enough to hold the uncompressed lump.
+// Also adds the decompressed lump to the on-disk lump cache, if the cache is being used.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void WadFile::decompressLumpData(const int32_t lumpIdx, const void* const pSrc, const int32_t srcSize, void* const pDest) noexcept {
+    const int32_t uncompressedSize = mLumps[lumpIdx].uncompressedSize;
+    decompressLumpOrFail(pSrc, srcSize, pDest, uncompressedSize);
+    mLumpCache.addLump(lumpIdx, pDest, uncompressedSize);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Performs WAD initialization after the file has been opened
 //------------------------------------------------------------------------------------------------------------------------------------------
 void WadFile::initAfterOpen(const RemapWadLumpNameFn lumpNameRemapFn) noexcept {
+    mLumpNameRemapFn = lumpNameRemapFn;
     readLumpInfo(lumpNameRemapFn);
 }
 
@@ -306,6 +570,9 @@ void WadFile::readLumpInfo(const RemapWadLumpNameFn lumpNameRemapFn) noexcept {
     mFileReader.seekAbsolute(wadHdr.lumpHdrsOffset);
     mFileReader.read(lumpHdrs.get(), wadHdr.numLumps * sizeof(WadLumpHdr));
 
+    // Hash the header, lump directory and WAD size: this identifies the WAD for the purposes of caching
+    computeWadHash(wadHdr, lumpHdrs.get(), mSizeInBytes, mHashWord1, mHashWord2);
+
     // Setup the list of lump names and lumps using the lump headers
     mNumLumps = wadHdr.numLumps;
     mLumpNames.reset(new WadLumpName[wadHdr.numLumps]);
@@ -317,18 +584,7 @@ void WadFile::readLumpInfo(const RemapWadLumpNameFn lumpNameRemapFn) noexcept {
         const WadLumpHdr& lumpHdr = lumpHdrs[i];
         WadLump& lump = mLumps[i];
 
-        // Remap the lump name if a name remapper is supplied!
-        // When remapping however don't supply the 'compressed' flag encoded in the lump name.
-        // Also re-add it after remapping, don't allow the remapping code to have any say over whether something is compressed:
-        if (lumpNameRemapFn) {
-            // Games like 'GEC Master Edition (Beta 3)' need some lump remapping to work!
-            const uint64_t compressedLumpBit = lumpHdr.name.word() & (~WAD_LUMPNAME_MASK);
-            mLumpNames[i] = lumpNameRemapFn(lumpHdr.name.word() ^ compressedLumpBit).word() ^ compressedLumpBit;
-        } else {
-            // This is the normal case for the 'Doom' and 'Final Doom' games - no lump remapper used:
-            mLumpNames[i] = lumpHdr.name;
-        }
-
+        mLumpNames[i] = getRemappedLumpName(lumpHdr.name, lumpNameRemapFn);
         lump.wadFileOffset = lumpHdr.wadFileOffset;
         lump.uncompressedSize = lumpHdr.uncompressedSize;
     }
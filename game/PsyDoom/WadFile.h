@@ -4,8 +4,10 @@
 #include "Endian.h"
 #include "GameFileReader.h"
 #include "SmallString.h"
+#include "WadLumpCache.h"
 
 #include <memory>
+#include <string>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Holds details about one lump in a wad file (except for the name)
@@ -49,6 +51,11 @@ public:
     void close() noexcept;
     void open(const char* const filePath, const RemapWadLumpNameFn lumpNameRemapFn = nullptr) noexcept;
     void open(const CdFileId fileId, const RemapWadLumpNameFn lumpNameRemapFn = nullptr) noexcept;
+    bool reopen() noexcept;
+
+    inline const std::string& getFilePath() const noexcept {
+        return mFilePath;
+    }
 
     inline bool isValidLumpIdx(const int32_t lumpIdx) const noexcept {
         return ((lumpIdx >= 0) && (lumpIdx < mNumLumps));
@@ -74,7 +81,9 @@ public:
     void purgeAllLumps() noexcept;
     int32_t getRawSize(const int32_t lumpIdx) noexcept;
     const WadLump& cacheLump(const int32_t lumpIdx, const int16_t allocTag, const bool bDecompress) noexcept;
+    void* allocLumpCacheData(const int32_t lumpIdx, const int16_t allocTag, const bool bDecompress) noexcept;
     void readLump(const int32_t lumpIdx, void* const pDest, const bool bDecompress) noexcept;
+    void readLumps(const int32_t* const pLumpIdxs, void* const* const pDests, const int32_t numLumps, const bool bDecompress) noexcept;
 
 private:
     WadFile(const WadFile& other) = delete;
@@ -83,10 +92,16 @@ private:
 
     void initAfterOpen(const RemapWadLumpNameFn lumpNameRemapFn) noexcept;
     void readLumpInfo(const RemapWadLumpNameFn lumpNameRemapFn) noexcept;
+    void decompressLumpData(const int32_t lumpIdx, const void* const pSrc, const int32_t srcSize, void* const pDest) noexcept;
 
     int32_t                         mNumLumps;          // The number of lumps in the WAD
     int32_t                         mSizeInBytes;       // The total size (in bytes) of the entire WAD file
     std::unique_ptr<WadLumpName[]>  mLumpNames;         // Store names in their own list for cache-friendly search
     std::unique_ptr<WadLump[]>      mLumps;             // The details and data for each lump
     GameFileReader                  mFileReader;        // Responsible for reading from the WAD file
+    uint64_t                        mHashWord1;         // Hash of the WAD header and lump directory (word 1): identifies the WAD for caching
+    uint64_t                        mHashWord2;         // Hash of the WAD header and lump directory (word 2): identifies the WAD for caching
+    WadLumpCache                    mLumpCache;         // On-disk cache of decompressed lumps, only used for WADs on the game disc
+    std::string                     mFilePath;          // Path to the WAD file if it is a real file on disk, otherwise empty
+    RemapWadLumpNameFn              mLumpNameRemapFn;   // The lump name remapper the WAD was opened with (if any)
 };
@@ -1,11 +1,15 @@
 #include "WadList.h"
 
+#include "Doom/Base/z_zone.h"
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Initializes the WAD list with no WADS opened
 //------------------------------------------------------------------------------------------------------------------------------------------
 WadList::WadList() noexcept
     : mWadFiles()
     , mLumpHandles()
+    , mLumpNameHashSlots()
+    , mNextSameNameLumpIdx()
 {
 }
 
@@ -59,12 +63,17 @@ void WadList::finalize() noexcept {
             mLumpHandles.push_back({ wadFileIndex, lumpIdx, lumpName.word() & WAD_LUMPNAME_MASK });     // Note: remove the special 'compressed' flag bit to make later search a bit faster
         }
     }
+
+    // Build the index used for finding lumps quickly by name
+    buildLumpNameIndex();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Clears the WAD list and unloads all WADs
 //------------------------------------------------------------------------------------------------------------------------------------------
 void WadList::clear() noexcept {
+    mLumpNameHashSlots.clear();
+    mNextSameNameLumpIdx.clear();
     mLumpHandles.clear();
     mWadFiles.clear();
 }
@@ -75,17 +84,83 @@ void WadList::clear() noexcept {
 // Note: when searching the 'compressed' flag bit in the 1st byte of candidate lump names is ignored.
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t WadList::findLumpIdx(const WadLumpName lumpName, const int32_t searchStartIdx) const noexcept {
-    const int32_t numLumps = (int32_t) mLumpHandles.size();
-    const LumpHandle* const pLumpHandles = mLumpHandles.data();
+    // Nothing to search if the list is not finalized or empty
+    if (mLumpNameHashSlots.empty())
+        return -1;
 
-    for (int32_t i = searchStartIdx; i < numLumps; ++i) {
-        if (pLumpHandles[i].name.word() == lumpName.word())
-            return i;
+    // Find the first lump with this name, then follow the chain of lumps with the same name until we reach the search start point.
+    // Since the chain is in ascending order, this gives the same result as a straight search from the start index.
+    const int32_t slotIdx = getLumpNameHashSlot(lumpName);
+
+    for (int32_t lumpIdx = mLumpNameHashSlots[slotIdx]; lumpIdx >= 0; lumpIdx = mNextSameNameLumpIdx[lumpIdx]) {
+        if (lumpIdx >= searchStartIdx)
+            return lumpIdx;
     }
 
     return -1;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the index in the combined list of lumps of the first lump in the specified WAD file.
+// The lumps for each WAD file are contiguous in the combined list, in the order the WAD files were added.
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t WadList::getWadFirstLumpIdx(const int32_t wadFileIdx) const noexcept {
+    ASSERT((wadFileIdx >= 0) && (wadFileIdx < (int32_t) mWadFiles.size()));
+    int32_t firstLumpIdx = 0;
+
+    for (int32_t i = 0; i < wadFileIdx; ++i) {
+        firstLumpIdx += mWadFiles[i].getNumLumps();
+    }
+
+    return firstLumpIdx;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the hash table used for quickly finding lumps by name.
+// The table is sized to at least twice the number of lumps (and a power of two) so that probe sequences stay short.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void WadList::buildLumpNameIndex() noexcept {
+    const int32_t numLumps = (int32_t) mLumpHandles.size();
+    int32_t numSlots = 16;
+
+    while (numSlots < numLumps * 2) {
+        numSlots *= 2;
+    }
+
+    mLumpNameHashSlots.clear();
+    mLumpNameHashSlots.resize((size_t) numSlots, -1);
+    mNextSameNameLumpIdx.clear();
+    mNextSameNameLumpIdx.resize((size_t) numLumps, -1);
+
+    // Add the lumps in reverse order, so that each lump added becomes the new head of the chain of lumps with the same name.
+    // This leaves the lowest index lump with a name in each slot and ensures the chains are in ascending order.
+    for (int32_t lumpIdx = numLumps - 1; lumpIdx >= 0; --lumpIdx) {
+        const int32_t slotIdx = getLumpNameHashSlot(mLumpHandles[lumpIdx].name);
+        mNextSameNameLumpIdx[lumpIdx] = mLumpNameHashSlots[slotIdx];
+        mLumpNameHashSlots[slotIdx] = lumpIdx;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the hash table slot for the specified lump name.
+// This is either the slot containing lumps with the name or the empty slot where they would be placed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t WadList::getLumpNameHashSlot(const WadLumpName lumpName) const noexcept {
+    const uint64_t nameWord = lumpName.word();
+    const uint32_t slotMask = (uint32_t) mLumpNameHashSlots.size() - 1;
+    uint32_t slotIdx = (uint32_t)((nameWord * 0x9E3779B97F4A7C15ull) >> 32) & slotMask;
+
+    // Linear probing: stop on an empty slot or one containing lumps with this name
+    while (true) {
+        const int32_t lumpIdx = mLumpNameHashSlots[slotIdx];
+
+        if ((lumpIdx < 0) || (mLumpHandles[lumpIdx].name.word() == nameWord))
+            return (int32_t) slotIdx;
+
+        slotIdx = (slotIdx + 1) & slotMask;
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Returns a specified lump in the combined WAD lump list
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -153,6 +228,69 @@ const WadLump& WadList::cacheLump(const int32_t lumpIdx, const int16_t allocTag,
     return wadFile.cacheLump(lumpHandle.wadLumpIdx, allocTag, bDecompress);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Caches a batch of lumps in one go, with the same effect as calling 'cacheLump' for each of them.
+// Memory allocations happen on this thread, then the lumps for each WAD are read (and decompressed in parallel if possible).
+//
+// Note: while lumps are being read the memory for each lump is allocated as 'PU_STATIC', so allocating memory for one lump cannot evict
+// another lump which has not yet been read. The requested alloc tag is applied once the lumps are loaded. To avoid pinning too much of
+// the heap at once, the lumps are loaded in smaller batches if the total size is large.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void WadList::cacheLumps(const int32_t* const pLumpIdxs, const int32_t numLumps, const int16_t allocTag, const bool bDecompress) noexcept {
+    constexpr int32_t MAX_BATCH_SIZE = 4 * 1024 * 1024;
+
+    const int32_t numWadFiles = (int32_t) mWadFiles.size();
+    std::vector<std::vector<int32_t>> wadLumpIdxs((size_t) numWadFiles);
+    std::vector<std::vector<void*>> wadLumpDests((size_t) numWadFiles);
+    std::vector<void*> batchLumps;
+    int32_t batchSize = 0;
+
+    // Reads all the lumps in the current batch for each WAD and gives them the requested alloc tag
+    const auto loadBatch = [&]() noexcept {
+        for (int32_t wadFileIdx = 0; wadFileIdx < numWadFiles; ++wadFileIdx) {
+            std::vector<int32_t>& lumpIdxs = wadLumpIdxs[wadFileIdx];
+            std::vector<void*>& lumpDests = wadLumpDests[wadFileIdx];
+            mWadFiles[wadFileIdx].readLumps(lumpIdxs.data(), lumpDests.data(), (int32_t) lumpIdxs.size(), bDecompress);
+            lumpIdxs.clear();
+            lumpDests.clear();
+        }
+
+        for (void* const pLumpData : batchLumps) {
+            Z_ChangeTag(pLumpData, allocTag);
+        }
+
+        batchLumps.clear();
+        batchSize = 0;
+    };
+
+    // Allocate memory for all lumps which are not yet cached and gather up the reads to be done for each WAD.
+    // Lumps which are already cached don't need reading, though they might need to be decompressed - let 'cacheLump' handle that.
+    for (int32_t i = 0; i < numLumps; ++i) {
+        const int32_t lumpIdx = pLumpIdxs[i];
+        ASSERT(isValidLumpIdx(lumpIdx));
+        const LumpHandle& lumpHandle = mLumpHandles[lumpIdx];
+        WadFile& wadFile = mWadFiles[lumpHandle.wadFileIdx];
+        const WadLump& lump = wadFile.getLump(lumpHandle.wadLumpIdx);
+
+        if (lump.pCachedData) {
+            wadFile.cacheLump(lumpHandle.wadLumpIdx, allocTag, bDecompress);
+            continue;
+        }
+
+        void* const pLumpData = wadFile.allocLumpCacheData(lumpHandle.wadLumpIdx, PU_STATIC, bDecompress);
+        wadLumpIdxs[lumpHandle.wadFileIdx].push_back(lumpHandle.wadLumpIdx);
+        wadLumpDests[lumpHandle.wadFileIdx].push_back(pLumpData);
+        batchLumps.push_back(pLumpData);
+        batchSize += lump.uncompressedSize;
+
+        if (batchSize >= MAX_BATCH_SIZE) {
+            loadBatch();
+        }
+    }
+
+    loadBatch();
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Reads the requested lump index into the given buffer.
 // The buffer must be big enough to accomodate the data and (optionally) decompression can be disabled.
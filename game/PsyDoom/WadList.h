@@ -26,11 +26,15 @@ public:
     const WadLump& getLump(const int32_t lumpIdx) const noexcept;
     const WadLumpName getLumpName(const int32_t lumpIdx) const noexcept;
     inline int32_t getNumLumps() const noexcept { return (int32_t) mLumpHandles.size(); }
+    inline int32_t getNumWadFiles() const noexcept { return (int32_t) mWadFiles.size(); }
+    inline WadFile& getWadFile(const int32_t wadFileIdx) noexcept { return mWadFiles[wadFileIdx]; }
+    int32_t getWadFirstLumpIdx(const int32_t wadFileIdx) const noexcept;
 
     void purgeCachedLump(const int32_t lumpIdx) noexcept;
     void purgeAllLumps() noexcept;
     int32_t getRawSize(const int32_t lumpIdx) noexcept;
     const WadLump& cacheLump(const int32_t lumpIdx, const int16_t allocTag, const bool bDecompress) noexcept;
+    void cacheLumps(const int32_t* const pLumpIdxs, const int32_t numLumps, const int16_t allocTag, const bool bDecompress) noexcept;
     void readLump(const int32_t lumpIdx, void* const pDest, const bool bDecompress) noexcept;
 
 private:
@@ -43,6 +47,15 @@ private:
         WadLumpName     name;           // Note: has the 'compressed' flag removed for faster search
     };
 
+    void buildLumpNameIndex() noexcept;
+    int32_t getLumpNameHashSlot(const WadLumpName lumpName) const noexcept;
+
     std::vector<WadFile>        mWadFiles;
     std::vector<LumpHandle>     mLumpHandles;
+
+    // Open addressing hash table for finding lumps by name, built on finalize.
+    // Each slot holds the index of the first lump with a particular name or '-1' if the slot is empty.
+    // Other lumps with the same name can be found by following the 'next lump with the same name' links, which are in ascending order.
+    std::vector<int32_t>        mLumpNameHashSlots;
+    std::vector<int32_t>        mNextSameNameLumpIdx;
 };
@@ -0,0 +1,243 @@
+#include "WadLumpCache.h"
+
+#include "Asserts.h"
+#include "FileUtils.h"
+#include "Utils.h"
+
+#include <cstdio>
+#include <cstring>
+
+// Info for the pack file
+static constexpr uint32_t   PACK_FILE_MAGIC     = 0x43504D4C;           // 'LMPC'
+static constexpr uint32_t   PACK_FILE_VERSION   = 1;
+
+// Limit on how much new lump data can be added to the cache in one session, to avoid using excessive amounts of memory
+static constexpr size_t     MAX_NEW_LUMP_DATA   = 64 * 1024 * 1024;
+
+struct PackFileHeader {
+    uint32_t    magic;
+    uint32_t    version;
+    uint64_t    wadHashWord1;
+    uint64_t    wadHashWord2;
+    uint32_t    numLumps;
+    uint32_t    _unused;
+};
+
+// An entry in the index of the pack file for one lump: follows the header, one entry per lump in the WAD.
+// A size of '0' means the lump is not in the pack file.
+struct PackFileEntry {
+    uint32_t    offset;             // Offset of the lump data from the start of the pack file
+    uint32_t    size;               // Size of the lump data
+};
+
+static_assert(sizeof(PackFileHeader) == 32);
+static_assert(sizeof(PackFileEntry) == 8);
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates a cache that has not yet been opened
+//------------------------------------------------------------------------------------------------------------------------------------------
+WadLumpCache::WadLumpCache() noexcept
+    : mFilePath()
+    , mWadHashWord1(0)
+    , mWadHashWord2(0)
+    , mEntries()
+    , mNewLumpData()
+    , mNewLumpDataSize(0)
+    , mPackFile()
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Move a cache from one object to another.
+// Note: entries can still point to the data of the moved from object, since moving the mapping and buffers doesn't change their address.
+//------------------------------------------------------------------------------------------------------------------------------------------
+WadLumpCache::WadLumpCache(WadLumpCache&& other) noexcept
+    : mFilePath(std::move(other.mFilePath))
+    , mWadHashWord1(other.mWadHashWord1)
+    , mWadHashWord2(other.mWadHashWord2)
+    , mEntries(std::move(other.mEntries))
+    , mNewLumpData(std::move(other.mNewLumpData))
+    , mNewLumpDataSize(other.mNewLumpDataSize)
+    , mPackFile(std::move(other.mPackFile))
+{
+    other.mEntries.clear();
+    other.mNewLumpData.clear();
+    other.mNewLumpDataSize = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Closes the cache, saving any new lumps to disk
+//------------------------------------------------------------------------------------------------------------------------------------------
+WadLumpCache::~WadLumpCache() noexcept {
+    close();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Opens the cache for the WAD with the specified hash and number of lumps, loading the pack file for it if it exists.
+// Note: if the cache is currently opened then it is closed first.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void WadLumpCache::open(const uint64_t wadHashWord1, const uint64_t wadHashWord2, const int32_t numLumps) noexcept {
+    close();
+
+    if (numLumps <= 0)
+        return;
+
+    char fileName[64];
+    std::snprintf(fileName, sizeof(fileName), "lump_cache_%016llx%016llx.bin", (unsigned long long) wadHashWord1, (unsigned long long) wadHashWord2);
+
+    mFilePath = Utils::getOrCreateUserDataFolder() + fileName;
+    mWadHashWord1 = wadHashWord1;
+    mWadHashWord2 = wadHashWord2;
+    mEntries.resize((size_t) numLumps, Entry{ nullptr, 0 });
+    loadPackFile();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Closes the cache, first saving the pack file if any new lumps were added during this session
+//------------------------------------------------------------------------------------------------------------------------------------------
+void WadLumpCache::close() noexcept {
+    if (mNewLumpDataSize > 0) {
+        savePackFile();
+    }
+
+    mPackFile.close();
+    mNewLumpData.clear();
+    mNewLumpDataSize = 0;
+    mEntries.clear();
+    mFilePath.clear();
+    mWadHashWord1 = 0;
+    mWadHashWord2 = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns the cached data for the specified lump, or null if the lump is not cached.
+// The size of the cached data must match the expected size given, otherwise it is ignored.
+//------------------------------------------------------------------------------------------------------------------------------------------
+const std::byte* WadLumpCache::getLumpData(const int32_t lumpIdx, const int32_t lumpSize) const noexcept {
+    if ((lumpIdx < 0) || ((size_t) lumpIdx >= mEntries.size()))
+        return nullptr;
+
+    const Entry& entry = mEntries[lumpIdx];
+    return ((entry.pData) && (entry.size == (uint32_t) lumpSize)) ? entry.pData : nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds the specified decompressed lump data to the cache, if the cache is open and the lump is not already in it.
+// The data is copied and written to the pack file when the cache is closed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void WadLumpCache::addLump(const int32_t lumpIdx, const void* const pLumpData, const int32_t lumpSize) noexcept {
+    if ((lumpIdx < 0) || ((size_t) lumpIdx >= mEntries.size()) || (lumpSize <= 0))
+        return;
+
+    Entry& entry = mEntries[lumpIdx];
+
+    if (entry.pData && (entry.size == (uint32_t) lumpSize))
+        return;
+
+    if (mNewLumpDataSize + (size_t) lumpSize > MAX_NEW_LUMP_DATA)
+        return;
+
+    std::byte* const pData = mNewLumpData.emplace_back(new std::byte[lumpSize]).get();
+    std::memcpy(pData, pLumpData, (size_t) lumpSize);
+    mNewLumpDataSize += (size_t) lumpSize;
+
+    entry.pData = pData;
+    entry.size = (uint32_t) lumpSize;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Maps the pack file for the cache (if it exists and is valid) and points cache entries to the lump data contained within
+//------------------------------------------------------------------------------------------------------------------------------------------
+void WadLumpCache::loadPackFile() noexcept {
+    if (!FileUtils::fileExists(mFilePath.c_str()))
+        return;
+
+    if (!mPackFile.open(mFilePath.c_str()))
+        return;
+
+    // Verify the header and that the index fits in the file
+    const std::byte* const pFileData = mPackFile.getData();
+    const uint64_t fileSize = mPackFile.getSize();
+    const uint64_t indexSize = (uint64_t) mEntries.size() * sizeof(PackFileEntry);
+
+    if (fileSize < sizeof(PackFileHeader) + indexSize) {
+        mPackFile.close();
+        return;
+    }
+
+    PackFileHeader header;
+    std::memcpy(&header, pFileData, sizeof(PackFileHeader));
+
+    const bool bHeaderOk = (
+        (header.magic == PACK_FILE_MAGIC) &&
+        (header.version == PACK_FILE_VERSION) &&
+        (header.wadHashWord1 == mWadHashWord1) &&
+        (header.wadHashWord2 == mWadHashWord2) &&
+        (header.numLumps == (uint32_t) mEntries.size())
+    );
+
+    if (!bHeaderOk) {
+        mPackFile.close();
+        return;
+    }
+
+    // Point each entry to its data, ignoring any entries which are out of bounds
+    for (size_t i = 0; i < mEntries.size(); ++i) {
+        PackFileEntry packEntry;
+        std::memcpy(&packEntry, pFileData + sizeof(PackFileHeader) + i * sizeof(PackFileEntry), sizeof(PackFileEntry));
+
+        if ((packEntry.size > 0) && ((uint64_t) packEntry.offset + packEntry.size <= fileSize)) {
+            mEntries[i].pData = pFileData + packEntry.offset;
+            mEntries[i].size = packEntry.size;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Writes all lumps in the cache (both previously saved and newly added) to the pack file for the cache
+//------------------------------------------------------------------------------------------------------------------------------------------
+void WadLumpCache::savePackFile() noexcept {
+    // Figure out where all the lump data goes: it follows the header and index
+    const size_t indexSize = mEntries.size() * sizeof(PackFileEntry);
+    size_t fileSize = sizeof(PackFileHeader) + indexSize;
+
+    for (const Entry& entry : mEntries) {
+        fileSize += (entry.pData) ? entry.size : 0;
+    }
+
+    if (fileSize > UINT32_MAX)
+        return;
+
+    // Build the pack file contents
+    std::vector<std::byte> fileData(fileSize);
+
+    PackFileHeader header = {};
+    header.magic = PACK_FILE_MAGIC;
+    header.version = PACK_FILE_VERSION;
+    header.wadHashWord1 = mWadHashWord1;
+    header.wadHashWord2 = mWadHashWord2;
+    header.numLumps = (uint32_t) mEntries.size();
+    std::memcpy(fileData.data(), &header, sizeof(PackFileHeader));
+
+    size_t dataOffset = sizeof(PackFileHeader) + indexSize;
+
+    for (size_t i = 0; i < mEntries.size(); ++i) {
+        const Entry& entry = mEntries[i];
+        PackFileEntry packEntry = {};
+
+        if (entry.pData) {
+            packEntry.offset = (uint32_t) dataOffset;
+            packEntry.size = entry.size;
+            std::memcpy(fileData.data() + dataOffset, entry.pData, entry.size);
+            dataOffset += entry.size;
+        }
+
+        std::memcpy(fileData.data() + sizeof(PackFileHeader) + i * sizeof(PackFileEntry), &packEntry, sizeof(PackFileEntry));
+    }
+
+    // The old pack file must be unmapped before it can be overwritten.
+    // Note: this leaves entries pointing to unmapped data, but the cache is always closed after saving.
+    ASSERT(dataOffset == fileSize);
+    mPackFile.close();
+    FileUtils::writeDataToFile(mFilePath.c_str(), fileData.data(), fileData.size());
+}
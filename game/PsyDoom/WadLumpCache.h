@@ -0,0 +1,54 @@
+#pragma once
+
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// An on-disk cache of decompressed lump data for a single WAD file, so that repeat launches of the game can skip lump decompression.
+// The cache is stored as a single pack file in the user data folder, named after a hash of the WAD's header and lump directory.
+// When opened the pack file is memory mapped and lumps can be served straight from the mapping.
+// Lumps which were decompressed during the session but were not in the cache are added to the pack file when the cache is closed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class WadLumpCache {
+public:
+    WadLumpCache() noexcept;
+    WadLumpCache(WadLumpCache&& other) noexcept;
+    ~WadLumpCache() noexcept;
+
+    void open(const uint64_t wadHashWord1, const uint64_t wadHashWord2, const int32_t numLumps) noexcept;
+    void close() noexcept;
+
+    inline bool isOpen() const noexcept {
+        return (!mEntries.empty());
+    }
+
+    const std::byte* getLumpData(const int32_t lumpIdx, const int32_t lumpSize) const noexcept;
+    void addLump(const int32_t lumpIdx, const void* const pLumpData, const int32_t lumpSize) noexcept;
+
+private:
+    WadLumpCache(const WadLumpCache& other) = delete;
+    WadLumpCache& operator = (const WadLumpCache& other) = delete;
+    WadLumpCache& operator = (WadLumpCache&& other) = delete;
+
+    // An entry in the cache for one lump
+    struct Entry {
+        const std::byte*    pData;      // Data for the lump (in the mapped pack file, or in 'mNewLumpData') or null if not cached
+        uint32_t            size;       // Size of the cached data for the lump
+    };
+
+    void loadPackFile() noexcept;
+    void savePackFile() noexcept;
+
+    std::string                                 mFilePath;          // Path to the pack file for the cache
+    uint64_t                                    mWadHashWord1;      // Hash of the WAD the cache is for (word 1)
+    uint64_t                                    mWadHashWord2;      // Hash of the WAD the cache is for (word 2)
+    std::vector<Entry>                          mEntries;           // Cache entries for every lump in the WAD
+    std::vector<std::unique_ptr<std::byte[]>>   mNewLumpData;       // Data for lumps added during this session, not yet in the pack file
+    size_t                                      mNewLumpDataSize;   // Total size of all the lump data added during this session
+    MappedFile                                  mPackFile;          // Memory mapping of the pack file
+};
@@ -3,61 +3,276 @@
 //------------------------------------------------------------------------------------------------------------------------------------------
 #include "WadUtils.h"
 
+#include "GameJobs.h"
+
+#include <cstring>
+
 BEGIN_NAMESPACE(WadUtils)
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Job function for 'decompressLumps': decompresses the lump at the given index in the batch (given by the context)
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void decompressLumpsJob(void* const pCtx, const uint32_t jobIdx) noexcept {
+    LumpDecompressTask& task = ((LumpDecompressTask*) pCtx)[jobIdx];
+    task.bSucceeded = decompressLumpSafe(task.pSrc, task.srcSize, task.pDst, task.dstSize);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helper: copies a run of repeated bytes from earlier in the output for the decompressor.
+// Uses whole 8 byte moves where the source and destination don't overlap within a move, otherwise copies byte by byte.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline void copyRepeatedBytes(uint8_t* const pDst, const uint8_t* const pRepeatedBytes, const int32_t srcOffset, const int32_t numBytes) noexcept {
+    if (srcOffset >= numBytes) {
+        std::memcpy(pDst, pRepeatedBytes, (size_t) numBytes);
+    } else if (srcOffset >= 8) {
+        // Each 8 byte move only reads bytes that were written before it, so this gives the same result as a byte by byte copy
+        int32_t i = 0;
+
+        for (; i + 8 <= numBytes; i += 8) {
+            std::memcpy(pDst + i, pRepeatedBytes + i, 8);
+        }
+
+        for (; i < numBytes; ++i) {
+            pDst[i] = pRepeatedBytes[i];
+        }
+    } else {
+        for (int32_t i = 0; i < numBytes; ++i) {
+            pDst[i] = pRepeatedBytes[i];
+        }
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Decompresses the given compressed lump data into the given output buffer.
 // The compression algorithm used is a form of LZSS.
 // Assumes the output buffer is sized big enough to hold all of the decompressed data.
+//
+// The stream format is a series of 'id' bytes, each followed by 8 items of data. Each bit of the id byte (lowest bit first) tells what
+// the next item is: '0' means a single uncompressed byte and '1' means 2 bytes referencing repeated data earlier in the output.
+// For speed, the 8 items for an id byte are processed in one go and runs of 8 uncompressed bytes are copied all at once.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void decompressLump(const void* const pSrc, void* const pDst) noexcept {
     const uint8_t* pSrcByte = (const uint8_t*) pSrc;
     uint8_t* pDstByte = (uint8_t*) pDst;
 
-    uint32_t idByte = 0;        // Controls whether there is compressed or uncompressed data ahead
-    uint32_t haveIdByte = 0;    // Controls when to read an id byte, when '0' we need to read another one
+    while (true) {
+        // Read the id byte: we need 1 id byte for every 8 bytes of uncompressed output, or every 8 runs of compressed data.
+        // If all 8 items are uncompressed bytes then just copy them all at once.
+        uint32_t idByte = *pSrcByte;
+        ++pSrcByte;
+
+        if (idByte == 0) {
+            std::memcpy(pDstByte, pSrcByte, 8);
+            pSrcByte += 8;
+            pDstByte += 8;
+            continue;
+        }
+
+        for (int32_t itemIdx = 0; itemIdx < 8; ++itemIdx, idByte >>= 1) {
+            if (idByte & 1) {
+                // Compressed data ahead: the first 12-bits tells where to take repeated data from.
+                // The remaining 4-bits tell how many bytes of repeated data to take.
+                const uint32_t srcByte1 = pSrcByte[0];
+                const uint32_t srcByte2 = pSrcByte[1];
+                pSrcByte += 2;
+
+                const int32_t srcOffset = ((srcByte1 << 4) | (srcByte2 >> 4)) + 1;
+                const int32_t numRepeatedBytes = (srcByte2 & 0xF) + 1;
+
+                // A value of '1' is a special value and means we have reached the end of the compressed stream
+                if (numRepeatedBytes == 1)
+                    return;
 
+                copyRepeatedBytes(pDstByte, pDstByte - srcOffset, srcOffset, numRepeatedBytes);
+                pDstByte += numRepeatedBytes;
+            } else {
+                // Uncompressed data: just copy the input byte
+                *pDstByte = *pSrcByte;
+                ++pSrcByte;
+                ++pDstByte;
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// The result of decompressing some or all of the compressed data for a lump with bounds checking
+//------------------------------------------------------------------------------------------------------------------------------------------
+enum class DecompressResult : uint8_t {
+    Finished,           // Reached the end of the compressed stream
+    Corrupt,            // The compressed data is malformed
+    NeedMoreInput       // All the input given was used up without reaching the end of the stream: only when the input is incomplete
+};
+
+// The most data consumed and produced by one id byte and it's 8 items
+static constexpr int32_t MAX_GROUP_SRC_SIZE = 1 + 8 * 2;
+static constexpr int32_t MAX_GROUP_DST_SIZE = 8 * 16;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Does the work for 'decompressLumpSafe' and 'decompressLumpChunk', checking all reads and writes against the bounds of the buffers.
+// The source and destination pointers are advanced past the data consumed and produced.
+//
+// If the given input is not all of the remaining compressed data then decompression stops before the first id byte whose items might
+// extend past the end of the input, so that the remaining input can be supplied along with more compressed data on the next call.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static DecompressResult decompressGroupsSafe(
+    const uint8_t*& pSrcByte,
+    const uint8_t* const pSrcEnd,
+    const bool bIsLastInput,
+    uint8_t* const pDstBeg,
+    uint8_t*& pDstByte,
+    uint8_t* const pDstEnd
+) noexcept {
     while (true) {
-        // Read the id byte if required.
-        // We need 1 id byte for every 8 bytes of uncompressed output, or every 8 runs of compressed data.
-        if (haveIdByte == 0) {
-            idByte = *pSrcByte;
+        // Fast path: if there is enough input and output space left for all 8 items then only the repeat offsets need checking
+        if ((pSrcEnd - pSrcByte >= MAX_GROUP_SRC_SIZE) && (pDstEnd - pDstByte >= MAX_GROUP_DST_SIZE)) {
+            uint32_t idByte = *pSrcByte;
             ++pSrcByte;
+
+            if (idByte == 0) {
+                std::memcpy(pDstByte, pSrcByte, 8);
+                pSrcByte += 8;
+                pDstByte += 8;
+                continue;
+            }
+
+            for (int32_t itemIdx = 0; itemIdx < 8; ++itemIdx, idByte >>= 1) {
+                if (idByte & 1) {
+                    const uint32_t srcByte1 = pSrcByte[0];
+                    const uint32_t srcByte2 = pSrcByte[1];
+                    pSrcByte += 2;
+
+                    const int32_t srcOffset = ((srcByte1 << 4) | (srcByte2 >> 4)) + 1;
+                    const int32_t numRepeatedBytes = (srcByte2 & 0xF) + 1;
+
+                    if (numRepeatedBytes == 1)
+                        return DecompressResult::Finished;
+
+                    if (pDstByte - pDstBeg < srcOffset)
+                        return DecompressResult::Corrupt;
+
+                    const uint8_t* const pRepeatedBytes = pDstByte - srcOffset;
+
+                    if (srcOffset >= 16) {
+                        std::memcpy(pDstByte, pRepeatedBytes, 16);
+                    } else if (srcOffset >= 8) {
+                        std::memcpy(pDstByte, pRepeatedBytes, 8);
+                        std::memcpy(pDstByte + 8, pRepeatedBytes + 8, 8);
+                    } else {
+                        copyRepeatedBytes(pDstByte, pRepeatedBytes, srcOffset, numRepeatedBytes);
+                    }
+
+                    pDstByte += numRepeatedBytes;
+                } else {
+                    *pDstByte = *pSrcByte;
+                    ++pSrcByte;
+                    ++pDstByte;
+                }
+            }
+
+            continue;
         }
 
-        haveIdByte = (haveIdByte + 1) & 7;
+        // If more input is coming then wait for it, rather than running out of input partway through the items for this id byte
+        if ((!bIsLastInput) && (pSrcEnd - pSrcByte < MAX_GROUP_SRC_SIZE))
+            return DecompressResult::NeedMoreInput;
 
-        if (idByte & 1) {
-            // Compressed data ahead: the first 12-bits tells where to take repeated data from.
-            // The remaining 4-bits tell how many bytes of repeated data to take.
-            const uint32_t srcByte1 = pSrcByte[0];
-            const uint32_t srcByte2 = pSrcByte[1];
-            pSrcByte += 2;
+        // Slow path near the end of the buffers: check everything
+        if (pSrcByte >= pSrcEnd)
+            return DecompressResult::Corrupt;
 
-            const int32_t srcOffset = ((srcByte1 << 4) | (srcByte2 >> 4)) + 1;
-            const int32_t numRepeatedBytes = (srcByte2 & 0xF) + 1;
+        uint32_t idByte = *pSrcByte;
+        ++pSrcByte;
 
-            // A value of '1' is a special value and means we have reached the end of the compressed stream
-            if (numRepeatedBytes == 1)
-                break;
+        for (int32_t itemIdx = 0; itemIdx < 8; ++itemIdx, idByte >>= 1) {
+            if (idByte & 1) {
+                if (pSrcEnd - pSrcByte < 2)
+                    return DecompressResult::Corrupt;
+
+                const uint32_t srcByte1 = pSrcByte[0];
+                const uint32_t srcByte2 = pSrcByte[1];
+                pSrcByte += 2;
 
-            const uint8_t* const pRepeatedBytes = pDstByte - srcOffset;
+                const int32_t srcOffset = ((srcByte1 << 4) | (srcByte2 >> 4)) + 1;
+                const int32_t numRepeatedBytes = (srcByte2 & 0xF) + 1;
 
-            for (int32_t i = 0; i < numRepeatedBytes; ++i) {
-                *pDstByte = pRepeatedBytes[i];
+                if (numRepeatedBytes == 1)
+                    return DecompressResult::Finished;
+
+                if ((pDstByte - pDstBeg < srcOffset) || (pDstEnd - pDstByte < numRepeatedBytes))
+                    return DecompressResult::Corrupt;
+
+                copyRepeatedBytes(pDstByte, pDstByte - srcOffset, srcOffset, numRepeatedBytes);
+                pDstByte += numRepeatedBytes;
+            } else {
+                if ((pSrcByte >= pSrcEnd) || (pDstByte >= pDstEnd))
+                    return DecompressResult::Corrupt;
+
+                *pDstByte = *pSrcByte;
+                ++pSrcByte;
                 ++pDstByte;
             }
-        } else {
-            // Uncompressed data: just copy the input byte
-            *pDstByte = *pSrcByte;
-            ++pSrcByte;
-            ++pDstByte;
         }
-
-        idByte >>= 1;
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A version of 'decompressLump' which checks all reads and writes against the bounds of the input and output buffers.
+// Returns 'false' if the compressed data is malformed, in which case the contents of the output buffer are undefined.
+//
+// Since the output size is known, this version is also able to copy repeated data using fixed size 16 byte moves (which may write past
+// the end of the repeated bytes) as long as there is enough room left in the output. The slack bytes written are overwritten later.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool decompressLumpSafe(const void* const pSrc, const int32_t srcSize, void* const pDst, const int32_t dstSize) noexcept {
+    const uint8_t* pSrcByte = (const uint8_t*) pSrc;
+    uint8_t* pDstByte = (uint8_t*) pDst;
+    const DecompressResult result = decompressGroupsSafe(pSrcByte, pSrcByte + srcSize, true, pDstByte, pDstByte, pDstByte + dstSize);
+    return (result == DecompressResult::Finished);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Begins decompressing a lump incrementally with 'decompressLumpChunk', into the given output buffer
+//------------------------------------------------------------------------------------------------------------------------------------------
+void beginLumpDecompressStream(LumpDecompressStream& stream, void* const pDst, const int32_t dstSize) noexcept {
+    stream.pDstBeg = (uint8_t*) pDst;
+    stream.pDstCur = stream.pDstBeg;
+    stream.pDstEnd = stream.pDstBeg + dstSize;
+    stream.bFinished = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decompresses the next chunk of compressed data for a lump being decompressed incrementally, with the same checks as 'decompressLumpSafe'.
+// This allows a lump to be decompressed as it is read, without needing a buffer for all of the compressed data.
+//
+// Returns how many bytes of the given input were consumed, or '-1' if the compressed data is malformed. Any input not consumed must be
+// supplied again (at the start of the input) on the next call, followed by more compressed data. The last chunk must be flagged as such.
+// Once the end of the compressed stream is reached, 'bFinished' is set on the stream.
+//------------------------------------------------------------------------------------------------------------------------------------------
+int32_t decompressLumpChunk(LumpDecompressStream& stream, const void* const pSrc, const int32_t srcSize, const bool bIsLastChunk) noexcept {
+    ASSERT(!stream.bFinished);
+
+    const uint8_t* const pSrcBeg = (const uint8_t*) pSrc;
+    const uint8_t* pSrcByte = pSrcBeg;
+    const DecompressResult result = decompressGroupsSafe(pSrcByte, pSrcBeg + srcSize, bIsLastChunk, stream.pDstBeg, stream.pDstCur, stream.pDstEnd);
+
+    if (result == DecompressResult::Corrupt)
+        return -1;
+
+    stream.bFinished = (result == DecompressResult::Finished);
+    return (int32_t)(pSrcByte - pSrcBeg);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decompresses a batch of lumps with 'decompressLumpSafe', spreading the work across the game's job worker threads (if running).
+// The success or failure of each decompression is saved in the task for the lump.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void decompressLumps(LumpDecompressTask* const pTasks, const int32_t numTasks) noexcept {
+    if (numTasks <= 0)
+        return;
+
+    GameJobs::run(decompressLumpsJob, pTasks, (uint32_t) numTasks);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Similar to 'decompressLump' except that it does not do any decompression.
 // Instead this function returns the decompressed size of the lump data, given just the data itself.
@@ -75,6 +290,13 @@ int32_t getDecompressedLumpSize(const void* const pSrc) noexcept {
         if (haveIdByte == 0) {
             idByte = *pSrcByte;
             ++pSrcByte;
+
+            // Fast path: skip past all 8 items at once if they are all uncompressed bytes
+            if (idByte == 0) {
+                size += 8;
+                pSrcByte += 8;
+                continue;
+            }
         }
 
         haveIdByte = (haveIdByte + 1) & 7;
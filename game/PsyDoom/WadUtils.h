@@ -4,7 +4,28 @@
 
 BEGIN_NAMESPACE(WadUtils)
 
+// Describes a lump to be decompressed as part of a batch
+struct LumpDecompressTask {
+    const void*     pSrc;
+    int32_t         srcSize;
+    void*           pDst;
+    int32_t         dstSize;
+    bool            bSucceeded;     // Output: whether the data was decompressed successfully
+};
+
+// State for a lump being decompressed incrementally, as it's compressed data is read in chunks
+struct LumpDecompressStream {
+    uint8_t*        pDstBeg;
+    uint8_t*        pDstCur;
+    uint8_t*        pDstEnd;
+    bool            bFinished;      // Set once the end of the compressed stream has been reached
+};
+
 void decompressLump(const void* const pSrc, void* const pDst) noexcept;
+bool decompressLumpSafe(const void* const pSrc, const int32_t srcSize, void* const pDst, const int32_t dstSize) noexcept;
+void beginLumpDecompressStream(LumpDecompressStream& stream, void* const pDst, const int32_t dstSize) noexcept;
+int32_t decompressLumpChunk(LumpDecompressStream& stream, const void* const pSrc, const int32_t srcSize, const bool bIsLastChunk) noexcept;
+void decompressLumps(LumpDecompressTask* const pTasks, const int32_t numTasks) noexcept;
 int32_t getDecompressedLumpSize(const void* const pSrc) noexcept;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,80 @@
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helpers for reporting on main memory zone usage: converts zone statistics to json for the timedemo and simulation benchmark results.
+// These reports are used to size the zone heap and to catch memory leaks across levels, by comparing usage at the start and end of a run.
+//------------------------------------------------------------------------------------------------------------------------------------------
+#include "ZoneStats.h"
+
+#include "Doom/Base/z_zone.h"
+
+BEGIN_NAMESPACE(ZoneStats)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Captures the allocation totals of the main memory zone, so the amount allocated over a period of time can be worked out later
+//------------------------------------------------------------------------------------------------------------------------------------------
+Snapshot takeSnapshot() noexcept {
+    Snapshot snapshot = {};
+
+    if (gpMainMemZone) {
+        snapshot.numMallocs = gpMainMemZone->numMallocs;
+        snapshot.numBytesMalloced = gpMainMemZone->numBytesMalloced;
+    }
+
+    return snapshot;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts the given zone statistics to a json object
+//------------------------------------------------------------------------------------------------------------------------------------------
+rapidjson::Value statsToJson(const zonestats_t& stats, rapidjson::Document::AllocatorType& allocator) noexcept {
+    rapidjson::Value jsonObj(rapidjson::kObjectType);
+    jsonObj.AddMember("totalBytes", stats.totalBytes, allocator);
+    jsonObj.AddMember("peakTotalBytes", stats.peakTotalBytes, allocator);
+    jsonObj.AddMember("usedBytes", stats.usedBytes, allocator);
+    jsonObj.AddMember("freeBytes", stats.freeBytes, allocator);
+    jsonObj.AddMember("largestFreeBlock", stats.largestFreeBlock, allocator);
+    jsonObj.AddMember("numUsedBlocks", stats.numUsedBlocks, allocator);
+    jsonObj.AddMember("numFreeBlocks", stats.numFreeBlocks, allocator);
+
+    rapidjson::Value tagsJson(rapidjson::kObjectType);
+    tagsJson.AddMember("PU_STATIC", stats.staticBytes, allocator);
+    tagsJson.AddMember("PU_LEVEL", stats.levelBytes, allocator);
+    tagsJson.AddMember("PU_LEVSPEC", stats.levSpecBytes, allocator);
+    tagsJson.AddMember("PU_ANIMATION", stats.animationBytes, allocator);
+    tagsJson.AddMember("PU_CACHE", stats.cacheBytes, allocator);
+    tagsJson.AddMember("other", stats.otherTagBytes, allocator);
+    jsonObj.AddMember("bytesByTag", tagsJson, allocator);
+
+    return jsonObj;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes a json report on main memory zone usage over a run of the given number of ticks.
+// The state of the zone at the start of the run is given, and the current state of the zone is used as the state at the end of the run.
+//------------------------------------------------------------------------------------------------------------------------------------------
+rapidjson::Value mainZoneToJson(
+    const zonestats_t& startStats,
+    const Snapshot& startSnapshot,
+    const uint64_t numTicks,
+    rapidjson::Document::AllocatorType& allocator
+) noexcept {
+    zonestats_t endStats = {};
+
+    if (gpMainMemZone) {
+        Z_GetStats(*gpMainMemZone, endStats);
+    }
+
+    const Snapshot endSnapshot = takeSnapshot();
+    const uint64_t numMallocs = endSnapshot.numMallocs - startSnapshot.numMallocs;
+    const uint64_t numBytesMalloced = endSnapshot.numBytesMalloced - startSnapshot.numBytesMalloced;
+
+    rapidjson::Value jsonObj(rapidjson::kObjectType);
+    jsonObj.AddMember("atStart", statsToJson(startStats, allocator), allocator);
+    jsonObj.AddMember("atEnd", statsToJson(endStats, allocator), allocator);
+    jsonObj.AddMember("numMallocs", numMallocs, allocator);
+    jsonObj.AddMember("numBytesMalloced", numBytesMalloced, allocator);
+    jsonObj.AddMember("mallocsPerTick", (numTicks > 0) ? (double) numMallocs / (double) numTicks : 0.0, allocator);
+    jsonObj.AddMember("bytesMallocedPerTick", (numTicks > 0) ? (double) numBytesMalloced / (double) numTicks : 0.0, allocator);
+    return jsonObj;
+}
+
+END_NAMESPACE(ZoneStats)
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstdint>
+#include <rapidjson/document.h>
+
+struct memzone_t;
+struct zonestats_t;
+
+BEGIN_NAMESPACE(ZoneStats)
+
+// A snapshot of the state of the main memory zone at a point in time, used to report on memory usage over a period of game ticks
+struct Snapshot {
+    uint64_t    numMallocs;             // Number of allocations made in the zone so far
+    uint64_t    numBytesMalloced;       // Total bytes allocated in the zone so far
+};
+
+Snapshot takeSnapshot() noexcept;
+rapidjson::Value statsToJson(const zonestats_t& stats, rapidjson::Document::AllocatorType& allocator) noexcept;
+
+rapidjson::Value mainZoneToJson(
+    const zonestats_t& startStats,
+    const Snapshot& startSnapshot,
+    const uint64_t numTicks,
+    rapidjson::Document::AllocatorType& allocator
+) noexcept;
+
+END_NAMESPACE(ZoneStats)
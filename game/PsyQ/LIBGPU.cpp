@@ -187,6 +187,9 @@ void LIBGPU_LoadImage(const SRECT& dstRect, const uint16_t* const pImageData) no
     ASSERT(dstRect.w <= gpu.ramPixelW);
     ASSERT(dstRect.h <= gpu.ramPixelH);
 
+    // PsyDoom: make sure any deferred draws are done before modifying VRAM, since they might use the texture being overwritten
+    Gpu::flushDeferredDraw(gpu);
+
     // Determine the destination bounds and row size for the copy.
     // Note that we must wrap horizontal coordinates (see comments below).
     const uint16_t rowW = dstRect.w;
@@ -216,6 +219,9 @@ void LIBGPU_LoadImage(const SRECT& dstRect, const uint16_t* const pImageData) no
             // Usual case: no wraparound, so we can do a simple memcpy for the entire row
             std::memcpy(pDstRow + dstLx, pSrcPixels, rowW * sizeof(uint16_t));
             pSrcPixels += rowW;
+
+            // PsyDoom: discard any cached CLUTs that were overwritten
+            Gpu::invalidateClutCache(gpu, dstLx, dstYWrapped, rowW, 1);
         }
         else {
             // The copy wraps around to the left side of VRAM, need to do 2 separate memcpy operations:
@@ -227,6 +233,10 @@ void LIBGPU_LoadImage(const SRECT& dstRect, const uint16_t* const pImageData) no
 
             std::memcpy(pDstRow, pSrcPixels, numWrappedPixels * sizeof(uint16_t));
             pSrcPixels += numWrappedPixels;
+
+            // PsyDoom: discard any cached CLUTs that were overwritten
+            Gpu::invalidateClutCache(gpu, dstLx, dstYWrapped, (uint16_t) numNonWrappedPixels, 1);
+            Gpu::invalidateClutCache(gpu, 0, dstYWrapped, (uint16_t) numWrappedPixels, 1);
         }
     }
 
@@ -307,6 +317,9 @@ int32_t LIBGPU_MoveImage(const SRECT& srcRect, const int32_t dstX, const int32_t
     ASSERT(dstX + srcRect.w <= gpu.ramPixelW);
     ASSERT(dstY + srcRect.y <= gpu.ramPixelH);
 
+    // PsyDoom: make sure any deferred draws are done before accessing VRAM
+    Gpu::flushDeferredDraw(gpu);
+
     // Copy each row
     const uint32_t numRows = srcRect.h;
     const uint32_t rowSize = srcRect.w * sizeof(uint16_t);
@@ -320,6 +333,9 @@ int32_t LIBGPU_MoveImage(const SRECT& srcRect, const int32_t dstX, const int32_t
         pDstRow += gpu.ramPixelW;
     }
 
+    // PsyDoom: discard any cached CLUTs that were overwritten
+    Gpu::invalidateClutCache(gpu, (uint16_t) dstX, (uint16_t) dstY, (uint16_t) srcRect.w, (uint16_t) srcRect.h);
+
     return 0;   // This is the position of the command in the queue, according to PsyQ docs - don't care about this...
 }
 
@@ -57,6 +57,14 @@ static uint32_t gTransferStartAddr;
 // See the implementation of 'LIBSPU__spu_note2pitch' for more details on that.
 static uint16_t gVoiceBaseNotes[SPU_NUM_VOICES] = {};
 
+// PsyDoom: voice and SPU settings are now submitted to the SPU via commands which are executed later, without locking the SPU.
+// Because of this LIBSPU now tracks the latest requested values for settings that it needs to read back, or partially modify.
+// It also remembers the key on commands issued for voices, so it can report voices as 'on' while their key on commands are pending.
+static Spu::AdsrEnvelope    gVoiceEnvs[SPU_NUM_VOICES] = {};        // The latest envelope settings requested for each voice
+static SpuVoiceMask         gVoiceReverbBits = {};                  // The latest reverb on/off settings requested for each voice
+static SpuVoiceMask         gVoicePendingKeyOnBits = {};            // Which voices might have a key on command which is not yet executed
+static uint32_t             gVoiceKeyOnCmdSeqNums[SPU_NUM_VOICES];  // The sequence number of the last key on command for each voice
+
 // Internal LIBSPU function: convert a note to a pitch.
 // See definition for details.
 uint16_t LIBSPU__spu_note2pitch(
@@ -66,6 +74,23 @@ uint16_t LIBSPU__spu_note2pitch(
     const uint16_t offsetNoteFrac
 ) noexcept;
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: submits a command to the SPU to be executed later and returns the sequence number of the command
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint32_t LIBSPU_SubmitCmd(const Spu::CmdType type, const uint32_t voiceIdx, const uint32_t value) noexcept {
+    return PsxVm::submitSpuCmd(Spu::Cmd{ type, false, (uint16_t) voiceIdx, value });
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// PsyDoom addition: submits a command to the SPU to set the envelope for a voice, using the latest requested envelope for the voice
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void LIBSPU_SubmitVoiceEnvCmd(const uint32_t voiceIdx) noexcept {
+    static_assert(sizeof(Spu::AdsrEnvelope) == sizeof(uint32_t));
+    uint32_t envBits = 0;
+    std::memcpy(&envBits, &gVoiceEnvs[voiceIdx], sizeof(envBits));
+    LIBSPU_SubmitCmd(Spu::CmdType::VoiceEnv, voiceIdx, envBits);
+}
+
 #if PSYDOOM_LIMIT_REMOVING
 //------------------------------------------------------------------------------------------------------------------------------------------
 // PsyDoom addition: computes the reverb base address (divided by 8) for potentially extended PSX sound ram given a reverb base address in
@@ -115,22 +140,26 @@ void LIBSPU_SpuSetVoiceAttr(const SpuVoiceAttr& attribs) noexcept {
     const bool bSetVolR         = (bSetAllAttribs || (attribMask & SPU_VOICE_VOLR));
     const bool bSetVolModeR     = (bSetAllAttribs || (attribMask & SPU_VOICE_VOLMODER));
 
-    // Set the required attributes for all specified voices
-    Spu::Core& spu = PsxVm::gSpu;
-    PsxVm::LockSpu spuLock;
-
+    // Set the required attributes for all specified voices.
+    // PsyDoom: these are now submitted as commands to the SPU, so the SPU doesn't need to be locked.
+    // Note: the SPU voice count is fixed after init, so it is safe to read without locking.
+    const uint32_t numVoices = std::min(SPU_NUM_VOICES, PsxVm::gSpu.numVoices);
     const SpuVoiceMask voiceBits = attribs.voice_bits;
 
-    for (uint32_t voiceIdx = 0; voiceIdx < spu.numVoices; ++voiceIdx) {
+    const bool bSetEnv = (
+        bSetAttackRate || bSetDecayRate || bSetSustainLevel || bSetSustainRate || bSetReleaseRate || bSetAdsrPart1 || bSetAdsrPart2
+    );
+
+    for (uint32_t voiceIdx = 0; voiceIdx < numVoices; ++voiceIdx) {
         // Skip this voice if we're not setting its attributes
         if ((voiceBits & (SpuVoiceMask(1) << voiceIdx)) == 0)
             continue;
 
         // Set: voice 'pitch' or sample rate. Note that '4,096' = '44,100 Hz'.
-        Spu::Voice& voice = spu.pVoices[voiceIdx];
+        Spu::AdsrEnvelope& env = gVoiceEnvs[voiceIdx];
 
         if (bSetPitch) {
-            voice.sampleRate = attribs.pitch;
+            LIBSPU_SubmitCmd(Spu::CmdType::VoiceSampleRate, voiceIdx, attribs.pitch);
         }
 
         // Set: voice 'base' note at which the sample rate is regarded to be '44,100 Hz'
@@ -144,46 +173,46 @@ void LIBSPU_SpuSetVoiceAttr(const SpuVoiceAttr& attribs) noexcept {
             const uint16_t baseNote = gVoiceBaseNotes[voiceIdx];
             const uint16_t note = attribs.note;
             const uint16_t sampleRate = LIBSPU__spu_note2pitch(baseNote >> 8, baseNote & 0xFF, note >> 8, note & 0xFF);
-            voice.sampleRate = sampleRate;
+            LIBSPU_SubmitCmd(Spu::CmdType::VoiceSampleRate, voiceIdx, sampleRate);
         }
 
         // Set: the start address (64-bit word index) for the voice wave data.
         // If the given address is not 64-bit aligned then it is aligned up to the next 64-bit boundary.
         if (bSetWaveAddr) {
             const uint32_t addr = (attribs.addr + 7) / 8;
-            voice.adpcmStartAddr8 = addr;
+            LIBSPU_SubmitCmd(Spu::CmdType::VoiceStartAddr8, voiceIdx, addr);
         }
 
         // Set: attack rate
         if (bSetAttackRate) {
             const uint32_t attackRate = (attribs.ar < 0x7F) ? attribs.ar : 0x7F;
-            voice.env.attackStep = (attackRate & 0b0000'0011);
-            voice.env.releaseShift = (attackRate & 0b0111'1100) >> 2;
+            env.attackStep = (attackRate & 0b0000'0011);
+            env.releaseShift = (attackRate & 0b0111'1100) >> 2;
 
             // Set: attack rate mode (exponential or not).
             // If not specified then default to 'linear' increase mode.
             if (bSetAttackMode) {
-                voice.env.bAttackExp = (attribs.a_mode == SPU_VOICE_EXPIncN) ? 1 : 0;
+                env.bAttackExp = (attribs.a_mode == SPU_VOICE_EXPIncN) ? 1 : 0;
             } else {
-                voice.env.bAttackExp = 0;
+                env.bAttackExp = 0;
             }
         }
 
         // Set: decay rate
         if (bSetDecayRate) {
-            voice.env.decayShift = (attribs.dr < 0xF) ? attribs.dr : 0xF;
+            env.decayShift = (attribs.dr < 0xF) ? attribs.dr : 0xF;
         }
 
         // Set: sustain level
         if (bSetSustainLevel) {
-            voice.env.sustainLevel = (attribs.sl < 0xF) ? attribs.sl : 0xF;
+            env.sustainLevel = (attribs.sl < 0xF) ? attribs.sl : 0xF;
         }
 
         // Set: sustain rate
         if (bSetSustainRate) {
             const uint32_t sustainRate = (attribs.sr < 0x7F) ? attribs.sr : 0x7F;
-            voice.env.sustainStep = (sustainRate & 0b0000'0011);
-            voice.env.sustainShift = (sustainRate & 0b0111'1100) >> 2;
+            env.sustainStep = (sustainRate & 0b0000'0011);
+            env.sustainShift = (sustainRate & 0b0111'1100) >> 2;
 
             // Set: sustain rate mode (increase and exponential or not).
             // If not specified then default to 'increase' and NOT 'exponential' mode.
@@ -205,26 +234,26 @@ void LIBSPU_SpuSetVoiceAttr(const SpuVoiceAttr& attribs) noexcept {
                     default: break;
                 }
 
-                voice.env.bSustainDec = dir;
-                voice.env.bSustainExp = mode;
+                env.bSustainDec = dir;
+                env.bSustainExp = mode;
             } else {
-                voice.env.bSustainDec = 0;
-                voice.env.bSustainExp = 0;
+                env.bSustainDec = 0;
+                env.bSustainExp = 0;
             }
         }
 
         // Set: release rate
         if (bSetReleaseRate) {
             const uint32_t releaseRate = (attribs.rr < 0x1F) ? attribs.rr : 0x1F;
-            voice.env.releaseShift = releaseRate;
+            env.releaseShift = releaseRate;
 
             // Set: release rate mode (exponential or not).
             // If not specified then default to 'linear' mode.
-            voice.env.bReleaseExp = 0;
+            env.bReleaseExp = 0;
 
             if (bSetReleaseMode) {
                 if (attribs.r_mode == SPU_VOICE_EXPDec) {
-                    voice.env.bReleaseExp = 1;
+                    env.bReleaseExp = 1;
                 }
             }
         }
@@ -234,31 +263,31 @@ void LIBSPU_SpuSetVoiceAttr(const SpuVoiceAttr& attribs) noexcept {
             // Note: the original PSX code set the low 16-bits of the ADSR envelope directly using 'attribs.adsr1'.
             // We can't rely on that method however because a particular bitfield order is not guaranteed in C++.
             // Instead decode all fields individually in a portable manner:
-            voice.env.sustainLevel = attribs.adsr1 & 0xF;
-            voice.env.decayShift = (attribs.adsr1 >> 4) & 0xF;
-            voice.env.attackStep = (attribs.adsr1 >> 8) & 0x3;
-            voice.env.attackShift = (attribs.adsr1 >> 10) & 0x1F;
-            voice.env.bAttackExp = (attribs.adsr1 >> 15);
+            env.sustainLevel = attribs.adsr1 & 0xF;
+            env.decayShift = (attribs.adsr1 >> 4) & 0xF;
+            env.attackStep = (attribs.adsr1 >> 8) & 0x3;
+            env.attackShift = (attribs.adsr1 >> 10) & 0x1F;
+            env.bAttackExp = (attribs.adsr1 >> 15);
         }
 
         if (bSetAdsrPart2) {
             // Note: the original PSX code set the high 16-bits of the ADSR envelope directly using 'attribs.adsr2'.
             // We can't rely on that method however because a particular bitfield order is not guaranteed in C++.
             // Instead decode all fields individually in a portable manner:
-            voice.env.releaseShift = attribs.adsr2 & 0x1F;
-            voice.env.bReleaseExp = (attribs.adsr2 >> 5) & 0x1;
-            voice.env.sustainStep = (attribs.adsr2 >> 6) & 0x3;
-            voice.env.sustainShift = (attribs.adsr2 >> 8) & 0x1F;
-            voice.env._unused = (attribs.adsr2 >> 13) & 0x1;
-            voice.env.bSustainDec = (attribs.adsr2 >> 14) & 0x1;
-            voice.env.bSustainExp = attribs.adsr2 >> 15;
+            env.releaseShift = attribs.adsr2 & 0x1F;
+            env.bReleaseExp = (attribs.adsr2 >> 5) & 0x1;
+            env.sustainStep = (attribs.adsr2 >> 6) & 0x3;
+            env.sustainShift = (attribs.adsr2 >> 8) & 0x1F;
+            env._unused = (attribs.adsr2 >> 13) & 0x1;
+            env.bSustainDec = (attribs.adsr2 >> 14) & 0x1;
+            env.bSustainExp = attribs.adsr2 >> 15;
         }
 
         // Set: wave loop address (64-bit word index).
         // If the given address is not 64-bit aligned then it is aligned up to the next 64-bit boundary.
         if (bSetWaveLoopAddr) {
             const uint32_t addr = (attribs.loop_addr + 7) / 8;
-            voice.adpcmRepeatAddr8 = addr;
+            LIBSPU_SubmitCmd(Spu::CmdType::VoiceRepeatAddr8, voiceIdx, addr);
         }
 
         // Set: left volume and mode
@@ -266,11 +295,11 @@ void LIBSPU_SpuSetVoiceAttr(const SpuVoiceAttr& attribs) noexcept {
             const uint16_t mode = (bSetVolModeL) ? attribs.volmode.left : 0;
 
             if (mode == 0) {
-                voice.volume.left = attribs.volume.left & 0x7FFF;
+                LIBSPU_SubmitCmd(Spu::CmdType::VoiceVolumeL, voiceIdx, (uint16_t)(attribs.volume.left & 0x7FFF));
             } else {
                 const uint16_t volBits = (attribs.volume.left < 0x7F) ? attribs.volume.left : 0x7F;
                 const uint16_t modeBits = 0x8000 | ((mode - 1) << 12);
-                voice.volume.left = modeBits | volBits;
+                LIBSPU_SubmitCmd(Spu::CmdType::VoiceVolumeL, voiceIdx, (uint16_t)(modeBits | volBits));
             }
         }
 
@@ -279,13 +308,18 @@ void LIBSPU_SpuSetVoiceAttr(const SpuVoiceAttr& attribs) noexcept {
             const uint16_t mode = (bSetVolModeR) ? attribs.volmode.right : 0;
 
             if (mode == 0) {
-                voice.volume.right = attribs.volume.right & 0x7FFF;
+                LIBSPU_SubmitCmd(Spu::CmdType::VoiceVolumeR, voiceIdx, (uint16_t)(attribs.volume.right & 0x7FFF));
             } else {
                 const uint16_t volBits = (attribs.volume.right < 0x7F) ? attribs.volume.right : 0x7F;
                 const uint16_t modeBits = 0x8000 | ((mode - 1) << 12);
-                voice.volume.right = modeBits | volBits;
+                LIBSPU_SubmitCmd(Spu::CmdType::VoiceVolumeR, voiceIdx, (uint16_t)(modeBits | volBits));
             }
         }
+
+        // Send the updated envelope to the SPU if it changed
+        if (bSetEnv) {
+            LIBSPU_SubmitVoiceEnvCmd(voiceIdx);
+        }
     }
 }
 
@@ -522,19 +556,17 @@ void LIBSPU_SpuSetCommonAttr(const SpuCommonAttr& attribs) noexcept {
         const bool bSetExtMix       = (bSetAllAttribs || (attribMask & SPU_COMMON_EXTMIX));
     #endif
 
-    // Set: master volume and mode (left)
-    Spu::Core& spu = PsxVm::gSpu;
-    PsxVm::LockSpu spuLock;
-
+    // Set: master volume and mode (left).
+    // PsyDoom: these are now submitted as commands to the SPU, so the SPU doesn't need to be locked.
     if (bSetMVolL) {
         const uint16_t mode = (bSetMVolModeL) ? attribs.mvolmode.left : 0;
 
         if (mode == 0) {
-            spu.masterVol.left = attribs.mvol.left & 0x7FFF;
+            LIBSPU_SubmitCmd(Spu::CmdType::MasterVolL, 0, (uint16_t)(attribs.mvol.left & 0x7FFF));
         } else {
             const uint16_t volBits = std::max(std::min(attribs.mvol.left, (int16_t) 0x7F), (int16_t) 0);
             const uint16_t modeBits = 0x8000 | ((mode - 1) << 12);
-            spu.masterVol.left = modeBits | volBits;
+            LIBSPU_SubmitCmd(Spu::CmdType::MasterVolL, 0, (uint16_t)(modeBits | volBits));
         }
     }
 
@@ -543,11 +575,11 @@ void LIBSPU_SpuSetCommonAttr(const SpuCommonAttr& attribs) noexcept {
         const uint16_t mode = (bSetMVolModeR) ? attribs.mvolmode.right : 0;
 
         if (mode == 0) {
-            spu.masterVol.right = attribs.mvol.right & 0x7FFF;
+            LIBSPU_SubmitCmd(Spu::CmdType::MasterVolR, 0, (uint16_t)(attribs.mvol.right & 0x7FFF));
         } else {
             const uint16_t volBits = std::max(std::min(attribs.mvol.right, (int16_t) 0x7F), (int16_t) 0);
             const uint16_t modeBits = 0x8000 | ((mode - 1) << 12);
-            spu.masterVol.right = modeBits | volBits;
+            LIBSPU_SubmitCmd(Spu::CmdType::MasterVolR, 0, (uint16_t)(modeBits | volBits));
         }
     }
 
@@ -558,20 +590,20 @@ void LIBSPU_SpuSetCommonAttr(const SpuCommonAttr& attribs) noexcept {
 
     // Set: cd volume left and right
     if (bSetCdVolL) {
-        spu.extInputVol.left = attribs.cd.volume.left;
+        LIBSPU_SubmitCmd(Spu::CmdType::ExtInputVolL, 0, (uint16_t) attribs.cd.volume.left);
     }
 
     if (bSetCdVolR) {
-        spu.extInputVol.right = attribs.cd.volume.right;
+        LIBSPU_SubmitCmd(Spu::CmdType::ExtInputVolR, 0, (uint16_t) attribs.cd.volume.right);
     }
 
     // Set: cd reverb and mix enabled
     if (bSetCdReverb) {
-        spu.bExtReverbEnable = (attribs.cd.reverb != 0);
+        LIBSPU_SubmitCmd(Spu::CmdType::ExtReverbEnable, 0, (attribs.cd.reverb != 0));
     }
 
     if (bSetCdMix) {
-        spu.bExtEnabled = (attribs.cd.mix != 0);
+        LIBSPU_SubmitCmd(Spu::CmdType::ExtEnabled, 0, (attribs.cd.mix != 0));
     }
 
     // Attributes relating to PlayStation external inputs are ignored for PsyDoom (see comments above)
@@ -625,6 +657,7 @@ int32_t LIBSPU_SpuClearReverbWorkArea() noexcept {
         if (reverbBaseAddr < spu.ramSize) {
             const uint32_t reverbAreaSize = spu.ramSize - reverbBaseAddr;
             std::memset(spu.pRam + reverbBaseAddr, 0, reverbAreaSize);
+            Spu::invalidateAdpcmCache(spu, reverbBaseAddr, reverbAreaSize);
         }
     #endif
 
@@ -644,15 +677,13 @@ void LIBSPU_SpuStart() noexcept {
 // By default both left and right channels are set, but you can set independently using 'SPU_REV_DEPTHL' and 'SPU_REV_DEPTHR' mask flags.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void LIBSPU_SpuSetReverbDepth(const SpuReverbAttr& reverb) noexcept {
-    Spu::Core& spu = PsxVm::gSpu;
-    PsxVm::LockSpu spuLock;
-
+    // PsyDoom: these are now submitted as commands to the SPU, so the SPU doesn't need to be locked
     if ((reverb.mask == 0) || (reverb.mask & SPU_REV_DEPTHL)) {
-        spu.reverbVol.left = reverb.depth.left;
+        LIBSPU_SubmitCmd(Spu::CmdType::ReverbVolL, 0, (uint16_t) reverb.depth.left);
     }
 
     if ((reverb.mask == 0) || (reverb.mask & SPU_REV_DEPTHR)) {
-        spu.reverbVol.right = reverb.depth.right;
+        LIBSPU_SubmitCmd(Spu::CmdType::ReverbVolR, 0, (uint16_t) reverb.depth.right);
     }
 }
 
@@ -667,34 +698,37 @@ void LIBSPU_SpuSetReverbDepth(const SpuReverbAttr& reverb) noexcept {
 //            If the bit is set then reverb is enabled.
 //------------------------------------------------------------------------------------------------------------------------------------------
 SpuVoiceMask LIBSPU_SpuSetReverbVoice(const int32_t onOff, const SpuVoiceMask voiceBits) noexcept {
-    // Enabling/disabling reverb for every single voice with the bit mask?
-    Spu::Core& spu = PsxVm::gSpu;
-    PsxVm::LockSpu spuLock;
+    // PsyDoom: reverb settings for voices are now submitted as commands to the SPU, so the SPU doesn't need to be locked.
+    // The latest requested reverb settings are tracked by LIBSPU so they can be returned.
+    const uint32_t numVoices = std::min(SPU_NUM_VOICES, PsxVm::gSpu.numVoices);
 
+    // Enabling/disabling reverb for every single voice with the bit mask?
     if (onOff == SPU_BIT) {
-        for (uint32_t voiceIdx = 0; voiceIdx < SPU_NUM_VOICES; ++voiceIdx) {
-            Spu::Voice& voice = spu.pVoices[voiceIdx];
-            voice.bDoReverb = (voiceBits & (SpuVoiceMask(1) << voiceIdx));
+        for (uint32_t voiceIdx = 0; voiceIdx < numVoices; ++voiceIdx) {
+            const SpuVoiceMask voiceBit = SpuVoiceMask(1) << voiceIdx;
+
+            if ((gVoiceReverbBits ^ voiceBits) & voiceBit) {
+                LIBSPU_SubmitCmd(Spu::CmdType::VoiceDoReverb, voiceIdx, ((voiceBits & voiceBit) != 0));
+            }
         }
 
+        gVoiceReverbBits = voiceBits;
         return voiceBits;
     }
 
     // Enable or disable reverb for specific voices and return the reverb status of all voices after
     const bool bEnableReverb = (onOff != SPU_OFF);
-    SpuVoiceMask enabledVoiceBits = 0;
 
-    for (uint32_t voiceIdx = 0; voiceIdx < SPU_NUM_VOICES; ++voiceIdx) {
-        Spu::Voice& voice = spu.pVoices[voiceIdx];
+    for (uint32_t voiceIdx = 0; voiceIdx < numVoices; ++voiceIdx) {
+        const SpuVoiceMask voiceBit = SpuVoiceMask(1) << voiceIdx;
 
-        if (voiceBits & (SpuVoiceMask(1) << voiceIdx)) {
-            voice.bDoReverb = bEnableReverb;
+        if (voiceBits & voiceBit) {
+            LIBSPU_SubmitCmd(Spu::CmdType::VoiceDoReverb, voiceIdx, bEnableReverb);
+            gVoiceReverbBits = (bEnableReverb) ? gVoiceReverbBits | voiceBit : gVoiceReverbBits & (~voiceBit);
         }
-
-        enabledVoiceBits |= (voice.bDoReverb) ? (SpuVoiceMask(1) << voiceIdx) : 0;
     }
 
-    return enabledVoiceBits;
+    return gVoiceReverbBits;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -716,13 +750,20 @@ void LIBSPU_SpuInit() noexcept {
     for (uint32_t voiceIdx = 0; voiceIdx < spu.numVoices; ++voiceIdx) {
         Spu::Voice& voice = spu.pVoices[voiceIdx];
 
-        Spu::keyOff(voice);
+        Spu::keyOff(spu, voiceIdx);
         voice.volume = {};
         voice.sampleRate = 0x00FF;
         voice.adpcmStartAddr8 = 0;
         voice.env = {};
     }
 
+    // PsyDoom: keep the latest requested voice settings tracked by LIBSPU in sync
+    for (Spu::AdsrEnvelope& env : gVoiceEnvs) {
+        env = {};
+    }
+
+    gVoicePendingKeyOnBits = 0;
+
     spu.bUnmute = true;
     LIBSPU_SpuStart();
 
@@ -744,11 +785,9 @@ void LIBSPU_SpuInit() noexcept {
 // Since DOOM does not use SpuMalloc, this can never fail.
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t LIBSPU_SpuSetReverb(const int32_t onOff) noexcept {
+    // PsyDoom: this is now submitted as a command to the SPU, so the SPU doesn't need to be locked
     const bool bEnable = (onOff != SPU_OFF);
-
-    Spu::Core& spu = PsxVm::gSpu;
-    PsxVm::LockSpu spuLock;
-    spu.bReverbWriteEnable = bEnable;
+    LIBSPU_SubmitCmd(Spu::CmdType::ReverbWriteEnable, 0, bEnable);
     return (bEnable) ? SPU_ON : SPU_OFF;
 }
 
@@ -820,6 +859,7 @@ uint32_t LIBSPU_SpuWrite(const void* const pData, const uint32_t size) noexcept
     const uint32_t thisWriteSize = (size <= maxWriteSize) ? size : maxWriteSize;
 
     std::memcpy(spu.pRam + gTransferStartAddr, pData, thisWriteSize);
+    Spu::invalidateAdpcmCache(spu, gTransferStartAddr, thisWriteSize);
     return thisWriteSize;
 }
 
@@ -838,24 +878,27 @@ void LIBSPU_SpuSetKeyOnWithAttr(const SpuVoiceAttr& attribs) noexcept {
 // The on/off action to perform must be either 'SPU_OFF' or 'SPU_ON'
 //------------------------------------------------------------------------------------------------------------------------------------------
 void LIBSPU_SpuSetKey(const int32_t onOff, const SpuVoiceMask voiceBits) noexcept {
-    Spu::Core& spu = PsxVm::gSpu;
-    PsxVm::LockSpu spuLock;
-
-    const uint32_t numVoicesToSet = std::min(SPU_NUM_VOICES, spu.numVoices);
+    // PsyDoom: key on and off are now submitted as commands to the SPU, so the SPU doesn't need to be locked.
+    // Remember the key on commands so that the voices can be reported as 'on' until the commands are executed.
+    const uint32_t numVoicesToSet = std::min(SPU_NUM_VOICES, PsxVm::gSpu.numVoices);
 
     if (onOff == SPU_OFF) {
         for (uint32_t voiceIdx = 0; voiceIdx < numVoicesToSet; ++voiceIdx) {
-            if (voiceBits & (SpuVoiceMask(1) << voiceIdx)) {
-                Spu::Voice& voice = spu.pVoices[voiceIdx];
-                Spu::keyOff(voice);
+            const SpuVoiceMask voiceBit = SpuVoiceMask(1) << voiceIdx;
+
+            if (voiceBits & voiceBit) {
+                LIBSPU_SubmitCmd(Spu::CmdType::VoiceKeyOff, voiceIdx, 0);
+                gVoicePendingKeyOnBits &= ~voiceBit;
             }
         }
     }
     else if (onOff == SPU_ON) {
         for (uint32_t voiceIdx = 0; voiceIdx < numVoicesToSet; ++voiceIdx) {
-            if (voiceBits & (SpuVoiceMask(1) << voiceIdx)) {
-                Spu::Voice& voice = spu.pVoices[voiceIdx];
-                Spu::keyOn(voice);
+            const SpuVoiceMask voiceBit = SpuVoiceMask(1) << voiceIdx;
+
+            if (voiceBits & voiceBit) {
+                gVoiceKeyOnCmdSeqNums[voiceIdx] = LIBSPU_SubmitCmd(Spu::CmdType::VoiceKeyOn, voiceIdx, 0);
+                gVoicePendingKeyOnBits |= voiceBit;
             }
         }
     }
@@ -875,6 +918,18 @@ void LIBSPU_SpuGetAllKeysStatus(uint8_t statuses[SPU_NUM_VOICES]) noexcept {
     const uint32_t numVoicesToGet = std::min(SPU_NUM_VOICES, spu.numVoices);
 
     for (uint32_t voiceIdx = 0; voiceIdx < numVoicesToGet; ++voiceIdx) {
+        // PsyDoom: if the voice has a key on command which has not executed yet then report the voice as being keyed on
+        const SpuVoiceMask voiceBit = SpuVoiceMask(1) << voiceIdx;
+
+        if (gVoicePendingKeyOnBits & voiceBit) {
+            if (PsxVm::isSpuCmdPending(gVoiceKeyOnCmdSeqNums[voiceIdx])) {
+                statuses[voiceIdx] = SPU_ON;
+                continue;
+            }
+
+            gVoicePendingKeyOnBits &= ~voiceBit;
+        }
+
         const Spu::EnvPhase envPhase = spu.pVoices[voiceIdx].envPhase;
 
         switch (envPhase) {
@@ -10,12 +10,16 @@
 #include "Finally.h"
 #include "psxspu.h"
 #include "PsyDoom/ProgArgs.h"
+#include "PsyDoom/PsxVm.h"
 #include "PsyQ/LIBSPU.h"
+#include "Spu.h"
 #include "wessapi.h"
 #include "wessarc.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
+#include <vector>
 
 // Maximum number of sounds that can be in an LCD file
 static constexpr uint32_t MAX_LCD_SOUNDS = 100;
@@ -289,37 +293,93 @@ int32_t wess_dig_lcd_load(
     if (pLcdHeader->numPatchSamples > MAX_LCD_SOUNDS)
         return 0;
 
-    // Set the number of sounds to load globally and which buffer contains the LCD header.
-    // Also initialize other variables used by 'wess_dig_lcd_data_read':
-    gWess_lcd_load_numSounds = pLcdHeader->numPatchSamples;
-    gpWess_lcd_load_headerBuf = gWess_sectorBuffer1;
+    // Read each sound's data from the LCD file into a staging buffer and then copy it into SPU RAM, invalidating any cached ADPCM blocks
+    // for that area. The SPU lock is only held for the copy so that the audio thread is never left waiting on file I/O.
+    // The sounds are stored one after the other in the file and sounds which are skipped (already loaded) are not written to SPU RAM.
+    //
+    // Note: the original code processed the sound data in whole sectors, with the last partial sector padded out with zeros, and only
+    // committed the details for a sound once it moved past the sound's last byte. A sound ending exactly at the end of the last sector
+    // was therefore uploaded but never committed, and this behavior is preserved here.
+    // Note: sound data starts after the LCD header sector, so the byte count is adjusted accordingly.
+    Spu::Core& spu = PsxVm::gSpu;
+    const int32_t lcdDataSize = pLcdFile->size - CDROM_SECTOR_SIZE;
+    const int32_t lcdPaddedDataSize = ((lcdDataSize + CDROM_SECTOR_SIZE - 1) / CDROM_SECTOR_SIZE) * CDROM_SECTOR_SIZE;
+    int32_t lcdDataOffset = 0;
+    int32_t numSpuBytesWritten = 0;
+    std::vector<uint8_t> soundData;
 
-    gWess_lcd_load_soundNum = 0;
-    gWess_lcd_load_samplePos = destSpuAddr;
-    gWess_lcd_load_soundBytesLeft = 0;
+    for (uint32_t soundNum = 0; soundNum < pLcdHeader->numPatchSamples; ++soundNum) {
+        // Added safety: if the sample index is out of range then abort loading the LCD and issue a warning
+        const uint16_t patchSampleIdx = pLcdHeader->patchSampleIndices[soundNum];
 
-    // Seek to the first sound data sector in the file and continue reading sound data until we are done
-    if (psxcd_seek(*pLcdFile, CDROM_SECTOR_SIZE, PsxCd_SeekMode::SET) != 0)
-        return 0;
+        if (patchSampleIdx >= gWess_lcd_load_numPatchSamples) {
+            std::snprintf(gLevelStartupWarning, C_ARRAY_SIZE(gLevelStartupWarning), "W:LCD load error! Bad snd idx!");
+            break;
+        }
 
-    // Read all of the sound data and upload to the SPU using sector buffer 2 as a temporary.
-    // Note: we've already consumed 1 sector from the file, so the byte count left is adjusted accordingly.
-    int32_t lcdBytesLeft = pLcdFile->size - CDROM_SECTOR_SIZE;
-    int32_t numSpuBytesWritten = 0;
+        // Stop if there is no sound data left, otherwise figure out how much of the sound is in the (padded) data and whether to commit it
+        patch_sample& patchSample = gpWess_lcd_load_patchSamples[patchSampleIdx];
+        const int32_t soundSize = (int32_t) patchSample.size;
+        const int32_t lcdPaddedBytesLeft = lcdPaddedDataSize - lcdDataOffset;
+
+        if (lcdPaddedBytesLeft <= 0)
+            break;
+
+        const int32_t uploadSize = std::min(soundSize, lcdPaddedBytesLeft);
+        const bool bCommitSound = (soundSize < lcdPaddedBytesLeft);
+
+        // If the sound was already loaded, and we are not forcing it to be overwritten, then just skip past the sound's data
+        if ((patchSample.spu_addr != 0) && (!bOverride)) {
+            lcdDataOffset += uploadSize;
+
+            if (!bCommitSound)
+                break;
+
+            continue;
+        }
+
+        // If uploading this sound would cause us to go beyond the bounds of SPU RAM then do not try to upload it and stop loading
+        const uint32_t soundSpuAddr = destSpuAddr + numSpuBytesWritten;
 
-    while ((lcdBytesLeft > 0) && (!gbWess_lcd_load_abort)) {
-        // Read this sector from the LCD file and the number of bytes left is smaller then read that amount instead
-        uint8_t* const sectorBuffer = gWess_sectorBuffer2;
-        const int32_t readSize = (lcdBytesLeft < CDROM_SECTOR_SIZE) ? lcdBytesLeft : CDROM_SECTOR_SIZE;
-        psxcd_read(sectorBuffer, readSize, *pLcdFile);
+        if ((soundSpuAddr + soundSize > gPsxSpu_sram_end) || (soundSpuAddr + soundSize > spu.ramSize)) {
+            std::snprintf(gLevelStartupWarning, C_ARRAY_SIZE(gLevelStartupWarning), "W:not enough sound RAM!");
+            break;
+        }
+
+        // Read the sound into the staging buffer, zero filling any part which is in the padding past the end of the file
+        const int32_t readSize = std::clamp(lcdDataSize - lcdDataOffset, 0, uploadSize);
+        soundData.resize((size_t) uploadSize);
+
+        if (psxcd_seek(*pLcdFile, CDROM_SECTOR_SIZE + lcdDataOffset, PsxCd_SeekMode::SET) != 0)
+            break;
+
+        if (psxcd_read(soundData.data(), readSize, *pLcdFile) != readSize)
+            break;
 
-        if (readSize < CDROM_SECTOR_SIZE) {
-            // When we are not filling part of the buffer then zero it out just for consistency
-            std::memset(sectorBuffer + readSize, 0, (size_t) CDROM_SECTOR_SIZE - readSize);
+        std::memset(soundData.data() + readSize, 0, (size_t) uploadSize - readSize);
+
+        // Copy the sound into SPU RAM and invalidate any cached ADPCM blocks for that area
+        {
+            PsxVm::LockSpu spuLock;
+            std::memcpy(spu.pRam + soundSpuAddr, soundData.data(), (size_t) uploadSize);
+            Spu::invalidateAdpcmCache(spu, soundSpuAddr, uploadSize);
         }
 
-        numSpuBytesWritten += wess_dig_lcd_data_read(sectorBuffer, destSpuAddr + numSpuBytesWritten, pSampleBlock, bOverride);
-        lcdBytesLeft -= readSize;
+        lcdDataOffset += uploadSize;
+        numSpuBytesWritten += uploadSize;
+
+        // Save the details of the sound, including to the sample block (if given)
+        if (!bCommitSound)
+            break;
+
+        patchSample.spu_addr = soundSpuAddr;
+
+        if (pSampleBlock) {
+            ASSERT(pSampleBlock->num_samples < SAMPLE_BLOCK_SIZE);
+            pSampleBlock->patch_sample_idx[pSampleBlock->num_samples] = patchSampleIdx;
+            pSampleBlock->sample_spu_addr_8[pSampleBlock->num_samples] = (uint16_t)(patchSample.spu_addr / 8);
+            pSampleBlock->num_samples++;
+        }
     }
 
     return numSpuBytesWritten;
@@ -10,6 +10,7 @@
 #include "Asserts.h"
 #include "FatalErrors.h"
 #include "psxspu.h"
+#include "PsyDoom/Config/Config.h"
 #include "PsyDoom/DiscInfo.h"
 #include "PsyDoom/DiscReader.h"
 #include "PsyDoom/ModMgr.h"
@@ -18,8 +19,14 @@
 #include "PsyDoom/Utils.h"
 #include "Spu.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstring>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 // PsyDoom: raise the open file limit
 #if PSYDOOM_MODS
@@ -28,32 +35,54 @@
     static constexpr int32_t MAX_OPEN_FILES = 4;    // Maximum number of open files
 #endif
 
-static constexpr int32_t FADE_TIME_MS       = 250;      // Time it takes to fade out CD audio (milliseconds)
-static constexpr int32_t CDDA_SECTOR_SIZE   = 2352;     // Size of of a CD digital audio sector
+static constexpr int32_t FADE_TIME_MS           = 250;                                  // Time it takes to fade out CD audio (milliseconds)
+static constexpr int32_t CDDA_SECTOR_SIZE       = 2352;                                 // Size of of a CD digital audio sector
+static constexpr int32_t CDDA_SECTOR_SAMPLES    = CDDA_SECTOR_SIZE / sizeof(int16_t);   // Number of 16-bit samples in a CD digital audio sector
+static constexpr int32_t CDDA_STREAM_SECTORS    = 256;                                  // How many sectors of CD audio to read ahead (~3.4 seconds worth)
+static constexpr int32_t CDDA_STREAM_BATCH_SIZE = 16;                                   // Maximum number of sectors read by the streaming thread in one go
+static constexpr int32_t CDDA_CACHE_BATCH_SIZE  = 64;                                   // Maximum number of sectors read into the track cache in one go
+static constexpr int32_t DEFAULT_MAX_CACHED_CD_TRACK_SIZE = 64 * 1024 * 1024;           // Default limit on the size of a CD audio track that can be cached in memory
+
+static_assert(CDDA_SECTOR_SAMPLES % 2 == 0);
 
 // If true then the 'psxcd' module has been initialized
 static bool gbPSXCD_IsCdInit;
 
-// Used to hold a file temporarily after opening
-static PsxCd_File gPSXCD_cdfile;
+// Used to hold a file temporarily after opening.
+// PsyDoom: this is now per thread and opening or closing files is guarded by a mutex, so that files can be opened from multiple threads.
+// Reads and seeks are not guarded since each open file has it's own disc reader (or overriden file handle) which is not shared.
+static thread_local PsxCd_File  gPSXCD_cdfile;
+static std::mutex               gPSXCD_openFilesMutex;
 
 // CD audio playback related state.
-// Access to all of this is controlled by the CD player mutex.
+// Access to all of this is controlled by the CD player mutex. CD audio is read from the disc by a dedicated streaming thread, which reads
+// sectors ahead of playback into the stream ring buffer. The SPU audio callback (the consumer) only ever copies audio out of the ring buffer
+// and never takes the CD player lock, so it never has to wait on disc I/O.
 static struct {
     DiscReader  discReader          = { PsxVm::gDiscInfo };     // The disc reader used to stream the audio
-    bool        bPlay               = false;                    // If 'false' then playback is either paused or stopped (stopped if the disc reader doesn't have a track)
+    bool        bStream             = false;                    // If 'true' then the streaming thread should read audio into the ring buffer
     bool        bLoop               = false;                    // If 'true' then playback is looped upon reaching the end
-    int32_t     bufferOffset        = 0;                        // Where we are in the audio buffer
+    bool        bReadFromCache      = false;                    // If 'true' then audio is being read from the track cache rather than the disc
+    int32_t     cacheOffset         = 0;                        // Where we are in the track cache when reading from it
     int32_t     loopTrack           = 0;                        // The track to play when looping
     int32_t     loopSectorOffset    = 0;                        // Offset (in sectors) to start at in the track when looping
-
-    // The CD audio buffer: we read CD audio in chunks
-    int16_t buffer[CDDA_SECTOR_SIZE / sizeof(int16_t)];
+    uint32_t    generation          = 0;                        // Incremented every time playback starts or stops: used to identify stale audio in the ring buffer
 } gCdPlayer;
 
+// A cache holding an entire CD audio track in memory, so that looping music can be played from memory rather than re-read from the disc.
+// The track to loop is read into the cache in the background by the streaming thread, while the track is first playing.
+// Access to all of this is controlled by the CD player mutex.
+static struct {
+    DiscReader              discReader  = { PsxVm::gDiscInfo };     // Disc reader used to fill the cache, separate to the one for streaming so as not to disturb it
+    int32_t                 trackNum    = -1;                       // Which track is cached, or is being cached; '-1' if none
+    int32_t                 numBytesRead = 0;                       // How much of the track has been read into the cache so far
+    bool                    bComplete   = false;                    // If 'true' then the entire track has been read into the cache
+    bool                    bFailed     = false;                    // If 'true' then reading the track failed and caching was abandoned
+    std::vector<std::byte>  data;                                   // The audio data for the track
+} gCdTrackCache;
+
 // The lock for the CD player and a helper to lock/unlock via RAII.
 // N.B: this *CANNOT* be held the same time as the SPU lock, otherwise deadlock MIGHT occur!
-// The SPU can request audio from the CD and thus needs access to the cd player lock also.
 static std::recursive_mutex gCdPlayerMutex;
 
 struct LockCdPlayer {
@@ -61,6 +90,34 @@ struct LockCdPlayer {
     ~LockCdPlayer() noexcept { gCdPlayerMutex.unlock(); }
 };
 
+// A sector of CD audio in the stream ring buffer
+struct CdStreamSector {
+    uint32_t    generation;                         // Value of the CD player 'generation' when this sector was read: if it doesn't match the current value the sector is stale
+    int32_t     trackNum;                           // Which track the sector was read from
+    int32_t     trackSectorsElapsed;                // How many sectors of the track will have elapsed once this sector starts playing
+    bool        bEndOfTrack;                        // If set then this is not audio but a marker saying that a non-looping track has ended
+    int16_t     samples[CDDA_SECTOR_SAMPLES];       // The audio for the sector (16-bit stereo)
+};
+
+// The stream ring buffer: a lock free single producer (streaming thread) and single consumer (SPU audio callback) queue.
+// The read and write indexes increase forever and wrap around the buffer. The producer only writes to the sector at the write index once
+// there is space for it, and the consumer only reads sectors between the read index and the write index.
+static CdStreamSector           gCdStreamSectors[CDDA_STREAM_SECTORS];
+static std::atomic<uint32_t>    gCdStreamReadIdx;
+static std::atomic<uint32_t>    gCdStreamWriteIdx;
+static int32_t                  gCdStreamSampleIdx;                 // Consumer only: next sample to return from the sector at the read index
+
+// State shared with the consumer which is read/written without the CD player lock:
+//  Play state:     current CD player 'generation' (high 32-bits) and whether playback is active (bit 0).
+//  Play position:  'generation' the position is for (high 32-bits), playing track number (8-bits, 0xFF if none) and elapsed sectors (low 24-bits).
+static std::atomic<uint64_t>    gCdPlayState;
+static std::atomic<uint64_t>    gCdPlayPos = { 0xFF000000 };
+
+// The streaming thread and the means to wake it up (when playback starts) or tell it to quit
+static std::thread                  gCdStreamThread;
+static std::condition_variable_any  gCdStreamWakeCV;
+static bool                         gbCdStreamThreadQuit;
+
 // Disc readers used for each open file
 static DiscReader gFileDiscReaders[MAX_OPEN_FILES] = {
     PsxVm::gDiscInfo, PsxVm::gDiscInfo, PsxVm::gDiscInfo, PsxVm::gDiscInfo,
@@ -70,77 +127,298 @@ static DiscReader gFileDiscReaders[MAX_OPEN_FILES] = {
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// A callback invoked by the SPU when it wants audio from the CD player - returns a single sample.
+// Helpers for making up and breaking down the packed play state and position values shared with the SPU audio callback
 //------------------------------------------------------------------------------------------------------------------------------------------
-static Spu::StereoSample SpuAudioCallback([[maybe_unused]] void* pUserData) noexcept {
-    // Lock the CD player while we are doing this.
-    // Note that this thread also has the SPU lock at this point too.
-    // Therefore the main thread must NOT lock both the CD player and the SPU at the same time, or otherwise a deadlock might occur.
-    LockCdPlayer cdPlayerLock;
+static uint64_t makeCdPlayState(const uint32_t generation, const bool bPlay) noexcept {
+    return ((uint64_t) generation << 32) | (bPlay ? 1u : 0u);
+}
 
-    // If the CD player is not currently active then return silence
-    if ((!gCdPlayer.bPlay) || (!gCdPlayer.discReader.isTrackOpen()))
-        return Spu::StereoSample{};
+static uint64_t makeCdPlayPos(const uint32_t generation, const int32_t trackNum, const int32_t sectorsElapsed) noexcept {
+    const uint32_t trackBits = ((trackNum >= 0) && (trackNum < 0xFF)) ? (uint32_t) trackNum : 0xFFu;
+    return ((uint64_t) generation << 32) | (trackBits << 24) | ((uint32_t) sectorsElapsed & 0x00FFFFFFu);
+}
+
+static bool isCdPlayStateActive(const uint64_t playState) noexcept {
+    return (playState & 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Streaming thread helper: gets the track being read from, its size and the current read offset within it.
+// This is either for the disc or for the track cache, depending on which is being read from. The CD player lock must be held.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void CdStream_GetReadPos(int32_t& trackNum, int32_t& trackSize, int32_t& trackOffset) noexcept {
+    if (gCdPlayer.bReadFromCache) {
+        trackNum = gCdTrackCache.trackNum;
+        trackSize = (int32_t) gCdTrackCache.data.size();
+        trackOffset = gCdPlayer.cacheOffset;
+    } else {
+        const DiscTrack* const pTrack = gCdPlayer.discReader.getOpenTrack();
+        trackNum = pTrack->trackNum;
+        trackSize = pTrack->trackPayloadSize;
+        trackOffset = gCdPlayer.discReader.tell();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Streaming thread helper: if a looping track is playing then reads the next part of the track to loop into the track cache.
+// Does nothing if the track is already cached, or if it is too big to cache. The CD player lock must be held when calling this.
+// Returns 'true' if any data was read.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool CdStream_FillTrackCache() noexcept {
+    if ((!gCdPlayer.bStream) || (!gCdPlayer.bLoop))
+        return false;
+
+    // Start caching the loop track if it isn't the track currently cached. Make sure it is a valid track and not too big first.
+    const int32_t trackNum = gCdPlayer.loopTrack;
+
+    if (gCdTrackCache.trackNum != trackNum) {
+        const int32_t maxTrackSize = (Config::gMaxCachedCdTrackSize < 0) ? DEFAULT_MAX_CACHED_CD_TRACK_SIZE : Config::gMaxCachedCdTrackSize;
+        const DiscTrack* const pTrack = PsxVm::gDiscInfo.getTrack(trackNum);
+
+        if ((!pTrack) || (pTrack->trackPayloadSize <= 0) || (pTrack->trackPayloadSize > maxTrackSize))
+            return false;
 
-    // Check if we have any data left in the buffer firstly
-    constexpr int16_t SAMPLE_SIZE = sizeof(int16_t);
-    constexpr int32_t NUM_BUFFER_SAMPLES = sizeof(gCdPlayer.buffer) / SAMPLE_SIZE;
-    static_assert(NUM_BUFFER_SAMPLES % 2 == 0);
+        // Don't discard the cached track if it is being played from
+        if (gCdPlayer.bReadFromCache)
+            return false;
 
+        gCdTrackCache.trackNum = trackNum;
+        gCdTrackCache.numBytesRead = 0;
+        gCdTrackCache.bComplete = false;
+        gCdTrackCache.bFailed = !gCdTrackCache.discReader.setTrackNum(trackNum);
+        gCdTrackCache.data.clear();
+        gCdTrackCache.data.shrink_to_fit();
+
+        if (!gCdTrackCache.bFailed) {
+            gCdTrackCache.data.resize((size_t) pTrack->trackPayloadSize);
+        }
+    }
+
+    if (gCdTrackCache.bComplete || gCdTrackCache.bFailed)
+        return false;
+
+    // Read the next chunk of the track
+    const int32_t trackSize = (int32_t) gCdTrackCache.data.size();
+    const int32_t bytesToRead = std::min(trackSize - gCdTrackCache.numBytesRead, CDDA_CACHE_BATCH_SIZE * CDDA_SECTOR_SIZE);
+    DiscReader& disc = gCdTrackCache.discReader;
+
+    if ((!disc.trackSeekAbs(gCdTrackCache.numBytesRead)) || (!disc.read(gCdTrackCache.data.data() + gCdTrackCache.numBytesRead, bytesToRead))) {
+        gCdTrackCache.bFailed = true;
+        gCdTrackCache.data.clear();
+        gCdTrackCache.data.shrink_to_fit();
+        disc.closeTrack();
+        return false;
+    }
+
+    gCdTrackCache.numBytesRead += bytesToRead;
+
+    if (gCdTrackCache.numBytesRead >= trackSize) {
+        gCdTrackCache.bComplete = true;
+        disc.closeTrack();
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Streaming thread helper: reads the next batch of CD audio sectors into the stream ring buffer, if there is space.
+// The CD player lock must be held when calling this. Returns the number of sectors read.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int32_t CdStream_ReadSectors() noexcept {
     DiscReader& disc = gCdPlayer.discReader;
+    int32_t numSectorsRead = 0;
+
+    while ((numSectorsRead < CDDA_STREAM_BATCH_SIZE) && gCdPlayer.bStream && disc.isTrackOpen()) {
+        // Stop if the ring buffer is full
+        const uint32_t writeIdx = gCdStreamWriteIdx.load(std::memory_order_relaxed);
+
+        if (writeIdx - gCdStreamReadIdx.load(std::memory_order_acquire) >= (uint32_t) CDDA_STREAM_SECTORS)
+            break;
+
+        CdStreamSector& sector = gCdStreamSectors[writeIdx % CDDA_STREAM_SECTORS];
+        sector.generation = gCdPlayer.generation;
+        sector.bEndOfTrack = false;
 
-    if (gCdPlayer.bufferOffset + 1 >= NUM_BUFFER_SAMPLES) {
         // Get the size of the track and where we are at in it
-        const DiscTrack* pTrack = disc.getOpenTrack();
-        int32_t trackSize = pTrack->trackPayloadSize;
-        int32_t trackOffset = disc.tell();
+        int32_t trackNum, trackSize, trackOffset;
+        CdStream_GetReadPos(trackNum, trackSize, trackOffset);
 
         // See if there is any data left in the track to read
         if (trackOffset >= trackSize) {
             // We reached the end, do we loop back around again?
             if (gCdPlayer.bLoop) {
                 // Looping: rewind back to the start plus any additional offset.
-                // Change tracks also if we need to.
-                if (disc.getTrackNum() != gCdPlayer.loopTrack) {
-                    disc.setTrackNum(gCdPlayer.loopTrack);
-
-                    // Need to re-fetch this info when changing tracks
-                    pTrack = disc.getOpenTrack();
-                    trackSize = pTrack->trackPayloadSize;
-                }
+                // Play from the track cache if the entire loop track is cached, otherwise read from the disc and change tracks if we need to.
+                const int32_t loopOffset = (gCdPlayer.loopSectorOffset > 0) ? CDDA_SECTOR_SIZE * gCdPlayer.loopSectorOffset : 0;
 
-                if (gCdPlayer.loopSectorOffset > 0) {
-                    disc.trackSeekAbs(CDDA_SECTOR_SIZE * gCdPlayer.loopSectorOffset);
+                if (gCdTrackCache.bComplete && (gCdTrackCache.trackNum == gCdPlayer.loopTrack)) {
+                    gCdPlayer.bReadFromCache = true;
+                    gCdPlayer.cacheOffset = std::min<int32_t>(loopOffset, (int32_t) gCdTrackCache.data.size());
                 } else {
-                    disc.trackSeekAbs(0);
+                    gCdPlayer.bReadFromCache = false;
+
+                    if (disc.getTrackNum() != gCdPlayer.loopTrack) {
+                        if (!disc.setTrackNum(gCdPlayer.loopTrack)) {
+                            gCdPlayer.bStream = false;
+                            break;
+                        }
+                    }
+
+                    disc.trackSeekAbs(loopOffset);
                 }
 
-                trackOffset = disc.tell();
+                CdStream_GetReadPos(trackNum, trackSize, trackOffset);
             }
             else {
-                // No looping, mark the CD player as no longer playing and return an empty sample
-                gCdPlayer.bPlay = false;
-                return Spu::StereoSample{};
+                // No looping: queue up a marker telling the consumer that playback ends here and stop streaming
+                sector.trackNum = trackNum;
+                sector.trackSectorsElapsed = trackOffset / CDDA_SECTOR_SIZE;
+                sector.bEndOfTrack = true;
+                gCdStreamWriteIdx.store(writeIdx + 1, std::memory_order_release);
+                gCdPlayer.bStream = false;
+                break;
             }
         }
 
         // Read what we can and zero anything we can't (in case the last sector is short for some reason)
-        const int32_t samplesToRead = std::min<int32_t>((trackSize - trackOffset) / SAMPLE_SIZE, NUM_BUFFER_SAMPLES);
-        const int32_t samplesToZero = NUM_BUFFER_SAMPLES - samplesToRead;
-        disc.read(gCdPlayer.buffer, samplesToRead * SAMPLE_SIZE);
+        const int32_t samplesToRead = std::clamp<int32_t>((trackSize - trackOffset) / (int32_t) sizeof(int16_t), 0, CDDA_SECTOR_SAMPLES);
+        const int32_t samplesToZero = CDDA_SECTOR_SAMPLES - samplesToRead;
+        const int32_t bytesToRead = samplesToRead * (int32_t) sizeof(int16_t);
+
+        if (gCdPlayer.bReadFromCache) {
+            std::memcpy(sector.samples, gCdTrackCache.data.data() + gCdPlayer.cacheOffset, (size_t) bytesToRead);
+            gCdPlayer.cacheOffset += bytesToRead;
+        } else {
+            disc.read(sector.samples, bytesToRead);
+        }
 
         if (samplesToZero > 0) {
-            std::memset(gCdPlayer.buffer + samplesToRead * SAMPLE_SIZE, 0, (size_t) samplesToZero * SAMPLE_SIZE);
+            std::memset(sector.samples + samplesToRead, 0, (size_t) samplesToZero * sizeof(int16_t));
         }
 
-        gCdPlayer.bufferOffset = 0;
+        sector.trackNum = trackNum;
+        sector.trackSectorsElapsed = (trackOffset + bytesToRead) / CDDA_SECTOR_SIZE;
+
+        // Make the sector available to the consumer
+        gCdStreamWriteIdx.store(writeIdx + 1, std::memory_order_release);
+        numSectorsRead++;
     }
 
-    // Should have samples in the buffer at this point, return the requested samples
-    ASSERT(gCdPlayer.bufferOffset + 2 <= NUM_BUFFER_SAMPLES);
+    return numSectorsRead;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Main loop for the CD audio streaming thread: keeps the stream ring buffer topped up while CD audio is being streamed.
+// The CD player lock is only held while reading from the disc, and released between batches so the main thread is not held up for long.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void CdStream_ThreadMain() noexcept {
+    std::unique_lock<std::recursive_mutex> lock(gCdPlayerMutex);
+
+    while (!gbCdStreamThreadQuit) {
+        // Keeping the ring buffer topped up takes priority over filling the track cache
+        const bool bDidWork = (CdStream_ReadSectors() > 0) || CdStream_FillTrackCache();
+
+        if (bDidWork) {
+            lock.unlock();
+            std::this_thread::yield();
+            lock.lock();
+        } else {
+            // Nothing to do or the buffer is full: wait until woken, or for a short while which is tiny compared to the audio buffered
+            gCdStreamWakeCV.wait_for(lock, std::chrono::milliseconds(10));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Starts and stops the CD audio streaming thread
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void CdStream_StartThread() noexcept {
+    if (gCdStreamThread.joinable())
+        return;
+
+    gbCdStreamThreadQuit = false;
+    gCdStreamThread = std::thread(CdStream_ThreadMain);
+}
+
+static void CdStream_StopThread() noexcept {
+    if (!gCdStreamThread.joinable())
+        return;
+
+    {
+        LockCdPlayer cdPlayerLock;
+        gbCdStreamThreadQuit = true;
+    }
+
+    gCdStreamWakeCV.notify_all();
+    gCdStreamThread.join();
+}
+
+// Makes sure the streaming thread is stopped on exit, even if 'psxcd_exit' is not called (e.g on a fatal error)
+static struct CdStreamThreadStopper {
+    ~CdStreamThreadStopper() noexcept { CdStream_StopThread(); }
+} gCdStreamThreadStopper;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Consumer helper: updates the play position shared with the main thread, provided it is still for the current playback 'generation'
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void CdStream_UpdatePlayPos(const CdStreamSector& sector) noexcept {
+    uint64_t playPos = gCdPlayPos.load(std::memory_order_relaxed);
+
+    if ((uint32_t)(playPos >> 32) == sector.generation) {
+        gCdPlayPos.compare_exchange_strong(playPos, makeCdPlayPos(sector.generation, sector.trackNum, sector.trackSectorsElapsed));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A callback invoked by the SPU when it wants audio from the CD player - returns a single sample.
+// Note: this only reads audio that has been buffered by the streaming thread - it never does any disc I/O or takes the CD player lock.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static Spu::StereoSample SpuAudioCallback([[maybe_unused]] void* pUserData) noexcept {
+    // Get the current play state and skip past any stale sectors from previous playback, even if paused.
+    // Skipping while paused means stale audio is cleared out of the ring buffer before playback starts.
+    uint64_t playState = gCdPlayState.load(std::memory_order_acquire);
+    const uint32_t generation = (uint32_t)(playState >> 32);
+
+    uint32_t readIdx = gCdStreamReadIdx.load(std::memory_order_relaxed);
+    const uint32_t writeIdx = gCdStreamWriteIdx.load(std::memory_order_acquire);
+
+    if ((readIdx != writeIdx) && (gCdStreamSectors[readIdx % CDDA_STREAM_SECTORS].generation != generation)) {
+        do {
+            ++readIdx;
+        } while ((readIdx != writeIdx) && (gCdStreamSectors[readIdx % CDDA_STREAM_SECTORS].generation != generation));
+
+        gCdStreamSampleIdx = 0;
+        gCdStreamReadIdx.store(readIdx, std::memory_order_release);
+    }
+
+    // If the CD player is not currently active or there is no audio buffered then return silence
+    if ((!isCdPlayStateActive(playState)) || (readIdx == writeIdx))
+        return Spu::StereoSample{};
+
+    // Reached the end of a non-looping track? If so then stop playback.
+    // Note: the end marker is deliberately not consumed, so if playback is restarted it will immediately stop again.
+    const CdStreamSector& sector = gCdStreamSectors[readIdx % CDDA_STREAM_SECTORS];
+
+    if (sector.bEndOfTrack) {
+        gCdPlayState.compare_exchange_strong(playState, makeCdPlayState(generation, false));
+        return Spu::StereoSample{};
+    }
+
+    // Update the play position when starting a new sector, then return the requested samples
+    if (gCdStreamSampleIdx == 0) {
+        CdStream_UpdatePlayPos(sector);
+    }
+
+    ASSERT(gCdStreamSampleIdx + 2 <= CDDA_SECTOR_SAMPLES);
+    const Spu::StereoSample sample = { sector.samples[gCdStreamSampleIdx], sector.samples[gCdStreamSampleIdx + 1] };
+    gCdStreamSampleIdx += 2;
+
+    // Move onto the next sector if this one is done
+    if (gCdStreamSampleIdx >= CDDA_SECTOR_SAMPLES) {
+        gCdStreamSampleIdx = 0;
+        gCdStreamReadIdx.store(readIdx + 1, std::memory_order_release);
+    }
 
-    Spu::StereoSample sample = { gCdPlayer.buffer[gCdPlayer.bufferOffset], gCdPlayer.buffer[gCdPlayer.bufferOffset + 1] };
-    gCdPlayer.bufferOffset += 2;
     return sample;
 }
 
@@ -162,6 +440,11 @@ void psxcd_init() noexcept {
         PsxVm::gSpu.pExtInputCallback = SpuAudioCallback;
         PsxVm::gSpu.pExtInputUserData = nullptr;
     }
+
+    // Start up the thread which streams CD audio from the disc (not needed in headless mode, since CD audio playback is ignored)
+    if (!ProgArgs::gbHeadlessMode) {
+        CdStream_StartThread();
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -174,14 +457,18 @@ void psxcd_exit() noexcept {
         PsxVm::gSpu.pExtInputCallback = nullptr;
         PsxVm::gSpu.pExtInputUserData = nullptr;
     }
+
+    CdStream_StopThread();
+    gbPSXCD_IsCdInit = false;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Open a specified CD file for reading
 //------------------------------------------------------------------------------------------------------------------------------------------
 PsxCd_File* psxcd_open(const CdFileId discFile) noexcept {
-    // Zero init the temporary file structure
+    // Zero init the temporary file structure and lock access to the list of open files
     gPSXCD_cdfile = {};
+    std::lock_guard<std::mutex> openFilesLock(gPSXCD_openFilesMutex);
 
     // Modding mechanism: allow files to be overridden with user files in a specified directory.
     // Note that we do this check BEFORE validating if the file exists on-disc because PsyDoom now allows Doom format maps (.WAD)
@@ -324,6 +611,8 @@ int32_t psxcd_tell(const PsxCd_File& file) noexcept {
 // Close a CD file and free up the file slot
 //------------------------------------------------------------------------------------------------------------------------------------------
 void psxcd_close([[maybe_unused]] PsxCd_File& file) noexcept {
+    std::lock_guard<std::mutex> openFilesLock(gPSXCD_openFilesMutex);
+
     // Modding mechanism: allow files to be overriden with user files in a specified directory
     if (ModMgr::isFileOverriden(file)) {
         ModMgr::closeOverridenFile(file);
@@ -361,7 +650,8 @@ static void psxcd_play_internal(
     {
         // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
         LockCdPlayer cdPlayerLock;
-        gCdPlayer.bPlay = false;
+        gCdPlayer.bStream = false;
+        gCdPlayState.store(makeCdPlayState(gCdPlayer.generation, false), std::memory_order_release);
         setTrackOk = gCdPlayer.discReader.setTrackNum(track);
     }
 
@@ -390,13 +680,21 @@ static void psxcd_play_internal(
             gCdPlayer.discReader.trackSeekAbs(CDDA_SECTOR_SIZE * sectorOffset);
         }
 
-        // Mark the player as playing and save loop parameters
-        gCdPlayer.bPlay = true;
-        gCdPlayer.bufferOffset = CDDA_SECTOR_SIZE / sizeof(int16_t);    // Need to read a sector
+        // Save loop parameters and start streaming: this is a new 'generation' of playback, so any previously buffered audio is now stale
+        gCdPlayer.bStream = true;
+        gCdPlayer.bReadFromCache = false;
         gCdPlayer.bLoop = bLoop;
         gCdPlayer.loopTrack = loopTrack;
         gCdPlayer.loopSectorOffset = loopSectorOffset;
+        gCdPlayer.generation++;
+
+        // Mark the player as playing
+        const int32_t sectorsElapsed = gCdPlayer.discReader.tell() / CDDA_SECTOR_SIZE;
+        gCdPlayPos.store(makeCdPlayPos(gCdPlayer.generation, track, sectorsElapsed), std::memory_order_release);
+        gCdPlayState.store(makeCdPlayState(gCdPlayer.generation, true), std::memory_order_release);
     }
+
+    gCdStreamWakeCV.notify_all();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -456,7 +754,7 @@ void psxcd_stop() noexcept {
     {
         // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
         LockCdPlayer cdPlayerLock;
-        bMightNeedFade = (gCdPlayer.discReader.isTrackOpen() && gCdPlayer.bPlay);
+        bMightNeedFade = (gCdPlayer.discReader.isTrackOpen() && isCdPlayStateActive(gCdPlayState.load()));
     }
 
     if (bMightNeedFade) {
@@ -474,10 +772,14 @@ void psxcd_stop() noexcept {
         LockCdPlayer cdPlayerLock;
 
         gCdPlayer.discReader.closeTrack();
-        gCdPlayer.bPlay = false;
+        gCdPlayer.bStream = false;
+        gCdPlayer.bReadFromCache = false;
         gCdPlayer.bLoop = false;
-        gCdPlayer.bufferOffset = 0;
         gCdPlayer.loopSectorOffset = 0;
+        gCdPlayer.generation++;
+
+        gCdPlayPos.store(makeCdPlayPos(gCdPlayer.generation, -1, 0), std::memory_order_release);
+        gCdPlayState.store(makeCdPlayState(gCdPlayer.generation, false), std::memory_order_release);
     }
 }
 
@@ -491,7 +793,7 @@ void psxcd_pause() noexcept {
     {
         // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
         LockCdPlayer cdPlayerLock;
-        bMightNeedFade = (gCdPlayer.discReader.isTrackOpen() && gCdPlayer.bPlay);
+        bMightNeedFade = (gCdPlayer.discReader.isTrackOpen() && isCdPlayStateActive(gCdPlayState.load()));
     }
 
     if (bMightNeedFade) {
@@ -503,11 +805,11 @@ void psxcd_pause() noexcept {
         }
     }
 
-    // Mark as no longer playing
+    // Mark as no longer playing: note that the streaming thread continues to read ahead while paused
     {
         // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
         LockCdPlayer cdPlayerLock;
-        gCdPlayer.bPlay = false;
+        gCdPlayState.fetch_and(~(uint64_t) 1);
     }
 }
 
@@ -524,7 +826,7 @@ void psxcd_restart(const int32_t vol) noexcept {
             return;
 
         // Begin playing again
-        gCdPlayer.bPlay = true;
+        gCdPlayState.fetch_or(1);
     }
 
     // Set the audio volume
@@ -535,15 +837,18 @@ void psxcd_restart(const int32_t vol) noexcept {
 // Tells how many sectors have elapsed during cd playback
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t psxcd_elapsed_sectors() noexcept {
-    // N.B: don't hold this lock in the main thread at the same time as the SPU lock - otherwise deadlock might occur!
-    LockCdPlayer cdPlayerLock;
-    return (gCdPlayer.discReader.isTrackOpen()) ? gCdPlayer.discReader.tell() / CDDA_SECTOR_SIZE : 0;
+    // Note: this is the position of what is being played rather than what has been read from the disc, which is further ahead
+    const uint64_t playPos = gCdPlayPos.load(std::memory_order_acquire);
+    return (int32_t)(playPos & 0x00FFFFFF);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Get the size of a file
+// Get the size of a file.
+// PsyDoom: this takes the same lock as opening files, since the size of an overriden file is cached by both operations.
 //------------------------------------------------------------------------------------------------------------------------------------------
 int32_t psxcd_get_file_size(const CdFileId discFile) noexcept {
+    std::lock_guard<std::mutex> openFilesLock(gPSXCD_openFilesMutex);
+
     // Modding mechanism: allow files to be overriden with user files in a specified directory
     if (ModMgr::areOverridesAvailableForFile(discFile))
         return ModMgr::getOverridenFileSize(discFile);
@@ -552,7 +857,7 @@ int32_t psxcd_get_file_size(const CdFileId discFile) noexcept {
 }
 
 int32_t psxcd_get_playing_track() noexcept {
-    LockCdPlayer cdPlayerLock;
-    const DiscTrack* const pTrack = gCdPlayer.discReader.getOpenTrack();
-    return (pTrack) ? pTrack->trackNum : -1;
+    const uint64_t playPos = gCdPlayPos.load(std::memory_order_acquire);
+    const uint32_t trackBits = (uint32_t)(playPos >> 24) & 0xFFu;
+    return (trackBits != 0xFFu) ? (int32_t) trackBits : -1;
 }
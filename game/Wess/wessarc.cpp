@@ -95,7 +95,7 @@ int32_t WessInterruptHandler() noexcept {
 
     // Execute the sequencer engine if it is enabled.
     //
-    // PsyDoom: this is now invoked by 'Utils::doPlatformUpdates' as frequently as possible and with a variable delta time.
+    // PsyDoom: this is now invoked by 'Utils::doPlatformUpdates' on a 1 KHz clock and with a variable delta time.
     // This helps keep the music timing as stable as possible.
     #if !PSYDOOM_MODS
         if (gbWess_SeqOn) {
@@ -5,6 +5,7 @@
 #include "wessseq.h"
 
 #include "Macros.h"
+#include "PsyDoom/PsxVm.h"
 #include "wessapi.h"
 
 #include <algorithm>
@@ -107,6 +108,9 @@ static uint8_t                      gWess_eng_maxActiveTracks;      // The maxim
 #if PSYDOOM_MODS    
     typedef std::chrono::high_resolution_clock::time_point timepoint_t;     // Because typing this is a pain...
     static timepoint_t gLastSequencerUpdateTime = {};                       // When we last updated the sequencer
+    static uint32_t gLastSequencerUpdateSampleNum = {};                     // The SPU sample clock when we last updated the sequencer
+
+    static constexpr double SPU_SAMPLE_RATE = 44100.0;                      // Sample rate of the SPU sample clock
 #endif
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -818,11 +822,37 @@ void SeqEngine() noexcept {
     // PsyDoom: this can now be invoked at any time rather than at fixed 120 Hz intervals, so the delta time which can pass is variable.
     // Restrict the maximum number of time that can be simulated however to 0.5 seconds.
     // Compute the fractional number of 120Hz ticks/interrupts elapsed here:
+    //
+    // If sample accurate timing is enabled then time is measured using the SPU sample clock (samples generated by the audio thread)
+    // rather than the system clock, and hardware driver commands are scheduled to execute at the exact sample they were due at.
     #if PSYDOOM_MODS
+        const bool bSampleAccurate = PsxVm::isSpuSampleClockEnabled();
         const timepoint_t now = std::chrono::high_resolution_clock::now();
-        const double deltaTime = std::clamp(std::chrono::duration<double>(now - gLastSequencerUpdateTime).count(), 0.0, 0.5);
+        const uint32_t sampleClock = PsxVm::getSpuSampleClock();
+
+        const double rawDeltaTime = (bSampleAccurate) ?
+            (double)(sampleClock - gLastSequencerUpdateSampleNum) / SPU_SAMPLE_RATE :
+            std::chrono::duration<double>(now - gLastSequencerUpdateTime).count();
+
+        const double deltaTime = std::clamp(rawDeltaTime, 0.0, 0.5);
         const double deltaTime120HzTicks = std::min(deltaTime * 120.0, 8.0);
         gLastSequencerUpdateTime = now;
+        gLastSequencerUpdateSampleNum = sampleClock;
+
+        // Schedules hardware driver commands for the given track to execute at the sample they became due at (if sample accurate).
+        // Works out how long ago the command was due from how far the track's time marker has gone past it.
+        // Returns 'true' if the command is timed, in which case 'PsxVm::endTimedSpuCmds' must be called after executing it.
+        const auto scheduleDriverCmd = [=](const track_status& trackStat) noexcept {
+            if ((!bSampleAccurate) || (trackStat.tempo_ppi_frac == 0))
+                return false;
+
+            const double qnpPastDue = (double) trackStat.deltatime_qnp + (double) trackStat.deltatime_qnp_frac / 65536.0;
+            const double qnpPerSample = (double) trackStat.tempo_ppi_frac * (120.0 / 65536.0) / SPU_SAMPLE_RATE;
+            const double samplesPastDue = std::clamp(qnpPastDue / qnpPerSample, 0.0, deltaTime * SPU_SAMPLE_RATE);
+            const uint32_t dueSampleNum = sampleClock - (uint32_t) samplesPastDue;
+            PsxVm::beginTimedSpuCmds(dueSampleNum + PsxVm::getSpuCmdLeadSamples());
+            return true;
+        };
     #endif
 
     // Some helper variables for the loop
@@ -877,9 +907,20 @@ void SeqEngine() noexcept {
 
                         // Decide what executes this command, the sequencer engine or the hardware driver
                         if ((seqCmd >= PatchChg) && (seqCmd <= NoteOff)) {
+                            // PsyDoom: schedule when the SPU changes made by the command take effect, if doing sample accurate timing
+                            #if PSYDOOM_MODS
+                                const bool bTimedDriverCmd = scheduleDriverCmd(trackStat);
+                            #endif
+
                             // The hardware sound driver executes this command: do it!
                             gWess_CmdFuncArr[trackStat.driver_id][seqCmd](trackStat);
 
+                            #if PSYDOOM_MODS
+                                if (bTimedDriverCmd) {
+                                    PsxVm::endTimedSpuCmds();
+                                }
+                            #endif
+
                             // Skip past the command bytes and read the delta time until the next command
                             trackStat.pcur_cmd += gWess_seq_CmdLength[seqCmd];
                             trackStat.pcur_cmd = Read_Vlq(trackStat.pcur_cmd, trackStat.qnp_till_next_cmd);
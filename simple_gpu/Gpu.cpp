@@ -1,12 +1,42 @@
 #include "Gpu.h"
 
 #include "Asserts.h"
+#include "JobPool.h"
 
 #include <algorithm>
 #include <cstring>
+#include <vector>
+
+// Use SIMD instructions (SSE2 or NEON) for drawing floor rows, wall columns and rectangles, if allowed and supported by the target architecture
+#if SIMPLE_GPU_SIMD && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define SIMPLE_GPU_SSE2 1
+    #include <emmintrin.h>
+#elif SIMPLE_GPU_SIMD && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+    #define SIMPLE_GPU_NEON 1
+    #include <arm_neon.h>
+#endif
 
 BEGIN_NAMESPACE(Gpu)
 
+template <DrawMode DrawMode, class PrimT>
+static bool tryDeferDraw(Core& core, const PrimT& prim) noexcept;
+
+template <DrawMode DrawMode, class PrimT>
+static bool tryDeferDraws(Core& core, const PrimT* const pPrims, const uint32_t numPrims) noexcept;
+
+#if SIMPLE_GPU_SSE2 || SIMPLE_GPU_NEON
+    template <DrawMode DrawMode, TexFmt TexFmt>
+    static void drawRectRowPixelsSimd(
+        const Core& core,
+        uint16_t* const pDstPixelRow,
+        const int32_t begX,
+        const int32_t endX,
+        const uint16_t begU,
+        const uint16_t v,
+        const Color24F rectColor
+    ) noexcept;
+#endif
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Rounds the given number up to the next power of two if it's not a power of two
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -66,13 +96,17 @@ void initCore(Core& core, const uint16_t ramPixelW, const uint16_t ramPixelH) no
     core.clutY = 240;
     core.bDisableMasking = false;
 
-    core.clutCacheX = UINT16_MAX;
-    core.clutCacheY = UINT16_MAX;
-    core.clutCacheFmt = {};
-    std::memset(&core.clutCache->bits, 0, sizeof(core.clutCache));
+    for (ClutCacheEntry& entry : core.clutCache) {
+        entry = {};
+        entry.x = UINT16_MAX;
+    }
+
+    core.clutCacheCurEntry = 0;
+    core.clutCacheUseCount = 0;
 }
 
 void destroyCore(Core& core) noexcept {
+    destroyDeferredDraw(core);
     delete[] core.pRam;
     core = {};
 }
@@ -114,6 +148,14 @@ void vramWriteU16(Core& core, const uint16_t x, const uint16_t y, const uint16_t
     const uint16_t xt = x & core.ramXMask;
     const uint16_t yt = y & core.ramYMask;
     core.pRam[yt * core.ramPixelW + xt] = value;
+    invalidateClutCache(core, xt, yt, 1, 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the colors of the current CLUT; assumes the CLUT cache is up to date
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline const Color16* getCurClut(const Core& core) noexcept {
+    return core.clutCache[core.clutCacheCurEntry].colors;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -149,12 +191,12 @@ static Color16 readTexel(
     if constexpr (TexFmt == TexFmt::Bpp4) {
         // 4-bit color: each 16-bit pixel has 4 CLUT indexes. Get the CLUT index then lookup the color from the CLUT.
         const uint16_t clutIdx = (vramPixel >> ((coordX & 3) * 4)) & 0xF;
-        return core.clutCache[clutIdx];
+        return getCurClut(core)[clutIdx];
     }
     else if constexpr (TexFmt == TexFmt::Bpp8) {
         // 8-bit color: each 16-bit pixel has 2 CLUT indexes. Get the CLUT index then lookup the color from the CLUT.
         const uint16_t clutIdx = (vramPixel >> ((coordX & 1) * 8)) & 0xFF;
-        return core.clutCache[clutIdx];
+        return getCurClut(core)[clutIdx];
     }
     else {
         // Direct 16-bit color, no CLUT
@@ -167,6 +209,7 @@ static Color16 readTexel(
 // Read a texel using dynamic dispatch (slower)
 //------------------------------------------------------------------------------------------------------------------------------------------
 Color16 readTexel(Core& core, const uint16_t coordX, const uint16_t coordY) noexcept {
+    flushDeferredDraw(core);
     updateClutCache(core);
 
     switch (core.texFmt) {
@@ -180,36 +223,89 @@ Color16 readTexel(Core& core, const uint16_t coordX, const uint16_t coordY) noex
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Makes sure the CLUT cache is up to date for the current CLUT settings
+// Makes sure the CLUT cache has an entry for the current CLUT settings and that it is the current entry.
+// If the CLUT is not cached already then the least recently used entry is replaced with it.
 //------------------------------------------------------------------------------------------------------------------------------------------
 void updateClutCache(Core& core) noexcept {
     sanityCheckGpuDrawState(core);
 
-    // Do we need to update the cache?
-    const TexFmt newTexFmt = core.texFmt;
+    // No CLUT is used in 16-bit mode
+    const TexFmt texFmt = core.texFmt;
 
-    const bool bCacheNeedsUpdate = (
-        (core.clutCacheX != core.clutX) ||
-        (core.clutCacheY != core.clutY) ||
-        (core.clutCacheFmt != newTexFmt)
-    );
+    if (texFmt == TexFmt::Bpp16)
+        return;
+
+    // Is the current entry already the one we want? If so then there is nothing to do:
+    const uint16_t clutX = core.clutX;
+    const uint16_t clutY = core.clutY;
+    const auto isWantedEntry = [=](const ClutCacheEntry& entry) noexcept {
+        return ((entry.x == clutX) && (entry.y == clutY) && (entry.texFmt == texFmt));
+    };
+
+    ClutCacheEntry& curEntry = core.clutCache[core.clutCacheCurEntry];
 
-    if (!bCacheNeedsUpdate)
+    if (isWantedEntry(curEntry)) {
+        curEntry.lastUseTime = ++core.clutCacheUseCount;
         return;
+    }
+
+    // Search for the CLUT in the cache and remember the least recently used entry while doing so (unused entries are preferred)
+    uint32_t lruEntryIdx = 0;
+
+    for (uint32_t entryIdx = 0; entryIdx < CLUT_CACHE_SIZE; ++entryIdx) {
+        ClutCacheEntry& entry = core.clutCache[entryIdx];
+
+        if (isWantedEntry(entry)) {
+            entry.lastUseTime = ++core.clutCacheUseCount;
+            core.clutCacheCurEntry = entryIdx;
+            return;
+        }
+
+        const ClutCacheEntry& lruEntry = core.clutCache[lruEntryIdx];
 
-    // Don't update unless changed
-    core.clutCacheX = core.clutX;
-    core.clutCacheY = core.clutY;
-    core.clutCacheFmt = newTexFmt;
+        if ((lruEntry.x != UINT16_MAX) && ((entry.x == UINT16_MAX) || (entry.lastUseTime < lruEntry.lastUseTime))) {
+            lruEntryIdx = entryIdx;
+        }
+    }
+
+    // Not cached: replace the least recently used entry with this CLUT
+    ASSERT((texFmt == TexFmt::Bpp4) || (texFmt == TexFmt::Bpp8));
+    ClutCacheEntry& newEntry = core.clutCache[lruEntryIdx];
+    newEntry.x = clutX;
+    newEntry.y = clutY;
+    newEntry.texFmt = texFmt;
+    newEntry.lastUseTime = ++core.clutCacheUseCount;
+
+    std::memcpy(
+        &newEntry.colors->bits,
+        core.pRam + (clutY * core.ramPixelW + clutX),
+        sizeof(uint16_t) * ((texFmt == TexFmt::Bpp4) ? 16 : 256)
+    );
+
+    core.clutCacheCurEntry = lruEntryIdx;
+}
 
-    // Save the CLUT cache entries unless in 16-bit mode
-    if (newTexFmt != TexFmt::Bpp16) {
-        ASSERT((newTexFmt == TexFmt::Bpp4) || (newTexFmt == TexFmt::Bpp8));
-        std::memcpy(
-            &core.clutCache->bits,
-            core.pRam + (core.clutY * core.ramPixelW + core.clutX),
-            sizeof(uint16_t) * ((newTexFmt == TexFmt::Bpp4) ? 16 : 256)
-        );
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Discards any cached CLUTs which overlap the given area of VRAM; should be called whenever that area of VRAM is modified.
+// The area is given in terms of 16-bit VRAM pixels and is expected to not wrap around VRAM.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void invalidateClutCache(Core& core, const uint16_t x, const uint16_t y, const uint16_t w, const uint16_t h) noexcept {
+    const int32_t lx = x;
+    const int32_t rx = x + (int32_t) w;
+    const int32_t ty = y;
+    const int32_t by = y + (int32_t) h;
+
+    for (ClutCacheEntry& entry : core.clutCache) {
+        if (entry.x == UINT16_MAX)
+            continue;
+
+        const int32_t clutLx = entry.x;
+        const int32_t clutRx = clutLx + ((entry.texFmt == TexFmt::Bpp4) ? 16 : 256);
+        const int32_t clutY = entry.y;
+
+        if ((clutY >= ty) && (clutY < by) && (clutLx < rx) && (clutRx > lx)) {
+            entry.x = UINT16_MAX;
+        }
     }
 }
 
@@ -229,6 +325,9 @@ bool isPixelInDrawArea(const Core& core, const uint16_t x, const uint16_t y) noe
 // Clears a region of VRAM to the specified color
 //------------------------------------------------------------------------------------------------------------------------------------------
 void clearRect(Core& core, const Color16 color, const uint16_t x, const uint16_t y, const uint16_t w, const uint16_t h) noexcept {
+    // Make sure any deferred draws are done before clearing
+    flushDeferredDraw(core);
+
     // Caching GPU state
     uint16_t* const pRam = core.pRam;
     const uint16_t ramPixelW = core.ramPixelW;
@@ -245,6 +344,9 @@ void clearRect(Core& core, const Color16 color, const uint16_t x, const uint16_t
             pRam[(uint32_t) curY * ramPixelW + curX] = color;
         }
     }
+
+    // Discard any cached CLUTs that were overwritten
+    invalidateClutCache(core, begX, begY, endX - begX, endY - begY);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -379,11 +481,28 @@ static void draw(Core& core, const DrawRect& rect) noexcept {
         fgColor = color24FTo16<DrawMode>(rectColor);
     }
 
-    // Fill in the rectangle pixels
+    // Nothing to do if the rectangle is entirely clipped
+    if ((begX >= endX) || (begY >= endY))
+        return;
+
+    // Fill in the rectangle pixels.
+    // Note: the draw area is always within VRAM, so the pixels written do not need to be wrapped to VRAM boundaries.
+    // Any CLUTs overwritten are also invalidated once at the end, rather than for every pixel. This gives the same results since the
+    // CLUT colors being used (if any) continue to be used for the entire draw regardless.
     const bool bEnableMasking = (!core.bDisableMasking);
     uint16_t curV = topLeftV;
 
     for (int16_t y = begY; y < endY; ++y, ++curV) {
+        uint16_t* const pDstPixelRow = core.pRam + (uint32_t) y * core.ramPixelW;
+
+        // Use SIMD to do 8 pixels at a time if possible; 4bpp textures are not supported by the SIMD code
+        #if SIMPLE_GPU_SSE2 || SIMPLE_GPU_NEON
+            if constexpr (TexFmt != TexFmt::Bpp4) {
+                drawRectRowPixelsSimd<DrawMode, TexFmt>(core, pDstPixelRow, begX, endX, topLeftU, curV, rectColor);
+                continue;
+            }
+        #endif
+
         uint16_t curU = topLeftU;
 
         for (int16_t x = begX; x < endX; ++x, ++curU) {
@@ -398,16 +517,21 @@ static void draw(Core& core, const DrawRect& rect) noexcept {
                 fgColor = colorMul(fgColor, rectColor);
             }
 
-            // Do blending with the background if that is enabled
+            // Do blending with the background if that is enabled.
+            // Note: blend into a separate color so the (possibly constant) foreground color is not modified for the next pixel.
+            Color16 outColor = fgColor;
+
             if constexpr ((DrawMode == DrawMode::ColoredBlended) || (DrawMode == DrawMode::TexturedBlended)) {
-                const Color16 bgColor = vramReadU16(core, x, y);
-                fgColor = colorBlend(bgColor, fgColor, core.blendMode);
+                const Color16 bgColor = pDstPixelRow[x];
+                outColor = colorBlend(bgColor, fgColor, core.blendMode);
             }
 
             // Save the output pixel
-            vramWriteU16(core, x, y, fgColor);
+            pDstPixelRow[x] = outColor;
         }
     }
+
+    invalidateClutCache(core, begX, begY, endX - begX, endY - begY);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -415,6 +539,10 @@ static void draw(Core& core, const DrawRect& rect) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <DrawMode DrawMode>
 void draw(Core& core, const DrawRect& rect) noexcept {
+    // If doing a deferred draw then just record the command for later
+    if (tryDeferDraw<DrawMode>(core, rect))
+        return;
+
     if (core.texFmt == TexFmt::Bpp4) {
         draw<DrawMode, TexFmt::Bpp4>(core, rect);
     } else if (core.texFmt == TexFmt::Bpp8) {
@@ -436,6 +564,10 @@ template void draw<DrawMode::TexturedBlended>(Core& core, const DrawRect& rect)
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <DrawMode DrawMode>
 void draw(Core& core, const DrawLine& line) noexcept {
+    // If doing a deferred draw then just record the command for later
+    if (tryDeferDraw<DrawMode>(core, line))
+        return;
+
     sanityCheckGpuDrawState(core);
 
     // Translate the line by the drawing offset
@@ -657,14 +789,17 @@ static void draw(Core& core, const DrawTriangle& triangle) noexcept {
                 fgColor = colorMul(fgColor, triangleColor);
             }
 
-            // Do blending with the background if that is enabled
+            // Do blending with the background if that is enabled.
+            // Note: blend into a separate color so the (possibly constant) foreground color is not modified for the next pixel.
+            Color16 outColor = fgColor;
+
             if constexpr ((DrawMode == DrawMode::ColoredBlended) || (DrawMode == DrawMode::TexturedBlended)) {
                 const Color16 bgColor = pDstPixelRow[x];
-                fgColor = colorBlend(bgColor, fgColor, core.blendMode);
+                outColor = colorBlend(bgColor, fgColor, core.blendMode);
             }
 
             // Save the output pixel
-            pDstPixelRow[x] = fgColor;
+            pDstPixelRow[x] = outColor;
         }
 
         // Step the edge function onto the next row
@@ -679,6 +814,10 @@ static void draw(Core& core, const DrawTriangle& triangle) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <DrawMode DrawMode>
 void draw(Core& core, const DrawTriangle& triangle) noexcept {
+    // If doing a deferred draw then just record the command for later
+    if (tryDeferDraw<DrawMode>(core, triangle))
+        return;
+
     if (core.texFmt == TexFmt::Bpp4) {
         draw<DrawMode, TexFmt::Bpp4>(core, triangle);
     } else if (core.texFmt == TexFmt::Bpp8) {
@@ -851,14 +990,17 @@ static void draw(Core& core, const DrawTriangleGouraud& triangle) noexcept {
                 );
             }
 
-            // Do blending with the background if that is enabled
+            // Do blending with the background if that is enabled.
+            // Note: blend into a separate color so the (possibly constant) foreground color is not modified for the next pixel.
+            Color16 outColor = fgColor;
+
             if constexpr ((DrawMode == DrawMode::ColoredBlended) || (DrawMode == DrawMode::TexturedBlended)) {
                 const Color16 bgColor = pDstPixelRow[x];
-                fgColor = colorBlend(bgColor, fgColor, core.blendMode);
+                outColor = colorBlend(bgColor, fgColor, core.blendMode);
             }
 
             // Save the output pixel
-            pDstPixelRow[x] = fgColor;
+            pDstPixelRow[x] = outColor;
         }
 
         // Step the edge function onto the next row
@@ -873,6 +1015,10 @@ static void draw(Core& core, const DrawTriangleGouraud& triangle) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <DrawMode DrawMode>
 void draw(Core& core, const DrawTriangleGouraud& triangle) noexcept {
+    // If doing a deferred draw then just record the command for later
+    if (tryDeferDraw<DrawMode>(core, triangle))
+        return;
+
     if (core.texFmt == TexFmt::Bpp4) {
         draw<DrawMode, TexFmt::Bpp4>(core, triangle);
     } else if (core.texFmt == TexFmt::Bpp8) {
@@ -889,12 +1035,548 @@ template void draw<DrawMode::ColoredBlended>(Core& core, const DrawTriangleGoura
 template void draw<DrawMode::Textured>(Core& core, const DrawTriangleGouraud& triangle) noexcept;
 template void draw<DrawMode::TexturedBlended>(Core& core, const DrawTriangleGouraud& triangle) noexcept;
 
+#if SIMPLE_GPU_SSE2 || SIMPLE_GPU_NEON
+
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Draws a single row of Doom floor pixels; texture format is assumed to be 8bpp.
-// This is a new primitive added to help accelerate the classic renderer for PsyDoom.
+// SIMD helpers for drawing floor rows and wall columns.
+// These are thin wrappers over SSE2 or NEON, so that the drawing code can be written once for both.
+// Vectors of 8 16-bit pixels/values are processed at a time, with 2 vectors of 4 floats used for the interpolation of those 8 values.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr int32_t SIMD_SPAN_SIZE = 8;
+
+#if SIMPLE_GPU_SSE2
+    struct Float4   { __m128  v; };
+    struct U16x8    { __m128i v; };
+
+    static inline Float4 f4Set1(const float f) noexcept { return { _mm_set1_ps(f) }; }
+    static inline Float4 f4Ramp(const float f) noexcept { return { _mm_add_ps(_mm_set1_ps(f), _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f)) }; }
+    static inline Float4 f4Add(const Float4 a, const Float4 b) noexcept { return { _mm_add_ps(a.v, b.v) }; }
+    static inline Float4 f4Sub(const Float4 a, const Float4 b) noexcept { return { _mm_sub_ps(a.v, b.v) }; }
+    static inline Float4 f4Mul(const Float4 a, const Float4 b) noexcept { return { _mm_mul_ps(a.v, b.v) }; }
+
+    // Truncates the floats to integers and then wraps them to 16-bits, like a '(uint16_t)' cast of a float would
+    static inline U16x8 u16FromFloats(const Float4 lo, const Float4 hi) noexcept {
+        const __m128i lo32 = _mm_srai_epi32(_mm_slli_epi32(_mm_cvttps_epi32(lo.v), 16), 16);
+        const __m128i hi32 = _mm_srai_epi32(_mm_slli_epi32(_mm_cvttps_epi32(hi.v), 16), 16);
+        return { _mm_packs_epi32(lo32, hi32) };
+    }
+
+    static inline U16x8 u16Set1(const uint16_t x) noexcept { return { _mm_set1_epi16((int16_t) x) }; }
+    static inline U16x8 u16Ramp(const uint16_t x) noexcept { return { _mm_add_epi16(_mm_set1_epi16((int16_t) x), _mm_set_epi16(7, 6, 5, 4, 3, 2, 1, 0)) }; }
+    static inline U16x8 u16Load(const uint16_t* const p) noexcept { return { _mm_loadu_si128((const __m128i*) p) }; }
+    static inline void u16Store(uint16_t* const p, const U16x8 a) noexcept { _mm_storeu_si128((__m128i*) p, a.v); }
+    static inline U16x8 u16And(const U16x8 a, const U16x8 b) noexcept { return { _mm_and_si128(a.v, b.v) }; }
+    static inline U16x8 u16Or(const U16x8 a, const U16x8 b) noexcept { return { _mm_or_si128(a.v, b.v) }; }
+    static inline U16x8 u16Add(const U16x8 a, const U16x8 b) noexcept { return { _mm_add_epi16(a.v, b.v) }; }
+    static inline U16x8 u16SubSat(const U16x8 a, const U16x8 b) noexcept { return { _mm_subs_epu16(a.v, b.v) }; }
+    static inline U16x8 u16Mul(const U16x8 a, const U16x8 b) noexcept { return { _mm_mullo_epi16(a.v, b.v) }; }
+    static inline U16x8 u16Eq(const U16x8 a, const U16x8 b) noexcept { return { _mm_cmpeq_epi16(a.v, b.v) }; }
+
+    // Note: only valid for values that are less than 0x8000 since SSE2 only has a signed 16-bit min
+    static inline U16x8 u16Min(const U16x8 a, const U16x8 b) noexcept { return { _mm_min_epi16(a.v, b.v) }; }
+
+    template <int N> static inline U16x8 u16Shr(const U16x8 a) noexcept { return { _mm_srli_epi16(a.v, N) }; }
+    template <int N> static inline U16x8 u16Shl(const U16x8 a) noexcept { return { _mm_slli_epi16(a.v, N) }; }
+
+    // Picks 'a' where the mask bits are set and 'b' otherwise
+    static inline U16x8 u16Select(const U16x8 mask, const U16x8 a, const U16x8 b) noexcept {
+        return { _mm_or_si128(_mm_and_si128(mask.v, a.v), _mm_andnot_si128(mask.v, b.v)) };
+    }
+#else
+    struct Float4   { float32x4_t v; };
+    struct U16x8    { uint16x8_t  v; };
+
+    static inline Float4 f4Set1(const float f) noexcept { return { vdupq_n_f32(f) }; }
+
+    static inline Float4 f4Ramp(const float f) noexcept {
+        constexpr float RAMP[4] = { 0.0f, 1.0f, 2.0f, 3.0f };
+        return { vaddq_f32(vdupq_n_f32(f), vld1q_f32(RAMP)) };
+    }
+
+    static inline Float4 f4Add(const Float4 a, const Float4 b) noexcept { return { vaddq_f32(a.v, b.v) }; }
+    static inline Float4 f4Sub(const Float4 a, const Float4 b) noexcept { return { vsubq_f32(a.v, b.v) }; }
+    static inline Float4 f4Mul(const Float4 a, const Float4 b) noexcept { return { vmulq_f32(a.v, b.v) }; }
+
+    // Truncates the floats to integers and then wraps them to 16-bits, like a '(uint16_t)' cast of a float would
+    static inline U16x8 u16FromFloats(const Float4 lo, const Float4 hi) noexcept {
+        const int16x4_t lo16 = vmovn_s32(vcvtq_s32_f32(lo.v));
+        const int16x4_t hi16 = vmovn_s32(vcvtq_s32_f32(hi.v));
+        return { vreinterpretq_u16_s16(vcombine_s16(lo16, hi16)) };
+    }
+
+    static inline U16x8 u16Set1(const uint16_t x) noexcept { return { vdupq_n_u16(x) }; }
+
+    static inline U16x8 u16Ramp(const uint16_t x) noexcept {
+        constexpr uint16_t RAMP[8] = { 0, 1, 2, 3, 4, 5, 6, 7 };
+        return { vaddq_u16(vdupq_n_u16(x), vld1q_u16(RAMP)) };
+    }
+
+    static inline U16x8 u16Load(const uint16_t* const p) noexcept { return { vld1q_u16(p) }; }
+    static inline void u16Store(uint16_t* const p, const U16x8 a) noexcept { vst1q_u16(p, a.v); }
+    static inline U16x8 u16And(const U16x8 a, const U16x8 b) noexcept { return { vandq_u16(a.v, b.v) }; }
+    static inline U16x8 u16Or(const U16x8 a, const U16x8 b) noexcept { return { vorrq_u16(a.v, b.v) }; }
+    static inline U16x8 u16Add(const U16x8 a, const U16x8 b) noexcept { return { vaddq_u16(a.v, b.v) }; }
+    static inline U16x8 u16SubSat(const U16x8 a, const U16x8 b) noexcept { return { vqsubq_u16(a.v, b.v) }; }
+    static inline U16x8 u16Mul(const U16x8 a, const U16x8 b) noexcept { return { vmulq_u16(a.v, b.v) }; }
+    static inline U16x8 u16Eq(const U16x8 a, const U16x8 b) noexcept { return { vceqq_u16(a.v, b.v) }; }
+    static inline U16x8 u16Min(const U16x8 a, const U16x8 b) noexcept { return { vminq_u16(a.v, b.v) }; }
+
+    template <int N> static inline U16x8 u16Shr(const U16x8 a) noexcept { return { vshrq_n_u16(a.v, N) }; }
+    template <int N> static inline U16x8 u16Shl(const U16x8 a) noexcept { return { vshlq_n_u16(a.v, N) }; }
+
+    // Picks 'a' where the mask bits are set and 'b' otherwise
+    static inline U16x8 u16Select(const U16x8 mask, const U16x8 a, const U16x8 b) noexcept { return { vbslq_u16(mask.v, a.v, b.v) }; }
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD helper: computes the interpolation factor 't' (and '1 - t') for 8 consecutive pixels, starting at the given pixel index.
+// This matches how the scalar code computes 't' exactly: (0.5 + pixel index) * tStep.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline void simdGetLerpFactors(const int32_t firstPixelIdx, const float tStep, Float4 (&t)[2], Float4 (&tInv)[2]) noexcept {
+    const Float4 tStep4 = f4Set1(tStep);
+    const Float4 one4 = f4Set1(1.0f);
+    t[0] = f4Mul(f4Ramp(0.5f + (float) firstPixelIdx), tStep4);
+    t[1] = f4Mul(f4Ramp(4.5f + (float) firstPixelIdx), tStep4);
+    tInv[0] = f4Sub(one4, t[0]);
+    tInv[1] = f4Sub(one4, t[1]);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD helper: interpolates between the 2 given values for 8 pixels, truncating the results to 16-bit integers.
+// Optionally a bias can be added before truncating also. Matches the scalar calculation of: (uint16_t)(a * tInv + b * t + bias).
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline U16x8 simdLerpU16(
+    const float a,
+    const float b,
+    const Float4 (&t)[2],
+    const Float4 (&tInv)[2],
+    const float bias = 0.0f
+) noexcept {
+    const Float4 a4 = f4Set1(a);
+    const Float4 b4 = f4Set1(b);
+    Float4 lo = f4Add(f4Mul(a4, tInv[0]), f4Mul(b4, t[0]));
+    Float4 hi = f4Add(f4Mul(a4, tInv[1]), f4Mul(b4, t[1]));
+
+    if (bias != 0.0f) {
+        lo = f4Add(lo, f4Set1(bias));
+        hi = f4Add(hi, f4Set1(bias));
+    }
+
+    return u16FromFloats(lo, hi);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD helper: reads 8 texels from the current 8bpp texture page and window using the given texture coordinates.
+// The VRAM addresses are computed with SIMD but the VRAM and CLUT lookups themselves must be done one at a time.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline U16x8 simdReadTexels8bpp(const Core& core, const U16x8 u, const U16x8 v) noexcept {
+    U16x8 vramX = u16And(u, u16Set1(core.texWinXMask));
+    U16x8 vramY = u16And(v, u16Set1(core.texWinYMask));
+    vramX = u16Add(vramX, u16Set1(core.texWinX));
+    vramY = u16Add(vramY, u16Set1(core.texWinY));
+    vramX = u16Shr<1>(vramX);
+    vramX = u16And(vramX, u16Set1(core.texPageXMask));
+    vramY = u16And(vramY, u16Set1(core.texPageYMask));
+    vramX = u16Add(vramX, u16Set1(core.texPageX));
+    vramY = u16Add(vramY, u16Set1(core.texPageY));
+    vramX = u16And(vramX, u16Set1(core.ramXMask));
+    vramY = u16And(vramY, u16Set1(core.ramYMask));
+
+    alignas(16) uint16_t coordsU[SIMD_SPAN_SIZE];
+    alignas(16) uint16_t coordsX[SIMD_SPAN_SIZE];
+    alignas(16) uint16_t coordsY[SIMD_SPAN_SIZE];
+    alignas(16) uint16_t texels[SIMD_SPAN_SIZE];
+    u16Store(coordsU, u);
+    u16Store(coordsX, vramX);
+    u16Store(coordsY, vramY);
+
+    const uint16_t* const pVram = core.pRam;
+    const uint32_t vramPixelW = core.ramPixelW;
+
+    for (int32_t i = 0; i < SIMD_SPAN_SIZE; ++i) {
+        const uint16_t vramPixel = pVram[coordsY[i] * vramPixelW + coordsX[i]];
+        const uint16_t clutIdx = (vramPixel >> ((coordsU[i] & 1) * 8)) & 0xFF;
+        texels[i] = getCurClut(core)[clutIdx];
+    }
+
+    return u16Load(texels);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD helper: reads 8 texels from the current 16bpp texture page and window using the given texture coordinates.
+// The VRAM addresses are computed with SIMD but the VRAM lookups themselves must be done one at a time.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline U16x8 simdReadTexels16bpp(const Core& core, const U16x8 u, const U16x8 v) noexcept {
+    U16x8 vramX = u16And(u, u16Set1(core.texWinXMask));
+    U16x8 vramY = u16And(v, u16Set1(core.texWinYMask));
+    vramX = u16Add(vramX, u16Set1(core.texWinX));
+    vramY = u16Add(vramY, u16Set1(core.texWinY));
+    vramX = u16And(vramX, u16Set1(core.texPageXMask));
+    vramY = u16And(vramY, u16Set1(core.texPageYMask));
+    vramX = u16Add(vramX, u16Set1(core.texPageX));
+    vramY = u16Add(vramY, u16Set1(core.texPageY));
+    vramX = u16And(vramX, u16Set1(core.ramXMask));
+    vramY = u16And(vramY, u16Set1(core.ramYMask));
+
+    alignas(16) uint16_t coordsX[SIMD_SPAN_SIZE];
+    alignas(16) uint16_t coordsY[SIMD_SPAN_SIZE];
+    alignas(16) uint16_t texels[SIMD_SPAN_SIZE];
+    u16Store(coordsX, vramX);
+    u16Store(coordsY, vramY);
+
+    const uint16_t* const pVram = core.pRam;
+    const uint32_t vramPixelW = core.ramPixelW;
+
+    for (int32_t i = 0; i < SIMD_SPAN_SIZE; ++i) {
+        texels[i] = pVram[coordsY[i] * vramPixelW + coordsX[i]];
+    }
+
+    return u16Load(texels);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD version of 'colorMul': modulates 8 colors by the given 1.7 fixed point color multipliers (one per color component and pixel)
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline U16x8 simdColorMul(const U16x8 color, const U16x8 mulR, const U16x8 mulG, const U16x8 mulB) noexcept {
+    const U16x8 compMask = u16Set1(0x1F);
+    const U16x8 r = u16Min(u16Shr<7>(u16Mul(u16And(color, compMask), mulR)), compMask);
+    const U16x8 g = u16Min(u16Shr<7>(u16Mul(u16And(u16Shr<5>(color), compMask), mulG)), compMask);
+    const U16x8 b = u16Min(u16Shr<7>(u16Mul(u16And(u16Shr<10>(color), compMask), mulB)), compMask);
+    const U16x8 t = u16And(color, u16Set1(0x8000));
+    return u16Or(u16Or(r, u16Shl<5>(g)), u16Or(u16Shl<10>(b), t));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD version of 'colorBlend': blends 8 foreground and background colors using the given blend mode
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline U16x8 simdColorBlend(const U16x8 bg, const U16x8 fg, const BlendMode mode) noexcept {
+    const U16x8 compMask = u16Set1(0x1F);
+    const U16x8 bgR = u16And(bg, compMask);
+    const U16x8 bgG = u16And(u16Shr<5>(bg), compMask);
+    const U16x8 bgB = u16And(u16Shr<10>(bg), compMask);
+    const U16x8 fgR = u16And(fg, compMask);
+    const U16x8 fgG = u16And(u16Shr<5>(fg), compMask);
+    const U16x8 fgB = u16And(u16Shr<10>(fg), compMask);
+
+    U16x8 r, g, b;
+
+    switch (mode) {
+        case BlendMode::Alpha50:
+            r = u16Shr<1>(u16Add(bgR, fgR));
+            g = u16Shr<1>(u16Add(bgG, fgG));
+            b = u16Shr<1>(u16Add(bgB, fgB));
+            break;
+
+        case BlendMode::Add:
+            r = u16Min(u16Add(bgR, fgR), compMask);
+            g = u16Min(u16Add(bgG, fgG), compMask);
+            b = u16Min(u16Add(bgB, fgB), compMask);
+            break;
+
+        case BlendMode::Subtract:
+            r = u16SubSat(bgR, fgR);
+            g = u16SubSat(bgG, fgG);
+            b = u16SubSat(bgB, fgB);
+            break;
+
+        case BlendMode::Add25:
+        default:
+            r = u16Min(u16Add(bgR, u16Shr<2>(fgR)), compMask);
+            g = u16Min(u16Add(bgG, u16Shr<2>(fgG)), compMask);
+            b = u16Min(u16Add(bgB, u16Shr<2>(fgB)), compMask);
+            break;
+    }
+
+    // Note: the semi-transparency bit of the foreground color is preserved, like with 'colorBlend'
+    const U16x8 t = u16And(fg, u16Set1(0x8000));
+    return u16Or(u16Or(r, u16Shl<5>(g)), u16Or(u16Shl<10>(b), t));
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD helper: given the foreground color for 8 pixels and the existing (background) pixels, produces the final output pixels.
+// Blends if the draw mode requires it and keeps the existing pixel wherever the skip mask is set.
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <DrawMode DrawMode>
-void draw(Core& core, const DrawFloorRow& row) noexcept {
+static inline U16x8 simdGetOutputPixels(const Core& core, const U16x8 fgColor, const U16x8 bgColor, const U16x8 skipMask) noexcept {
+    U16x8 outColor = fgColor;
+
+    if constexpr ((DrawMode == DrawMode::ColoredBlended) || (DrawMode == DrawMode::TexturedBlended)) {
+        outColor = simdColorBlend(bgColor, fgColor, core.blendMode);
+    }
+
+    return u16Select(skipMask, bgColor, outColor);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD helper: figures out the pixels to skip for the given texels, if masking is enabled.
+// Transparent pixels (all bits zero) are skipped if masking is enabled.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline U16x8 simdGetTexelSkipMask(const U16x8 texels, const bool bEnableMasking) noexcept {
+    return (bEnableMasking) ? u16Eq(texels, u16Set1(0)) : u16Set1(0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD version of the pixel loop for drawing a floor row.
+// Produces exactly the same results as the scalar loop, but 8 pixels at a time.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <DrawMode DrawMode>
+static void drawFloorRowPixelsSimd(
+    const Core& core,
+    uint16_t* const pDstPixelRow,
+    const int32_t lx,
+    const int32_t rx,
+    const int32_t minX,
+    const float tStep,
+    const float u1,
+    const float u2,
+    const float v1,
+    const float v2,
+    const Color24F rowColor
+) noexcept {
+    constexpr bool bTextured = ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended));
+
+    const bool bEnableMasking = (!core.bDisableMasking);
+    const U16x8 mulR = u16Set1(rowColor.comp.r);
+    const U16x8 mulG = u16Set1(rowColor.comp.g);
+    const U16x8 mulB = u16Set1(rowColor.comp.b);
+    const U16x8 flatColor = u16Set1((bTextured) ? 0 : color24FTo16<DrawMode>(rowColor).bits);
+
+    for (int32_t x = lx; x <= rx; x += SIMD_SPAN_SIZE) {
+        // Get the foreground color for all pixels and figure out which ones to skip
+        U16x8 fgColor = flatColor;
+        U16x8 skipMask = u16Set1(0);
+
+        if constexpr (bTextured) {
+            Float4 t[2], tInv[2];
+            simdGetLerpFactors(x - minX, tStep, t, tInv);
+
+            const U16x8 u = simdLerpU16(u1, u2, t, tInv);
+            const U16x8 v = simdLerpU16(v1, v2, t, tInv);
+            const U16x8 texels = simdReadTexels8bpp(core, u, v);
+
+            skipMask = simdGetTexelSkipMask(texels, bEnableMasking);
+            fgColor = simdColorMul(texels, mulR, mulG, mulB);
+        }
+
+        // Read the existing pixels, compute the output pixels and write: do a partial read and write at the end of the row if required
+        uint16_t* const pDstPixels = pDstPixelRow + x;
+        const int32_t numPixels = std::min(rx - x + 1, SIMD_SPAN_SIZE);
+
+        if (numPixels == SIMD_SPAN_SIZE) {
+            const U16x8 bgColor = u16Load(pDstPixels);
+            u16Store(pDstPixels, simdGetOutputPixels<DrawMode>(core, fgColor, bgColor, skipMask));
+        } else {
+            alignas(16) uint16_t pixels[SIMD_SPAN_SIZE] = {};
+            std::memcpy(pixels, pDstPixels, sizeof(uint16_t) * numPixels);
+            u16Store(pixels, simdGetOutputPixels<DrawMode>(core, fgColor, u16Load(pixels), skipMask));
+            std::memcpy(pDstPixels, pixels, sizeof(uint16_t) * numPixels);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD version of the pixel loop for drawing a row of a rectangle; the texture format (if textured) must be 8bpp or 16bpp.
+// Produces exactly the same results as the scalar loop, but 8 pixels at a time.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <DrawMode DrawMode, TexFmt TexFmt>
+static void drawRectRowPixelsSimd(
+    const Core& core,
+    uint16_t* const pDstPixelRow,
+    const int32_t begX,
+    const int32_t endX,
+    const uint16_t begU,
+    const uint16_t v,
+    const Color24F rectColor
+) noexcept {
+    constexpr bool bTextured = ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended));
+    static_assert((!bTextured) || (TexFmt == TexFmt::Bpp8) || (TexFmt == TexFmt::Bpp16));
+
+    const bool bEnableMasking = (!core.bDisableMasking);
+    const U16x8 mulR = u16Set1(rectColor.comp.r);
+    const U16x8 mulG = u16Set1(rectColor.comp.g);
+    const U16x8 mulB = u16Set1(rectColor.comp.b);
+    const U16x8 flatColor = u16Set1((bTextured) ? 0 : color24FTo16<DrawMode>(rectColor).bits);
+    const U16x8 v8 = u16Set1(v);
+
+    for (int32_t x = begX; x < endX; x += SIMD_SPAN_SIZE) {
+        // Get the foreground color for all pixels and figure out which ones to skip
+        U16x8 fgColor = flatColor;
+        U16x8 skipMask = u16Set1(0);
+
+        if constexpr (bTextured) {
+            const U16x8 u = u16Ramp((uint16_t)(begU + (x - begX)));
+            U16x8 texels;
+
+            if constexpr (TexFmt == TexFmt::Bpp8) {
+                texels = simdReadTexels8bpp(core, u, v8);
+            } else {
+                texels = simdReadTexels16bpp(core, u, v8);
+            }
+
+            skipMask = simdGetTexelSkipMask(texels, bEnableMasking);
+            fgColor = simdColorMul(texels, mulR, mulG, mulB);
+        }
+
+        // Read the existing pixels, compute the output pixels and write: do a partial read and write at the end of the row if required
+        uint16_t* const pDstPixels = pDstPixelRow + x;
+        const int32_t numPixels = std::min(endX - x, SIMD_SPAN_SIZE);
+
+        if (numPixels == SIMD_SPAN_SIZE) {
+            const U16x8 bgColor = u16Load(pDstPixels);
+            u16Store(pDstPixels, simdGetOutputPixels<DrawMode>(core, fgColor, bgColor, skipMask));
+        } else {
+            alignas(16) uint16_t pixels[SIMD_SPAN_SIZE] = {};
+            std::memcpy(pixels, pDstPixels, sizeof(uint16_t) * numPixels);
+            u16Store(pixels, simdGetOutputPixels<DrawMode>(core, fgColor, u16Load(pixels), skipMask));
+            std::memcpy(pDstPixels, pixels, sizeof(uint16_t) * numPixels);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD helper: reads up to 8 pixels from a column in VRAM, and writes them back
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline U16x8 simdReadColPixels(const uint16_t* const pSrc, const uint32_t pitch, const int32_t numPixels) noexcept {
+    alignas(16) uint16_t pixels[SIMD_SPAN_SIZE] = {};
+
+    for (int32_t i = 0; i < numPixels; ++i) {
+        pixels[i] = pSrc[i * pitch];
+    }
+
+    return u16Load(pixels);
+}
+
+static inline void simdWriteColPixels(uint16_t* const pDst, const uint32_t pitch, const int32_t numPixels, const U16x8 colPixels) noexcept {
+    alignas(16) uint16_t pixels[SIMD_SPAN_SIZE];
+    u16Store(pixels, colPixels);
+
+    for (int32_t i = 0; i < numPixels; ++i) {
+        pDst[i * pitch] = pixels[i];
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD version of the pixel loop for drawing a wall column.
+// Produces exactly the same results as the scalar loop, but 8 pixels at a time.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <DrawMode DrawMode>
+static void drawWallColPixelsSimd(
+    const Core& core,
+    uint16_t* const pDstPixelCol,
+    const int32_t ty,
+    const int32_t by,
+    const int32_t minY,
+    const float tStep,
+    const uint16_t u,
+    const float v1,
+    const float v2,
+    const Color24F colColor
+) noexcept {
+    constexpr bool bTextured = ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended));
+
+    const bool bEnableMasking = (!core.bDisableMasking);
+    const uint32_t vramPixelW = core.ramPixelW;
+    const U16x8 mulR = u16Set1(colColor.comp.r);
+    const U16x8 mulG = u16Set1(colColor.comp.g);
+    const U16x8 mulB = u16Set1(colColor.comp.b);
+    const U16x8 flatColor = u16Set1((bTextured) ? 0 : color24FTo16<DrawMode>(colColor).bits);
+
+    for (int32_t y = ty; y <= by; y += SIMD_SPAN_SIZE) {
+        // Get the foreground color for all pixels and figure out which ones to skip
+        U16x8 fgColor = flatColor;
+        U16x8 skipMask = u16Set1(0);
+
+        if constexpr (bTextured) {
+            Float4 t[2], tInv[2];
+            simdGetLerpFactors(y - minY, tStep, t, tInv);
+
+            const U16x8 v = simdLerpU16(v1, v2, t, tInv);
+            const U16x8 texels = simdReadTexels8bpp(core, u16Set1(u), v);
+
+            skipMask = simdGetTexelSkipMask(texels, bEnableMasking);
+            fgColor = simdColorMul(texels, mulR, mulG, mulB);
+        }
+
+        // Read the existing pixels, compute the output pixels and write
+        uint16_t* const pDstPixels = pDstPixelCol + (intptr_t) y * vramPixelW;
+        const int32_t numPixels = std::min(by - y + 1, SIMD_SPAN_SIZE);
+        const U16x8 bgColor = simdReadColPixels(pDstPixels, vramPixelW, numPixels);
+        simdWriteColPixels(pDstPixels, vramPixelW, numPixels, simdGetOutputPixels<DrawMode>(core, fgColor, bgColor, skipMask));
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD version of the pixel loop for drawing a gouraud shaded wall column.
+// Produces exactly the same results as the scalar loop, but 8 pixels at a time.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <DrawMode DrawMode>
+static void drawWallColGouraudPixelsSimd(
+    const Core& core,
+    uint16_t* const pDstPixelCol,
+    const int32_t ty,
+    const int32_t by,
+    const int32_t minY,
+    const float tStep,
+    const uint16_t u,
+    const float v1,
+    const float v2,
+    const float r1,
+    const float g1,
+    const float b1,
+    const float r2,
+    const float g2,
+    const float b2
+) noexcept {
+    constexpr bool bTextured = ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended));
+
+    const bool bEnableMasking = (!core.bDisableMasking);
+    const uint32_t vramPixelW = core.ramPixelW;
+    const U16x8 byteMask = u16Set1(0xFF);
+
+    for (int32_t y = ty; y <= by; y += SIMD_SPAN_SIZE) {
+        // Compute the gouraud shaded color for all pixels
+        Float4 t[2], tInv[2];
+        simdGetLerpFactors(y - minY, tStep, t, tInv);
+
+        const U16x8 colorR = u16And(simdLerpU16(r1, r2, t, tInv, 0.5f), byteMask);
+        const U16x8 colorG = u16And(simdLerpU16(g1, g2, t, tInv, 0.5f), byteMask);
+        const U16x8 colorB = u16And(simdLerpU16(b1, b2, t, tInv, 0.5f), byteMask);
+
+        // Get the foreground color for all pixels and figure out which ones to skip
+        U16x8 fgColor;
+        U16x8 skipMask = u16Set1(0);
+
+        if constexpr (bTextured) {
+            const U16x8 v = simdLerpU16(v1, v2, t, tInv);
+            const U16x8 texels = simdReadTexels8bpp(core, u16Set1(u), v);
+
+            skipMask = simdGetTexelSkipMask(texels, bEnableMasking);
+            fgColor = simdColorMul(texels, colorR, colorG, colorB);
+        } else {
+            // Not doing texture mapping: foreground color is just the interpolated color
+            const U16x8 compMask = u16Set1(0x1F);
+            const U16x8 four = u16Set1(4);
+            const U16x8 r = u16Min(u16Shr<3>(u16Add(colorR, four)), compMask);
+            const U16x8 g = u16Min(u16Shr<3>(u16Add(colorG, four)), compMask);
+            const U16x8 b = u16Min(u16Shr<3>(u16Add(colorB, four)), compMask);
+            fgColor = u16Or(u16Or(r, u16Shl<5>(g)), u16Shl<10>(b));
+        }
+
+        // Read the existing pixels, compute the output pixels and write
+        uint16_t* const pDstPixels = pDstPixelCol + (intptr_t) y * vramPixelW;
+        const int32_t numPixels = std::min(by - y + 1, SIMD_SPAN_SIZE);
+        const U16x8 bgColor = simdReadColPixels(pDstPixels, vramPixelW, numPixels);
+        simdWriteColPixels(pDstPixels, vramPixelW, numPixels, simdGetOutputPixels<DrawMode>(core, fgColor, bgColor, skipMask));
+    }
+}
+
+#endif  // #if SIMPLE_GPU_SSE2 || SIMPLE_GPU_NEON
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Rasterizes a single row of Doom floor pixels immediately; texture format is assumed to be 8bpp
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <DrawMode DrawMode>
+static void drawFloorRowImmediate(Core& core, const DrawFloorRow& row) noexcept {
     sanityCheckGpuDrawState(core);
 
     // Apply the draw offset to the row coordinates
@@ -950,22 +1632,25 @@ void draw(Core& core, const DrawFloorRow& row) noexcept {
     const uint16_t vramYMask = core.ramYMask;
     uint16_t* const pVram = core.pRam;
 
-    // Process each pixel in the line being rasterized
-    float t = (0.5f + (float) lx - minX) * tStep;
-    float tinv = 1.0f - t;
-
+    // Process each pixel in the line being rasterized.
+    // Note: 't' is computed from scratch for each pixel rather than being stepped, so that the SIMD and regular versions of this loop
+    // produce exactly the same results.
     uint16_t* pDstPixelRow = pVram + py * vramPixelW;
+
+    #if SIMPLE_GPU_SSE2 || SIMPLE_GPU_NEON
+        drawFloorRowPixelsSimd<DrawMode>(core, pDstPixelRow, lx, rx, minX, tStep, u1, u2, v1, v2, rowColor);
+        return;
+    #endif
+
     const bool bEnableMasking = (!core.bDisableMasking);
 
     for (int32_t x = lx; x <= rx; ++x) {
         // Compute the texture coordinate to use
+        const float t = (0.5f + (float)(x - minX)) * tStep;
+        const float tinv = 1.0f - t;
         const uint16_t u = (uint16_t)(u1 * tinv + u2 * t);
         const uint16_t v = (uint16_t)(v1 * tinv + v2 * t);
 
-        // Step these to the next pixel
-        t += tStep;
-        tinv -= tStep;
-
         // Get the foreground color for the row pixel if the row is textured.
         // If the pixel is transparent and masking is enabled then also skip it, otherwise modulate it by the primitive color...
         if constexpr ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended)) {
@@ -983,7 +1668,7 @@ void draw(Core& core, const DrawFloorRow& row) noexcept {
             // Read the VRAM pixel and lookup the actual texel using the clut index
             const uint16_t vramPixel = pVram[(vramY & vramYMask) * vramPixelW + (vramX & vramXMask)];
             const uint16_t clutIdx = (vramPixel >> ((u & 1) * 8)) & 0xFF;
-            fgColor = core.clutCache[clutIdx];
+            fgColor = getCurClut(core)[clutIdx];
 
             if ((fgColor.bits == 0) && bEnableMasking)
                 continue;
@@ -991,31 +1676,70 @@ void draw(Core& core, const DrawFloorRow& row) noexcept {
             fgColor = colorMul(fgColor, rowColor);
         }
 
-        // Do blending with the background if that is enabled
+        // Do blending with the background if that is enabled.
+        // Note: blend into a separate color so the (possibly constant) foreground color is not modified for the next pixel.
         uint16_t& dstPixel = pDstPixelRow[x];
+        Color16 outColor = fgColor;
 
         if constexpr ((DrawMode == DrawMode::ColoredBlended) || (DrawMode == DrawMode::TexturedBlended)) {
             const Color16 bgColor = dstPixel;
-            fgColor = colorBlend(bgColor, fgColor, core.blendMode);
+            outColor = colorBlend(bgColor, fgColor, core.blendMode);
         }
 
         // Save the output pixel and step to the next pixel
-        dstPixel = fgColor;
+        dstPixel = outColor;
     }
 }
 
-// Instantiate the variants of this function
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws a single row of Doom floor pixels; texture format is assumed to be 8bpp.
+// This is a new primitive added to help accelerate the classic renderer for PsyDoom.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <DrawMode DrawMode>
+void draw(Core& core, const DrawFloorRow& row) noexcept {
+    // If doing a deferred draw then just record the command for later
+    if (tryDeferDraw<DrawMode>(core, row))
+        return;
+
+    drawFloorRowImmediate<DrawMode>(core, row);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws a batch of rows of Doom floor pixels which all use the current draw state; texture format is assumed to be 8bpp.
+// The result is the same as drawing each row individually, but the per primitive overhead is greatly reduced.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <DrawMode DrawMode>
+void draw(Core& core, const DrawFloorRow* const pRows, const uint32_t numRows) noexcept {
+    // If doing a deferred draw then just record the commands for later
+    if (tryDeferDraws<DrawMode>(core, pRows, numRows))
+        return;
+
+    for (uint32_t rowIdx = 0; rowIdx < numRows; ++rowIdx) {
+        drawFloorRowImmediate<DrawMode>(core, pRows[rowIdx]);
+    }
+}
+
+// Instantiate the variants of these functions
 template void draw<DrawMode::Colored>(Core& core, const DrawFloorRow& row) noexcept;
 template void draw<DrawMode::ColoredBlended>(Core& core, const DrawFloorRow& row) noexcept;
 template void draw<DrawMode::Textured>(Core& core, const DrawFloorRow& row) noexcept;
 template void draw<DrawMode::TexturedBlended>(Core& core, const DrawFloorRow& row) noexcept;
 
+template void draw<DrawMode::Colored>(Core& core, const DrawFloorRow* const pRows, const uint32_t numRows) noexcept;
+template void draw<DrawMode::ColoredBlended>(Core& core, const DrawFloorRow* const pRows, const uint32_t numRows) noexcept;
+template void draw<DrawMode::Textured>(Core& core, const DrawFloorRow* const pRows, const uint32_t numRows) noexcept;
+template void draw<DrawMode::TexturedBlended>(Core& core, const DrawFloorRow* const pRows, const uint32_t numRows) noexcept;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Draws a single column of Doom wall pixels; texture format is assumed to be 8bpp.
 // This is a new primitive added to help accelerate the classic renderer for PsyDoom.
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <DrawMode DrawMode>
 void draw(Core& core, const DrawWallCol& col) noexcept {
+    // If doing a deferred draw then just record the command for later
+    if (tryDeferDraw<DrawMode>(core, col))
+        return;
+
     sanityCheckGpuDrawState(core);
 
     // Apply the draw offset to the column coordinates
@@ -1080,21 +1804,24 @@ void draw(Core& core, const DrawWallCol& col) noexcept {
         texVramX &= core.ramXMask;
     }
 
-    // Process each pixel in the line being rasterized
-    float t = (0.5f + (float) ty - minY) * tStep;
-    float tinv = 1.0f - t;
-
+    // Process each pixel in the line being rasterized.
+    // Note: 't' is computed from scratch for each pixel rather than being stepped, so that the results are exactly the same regardless
+    // of where the column starts being rasterized. This is required so that deferred draws split the column across tiles seamlessly.
     uint16_t* pDstPixelCol = core.pRam + px;
+
+    #if SIMPLE_GPU_SSE2 || SIMPLE_GPU_NEON
+        drawWallColPixelsSimd<DrawMode>(core, pDstPixelCol, ty, by, minY, tStep, (uint16_t) u, v1, v2, colColor);
+        return;
+    #endif
+
     const bool bEnableMasking = (!core.bDisableMasking);
 
     for (int32_t y = ty; y <= by; ++y) {
         // Compute the 'v' texture coordinate to use
+        const float t = (0.5f + (float)(y - minY)) * tStep;
+        const float tinv = 1.0f - t;
         const uint16_t v = (uint16_t)(v1 * tinv + v2 * t);
 
-        // Step these to the next pixel
-        t += tStep;
-        tinv -= tStep;
-
         // Get the foreground color for the column pixel if the column is textured.
         // If the pixel is transparent and masking is enabled then also skip it, otherwise modulate it by the primitive color...
         if constexpr ((DrawMode == DrawMode::Textured) || (DrawMode == DrawMode::TexturedBlended)) {
@@ -1108,7 +1835,7 @@ void draw(Core& core, const DrawWallCol& col) noexcept {
             // Read the VRAM pixel and lookup the actual texel using the clut index
             const uint16_t vramPixel = pVram[vramY * vramPixelW + texVramX];
             const uint16_t clutIdx = (vramPixel >> ((u & 1) * 8)) & 0xFF;
-            fgColor = core.clutCache[clutIdx];
+            fgColor = getCurClut(core)[clutIdx];
 
             if ((fgColor.bits == 0) && bEnableMasking)
                 continue;
@@ -1116,16 +1843,18 @@ void draw(Core& core, const DrawWallCol& col) noexcept {
             fgColor = colorMul(fgColor, colColor);
         }
 
-        // Do blending with the background if that is enabled
+        // Do blending with the background if that is enabled.
+        // Note: blend into a separate color so the (possibly constant) foreground color is not modified for the next pixel.
         uint16_t& dstPixel = pDstPixelCol[y * vramPixelW];
+        Color16 outColor = fgColor;
 
         if constexpr ((DrawMode == DrawMode::ColoredBlended) || (DrawMode == DrawMode::TexturedBlended)) {
             const Color16 bgColor = dstPixel;
-            fgColor = colorBlend(bgColor, fgColor, core.blendMode);
+            outColor = colorBlend(bgColor, fgColor, core.blendMode);
         }
 
         // Save the output pixel and step to the next pixel
-        dstPixel = fgColor;
+        dstPixel = outColor;
     }
 }
 
@@ -1141,6 +1870,10 @@ template void draw<DrawMode::TexturedBlended>(Core& core, const DrawWallCol& col
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <DrawMode DrawMode>
 void draw(Core& core, const DrawWallColGouraud& col) noexcept {
+    // If doing a deferred draw then just record the command for later
+    if (tryDeferDraw<DrawMode>(core, col))
+        return;
+
     sanityCheckGpuDrawState(core);
 
     // Apply the draw offset to the column coordinates
@@ -1206,15 +1939,22 @@ void draw(Core& core, const DrawWallColGouraud& col) noexcept {
         texVramX &= core.ramXMask;
     }
 
-    // Process each pixel in the line being rasterized
-    float t = (0.5f + (float) ty - minY) * tStep;
-    float tInv = 1.0f - t;
-
+    // Process each pixel in the line being rasterized.
+    // Note: 't' is computed from scratch for each pixel rather than being stepped, so that the results are exactly the same regardless
+    // of where the column starts being rasterized. This is required so that deferred draws split the column across tiles seamlessly.
     uint16_t* pDstPixelCol = core.pRam + px;
+
+    #if SIMPLE_GPU_SSE2 || SIMPLE_GPU_NEON
+        drawWallColGouraudPixelsSimd<DrawMode>(core, pDstPixelCol, ty, by, minY, tStep, (uint16_t) u, v1, v2, r1, g1, b1, r2, g2, b2);
+        return;
+    #endif
+
     const bool bEnableMasking = (!core.bDisableMasking);
 
     for (int32_t y = ty; y <= by; ++y) {
         // Compute the 'v' texture coordinate to use
+        const float t = (0.5f + (float)(y - minY)) * tStep;
+        const float tInv = 1.0f - t;
         const uint16_t v = (uint16_t)(v1 * tInv + v2 * t);
 
         // Compute the triangle gouraud shaded color at this pixel.
@@ -1223,10 +1963,6 @@ void draw(Core& core, const DrawWallColGouraud& col) noexcept {
         const uint8_t gColorG = (uint8_t)(g1 * tInv + g2 * t + 0.5f);
         const uint8_t gColorB = (uint8_t)(b1 * tInv + b2 * t + 0.5f);
 
-        // Step these to the next pixel
-        t += tStep;
-        tInv -= tStep;
-
         // Figure out the foreground color for the pixel for the current draw mode.
         // If the pixel is transparent and masking is enabled then also skip it, otherwise modulate it by the primitive color...
         Color16 fgColor;
@@ -1243,7 +1979,7 @@ void draw(Core& core, const DrawWallColGouraud& col) noexcept {
             // Read the VRAM pixel and lookup the actual texel using the clut index
             const uint16_t vramPixel = pVram[vramY * vramPixelW + texVramX];
             const uint16_t clutIdx = (vramPixel >> ((u & 1) * 8)) & 0xFF;
-            fgColor = core.clutCache[clutIdx];
+            fgColor = getCurClut(core)[clutIdx];
 
             if ((fgColor.bits == 0) && bEnableMasking)
                 continue;
@@ -1259,16 +1995,18 @@ void draw(Core& core, const DrawWallColGouraud& col) noexcept {
             );
         }
 
-        // Do blending with the background if that is enabled
+        // Do blending with the background if that is enabled.
+        // Note: blend into a separate color so the (possibly constant) foreground color is not modified for the next pixel.
         uint16_t& dstPixel = pDstPixelCol[y * vramPixelW];
+        Color16 outColor = fgColor;
 
         if constexpr ((DrawMode == DrawMode::ColoredBlended) || (DrawMode == DrawMode::TexturedBlended)) {
             const Color16 bgColor = dstPixel;
-            fgColor = colorBlend(bgColor, fgColor, core.blendMode);
+            outColor = colorBlend(bgColor, fgColor, core.blendMode);
         }
 
         // Save the output pixel and step to the next pixel
-        dstPixel = fgColor;
+        dstPixel = outColor;
     }
 }
 
@@ -1278,4 +2016,422 @@ template void draw<DrawMode::ColoredBlended>(Core& core, const DrawWallColGourau
 template void draw<DrawMode::Textured>(Core& core, const DrawWallColGouraud& col) noexcept;
 template void draw<DrawMode::TexturedBlended>(Core& core, const DrawWallColGouraud& col) noexcept;
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Deferred drawing: constants and data structures.
+// 
+// Deferred draw commands are binned into tiles which cover the full width of VRAM and a small number of rows.
+// Covering the full width means floor rows (the most common classic renderer primitive) are never split across tiles, and clipping
+// all other primitives to a tile's rows only produces the exact same pixels as drawing them unclipped.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr uint32_t DEFERRED_TILE_H = 16;
+
+// Types of primitive that can be recorded for a deferred draw
+enum class DrawCmdType : uint8_t {
+    Rect,
+    Line,
+    Triangle,
+    TriangleGouraud,
+    FloorRow,
+    WallCol,
+    WallColGouraud
+};
+
+// The GPU state that a deferred draw command is rasterized with.
+// Note: explicitly padded so that it can be compared with 'memcmp'.
+struct DrawState {
+    int16_t     drawOffsetX;
+    int16_t     drawOffsetY;
+    uint16_t    drawAreaLx;
+    uint16_t    drawAreaRx;
+    uint16_t    drawAreaTy;
+    uint16_t    drawAreaBy;
+    uint16_t    texPageX;
+    uint16_t    texPageY;
+    uint16_t    texPageXMask;
+    uint16_t    texPageYMask;
+    uint16_t    texWinX;
+    uint16_t    texWinY;
+    uint16_t    texWinXMask;
+    uint16_t    texWinYMask;
+    uint16_t    clutX;
+    uint16_t    clutY;
+    BlendMode   blendMode;
+    TexFmt      texFmt;
+    bool        bDisableMasking;
+    uint8_t     pad;
+};
+
+static_assert(sizeof(DrawState) == 36);
+
+// A recorded deferred draw command: the primitive, how to draw it and the index of the GPU state to draw it with
+struct DrawCmd {
+    DrawCmdType     type;
+    DrawMode        drawMode;
+    uint32_t        stateIdx;
+
+    union Prim {
+        DrawRect                rect;
+        DrawLine                line;
+        DrawTriangle            triangle;
+        DrawTriangleGouraud     triangleGouraud;
+        DrawFloorRow            floorRow;
+        DrawWallCol             wallCol;
+        DrawWallColGouraud      wallColGouraud;
+
+        inline Prim() noexcept : rect() {}
+    } prim;
+};
+
+struct DeferredDraw {
+    bool                                bInDeferredDraw;    // Is a deferred draw in progress? If so then draw commands are recorded.
+    std::vector<DrawState>              drawStates;         // All of the unique (consecutive) GPU states used by recorded draw commands
+    std::vector<DrawCmd>                drawCmds;           // All of the draw commands recorded, in draw order
+    std::vector<std::vector<uint32_t>>  tileDrawCmds;       // For each tile: the indexes of the draw commands which touch the tile, in draw order
+    JobPool*                            pJobPool;           // The job pool whose worker threads help the thread flushing deferred draws to rasterize tiles
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the range of VRAM rows that a primitive potentially touches (inclusive), before the draw area and draw offset are applied.
+// Note that this does not need to be tight, just conservative.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void getPrimRows(const DrawRect& rect, int32_t& minY, int32_t& maxY) noexcept {
+    minY = rect.y;
+    maxY = (int32_t) rect.y + rect.h - 1;
+}
+
+static void getPrimRows(const DrawLine& line, int32_t& minY, int32_t& maxY) noexcept {
+    minY = std::min(line.y1, line.y2);
+    maxY = std::max(line.y1, line.y2);
+}
+
+template <class TriangleT>
+static void getPrimRows(const TriangleT& triangle, int32_t& minY, int32_t& maxY) noexcept {
+    minY = std::min(std::min(triangle.y1, triangle.y2), triangle.y3);
+    maxY = std::max(std::max(triangle.y1, triangle.y2), triangle.y3);
+}
+
+static void getPrimRows(const DrawFloorRow& row, int32_t& minY, int32_t& maxY) noexcept {
+    minY = row.y;
+    maxY = row.y;
+}
+
+template <class WallColT>
+static void getPrimRowsForCol(const WallColT& col, int32_t& minY, int32_t& maxY) noexcept {
+    minY = std::min(col.y1, col.y2);
+    maxY = std::max(col.y1, col.y2);
+}
+
+static void getPrimRows(const DrawWallCol& col, int32_t& minY, int32_t& maxY) noexcept { getPrimRowsForCol(col, minY, maxY); }
+static void getPrimRows(const DrawWallColGouraud& col, int32_t& minY, int32_t& maxY) noexcept { getPrimRowsForCol(col, minY, maxY); }
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helpers: save the current draw state of the core or restore it from a saved draw state
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void saveDrawState(const Core& core, DrawState& state) noexcept {
+    std::memset(&state, 0, sizeof(DrawState));
+    state.drawOffsetX = core.drawOffsetX;
+    state.drawOffsetY = core.drawOffsetY;
+    state.drawAreaLx = core.drawAreaLx;
+    state.drawAreaRx = core.drawAreaRx;
+    state.drawAreaTy = core.drawAreaTy;
+    state.drawAreaBy = core.drawAreaBy;
+    state.texPageX = core.texPageX;
+    state.texPageY = core.texPageY;
+    state.texPageXMask = core.texPageXMask;
+    state.texPageYMask = core.texPageYMask;
+    state.texWinX = core.texWinX;
+    state.texWinY = core.texWinY;
+    state.texWinXMask = core.texWinXMask;
+    state.texWinYMask = core.texWinYMask;
+    state.clutX = core.clutX;
+    state.clutY = core.clutY;
+    state.blendMode = core.blendMode;
+    state.texFmt = core.texFmt;
+    state.bDisableMasking = core.bDisableMasking;
+}
+
+static void restoreDrawState(Core& core, const DrawState& state) noexcept {
+    core.drawOffsetX = state.drawOffsetX;
+    core.drawOffsetY = state.drawOffsetY;
+    core.drawAreaLx = state.drawAreaLx;
+    core.drawAreaRx = state.drawAreaRx;
+    core.drawAreaTy = state.drawAreaTy;
+    core.drawAreaBy = state.drawAreaBy;
+    core.texPageX = state.texPageX;
+    core.texPageY = state.texPageY;
+    core.texPageXMask = state.texPageXMask;
+    core.texPageYMask = state.texPageYMask;
+    core.texWinX = state.texWinX;
+    core.texWinY = state.texWinY;
+    core.texWinXMask = state.texWinXMask;
+    core.texWinYMask = state.texWinYMask;
+    core.clutX = state.clutX;
+    core.clutY = state.clutY;
+    core.blendMode = state.blendMode;
+    core.texFmt = state.texFmt;
+    core.bDisableMasking = state.bDisableMasking;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Helpers: set the primitive to draw for a deferred draw command
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void setCmdPrim(DrawCmd& cmd, const DrawRect& rect) noexcept {
+    cmd.type = DrawCmdType::Rect;
+    cmd.prim.rect = rect;
+}
+
+static void setCmdPrim(DrawCmd& cmd, const DrawLine& line) noexcept {
+    cmd.type = DrawCmdType::Line;
+    cmd.prim.line = line;
+}
+
+static void setCmdPrim(DrawCmd& cmd, const DrawTriangle& triangle) noexcept {
+    cmd.type = DrawCmdType::Triangle;
+    cmd.prim.triangle = triangle;
+}
+
+static void setCmdPrim(DrawCmd& cmd, const DrawTriangleGouraud& triangle) noexcept {
+    cmd.type = DrawCmdType::TriangleGouraud;
+    cmd.prim.triangleGouraud = triangle;
+}
+
+static void setCmdPrim(DrawCmd& cmd, const DrawFloorRow& row) noexcept {
+    cmd.type = DrawCmdType::FloorRow;
+    cmd.prim.floorRow = row;
+}
+
+static void setCmdPrim(DrawCmd& cmd, const DrawWallCol& col) noexcept {
+    cmd.type = DrawCmdType::WallCol;
+    cmd.prim.wallCol = col;
+}
+
+static void setCmdPrim(DrawCmd& cmd, const DrawWallColGouraud& col) noexcept {
+    cmd.type = DrawCmdType::WallColGouraud;
+    cmd.prim.wallColGouraud = col;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// If a deferred draw is in progress then records the given primitives to be drawn later and returns 'true'.
+// Returns 'false' if the primitives should just be drawn immediately instead.
+// All of the primitives are drawn with the current draw state of the core.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <DrawMode DrawMode, class PrimT>
+static bool tryDeferDraws(Core& core, const PrimT* const pPrims, const uint32_t numPrims) noexcept {
+    DeferredDraw* const pDeferredDraw = core.pDeferredDraw;
+
+    if ((!pDeferredDraw) || (!pDeferredDraw->bInDeferredDraw))
+        return false;
+
+    DeferredDraw& deferredDraw = *pDeferredDraw;
+    sanityCheckGpuDrawState(core);
+
+    std::vector<DrawState>& drawStates = deferredDraw.drawStates;
+    bool bSavedDrawState = false;
+
+    for (uint32_t primIdx = 0; primIdx < numPrims; ++primIdx) {
+        // Figure out which rows of the draw area the primitive touches, if any.
+        // If the primitive is completely outside of the draw area then it would draw nothing and can be discarded.
+        const PrimT& prim = pPrims[primIdx];
+
+        int32_t minY = {};
+        int32_t maxY = {};
+        getPrimRows(prim, minY, maxY);
+        minY = std::max(minY + core.drawOffsetY, (int32_t) core.drawAreaTy);
+        maxY = std::min(maxY + core.drawOffsetY, (int32_t) core.drawAreaBy);
+
+        if (minY > maxY)
+            continue;
+
+        // Save the current draw state, if it's different to the last draw state saved.
+        // This only needs to be done once, since all of the primitives share the same draw state.
+        if (!bSavedDrawState) {
+            DrawState drawState;
+            saveDrawState(core, drawState);
+
+            if (drawStates.empty() || (std::memcmp(&drawStates.back(), &drawState, sizeof(DrawState)) != 0)) {
+                drawStates.push_back(drawState);
+            }
+
+            bSavedDrawState = true;
+        }
+
+        // Record the draw command and bin it into all the tiles that it touches
+        const uint32_t cmdIdx = (uint32_t) deferredDraw.drawCmds.size();
+        DrawCmd& cmd = deferredDraw.drawCmds.emplace_back();
+        cmd.drawMode = DrawMode;
+        cmd.stateIdx = (uint32_t) drawStates.size() - 1;
+        setCmdPrim(cmd, prim);
+
+        const uint32_t startTileIdx = (uint32_t) minY / DEFERRED_TILE_H;
+        const uint32_t endTileIdx = (uint32_t) maxY / DEFERRED_TILE_H;
+
+        for (uint32_t tileIdx = startTileIdx; tileIdx <= endTileIdx; ++tileIdx) {
+            deferredDraw.tileDrawCmds[tileIdx].push_back(cmdIdx);
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// If a deferred draw is in progress then records the given primitive to be drawn later and returns 'true'.
+// Returns 'false' if the primitive should just be drawn immediately instead.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <DrawMode DrawMode, class PrimT>
+static bool tryDeferDraw(Core& core, const PrimT& prim) noexcept {
+    return tryDeferDraws<DrawMode>(core, &prim, 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws a recorded primitive with the given draw mode
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class PrimT>
+static void drawWithMode(Core& core, const DrawMode drawMode, const PrimT& prim) noexcept {
+    switch (drawMode) {
+        case DrawMode::Colored:             draw<DrawMode::Colored>(core, prim);            break;
+        case DrawMode::ColoredBlended:      draw<DrawMode::ColoredBlended>(core, prim);     break;
+        case DrawMode::Textured:            draw<DrawMode::Textured>(core, prim);           break;
+        case DrawMode::TexturedBlended:     draw<DrawMode::TexturedBlended>(core, prim);    break;
+    }
+}
+
+// Lines cannot be textured, so only the colored draw modes are available for them
+static void drawWithMode(Core& core, const DrawMode drawMode, const DrawLine& line) noexcept {
+    if (drawMode == DrawMode::ColoredBlended) {
+        draw<DrawMode::ColoredBlended>(core, line);
+    } else {
+        ASSERT(drawMode == DrawMode::Colored);
+        draw<DrawMode::Colored>(core, line);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Rasterizes all of the recorded draw commands touching the specified tile.
+// Uses a copy of the core (with its own CLUT cache) restricted to drawing within the tile, so that tiles can be drawn in parallel.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void rasterizeDeferredTile(const Core& core, const DeferredDraw& deferredDraw, const uint32_t tileIdx) noexcept {
+    const std::vector<uint32_t>& tileDrawCmds = deferredDraw.tileDrawCmds[tileIdx];
+
+    if (tileDrawCmds.empty())
+        return;
+
+    Core tileCore = core;
+    tileCore.pDeferredDraw = nullptr;
+
+    const uint16_t tileTy = (uint16_t)(tileIdx * DEFERRED_TILE_H);
+    const uint16_t tileBy = (uint16_t)(tileTy + DEFERRED_TILE_H - 1);
+    uint32_t curStateIdx = UINT32_MAX;
+
+    for (const uint32_t cmdIdx : tileDrawCmds) {
+        const DrawCmd& cmd = deferredDraw.drawCmds[cmdIdx];
+
+        // Switch to the GPU state for this command if required and clip the draw area to the tile.
+        // Note: the command is only binned into this tile if it's draw area overlaps the tile, so the clipped draw area is never empty.
+        if (cmd.stateIdx != curStateIdx) {
+            restoreDrawState(tileCore, deferredDraw.drawStates[cmd.stateIdx]);
+            tileCore.drawAreaTy = std::max(tileCore.drawAreaTy, tileTy);
+            tileCore.drawAreaBy = std::min(tileCore.drawAreaBy, tileBy);
+            curStateIdx = cmd.stateIdx;
+        }
+
+        switch (cmd.type) {
+            case DrawCmdType::Rect:             drawWithMode(tileCore, cmd.drawMode, cmd.prim.rect);                break;
+            case DrawCmdType::Line:             drawWithMode(tileCore, cmd.drawMode, cmd.prim.line);                break;
+            case DrawCmdType::Triangle:         drawWithMode(tileCore, cmd.drawMode, cmd.prim.triangle);            break;
+            case DrawCmdType::TriangleGouraud:  drawWithMode(tileCore, cmd.drawMode, cmd.prim.triangleGouraud);     break;
+            case DrawCmdType::FloorRow:         drawWithMode(tileCore, cmd.drawMode, cmd.prim.floorRow);            break;
+            case DrawCmdType::WallCol:          drawWithMode(tileCore, cmd.drawMode, cmd.prim.wallCol);             break;
+            case DrawCmdType::WallColGouraud:   drawWithMode(tileCore, cmd.drawMode, cmd.prim.wallColGouraud);      break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Job which rasterizes the deferred draw tile with the given index for the core passed as the context
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void rasterizeDeferredTileJob(void* const pCtx, const uint32_t tileIdx) noexcept {
+    const Core& core = *(const Core*) pCtx;
+    rasterizeDeferredTile(core, *core.pDeferredDraw, tileIdx);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Setup deferred drawing, using the worker threads of the given job pool (in addition to the thread flushing the draws).
+// If the pool has no worker threads then deferred drawing is not enabled, since it would just be slower than drawing immediately.
+// The job pool must outlive deferred drawing for the core.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void initDeferredDraw(Core& core, JobPool& jobPool) noexcept {
+    destroyDeferredDraw(core);
+
+    if (jobPool.getNumWorkers() == 0)
+        return;
+
+    DeferredDraw& deferredDraw = *new DeferredDraw();
+    core.pDeferredDraw = &deferredDraw;
+    deferredDraw.tileDrawCmds.resize((core.ramPixelH + DEFERRED_TILE_H - 1) / DEFERRED_TILE_H);
+    deferredDraw.pJobPool = &jobPool;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tears down deferred drawing (if it's enabled) and draws anything still outstanding
+//------------------------------------------------------------------------------------------------------------------------------------------
+void destroyDeferredDraw(Core& core) noexcept {
+    DeferredDraw* const pDeferredDraw = core.pDeferredDraw;
+
+    if (!pDeferredDraw)
+        return;
+
+    flushDeferredDraw(core);
+    delete pDeferredDraw;
+    core.pDeferredDraw = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Begins a deferred draw: draw commands will be recorded from here on and drawn when flushed or the deferred draw ends.
+// Does nothing if deferred drawing has not been initialized.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void beginDeferredDraw(Core& core) noexcept {
+    if (core.pDeferredDraw) {
+        core.pDeferredDraw->bInDeferredDraw = true;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Ends a deferred draw and draws all of the recorded draw commands
+//------------------------------------------------------------------------------------------------------------------------------------------
+void endDeferredDraw(Core& core) noexcept {
+    if (core.pDeferredDraw) {
+        flushDeferredDraw(core);
+        core.pDeferredDraw->bInDeferredDraw = false;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws all of the draw commands recorded so far (if any) using the worker threads, and waits for the drawing to finish
+//------------------------------------------------------------------------------------------------------------------------------------------
+void flushDeferredDraw(Core& core) noexcept {
+    DeferredDraw* const pDeferredDraw = core.pDeferredDraw;
+
+    if ((!pDeferredDraw) || pDeferredDraw->drawCmds.empty())
+        return;
+
+    // Rasterize each tile as a job on the job pool and wait for them all to finish
+    DeferredDraw& deferredDraw = *pDeferredDraw;
+    deferredDraw.pJobPool->run(rasterizeDeferredTileJob, &core, (uint32_t) deferredDraw.tileDrawCmds.size());
+
+    // Clear all of the recorded commands but keep the memory allocated for the next time
+    deferredDraw.drawStates.clear();
+    deferredDraw.drawCmds.clear();
+
+    for (std::vector<uint32_t>& tileDrawCmds : deferredDraw.tileDrawCmds) {
+        tileDrawCmds.clear();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if a deferred draw is currently in progress, i.e if draw commands are being recorded to be drawn later
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool isDeferringDraws(const Core& core) noexcept {
+    return (core.pDeferredDraw && core.pDeferredDraw->bInDeferredDraw);
+}
+
 END_NAMESPACE(Gpu)
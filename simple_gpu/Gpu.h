@@ -19,6 +19,7 @@
 //  (7) The GPU 'mask bit' for masking pixels is not supported, Doom did not use this.
 //  (8) X and Y flipping textures is not supported; original PS1 models did not have this anyway so games could not use it.
 //  (9) All rendering/command primitives are fed directly to the GPU and handled immediately - command buffers are not supported.
+//      The only exception to this is the optional 'deferred draw' mode, where primitives are recorded for multithreaded rasterization.
 //  (10) Only rectangles, lines, triangles, and a few (newly added) Doom specific primitives are supported.
 //       Quads must be decomposed externally into triangles.
 //  (11) The full range of draw primitives exposed by the original LIBGPU is NOT provided, only the ones that Doom uses.
@@ -31,6 +32,8 @@
 //  (2) VRAM can be made bigger than the standard 1024x512 pixels.
 //  (3) Texture coordinates are now 16-bit, which allows for (1) to be taken advantage of.
 //------------------------------------------------------------------------------------------------------------------------------------------
+class JobPool;
+
 BEGIN_NAMESPACE(Gpu)
 
 // The original VRAM width and height (in 16-bit pixels) for the PS1
@@ -222,6 +225,22 @@ struct DrawWallColGouraud {
     Color24F    color2;     // Column point 2: color
 };
 
+// How many CLUTs can be cached at once
+static constexpr uint32_t CLUT_CACHE_SIZE = 16;
+
+// A single entry in the CLUT cache: the colors of a CLUT and the VRAM location and texture format the CLUT was cached for.
+// An 'x' value of 'UINT16_MAX' means the entry is unused.
+struct ClutCacheEntry {
+    uint16_t    x;              // X position of the CLUT in 16-bit VRAM pixels
+    uint16_t    y;              // Y position of the CLUT in 16-bit VRAM pixels
+    TexFmt      texFmt;         // Texture format the CLUT was cached for (determines the number of colors in the CLUT)
+    uint32_t    lastUseTime;    // When the entry was last used ('clutCacheUseCount' value), for evicting the least recently used entry
+    Color16     colors[256];    // The cached colors of the CLUT
+};
+
+// Internal state for deferred drawing (see 'beginDeferredDraw'), this is private to the GPU implementation
+struct DeferredDraw;
+
 //----------------------------------------------------------------------------------------------------------------------
 // The GPU core/device itself
 //----------------------------------------------------------------------------------------------------------------------
@@ -255,11 +274,13 @@ struct Core {
     uint16_t        clutY;              // Y position of the current CLUT/color-index table in 16-bit VRAM pixels (CLUT is arranged in a row at this location)
     bool            bDisableMasking;    // PSX GPU extension: disable pixel discard during texture mapping when all the texel bits are '0'?
 
-    // CLUT cache to speed up texture mapping and the settings it was last saved with
-    TexFmt          clutCacheFmt;
-    uint16_t        clutCacheX;
-    uint16_t        clutCacheY;
-    Color16         clutCache[256];
+    // Cache of recently used CLUTs to speed up texture mapping, the entry for the current CLUT and a counter for tracking entry usage
+    ClutCacheEntry  clutCache[CLUT_CACHE_SIZE];
+    uint32_t        clutCacheCurEntry;
+    uint32_t        clutCacheUseCount;
+
+    // The job pool and recorded draw commands for deferred drawing, or null if deferred drawing is not available
+    DeferredDraw*   pDeferredDraw;
 };
 
 // Initializing and shutting down a core
@@ -273,6 +294,7 @@ Color16 readTexel(Core& core, const uint16_t coordX, const uint16_t coordY) noex
 
 // Miscellaneous
 void updateClutCache(Core& core) noexcept;
+void invalidateClutCache(Core& core, const uint16_t x, const uint16_t y, const uint16_t w, const uint16_t h) noexcept;
 bool isPixelInDrawArea(const Core& core, const uint16_t x, const uint16_t y) noexcept;
 void clearRect(Core& core, const Color16 color, const uint16_t x, const uint16_t y, const uint16_t w, const uint16_t h) noexcept;
 
@@ -283,6 +305,22 @@ Color16 color24FTo16(const Color24F colorIn) noexcept;
 Color16 colorMul(const Color16 color1, const Color24F color2) noexcept;
 Color16 colorBlend(const Color16 bg, const Color16 fg, const BlendMode mode) noexcept;
 
+// Deferred drawing.
+// While a deferred draw is in progress, all draw commands are recorded and binned into screen tiles instead of being drawn immediately.
+// When the commands are flushed, the tiles are rasterized in parallel using a job pool's worker threads; draw order is preserved within each tile.
+// If deferred drawing has not been initialized (or the job pool has no worker threads) then drawing just happens immediately as normal.
+//
+// Notes:
+//  (1) The host must flush deferred draws before it directly accesses VRAM (reading, writing or copying) during a deferred draw.
+//      The GPU functions which access VRAM (clearing and reading texels) flush automatically.
+//  (2) Deferred draws must not sample textures from the area of VRAM being drawn to in the same flush.
+void initDeferredDraw(Core& core, JobPool& jobPool) noexcept;
+void destroyDeferredDraw(Core& core) noexcept;
+void beginDeferredDraw(Core& core) noexcept;
+void endDeferredDraw(Core& core) noexcept;
+void flushDeferredDraw(Core& core) noexcept;
+bool isDeferringDraws(const Core& core) noexcept;
+
 // Drawing functions: note that lines CANNOT be textured!
 template <DrawMode DrawMode>
 void draw(Core& core, const DrawRect& rect) noexcept;
@@ -299,6 +337,9 @@ void draw(Core& core, const DrawTriangleGouraud& triangle) noexcept;
 template <DrawMode DrawMode>
 void draw(Core& core, const DrawFloorRow& row) noexcept;
 
+template <DrawMode DrawMode>
+void draw(Core& core, const DrawFloorRow* const pRows, const uint32_t numRows) noexcept;
+
 template <DrawMode DrawMode>
 void draw(Core& core, const DrawWallCol& col) noexcept;
 
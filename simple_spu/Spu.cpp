@@ -3,8 +3,19 @@
 #include "Asserts.h"
 
 #include <algorithm>
+#include <array>
 #include <cstring>
 
+// Decide whether to use SIMD for voice mixing and reverb (only used for the floating point SPU).
+// The instruction set used is chosen at compile time based on the target architecture.
+#if SIMPLE_SPU_FLOAT_SPU && SIMPLE_SPU_SIMD && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+    #define SIMPLE_SPU_SSE2 1
+    #include <emmintrin.h>
+#elif SIMPLE_SPU_FLOAT_SPU && SIMPLE_SPU_SIMD && (defined(__ARM_NEON) || defined(__ARM_NEON__))
+    #define SIMPLE_SPU_NEON 1
+    #include <arm_neon.h>
+#endif
+
 using namespace Spu;
 
 // A series of co-efficients used by the SPU's gaussian sample interpolation.
@@ -44,6 +55,62 @@ static constexpr int32_t INTERP_GAUSS_TABLE[512] = {
     0x593A, 0x5949, 0x5958, 0x5965, 0x5971, 0x597C, 0x5986, 0x598F, 0x5997, 0x599E, 0x59A4, 0x59A9, 0x59AD, 0x59B0, 0x59B2, 0x59B3,
 };
 
+#if SIMPLE_SPU_SSE2 || SIMPLE_SPU_NEON
+//------------------------------------------------------------------------------------------------------------------------------------------
+// The gaussian interpolation table converted to floating point co-efficients, for use by the SIMD voice mixing code
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr std::array<float, 512> INTERP_GAUSS_TABLE_F = []() constexpr noexcept {
+    std::array<float, 512> table = {};
+
+    for (uint32_t i = 0; i < 512; ++i) {
+        table[i] = (float) INTERP_GAUSS_TABLE[i] * (1.0f / 32768.0f);
+    }
+
+    return table;
+}();
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A thin wrapper around a 4 element floating point vector for the current instruction set, and some basic operations on it
+//------------------------------------------------------------------------------------------------------------------------------------------
+#if SIMPLE_SPU_SSE2
+    typedef __m128 Float4;
+
+    static inline Float4 f4Load(const float* const pSrc) noexcept { return _mm_load_ps(pSrc); }
+    static inline Float4 f4Set(const float a, const float b, const float c, const float d) noexcept { return _mm_setr_ps(a, b, c, d); }
+    static inline void f4Store(float* const pDst, const Float4 v) noexcept { _mm_store_ps(pDst, v); }
+    static inline Float4 f4Add(const Float4 a, const Float4 b) noexcept { return _mm_add_ps(a, b); }
+    static inline Float4 f4Sub(const Float4 a, const Float4 b) noexcept { return _mm_sub_ps(a, b); }
+    static inline Float4 f4Mul(const Float4 a, const Float4 b) noexcept { return _mm_mul_ps(a, b); }
+
+    static inline float f4Sum(const Float4 v) noexcept {
+        const __m128 sum2 = _mm_add_ps(v, _mm_movehl_ps(v, v));                         // (x + z), (y + w)
+        const __m128 sum1 = _mm_add_ss(sum2, _mm_shuffle_ps(sum2, sum2, 0x55));         // (x + z) + (y + w)
+        return _mm_cvtss_f32(sum1);
+    }
+#else
+    typedef float32x4_t Float4;
+
+    static inline Float4 f4Load(const float* const pSrc) noexcept { return vld1q_f32(pSrc); }
+    static inline void f4Store(float* const pDst, const Float4 v) noexcept { vst1q_f32(pDst, v); }
+    static inline Float4 f4Add(const Float4 a, const Float4 b) noexcept { return vaddq_f32(a, b); }
+    static inline Float4 f4Sub(const Float4 a, const Float4 b) noexcept { return vsubq_f32(a, b); }
+    static inline Float4 f4Mul(const Float4 a, const Float4 b) noexcept { return vmulq_f32(a, b); }
+
+    static inline Float4 f4Set(const float a, const float b, const float c, const float d) noexcept {
+        alignas(16) const float values[4] = { a, b, c, d };
+        return vld1q_f32(values);
+    }
+
+    static inline float f4Sum(const Float4 v) noexcept {
+        const float32x2_t sum2 = vadd_f32(vget_low_f32(v), vget_high_f32(v));
+        return vget_lane_f32(vpadd_f32(sum2, sum2), 0);
+    }
+#endif
+
+// How many voices are mixed in parallel by the SIMD voice mixing code
+static constexpr uint32_t SIMD_VOICE_GROUP_SIZE = 4;
+#endif  // #if SIMPLE_SPU_SSE2 || SIMPLE_SPU_NEON
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Read from sound memory with bounds checking.
 // Any portion read beyond the end of sound memory will be zeroed.
@@ -334,56 +401,135 @@ static Sample getInterpolatedVoiceSample(const Voice& voice) noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Process/update a single voice and return it's output and output to be reverberated
+// Get the ADPCM cache entry slot to use for the ADPCM block at the given address (in 8 byte units)
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void stepVoice(
-    Voice& voice,
-    const std::byte* pRam,
-    const uint32_t ramSize,
-    StereoSample& output,
-    StereoSample& outputToReverb
-) noexcept {
-    // Nothing to do if the voice is switched off
-    if (voice.envPhase == EnvPhase::Off)
-        return;
+static inline uint32_t getAdpcmCacheSlot(const Core& core, const uint32_t adpcmAddr8) noexcept {
+    // Note: ADPCM blocks are normally 16 byte aligned, hence discard the lowest bit of the address
+    return (adpcmAddr8 >> 1) & (core.adpcmCacheSize - 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Read and decode the next ADPCM block for the voice, going through the ADPCM cache (if enabled) to avoid decoding where possible.
+// Returns the ADPCM flags for the block.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint8_t loadVoiceSamples(Voice& voice, Core& core) noexcept {
+    const uint32_t adpcmAddr8 = voice.adpcmCurAddr8;
+
+    // Can we use the cache for this block?
+    // Note: for the 16-bit SPU the reverb work area lives in SPU RAM and is continously written, so never cache blocks from there.
+    AdpcmCacheEntry* pCacheEntry = nullptr;
+
+    if (core.pAdpcmCache) {
+        #if SIMPLE_SPU_FLOAT_SPU
+            const bool bCanCache = true;
+        #else
+            const bool bCanCache = ((adpcmAddr8 * 8 + ADPCM_BLOCK_SIZE) <= core.reverbBaseAddr8 * 8);
+        #endif
+
+        if (bCanCache) {
+            pCacheEntry = &core.pAdpcmCache[getAdpcmCacheSlot(core, adpcmAddr8)];
+        }
+    }
 
+    // Decoding depends on the last 2 samples decoded by the voice, so the cached block can only be used if those match too
+    const Sample prevSample1 = voice.samples[Voice::SAMPLE_BUFFER_SIZE - 1];
+    const Sample prevSample2 = voice.samples[Voice::SAMPLE_BUFFER_SIZE - 2];
+
+    if (pCacheEntry &&
+        (pCacheEntry->adpcmAddr8Plus1 == adpcmAddr8 + 1) &&
+        (pCacheEntry->prevSamples[0].value == prevSample1.value) &&
+        (pCacheEntry->prevSamples[1].value == prevSample2.value)
+    ) {
+        // Cache hit: save the last 3 samples of the previous ADPCM block for interpolation and use the cached samples
+        static_assert(Voice::NUM_PREV_SAMPLES == 3);
+        voice.samples[0] = voice.samples[Voice::SAMPLE_BUFFER_SIZE - 3];
+        voice.samples[1] = voice.samples[Voice::SAMPLE_BUFFER_SIZE - 2];
+        voice.samples[2] = voice.samples[Voice::SAMPLE_BUFFER_SIZE - 1];
+        std::memcpy(voice.samples + Voice::NUM_PREV_SAMPLES, pCacheEntry->samples, sizeof(pCacheEntry->samples));
+        return pCacheEntry->adpcmFlags;
+    }
+
+    // Cache miss or no caching: read and decode the block
+    std::byte adpcmBlock[ADPCM_BLOCK_SIZE];
+    sramRead(core.pRam, core.ramSize, adpcmAddr8 * 8, ADPCM_BLOCK_SIZE, adpcmBlock);
+    decodeAdpcmBlock(voice, adpcmBlock);
+
+    // The ADPCM flags are in the 2nd byte of the ADPCM block
+    const uint8_t adpcmFlags = (uint8_t) adpcmBlock[1];
+
+    // Save the decoded block to the cache, if caching
+    if (pCacheEntry) {
+        pCacheEntry->adpcmAddr8Plus1 = adpcmAddr8 + 1;
+        pCacheEntry->prevSamples[0] = prevSample1;
+        pCacheEntry->prevSamples[1] = prevSample2;
+        pCacheEntry->adpcmFlags = adpcmFlags;
+        std::memcpy(pCacheEntry->samples, voice.samples + Voice::NUM_PREV_SAMPLES, sizeof(pCacheEntry->samples));
+    }
+
+    return adpcmFlags;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Does the first part of updating a voice for 1 sample, before the output of the voice is computed.
+// Reads and decodes the next ADPCM block if it is time and steps the ADSR envelope for the voice.
+// Returns 'true' if a new ADPCM block was read, in which case the flags for that block must be handled by 'endVoiceStep'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool beginVoiceStep(Voice& voice, Core& core, uint8_t& adpcmFlags) noexcept {
     // Read and decode the next ADPCM block if it is time.
     // Note that if we read in a new block then we'll have to handle the ADPCM flags at the end.
-    std::byte adpcmBlock[ADPCM_BLOCK_SIZE];
     bool bHandleAdpcmFlags = false;
 
     if (!voice.bSamplesLoaded) {
-        const uint32_t samplesAddr = voice.adpcmCurAddr8 * 8;
-        sramRead(pRam, ramSize, samplesAddr, ADPCM_BLOCK_SIZE, adpcmBlock);
-        decodeAdpcmBlock(voice, adpcmBlock);
+        adpcmFlags = loadVoiceSamples(voice, core);
         voice.bSamplesLoaded = true;
         bHandleAdpcmFlags = true;
     }
 
     // Process the ADSR envelope for the voice
     stepVoiceEnvelope(voice);
+    return bHandleAdpcmFlags;
+}
 
-    // Get the interpolated sample for the voice, attenuate by the volume envelope and voice volume, and add to the output.
-    // Only bother doing this however if the voice is actually turned on.
-    if (!voice.bDisabled) {
-        const Sample rawSample = getInterpolatedVoiceSample(voice);
-        const Sample sampleEnvScaled = rawSample * voice.envLevel;
-        const int16_t realVoiceVolL = (int16_t) std::clamp((int32_t) voice.volume.left * 2, INT16_MIN, +INT16_MAX);     // N.B: voice volume was divided by 2
-        const int16_t realVoiceVolR = (int16_t) std::clamp((int32_t) voice.volume.right * 2, INT16_MIN, +INT16_MAX);
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Start playing the given voice
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void keyOnVoice(Voice& voice) noexcept {
+    // Jump to the sample start address and flag that we need to load samples
+    voice.bSamplesLoaded = false;
+    voice.adpcmBlockPos = {};
+    voice.adpcmCurAddr8 = voice.adpcmStartAddr8;
 
-        const StereoSample sampleVolScaled = {
-            sampleEnvScaled * realVoiceVolL,
-            sampleEnvScaled * realVoiceVolR
-        };
+    // Initialize the envelope
+    voice.envPhase = EnvPhase::Attack;
+    voice.envLevel = 0;
+    voice.envWaitCycles = 0;
 
-        output += sampleVolScaled;
+    // Initialize flags
+    voice.bReachedLoopEnd = false;
+    voice.bRepeat = false;
 
-        // Only include in the output to reverberate if reverb is enabled for the voice
-        if (voice.bDoReverb) {
-            outputToReverb += sampleVolScaled;
-        }
-    }
+    // Zero the 3 previous samples used for interpolation and previous 2 samples used for ADPCM decoding
+    static_assert(Voice::NUM_PREV_SAMPLES == 3);
+    voice.samples[0] = {};
+    voice.samples[1] = {};
+    voice.samples[2] = {};
+    voice.samples[Voice::SAMPLE_BUFFER_SIZE - 2] = {};
+    voice.samples[Voice::SAMPLE_BUFFER_SIZE - 1] = {};
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Puts the given voice into release mode
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void keyOffVoice(Voice& voice) noexcept {
+    voice.envPhase = EnvPhase::Release;
+    voice.envWaitCycles = 0;
+}
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Does the last part of updating a voice for 1 sample, after the output of the voice is computed.
+// Advances the voice's sample position and handles the flags for a newly read ADPCM block (if one was read).
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void endVoiceStep(Voice& voice, const bool bHandleAdpcmFlags, const uint8_t adpcmFlags) noexcept {
     // Advance the position of the voice within the current sample block.
     // Note that the original PSX SPU wouldn't allow frequencies of more than 176,400 Hz (0x4000), hence we clamp the frequency here.
     // Certain pieces of music in Doom need this clamping to be done in order to sound correct.
@@ -404,9 +550,6 @@ static void stepVoice(
 
     // Handle processing flags for the current ADPCM block we just read (if we read one)
     if (bHandleAdpcmFlags) {
-        // The ADPCM flags are in the 2nd byte of the ADPCM block
-        const uint8_t adpcmFlags = (uint8_t) adpcmBlock[1];
-
         // Is this where we jump to restart a loop?
         if (adpcmFlags & ADPCM_FLAG_LOOP_START) {
             voice.adpcmRepeatAddr8 = voice.adpcmCurAddr8;
@@ -420,29 +563,240 @@ static void stepVoice(
             // If the repeat flag is not set then the voice will be silenced upon 'repeating'
             if ((adpcmFlags & ADPCM_FLAG_REPEAT) == 0) {
                 voice.envLevel = 0;
-                keyOff(voice);
+                keyOffVoice(voice);
             }
         }
     }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Process/update all voices and get 1 sample of output from them
+// Get the actual left and right volume levels for a voice: the stored voice volume is divided by 2
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void stepVoices(
-    Voice* const pVoices,
-    const int32_t numVoices,
-    const std::byte* pRam,
-    const uint32_t ramSize,
+static Volume getRealVoiceVolume(const Voice& voice) noexcept {
+    return Volume {
+        (int16_t) std::clamp((int32_t) voice.volume.left * 2, INT16_MIN, +INT16_MAX),
+        (int16_t) std::clamp((int32_t) voice.volume.right * 2, INT16_MIN, +INT16_MAX)
+    };
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the index of the lowest set bit in the given mask, which must be non zero
+//------------------------------------------------------------------------------------------------------------------------------------------
+static inline uint32_t getLowestSetBitIdx(const uint64_t bits) noexcept {
+    ASSERT(bits != 0);
+
+    #if defined(_MSC_VER)
+        unsigned long bitIdx = 0;
+        _BitScanForward64(&bitIdx, bits);
+        return (uint32_t) bitIdx;
+    #else
+        return (uint32_t) __builtin_ctzll(bits);
+    #endif
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Invokes the given function for the index of each voice flagged as active in the core, in order of voice index
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class VoiceIdxFuncT>
+static inline void forEachActiveVoice(const Core& core, const VoiceIdxFuncT& func) noexcept {
+    const uint32_t numMaskWords = (core.numVoices + 63) / 64;
+
+    for (uint32_t wordIdx = 0; wordIdx < numMaskWords; ++wordIdx) {
+        for (uint64_t bits = core.pActiveVoiceMask[wordIdx]; bits != 0; bits &= bits - 1) {
+            func(wordIdx * 64 + getLowestSetBitIdx(bits));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Clears the active flag for any voices in the core which have switched off
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void clearInactiveVoices(Core& core) noexcept {
+    forEachActiveVoice(core, [&](const uint32_t voiceIdx) noexcept {
+        if (core.pVoices[voiceIdx].envPhase == EnvPhase::Off) {
+            core.pActiveVoiceMask[voiceIdx / 64] &= ~((uint64_t) 1 << (voiceIdx % 64));
+        }
+    });
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Process/update a single voice and return it's output and output to be reverberated
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void stepVoice(
+    Voice& voice,
+    Core& core,
     StereoSample& output,
     StereoSample& outputToReverb
 ) noexcept {
-    ASSERT(pVoices || (numVoices == 0));
+    // Nothing to do if the voice is switched off
+    if (voice.envPhase == EnvPhase::Off)
+        return;
+
+    // Read new samples if required and step the envelope
+    uint8_t adpcmFlags = 0;
+    const bool bHandleAdpcmFlags = beginVoiceStep(voice, core, adpcmFlags);
+
+    // Get the interpolated sample for the voice, attenuate by the volume envelope and voice volume, and add to the output.
+    // Only bother doing this however if the voice is actually turned on.
+    if (!voice.bDisabled) {
+        const Sample rawSample = getInterpolatedVoiceSample(voice);
+        const Sample sampleEnvScaled = rawSample * voice.envLevel;
+        const Volume realVoiceVol = getRealVoiceVolume(voice);
+
+        const StereoSample sampleVolScaled = {
+            sampleEnvScaled * realVoiceVol.left,
+            sampleEnvScaled * realVoiceVol.right
+        };
+
+        output += sampleVolScaled;
+
+        // Only include in the output to reverberate if reverb is enabled for the voice
+        if (voice.bDoReverb) {
+            outputToReverb += sampleVolScaled;
+        }
+    }
+
+    // Advance the voice and handle the flags for any new ADPCM block
+    endVoiceStep(voice, bHandleAdpcmFlags, adpcmFlags);
+}
+
+#if SIMPLE_SPU_SSE2 || SIMPLE_SPU_NEON
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD version of voice processing for a whole block of samples: processes a group of up to 4 voices (not necessarily adjacent) in parallel.
+// The control logic (ADPCM decoding, envelopes and looping) is still done per voice, but the gaussian interpolation and the envelope and
+// volume attenuation is done for all of the voices in the group at once. Adds the output of the voices to the given sample buffers.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void stepVoiceGroupBlock(
+    Voice* const* const pVoices,
+    const uint32_t numVoices,
+    Core& core,
+    StereoSample* const pOutput,
+    StereoSample* const pOutputToReverb,
+    const uint32_t numSamples
+) noexcept {
+    ASSERT((numVoices > 0) && (numVoices <= SIMD_VOICE_GROUP_SIZE));
+
+    // The inputs for each voice in the group for the current sample: 4 interpolation samples and gauss factors and the attenuation
+    alignas(16) float samples[4][SIMD_VOICE_GROUP_SIZE];
+    alignas(16) float gaussFactors[4][SIMD_VOICE_GROUP_SIZE];
+    alignas(16) float envLevels[SIMD_VOICE_GROUP_SIZE];
+    alignas(16) float volsL[SIMD_VOICE_GROUP_SIZE];
+    alignas(16) float volsR[SIMD_VOICE_GROUP_SIZE];
+    alignas(16) float reverbMasks[SIMD_VOICE_GROUP_SIZE];
+
+    for (uint32_t sampleIdx = 0; sampleIdx < numSamples; ++sampleIdx) {
+        // Gather the inputs for each voice and do the control logic for each voice.
+        // Note: voices can only be keyed on outside of the SPU update, so once all voices are off we can stop processing early.
+        bool bAnyVoiceActive = false;
+
+        for (uint32_t laneIdx = 0; laneIdx < SIMD_VOICE_GROUP_SIZE; ++laneIdx) {
+            // If the voice is not producing sound then zero it's contribution
+            envLevels[laneIdx] = 0.0f;
+
+            if (laneIdx >= numVoices)
+                continue;
+
+            Voice& voice = *pVoices[laneIdx];
+
+            if (voice.envPhase == EnvPhase::Off)
+                continue;
+
+            bAnyVoiceActive = true;
+            uint8_t adpcmFlags = 0;
+            const bool bHandleAdpcmFlags = beginVoiceStep(voice, core, adpcmFlags);
+
+            if (!voice.bDisabled) {
+                const int32_t curSampleIdx = (int32_t) voice.adpcmBlockPos.fields.sampleIdx;
+                const int32_t gaussTableIdx = (int32_t)(uint8_t) voice.adpcmBlockPos.fields.gaussIdx;
+
+                samples[0][laneIdx] = getVoiceSample(voice, Voice::NUM_PREV_SAMPLES + curSampleIdx - 3).value;
+                samples[1][laneIdx] = getVoiceSample(voice, Voice::NUM_PREV_SAMPLES + curSampleIdx - 2).value;
+                samples[2][laneIdx] = getVoiceSample(voice, Voice::NUM_PREV_SAMPLES + curSampleIdx - 1).value;
+                samples[3][laneIdx] = getVoiceSample(voice, Voice::NUM_PREV_SAMPLES + curSampleIdx    ).value;
+                gaussFactors[0][laneIdx] = INTERP_GAUSS_TABLE_F[(255 - gaussTableIdx) & 0x1FF];
+                gaussFactors[1][laneIdx] = INTERP_GAUSS_TABLE_F[(511 - gaussTableIdx) & 0x1FF];
+                gaussFactors[2][laneIdx] = INTERP_GAUSS_TABLE_F[(256 + gaussTableIdx) & 0x1FF];
+                gaussFactors[3][laneIdx] = INTERP_GAUSS_TABLE_F[(      gaussTableIdx) & 0x1FF];
+
+                const Volume realVoiceVol = getRealVoiceVolume(voice);
+                envLevels[laneIdx] = toFloatSample(voice.envLevel);
+                volsL[laneIdx] = toFloatSample(realVoiceVol.left);
+                volsR[laneIdx] = toFloatSample(realVoiceVol.right);
+                reverbMasks[laneIdx] = (voice.bDoReverb) ? 1.0f : 0.0f;
+            }
+
+            endVoiceStep(voice, bHandleAdpcmFlags, adpcmFlags);
+        }
+
+        if (!bAnyVoiceActive)
+            break;
+
+        // Zero the inputs for any lanes which are not producing sound, so that no garbage (or NaNs) make it to the output
+        for (uint32_t laneIdx = 0; laneIdx < SIMD_VOICE_GROUP_SIZE; ++laneIdx) {
+            if (envLevels[laneIdx] == 0.0f) {
+                samples[0][laneIdx] = 0.0f; samples[1][laneIdx] = 0.0f; samples[2][laneIdx] = 0.0f; samples[3][laneIdx] = 0.0f;
+                gaussFactors[0][laneIdx] = 0.0f; gaussFactors[1][laneIdx] = 0.0f; gaussFactors[2][laneIdx] = 0.0f; gaussFactors[3][laneIdx] = 0.0f;
+                volsL[laneIdx] = 0.0f;
+                volsR[laneIdx] = 0.0f;
+                reverbMasks[laneIdx] = 0.0f;
+            }
+        }
 
-    for (int32_t voiceIdx = 0; voiceIdx < numVoices; ++voiceIdx) {
-        stepVoice(pVoices[voiceIdx], pRam, ramSize, output, outputToReverb);
+        // Do the gaussian interpolation and attenuation for all voices in the group at once
+        Float4 interpSamples = f4Mul(f4Load(samples[0]), f4Load(gaussFactors[0]));
+        interpSamples = f4Add(interpSamples, f4Mul(f4Load(samples[1]), f4Load(gaussFactors[1])));
+        interpSamples = f4Add(interpSamples, f4Mul(f4Load(samples[2]), f4Load(gaussFactors[2])));
+        interpSamples = f4Add(interpSamples, f4Mul(f4Load(samples[3]), f4Load(gaussFactors[3])));
+
+        const Float4 envScaledSamples = f4Mul(interpSamples, f4Load(envLevels));
+        const Float4 samplesL = f4Mul(envScaledSamples, f4Load(volsL));
+        const Float4 samplesR = f4Mul(envScaledSamples, f4Load(volsR));
+        const Float4 reverbMask = f4Load(reverbMasks);
+
+        pOutput[sampleIdx] += StereoSample{ f4Sum(samplesL), f4Sum(samplesR) };
+        pOutputToReverb[sampleIdx] += StereoSample{ f4Sum(f4Mul(samplesL, reverbMask)), f4Sum(f4Mul(samplesR, reverbMask)) };
     }
 }
+#endif  // #if SIMPLE_SPU_SSE2 || SIMPLE_SPU_NEON
+
+#if !(SIMPLE_SPU_SSE2 || SIMPLE_SPU_NEON)
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Process/update a single voice for a whole block of samples.
+// Adds the output of the voice (and the output to be reverberated) to the given sample buffers.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void stepVoiceBlock(
+    Voice& voice,
+    Core& core,
+    StereoSample* const pOutput,
+    StereoSample* const pOutputToReverb,
+    const uint32_t numSamples
+) noexcept {
+    // Voices can only be keyed on outside of the SPU update, so if the voice is off now then it will stay off for the entire block.
+    // Likewise if it switches off midway through the block then we can stop processing early.
+    for (uint32_t sampleIdx = 0; sampleIdx < numSamples; ++sampleIdx) {
+        if (voice.envPhase == EnvPhase::Off)
+            break;
+
+        stepVoice(voice, core, pOutput[sampleIdx], pOutputToReverb[sampleIdx]);
+    }
+}
+#endif  // #if !(SIMPLE_SPU_SSE2 || SIMPLE_SPU_NEON)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Process/update all voices and get 1 sample of output from them.
+// Only voices flagged as active are processed, and any voices which switch off are no longer flagged as active afterwards.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void stepVoices(
+    Core& core,
+    StereoSample& output,
+    StereoSample& outputToReverb
+) noexcept {
+    forEachActiveVoice(core, [&](const uint32_t voiceIdx) noexcept {
+        stepVoice(core.pVoices[voiceIdx], core, output, outputToReverb);
+    });
+
+    clearInactiveVoices(core);
+}
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Mixes sound from an external input; does nothing if there is no current external input
@@ -468,104 +822,168 @@ static void mixExternalInput(
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Add the given sample to reverb input and return a sample of reverb output
+// Recomputes the precomputed reverb tap positions for the core if the reverb registers or reverb work area location have changed
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void updateReverbTaps(Core& core) noexcept {
+    ReverbTaps& taps = core.reverbTaps;
+
+    const bool bTapsUpToDate = (
+        taps.bValid &&
+        (taps.reverbBaseAddr8 == core.reverbBaseAddr8) &&
+        (std::memcmp(&taps.reverbRegs, &core.reverbRegs, sizeof(ReverbRegs)) == 0)
+    );
+
+    if (bTapsUpToDate)
+        return;
+
+    taps.bValid = true;
+    taps.reverbRegs = core.reverbRegs;
+    taps.reverbBaseAddr8 = core.reverbBaseAddr8;
+
+    // Figure out the size of the work area.
+    // Note that for the float SPU reverb addresses are still specified in terms of the main SPU ram, so that we can use the original SPU reverb settings.
+    const uint32_t reverbBaseAddr = core.reverbBaseAddr8 * 8;
+
+    #if SIMPLE_SPU_FLOAT_SPU
+        taps.workAreaSize = std::min((core.ramSize - reverbBaseAddr) / 2, core.numReverbRamSamples);
+    #else
+        taps.workAreaSize = (core.ramSize - reverbBaseAddr) / 2;
+    #endif
+
+    // Get the real relative reverb addresses for each tap (need to x8 the register values).
+    // This is based almost exactly on: https://problemkaputt.de/psx-spx.htm#spureverbformula.
+    const ReverbRegs& regs = core.reverbRegs;
+    const auto setTapAddr = [&](const ReverbTap tap, const uint32_t addrOffset) noexcept {
+        taps.addrOffsets[(uint8_t) tap] = addrOffset;
+    };
+
+    setTapAddr(ReverbTap::LSame1,       (uint32_t) regs.addrLSame1 * 8);
+    setTapAddr(ReverbTap::RSame1,       (uint32_t) regs.addrRSame1 * 8);
+    setTapAddr(ReverbTap::LSame1Prev,   (uint32_t) regs.addrLSame1 * 8 - 2);
+    setTapAddr(ReverbTap::RSame1Prev,   (uint32_t) regs.addrRSame1 * 8 - 2);
+    setTapAddr(ReverbTap::LSame2,       (uint32_t) regs.addrLSame2 * 8);
+    setTapAddr(ReverbTap::RSame2,       (uint32_t) regs.addrRSame2 * 8);
+    setTapAddr(ReverbTap::LDiff1,       (uint32_t) regs.addrLDiff1 * 8);
+    setTapAddr(ReverbTap::RDiff1,       (uint32_t) regs.addrRDiff1 * 8);
+    setTapAddr(ReverbTap::LDiff1Prev,   (uint32_t) regs.addrLDiff1 * 8 - 2);
+    setTapAddr(ReverbTap::RDiff1Prev,   (uint32_t) regs.addrRDiff1 * 8 - 2);
+    setTapAddr(ReverbTap::LDiff2,       (uint32_t) regs.addrLDiff2 * 8);
+    setTapAddr(ReverbTap::RDiff2,       (uint32_t) regs.addrRDiff2 * 8);
+    setTapAddr(ReverbTap::LComb1,       (uint32_t) regs.addrLComb1 * 8);
+    setTapAddr(ReverbTap::LComb2,       (uint32_t) regs.addrLComb2 * 8);
+    setTapAddr(ReverbTap::LComb3,       (uint32_t) regs.addrLComb3 * 8);
+    setTapAddr(ReverbTap::LComb4,       (uint32_t) regs.addrLComb4 * 8);
+    setTapAddr(ReverbTap::RComb1,       (uint32_t) regs.addrRComb1 * 8);
+    setTapAddr(ReverbTap::RComb2,       (uint32_t) regs.addrRComb2 * 8);
+    setTapAddr(ReverbTap::RComb3,       (uint32_t) regs.addrRComb3 * 8);
+    setTapAddr(ReverbTap::RComb4,       (uint32_t) regs.addrRComb4 * 8);
+    setTapAddr(ReverbTap::LAPF1,        (uint32_t) regs.addrLAPF1 * 8);
+    setTapAddr(ReverbTap::RAPF1,        (uint32_t) regs.addrRAPF1 * 8);
+    setTapAddr(ReverbTap::LAPF1Src,     (uint32_t) regs.addrLAPF1 * 8 - (uint32_t) regs.dispAPF1 * 8);
+    setTapAddr(ReverbTap::RAPF1Src,     (uint32_t) regs.addrRAPF1 * 8 - (uint32_t) regs.dispAPF1 * 8);
+    setTapAddr(ReverbTap::LAPF2,        (uint32_t) regs.addrLAPF2 * 8);
+    setTapAddr(ReverbTap::RAPF2,        (uint32_t) regs.addrRAPF2 * 8);
+    setTapAddr(ReverbTap::LAPF2Src,     (uint32_t) regs.addrLAPF2 * 8 - (uint32_t) regs.dispAPF2 * 8);
+    setTapAddr(ReverbTap::RAPF2Src,     (uint32_t) regs.addrRAPF2 * 8 - (uint32_t) regs.dispAPF2 * 8);
+
+    // Convert the byte offsets to sample offsets: offsets which point backwards are negative and positive offsets get wrapped to the work area.
+    // Note that all of the byte offsets are even, and that backwards pointing offsets will have wrapped around when computed as unsigned.
+    // Also track the furthest that any tap points backwards, so that reverb processing knows when no tap can go past the start of the work area.
+    taps.maxBackOffset = 0;
+
+    for (uint32_t tapIdx = 0; tapIdx < NUM_REVERB_TAPS; ++tapIdx) {
+        const int32_t sampleOffset = (int32_t) taps.addrOffsets[tapIdx] / 2;
+        taps.sampleOffsets[tapIdx] = ((sampleOffset >= 0) && (taps.workAreaSize > 0)) ? sampleOffset % (int32_t) taps.workAreaSize : sampleOffset;
+        taps.maxBackOffset = (sampleOffset < 0) ? std::max(taps.maxBackOffset, (uint32_t) -sampleOffset) : taps.maxBackOffset;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Add the given sample to reverb input and return a sample of reverb output.
+// Uses the precomputed tap positions for the reverb work area, which must be up to date.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void doReverb(
 #if SIMPLE_SPU_FLOAT_SPU
     float* pReverbRam,
-    const uint32_t numReverbRamSamples,
 #else
     std::byte* pRam,
 #endif
-    const uint32_t ramSize,
     const uint32_t reverbBaseAddr8,
     uint32_t& reverbCurAddr,
     const Volume reverbVol,
     const bool bReverbWriteEnable,
     const ReverbRegs& reverbRegs,
+    const ReverbTaps& reverbTaps,
     const StereoSample reverbInput,
     StereoSample& reverbOutput
 ) noexcept {
-    // Helper: wrap an address to be within the reverb work area and guarantee that 16-bits (or a single float, for the float SPU) can be read safely.
-    // If there is no reverb work area (which should never be the case) then the address '0' is returned.
-    // Note that for the float SPU reverb addresses are still specified in terms of the main SPU ram, so that we can use the original SPU reverb settings.
+    // Get the current position within the reverb work area, relative to the start of the work area
     const uint32_t reverbBaseAddr = reverbBaseAddr8 * 8;
     const uint32_t reverbBaseAddr2 = reverbBaseAddr / 2;
-
-    #if SIMPLE_SPU_FLOAT_SPU
-        const uint32_t reverbWorkAreaSize2 = std::min((ramSize - reverbBaseAddr) / 2, numReverbRamSamples);
-    #else
-        const uint32_t reverbWorkAreaSize2 = (ramSize - reverbBaseAddr) / 2;
-    #endif
-
-    const auto wrapRevAddr16 = [=](uint32_t addr) noexcept -> uint32_t {
-        if (reverbWorkAreaSize2 > 0) {
-            const uint32_t addr2 = addr / 2;
-            const uint32_t relativeAddr2 = (addr2 - reverbBaseAddr2) % reverbWorkAreaSize2;
-
-            #if SIMPLE_SPU_FLOAT_SPU
-                // For the float SPU the reverb work area always starts at element '0' in reverb RAM
-                return relativeAddr2 * 2;
-            #else
-                return (reverbBaseAddr2 + relativeAddr2) * 2;
-            #endif
+    const uint32_t reverbWorkAreaSize2 = reverbTaps.workAreaSize;
+    const uint32_t reverbCurPos = reverbCurAddr / 2 - reverbBaseAddr2;
+
+    // Get the location of every tap in the reverb work area, relative to the start of the work area.
+    // Normally the current reverb position is within the work area (it is wrapped after each update) and far enough along that backwards pointing
+    // taps don't go past the start of the work area. In that case each tap needs at most a single wraparound. Otherwise (reverb settings changed
+    // or near the start of the work area) the tap addresses are all computed and wrapped the long way, preserving the exact unsigned wraparound
+    // behavior. If there is no reverb work area (which should never be the case) then all of the tap positions are '0'.
+    const bool bCurPosInWorkArea = (reverbCurPos < reverbWorkAreaSize2);
+    uint32_t tapPositions[NUM_REVERB_TAPS];
+
+    if (bCurPosInWorkArea && (reverbCurPos >= reverbTaps.maxBackOffset)) {
+        for (uint32_t tapIdx = 0; tapIdx < NUM_REVERB_TAPS; ++tapIdx) {
+            const uint32_t tapPos = reverbCurPos + (uint32_t) reverbTaps.sampleOffsets[tapIdx];
+            tapPositions[tapIdx] = (tapPos >= reverbWorkAreaSize2) ? tapPos - reverbWorkAreaSize2 : tapPos;
+        }
+    } else if (reverbWorkAreaSize2 > 0) {
+        for (uint32_t tapIdx = 0; tapIdx < NUM_REVERB_TAPS; ++tapIdx) {
+            const uint32_t addr2 = (reverbCurAddr + reverbTaps.addrOffsets[tapIdx]) / 2;
+            tapPositions[tapIdx] = (addr2 - reverbBaseAddr2) % reverbWorkAreaSize2;
         }
+    } else {
+        std::memset(tapPositions, 0, sizeof(tapPositions));
+    }
 
-        return 0;
+    const auto getTapPos = [&](const ReverbTap tap) noexcept -> uint32_t {
+        return tapPositions[(uint8_t) tap];
     };
 
-    // Helpers: read and write a 16-bit sample relative to the current reverb address.
-    // Wraps the read or write to be within the work area for reverb.
-    const auto revR = [=](uint32_t addrRelative) noexcept -> Sample {
-        const uint32_t addr = wrapRevAddr16(reverbCurAddr + addrRelative);
+    // Helpers: read and write a 16-bit sample (or a single float, for the float SPU) at a reverb tap.
+    // Note: for the float SPU the reverb work area always starts at element '0' in reverb RAM.
+    #if SIMPLE_SPU_FLOAT_SPU
+        const auto revR = [&](const ReverbTap tap) noexcept -> Sample {
+            return pReverbRam[getTapPos(tap)];
+        };
 
-        #if SIMPLE_SPU_FLOAT_SPU
-            return pReverbRam[addr / 2];
-        #else
+        const auto revW = [&](const ReverbTap tap, const Sample sample) noexcept {
+            if (bReverbWriteEnable) {
+                pReverbRam[getTapPos(tap)] = sample.value;
+            }
+        };
+    #else
+        const auto getTapAddr = [&](const ReverbTap tap) noexcept -> uint32_t {
+            return (reverbWorkAreaSize2 > 0) ? (reverbBaseAddr2 + getTapPos(tap)) * 2 : 0;
+        };
+
+        const auto revR = [&](const ReverbTap tap) noexcept -> Sample {
+            const uint32_t addr = getTapAddr(tap);
             const uint16_t data = (uint16_t) pRam[addr] | ((uint16_t) pRam[addr + 1] << 8);
             return (int16_t) data;
-        #endif
-    };
-
-    const auto revW = [=](uint32_t addrRelative, const Sample sample) noexcept {
-        if (bReverbWriteEnable) {
-            const uint32_t addr = wrapRevAddr16(reverbCurAddr + addrRelative);
+        };
 
-            #if SIMPLE_SPU_FLOAT_SPU
-                pReverbRam[addr / 2] = sample.value;
-            #else
+        const auto revW = [&](const ReverbTap tap, const Sample sample) noexcept {
+            if (bReverbWriteEnable) {
+                const uint32_t addr = getTapAddr(tap);
                 const uint16_t data = (uint16_t) sample;
                 pRam[addr] = (std::byte) data;
                 pRam[addr + 1] = (std::byte)(data >> 8);
-            #endif
-        }
-    };
+            }
+        };
+    #endif
 
     // This is based almost exactly on: https://problemkaputt.de/psx-spx.htm#spureverbformula.
-    // First grab all of the reverb inputs we will be dealing with and the real relative reverb addresses (need to x8 them).
-    const uint32_t addrLSame1   = (uint32_t) reverbRegs.addrLSame1 * 8;
-    const uint32_t addrLSame2   = (uint32_t) reverbRegs.addrLSame2 * 8;
-    const uint32_t addrRSame1   = (uint32_t) reverbRegs.addrRSame1 * 8;
-    const uint32_t addrRSame2   = (uint32_t) reverbRegs.addrRSame2 * 8;
-    const uint32_t addrLDiff1   = (uint32_t) reverbRegs.addrLDiff1 * 8;
-    const uint32_t addrLDiff2   = (uint32_t) reverbRegs.addrLDiff2 * 8;
-    const uint32_t addrRDiff1   = (uint32_t) reverbRegs.addrRDiff1 * 8;
-    const uint32_t addrRDiff2   = (uint32_t) reverbRegs.addrRDiff2 * 8;
-    const uint32_t addrLComb1   = (uint32_t) reverbRegs.addrLComb1 * 8;
-    const uint32_t addrLComb2   = (uint32_t) reverbRegs.addrLComb2 * 8;
-    const uint32_t addrLComb3   = (uint32_t) reverbRegs.addrLComb3 * 8;
-    const uint32_t addrLComb4   = (uint32_t) reverbRegs.addrLComb4 * 8;
-    const uint32_t addrRComb1   = (uint32_t) reverbRegs.addrRComb1 * 8;
-    const uint32_t addrRComb2   = (uint32_t) reverbRegs.addrRComb2 * 8;
-    const uint32_t addrRComb3   = (uint32_t) reverbRegs.addrRComb3 * 8;
-    const uint32_t addrRComb4   = (uint32_t) reverbRegs.addrRComb4 * 8;
-    const uint32_t addrLAPF1    = (uint32_t) reverbRegs.addrLAPF1 * 8;
-    const uint32_t addrLAPF2    = (uint32_t) reverbRegs.addrLAPF2 * 8;
-    const uint32_t addrRAPF1    = (uint32_t) reverbRegs.addrRAPF1 * 8;
-    const uint32_t addrRAPF2    = (uint32_t) reverbRegs.addrRAPF2 * 8;
-    const uint32_t dispAPF1     = (uint32_t) reverbRegs.dispAPF1 * 8;
-    const uint32_t dispAPF2     = (uint32_t) reverbRegs.dispAPF2 * 8;
-
+    // First grab all of the reverb volumes we will be dealing with.
     const int16_t volWall   = reverbRegs.volWall;
     const int16_t volIIR    = reverbRegs.volIIR;
     const int16_t volComb1  = reverbRegs.volComb1;
@@ -579,69 +997,139 @@ static void doReverb(
     const Sample inputL = reverbInput.left * reverbRegs.volLIn;
     const Sample inputR = reverbInput.right * reverbRegs.volRIn;
 
-    // Same side reflection (left-to-left and right-to-right)
+    // Same side reflection (left-to-left and right-to-right) and different side reflection (left-to-right and right-to-left).
+    //
+    // SIMD version: do all 4 reflections at once. Note that the different side reflection reads happen before the same side reflection writes
+    // here, so this can only be done if none of the different side reflection reads are from where the same side reflections are written.
+    bool bDidReflections = false;
+
+    #if SIMPLE_SPU_SSE2 || SIMPLE_SPU_NEON
     {
-        const Sample l1 = revR(addrLSame2);
-        const Sample r1 = revR(addrRSame2);
-        const Sample l2 = revR(addrLSame1 - 2);
-        const Sample r2 = revR(addrRSame1 - 2);
+        const uint32_t lSame1Pos = getTapPos(ReverbTap::LSame1);
+        const uint32_t rSame1Pos = getTapPos(ReverbTap::RSame1);
+        const uint32_t lDiff1Pos = getTapPos(ReverbTap::LDiff1);
+        const uint32_t rDiff1Pos = getTapPos(ReverbTap::RDiff1);
+        const uint32_t lDiff1PrevPos = getTapPos(ReverbTap::LDiff1Prev);
+        const uint32_t rDiff1PrevPos = getTapPos(ReverbTap::RDiff1Prev);
+        const uint32_t lDiff2Pos = getTapPos(ReverbTap::LDiff2);
+        const uint32_t rDiff2Pos = getTapPos(ReverbTap::RDiff2);
+
+        const auto isSameSideWritePos = [=](const uint32_t pos) noexcept {
+            return ((pos == lSame1Pos) || (pos == rSame1Pos));
+        };
+
+        const bool bReflectionsIndependent = (
+            (!bReverbWriteEnable) || (
+                (!isSameSideWritePos(lDiff1PrevPos)) && (!isSameSideWritePos(rDiff1PrevPos)) &&
+                (!isSameSideWritePos(lDiff2Pos)) && (!isSameSideWritePos(rDiff2Pos))
+            )
+        );
+
+        if (bReflectionsIndependent) {
+            const Float4 input = f4Set(inputL, inputR, inputL, inputR);
+            const Float4 reflectIn = f4Set(revR(ReverbTap::LSame2), revR(ReverbTap::RSame2), pReverbRam[rDiff2Pos], pReverbRam[lDiff2Pos]);
+            const Float4 prevOut = f4Set(revR(ReverbTap::LSame1Prev), revR(ReverbTap::RSame1Prev), pReverbRam[lDiff1PrevPos], pReverbRam[rDiff1PrevPos]);
+            const Float4 volWallF = f4Set(toFloatSample(volWall), toFloatSample(volWall), toFloatSample(volWall), toFloatSample(volWall));
+            const Float4 volIIRF = f4Set(toFloatSample(volIIR), toFloatSample(volIIR), toFloatSample(volIIR), toFloatSample(volIIR));
+
+            alignas(16) float reflections[4];
+            f4Store(reflections, f4Add(f4Mul(f4Sub(f4Add(input, f4Mul(reflectIn, volWallF)), prevOut), volIIRF), prevOut));
+
+            if (bReverbWriteEnable) {
+                pReverbRam[lSame1Pos] = reflections[0];     // Left to left
+                pReverbRam[rSame1Pos] = reflections[1];     // Right to right
+                pReverbRam[lDiff1Pos] = reflections[2];     // Right to left
+                pReverbRam[rDiff1Pos] = reflections[3];     // Left to right
+            }
 
-        revW(addrLSame1, (inputL + l1 * volWall - l2) * volIIR + l2);   // Left to left
-        revW(addrRSame1, (inputR + r1 * volWall - r2) * volIIR + r2);   // Right to right
+            bDidReflections = true;
+        }
     }
+    #endif
 
-    // Different side reflection (left-to-right and right-to-left)
-    {
-        const Sample l1 = revR(addrLDiff2);
-        const Sample r1 = revR(addrRDiff2);
-        const Sample l2 = revR(addrLDiff1 - 2);
-        const Sample r2 = revR(addrRDiff1 - 2);
+    if (!bDidReflections) {
+        // Same side reflection (left-to-left and right-to-right)
+        {
+            const Sample l1 = revR(ReverbTap::LSame2);
+            const Sample r1 = revR(ReverbTap::RSame2);
+            const Sample l2 = revR(ReverbTap::LSame1Prev);
+            const Sample r2 = revR(ReverbTap::RSame1Prev);
 
-        revW(addrLDiff1, (inputL + r1 * volWall - l2) * volIIR + l2);   // Right to left
-        revW(addrRDiff1, (inputR + l1 * volWall - r2) * volIIR + r2);   // Left to right
+            revW(ReverbTap::LSame1, (inputL + l1 * volWall - l2) * volIIR + l2);   // Left to left
+            revW(ReverbTap::RSame1, (inputR + r1 * volWall - r2) * volIIR + r2);   // Right to right
+        }
+
+        // Different side reflection (left-to-right and right-to-left)
+        {
+            const Sample l1 = revR(ReverbTap::LDiff2);
+            const Sample r1 = revR(ReverbTap::RDiff2);
+            const Sample l2 = revR(ReverbTap::LDiff1Prev);
+            const Sample r2 = revR(ReverbTap::RDiff1Prev);
+
+            revW(ReverbTap::LDiff1, (inputL + r1 * volWall - l2) * volIIR + l2);   // Right to left
+            revW(ReverbTap::RDiff1, (inputR + l1 * volWall - r2) * volIIR + r2);   // Left to right
+        }
     }
 
     // Early echo (comb filter, with input from buffer)
     Sample outL;
     Sample outR;
 
-    outL = (
-        revR(addrLComb1) * volComb1 +
-        revR(addrLComb2) * volComb2 +
-        revR(addrLComb3) * volComb3 +
-        revR(addrLComb4) * volComb4
-    );
+    #if SIMPLE_SPU_SSE2 || SIMPLE_SPU_NEON
+        // SIMD version: do both comb filters as 4 element dot products.
+        // Note that the all pass filter stages are not vectorized because they read back values written to the work area by the previous stage.
+        const Float4 volCombs = f4Set(toFloatSample(volComb1), toFloatSample(volComb2), toFloatSample(volComb3), toFloatSample(volComb4));
+        const Float4 combL = f4Set(revR(ReverbTap::LComb1), revR(ReverbTap::LComb2), revR(ReverbTap::LComb3), revR(ReverbTap::LComb4));
+        const Float4 combR = f4Set(revR(ReverbTap::RComb1), revR(ReverbTap::RComb2), revR(ReverbTap::RComb3), revR(ReverbTap::RComb4));
+        outL = f4Sum(f4Mul(combL, volCombs));
+        outR = f4Sum(f4Mul(combR, volCombs));
+    #else
+        outL = (
+            revR(ReverbTap::LComb1) * volComb1 +
+            revR(ReverbTap::LComb2) * volComb2 +
+            revR(ReverbTap::LComb3) * volComb3 +
+            revR(ReverbTap::LComb4) * volComb4
+        );
 
-    outR = (
-        revR(addrRComb1) * volComb1 +
-        revR(addrRComb2) * volComb2 +
-        revR(addrRComb3) * volComb3 +
-        revR(addrRComb4) * volComb4
-    );
+        outR = (
+            revR(ReverbTap::RComb1) * volComb1 +
+            revR(ReverbTap::RComb2) * volComb2 +
+            revR(ReverbTap::RComb3) * volComb3 +
+            revR(ReverbTap::RComb4) * volComb4
+        );
+    #endif
 
     // Late reverb APF1 (all pass filter 1, with input from COMB)
-    outL = outL - revR(addrLAPF1 - dispAPF1) * volAPF1;
-    revW(addrLAPF1, outL);
-    outL = outL * volAPF1 + revR(addrLAPF1 - dispAPF1);
+    outL = outL - revR(ReverbTap::LAPF1Src) * volAPF1;
+    revW(ReverbTap::LAPF1, outL);
+    outL = outL * volAPF1 + revR(ReverbTap::LAPF1Src);
 
-    outR = outR - revR(addrRAPF1 - dispAPF1) * volAPF1;
-    revW(addrRAPF1, outR);
-    outR = outR * volAPF1 + revR(addrRAPF1 - dispAPF1);
+    outR = outR - revR(ReverbTap::RAPF1Src) * volAPF1;
+    revW(ReverbTap::RAPF1, outR);
+    outR = outR * volAPF1 + revR(ReverbTap::RAPF1Src);
 
     // Late reverb APF2 (all pass filter 2, with input from APF1)
-    outL = outL - revR(addrLAPF2 - dispAPF2) * volAPF2;
-    revW(addrLAPF2, outL);
-    outL = outL * volAPF2 + revR(addrLAPF2 - dispAPF2);
+    outL = outL - revR(ReverbTap::LAPF2Src) * volAPF2;
+    revW(ReverbTap::LAPF2, outL);
+    outL = outL * volAPF2 + revR(ReverbTap::LAPF2Src);
+
+    outR = outR - revR(ReverbTap::RAPF2Src) * volAPF2;
+    revW(ReverbTap::RAPF2, outR);
+    outR = outR * volAPF2 + revR(ReverbTap::RAPF2Src);
+
+    // Move along the reverb address for the next update by 1 16-bit sample, wrapping to the work area
+    uint32_t nextReverbPos = 0;
 
-    outR = outR - revR(addrRAPF2 - dispAPF2) * volAPF2;
-    revW(addrRAPF2, outR);
-    outR = outR * volAPF2 + revR(addrRAPF2 - dispAPF2);
+    if (bCurPosInWorkArea) {
+        nextReverbPos = (reverbCurPos + 1 < reverbWorkAreaSize2) ? reverbCurPos + 1 : 0;
+    } else if (reverbWorkAreaSize2 > 0) {
+        nextReverbPos = ((reverbCurAddr + 2) / 2 - reverbBaseAddr2) % reverbWorkAreaSize2;
+    }
 
-    // Move along the reverb address for the next update by 1 16-bit sample
     #if SIMPLE_SPU_FLOAT_SPU
-        reverbCurAddr = reverbBaseAddr + wrapRevAddr16(reverbCurAddr + 2);  // 'wrapRevAddr16' returns the address starting from '0' for the float SPU, need to fix up
+        reverbCurAddr = reverbBaseAddr + nextReverbPos * 2;
     #else
-        reverbCurAddr = wrapRevAddr16(reverbCurAddr + 2);
+        reverbCurAddr = (reverbWorkAreaSize2 > 0) ? (reverbBaseAddr2 + nextReverbPos) * 2 : 0;
     #endif
 
     // Scale and return the reverb output
@@ -691,6 +1179,9 @@ void doMasterMix(
         for (uint32_t i = 0; i < voiceCount; ++i) {
             core.pVoices[i] = {};
         }
+
+        // No voices are active initially, since all voices start off with their envelopes switched off
+        core.pActiveVoiceMask = new uint64_t[(voiceCount + 63) / 64]();
     }
 
     // Note: pad RAM size to the nearest 16-bytes to ensure the 8-byte addressing mode of the SPU always works.
@@ -716,25 +1207,66 @@ void Spu::destroyCore(Core& core) noexcept {
         delete[] core.pReverbRam;
     #endif
 
+    delete[] core.pAdpcmCache;
+
+    delete[] core.pActiveVoiceMask;
     delete[] core.pVoices;
     delete[] core.pRam;
     core = {};
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Start playing the given voice
+// Enables caching of decoded ADPCM blocks with the given number of cache entries, which must be a power of two.
+// Passing '0' entries disables the cache.
 //------------------------------------------------------------------------------------------------------------------------------------------
-StereoSample Spu::stepCore(Core& core) noexcept {
-    // Process all voices firstly and silence the output if we are not unmuted
-    StereoSample output = {};
-    StereoSample outputToReverb = {};
-    stepVoices(core.pVoices, core.numVoices, core.pRam, core.ramSize, output, outputToReverb);
+void Spu::setAdpcmCacheSize(Core& core, const uint32_t numEntries) noexcept {
+    ASSERT((numEntries & (numEntries - 1)) == 0);
 
-    if (!core.bUnmute) {
-        output = {};
-        outputToReverb = {};
+    delete[] core.pAdpcmCache;
+    core.pAdpcmCache = nullptr;
+    core.adpcmCacheSize = 0;
+
+    if (numEntries > 0) {
+        core.pAdpcmCache = new AdpcmCacheEntry[numEntries]();
+        core.adpcmCacheSize = numEntries;
     }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Invalidates any cached decoded ADPCM blocks which overlap the given range of SPU RAM.
+// This must be called whenever SPU RAM is modified outside of the SPU core.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Spu::invalidateAdpcmCache(Core& core, const uint32_t startAddr, const uint32_t numBytes) noexcept {
+    if ((!core.pAdpcmCache) || (numBytes == 0))
+        return;
+
+    // Get the range of block addresses (in 8 byte units) that could overlap the modified range: blocks can start on any 8 byte boundary
+    const uint32_t startAddr8 = (startAddr >= ADPCM_BLOCK_SIZE) ? (startAddr - ADPCM_BLOCK_SIZE + 8) / 8 : 0;
+    const uint32_t endAddr8 = (startAddr + numBytes + 7) / 8;
+
+    // If the range covers more block addresses than there are cache entries then just clear the entire cache, it's faster
+    if (endAddr8 - startAddr8 >= core.adpcmCacheSize * 2) {
+        for (uint32_t entryIdx = 0; entryIdx < core.adpcmCacheSize; ++entryIdx) {
+            core.pAdpcmCache[entryIdx].adpcmAddr8Plus1 = 0;
+        }
+
+        return;
+    }
+
+    for (uint32_t addr8 = startAddr8; addr8 < endAddr8; ++addr8) {
+        AdpcmCacheEntry& entry = core.pAdpcmCache[getAdpcmCacheSlot(core, addr8)];
 
+        if (entry.adpcmAddr8Plus1 == addr8 + 1) {
+            entry.adpcmAddr8Plus1 = 0;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Mixes in external input, does reverb processing and does the final master mix for a single sample of voice output.
+// Also advances the cycle count of the SPU and returns the final output sample.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static StereoSample finishCoreStep(Core& core, StereoSample output, StereoSample outputToReverb) noexcept {
     // Mix any external input
     if (core.bExtEnabled) {
         mixExternalInput(
@@ -749,19 +1281,19 @@ StereoSample Spu::stepCore(Core& core) noexcept {
 
     // Do reverb every 2 cycles: PSX reverb operates at 22,050 Hz and the SPU operates at 44,100 Hz
     if ((core.cycleCount & 1) == 0) {
+        updateReverbTaps(core);
         doReverb(
         #if SIMPLE_SPU_FLOAT_SPU
             core.pReverbRam,
-            core.numReverbRamSamples,
         #else
             core.pRam,
         #endif
-            core.ramSize,
             core.reverbBaseAddr8,
             core.reverbCurAddr,
             core.reverbVol,
             core.bReverbWriteEnable,
             core.reverbRegs,
+            core.reverbTaps,
             outputToReverb,
             core.processedReverb
         );
@@ -774,36 +1306,259 @@ StereoSample Spu::stepCore(Core& core) noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Start playing the given voice
+// Step the SPU core by a single cycle and return the sample that was generated
 //------------------------------------------------------------------------------------------------------------------------------------------
-void Spu::keyOn(Voice& voice) noexcept {
-    // Jump to the sample start address and flag that we need to load samples
-    voice.bSamplesLoaded = false;
-    voice.adpcmBlockPos = {};
-    voice.adpcmCurAddr8 = voice.adpcmStartAddr8;
+StereoSample Spu::stepCore(Core& core) noexcept {
+    // Process all voices firstly and silence the output if we are not unmuted
+    StereoSample output = {};
+    StereoSample outputToReverb = {};
+    stepVoices(core, output, outputToReverb);
 
-    // Initialize the envelope
-    voice.envPhase = EnvPhase::Attack;
-    voice.envLevel = 0;
-    voice.envWaitCycles = 0;
+    if (!core.bUnmute) {
+        output = {};
+        outputToReverb = {};
+    }
 
-    // Initialize flags
-    voice.bReachedLoopEnd = false;
-    voice.bRepeat = false;
+    return finishCoreStep(core, output, outputToReverb);
+}
 
-    // Zero the 3 previous samples used for interpolation and previous 2 samples used for ADPCM decoding
-    static_assert(Voice::NUM_PREV_SAMPLES == 3);
-    voice.samples[0] = {};
-    voice.samples[1] = {};
-    voice.samples[2] = {};
-    voice.samples[Voice::SAMPLE_BUFFER_SIZE - 2] = {};
-    voice.samples[Voice::SAMPLE_BUFFER_SIZE - 1] = {};
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Step the SPU core by the given number of cycles and save the generated samples to the given output buffer.
+// Produces the same output as calling 'stepCore' repeatedly, but processes each voice across a whole block of samples at a time.
+// The voice mixing is done first for each block, then external input mixing, reverb and master mixing is done in a separate pass.
+// Note: for the 16-bit SPU, voices playing from the reverb work area (which is in SPU RAM) will see reverb writes one block later.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Spu::stepCoreBlock(Core& core, StereoSample* const pOutput, const uint32_t numSamples) noexcept {
+    ASSERT(pOutput || (numSamples == 0));
+
+    // Scratch buffers holding the voice output and output to reverb for the current block of samples
+    StereoSample voiceOutput[MAX_STEP_BLOCK_SIZE];
+    StereoSample voiceOutputToReverb[MAX_STEP_BLOCK_SIZE];
+
+    for (uint32_t blockStartIdx = 0; blockStartIdx < numSamples; blockStartIdx += MAX_STEP_BLOCK_SIZE) {
+        const uint32_t blockSize = std::min<uint32_t>(numSamples - blockStartIdx, MAX_STEP_BLOCK_SIZE);
+
+        // Process all voices across the entire block first
+        std::fill_n(voiceOutput, blockSize, StereoSample{});
+        std::fill_n(voiceOutputToReverb, blockSize, StereoSample{});
+
+        // Only the voices flagged as active need to be processed.
+        // For SIMD mixing the active voices are packed together into groups, regardless of where they are in the voice list.
+        #if SIMPLE_SPU_SSE2 || SIMPLE_SPU_NEON
+            Voice* voiceGroup[SIMD_VOICE_GROUP_SIZE];
+            uint32_t groupSize = 0;
+
+            forEachActiveVoice(core, [&](const uint32_t voiceIdx) noexcept {
+                voiceGroup[groupSize++] = &core.pVoices[voiceIdx];
+
+                if (groupSize == SIMD_VOICE_GROUP_SIZE) {
+                    stepVoiceGroupBlock(voiceGroup, groupSize, core, voiceOutput, voiceOutputToReverb, blockSize);
+                    groupSize = 0;
+                }
+            });
+
+            if (groupSize > 0) {
+                stepVoiceGroupBlock(voiceGroup, groupSize, core, voiceOutput, voiceOutputToReverb, blockSize);
+            }
+        #else
+            forEachActiveVoice(core, [&](const uint32_t voiceIdx) noexcept {
+                stepVoiceBlock(core.pVoices[voiceIdx], core, voiceOutput, voiceOutputToReverb, blockSize);
+            });
+        #endif
+
+        clearInactiveVoices(core);
+
+        // Silence the voice output if we are not unmuted
+        if (!core.bUnmute) {
+            std::fill_n(voiceOutput, blockSize, StereoSample{});
+            std::fill_n(voiceOutputToReverb, blockSize, StereoSample{});
+        }
+
+        // Do external input mixing, reverb and the final mix for each sample in the block
+        StereoSample* const pBlockOutput = pOutput + blockStartIdx;
+
+        for (uint32_t sampleIdx = 0; sampleIdx < blockSize; ++sampleIdx) {
+            pBlockOutput[sampleIdx] = finishCoreStep(core, voiceOutput[sampleIdx], voiceOutputToReverb[sampleIdx]);
+        }
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Puts the given voice into release mode
+// Start playing or put into release mode the specified voice of the core.
+// Either of these makes the voice active again, since the voice's envelope will no longer be switched off.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void Spu::keyOff(Voice& voice) noexcept {
-    voice.envPhase = EnvPhase::Release;
-    voice.envWaitCycles = 0;
+void Spu::keyOn(Core& core, const uint32_t voiceIdx) noexcept {
+    ASSERT(voiceIdx < core.numVoices);
+    keyOnVoice(core.pVoices[voiceIdx]);
+    core.pActiveVoiceMask[voiceIdx / 64] |= (uint64_t) 1 << (voiceIdx % 64);
+}
+
+void Spu::keyOff(Core& core, const uint32_t voiceIdx) noexcept {
+    ASSERT(voiceIdx < core.numVoices);
+    keyOffVoice(core.pVoices[voiceIdx]);
+    core.pActiveVoiceMask[voiceIdx / 64] |= (uint64_t) 1 << (voiceIdx % 64);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initializes a queue of SPU commands with the given capacity, which must be a power of two
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Spu::initCmdQueue(CmdQueue& queue, const uint32_t capacity) noexcept {
+    ASSERT((capacity > 0) && ((capacity & (capacity - 1)) == 0));
+
+    queue.pCmds = new Cmd[capacity];
+    queue.capacity = capacity;
+    queue.writeIdx = 0;
+    queue.readIdx = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees the memory used by a queue of SPU commands
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Spu::destroyCmdQueue(CmdQueue& queue) noexcept {
+    delete[] queue.pCmds;
+    queue.pCmds = nullptr;
+    queue.capacity = 0;
+    queue.writeIdx = 0;
+    queue.readIdx = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Try to add a command to the queue; this must only be called by the producer thread.
+// Returns 'false' if the queue is full, otherwise saves the sequence number of the command and returns 'true'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool Spu::tryEnqueueCmd(CmdQueue& queue, const Cmd& cmd, uint32_t& cmdSeqNum) noexcept {
+    const uint32_t writeIdx = queue.writeIdx.load(std::memory_order_relaxed);
+    const uint32_t readIdx = queue.readIdx.load(std::memory_order_acquire);
+
+    if (writeIdx - readIdx >= queue.capacity)
+        return false;
+
+    queue.pCmds[writeIdx & (queue.capacity - 1)] = cmd;
+    queue.writeIdx.store(writeIdx + 1, std::memory_order_release);
+    cmdSeqNum = writeIdx;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the command with the given sequence number has not been executed yet
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool Spu::isCmdPending(const CmdQueue& queue, const uint32_t cmdSeqNum) noexcept {
+    const uint32_t readIdx = queue.readIdx.load(std::memory_order_acquire);
+    return ((int32_t)(cmdSeqNum - readIdx) >= 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Executes a single command from a command queue against the given SPU core
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void executeCmd(Core& core, const Cmd& cmd) noexcept {
+    // Ignore voice commands for voices that don't exist
+    Voice* const pVoice = (cmd.voiceIdx < core.numVoices) ? &core.pVoices[cmd.voiceIdx] : nullptr;
+    const bool bIsVoiceCmd = (cmd.type <= CmdType::VoiceKeyOff);
+
+    if (bIsVoiceCmd && (!pVoice))
+        return;
+
+    switch (cmd.type) {
+        case CmdType::VoiceSampleRate:      pVoice->sampleRate = (uint16_t) cmd.value;                      break;
+        case CmdType::VoiceStartAddr8:      pVoice->adpcmStartAddr8 = cmd.value;                            break;
+        case CmdType::VoiceRepeatAddr8:     pVoice->adpcmRepeatAddr8 = cmd.value;                           break;
+        case CmdType::VoiceVolumeL:         pVoice->volume.left = (int16_t) cmd.value;                      break;
+        case CmdType::VoiceVolumeR:         pVoice->volume.right = (int16_t) cmd.value;                     break;
+        case CmdType::VoiceDoReverb:        pVoice->bDoReverb = (cmd.value != 0);                           break;
+        case CmdType::VoiceKeyOn:           keyOn(core, cmd.voiceIdx);                                      break;
+        case CmdType::VoiceKeyOff:          keyOff(core, cmd.voiceIdx);                                     break;
+        case CmdType::MasterVolL:           core.masterVol.left = (int16_t) cmd.value;                      break;
+        case CmdType::MasterVolR:           core.masterVol.right = (int16_t) cmd.value;                     break;
+        case CmdType::ReverbVolL:           core.reverbVol.left = (int16_t) cmd.value;                      break;
+        case CmdType::ReverbVolR:           core.reverbVol.right = (int16_t) cmd.value;                     break;
+        case CmdType::ExtInputVolL:         core.extInputVol.left = (int16_t) cmd.value;                    break;
+        case CmdType::ExtInputVolR:         core.extInputVol.right = (int16_t) cmd.value;                   break;
+        case CmdType::ExtEnabled:           core.bExtEnabled = (cmd.value != 0);                            break;
+        case CmdType::ExtReverbEnable:      core.bExtReverbEnable = (cmd.value != 0);                       break;
+        case CmdType::ReverbWriteEnable:    core.bReverbWriteEnable = (cmd.value != 0);                     break;
+        case CmdType::WaitUntilSample:                                                                      break;
+        case CmdType::None:                                                                                 break;
+
+        case CmdType::VoiceEnv: {
+            static_assert(sizeof(AdsrEnvelope) == sizeof(uint32_t));
+            std::memcpy(&pVoice->env, &cmd.value, sizeof(AdsrEnvelope));
+        }   break;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Executes the untimed commands in the given range of the queue, which follows a wait that is not yet due, so that commands which are not
+// sample timed (sound effects etc.) are not delayed along with the timed ones. An untimed command is held back however if it must stay
+// ordered after a command that is being held: one for the same voice, or any other non voice command in the case of non voice commands.
+// Commands which are executed are replaced with 'None' commands, since they must stay in the queue until the wait before them is done.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void executeUntimedCmdsAhead(Core& core, CmdQueue& queue, const uint32_t beginCmdIdx, const uint32_t endCmdIdx) noexcept {
+    // Which voices have commands being held: commands for voices beyond the ones tracked here are always held, to be safe
+    constexpr uint32_t MAX_TRACKED_VOICES = 256;
+    uint64_t heldVoiceBits[MAX_TRACKED_VOICES / 64] = {};
+    bool bHoldNonVoiceCmds = false;
+
+    for (uint32_t cmdIdx = beginCmdIdx; cmdIdx != endCmdIdx; ++cmdIdx) {
+        Cmd& cmd = queue.pCmds[cmdIdx & (queue.capacity - 1)];
+
+        if ((cmd.type == CmdType::WaitUntilSample) || (cmd.type == CmdType::None))
+            continue;
+
+        // Does this command need to be held because it is timed, or because it must stay ordered after another held command?
+        const bool bIsVoiceCmd = (cmd.type <= CmdType::VoiceKeyOff);
+        const bool bIsTrackedVoice = (cmd.voiceIdx < MAX_TRACKED_VOICES);
+        const uint64_t voiceBit = (bIsTrackedVoice) ? uint64_t(1) << (cmd.voiceIdx % 64) : 0;
+
+        const bool bHoldCmd = (bIsVoiceCmd) ?
+            (cmd.bTimed || (!bIsTrackedVoice) || (heldVoiceBits[cmd.voiceIdx / 64] & voiceBit)) :
+            (cmd.bTimed || bHoldNonVoiceCmds);
+
+        if (bHoldCmd) {
+            if (!bIsVoiceCmd) {
+                bHoldNonVoiceCmds = true;
+            } else if (bIsTrackedVoice) {
+                heldVoiceBits[cmd.voiceIdx / 64] |= voiceBit;
+            }
+
+            continue;
+        }
+
+        // Otherwise execute the command now and remove it from the queue
+        executeCmd(core, cmd);
+        cmd.type = CmdType::None;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Executes the commands in the queue against the given SPU core; this must only be called by the consumer thread.
+// Stops at the first 'WaitUntilSample' command that is not yet due for the given sample number (unless ignoring waits) and returns how
+// many samples away that command is. Untimed commands after the wait are still executed where possible (see 'executeUntimedCmdsAhead').
+// Returns 'UINT32_MAX' if all commands in the queue were executed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t Spu::executeCmds(Core& core, CmdQueue& queue, const uint32_t curSampleNum, const bool bIgnoreWaits) noexcept {
+    const uint32_t writeIdx = queue.writeIdx.load(std::memory_order_acquire);
+    const uint32_t readIdx = queue.readIdx.load(std::memory_order_relaxed);
+
+    for (uint32_t cmdIdx = readIdx; cmdIdx != writeIdx; ++cmdIdx) {
+        const Cmd& cmd = queue.pCmds[cmdIdx & (queue.capacity - 1)];
+
+        // Is this a wait for a sample that hasn't been reached yet? If so then stop here and leave the wait in the queue.
+        // Note: the sample numbers wrap around, so compare the signed difference.
+        if (cmd.type == CmdType::WaitUntilSample) {
+            const int32_t samplesUntilDue = (int32_t)(cmd.value - curSampleNum);
+
+            if ((samplesUntilDue > 0) && (!bIgnoreWaits)) {
+                executeUntimedCmdsAhead(core, queue, cmdIdx + 1, writeIdx);
+                queue.readIdx.store(cmdIdx, std::memory_order_release);
+                return (uint32_t) samplesUntilDue;
+            }
+
+            continue;
+        }
+
+        executeCmd(core, cmd);
+    }
+
+    queue.readIdx.store(writeIdx, std::memory_order_release);
+    return UINT32_MAX;
 }
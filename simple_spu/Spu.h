@@ -3,6 +3,7 @@
 #include "Macros.h"
 
 #include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <cstddef>
 
@@ -29,6 +30,7 @@ static constexpr int16_t    MIN_MASTER_VOLUME       = -0x3FFF;      // Minimum m
 static constexpr int16_t    MAX_MASTER_VOLUME       = +0x3FFF;      // Maximum master volume level (divided by 2)
 static constexpr int16_t    MIN_ENV_LEVEL           = 0;            // Minimum allowed envelope level
 static constexpr int16_t    MAX_ENV_LEVEL           = 0x7FFF;       // Maximum allowed envelope level
+static constexpr uint32_t   MAX_STEP_BLOCK_SIZE     = 256;          // Maximum number of samples processed at a time internally by 'stepCoreBlock'
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Flags read from the 2nd byte of a PSX ADPCM block.
@@ -391,6 +393,47 @@ struct Voice {
     Sample samples[SAMPLE_BUFFER_SIZE];
 };
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// An entry in the (optional) cache of decoded ADPCM blocks.
+// Since ADPCM decoding depends on the previous 2 samples decoded by a voice, these are also saved and must match for a cache hit.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct AdpcmCacheEntry {
+    uint32_t    adpcmAddr8Plus1;                        // Address of the ADPCM block (in 8 byte units) plus '1': '0' if the entry is unused
+    Sample      prevSamples[2];                         // The previous 2 samples (newest first) that the block was decoded with
+    uint8_t     adpcmFlags;                             // The ADPCM flags for the block
+    Sample      samples[ADPCM_BLOCK_NUM_SAMPLES];       // The decoded samples for the block
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reverb 'taps': each of the locations in the reverb work area that reverb processing reads from or writes to.
+// Positions are relative to the current reverb address and are determined by the reverb registers.
+//------------------------------------------------------------------------------------------------------------------------------------------
+enum class ReverbTap : uint8_t {
+    LSame1, RSame1, LSame1Prev, RSame1Prev, LSame2, RSame2,     // Same side reflection: 'Prev' is the sample before the 1st address
+    LDiff1, RDiff1, LDiff1Prev, RDiff1Prev, LDiff2, RDiff2,     // Different side reflection: 'Prev' is the sample before the 1st address
+    LComb1, LComb2, LComb3, LComb4,                             // Comb filter inputs: left
+    RComb1, RComb2, RComb3, RComb4,                             // Comb filter inputs: right
+    LAPF1, RAPF1, LAPF1Src, RAPF1Src,                           // All pass filter 1: 'Src' is the APF address minus the APF displacement
+    LAPF2, RAPF2, LAPF2Src, RAPF2Src,                           // All pass filter 2: 'Src' is the APF address minus the APF displacement
+};
+
+static constexpr uint32_t NUM_REVERB_TAPS = (uint32_t) ReverbTap::RAPF2Src + 1;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reverb tap positions precomputed from the reverb registers and the location and size of the reverb work area.
+// Saves having to compute and wrap every work area address for every reverb sample; these are recomputed by the SPU core automatically
+// whenever the reverb settings change and should not be modified outside of the core.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct ReverbTaps {
+    bool        bValid;                             // If 'false' then the taps need to be computed
+    ReverbRegs  reverbRegs;                         // The reverb registers the taps were computed for
+    uint32_t    reverbBaseAddr8;                    // Start address of the reverb work area the taps were computed for (in 8 byte units)
+    uint32_t    workAreaSize;                       // Size of the reverb work area in samples: 16-bit samples, or floats for the float SPU
+    uint32_t    addrOffsets[NUM_REVERB_TAPS];       // Byte offset of each tap from the current reverb address, as specified by the registers
+    int32_t     sampleOffsets[NUM_REVERB_TAPS];     // Sample offset of each tap from the current reverb position: wrapped to the work area if positive
+    uint32_t    maxBackOffset;                      // The largest number of samples that any tap points backwards from the current reverb position
+};
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // A callback which is invoked by the SPU to provide external input.
 // Can be used to mix in CD audio or anything else and run it through the reverb processing of the SPU.
@@ -410,6 +453,7 @@ struct Core {
 #endif
     Voice*              pVoices;                // Each of the hardware voices for the SPU
     uint32_t            numVoices;              // How many voices the core provides
+    uint64_t*           pActiveVoiceMask;       // 1 bit per voice (64 voices per element) set if the voice's envelope might not be switched off: only these voices are processed
     Volume              masterVol;              // Master volume. Note: expected to be from -0x3FFF to +0x3FFF.
     Volume              reverbVol;              // Reverb volume level
     Volume              extInputVol;            // External input volume (I'm using this for CD audio mixing)
@@ -424,6 +468,63 @@ struct Core {
     uint32_t            reverbCurAddr;          // Used for relative reads and writes to the reverb work area; continously incremented and wrapped as reverb is processed
     StereoSample        processedReverb;        // The processed reverb that is to be added into the final mix: only updated at 22,050 Hz instead of 44,100 Hz (every 2 SPU steps)
     ReverbRegs          reverbRegs;             // Registers with settings determining how reverb is processed: determines the type of reverb
+    ReverbTaps          reverbTaps;             // Reverb work area positions precomputed from the reverb settings above: updated automatically
+    AdpcmCacheEntry*    pAdpcmCache;            // Optional cache of decoded ADPCM blocks, indexed by block address: null if not caching
+    uint32_t            adpcmCacheSize;         // Number of entries in the ADPCM cache: always a power of two
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// The types of commands which can be submitted to the SPU via a command queue.
+// Each command sets a single SPU or voice register, or keys on or off a voice.
+// Note: commands which apply to a voice must all come first, up to and including 'VoiceKeyOff'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+enum class CmdType : uint8_t {
+    VoiceSampleRate,        // Set 'Voice::sampleRate'
+    VoiceStartAddr8,        // Set 'Voice::adpcmStartAddr8'
+    VoiceRepeatAddr8,       // Set 'Voice::adpcmRepeatAddr8'
+    VoiceEnv,               // Set 'Voice::env': the value is the raw bits of an 'AdsrEnvelope' (copied via memcpy)
+    VoiceVolumeL,           // Set 'Voice::volume.left'
+    VoiceVolumeR,           // Set 'Voice::volume.right'
+    VoiceDoReverb,          // Set 'Voice::bDoReverb'
+    VoiceKeyOn,             // Call 'keyOn' for the voice
+    VoiceKeyOff,            // Call 'keyOff' for the voice
+    MasterVolL,             // Set 'Core::masterVol.left'
+    MasterVolR,             // Set 'Core::masterVol.right'
+    ReverbVolL,             // Set 'Core::reverbVol.left'
+    ReverbVolR,             // Set 'Core::reverbVol.right'
+    ExtInputVolL,           // Set 'Core::extInputVol.left'
+    ExtInputVolR,           // Set 'Core::extInputVol.right'
+    ExtEnabled,             // Set 'Core::bExtEnabled'
+    ExtReverbEnable,        // Set 'Core::bExtReverbEnable'
+    ReverbWriteEnable,      // Set 'Core::bReverbWriteEnable'
+    WaitUntilSample,        // Don't execute any further timed commands until the consumer's sample clock reaches the given sample number
+    None,                   // Does nothing: an untimed command which was already executed ahead of a wait is replaced with this
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A command to be executed by the SPU
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct Cmd {
+    CmdType     type;           // What type of command this is
+    bool        bTimed;         // If set then the command is held by any 'WaitUntilSample' before it, otherwise it can execute ahead of waits
+    uint16_t    voiceIdx;       // Which voice the command applies to (if it's a voice command)
+    uint32_t    value;          // The value for the register being set (if it is a register command)
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A fixed size single producer, single consumer ring buffer of commands to be executed by the SPU.
+// Allows a thread to submit updates to the SPU without locking, while another thread (the consumer) executes them.
+//
+// Notes:
+//  (1) Only one thread can submit commands at a time, and only one thread can execute them at a time.
+//  (2) The read and write indexes are not wrapped; they are wrapped when used to access the ring buffer.
+//      Each index can be used as a sequence number for a particular command in the queue.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct CmdQueue {
+    Cmd*                    pCmds;          // The ring buffer of commands
+    uint32_t                capacity;       // Maximum number of commands in the queue: must be a power of two
+    std::atomic<uint32_t>   writeIdx;       // Index of the next command to be written: only changed by the producer thread
+    std::atomic<uint32_t>   readIdx;        // Index of the next command to be executed: only changed by the consumer thread
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -448,11 +549,35 @@ struct Core {
 
 void destroyCore(Core& core) noexcept;
 
-// Step the given SPU core
+// Step the given SPU core by a single sample, or by a block of samples (preferred, faster)
 StereoSample stepCore(Core& core) noexcept;
-
-// Key on or off the given SPU voice
-void keyOn(Voice& voice) noexcept;
-void keyOff(Voice& voice) noexcept;
+void stepCoreBlock(Core& core, StereoSample* const pOutput, const uint32_t numSamples) noexcept;
+
+// Setup the cache of decoded ADPCM blocks and invalidate parts of it.
+// The cache must be invalidated whenever SPU RAM is modified outside of the SPU core.
+void setAdpcmCacheSize(Core& core, const uint32_t numEntries) noexcept;
+void invalidateAdpcmCache(Core& core, const uint32_t startAddr, const uint32_t numBytes) noexcept;
+
+// Setup and teardown for a queue of SPU commands
+void initCmdQueue(CmdQueue& queue, const uint32_t capacity) noexcept;
+void destroyCmdQueue(CmdQueue& queue) noexcept;
+
+// Submit a command to the queue (producer thread only): returns 'false' if the queue is full.
+// If successful then the sequence number of the command is also returned.
+bool tryEnqueueCmd(CmdQueue& queue, const Cmd& cmd, uint32_t& cmdSeqNum) noexcept;
+
+// Tells if the command with the given sequence number has not yet been executed
+bool isCmdPending(const CmdQueue& queue, const uint32_t cmdSeqNum) noexcept;
+
+// Execute commands in the queue against the given SPU core (consumer thread only).
+// Execution stops at any 'WaitUntilSample' command which is not yet due at the given sample number, unless waits are being ignored.
+// Untimed commands after the wait are still executed, unless they must stay ordered after a timed command that is being held.
+// Returns the number of samples until the next command is due, or 'UINT32_MAX' if all commands were executed.
+uint32_t executeCmds(Core& core, CmdQueue& queue, const uint32_t curSampleNum, const bool bIgnoreWaits = false) noexcept;
+
+// Key on or off the given SPU voice.
+// Voices must be keyed on through these functions for the SPU core to know that they are active and need processing.
+void keyOn(Core& core, const uint32_t voiceIdx) noexcept;
+void keyOff(Core& core, const uint32_t voiceIdx) noexcept;
 
 END_NAMESPACE(Spu)
@@ -7,6 +7,16 @@
 #include "FileUtils.h"
 
 #include <algorithm>
+#include <cstring>
+
+// Which SIMD instruction set (if any) to use for finding the best ADPCM encoding for a block
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define VAG_UTILS_SSE2 1
+    #include <emmintrin.h>
+#elif defined(__ARM_NEON)
+    #define VAG_UTILS_NEON 1
+    #include <arm_neon.h>
+#endif
 
 BEGIN_NAMESPACE(AudioTools)
 BEGIN_NAMESPACE(VagUtils)
@@ -495,24 +505,21 @@ static void tryPsxAdpcmEncoding(
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Encode the given samples in the PlayStation's ADPCM format
+// Tries all combinations of ADPCM prediction filter and sample shift for a block of samples and returns the settings which give the lowest
+// encoding error. Also returns the encoded nibbles and the last 2 encoded samples for the best encoding. If several encodings have the same
+// error then the first one tried is chosen, trying filters in ascending order and then shifts in ascending order for each filter.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void encodePcmToPsxAdpcmBlock(
+[[maybe_unused]] static void findBestPsxAdpcmEncoding(
     const int16_t samples[ADPCM_BLOCK_NUM_SAMPLES],
     const int16_t prevSample1,
     const int16_t prevSample2,
-    const bool bLoopStartFlag,
-    const bool bLoopEndFlag,
-    const bool bRepeatFlag,
-    std::byte adpcmDataOut[ADPCM_BLOCK_SIZE],
+    uint32_t& bestSampleFilterOut,
+    uint32_t& bestSampleShiftOut,
+    uint8_t bestSampleNibblesOut[ADPCM_BLOCK_NUM_SAMPLES],
     int16_t& prevEncSampleOut1,
     int16_t& prevEncSampleOut2
 ) noexcept {
-    // Try various combinations of ADPCM encoding and sample shift adjust to find the best one
     uint64_t bestError = UINT64_MAX;
-    uint32_t bestSampleFilter = 0;
-    uint32_t bestSampleShift = 0;
-    uint8_t bestSampleNibbles[ADPCM_BLOCK_NUM_SAMPLES] = {};
 
     for (uint32_t sampleFilter = 0; sampleFilter <= 4; ++sampleFilter) {
         for (int32_t sampleShift = 0; sampleShift <= 12; ++sampleShift) {
@@ -537,9 +544,9 @@ void encodePcmToPsxAdpcmBlock(
             // Is this a better one? If so then remember it...
             if (error < bestError) {
                 bestError = error;
-                bestSampleFilter = sampleFilter;
-                bestSampleShift = sampleShift;
-                std::memcpy(bestSampleNibbles, sampleNibbles, sizeof(sampleNibbles));
+                bestSampleFilterOut = sampleFilter;
+                bestSampleShiftOut = sampleShift;
+                std::memcpy(bestSampleNibblesOut, sampleNibbles, sizeof(sampleNibbles));
 
                 // Save this for the caller, so it knows the last two encoded samples for the best encoding
                 prevEncSampleOut1 = lastEncSample1;
@@ -547,6 +554,257 @@ void encodePcmToPsxAdpcmBlock(
             }
         }
     }
+}
+
+#if VAG_UTILS_SSE2 || VAG_UTILS_NEON
+//------------------------------------------------------------------------------------------------------------------------------------------
+// All of the filter and shift combinations tried when encoding a block: 5 filters x 13 shifts.
+// The SIMD version of the search evaluates 4 of these at a time, with 1 combination per vector lane. The combination list is padded to
+// a multiple of 4 with copies of the last combination, and the results for the padding lanes are ignored.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr uint32_t NUM_ADPCM_ENCODINGS = 5 * 13;
+static constexpr uint32_t NUM_ADPCM_ENCODING_VECS = (NUM_ADPCM_ENCODINGS + 3) / 4;
+
+struct AdpcmEncodingParams {
+    int32_t     predictCoefPos[NUM_ADPCM_ENCODING_VECS * 4];    // Filter prediction co-efficient for the previous sample
+    int32_t     predictCoefNeg[NUM_ADPCM_ENCODING_VECS * 4];    // Filter prediction co-efficient for the sample before that
+    int32_t     adjustStep[NUM_ADPCM_ENCODING_VECS * 4];        // How much each nibble step changes a sample by: determined by the shift
+    float       adjustStepRcp[NUM_ADPCM_ENCODING_VECS * 4];     // 1.0 / 'adjustStep': an exact power of 2
+};
+
+static constexpr AdpcmEncodingParams buildAdpcmEncodingParams() noexcept {
+    AdpcmEncodingParams params = {};
+
+    for (uint32_t i = 0; i < NUM_ADPCM_ENCODING_VECS * 4; ++i) {
+        const uint32_t encodingIdx = std::min(i, NUM_ADPCM_ENCODINGS - 1);
+        const uint32_t sampleFilter = encodingIdx / 13;
+        const int32_t sampleShift = (int32_t)(encodingIdx % 13);
+
+        params.predictCoefPos[i] = ADPCM_PREDICT_COEF_POS[sampleFilter];
+        params.predictCoefNeg[i] = ADPCM_PREDICT_COEF_NEG[sampleFilter];
+        params.adjustStep[i] = 1 << (12 - sampleShift);
+        params.adjustStepRcp[i] = 1.0f / (float)(1 << (12 - sampleShift));
+    }
+
+    return params;
+}
+
+static constexpr AdpcmEncodingParams ADPCM_ENCODING_PARAMS = buildAdpcmEncodingParams();
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// SIMD version of 'findBestPsxAdpcmEncoding': gives exactly the same results, with 4 filter and shift combinations evaluated at once.
+//
+// Notes:
+//  (1) Dividing the prediction error by the adjust step (rounding towards zero) is done in floating point, since that allows a different
+//      step for each lane. The result is exact because the step is a power of 2 and the prediction error is well within the 24-bit range
+//      that a float can represent exactly.
+//  (2) Multiplying a nibble by the adjust step gives the same result as the 'SHIFT_NIBBLE_ENC_TABLE' lookup since the nibble is shifted
+//      left by 12 first, so the arithmetic right shift by the sample shift never discards any bits.
+//  (3) The error for each encoding is accumulated as 64-bit, like the scalar version.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void findBestPsxAdpcmEncodingSimd(
+    const int16_t samples[ADPCM_BLOCK_NUM_SAMPLES],
+    const int16_t prevSample1,
+    const int16_t prevSample2,
+    uint32_t& bestSampleFilterOut,
+    uint32_t& bestSampleShiftOut,
+    uint8_t bestSampleNibblesOut[ADPCM_BLOCK_NUM_SAMPLES],
+    int16_t& prevEncSampleOut1,
+    int16_t& prevEncSampleOut2
+) noexcept {
+    // The results of each encoding: nibbles (sign extended), the error and the last 2 encoded samples
+    alignas(16) int32_t encAdjustSteps[NUM_ADPCM_ENCODING_VECS][ADPCM_BLOCK_NUM_SAMPLES][4];
+    alignas(16) uint64_t encErrors[NUM_ADPCM_ENCODING_VECS * 4];
+    alignas(16) int32_t encPrevSamples1[NUM_ADPCM_ENCODING_VECS * 4];
+    alignas(16) int32_t encPrevSamples2[NUM_ADPCM_ENCODING_VECS * 4];
+
+    for (uint32_t vecIdx = 0; vecIdx < NUM_ADPCM_ENCODING_VECS; ++vecIdx) {
+        const uint32_t laneIdx = vecIdx * 4;
+
+        #if VAG_UTILS_SSE2
+            // The co-efficients are packed as 16-bit pairs, to match the pairs of previous samples: these get multiplied and summed via 'madd'
+            const __m128i predictCoefs = _mm_or_si128(
+                _mm_and_si128(_mm_loadu_si128((const __m128i*) &ADPCM_ENCODING_PARAMS.predictCoefPos[laneIdx]), _mm_set1_epi32(0xFFFF)),
+                _mm_slli_epi32(_mm_loadu_si128((const __m128i*) &ADPCM_ENCODING_PARAMS.predictCoefNeg[laneIdx]), 16)
+            );
+
+            const __m128i adjustStep = _mm_loadu_si128((const __m128i*) &ADPCM_ENCODING_PARAMS.adjustStep[laneIdx]);
+            const __m128 adjustStepRcp = _mm_loadu_ps(&ADPCM_ENCODING_PARAMS.adjustStepRcp[laneIdx]);
+            const __m128i lo16Mask = _mm_set1_epi32(0xFFFF);
+            const __m128i minSteps = _mm_set1_epi16(-8);
+            const __m128i maxSteps = _mm_set1_epi16(7);
+
+            // Previous samples: the most recent in the low 16-bits and the one before that in the high 16-bits
+            __m128i prevSamples = _mm_set1_epi32((int32_t)(((uint32_t)(uint16_t) prevSample1) | ((uint32_t)(uint16_t) prevSample2 << 16)));
+            __m128i errorEven = _mm_setzero_si128();    // 64-bit error for lanes 0 and 2
+            __m128i errorOdd = _mm_setzero_si128();     // 64-bit error for lanes 1 and 3
+
+            for (uint32_t sampleIdx = 0; sampleIdx < ADPCM_BLOCK_NUM_SAMPLES; ++sampleIdx) {
+                // Get the current sample and the prediction according to the filter, dividing by 64 and rounding towards zero
+                const __m128i realSample = _mm_set1_epi32(samples[sampleIdx]);
+                const __m128i predictSum = _mm_add_epi32(_mm_madd_epi16(prevSamples, predictCoefs), _mm_set1_epi32(32));
+                const __m128i predictBias = _mm_and_si128(_mm_srai_epi32(predictSum, 31), _mm_set1_epi32(63));
+                const __m128i predictedSample = _mm_srai_epi32(_mm_add_epi32(predictSum, predictBias), 6);
+                const __m128i predictionError = _mm_sub_epi32(realSample, predictedSample);
+
+                // Compute how many steps to adjust by to try and fix, clamped to the range of a 4-bit signed integer.
+                // Note: saturating to 16-bits first is fine since that doesn't affect the final clamped value.
+                const __m128i adjustStepsUnclamped = _mm_cvttps_epi32(_mm_mul_ps(_mm_cvtepi32_ps(predictionError), adjustStepRcp));
+                const __m128i adjustSteps16 = _mm_min_epi16(_mm_max_epi16(_mm_packs_epi32(adjustStepsUnclamped, adjustStepsUnclamped), minSteps), maxSteps);
+                const __m128i adjustSteps = _mm_srai_epi32(_mm_unpacklo_epi16(adjustSteps16, adjustSteps16), 16);
+                _mm_store_si128((__m128i*) encAdjustSteps[vecIdx][sampleIdx], adjustSteps);
+
+                // Compute the encoded sample and clamp to a 16-bit range.
+                // The multiply here only involves the low 16-bits of each lane since the adjust step has zero for the high 16-bits.
+                const __m128i encodedSampleUnclamped = _mm_add_epi32(predictedSample, _mm_madd_epi16(adjustSteps, adjustStep));
+                const __m128i encodedSample16 = _mm_packs_epi32(encodedSampleUnclamped, encodedSampleUnclamped);
+                const __m128i encodedSample = _mm_srai_epi32(_mm_unpacklo_epi16(encodedSample16, encodedSample16), 16);
+
+                // Save the sample we just encoded and shuffle backwards the last previous sample
+                prevSamples = _mm_or_si128(_mm_and_si128(encodedSample, lo16Mask), _mm_slli_epi32(prevSamples, 16));
+
+                // Update the error of this encoding: penalize heavily overflow
+                const __m128i encodingErrorSigned = _mm_sub_epi32(encodedSample, realSample);
+                const __m128i encodingErrorSign = _mm_srai_epi32(encodingErrorSigned, 31);
+                const __m128i encodingError = _mm_sub_epi32(_mm_xor_si128(encodingErrorSigned, encodingErrorSign), encodingErrorSign);
+                const __m128i overflowErrorSigned = _mm_sub_epi32(encodedSampleUnclamped, encodedSample);
+                const __m128i overflowErrorSign = _mm_srai_epi32(overflowErrorSigned, 31);
+                const __m128i overflowError = _mm_slli_epi32(_mm_sub_epi32(_mm_xor_si128(overflowErrorSigned, overflowErrorSign), overflowErrorSign), 6);
+
+                errorEven = _mm_add_epi64(errorEven, _mm_mul_epu32(encodingError, encodingError));
+                errorEven = _mm_add_epi64(errorEven, _mm_mul_epu32(overflowError, overflowError));
+
+                const __m128i encodingErrorOdd = _mm_srli_epi64(encodingError, 32);
+                const __m128i overflowErrorOdd = _mm_srli_epi64(overflowError, 32);
+                errorOdd = _mm_add_epi64(errorOdd, _mm_mul_epu32(encodingErrorOdd, encodingErrorOdd));
+                errorOdd = _mm_add_epi64(errorOdd, _mm_mul_epu32(overflowErrorOdd, overflowErrorOdd));
+            }
+
+            // Save the error and the last 2 encoded samples for each lane
+            alignas(16) uint64_t errorsEven[2];
+            alignas(16) uint64_t errorsOdd[2];
+            _mm_store_si128((__m128i*) errorsEven, errorEven);
+            _mm_store_si128((__m128i*) errorsOdd, errorOdd);
+
+            encErrors[laneIdx + 0] = errorsEven[0];
+            encErrors[laneIdx + 1] = errorsOdd[0];
+            encErrors[laneIdx + 2] = errorsEven[1];
+            encErrors[laneIdx + 3] = errorsOdd[1];
+
+            _mm_store_si128((__m128i*) &encPrevSamples1[laneIdx], _mm_srai_epi32(_mm_slli_epi32(prevSamples, 16), 16));
+            _mm_store_si128((__m128i*) &encPrevSamples2[laneIdx], _mm_srai_epi32(prevSamples, 16));
+        #else
+            const int32x4_t predictCoefPos = vld1q_s32(&ADPCM_ENCODING_PARAMS.predictCoefPos[laneIdx]);
+            const int32x4_t predictCoefNeg = vld1q_s32(&ADPCM_ENCODING_PARAMS.predictCoefNeg[laneIdx]);
+            const int32x4_t adjustStep = vld1q_s32(&ADPCM_ENCODING_PARAMS.adjustStep[laneIdx]);
+            const float32x4_t adjustStepRcp = vld1q_f32(&ADPCM_ENCODING_PARAMS.adjustStepRcp[laneIdx]);
+
+            int32x4_t prevSamples1 = vdupq_n_s32(prevSample1);
+            int32x4_t prevSamples2 = vdupq_n_s32(prevSample2);
+            uint64x2_t errorLo = vdupq_n_u64(0);    // 64-bit error for lanes 0 and 1
+            uint64x2_t errorHi = vdupq_n_u64(0);    // 64-bit error for lanes 2 and 3
+
+            for (uint32_t sampleIdx = 0; sampleIdx < ADPCM_BLOCK_NUM_SAMPLES; ++sampleIdx) {
+                // Get the current sample and the prediction according to the filter, dividing by 64 and rounding towards zero
+                const int32x4_t realSample = vdupq_n_s32(samples[sampleIdx]);
+                const int32x4_t predictSum = vaddq_s32(vmlaq_s32(vmulq_s32(prevSamples1, predictCoefPos), prevSamples2, predictCoefNeg), vdupq_n_s32(32));
+                const int32x4_t predictBias = vandq_s32(vshrq_n_s32(predictSum, 31), vdupq_n_s32(63));
+                const int32x4_t predictedSample = vshrq_n_s32(vaddq_s32(predictSum, predictBias), 6);
+                const int32x4_t predictionError = vsubq_s32(realSample, predictedSample);
+
+                // Compute how many steps to adjust by to try and fix, clamped to the range of a 4-bit signed integer
+                const int32x4_t adjustStepsUnclamped = vcvtq_s32_f32(vmulq_f32(vcvtq_f32_s32(predictionError), adjustStepRcp));
+                const int32x4_t adjustSteps = vminq_s32(vmaxq_s32(adjustStepsUnclamped, vdupq_n_s32(-8)), vdupq_n_s32(7));
+                vst1q_s32(encAdjustSteps[vecIdx][sampleIdx], adjustSteps);
+
+                // Compute the encoded sample and clamp to a 16-bit range
+                const int32x4_t encodedSampleUnclamped = vmlaq_s32(predictedSample, adjustSteps, adjustStep);
+                const int32x4_t encodedSample = vmovl_s16(vqmovn_s32(encodedSampleUnclamped));
+
+                // Save the sample we just encoded and shuffle backwards the last previous sample
+                prevSamples2 = prevSamples1;
+                prevSamples1 = encodedSample;
+
+                // Update the error of this encoding: penalize heavily overflow
+                const uint32x4_t encodingError = vreinterpretq_u32_s32(vabdq_s32(encodedSample, realSample));
+                const uint32x4_t overflowError = vshlq_n_u32(vreinterpretq_u32_s32(vabdq_s32(encodedSampleUnclamped, encodedSample)), 6);
+
+                errorLo = vmlal_u32(errorLo, vget_low_u32(encodingError), vget_low_u32(encodingError));
+                errorLo = vmlal_u32(errorLo, vget_low_u32(overflowError), vget_low_u32(overflowError));
+                errorHi = vmlal_u32(errorHi, vget_high_u32(encodingError), vget_high_u32(encodingError));
+                errorHi = vmlal_u32(errorHi, vget_high_u32(overflowError), vget_high_u32(overflowError));
+            }
+
+            // Save the error and the last 2 encoded samples for each lane
+            vst1q_u64(&encErrors[laneIdx + 0], errorLo);
+            vst1q_u64(&encErrors[laneIdx + 2], errorHi);
+            vst1q_s32(&encPrevSamples1[laneIdx], prevSamples1);
+            vst1q_s32(&encPrevSamples2[laneIdx], prevSamples2);
+        #endif
+    }
+
+    // Pick the best encoding, in the same order as the scalar version so that ties are resolved the same way
+    uint32_t bestEncodingIdx = 0;
+
+    for (uint32_t encodingIdx = 1; encodingIdx < NUM_ADPCM_ENCODINGS; ++encodingIdx) {
+        if (encErrors[encodingIdx] < encErrors[bestEncodingIdx]) {
+            bestEncodingIdx = encodingIdx;
+        }
+    }
+
+    bestSampleFilterOut = bestEncodingIdx / 13;
+    bestSampleShiftOut = bestEncodingIdx % 13;
+    prevEncSampleOut1 = (int16_t) encPrevSamples1[bestEncodingIdx];
+    prevEncSampleOut2 = (int16_t) encPrevSamples2[bestEncodingIdx];
+
+    for (uint32_t sampleIdx = 0; sampleIdx < ADPCM_BLOCK_NUM_SAMPLES; ++sampleIdx) {
+        bestSampleNibblesOut[sampleIdx] = ((uint8_t) encAdjustSteps[bestEncodingIdx / 4][sampleIdx][bestEncodingIdx % 4]) & 0x0Fu;
+    }
+}
+#endif  // #if VAG_UTILS_SSE2 || VAG_UTILS_NEON
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Encode the given samples in the PlayStation's ADPCM format
+//------------------------------------------------------------------------------------------------------------------------------------------
+void encodePcmToPsxAdpcmBlock(
+    const int16_t samples[ADPCM_BLOCK_NUM_SAMPLES],
+    const int16_t prevSample1,
+    const int16_t prevSample2,
+    const bool bLoopStartFlag,
+    const bool bLoopEndFlag,
+    const bool bRepeatFlag,
+    std::byte adpcmDataOut[ADPCM_BLOCK_SIZE],
+    int16_t& prevEncSampleOut1,
+    int16_t& prevEncSampleOut2
+) noexcept {
+    // Find the combination of ADPCM prediction filter and sample shift which gives the best encoding
+    uint32_t bestSampleFilter = 0;
+    uint32_t bestSampleShift = 0;
+    uint8_t bestSampleNibbles[ADPCM_BLOCK_NUM_SAMPLES] = {};
+
+    #if VAG_UTILS_SSE2 || VAG_UTILS_NEON
+        findBestPsxAdpcmEncodingSimd(samples, prevSample1, prevSample2, bestSampleFilter, bestSampleShift, bestSampleNibbles, prevEncSampleOut1, prevEncSampleOut2);
+
+        // Debug: verify the SIMD search picked exactly the same encoding as the scalar version
+        #if ASSERTS_ENABLED
+        {
+            uint32_t refSampleFilter = 0;
+            uint32_t refSampleShift = 0;
+            uint8_t refSampleNibbles[ADPCM_BLOCK_NUM_SAMPLES] = {};
+            int16_t refPrevEncSample1 = {};
+            int16_t refPrevEncSample2 = {};
+            findBestPsxAdpcmEncoding(samples, prevSample1, prevSample2, refSampleFilter, refSampleShift, refSampleNibbles, refPrevEncSample1, refPrevEncSample2);
+
+            ASSERT(refSampleFilter == bestSampleFilter);
+            ASSERT(refSampleShift == bestSampleShift);
+            ASSERT(std::memcmp(refSampleNibbles, bestSampleNibbles, sizeof(refSampleNibbles)) == 0);
+            ASSERT(refPrevEncSample1 == prevEncSampleOut1);
+            ASSERT(refPrevEncSample2 == prevEncSampleOut2);
+        }
+        #endif
+    #else
+        findBestPsxAdpcmEncoding(samples, prevSample1, prevSample2, bestSampleFilter, bestSampleShift, bestSampleNibbles, prevEncSampleOut1, prevEncSampleOut2);
+    #endif
 
     // Save the sample shift and the prediction filter
     adpcmDataOut[0] = (std::byte)(bestSampleShift | (bestSampleFilter << 4));
@@ -3,6 +3,7 @@
 #include "Endian.h"
 
 #include <algorithm>
+#include <cstring>
 #include <map>
 #include <string>
 
@@ -6,6 +6,21 @@
 #include "VagUtils.h"
 #include "WavUtils.h"
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+// MacOS: some POSIX stuff needed due to <filesystem> workaround
+#if __APPLE__
+    #include <dirent.h>
+#else
+    #include <filesystem>
+#endif
+
 using namespace AudioTools;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -37,6 +52,23 @@ Command switches and arguments:
             (1) The .WAV file will be output with loop point info via the 'smpl' chunk.
         Example:
             VagTool -vag-to-wav PSX_SOUND.VAG SOME_SOUND.WAV
+
+    -batch-wav-to-vag <INPUT DIR> <OUTPUT DIR> [NUM THREADS]
+        Convert all .WAV files in the input directory to .VAG files with the same names in the output directory.
+        Notes:
+            (1) The same rules apply to each .WAV file as for the '-wav-to-vag' command.
+            (2) Files are converted in parallel. If the number of threads is not given then one thread per CPU thread is used.
+            (3) The output directory must already exist.
+        Example:
+            VagTool -batch-wav-to-vag WAV_SOUNDS VAG_SOUNDS
+
+    -batch-vag-to-wav <INPUT DIR> <OUTPUT DIR> [NUM THREADS]
+        Convert all .VAG files in the input directory to .WAV files with the same names in the output directory.
+        Notes:
+            (1) Files are converted in parallel. If the number of threads is not given then one thread per CPU thread is used.
+            (2) The output directory must already exist.
+        Example:
+            VagTool -batch-vag-to-wav VAG_SOUNDS WAV_SOUNDS
 )";
 
 static void printHelp() noexcept {
@@ -147,6 +179,135 @@ static bool convertVagToWav(const char* const vagFilePath, const char* const wav
     return true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the names of all files in the given directory with the given extension (case insensitive, including the '.').
+// Returns 'false' if the directory could not be read.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool getDirFilesWithExtension(const char* const dirPath, const char* const extension, std::vector<std::string>& fileNamesOut) noexcept {
+    // Does the given file name have the extension?
+    auto hasExtension = [=](const std::string& fileName) noexcept {
+        const size_t extLen = std::strlen(extension);
+
+        if (fileName.length() <= extLen)
+            return false;
+
+        return std::equal(fileName.end() - extLen, fileName.end(), extension, [](const char c1, const char c2) noexcept {
+            return (std::tolower((unsigned char) c1) == std::tolower((unsigned char) c2));
+        });
+    };
+
+    fileNamesOut.clear();
+
+    // MacOS: the C++ 17 '<filesystem>' header requires MacOS Catalina as a minimum target, use standard POSIX stuff instead as a workaround
+    #if __APPLE__
+        DIR* const pDir = opendir(dirPath);
+
+        if (!pDir)
+            return false;
+
+        while (dirent* const pDirEnt = readdir(pDir)) {
+            if ((pDirEnt->d_type == DT_REG) && hasExtension(pDirEnt->d_name)) {
+                fileNamesOut.emplace_back(pDirEnt->d_name);
+            }
+        }
+
+        closedir(pDir);
+    #else
+        try {
+            for (const std::filesystem::directory_entry& dirEntry : std::filesystem::directory_iterator(dirPath)) {
+                std::string fileName = dirEntry.path().filename().u8string();
+
+                if (dirEntry.is_regular_file() && hasExtension(fileName)) {
+                    fileNamesOut.emplace_back(std::move(fileName));
+                }
+            }
+        }
+        catch (...) {
+            return false;
+        }
+    #endif
+
+    // Process files in a consistent order, regardless of the order the OS lists them in
+    std::sort(fileNamesOut.begin(), fileNamesOut.end());
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Convert all files with the given input extension in the input directory, using the given single file conversion function.
+// The output files are given the same names but with the output extension instead, keeping the case of the input extension.
+// If the number of threads is '0' then one thread per CPU thread is used.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool batchConvert(
+    const char* const inputDir,
+    const char* const outputDir,
+    const char* const inputExtension,
+    const char* const outputExtension,
+    uint32_t numThreads,
+    bool (* const convertFunc)(const char* const inputFilePath, const char* const outputFilePath) noexcept
+) noexcept {
+    // Get all of the files to convert
+    std::vector<std::string> fileNames;
+
+    if (!getDirFilesWithExtension(inputDir, inputExtension, fileNames)) {
+        std::printf("Error! Failed to read the input directory '%s'! Does this directory exist?\n", inputDir);
+        return false;
+    }
+
+    // Decide on the number of threads to use: no point in having more threads than files
+    if (numThreads == 0) {
+        numThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    numThreads = std::max(std::min<uint32_t>(numThreads, (uint32_t) fileNames.size()), 1u);
+
+    // Convert all of the files, with each thread grabbing the next unconverted file until there are none left
+    try {
+        std::atomic<uint32_t> nextFileIdx = 0;
+        std::atomic<uint32_t> numFilesConverted = 0;
+
+        auto convertFiles = [&]() noexcept {
+            const size_t extLen = std::strlen(inputExtension);
+
+            for (uint32_t fileIdx = nextFileIdx++; fileIdx < fileNames.size(); fileIdx = nextFileIdx++) {
+                const std::string& fileName = fileNames[fileIdx];
+                std::string outputFileName = fileName.substr(0, fileName.length() - extLen);
+                const bool bUpperCaseExt = std::isupper((unsigned char) fileName.back());
+
+                for (const char* pExtChar = outputExtension; *pExtChar; ++pExtChar) {
+                    outputFileName.push_back((bUpperCaseExt) ? (char) std::toupper((unsigned char) *pExtChar) : *pExtChar);
+                }
+
+                const std::string inputFilePath = std::string(inputDir) + "/" + fileName;
+                const std::string outputFilePath = std::string(outputDir) + "/" + outputFileName;
+
+                if (convertFunc(inputFilePath.c_str(), outputFilePath.c_str())) {
+                    numFilesConverted++;
+                }
+            }
+        };
+
+        std::vector<std::thread> workers;
+        workers.reserve(numThreads - 1);
+
+        for (uint32_t i = 1; i < numThreads; ++i) {
+            workers.emplace_back(convertFiles);
+        }
+
+        convertFiles();
+
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+
+        std::printf("Converted %u of %zu file(s).\n", numFilesConverted.load(), fileNames.size());
+        return (numFilesConverted == fileNames.size());
+    }
+    catch (...) {
+        std::printf("Error! Failed to start the threads for conversion!\n");
+        return false;
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Program entrypoint
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -180,6 +341,33 @@ int main(int argc, const char* const argv[]) noexcept {
             return (convertVagToWav(vagFilePath, wavFilePath)) ? 0 : 1;
         }
     }
+    else if ((std::strcmp(cmdSwitch, "-batch-wav-to-vag") == 0) || (std::strcmp(cmdSwitch, "-batch-vag-to-wav") == 0)) {
+        if ((argc == 4) || (argc == 5)) {
+            const char* const inputDir = argv[2];
+            const char* const outputDir = argv[3];
+            int numThreads = 0;
+
+            if (argc == 5) {
+                try {
+                    numThreads = std::stoi(argv[4]);
+                } catch (...) {
+                    numThreads = -1;
+                }
+
+                if (numThreads <= 0) {
+                    std::printf("Invalid number of threads '%s'! Must be a positive integer.\n", argv[4]);
+                    return 1;
+                }
+            }
+
+            const bool bWavToVag = (std::strcmp(cmdSwitch, "-batch-wav-to-vag") == 0);
+            const bool bConverted = (bWavToVag) ?
+                batchConvert(inputDir, outputDir, ".wav", ".vag", (uint32_t) numThreads, convertWavToVag) :
+                batchConvert(inputDir, outputDir, ".vag", ".wav", (uint32_t) numThreads, convertVagToWav);
+
+            return (bConverted) ? 0 : 1;
+        }
+    }
 
     printHelp();
     return 1;
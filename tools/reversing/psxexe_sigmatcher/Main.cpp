@@ -4,7 +4,114 @@
 #include "FuncSignature.h"
 #include "PrintUtils.h"
 #include "TextIStream.h"
+
+#include <algorithm>
+#include <atomic>
 #include <fstream>
+#include <thread>
+#include <unordered_map>
+
+// Signatures are matched by looking up pairs of consecutive instructions (bigrams) in an index built over the executable.
+// This maps from the hash of an instruction bigram to the word indexes in the exe where the bigram begins, in ascending order.
+typedef std::unordered_map<uint64_t, std::vector<uint32_t>> BigramIndex;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Hash a single instruction or a pair of consecutive instructions for the bigram index
+//------------------------------------------------------------------------------------------------------------------------------------------
+static uint64_t hashInstruction(const CpuInstruction& inst) noexcept {
+    return (
+        ((uint64_t) inst.opcode << 56) |
+        ((uint64_t) inst.regS << 48) |
+        ((uint64_t) inst.regT << 40) |
+        ((uint64_t) inst.regD << 32) |
+        ((uint64_t) inst.immediateVal)
+    );
+}
+
+static uint64_t hashInstructionBigram(const CpuInstruction& i1, const CpuInstruction& i2) noexcept {
+    return (hashInstruction(i1) * 0x9E3779B97F4A7C15ull) ^ hashInstruction(i2);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Check if the given signature matches the exe instructions starting at the specified word index.
+// Wildcard instructions match only on instruction type!
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool sigMatchesAt(const FuncSignature& sig, const std::vector<CpuInstruction>& exeInstructions, const uint32_t startExeWordIdx) noexcept {
+    const uint32_t numSigWords = (uint32_t) sig.instructions.size();
+
+    // Are there enough words left in the exe for a match?
+    if (startExeWordIdx + numSigWords > exeInstructions.size())
+        return false;
+
+    for (uint32_t sigWordIdx = 0; sigWordIdx < numSigWords; ++sigWordIdx) {
+        const CpuInstruction& i1 = exeInstructions[startExeWordIdx + sigWordIdx];
+        const CpuInstruction& i2 = sig.instructions[sigWordIdx];
+
+        if (i1 != i2) {
+            if ((i1.opcode != i2.opcode) || (!sig.bInstructionIsPatched[sigWordIdx]))
+                return false;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Find all the exe word indexes where the given signature matches and save them to the given list, in ascending order.
+//
+// The signature is anchored on the pair of consecutive non-wildcard instructions which occurs least often in the exe, and only the
+// offsets where that pair occurs are checked. If the signature has no such pair then every offset in the exe is checked (brute force).
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void findSigMatches(
+    const FuncSignature& sig,
+    const std::vector<CpuInstruction>& exeInstructions,
+    const BigramIndex& bigramIndex,
+    std::vector<uint32_t>& matchesOut
+) noexcept {
+    const uint32_t numExeWords = (uint32_t) exeInstructions.size();
+    const uint32_t numSigWords = (uint32_t) sig.instructions.size();
+
+    // Pick the anchor instruction pair for the signature
+    const std::vector<uint32_t>* pAnchorOffsets = nullptr;
+    uint32_t anchorSigWordIdx = 0;
+
+    for (uint32_t sigWordIdx = 0; sigWordIdx + 1 < numSigWords; ++sigWordIdx) {
+        if (sig.bInstructionIsPatched[sigWordIdx] || sig.bInstructionIsPatched[sigWordIdx + 1])
+            continue;
+
+        const uint64_t bigramHash = hashInstructionBigram(sig.instructions[sigWordIdx], sig.instructions[sigWordIdx + 1]);
+        const auto bigramIter = bigramIndex.find(bigramHash);
+
+        // If the pair does not occur anywhere in the exe then the signature can't match
+        if (bigramIter == bigramIndex.end())
+            return;
+
+        if ((!pAnchorOffsets) || (bigramIter->second.size() < pAnchorOffsets->size())) {
+            pAnchorOffsets = &bigramIter->second;
+            anchorSigWordIdx = sigWordIdx;
+        }
+    }
+
+    // Brute force the match if there is no anchor, otherwise just check the offsets where the anchor occurs
+    if (!pAnchorOffsets) {
+        for (uint32_t startExeWordIdx = 0; startExeWordIdx + numSigWords <= numExeWords; ++startExeWordIdx) {
+            if (sigMatchesAt(sig, exeInstructions, startExeWordIdx)) {
+                matchesOut.push_back(startExeWordIdx);
+            }
+        }
+    } else {
+        for (const uint32_t anchorExeWordIdx : *pAnchorOffsets) {
+            if (anchorExeWordIdx < anchorSigWordIdx)
+                continue;
+
+            const uint32_t startExeWordIdx = anchorExeWordIdx - anchorSigWordIdx;
+
+            if (sigMatchesAt(sig, exeInstructions, startExeWordIdx)) {
+                matchesOut.push_back(startExeWordIdx);
+            }
+        }
+    }
+}
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Entry point for 'PSXExeSigMatcher'
@@ -51,45 +158,63 @@ int main(int argc, char* argv[]) noexcept {
         exeInstructions.push_back(instruction);
     }
 
-    // Do brute force matching!
-    // Not a very smart way of doing things, but gets the job done.
+    // Index all of the instruction pairs in the exe
+    BigramIndex bigramIndex;
+
+    try {
+        for (uint32_t wordIdx = 0; wordIdx + 1 < numExeWords; ++wordIdx) {
+            const uint64_t bigramHash = hashInstructionBigram(exeInstructions[wordIdx], exeInstructions[wordIdx + 1]);
+            bigramIndex[bigramHash].push_back(wordIdx);
+        }
+    } catch (...) {
+        FATAL_ERROR("Failed to allocate memory for the instruction index!\n");
+    }
+
+    // Find the matches for all signatures in parallel, with each thread grabbing the next unmatched signature until there are none left
+    const uint32_t numSigs = (uint32_t) funcSigs.size();
+    std::vector<std::vector<uint32_t>> sigMatches;
+
+    try {
+        sigMatches.resize(numSigs);
+        std::atomic<uint32_t> nextSigIdx = 0;
+
+        auto matchSigs = [&]() noexcept {
+            for (uint32_t sigIdx = nextSigIdx++; sigIdx < numSigs; sigIdx = nextSigIdx++) {
+                findSigMatches(funcSigs[sigIdx], exeInstructions, bigramIndex, sigMatches[sigIdx]);
+            }
+        };
+
+        const uint32_t numThreads = std::max(std::min<uint32_t>(std::thread::hardware_concurrency(), numSigs), 1u);
+        std::printf("Searching for matches for %u function signature(s) using %u thread(s)...\n", numSigs, numThreads);
+
+        std::vector<std::thread> workers;
+        workers.reserve(numThreads - 1);
+
+        for (uint32_t i = 1; i < numThreads; ++i) {
+            workers.emplace_back(matchSigs);
+        }
+
+        matchSigs();
+
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    } catch (...) {
+        FATAL_ERROR("An error occurred while matching function signatures!\n");
+    }
+
+    // Output all the matches found, in signature order
     try {
         std::fstream out;
         out.open(argv[3], std::fstream::out);
 
-        for (const FuncSignature& sig : funcSigs) {
-            std::printf("Search for matches for '%s'...\n", sig.name.c_str());
-            const uint32_t numSigWords = (uint32_t) sig.instructions.size();
-
-            for (uint32_t startExeWordIdx = 0; startExeWordIdx < numExeWords; ++startExeWordIdx) {
-                // Are there enough words left in the exe for a match?
-                if (startExeWordIdx + numSigWords > numExeWords)
-                    break;
-
-                // Check if all instructions match, taking into account wildcard instructions.
-                // Wildcard instructions match only on instruction type!
-                bool bMatch = true;
-
-                for (uint32_t sigWordIdx = 0; sigWordIdx < numSigWords; ++sigWordIdx) {
-                    const CpuInstruction& i1 = exeInstructions[startExeWordIdx + sigWordIdx];
-                    const CpuInstruction& i2 = sig.instructions[sigWordIdx];
-
-                    if (i1 != i2) {
-                        if ((i1.opcode != i2.opcode) || (!sig.bInstructionIsPatched[sigWordIdx])) {
-                            bMatch = false;
-                            break;
-                        }
-                    }
-                }
-
-                // Did we find a match? If so then output it!
-                if (bMatch) {
-                    const uint32_t addr = exe.baseAddress + startExeWordIdx * 4;
-                    PrintUtils::printHexU32(addr, true, out);
-                    out << " matches function '";
-                    out << sig.name;
-                    out << "'\n";
-                }
+        for (uint32_t sigIdx = 0; sigIdx < numSigs; ++sigIdx) {
+            for (const uint32_t startExeWordIdx : sigMatches[sigIdx]) {
+                const uint32_t addr = exe.baseAddress + startExeWordIdx * 4;
+                PrintUtils::printHexU32(addr, true, out);
+                out << " matches function '";
+                out << funcSigs[sigIdx].name;
+                out << "'\n";
             }
         }
     } catch (...) {
@@ -8,7 +8,8 @@
 #include "PrintUtils.h"
 #include <algorithm>
 
-static ConstInstructionEvaluator gConstInstructionEvaluator;
+// Note: each thread printing the disassembly needs its own evaluator
+static thread_local ConstInstructionEvaluator gConstInstructionEvaluator;
 
 static void prefixInstructionComment(const uint32_t lineCol, std::ostream& out) {
     // Figure out the start column for the comment
@@ -628,12 +629,40 @@ static void printUncategorizedProgramRegion(
     out << "\n";
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Something to be printed in the disassembly: either a program element or an uncategorized region of the exe
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct DisasmPrintItem {
+    const ProgElem*     pProgElem;          // The program element to print or 'nullptr' if printing an uncategorized region
+    uint32_t            startByteIdx;       // Uncategorized regions only: the start and end byte in the exe
+    uint32_t            endByteIdx;
+};
+
+static void printItemsInParallel(const ExeFile& exe, const std::vector<DisasmPrintItem>& items, std::ostream& out) {
+    PrintUtils::printInParallel(
+        (uint32_t) items.size(),
+        [&](const uint32_t itemIdx, std::ostream& itemOut) {
+            const DisasmPrintItem& item = items[itemIdx];
+
+            if (item.pProgElem) {
+                printProgElem(exe, *item.pProgElem, itemOut);
+            } else {
+                printUncategorizedProgramRegion(exe, item.startByteIdx, item.endByteIdx, itemOut);
+            }
+        },
+        out
+    );
+}
+
 void DisassemblyPrinter::printExe(const ExeFile& exe, std::ostream& out) {
     // Firstly make sure all program elements are valid and in range for the exe
     for (const ProgElem& progElem : exe.progElems) {
         validateProgElemRange(exe, progElem);
     }
 
+    // Figure out everything that needs to be printed first, in order, so that it can all be printed in parallel
+    std::vector<DisasmPrintItem> printItems;
+
     // Continue until we have printed all program words
     uint32_t curProgByteIdx = 0;
     uint32_t curProgElemIdx = 0;
@@ -651,7 +680,7 @@ void DisassemblyPrinter::printExe(const ExeFile& exe, std::ostream& out) {
 
             if (progElem.containsByteAtAddr(curByteAddr) || progElem.endAddr <= curByteAddr) {
                 // Time to print this program element
-                printProgElem(exe, progElem, out);
+                printItems.push_back({ &progElem, 0, 0 });
                 ++curProgElemIdx;
 
                 // Move on in the program bytes and ensure we don't go backwards
@@ -677,12 +706,14 @@ void DisassemblyPrinter::printExe(const ExeFile& exe, std::ostream& out) {
         }
 
         if (endByteIdx > curProgByteIdx) {
-            printUncategorizedProgramRegion(exe, curProgByteIdx, endByteIdx, out);
+            printItems.push_back({ nullptr, curProgByteIdx, endByteIdx });
         }
 
         curProgByteIdx = endByteIdx;
     }
 
+    printItemsInParallel(exe, printItems, out);
+
     // If there are program elements outside of the .EXE image (zero intialized globals) then print them now
     if (curProgElemIdx < numProgElems) {
         out << "\n";
@@ -690,10 +721,14 @@ void DisassemblyPrinter::printExe(const ExeFile& exe, std::ostream& out) {
         out << "; ZERO initialized globals (not defined in .EXE image, zero initialized in 'main()')\n";
         out << ";-----------------------------------------------------------------------------------------------------------------------\n\n";
 
+        printItems.clear();
+
         while (curProgElemIdx < numProgElems) {
             const ProgElem& progElem = exe.progElems[curProgElemIdx];
-            printProgElem(exe, progElem, out);
+            printItems.push_back({ &progElem, 0, 0 });
             ++curProgElemIdx;
         }
+
+        printItemsInParallel(exe, printItems, out);
     }
 }
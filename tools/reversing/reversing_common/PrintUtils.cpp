@@ -1,6 +1,14 @@
 #include "PrintUtils.h"
 
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <type_traits>
+#include <vector>
 
 void PrintUtils::printHexDigit(const uint8_t nibble, std::ostream& out) {
     const uint8_t nibble4Bit = nibble & 0x0Fu;
@@ -123,3 +131,56 @@ void PrintUtils::printEscapedChar(const char val, std::ostream& out) {
         printHexU8(valU8, true, out);
     }
 }
+
+void PrintUtils::printInParallel(
+    const uint32_t numItems,
+    const std::function<void (const uint32_t itemIdx, std::ostream& out)>& printFunc,
+    std::ostream& out
+) {
+    // Print each item to its own buffer, with each thread grabbing the next unprinted item until there are none left
+    std::vector<std::string> itemOutputs(numItems);
+    std::atomic<uint32_t> nextItemIdx = 0;
+    std::exception_ptr pPrintError;
+    std::mutex printErrorMutex;
+
+    auto printItems = [&]() noexcept {
+        try {
+            for (uint32_t itemIdx = nextItemIdx++; itemIdx < numItems; itemIdx = nextItemIdx++) {
+                std::ostringstream itemOut;
+                printFunc(itemIdx, itemOut);
+                itemOutputs[itemIdx] = itemOut.str();
+            }
+        } catch (...) {
+            // Stop all other threads from printing and save the error to re-throw
+            nextItemIdx = numItems;
+            std::lock_guard<std::mutex> lock(printErrorMutex);
+
+            if (!pPrintError) {
+                pPrintError = std::current_exception();
+            }
+        }
+    };
+
+    const uint32_t numThreads = std::max(std::min<uint32_t>(std::thread::hardware_concurrency(), numItems), 1u);
+    std::vector<std::thread> workers;
+    workers.reserve(numThreads - 1);
+
+    for (uint32_t i = 1; i < numThreads; ++i) {
+        workers.emplace_back(printItems);
+    }
+
+    printItems();
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+
+    if (pPrintError) {
+        std::rethrow_exception(pPrintError);
+    }
+
+    // Output all of the items in order
+    for (const std::string& itemOutput : itemOutputs) {
+        out << itemOutput;
+    }
+}
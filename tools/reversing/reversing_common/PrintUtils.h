@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <functional>
 #include <ostream>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -18,4 +19,9 @@ namespace PrintUtils {
 
     // Print a char with characters like newline '\n' or above ascii characters escaped
     void printEscapedChar(const char val, std::ostream& out);
+
+    // Print a number of items in parallel using all available CPU threads, then output them to the given stream in order.
+    // Each item is printed by one thread to its own buffer, so the print function must not touch state shared with other items.
+    // If printing any item fails then the exception is re-thrown on the calling thread once all threads are done.
+    void printInParallel(const uint32_t numItems, const std::function<void (const uint32_t itemIdx, std::ostream& out)>& printFunc, std::ostream& out);
 }
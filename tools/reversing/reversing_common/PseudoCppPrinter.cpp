@@ -10,7 +10,8 @@
 #include <algorithm>
 #include <set>
 
-static ConstInstructionEvaluator gConstInstructionEvaluator;
+// Note: each thread printing functions needs its own evaluator
+static thread_local ConstInstructionEvaluator gConstInstructionEvaluator;
 
 using namespace PseudoCppPrinter;
 
@@ -720,12 +721,22 @@ void PseudoCppPrinter::printCpp(const ExeFile& exe, std::ostream& out) {
 
     out << "\n";
 
-    // Print all of the functions
-    for (const ProgElem& progElem : exe.progElems) {        
+    // Print all of the functions in parallel
+    std::vector<const ProgElem*> funcElems;
+
+    for (const ProgElem& progElem : exe.progElems) {
         if (progElem.type == ProgElemType::FUNCTION) {
-            printFunction(exe, progElem, out);
+            funcElems.push_back(&progElem);
         }
     }
+
+    PrintUtils::printInParallel(
+        (uint32_t) funcElems.size(),
+        [&](const uint32_t funcIdx, std::ostream& funcOut) {
+            printFunction(exe, *funcElems[funcIdx], funcOut);
+        },
+        out
+    );
 }
 
 void PseudoCppPrinter::printHexCppInt16Literal(const int16_t valI16, bool bZeroPad, std::ostream& out) {
@@ -46,6 +46,7 @@ Buffer::Buffer() noexcept
     , mLockedOffset(0)
     , mLockedSize(0)
     , mLockedVkBuffer(VK_NULL_HANDLE)
+    , mLockedVkOffset(0)
     , mpLockedBytes(nullptr)
     , mBuffer()
     , mStagingBuffer()
@@ -64,6 +65,7 @@ Buffer::Buffer(Buffer&& other) noexcept
     , mLockedOffset(other.mLockedOffset)
     , mLockedSize(other.mLockedSize)
     , mLockedVkBuffer(other.mLockedVkBuffer)
+    , mLockedVkOffset(other.mLockedVkOffset)
     , mpLockedBytes(other.mpLockedBytes)
     , mBuffer(std::move(other.mBuffer))
     , mStagingBuffer(std::move(other.mStagingBuffer))
@@ -76,6 +78,7 @@ Buffer::Buffer(Buffer&& other) noexcept
     other.mLockedOffset = 0;
     other.mLockedSize = 0;
     other.mLockedVkBuffer = VK_NULL_HANDLE;
+    other.mLockedVkOffset = 0;
     other.mpLockedBytes = nullptr;
 }
 
@@ -227,6 +230,7 @@ std::byte* Buffer::lockBytes(const uint64_t offsetInBytes, const uint64_t sizeIn
         mLockedOffset = offsetInBytes;
         mLockedSize = sizeInBytes;
         mLockedVkBuffer = mStagingBuffer.getVkBuffer();
+        mLockedVkOffset = offsetInBytes;
         mpLockedBytes = pBytes;
         return pBytes + offsetInBytes;
     }
@@ -245,6 +249,7 @@ std::byte* Buffer::lockBytes(const uint64_t offsetInBytes, const uint64_t sizeIn
     mLockedOffset = offsetInBytes;
     mLockedSize = sizeInBytes;
     mLockedVkBuffer = buffer.vkBuffer;
+    mLockedVkOffset = buffer.offset;
     mpLockedBytes = buffer.pBytes;
     return mpLockedBytes;
 }
@@ -278,9 +283,9 @@ void Buffer::unlockBytes(const uint64_t writtenSizeInBytes, TransferTask* const
     const VkBuffer lockedVkBuffer = mLockedVkBuffer;
 
     if (lockedVkBuffer) {
-        // Note: we only use an staging buffer offset if we are using a persistent buffer.
-        // Otherwise we always use offset '0' if it was temporarily allocated just for a single transfer:
-        const uint64_t stagingBufferOffset = (lockedVkBuffer == mStagingBuffer.getVkBuffer()) ? mLockedOffset : 0;
+        // Note: for a persistent staging buffer this is the same as the locked offset.
+        // Otherwise it's wherever the temporary staging allocation for the transfer begins within its buffer:
+        const uint64_t stagingBufferOffset = mLockedVkOffset;
         TransferTask* pDstTask;
 
         if (!pTransferTaskOverride) {
@@ -300,6 +305,7 @@ void Buffer::unlockBytes(const uint64_t writtenSizeInBytes, TransferTask* const
         }
 
         mLockedVkBuffer = VK_NULL_HANDLE;
+        mLockedVkOffset = 0;
     }
 
     mbIsLocked = false;
@@ -324,6 +330,7 @@ void Buffer::abandonLock() noexcept {
     mLockedOffset = 0;
     mLockedSize = 0;
     mLockedVkBuffer = VK_NULL_HANDLE;
+    mLockedVkOffset = 0;
     mpLockedBytes = nullptr;
 }
 
@@ -374,6 +381,7 @@ bool Buffer::resizeToByteCount(
     mLockedOffset       = 0;
     mLockedSize         = 0;
     mLockedVkBuffer     = VK_NULL_HANDLE;
+    mLockedVkOffset     = 0;
     mpLockedBytes       = nullptr;
 
     RawBuffer oldBuffer(std::move(mBuffer));
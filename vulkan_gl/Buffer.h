@@ -203,6 +203,7 @@ private:
     uint64_t            mLockedOffset;      // Lock details: offset of the locked region
     uint64_t            mLockedSize;        // Lock details: size of the locked region
     VkBuffer            mLockedVkBuffer;    // Lock details: the actual Vulkan Buffer locked
+    uint64_t            mLockedVkOffset;    // Lock details: offset of the locked region within the actual Vulkan Buffer locked
     std::byte*          mpLockedBytes;      // Lock details: the actual bytes locked
     RawBuffer           mBuffer;            // Raw backing buffer that stores the actual data for the buffer
     RawBuffer           mStagingBuffer;     // Raw backing buffer used as a persistant staging buffer if the usage mode is dynamic
@@ -8,6 +8,7 @@
 #include "LogicalDevice.h"
 #include "Pipeline.h"
 #include "PipelineLayout.h"
+#include "QueryPool.h"
 #include "RenderPass.h"
 #include "VkFuncs.h"
 
@@ -394,4 +395,27 @@ void CmdBufferRecorder::dispatchWorkgroups(
     mVkFuncs.vkCmdDispatch(mVkCommandBuffer, numWorkgroupsX, numWorkgroupsY, numWorkgroupsZ);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Recorded command: reset a range of queries in a query pool so they can be used again.
+// Note: this must be done outside of a render pass.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void CmdBufferRecorder::resetQueries(const QueryPool& queryPool, const uint32_t firstQuery, const uint32_t numQueries) noexcept {
+    ASSERT(isRecording());
+    ASSERT(queryPool.isValid());
+    ASSERT(firstQuery + numQueries <= queryPool.getNumQueries());
+
+    mVkFuncs.vkCmdResetQueryPool(mVkCommandBuffer, queryPool.getVkQueryPool(), firstQuery, numQueries);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Recorded command: write the device timestamp to the given query once all previous commands reach the specified pipeline stage
+//------------------------------------------------------------------------------------------------------------------------------------------
+void CmdBufferRecorder::writeTimestamp(const VkPipelineStageFlagBits pipelineStage, const QueryPool& queryPool, const uint32_t query) noexcept {
+    ASSERT(isRecording());
+    ASSERT(queryPool.isValid());
+    ASSERT(query < queryPool.getNumQueries());
+
+    mVkFuncs.vkCmdWriteTimestamp(mVkCommandBuffer, pipelineStage, queryPool.getVkQueryPool(), query);
+}
+
 END_NAMESPACE(vgl)
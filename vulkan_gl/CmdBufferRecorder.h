@@ -12,6 +12,7 @@ class DescriptorSet;
 class Framebuffer;
 class Pipeline;
 class PipelineLayout;
+class QueryPool;
 class RenderPass;
 struct VkFuncs;
 
@@ -136,6 +137,9 @@ public:
         const uint32_t numWorkgroupsZ = 1
     ) noexcept;
 
+    void resetQueries(const QueryPool& queryPool, const uint32_t firstQuery, const uint32_t numQueries) noexcept;
+    void writeTimestamp(const VkPipelineStageFlagBits pipelineStage, const QueryPool& queryPool, const uint32_t query) noexcept;
+
 private:
     // Copy and move are disallowed
     CmdBufferRecorder(const CmdBufferRecorder& other) = delete;
@@ -24,6 +24,10 @@ struct DeviceMemAlloc {
     // This may be bigger than what was requested.
     uint64_t size;
 
+    // The size of the memory region that was originally requested.
+    // The difference between this and 'size' is memory wasted due to rounding the allocation up to a supported block size.
+    uint64_t requestedSize;
+
     // Pointer to the start of the memory region allocated.
     // Note that this is only provided for memory allocations that are host/CPU visible.
     std::byte* pBytes;
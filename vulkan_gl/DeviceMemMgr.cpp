@@ -194,15 +194,25 @@ void DeviceMemMgr::alloc(
     );
 
     // Try to do the alloc and die with an out of memory error if it fails.
+    // If the first attempt fails then give back any empty pools which are being kept around for re-use and try once more,
+    // since that memory might be all that is needed to satisfy the request.
     // Note that in the case of an unpooled alloc we don't need to worry about alignment, since the Vulkan spec states
     // that the memory returned by 'vkAllocateMemory' must meet any possible alignment requirement of the implementation.
     if (bAllocUnpooled) {
-        if (!allocUnpooled(numBytes, allowedVkMemTypeBits, allocMode, allocInfoOut))
-            FatalErrors::outOfMemory();
+        if (!allocUnpooled(numBytes, allowedVkMemTypeBits, allocMode, allocInfoOut)) {
+            freeEmptyPools(0);
+
+            if (!allocUnpooled(numBytes, allowedVkMemTypeBits, allocMode, allocInfoOut))
+                FatalErrors::outOfMemory();
+        }
     } 
     else {
-        if (!allocFromAllPools(numBytes, alignment, allowedVkMemTypeBits, allocMode, allocInfoOut))
-            FatalErrors::outOfMemory();
+        if (!allocFromAllPools(numBytes, alignment, allowedVkMemTypeBits, allocMode, allocInfoOut)) {
+            freeEmptyPools(0);
+
+            if (!allocFromAllPools(numBytes, alignment, allowedVkMemTypeBits, allocMode, allocInfoOut))
+                FatalErrors::outOfMemory();
+        }
 
         // Sanity check alignment requirements have been met before exiting
         ASSERT((alignment == 0) || (allocInfoOut.offset % alignment == 0));
@@ -226,6 +236,8 @@ void DeviceMemMgr::dealloc(DeviceMemAlloc& allocInfo) noexcept {
 
     // Get the pool the allocation is in: expect it to exist
     Pool& pool = mPools.at(allocInfo.poolId);
+    ASSERT(pool.numBytesRequested >= allocInfo.requestedSize);
+    pool.numBytesRequested -= allocInfo.requestedSize;
 
     // See if the alloc is in a sub pool or not
     if (allocInfo.subPoolId != INVALID_MEM_MGR_ID) {
@@ -249,6 +261,66 @@ void DeviceMemMgr::dealloc(DeviceMemAlloc& allocInfo) noexcept {
 // Makes the memory manager free up any pools that are no longer in use
 //------------------------------------------------------------------------------------------------------------------------------------------
 void DeviceMemMgr::freeUnusedPools() noexcept {
+    freeEmptyPools(0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Does an idle time compaction pass on the memory manager, intended to be run regularly (e.g once per frame) when retired resources are freed.
+// Frees pools and sub-pools which have been empty for enough consecutive passes, so that device memory usage does not creep up over time
+// as resources are created and destroyed. Pools which have only been empty briefly are kept around, so they can be re-used.
+//
+// Note: allocations are never moved between pools, since the memory bound to Vulkan buffers and images cannot be changed.
+// Instead, empty pools are given back to Vulkan so that the memory manager's footprint shrinks back down as allocations are freed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void DeviceMemMgr::compact() noexcept {
+    if (mbIsValid) {
+        freeEmptyPools(COMPACT_MIN_IDLE_PASSES);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets allocation stats for all pools and unpooled allocations in the memory manager
+//------------------------------------------------------------------------------------------------------------------------------------------
+void DeviceMemMgr::getStats(Stats& statsOut) const noexcept {
+    statsOut.pools.clear();
+    statsOut.pools.reserve(mPools.size());
+    statsOut.numUnpooledAllocs = (uint32_t) mUnpooledAllocs.size();
+    statsOut.numUnpooledBytes = 0;
+
+    for (const std::pair<const MemMgrIdT, Pool>& poolKvp : mPools) {
+        const Pool& pool = poolKvp.second;
+
+        // Note: sub pools count as allocated in the main pool, so free space inside them must be added to the total free space
+        uint64_t numBytesFree = pool.memMgr.getNumBytesFree();
+
+        for (const std::pair<const MemMgrIdT, SubPool>& subPoolKvp : pool.subPools) {
+            numBytesFree += subPoolKvp.second.memMgr.getNumBytesFree();
+        }
+
+        const uint64_t numBytesCapacity = pool.memMgr.getCapacityInBytes();
+        ASSERT(numBytesFree + pool.numBytesRequested <= numBytesCapacity);
+
+        PoolStats& poolStats = statsOut.pools.emplace_back();
+        poolStats.poolId = pool.poolId;
+        poolStats.bIsDeviceLocal = pool.bIsDeviceLocal;
+        poolStats.bIsHostVisible = pool.bIsHostVisible;
+        poolStats.numSubPools = (uint32_t) pool.subPools.size();
+        poolStats.numBytesCapacity = numBytesCapacity;
+        poolStats.numBytesInUse = pool.numBytesRequested;
+        poolStats.numBytesWasted = numBytesCapacity - numBytesFree - pool.numBytesRequested;
+        poolStats.numBytesFree = numBytesFree;
+    }
+
+    for (const std::pair<const MemMgrIdT, DeviceMemAlloc>& allocKvp : mUnpooledAllocs) {
+        statsOut.numUnpooledBytes += allocKvp.second.size;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees up any pools and sub-pools that have been empty for more than the given number of consecutive calls.
+// If '0' is specified then all empty pools and sub-pools are freed immediately.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void DeviceMemMgr::freeEmptyPools(const uint32_t minIdlePasses) noexcept {
     // This can only be done if there is a device.
     // If we have no device then there should be no allocations, hence nothing to do.
     if (!mpDevice)
@@ -269,18 +341,27 @@ void DeviceMemMgr::freeUnusedPools() noexcept {
         while (subPoolIter != subPools.end()) {
             SubPool& subPool = subPoolIter->second;
 
-            if (!subPool.memMgr.hasAllocations()) {
+            if (subPool.memMgr.hasAllocations()) {
+                // This sub pool is still in use
+                subPool.numIdlePasses = 0;
+                ++subPoolIter;
+            } else if (++subPool.numIdlePasses > minIdlePasses) {
                 // This sub pool is finished, deallocate it from the main pool
                 pool.memMgr.dealloc(subPool.offset);
                 subPoolIter = subPools.erase(subPoolIter);
             } else {
-                // This sub pool is still in use
+                // This sub pool is empty but hasn't been idle for long enough to free yet
                 ++subPoolIter;
             }
         }
 
-        // Free the pool itself if it is no longer in use
-        if (!pool.memMgr.hasAllocations()) {
+        // Free the pool itself if it is no longer in use and has been idle for long enough
+        const bool bIsPoolEmpty = (!pool.memMgr.hasAllocations());
+        pool.numIdlePasses = (bIsPoolEmpty) ? pool.numIdlePasses + 1 : 0;
+
+        if (bIsPoolEmpty && (pool.numIdlePasses > minIdlePasses)) {
+            ASSERT(pool.numBytesRequested == 0);
+
             // Unmap any mapped memory with Vulkan
             if (pool.pMappedMemory) {
                 mVkFuncs.vkUnmapMemory(vkDevice, pool.vkDeviceMemory);
@@ -320,7 +401,7 @@ void DeviceMemMgr::freeUnusedPools() noexcept {
             poolIter = mPools.erase(poolIter);
         }
         else {
-            // This pool is still in use
+            // This pool is still in use (or hasn't been idle for long enough)
             ++poolIter;
         }
     }
@@ -368,7 +449,16 @@ bool DeviceMemMgr::allocFromAllPools(
         // Failing that try to make a new device local pool and allocate from
         // that if we haven't already exhausted all our device memory:
         if (!mbDeviceMemExhausted) {
-            if (Pool* const pPool = allocNewPool(allowedVkMemTypeBits, true, false)) {
+            Pool* pPool = allocNewPool(allowedVkMemTypeBits, true, false);
+
+            // If that failed then give back any empty pools (of other memory types) that we are holding onto and try again
+            // before falling back to RAM. Idle pools are only an optimization and not worth losing device local memory over.
+            if (!pPool) {
+                freeEmptyPools(0);
+                pPool = allocNewPool(allowedVkMemTypeBits, true, false);
+            }
+
+            if (pPool) {
                 // Note: this SHOULD succeed at this point!
                 ASSERT((pPool->vkMemoryTypeBit & allowedVkMemTypeBits) != 0);
 
@@ -457,6 +547,7 @@ bool DeviceMemMgr::allocFromPool(
     allocInfoOut.vkDeviceMemory = pool.vkDeviceMemory;
     allocInfoOut.offset = alloc.offset;
     allocInfoOut.size = alloc.size;
+    allocInfoOut.requestedSize = numBytes;
     allocInfoOut.bIsPooled = true;
     allocInfoOut.bIsDeviceLocal = pool.bIsDeviceLocal;
     allocInfoOut.bIsHostVisible = pool.bIsHostVisible;
@@ -466,6 +557,7 @@ bool DeviceMemMgr::allocFromPool(
         allocInfoOut.pBytes = pool.pMappedMemory + alloc.offset;
     }
 
+    pool.numBytesRequested += numBytes;
     return true;
 }
 
@@ -495,6 +587,7 @@ bool DeviceMemMgr::allocFromSubPool(
     allocInfoOut.vkDeviceMemory = parentPool.vkDeviceMemory;
     allocInfoOut.offset = subPool.offset + alloc.offset;
     allocInfoOut.size = alloc.size;
+    allocInfoOut.requestedSize = numBytes;
     allocInfoOut.bIsPooled = true;
     allocInfoOut.bIsDeviceLocal = parentPool.bIsDeviceLocal;
     allocInfoOut.bIsHostVisible = parentPool.bIsHostVisible;
@@ -505,6 +598,7 @@ bool DeviceMemMgr::allocFromSubPool(
         allocInfoOut.pBytes = parentPool.pMappedMemory + subPool.offset + alloc.offset;
     }
 
+    parentPool.numBytesRequested += numBytes;
     return true;
 }
 
@@ -745,6 +839,7 @@ bool DeviceMemMgr::allocUnpooled(
     alloc.vkDeviceMemory = vkDeviceMemory;
     alloc.offset = 0;
     alloc.size = numBytes;
+    alloc.requestedSize = numBytes;
     alloc.pBytes = (std::byte*) pMappedMemory;
     alloc.bIsPooled = false;
     alloc.bIsDeviceLocal = bIsMemTypeDeviceLocal;
@@ -842,7 +937,7 @@ DeviceMemMgr::MemMgrIdT DeviceMemMgr::pickNewUnpooledAllocId() noexcept {
         // Make sure this is not the invalid alloc id, and that there isn't already an alloc with this id
         if ((allocId != INVALID_MEM_MGR_ID) && (mUnpooledAllocs.find(allocId) == mUnpooledAllocs.end())) {
             // Found a valid alloc id to use. Increment the next new alloc id and return the id chosen!
-            mNextNewPoolId = allocId + 1;
+            mNextUnpooledAllocId = allocId + 1;
             return allocId;
         }
 
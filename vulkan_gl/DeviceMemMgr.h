@@ -26,6 +26,26 @@ struct VkFuncs;
 //------------------------------------------------------------------------------------------------------------------------------------------
 class DeviceMemMgr {
 public:
+    // Allocation stats for one memory pool in the manager.
+    // The capacity of the pool is always equal to the sum of the bytes in use, wasted and free.
+    struct PoolStats {
+        uint32_t    poolId;             // Id of the pool
+        bool        bIsDeviceLocal;     // Is the pool hosted on device?
+        bool        bIsHostVisible;     // Is the pool host visible and modifiable?
+        uint32_t    numSubPools;        // How many sub pools (for small allocations) are in the pool
+        uint64_t    numBytesCapacity;   // Total size of the pool
+        uint64_t    numBytesInUse;      // Number of bytes requested by allocations that are still alive
+        uint64_t    numBytesWasted;     // Number of bytes lost due to rounding allocations up to supported block sizes
+        uint64_t    numBytesFree;       // Number of bytes free in the pool, including free space in sub pools
+    };
+
+    // Allocation stats for the entire memory manager
+    struct Stats {
+        std::vector<PoolStats>  pools;                  // Stats for each memory pool
+        uint32_t                numUnpooledAllocs;      // Number of allocations made outside of any pool
+        uint64_t                numUnpooledBytes;       // Total size of all allocations made outside of any pool
+    };
+
     DeviceMemMgr(const VkFuncs& vkFuncs) noexcept;
     ~DeviceMemMgr() noexcept;
 
@@ -44,6 +64,8 @@ public:
 
     void dealloc(DeviceMemAlloc& allocInfo) noexcept;
     void freeUnusedPools() noexcept;
+    void compact() noexcept;
+    void getStats(Stats& statsOut) const noexcept;
 
 private:
     // Copy and move are disallowed
@@ -62,6 +84,10 @@ private:
     static constexpr uint32_t SUB_POOL_NUM_TIERS = 5;                           // Results in 4KB, 16KB, 64KB, 256KB, 1MB, 4MB tiers
     static constexpr uint32_t SUB_POOL_ALLOC_THRESHOLD = MAIN_POOL_UNIT_SIZE;   // Allocs smaller than this go into a sub pool
 
+    // How many consecutive compaction passes a pool or sub pool must be empty for before 'compact()' frees it.
+    // This prevents pools from being repeatedly freed and re-created in cases where allocations come & go frequently; e.g staging buffers.
+    static constexpr uint32_t COMPACT_MIN_IDLE_PASSES = 120;
+
     // Sizes for the main and sub pools
     static constexpr uint64_t MAIN_POOL_SIZE = Utils::powRecursive((uint64_t) 4, (uint64_t) MAIN_POOL_NUM_TIERS) * MAIN_POOL_UNIT_SIZE;
     static constexpr uint64_t SUB_POOL_SIZE = Utils::powRecursive((uint64_t) 4, (uint64_t) SUB_POOL_NUM_TIERS) * SUB_POOL_UNIT_SIZE;
@@ -80,12 +106,14 @@ private:
         inline SubPool() noexcept
             : offset(0)
             , subPoolId(INVALID_MEM_MGR_ID)
+            , numIdlePasses(0)
             , memMgr()
         {
         }
 
         uint64_t    offset;         // The offset of this sub-pool (in bytes) in the parent pool
         MemMgrIdT   subPoolId;      // The id of the sub-pool
+        uint32_t    numIdlePasses;  // How many consecutive compaction passes the sub-pool has been empty for
 
         // The memory manager for this pool
         AbstractFixedQTreeMemMgr<SUB_POOL_UNIT_SIZE, SUB_POOL_NUM_TIERS> memMgr;
@@ -102,6 +130,8 @@ private:
             , poolId(INVALID_MEM_MGR_ID)
             , nextNewSubPoolId(1)
             , vkMemoryTypeBit(0)
+            , numIdlePasses(0)
+            , numBytesRequested(0)
             , vkDeviceMemory(VK_NULL_HANDLE)
             , pMappedMemory(nullptr)
             , subPools()
@@ -127,6 +157,12 @@ private:
         // if the allocation can be performed using this pool.
         uint32_t vkMemoryTypeBit;
 
+        // How many consecutive compaction passes the pool has been empty for
+        uint32_t numIdlePasses;
+
+        // The total number of bytes requested by all allocations in this pool (including sub pools), before rounding up to block sizes
+        uint64_t numBytesRequested;
+
         // Pointer to the Vulkan Device memory for this pool
         VkDeviceMemory vkDeviceMemory;
 
@@ -171,6 +207,7 @@ private:
     ) noexcept;
 
     SubPool* allocNewSubPool(Pool& parentPool) noexcept;
+    void freeEmptyPools(const uint32_t minIdlePasses) noexcept;
 
     bool allocUnpooled(
         const uint64_t numBytes,
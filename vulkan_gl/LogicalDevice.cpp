@@ -36,7 +36,10 @@ LogicalDevice::LogicalDevice(VkFuncs& vkFuncs) noexcept
     , mWorkQueue(VK_NULL_HANDLE)
     , mPresentationQueueFamilyIdx(INVALID_QUEUE_FAMILY_IDX)
     , mPresentationQueue(VK_NULL_HANDLE)
+    , mTransferQueueFamilyIdx(INVALID_QUEUE_FAMILY_IDX)
+    , mTransferQueue(VK_NULL_HANDLE)
     , mCmdPool()
+    , mTransferCmdPool()
     , mDeviceMemMgr(vkFuncs)
     , mRingbufferMgr()
     , mRetirementMgr()
@@ -87,6 +90,11 @@ bool LogicalDevice::init(const PhysicalDevice& physicalDevice, const WindowSurfa
     if (!mCmdPool.init(*this, mWorkQueueFamilyIdx, true))
         return false;
 
+    if (hasDedicatedTransferQueue()) {
+        if (!mTransferCmdPool.init(*this, mTransferQueueFamilyIdx, true))
+            return false;
+    }
+
     // Initializing other managers that are contained on the device
     if (!mRingbufferMgr.init(*this))
         return false;
@@ -122,6 +130,7 @@ void LogicalDevice::destroy(const bool bForceIfInvalid) noexcept {
     mRetirementMgr.destroy();
     mRingbufferMgr.destroy();
     mDeviceMemMgr.destroy();
+    mTransferCmdPool.destroy();
     mCmdPool.destroy();
     destroyDeviceAndQueues();
 
@@ -146,9 +155,61 @@ bool LogicalDevice::submitCmdBuffer(
     const std::vector<CmdBufferWaitCond>& waitConditions,
     const Semaphore* const pSignalSemaphore,
     const Fence* const pSignalFence
+) noexcept {
+    return submitCmdBufferToQueue(mWorkQueue, cmdBuffer, waitConditions, pSignalSemaphore, pSignalFence);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Same as 'submitCmdBuffer' but submits to the dedicated transfer queue instead of the work queue.
+// The command buffer must have been allocated from the transfer command pool and the device must have a dedicated transfer queue.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool LogicalDevice::submitTransferCmdBuffer(
+    const CmdBuffer& cmdBuffer,
+    const std::vector<CmdBufferWaitCond>& waitConditions,
+    const Semaphore* const pSignalSemaphore,
+    const Fence* const pSignalFence
+) noexcept {
+    ASSERT(hasDedicatedTransferQueue());
+    ASSERT(cmdBuffer.getCmdPool() == &mTransferCmdPool);
+    return submitCmdBufferToQueue(mTransferQueue, cmdBuffer, waitConditions, pSignalSemaphore, pSignalFence);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Waits for the device to be idle. All operations will complete after this.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void LogicalDevice::waitUntilDeviceIdle() noexcept {
+    // Note: no check for 'mbIsValid' since this function is invoked during the destructor.
+    // It's called when the device is not 100% in a valid state:
+    ASSERT(mVkDevice);
+
+    if (mTransferMgr.isValid()) {
+        // Finish up all transfers before we do the cleanup below
+        mTransferMgr.executePreFrameTransferTask();
+    }
+
+    mVkFuncs.vkDeviceWaitIdle(mVkDevice);
+
+    // Do cleanup for all ringbuffer slots if we can, since the device is now completely idle
+    if (mRingbufferMgr.isValid()) {
+        mRingbufferMgr.doCleanupForAllBufferSlots();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Submit a single command buffer for execution to the specified queue.
+// Can optionally be made to wait on the given command buffer wait conditions.
+// Can optionally signal a semaphore or fence, or both.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool LogicalDevice::submitCmdBufferToQueue(
+    const VkQueue queue,
+    const CmdBuffer& cmdBuffer,
+    const std::vector<CmdBufferWaitCond>& waitConditions,
+    const Semaphore* const pSignalSemaphore,
+    const Fence* const pSignalFence
 ) noexcept {
     // Sanity checks
     ASSERT(mbIsValid);
+    ASSERT(queue);
     ASSERT(cmdBuffer.isValid());
 
     // Prepare the list of semaphores that we will wait on:
@@ -199,35 +260,14 @@ bool LogicalDevice::submitCmdBuffer(
     submitInfo.signalSemaphoreCount = numSignalSemaphores;
     submitInfo.pSignalSemaphores = &signalVkSemaphore;
 
-    if (mVkFuncs.vkQueueSubmit(mWorkQueue, 1, &submitInfo, signalVkFence) != VK_SUCCESS) {
-        ASSERT_FAIL("Failed to submit the command buffer to the graphics queue for rendering!");
+    if (mVkFuncs.vkQueueSubmit(queue, 1, &submitInfo, signalVkFence) != VK_SUCCESS) {
+        ASSERT_FAIL("Failed to submit the command buffer to the device queue!");
         return false;
     }
 
     return true;
 }
 
-//------------------------------------------------------------------------------------------------------------------------------------------
-// Waits for the device to be idle. All operations will complete after this.
-//------------------------------------------------------------------------------------------------------------------------------------------
-void LogicalDevice::waitUntilDeviceIdle() noexcept {
-    // Note: no check for 'mbIsValid' since this function is invoked during the destructor.
-    // It's called when the device is not 100% in a valid state:
-    ASSERT(mVkDevice);
-
-    if (mTransferMgr.isValid()) {
-        // Finish up all transfers before we do the cleanup below
-        mTransferMgr.executePreFrameTransferTask();
-    }
-
-    mVkFuncs.vkDeviceWaitIdle(mVkDevice);
-
-    // Do cleanup for all ringbuffer slots if we can, since the device is now completely idle
-    if (mRingbufferMgr.isValid()) {
-        mRingbufferMgr.doCleanupForAllBufferSlots();
-    }
-}
-
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Creates the Vulkan device and all of it's work queues
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -280,16 +320,26 @@ bool LogicalDevice::createDeviceAndQueues() noexcept {
         }
     }
 
+    // Use a dedicated transfer only queue for async uploads too if the device has one (optional)
+    chooseDedicatedTransferQueueFamily();
+
     // Decide how many queues we need to create.
     // We create 1 for each unique queue family that we require.
-    constexpr const uint32_t MAX_QUEUE_FAMILIES = 2;
-    uint32_t requiredQueueFamilyIdxs[MAX_QUEUE_FAMILIES] = { mWorkQueueFamilyIdx, UINT32_MAX };
+    constexpr const uint32_t MAX_QUEUE_FAMILIES = 3;
+    uint32_t requiredQueueFamilyIdxs[MAX_QUEUE_FAMILIES] = { mWorkQueueFamilyIdx, UINT32_MAX, UINT32_MAX };
     uint32_t numQueuesToCreate = 1;
 
     if (!mbIsHeadless) {
         if (mPresentationQueueFamilyIdx != mWorkQueueFamilyIdx) {
-            requiredQueueFamilyIdxs[1] = mPresentationQueueFamilyIdx;
-            numQueuesToCreate = 2;
+            requiredQueueFamilyIdxs[numQueuesToCreate] = mPresentationQueueFamilyIdx;
+            numQueuesToCreate++;
+        }
+    }
+
+    if (mTransferQueueFamilyIdx != INVALID_QUEUE_FAMILY_IDX) {
+        if ((mbIsHeadless) || (mTransferQueueFamilyIdx != mPresentationQueueFamilyIdx)) {
+            requiredQueueFamilyIdxs[numQueuesToCreate] = mTransferQueueFamilyIdx;
+            numQueuesToCreate++;
         }
     }
 
@@ -368,6 +418,8 @@ void LogicalDevice::destroyDeviceAndQueues() noexcept {
     }
 
     // Note: queues get destroyed automatically with the device, so we only null out to cleanup the references
+    mTransferQueue = VK_NULL_HANDLE;
+    mTransferQueueFamilyIdx = INVALID_QUEUE_FAMILY_IDX;
     mPresentationQueue = VK_NULL_HANDLE;
     mPresentationQueueFamilyIdx = INVALID_QUEUE_FAMILY_IDX;
     mWorkQueue = VK_NULL_HANDLE;
@@ -450,6 +502,39 @@ bool LogicalDevice::chooseOptimalPresentationQueueFamily(const std::vector<uint3
     return false;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Chooses a dedicated transfer only queue family to use for async uploads, if the device has one.
+// Only queue families without graphics or compute support are considered, since those typically map to dedicated DMA/copy hardware.
+// The queue family must also support transfers at a granularity of single texels, so that arbitrary texture regions can be uploaded.
+// If no suitable queue family is found then all transfers will just happen on the work queue.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void LogicalDevice::chooseDedicatedTransferQueueFamily() noexcept {
+    ASSERT(mpPhysicalDevice);
+
+    const std::vector<VkQueueFamilyProperties>& queueFamilyProps = mpPhysicalDevice->getQueueFamilyProps();
+    const std::vector<uint32_t>& graphicsQueueFamilies = mpPhysicalDevice->getGraphicsQueueFamilyIndexes();
+    const std::vector<uint32_t>& computeQueueFamilies = mpPhysicalDevice->getComputeQueueFamilyIndexes();
+    const std::vector<uint32_t>& transferQueueFamilies = mpPhysicalDevice->getTransferQueueFamilyIndexes();
+
+    for (const uint32_t queueFamilyIdx : transferQueueFamilies) {
+        if (Utils::containerContains(graphicsQueueFamilies, queueFamilyIdx))
+            continue;
+
+        if (Utils::containerContains(computeQueueFamilies, queueFamilyIdx))
+            continue;
+
+        const VkExtent3D& granularity = queueFamilyProps[queueFamilyIdx].minImageTransferGranularity;
+
+        if ((granularity.width != 1) || (granularity.height != 1) || (granularity.depth != 1))
+            continue;
+
+        mTransferQueueFamilyIdx = queueFamilyIdx;
+        return;
+    }
+
+    mTransferQueueFamilyIdx = INVALID_QUEUE_FAMILY_IDX;
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Gather all queue handles for created queues after device creation. Returns false on failure.
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -478,6 +563,10 @@ bool LogicalDevice::gatherCreatedQueueHandles(
                         mPresentationQueue = queue;
                     }
                 }
+
+                if (queueFamilyIdx == mTransferQueueFamilyIdx) {
+                    mTransferQueue = queue;
+                }
             }
         }
 
@@ -497,6 +586,11 @@ bool LogicalDevice::gatherCreatedQueueHandles(
         }
     }
 
+    // The dedicated transfer queue is optional: just do all transfers on the work queue if it could not be obtained
+    if (!mTransferQueue) {
+        mTransferQueueFamilyIdx = INVALID_QUEUE_FAMILY_IDX;
+    }
+
     // If we got to here then this all went well
     return true;
 }
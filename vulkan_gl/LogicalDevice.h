@@ -44,11 +44,15 @@ public:
     inline VkQueue getWorkQueue() const noexcept { return mWorkQueue; }
     inline uint32_t getPresentationQueueFamilyIdx() const noexcept { return mPresentationQueueFamilyIdx; }
     inline VkQueue getPresentationQueue() const noexcept { return mPresentationQueue; }
+    inline uint32_t getTransferQueueFamilyIdx() const noexcept { return mTransferQueueFamilyIdx; }
+    inline VkQueue getTransferQueue() const noexcept { return mTransferQueue; }
+    inline bool hasDedicatedTransferQueue() const noexcept { return (mTransferQueue != VK_NULL_HANDLE); }
     inline DeviceMemMgr& getDeviceMemMgr() noexcept { return mDeviceMemMgr; }
     inline RingbufferMgr& getRingbufferMgr() noexcept { return mRingbufferMgr; }
     inline RetirementMgr& getRetirementMgr() noexcept { return mRetirementMgr; }
     inline TransferMgr& getTransferMgr() noexcept { return mTransferMgr; }
     inline CmdPool& getCmdPool() noexcept { return mCmdPool; }
+    inline CmdPool& getTransferCmdPool() noexcept { return mTransferCmdPool; }
 
     bool submitCmdBuffer(
         const CmdBuffer& cmdBuffer,
@@ -57,6 +61,13 @@ public:
         const Fence* const pSignalFence
     ) noexcept;
 
+    bool submitTransferCmdBuffer(
+        const CmdBuffer& cmdBuffer,
+        const std::vector<CmdBufferWaitCond>& waitConditions,
+        const Semaphore* const pSignalSemaphore,
+        const Fence* const pSignalFence
+    ) noexcept;
+
     void waitUntilDeviceIdle() noexcept;
 
 private:
@@ -70,6 +81,15 @@ private:
     void destroyDeviceAndQueues() noexcept;
     bool chooseOptimalWorkQueueFamily(const std::vector<uint32_t>& validPresentationQueueFamilies) noexcept;
     bool chooseOptimalPresentationQueueFamily(const std::vector<uint32_t>& validPresentationQueueFamilies) noexcept;
+    void chooseDedicatedTransferQueueFamily() noexcept;
+
+    bool submitCmdBufferToQueue(
+        const VkQueue queue,
+        const CmdBuffer& cmdBuffer,
+        const std::vector<CmdBufferWaitCond>& waitConditions,
+        const Semaphore* const pSignalSemaphore,
+        const Fence* const pSignalFence
+    ) noexcept;
 
     bool gatherCreatedQueueHandles(
         const VkDeviceQueueCreateInfo* const pQueueCreateInfos, 
@@ -87,7 +107,10 @@ private:
     VkQueue                 mWorkQueue;                     // Handle to the queue that supports graphics + compute + transfer operations
     uint32_t                mPresentationQueueFamilyIdx;    // The index of the queue family the presentation queue belongs to
     VkQueue                 mPresentationQueue;             // Handle to the presentation queue for the device
+    uint32_t                mTransferQueueFamilyIdx;        // The index of the dedicated transfer only queue family, or invalid if there is no such queue family
+    VkQueue                 mTransferQueue;                 // Handle to the dedicated transfer only queue (if the device has one), null otherwise
     CmdPool                 mCmdPool;                       // A command pool used by the transfer manager and possibly application code too
+    CmdPool                 mTransferCmdPool;               // A command pool for command buffers submitted to the dedicated transfer queue (if the device has one)
     DeviceMemMgr            mDeviceMemMgr;                  // Used for allocating Vulkan device memory
     RingbufferMgr           mRingbufferMgr;                 // Keeps track of which ringbuffer we are on and holds sync primitives for ringbuffers
     RetirementMgr           mRetirementMgr;                 // Manages the retirement of resources that may be in used by currently processing frames
@@ -3,6 +3,7 @@
 #include "Finally.h"
 #include "LogicalDevice.h"
 #include "PhysicalDevice.h"
+#include "PipelineCache.h"
 #include "PipelineLayout.h"
 #include "RenderPass.h"
 #include "RetirementMgr.h"
@@ -65,7 +66,8 @@ bool Pipeline::initGraphicsPipeline(
     const PipelineRasterizationState& rasterizationState,
     const PipelineMultisampleState& multisampleState,
     const PipelineColorBlendState& colorBlendState,
-    const PipelineDepthStencilState& depthStencilState
+    const PipelineDepthStencilState& depthStencilState,
+    const PipelineCache* const pPipelineCache
 ) noexcept {
     //------------------------------------------------------------------------------------------------------------------
     // The basics
@@ -258,8 +260,9 @@ bool Pipeline::initGraphicsPipeline(
     pipelineCI.basePipelineIndex = -1;                  // Used when creating derived pipelines
 
     const VkFuncs& vkFuncs = device.getVkFuncs();
+    const VkPipelineCache vkPipelineCache = (pPipelineCache) ? pPipelineCache->getVkPipelineCache() : VK_NULL_HANDLE;
 
-    if (vkFuncs.vkCreateGraphicsPipelines(device.getVkDevice(), VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &mVkPipeline) != VK_SUCCESS) {
+    if (vkFuncs.vkCreateGraphicsPipelines(device.getVkDevice(), vkPipelineCache, 1, &pipelineCI, nullptr, &mVkPipeline) != VK_SUCCESS) {
         ASSERT_FAIL("Failed to create a graphics pipeline!");
         return false;
     }
@@ -277,7 +280,8 @@ bool Pipeline::initGraphicsPipeline(
 bool Pipeline::initComputePipeline(
     const VkPipelineLayout& pipelineLayout,
     const ShaderModule& shaderModule,
-    const VkSpecializationInfo* const pShaderSpecializationInfo
+    const VkSpecializationInfo* const pShaderSpecializationInfo,
+    const PipelineCache* const pPipelineCache
 ) noexcept {
     //------------------------------------------------------------------------------------------------------------------
     // The basics
@@ -319,8 +323,9 @@ bool Pipeline::initComputePipeline(
     pipelineCI.basePipelineIndex = -1;                  // Used when creating derived pipelines
 
     const VkFuncs& vkFuncs = device.getVkFuncs();
+    const VkPipelineCache vkPipelineCache = (pPipelineCache) ? pPipelineCache->getVkPipelineCache() : VK_NULL_HANDLE;
 
-    if (vkFuncs.vkCreateComputePipelines(device.getVkDevice(), VK_NULL_HANDLE, 1, &pipelineCI, nullptr, &mVkPipeline) != VK_SUCCESS) {
+    if (vkFuncs.vkCreateComputePipelines(device.getVkDevice(), vkPipelineCache, 1, &pipelineCI, nullptr, &mVkPipeline) != VK_SUCCESS) {
         ASSERT_FAIL("Failed to create a compute pipeline!");
         return false;
     }
@@ -0,0 +1,129 @@
+#include "PipelineCache.h"
+
+#include "Finally.h"
+#include "LogicalDevice.h"
+#include "VkFuncs.h"
+
+BEGIN_NAMESPACE(vgl)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates an uninitialized pipeline cache
+//------------------------------------------------------------------------------------------------------------------------------------------
+PipelineCache::PipelineCache() noexcept
+    : mbIsValid(false)
+    , mpDevice(nullptr)
+    , mVkPipelineCache(VK_NULL_HANDLE)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Move constructor: relocate a pipeline cache to this object
+//------------------------------------------------------------------------------------------------------------------------------------------
+PipelineCache::PipelineCache(PipelineCache&& other) noexcept
+    : mbIsValid(other.mbIsValid)
+    , mpDevice(other.mpDevice)
+    , mVkPipelineCache(other.mVkPipelineCache)
+{
+    other.mbIsValid = false;
+    other.mpDevice = nullptr;
+    other.mVkPipelineCache = VK_NULL_HANDLE;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Automatically destroys the pipeline cache
+//------------------------------------------------------------------------------------------------------------------------------------------
+PipelineCache::~PipelineCache() noexcept {
+    destroy();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Initializes the pipeline cache, optionally with data previously retrieved from a pipeline cache.
+// Note that the Vulkan implementation will silently ignore the initial data if it is incompatible with the device.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool PipelineCache::init(LogicalDevice& device, const void* const pInitialData, const size_t initialDataSize) noexcept {
+    // Preconditions
+    ASSERT_LOG((!mbIsValid), "Must call destroy() before re-initializing!");
+    ASSERT(device.getVkDevice());
+    ASSERT(pInitialData || (initialDataSize == 0));
+
+    // If anything goes wrong, cleanup on exit - don't half initialize!
+    auto cleanupOnError = finally([&]{
+        if (!mbIsValid) {
+            destroy(true);
+        }
+    });
+
+    // Save for future reference
+    mpDevice = &device;
+
+    // Create the pipeline cache
+    VkPipelineCacheCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+    createInfo.initialDataSize = initialDataSize;
+    createInfo.pInitialData = pInitialData;
+
+    const VkFuncs& vkFuncs = device.getVkFuncs();
+
+    if (vkFuncs.vkCreatePipelineCache(mpDevice->getVkDevice(), &createInfo, nullptr, &mVkPipelineCache) != VK_SUCCESS) {
+        ASSERT_FAIL("Failed to create a Vulkan pipeline cache object!");
+        return false;
+    }
+
+    // Success!
+    mbIsValid = true;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Destroys the pipeline cache and releases its resources
+//------------------------------------------------------------------------------------------------------------------------------------------
+void PipelineCache::destroy(const bool bForceIfInvalid) noexcept {
+    // Only destroy if we need to
+    if ((!mbIsValid) && (!bForceIfInvalid))
+        return;
+
+    // Preconditions
+    ASSERT_LOG((!mpDevice) || mpDevice->getVkDevice(), "Parent device must still be valid if defined!");
+
+    // Cleanup and destroy the Vulkan pipeline cache
+    mbIsValid = false;
+
+    if (mVkPipelineCache) {
+        ASSERT(mpDevice && mpDevice->getVkDevice());
+        const VkFuncs& vkFuncs = mpDevice->getVkFuncs();
+        vkFuncs.vkDestroyPipelineCache(mpDevice->getVkDevice(), mVkPipelineCache, nullptr);
+        mVkPipelineCache = VK_NULL_HANDLE;
+    }
+
+    mpDevice = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Retrieves the current data for the pipeline cache, so that it can be saved and used to initialize a pipeline cache later on.
+// Returns 'false' on failure, in which case the output data will be empty.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool PipelineCache::getData(std::vector<std::byte>& dataOut) const noexcept {
+    ASSERT(mbIsValid);
+    dataOut.clear();
+
+    // Get the size of the data first and then the data itself.
+    // Note that the cache should not be modified in the meantime, since it's not in use on any other threads.
+    const VkFuncs& vkFuncs = mpDevice->getVkFuncs();
+    const VkDevice vkDevice = mpDevice->getVkDevice();
+    size_t dataSize = 0;
+
+    if (vkFuncs.vkGetPipelineCacheData(vkDevice, mVkPipelineCache, &dataSize, nullptr) != VK_SUCCESS)
+        return false;
+
+    dataOut.resize(dataSize);
+
+    if (vkFuncs.vkGetPipelineCacheData(vkDevice, mVkPipelineCache, &dataSize, dataOut.data()) != VK_SUCCESS) {
+        dataOut.clear();
+        return false;
+    }
+
+    dataOut.resize(dataSize);
+    return true;
+}
+
+END_NAMESPACE(vgl)
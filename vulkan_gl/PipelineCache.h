@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Macros.h"
+
+#include <cstddef>
+#include <vector>
+#include <vulkan/vulkan.h>
+
+BEGIN_NAMESPACE(vgl)
+
+class LogicalDevice;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Represents a Vulkan pipeline cache.
+// A pipeline cache allows the results of pipeline compilation to be re-used across pipelines, and across runs of the application if the
+// cache data is saved and then used to initialize the cache again later.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class PipelineCache {
+public:
+    PipelineCache() noexcept;
+    PipelineCache(PipelineCache&& other) noexcept;
+    ~PipelineCache() noexcept;
+
+    bool init(LogicalDevice& device, const void* const pInitialData, const size_t initialDataSize) noexcept;
+    void destroy(const bool bForceIfInvalid = false) noexcept;
+    bool getData(std::vector<std::byte>& dataOut) const noexcept;
+
+    inline bool isValid() const noexcept { return mbIsValid; }
+    inline LogicalDevice* getDevice() const noexcept { return mpDevice; }
+    inline VkPipelineCache getVkPipelineCache() const noexcept { return mVkPipelineCache; }
+
+private:
+    // Copy and move assign are disallowed
+    PipelineCache(const PipelineCache& other) = delete;
+    PipelineCache& operator = (const PipelineCache& other) = delete;
+    PipelineCache& operator = (PipelineCache&& other) = delete;
+
+    bool                mbIsValid;
+    LogicalDevice*      mpDevice;
+    VkPipelineCache     mVkPipelineCache;
+};
+
+END_NAMESPACE(vgl)
@@ -0,0 +1,136 @@
+#include "QueryPool.h"
+
+#include "Finally.h"
+#include "LogicalDevice.h"
+#include "VkFuncs.h"
+
+BEGIN_NAMESPACE(vgl)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates an uninitialized query pool
+//------------------------------------------------------------------------------------------------------------------------------------------
+QueryPool::QueryPool() noexcept
+    : mbIsValid(false)
+    , mpDevice(nullptr)
+    , mQueryType(VK_QUERY_TYPE_TIMESTAMP)
+    , mNumQueries(0)
+    , mVkQueryPool(VK_NULL_HANDLE)
+{
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Move constructor: relocate query pool to this object
+//------------------------------------------------------------------------------------------------------------------------------------------
+QueryPool::QueryPool(QueryPool&& other) noexcept
+    : mbIsValid(other.mbIsValid)
+    , mpDevice(other.mpDevice)
+    , mQueryType(other.mQueryType)
+    , mNumQueries(other.mNumQueries)
+    , mVkQueryPool(other.mVkQueryPool)
+{
+    other.mbIsValid = false;
+    other.mpDevice = nullptr;
+    other.mQueryType = VK_QUERY_TYPE_TIMESTAMP;
+    other.mNumQueries = 0;
+    other.mVkQueryPool = VK_NULL_HANDLE;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Automatically destroys the query pool
+//------------------------------------------------------------------------------------------------------------------------------------------
+QueryPool::~QueryPool() noexcept {
+    destroy();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Attempts to initialize the query pool with the given number of queries of the given type and returns 'true' if successful.
+// Note: pipeline statistics queries are not supported since they require extra info on creation.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool QueryPool::init(LogicalDevice& device, const VkQueryType queryType, const uint32_t numQueries) noexcept {
+    // Preconditions
+    ASSERT_LOG((!mbIsValid), "Must call destroy() before re-initializing!");
+    ASSERT(device.getVkDevice());
+    ASSERT(queryType != VK_QUERY_TYPE_PIPELINE_STATISTICS);
+    ASSERT(numQueries > 0);
+
+    // If anything goes wrong, cleanup on exit - don't half initialize!
+    auto cleanupOnError = finally([&]{
+        if (!mbIsValid) {
+            destroy(true);
+        }
+    });
+
+    // Save for later cleanup
+    mpDevice = &device;
+    mQueryType = queryType;
+    mNumQueries = numQueries;
+
+    // Create the query pool itself
+    const VkFuncs& vkFuncs = device.getVkFuncs();
+
+    VkQueryPoolCreateInfo createInfo = {};
+    createInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+    createInfo.queryType = queryType;
+    createInfo.queryCount = numQueries;
+
+    if (vkFuncs.vkCreateQueryPool(device.getVkDevice(), &createInfo, nullptr, &mVkQueryPool) != VK_SUCCESS) {
+        ASSERT_FAIL("Failed to create a Vulkan query pool!");
+        return false;
+    }
+
+    // Success!
+    mbIsValid = true;
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Destroys the query pool and releases its resources
+//------------------------------------------------------------------------------------------------------------------------------------------
+void QueryPool::destroy(const bool bForceIfInvalid) noexcept {
+    // Only destroy if we need to
+    if ((!mbIsValid) && (!bForceIfInvalid))
+        return;
+
+    // Preconditions
+    ASSERT_LOG(((!mpDevice) || mpDevice->getVkDevice()), "Parent device must still be valid if defined!");
+
+    // Destroy the query pool
+    mbIsValid = false;
+
+    if (mVkQueryPool) {
+        ASSERT(mpDevice && mpDevice->getVkDevice());
+        const VkFuncs& vkFuncs = mpDevice->getVkFuncs();
+        vkFuncs.vkDestroyQueryPool(mpDevice->getVkDevice(), mVkQueryPool, nullptr);
+        mVkQueryPool = VK_NULL_HANDLE;
+    }
+
+    mQueryType = VK_QUERY_TYPE_TIMESTAMP;
+    mNumQueries = 0;
+    mpDevice = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads back the 64-bit results for the given range of queries without waiting.
+// Returns 'false' if the results of any of the queries are not yet available or if there was an error.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool QueryPool::getResults(const uint32_t firstQuery, const uint32_t numQueries, uint64_t* const pResults) const noexcept {
+    ASSERT(mbIsValid);
+    ASSERT(firstQuery + numQueries <= mNumQueries);
+    ASSERT(pResults);
+
+    const VkFuncs& vkFuncs = mpDevice->getVkFuncs();
+    const VkResult result = vkFuncs.vkGetQueryPoolResults(
+        mpDevice->getVkDevice(),
+        mVkQueryPool,
+        firstQuery,
+        numQueries,
+        sizeof(uint64_t) * numQueries,
+        pResults,
+        sizeof(uint64_t),
+        VK_QUERY_RESULT_64_BIT
+    );
+
+    return (result == VK_SUCCESS);
+}
+
+END_NAMESPACE(vgl)
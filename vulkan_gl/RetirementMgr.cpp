@@ -128,6 +128,9 @@ void RetirementMgr::freeRetiredResourcesForAllRingbufferSlots() noexcept {
     #if ASSERTS_ENABLED == 1
         mbDebugIsDestroyingResources = false;
     #endif
+
+    // All rendering operations are finished, so this is a good time to give back all unused device memory
+    mpDevice->getDeviceMemMgr().freeUnusedPools();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -151,6 +154,9 @@ void RetirementMgr::freeRetiredResourcesForRingbufferIndex(const uint8_t ringbuf
     #if ASSERTS_ENABLED == 1
         mbDebugIsDestroyingResources = false;
     #endif
+
+    // Do an idle time compaction of device memory now that the memory for the resources just freed is available again
+    mpDevice->getDeviceMemMgr().compact();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -17,6 +17,7 @@ Texture::Texture() noexcept
     : BaseTexture()
     , mbDidATextureUpload(false)
     , mLockedVkStagingBuffer(VK_NULL_HANDLE)
+    , mLockedStagingOffset(0)
     , mpLockedBytes(nullptr)
     , mLockedSizeInBytes(0)
     , mLockedOffsetX(0)
@@ -37,6 +38,7 @@ Texture::Texture(Texture&& other) noexcept
     : BaseTexture(std::move(other))
     , mbDidATextureUpload(other.mbDidATextureUpload)
     , mLockedVkStagingBuffer(other.mLockedVkStagingBuffer)
+    , mLockedStagingOffset(other.mLockedStagingOffset)
     , mpLockedBytes(other.mpLockedBytes)
     , mLockedSizeInBytes(other.mLockedSizeInBytes)
     , mLockedOffsetX(other.mLockedOffsetX)
@@ -50,6 +52,7 @@ Texture::Texture(Texture&& other) noexcept
 {
     other.mbDidATextureUpload = false;
     other.mLockedVkStagingBuffer = VK_NULL_HANDLE;
+    other.mLockedStagingOffset = 0;
     other.mpLockedBytes = nullptr;
     other.mLockedSizeInBytes = 0;
     other.mLockedOffsetX = 0;
@@ -329,6 +332,7 @@ std::byte* Texture::lock(
 
     // All good, save the details of the buffer, locked region and return the locked memory
     mLockedVkStagingBuffer = buffer.vkBuffer;
+    mLockedStagingOffset = buffer.offset;
     mpLockedBytes = buffer.pBytes;
     mLockedOffsetX = offsetX;
     mLockedOffsetY = offsetY;
@@ -373,7 +377,7 @@ void Texture::unlock(TransferTask* const pTransferTaskOverride) noexcept {
         mLockedVkStagingBuffer,
         *this,
         oldVkImageLayout,
-        0,
+        mLockedStagingOffset,
         mLockedOffsetX,
         mLockedOffsetY,
         mLockedOffsetZ,
@@ -386,6 +390,7 @@ void Texture::unlock(TransferTask* const pTransferTaskOverride) noexcept {
 
     // Clear the lock details
     mLockedVkStagingBuffer = VK_NULL_HANDLE;
+    mLockedStagingOffset = 0;
     mpLockedBytes = nullptr;
     mLockedSizeInBytes = 0;
     mLockedOffsetX = 0;
@@ -401,4 +406,45 @@ void Texture::unlock(TransferTask* const pTransferTaskOverride) noexcept {
     mbDidATextureUpload = true;
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Schedule an upload of multiple regions of the texture from the given buffer, as one transfer operation.
+// This is cheaper than locking and unlocking each region individually, since image layout transitions are only done once.
+//
+// Optionally the upload can be scheduled to happen against the specified transfer task.
+// If not specified, then the global 'pre-frame' transfer task is used by default.
+//
+// Notes:
+//  (1) Only supported for textures with a single mipmap level and layer.
+//  (2) The source buffer is typically a temporary staging buffer allocated via the transfer manager.
+//      It must remain valid until the transfer completes.
+//  (3) The texture must have been uploaded to fully at least once previously, since the existing texture contents are preserved.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void Texture::uploadRegions(
+    const VkBuffer srcVkBuffer,
+    const VkBufferImageCopy* const pRegions,
+    const uint32_t numRegions,
+    TransferTask* const pTransferTaskOverride
+) noexcept {
+    // Preconditions
+    ASSERT(mbIsValid);
+    ASSERT(mpDevice && mpDevice->getVkDevice());
+    ASSERT_LOG(!isLocked(), "Can't upload regions while the texture is locked!");
+    ASSERT(mbDidATextureUpload);
+    ASSERT((mNumMipLevels == 1) && (mNumLayers == 1));
+
+    if (numRegions == 0)
+        return;
+
+    // Schedule the data transfer for the regions and image layout transitions
+    TransferTask* pDstTask;
+
+    if (!pTransferTaskOverride) {
+        pDstTask = &mpDevice->getTransferMgr().getPreFrameTransferTask();
+    } else {
+        pDstTask = pTransferTaskOverride;
+    }
+
+    pDstTask->addTextureRegionsUpload(srcVkBuffer, *this, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, pRegions, numRegions);
+}
+
 END_NAMESPACE(vgl)
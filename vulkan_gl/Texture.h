@@ -84,6 +84,13 @@ public:
 
     void unlock(TransferTask* const pTransferTaskOverride = nullptr) noexcept;
 
+    void uploadRegions(
+        const VkBuffer srcVkBuffer,
+        const VkBufferImageCopy* const pRegions,
+        const uint32_t numRegions,
+        TransferTask* const pTransferTaskOverride = nullptr
+    ) noexcept;
+
     inline bool didATextureUpload() const noexcept { return mbDidATextureUpload; }
     inline std::byte* getLockedBytes() const noexcept { return mpLockedBytes; }
     inline uint64_t getLockedSizeInBytes() const noexcept { return mLockedSizeInBytes; }
@@ -104,6 +111,7 @@ private:
 
     bool            mbDidATextureUpload;        // Flag set to true after we schedule the first texture upload (might not have EXECUTED yet!)
     VkBuffer        mLockedVkStagingBuffer;     // If the texture is locked this is the staging buffer being used for transfer
+    uint64_t        mLockedStagingOffset;       // If the texture is locked this is the offset of the locked data within the staging buffer
     std::byte*      mpLockedBytes;              // If the texture is locked then these are the data bytes locked
     uint64_t        mLockedSizeInBytes;         // Size of the locked area in bytes including padding between mipmap levels, minimum block size alignment etc.
     uint32_t        mLockedOffsetX;             // Currently locked area: offset x
@@ -9,6 +9,9 @@
 #include "RawBuffer.h"
 #include "RingbufferMgr.h"
 #include "TransferTask.h"
+#include "Utils.h"
+
+#include <algorithm>
 
 BEGIN_NAMESPACE(vgl)
 
@@ -19,7 +22,9 @@ TransferMgr::TransferMgr() noexcept
     : mbIsValid(false)
     , mpDevice(nullptr)
     , mpRingbufferMgr(nullptr)
+    , mbHaveTransferQueue(false)
     , mPreFrameTransferTask()
+    , mAsyncUploadTask()
     , mRingbufferSlots()
 {
 }
@@ -43,6 +48,7 @@ bool TransferMgr::init(LogicalDevice& device) noexcept {
     // Save for later use
     mpDevice = &device;
     mpRingbufferMgr = &device.getRingbufferMgr();
+    mbHaveTransferQueue = device.hasDedicatedTransferQueue();
 
     // If anything goes wrong, cleanup on exit - don't half initialize!
     auto cleanupOnError = finally([&]{
@@ -57,6 +63,24 @@ bool TransferMgr::init(LogicalDevice& device) noexcept {
             return false;
 
         slot.tmpStagingBuffers.reserve(32);
+        slot.stagingBlocks.reserve(MAX_RETAINED_STAGING_BLOCKS);
+        slot.curStagingBlockIdx = 0;
+        slot.curStagingBlockOffset = 0;
+
+        // Resources for async uploads are only needed if there is a dedicated transfer queue to do them on
+        if (mbHaveTransferQueue) {
+            if (!slot.ownershipReleaseCmdBuffer.init(device.getCmdPool(), VK_COMMAND_BUFFER_LEVEL_PRIMARY))
+                return false;
+
+            if (!slot.asyncUploadCmdBuffer.init(device.getTransferCmdPool(), VK_COMMAND_BUFFER_LEVEL_PRIMARY))
+                return false;
+
+            if (!slot.ownershipReleasedSemaphore.init(device))
+                return false;
+
+            if (!slot.asyncUploadDoneSemaphore.init(device))
+                return false;
+        }
     }
 
     // Successful at this point!
@@ -76,27 +100,45 @@ void TransferMgr::destroy(const bool bForceIfInvalid) noexcept {
     ASSERT((!mpDevice) || mpDevice->getVkDevice());
 
     for (RingbufferSlot& slot : mRingbufferSlots) {
+        slot.asyncUploadDoneSemaphore.destroy();
+        slot.ownershipReleasedSemaphore.destroy();
+        slot.asyncUploadCmdBuffer.destroy();
+        slot.ownershipReleaseCmdBuffer.destroy();
         slot.cmdBuffer.destroy();
         slot.tmpStagingBuffers.clear();
         slot.tmpStagingBuffers.shrink_to_fit();
+        slot.stagingBlocks.clear();
+        slot.stagingBlocks.shrink_to_fit();
+        slot.curStagingBlockIdx = 0;
+        slot.curStagingBlockOffset = 0;
     }
 
+    mAsyncUploadTask.clearCmds(true);
     mPreFrameTransferTask.clearCmds(true);
+    mbHaveTransferQueue = false;
     mpRingbufferMgr = nullptr;
     mpDevice = nullptr;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Attempts to allocate a temporary raw staging buffer that can be used to schedule transfers.
-// The buffer is automatically destroyed the next time we start a frame on the current ringbuffer index.
+// The buffer is automatically freed the next time we start a frame on the current ringbuffer index.
+//
+// Small allocations are packed together into shared staging buffer blocks which are re-used from frame to frame, instead of each getting
+// their own Vulkan buffer. Transfers must therefore always use the offset of the returned allocation within its buffer.
 //------------------------------------------------------------------------------------------------------------------------------------------
 TransferMgr::StagingBuffer TransferMgr::allocTempStagingBuffer(const uint64_t numBytes) noexcept {
     // Preconditions
     ASSERT(mbIsValid);
     ASSERT(mpDevice && mpDevice->getVkDevice());
 
-    // Alloc the raw staging buffer
+    // Pack small allocations into the shared staging buffer blocks
     RingbufferSlot& ringbufferSlot = getCurrentRingbufferSlot();
+
+    if (numBytes <= MAX_PACKED_STAGING_ALLOC_SIZE)
+        return allocPackedStagingBuffer(ringbufferSlot, numBytes);
+
+    // Otherwise alloc a raw staging buffer just for this allocation
     std::vector<RawBuffer>& tmpBuffers = ringbufferSlot.tmpStagingBuffers;
     RawBuffer& tmpBuffer = tmpBuffers.emplace_back();
 
@@ -121,6 +163,7 @@ TransferMgr::StagingBuffer TransferMgr::allocTempStagingBuffer(const uint64_t nu
     return StagingBuffer {
         tmpBuffer.getBytes(),
         tmpBuffer.getVkBuffer(),
+        0,
         tmpBuffer.getSize()
     };
 }
@@ -133,14 +176,19 @@ TransferMgr::StagingBuffer TransferMgr::allocTempStagingBuffer(const uint64_t nu
 //  (1) This should only be called ONCE per frame.
 //  (2) Clears the pre-frame transfer task upon submitting to the GPU.
 //  (3) If there are no transfers to execute then this call is a no-op.
+//  (4) Also kicks off the async upload task on the dedicated transfer queue (if there is one).
+//      The pre-frame transfer task waits for the async uploads to finish before it begins executing.
 //------------------------------------------------------------------------------------------------------------------------------------------
 bool TransferMgr::executePreFrameTransferTask() noexcept {
     // Preconditions: must be valid and device must be valid
     ASSERT(mbIsValid);
     ASSERT(mpDevice && mpDevice->getVkDevice());
 
-    // If there is no work to be done then just bail
-    if (mPreFrameTransferTask.isEmpty())
+    // If there is no work to be done then just bail.
+    // Note that the async upload task can only have commands if there is a dedicated transfer queue.
+    const bool bDoAsyncUploads = (!mAsyncUploadTask.isEmpty());
+
+    if (mPreFrameTransferTask.isEmpty() && (!bDoAsyncUploads))
         return true;
 
     // Otherwise record the transfer task to the command buffer for this ringbuffer index
@@ -151,13 +199,24 @@ bool TransferMgr::executePreFrameTransferTask() noexcept {
     if (!cmdRecorder.beginPrimaryCmdBuffer(cmdBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT))
         return false;
 
+    if (bDoAsyncUploads) {
+        if (!executeAsyncUploadTask(ringbufferSlot, cmdBuffer))
+            return false;
+    }
+
     mPreFrameTransferTask.submitToCmdBuffer(cmdBuffer);
 
     if (!cmdRecorder.endCmdBuffer())
         return false;
 
-    // Finally begin execution of the command buffer against the device
-    return mpDevice->submitCmdBuffer(cmdBuffer, {}, nullptr, nullptr);
+    // Finally begin execution of the command buffer against the device.
+    // If async uploads were kicked off then it must wait for those to finish first.
+    if (bDoAsyncUploads) {
+        const CmdBufferWaitCond asyncUploadsDone(&ringbufferSlot.asyncUploadDoneSemaphore, VK_PIPELINE_STAGE_ALL_COMMANDS_BIT);
+        return mpDevice->submitCmdBuffer(cmdBuffer, { asyncUploadsDone }, nullptr, nullptr);
+    } else {
+        return mpDevice->submitCmdBuffer(cmdBuffer, {}, nullptr, nullptr);
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -172,6 +231,127 @@ void TransferMgr::doCleanupForRingbufferIndex(const uint8_t ringbufferIndex) noe
 
     RingbufferSlot& ringbufferSlot = mRingbufferSlots[ringbufferIndex];
     ringbufferSlot.tmpStagingBuffers.clear();
+
+    // The shared staging buffer blocks can be re-used again from the start, but don't hold onto too many of them
+    if (ringbufferSlot.stagingBlocks.size() > MAX_RETAINED_STAGING_BLOCKS) {
+        ringbufferSlot.stagingBlocks.resize(MAX_RETAINED_STAGING_BLOCKS);
+    }
+
+    ringbufferSlot.curStagingBlockIdx = 0;
+    ringbufferSlot.curStagingBlockOffset = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Kicks off the async upload task on the dedicated transfer queue and records the barriers needed to hand ownership of the uploaded
+// textures back to the work queue into the given pre-frame command buffer (which must be recording).
+// The pre-frame command buffer must wait on the async upload done semaphore for the current ringbuffer slot when submitted.
+//
+// The steps involved are:
+//  (1) A work queue submission releases ownership of the upload destinations to the transfer queue.
+//      This also ensures that all previously submitted work queue commands are done with the textures before the uploads begin.
+//  (2) The transfer queue waits for the release, acquires ownership, does the uploads and releases ownership back to the work queue.
+//  (3) The pre-frame command buffer re-acquires ownership of the textures on the work queue after the uploads are done.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool TransferMgr::executeAsyncUploadTask(RingbufferSlot& ringbufferSlot, CmdBuffer& preFrameCmdBuffer) noexcept {
+    ASSERT(mbHaveTransferQueue);
+    ASSERT(!mAsyncUploadTask.isEmpty());
+    ASSERT(mAsyncUploadTask.hasOnlyTextureUploads());
+
+    const VkFuncs& vkFuncs = mpDevice->getVkFuncs();
+    const uint32_t workQueueFamilyIdx = mpDevice->getWorkQueueFamilyIdx();
+    const uint32_t transferQueueFamilyIdx = mpDevice->getTransferQueueFamilyIdx();
+
+    // Re-acquire ownership on the work queue at the start of the pre-frame command buffer.
+    // Note: must record this before the async task is submitted, since that clears the list of commands.
+    mAsyncUploadTask.recordOwnershipAcquireBarriers(preFrameCmdBuffer, workQueueFamilyIdx, transferQueueFamilyIdx);
+
+    // Release ownership of the upload destinations to the transfer queue
+    {
+        CmdBuffer& cmdBuffer = ringbufferSlot.ownershipReleaseCmdBuffer;
+        CmdBufferRecorder cmdRecorder(vkFuncs);
+
+        if (!cmdRecorder.beginPrimaryCmdBuffer(cmdBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT))
+            return false;
+
+        mAsyncUploadTask.recordOwnershipReleaseBarriers(cmdBuffer, workQueueFamilyIdx, transferQueueFamilyIdx);
+
+        if (!cmdRecorder.endCmdBuffer())
+            return false;
+
+        if (!mpDevice->submitCmdBuffer(cmdBuffer, {}, &ringbufferSlot.ownershipReleasedSemaphore, nullptr))
+            return false;
+    }
+
+    // Do the uploads on the transfer queue once the release has happened
+    CmdBuffer& cmdBuffer = ringbufferSlot.asyncUploadCmdBuffer;
+    CmdBufferRecorder cmdRecorder(vkFuncs);
+
+    if (!cmdRecorder.beginPrimaryCmdBuffer(cmdBuffer, VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT))
+        return false;
+
+    mAsyncUploadTask.submitToCmdBuffer(cmdBuffer, workQueueFamilyIdx, transferQueueFamilyIdx);
+
+    if (!cmdRecorder.endCmdBuffer())
+        return false;
+
+    const CmdBufferWaitCond ownershipReleased(&ringbufferSlot.ownershipReleasedSemaphore, VK_PIPELINE_STAGE_TRANSFER_BIT);
+    return mpDevice->submitTransferCmdBuffer(cmdBuffer, { ownershipReleased }, &ringbufferSlot.asyncUploadDoneSemaphore, nullptr);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocates a small temporary staging buffer from the shared staging buffer blocks for the given ringbuffer slot.
+// Moves onto the next block (creating it if required) if there is not enough room left in the current one.
+//------------------------------------------------------------------------------------------------------------------------------------------
+TransferMgr::StagingBuffer TransferMgr::allocPackedStagingBuffer(RingbufferSlot& ringbufferSlot, const uint64_t numBytes) noexcept {
+    ASSERT(numBytes <= MAX_PACKED_STAGING_ALLOC_SIZE);
+    ASSERT(MAX_PACKED_STAGING_ALLOC_SIZE <= STAGING_BLOCK_SIZE);
+
+    std::vector<RawBuffer>& blocks = ringbufferSlot.stagingBlocks;
+    uint32_t& blockIdx = ringbufferSlot.curStagingBlockIdx;
+    uint64_t& blockOffset = ringbufferSlot.curStagingBlockOffset;
+
+    // Move onto the next block if the allocation doesn't fit in the current one
+    const uint64_t allocSize = Utils::ualignUp(std::max<uint64_t>(numBytes, 1), STAGING_ALLOC_ALIGNMENT);
+
+    if ((blockIdx < blocks.size()) && (blockOffset + allocSize > blocks[blockIdx].getSize())) {
+        blockIdx++;
+        blockOffset = 0;
+    }
+
+    // Create a new block if needed
+    if (blockIdx >= blocks.size()) {
+        ASSERT(blockIdx == blocks.size());
+        RawBuffer& block = blocks.emplace_back();
+
+        if (!block.init(
+                *mpDevice,
+                STAGING_BLOCK_SIZE,
+                DeviceMemAllocMode::REQUIRE_HOST_VISIBLE,
+                VK_BUFFER_USAGE_TRANSFER_SRC_BIT            // Used as a transfer source only
+            )
+        )
+        {
+            ASSERT_FAIL("Failed to allocate a buffer!");
+            blocks.pop_back();
+            return {};
+        }
+
+        ASSERT(block.getBytes());
+        ASSERT(block.getSize() >= STAGING_BLOCK_SIZE);
+        ASSERT(block.getVkBuffer());
+    }
+
+    // Make the allocation from the current block
+    RawBuffer& block = blocks[blockIdx];
+    const uint64_t allocOffset = blockOffset;
+    blockOffset += allocSize;
+
+    return StagingBuffer {
+        block.getBytes() + allocOffset,
+        block.getVkBuffer(),
+        allocOffset,
+        numBytes
+    };
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
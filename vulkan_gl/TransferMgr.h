@@ -2,6 +2,7 @@
 
 #include "CmdBuffer.h"
 #include "Defines.h"
+#include "Semaphore.h"
 #include "TransferTask.h"
 
 #include <cstddef>
@@ -18,13 +19,27 @@ class RingbufferMgr;
 //------------------------------------------------------------------------------------------------------------------------------------------
 class TransferMgr {
 public:
-    // Contains details for an allocated staging buffer that can be used in transfers
+    // Contains details for an allocated staging buffer that can be used in transfers.
+    // Small allocations are packed together into shared staging buffers, so the allocation may start at an offset within 'vkBuffer'.
+    // Note that 'pBytes' points to the start of the allocation and not the start of the buffer.
     struct StagingBuffer {
         std::byte*  pBytes;
         VkBuffer    vkBuffer;
+        uint64_t    offset;
         uint64_t    size;
     };
 
+    // Allocations of this size or smaller are sub-allocated from shared staging buffer blocks rather than getting their own buffer
+    static constexpr uint64_t MAX_PACKED_STAGING_ALLOC_SIZE = 64 * 1024;
+
+    // The size of each shared staging buffer block, and how many blocks each ringbuffer slot retains between frames
+    static constexpr uint64_t STAGING_BLOCK_SIZE = 1024 * 1024;
+    static constexpr uint32_t MAX_RETAINED_STAGING_BLOCKS = 4;
+
+    // The alignment of sub-allocations within a staging buffer block.
+    // This is a multiple of the texel block size for all formats, so the allocations can be used as the source of image copies.
+    static constexpr uint64_t STAGING_ALLOC_ALIGNMENT = 256;
+
     TransferMgr() noexcept;
     ~TransferMgr() noexcept;
 
@@ -37,6 +52,16 @@ public:
     // Typically this contains texture and vertex etc. buffer upload operations.
     inline TransferTask& getPreFrameTransferTask() noexcept { return mPreFrameTransferTask; }
 
+    // Gets the transfer task for large texture uploads which can execute asynchronously on the device's dedicated transfer queue.
+    // The uploads are kicked off with the pre-frame transfer task and complete before it executes on the work queue, so their results are
+    // visible to all rendering in the frame. If the device has no dedicated transfer queue then this is just the pre-frame transfer task.
+    //
+    // Notes:
+    //  (1) Only texture uploads are allowed in this task.
+    //  (2) Each texture must only be the destination of one upload in the task per frame.
+    //  (3) The uploads execute before anything in the pre-frame transfer task.
+    inline TransferTask& getAsyncUploadTask() noexcept { return (mbHaveTransferQueue) ? mAsyncUploadTask : mPreFrameTransferTask; }
+
     StagingBuffer allocTempStagingBuffer(const uint64_t numBytes) noexcept;
     bool executePreFrameTransferTask() noexcept;
     void doCleanupForRingbufferIndex(const uint8_t ringbufferIndex) noexcept;
@@ -50,16 +75,27 @@ private:
 
     // Data structures for one of the ringbuffer slots
     struct RingbufferSlot {
-        CmdBuffer               cmdBuffer;              // The command buffer which is submitted to the transfer queue to do transfer related commands
-        std::vector<RawBuffer>  tmpStagingBuffers;      // Temporary raw staging buffers that have been allocated by the manager for the purposes of doing transfers
+        CmdBuffer               cmdBuffer;                      // The command buffer which is submitted to the transfer queue to do transfer related commands
+        CmdBuffer               ownershipReleaseCmdBuffer;      // Work queue command buffer which releases async upload destinations to the dedicated transfer queue
+        CmdBuffer               asyncUploadCmdBuffer;           // Dedicated transfer queue command buffer which executes the async upload task
+        Semaphore               ownershipReleasedSemaphore;     // Signalled when async upload destinations have been released to the dedicated transfer queue
+        Semaphore               asyncUploadDoneSemaphore;       // Signalled when the async uploads are done and released back to the work queue
+        std::vector<RawBuffer>  tmpStagingBuffers;              // Temporary raw staging buffers that have been allocated by the manager for the purposes of doing transfers
+        std::vector<RawBuffer>  stagingBlocks;                  // Shared staging buffer blocks that small allocations are packed into: retained between frames
+        uint32_t                curStagingBlockIdx;             // Which of the shared staging buffer blocks small allocations are currently being made from
+        uint64_t                curStagingBlockOffset;          // Offset of the next free byte in the current shared staging buffer block
     };
 
     RingbufferSlot& getCurrentRingbufferSlot() noexcept;
+    StagingBuffer allocPackedStagingBuffer(RingbufferSlot& ringbufferSlot, const uint64_t numBytes) noexcept;
+    bool executeAsyncUploadTask(RingbufferSlot& ringbufferSlot, CmdBuffer& preFrameCmdBuffer) noexcept;
 
     bool                mbIsValid;
     LogicalDevice*      mpDevice;
     RingbufferMgr*      mpRingbufferMgr;
+    bool                mbHaveTransferQueue;
     TransferTask        mPreFrameTransferTask;
+    TransferTask        mAsyncUploadTask;
     RingbufferSlot      mRingbufferSlots[Defines::RINGBUFFER_SIZE];
 };
 
@@ -13,12 +13,15 @@
 #include "VkFormatUtils.h"
 #include "VkFuncs.h"
 
+#include <algorithm>
+
 BEGIN_NAMESPACE(vgl)
 
 // What type of transfer command we are dealing with
 enum class TransferCmdType {
     BUFFER_TO_BUFFER_TRANSFER,
     BUFFER_TO_TEXTURE_TRANSFER,
+    BUFFER_TO_TEXTURE_REGIONS_TRANSFER,
     RENDER_TEXTURE_DOWNLOAD
 };
 
@@ -50,6 +53,16 @@ struct BufToTexTransCmd {
     bool            bTexIsCubemap;
 };
 
+// A buffer to texture transfer command for a list of texture regions (first mip level only, 2d textures only)
+struct BufToTexRegionsTransCmd {
+    VkBuffer        srcVkBuffer;
+    VkImage         dstVkImage;
+    VkImageLayout   dstOldVkImageLayout;
+    VkFormat        texFormat;
+    uint32_t        startRegionIdx;     // Index of the first region in 'TransferTask::mBufToTexRegions'
+    uint32_t        numRegions;
+};
+
 // A render texture download command
 struct RenderTexDownloadCmd {
     VkImage     srcVkImage;
@@ -73,6 +86,7 @@ struct TransferTask::TransferCmd {
     union {
         BufToBufTransCmd        bufToBufTransCmd;
         BufToTexTransCmd        bufToTexTransCmd;
+        BufToTexRegionsTransCmd bufToTexRegionsTransCmd;
         RenderTexDownloadCmd    renderTexDownloadCmd;
     };
 };
@@ -92,160 +106,298 @@ static void submitToCmdBufferImpl(CmdBuffer& cmdBuffer, const BufToBufTransCmd&
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Write a buffer to texture transfer command into the given command buffer
+// Determines the queue family indexes to use for the image barrier which gets an upload destination into the transfer destination layout.
+//
+// If the upload executes on a queue family other than the one that owns the image then ownership of the image is acquired from the owner.
+// If the existing image contents are being discarded however (old layout is undefined) then no ownership transfer is required at all.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void submitToCmdBufferImpl(CmdBuffer& cmdBuffer, const BufToTexTransCmd& cmd) noexcept {
-    // Buffer offset for command should be 32-bit aligned!
-    ASSERT(cmd.srcBufferOffset % Defines::MIN_IMAGE_ALIGNMENT == 0);
+static void getPreUploadQueueFamilies(
+    const VkImageLayout oldVkImageLayout,
+    const uint32_t ownerQueueFamilyIdx,
+    const uint32_t execQueueFamilyIdx,
+    uint32_t& srcQueueFamilyIdx,
+    uint32_t& dstQueueFamilyIdx
+) noexcept {
+    if (ownerQueueFamilyIdx == execQueueFamilyIdx) {
+        srcQueueFamilyIdx = execQueueFamilyIdx;
+        dstQueueFamilyIdx = execQueueFamilyIdx;
+    } else if (oldVkImageLayout == VK_IMAGE_LAYOUT_UNDEFINED) {
+        srcQueueFamilyIdx = VK_QUEUE_FAMILY_IGNORED;
+        dstQueueFamilyIdx = VK_QUEUE_FAMILY_IGNORED;
+    } else {
+        srcQueueFamilyIdx = ownerQueueFamilyIdx;
+        dstQueueFamilyIdx = execQueueFamilyIdx;
+    }
+}
 
-    // Get the queue that we use for submitting work in general to graphics device
-    LogicalDevice& device = *cmdBuffer.getCmdPool()->getDevice();
-    const uint32_t workQueueFamilyIdx = device.getWorkQueueFamilyIdx();
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes the image barrier that gets the destination of a buffer to texture transfer into a format that is optimal as a transfer destination
+//------------------------------------------------------------------------------------------------------------------------------------------
+static VkImageMemoryBarrier getPreUploadBarrier(
+    const BufToTexTransCmd& cmd,
+    const uint32_t ownerQueueFamilyIdx,
+    const uint32_t execQueueFamilyIdx
+) noexcept {
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;     // Wait for other access to finish
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;     // Reads and writes are blocked on waiting for the other transfers to finish
+    barrier.oldLayout = cmd.dstOldVkImageLayout;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;           // Make the image be optimal as a transfer destination
+    barrier.image = cmd.dstVkImage;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;    // Only dealing with color buffers and not depth
+    barrier.subresourceRange.baseMipLevel = 0;                          // Include all mip levels
+    barrier.subresourceRange.levelCount = cmd.dstNumMipLevels;          // Include all mip levels
+    barrier.subresourceRange.baseArrayLayer = TextureUtils::getNumTexImages(cmd.dstStartLayer, cmd.bTexIsCubemap);
+    barrier.subresourceRange.layerCount = TextureUtils::getNumTexImages(cmd.dstNumLayers, cmd.bTexIsCubemap);
+
+    getPreUploadQueueFamilies(
+        cmd.dstOldVkImageLayout,
+        ownerQueueFamilyIdx,
+        execQueueFamilyIdx,
+        barrier.srcQueueFamilyIndex,
+        barrier.dstQueueFamilyIndex
+    );
 
-    // Need to insert an image barrier to get the image in a format that is optimal as a transfer destination:
-    const VkCommandBuffer vkCmdBuffer = cmdBuffer.getVkCommandBuffer();
-    const VkFuncs& vkFuncs = device.getVkFuncs();
+    return barrier;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes the image barrier that gets the destination of a buffer to texture transfer into a format that is optimal for use in shaders.
+// If the upload executes on a queue family other than the owner of the image, then ownership is also released back to the owner.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static VkImageMemoryBarrier getPostUploadBarrier(
+    const BufToTexTransCmd& cmd,
+    const uint32_t ownerQueueFamilyIdx,
+    const uint32_t execQueueFamilyIdx
+) noexcept {
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;   // Waiting on transfer reads and writes to finish
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;     // All types of reads and writes are blocked waiting for the writes
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;                           // The old layout was transfer optimal
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;                       // The new layout will be shader use optimal
+    barrier.srcQueueFamilyIndex = execQueueFamilyIdx;
+    barrier.dstQueueFamilyIndex = ownerQueueFamilyIdx;
+    barrier.image = cmd.dstVkImage;
+    barrier.subresourceRange.aspectMask = VkFormatUtils::getVkImageAspectFlags(cmd.texFormat);
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = cmd.dstNumMipLevels;              // Include all mip levels
+    barrier.subresourceRange.baseArrayLayer = TextureUtils::getNumTexImages(cmd.dstStartLayer, cmd.bTexIsCubemap);
+    barrier.subresourceRange.layerCount = TextureUtils::getNumTexImages(cmd.dstNumLayers, cmd.bTexIsCubemap);
+    return barrier;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes the image barrier that gets the destination of a texture regions transfer into a format that is optimal as a transfer destination.
+// This works the same way as a regular buffer to texture transfer, except that only the first mip level and layer is affected.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static VkImageMemoryBarrier getPreUploadBarrier(
+    const BufToTexRegionsTransCmd& cmd,
+    const uint32_t ownerQueueFamilyIdx,
+    const uint32_t execQueueFamilyIdx
+) noexcept {
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier.oldLayout = cmd.dstOldVkImageLayout;
+    barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.image = cmd.dstVkImage;
+    barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+
+    getPreUploadQueueFamilies(
+        cmd.dstOldVkImageLayout,
+        ownerQueueFamilyIdx,
+        execQueueFamilyIdx,
+        barrier.srcQueueFamilyIndex,
+        barrier.dstQueueFamilyIndex
+    );
+
+    return barrier;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes the image barrier that gets the destination of a texture regions transfer into a format that is optimal for use in shaders.
+// If the upload executes on a queue family other than the owner of the image, then ownership is also released back to the owner.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static VkImageMemoryBarrier getPostUploadBarrier(
+    const BufToTexRegionsTransCmd& cmd,
+    const uint32_t ownerQueueFamilyIdx,
+    const uint32_t execQueueFamilyIdx
+) noexcept {
+    VkImageMemoryBarrier barrier = {};
+    barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+    barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+    barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    barrier.srcQueueFamilyIndex = execQueueFamilyIdx;
+    barrier.dstQueueFamilyIndex = ownerQueueFamilyIdx;
+    barrier.image = cmd.dstVkImage;
+    barrier.subresourceRange.aspectMask = VkFormatUtils::getVkImageAspectFlags(cmd.texFormat);
+    barrier.subresourceRange.baseMipLevel = 0;
+    barrier.subresourceRange.levelCount = 1;
+    barrier.subresourceRange.baseArrayLayer = 0;
+    barrier.subresourceRange.layerCount = 1;
+    return barrier;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records a single pipeline barrier command containing all of the given pre-upload image barriers.
+// This gets all of the upload destinations into a layout that is optimal as a transfer destination.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void recordPreUploadBarriers(CmdBuffer& cmdBuffer, const VkImageMemoryBarrier* const pBarriers, const uint32_t numBarriers) noexcept {
+    ASSERT(pBarriers);
+    ASSERT(numBarriers > 0);
+
+    const VkFuncs& vkFuncs = cmdBuffer.getCmdPool()->getDevice()->getVkFuncs();
+
+    vkFuncs.vkCmdPipelineBarrier(
+        cmdBuffer.getVkCommandBuffer(),
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,     // Src pipeline stage mask: wait for other stages to finish accessing
+        VK_PIPELINE_STAGE_TRANSFER_BIT,         // Dst pipeline stage mask: transfers waiting on transfers
+        0,                                      // Dependency flags
+        0,                                      // Memory barrier count
+        nullptr,                                // Memory barriers
+        0,                                      // Buffer memory barrier count
+        nullptr,                                // Buffer memory barriers
+        numBarriers,                            // Image memory barrier count
+        pBarriers                               // Image memory barriers
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records a single pipeline barrier command containing all of the given post-upload image barriers.
+// This gets all of the upload destinations into a layout that is optimal for use in shaders.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void recordPostUploadBarriers(CmdBuffer& cmdBuffer, const VkImageMemoryBarrier* const pBarriers, const uint32_t numBarriers) noexcept {
+    ASSERT(pBarriers);
+    ASSERT(numBarriers > 0);
+
+    const VkFuncs& vkFuncs = cmdBuffer.getCmdPool()->getDevice()->getVkFuncs();
+
+    vkFuncs.vkCmdPipelineBarrier(
+        cmdBuffer.getVkCommandBuffer(),
+        VK_PIPELINE_STAGE_TRANSFER_BIT,         // Wait for the transfer stage to finish executing
+        VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,     // All stages are blocked waiting for the transfer to finish
+        0,                                      // Dependency flags
+        0,                                      // Memory barrier count
+        nullptr,                                // Memory barriers
+        0,                                      // Buffer memory barrier count
+        nullptr,                                // Buffer memory barriers
+        numBarriers,                            // Image memory barrier count
+        pBarriers                               // Image memory barriers
+    );
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records the copy operations for a buffer to texture transfer command into the given command buffer.
+// The destination image must already be in the transfer destination optimal layout.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void recordUploadCopies(CmdBuffer& cmdBuffer, const BufToTexTransCmd& cmd) noexcept {
+    // Buffer offset for command should be 32-bit aligned!
+    ASSERT(cmd.srcBufferOffset % Defines::MIN_IMAGE_ALIGNMENT == 0);
 
+    const VkFuncs& vkFuncs = cmdBuffer.getCmdPool()->getDevice()->getVkFuncs();
     const uint32_t startTexImage = TextureUtils::getNumTexImages(cmd.dstStartLayer, cmd.bTexIsCubemap);
     const uint32_t numTexImages = TextureUtils::getNumTexImages(cmd.dstNumLayers, cmd.bTexIsCubemap);
 
-    {
-        VkImageMemoryBarrier barrier = {};
+    // Use this buffer to submit the copy operations
+    // TODO: preallocate this temporary buffer once and re-use
+    uint64_t bufferOffset = cmd.srcBufferOffset;
+    std::vector<VkBufferImageCopy> bufferImageCopyCmds;
+    bufferImageCopyCmds.reserve(16);
 
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;     // Wait for other access to finish
-        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;     // Reads and writes are blocked on waiting for the other transfers to finish
-        barrier.oldLayout = cmd.dstOldVkImageLayout;
-        barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;           // Make the image be optimal as a transfer destination
-        barrier.srcQueueFamilyIndex = workQueueFamilyIdx;
-        barrier.dstQueueFamilyIndex = workQueueFamilyIdx;
-        barrier.image = cmd.dstVkImage;
-        barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;    // Only dealing with color buffers and not depth
-        barrier.subresourceRange.baseMipLevel = 0;                          // Include all mip levels
-        barrier.subresourceRange.levelCount = cmd.dstNumMipLevels;          // Include all mip levels
-        barrier.subresourceRange.baseArrayLayer = startTexImage;
-        barrier.subresourceRange.layerCount = numTexImages;
+    // Process the copy operations for every image and mipmap level in the texture
+    for (uint32_t curImage = 0; curImage < numTexImages; ++curImage) {
+        for (uint32_t curMipLevel = 0; curMipLevel < cmd.dstNumMipLevels; ++curMipLevel) {
+            // Figure out the dimensions for this mip level.
+            // Note that we do NOT round to the nearest block size for the copy command!
+            uint32_t mipLevelWidth = 0;
+            uint32_t mipLevelHeight = 0;
+            uint32_t mipLevelDepth = 0;
 
-        vkFuncs.vkCmdPipelineBarrier(
-            vkCmdBuffer,
-            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,     // Src pipeline stage mask: wait for other stages to finish accessing
-            VK_PIPELINE_STAGE_TRANSFER_BIT,         // Dst pipeline stage mask: transfers waiting on transfers
-            0,                                      // Dependency flags
-            0,                                      // Memory barrier count
-            nullptr,                                // Memory barriers
-            0,                                      // Buffer memory barrier count
-            nullptr,                                // Buffer memory barriers
-            1,                                      // Image memory barrier count
-            &barrier                                // Image memory barrier
-        );
-    }
+            TextureUtils::getMipLevelDimensions(
+                cmd.dstSizeX,
+                cmd.dstSizeY,
+                cmd.dstSizeZ,
+                curMipLevel,
+                mipLevelWidth,
+                mipLevelHeight,
+                mipLevelDepth
+            );
 
-    // Next record the actual copy operations that will copy the data into the image.
-    {
-        // Use this buffer to submit the copy operations
-        // TODO: preallocate this temporary buffer once and re-use
-        uint64_t bufferOffset = cmd.srcBufferOffset;
-        std::vector<VkBufferImageCopy> bufferImageCopyCmds;
-        bufferImageCopyCmds.reserve(16);
+            ASSERT((mipLevelWidth > 0) && (mipLevelHeight > 0) && (mipLevelDepth > 0));
 
-        // Process the copy operations for every image and mipmap level in the texture
-        for (uint32_t curImage = 0; curImage < numTexImages; ++curImage) {
-            for (uint32_t curMipLevel = 0; curMipLevel < cmd.dstNumMipLevels; ++curMipLevel) {
-                // Figure out the dimensions for this mip level.
-                // Note that we do NOT round to the nearest block size for the copy command!
-                uint32_t mipLevelWidth = 0;
-                uint32_t mipLevelHeight = 0;
-                uint32_t mipLevelDepth = 0;
-
-                TextureUtils::getMipLevelDimensions(
-                    cmd.dstSizeX,
-                    cmd.dstSizeY,
-                    cmd.dstSizeZ,
-                    curMipLevel,
-                    mipLevelWidth,
-                    mipLevelHeight,
-                    mipLevelDepth
-                );
-
-                ASSERT((mipLevelWidth > 0) && (mipLevelHeight > 0) && (mipLevelDepth > 0));
-
-                // Figure out the byte size for this mip level.
-                // Note that this WILL round to the nearest block size!
-                const uint64_t mipLevelByteSize = TextureUtils::getMipLevelByteSize(
-                    cmd.texFormat,
-                    mipLevelWidth,
-                    mipLevelHeight,
-                    mipLevelDepth
-                );
-
-                // Get the destination offset within this mipmap level
-                const uint32_t mipOffsetX = (cmd.dstOffsetX >> curMipLevel);
-                const uint32_t mipOffsetY = (cmd.dstOffsetY >> curMipLevel);
-                const uint32_t mipOffsetZ = (cmd.dstOffsetZ >> curMipLevel);
-
-                // Schedule the copy operation for this mip level
-                VkBufferImageCopy copyOp = {};
-                copyOp.bufferOffset = bufferOffset;
-                copyOp.bufferRowLength = 0;                                         // Tightly packed
-                copyOp.bufferImageHeight = 0;                                       // Tightly packed
-                copyOp.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;     // Just dealing with color buffer
-                copyOp.imageSubresource.mipLevel = curMipLevel;
-                copyOp.imageSubresource.baseArrayLayer = startTexImage + curImage;
-                copyOp.imageSubresource.layerCount = 1;
-                copyOp.imageOffset = { (int32_t) mipOffsetX, (int32_t) mipOffsetY, (int32_t) mipOffsetZ };
-                copyOp.imageExtent = { mipLevelWidth, mipLevelHeight, mipLevelDepth };
-
-                bufferImageCopyCmds.push_back(copyOp);
-
-                // Move onto the next mip level in the buffer.
-                // Note that as per the docs in 'Texture' this offset must be 32-bit (4 byte) aligned so if it's not aligned then align it now.
-                bufferOffset += mipLevelByteSize;
-                bufferOffset = Utils::ualignUp(bufferOffset, (uint64_t) Defines::MIN_IMAGE_ALIGNMENT);
-            }
-        }
+            // Figure out the byte size for this mip level.
+            // Note that this WILL round to the nearest block size!
+            const uint64_t mipLevelByteSize = TextureUtils::getMipLevelByteSize(
+                cmd.texFormat,
+                mipLevelWidth,
+                mipLevelHeight,
+                mipLevelDepth
+            );
 
-        // Issue the buffer image copy commands
-        vkFuncs.vkCmdCopyBufferToImage(
-            vkCmdBuffer,
-            cmd.srcVkBuffer,
-            cmd.dstVkImage,
-            VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,                       // Dest image is in this format
-            static_cast<uint32_t>(bufferImageCopyCmds.size()),
-            bufferImageCopyCmds.data()
-        );
+            // Get the destination offset within this mipmap level
+            const uint32_t mipOffsetX = (cmd.dstOffsetX >> curMipLevel);
+            const uint32_t mipOffsetY = (cmd.dstOffsetY >> curMipLevel);
+            const uint32_t mipOffsetZ = (cmd.dstOffsetZ >> curMipLevel);
+
+            // Schedule the copy operation for this mip level
+            VkBufferImageCopy copyOp = {};
+            copyOp.bufferOffset = bufferOffset;
+            copyOp.bufferRowLength = 0;                                         // Tightly packed
+            copyOp.bufferImageHeight = 0;                                       // Tightly packed
+            copyOp.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;     // Just dealing with color buffer
+            copyOp.imageSubresource.mipLevel = curMipLevel;
+            copyOp.imageSubresource.baseArrayLayer = startTexImage + curImage;
+            copyOp.imageSubresource.layerCount = 1;
+            copyOp.imageOffset = { (int32_t) mipOffsetX, (int32_t) mipOffsetY, (int32_t) mipOffsetZ };
+            copyOp.imageExtent = { mipLevelWidth, mipLevelHeight, mipLevelDepth };
+
+            bufferImageCopyCmds.push_back(copyOp);
+
+            // Move onto the next mip level in the buffer.
+            // Note that as per the docs in 'Texture' this offset must be 32-bit (4 byte) aligned so if it's not aligned then align it now.
+            bufferOffset += mipLevelByteSize;
+            bufferOffset = Utils::ualignUp(bufferOffset, (uint64_t) Defines::MIN_IMAGE_ALIGNMENT);
+        }
     }
 
-    // Need to insert an image barrier to get the image into a format that is optimal for use in shaders:
-    {
-        VkImageMemoryBarrier barrier = {};
+    // Issue the buffer image copy commands
+    vkFuncs.vkCmdCopyBufferToImage(
+        cmdBuffer.getVkCommandBuffer(),
+        cmd.srcVkBuffer,
+        cmd.dstVkImage,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,                       // Dest image is in this format
+        static_cast<uint32_t>(bufferImageCopyCmds.size()),
+        bufferImageCopyCmds.data()
+    );
+}
 
-        barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
-        barrier.srcAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_TRANSFER_WRITE_BIT;   // Waiting on transfer reads and writes to finish
-        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;     // All types of reads and writes are blocked waiting for the writes
-        barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;                           // The old layout was transfer optimal
-        barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;                       // The new layout will be shader use optimal
-        barrier.srcQueueFamilyIndex = workQueueFamilyIdx;
-        barrier.dstQueueFamilyIndex = workQueueFamilyIdx;
-        barrier.image = cmd.dstVkImage;
-        barrier.subresourceRange.aspectMask = VkFormatUtils::getVkImageAspectFlags(cmd.texFormat);
-        barrier.subresourceRange.baseMipLevel = 0;
-        barrier.subresourceRange.levelCount = cmd.dstNumMipLevels;              // Include all mip levels
-        barrier.subresourceRange.baseArrayLayer = startTexImage;
-        barrier.subresourceRange.layerCount = numTexImages;
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records the copy operation for a buffer to texture transfer command for a list of texture regions into the given command buffer.
+// All of the regions are copied with a single copy command. The destination image must already be in the transfer destination layout.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void recordUploadCopies(CmdBuffer& cmdBuffer, const BufToTexRegionsTransCmd& cmd, const VkBufferImageCopy* const pRegions) noexcept {
+    ASSERT(pRegions);
+    ASSERT(cmd.numRegions > 0);
 
-        vkFuncs.vkCmdPipelineBarrier(
-            vkCmdBuffer,
-            VK_PIPELINE_STAGE_TRANSFER_BIT,         // Wait for the transfer stage to finish executing
-            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,     // All stages are blocked waiting for the transfer to finish
-            0,                                      // Dependency flags
-            0,                                      // Memory barrier count
-            nullptr,                                // Memory barriers
-            0,                                      // Buffer memory barrier count
-            nullptr,                                // Buffer memory barriers
-            1,                                      // Image memory barrier count
-            &barrier                                // Image memory barrier
-        );
-    }
+    const VkFuncs& vkFuncs = cmdBuffer.getCmdPool()->getDevice()->getVkFuncs();
+
+    vkFuncs.vkCmdCopyBufferToImage(
+        cmdBuffer.getVkCommandBuffer(),
+        cmd.srcVkBuffer,
+        cmd.dstVkImage,
+        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        cmd.numRegions,
+        pRegions
+    );
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -444,9 +596,11 @@ void TransferTask::reserveCmds(const size_t numCmds) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 void TransferTask::clearCmds(const bool bCompactCmdList) noexcept {
     mCmds.clear();
+    mBufToTexRegions.clear();
 
     if (bCompactCmdList) {
         mCmds.shrink_to_fit();
+        mBufToTexRegions.shrink_to_fit();
     }
 }
 
@@ -470,28 +624,237 @@ size_t TransferTask::getNumCmds() const noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 void TransferTask::submitToCmdBuffer(CmdBuffer& cmdBuffer) noexcept {
     ASSERT(cmdBuffer.isValid());
+    const uint32_t workQueueFamilyIdx = cmdBuffer.getCmdPool()->getDevice()->getWorkQueueFamilyIdx();
+    submitToCmdBuffer(cmdBuffer, workQueueFamilyIdx, workQueueFamilyIdx);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records the transfer task into the given command buffer for execution on the specified queue family.
+// After the call the list of commands in the task is empty again.
+//
+// If the executing queue family differs from the queue family which owns the destination resources then ownership of those resources is
+// acquired from the owner before the transfers and released back to the owner afterwards. In that case the owning queue must also record
+// the matching release and acquire barriers via 'recordOwnershipReleaseBarriers' and 'recordOwnershipAcquireBarriers'.
+// Only texture uploads are supported for transfers which execute on another queue family.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void TransferTask::submitToCmdBuffer(CmdBuffer& cmdBuffer, const uint32_t ownerQueueFamilyIdx, const uint32_t execQueueFamilyIdx) noexcept {
+    ASSERT(cmdBuffer.isValid());
+    ASSERT((ownerQueueFamilyIdx == execQueueFamilyIdx) || hasOnlyTextureUploads());
+
+    const size_t numCmds = mCmds.size();
+
+    for (size_t cmdIdx = 0; cmdIdx < numCmds;) {
+        const TransferCmd& cmd = mCmds[cmdIdx];
 
-    for (const TransferCmd& cmd : mCmds) {
         switch (cmd.type) {
             case TransferCmdType::BUFFER_TO_BUFFER_TRANSFER:
                 submitToCmdBufferImpl(cmdBuffer, cmd.bufToBufTransCmd);
+                cmdIdx++;
                 break;
 
             case TransferCmdType::BUFFER_TO_TEXTURE_TRANSFER:
-                submitToCmdBufferImpl(cmdBuffer, cmd.bufToTexTransCmd);
+            case TransferCmdType::BUFFER_TO_TEXTURE_REGIONS_TRANSFER:
+                cmdIdx = submitTextureUploadsToCmdBuffer(cmdBuffer, cmdIdx, ownerQueueFamilyIdx, execQueueFamilyIdx);
                 break;
 
             case TransferCmdType::RENDER_TEXTURE_DOWNLOAD:
                 submitToCmdBufferImpl(cmdBuffer, cmd.renderTexDownloadCmd);
+                cmdIdx++;
                 break;
 
             default:
                 ASSERT_FAIL("Unknown command type!");
+                cmdIdx++;
                 break;
         }
     }
 
     mCmds.clear();
+    mBufToTexRegions.clear();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records a run of consecutive texture upload commands into the given command buffer, starting at the specified command index.
+// Returns the index of the first command after the run.
+//
+// The image layout transitions for the whole run are done with just one pipeline barrier command before all of the copies and one after,
+// rather than a pair for each upload. Because of this each texture can only be the destination of one upload in a run: the run ends
+// early if a texture is uploaded to again, or if it reaches the maximum number of uploads which can be batched together.
+//------------------------------------------------------------------------------------------------------------------------------------------
+size_t TransferTask::submitTextureUploadsToCmdBuffer(
+    CmdBuffer& cmdBuffer,
+    const size_t startCmdIdx,
+    const uint32_t ownerQueueFamilyIdx,
+    const uint32_t execQueueFamilyIdx
+) noexcept {
+    constexpr uint32_t MAX_BATCHED_UPLOADS = 64;
+
+    VkImageMemoryBarrier preUploadBarriers[MAX_BATCHED_UPLOADS] = {};
+    VkImageMemoryBarrier postUploadBarriers[MAX_BATCHED_UPLOADS] = {};
+    uint32_t numUploads = 0;
+
+    // Gather the barriers for the run of uploads
+    const size_t numCmds = mCmds.size();
+    size_t endCmdIdx = startCmdIdx;
+
+    for (; (endCmdIdx < numCmds) && (numUploads < MAX_BATCHED_UPLOADS); ++endCmdIdx) {
+        const TransferCmd& cmd = mCmds[endCmdIdx];
+        VkImageMemoryBarrier preUploadBarrier;
+        VkImageMemoryBarrier postUploadBarrier;
+
+        if (cmd.type == TransferCmdType::BUFFER_TO_TEXTURE_TRANSFER) {
+            preUploadBarrier = getPreUploadBarrier(cmd.bufToTexTransCmd, ownerQueueFamilyIdx, execQueueFamilyIdx);
+            postUploadBarrier = getPostUploadBarrier(cmd.bufToTexTransCmd, ownerQueueFamilyIdx, execQueueFamilyIdx);
+        } else if (cmd.type == TransferCmdType::BUFFER_TO_TEXTURE_REGIONS_TRANSFER) {
+            preUploadBarrier = getPreUploadBarrier(cmd.bufToTexRegionsTransCmd, ownerQueueFamilyIdx, execQueueFamilyIdx);
+            postUploadBarrier = getPostUploadBarrier(cmd.bufToTexRegionsTransCmd, ownerQueueFamilyIdx, execQueueFamilyIdx);
+        } else {
+            break;
+        }
+
+        // Stop the run if this texture is already being uploaded to in it
+        const bool bImageAlreadyInRun = std::any_of(
+            preUploadBarriers,
+            preUploadBarriers + numUploads,
+            [&](const VkImageMemoryBarrier& barrier) noexcept { return (barrier.image == preUploadBarrier.image); }
+        );
+
+        if (bImageAlreadyInRun)
+            break;
+
+        preUploadBarriers[numUploads] = preUploadBarrier;
+        postUploadBarriers[numUploads] = postUploadBarrier;
+        numUploads++;
+    }
+
+    ASSERT(numUploads > 0);
+
+    // Transition all of the destinations so they are optimal as transfer destinations, do the copies and then transition them all again
+    // so that they are optimal for use in shaders.
+    recordPreUploadBarriers(cmdBuffer, preUploadBarriers, numUploads);
+
+    for (size_t cmdIdx = startCmdIdx; cmdIdx < endCmdIdx; ++cmdIdx) {
+        const TransferCmd& cmd = mCmds[cmdIdx];
+
+        if (cmd.type == TransferCmdType::BUFFER_TO_TEXTURE_TRANSFER) {
+            recordUploadCopies(cmdBuffer, cmd.bufToTexTransCmd);
+        } else {
+            recordUploadCopies(cmdBuffer, cmd.bufToTexRegionsTransCmd, mBufToTexRegions.data() + cmd.bufToTexRegionsTransCmd.startRegionIdx);
+        }
+    }
+
+    recordPostUploadBarriers(cmdBuffer, postUploadBarriers, numUploads);
+    return endCmdIdx;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records barriers into a command buffer for the owning queue family which release ownership of upload destinations to the queue family
+// that will execute the task. Must be executed before the task itself, which should wait on a semaphore signalled after the release.
+// Uploads which discard the existing image contents do not need their ownership released and are skipped.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void TransferTask::recordOwnershipReleaseBarriers(
+    CmdBuffer& cmdBuffer,
+    const uint32_t ownerQueueFamilyIdx,
+    const uint32_t execQueueFamilyIdx
+) const noexcept {
+    ASSERT(cmdBuffer.isValid());
+    ASSERT(ownerQueueFamilyIdx != execQueueFamilyIdx);
+    ASSERT(hasOnlyTextureUploads());
+
+    const VkCommandBuffer vkCmdBuffer = cmdBuffer.getVkCommandBuffer();
+    const VkFuncs& vkFuncs = cmdBuffer.getCmdPool()->getDevice()->getVkFuncs();
+
+    for (const TransferCmd& cmd : mCmds) {
+        VkImageMemoryBarrier barrier;
+
+        if (cmd.type == TransferCmdType::BUFFER_TO_TEXTURE_TRANSFER) {
+            barrier = getPreUploadBarrier(cmd.bufToTexTransCmd, ownerQueueFamilyIdx, execQueueFamilyIdx);
+        } else {
+            barrier = getPreUploadBarrier(cmd.bufToTexRegionsTransCmd, ownerQueueFamilyIdx, execQueueFamilyIdx);
+        }
+
+        // No ownership transfer happens if the image contents are being discarded
+        if (barrier.srcQueueFamilyIndex == VK_QUEUE_FAMILY_IGNORED)
+            continue;
+
+        // Release: the destination access mask is ignored, the semaphore wait takes care of the rest
+        barrier.srcAccessMask = VK_ACCESS_MEMORY_WRITE_BIT;
+        barrier.dstAccessMask = 0;
+
+        vkFuncs.vkCmdPipelineBarrier(
+            vkCmdBuffer,
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+            VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+            0,
+            0,
+            nullptr,
+            0,
+            nullptr,
+            1,
+            &barrier
+        );
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records barriers into a command buffer for the owning queue family which re-acquire ownership of upload destinations after the task has
+// executed on another queue family. The command buffer should wait on a semaphore signalled after the task has executed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void TransferTask::recordOwnershipAcquireBarriers(
+    CmdBuffer& cmdBuffer,
+    const uint32_t ownerQueueFamilyIdx,
+    const uint32_t execQueueFamilyIdx
+) const noexcept {
+    ASSERT(cmdBuffer.isValid());
+    ASSERT(ownerQueueFamilyIdx != execQueueFamilyIdx);
+    ASSERT(hasOnlyTextureUploads());
+
+    const VkCommandBuffer vkCmdBuffer = cmdBuffer.getVkCommandBuffer();
+    const VkFuncs& vkFuncs = cmdBuffer.getCmdPool()->getDevice()->getVkFuncs();
+
+    for (const TransferCmd& cmd : mCmds) {
+        VkImageMemoryBarrier barrier;
+
+        if (cmd.type == TransferCmdType::BUFFER_TO_TEXTURE_TRANSFER) {
+            barrier = getPostUploadBarrier(cmd.bufToTexTransCmd, ownerQueueFamilyIdx, execQueueFamilyIdx);
+        } else {
+            barrier = getPostUploadBarrier(cmd.bufToTexRegionsTransCmd, ownerQueueFamilyIdx, execQueueFamilyIdx);
+        }
+
+        // Acquire: the source access mask is ignored, the semaphore wait takes care of the rest
+        barrier.srcAccessMask = 0;
+        barrier.dstAccessMask = VK_ACCESS_MEMORY_READ_BIT | VK_ACCESS_MEMORY_WRITE_BIT;
+
+        vkFuncs.vkCmdPipelineBarrier(
+            vkCmdBuffer,
+            VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+            VK_PIPELINE_STAGE_ALL_COMMANDS_BIT,
+            0,
+            0,
+            nullptr,
+            0,
+            nullptr,
+            1,
+            &barrier
+        );
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if the task consists only of texture uploads, which are the only commands that can execute on other queue families
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool TransferTask::hasOnlyTextureUploads() const noexcept {
+    for (const TransferCmd& cmd : mCmds) {
+        const bool bIsTextureUpload = (
+            (cmd.type == TransferCmdType::BUFFER_TO_TEXTURE_TRANSFER) ||
+            (cmd.type == TransferCmdType::BUFFER_TO_TEXTURE_REGIONS_TRANSFER)
+        );
+
+        if (!bIsTextureUpload)
+            return false;
+    }
+
+    return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -565,6 +928,43 @@ void TransferTask::addTextureUpload(
     cmdDetails.bTexIsCubemap = dstTexture.isCubemap();
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Schedules a texture data upload to occur from the given buffer to a list of regions within the given texture.
+// The regions are copied for the first mipmap level and array layer only.
+//
+// Notes:
+//  (1) The buffer offset for each region must be aligned to 'Defines::MIN_IMAGE_ALIGNMENT'.
+//  (2) The regions should not overlap, since the order in which overlapping regions are written is undefined.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void TransferTask::addTextureRegionsUpload(
+    const VkBuffer srcVkBuffer,
+    const Texture& dstTexture,
+    const VkImageLayout dstOldVkImageLayout,
+    const VkBufferImageCopy* const pRegions,
+    const uint32_t numRegions
+) noexcept {
+    ASSERT(srcVkBuffer);
+    ASSERT(dstTexture.isValid());
+    ASSERT(pRegions);
+    ASSERT(numRegions > 0);
+
+    TransferCmd& cmd = mCmds.emplace_back();
+    cmd.type = TransferCmdType::BUFFER_TO_TEXTURE_REGIONS_TRANSFER;
+
+    BufToTexRegionsTransCmd& cmdDetails = cmd.bufToTexRegionsTransCmd;
+    cmdDetails.srcVkBuffer = srcVkBuffer;
+    cmdDetails.dstVkImage = dstTexture.getVkImage();
+    cmdDetails.dstOldVkImageLayout = dstOldVkImageLayout;
+    cmdDetails.texFormat = dstTexture.getFormat();
+    cmdDetails.startRegionIdx = (uint32_t) mBufToTexRegions.size();
+    cmdDetails.numRegions = numRegions;
+
+    for (uint32_t i = 0; i < numRegions; ++i) {
+        ASSERT(pRegions[i].bufferOffset % Defines::MIN_IMAGE_ALIGNMENT == 0);
+        mBufToTexRegions.push_back(pRegions[i]);
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Schedules the contents of a render texture to be transferred into the given mutable texture.
 // The entire texture data is transferred, including all the mipmap levels.
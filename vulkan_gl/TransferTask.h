@@ -30,6 +30,10 @@ public:
     bool isEmpty() const noexcept;
     size_t getNumCmds() const noexcept;
     void submitToCmdBuffer(CmdBuffer& cmdBuffer) noexcept;
+    void submitToCmdBuffer(CmdBuffer& cmdBuffer, const uint32_t ownerQueueFamilyIdx, const uint32_t execQueueFamilyIdx) noexcept;
+    void recordOwnershipReleaseBarriers(CmdBuffer& cmdBuffer, const uint32_t ownerQueueFamilyIdx, const uint32_t execQueueFamilyIdx) const noexcept;
+    void recordOwnershipAcquireBarriers(CmdBuffer& cmdBuffer, const uint32_t ownerQueueFamilyIdx, const uint32_t execQueueFamilyIdx) const noexcept;
+    bool hasOnlyTextureUploads() const noexcept;
 
 private:
     // Copy and move is disallowed
@@ -66,11 +70,27 @@ private:
         const uint32_t dstNumLayers
     ) noexcept;
 
+    void addTextureRegionsUpload(
+        const VkBuffer srcVkBuffer,
+        const Texture& dstTexture,
+        const VkImageLayout dstOldVkImageLayout,
+        const VkBufferImageCopy* const pRegions,
+        const uint32_t numRegions
+    ) noexcept;
+
     void addRenderTextureDownload(RenderTexture& src, MutableTexture& dst) noexcept;
 
-    // The list of transfer commands to execute
+    size_t submitTextureUploadsToCmdBuffer(
+        CmdBuffer& cmdBuffer,
+        const size_t startCmdIdx,
+        const uint32_t ownerQueueFamilyIdx,
+        const uint32_t execQueueFamilyIdx
+    ) noexcept;
+
+    // The list of transfer commands to execute and the buffer to image copy regions used by 'addTextureRegionsUpload' commands
     struct TransferCmd;
     std::vector<TransferCmd> mCmds;
+    std::vector<VkBufferImageCopy> mBufToTexRegions;
 };
 
 END_NAMESPACE(vgl)
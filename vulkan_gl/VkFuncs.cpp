@@ -122,8 +122,10 @@ void VkFuncs::loadInstanceFuncs(const VkInstance vkInstance) noexcept {
     LOAD_INST_FUNC(vkCmdNextSubpass);
     LOAD_INST_FUNC(vkCmdPipelineBarrier);
     LOAD_INST_FUNC(vkCmdPushConstants);
+    LOAD_INST_FUNC(vkCmdResetQueryPool);
     LOAD_INST_FUNC(vkCmdSetScissor);
     LOAD_INST_FUNC(vkCmdSetViewport);
+    LOAD_INST_FUNC(vkCmdWriteTimestamp);
     LOAD_INST_FUNC(vkCreateDevice);
     LOAD_INST_FUNC(vkDestroyDevice);
     LOAD_INST_FUNC(vkDestroyInstance);
@@ -180,7 +182,9 @@ void VkFuncs::loadDeviceFuncs(const VkDevice vkDevice) noexcept {
     LOAD_DEV_FUNC(vkCreateGraphicsPipelines);
     LOAD_DEV_FUNC(vkCreateImage);
     LOAD_DEV_FUNC(vkCreateImageView);
+    LOAD_DEV_FUNC(vkCreatePipelineCache);
     LOAD_DEV_FUNC(vkCreatePipelineLayout);
+    LOAD_DEV_FUNC(vkCreateQueryPool);
     LOAD_DEV_FUNC(vkCreateRenderPass);
     LOAD_DEV_FUNC(vkCreateSampler);
     LOAD_DEV_FUNC(vkCreateSemaphore);
@@ -195,7 +199,9 @@ void VkFuncs::loadDeviceFuncs(const VkDevice vkDevice) noexcept {
     LOAD_DEV_FUNC(vkDestroyImage);
     LOAD_DEV_FUNC(vkDestroyImageView);
     LOAD_DEV_FUNC(vkDestroyPipeline);
+    LOAD_DEV_FUNC(vkDestroyPipelineCache);
     LOAD_DEV_FUNC(vkDestroyPipelineLayout);
+    LOAD_DEV_FUNC(vkDestroyQueryPool);
     LOAD_DEV_FUNC(vkDestroyRenderPass);
     LOAD_DEV_FUNC(vkDestroySampler);
     LOAD_DEV_FUNC(vkDestroySemaphore);
@@ -209,6 +215,8 @@ void VkFuncs::loadDeviceFuncs(const VkDevice vkDevice) noexcept {
     LOAD_DEV_FUNC(vkGetDeviceQueue);
     LOAD_DEV_FUNC(vkGetFenceStatus);
     LOAD_DEV_FUNC(vkGetImageMemoryRequirements);
+    LOAD_DEV_FUNC(vkGetPipelineCacheData);
+    LOAD_DEV_FUNC(vkGetQueryPoolResults);
     LOAD_DEV_FUNC(vkGetSwapchainImagesKHR);
     LOAD_DEV_FUNC(vkMapMemory);
     LOAD_DEV_FUNC(vkQueuePresentKHR);
@@ -45,8 +45,10 @@ struct VkFuncs {
     DEFINE_VK_FUNC(vkCmdNextSubpass)
     DEFINE_VK_FUNC(vkCmdPipelineBarrier)
     DEFINE_VK_FUNC(vkCmdPushConstants)
+    DEFINE_VK_FUNC(vkCmdResetQueryPool)
     DEFINE_VK_FUNC(vkCmdSetScissor)
     DEFINE_VK_FUNC(vkCmdSetViewport)
+    DEFINE_VK_FUNC(vkCmdWriteTimestamp)
     DEFINE_VK_FUNC(vkCreateDevice)
     DEFINE_VK_FUNC(vkDestroyDevice)
     DEFINE_VK_FUNC(vkDestroyInstance)
@@ -88,7 +90,9 @@ struct VkFuncs {
     DEFINE_VK_FUNC(vkCreateGraphicsPipelines)
     DEFINE_VK_FUNC(vkCreateImage)
     DEFINE_VK_FUNC(vkCreateImageView)
+    DEFINE_VK_FUNC(vkCreatePipelineCache)
     DEFINE_VK_FUNC(vkCreatePipelineLayout)
+    DEFINE_VK_FUNC(vkCreateQueryPool)
     DEFINE_VK_FUNC(vkCreateRenderPass)
     DEFINE_VK_FUNC(vkCreateSampler)
     DEFINE_VK_FUNC(vkCreateSemaphore)
@@ -103,7 +107,9 @@ struct VkFuncs {
     DEFINE_VK_FUNC(vkDestroyImage)
     DEFINE_VK_FUNC(vkDestroyImageView)
     DEFINE_VK_FUNC(vkDestroyPipeline)
+    DEFINE_VK_FUNC(vkDestroyPipelineCache)
     DEFINE_VK_FUNC(vkDestroyPipelineLayout)
+    DEFINE_VK_FUNC(vkDestroyQueryPool)
     DEFINE_VK_FUNC(vkDestroyRenderPass)
     DEFINE_VK_FUNC(vkDestroySampler)
     DEFINE_VK_FUNC(vkDestroySemaphore)
@@ -117,6 +123,8 @@ struct VkFuncs {
     DEFINE_VK_FUNC(vkGetDeviceQueue)
     DEFINE_VK_FUNC(vkGetFenceStatus)
     DEFINE_VK_FUNC(vkGetImageMemoryRequirements)
+    DEFINE_VK_FUNC(vkGetPipelineCacheData)
+    DEFINE_VK_FUNC(vkGetQueryPoolResults)
     DEFINE_VK_FUNC(vkGetSwapchainImagesKHR)
     DEFINE_VK_FUNC(vkMapMemory)
     DEFINE_VK_FUNC(vkQueuePresentKHR)